@@ -18,7 +18,7 @@
 #include <signal.h>
 #include <stdio.h>
 #include <unwind.h>
-#include <dlfcn.h>
+#include <string.h>
 #include "crash.h"
 #include "crash_private.h"
 
@@ -30,11 +30,6 @@ namespace dmCrash
     static FCallstackExtraInfoCallback  g_CrashExtraInfoCallback = 0;
     static void*                        g_CrashExtraInfoCallbackCtx = 0;
 
-    struct unwind_data {
-      uint32_t offset_extra;
-      uint32_t stack_index;
-    };
-
     void EnableHandler(bool enable)
     {
         g_CrashDumpEnabled = enable;
@@ -46,52 +41,82 @@ namespace dmCrash
         g_CrashExtraInfoCallbackCtx = ctx;
     }
 
-    _Unwind_Reason_Code OnFrameEnter(struct _Unwind_Context *context, void *data)
+    // Only records the program counters. Everything in the crash handler must be async-signal-safe,
+    // so the frames are symbolized offline, from the module addresses read at startup (see SetLoadAddrs)
+    static _Unwind_Reason_Code OnFrameEnter(struct _Unwind_Context *context, void *data)
     {
-        unwind_data * unwindData = (unwind_data *) data;
+        (void)data;
         const uintptr_t pc = _Unwind_GetIP(context);
         if (pc)
         {
             g_AppState.m_Ptr[g_AppState.m_PtrCount] = (void*)(uintptr_t)pc;
             g_AppState.m_PtrCount++;
-            Dl_info dl_info;
-            int result = dladdr((void *) pc, &dl_info);
-            if (result) {
-                const char* proc_path = dl_info.dli_fname;
-                bool proc_path_truncated = false;
-                if (proc_path) {
-                    int proc_path_len = strlen(proc_path);
-                    if (proc_path_len > 32) {
-                        proc_path = proc_path + (proc_path_len-32);
-                        proc_path_truncated = true;
-                    }
-                }
-                char extra[256];
-                snprintf(extra, sizeof(extra),
-                    "#%02d pc %012p %s%s %s+%u",
-                    unwindData->stack_index++,
-                    (void*)((uintptr_t)pc - (intptr_t) dl_info.dli_fbase),
-                    proc_path_truncated ? "..." : "",
-                    proc_path ? proc_path : "",
-                    dl_info.dli_sname ? dl_info.dli_sname : "<unknown>",
-                    dl_info.dli_saddr != NULL ? (void*)((intptr_t) pc - (intptr_t) dl_info.dli_saddr) : 0);
-                
-                int extra_len = strlen(extra);
-                if ((unwindData->offset_extra + extra_len) < (dmCrash::AppState::EXTRA_MAX - 1))
-                {
-                    memcpy(g_AppState.m_Extra + unwindData->offset_extra, extra, extra_len);
-                    g_AppState.m_Extra[unwindData->offset_extra + extra_len] = '\n';
-                    unwindData->offset_extra += extra_len + 1;
-                }
-                else
-                {
-                    dmLogWarning("Not enough space to write entire stacktrace!");
-                }
-            }
         }
         return g_AppState.m_PtrCount >= AppState::PTRS_MAX ? _URC_END_OF_STACK : _URC_NO_REASON;
     }
 
+    // Signal safe string building, since snprintf may allocate or take locks
+    static uint32_t AppendString(char* buffer, uint32_t offset, uint32_t size, const char* str)
+    {
+        while (*str && offset < size)
+            buffer[offset++] = *str++;
+        return offset;
+    }
+
+    static uint32_t AppendHex(char* buffer, uint32_t offset, uint32_t size, uintptr_t value, uint32_t min_digits)
+    {
+        char digits[2 * sizeof(uintptr_t)];
+        uint32_t count = 0;
+        do {
+            digits[count++] = "0123456789abcdef"[value & 0xf];
+            value >>= 4;
+        } while (value != 0 && count < sizeof(digits));
+        while (count < min_digits && count < sizeof(digits))
+            digits[count++] = '0';
+        while (count > 0 && offset < size)
+            buffer[offset++] = digits[--count];
+        return offset;
+    }
+
+    // Writes the frames in the same format as the Android tombstones ("#00 pc 000000000001a2b4  libfoo.so"),
+    // which ndk-stack and addr2line can symbolize
+    static void WriteFrames()
+    {
+        char* extra = g_AppState.m_Extra;
+        const uint32_t size = AppState::EXTRA_MAX - 1;
+        uint32_t offset = 0;
+        for (uint32_t i = 0; i < g_AppState.m_PtrCount; ++i)
+        {
+            uintptr_t pc = (uintptr_t)g_AppState.m_Ptr[i];
+
+            // The module with the highest load address below the pc
+            int module = -1;
+            for (uint32_t m = 0; m < AppState::MODULES_MAX && g_AppState.m_ModuleName[m][0]; ++m)
+            {
+                uintptr_t addr = (uintptr_t)g_AppState.m_ModuleAddr[m];
+                if (addr <= pc && (module < 0 || addr > (uintptr_t)g_AppState.m_ModuleAddr[module]))
+                    module = (int)m;
+            }
+
+            offset = AppendString(extra, offset, size, "#");
+            offset = AppendHex(extra, offset, size, i, 2);
+            offset = AppendString(extra, offset, size, " pc ");
+            if (module >= 0)
+            {
+                offset = AppendHex(extra, offset, size, pc - (uintptr_t)g_AppState.m_ModuleAddr[module], 2 * sizeof(uintptr_t));
+                offset = AppendString(extra, offset, size, "  ");
+                offset = AppendString(extra, offset, size, g_AppState.m_ModuleName[module]);
+            }
+            else
+            {
+                offset = AppendHex(extra, offset, size, pc, 2 * sizeof(uintptr_t));
+                offset = AppendString(extra, offset, size, "  <unknown>");
+            }
+            offset = AppendString(extra, offset, size, "\n");
+        }
+        extra[offset] = 0;
+    }
+
     static void ResetToDefaultHandler(const int signum)
     {
         struct sigaction sa;
@@ -115,19 +140,19 @@ namespace dmCrash
         // be stuck in a signal-handler loop forever.
         ResetToDefaultHandler(signo);
 
-        unwind_data unwindData;
-        unwindData.offset_extra = 0;
-        unwindData.stack_index = 0;
-        _Unwind_Backtrace(OnFrameEnter, &unwindData);
+        _Unwind_Backtrace(OnFrameEnter, 0);
+        WriteFrames();
+
+        // Write the dump before anything that may be slow, in case the OS kills the process before we're done
+        WriteCrash(g_FilePath, &g_AppState);
 
         if (g_CrashExtraInfoCallback)
         {
             int extra_len = strlen(g_AppState.m_Extra);
             g_CrashExtraInfoCallback(g_CrashExtraInfoCallbackCtx, g_AppState.m_Extra + extra_len, dmCrash::AppState::EXTRA_MAX - extra_len - 1);
+            WriteCrash(g_FilePath, &g_AppState);
         }
 
-        WriteCrash(g_FilePath, &g_AppState);
-
         bool is_debug_mode = dLib::IsDebugMode();
         dLib::SetDebugMode(true);
         dmLogError("CALL STACK:\n\n%s\n", g_AppState.m_Extra);
@@ -101,6 +101,14 @@ namespace dmCrash
         HandlerSetExtraInfoCallback(cbk, ctx);
     }
 
+    void UpdateModules()
+    {
+        if (IsInitialized())
+        {
+            SetLoadAddrs(&g_AppState);
+        }
+    }
+
     void SetFilePath(const char *filepath)
     {
         dmStrlCpy(g_FilePath, filepath, sizeof(g_FilePath));
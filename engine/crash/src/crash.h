@@ -77,6 +77,12 @@ namespace dmCrash
      */
     void SetEnabled(bool enable);
 
+    /**
+     * Refresh the module names and load addresses that are written with a crash dump. They are read when
+     * the library is initialized, and not in the crash handler, so call this after loading a dynamic library (e.g. with dlopen)
+     */
+    void UpdateModules();
+
     // Called during creation of a callstack. May write extra relevant into to the output buffer.
     typedef void (*FCallstackExtraInfoCallback)(void* ctx, char* buffer, uint32_t buffsersize);
 
@@ -45,6 +45,10 @@ namespace dmCrash
         (void)enable;
     }
 
+    void UpdateModules()
+    {
+    }
+
     void SetExtraInfoCallback(FCallstackExtraInfoCallback cbk, void* ctx)
     {
         (void)cbk;
@@ -15,83 +15,81 @@
 #include <dlfcn.h>
 #include <link.h>
 #include <stdlib.h>
+#include <unistd.h>
 #include <dlib/log.h>
 #include <dlib/dstrings.h>
 #include "crash_private.h"
 
 namespace dmCrash
 {
-    void SetLoadAddrs(AppState* state)
+    struct LoadAddrsContext
     {
-        FILE *fp = fopen("/proc/self/smaps", "rt");
-        if (!fp)
-        {
-            dmLogWarning("Could not read /proc/self/smaps");
+        AppState* m_State;
+        uint32_t  m_Count;
+    };
+
+    static void SetModule(LoadAddrsContext* context, const char* path, void* addr)
+    {
+        const char* name = strrchr(path, '/');
+        name = name ? name + 1 : path;
+        if (!*name)
             return;
-        }
+        dmStrlCpy(context->m_State->m_ModuleName[context->m_Count], name, AppState::MODULE_NAME_SIZE);
+        context->m_State->m_ModuleAddr[context->m_Count] = addr;
+        context->m_Count++;
+    }
 
-        int count = 0;
-        char line[1024];
-        while (fgets(line, sizeof(line), fp))
+    static int OnModule(struct dl_phdr_info* info, size_t size, void* ctx)
+    {
+        (void)size;
+        LoadAddrsContext* context = (LoadAddrsContext*) ctx;
+        if (context->m_Count == AppState::MODULES_MAX)
+            return 1;
+
+        // The lowest loaded segment is the base of the module, which the addresses in the backtraces are relative to
+        ElfW(Addr) base = 0;
+        bool found = false;
+        for (ElfW(Half) i = 0; i < info->dlpi_phnum; ++i)
         {
-            // example line, extract address and name of all module lines
-            //
-            // b6f54000-b6f55000 rw-p 00001000 b3:17 3478       /system/lib/libsigchain.so
-            int len = strlen(line);
-            int addr_break = len;
-            int perm_start = len;
-            int name_start = len;
-            for (int i=0;i<len;i++)
+            const ElfW(Phdr)* phdr = &info->dlpi_phdr[i];
+            if (phdr->p_type == PT_LOAD && (!found || phdr->p_vaddr < base))
             {
-                if (addr_break == len)
-                {
-                    if (line[i] == '-')
-                        addr_break = i;
-                }
-                else if (perm_start == len)
-                {
-                    if (line[i] == ' ')
-                        perm_start = i+1;
-                }
-                else
-                {
-                    // pick the last /
-                    if (line[i] == '/')
-                        name_start = i + 1;
-                }
-
-                if (line[i] == '\n')
-                    line[i] = 0;
+                base = phdr->p_vaddr;
+                found = true;
             }
+        }
+        if (!found)
+            return 0;
 
-            if (addr_break < len && perm_start < len && name_start < len)
-            {
-                bool is_exec = false;
-                for (int p=perm_start;p<(perm_start+4) && p<len;p++)
-                {
-                    if (line[p] == 'x')
-                    {
-                        is_exec = true;
-                    }
-                }
-
-                if (!is_exec)
-                {
-                    continue;
-                }
+        void* addr = (void*)(info->dlpi_addr + base);
+        if (info->dlpi_name && info->dlpi_name[0])
+        {
+            SetModule(context, info->dlpi_name, addr);
+        }
+        else if (context->m_Count == 0)
+        {
+            // The first object is the executable, which has no name
+            char path[AppState::FILEPATH_MAX];
+            ssize_t len = readlink("/proc/self/exe", path, sizeof(path) - 1);
+            path[len > 0 ? len : 0] = 0;
+            SetModule(context, len > 0 ? path : "<executable>", addr);
+        }
+        return 0;
+    }
 
-                if (count == AppState::MODULES_MAX)
-                {
-                    break;
-                }
+    // Reads the loaded modules from the dynamic linker, which is a lot faster than parsing /proc/self/smaps.
+    // Called at startup, and again when libraries are loaded (see UpdateModules), never from the crash handler
+    void SetLoadAddrs(AppState* state)
+    {
+        LoadAddrsContext context;
+        context.m_State = state;
+        context.m_Count = 0;
+        dl_iterate_phdr(OnModule, &context);
 
-                line[addr_break] = 0;
-                state->m_ModuleAddr[count] = (void*)strtoull(line, 0, 16);
-                dmStrlCpy(state->m_ModuleName[count], &line[name_start], AppState::MODULE_NAME_SIZE);
-                ++count;
-            }
+        for (uint32_t i = context.m_Count; i < AppState::MODULES_MAX; ++i)
+        {
+            state->m_ModuleName[i][0] = 0;
+            state->m_ModuleAddr[i] = 0;
         }
-
-        fclose(fp);
     }
 }
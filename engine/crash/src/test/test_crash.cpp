@@ -118,6 +118,23 @@ TEST_F(dmCrashTest, TestLoad)
     ASSERT_GT(count, 3);
 }
 
+TEST_F(dmCrashTest, TestUpdateModules)
+{
+    dmCrash::UpdateModules();
+    dmCrash::WriteDump();
+
+    dmCrash::HDump d = dmCrash::LoadPrevious();
+    ASSERT_NE(d, 0);
+
+    uint32_t count = 0;
+    while (dmCrash::GetModuleName(d, count))
+    {
+        ASSERT_NE((void*) 0, dmCrash::GetModuleAddr(d, count));
+        count++;
+    }
+    ASSERT_GT(count, 3u);
+}
+
 TEST_F(dmCrashTest, TestPurgeCustomPath)
 {
     dmCrash::SetFilePath(MOUNTFS "remove-me");
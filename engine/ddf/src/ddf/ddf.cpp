@@ -87,6 +87,7 @@ namespace dmDDF
 
         // Calculate number of entries in arrays, ie memory requirements for the entire message
         uint32_t start = ib->Tell();
+        uint32_t field_hint = 0;
         while (!ib->Eof())
         {
             uint32_t tag;
@@ -98,7 +99,8 @@ namespace dmDDF
                 if (key == 0)
                     return RESULT_WIRE_FORMAT_ERROR;
 
-                const FieldDescriptor* field = FindField(desc, key, 0);
+                uint32_t field_index;
+                const FieldDescriptor* field = FindField(desc, key, field_hint, &field_index);
 
                 if (field == 0)
                 {
@@ -108,6 +110,7 @@ namespace dmDDF
                 }
                 else
                 {
+                    field_hint = field_index;
                     if (field->m_Label == LABEL_REPEATED)
                     {
                         load_context->IncreaseArrayCount(start, field->m_Number);
@@ -157,6 +160,34 @@ namespace dmDDF
         return LoadMessage(buffer, buffer_size, desc, out_message, 0, 0);
     }
 
+    // Counts the repeated fields, and calculates the memory needed for the message
+    static Result DryLoadMessage(LoadContext* load_context, InputBuffer* input_buffer, const Descriptor* desc)
+    {
+        Message dry_message = load_context->AllocMessage(desc);
+
+        Result e = CalculateRepeated(load_context, input_buffer, desc);
+        if (e != RESULT_OK)
+        {
+            return e;
+        }
+
+        input_buffer->Seek(0);
+        DoLoadMessage(load_context, input_buffer, desc, &dry_message);
+        return RESULT_OK;
+    }
+
+    static Result CheckLoadOptions(const Descriptor* desc, uint32_t options)
+    {
+        if (desc->m_MajorVersion != DDF_MAJOR_VERSION)
+            return RESULT_VERSION_MISMATCH;
+
+        // The offsets are relative to the message buffer
+        if ((options & OPTION_IN_PLACE_BYTES) && (options & OPTION_OFFSET_POINTERS))
+            return RESULT_INTERNAL_ERROR;
+
+        return RESULT_OK;
+    }
+
     Result LoadMessage(const void* buffer, uint32_t buffer_size, const Descriptor* desc, void** out_message, uint32_t options, uint32_t* size)
     {
         DM_PROFILE("DdfLoadMessage");
@@ -167,23 +198,19 @@ namespace dmDDF
         if (size)
             *size = 0;
 
-        if (desc->m_MajorVersion != DDF_MAJOR_VERSION)
-            return RESULT_VERSION_MISMATCH;
+        Result e = CheckLoadOptions(desc, options);
+        if (e != RESULT_OK)
+            return e;
 
         LoadContext load_context(0, 0, true, options);
-        Message dry_message = load_context.AllocMessage(desc);
-
         InputBuffer input_buffer((const char*) buffer, buffer_size);
 
-        Result e = CalculateRepeated(&load_context, &input_buffer, desc);
+        e = DryLoadMessage(&load_context, &input_buffer, desc);
         if (e != RESULT_OK)
         {
             return e;
         }
 
-        input_buffer.Seek(0);
-        e = DoLoadMessage(&load_context, &input_buffer, desc, &dry_message);
-
         int message_buffer_size = load_context.GetMemoryUsage();
         char* message_buffer = 0;
         dmMemory::AlignedMalloc((void**)&message_buffer, 16, message_buffer_size);
@@ -207,6 +234,49 @@ namespace dmDDF
         return e;
     }
 
+    Result LoadMessageToBuffer(const void* buffer, uint32_t buffer_size, const Descriptor* desc, void* message_buffer, uint32_t message_buffer_size, uint32_t options, uint32_t* size)
+    {
+        DM_PROFILE("DdfLoadMessage");
+        assert(buffer);
+        assert(desc);
+        assert(size);
+        // The dry run aligns the allocations as if the buffer was aligned
+        assert(((uintptr_t) message_buffer & 15) == 0);
+
+        *size = 0;
+
+        Result e = CheckLoadOptions(desc, options);
+        if (e != RESULT_OK)
+            return e;
+
+        LoadContext load_context(0, 0, true, options);
+        InputBuffer input_buffer((const char*) buffer, buffer_size);
+
+        e = DryLoadMessage(&load_context, &input_buffer, desc);
+        if (e != RESULT_OK)
+        {
+            return e;
+        }
+
+        uint32_t message_size = (uint32_t) load_context.GetMemoryUsage();
+        *size = message_size;
+        if (message_size > message_buffer_size)
+        {
+            return RESULT_BUFFER_TOO_SMALL;
+        }
+
+        load_context.SetMemoryBuffer((char*) message_buffer, message_size, false);
+        Message message = load_context.AllocMessage(desc);
+
+        input_buffer.Seek(0);
+        e = DoLoadMessage(&load_context, &input_buffer, desc, &message);
+        if (e != RESULT_OK)
+        {
+            *size = 0;
+        }
+        return e;
+    }
+
     Result LoadMessageFromFile(const char* file_name, const Descriptor* desc, void** message)
     {
         FILE* f = fopen(file_name, "rb");
@@ -138,6 +138,7 @@ namespace dmDDF
             }
         }
 
+        uint32_t field_hint = 0;
         while (!input_buffer->Eof())
         {
             uint32_t tag;
@@ -152,7 +153,7 @@ namespace dmDDF
                 }
 
                 uint32_t field_index;
-                const FieldDescriptor* field = FindField(desc, key, &field_index);
+                const FieldDescriptor* field = FindField(desc, key, field_hint, &field_index);
 
                 if (!field)
                 {
@@ -168,6 +169,7 @@ namespace dmDDF
                 {
                     assert(field_index < DDF_MAX_FIELDS);
                     read_fields[field_index] = 1;
+                    field_hint = field_index;
 
                     Result e;
                     e = message->ReadField(load_context, (WireType) type, field, input_buffer);
@@ -31,7 +31,7 @@ namespace dmDDF
         {
             memset(buffer, 0, buffer_size);
         }
-        m_ArrayCount.SetCapacity(2048, 2048);
+        // The array counts are allocated on demand, most messages don't have that many repeated fields
     }
 
     Message LoadContext::AllocMessage(const Descriptor* desc)
@@ -50,6 +50,35 @@ namespace dmDDF
         return 0;
     }
 
+    /**
+     * Finds a field, starting the search at a field index and wrapping around.
+     * Messages are written with the fields in descriptor order, and the elements of a repeated
+     * field after each other, so starting at the previously read field usually finds the
+     * field with the first or second compare, instead of scanning the whole descriptor.
+     * @param desc Descriptor
+     * @param key Field number
+     * @param hint Field index to start at
+     * @param index Index of the found field (out)
+     * @return The field, or 0 if not found
+     */
+    static inline const FieldDescriptor* FindField(const Descriptor* desc, uint32_t key, uint32_t hint, uint32_t* index)
+    {
+        uint32_t count = desc->m_FieldCount;
+        uint32_t i = hint < count ? hint : 0;
+        for (uint32_t n = 0; n < count; ++n)
+        {
+            const FieldDescriptor* f = &desc->m_Fields[i];
+            if (f->m_Number == key)
+            {
+                *index = i;
+                return f;
+            }
+            if (++i == count)
+                i = 0;
+        }
+        return 0;
+    }
+
     static inline WireType WireTypeCorrespondence(Type ddf_type)
     {
         switch(ddf_type)
@@ -44,6 +44,14 @@ namespace dmDDF
      */
     const uint32_t OPTION_OFFSET_POINTERS = (1 << 0);
 
+    /*#
+     * Point the bytes fields into the input buffer instead of copying them. The input buffer must outlive the message.
+     * Can't be combined with dmDDF::OPTION_OFFSET_POINTERS. Value (1 << 1)
+     * @constant
+     * @name OPTION_IN_PLACE_BYTES
+     */
+    const uint32_t OPTION_IN_PLACE_BYTES = (1 << 1);
+
     /*# result enumeration
      * Result enumeration.
      *
@@ -55,6 +63,7 @@ namespace dmDDF
      * @member dmDDF::RESULT_IO_ERROR = 3,
      * @member dmDDF::RESULT_VERSION_MISMATCH = 4,
      * @member dmDDF::RESULT_MISSING_REQUIRED = 5,
+     * @member dmDDF::RESULT_BUFFER_TOO_SMALL = 6,
      * @member dmDDF::RESULT_INTERNAL_ERROR = 1000,
      */
     enum Result
@@ -65,6 +74,7 @@ namespace dmDDF
         RESULT_IO_ERROR = 3,
         RESULT_VERSION_MISMATCH = 4,
         RESULT_MISSING_REQUIRED = 5,
+        RESULT_BUFFER_TOO_SMALL = 6,
         RESULT_INTERNAL_ERROR = 1000,
     };
 
@@ -100,6 +110,21 @@ namespace dmDDF
      */
     Result LoadMessage(const void* buffer, uint32_t buffer_size, const Descriptor* desc, void** message, uint32_t options, uint32_t* size);
 
+    /*#
+     * Load/decode a DDF message into a caller supplied buffer, e.g. from a frame allocator or the stack.
+     * The message is placed at the start of the buffer, and must not be freed with dmDDF::FreeMessage()
+     * @name LoadMessageToBuffer
+     * @param buffer [type:const void*] Input buffer
+     * @param buffer_size [type:uint32_t] Input buffer size in bytes
+     * @param desc [type:dmDDF::Descriptor*] DDF descriptor
+     * @param message_buffer [type:void*] Destination buffer. Must be 16 byte aligned
+     * @param message_buffer_size [type:uint32_t] Destination buffer size in bytes
+     * @param options [type:uint32_t] options, eg dmDDF::OPTION_IN_PLACE_BYTES
+     * @param size [type:uint32_t*] (out) loaded message size, or the size needed if the buffer is too small
+     * @return RESULT_OK on success, RESULT_BUFFER_TOO_SMALL if the message doesn't fit in the buffer
+     */
+    Result LoadMessageToBuffer(const void* buffer, uint32_t buffer_size, const Descriptor* desc, void* message_buffer, uint32_t message_buffer_size, uint32_t options, uint32_t* size);
+
     /*#
      * Save message to array
      * @name SaveMessageToArray
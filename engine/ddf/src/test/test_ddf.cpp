@@ -22,6 +22,7 @@
 #include <jc_test/jc_test.h>
 
 #include "../ddf/ddf.h"
+#include <dlib/align.h>
 #include <dlib/memory.h>
 #include <dlib/dstrings.h>
 #include <dlib/sys.h>
@@ -253,6 +254,40 @@ TEST(ScalarTypes, Load)
     dmDDF::FreeMessage(message);
 }
 
+TEST(ScalarTypes, LoadOutOfOrder)
+{
+    // The fields are looked up starting at the previously read one, make sure any order is found
+    TestDDF::ScalarTypes last;
+    last.set_string_val("foo");
+    last.set_bool_val(true);
+    TestDDF::ScalarTypes middle;
+    middle.set_int32_val(INT32_MAX);
+    middle.set_uint32_val(UINT32_MAX);
+    middle.set_int64_val(INT64_MAX);
+    middle.set_uint64_val(UINT64_MAX);
+    TestDDF::ScalarTypes first;
+    first.set_float_val(1.0f);
+    first.set_double_val(2.0);
+
+    std::string msg_str = last.SerializePartialAsString() + middle.SerializePartialAsString() + first.SerializePartialAsString();
+    void* message;
+
+    dmDDF::Result e = dmDDF::LoadMessage((void*) msg_str.c_str(), msg_str.size(), &DUMMY::TestDDF_ScalarTypes_DESCRIPTOR, &message);
+    ASSERT_EQ(dmDDF::RESULT_OK, e);
+
+    DUMMY::TestDDF::ScalarTypes* msg = (DUMMY::TestDDF::ScalarTypes*) message;
+    ASSERT_EQ(1.0f, msg->m_FloatVal);
+    ASSERT_EQ(2.0, msg->m_DoubleVal);
+    ASSERT_EQ(INT32_MAX, msg->m_Int32Val);
+    ASSERT_EQ(UINT32_MAX, msg->m_Uint32Val);
+    ASSERT_EQ(INT64_MAX, msg->m_Int64Val);
+    ASSERT_EQ(UINT64_MAX, msg->m_Uint64Val);
+    ASSERT_STREQ("foo", msg->m_StringVal);
+    ASSERT_TRUE(msg->m_BoolVal);
+
+    dmDDF::FreeMessage(message);
+}
+
 TEST(Enum, Simple)
 {
     ASSERT_EQ(10, DUMMY::TestDDF::TEST_ENUM_VAL1);
@@ -543,6 +578,78 @@ TEST(Bytes, Load)
     dmDDF::FreeMessage(message);
 }
 
+TEST(Bytes, LoadInPlace)
+{
+    TestDDF::Bytes bytes;
+    bytes.set_pad("..");
+    bytes.set_data((void*) "foo", 3);
+    std::string msg_str = bytes.SerializeAsString();
+    const char* msg_buf = msg_str.c_str();
+    uint32_t msg_buf_size = msg_str.size();
+    void* message;
+    uint32_t size;
+
+    dmDDF::Result e = dmDDF::LoadMessage((void*) msg_buf, msg_buf_size, &DUMMY::TestDDF_Bytes_DESCRIPTOR, &message, dmDDF::OPTION_IN_PLACE_BYTES, &size);
+    ASSERT_EQ(dmDDF::RESULT_OK, e);
+
+    DUMMY::TestDDF::Bytes* msg = (DUMMY::TestDDF::Bytes*) message;
+    ASSERT_EQ((uint32_t) 3, msg->m_Data.m_Count);
+    ASSERT_EQ(0, memcmp("foo", msg->m_Data.m_Data, 3));
+    ASSERT_STREQ("..", msg->m_Pad);
+
+    // Points into the input buffer
+    ASSERT_GE((const char*) msg->m_Data.m_Data, msg_buf);
+    ASSERT_LE((const char*) msg->m_Data.m_Data + 3, msg_buf + msg_buf_size);
+    dmDDF::FreeMessage(message);
+
+    // The offsets would be relative to the message
+    e = dmDDF::LoadMessage((void*) msg_buf, msg_buf_size, &DUMMY::TestDDF_Bytes_DESCRIPTOR, &message, dmDDF::OPTION_IN_PLACE_BYTES | dmDDF::OPTION_OFFSET_POINTERS, &size);
+    ASSERT_EQ(dmDDF::RESULT_INTERNAL_ERROR, e);
+}
+
+TEST(LoadToBuffer, Load)
+{
+    const int count = 5;
+
+    TestDDF::Simple01Repeated repated;
+    for (int i = 0; i < count; ++i)
+    {
+        TestDDF::Simple01*s = repated.add_array();
+        s->set_x(i);
+        s->set_y(i+100);
+    }
+
+    std::string msg_str = repated.SerializeAsString();
+    const char* msg_buf = msg_str.c_str();
+    uint32_t msg_buf_size = msg_str.size();
+
+    DM_ALIGNED(16) uint8_t buffer[256];
+    uint32_t size = 0;
+
+    dmDDF::Result e = dmDDF::LoadMessageToBuffer(msg_buf, msg_buf_size, &DUMMY::TestDDF_Simple01Repeated_DESCRIPTOR, buffer, 16, 0, &size);
+    ASSERT_EQ(dmDDF::RESULT_BUFFER_TOO_SMALL, e);
+    ASSERT_LT(16u, size);
+    ASSERT_GE(sizeof(buffer), size);
+    uint32_t needed_size = size;
+
+    e = dmDDF::LoadMessageToBuffer(msg_buf, msg_buf_size, &DUMMY::TestDDF_Simple01Repeated_DESCRIPTOR, buffer, sizeof(buffer), 0, &size);
+    ASSERT_EQ(dmDDF::RESULT_OK, e);
+    ASSERT_EQ(needed_size, size);
+
+    DUMMY::TestDDF::Simple01Repeated* msg = (DUMMY::TestDDF::Simple01Repeated*) buffer;
+    ASSERT_EQ((uint32_t) count, msg->m_Array.m_Count);
+    for (int i = 0; i < count; ++i)
+    {
+        ASSERT_EQ(repated.array(i).x(), msg->m_Array.m_Data[i].m_X);
+        ASSERT_EQ(repated.array(i).y(), msg->m_Array.m_Data[i].m_Y);
+    }
+
+    std::string msg_str2;
+    e = DDFSaveToString(msg, &DUMMY::TestDDF_Simple01Repeated_DESCRIPTOR, msg_str2);
+    ASSERT_EQ(dmDDF::RESULT_OK, e);
+    ASSERT_EQ(msg_str, msg_str2);
+}
+
 TEST(Material, Load)
 {
     TestDDF::MaterialDesc material_desc;
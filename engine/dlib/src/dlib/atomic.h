@@ -17,4 +17,33 @@
 
 #include <dmsdk/dlib/atomic.h>
 
+/**
+ * Atomic pointer exchange, with a full memory barrier.
+ * @param ptr Pointer to the pointer to store into.
+ * @param value Value to set.
+ * @return prev Previous value
+ */
+inline void* dmAtomicStorePtr(void* volatile* ptr, void* value)
+{
+#if defined(_MSC_VER)
+    return InterlockedExchangePointer((void* volatile*) ptr, value);
+#else
+    return __atomic_exchange_n(ptr, value, __ATOMIC_SEQ_CST);
+#endif
+}
+
+/**
+ * Atomic pointer get, with a full memory barrier.
+ * @param ptr Pointer to the pointer to get from.
+ * @return value Current value
+ */
+inline void* dmAtomicGetPtr(void* volatile* ptr)
+{
+#if defined(_MSC_VER)
+    return InterlockedCompareExchangePointer((void* volatile*) ptr, 0, 0);
+#else
+    return __atomic_load_n(ptr, __ATOMIC_SEQ_CST);
+#endif
+}
+
 #endif //DM_ATOMIC_H
@@ -52,6 +52,7 @@ namespace dmConnectionPool
 
         dmSocket::Address       m_Address;
         dmhash_t                m_ID;
+        dmhash_t                m_HostID;   // Host name, port and ssl, used to reuse connections without a dns lookup
         uint64_t                m_Expires;
         dmSSLSocket::Socket     m_SSLSocket;
         dmSocket::Socket        m_Socket;
@@ -169,6 +170,17 @@ namespace dmConnectionPool
         return dmHashFinal64(&hs);
     }
 
+    static dmhash_t CalculateHostID(const char* host, uint16_t port, bool ssl)
+    {
+        HashState64 hs;
+        dmHashInit64(&hs, false);
+        dmHashUpdateBuffer64(&hs, host, strlen(host));
+        dmHashUpdateBuffer64(&hs, &port, sizeof(port));
+        dmHashUpdateBuffer64(&hs, &ssl, sizeof(ssl));
+
+        return dmHashFinal64(&hs);
+    }
+
     static HConnection MakeHandle(HPool pool, uint32_t index, Connection* c) {
         if (pool->m_NextVersion == 0) {
             pool->m_NextVersion = 1;
@@ -210,6 +222,29 @@ namespace dmConnectionPool
         return false;
     }
 
+    // Find an idle connection that was previously dialed with the same host name.
+    // This lets us skip the (blocking) host lookup when fetching many files from the same server
+    static bool FindConnectionByHost(HPool pool, dmhash_t host_id, bool ipv4, bool ipv6, HConnection* connection)
+    {
+        uint32_t n = pool->m_Connections.Size();
+        for (uint32_t i = 0; i < n; ++i) {
+            Connection* c = &pool->m_Connections[i];
+            if (c->m_State == STATE_CONNECTED && c->m_HostID == host_id) {
+                bool ipv4_match = ipv4 && dmSocket::IsSocketIPv4(c->m_Socket);
+                bool ipv6_match = ipv6 && dmSocket::IsSocketIPv6(c->m_Socket);
+                if (ipv4_match || ipv6_match)
+                {
+                    c->m_State = STATE_INUSE;
+                    c->m_ReuseCount++;
+                    *connection = MakeHandle(pool, i, c);
+                    return true;
+                }
+            }
+        }
+
+        return false;
+    }
+
     static void DoClose(HPool pool, Connection* c)
     {
         if (c->m_SSLSocket != dmSSLSocket::INVALID_SOCKET_HANDLE) {
@@ -240,6 +275,7 @@ namespace dmConnectionPool
     {
         uint32_t n = pool->m_Connections.Size();
 
+        uint32_t oldest = n;
         for (uint32_t i = 0; i < n; ++i) {
             Connection* c = &pool->m_Connections[i];
             if (c->m_State == STATE_FREE) {
@@ -247,6 +283,19 @@ namespace dmConnectionPool
                 *index = i;
                 return true;
             }
+            if (c->m_State == STATE_CONNECTED && (oldest == n || c->m_Expires < pool->m_Connections[oldest].m_Expires)) {
+                oldest = i;
+            }
+        }
+
+        // No free slots. Rather than failing while idle connections to other hosts are kept alive,
+        // we close the one closest to expire
+        if (oldest != n) {
+            Connection* c = &pool->m_Connections[oldest];
+            DoClose(pool, c);
+            *connection = c;
+            *index = oldest;
+            return true;
         }
         return false;
     }
@@ -348,6 +397,17 @@ namespace dmConnectionPool
         // Connecting to the returned address would fail when on an ipv6 network.
         // This is why when calling DoDial we now have the ability to specify ipv4 and/or ipv6 so
         // that the caller can try to connect first to ipv4 and then to ipv6 if ipv4 failed.
+        dmhash_t host_id = CalculateHostID(host, port, ssl);
+        {
+            DM_MUTEX_SCOPED_LOCK(pool->m_Mutex);
+
+            PurgeExpired(pool);
+
+            if (FindConnectionByHost(pool, host_id, ipv4, ipv6, connection)) {
+                return RESULT_OK;
+            }
+        }
+
         dmSocket::Address address;
 
         uint64_t dial_started = dmTime::GetTime();
@@ -397,6 +457,7 @@ namespace dmConnectionPool
                 c->m_Socket = socket;
                 c->m_SSLSocket = sslsocket;
                 c->m_ID = conn_id;
+                c->m_HostID = host_id;
                 c->m_ReuseCount = 0;
                 c->m_State = STATE_INUSE;
                 c->m_Expires = pool->m_MaxKeepAlive * 1000000U + dmTime::GetTime();
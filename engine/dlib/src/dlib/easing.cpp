@@ -61,5 +61,25 @@ namespace dmEasing
         float diff = (t - index1 * (1.0f / (sample_count-1))) * (sample_count-1);
         return val1 * (1.0f - diff) + val2 * diff;
     }
+
+    void GetValues(Type type, const float* t, float* out, uint32_t count)
+    {
+        assert(type < TYPE_FLOAT_VECTOR);
+        const float* lookup = EASING_LOOKUP + type * (EASING_SAMPLES + 1);
+        const float scale = (float) (EASING_SAMPLES - 1);
+        const float inv_scale = 1.0f / (EASING_SAMPLES - 1);
+
+        // Since the last sample is duplicated, index1 + 1 is always a valid sample and
+        // we can skip the clamping of index2 done in GetValue
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            float ti = dmMath::Clamp(t[i], 0.0f, 1.0f);
+            int index1 = (int) (ti * scale);
+            float val1 = lookup[index1];
+            float val2 = lookup[index1 + 1];
+            float diff = (ti - index1 * inv_scale) * scale;
+            out[i] = val1 * (1.0f - diff) + val2 * diff;
+        }
+    }
 }
 
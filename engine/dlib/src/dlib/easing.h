@@ -105,6 +105,15 @@ namespace dmEasing
      */
     float GetValue(Type type, float t);
     float GetValue(Curve curve, float t);
+
+    /**
+     * Batched easing-curve evaluation of a built in curve type
+     * @param type curve type, must not be TYPE_FLOAT_VECTOR
+     * @param t array of count times, clamped to the range [0,1]
+     * @param out array of count curve values
+     * @param count number of values to evaluate
+     */
+    void GetValues(Type type, const float* t, float* out, uint32_t count);
 }
 
 #endif // DM_EASING
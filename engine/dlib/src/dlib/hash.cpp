@@ -32,33 +32,116 @@ struct ReverseHashEntry
     uint16_t m_Length;
 };
 
+// The reverse hash entries are split into shards, selected by the top bits of the hash,
+// each with its own lock. This way, threads hashing different strings rarely contend
+template <typename TABLE>
+struct ReverseHashShard
+{
+    dmMutex::HMutex m_Mutex;
+    TABLE           m_Entries;
+};
+
+typedef ReverseHashShard<dmHashTable32<ReverseHashEntry> > ReverseHashShard32;
+typedef ReverseHashShard<dmHashTable64<ReverseHashEntry> > ReverseHashShard64;
+
 struct ReverseHashContainer
 {
-    static const size_t m_HashTableSize = 1024;
-    static const size_t m_HashTableCapacity = 512;
-    static const size_t m_HashTableCapacityIncrement = 256;
+    static const size_t m_ShardCount = 16;
+    static const size_t m_HashTableSize = 1024 / m_ShardCount;
+    static const size_t m_HashTableCapacity = 512 / m_ShardCount;
+    static const size_t m_HashTableCapacityIncrement = 256 / m_ShardCount;
     static const size_t m_HashStatesCapacity = 512;
     static const size_t m_HashStatesCapacityIncrement = 256;
 
-    dmMutex::HMutex                 m_Mutex;
+    dmMutex::HMutex                 m_Mutex; // Protects the enabled state and the hash states
     bool                            m_Enabled;
-    dmHashTable32<ReverseHashEntry> m_HashTable32Entries;
-    dmHashTable64<ReverseHashEntry> m_HashTable64Entries;
+    ReverseHashShard32              m_Shards32[m_ShardCount];
+    ReverseHashShard64              m_Shards64[m_ShardCount];
     dmArray<ReverseHashEntry>       m_HashStates;
     dmIndexPool32                   m_HashStatesSlots;
 
     ReverseHashContainer()
     {
         m_Mutex = dmMutex::New();
+        for (uint32_t i = 0; i < m_ShardCount; ++i)
+        {
+            m_Shards32[i].m_Mutex = dmMutex::New();
+            m_Shards64[i].m_Mutex = dmMutex::New();
+        }
         m_Enabled = false;
     }
 
     ~ReverseHashContainer()
     {
         Enable(false);
+        for (uint32_t i = 0; i < m_ShardCount; ++i)
+        {
+            dmMutex::Delete(m_Shards32[i].m_Mutex);
+            dmMutex::Delete(m_Shards64[i].m_Mutex);
+        }
         dmMutex::Delete(m_Mutex);
     }
 
+    inline ReverseHashShard32& GetShard(uint32_t hash)
+    {
+        return m_Shards32[hash >> 28];
+    }
+
+    inline ReverseHashShard64& GetShard(uint64_t hash)
+    {
+        return m_Shards64[hash >> 60];
+    }
+
+    template <typename SHARD>
+    static void ClearShard(SHARD& shard, bool free_entries)
+    {
+        DM_MUTEX_SCOPED_LOCK(shard.m_Mutex);
+        if (free_entries)
+        {
+            shard.m_Entries.Iterate(FreeEntryCallback, (void*) 0);
+        }
+        else if (shard.m_Entries.Capacity() < m_HashTableCapacity)
+        {
+            shard.m_Entries.SetCapacity(m_HashTableSize, m_HashTableCapacity);
+        }
+        shard.m_Entries.Clear();
+    }
+
+    // Adds the entry unless the hash is already registered. Returns false if the entry wasn't added
+    template <typename SHARD, typename KEY>
+    static bool PutEntry(SHARD& shard, KEY hash, const ReverseHashEntry& entry)
+    {
+        DM_MUTEX_SCOPED_LOCK(shard.m_Mutex);
+        if (shard.m_Entries.Get(hash) != 0)
+        {
+            return false;
+        }
+        if (shard.m_Entries.Full())
+        {
+            shard.m_Entries.SetCapacity(m_HashTableSize, shard.m_Entries.Capacity() + m_HashTableCapacityIncrement);
+        }
+        shard.m_Entries.Put(hash, entry);
+        return true;
+    }
+
+    template <typename SHARD, typename KEY>
+    static void PutEntryCopy(SHARD& shard, KEY hash, const void* key, uint32_t len)
+    {
+        DM_MUTEX_SCOPED_LOCK(shard.m_Mutex);
+        if (shard.m_Entries.Get(hash) != 0)
+        {
+            return;
+        }
+        if (shard.m_Entries.Full())
+        {
+            shard.m_Entries.SetCapacity(m_HashTableSize, shard.m_Entries.Capacity() + m_HashTableCapacityIncrement);
+        }
+        char* copy = (char*) malloc(len + 1);
+        memcpy(copy, key, len);
+        copy[len] = '\0';
+        shard.m_Entries.Put(hash, ReverseHashEntry(copy, len));
+    }
+
     template <typename KEY>
     static inline void FreeEntryCallback(void* context, const KEY* key, ReverseHashEntry* value)
     {
@@ -81,13 +164,11 @@ struct ReverseHashContainer
 
         if(enable)
         {
-
-            if(m_HashTable32Entries.Capacity() < m_HashTableCapacity)
-                m_HashTable32Entries.SetCapacity(m_HashTableSize, m_HashTableCapacity);
-            m_HashTable32Entries.Clear();
-            if(m_HashTable64Entries.Capacity() < m_HashTableCapacity)
-                m_HashTable64Entries.SetCapacity(m_HashTableSize, m_HashTableCapacity);
-            m_HashTable64Entries.Clear();
+            for (uint32_t i = 0; i < m_ShardCount; ++i)
+            {
+                ClearShard(m_Shards32[i], false);
+                ClearShard(m_Shards64[i], false);
+            }
             m_HashStates.SetCapacity(m_HashStatesCapacity);
             m_HashStates.SetSize(m_HashStatesCapacity);
             m_HashStatesSlots.SetCapacity(m_HashStatesCapacity);
@@ -97,10 +178,11 @@ struct ReverseHashContainer
         }
         else
         {
-            m_HashTable32Entries.Iterate(FreeEntryCallback, (void*) 0);
-            m_HashTable32Entries.Clear();
-            m_HashTable64Entries.Iterate(FreeEntryCallback, (void*) 0);
-            m_HashTable64Entries.Clear();
+            for (uint32_t i = 0; i < m_ShardCount; ++i)
+            {
+                ClearShard(m_Shards32[i], true);
+                ClearShard(m_Shards64[i], true);
+            }
             if(m_HashStatesSlots.Size() != 0)
             {
                 m_HashStatesSlots.Push(0);
@@ -177,6 +259,34 @@ void dmHashEnableReverseHash(bool enable)
 
 #define mmix(h,k) { k *= m; k ^= k >> r; k *= m; h *= m; h ^= k; }
 
+// The hashes are defined on little endian words. On little endian platforms
+// the words are loaded directly instead of being assembled byte by byte
+#if (defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)) || defined(_MSC_VER)
+    #define DM_HASH_LITTLE_ENDIAN
+#endif
+
+static inline uint32_t ReadWord32(const unsigned char* data)
+{
+#if defined(DM_HASH_LITTLE_ENDIAN)
+    uint32_t k;
+    memcpy(&k, data, sizeof(k));
+    return k;
+#else
+    return uint32_t(data[0]) | (uint32_t(data[1]) << 8) | (uint32_t(data[2]) << 16) | (uint32_t(data[3]) << 24);
+#endif
+}
+
+static inline uint64_t ReadWord64(const unsigned char* data)
+{
+#if defined(DM_HASH_LITTLE_ENDIAN)
+    uint64_t k;
+    memcpy(&k, data, sizeof(k));
+    return k;
+#else
+    return uint64_t(ReadWord32(data)) | (uint64_t(ReadWord32(data + 4)) << 32);
+#endif
+}
+
 // Based on MurmurHash2A but endian neutral
 uint32_t dmHashBufferNoReverse32(const void* key, uint32_t len)
 {
@@ -190,12 +300,7 @@ uint32_t dmHashBufferNoReverse32(const void* key, uint32_t len)
 
     while(len >= 4)
     {
-        uint32_t k;
-
-        k  = data[0];
-        k |= data[1] << 8;
-        k |= data[2] << 16;
-        k |= data[3] << 24;
+        uint32_t k = ReadWord32(data);
 
         mmix(h,k);
 
@@ -228,19 +333,7 @@ uint32_t dmHashBuffer32(const void * key, uint32_t len)
 
     if (dmHashContainer().m_Enabled && len <= DMHASH_MAX_REVERSE_LENGTH)
     {
-        DM_MUTEX_SCOPED_LOCK(dmHashContainer().m_Mutex);
-        dmHashTable32<ReverseHashEntry>* hash_table = &dmHashContainer().m_HashTable32Entries;
-        if (hash_table->Get(h) == 0)
-        {
-            if (hash_table->Full())
-            {
-                hash_table->SetCapacity(dmHashContainer().m_HashTableSize, hash_table->Capacity() + dmHashContainer().m_HashTableCapacityIncrement);
-            }
-            char* copy = (char*) malloc(len + 1);
-            memcpy(copy, key, len);
-            copy[len] = '\0';
-            hash_table->Put(h, ReverseHashEntry(copy, len));
-        }
+        ReverseHashContainer::PutEntryCopy(dmHashContainer().GetShard(h), h, key, len);
     }
 
     return h;
@@ -259,16 +352,7 @@ uint64_t dmHashBufferNoReverse64(const void * key, uint32_t len)
 
     while(len >= 8)
     {
-        uint64_t k;
-
-        k  = uint64_t(data[0]);
-        k |= uint64_t(data[1]) << 8;
-        k |= uint64_t(data[2]) << 16;
-        k |= uint64_t(data[3]) << 24;
-        k |= uint64_t(data[4]) << 32;
-        k |= uint64_t(data[5]) << 40;
-        k |= uint64_t(data[6]) << 48;
-        k |= uint64_t(data[7]) << 56;
+        uint64_t k = ReadWord64(data);
 
         mmix(h,k);
 
@@ -305,19 +389,7 @@ uint64_t dmHashBuffer64(const void * key, uint32_t len)
 
     if (dmHashContainer().m_Enabled && len <= DMHASH_MAX_REVERSE_LENGTH)
     {
-        DM_MUTEX_SCOPED_LOCK(dmHashContainer().m_Mutex);
-        dmHashTable64<ReverseHashEntry>* hash_table = &dmHashContainer().m_HashTable64Entries;
-        if (hash_table->Get(h) == 0)
-        {
-            if (hash_table->Full())
-            {
-                hash_table->SetCapacity(dmHashContainer().m_HashTableSize, hash_table->Capacity() + dmHashContainer().m_HashTableCapacityIncrement);
-            }
-            char* copy = (char*) malloc(len + 1);
-            memcpy(copy, key, len);
-            copy[len] = '\0';
-            hash_table->Put(h, ReverseHashEntry(copy, len));
-        }
+        ReverseHashContainer::PutEntryCopy(dmHashContainer().GetShard(h), h, key, len);
     }
 
     return h;
@@ -399,11 +471,7 @@ void dmHashUpdateBuffer32(HashState32* hash_state, const void* buffer, uint32_t
 
     while(len >= 4)
     {
-        uint32_t k;
-        k  = data[0];
-        k |= data[1] << 8;
-        k |= data[2] << 16;
-        k |= data[3] << 24;
+        uint32_t k = ReadWord32(data);
 
         mmix(hash_state->m_Hash,k);
 
@@ -433,18 +501,10 @@ uint32_t dmHashFinal32(HashState32* hash_state)
     if (dmHashContainer().m_Enabled && hash_state->m_ReverseHashEntryIndex && hash_state->m_Size <= DMHASH_MAX_REVERSE_LENGTH)
     {
         DM_MUTEX_SCOPED_LOCK(dmHashContainer().m_Mutex);
-        dmHashTable32<ReverseHashEntry>* hash_table = &dmHashContainer().m_HashTable32Entries;
-        if (hash_table->Get(hash_state->m_Hash) == 0)
-        {
-            if (hash_table->Full())
-            {
-                hash_table->SetCapacity(dmHashContainer().m_HashTableSize, hash_table->Capacity() + dmHashContainer().m_HashTableCapacityIncrement);
-            }
-            hash_table->Put(hash_state->m_Hash, dmHashContainer().m_HashStates[hash_state->m_ReverseHashEntryIndex]);
-        }
-        else
+        const ReverseHashEntry& entry = dmHashContainer().m_HashStates[hash_state->m_ReverseHashEntryIndex];
+        if (!ReverseHashContainer::PutEntry(dmHashContainer().GetShard(hash_state->m_Hash), hash_state->m_Hash, entry))
         {
-            free(dmHashContainer().m_HashStates[hash_state->m_ReverseHashEntryIndex].m_Value);
+            free(entry.m_Value);
         }
         dmHashContainer().FreeReverseHashStatesSlot(hash_state->m_ReverseHashEntryIndex);
         hash_state->m_ReverseHashEntryIndex = 0;
@@ -530,15 +590,7 @@ void dmHashUpdateBuffer64(HashState64* hash_state, const void* buffer, uint32_t
 
     while(len >= 8)
     {
-        uint64_t k;
-        k  = uint64_t(data[0]);
-        k |= uint64_t(data[1]) << 8;
-        k |= uint64_t(data[2]) << 16;
-        k |= uint64_t(data[3]) << 24;
-        k |= uint64_t(data[4]) << 32;
-        k |= uint64_t(data[5]) << 40;
-        k |= uint64_t(data[6]) << 48;
-        k |= uint64_t(data[7]) << 56;
+        uint64_t k = ReadWord64(data);
 
         mmix(hash_state->m_Hash, k);
 
@@ -569,18 +621,10 @@ uint64_t dmHashFinal64(HashState64* hash_state)
     if (dmHashContainer().m_Enabled && hash_state->m_ReverseHashEntryIndex && hash_state->m_Size <= DMHASH_MAX_REVERSE_LENGTH)
     {
         DM_MUTEX_SCOPED_LOCK(dmHashContainer().m_Mutex);
-        dmHashTable64<ReverseHashEntry>* hash_table = &dmHashContainer().m_HashTable64Entries;
-        if (hash_table->Get(hash_state->m_Hash) == 0)
-        {
-            if (hash_table->Full())
-            {
-                hash_table->SetCapacity(dmHashContainer().m_HashTableSize, hash_table->Capacity() + dmHashContainer().m_HashTableCapacityIncrement);
-            }
-            hash_table->Put(hash_state->m_Hash, dmHashContainer().m_HashStates[hash_state->m_ReverseHashEntryIndex]);
-        }
-        else
+        const ReverseHashEntry& entry = dmHashContainer().m_HashStates[hash_state->m_ReverseHashEntryIndex];
+        if (!ReverseHashContainer::PutEntry(dmHashContainer().GetShard(hash_state->m_Hash), hash_state->m_Hash, entry))
         {
-            free(dmHashContainer().m_HashStates[hash_state->m_ReverseHashEntryIndex].m_Value);
+            free(entry.m_Value);
         }
         dmHashContainer().FreeReverseHashStatesSlot(hash_state->m_ReverseHashEntryIndex);
         hash_state->m_ReverseHashEntryIndex = 0;
@@ -604,8 +648,9 @@ DM_DLLEXPORT const void* dmHashReverse32(uint32_t hash, uint32_t* length)
 {
     if (dmHashContainer().m_Enabled)
     {
-        DM_MUTEX_SCOPED_LOCK(dmHashContainer().m_Mutex);
-        ReverseHashEntry* reverse = dmHashContainer().m_HashTable32Entries.Get(hash);
+        ReverseHashShard32& shard = dmHashContainer().GetShard(hash);
+        DM_MUTEX_SCOPED_LOCK(shard.m_Mutex);
+        ReverseHashEntry* reverse = shard.m_Entries.Get(hash);
         if (reverse)
         {
             if (length)
@@ -622,8 +667,9 @@ DM_DLLEXPORT const void* dmHashReverse32Alloc(dmAllocator* allocator, uint32_t h
 {
     if (dmHashContainer().m_Enabled)
     {
-        DM_MUTEX_SCOPED_LOCK(dmHashContainer().m_Mutex);
-        ReverseHashEntry* reverse = dmHashContainer().m_HashTable32Entries.Get(hash);
+        ReverseHashShard32& shard = dmHashContainer().GetShard(hash);
+        DM_MUTEX_SCOPED_LOCK(shard.m_Mutex);
+        ReverseHashEntry* reverse = shard.m_Entries.Get(hash);
         if (reverse)
         {
             if (length)
@@ -647,8 +693,9 @@ DM_DLLEXPORT const void* dmHashReverse64(uint64_t hash, uint32_t* length)
 {
     if (dmHashContainer().m_Enabled)
     {
-        DM_MUTEX_SCOPED_LOCK(dmHashContainer().m_Mutex);
-        ReverseHashEntry* reverse = dmHashContainer().m_HashTable64Entries.Get(hash);
+        ReverseHashShard64& shard = dmHashContainer().GetShard(hash);
+        DM_MUTEX_SCOPED_LOCK(shard.m_Mutex);
+        ReverseHashEntry* reverse = shard.m_Entries.Get(hash);
         if (reverse)
         {
             if (length)
@@ -665,8 +712,9 @@ DM_DLLEXPORT const void* dmHashReverse64Alloc(dmAllocator* allocator, uint64_t h
 {
     if (dmHashContainer().m_Enabled)
     {
-        DM_MUTEX_SCOPED_LOCK(dmHashContainer().m_Mutex);
-        ReverseHashEntry* reverse = dmHashContainer().m_HashTable64Entries.Get(hash);
+        ReverseHashShard64& shard = dmHashContainer().GetShard(hash);
+        DM_MUTEX_SCOPED_LOCK(shard.m_Mutex);
+        ReverseHashEntry* reverse = shard.m_Entries.Get(hash);
         if (reverse)
         {
             if (length)
@@ -690,12 +738,13 @@ DM_DLLEXPORT void dmHashReverseErase32(uint32_t hash)
 {
     if (dmHashContainer().m_Enabled)
     {
-        DM_MUTEX_SCOPED_LOCK(dmHashContainer().m_Mutex);
-        ReverseHashEntry* reverse = dmHashContainer().m_HashTable32Entries.Get(hash);
+        ReverseHashShard32& shard = dmHashContainer().GetShard(hash);
+        DM_MUTEX_SCOPED_LOCK(shard.m_Mutex);
+        ReverseHashEntry* reverse = shard.m_Entries.Get(hash);
         if (reverse)
         {
             free(reverse->m_Value);
-            dmHashContainer().m_HashTable32Entries.Erase(hash);
+            shard.m_Entries.Erase(hash);
         }
     }
 }
@@ -704,12 +753,13 @@ DM_DLLEXPORT void dmHashReverseErase64(uint64_t hash)
 {
     if (dmHashContainer().m_Enabled)
     {
-        DM_MUTEX_SCOPED_LOCK(dmHashContainer().m_Mutex);
-        ReverseHashEntry* reverse = dmHashContainer().m_HashTable64Entries.Get(hash);
+        ReverseHashShard64& shard = dmHashContainer().GetShard(hash);
+        DM_MUTEX_SCOPED_LOCK(shard.m_Mutex);
+        ReverseHashEntry* reverse = shard.m_Entries.Get(hash);
         if (reverse)
         {
             free(reverse->m_Value);
-            dmHashContainer().m_HashTable64Entries.Erase(hash);
+            shard.m_Entries.Erase(hash);
         }
     }
 }
@@ -35,7 +35,7 @@ namespace dmHttpCache
     // Magic file header for index file
     const uint32_t MAGIC = 0xCAAAAAAC;
     // Current index file version
-    const uint32_t VERSION = 7;
+    const uint32_t VERSION = 8;
 
     // Maximum number of cache entry creations in flight
     const uint32_t MAX_CACHE_CREATORS = 16;
@@ -69,14 +69,14 @@ namespace dmHttpCache
 
     /*
      * Disk (index) representation of a cache entry
+     * The entry is followed by m_URILength bytes of URI string (without null termination),
+     * padded to FILE_ENTRY_ALIGNMENT. Storing the URI in full would make each record several kilobytes.
      */
     struct FileEntry
     {
         uint64_t m_UriHash;
         // ETag string
         char     m_ETag[MAX_TAG_LEN];
-        // Path string
-        char     m_URI[MAX_URI_LEN];
         // The content hash is the hash of URI and ETag.
         uint64_t m_IdentifierHash;
         // Last accessed time
@@ -85,8 +85,18 @@ namespace dmHttpCache
         uint64_t m_Expires;
         // Checksum
         uint64_t m_Checksum;
+        // Length of the path string following the entry
+        uint32_t m_URILength;
+        uint32_t m_Pad;
     };
 
+    const uint32_t FILE_ENTRY_ALIGNMENT = 8;
+
+    static uint32_t FileEntryURISize(uint32_t uri_length)
+    {
+        return (uri_length + FILE_ENTRY_ALIGNMENT - 1) & ~(FILE_ENTRY_ALIGNMENT - 1);
+    }
+
     /*
      * Cache entry creation state
      */
@@ -243,30 +253,53 @@ namespace dmHttpCache
                 }
                 else
                 {
-                    uint32_t n_entries = (size - sizeof(IndexHeader)) / sizeof(FileEntry);
-                    FileEntry* entries = (FileEntry*) (((uintptr_t) buffer) + sizeof(IndexHeader));
-                    uint32_t capacity = n_entries + 128;
+                    const uint8_t* cursor = (const uint8_t*) buffer + sizeof(IndexHeader);
+                    const uint8_t* end = (const uint8_t*) buffer + size;
+
+                    // The records are variable sized, so we estimate the entry count from the smallest possible record
+                    uint32_t capacity = (uint32_t) ((end - cursor) / (sizeof(FileEntry) + FILE_ENTRY_ALIGNMENT)) + 128;
                     c->m_CacheTable.SetCapacity(2 * capacity / 3, capacity);
                     uint64_t current_time = dmTime::GetTime();
-                    for (uint32_t i = 0; i < n_entries; ++i)
+                    while ((size_t) (end - cursor) >= sizeof(FileEntry))
                     {
-                        if (entries[i].m_LastAccessed + c->m_MaxCacheEntryAge >= current_time)
+                        FileEntry file_entry;
+                        memcpy(&file_entry, cursor, sizeof(file_entry));
+                        cursor += sizeof(FileEntry);
+
+                        uint32_t uri_size = FileEntryURISize(file_entry.m_URILength);
+                        if (file_entry.m_URILength >= MAX_URI_LEN || (size_t) (end - cursor) < uri_size)
+                        {
+                            dmLogError("Corrupt cache index entry in '%s'", cache_file);
+                            break;
+                        }
+
+                        if (file_entry.m_LastAccessed + c->m_MaxCacheEntryAge >= current_time)
                         {
                             // Keep cache entry, ie within max age
+                            char uri[MAX_URI_LEN];
+                            memcpy(uri, cursor, file_entry.m_URILength);
+                            uri[file_entry.m_URILength] = '\0';
+
                             Entry e;
-                            memcpy(e.m_Info.m_ETag, entries[i].m_ETag, sizeof(e.m_Info.m_ETag));
-                            e.m_Info.m_URI = dmPoolAllocator::Duplicate(c->m_StringAllocator, entries[i].m_URI);
-                            e.m_Info.m_IdentifierHash = entries[i].m_IdentifierHash;
-                            e.m_Info.m_LastAccessed = entries[i].m_LastAccessed;
-                            e.m_Info.m_Expires = entries[i].m_Expires;
-                            e.m_Info.m_Checksum = entries[i].m_Checksum;
-                            c->m_CacheTable.Put(entries[i].m_UriHash, e);
+                            memcpy(e.m_Info.m_ETag, file_entry.m_ETag, sizeof(e.m_Info.m_ETag));
+                            e.m_Info.m_URI = dmPoolAllocator::Duplicate(c->m_StringAllocator, uri);
+                            e.m_Info.m_IdentifierHash = file_entry.m_IdentifierHash;
+                            e.m_Info.m_LastAccessed = file_entry.m_LastAccessed;
+                            e.m_Info.m_Expires = file_entry.m_Expires;
+                            e.m_Info.m_Checksum = file_entry.m_Checksum;
+                            if (c->m_CacheTable.Full())
+                            {
+                                uint32_t new_capacity = c->m_CacheTable.Capacity() + 128;
+                                c->m_CacheTable.SetCapacity(2 * new_capacity / 3, new_capacity);
+                            }
+                            c->m_CacheTable.Put(file_entry.m_UriHash, e);
                         }
                         else
                         {
                             // Remove old cache entry
-                            RemoveCachedContentFile(c, entries[i].m_IdentifierHash);
+                            RemoveCachedContentFile(c, file_entry.m_IdentifierHash);
                         }
+                        cursor += uri_size;
                     }
                 }
             }
@@ -305,17 +338,26 @@ namespace dmHttpCache
         FileEntry file_entry;
         memset(&file_entry, 0, sizeof(file_entry));
 
+        uint32_t uri_length = dmMath::Min((uint32_t) strlen(entry->m_Info.m_URI), MAX_URI_LEN - 1);
+        uint32_t uri_size = FileEntryURISize(uri_length);
+
         file_entry.m_UriHash = *key;
         memcpy(file_entry.m_ETag, entry->m_Info.m_ETag, sizeof(file_entry.m_ETag));
-        dmStrlCpy(file_entry.m_URI, entry->m_Info.m_URI, sizeof(file_entry.m_URI));
         file_entry.m_IdentifierHash = entry->m_Info.m_IdentifierHash;
         file_entry.m_LastAccessed = entry->m_Info.m_LastAccessed;
         file_entry.m_Expires = entry->m_Info.m_Expires;
         file_entry.m_Checksum = entry->m_Info.m_Checksum;
+        file_entry.m_URILength = uri_length;
+
+        char uri[MAX_URI_LEN];
+        memset(uri, 0, uri_size);
+        memcpy(uri, entry->m_Info.m_URI, uri_length);
 
         dmHashUpdateBuffer64(&context->m_HashState, &file_entry, sizeof(file_entry));
+        dmHashUpdateBuffer64(&context->m_HashState, uri, uri_size);
         size_t n_written = fwrite(&file_entry, 1, sizeof(file_entry), context->m_File);
-        if (n_written != sizeof(file_entry))
+        n_written += fwrite(uri, 1, uri_size, context->m_File);
+        if (n_written != sizeof(file_entry) + uri_size)
         {
             context->m_Error = true;
         }
@@ -629,9 +671,9 @@ namespace dmHttpCache
 
     Result GetETag(HCache cache, const char* uri, char* tag_buffer, uint32_t tag_buffer_len)
     {
-        dmMutex::ScopedLock lock(cache->m_Mutex);
-
         uint64_t uri_hash = dmHashString64(uri);
+
+        dmMutex::ScopedLock lock(cache->m_Mutex);
         Entry* entry = cache->m_CacheTable.Get(uri_hash);
         if (entry != 0)
         {
@@ -650,9 +692,9 @@ namespace dmHttpCache
 
     Result GetInfo(HCache cache, const char* uri, EntryInfo* info)
     {
-        dmMutex::ScopedLock lock(cache->m_Mutex);
-
         uint64_t uri_hash = dmHashString64(uri);
+
+        dmMutex::ScopedLock lock(cache->m_Mutex);
         Entry* entry = cache->m_CacheTable.Get(uri_hash);
         if (entry != 0)
         {
@@ -668,8 +710,6 @@ namespace dmHttpCache
 
     Result Get(HCache cache, const char* uri, const char* etag, FILE** file, uint32_t* file_size, uint64_t* checksum)
     {
-        dmMutex::ScopedLock lock(cache->m_Mutex);
-
         HashState64 hash_state;
         dmHashInit64(&hash_state, false);
         dmHashUpdateBuffer64(&hash_state, uri, strlen(uri));
@@ -677,51 +717,68 @@ namespace dmHttpCache
         uint64_t identifier_hash = dmHashFinal64(&hash_state);
 
         uint64_t uri_hash = dmHashString64(uri);
-        Entry* entry = cache->m_CacheTable.Get(uri_hash);
-        if (entry != 0 && entry->m_Info.m_IdentifierHash == identifier_hash)
+
+        uint64_t entry_checksum;
         {
+            dmMutex::ScopedLock lock(cache->m_Mutex);
+
+            Entry* entry = cache->m_CacheTable.Get(uri_hash);
+            if (entry == 0 || entry->m_Info.m_IdentifierHash != identifier_hash)
+            {
+                return RESULT_NO_ENTRY;
+            }
+
             if (entry->m_WriteLock)
             {
                 dmLogWarning("Cache entry locked.");
                 return RESULT_LOCKED;
             }
 
+            // The read lock keeps the content file from being replaced, so it can be opened
+            // without holding the cache lock
             entry->m_Info.m_LastAccessed = dmTime::GetTime();
+            entry->m_ReadLockCount++;
+            entry_checksum = entry->m_Info.m_Checksum;
+        }
 
-            char path[DMPATH_MAX_PATH];
-            ContentFilePath(cache, identifier_hash, path, sizeof(path));
-            FILE* f = fopen(path, "rb");
-            if (f)
+        char path[DMPATH_MAX_PATH];
+        ContentFilePath(cache, identifier_hash, path, sizeof(path));
+        FILE* f = fopen(path, "rb");
+        if (f)
+        {
+            if (file_size)
             {
-                if (file_size)
-                {
-                    fseek(f, 0L, SEEK_END);
-                    *file_size = ftell(f);
-                    fseek(f, 0L, SEEK_SET);
-                }
-
-                *file = f;
-                entry->m_ReadLockCount++;
-                *checksum = entry->m_Info.m_Checksum;
-                return RESULT_OK;
+                fseek(f, 0L, SEEK_END);
+                *file_size = ftell(f);
+                fseek(f, 0L, SEEK_SET);
             }
-            else
+
+            *file = f;
+            *checksum = entry_checksum;
+            return RESULT_OK;
+        }
+        else
+        {
+            dmLogError("Unable to open %s", path);
+
+            dmMutex::ScopedLock lock(cache->m_Mutex);
+            Entry* entry = cache->m_CacheTable.Get(uri_hash);
+            assert(entry && entry->m_ReadLockCount > 0);
+            --entry->m_ReadLockCount;
+            if (entry->m_ReadLockCount == 0)
             {
-                dmLogError("Unable to open %s", path);
                 // Remove invalid cache entry
                 cache->m_CacheTable.Erase(uri_hash);
-                return RESULT_NO_ENTRY;
             }
+            return RESULT_NO_ENTRY;
         }
-
-        return RESULT_NO_ENTRY;
     }
 
     Result SetVerified(HCache cache, const char* uri, bool verified)
     {
-        dmMutex::ScopedLock lock(cache->m_Mutex);
-
         uint64_t uri_hash = dmHashString64(uri);
+
+        dmMutex::ScopedLock lock(cache->m_Mutex);
         Entry* entry = cache->m_CacheTable.Get(uri_hash);
         if (entry != 0)
         {
@@ -736,8 +793,6 @@ namespace dmHttpCache
 
     Result Release(HCache cache, const char* uri, const char* etag, FILE* file)
     {
-        dmMutex::ScopedLock lock(cache->m_Mutex);
-
         HashState64 hash_state;
         dmHashInit64(&hash_state, false);
         dmHashUpdateBuffer64(&hash_state, uri, strlen(uri));
@@ -745,14 +800,17 @@ namespace dmHttpCache
         uint64_t identifier_hash = dmHashFinal64(&hash_state);
 
         uint64_t uri_hash = dmHashString64(uri);
+
+        // Close the file outside of the cache lock
+        fclose(file);
+
+        dmMutex::ScopedLock lock(cache->m_Mutex);
         Entry* entry = cache->m_CacheTable.Get(uri_hash);
         assert(entry);
         assert(entry->m_Info.m_IdentifierHash == identifier_hash);
         assert(strcmp(uri, entry->m_Info.m_URI) == 0);
         assert(entry->m_ReadLockCount > 0);
         --entry->m_ReadLockCount;
-
-        fclose(file);
         return RESULT_OK;
     }
 
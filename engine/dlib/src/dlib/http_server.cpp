@@ -42,6 +42,7 @@ namespace dmHttpServer
         Server()
         {
             m_ServerSocket = dmSocket::INVALID_SOCKET_HANDLE;
+            m_Poller = 0;
             m_Reconnect = 0;
         }
         dmSocket::Address   m_Address;
@@ -54,6 +55,9 @@ namespace dmHttpServer
         uint64_t            m_ConnectionTimeout;
         dmArray<Connection> m_Connections;
         dmSocket::Socket    m_ServerSocket;
+        // The server socket and the connections are registered in the poller
+        dmSocket::HPoller   m_Poller;
+        dmArray<dmSocket::PollerEvent> m_PollerEvents;
         // Receive and send buffer
         char                m_Buffer[BUFFER_SIZE];
 
@@ -108,6 +112,7 @@ namespace dmHttpServer
     {
         if (server->m_ServerSocket != dmSocket::INVALID_SOCKET_HANDLE)
         {
+            dmSocket::PollerRemove(server->m_Poller, server->m_ServerSocket);
             dmSocket::Delete(server->m_ServerSocket);
             server->m_ServerSocket = dmSocket::INVALID_SOCKET_HANDLE;
         }
@@ -158,6 +163,13 @@ namespace dmHttpServer
             return RESULT_SOCKET_ERROR;
         }
 
+        r = dmSocket::PollerAdd(server->m_Poller, socket, dmSocket::POLLER_FLAG_READ, 0);
+        if (r != dmSocket::RESULT_OK)
+        {
+            dmSocket::Delete(socket);
+            return RESULT_SOCKET_ERROR;
+        }
+
         server->m_Address = address;
         server->m_Port = actual_port;
         server->m_ServerSocket = socket;
@@ -173,8 +185,15 @@ namespace dmHttpServer
             return RESULT_ERROR_INVAL;
 
         Server* ret = new Server();
+        if (dmSocket::NewPoller(&ret->m_Poller) != dmSocket::RESULT_OK)
+        {
+            delete ret;
+            return RESULT_SOCKET_ERROR;
+        }
+
         if (Connect(ret, port) != RESULT_OK)
         {
+            dmSocket::DeletePoller(ret->m_Poller);
             delete ret;
             return RESULT_SOCKET_ERROR;
         }
@@ -184,6 +203,8 @@ namespace dmHttpServer
         ret->m_Userdata = params->m_Userdata;
         ret->m_ConnectionTimeout = params->m_ConnectionTimeout * 1000000U;
         ret->m_Connections.SetCapacity(params->m_MaxConnections);
+        ret->m_PollerEvents.SetCapacity(params->m_MaxConnections + 1);
+        ret->m_PollerEvents.SetSize(params->m_MaxConnections + 1);
 
         *server = ret;
         return RESULT_OK;
@@ -193,9 +214,20 @@ namespace dmHttpServer
     {
         // TODO: Shutdown connections
         dmSocket::Delete(server->m_ServerSocket);
+        dmSocket::DeletePoller(server->m_Poller);
         delete server;
     }
 
+    static void CloseConnection(Server* server, uint32_t index)
+    {
+        Connection* connection = &server->m_Connections[index];
+        dmSocket::PollerRemove(server->m_Poller, connection->m_Socket);
+        dmSocket::Shutdown(connection->m_Socket, dmSocket::SHUTDOWNTYPE_READWRITE);
+        dmSocket::Delete(connection->m_Socket);
+        connection->m_Socket = dmSocket::INVALID_SOCKET_HANDLE;
+        server->m_Connections.EraseSwap(index);
+    }
+
     static void HandleRequest(void* user_data, const char* request_method, const char* resource, int major, int minor)
     {
         InternalRequest* req = (InternalRequest*) user_data;
@@ -589,19 +621,37 @@ bail:
             Connect(server, server->m_Port);
             server->m_Reconnect = 0;
         }
-        dmSocket::Selector selector;
-        dmSocket::SelectorSet(&selector, dmSocket::SELECTOR_KIND_READ, server->m_ServerSocket);
 
-        dmSocket::Result r = dmSocket::Select(&selector, 0);
+        uint64_t current_time = dmTime::GetTime();
+
+        // Iterate over persistent connections, timeout phase
+        // This is done before the wait, so that no events are returned for closed sockets
+        for (uint32_t i = 0; i < server->m_Connections.Size(); ++i)
+        {
+            Connection* connection = &server->m_Connections[i];
+            uint64_t time_diff = current_time - connection->m_ConnectionTimeStart;
+            if (time_diff > server->m_ConnectionTimeout)
+            {
+                CloseConnection(server, i);
+                --i;
+            }
+        }
 
+        uint32_t event_count = 0;
+        dmSocket::Result r = dmSocket::PollerWait(server->m_Poller, server->m_PollerEvents.Begin(), server->m_PollerEvents.Size(), 0, &event_count);
         if (r != dmSocket::RESULT_OK)
         {
             return RESULT_SOCKET_ERROR;
         }
 
         // Check for new connections
-        if (dmSocket::SelectorIsSet(&selector, dmSocket::SELECTOR_KIND_READ, server->m_ServerSocket))
+        for (uint32_t e = 0; e < event_count; ++e)
         {
+            if (server->m_PollerEvents[e].m_Socket != server->m_ServerSocket)
+            {
+                continue;
+            }
+
             dmSocket::Address address;
             dmSocket::Socket client_socket;
             r = dmSocket::Accept(server->m_ServerSocket, &address, &client_socket);
@@ -613,6 +663,12 @@ bail:
                     dmSocket::Shutdown(client_socket, dmSocket::SHUTDOWNTYPE_READWRITE);
                     dmSocket::Delete(client_socket);
                 }
+                else if (dmSocket::PollerAdd(server->m_Poller, client_socket, dmSocket::POLLER_FLAG_READ, 0) != dmSocket::RESULT_OK)
+                {
+                    dmLogWarning("Unable to poll client connection in http server");
+                    dmSocket::Shutdown(client_socket, dmSocket::SHUTDOWNTYPE_READWRITE);
+                    dmSocket::Delete(client_socket);
+                }
                 else
                 {
                     dmSocket::SetNoDelay(client_socket, true);
@@ -629,51 +685,29 @@ bail:
             }
         }
 
-        dmSocket::SelectorZero(&selector);
-
-        uint64_t current_time = dmTime::GetTime();
-
-        // Iterate over persistent connections, timeout phase
-        for (uint32_t i = 0; i < server->m_Connections.Size(); ++i)
+        // Handle the connections with pending data (or errors, which the receive reports)
+        for (uint32_t e = 0; e < event_count; ++e)
         {
-            Connection* connection = &server->m_Connections[i];
-            uint64_t time_diff = current_time - connection->m_ConnectionTimeStart;
-            if (time_diff > server->m_ConnectionTimeout)
+            dmSocket::Socket socket = server->m_PollerEvents[e].m_Socket;
+            if (socket == server->m_ServerSocket)
             {
-                dmSocket::Shutdown(connection->m_Socket, dmSocket::SHUTDOWNTYPE_READWRITE);
-                dmSocket::Delete(connection->m_Socket);
-                connection->m_Socket = dmSocket::INVALID_SOCKET_HANDLE;
-                server->m_Connections.EraseSwap(i);
-                --i;
+                continue;
             }
-        }
 
-        // Iterate over persistent connections, select phase
-        for (uint32_t i = 0; i < server->m_Connections.Size(); ++i)
-        {
-            Connection* connection = &server->m_Connections[i];
-            dmSocket::SelectorSet(&selector, dmSocket::SELECTOR_KIND_READ, connection->m_Socket);
-        }
-
-        r = dmSocket::Select(&selector, 0);
-        if (r != dmSocket::RESULT_OK)
-            return RESULT_SOCKET_ERROR;
-
-        // Iterate over persistent connections, handle phase
-        for (uint32_t i = 0; i < server->m_Connections.Size(); ++i)
-        {
-            Connection* connection = &server->m_Connections[i];
-            if (dmSocket::SelectorIsSet(&selector, dmSocket::SELECTOR_KIND_READ, connection->m_Socket))
+            for (uint32_t i = 0; i < server->m_Connections.Size(); ++i)
             {
-                bool keep_connection =  HandleConnection(server, connection);
+                Connection* connection = &server->m_Connections[i];
+                if (connection->m_Socket != socket)
+                {
+                    continue;
+                }
+
+                bool keep_connection = HandleConnection(server, connection);
                 if (!keep_connection)
                 {
-                    dmSocket::Shutdown(connection->m_Socket, dmSocket::SHUTDOWNTYPE_READWRITE);
-                    dmSocket::Delete(connection->m_Socket);
-                    connection->m_Socket = dmSocket::INVALID_SOCKET_HANDLE;
-                    server->m_Connections.EraseSwap(i);
-                    --i;
+                    CloseConnection(server, i);
                 }
+                break;
             }
         }
         return RESULT_OK;
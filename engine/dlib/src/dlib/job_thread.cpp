@@ -14,8 +14,7 @@
 
 
 #include <stdio.h> // printf
-
-#include <dmsdk/dlib/array.h>
+#include <string.h> // memset
 
 #include <dmsdk/dlib/array.h>
 #include <dmsdk/dlib/atomic.h>
@@ -28,6 +27,7 @@
 #if defined(DM_HAS_THREADS)
     #include <dmsdk/dlib/condition_variable.h>
     #include <dmsdk/dlib/mutex.h>
+    #include <dmsdk/dlib/spinlock.h>
 #endif
 
 #include "jc/ringbuffer.h"
@@ -57,14 +57,150 @@ struct JobThreadContext
 #endif
 };
 
+struct GroupJob
+{
+    void*       m_Context;
+    void*       m_Data;
+    FProcess    m_Process;
+    JobGroup*   m_Group;
+};
+
+// Double ended queue of group jobs. The owning worker pushes and pops at the back,
+// while other threads steal from the front
+struct JobQueue
+{
+    JobQueue() : m_Front(0), m_Count(0) {}
+
+    dmArray<GroupJob>       m_Jobs; // Ring buffer with a power of two size
+    uint32_t                m_Front;
+    uint32_t                m_Count;
+#if defined(DM_HAS_THREADS)
+    dmSpinlock::Spinlock    m_Lock;
+#endif
+};
+
+struct JobWorker
+{
+    JobContext* m_Context;
+    JobQueue    m_Queue;
+    uint32_t    m_Index;
+};
+
 struct JobContext
 {
 #if defined(DM_HAS_THREADS)
     dmArray<dmThread::Thread> m_Threads;
+    dmThread::TlsKey          m_WorkerKey;
 #endif
+    dmArray<JobWorker*> m_Workers;
+    JobQueue            m_Queue;            // Group jobs pushed from threads that aren't workers
+    int32_atomic_t      m_GroupJobCount;    // Number of queued (not yet started) group jobs
+    int32_atomic_t      m_SleepingCount;    // Number of workers waiting for the wakeup condition
     JobThreadContext    m_ThreadContext;
 };
 
+// The engine job context, shared with the extensions
+static HContext g_DefaultContext = 0;
+
+JobThreadCreationParams::JobThreadCreationParams()
+{
+    memset(this, 0, sizeof(*this));
+}
+
+static void QueuePushBack(JobQueue* queue, const GroupJob& job)
+{
+#if defined(DM_HAS_THREADS)
+    DM_SPINLOCK_SCOPED_LOCK(queue->m_Lock);
+#endif
+    uint32_t size = queue->m_Jobs.Size();
+    if (queue->m_Count == size)
+    {
+        uint32_t new_size = size ? size * 2 : 64;
+        dmArray<GroupJob> jobs;
+        jobs.SetCapacity(new_size);
+        jobs.SetSize(new_size);
+        for (uint32_t i = 0; i < queue->m_Count; ++i)
+            jobs[i] = queue->m_Jobs[(queue->m_Front + i) & (size - 1)];
+        queue->m_Jobs.Swap(jobs);
+        queue->m_Front = 0;
+        size = new_size;
+    }
+    queue->m_Jobs[(queue->m_Front + queue->m_Count) & (size - 1)] = job;
+    queue->m_Count++;
+}
+
+static bool QueuePopBack(JobQueue* queue, GroupJob* job)
+{
+#if defined(DM_HAS_THREADS)
+    DM_SPINLOCK_SCOPED_LOCK(queue->m_Lock);
+#endif
+    if (queue->m_Count == 0)
+        return false;
+    queue->m_Count--;
+    *job = queue->m_Jobs[(queue->m_Front + queue->m_Count) & (queue->m_Jobs.Size() - 1)];
+    return true;
+}
+
+static bool QueuePopFront(JobQueue* queue, GroupJob* job)
+{
+#if defined(DM_HAS_THREADS)
+    DM_SPINLOCK_SCOPED_LOCK(queue->m_Lock);
+#endif
+    if (queue->m_Count == 0)
+        return false;
+    *job = queue->m_Jobs[queue->m_Front];
+    queue->m_Front = (queue->m_Front + 1) & (queue->m_Jobs.Size() - 1);
+    queue->m_Count--;
+    return true;
+}
+
+static JobWorker* GetCurrentWorker(JobContext* context)
+{
+#if defined(DM_HAS_THREADS)
+    return (JobWorker*) dmThread::GetTlsValue(context->m_WorkerKey);
+#else
+    return 0;
+#endif
+}
+
+// Takes a job from the worker's own queue (newest first), then the shared queue, then steals from the other workers (oldest first)
+static bool PopGroupJob(JobContext* context, JobWorker* self, GroupJob* job)
+{
+    if (dmAtomicGet32(&context->m_GroupJobCount) == 0)
+        return false;
+
+    bool found = (self && QueuePopBack(&self->m_Queue, job)) || QueuePopFront(&context->m_Queue, job);
+
+    uint32_t worker_count = context->m_Workers.Size();
+    uint32_t start = self ? self->m_Index + 1 : 0;
+    for (uint32_t i = 0; !found && i < worker_count; ++i)
+    {
+        JobWorker* worker = context->m_Workers[(start + i) % worker_count];
+        if (worker != self)
+            found = QueuePopFront(&worker->m_Queue, job);
+    }
+
+    if (found)
+        dmAtomicDecrement32(&context->m_GroupJobCount);
+    return found;
+}
+
+static void RunGroupJob(const GroupJob& job)
+{
+    DM_PROFILE("GroupJob");
+    job.m_Process(job.m_Context, job.m_Data);
+
+    // The job counts in all the parent groups as well.
+    // Read the parent first, since the group may go away as soon as it is done
+    JobGroup* group = job.m_Group;
+    while (group)
+    {
+        JobGroup* parent = group->m_Parent;
+        dmAtomicDecrement32(&group->m_Pending);
+        group = parent;
+    }
+}
+
 static void PutWork(JobThreadContext* ctx, const JobItem* item)
 {
 #if defined(DM_HAS_THREADS)
@@ -86,11 +222,22 @@ static void PutDone(JobThreadContext* ctx, JobItem* item)
 }
 
 #if defined(DM_HAS_THREADS)
-static void JobThread(void* _ctx)
+static void JobThread(void* _worker)
 {
-    JobThreadContext* ctx = (JobThreadContext*)_ctx;
+    JobWorker* worker = (JobWorker*)_worker;
+    JobContext* context = worker->m_Context;
+    JobThreadContext* ctx = &context->m_ThreadContext;
+    dmThread::SetTlsValue(context->m_WorkerKey, worker);
+
     while (true)
     {
+        GroupJob group_job;
+        if (PopGroupJob(context, worker, &group_job))
+        {
+            RunGroupJob(group_job);
+            continue;
+        }
+
         JobItem item = {};
         {
             DM_MUTEX_SCOPED_LOCK(ctx->m_Mutex);
@@ -98,11 +245,17 @@ static void JobThread(void* _ctx)
             if (!ctx->m_Run)
                 break;
 
-            while(ctx->m_Work.Empty())
+            if (ctx->m_Work.Empty())
             {
-                dmConditionVariable::Wait(ctx->m_WakeupCond, ctx->m_Mutex);
-                if (!ctx->m_Run)
-                    return;
+                // The pushing thread increments the job count before it checks the sleeping count,
+                // so either it sees us sleeping and signals, or we see the job here
+                dmAtomicIncrement32(&context->m_SleepingCount);
+                while (ctx->m_Run && ctx->m_Work.Empty() && dmAtomicGet32(&context->m_GroupJobCount) == 0)
+                {
+                    dmConditionVariable::Wait(ctx->m_WakeupCond, ctx->m_Mutex);
+                }
+                dmAtomicDecrement32(&context->m_SleepingCount);
+                continue;
             }
             item = ctx->m_Work.Pop();
         }
@@ -130,20 +283,39 @@ static void UpdateSingleThread(JobThreadContext* ctx)
 HContext Create(const JobThreadCreationParams& create_params)
 {
     JobContext* context = new JobContext;
+    context->m_GroupJobCount = 0;
+    context->m_SleepingCount = 0;
 #if defined(DM_HAS_THREADS)
     context->m_ThreadContext.m_Mutex = dmMutex::New();
     context->m_ThreadContext.m_WakeupCond = dmConditionVariable::New();
     context->m_ThreadContext.m_Run = true;
+    context->m_WorkerKey = dmThread::AllocTls();
+    dmSpinlock::Create(&context->m_Queue.m_Lock);
+
+    uint32_t thread_count = create_params.m_ThreadCount;
+    context->m_Workers.SetCapacity(thread_count);
+    context->m_Workers.SetSize(thread_count);
+    for (uint32_t i = 0; i < thread_count; ++i)
+    {
+        JobWorker* worker = new JobWorker;
+        worker->m_Context = context;
+        worker->m_Index = i;
+        dmSpinlock::Create(&worker->m_Queue.m_Lock);
+        context->m_Workers[i] = worker;
+    }
 
-    uint32_t thread_count = dmMath::Min(create_params.m_ThreadCount, DM_MAX_JOB_THREAD_COUNT);
     context->m_Threads.SetCapacity(thread_count);
     context->m_Threads.SetSize(thread_count);
 
-    for (int i = 0; i < thread_count; ++i)
+    for (uint32_t i = 0; i < thread_count; ++i)
     {
+        const char* name = i < DM_MAX_JOB_THREAD_COUNT ? create_params.m_ThreadNames[i] : 0;
+        if (!name)
+            name = create_params.m_ThreadNames[0] ? create_params.m_ThreadNames[0] : "JobThread";
+
         char name_buf[128];
-        dmSnPrintf(name_buf, sizeof(name_buf), "%s_%d", create_params.m_ThreadNames[i], i);
-        context->m_Threads[i] = dmThread::New(JobThread, 0x80000, (void*)&context->m_ThreadContext, name_buf);
+        dmSnPrintf(name_buf, sizeof(name_buf), "%s_%d", name, i);
+        context->m_Threads[i] = dmThread::New(JobThread, 0x80000, (void*)context->m_Workers[i], name_buf);
     }
 #endif
     return context;
@@ -169,6 +341,14 @@ void Destroy(HContext context)
     }
     dmConditionVariable::Delete(context->m_ThreadContext.m_WakeupCond);
     dmMutex::Delete(context->m_ThreadContext.m_Mutex);
+    dmThread::FreeTls(context->m_WorkerKey);
+
+    for (uint32_t i = 0; i < context->m_Workers.Size(); ++i)
+    {
+        dmSpinlock::Destroy(&context->m_Workers[i]->m_Queue.m_Lock);
+        delete context->m_Workers[i];
+    }
+    dmSpinlock::Destroy(&context->m_Queue.m_Lock);
 #endif // DM_HAS_THREADS
 
     delete context;
@@ -231,4 +411,76 @@ void Update(HContext context)
     }
 }
 
+bool PlatformHasThreadSupport()
+{
+    return dmThread::PlatformHasThreadSupport();
+}
+
+void SetDefaultContext(HContext context)
+{
+    g_DefaultContext = context;
+}
+
+HContext GetDefaultContext()
+{
+    return g_DefaultContext;
+}
+
+void InitGroup(JobGroup* group, JobGroup* parent)
+{
+    group->m_Parent = parent;
+    group->m_Pending = 0;
+}
+
+void PushGroupJob(HContext context, JobGroup* group, FProcess process, void* user_context, void* data)
+{
+    GroupJob job;
+    job.m_Context = user_context;
+    job.m_Data = data;
+    job.m_Process = process;
+    job.m_Group = group;
+
+    for (JobGroup* g = group; g; g = g->m_Parent)
+        dmAtomicIncrement32(&g->m_Pending);
+
+    if (!context)
+    {
+        RunGroupJob(job);
+        return;
+    }
+
+    dmAtomicIncrement32(&context->m_GroupJobCount);
+
+    JobWorker* self = GetCurrentWorker(context);
+    QueuePushBack(self ? &self->m_Queue : &context->m_Queue, job);
+
+#if defined(DM_HAS_THREADS)
+    if (dmAtomicGet32(&context->m_SleepingCount) > 0)
+    {
+        DM_MUTEX_SCOPED_LOCK(context->m_ThreadContext.m_Mutex);
+        dmConditionVariable::Signal(context->m_ThreadContext.m_WakeupCond);
+    }
+#endif
+}
+
+bool IsGroupDone(JobGroup* group)
+{
+    return dmAtomicGet32(&group->m_Pending) == 0;
+}
+
+void WaitGroup(HContext context, JobGroup* group)
+{
+    DM_PROFILE("WaitGroup");
+    if (!context)
+        return; // The jobs were run when pushed
+
+    JobWorker* self = GetCurrentWorker(context);
+    while (dmAtomicGet32(&group->m_Pending) != 0)
+    {
+        GroupJob job;
+        if (PopGroupJob(context, self, &job))
+            RunGroupJob(job);
+    }
+}
+
 } // namespace dmJobThread
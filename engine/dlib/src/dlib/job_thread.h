@@ -16,27 +16,32 @@
 #define DM_JOB_THREAD_H
 
 #include <stdint.h>
+#include <dmsdk/dlib/job.h>
 
 namespace dmJobThread
 {
-    typedef struct JobContext* HContext;
-    typedef int (*FProcess)(void* context, void* data);
-    typedef void (*FCallback)(void* context, void* data, int result);
-
+    /// Number of thread names in JobThreadCreationParams. Not a limit on the thread count
     static const uint8_t DM_MAX_JOB_THREAD_COUNT = 8;
 
     struct JobThreadCreationParams
     {
+        JobThreadCreationParams();
+
+        /// Threads without a name use the first name
         const char* m_ThreadNames[DM_MAX_JOB_THREAD_COUNT];
-        uint8_t     m_ThreadCount;
+        uint32_t    m_ThreadCount;
     };
 
     HContext Create(const JobThreadCreationParams& create_params);
     void     Destroy(HContext context);
     void     Update(HContext context); // Flushes any items and calls PostProcess
-    void     PushJob(HContext context, FProcess process, FCallback callback, void* user_context, void* data);
-    uint32_t GetWorkerCount(HContext context);
     bool     PlatformHasThreadSupport();
+
+    /**
+     * Sets the context returned by GetDefaultContext(). The owner must call Update() on it every frame,
+     * and reset it to 0 before destroying it.
+     */
+    void     SetDefaultContext(HContext context);
 }
 
 #endif // DM_JOB_THREAD_H
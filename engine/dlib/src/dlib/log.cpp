@@ -47,6 +47,8 @@ namespace dmLog
 
 const char* LOG_OUTPUT_TRUNCATED_MESSAGE = "...\n[Output truncated]\n";
 const int MAX_LOG_FILE_SIZE = 1024 * 1024 * 32;
+// Maximum number of messages waiting for the log thread. Messages beyond this are dropped and counted
+const int MAX_PENDING_LOG_MESSAGES = 4096;
 
 struct dmLogConnection
 {
@@ -85,6 +87,9 @@ static dmLogServer* g_dmLogServer = 0;
 static LogSeverity g_LogLevel = LOG_SEVERITY_USER_DEBUG;
 static int g_TotalBytesLogged = 0;
 static FILE* g_LogFile = 0;
+static dmSpinlock::Spinlock g_LogFileLock; // Protects g_LogFile when the log thread is running
+static int32_atomic_t g_PendingMessages = 0;
+static int32_atomic_t g_DroppedMessages = 0;
 static dmSpinlock::Spinlock g_ListenerLock; // Protects the array of listener functions
 
 #if defined(DM_HAS_NO_GETENV)
@@ -320,7 +325,12 @@ static void DoLogPlatform(LogSeverity severity, const char* output, int output_l
 #elif !defined(ANDROID)
         fwrite(output, 1, output_len, stderr);
 #endif
+}
 
+// Writes to the log file. When the log thread is running, this is done on the log thread,
+// so that the flush doesn't stall the thread doing the logging
+static void DoLogFile(const char* output, int output_len)
+{
     if (dmLog::g_LogFile && dmLog::g_TotalBytesLogged < dmLog::MAX_LOG_FILE_SIZE) {
         dmLog::g_TotalBytesLogged += output_len;
         fwrite(output, 1, output_len, dmLog::g_LogFile);
@@ -355,9 +365,26 @@ static void dmLogDispatch(dmMessage::Message *message, void* user_ptr)
         return;
     }
 
+    dmAtomicDecrement32(&dmLog::g_PendingMessages);
+
+    int32_t dropped = dmAtomicStore32(&dmLog::g_DroppedMessages, 0);
+    if (dropped > 0)
+    {
+        char dropped_msg[128];
+        int dropped_len = dmSnPrintf(dropped_msg, sizeof(dropped_msg), "WARNING:DLIB: %d log messages were dropped\n", dropped);
+        DoLogPlatform(LOG_SEVERITY_WARNING, dropped_msg, dropped_len);
+        DoLogSynchronized(LOG_SEVERITY_WARNING, "DLIB", dropped_msg, dropped_len);
+    }
+
     int msg_len = (int) strlen(log_message->m_Message);
     DoLogSynchronized((LogSeverity)log_message->m_Severity, log_message->m_Domain, log_message->m_Message, msg_len);
 
+    if (dLib::IsDebugMode())
+    {
+        DM_SPINLOCK_SCOPED_LOCK(dmLog::g_LogFileLock);
+        DoLogFile(log_message->m_Message, msg_len);
+    }
+
     // NOTE: Keep i as signed! See --i below after EraseSwap
     int n = 0;
     {
@@ -482,6 +509,9 @@ void LogInitialize(const LogParams* params)
 
     dmAtomicStore32(&g_ListenersCount, 0);
     dmSpinlock::Create(&g_ListenerLock);
+    dmSpinlock::Create(&g_LogFileLock);
+    dmAtomicStore32(&g_PendingMessages, 0);
+    dmAtomicStore32(&g_DroppedMessages, 0);
 
     /*
      * This message is parsed by editor 2 - don't remove or change without
@@ -551,6 +581,7 @@ void LogFinalize()
     }
 
     dmSpinlock::Destroy(&g_ListenerLock);
+    dmSpinlock::Destroy(&g_LogFileLock);
     dmSpinlock::Destroy(&g_LogServerLock);
 }
 
@@ -564,11 +595,20 @@ uint16_t GetPort()
 
 bool SetLogFile(const char* path)
 {
+    // The log thread may be writing to the file
+    bool lock = IsServerInitialized();
+    if (lock)
+        dmSpinlock::Lock(&g_LogFileLock);
+
     if (g_LogFile) {
         fclose(g_LogFile);
         g_LogFile = 0;
     }
     g_LogFile = fopen(path, "wb");
+
+    if (lock)
+        dmSpinlock::Unlock(&g_LogFileLock);
+
     if (g_LogFile) {
         dmLogInfo("Writing log to: %s", path);
     } else {
@@ -688,7 +728,11 @@ void LogInternal(LogSeverity severity, const char* domain, const char* format, .
     }
 
     if (!dmLog::IsServerInitialized()) // in case the server lock isn't even created
+    {
+        if (is_debug_mode)
+            dmLog::DoLogFile(str_buf, actual_n);
         return;
+    }
 
     // Make sure we have the lock, so that the log system cannot shut down in between
     DM_SPINLOCK_SCOPED_LOCK(dmLog::g_LogServerLock);
@@ -696,6 +740,16 @@ void LogInternal(LogSeverity severity, const char* domain, const char* format, .
         return; // The log system may have been shut down in between
 
     dmLog::dmLogServer* server = dmLog::g_dmLogServer;
+    if (!server->m_Thread || dmThread::GetCurrentThread() == server->m_Thread || !dLib::FeaturesSupported(DM_FEATURE_BIT_SOCKET_SERVER_TCP))
+    {
+        // No log thread to write the file for us (e.g. Emscripten), or we're on it
+        if (is_debug_mode)
+        {
+            DM_SPINLOCK_SCOPED_LOCK(dmLog::g_LogFileLock);
+            dmLog::DoLogFile(str_buf, actual_n);
+        }
+    }
+
     if (!server->m_Thread) // e.g. Emscripten
     {
         dmLog::DoLogSynchronized(severity, domain, str_buf, actual_n);
@@ -711,6 +765,14 @@ void LogInternal(LogSeverity severity, const char* domain, const char* format, .
         return;
     }
 
+    // Don't let a burst of logging grow the message queue without bounds
+    if (dmAtomicIncrement32(&dmLog::g_PendingMessages) >= dmLog::MAX_PENDING_LOG_MESSAGES)
+    {
+        dmAtomicDecrement32(&dmLog::g_PendingMessages);
+        dmAtomicIncrement32(&dmLog::g_DroppedMessages);
+        return;
+    }
+
     if (server)
     {
         msg->m_Type = dmLog::LogMessage::MESSAGE;
@@ -720,6 +782,10 @@ void LogInternal(LogSeverity severity, const char* domain, const char* format, .
         receiver.m_Socket = server->m_MessageSocket;
         receiver.m_Path = 0;
         receiver.m_Fragment = 0;
-        dmMessage::Post(0, &receiver, 0, 0, 0, msg, dmMath::Min(sizeof(dmLog::LogMessage) + actual_n + 1, sizeof(tmp_buf)), 0);
+        if (dmMessage::RESULT_OK != dmMessage::Post(0, &receiver, 0, 0, 0, msg, dmMath::Min(sizeof(dmLog::LogMessage) + actual_n + 1, sizeof(tmp_buf)), 0))
+        {
+            dmAtomicDecrement32(&dmLog::g_PendingMessages);
+            dmAtomicIncrement32(&dmLog::g_DroppedMessages);
+        }
     }
 }
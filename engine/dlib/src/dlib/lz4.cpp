@@ -51,6 +51,35 @@ namespace dmLZ4
         return r;
     }
 
+    Result DecompressBufferWithDictionary(const void* buffer, uint32_t buffer_size, const void* dictionary, uint32_t dictionary_size, void* decompressed_buffer, uint32_t max_output, int* decompressed_size)
+    {
+        if(max_output > DMLZ4_MAX_OUTPUT_SIZE)
+        {
+            *decompressed_size = -1;
+            return dmLZ4::RESULT_OUTPUT_SIZE_TOO_LARGE;
+        }
+
+        *decompressed_size = LZ4_decompress_safe_usingDict((const char*)buffer, (char*)decompressed_buffer, buffer_size, max_output, (const char*)dictionary, dictionary_size);
+        return *decompressed_size < 0 ? dmLZ4::RESULT_OUTBUFFER_TOO_SMALL : dmLZ4::RESULT_OK;
+    }
+
+    Result CompressBufferWithDictionary(const void* buffer, uint32_t buffer_size, const void* dictionary, uint32_t dictionary_size, void* compressed_buffer, int* compressed_size)
+    {
+        LZ4_streamHC_t* stream = LZ4_createStreamHC();
+        if (!stream)
+        {
+            *compressed_size = 0;
+            return dmLZ4::RESULT_COMPRESSION_FAILED;
+        }
+
+        LZ4_resetStreamHC_fast(stream, 9);
+        LZ4_loadDictHC(stream, (const char*)dictionary, dictionary_size);
+        *compressed_size = LZ4_compress_HC_continue(stream, (const char*)buffer, (char*)compressed_buffer, buffer_size, LZ4_compressBound(buffer_size));
+        LZ4_freeStreamHC(stream);
+
+        return *compressed_size == 0 ? dmLZ4::RESULT_COMPRESSION_FAILED : dmLZ4::RESULT_OK;
+    }
+
     Result MaxCompressedSize(int uncompressed_size, int *max_compressed_size)
     {
         *max_compressed_size = LZ4_compressBound(uncompressed_size);
@@ -76,6 +105,11 @@ extern "C" {
         return dmLZ4::CompressBuffer(buffer, buffer_size, compressed_buffer, compressed_size);
     }
 
+    DM_DLLEXPORT int LZ4CompressBufferWithDictionary(const void* buffer, uint32_t buffer_size, const void* dictionary, uint32_t dictionary_size, void* compressed_buffer, int* compressed_size)
+    {
+        return dmLZ4::CompressBufferWithDictionary(buffer, buffer_size, dictionary, dictionary_size, compressed_buffer, compressed_size);
+    }
+
     DM_DLLEXPORT int LZ4MaxCompressedSize(int uncompressed_size, int* max_compressed_size)
     {
         return dmLZ4::MaxCompressedSize(uncompressed_size, max_compressed_size);
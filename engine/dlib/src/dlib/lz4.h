@@ -61,6 +61,34 @@ namespace dmLZ4
      */
     Result CompressBuffer(const void* buffer, uint32_t buffer_size, void* compressed_buffer, int* compressed_size);
 
+    /**
+     * Decompress buffer from LZ4-format, compressed with CompressBufferWithDictionary() using the same dictionary
+     *
+     * @param buffer buffer to decompress
+     * @param buffer_size buffer size
+     * @param dictionary the dictionary
+     * @param dictionary_size dictionary size. Only the last 64KB of the dictionary is used
+     * @param decompressed_buffer Pre-allocated buffer to decompress data into
+     * @param max_output max size of decompressed data
+     * @param decompressed_size Actual decompressed size will be written to this
+     * @return dmLZ4::RESULT_OK on success
+     */
+    Result DecompressBufferWithDictionary(const void* buffer, uint32_t buffer_size, const void* dictionary, uint32_t dictionary_size, void* decompressed_buffer, uint32_t max_output, int* decompressed_size);
+
+    /**
+     * Compress buffer to LZ4-format, referencing data in the dictionary. Small buffers with
+     * content similar to the dictionary compress much better than on their own.
+     *
+     * @param buffer buffer to compress
+     * @param buffer_size buffer size
+     * @param dictionary the dictionary
+     * @param dictionary_size dictionary size. Only the last 64KB of the dictionary is used
+     * @param compressed_buffer Pre-allocated buffer to compress data into
+     * @param compressed_size Actual compressed size will be written to this
+     * @return dmLZ4::RESULT_OK on success
+     */
+    Result CompressBufferWithDictionary(const void* buffer, uint32_t buffer_size, const void* dictionary, uint32_t dictionary_size, void* compressed_buffer, int* compressed_size);
+
     /**
      * Helper method to get a "worst case" size of compressed data.
      *
@@ -14,7 +14,12 @@
 
 #include "memory.h"
 #include "dalloca.h"
+#include "atomic.h"
+#include "spinlock.h"
+#include "thread.h"
+#include "log.h"
 #include <stdlib.h>
+#include <string.h>
 #include <errno.h>
 #if defined(__ANDROID__) || defined(_MSC_VER)
 #include <malloc.h>
@@ -66,4 +71,226 @@ namespace dmMemory
         #error "dmMemory::AlignedFree not implemented for this platform."
 #endif
     }
+
+    static const uint32_t FRAME_ARENA_INITIAL_SIZE = 64 * 1024;
+    static const uint32_t FRAME_ARENA_ALIGNMENT = 16;
+
+    // A linear allocator used by a single thread. Even and odd frames use separate
+    // buffers, so that memory from the previous frame is still valid.
+    struct FrameArena
+    {
+        uint8_t*    m_Buffer[2];
+        uint32_t    m_Capacity[2];
+        uint32_t    m_Offset[2];
+        uint32_t    m_Required[2];  // The memory needed to fit all allocations of the last use, including the failed ones
+        int32_t     m_Frame[2];     // The frame the buffer was last used in
+        FrameArena* m_Next;
+    };
+
+    struct FrameAllocatorContext
+    {
+        FrameAllocatorContext()
+        {
+            dmAtomicStore32(&m_Frame, 0);
+            dmSpinlock::Create(&m_Spinlock);
+            m_Tls = dmThread::AllocTls();
+            m_Arenas = 0;
+        }
+
+        ~FrameAllocatorContext()
+        {
+            {
+                DM_SPINLOCK_SCOPED_LOCK(m_Spinlock);
+                FrameArena* arena = m_Arenas;
+                while (arena)
+                {
+                    FrameArena* next = arena->m_Next;
+                    AlignedFree(arena->m_Buffer[0]);
+                    AlignedFree(arena->m_Buffer[1]);
+                    delete arena;
+                    arena = next;
+                }
+                m_Arenas = 0;
+            }
+            dmThread::FreeTls(m_Tls);
+            dmSpinlock::Destroy(&m_Spinlock);
+        }
+
+        int32_atomic_t          m_Frame;
+        dmSpinlock::Spinlock    m_Spinlock;
+        dmThread::TlsKey        m_Tls;
+        FrameArena*             m_Arenas;
+    } g_FrameAllocator;
+
+    static FrameArena* GetFrameArena()
+    {
+        FrameArena* arena = (FrameArena*)dmThread::GetTlsValue(g_FrameAllocator.m_Tls);
+        if (!arena)
+        {
+            arena = new FrameArena;
+            memset(arena, 0, sizeof(FrameArena));
+            arena->m_Frame[0] = -1;
+            arena->m_Frame[1] = -1;
+            dmThread::SetTlsValue(g_FrameAllocator.m_Tls, arena);
+
+            DM_SPINLOCK_SCOPED_LOCK(g_FrameAllocator.m_Spinlock);
+            arena->m_Next = g_FrameAllocator.m_Arenas;
+            g_FrameAllocator.m_Arenas = arena;
+        }
+        return arena;
+    }
+
+    // Called the first time a buffer is used in a new frame
+    static void ResetFrameBuffer(FrameArena* arena, uint32_t index, int32_t frame)
+    {
+        uint32_t required = arena->m_Required[index];
+        if (arena->m_Buffer[index] == 0 || required > arena->m_Capacity[index])
+        {
+            uint32_t capacity = arena->m_Capacity[index] ? arena->m_Capacity[index] : FRAME_ARENA_INITIAL_SIZE;
+            while (capacity < required)
+                capacity *= 2;
+
+            AlignedFree(arena->m_Buffer[index]);
+            void* buffer = 0;
+            if (AlignedMalloc(&buffer, FRAME_ARENA_ALIGNMENT, capacity) != RESULT_OK)
+            {
+                buffer = 0;
+                capacity = 0;
+            }
+            arena->m_Buffer[index] = (uint8_t*)buffer;
+            arena->m_Capacity[index] = capacity;
+        }
+        arena->m_Offset[index] = 0;
+        arena->m_Required[index] = 0;
+        arena->m_Frame[index] = frame;
+    }
+
+    void* FrameAlloc(uint32_t size, uint32_t alignment)
+    {
+        if (alignment == 0 || (alignment & (alignment - 1)) != 0)
+            return 0;
+
+        FrameArena* arena = GetFrameArena();
+        int32_t frame = dmAtomicGet32(&g_FrameAllocator.m_Frame);
+        uint32_t index = (uint32_t)frame & 1;
+        if (arena->m_Frame[index] != frame)
+        {
+            ResetFrameBuffer(arena, index, frame);
+        }
+
+        uintptr_t base = (uintptr_t)arena->m_Buffer[index];
+        uintptr_t start = (base + arena->m_Offset[index] + (alignment - 1)) & ~(uintptr_t)(alignment - 1);
+        uint32_t end = (uint32_t)(start - base) + size;
+
+        // Keep track of the total size needed, so that the buffer grows on the next reset
+        uint32_t required = (arena->m_Required[index] + (alignment - 1)) & ~(alignment - 1);
+        if (alignment > FRAME_ARENA_ALIGNMENT)
+            required += alignment;
+        arena->m_Required[index] = required + size;
+
+        if (base == 0 || end > arena->m_Capacity[index])
+        {
+            return 0;
+        }
+        arena->m_Offset[index] = end;
+        return (void*)start;
+    }
+
+    void FrameAllocatorNewFrame()
+    {
+        dmAtomicIncrement32(&g_FrameAllocator.m_Frame);
+    }
+
+    struct CategoryStats
+    {
+        int32_atomic_t m_Usage;
+        int32_atomic_t m_Peak;
+        int32_atomic_t m_Budget;
+    };
+
+    static const char* CATEGORY_NAMES[MAX_CATEGORY_COUNT] = {
+        "Resource",
+        "Lua",
+        "Graphics",
+        "Sound",
+        "Physics",
+        "Other",
+    };
+
+    static CategoryStats    g_CategoryStats[MAX_CATEGORY_COUNT];
+    static BudgetCallback   g_BudgetCallback = 0;
+    static void*            g_BudgetCallbackUserData = 0;
+
+    static void UpdateCategory(Category category, uint32_t prev, uint32_t usage)
+    {
+        CategoryStats& stats = g_CategoryStats[category];
+
+        uint32_t peak = (uint32_t)dmAtomicGet32(&stats.m_Peak);
+        while (usage > peak)
+        {
+            uint32_t prev_peak = (uint32_t)dmAtomicCompareStore32(&stats.m_Peak, (int32_t)usage, (int32_t)peak);
+            if (prev_peak == peak)
+                break;
+            peak = prev_peak;
+        }
+
+        // Only report when crossing the budget, not for every allocation above it
+        uint32_t budget = (uint32_t)dmAtomicGet32(&stats.m_Budget);
+        if (budget != 0 && prev <= budget && usage > budget)
+        {
+            BudgetCallback callback = g_BudgetCallback;
+            if (callback)
+                callback(category, usage, budget, g_BudgetCallbackUserData);
+            else
+                dmLogWarning("Memory category '%s' exceeds its budget: %u > %u bytes", CATEGORY_NAMES[category], usage, budget);
+        }
+    }
+
+    void TrackAlloc(Category category, uint32_t size)
+    {
+        uint32_t prev = (uint32_t)dmAtomicAdd32(&g_CategoryStats[category].m_Usage, (int32_t)size);
+        UpdateCategory(category, prev, prev + size);
+    }
+
+    void TrackFree(Category category, uint32_t size)
+    {
+        dmAtomicSub32(&g_CategoryStats[category].m_Usage, (int32_t)size);
+    }
+
+    void SetUsage(Category category, uint32_t size)
+    {
+        uint32_t prev = (uint32_t)dmAtomicStore32(&g_CategoryStats[category].m_Usage, (int32_t)size);
+        UpdateCategory(category, prev, size);
+    }
+
+    uint32_t GetUsage(Category category)
+    {
+        return (uint32_t)dmAtomicGet32(&g_CategoryStats[category].m_Usage);
+    }
+
+    uint32_t GetPeakUsage(Category category)
+    {
+        return (uint32_t)dmAtomicGet32(&g_CategoryStats[category].m_Peak);
+    }
+
+    void SetBudget(Category category, uint32_t budget)
+    {
+        dmAtomicStore32(&g_CategoryStats[category].m_Budget, (int32_t)budget);
+    }
+
+    uint32_t GetBudget(Category category)
+    {
+        return (uint32_t)dmAtomicGet32(&g_CategoryStats[category].m_Budget);
+    }
+
+    void SetBudgetCallback(BudgetCallback callback, void* user_data)
+    {
+        g_BudgetCallbackUserData = user_data;
+        g_BudgetCallback = callback;
+    }
+
+    const char* GetCategoryName(Category category)
+    {
+        return CATEGORY_NAMES[category];
+    }
 }
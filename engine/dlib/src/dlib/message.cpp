@@ -24,6 +24,8 @@
 #include <dlib/mutex.h>
 #include <dlib/static_assert.h>
 #include <dlib/spinlock.h>
+#include <dlib/thread.h>
+#include <dlib/time.h>
 #include <dlib/profile/profile.h>
 
 DM_PROPERTY_GROUP(rmtp_Message, "dmMessage");
@@ -34,24 +36,34 @@ namespace dmMessage
     // Alignment of allocations
     const uint32_t DM_MESSAGE_ALIGNMENT = 16U;
 
+    // Each message is prefixed with the page it was allocated from, so that the page can be recycled
+    // once all its messages are dispatched
+    const uint32_t DM_MESSAGE_PREFIX_SIZE = DM_MESSAGE_ALIGNMENT;
+
+    // Max number of unused pages kept around for reuse
+    const uint32_t MAX_FREE_PAGES = 64;
+
     struct MemoryPage
     {
-        uint8_t     m_Memory[DM_MESSAGE_PAGE_SIZE];
-        uint32_t    m_Current;
-        MemoryPage* m_NextPage;
+        uint8_t         m_Memory[DM_MESSAGE_PAGE_SIZE + DM_MESSAGE_PREFIX_SIZE];
+        uint32_t        m_Current;
+        // One reference per allocated message, plus one while the page is used for new allocations
+        int32_atomic_t  m_RefCount;
+        MemoryPage*     m_NextPage;
     };
 
+    // Messages are bump allocated from pages owned by the posting thread, so Post never contends on memory.
+    // The consumer releases the page references after dispatching, and the last one to release a page puts it in the free list.
+    // Note: The current page of a thread that exits is not recycled
     struct MemoryAllocator
     {
         MemoryAllocator()
         {
             m_CurrentPage = 0;
-            m_FreePages = 0;
-            m_FullPages = 0;
+            m_Next = 0;
         }
-        MemoryPage* m_CurrentPage;
-        MemoryPage* m_FreePages;
-        MemoryPage* m_FullPages;
+        MemoryPage*      m_CurrentPage;
+        MemoryAllocator* m_Next;
     };
 
     struct GlobalInit
@@ -59,30 +71,77 @@ namespace dmMessage
         GlobalInit() {
             // Make sure the struct sizes are in sync! Think of potential save files!
             DM_STATIC_ASSERT(sizeof(dmMessage::URL) == 32, Invalid_Struct_Size);
+            DM_STATIC_ASSERT(sizeof(MemoryPage*) <= DM_MESSAGE_PREFIX_SIZE, Invalid_Prefix_Size);
         }
 
     } g_MessageInit;
 
+    // The per thread allocators, and the page free list
+    dmSpinlock::Spinlock    g_PageSpinlock;
+    dmThread::TlsKey        g_AllocatorTls;
+    MemoryAllocator*        g_Allocators = 0;
+    MemoryPage*             g_FreePages = 0;
+    uint32_t                g_FreePageCount = 0;
+
     static Result GetSocketNoLock(dmhash_t name_hash, HSocket* out_socket);
 
+    static MemoryAllocator* GetAllocator()
+    {
+        MemoryAllocator* allocator = (MemoryAllocator*)dmThread::GetTlsValue(g_AllocatorTls);
+        if (!allocator)
+        {
+            allocator = new MemoryAllocator;
+            dmThread::SetTlsValue(g_AllocatorTls, allocator);
+
+            DM_SPINLOCK_SCOPED_LOCK(g_PageSpinlock);
+            allocator->m_Next = g_Allocators;
+            g_Allocators = allocator;
+        }
+        return allocator;
+    }
+
+    static void ReleasePage(MemoryPage* page)
+    {
+        if (dmAtomicDecrement32(&page->m_RefCount) != 1)
+        {
+            return;
+        }
+
+        {
+            DM_SPINLOCK_SCOPED_LOCK(g_PageSpinlock);
+            if (g_FreePageCount < MAX_FREE_PAGES)
+            {
+                page->m_NextPage = g_FreePages;
+                g_FreePages = page;
+                ++g_FreePageCount;
+                return;
+            }
+        }
+        delete page;
+    }
+
     static void AllocateNewPage(MemoryAllocator* allocator)
     {
         if (allocator->m_CurrentPage)
         {
-            // Link current page to full pages
-            allocator->m_CurrentPage->m_NextPage = allocator->m_FullPages;
-            allocator->m_FullPages = allocator->m_CurrentPage;
+            // Drop our reference to the current page. It is recycled once all its messages are dispatched
+            ReleasePage(allocator->m_CurrentPage);
         }
 
         MemoryPage* new_page = 0;
 
-        if (allocator->m_FreePages)
         {
-            // Free page to use
-            new_page = allocator->m_FreePages;
-            allocator->m_FreePages = new_page->m_NextPage;
+            DM_SPINLOCK_SCOPED_LOCK(g_PageSpinlock);
+            if (g_FreePages)
+            {
+                // Free page to use
+                new_page = g_FreePages;
+                g_FreePages = new_page->m_NextPage;
+                --g_FreePageCount;
+            }
         }
-        else
+
+        if (!new_page)
         {
             // Allocate new page
             new_page = new MemoryPage;
@@ -90,39 +149,114 @@ namespace dmMessage
 
         new_page->m_Current = 0;
         new_page->m_NextPage = 0;
+        dmAtomicStore32(&new_page->m_RefCount, 1);
 
         allocator->m_CurrentPage = new_page;
     }
 
-    static void* AllocateMessage(MemoryAllocator* allocator, uint32_t size)
+    static Message* AllocateMessage(uint32_t size)
     {
         // At least ALIGNMENT bytes alignment of size in order to ensure that the next allocation is aligned
-        size += DM_MESSAGE_ALIGNMENT-1;
+        size += DM_MESSAGE_PREFIX_SIZE + DM_MESSAGE_ALIGNMENT-1;
         size &= ~(DM_MESSAGE_ALIGNMENT-1);
-        assert(size <= DM_MESSAGE_PAGE_SIZE);
+        assert(size <= sizeof(MemoryPage::m_Memory));
 
-        if (allocator->m_CurrentPage == 0 || (DM_MESSAGE_PAGE_SIZE-allocator->m_CurrentPage->m_Current) < size)
+        MemoryAllocator* allocator = GetAllocator();
+        if (allocator->m_CurrentPage == 0 || (sizeof(MemoryPage::m_Memory)-allocator->m_CurrentPage->m_Current) < size)
         {
             // No current page or allocation didn't fit.
             AllocateNewPage(allocator);
         }
 
         MemoryPage* page = allocator->m_CurrentPage;
-        void* ret = (void*) ((uintptr_t) &page->m_Memory[0] + page->m_Current);
+        uint8_t* ret = &page->m_Memory[page->m_Current];
         page->m_Current += size;
-        return ret;
+        dmAtomicIncrement32(&page->m_RefCount);
+
+        *(MemoryPage**)ret = page;
+        return (Message*)(ret + DM_MESSAGE_PREFIX_SIZE);
+    }
+
+    static void FreeMessage(Message* message)
+    {
+        MemoryPage* page = *(MemoryPage**)((uint8_t*)message - DM_MESSAGE_PREFIX_SIZE);
+        ReleasePage(page);
+    }
+
+    static Message* GetNext(Message* message)
+    {
+        return (Message*)dmAtomicGetPtr((void* volatile*)&message->m_Next);
+    }
+
+    // Lock free multiple producer, single consumer queue of messages.
+    // The queue is a linked list starting at m_Stub (always the first item seen by the consumer), where producers
+    // swap themselves in as the new m_Last and then link the previous last item to themselves.
+    struct MessageQueue
+    {
+        Message*        m_Last;
+        Message         m_Stub;
+    };
+
+    static void InitQueue(MessageQueue* queue)
+    {
+        memset(&queue->m_Stub, 0, sizeof(queue->m_Stub));
+        queue->m_Last = &queue->m_Stub;
+    }
+
+    // Returns true if the queue was empty
+    static bool PushMessage(MessageQueue* queue, Message* message)
+    {
+        message->m_Next = 0;
+        Message* prev = (Message*)dmAtomicStorePtr((void* volatile*)&queue->m_Last, message);
+        // Until this store, the consumer will wait for the link
+        dmAtomicStorePtr((void* volatile*)&prev->m_Next, message);
+        return prev == &queue->m_Stub;
+    }
+
+    static bool IsQueueEmpty(MessageQueue* queue)
+    {
+        return dmAtomicGetPtr((void* volatile*)&queue->m_Last) == &queue->m_Stub;
+    }
+
+    static Message* WaitForNext(Message* message)
+    {
+        Message* next = GetNext(message);
+        while (next == 0)
+        {
+            // The producer has swapped in the next message but not yet linked it
+            dmTime::Sleep(0);
+            next = GetNext(message);
+        }
+        return next;
+    }
+
+    // Detaches all the currently queued messages, which are then terminated by the stub.
+    // Messages pushed after this call are linked after the stub, and are not part of the returned list
+    static Message* PopAll(MessageQueue* queue)
+    {
+        if (IsQueueEmpty(queue))
+        {
+            return 0;
+        }
+
+        Message* stub = &queue->m_Stub;
+        Message* first = WaitForNext(stub);
+
+        // Move the stub to the end of the queue
+        stub->m_Next = 0;
+        PushMessage(queue, stub);
+        return first;
     }
 
     struct MessageSocket
     {
         uint32_t        m_RefCount; // Is protected by "g_MessageSpinlock"
         dmhash_t        m_NameHash;
-        Message*        m_Header;
-        Message*        m_Tail;
+        MessageQueue*   m_Queue;
         const char*     m_Name;
+        // Only used for blocking dispatch
         dmMutex::HMutex m_Mutex;
         dmConditionVariable::HConditionVariable m_Condition;
-        MemoryAllocator m_Allocator;
     };
 
     const uint32_t MAX_SOCKETS = 256;
@@ -151,6 +285,8 @@ namespace dmMessage
         {
             dmAtomicStore32(&m_Deleted, 0);
             dmSpinlock::Create(&g_MessageSpinlock);
+            dmSpinlock::Create(&g_PageSpinlock);
+            g_AllocatorTls = dmThread::AllocTls();
         }
 
         ~ContextDestroyer()
@@ -165,6 +301,31 @@ namespace dmMessage
                 }
             }
             dmSpinlock::Destroy(&g_MessageSpinlock);
+
+            {
+                DM_SPINLOCK_SCOPED_LOCK(g_PageSpinlock);
+                MemoryAllocator* allocator = g_Allocators;
+                while (allocator)
+                {
+                    MemoryAllocator* next = allocator->m_Next;
+                    delete allocator->m_CurrentPage;
+                    delete allocator;
+                    allocator = next;
+                }
+                g_Allocators = 0;
+
+                MemoryPage* p = g_FreePages;
+                while (p)
+                {
+                    MemoryPage* next = p->m_NextPage;
+                    delete p;
+                    p = next;
+                }
+                g_FreePages = 0;
+                g_FreePageCount = 0;
+            }
+            dmThread::FreeTls(g_AllocatorTls);
+            dmSpinlock::Destroy(&g_PageSpinlock);
         }
         int32_atomic_t m_Deleted;
     } g_ContextDestroyer;
@@ -203,8 +364,8 @@ namespace dmMessage
 
         MessageSocket s;
         s.m_RefCount = 1;
-        s.m_Header = 0;
-        s.m_Tail = 0;
+        s.m_Queue = new MessageQueue;
+        InitQueue(s.m_Queue);
         s.m_NameHash = name_hash;
         s.m_Name = strdup(name);
         s.m_Mutex = dmMutex::New();
@@ -218,37 +379,23 @@ namespace dmMessage
 
     static void DisposeSocket(MessageSocket* s)
     {
-        Message *message_object = s->m_Header;
-        while (message_object)
+        // No one else references the socket at this point, so the queue is complete
+        Message* stub = &s->m_Queue->m_Stub;
+        Message *message_object = stub->m_Next;
+        while (message_object && message_object != stub)
         {
+            Message* next = message_object->m_Next;
             if (message_object->m_DestroyCallback)
             {
                 message_object->m_DestroyCallback(message_object);
             }
-            message_object = message_object->m_Next;
+            FreeMessage(message_object);
+            message_object = next;
         }
+        delete s->m_Queue;
 
         free((void*) s->m_Name);
 
-        MemoryPage* p = s->m_Allocator.m_FreePages;
-        while (p)
-        {
-            MemoryPage* next = p->m_NextPage;
-            delete p;
-            p = next;
-        }
-        p = s->m_Allocator.m_FullPages;
-        while (p)
-        {
-            MemoryPage* next = p->m_NextPage;
-            delete p;
-            p = next;
-        }
-        if (s->m_Allocator.m_CurrentPage)
-        {
-            delete s->m_Allocator.m_CurrentPage;
-        }
-
         dmConditionVariable::Delete(s->m_Condition);
 
         dmMutex::Delete(s->m_Mutex);
@@ -394,11 +541,7 @@ namespace dmMessage
         MessageSocket* s = AcquireSocket(socket);
         if (s != 0)
         {
-            bool has_messages;
-            {
-                DM_MUTEX_SCOPED_LOCK(s->m_Mutex);
-                has_messages = s->m_Header != 0;
-            }
+            bool has_messages = !IsQueueEmpty(s->m_Queue);
             ReleaseSocket(s);
             return has_messages;
         }
@@ -462,11 +605,8 @@ namespace dmMessage
             return RESULT_SOCKET_NOT_FOUND;
         }
 
-        dmMutex::Lock(s->m_Mutex);
-
-        MemoryAllocator* allocator = &s->m_Allocator;
         uint32_t data_size = sizeof(Message) + message_data_size;
-        Message *new_message = (Message *) AllocateMessage(allocator, data_size);
+        Message *new_message = AllocateMessage(data_size);
         if (sender != 0x0)
         {
             new_message->m_Sender = *sender;
@@ -485,24 +625,14 @@ namespace dmMessage
         new_message->m_DestroyCallback = destroy_callback;
         memcpy(&new_message->m_Data[0], message_data, message_data_size);
 
-        bool is_first_message = !s->m_Header;
-
-        if (!s->m_Header)
-        {
-            s->m_Header = new_message;
-            s->m_Tail = new_message;
-        }
-        else
-        {
-            s->m_Tail->m_Next = new_message;
-            s->m_Tail = new_message;
-        }
+        bool is_first_message = PushMessage(s->m_Queue, new_message);
 
         if (is_first_message)
         {
+            // Wake up any blocking dispatch. The lock makes sure it is either waiting or will see the message
+            DM_MUTEX_SCOPED_LOCK(s->m_Mutex);
             dmConditionVariable::Signal(s->m_Condition);
         }
-        dmMutex::Unlock(s->m_Mutex);
 
         ReleaseSocket(s);
 
@@ -550,60 +680,42 @@ namespace dmMessage
             return 0;
         }
 
-        dmMutex::Lock(s->m_Mutex);
-
-        MemoryAllocator* allocator = &s->m_Allocator;
-
-        if (!s->m_Header)
+        if (IsQueueEmpty(s->m_Queue))
         {
             if (blocking) {
-                dmConditionVariable::Wait(s->m_Condition, s->m_Mutex);
+                DM_MUTEX_SCOPED_LOCK(s->m_Mutex);
+                while (IsQueueEmpty(s->m_Queue))
+                {
+                    dmConditionVariable::Wait(s->m_Condition, s->m_Mutex);
+                }
             } else {
-                dmMutex::Unlock(s->m_Mutex);
                 ReleaseSocket(s);
                 return 0;
             }
         }
 
-
         char buffer[128];
         const char* profiler_string = GetProfilerString(s->m_Name, buffer, sizeof(buffer));
         DM_PROFILE_DYN(profiler_string, 0);
 
         uint32_t dispatch_count = 0;
 
-        Message *message_object = s->m_Header;
-        s->m_Header = 0;
-        s->m_Tail = 0;
-
-        // Unlink full pages
-        MemoryPage* full_pages = allocator->m_FullPages;
-        allocator->m_FullPages = 0;
+        // Only dispatch the messages posted so far. Messages posted while dispatching are left for the next dispatch
+        Message* stub = &s->m_Queue->m_Stub;
+        Message* message_object = PopAll(s->m_Queue);
 
-        dmMutex::Unlock(s->m_Mutex);
-
-        while (message_object)
+        while (message_object && message_object != stub)
         {
+            Message* next = WaitForNext(message_object);
             dispatch_callback(message_object, user_ptr);
             if (message_object->m_DestroyCallback) {
                 message_object->m_DestroyCallback(message_object);
             }
-            message_object = message_object->m_Next;
+            FreeMessage(message_object);
+            message_object = next;
             dispatch_count++;
         }
 
-        // Reclaim all full pages active when dispatch started
-        dmMutex::Lock(s->m_Mutex);
-        MemoryPage* p = full_pages;
-        while (p)
-        {
-            MemoryPage* next = p->m_NextPage;
-            p->m_NextPage = allocator->m_FreePages;
-            allocator->m_FreePages = p;
-            p = next;
-        }
-        dmMutex::Unlock(s->m_Mutex);
-
         ReleaseSocket(s);
 
         return dispatch_count;
@@ -619,6 +731,59 @@ namespace dmMessage
         return InternalDispatch(socket, dispatch_callback, user_ptr, true);
     }
 
+    uint32_t DispatchBatch(HSocket socket, DispatchBatchCallback dispatch_callback, void* user_ptr)
+    {
+        MessageSocket* s = AcquireSocket(socket);
+        if (s == 0)
+        {
+            return 0;
+        }
+
+        if (IsQueueEmpty(s->m_Queue))
+        {
+            ReleaseSocket(s);
+            return 0;
+        }
+
+        char buffer[128];
+        const char* profiler_string = GetProfilerString(s->m_Name, buffer, sizeof(buffer));
+        DM_PROFILE_DYN(profiler_string, 0);
+
+        uint32_t dispatch_count = 0;
+
+        Message* batch[DISPATCH_BATCH_SIZE];
+
+        // Only dispatch the messages posted so far. Messages posted while dispatching are left for the next dispatch
+        Message* stub = &s->m_Queue->m_Stub;
+        Message* message_object = PopAll(s->m_Queue);
+
+        while (message_object && message_object != stub)
+        {
+            uint32_t count = 0;
+            while (message_object && message_object != stub && count < DISPATCH_BATCH_SIZE)
+            {
+                Message* next = WaitForNext(message_object);
+                batch[count++] = message_object;
+                message_object = next;
+            }
+
+            dispatch_callback(batch, count, user_ptr);
+
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                if (batch[i]->m_DestroyCallback) {
+                    batch[i]->m_DestroyCallback(batch[i]);
+                }
+                FreeMessage(batch[i]);
+            }
+            dispatch_count += count;
+        }
+
+        ReleaseSocket(s);
+
+        return dispatch_count;
+    }
+
     static void ConsumeCallback(dmMessage::Message*, void*)
     {
     }
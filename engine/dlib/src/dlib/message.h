@@ -33,6 +33,16 @@ namespace dmMessage
      */
     typedef void(*DispatchCallback)(dmMessage::Message *message, void* user_ptr);
 
+    /**
+     * @see #DispatchBatch
+     */
+    typedef void(*DispatchBatchCallback)(dmMessage::Message** messages, uint32_t count, void* user_ptr);
+
+    /**
+     * Max number of messages passed to a DispatchBatchCallback
+     */
+    const uint32_t DISPATCH_BATCH_SIZE = 64;
+
 
     /**
      * Create a new socket
@@ -91,6 +101,17 @@ namespace dmMessage
      */
     uint32_t DispatchBlocking(HSocket socket, DispatchCallback dispatch_callback, void* user_ptr);
 
+    /**
+     * Dispatch messages in batches. Same as Dispatch(), but the messages are passed to the callback
+     * in post order, in batches of at most DISPATCH_BATCH_SIZE messages. The messages of a batch are
+     * valid until the callback returns.
+     * @param socket socket
+     * @param dispatch_callback dispatch callback
+     * @param user_ptr user data
+     * @return Number of dispatched messages
+     */
+    uint32_t DispatchBatch(HSocket socket, DispatchBatchCallback dispatch_callback, void* user_ptr);
+
     /**
      * Consume all pending messages
      * @param socket Socket handle
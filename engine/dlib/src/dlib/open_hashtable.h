@@ -0,0 +1,407 @@
+// Copyright 2020-2024 The Defold Foundation
+// Copyright 2014-2020 King
+// Copyright 2009-2014 Ragnar Svensson, Christian Murray
+// Licensed under the Defold License version 1.0 (the "License"); you may not use
+// this file except in compliance with the License.
+//
+// You may obtain a copy of the License, together with FAQs at
+// https://www.defold.com/license
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#ifndef DM_OPEN_HASHTABLE_H
+#define DM_OPEN_HASHTABLE_H
+
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define DM_OPEN_HASHTABLE_SSE2
+#endif
+
+#if defined(_MSC_VER)
+    #include <intrin.h>
+#endif
+
+/**
+ * Hashtable with open addressing, with the same interface as dmHashTable.
+ * The slots are split into groups of 16. Each slot has a control byte holding 7 bits of the
+ * hash of the key (or the empty/deleted markers), so that a lookup compares a whole group
+ * at once (using SSE2 where available) and only touches the entries whose control byte match.
+ * Keys and values are stored inline in the entry array, avoiding the extra indirection
+ * through the bucket array of dmHashTable.
+ *
+ * Memcpy-copy semantics (POD types). The key type needs to support == and conversion to uint64_t.
+ * @note Unlike dmHashTable, the table_size argument to SetCapacity is ignored, and Put() may
+ *       rehash (allocate) once enough entries have been erased that the table has no empty slots left.
+ */
+template <typename KEY, typename T>
+class dmOpenHashTable
+{
+    static const uint32_t GROUP_SIZE    = 16;
+    static const uint8_t  CTRL_EMPTY    = 0x80;
+    static const uint8_t  CTRL_DELETED  = 0xFE;
+
+public:
+    struct Entry
+    {
+        KEY m_Key;
+        T   m_Value;
+    };
+
+    dmOpenHashTable()
+    {
+        memset(this, 0, sizeof(*this));
+    }
+
+    ~dmOpenHashTable()
+    {
+        free(m_Control);
+        free(m_Entries);
+    }
+
+    /**
+     * Removes all the entries from the table.
+     */
+    void Clear()
+    {
+        if (m_Control)
+            memset(m_Control, CTRL_EMPTY, m_SlotCount);
+        m_Count = 0;
+        m_Deleted = 0;
+    }
+
+    /**
+     * Number of entries stored in the table
+     */
+    uint32_t Size() const
+    {
+        return m_Count;
+    }
+
+    /**
+     * Maximum number of entries possible to store in table
+     */
+    uint32_t Capacity() const
+    {
+        return m_Capacity;
+    }
+
+    /**
+     * Set hashtable capacity. New capacity must be greater or equal to current capacity
+     * @param capacity Capacity
+     */
+    void SetCapacity(uint32_t capacity)
+    {
+        assert(capacity >= m_Capacity);
+        Rehash(capacity);
+    }
+
+    /**
+     * Same as SetCapacity(capacity), for drop in compatibility with dmHashTable
+     * @param table_size Ignored
+     * @param capacity Capacity
+     */
+    void SetCapacity(uint32_t table_size, uint32_t capacity)
+    {
+        (void)table_size;
+        SetCapacity(capacity);
+    }
+
+    /**
+     * Swaps the contents of two hash tables
+     */
+    void Swap(dmOpenHashTable<KEY, T>& other)
+    {
+        char buf[sizeof(*this)];
+        memcpy(buf, &other, sizeof(buf));
+        memcpy(&other, this, sizeof(buf));
+        memcpy(this, buf, sizeof(buf));
+    }
+
+    bool Full() const
+    {
+        return m_Count == m_Capacity;
+    }
+
+    bool Empty() const
+    {
+        return m_Count == 0;
+    }
+
+    /**
+     * Put key/value pair in hash table. NOTE: The method will "assert" if the hashtable is full.
+     */
+    void Put(KEY key, const T& value)
+    {
+        uint64_t hash = HashKey(key);
+        Entry* entry = FindEntry(key, hash);
+        if (entry)
+        {
+            entry->m_Value = value;
+            return;
+        }
+
+        assert(!Full());
+        if (m_Count + m_Deleted >= m_Capacity)
+        {
+            // Too many deleted slots, purge them to keep empty slots that terminate the probing
+            Rehash(m_Capacity);
+        }
+
+        uint32_t index = FindInsertSlot(hash);
+        if (m_Control[index] == CTRL_DELETED)
+            --m_Deleted;
+        m_Control[index] = GetH2(hash);
+        m_Entries[index].m_Key = key;
+        m_Entries[index].m_Value = value;
+        ++m_Count;
+    }
+
+    /**
+     * Get pointer to value from key
+     * @return value Pointer to value. NULL if the key/value pair doesn't exist.
+     */
+    T* Get(KEY key)
+    {
+        Entry* entry = FindEntry(key, HashKey(key));
+        return entry ? &entry->m_Value : 0;
+    }
+
+    const T* Get(KEY key) const
+    {
+        Entry* entry = FindEntry(key, HashKey(key));
+        return entry ? &entry->m_Value : 0;
+    }
+
+    /**
+     * Remove key/value pair.
+     * @note Only valid if key exists in table
+     */
+    void Erase(KEY key)
+    {
+        Entry* entry = FindEntry(key, HashKey(key));
+        assert(entry != 0 && "Key not found (erase)");
+        uint32_t index = (uint32_t)(entry - m_Entries);
+
+        // If the group has an empty slot, it has never been full, and no probe sequence
+        // continues past it. The slot can then be marked as empty instead of deleted.
+        uint32_t group = index & ~(GROUP_SIZE - 1);
+        if (MatchByte(&m_Control[group], CTRL_EMPTY) != 0)
+        {
+            m_Control[index] = CTRL_EMPTY;
+        }
+        else
+        {
+            m_Control[index] = CTRL_DELETED;
+            ++m_Deleted;
+        }
+        --m_Count;
+    }
+
+    /**
+     * Iterate over all entries in table
+     * @param call_back Call-back called for every entry
+     * @param context Context
+     */
+    template <typename CONTEXT>
+    void Iterate(void (*call_back)(CONTEXT *context, const KEY* key, T* value), CONTEXT* context) const
+    {
+        for (uint32_t i = 0; i < m_SlotCount; ++i)
+        {
+            if (IsFull(m_Control[i]))
+            {
+                call_back(context, &m_Entries[i].m_Key, &m_Entries[i].m_Value);
+            }
+        }
+    }
+
+    /**
+     * Iterator to the key/value pairs of a hash table
+     */
+    struct Iterator
+    {
+        const KEY&  GetKey()    { return m_Table.m_Entries[m_Index].m_Key; }
+        const T&    GetValue()  { return m_Table.m_Entries[m_Index].m_Value; }
+
+        Iterator(dmOpenHashTable<KEY, T>& table)
+            : m_Table(table)
+            , m_Index(0xFFFFFFFF)
+        {
+        }
+
+        bool Next()
+        {
+            while (++m_Index < m_Table.m_SlotCount)
+            {
+                if (IsFull(m_Table.m_Control[m_Index]))
+                    return true;
+            }
+            m_Index = m_Table.m_SlotCount;
+            return false;
+        }
+
+        dmOpenHashTable<KEY, T>&    m_Table;
+        uint32_t                    m_Index;
+    };
+
+    Iterator GetIterator()
+    {
+        return Iterator(*this);
+    }
+
+private:
+    // Forbid assignment operator and copy-constructor
+    dmOpenHashTable(const dmOpenHashTable<KEY, T>&);
+    const dmOpenHashTable<KEY, T>& operator=(const dmOpenHashTable<KEY, T>&);
+
+    static bool IsFull(uint8_t control)
+    {
+        return (control & 0x80) == 0;
+    }
+
+    // Keys are often already hashes, but can also be sequential indices. Mix them to spread the bits
+    static uint64_t HashKey(KEY key)
+    {
+        uint64_t h = (uint64_t)key;
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        return h;
+    }
+
+    static uint8_t GetH2(uint64_t hash)
+    {
+        return (uint8_t)(hash & 0x7F);
+    }
+
+    static uint32_t FirstBit(uint32_t mask)
+    {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanForward(&index, mask);
+        return (uint32_t)index;
+#else
+        return (uint32_t)__builtin_ctz(mask);
+#endif
+    }
+
+    // Returns a bit mask of the slots in the group with the control byte
+    static uint32_t MatchByte(const uint8_t* group, uint8_t control)
+    {
+#if defined(DM_OPEN_HASHTABLE_SSE2)
+        __m128i ctrl = _mm_loadu_si128((const __m128i*)group);
+        return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8((char)control)));
+#else
+        uint32_t mask = 0;
+        for (uint32_t i = 0; i < GROUP_SIZE; ++i)
+            mask |= (group[i] == control ? 1u : 0u) << i;
+        return mask;
+#endif
+    }
+
+    // Returns a bit mask of the empty or deleted slots in the group
+    static uint32_t MatchEmptyOrDeleted(const uint8_t* group)
+    {
+#if defined(DM_OPEN_HASHTABLE_SSE2)
+        __m128i ctrl = _mm_loadu_si128((const __m128i*)group);
+        return (uint32_t)_mm_movemask_epi8(ctrl);
+#else
+        uint32_t mask = 0;
+        for (uint32_t i = 0; i < GROUP_SIZE; ++i)
+            mask |= (uint32_t)(group[i] >> 7) << i;
+        return mask;
+#endif
+    }
+
+    Entry* FindEntry(KEY key, uint64_t hash) const
+    {
+        if (m_SlotCount == 0)
+            return 0;
+
+        const uint8_t h2 = GetH2(hash);
+        const uint32_t group_mask = (m_SlotCount / GROUP_SIZE) - 1;
+        uint32_t group = (uint32_t)(hash >> 7) & group_mask;
+
+        // Triangular probing visits every group once, since the group count is a power of two
+        for (uint32_t i = 1; i <= group_mask + 1; ++i)
+        {
+            const uint8_t* ctrl = &m_Control[group * GROUP_SIZE];
+            uint32_t match = MatchByte(ctrl, h2);
+            while (match)
+            {
+                uint32_t index = group * GROUP_SIZE + FirstBit(match);
+                if (m_Entries[index].m_Key == key)
+                    return &m_Entries[index];
+                match &= match - 1;
+            }
+            if (MatchByte(ctrl, CTRL_EMPTY))
+                return 0;
+            group = (group + i) & group_mask;
+        }
+        return 0;
+    }
+
+    uint32_t FindInsertSlot(uint64_t hash) const
+    {
+        const uint32_t group_mask = (m_SlotCount / GROUP_SIZE) - 1;
+        uint32_t group = (uint32_t)(hash >> 7) & group_mask;
+        for (uint32_t i = 1; ; ++i)
+        {
+            uint32_t match = MatchEmptyOrDeleted(&m_Control[group * GROUP_SIZE]);
+            if (match)
+                return group * GROUP_SIZE + FirstBit(match);
+            group = (group + i) & group_mask;
+        }
+    }
+
+    void Rehash(uint32_t capacity)
+    {
+        // Keep the load below 7/8
+        uint32_t slot_count = GROUP_SIZE;
+        while (slot_count - slot_count / 8 < capacity)
+            slot_count *= 2;
+
+        uint8_t* old_control = m_Control;
+        Entry* old_entries = m_Entries;
+        uint32_t old_slot_count = m_SlotCount;
+
+        m_Control = (uint8_t*)malloc(slot_count);
+        memset(m_Control, CTRL_EMPTY, slot_count);
+        m_Entries = (Entry*)malloc(sizeof(Entry) * slot_count);
+        m_SlotCount = slot_count;
+        m_Capacity = capacity;
+        m_Count = 0;
+        m_Deleted = 0;
+
+        for (uint32_t i = 0; i < old_slot_count; ++i)
+        {
+            if (IsFull(old_control[i]))
+            {
+                uint64_t hash = HashKey(old_entries[i].m_Key);
+                uint32_t index = FindInsertSlot(hash);
+                m_Control[index] = GetH2(hash);
+                m_Entries[index] = old_entries[i];
+                ++m_Count;
+            }
+        }
+
+        free(old_control);
+        free(old_entries);
+    }
+
+    uint8_t*    m_Control;      // One control byte per slot
+    Entry*      m_Entries;
+    uint32_t    m_SlotCount;    // Multiple of GROUP_SIZE, power of two
+    uint32_t    m_Capacity;
+    uint32_t    m_Count;
+    uint32_t    m_Deleted;      // Number of slots marked as deleted
+};
+
+#endif // DM_OPEN_HASHTABLE_H
@@ -0,0 +1,114 @@
+// Copyright 2020-2024 The Defold Foundation
+// Copyright 2014-2020 King
+// Copyright 2009-2014 Ragnar Svensson, Christian Murray
+// Licensed under the Defold License version 1.0 (the "License"); you may not use
+// this file except in compliance with the License.
+//
+// You may obtain a copy of the License, together with FAQs at
+// https://www.defold.com/license
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include <string.h>
+#include "radix_sort.h"
+
+namespace dmRadixSort
+{
+    // Below this count, the histogram overhead dominates
+    static const uint32_t INSERTION_SORT_THRESHOLD = 32;
+
+    static void InsertionSort(uint64_t* keys, uint32_t* values, uint32_t count, uint64_t mask)
+    {
+        for (uint32_t i = 1; i < count; ++i)
+        {
+            uint64_t key = keys[i];
+            uint32_t value = values[i];
+            uint32_t j = i;
+            while (j > 0 && (keys[j-1] & mask) > (key & mask))
+            {
+                keys[j] = keys[j-1];
+                values[j] = values[j-1];
+                --j;
+            }
+            keys[j] = key;
+            values[j] = value;
+        }
+    }
+
+    void Sort(uint64_t* keys, uint32_t* values, uint64_t* tmp_keys, uint32_t* tmp_values, uint32_t count, uint32_t key_bits)
+    {
+        if (count < 2 || key_bits == 0)
+            return;
+
+        if (key_bits > 64)
+            key_bits = 64;
+
+        const uint32_t pass_count = (key_bits + 7) / 8;
+
+        if (count <= INSERTION_SORT_THRESHOLD)
+        {
+            uint64_t mask = pass_count == 8 ? ~(uint64_t)0 : (((uint64_t)1 << (pass_count * 8)) - 1);
+            InsertionSort(keys, values, count, mask);
+            return;
+        }
+
+        // All histograms are built with a single read of the keys
+        uint32_t histograms[8][256];
+        memset(histograms, 0, sizeof(uint32_t) * 256 * pass_count);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            uint64_t key = keys[i];
+            for (uint32_t p = 0; p < pass_count; ++p)
+            {
+                histograms[p][(key >> (p * 8)) & 0xff]++;
+            }
+        }
+
+        uint64_t* src_keys = keys;
+        uint32_t* src_values = values;
+        uint64_t* dst_keys = tmp_keys;
+        uint32_t* dst_values = tmp_values;
+
+        for (uint32_t p = 0; p < pass_count; ++p)
+        {
+            uint32_t* histogram = histograms[p];
+            uint32_t shift = p * 8;
+
+            // All keys have the same digit, the pass wouldn't change the order
+            if (histogram[(src_keys[0] >> shift) & 0xff] == count)
+                continue;
+
+            uint32_t offset = 0;
+            for (uint32_t b = 0; b < 256; ++b)
+            {
+                uint32_t c = histogram[b];
+                histogram[b] = offset;
+                offset += c;
+            }
+
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                uint64_t key = src_keys[i];
+                uint32_t dst = histogram[(key >> shift) & 0xff]++;
+                dst_keys[dst] = key;
+                dst_values[dst] = src_values[i];
+            }
+
+            uint64_t* swap_keys = src_keys;
+            src_keys = dst_keys;
+            dst_keys = swap_keys;
+            uint32_t* swap_values = src_values;
+            src_values = dst_values;
+            dst_values = swap_values;
+        }
+
+        if (src_keys != keys)
+        {
+            memcpy(keys, src_keys, sizeof(uint64_t) * count);
+            memcpy(values, src_values, sizeof(uint32_t) * count);
+        }
+    }
+}
@@ -0,0 +1,38 @@
+// Copyright 2020-2024 The Defold Foundation
+// Copyright 2014-2020 King
+// Copyright 2009-2014 Ragnar Svensson, Christian Murray
+// Licensed under the Defold License version 1.0 (the "License"); you may not use
+// this file except in compliance with the License.
+//
+// You may obtain a copy of the License, together with FAQs at
+// https://www.defold.com/license
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#ifndef DM_RADIX_SORT_H
+#define DM_RADIX_SORT_H
+
+#include <stdint.h>
+
+/**
+ * Stable LSD radix sort of 32-bit values (typically indices) on integer keys.
+ * Sorts 8 bits per pass, and passes where all keys share the same digit are skipped.
+ */
+namespace dmRadixSort
+{
+    /**
+     * Sort the values in ascending order of their keys. Values with equal keys keep their relative order.
+     * @param keys [type: uint64_t*] keys, count entries. Sorted on return
+     * @param values [type: uint32_t*] values, count entries. Reordered along with the keys on return
+     * @param tmp_keys [type: uint64_t*] scratch buffer, count entries
+     * @param tmp_values [type: uint32_t*] scratch buffer, count entries
+     * @param count [type: uint32_t] number of entries
+     * @param key_bits [type: uint32_t] number of (low) bits of the keys to sort on (1-64), rounded up to whole bytes
+     */
+    void Sort(uint64_t* keys, uint32_t* values, uint64_t* tmp_keys, uint32_t* tmp_values, uint32_t count, uint32_t key_bits);
+}
+
+#endif // DM_RADIX_SORT_H
@@ -27,6 +27,18 @@
 #include "atomic.h"
 #include "time.h"
 
+#if defined(__linux__) && !defined(__EMSCRIPTEN__)
+    #define DM_SOCKET_POLLER_EPOLL
+    #include <sys/epoll.h>
+    #include <unistd.h>
+#elif defined(__MACH__)
+    #define DM_SOCKET_POLLER_KQUEUE
+    #include <sys/types.h>
+    #include <sys/event.h>
+    #include <sys/time.h>
+    #include <unistd.h>
+#endif
+
 // Helper and utility functions
 namespace dmSocket
 {
@@ -282,4 +294,323 @@ namespace dmSocket
             return RESULT_OK;
         }
     }
+
+    static int PollerTimeoutToMilliseconds(int32_t timeout)
+    {
+        // Round up, so that a short timeout doesn't turn into a busy loop
+        return timeout < 0 ? -1 : (timeout + 999) / 1000;
+    }
+
+#if defined(DM_SOCKET_POLLER_EPOLL) || defined(DM_SOCKET_POLLER_KQUEUE)
+    // The registrations are indexed by the socket, which is a small integer on these platforms
+    struct PollerRegistration
+    {
+        void*    m_UserData;
+        uint32_t m_Flags;
+        uint32_t m_Registered : 1;
+    };
+
+    struct Poller
+    {
+        int                          m_Fd;
+        dmArray<PollerRegistration>  m_Registrations;
+    #if defined(DM_SOCKET_POLLER_EPOLL)
+        dmArray<struct epoll_event>  m_NativeEvents;
+    #else
+        dmArray<struct kevent>       m_NativeEvents;
+    #endif
+    };
+
+    static PollerRegistration* GetPollerRegistration(Poller* poller, Socket socket, bool create)
+    {
+        if (socket < 0)
+        {
+            return 0;
+        }
+
+        dmArray<PollerRegistration>& registrations = poller->m_Registrations;
+        if ((uint32_t) socket >= registrations.Size())
+        {
+            if (!create)
+            {
+                return 0;
+            }
+            uint32_t old_size = registrations.Size();
+            uint32_t new_size = dmMath::Max((uint32_t) socket + 1, 2 * old_size);
+            registrations.SetCapacity(new_size);
+            registrations.SetSize(new_size);
+            memset(registrations.Begin() + old_size, 0, sizeof(PollerRegistration) * (new_size - old_size));
+        }
+        return &registrations[socket];
+    }
+
+    Result NewPoller(HPoller* poller)
+    {
+    #if defined(DM_SOCKET_POLLER_EPOLL)
+        int fd = epoll_create1(EPOLL_CLOEXEC);
+    #else
+        int fd = kqueue();
+    #endif
+        if (fd < 0)
+        {
+            *poller = 0;
+            return NATIVETORESULT(DM_SOCKET_ERRNO);
+        }
+
+        Poller* p = new Poller;
+        p->m_Fd = fd;
+        *poller = p;
+        return RESULT_OK;
+    }
+
+    void DeletePoller(HPoller poller)
+    {
+        close(poller->m_Fd);
+        delete poller;
+    }
+
+#if defined(DM_SOCKET_POLLER_KQUEUE)
+    static void KQueueChange(struct kevent* changes, int* change_count, Socket socket, int16_t filter, bool was_set, bool is_set, void* user_data)
+    {
+        if (is_set)
+        {
+            EV_SET(&changes[(*change_count)++], socket, filter, EV_ADD | EV_ENABLE, 0, 0, user_data);
+        }
+        else if (was_set)
+        {
+            EV_SET(&changes[(*change_count)++], socket, filter, EV_DELETE, 0, 0, 0);
+        }
+    }
+
+    static Result KQueueUpdate(Poller* poller, Socket socket, uint32_t old_flags, uint32_t flags, void* user_data)
+    {
+        struct kevent changes[2];
+        int change_count = 0;
+        KQueueChange(changes, &change_count, socket, EVFILT_READ, old_flags & POLLER_FLAG_READ, flags & POLLER_FLAG_READ, user_data);
+        KQueueChange(changes, &change_count, socket, EVFILT_WRITE, old_flags & POLLER_FLAG_WRITE, flags & POLLER_FLAG_WRITE, user_data);
+
+        if (change_count > 0 && kevent(poller->m_Fd, changes, change_count, 0, 0, 0) < 0)
+        {
+            return NATIVETORESULT(DM_SOCKET_ERRNO);
+        }
+        return RESULT_OK;
+    }
+#endif
+
+    Result PollerAdd(HPoller poller, Socket socket, uint32_t flags, void* user_data)
+    {
+        PollerRegistration* registration = GetPollerRegistration(poller, socket, true);
+        if (!registration)
+        {
+            return RESULT_BADF;
+        }
+
+    #if defined(DM_SOCKET_POLLER_EPOLL)
+        struct epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events  = ((flags & POLLER_FLAG_READ) ? EPOLLIN : 0) | ((flags & POLLER_FLAG_WRITE) ? EPOLLOUT : 0);
+        ev.data.fd = socket;
+        if (epoll_ctl(poller->m_Fd, registration->m_Registered ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, socket, &ev) < 0)
+        {
+            return NATIVETORESULT(DM_SOCKET_ERRNO);
+        }
+    #else
+        Result r = KQueueUpdate(poller, socket, registration->m_Registered ? registration->m_Flags : 0, flags, user_data);
+        if (r != RESULT_OK)
+        {
+            return r;
+        }
+    #endif
+
+        registration->m_UserData   = user_data;
+        registration->m_Flags      = flags;
+        registration->m_Registered = 1;
+        return RESULT_OK;
+    }
+
+    Result PollerRemove(HPoller poller, Socket socket)
+    {
+        PollerRegistration* registration = GetPollerRegistration(poller, socket, false);
+        if (!registration || !registration->m_Registered)
+        {
+            return RESULT_BADF;
+        }
+
+    #if defined(DM_SOCKET_POLLER_EPOLL)
+        struct epoll_event ev; // Ignored, but must be non-null on old kernels
+        memset(&ev, 0, sizeof(ev));
+        int r = epoll_ctl(poller->m_Fd, EPOLL_CTL_DEL, socket, &ev);
+    #else
+        int r = KQueueUpdate(poller, socket, registration->m_Flags, 0, 0) == RESULT_OK ? 0 : -1;
+    #endif
+
+        memset(registration, 0, sizeof(*registration));
+        if (r < 0)
+        {
+            return NATIVETORESULT(DM_SOCKET_ERRNO);
+        }
+        return RESULT_OK;
+    }
+
+    Result PollerWait(HPoller poller, PollerEvent* events, uint32_t max_events, int32_t timeout, uint32_t* event_count)
+    {
+        assert(max_events > 0);
+        *event_count = 0;
+        if (poller->m_NativeEvents.Capacity() < max_events)
+        {
+            poller->m_NativeEvents.SetCapacity(max_events);
+        }
+        poller->m_NativeEvents.SetSize(max_events);
+
+    #if defined(DM_SOCKET_POLLER_EPOLL)
+        int r = epoll_wait(poller->m_Fd, poller->m_NativeEvents.Begin(), (int) max_events, PollerTimeoutToMilliseconds(timeout));
+    #else
+        struct timespec ts;
+        ts.tv_sec  = timeout / 1000000;
+        ts.tv_nsec = (timeout % 1000000) * 1000;
+        int r = kevent(poller->m_Fd, 0, 0, poller->m_NativeEvents.Begin(), (int) max_events, timeout < 0 ? 0 : &ts);
+    #endif
+
+        if (r < 0)
+        {
+            return NATIVETORESULT(DM_SOCKET_ERRNO);
+        }
+
+        for (int i = 0; i < r; ++i)
+        {
+            PollerEvent& event = events[i];
+            memset(&event, 0, sizeof(event));
+
+        #if defined(DM_SOCKET_POLLER_EPOLL)
+            const struct epoll_event& native = poller->m_NativeEvents[i];
+            event.m_Socket   = native.data.fd;
+            event.m_Read     = (native.events & EPOLLIN) != 0;
+            event.m_Write    = (native.events & EPOLLOUT) != 0;
+            event.m_Error    = (native.events & (EPOLLERR | EPOLLHUP)) != 0;
+            event.m_UserData = poller->m_Registrations[event.m_Socket].m_UserData;
+        #else
+            const struct kevent& native = poller->m_NativeEvents[i];
+            event.m_Socket   = (Socket) native.ident;
+            event.m_Read     = native.filter == EVFILT_READ;
+            event.m_Write    = native.filter == EVFILT_WRITE;
+            event.m_Error    = (native.flags & (EV_ERROR | EV_EOF)) != 0;
+            event.m_UserData = native.udata;
+        #endif
+        }
+
+        *event_count = (uint32_t) r;
+        return (r == 0 && timeout > 0) ? RESULT_WOULDBLOCK : RESULT_OK;
+    }
+
+#else // poll() based fallback
+
+    struct Poller
+    {
+        dmFileDescriptor::Poller m_Poller;
+        dmArray<void*>           m_UserData;
+    };
+
+#if defined(_WIN32)
+    static const short POLLER_NATIVE_READ  = POLLRDNORM;
+    static const short POLLER_NATIVE_WRITE = POLLWRNORM;
+#else
+    static const short POLLER_NATIVE_READ  = POLLIN;
+    static const short POLLER_NATIVE_WRITE = POLLOUT;
+#endif
+
+    static int FindPollerSocket(Poller* poller, Socket socket)
+    {
+        dmArray<dmFileDescriptor::PollFD>& pollfds = poller->m_Poller.m_Pollfds;
+        for (uint32_t i = 0; i < pollfds.Size(); ++i)
+        {
+            if (pollfds[i].fd == socket)
+            {
+                return (int) i;
+            }
+        }
+        return -1;
+    }
+
+    Result NewPoller(HPoller* poller)
+    {
+        *poller = new Poller;
+        return RESULT_OK;
+    }
+
+    void DeletePoller(HPoller poller)
+    {
+        delete poller;
+    }
+
+    Result PollerAdd(HPoller poller, Socket socket, uint32_t flags, void* user_data)
+    {
+        short events = ((flags & POLLER_FLAG_READ) ? POLLER_NATIVE_READ : 0) | ((flags & POLLER_FLAG_WRITE) ? POLLER_NATIVE_WRITE : 0);
+
+        int index = FindPollerSocket(poller, socket);
+        if (index < 0)
+        {
+            dmArray<dmFileDescriptor::PollFD>& pollfds = poller->m_Poller.m_Pollfds;
+            if (pollfds.Full())
+            {
+                pollfds.OffsetCapacity(dmMath::Max(16u, pollfds.Capacity()));
+                poller->m_UserData.SetCapacity(pollfds.Capacity());
+            }
+            dmFileDescriptor::PollFD pfd;
+            memset(&pfd, 0, sizeof(pfd));
+            pfd.fd = socket;
+            pollfds.Push(pfd);
+            poller->m_UserData.Push(0);
+            index = (int) pollfds.Size() - 1;
+        }
+
+        poller->m_Poller.m_Pollfds[index].events = events;
+        poller->m_UserData[index] = user_data;
+        return RESULT_OK;
+    }
+
+    Result PollerRemove(HPoller poller, Socket socket)
+    {
+        int index = FindPollerSocket(poller, socket);
+        if (index < 0)
+        {
+            return RESULT_BADF;
+        }
+        poller->m_Poller.m_Pollfds.EraseSwap(index);
+        poller->m_UserData.EraseSwap(index);
+        return RESULT_OK;
+    }
+
+    Result PollerWait(HPoller poller, PollerEvent* events, uint32_t max_events, int32_t timeout, uint32_t* event_count)
+    {
+        assert(max_events > 0);
+        *event_count = 0;
+        int r = dmFileDescriptor::Wait(&poller->m_Poller, PollerTimeoutToMilliseconds(timeout));
+        if (r < 0)
+        {
+            return NATIVETORESULT(DM_SOCKET_ERRNO);
+        }
+
+        dmArray<dmFileDescriptor::PollFD>& pollfds = poller->m_Poller.m_Pollfds;
+        uint32_t count = 0;
+        for (uint32_t i = 0; i < pollfds.Size() && count < max_events && r > 0; ++i)
+        {
+            const dmFileDescriptor::PollFD& pfd = pollfds[i];
+            if (pfd.revents == 0)
+            {
+                continue;
+            }
+
+            PollerEvent& event = events[count++];
+            memset(&event, 0, sizeof(event));
+            event.m_Socket   = pfd.fd;
+            event.m_UserData = poller->m_UserData[i];
+            event.m_Read     = (pfd.revents & POLLER_NATIVE_READ) != 0;
+            event.m_Write    = (pfd.revents & POLLER_NATIVE_WRITE) != 0;
+            event.m_Error    = (pfd.revents & (POLLERR | POLLHUP | POLLNVAL)) != 0;
+        }
+
+        *event_count = count;
+        return (count == 0 && timeout > 0) ? RESULT_WOULDBLOCK : RESULT_OK;
+    }
+#endif
 }
@@ -137,6 +137,50 @@ namespace dmSocket
     Result ReceiveFrom(Socket socket, void* buffer, int length, int* received_bytes,
                        Address* from_addr, uint16_t* from_port);
 
+    /**
+     * A datagram for the batched send and receive functions
+     */
+    struct Datagram
+    {
+        void*    m_Buffer;
+        // Sending: the data size. Receiving: the buffer size, and the received size (result)
+        uint32_t m_Size;
+        // Sending: the destination. Receiving: the source (result)
+        Address  m_Address;
+        uint16_t m_Port;
+    };
+
+    /**
+     * Send several datagrams. Uses a single system call per batch where available (sendmmsg)
+     * @note Intended for non-blocking sockets. The datagrams that weren't sent may be retried later
+     * @param socket Socket to send the datagrams on
+     * @param datagrams Datagrams to send
+     * @param count Number of datagrams
+     * @param sent_count Number of datagrams sent (result), always the first ones
+     * @return RESULT_OK if at least one datagram was sent, or if count is 0
+     */
+    Result SendToBatch(Socket socket, const Datagram* datagrams, uint32_t count, uint32_t* sent_count);
+
+    /**
+     * Receive several datagrams. Uses a single system call per batch where available (recvmmsg)
+     * @note Intended for non-blocking sockets. Datagrams larger than the buffer are truncated
+     * @param socket Socket to receive the datagrams on
+     * @param datagrams Datagrams to receive to
+     * @param count Number of datagrams
+     * @param received_count Number of datagrams received (result)
+     * @return RESULT_OK if at least one datagram was received, RESULT_WOULDBLOCK if there was none
+     */
+    Result ReceiveFromBatch(Socket socket, Datagram* datagrams, uint32_t count, uint32_t* received_count);
+
+    /**
+     * Set the size of the socket receive buffer, i.e. the amount of incoming data the system queues
+     * before it starts to drop datagrams
+     * @param socket Socket
+     * @param size Buffer size in bytes
+     * @return RESULT_OK on success
+     */
+    Result SetReceiveBufferSize(Socket socket, uint32_t size);
+
 
     /**
      * Get name, address and port for socket
@@ -247,6 +291,71 @@ namespace dmSocket
      * @return Number of bits that differs between a and b
      */
     uint32_t BitDifference(Address a, Address b);
+
+    /**
+     * Event poller. Unlike the Selector, the sockets stay registered between the waits,
+     * and a wait only returns the sockets that are ready. It uses epoll on Linux and Android,
+     * kqueue on macOS and iOS, and poll (WSAPoll on Windows) elsewhere.
+     */
+    typedef struct Poller* HPoller;
+
+    enum PollerFlags
+    {
+        POLLER_FLAG_READ  = 1,
+        POLLER_FLAG_WRITE = 2,
+    };
+
+    struct PollerEvent
+    {
+        Socket   m_Socket;
+        void*    m_UserData;
+        uint8_t  m_Read  : 1;
+        uint8_t  m_Write : 1;
+        // Error or hang up. Reading from the socket returns the error
+        uint8_t  m_Error : 1;
+    };
+
+    /**
+     * Create a poller
+     * @param poller Pointer to the poller handle
+     * @return RESULT_OK on success
+     */
+    Result NewPoller(HPoller* poller);
+
+    /**
+     * Delete a poller. The registered sockets are not closed.
+     * @param poller Poller handle
+     */
+    void DeletePoller(HPoller poller);
+
+    /**
+     * Register a socket, or change the events it's polled for
+     * @param poller Poller handle
+     * @param socket Socket
+     * @param flags Mask of PollerFlags
+     * @param user_data Returned with the events of the socket
+     * @return RESULT_OK on success
+     */
+    Result PollerAdd(HPoller poller, Socket socket, uint32_t flags, void* user_data);
+
+    /**
+     * Unregister a socket. Must be called before the socket is deleted.
+     * @param poller Poller handle
+     * @param socket Socket
+     * @return RESULT_OK on success
+     */
+    Result PollerRemove(HPoller poller, Socket socket);
+
+    /**
+     * Wait for events on the registered sockets
+     * @param poller Poller handle
+     * @param events Array that receives the events
+     * @param max_events Size of the events array
+     * @param timeout Timeout in microseconds. For blocking pass -1
+     * @param event_count Number of events written to the array
+     * @return RESULT_OK on success, or RESULT_WOULDBLOCK if the wait timed out
+     */
+    Result PollerWait(HPoller poller, PollerEvent* events, uint32_t max_events, int32_t timeout, uint32_t* event_count);
 }
 
 #endif // DM_SOCKET_H
@@ -97,6 +97,20 @@ namespace dmSocket
         return RESULT_OPNOTSUPP;
     }
 
+    Result SendToBatch(Socket socket, const Datagram* datagrams, uint32_t count, uint32_t* sent_count) {
+        *sent_count = 0;
+        return RESULT_OPNOTSUPP;
+    }
+
+    Result ReceiveFromBatch(Socket socket, Datagram* datagrams, uint32_t count, uint32_t* received_count) {
+        *received_count = 0;
+        return RESULT_OPNOTSUPP;
+    }
+
+    Result SetReceiveBufferSize(Socket socket, uint32_t size) {
+        return RESULT_OPNOTSUPP;
+    }
+
     void SelectorClear(Selector* selector, SelectorKind selector_kind, Socket socket) {
     }
 
@@ -114,6 +128,27 @@ namespace dmSocket
         return RESULT_OPNOTSUPP;
     }
 
+    Result NewPoller(HPoller* poller) {
+        *poller = 0;
+        return RESULT_OPNOTSUPP;
+    }
+
+    void DeletePoller(HPoller poller) {
+    }
+
+    Result PollerAdd(HPoller poller, Socket socket, uint32_t flags, void* user_data) {
+        return RESULT_OPNOTSUPP;
+    }
+
+    Result PollerRemove(HPoller poller, Socket socket) {
+        return RESULT_OPNOTSUPP;
+    }
+
+    Result PollerWait(HPoller poller, PollerEvent* events, uint32_t max_events, int32_t timeout, uint32_t* event_count) {
+        *event_count = 0;
+        return RESULT_OPNOTSUPP;
+    }
+
     Result GetName(Socket socket, Address*address, uint16_t* port) {
         return RESULT_OPNOTSUPP;
     }
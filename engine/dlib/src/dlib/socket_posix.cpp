@@ -34,6 +34,12 @@
 #endif
 
 #include "socket_private.h"
+#include "math.h"
+
+#if defined(__linux__) && !defined(__EMSCRIPTEN__)
+    // recvmmsg/sendmmsg
+    #define DM_SOCKET_MMSG
+#endif
 
 // Helper and utility functions
 namespace dmSocket
@@ -587,6 +593,188 @@ namespace dmSocket
         return result >= 0 ? RESULT_OK : NativeToResultCompat(DM_SOCKET_ERRNO);
     }
 
+    static socklen_t ToSockAddr(const Address& address, uint16_t port, struct sockaddr_storage* sock_addr)
+    {
+        memset(sock_addr, 0, sizeof(*sock_addr));
+        if (address.m_family == DOMAIN_IPV4)
+        {
+            struct sockaddr_in* addr = (struct sockaddr_in*) sock_addr;
+            addr->sin_family = AF_INET;
+            addr->sin_addr.s_addr = address.m_address[3];
+            addr->sin_port = htons(port);
+            return sizeof(struct sockaddr_in);
+        }
+#if !defined(DM_IPV6_UNSUPPORTED)
+        else if (address.m_family == DOMAIN_IPV6)
+        {
+            struct sockaddr_in6* addr = (struct sockaddr_in6*) sock_addr;
+            addr->sin6_family = AF_INET6;
+            memcpy(&addr->sin6_addr, address.m_address, sizeof(struct in6_addr));
+            addr->sin6_port = htons(port);
+            return sizeof(struct sockaddr_in6);
+        }
+#endif
+        return 0;
+    }
+
+    static void FromSockAddr(const struct sockaddr_storage* sock_addr, Address* address, uint16_t* port)
+    {
+        if (sock_addr->ss_family == AF_INET)
+        {
+            const struct sockaddr_in* addr = (const struct sockaddr_in*) sock_addr;
+            address->m_family = DOMAIN_IPV4;
+            *IPv4(address) = addr->sin_addr.s_addr;
+            *port = ntohs(addr->sin_port);
+        }
+#if !defined(DM_IPV6_UNSUPPORTED)
+        else if (sock_addr->ss_family == AF_INET6)
+        {
+            const struct sockaddr_in6* addr = (const struct sockaddr_in6*) sock_addr;
+            address->m_family = DOMAIN_IPV6;
+            memcpy(IPv6(address), &addr->sin6_addr, sizeof(struct in6_addr));
+            *port = ntohs(addr->sin6_port);
+        }
+#endif
+    }
+
+#if defined(DM_SOCKET_MMSG)
+    // The number of datagrams per system call
+    static const uint32_t MAX_MMSG_BATCH = 32;
+
+    Result SendToBatch(Socket socket, const Datagram* datagrams, uint32_t count, uint32_t* sent_count)
+    {
+        struct mmsghdr          msgs[MAX_MMSG_BATCH];
+        struct iovec            iovs[MAX_MMSG_BATCH];
+        struct sockaddr_storage addrs[MAX_MMSG_BATCH];
+
+        *sent_count = 0;
+        while (*sent_count < count)
+        {
+            uint32_t batch_count = dmMath::Min(count - *sent_count, MAX_MMSG_BATCH);
+            const Datagram* batch = datagrams + *sent_count;
+            memset(msgs, 0, sizeof(msgs[0]) * batch_count);
+            for (uint32_t i = 0; i < batch_count; ++i)
+            {
+                iovs[i].iov_base = batch[i].m_Buffer;
+                iovs[i].iov_len  = batch[i].m_Size;
+                msgs[i].msg_hdr.msg_iov     = &iovs[i];
+                msgs[i].msg_hdr.msg_iovlen  = 1;
+                msgs[i].msg_hdr.msg_name    = &addrs[i];
+                msgs[i].msg_hdr.msg_namelen = ToSockAddr(batch[i].m_Address, batch[i].m_Port, &addrs[i]);
+            }
+
+            int r = sendmmsg(socket, msgs, batch_count, 0);
+            if (r < 0)
+            {
+                return *sent_count > 0 ? RESULT_OK : NativeToResultCompat(DM_SOCKET_ERRNO);
+            }
+            *sent_count += (uint32_t) r;
+            if ((uint32_t) r < batch_count)
+            {
+                break;
+            }
+        }
+        return RESULT_OK;
+    }
+
+    Result ReceiveFromBatch(Socket socket, Datagram* datagrams, uint32_t count, uint32_t* received_count)
+    {
+        struct mmsghdr          msgs[MAX_MMSG_BATCH];
+        struct iovec            iovs[MAX_MMSG_BATCH];
+        struct sockaddr_storage addrs[MAX_MMSG_BATCH];
+
+        *received_count = 0;
+        while (*received_count < count)
+        {
+            uint32_t batch_count = dmMath::Min(count - *received_count, MAX_MMSG_BATCH);
+            Datagram* batch = datagrams + *received_count;
+            memset(msgs, 0, sizeof(msgs[0]) * batch_count);
+            for (uint32_t i = 0; i < batch_count; ++i)
+            {
+                iovs[i].iov_base = batch[i].m_Buffer;
+                iovs[i].iov_len  = batch[i].m_Size;
+                msgs[i].msg_hdr.msg_iov     = &iovs[i];
+                msgs[i].msg_hdr.msg_iovlen  = 1;
+                msgs[i].msg_hdr.msg_name    = &addrs[i];
+                msgs[i].msg_hdr.msg_namelen = sizeof(addrs[i]);
+            }
+
+            int r = recvmmsg(socket, msgs, batch_count, MSG_DONTWAIT, 0);
+            if (r < 0)
+            {
+                return *received_count > 0 ? RESULT_OK : NativeToResultCompat(DM_SOCKET_ERRNO);
+            }
+            for (int i = 0; i < r; ++i)
+            {
+                batch[i].m_Size = dmMath::Min((uint32_t) msgs[i].msg_len, batch[i].m_Size);
+                FromSockAddr(&addrs[i], &batch[i].m_Address, &batch[i].m_Port);
+            }
+            *received_count += (uint32_t) r;
+            if ((uint32_t) r < batch_count)
+            {
+                break;
+            }
+        }
+        return RESULT_OK;
+    }
+#else
+    Result SendToBatch(Socket socket, const Datagram* datagrams, uint32_t count, uint32_t* sent_count)
+    {
+        *sent_count = 0;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            struct sockaddr_storage sock_addr;
+            socklen_t addr_len = ToSockAddr(datagrams[i].m_Address, datagrams[i].m_Port, &sock_addr);
+#ifdef _WIN32
+            int r = (int) sendto(socket, (const char*) datagrams[i].m_Buffer, (int) datagrams[i].m_Size, 0, (const sockaddr*) &sock_addr, addr_len);
+#else
+            int r = (int) sendto(socket, datagrams[i].m_Buffer, datagrams[i].m_Size, 0, (const sockaddr*) &sock_addr, addr_len);
+#endif
+            if (r < 0)
+            {
+                return i > 0 ? RESULT_OK : NativeToResultCompat(DM_SOCKET_ERRNO);
+            }
+            *sent_count = i + 1;
+        }
+        return RESULT_OK;
+    }
+
+    Result ReceiveFromBatch(Socket socket, Datagram* datagrams, uint32_t count, uint32_t* received_count)
+    {
+        *received_count = 0;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            struct sockaddr_storage sock_addr = { 0 };
+            socklen_t addr_len = sizeof(sock_addr);
+#ifdef _WIN32
+            int r = recvfrom(socket, (char*) datagrams[i].m_Buffer, (int) datagrams[i].m_Size, 0, (struct sockaddr*) &sock_addr, &addr_len);
+            if (r < 0 && WSAGetLastError() == WSAEMSGSIZE)
+            {
+                // The datagram was truncated, like on the other platforms
+                r = (int) datagrams[i].m_Size;
+            }
+#else
+            int r = (int) recvfrom(socket, datagrams[i].m_Buffer, datagrams[i].m_Size, 0, (struct sockaddr*) &sock_addr, &addr_len);
+#endif
+            if (r < 0)
+            {
+                return i > 0 ? RESULT_OK : NativeToResultCompat(DM_SOCKET_ERRNO);
+            }
+            datagrams[i].m_Size = (uint32_t) r;
+            FromSockAddr(&sock_addr, &datagrams[i].m_Address, &datagrams[i].m_Port);
+            *received_count = i + 1;
+        }
+        return RESULT_OK;
+    }
+#endif
+
+    Result SetReceiveBufferSize(Socket socket, uint32_t size)
+    {
+        int value = (int) size;
+        int ret = setsockopt(socket, SOL_SOCKET, SO_RCVBUF, (char*) &value, sizeof(value));
+        return ret >= 0 ? RESULT_OK : NATIVETORESULT(DM_SOCKET_ERRNO);
+    }
+
     Result GetName(Socket socket, Address* address, uint16_t* port)
     {
         int result = -1;
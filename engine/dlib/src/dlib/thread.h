@@ -17,7 +17,9 @@
 
 #include <dmsdk/dlib/thread.h>
 
-#if !defined(__EMSCRIPTEN__)
+// On HTML5, threads (Web Workers) are only available in builds made with -pthread,
+// which in turn require a cross-origin isolated page (SharedArrayBuffer)
+#if !defined(__EMSCRIPTEN__) || defined(__EMSCRIPTEN_PTHREADS__)
     #define DM_HAS_THREADS
 #endif
 
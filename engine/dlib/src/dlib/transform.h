@@ -16,6 +16,8 @@
 #define DM_TRANSFORM_H
 
 #include <assert.h>
+#include <math.h>
+#include <stdint.h>
 #include <dmsdk/dlib/transform.h>
 #include <dmsdk/dlib/vmath.h>
 
@@ -179,6 +181,132 @@ namespace dmTransform
         res = appendScale(res, dmVMath::Vector3(t.GetScale()));
         return res;
     }
+
+    /// Number of transforms processed together by the batched functions below
+    const uint32_t TRANSFORM_BATCH_SIZE = 4;
+
+    /**
+     * A batch of transforms stored as a structure of arrays, one array per component
+     * and TRANSFORM_BATCH_SIZE lanes in each array. Lets the batched matrix calculations
+     * below process all lanes with the same instructions (which the compiler can vectorize).
+     */
+    struct TransformBatch
+    {
+        float m_Translation[3][TRANSFORM_BATCH_SIZE];
+        float m_Rotation[4][TRANSFORM_BATCH_SIZE];
+        float m_Scale[3][TRANSFORM_BATCH_SIZE];
+    };
+
+    /**
+     * Store a transform in a lane of a batch
+     * @param batch Batch to store the transform in
+     * @param lane Lane index [0, TRANSFORM_BATCH_SIZE)
+     * @param t Transform to store
+     */
+    inline void SetBatchTransform(TransformBatch* batch, uint32_t lane, const Transform& t)
+    {
+        const dmVMath::Vector3& translation = t.GetTranslation();
+        const dmVMath::Quat& rotation = t.GetRotation();
+        const dmVMath::Vector3& scale = t.GetScale();
+        batch->m_Translation[0][lane] = translation.getX();
+        batch->m_Translation[1][lane] = translation.getY();
+        batch->m_Translation[2][lane] = translation.getZ();
+        batch->m_Rotation[0][lane] = rotation.getX();
+        batch->m_Rotation[1][lane] = rotation.getY();
+        batch->m_Rotation[2][lane] = rotation.getZ();
+        batch->m_Rotation[3][lane] = rotation.getW();
+        batch->m_Scale[0][lane] = scale.getX();
+        batch->m_Scale[1][lane] = scale.getY();
+        batch->m_Scale[2][lane] = scale.getZ();
+    }
+
+    /**
+     * Convert a batch of transforms into matrices and multiply them by their parent matrices, i.e.
+     * out[i] = parents[i] * ToMatrix4(t[i]), or MulNoScaleZ(*parents[i], ToMatrix4(t[i])) if scale_along_z is false.
+     * @param batch Transforms to convert
+     * @param parents TRANSFORM_BATCH_SIZE parent matrices (use the identity matrix for transforms without parent)
+     * @param scale_along_z If the z component of the translation should be affected by the parent scale
+     * @param out TRANSFORM_BATCH_SIZE resulting matrices
+     */
+    inline void MulToMatrix4Batch(const TransformBatch& batch, const dmVMath::Matrix4* const* parents, bool scale_along_z, dmVMath::Matrix4* out)
+    {
+        const uint32_t N = TRANSFORM_BATCH_SIZE;
+
+        // Parent matrices as [column][row][lane]
+        float p[4][4][N];
+        for (uint32_t lane = 0; lane < N; ++lane)
+        {
+            for (uint32_t c = 0; c < 4; ++c)
+            {
+                dmVMath::Vector4 col = parents[lane]->getCol(c);
+                p[c][0][lane] = col.getX();
+                p[c][1][lane] = col.getY();
+                p[c][2][lane] = col.getZ();
+                p[c][3][lane] = col.getW();
+            }
+        }
+
+        // Factor for the parent z-axis when applied to the translation (see NormalizeZScale)
+        float z_factor[N];
+        for (uint32_t lane = 0; lane < N; ++lane)
+        {
+            float z_mag_sqr = p[2][0][lane]*p[2][0][lane] + p[2][1][lane]*p[2][1][lane] + p[2][2][lane]*p[2][2][lane] + p[2][3][lane]*p[2][3][lane];
+            z_factor[lane] = (scale_along_z || z_mag_sqr <= 0.0f) ? 1.0f : 1.0f / sqrtf(z_mag_sqr);
+        }
+
+        // Local rotation and scale as [column][row][lane]
+        float l[3][3][N];
+        for (uint32_t lane = 0; lane < N; ++lane)
+        {
+            float qx = batch.m_Rotation[0][lane];
+            float qy = batch.m_Rotation[1][lane];
+            float qz = batch.m_Rotation[2][lane];
+            float qw = batch.m_Rotation[3][lane];
+            float qx2 = qx + qx;
+            float qy2 = qy + qy;
+            float qz2 = qz + qz;
+            float sx = batch.m_Scale[0][lane];
+            float sy = batch.m_Scale[1][lane];
+            float sz = batch.m_Scale[2][lane];
+            l[0][0][lane] = (1.0f - qy*qy2 - qz*qz2) * sx;
+            l[0][1][lane] = (qx*qy2 + qw*qz2) * sx;
+            l[0][2][lane] = (qx*qz2 - qw*qy2) * sx;
+            l[1][0][lane] = (qx*qy2 - qw*qz2) * sy;
+            l[1][1][lane] = (1.0f - qx*qx2 - qz*qz2) * sy;
+            l[1][2][lane] = (qy*qz2 + qw*qx2) * sy;
+            l[2][0][lane] = (qx*qz2 + qw*qy2) * sz;
+            l[2][1][lane] = (qy*qz2 - qw*qx2) * sz;
+            l[2][2][lane] = (1.0f - qx*qx2 - qy*qy2) * sz;
+        }
+
+        float res[4][4][N];
+        for (uint32_t c = 0; c < 3; ++c)
+        {
+            for (uint32_t r = 0; r < 4; ++r)
+            {
+                for (uint32_t lane = 0; lane < N; ++lane)
+                {
+                    res[c][r][lane] = p[0][r][lane]*l[c][0][lane] + p[1][r][lane]*l[c][1][lane] + p[2][r][lane]*l[c][2][lane];
+                }
+            }
+        }
+        for (uint32_t r = 0; r < 4; ++r)
+        {
+            for (uint32_t lane = 0; lane < N; ++lane)
+            {
+                res[3][r][lane] = p[0][r][lane]*batch.m_Translation[0][lane] + p[1][r][lane]*batch.m_Translation[1][lane]
+                                + p[2][r][lane]*batch.m_Translation[2][lane]*z_factor[lane] + p[3][r][lane];
+            }
+        }
+
+        for (uint32_t lane = 0; lane < N; ++lane)
+        {
+            for (uint32_t c = 0; c < 4; ++c)
+            {
+                out[lane].setCol(c, dmVMath::Vector4(res[c][0][lane], res[c][1][lane], res[c][2][lane], res[c][3][lane]));
+            }
+        }
+    }
 }
 
 #endif // DM_TRANSFORM_H
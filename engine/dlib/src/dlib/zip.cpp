@@ -79,6 +79,20 @@ Result GetEntryIndex(HZip zip, uint32_t* out_index)
     return RESULT_OK;
 }
 
+bool IsEntryStored(HZip zip)
+{
+    return zip_entry_isstored(zip) == 1;
+}
+
+Result GetEntryDataOffset(HZip zip, uint32_t* offset)
+{
+    unsigned long long data_offset;
+    if (zip_entry_dataoffset(zip, &data_offset) != 0 || data_offset > 0xFFFFFFFF)
+        return RESULT_NO_SUCH_ENTRY;
+    *offset = (uint32_t)data_offset;
+    return RESULT_OK;
+}
+
 Result GetEntryData(HZip zip, void* buffer, uint32_t buffer_size)
 {
     ssize_t nwritten = zip_entry_noallocread(zip, buffer, (size_t)buffer_size);
@@ -84,6 +84,15 @@ namespace dmZip
      *
      */
     Result GetEntryData(HZip zip, void* buffer, uint32_t buffer_size);
+
+    /*# Returns true if the currently open entry is stored without compression
+     */
+    bool IsEntryStored(HZip zip);
+
+    /*# gets the offset of the data of the currently open entry, from the start of the zip file
+     * Used to read stored entries directly from a memory mapped zip file
+     */
+    Result GetEntryDataOffset(HZip zip, uint32_t* offset);
 }
 
 #endif // DM_ZIP_H
\ No newline at end of file
@@ -0,0 +1,176 @@
+// Copyright 2020-2024 The Defold Foundation
+// Copyright 2014-2020 King
+// Copyright 2009-2014 Ragnar Svensson, Christian Murray
+// Licensed under the Defold License version 1.0 (the "License"); you may not use
+// this file except in compliance with the License.
+//
+// You may obtain a copy of the License, together with FAQs at
+// https://www.defold.com/license
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#ifndef DMSDK_JOB_H
+#define DMSDK_JOB_H
+
+#include <stdint.h>
+#include <dmsdk/dlib/atomic.h>
+
+/*# SDK Job API documentation
+ * [file:<dmsdk/dlib/job.h>]
+ *
+ * Functions for running work on the engine worker threads, instead of creating extra threads.
+ *
+ * @document
+ * @name Job
+ * @namespace dmJobThread
+ * @path engine/dlib/src/dmsdk/dlib/job.h
+ */
+
+namespace dmJobThread
+{
+    /*# job context handle
+     * @typedef
+     * @name HContext
+     */
+    typedef struct JobContext* HContext;
+
+    /*# job function
+     * Called on a worker thread
+     * @typedef
+     * @name FProcess
+     * @param context [type:void*] the user context
+     * @param data [type:void*] the job data
+     * @return result [type:int] the result, passed on to the callback
+     */
+    typedef int (*FProcess)(void* context, void* data);
+
+    /*# job completion callback
+     * Called on the main thread, after the job has finished
+     * @typedef
+     * @name FCallback
+     * @param context [type:void*] the user context
+     * @param data [type:void*] the job data
+     * @param result [type:int] the result of the job function
+     */
+    typedef void (*FCallback)(void* context, void* data, int result);
+
+    /*# job group
+     * Counts the unfinished jobs of a batch.
+     * A group with a parent counts as one unfinished job of the parent, until the group is done.
+     * Jobs may push more jobs to their own group, and the group isn't done until those have finished too.
+     * @struct
+     * @name JobGroup
+     * @member m_Parent [type:JobGroup*] the parent group, or 0
+     * @member m_Pending [type:int32_atomic_t] the number of unfinished jobs
+     */
+    struct JobGroup
+    {
+        JobGroup*       m_Parent;
+        int32_atomic_t  m_Pending;
+    };
+
+    /*# get the engine job context
+     * Gets the job context of the engine worker threads, shared by the engine systems and the extensions.
+     * The completion callbacks of its jobs are called on the main thread, once per frame.
+     * @name dmJobThread::GetDefaultContext
+     * @return context [type:dmJobThread::HContext] the context, or 0 before the engine has created it
+     */
+    HContext GetDefaultContext();
+
+    /*# push a job
+     * Pushes a job, which is run on a worker thread. The callback is called on the main thread once it has finished.
+     * The jobs are started in the order they were pushed.
+     * @name dmJobThread::PushJob
+     * @param context [type:dmJobThread::HContext] the job context
+     * @param process [type:dmJobThread::FProcess] the job function
+     * @param callback [type:dmJobThread::FCallback] the completion callback, or 0
+     * @param user_context [type:void*] the user context
+     * @param data [type:void*] the job data
+     * @examples
+     *
+     * ```cpp
+     * static int FindPath(void* context, void* data)
+     * {
+     *     PathRequest* request = (PathRequest*) data;
+     *     return AStar(request) ? 1 : 0;
+     * }
+     *
+     * static void FindPathDone(void* context, void* data, int result)
+     * {
+     *     PathRequest* request = (PathRequest*) data;
+     *     ReportPath(request, result != 0); // Safe to call Lua here
+     * }
+     *
+     * dmJobThread::PushJob(dmJobThread::GetDefaultContext(), FindPath, FindPathDone, 0, request);
+     * ```
+     */
+    void     PushJob(HContext context, FProcess process, FCallback callback, void* user_context, void* data);
+
+    /*# get the number of worker threads
+     * @name dmJobThread::GetWorkerCount
+     * @param context [type:dmJobThread::HContext] the job context
+     * @return count [type:uint32_t] the number of worker threads. 0 on platforms without threads
+     */
+    uint32_t GetWorkerCount(HContext context);
+
+    /*# initialize a job group
+     * Initializes an empty job group
+     * @name dmJobThread::InitGroup
+     * @param group [type:dmJobThread::JobGroup*] the group
+     * @param parent [type:dmJobThread::JobGroup*] the parent group, or 0
+     */
+    void     InitGroup(JobGroup* group, JobGroup* parent);
+
+    /*# push a job to a group
+     * Pushes a job to a group. Unlike PushJob(), group jobs have no callback, and they are queued per worker
+     * where idle workers (and threads waiting in WaitGroup()) steal from the others.
+     * There is no ordering between the jobs.
+     * If the context is 0, the job is run directly on the calling thread.
+     * @name dmJobThread::PushGroupJob
+     * @param context [type:dmJobThread::HContext] the job context
+     * @param group [type:dmJobThread::JobGroup*] the group
+     * @param process [type:dmJobThread::FProcess] the job function. The result is ignored
+     * @param user_context [type:void*] the user context
+     * @param data [type:void*] the job data
+     * @examples
+     *
+     * ```cpp
+     * static int GenerateChunk(void* context, void* data)
+     * {
+     *     GenerateTerrainChunk((World*) context, (Chunk*) data);
+     *     return 0;
+     * }
+     *
+     * dmJobThread::HContext job_context = dmJobThread::GetDefaultContext();
+     * dmJobThread::JobGroup group;
+     * dmJobThread::InitGroup(&group, 0);
+     * for (uint32_t i = 0; i < chunk_count; ++i)
+     * {
+     *     dmJobThread::PushGroupJob(job_context, &group, GenerateChunk, world, &chunks[i]);
+     * }
+     * dmJobThread::WaitGroup(job_context, &group);
+     * ```
+     */
+    void     PushGroupJob(HContext context, JobGroup* group, FProcess process, void* user_context, void* data);
+
+    /*# check if a job group is done
+     * @name dmJobThread::IsGroupDone
+     * @param group [type:dmJobThread::JobGroup*] the group
+     * @return done [type:bool] true if all the jobs of the group (and its child groups) have finished
+     */
+    bool     IsGroupDone(JobGroup* group);
+
+    /*# wait for a job group
+     * Waits for all the jobs of the group to finish. The calling thread runs queued group jobs while waiting,
+     * so it is safe to call without any worker threads, as well as from within a group job.
+     * @name dmJobThread::WaitGroup
+     * @param context [type:dmJobThread::HContext] the job context
+     * @param group [type:dmJobThread::JobGroup*] the group
+     */
+    void     WaitGroup(HContext context, JobGroup* group);
+}
+
+#endif // DMSDK_JOB_H
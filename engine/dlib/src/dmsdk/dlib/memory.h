@@ -15,6 +15,8 @@
 #ifndef DMSDK_MEMORY_H
 #define DMSDK_MEMORY_H
 
+#include <stdint.h>
+
 /*# SDK Memory API documentation
  * Memory allocation functions
  *
@@ -59,6 +61,148 @@ namespace dmMemory
      * @param memptr [type: void*] A pointer to the memory block that was returned by dmMemory::AlignedMalloc
      */
     void AlignedFree(void* memptr);
+
+    /*#
+     * Allocate scratch memory from the frame allocator.
+     * The memory is valid until the end of the next frame (i.e. until dmMemory::FrameAllocatorNewFrame
+     * has been called twice), and must not be freed.
+     * Each thread allocates from its own arena, so no locking is involved. If the arena is exhausted,
+     * 0 is returned, and the arena grows to fit the requested memory the next time it's reused.
+     *
+     * @name FrameAlloc
+     * @param size [type: uint32_t] Size of the requested memory allocation.
+     * @param alignment [type: uint32_t] The alignment value, which must be an integer power of 2.
+     * @return memory [type: void*] Pointer to the memory, or 0 if the arena is exhausted.
+     * @examples
+     *
+     * ```cpp
+     * float* scratch = (float*)dmMemory::FrameAlloc(count * sizeof(float), 16);
+     * if (!scratch)
+     * {
+     *     // fallback to a regular allocation
+     * }
+     * ```
+     */
+    void* FrameAlloc(uint32_t size, uint32_t alignment);
+
+    /*#
+     * Advances the frame allocator to the next frame.
+     * Memory allocated with dmMemory::FrameAlloc in the previous frame remains valid, while memory from
+     * the frame before that is reused. Called by the engine at the start of each frame.
+     *
+     * @name FrameAllocatorNewFrame
+     */
+    void FrameAllocatorNewFrame();
+
+    /*# memory accounting category
+     *
+     * The subsystems that report their memory usage.
+     * The categories may overlap, e.g. the resource sizes include the sound data owned by the sound system.
+     *
+     * @enum
+     * @name Category
+     * @member dmMemory::CATEGORY_RESOURCE Loaded resources
+     * @member dmMemory::CATEGORY_LUA Lua contexts
+     * @member dmMemory::CATEGORY_GRAPHICS Vertex and index buffers
+     * @member dmMemory::CATEGORY_SOUND Sound data and decoded pcm
+     * @member dmMemory::CATEGORY_PHYSICS Physics
+     * @member dmMemory::CATEGORY_OTHER Anything else, e.g. native extensions
+     */
+    enum Category
+    {
+        CATEGORY_RESOURCE,
+        CATEGORY_LUA,
+        CATEGORY_GRAPHICS,
+        CATEGORY_SOUND,
+        CATEGORY_PHYSICS,
+        CATEGORY_OTHER,
+        MAX_CATEGORY_COUNT
+    };
+
+    /*#
+     * Called when the memory usage of a category grows past its budget
+     * @typedef
+     * @name BudgetCallback
+     * @param category [type: dmMemory::Category] The category
+     * @param usage [type: uint32_t] The current usage in bytes
+     * @param budget [type: uint32_t] The budget in bytes
+     * @param user_data [type: void*] The user data passed to dmMemory::SetBudgetCallback
+     */
+    typedef void (*BudgetCallback)(Category category, uint32_t usage, uint32_t budget, void* user_data);
+
+    /*#
+     * Accounts for memory allocated by a subsystem.
+     * The counters are always enabled, and are updated atomically, so it's safe to call from any thread.
+     * @name TrackAlloc
+     * @param category [type: dmMemory::Category] The category
+     * @param size [type: uint32_t] The number of bytes allocated
+     */
+    void TrackAlloc(Category category, uint32_t size);
+
+    /*#
+     * Accounts for memory freed by a subsystem.
+     * @name TrackFree
+     * @param category [type: dmMemory::Category] The category
+     * @param size [type: uint32_t] The number of bytes freed
+     */
+    void TrackFree(Category category, uint32_t size);
+
+    /*#
+     * Sets the memory usage of a category that is sampled rather than tracked per allocation
+     * @name SetUsage
+     * @param category [type: dmMemory::Category] The category
+     * @param size [type: uint32_t] The current usage in bytes
+     */
+    void SetUsage(Category category, uint32_t size);
+
+    /*#
+     * Gets the current memory usage of a category
+     * @name GetUsage
+     * @param category [type: dmMemory::Category] The category
+     * @return usage [type: uint32_t] The usage in bytes
+     */
+    uint32_t GetUsage(Category category);
+
+    /*#
+     * Gets the highest memory usage of a category since startup
+     * @name GetPeakUsage
+     * @param category [type: dmMemory::Category] The category
+     * @return usage [type: uint32_t] The peak usage in bytes
+     */
+    uint32_t GetPeakUsage(Category category);
+
+    /*#
+     * Sets a soft budget for a category. The budget callback is called each time the usage grows past the budget.
+     * @name SetBudget
+     * @param category [type: dmMemory::Category] The category
+     * @param budget [type: uint32_t] The budget in bytes, or 0 to disable
+     */
+    void SetBudget(Category category, uint32_t budget);
+
+    /*#
+     * Gets the budget for a category
+     * @name GetBudget
+     * @param category [type: dmMemory::Category] The category
+     * @return budget [type: uint32_t] The budget in bytes, or 0 if disabled
+     */
+    uint32_t GetBudget(Category category);
+
+    /*#
+     * Sets the function to call when a category exceeds its budget. By default, a warning is logged.
+     * @note The callback may be called from any thread doing the allocation
+     * @name SetBudgetCallback
+     * @param callback [type: dmMemory::BudgetCallback] The callback, or 0 to restore the default
+     * @param user_data [type: void*] User data passed to the callback
+     */
+    void SetBudgetCallback(BudgetCallback callback, void* user_data);
+
+    /*#
+     * Gets the name of a category
+     * @name GetCategoryName
+     * @param category [type: dmMemory::Category] The category
+     * @return name [type: const char*] The name, e.g. "Resource"
+     */
+    const char* GetCategoryName(Category category);
 }
 
 #endif // DMSDK_MEMORY_H
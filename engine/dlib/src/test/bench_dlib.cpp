@@ -0,0 +1,265 @@
+// Copyright 2020-2024 The Defold Foundation
+// Copyright 2014-2020 King
+// Copyright 2009-2014 Ragnar Svensson, Christian Murray
+// Licensed under the Defold License version 1.0 (the "License"); you may not use
+// this file except in compliance with the License.
+//
+// You may obtain a copy of the License, together with FAQs at
+// https://www.defold.com/license
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+// Microbenchmarks for the dlib hot paths.
+// Each benchmark is run a number of times with the same fixed seed, and the results
+// are written to stdout as one json object per line, e.g.:
+//   {"benchmark": "hashtable_get", "ops": 65536, "runs": 7, "min_ns": 3.1, "median_ns": 3.4}
+// Usage: bench_dlib [filter]
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+
+#include "dlib/array.h"
+#include "dlib/hash.h"
+#include "dlib/hashtable.h"
+#include "dlib/open_hashtable.h"
+#include "dlib/message.h"
+#include "dlib/radix_sort.h"
+#include "dlib/time.h"
+#include "dlib/transform.h"
+#include <dmsdk/dlib/vmath.h>
+
+static const uint32_t RUN_COUNT = 7;
+static const uint32_t SEED = 0x5eed;
+
+// Returns a checksum, so that the work can't be optimized away
+typedef uint64_t (*BenchmarkFn)(uint32_t ops);
+
+struct Benchmark
+{
+    const char* m_Name;
+    BenchmarkFn m_Fn;
+    uint32_t    m_Ops;
+};
+
+// Deterministic random numbers, independent of the platform rand()
+struct Random
+{
+    Random() : m_State(SEED) {}
+    uint32_t Next()
+    {
+        m_State = m_State * 1664525u + 1013904223u;
+        return m_State;
+    }
+    uint32_t m_State;
+};
+
+static uint64_t BenchHashTablePut(uint32_t ops)
+{
+    Random rnd;
+    dmHashTable64<uint32_t> ht;
+    ht.SetCapacity(ops / 2, ops);
+    for (uint32_t i = 0; i < ops; ++i)
+    {
+        ht.Put(rnd.Next(), i);
+    }
+    return ht.Size();
+}
+
+static uint64_t BenchHashTableGet(uint32_t ops)
+{
+    dmHashTable64<uint32_t> ht;
+    ht.SetCapacity(ops / 2, ops);
+    for (uint32_t i = 0; i < ops; ++i)
+    {
+        ht.Put(i * 0x9e3779b97f4a7c15ULL, i);
+    }
+
+    Random rnd;
+    uint64_t sum = 0;
+    for (uint32_t i = 0; i < ops; ++i)
+    {
+        uint32_t* value = ht.Get((rnd.Next() % ops) * 0x9e3779b97f4a7c15ULL);
+        sum += value ? *value : 0;
+    }
+    return sum;
+}
+
+static uint64_t BenchOpenHashTableGet(uint32_t ops)
+{
+    dmOpenHashTable<uint64_t, uint32_t> ht;
+    ht.SetCapacity(ops / 2, ops);
+    for (uint32_t i = 0; i < ops; ++i)
+    {
+        ht.Put(i * 0x9e3779b97f4a7c15ULL, i);
+    }
+
+    Random rnd;
+    uint64_t sum = 0;
+    for (uint32_t i = 0; i < ops; ++i)
+    {
+        uint32_t* value = ht.Get((rnd.Next() % ops) * 0x9e3779b97f4a7c15ULL);
+        sum += value ? *value : 0;
+    }
+    return sum;
+}
+
+static uint64_t BenchHashString64(uint32_t ops)
+{
+    char buffer[64];
+    uint64_t sum = 0;
+    for (uint32_t i = 0; i < ops; ++i)
+    {
+        snprintf(buffer, sizeof(buffer), "/go%u#sprite", i & 1023);
+        sum += dmHashString64(buffer);
+    }
+    return sum;
+}
+
+struct BenchMessage
+{
+    uint32_t m_Value;
+};
+
+static void BenchMessageDispatch(dmMessage::Message* message, void* user_ptr)
+{
+    *(uint64_t*)user_ptr += ((BenchMessage*)message->m_Data)->m_Value;
+}
+
+static uint64_t BenchMessagePostDispatch(uint32_t ops)
+{
+    dmMessage::URL receiver;
+    dmMessage::ResetURL(&receiver);
+    dmMessage::NewSocket("bench_socket", &receiver.m_Socket);
+
+    dmhash_t message_id = dmHashString64("bench_message");
+    BenchMessage data;
+    uint64_t sum = 0;
+    for (uint32_t i = 0; i < ops; ++i)
+    {
+        data.m_Value = i;
+        dmMessage::Post(0x0, &receiver, message_id, 0, 0x0, &data, sizeof(data), 0);
+        if ((i & 255) == 255)
+            dmMessage::Dispatch(receiver.m_Socket, BenchMessageDispatch, &sum);
+    }
+    dmMessage::Dispatch(receiver.m_Socket, BenchMessageDispatch, &sum);
+    dmMessage::DeleteSocket(receiver.m_Socket);
+    return sum;
+}
+
+// The same keys as a render list: a 64 bit order key and an index
+static uint64_t BenchRadixSortRenderKeys(uint32_t ops)
+{
+    Random rnd;
+    dmArray<uint64_t> keys;
+    dmArray<uint64_t> tmp_keys;
+    dmArray<uint32_t> values;
+    dmArray<uint32_t> tmp_values;
+    keys.SetCapacity(ops);
+    keys.SetSize(ops);
+    tmp_keys.SetCapacity(ops);
+    tmp_keys.SetSize(ops);
+    values.SetCapacity(ops);
+    values.SetSize(ops);
+    tmp_values.SetCapacity(ops);
+    tmp_values.SetSize(ops);
+    for (uint32_t i = 0; i < ops; ++i)
+    {
+        // A few materials/batch keys, and a depth value
+        keys[i] = ((uint64_t)(rnd.Next() & 0xf) << 32) | (rnd.Next() & 0xffffff);
+        values[i] = i;
+    }
+    dmRadixSort::Sort(keys.Begin(), values.Begin(), tmp_keys.Begin(), tmp_values.Begin(), ops, 40);
+    return values[0] + values[ops-1];
+}
+
+// The inner loop of updating the world transforms of a hierarchy
+static uint64_t BenchTransformHierarchy(uint32_t ops)
+{
+    Random rnd;
+    dmArray<dmTransform::Transform> local;
+    dmArray<dmTransform::Transform> world;
+    dmArray<uint32_t> parents;
+    local.SetCapacity(ops);
+    world.SetCapacity(ops);
+    parents.SetCapacity(ops);
+    for (uint32_t i = 0; i < ops; ++i)
+    {
+        dmTransform::Transform t;
+        t.SetTranslation(dmVMath::Vector3((float)(rnd.Next() & 255), (float)(rnd.Next() & 255), 0.0f));
+        t.SetRotation(dmVMath::Quat::rotationZ((float)(rnd.Next() & 1023) * 0.001f));
+        t.SetUniformScale(1.0f);
+        local.Push(t);
+        world.Push(t);
+        parents.Push(i == 0 ? 0 : rnd.Next() % i); // Parents always come before their children
+    }
+
+    for (uint32_t i = 1; i < ops; ++i)
+    {
+        world[i] = dmTransform::Mul(world[parents[i]], local[i]);
+    }
+    return (uint64_t)(int64_t)world[ops-1].GetTranslation().getX();
+}
+
+static uint64_t BenchMatrixMul(uint32_t ops)
+{
+    Random rnd;
+    dmVMath::Matrix4 m = dmVMath::Matrix4::identity();
+    dmVMath::Matrix4 r = dmVMath::Matrix4::rotationZ((float)(rnd.Next() & 1023) * 0.001f);
+    dmVMath::Vector4 v(0.0f);
+    for (uint32_t i = 0; i < ops; ++i)
+    {
+        m = m * r;
+        v += m * dmVMath::Point3(1.0f, 2.0f, 3.0f);
+    }
+    return (uint64_t)(int64_t)v.getX();
+}
+
+static Benchmark g_Benchmarks[] = {
+    {"hashtable_put",           BenchHashTablePut,          1 << 16},
+    {"hashtable_get",           BenchHashTableGet,          1 << 16},
+    {"open_hashtable_get",      BenchOpenHashTableGet,      1 << 16},
+    {"hash_string64",           BenchHashString64,          1 << 16},
+    {"message_post_dispatch",   BenchMessagePostDispatch,   1 << 14},
+    {"radix_sort_render_keys",  BenchRadixSortRenderKeys,   1 << 16},
+    {"transform_hierarchy",     BenchTransformHierarchy,    1 << 16},
+    {"matrix_mul",              BenchMatrixMul,             1 << 16},
+};
+
+static void RunBenchmark(const Benchmark& benchmark)
+{
+    double times[RUN_COUNT];
+    uint64_t checksum = 0;
+
+    benchmark.m_Fn(benchmark.m_Ops); // Warm up
+
+    for (uint32_t i = 0; i < RUN_COUNT; ++i)
+    {
+        uint64_t start = dmTime::GetTime();
+        checksum += benchmark.m_Fn(benchmark.m_Ops);
+        uint64_t end = dmTime::GetTime();
+        times[i] = (end - start) * 1000.0 / benchmark.m_Ops;
+    }
+    std::sort(times, times + RUN_COUNT);
+
+    printf("{\"benchmark\": \"%s\", \"ops\": %u, \"runs\": %u, \"min_ns\": %.2f, \"median_ns\": %.2f, \"checksum\": %llu}\n",
+            benchmark.m_Name, benchmark.m_Ops, RUN_COUNT, times[0], times[RUN_COUNT / 2], (unsigned long long)checksum);
+    fflush(stdout);
+}
+
+int main(int argc, char **argv)
+{
+    const char* filter = argc > 1 ? argv[1] : 0;
+
+    for (uint32_t i = 0; i < sizeof(g_Benchmarks) / sizeof(g_Benchmarks[0]); ++i)
+    {
+        if (filter && strstr(g_Benchmarks[i].m_Name, filter) == 0)
+            continue;
+        RunBenchmark(g_Benchmarks[i]);
+    }
+    return 0;
+}
@@ -20,6 +20,8 @@
 #include <jc_test/jc_test.h>
 #include "../dlib/hash.h"
 #include "../dlib/log.h"
+#include "../dlib/dstrings.h"
+#include "../dlib/thread.h"
 
 class dlib : public jc_test_base_class
 {
@@ -601,6 +603,54 @@ TEST_F(dlib, HashIncrementalNoReverse)
     free((void*) buffer);
 }
 
+struct HashThreadContext
+{
+    uint32_t m_ThreadIndex;
+    uint32_t m_Count;
+};
+
+static void HashThread(void* arg)
+{
+    HashThreadContext* ctx = (HashThreadContext*)arg;
+    char buffer[64];
+    for (uint32_t i = 0; i < ctx->m_Count; ++i)
+    {
+        // Half of the strings are shared between the threads
+        dmSnPrintf(buffer, sizeof(buffer), "hash_thread_%u_%u", (i & 1) ? ctx->m_ThreadIndex : 0, i);
+        dmHashString64(buffer);
+        dmHashString32(buffer);
+    }
+}
+
+TEST_F(dlib, HashReverseThreaded)
+{
+    const uint32_t thread_count = 4;
+    const uint32_t count = 2000;
+    HashThreadContext contexts[thread_count];
+    dmThread::Thread threads[thread_count];
+    for (uint32_t i = 0; i < thread_count; ++i)
+    {
+        contexts[i].m_ThreadIndex = i + 1;
+        contexts[i].m_Count = count;
+        threads[i] = dmThread::New(HashThread, 0x80000, &contexts[i], "hash");
+    }
+    for (uint32_t i = 0; i < thread_count; ++i)
+    {
+        dmThread::Join(threads[i]);
+    }
+
+    char buffer[64];
+    for (uint32_t t = 0; t < thread_count; ++t)
+    {
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            dmSnPrintf(buffer, sizeof(buffer), "hash_thread_%u_%u", (i & 1) ? t + 1 : 0, i);
+            ASSERT_STREQ(buffer, (const char*) dmHashReverse64(dmHashBufferNoReverse64(buffer, strlen(buffer)), 0));
+            ASSERT_STREQ(buffer, (const char*) dmHashReverse32(dmHashBufferNoReverse32(buffer, strlen(buffer)), 0));
+        }
+    }
+}
+
 TEST_F(dlib, HashReverseEnable)
 {
     for(uint32_t i = 0; i < 2; ++i)
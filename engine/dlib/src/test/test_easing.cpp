@@ -43,6 +43,23 @@ TEST(dmEasing, Linear)
     }
 }
 
+TEST(dmEasing, GetValues)
+{
+    const uint32_t count = 203;
+    float t[count];
+    float values[count];
+    for (uint32_t i = 0; i < count; ++i) {
+        t[i] = -0.01f + i / 200.0f;
+    }
+
+    for (int type = 0; type < dmEasing::TYPE_FLOAT_VECTOR; ++type) {
+        dmEasing::GetValues((dmEasing::Type) type, t, values, count);
+        for (uint32_t i = 0; i < count; ++i) {
+            ASSERT_EQ(dmEasing::GetValue((dmEasing::Type) type, t[i]), values[i]);
+        }
+    }
+}
+
 TEST(dmEasing, CurstomCurve)
 {
     dmVMath::FloatVector vector_empty(0);
@@ -22,6 +22,7 @@
 #include <jc_test/jc_test.h>
 
 #include "dlib/hashtable.h"
+#include "dlib/open_hashtable.h"
 
 TEST(dmHashTable, EmtpyConstructor)
 {
@@ -524,6 +525,177 @@ TEST(dmHashTable, Swap)
     ASSERT_EQ(300, *h1.Get(30));
 }
 
+TEST(dmOpenHashTable, EmptyConstructor)
+{
+    dmOpenHashTable<uint32_t, int> ht;
+
+    EXPECT_EQ(0U, ht.Size());
+    EXPECT_EQ(0U, ht.Capacity());
+    EXPECT_EQ(true, ht.Full());
+    EXPECT_EQ(true, ht.Empty());
+    EXPECT_EQ((void*) 0, ht.Get(1));
+}
+
+TEST(dmOpenHashTable, PutGetErase)
+{
+    dmOpenHashTable<uint64_t, uint32_t> ht;
+    ht.SetCapacity(10, 10);
+    ht.Put(12, 23);
+    ht.Put(12, 24);
+    ASSERT_EQ(1U, ht.Size());
+    ASSERT_EQ(24U, *ht.Get(12));
+    ASSERT_EQ((void*) 0, ht.Get(13));
+
+    ht.Erase(12);
+    ASSERT_TRUE(ht.Empty());
+    ASSERT_EQ((void*) 0, ht.Get(12));
+}
+
+TEST(dmOpenHashTable, Exhaustive)
+{
+    const int N = 100;
+    for (int count = 1; count < N; ++count)
+    {
+        std::map<uint32_t, uint32_t> map;
+        dmOpenHashTable<uint32_t, uint32_t> ht;
+        ht.SetCapacity(count);
+
+        // Repeatedly fill and drain the table with random keys to exercise the deleted slots
+        for (int round = 0; round < 8; ++round)
+        {
+            while (map.size() < (uint32_t) count)
+            {
+                uint32_t key = rand() & 0x3ff;
+                uint32_t val = rand();
+                map[key] = val;
+                ht.Put(key, val);
+            }
+            ASSERT_TRUE(ht.Full());
+
+            std::map<uint32_t, uint32_t>::iterator iter;
+            for (iter = map.begin(); iter != map.end(); ++iter)
+            {
+                ASSERT_NE((void*) 0, ht.Get(iter->first));
+                ASSERT_EQ(iter->second, *ht.Get(iter->first));
+            }
+
+            // Erase every other key
+            int i = 0;
+            for (iter = map.begin(); iter != map.end();)
+            {
+                if (i++ & 1)
+                {
+                    ht.Erase(iter->first);
+                    map.erase(iter++);
+                }
+                else
+                {
+                    ++iter;
+                }
+            }
+            ASSERT_EQ(map.size(), ht.Size());
+            for (uint32_t key = 0; key < 0x400; ++key)
+            {
+                bool exists = map.find(key) != map.end();
+                ASSERT_EQ(exists, ht.Get(key) != 0);
+            }
+        }
+    }
+}
+
+static void OpenHashTableIterateCallback(std::map<uint64_t, int>* map, const uint64_t* key, int* value)
+{
+    (*map)[*key] = *value;
+}
+
+TEST(dmOpenHashTable, Iterate)
+{
+    dmOpenHashTable<uint64_t, int> ht;
+    ht.SetCapacity(100);
+    for (int i = 0; i < 100; ++i)
+        ht.Put((uint64_t)i << 40, i * 2);
+
+    std::map<uint64_t, int> map;
+    ht.Iterate(OpenHashTableIterateCallback, &map);
+    ASSERT_EQ(100U, map.size());
+
+    int count = 0;
+    dmOpenHashTable<uint64_t, int>::Iterator iter = ht.GetIterator();
+    while (iter.Next())
+    {
+        ASSERT_EQ(map[iter.GetKey()], iter.GetValue());
+        ASSERT_EQ((int)(iter.GetKey() >> 40) * 2, iter.GetValue());
+        ++count;
+    }
+    ASSERT_EQ(100, count);
+}
+
+TEST(dmOpenHashTable, GrowClearSwap)
+{
+    dmOpenHashTable<uint32_t, int> h1;
+    dmOpenHashTable<uint32_t, int> h2;
+    h1.SetCapacity(2);
+    h1.Put(1, 10);
+    h1.Put(2, 20);
+    ASSERT_TRUE(h1.Full());
+    h1.SetCapacity(500);
+    for (int i = 3; i < 500; ++i)
+        h1.Put(i, i * 10);
+    for (int i = 1; i < 500; ++i)
+        ASSERT_EQ(i * 10, *h1.Get(i));
+
+    h2.SetCapacity(4);
+    h2.Put(1000, 1);
+
+    h1.Swap(h2);
+    ASSERT_EQ(1U, h1.Size());
+    ASSERT_EQ(1, *h1.Get(1000));
+    ASSERT_EQ(499U, h2.Size());
+
+    h2.Clear();
+    ASSERT_TRUE(h2.Empty());
+    ASSERT_EQ(500U, h2.Capacity());
+    ASSERT_EQ((void*) 0, h2.Get(10));
+}
+
+static void OpenHashTablePerformance(uint32_t count)
+{
+    dmHashTable<uint64_t, uint32_t> ht;
+    dmOpenHashTable<uint64_t, uint32_t> oht;
+    ht.SetCapacity(count / 2, count);
+    oht.SetCapacity(count);
+
+    uint64_t* keys = new uint64_t[count];
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        keys[i] = ((uint64_t)rand() << 32) ^ (uint64_t)rand() ^ ((uint64_t)i << 20);
+        ht.Put(keys[i], i);
+        oht.Put(keys[i], i);
+    }
+
+    uint32_t sum1 = 0, sum2 = 0;
+    clock_t start = clock();
+    for (int n = 0; n < 20; ++n)
+        for (uint32_t i = 0; i < count; ++i)
+            sum1 += *ht.Get(keys[i]);
+    clock_t mid = clock();
+    for (int n = 0; n < 20; ++n)
+        for (uint32_t i = 0; i < count; ++i)
+            sum2 += *oht.Get(keys[i]);
+    clock_t end = clock();
+    ASSERT_EQ(sum1, sum2);
+
+    printf("%u entries: dmHashTable %.2f ms, dmOpenHashTable %.2f ms\n", count,
+           1000.0 * (mid - start) / CLOCKS_PER_SEC, 1000.0 * (end - mid) / CLOCKS_PER_SEC);
+    delete[] keys;
+}
+
+TEST(dmOpenHashTable, Performance)
+{
+    OpenHashTablePerformance(1000);
+    OpenHashTablePerformance(100000);
+}
+
 int main(int argc, char **argv)
 {
     jc_test_init(&argc, argv);
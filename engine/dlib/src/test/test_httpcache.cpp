@@ -764,6 +764,51 @@ TEST_F(dmHttpCacheTest, Persist)
     dmHttpCache::Close(cache);
 }
 
+TEST_F(dmHttpCacheTest, PersistVariableLengthURI)
+{
+    dmHttpCache::HCache cache;
+    dmHttpCache::NewParams params;
+    params.m_Path = m_Path;
+    dmHttpCache::Result r = dmHttpCache::Open(&params, &cache);
+    ASSERT_EQ(dmHttpCache::RESULT_OK, r);
+
+    // Index records are variable sized, make sure all uri lengths round trip
+    char uri[512];
+    const char* data = "data";
+    for (uint32_t i = 1; i < sizeof(uri); i += 7)
+    {
+        memset(uri, 'a' + (i % 26), i);
+        uri[i] = '\0';
+        r = Put(cache, uri, "etag", data, strlen(data));
+        ASSERT_EQ(dmHttpCache::RESULT_OK, r);
+    }
+    uint32_t count = dmHttpCache::GetEntryCount(cache);
+
+    dmHttpCache::Close(cache);
+    r = dmHttpCache::Open(&params, &cache);
+    ASSERT_EQ(dmHttpCache::RESULT_OK, r);
+    ASSERT_EQ(count, dmHttpCache::GetEntryCount(cache));
+
+    for (uint32_t i = 1; i < sizeof(uri); i += 7)
+    {
+        memset(uri, 'a' + (i % 26), i);
+        uri[i] = '\0';
+
+        dmHttpCache::EntryInfo info;
+        r = dmHttpCache::GetInfo(cache, uri, &info);
+        ASSERT_EQ(dmHttpCache::RESULT_OK, r);
+        ASSERT_STREQ(uri, info.m_URI);
+
+        void* buffer = 0;
+        uint64_t checksum;
+        r = Get(cache, uri, "etag", &buffer, &checksum);
+        ASSERT_EQ(dmHttpCache::RESULT_OK, r);
+        ASSERT_EQ(dmHashString64(data), checksum);
+        free(buffer);
+    }
+    dmHttpCache::Close(cache);
+}
+
 int main(int argc, char **argv)
 {
     jc_test_init(&argc, argv);
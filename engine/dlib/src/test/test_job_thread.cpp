@@ -82,6 +82,175 @@ TEST(dmJobThread, PushJobsMultipleThreads)
     ASSERT_TRUE(tests_done);
 }
 
+static int AddProcess(void* context, void* data)
+{
+    dmAtomicIncrement32((int32_atomic_t*) context);
+    return 0;
+}
+
+static void TestGroupJobs(dmJobThread::HContext ctx)
+{
+    int32_atomic_t counter = 0;
+    dmJobThread::JobGroup group;
+    dmJobThread::InitGroup(&group, 0);
+    for (int i = 0; i < 1000; ++i)
+    {
+        dmJobThread::PushGroupJob(ctx, &group, AddProcess, (void*) &counter, 0);
+    }
+    dmJobThread::WaitGroup(ctx, &group);
+
+    ASSERT_TRUE(dmJobThread::IsGroupDone(&group));
+    ASSERT_EQ(1000, dmAtomicGet32(&counter));
+}
+
+TEST(dmJobThread, GroupJobs)
+{
+    dmJobThread::JobThreadCreationParams job_thread_create_params;
+    job_thread_create_params.m_ThreadNames[0] = "DefoldTestJobThread";
+    job_thread_create_params.m_ThreadCount    = 4;
+
+    dmJobThread::HContext ctx = dmJobThread::Create(job_thread_create_params);
+    for (int i = 0; i < 10; ++i)
+    {
+        TestGroupJobs(ctx);
+    }
+    dmJobThread::Destroy(ctx);
+}
+
+TEST(dmJobThread, GroupJobsNoWorkers)
+{
+    dmJobThread::JobThreadCreationParams job_thread_create_params;
+    job_thread_create_params.m_ThreadCount = 0;
+
+    dmJobThread::HContext ctx = dmJobThread::Create(job_thread_create_params);
+    ASSERT_EQ(0u, dmJobThread::GetWorkerCount(ctx));
+    TestGroupJobs(ctx);
+    dmJobThread::Destroy(ctx);
+
+    // Without a context, the jobs are run when pushed
+    TestGroupJobs(0);
+}
+
+TEST(dmJobThread, ManyThreads)
+{
+    dmJobThread::JobThreadCreationParams job_thread_create_params;
+    job_thread_create_params.m_ThreadNames[0] = "DefoldTestJobThread";
+    job_thread_create_params.m_ThreadCount    = dmJobThread::DM_MAX_JOB_THREAD_COUNT * 2;
+
+    dmJobThread::HContext ctx = dmJobThread::Create(job_thread_create_params);
+#if defined(DM_HAS_THREADS)
+    ASSERT_EQ((uint32_t) dmJobThread::DM_MAX_JOB_THREAD_COUNT * 2, dmJobThread::GetWorkerCount(ctx));
+#endif
+    TestGroupJobs(ctx);
+    dmJobThread::Destroy(ctx);
+}
+
+struct SplitJobContext
+{
+    dmJobThread::HContext   m_JobThread;
+    dmJobThread::JobGroup*  m_Group;
+    int32_atomic_t          m_Sum;
+};
+
+struct SplitJobData
+{
+    uint32_t m_Start;
+    uint32_t m_Count;
+};
+
+// Splits the range in two child jobs, until it is small enough
+static int SplitProcess(void* context, void* data)
+{
+    SplitJobContext* ctx = (SplitJobContext*) context;
+    SplitJobData* range = (SplitJobData*) data;
+    if (range->m_Count <= 8)
+    {
+        for (uint32_t i = 0; i < range->m_Count; ++i)
+            dmAtomicAdd32(&ctx->m_Sum, (int32_t) (range->m_Start + i));
+        delete range;
+        return 0;
+    }
+
+    uint32_t half = range->m_Count / 2;
+    SplitJobData* first = new SplitJobData;
+    first->m_Start = range->m_Start;
+    first->m_Count = half;
+    SplitJobData* second = new SplitJobData;
+    second->m_Start = range->m_Start + half;
+    second->m_Count = range->m_Count - half;
+    delete range;
+
+    dmJobThread::PushGroupJob(ctx->m_JobThread, ctx->m_Group, SplitProcess, context, (void*) first);
+    dmJobThread::PushGroupJob(ctx->m_JobThread, ctx->m_Group, SplitProcess, context, (void*) second);
+    return 0;
+}
+
+TEST(dmJobThread, ChildJobsAndParentGroups)
+{
+    dmJobThread::JobThreadCreationParams job_thread_create_params;
+    job_thread_create_params.m_ThreadNames[0] = "DefoldTestJobThread";
+    job_thread_create_params.m_ThreadCount    = 3;
+
+    dmJobThread::HContext ctx = dmJobThread::Create(job_thread_create_params);
+
+    dmJobThread::JobGroup parent;
+    dmJobThread::InitGroup(&parent, 0);
+
+    const uint32_t group_count = 4;
+    const uint32_t range_count = 1000;
+    dmJobThread::JobGroup groups[group_count];
+    SplitJobContext contexts[group_count];
+    for (uint32_t i = 0; i < group_count; ++i)
+    {
+        dmJobThread::InitGroup(&groups[i], &parent);
+        contexts[i].m_JobThread = ctx;
+        contexts[i].m_Group = &groups[i];
+        contexts[i].m_Sum = 0;
+
+        SplitJobData* range = new SplitJobData;
+        range->m_Start = 0;
+        range->m_Count = range_count;
+        dmJobThread::PushGroupJob(ctx, &groups[i], SplitProcess, (void*) &contexts[i], (void*) range);
+    }
+
+    // Waiting for the parent waits for the child groups, and the jobs they push while running
+    dmJobThread::WaitGroup(ctx, &parent);
+
+    for (uint32_t i = 0; i < group_count; ++i)
+    {
+        ASSERT_TRUE(dmJobThread::IsGroupDone(&groups[i]));
+        ASSERT_EQ((int32_t) (range_count * (range_count - 1) / 2), dmAtomicGet32(&contexts[i].m_Sum));
+    }
+
+    dmJobThread::Destroy(ctx);
+}
+
+TEST(dmJobThread, DefaultContext)
+{
+    ASSERT_EQ((dmJobThread::HContext) 0, dmJobThread::GetDefaultContext());
+
+    dmJobThread::JobThreadCreationParams job_thread_create_params;
+    job_thread_create_params.m_ThreadNames[0] = "DefoldTestJobThread";
+    job_thread_create_params.m_ThreadCount    = 2;
+
+    dmJobThread::HContext ctx = dmJobThread::Create(job_thread_create_params);
+    dmJobThread::SetDefaultContext(ctx);
+    ASSERT_EQ(ctx, dmJobThread::GetDefaultContext());
+
+    uint8_t result = 0;
+    dmJobThread::PushJob(dmJobThread::GetDefaultContext(), process, callback, 0, &result);
+    uint64_t stop_time = dmTime::GetTime() + 1*1e6; // 1 second
+    while (result == 0 && dmTime::GetTime() < stop_time)
+    {
+        dmJobThread::Update(ctx);
+        dmTime::Sleep(20*1000);
+    }
+    ASSERT_EQ(1, result);
+
+    dmJobThread::SetDefaultContext(0);
+    dmJobThread::Destroy(ctx);
+}
+
 int main(int argc, char **argv)
 {
     jc_test_init(&argc, argv);
@@ -69,6 +69,34 @@ TEST(dmLZ4, Compress)
     ASSERT_EQ(memcmp("bar", decompressed, 3), 0);
 }
 
+TEST(dmLZ4, CompressWithDictionary)
+{
+    const char* dictionary = "material: \"/builtins/materials/sprite.material\" blend_mode: BLEND_MODE_ALPHA size_mode: SIZE_MODE_AUTO";
+    const char* data       = "material: \"/builtins/materials/sprite.material\" blend_mode: BLEND_MODE_ADD size_mode: SIZE_MODE_AUTO";
+    uint32_t dictionary_size = (uint32_t)strlen(dictionary);
+    uint32_t data_size = (uint32_t)strlen(data);
+
+    char compressed[256];
+    char decompressed[256];
+    int compressed_size, dictionary_compressed_size, decompressed_size;
+
+    dmLZ4::Result r = dmLZ4::CompressBuffer(data, data_size, compressed, &compressed_size);
+    ASSERT_EQ(dmLZ4::RESULT_OK, r);
+
+    r = dmLZ4::CompressBufferWithDictionary(data, data_size, dictionary, dictionary_size, compressed, &dictionary_compressed_size);
+    ASSERT_EQ(dmLZ4::RESULT_OK, r);
+    ASSERT_LT(dictionary_compressed_size, compressed_size / 2);
+
+    r = dmLZ4::DecompressBufferWithDictionary(compressed, dictionary_compressed_size, dictionary, dictionary_size, decompressed, data_size, &decompressed_size);
+    ASSERT_EQ(dmLZ4::RESULT_OK, r);
+    ASSERT_EQ((int)data_size, decompressed_size);
+    ASSERT_EQ(0, memcmp(data, decompressed, data_size));
+
+    // Without the dictionary, the data can't be decompressed
+    r = dmLZ4::DecompressBuffer(compressed, dictionary_compressed_size, decompressed, data_size, &decompressed_size);
+    ASSERT_EQ(dmLZ4::RESULT_OUTBUFFER_TOO_SMALL, r);
+}
+
 char * RandomCharArray(int max, int *real)
 {
     char *tmp;
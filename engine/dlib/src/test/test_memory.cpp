@@ -14,6 +14,7 @@
 
 #include <stdint.h>
 #include <stdio.h>
+#include <string.h>
 #define JC_TEST_IMPLEMENTATION
 #include <jc_test/jc_test.h>
 #include "../dlib/memory.h"
@@ -52,6 +53,114 @@ TEST(dmMemory, AlignedMalloc)
     dummy = 0;
 }
 
+TEST(dmMemory, FrameAlloc)
+{
+    dmMemory::FrameAllocatorNewFrame();
+
+    uint8_t* a = (uint8_t*)dmMemory::FrameAlloc(100, 16);
+    ASSERT_TRUE(a != 0);
+    ASSERT_EQ(0u, ((uintptr_t)a % 16));
+    memset(a, 0xAB, 100);
+
+    uint8_t* b = (uint8_t*)dmMemory::FrameAlloc(10, 64);
+    ASSERT_TRUE(b != 0);
+    ASSERT_EQ(0u, ((uintptr_t)b % 64));
+    ASSERT_TRUE(b >= a + 100);
+
+    ASSERT_EQ(0, dmMemory::FrameAlloc(10, 7));
+
+    // The memory from the previous frame is still valid
+    dmMemory::FrameAllocatorNewFrame();
+    uint8_t* c = (uint8_t*)dmMemory::FrameAlloc(100, 16);
+    ASSERT_TRUE(c != 0);
+    memset(c, 0xCD, 100);
+    for (uint32_t i = 0; i < 100; ++i)
+        ASSERT_EQ(0xAB, a[i]);
+
+    // The buffer is reused two frames later
+    dmMemory::FrameAllocatorNewFrame();
+    ASSERT_EQ(a, (uint8_t*)dmMemory::FrameAlloc(100, 16));
+}
+
+TEST(dmMemory, FrameAllocGrow)
+{
+    const uint32_t size = 1024 * 1024;
+    dmMemory::FrameAllocatorNewFrame();
+    ASSERT_EQ(0, dmMemory::FrameAlloc(size, 16));
+
+    // The arena grows the next time it's used
+    dmMemory::FrameAllocatorNewFrame();
+    dmMemory::FrameAllocatorNewFrame();
+    void* p = dmMemory::FrameAlloc(size, 16);
+    ASSERT_TRUE(p != 0);
+    memset(p, 0, size);
+}
+
+struct BudgetContext
+{
+    dmMemory::Category  m_Category;
+    uint32_t            m_Usage;
+    uint32_t            m_Count;
+};
+
+static void BudgetCallback(dmMemory::Category category, uint32_t usage, uint32_t budget, void* user_data)
+{
+    BudgetContext* ctx = (BudgetContext*)user_data;
+    ctx->m_Category = category;
+    ctx->m_Usage = usage;
+    ctx->m_Count++;
+}
+
+TEST(dmMemory, TrackCategory)
+{
+    const dmMemory::Category category = dmMemory::CATEGORY_OTHER;
+    uint32_t base = dmMemory::GetUsage(category);
+
+    dmMemory::TrackAlloc(category, 100);
+    dmMemory::TrackAlloc(category, 50);
+    ASSERT_EQ(base + 150, dmMemory::GetUsage(category));
+    dmMemory::TrackFree(category, 100);
+    ASSERT_EQ(base + 50, dmMemory::GetUsage(category));
+    ASSERT_LE(base + 150, dmMemory::GetPeakUsage(category));
+    dmMemory::TrackFree(category, 50);
+    ASSERT_EQ(base, dmMemory::GetUsage(category));
+
+    dmMemory::SetUsage(dmMemory::CATEGORY_LUA, 1234);
+    ASSERT_EQ(1234u, dmMemory::GetUsage(dmMemory::CATEGORY_LUA));
+    dmMemory::SetUsage(dmMemory::CATEGORY_LUA, 0);
+
+    ASSERT_STREQ("Lua", dmMemory::GetCategoryName(dmMemory::CATEGORY_LUA));
+}
+
+TEST(dmMemory, TrackBudget)
+{
+    const dmMemory::Category category = dmMemory::CATEGORY_PHYSICS;
+    uint32_t base = dmMemory::GetUsage(category);
+
+    BudgetContext ctx = {};
+    dmMemory::SetBudgetCallback(BudgetCallback, &ctx);
+    dmMemory::SetBudget(category, base + 1000);
+    ASSERT_EQ(base + 1000, dmMemory::GetBudget(category));
+
+    dmMemory::TrackAlloc(category, 1000);
+    ASSERT_EQ(0u, ctx.m_Count);
+
+    // The callback is only called when crossing the budget
+    dmMemory::TrackAlloc(category, 1);
+    dmMemory::TrackAlloc(category, 1);
+    ASSERT_EQ(1u, ctx.m_Count);
+    ASSERT_EQ(category, ctx.m_Category);
+    ASSERT_EQ(base + 1001, ctx.m_Usage);
+
+    dmMemory::TrackFree(category, 2);
+    dmMemory::TrackAlloc(category, 2);
+    ASSERT_EQ(2u, ctx.m_Count);
+
+    dmMemory::TrackFree(category, 1002);
+    dmMemory::SetBudget(category, 0);
+    dmMemory::SetBudgetCallback(0, 0);
+}
+
 int main(int argc, char **argv)
 {
     jc_test_init(&argc, argv);
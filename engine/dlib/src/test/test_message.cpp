@@ -280,6 +280,50 @@ TEST(dmMessage, PostDuringDispatch)
     ASSERT_EQ(dmMessage::RESULT_OK, dmMessage::DeleteSocket(receiver.m_Socket));
 }
 
+struct DispatchBatchContext
+{
+    uint32_t m_Count;
+    uint32_t m_BatchCount;
+};
+
+static void HandleMessageBatch(dmMessage::Message** messages, uint32_t count, void* user_ptr)
+{
+    DispatchBatchContext* context = (DispatchBatchContext*)user_ptr;
+    assert(count > 0 && count <= dmMessage::DISPATCH_BATCH_SIZE);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        CustomMessageData1* data = (CustomMessageData1*)messages[i]->m_Data;
+        assert(data->m_MyValue == context->m_Count);
+        ++context->m_Count;
+    }
+    ++context->m_BatchCount;
+}
+
+TEST(dmMessage, DispatchBatch)
+{
+    const uint32_t message_count = 3 * dmMessage::DISPATCH_BATCH_SIZE + 1;
+    dmMessage::URL receiver;
+    dmMessage::ResetURL(&receiver);
+    ASSERT_EQ(dmMessage::RESULT_OK, dmMessage::NewSocket("my_socket", &receiver.m_Socket));
+
+    for (uint32_t i = 0; i < message_count; ++i)
+    {
+        CustomMessageData1 message_data1;
+        message_data1.m_MyValue = i;
+        ASSERT_EQ(dmMessage::RESULT_OK, dmMessage::Post(0x0, &receiver, m_HashMessage1, 0, 0x0, &message_data1, sizeof(CustomMessageData1), 0));
+    }
+
+    DispatchBatchContext context = {0, 0};
+    ASSERT_EQ(message_count, dmMessage::DispatchBatch(receiver.m_Socket, HandleMessageBatch, &context));
+    ASSERT_EQ(message_count, context.m_Count);
+    ASSERT_EQ(4u, context.m_BatchCount);
+
+    ASSERT_EQ(0u, dmMessage::DispatchBatch(receiver.m_Socket, HandleMessageBatch, &context));
+    ASSERT_EQ(4u, context.m_BatchCount);
+
+    ASSERT_EQ(dmMessage::RESULT_OK, dmMessage::DeleteSocket(receiver.m_Socket));
+}
+
 #if !defined(DM_NO_THREAD_SUPPORT)
 #define T_ASSERT_EQ(_A, _B) \
     if ( (_A) != (_B) ) { \
@@ -365,6 +409,68 @@ TEST(dmMessage, ThreadTest2)
 
     ASSERT_EQ(dmMessage::RESULT_OK, dmMessage::DeleteSocket(receiver.m_Socket));
 }
+
+struct OrderPostContext
+{
+    dmMessage::URL* m_Receiver;
+    uint32_t        m_Index;
+};
+
+static void OrderPostThread(void* arg)
+{
+    OrderPostContext* ctx = (OrderPostContext*) arg;
+
+    for (uint32_t i = 0; i < 4096; ++i)
+    {
+        // Vary the size so that the pages fill up at different rates
+        uint32_t m[16] = { ctx->m_Index, i };
+        dmMessage::Result result = dmMessage::Post(0x0, ctx->m_Receiver, m_HashMessage1, 0, 0x0, m, sizeof(uint32_t) * (2 + i % 14), 0);
+        T_ASSERT_EQ(dmMessage::RESULT_OK, result);
+    }
+}
+
+static void HandleOrderMessage(dmMessage::Message *message_object, void *user_ptr)
+{
+    uint32_t* next = (uint32_t*) user_ptr;
+    uint32_t* m = (uint32_t*) message_object->m_Data;
+    ASSERT_EQ(next[m[0]], m[1]);
+    next[m[0]]++;
+}
+
+TEST(dmMessage, ThreadOrder)
+{
+    dmMessage::URL receiver;
+    dmMessage::ResetURL(&receiver);
+    ASSERT_EQ(dmMessage::RESULT_OK, dmMessage::NewSocket("my_socket", &receiver.m_Socket));
+
+    const uint32_t thread_count = 4;
+    OrderPostContext ctx[thread_count];
+    dmThread::Thread threads[thread_count];
+    for (uint32_t i = 0; i < thread_count; ++i)
+    {
+        ctx[i].m_Receiver = &receiver;
+        ctx[i].m_Index = i;
+        threads[i] = dmThread::New(&OrderPostThread, 0xf0000, (void*) &ctx[i], "post");
+    }
+
+    // Messages from each thread are dispatched in the order they were posted
+    uint32_t next[thread_count] = {};
+    uint32_t count = 0;
+    while (count < 4096 * thread_count)
+    {
+        count += dmMessage::Dispatch(receiver.m_Socket, HandleOrderMessage, next);
+    }
+    ASSERT_EQ(4096U * thread_count, count);
+
+    for (uint32_t i = 0; i < thread_count; ++i)
+    {
+        dmThread::Join(threads[i]);
+        ASSERT_EQ(4096U, next[i]);
+    }
+
+    ASSERT_EQ(0U, dmMessage::Dispatch(receiver.m_Socket, HandleOrderMessage, next));
+    ASSERT_EQ(dmMessage::RESULT_OK, dmMessage::DeleteSocket(receiver.m_Socket));
+}
 #endif // DM_NO_THREAD_SUPPORT
 
 void HandleIntegrityMessage(dmMessage::Message *message_object, void *user_ptr)
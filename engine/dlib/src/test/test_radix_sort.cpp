@@ -0,0 +1,116 @@
+// Copyright 2020-2024 The Defold Foundation
+// Copyright 2014-2020 King
+// Copyright 2009-2014 Ragnar Svensson, Christian Murray
+// Licensed under the Defold License version 1.0 (the "License"); you may not use
+// this file except in compliance with the License.
+//
+// You may obtain a copy of the License, together with FAQs at
+// https://www.defold.com/license
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include <stdlib.h>
+#include <algorithm>
+#include "dlib/array.h"
+#include "dlib/radix_sort.h"
+
+#define JC_TEST_IMPLEMENTATION
+#include <jc_test/jc_test.h>
+
+struct KeyIndexSorter
+{
+    bool operator()(uint32_t a, uint32_t b) const
+    {
+        return (m_Keys[a] & m_Mask) < (m_Keys[b] & m_Mask);
+    }
+    const uint64_t* m_Keys;
+    uint64_t        m_Mask;
+};
+
+static void TestSort(uint32_t count, uint32_t key_bits, uint64_t key_range)
+{
+    dmArray<uint64_t> original_keys;
+    dmArray<uint64_t> keys;
+    dmArray<uint64_t> tmp_keys;
+    dmArray<uint32_t> values;
+    dmArray<uint32_t> tmp_values;
+    dmArray<uint32_t> expected;
+    original_keys.SetCapacity(count); original_keys.SetSize(count);
+    keys.SetCapacity(count); keys.SetSize(count);
+    tmp_keys.SetCapacity(count); tmp_keys.SetSize(count);
+    values.SetCapacity(count); values.SetSize(count);
+    tmp_values.SetCapacity(count); tmp_values.SetSize(count);
+    expected.SetCapacity(count); expected.SetSize(count);
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        uint64_t key = (((uint64_t)rand() << 40) ^ ((uint64_t)rand() << 20) ^ (uint64_t)rand()) % key_range;
+        original_keys[i] = key;
+        keys[i] = key;
+        values[i] = i;
+        expected[i] = i;
+    }
+
+    KeyIndexSorter sorter;
+    sorter.m_Keys = original_keys.Begin();
+    sorter.m_Mask = key_bits == 64 ? ~(uint64_t)0 : (((uint64_t)1 << key_bits) - 1);
+    std::stable_sort(expected.Begin(), expected.End(), sorter);
+
+    dmRadixSort::Sort(keys.Begin(), values.Begin(), tmp_keys.Begin(), tmp_values.Begin(), count, key_bits);
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        ASSERT_EQ(expected[i], values[i]);
+        ASSERT_EQ(original_keys[values[i]], keys[i]);
+    }
+}
+
+TEST(dmRadixSort, Empty)
+{
+    uint64_t key = 1;
+    uint32_t value = 7;
+    dmRadixSort::Sort(&key, &value, 0, 0, 0, 64);
+    dmRadixSort::Sort(&key, &value, 0, 0, 1, 64);
+    ASSERT_EQ(7u, value);
+}
+
+TEST(dmRadixSort, Small)
+{
+    TestSort(5, 64, ~(uint64_t)0);
+    TestSort(31, 32, 1000);
+}
+
+TEST(dmRadixSort, Large)
+{
+    TestSort(1000, 64, ~(uint64_t)0);
+    TestSort(20000, 64, ~(uint64_t)0);
+    TestSort(20000, 32, 0xffffffff);
+}
+
+TEST(dmRadixSort, Stable)
+{
+    // Lots of duplicates
+    TestSort(5000, 64, 7);
+    TestSort(5000, 32, 300);
+}
+
+TEST(dmRadixSort, SameKeys)
+{
+    // All passes are skipped
+    TestSort(1000, 64, 1);
+}
+
+TEST(dmRadixSort, KeyBits)
+{
+    // Only the low 16 bits are sorted on
+    TestSort(1000, 16, ~(uint64_t)0);
+}
+
+int main(int argc, char **argv)
+{
+    jc_test_init(&argc, argv);
+    return jc_test_run_all();
+}
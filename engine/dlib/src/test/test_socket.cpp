@@ -450,6 +450,160 @@ TYPED_TEST(SocketTyped, Connect_ConnectionRefused)
     dmThread::Join(thread);
 }
 
+TYPED_TEST(SocketTyped, Poller)
+{
+    dmSocket::HPoller poller = 0;
+    dmSocket::Result result = dmSocket::NewPoller(&poller);
+    ASSERT_EQ(dmSocket::RESULT_OK, result);
+
+    dmSocket::Socket server = GetSocket(TestFixture::instance.domain_type);
+    ASSERT_NE(dmSocket::INVALID_SOCKET_HANDLE, server);
+    dmSocket::Address address;
+    result = dmSocket::GetHostByName(TestFixture::instance.loopback_address, &address, dmSocket::IsSocketIPv4(server), dmSocket::IsSocketIPv6(server));
+    ASSERT_EQ(dmSocket::RESULT_OK, result);
+    result = dmSocket::Bind(server, address, 0);
+    ASSERT_EQ(dmSocket::RESULT_OK, result);
+    result = dmSocket::Listen(server, 8);
+    ASSERT_EQ(dmSocket::RESULT_OK, result);
+    uint16_t port;
+    result = dmSocket::GetName(server, &address, &port);
+    ASSERT_EQ(dmSocket::RESULT_OK, result);
+
+    int server_tag = 1;
+    result = dmSocket::PollerAdd(poller, server, dmSocket::POLLER_FLAG_READ, &server_tag);
+    ASSERT_EQ(dmSocket::RESULT_OK, result);
+
+    // Nothing to accept yet
+    dmSocket::PollerEvent events[4];
+    uint32_t event_count = 1;
+    result = dmSocket::PollerWait(poller, events, 4, 0, &event_count);
+    ASSERT_EQ(dmSocket::RESULT_OK, result);
+    ASSERT_EQ(0u, event_count);
+
+    dmSocket::Socket client = GetSocket(TestFixture::instance.domain_type);
+    ASSERT_NE(dmSocket::INVALID_SOCKET_HANDLE, client);
+    result = dmSocket::Connect(client, address, port);
+    ASSERT_EQ(dmSocket::RESULT_OK, result);
+
+    result = dmSocket::PollerWait(poller, events, 4, 1000 * 1000, &event_count);
+    ASSERT_EQ(dmSocket::RESULT_OK, result);
+    ASSERT_EQ(1u, event_count);
+    ASSERT_EQ(server, events[0].m_Socket);
+    ASSERT_EQ((void*) &server_tag, events[0].m_UserData);
+    ASSERT_TRUE(events[0].m_Read);
+
+    dmSocket::Address client_address;
+    dmSocket::Socket connection;
+    result = dmSocket::Accept(server, &client_address, &connection);
+    ASSERT_EQ(dmSocket::RESULT_OK, result);
+
+    int connection_tag = 2;
+    result = dmSocket::PollerAdd(poller, connection, dmSocket::POLLER_FLAG_READ, &connection_tag);
+    ASSERT_EQ(dmSocket::RESULT_OK, result);
+
+    int value = 0x00def01d;
+    int sent = 0;
+    result = dmSocket::Send(client, &value, sizeof(value), &sent);
+    ASSERT_EQ(dmSocket::RESULT_OK, result);
+
+    result = dmSocket::PollerWait(poller, events, 4, 1000 * 1000, &event_count);
+    ASSERT_EQ(dmSocket::RESULT_OK, result);
+    ASSERT_EQ(1u, event_count);
+    ASSERT_EQ(connection, events[0].m_Socket);
+    ASSERT_EQ((void*) &connection_tag, events[0].m_UserData);
+    ASSERT_TRUE(events[0].m_Read);
+
+    // Also poll for writing, which is possible right away
+    result = dmSocket::PollerAdd(poller, connection, dmSocket::POLLER_FLAG_READ | dmSocket::POLLER_FLAG_WRITE, &connection_tag);
+    ASSERT_EQ(dmSocket::RESULT_OK, result);
+    result = dmSocket::PollerWait(poller, events, 4, 0, &event_count);
+    ASSERT_EQ(dmSocket::RESULT_OK, result);
+    ASSERT_LE(1u, event_count);
+    bool writable = false;
+    for (uint32_t i = 0; i < event_count; ++i)
+    {
+        writable |= events[i].m_Socket == connection && events[i].m_Write;
+    }
+    ASSERT_TRUE(writable);
+
+    result = dmSocket::PollerRemove(poller, connection);
+    ASSERT_EQ(dmSocket::RESULT_OK, result);
+    ASSERT_EQ(dmSocket::RESULT_BADF, dmSocket::PollerRemove(poller, connection));
+
+    result = dmSocket::PollerWait(poller, events, 4, 0, &event_count);
+    ASSERT_EQ(dmSocket::RESULT_OK, result);
+    ASSERT_EQ(0u, event_count);
+
+    dmSocket::PollerRemove(poller, server);
+    dmSocket::DeletePoller(poller);
+    dmSocket::Delete(connection);
+    dmSocket::Delete(client);
+    dmSocket::Delete(server);
+}
+
+TYPED_TEST(SocketTyped, Batch)
+{
+    dmSocket::Socket socket;
+    dmSocket::Result result = dmSocket::New(TestFixture::instance.domain_type, dmSocket::TYPE_DGRAM, dmSocket::PROTOCOL_UDP, &socket);
+    ASSERT_EQ(dmSocket::RESULT_OK, result);
+    dmSocket::Address address;
+    result = dmSocket::GetHostByName(TestFixture::instance.loopback_address, &address, dmSocket::IsSocketIPv4(socket), dmSocket::IsSocketIPv6(socket));
+    ASSERT_EQ(dmSocket::RESULT_OK, result);
+    result = dmSocket::Bind(socket, address, 0);
+    ASSERT_EQ(dmSocket::RESULT_OK, result);
+    uint16_t port;
+    result = dmSocket::GetName(socket, &address, &port);
+    ASSERT_EQ(dmSocket::RESULT_OK, result);
+    ASSERT_EQ(dmSocket::RESULT_OK, dmSocket::SetBlocking(socket, false));
+    ASSERT_EQ(dmSocket::RESULT_OK, dmSocket::SetReceiveBufferSize(socket, 256 * 1024));
+
+    // More than the datagrams per system call
+    const uint32_t count = 70;
+    char buffers[count + 1][8];
+    dmSocket::Datagram received[count + 1];
+    for (uint32_t i = 0; i < count + 1; ++i)
+    {
+        received[i].m_Buffer = buffers[i];
+        received[i].m_Size = sizeof(buffers[i]);
+    }
+
+    uint32_t received_count = 1;
+    result = dmSocket::ReceiveFromBatch(socket, received, count + 1, &received_count);
+    ASSERT_EQ(dmSocket::RESULT_WOULDBLOCK, result);
+    ASSERT_EQ(0u, received_count);
+
+    uint32_t values[count];
+    dmSocket::Datagram sent[count];
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        values[i] = i;
+        sent[i].m_Buffer = &values[i];
+        sent[i].m_Size = sizeof(values[i]);
+        sent[i].m_Address = address;
+        sent[i].m_Port = port;
+    }
+
+    uint32_t sent_count = 0;
+    result = dmSocket::SendToBatch(socket, sent, count, &sent_count);
+    ASSERT_EQ(dmSocket::RESULT_OK, result);
+    ASSERT_EQ(count, sent_count);
+
+    result = dmSocket::ReceiveFromBatch(socket, received, count + 1, &received_count);
+    ASSERT_EQ(dmSocket::RESULT_OK, result);
+    ASSERT_EQ(count, received_count);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        uint32_t value;
+        memcpy(&value, buffers[i], sizeof(value));
+        ASSERT_EQ(sizeof(value), received[i].m_Size);
+        ASSERT_EQ(i, value);
+        ASSERT_TRUE(address == received[i].m_Address);
+        ASSERT_EQ(port, received[i].m_Port);
+    }
+
+    dmSocket::Delete(socket);
+}
+
 // Listen
 
 // Shutdown
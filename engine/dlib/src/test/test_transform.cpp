@@ -174,6 +174,64 @@ TEST(dmTransform, Conversion)
     }
 }
 
+TEST(dmTransform, MulToMatrix4Batch)
+{
+    Transform parent_transforms[TRANSFORM_BATCH_SIZE] = {
+        Transform(Vector3(1, 2, 3), normalize(Quat(normalize(Vector3(1, 0.5f, 0)), 1.0f)), Vector3(2, 3, 4)),
+        Transform(Vector3(-5, 0, 1), normalize(Quat(normalize(Vector3(0, 0, 1)), 0.3f)), Vector3(1, 1, 1)),
+        Transform(Vector3(0, 0, 0), Quat::identity(), Vector3(0.5f, 0.5f, 2)),
+        Transform(Vector3(7, -8, 9), normalize(Quat(normalize(Vector3(-1, 2, 3)), 2.0f)), Vector3(1, 2, 0.25f)),
+    };
+    Transform local_transforms[TRANSFORM_BATCH_SIZE] = {
+        Transform(Vector3(0.5f, 1, -1), normalize(Quat(normalize(Vector3(0, 1, 1)), 0.7f)), Vector3(1, 2, 3)),
+        Transform(Vector3(3, 2, 1), Quat::identity(), Vector3(2, 2, 2)),
+        Transform(Vector3(-1, -1, 4), normalize(Quat(normalize(Vector3(1, 1, 1)), -1.0f)), Vector3(0.1f, 1, 1)),
+        Transform(Vector3(0, 0, 2), normalize(Quat(normalize(Vector3(3, 0, 1)), 1.5f)), Vector3(4, 4, 1)),
+    };
+
+    Matrix4 parents[TRANSFORM_BATCH_SIZE];
+    const Matrix4* parent_ptrs[TRANSFORM_BATCH_SIZE];
+    TransformBatch batch;
+    for (uint32_t i = 0; i < TRANSFORM_BATCH_SIZE; ++i)
+    {
+        parents[i] = ToMatrix4(parent_transforms[i]);
+        parent_ptrs[i] = &parents[i];
+        SetBatchTransform(&batch, i, local_transforms[i]);
+    }
+
+    for (int scale_along_z = 0; scale_along_z < 2; ++scale_along_z)
+    {
+        Matrix4 out[TRANSFORM_BATCH_SIZE];
+        MulToMatrix4Batch(batch, parent_ptrs, scale_along_z != 0, out);
+
+        for (uint32_t i = 0; i < TRANSFORM_BATCH_SIZE; ++i)
+        {
+            Matrix4 own = ToMatrix4(local_transforms[i]);
+            Matrix4 expected = scale_along_z ? parents[i] * own : MulNoScaleZ(parents[i], own);
+            for (uint32_t c = 0; c < 4; ++c)
+            {
+                ASSERT_V4_NEAR(expected.getCol(c), out[i].getCol(c));
+            }
+        }
+    }
+
+    // Identity parents
+    Matrix4 identity = Matrix4::identity();
+    for (uint32_t i = 0; i < TRANSFORM_BATCH_SIZE; ++i)
+        parent_ptrs[i] = &identity;
+
+    Matrix4 out[TRANSFORM_BATCH_SIZE];
+    MulToMatrix4Batch(batch, parent_ptrs, false, out);
+    for (uint32_t i = 0; i < TRANSFORM_BATCH_SIZE; ++i)
+    {
+        Matrix4 expected = ToMatrix4(local_transforms[i]);
+        for (uint32_t c = 0; c < 4; ++c)
+        {
+            ASSERT_V4_NEAR(expected.getCol(c), out[i].getCol(c));
+        }
+    }
+}
+
 TEST(dmTransform, Inverse)
 {
     TransformS1 is1;
@@ -122,6 +122,34 @@ TEST(dmZip, Iterate)
     dmZip::Close(zip);
 }
 
+TEST(dmZip, EntryDataOffset)
+{
+    char path[128];
+    dmTestUtil::MakeHostPath(path, sizeof(path), "src/test/data/foo.zip");
+
+    dmZip::HZip zip;
+    dmZip::Result zr = dmZip::Open(path, &zip);
+    ASSERT_EQ(dmZip::RESULT_OK, zr);
+
+    zr = dmZip::OpenEntry(zip, "hello.txt");
+    ASSERT_EQ(dmZip::RESULT_OK, zr);
+
+    uint32_t offset = 0;
+    zr = dmZip::GetEntryDataOffset(zip, &offset);
+    ASSERT_EQ(dmZip::RESULT_OK, zr);
+    ASSERT_LT(offset, FOO_ZIP_SIZE);
+
+    // Stored entries can be read straight from the zip file
+    if (dmZip::IsEntryStored(zip))
+    {
+        ASSERT_LE(offset + 11, FOO_ZIP_SIZE);
+        ASSERT_EQ(0, memcmp("Hello World", FOO_ZIP + offset, 11));
+    }
+
+    dmZip::CloseEntry(zip);
+    dmZip::Close(zip);
+}
+
 int main(int argc, char **argv)
 {
     jc_test_init(&argc, argv);
@@ -564,6 +564,39 @@ unsigned int zip_entry_crc32(struct zip_t *zip) {
   return zip ? zip->entry.uncomp_crc32 : 0;
 }
 
+// DEFOLD: Added to allow reading stored entries straight from a memory mapped zip file
+int zip_entry_isstored(struct zip_t *zip) {
+  if (!zip || zip->entry.index < 0) {
+    return -1;
+  }
+  return zip->entry.method == 0 && zip->entry.comp_size == zip->entry.uncomp_size ? 1 : 0;
+}
+
+// DEFOLD: Added to allow reading stored entries straight from a memory mapped zip file
+int zip_entry_dataoffset(struct zip_t *zip, unsigned long long *offset) {
+  miniz::mz_zip_archive *pzip = NULL;
+  miniz::mz_uint32 local_header_u32[(miniz::MZ_ZIP_LOCAL_DIR_HEADER_SIZE + sizeof(miniz::mz_uint32) - 1) / sizeof(miniz::mz_uint32)];
+  miniz::mz_uint8 *local_header = (miniz::mz_uint8 *)local_header_u32;
+
+  if (!zip || zip->entry.index < 0) {
+    return -1;
+  }
+
+  pzip = &(zip->archive);
+  if (pzip->m_pRead(pzip->m_pIO_opaque, zip->entry.header_offset, local_header,
+                    miniz::MZ_ZIP_LOCAL_DIR_HEADER_SIZE) != miniz::MZ_ZIP_LOCAL_DIR_HEADER_SIZE) {
+    return -1;
+  }
+  if (MZ_READ_LE32(local_header) != miniz::MZ_ZIP_LOCAL_DIR_HEADER_SIG) {
+    return -1;
+  }
+
+  *offset = zip->entry.header_offset + miniz::MZ_ZIP_LOCAL_DIR_HEADER_SIZE +
+            MZ_READ_LE16(local_header + miniz::MZ_ZIP_LDH_FILENAME_LEN_OFS) +
+            MZ_READ_LE16(local_header + miniz::MZ_ZIP_LDH_EXTRA_LEN_OFS);
+  return 0;
+}
+
 int zip_entry_write(struct zip_t *zip, const void *buf, size_t bufsize) {
   miniz::mz_uint level;
   miniz::mz_zip_archive *pzip = NULL;
@@ -189,6 +189,26 @@ extern unsigned long long zip_entry_size(struct zip_t *zip);
  */
 extern unsigned int zip_entry_crc32(struct zip_t *zip);
 
+/**
+ * DEFOLD: Determines if the current zip entry is stored without compression.
+ *
+ * @param zip zip archive handler.
+ *
+ * @return the return code - 1 (true), 0 (false), negative number (< 0) on
+ *         error.
+ */
+extern int zip_entry_isstored(struct zip_t *zip);
+
+/**
+ * DEFOLD: Returns the offset of the current zip entry data within the zip file.
+ *
+ * @param zip zip archive handler.
+ * @param offset the offset in bytes from the start of the zip file.
+ *
+ * @return the return code - 0 on success, negative number (< 0) on error.
+ */
+extern int zip_entry_dataoffset(struct zip_t *zip, unsigned long long *offset);
+
 /**
  * Compresses an input buffer for the current zip entry.
  *
@@ -31,6 +31,7 @@
 #include <dlib/http_client.h>
 #include <dlib/log.h>
 #include <dlib/math.h>
+#include <dlib/memory.h>
 #include <dlib/memprofile.h>
 #include <dlib/path.h>
 #include <dlib/profile.h>
@@ -101,6 +102,16 @@ extern "C" {
 DM_PROPERTY_EXTERN(rmtp_Script);
 DM_PROPERTY_U32(rmtp_LuaMem, 0, FrameReset, "kb", &rmtp_Script); // kilo bytes
 DM_PROPERTY_U32(rmtp_LuaRefs, 0, FrameReset, "# Lua references", &rmtp_Script);
+DM_PROPERTY_U32(rmtp_LuaGCTime, 0, FrameReset, "us spent in Lua GC steps", &rmtp_Script);
+DM_PROPERTY_U32(rmtp_LuaGCSteps, 0, FrameReset, "# Lua GC steps", &rmtp_Script);
+
+DM_PROPERTY_GROUP(rmtp_Memory, "Memory");
+DM_PROPERTY_U32(rmtp_MemResource, 0, FrameReset, "kb", &rmtp_Memory);
+DM_PROPERTY_U32(rmtp_MemLua, 0, FrameReset, "kb", &rmtp_Memory);
+DM_PROPERTY_U32(rmtp_MemGraphics, 0, FrameReset, "kb", &rmtp_Memory);
+DM_PROPERTY_U32(rmtp_MemSound, 0, FrameReset, "kb", &rmtp_Memory);
+DM_PROPERTY_U32(rmtp_MemPhysics, 0, FrameReset, "kb", &rmtp_Memory);
+DM_PROPERTY_U32(rmtp_MemOther, 0, FrameReset, "kb", &rmtp_Memory);
 
 namespace dmEngine
 {
@@ -226,6 +237,7 @@ namespace dmEngine
     , m_MainCollection(0)
     , m_LastReloadMTime(0)
     , m_MouseSensitivity(1.0f)
+    , m_WorkerJobThreadContext(0)
     , m_GraphicsContext(0)
     , m_RenderContext(0)
     , m_SharedScriptContext(0x0)
@@ -246,6 +258,7 @@ namespace dmEngine
     , m_ConnectionAppMode(false)
     , m_RunWhileIconified(false)
     , m_UseSwVSync(false)
+    , m_ScriptGCStepBudget(0)
     , m_Width(960)
     , m_Height(640)
     , m_InvPhysicalWidth(1.0f/960)
@@ -266,6 +279,15 @@ namespace dmEngine
         m_ModelContext.m_MaxModelCount = 0;
         m_AccumFrameTime = 0;
         m_PreviousFrameTime = dmTime::GetTime();
+        m_DecoupledRender = false;
+        m_AdaptiveFramePacing = false;
+        m_LowLatencyInput = false;
+        m_InputSampleTime = 0;
+        m_StepStartTime = 0;
+        m_SwapInterval = 0;
+        InitFramePacer(&m_FramePacer, 0, false);
+        InitFrameStats(&m_FrameStats, 0, 0);
+        InitInputRecord(&m_InputRecord);
     }
 
     HEngine New(dmEngineService::HEngineService engine_service)
@@ -332,6 +354,8 @@ namespace dmEngine
 
         dmRender::DeleteRenderContext(engine->m_RenderContext, engine->m_RenderScriptContext);
 
+        CloseInputRecord(&engine->m_InputRecord);
+
         if (engine->m_HidContext)
         {
             dmHID::Final(engine->m_HidContext);
@@ -364,6 +388,14 @@ namespace dmEngine
             dmResource::DeleteFactory(engine->m_Factory);
         }
 
+        dmJobThread::SetDefaultContext(0);
+
+        // Destroyed after the factory, since it is used when loading resources
+        if (engine->m_WorkerJobThreadContext)
+        {
+            dmJobThread::Destroy(engine->m_WorkerJobThreadContext);
+        }
+
 // TODO: Temporarily disabled as it hangs the shutdown procedure
         // // Stop processing graphics requests before deleting the graphics context
         // if (engine->m_JobThreadContext)
@@ -534,6 +566,7 @@ namespace dmEngine
     static void SetSwapInterval(HEngine engine, int swap_interval)
     {
         swap_interval = dmMath::Max(0, swap_interval);
+        engine->m_SwapInterval = swap_interval;
         dmGraphics::SetSwapInterval(engine->m_GraphicsContext, swap_interval);
 
         if (!dmGraphics::IsContextFeatureSupported(engine->m_GraphicsContext, dmGraphics::CONTEXT_FEATURE_VSYNC))
@@ -545,6 +578,11 @@ namespace dmEngine
     static void SetUpdateFrequency(HEngine engine, uint32_t frequency)
     {
         engine->m_UpdateFrequency = frequency;
+        InitFramePacer(&engine->m_FramePacer, frequency, engine->m_AdaptiveFramePacing);
+        if (engine->m_SwapInterval > 0 && !engine->m_UseSwVSync)
+        {
+            dmGraphics::SetSwapInterval(engine->m_GraphicsContext, engine->m_SwapInterval);
+        }
     }
 
     struct LuaCallstackCtx
@@ -600,6 +638,27 @@ namespace dmEngine
         return (dmPlatform::PlatformGraphicsApi) -1;
     }
 
+    // The subsystems that don't depend on the window or the graphics context, and that may be
+    // set up on a thread while the main thread creates those (mounting the archives and opening
+    // the sound device both tend to block for a while on mobile)
+    struct InitJob
+    {
+        dmConfigFile::HConfig           m_Config;
+        dmResource::NewFactoryParams    m_FactoryParams;
+        const char*                     m_ResourceUri;
+        dmResource::HFactory            m_Factory;
+        dmSound::InitializeParams       m_SoundParams;
+        dmSound::Result                 m_SoundResult;
+    };
+
+    static void RunInitJob(void* _job)
+    {
+        InitJob* job = (InitJob*) _job;
+        dmLogInfo("Loading data from: %s", job->m_ResourceUri);
+        job->m_Factory = dmResource::NewFactory(&job->m_FactoryParams, job->m_ResourceUri);
+        job->m_SoundResult = dmSound::Initialize(job->m_Config, &job->m_SoundParams);
+    }
+
     /*
      The game.projectc is located using the following scheme:
 
@@ -926,6 +985,84 @@ namespace dmEngine
         job_thread_create_param.m_ThreadCount    = 1;
         engine->m_JobThreadContext               = dmJobThread::Create(job_thread_create_param);
 
+        int32_t worker_thread_count = dmConfigFile::GetInt(engine->m_Config, "engine.worker_threads", 0);
+        if (worker_thread_count > 0 && dmJobThread::PlatformHasThreadSupport())
+        {
+            dmJobThread::JobThreadCreationParams worker_thread_create_param;
+            worker_thread_create_param.m_ThreadNames[0] = "DefoldWorkerThread";
+            worker_thread_create_param.m_ThreadCount    = (uint32_t) worker_thread_count;
+            engine->m_WorkerJobThreadContext = dmJobThread::Create(worker_thread_create_param);
+        }
+
+        // The extensions share the worker threads if there are any
+        dmJobThread::SetDefaultContext(engine->m_WorkerJobThreadContext ? engine->m_WorkerJobThreadContext : engine->m_JobThreadContext);
+
+        InitJob init_job;
+        init_job.m_Config = engine->m_Config;
+
+        const uint32_t max_resources = dmConfigFile::GetInt(engine->m_Config, dmResource::MAX_RESOURCES_KEY, 1024);
+        dmResource::NewFactoryParams& params = init_job.m_FactoryParams;
+        params.m_MaxResources = max_resources;
+        params.m_Flags = 0;
+        params.m_LoaderThreadCount = (uint32_t) dmMath::Max(1, dmConfigFile::GetInt(engine->m_Config, dmResource::LOADER_THREADS_KEY, dmResource::DEFAULT_LOADER_THREAD_COUNT));
+        params.m_LoaderMaxPendingData = (uint32_t) dmMath::Max(0, dmConfigFile::GetInt(engine->m_Config, dmResource::LOADER_MAX_PENDING_DATA_KEY, dmResource::DEFAULT_LOADER_MAX_PENDING_DATA));
+        params.m_JobThread = engine->m_WorkerJobThreadContext;
+        // The load timeline is served by the engine service, so it's only on by default in debug builds
+        params.m_LoadTimelineSize = (uint32_t) dmMath::Max(0, dmConfigFile::GetInt(engine->m_Config, dmResource::LOAD_TIMELINE_SIZE_KEY, dLib::IsDebugMode() ? 512 : 0));
+        params.m_ResidencyBudget = (uint32_t) dmMath::Max(0, dmConfigFile::GetInt(engine->m_Config, dmResource::RESIDENCY_BUDGET_KEY, 0));
+
+        if (dLib::IsDebugMode())
+        {
+            params.m_Flags = RESOURCE_FACTORY_FLAGS_RELOAD_SUPPORT;
+
+            int32_t http_cache = dmConfigFile::GetInt(engine->m_Config, "resource.http_cache", 1);
+            if (http_cache)
+                params.m_Flags |= RESOURCE_FACTORY_FLAGS_HTTP_CACHE;
+        }
+
+        int32_t liveupdate_enable = dmConfigFile::GetInt(engine->m_Config, "liveupdate.enabled", 1);
+        int32_t liveupdate_mount_on_start = dmConfigFile::GetInt(engine->m_Config, "liveupdate.mount_on_start", 1);
+        if (liveupdate_enable && liveupdate_mount_on_start)
+        {
+            params.m_Flags |= RESOURCE_FACTORY_FLAGS_LIVE_UPDATE_MOUNTS_ON_START;
+        }
+
+#if !defined(DM_RELEASE)
+        params.m_ArchiveIndex.m_Data = (const void*) BUILTINS_ARCI;
+        params.m_ArchiveIndex.m_Size = BUILTINS_ARCI_SIZE;
+        params.m_ArchiveData.m_Data = (const void*) BUILTINS_ARCD;
+        params.m_ArchiveData.m_Size = BUILTINS_ARCD_SIZE;
+        params.m_ArchiveManifest.m_Data = (const void*) BUILTINS_DMANIFEST;
+        params.m_ArchiveManifest.m_Size = BUILTINS_DMANIFEST_SIZE;
+#endif
+
+        init_job.m_ResourceUri = dmConfigFile::GetString(engine->m_Config, "resource.uri", project_file_uri);
+        init_job.m_Factory = 0;
+
+        dmSound::InitializeParams& sound_params = init_job.m_SoundParams;
+        sound_params.m_OutputDevice = "default";
+#if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+        sound_params.m_UseThread = false;
+#else
+        sound_params.m_UseThread = dmConfigFile::GetInt(engine->m_Config, "sound.use_thread", 1) != 0;
+#endif
+        // Frames mixed per buffer. Lower values lower the latency, at the cost of more frequent mixing
+        sound_params.m_FrameCount = (uint32_t) dmConfigFile::GetInt(engine->m_Config, "sound.frame_count", (int32_t) sound_params.m_FrameCount);
+        sound_params.m_JobThread = engine->m_WorkerJobThreadContext;
+        // The reads of streamed sounds may block, so they are kept off the mixing workers
+        sound_params.m_StreamJobThread = engine->m_JobThreadContext;
+        init_job.m_SoundResult = dmSound::RESULT_OK;
+
+        dmThread::Thread init_thread = 0;
+        if (dmConfigFile::GetInt(engine->m_Config, "engine.parallel_init", 1) && dmJobThread::PlatformHasThreadSupport())
+        {
+            init_thread = dmThread::New(RunInitJob, 0x80000, &init_job, "engine_init");
+        }
+        if (!init_thread)
+        {
+            RunInitJob(&init_job);
+        }
+
         dmGraphics::ContextParams graphics_context_params;
         graphics_context_params.m_DefaultTextureMinFilter = ConvertMinTextureFilter(dmConfigFile::GetString(engine->m_Config, "graphics.default_texture_min_filter", "linear"));
         graphics_context_params.m_DefaultTextureMagFilter = ConvertMagTextureFilter(dmConfigFile::GetString(engine->m_Config, "graphics.default_texture_mag_filter", "linear"));
@@ -939,8 +1076,41 @@ namespace dmEngine
         graphics_context_params.m_PrintDeviceInfo         = dmConfigFile::GetInt(engine->m_Config, "display.display_device_info", 0);
         graphics_context_params.m_JobThread               = engine->m_JobThreadContext;
         graphics_context_params.m_SwapInterval            = swap_interval;
+        graphics_context_params.m_TextureMipmapSkip       = (uint8_t) dmMath::Clamp(dmConfigFile::GetInt(engine->m_Config, "graphics.texture_mipmap_skip", 0), 0, 15);
+
+        char application_support_path[DMPATH_MAX_PATH];
+        char pipeline_cache_path[DMPATH_MAX_PATH];
+        char pipeline_manifest_path[DMPATH_MAX_PATH];
+        char program_cache_path[DMPATH_MAX_PATH];
+        const char* application_name = dmConfigFile::GetString(engine->m_Config, "project.title_as_file_name", "defold");
+        if (dmSys::GetApplicationSupportPath(application_name, application_support_path, sizeof(application_support_path)) == dmSys::RESULT_OK)
+        {
+            dmPath::Concat(application_support_path, "vulkan_pipeline_cache", pipeline_cache_path, sizeof(pipeline_cache_path));
+            dmPath::Concat(application_support_path, "vulkan_pipeline_manifest", pipeline_manifest_path, sizeof(pipeline_manifest_path));
+            graphics_context_params.m_PipelineCachePath      = pipeline_cache_path;
+            graphics_context_params.m_PipelineManifestPath   = pipeline_manifest_path;
+            graphics_context_params.m_RecordPipelineManifest = dmConfigFile::GetInt(engine->m_Config, "graphics.record_pipeline_manifest", 0) != 0;
+
+            if (dmConfigFile::GetInt(engine->m_Config, "graphics.program_cache", 1))
+            {
+                dmPath::Concat(application_support_path, "opengl_program_cache", program_cache_path, sizeof(program_cache_path));
+                graphics_context_params.m_ProgramCachePath = program_cache_path;
+            }
+        }
 
         engine->m_GraphicsContext = dmGraphics::NewContext(graphics_context_params);
+
+        if (init_thread)
+        {
+            dmThread::Join(init_thread);
+        }
+        engine->m_Factory = init_job.m_Factory;
+        if (dmSound::RESULT_OK == init_job.m_SoundResult) {
+            dmLogInfo("Initialised sound device '%s'", sound_params.m_OutputDevice);
+        } else {
+            dmLogWarning("Failed to initialize sound system.");
+        }
+
         if (engine->m_GraphicsContext == 0x0)
         {
             dmLogFatal("Unable to create the graphics context.");
@@ -959,46 +1129,48 @@ namespace dmEngine
         engine->m_RunWhileIconified = dmConfigFile::GetInt(engine->m_Config, "engine.run_while_iconified", 0);
 #endif
 
+        engine->m_LowLatencyInput = dmConfigFile::GetInt(engine->m_Config, "input.low_latency", 0) != 0;
+
         engine->m_FixedUpdateFrequency = dmConfigFile::GetInt(engine->m_Config, "engine.fixed_update_frequency", 60);
         engine->m_MaxTimeStep = dmConfigFile::GetFloat(engine->m_Config, "engine.max_time_step", 0.5);
 
-        dmGameSystem::OnWindowCreated(physical_width, physical_height);
+        // Only the simulation is stepped at display.update_frequency, the frame is rendered (and flipped) once.
+        // The fixed updates still run at engine.fixed_update_frequency
+        engine->m_DecoupledRender = dmConfigFile::GetInt(engine->m_Config, "engine.decoupled_render", 0) != 0;
 
-        SetUpdateFrequency(engine, dmConfigFile::GetInt(engine->m_Config, "display.update_frequency", 0));
+        // With display.update_frequency set, the frame rate is lowered to an even fraction of it while the frames
+        // keep missing it (e.g. when the device is throttled), rather than having uneven frame times
+        engine->m_AdaptiveFramePacing = dmConfigFile::GetInt(engine->m_Config, "display.adaptive_frame_pacing", 0) != 0;
 
-        const uint32_t max_resources = dmConfigFile::GetInt(engine->m_Config, dmResource::MAX_RESOURCES_KEY, 1024);
-        dmResource::NewFactoryParams params;
-        params.m_MaxResources = max_resources;
-        params.m_Flags = 0;
+        // Log a breakdown of the frames that take longer than the threshold (in milliseconds). Available in release builds as well.
+        uint32_t frame_spike_threshold = (uint32_t)(dmConfigFile::GetFloat(engine->m_Config, "engine.frame_spike_threshold", 0.0f) * 1000.0f);
+        uint32_t frame_spike_report_interval = (uint32_t)dmConfigFile::GetInt(engine->m_Config, "engine.frame_spike_report_interval", 60);
+        InitFrameStats(&engine->m_FrameStats, frame_spike_threshold, frame_spike_report_interval);
 
-        if (dLib::IsDebugMode())
+        // Record the input, dt and random seeds of each frame, or replay a recording with the same time steps.
+        // Paired with the frame time report at the end of the replay, a recorded session becomes a repeatable benchmark
+        const char* input_record_path = dmConfigFile::GetString(engine->m_Config, "engine.input_record", 0);
+        const char* input_replay_path = dmConfigFile::GetString(engine->m_Config, "engine.input_replay", 0);
+        if (input_replay_path && input_replay_path[0])
         {
-            params.m_Flags = RESOURCE_FACTORY_FLAGS_RELOAD_SUPPORT;
-
-            int32_t http_cache = dmConfigFile::GetInt(engine->m_Config, "resource.http_cache", 1);
-            if (http_cache)
-                params.m_Flags |= RESOURCE_FACTORY_FLAGS_HTTP_CACHE;
+            if (OpenInputRecord(&engine->m_InputRecord, input_replay_path, INPUT_RECORD_MODE_REPLAY))
+            {
+                engine->m_InputRecord.m_QuitWhenDone = dmConfigFile::GetInt(engine->m_Config, "engine.input_replay_quit", 1) != 0;
+                dmLogInfo("Replaying input from '%s'", input_replay_path);
+            }
         }
-
-        int32_t liveupdate_enable = dmConfigFile::GetInt(engine->m_Config, "liveupdate.enabled", 1);
-        int32_t liveupdate_mount_on_start = dmConfigFile::GetInt(engine->m_Config, "liveupdate.mount_on_start", 1);
-        if (liveupdate_enable && liveupdate_mount_on_start)
+        else if (input_record_path && input_record_path[0])
         {
-            params.m_Flags |= RESOURCE_FACTORY_FLAGS_LIVE_UPDATE_MOUNTS_ON_START;
+            if (OpenInputRecord(&engine->m_InputRecord, input_record_path, INPUT_RECORD_MODE_RECORD))
+            {
+                dmLogInfo("Recording input to '%s'", input_record_path);
+            }
         }
 
-#if !defined(DM_RELEASE)
-        params.m_ArchiveIndex.m_Data = (const void*) BUILTINS_ARCI;
-        params.m_ArchiveIndex.m_Size = BUILTINS_ARCI_SIZE;
-        params.m_ArchiveData.m_Data = (const void*) BUILTINS_ARCD;
-        params.m_ArchiveData.m_Size = BUILTINS_ARCD_SIZE;
-        params.m_ArchiveManifest.m_Data = (const void*) BUILTINS_DMANIFEST;
-        params.m_ArchiveManifest.m_Size = BUILTINS_DMANIFEST_SIZE;
-#endif
+        dmGameSystem::OnWindowCreated(physical_width, physical_height);
+
+        SetUpdateFrequency(engine, dmConfigFile::GetInt(engine->m_Config, "display.update_frequency", 0));
 
-        const char* resource_uri = dmConfigFile::GetString(engine->m_Config, "resource.uri", project_file_uri);
-        dmLogInfo("Loading data from: %s", resource_uri);
-        engine->m_Factory = dmResource::NewFactory(&params, resource_uri);
         if (!engine->m_Factory)
         {
             return false;
@@ -1038,19 +1210,15 @@ namespace dmEngine
             module_script_contexts.Push(engine->m_GuiScriptContext);
         }
 
-        dmSound::InitializeParams sound_params;
-        sound_params.m_OutputDevice = "default";
-#if defined(__EMSCRIPTEN__)
-        sound_params.m_UseThread = false;
-#else
-        sound_params.m_UseThread = dmConfigFile::GetInt(engine->m_Config, "sound.use_thread", 1) != 0;
-#endif
-        dmSound::Result soundInit = dmSound::Initialize(engine->m_Config, &sound_params);
-        if (dmSound::RESULT_OK == soundInit) {
-            dmLogInfo("Initialised sound device '%s'", sound_params.m_OutputDevice);
-        } else {
-            dmLogWarning("Failed to initialize sound system.");
+        for (uint32_t i = 0; i < module_script_contexts.Size(); ++i)
+        {
+            dmScript::HContext context = module_script_contexts[i];
+            const char* context_name = 0;
+            if (!shared)
+                context_name = context == engine->m_GOScriptContext ? "go" : (context == engine->m_GuiScriptContext ? "gui" : "render");
+            SetScriptGCParams(engine, context, context_name);
         }
+        engine->m_ScriptGCStepBudget = dmConfigFile::GetInt(engine->m_Config, "script.gc_step_budget", 0);
 
         dmGameObject::Result go_result = dmGameObject::SetCollectionDefaultCapacity(engine->m_Register, dmConfigFile::GetInt(engine->m_Config, dmGameObject::COLLECTION_MAX_INSTANCES_KEY, dmGameObject::DEFAULT_MAX_COLLECTION_CAPACITY));
         if(go_result != dmGameObject::RESULT_OK)
@@ -1059,6 +1227,7 @@ namespace dmEngine
             return false;
         }
         dmGameObject::SetInputStackDefaultCapacity(engine->m_Register, dmConfigFile::GetInt(engine->m_Config, dmGameObject::COLLECTION_MAX_INPUT_STACK_ENTRIES_KEY, dmGameObject::DEFAULT_MAX_INPUT_STACK_CAPACITY));
+        dmGameObject::SetJobThread(engine->m_Register, engine->m_WorkerJobThreadContext);
 
         dmRender::RenderContextParams render_params;
         render_params.m_MaxRenderTypes = 16;
@@ -1067,6 +1236,7 @@ namespace dmEngine
         render_params.m_MaxCharacters = (uint32_t) dmConfigFile::GetInt(engine->m_Config, "graphics.max_characters", 2048 * 4);
         render_params.m_CommandBufferSize = 1024;
         render_params.m_ScriptContext = engine->m_RenderScriptContext;
+        render_params.m_JobThread = engine->m_WorkerJobThreadContext;
 #if !defined(DM_RELEASE)
         render_params.m_VertexShaderDesc = ::DEBUG_VPC;
         render_params.m_VertexShaderDescSize = ::DEBUG_VPC_SIZE;
@@ -1083,6 +1253,7 @@ namespace dmEngine
 
         engine->m_ParticleFXContext.m_Factory = engine->m_Factory;
         engine->m_ParticleFXContext.m_RenderContext = engine->m_RenderContext;
+        engine->m_ParticleFXContext.m_JobThread = engine->m_WorkerJobThreadContext;
         engine->m_ParticleFXContext.m_MaxParticleFXCount = dmConfigFile::GetInt(engine->m_Config, dmParticle::MAX_INSTANCE_COUNT_KEY, 64);
         engine->m_ParticleFXContext.m_MaxEmitterCount = dmConfigFile::GetInt(engine->m_Config, dmParticle::MAX_EMITTER_COUNT_KEY, 64);
         engine->m_ParticleFXContext.m_MaxParticleCount = dmConfigFile::GetInt(engine->m_Config, dmParticle::MAX_PARTICLE_COUNT_KEY, 1024);
@@ -1137,6 +1308,7 @@ namespace dmEngine
         gui_params.m_DefaultProjectWidth = engine->m_Width;
         gui_params.m_DefaultProjectHeight = engine->m_Height;
         gui_params.m_Dpi = physical_dpi;
+        gui_params.m_ScissorClipping = dmConfigFile::GetInt(engine->m_Config, "gui.scissor_clipping", 1) != 0;
 
         engine->m_GuiContext = dmGui::NewContext(&gui_params);
 
@@ -1151,6 +1323,8 @@ namespace dmEngine
         physics_params.m_RayCastLimit3D = dmConfigFile::GetInt(engine->m_Config, "physics.ray_cast_limit_3d", 128);
         physics_params.m_TriggerOverlapCapacity = dmConfigFile::GetInt(engine->m_Config, "physics.trigger_overlap_capacity", 16);
         physics_params.m_VelocityThreshold = dmConfigFile::GetFloat(engine->m_Config, "physics.velocity_threshold", 1.0f);
+        physics_params.m_RegionSize2D = dmConfigFile::GetFloat(engine->m_Config, "physics.region_size", 0.0f);
+        physics_params.m_RegionRadius2D = dmConfigFile::GetInt(engine->m_Config, "physics.region_radius", 1);
         if (physics_params.m_Scale < dmPhysics::MIN_SCALE || physics_params.m_Scale > dmPhysics::MAX_SCALE)
         {
             dmLogWarning("Physics scale must be in the range %.2f - %.2f and has been clamped.", dmPhysics::MIN_SCALE, dmPhysics::MAX_SCALE);
@@ -1161,6 +1335,7 @@ namespace dmEngine
         }
         physics_params.m_ContactImpulseLimit = dmConfigFile::GetFloat(engine->m_Config, "physics.contact_impulse_limit", 0.0f);
         physics_params.m_AllowDynamicTransforms = dmConfigFile::GetInt(engine->m_Config, "physics.allow_dynamic_transforms", 1) ? 1 : 0;
+        physics_params.m_JobThread = engine->m_WorkerJobThreadContext;
         if (dmStrCaseCmp(physics_type, "3D") == 0)
         {
             engine->m_PhysicsContext.m_3D = true;
@@ -1206,7 +1381,10 @@ namespace dmEngine
 
         engine->m_ModelContext.m_RenderContext = engine->m_RenderContext;
         engine->m_ModelContext.m_Factory = engine->m_Factory;
+        engine->m_ModelContext.m_JobThread = engine->m_WorkerJobThreadContext;
         engine->m_ModelContext.m_MaxModelCount = dmConfigFile::GetInt(engine->m_Config, "model.max_count", 128);
+        engine->m_ModelContext.m_CullOffscreenAnimation = dmConfigFile::GetInt(engine->m_Config, "model.cull_offscreen_animation", 0) != 0;
+        engine->m_ModelContext.m_OcclusionCulling = dmConfigFile::GetInt(engine->m_Config, "model.occlusion_culling", 0) != 0;
 
         engine->m_LabelContext.m_RenderContext      = engine->m_RenderContext;
         engine->m_LabelContext.m_MaxLabelCount      = dmConfigFile::GetInt(engine->m_Config, "label.max_count", 64);
@@ -1221,6 +1399,7 @@ namespace dmEngine
 
         engine->m_CollectionProxyContext.m_Factory = engine->m_Factory;
         engine->m_CollectionProxyContext.m_MaxCollectionProxyCount = dmConfigFile::GetInt(engine->m_Config, dmGameSystem::COLLECTION_PROXY_MAX_COUNT_KEY, 8);
+        engine->m_CollectionProxyContext.m_LoadBudget = dmConfigFile::GetInt(engine->m_Config, dmGameSystem::COLLECTION_PROXY_LOAD_BUDGET_KEY, 10);
 
         engine->m_FactoryContext.m_MaxFactoryCount = dmConfigFile::GetInt(engine->m_Config, dmGameSystem::FACTORY_MAX_COUNT_KEY, 128);
         engine->m_FactoryContext.m_Factory = engine->m_Factory;
@@ -1277,6 +1456,24 @@ namespace dmEngine
         if (go_result != dmGameObject::RESULT_OK)
             goto bail;
 
+        // The resources read until the main collection is loaded are stored in one file, and read
+        // from it on the next launch (until the archives change)
+        if (dmConfigFile::GetInt(engine->m_Config, "resource.startup_snapshot", 0))
+        {
+            uint64_t snapshot_key;
+            char snapshot_path[DMPATH_MAX_PATH];
+            if (dmResource::GetStartupSnapshotKey(engine->m_Factory, &snapshot_key) == dmResource::RESULT_OK &&
+                dmSys::GetApplicationSupportPath(application_name, snapshot_path, sizeof(snapshot_path)) == dmSys::RESULT_OK)
+            {
+                dmStrlCat(snapshot_path, "/startup_snapshot", sizeof(snapshot_path));
+                uint32_t snapshot_max_size = (uint32_t) dmConfigFile::GetInt(engine->m_Config, "resource.startup_snapshot_max_size", 32 * 1024 * 1024);
+                if (dmResource::OpenStartupSnapshot(engine->m_Factory, snapshot_path, snapshot_key, snapshot_max_size))
+                {
+                    dmLogInfo("Loaded the startup snapshot '%s'", snapshot_path);
+                }
+            }
+        }
+
         if (!LoadBootstrapContent(engine, engine->m_Config))
         {
             dmLogError("Unable to load bootstrap data.");
@@ -1385,6 +1582,8 @@ namespace dmEngine
             goto bail;
         dmGameObject::Init(engine->m_MainCollection);
 
+        dmResource::CloseStartupSnapshot(engine->m_Factory);
+
         engine->m_LastReloadMTime = 0;
 
 #if defined(__NX__)
@@ -1502,6 +1701,7 @@ bail:
         input_action.m_AccX = action->m_AccX;
         input_action.m_AccY = action->m_AccY;
         input_action.m_AccZ = action->m_AccZ;
+        input_action.m_Time = engine->m_InputSampleTime;
 
         input_action.m_TouchCount = action->m_TouchCount;
         int tc = action->m_TouchCount;
@@ -1570,10 +1770,241 @@ bail:
         return memcount;
     }
 
-    static void StepFrame(HEngine engine, float dt)
+    // E.g. "script.gc_pause" can be overridden per context with "script.gui_gc_pause"
+    static void SetScriptGCParams(HEngine engine, dmScript::HContext context, const char* context_name)
+    {
+        int pause = dmConfigFile::GetInt(engine->m_Config, "script.gc_pause", 0);
+        int step_mul = dmConfigFile::GetInt(engine->m_Config, "script.gc_stepmul", 0);
+        if (context_name)
+        {
+            char key[64];
+            dmSnPrintf(key, sizeof(key), "script.%s_gc_pause", context_name);
+            pause = dmConfigFile::GetInt(engine->m_Config, key, pause);
+            dmSnPrintf(key, sizeof(key), "script.%s_gc_stepmul", context_name);
+            step_mul = dmConfigFile::GetInt(engine->m_Config, key, step_mul);
+        }
+        dmScript::SetLuaGCParams(dmScript::GetLuaState(context), pause, step_mul);
+    }
+
+    static void StepScriptGC(HEngine engine, float dt, uint64_t frame_start)
+    {
+        if (engine->m_ScriptGCStepBudget == 0)
+            return;
+
+        // The frame is already over budget, postpone the collection to a later frame.
+        // Lua's own allocation driven steps still run, so memory cannot grow unbounded
+        uint64_t target_time = (uint64_t)(dt * 1000000.0f);
+        uint64_t elapsed = dmTime::GetTime() - frame_start;
+        if (elapsed >= target_time)
+            return;
+
+        DM_PROFILE("LuaGC");
+        uint64_t budget = dmMath::Min((uint64_t)engine->m_ScriptGCStepBudget, target_time - elapsed);
+        uint64_t gc_start = dmTime::GetTime();
+        uint32_t steps = 0;
+        if (engine->m_SharedScriptContext)
+        {
+            steps += dmScript::StepLuaGC(dmScript::GetLuaState(engine->m_SharedScriptContext), budget);
+        }
+        else
+        {
+            // Split the budget over the contexts
+            budget = dmMath::Max(budget / 3, (uint64_t)1);
+            steps += dmScript::StepLuaGC(dmScript::GetLuaState(engine->m_GOScriptContext), budget);
+            steps += dmScript::StepLuaGC(dmScript::GetLuaState(engine->m_GuiScriptContext), budget);
+            steps += dmScript::StepLuaGC(dmScript::GetLuaState(engine->m_RenderScriptContext), budget);
+        }
+        DM_PROPERTY_SET_U32(rmtp_LuaGCTime, (uint32_t)(dmTime::GetTime() - gc_start));
+        DM_PROPERTY_SET_U32(rmtp_LuaGCSteps, steps);
+    }
+
+    static void GetRandomSeedContexts(HEngine engine, dmScript::HContext contexts[INPUT_RECORD_MAX_SEED_COUNT])
+    {
+        bool shared = engine->m_SharedScriptContext != 0;
+        contexts[0] = shared ? engine->m_SharedScriptContext : engine->m_GOScriptContext;
+        contexts[1] = shared ? 0 : engine->m_GuiScriptContext;
+        contexts[2] = shared ? 0 : engine->m_RenderScriptContext;
+    }
+
+    // Replaces the dt with the recorded one. Returns false when the replay has finished
+    static bool BeginReplayFrame(HEngine engine, float* dt)
+    {
+        InputRecord* record = &engine->m_InputRecord;
+        InputRecordFrame frame;
+        if (!ReadInputRecordFrame(record, &frame))
+        {
+            float total_time = (dmTime::GetTime() - record->m_StartTime) / 1000000.0f;
+            uint32_t median, p95, p99;
+            GetFrameTimePercentiles(&engine->m_FrameStats, &median, &p95, &p99);
+            dmLogInfo("Replay finished: %u frames in %.2f s, average %.2f ms, median %.2f ms, p95 %.2f ms, p99 %.2f ms",
+                        record->m_FrameCount, total_time, record->m_FrameCount ? total_time * 1000.0f / record->m_FrameCount : 0.0f,
+                        median / 1000.0f, p95 / 1000.0f, p99 / 1000.0f);
+            if (record->m_QuitWhenDone)
+            {
+                engine->m_Alive = false;
+            }
+            CloseInputRecord(record);
+            return false;
+        }
+
+        // The seeds are applied now, and the input state after the hid update
+        dmScript::HContext contexts[INPUT_RECORD_MAX_SEED_COUNT];
+        GetRandomSeedContexts(engine, contexts);
+        for (uint32_t i = 0; i < INPUT_RECORD_MAX_SEED_COUNT; ++i)
+        {
+            if (contexts[i])
+                dmScript::SetRandomSeed(dmScript::GetLuaState(contexts[i]), frame.m_RandomSeeds[i]);
+        }
+
+        *dt = frame.m_Dt;
+        engine->m_AccumFrameTime = frame.m_AccumFrameTime;
+        return true;
+    }
+
+    // Called after the hid update, before the input is dispatched
+    static void UpdateInputRecord(HEngine engine, float dt)
+    {
+        InputRecord* record = &engine->m_InputRecord;
+        if (record->m_Mode == INPUT_RECORD_MODE_REPLAY)
+        {
+            dmHID::SetInputState(engine->m_HidContext, &record->m_State);
+        }
+        else if (record->m_Mode == INPUT_RECORD_MODE_RECORD)
+        {
+            InputRecordFrame frame;
+            memset(&frame, 0, sizeof(frame));
+            frame.m_Dt = dt;
+            frame.m_AccumFrameTime = engine->m_AccumFrameTime;
+
+            dmScript::HContext contexts[INPUT_RECORD_MAX_SEED_COUNT];
+            GetRandomSeedContexts(engine, contexts);
+            for (uint32_t i = 0; i < INPUT_RECORD_MAX_SEED_COUNT; ++i)
+            {
+                if (contexts[i])
+                    frame.m_RandomSeeds[i] = dmScript::GetRandomSeed(dmScript::GetLuaState(contexts[i]));
+            }
+
+            dmHID::InputState state;
+            dmHID::GetInputState(engine->m_HidContext, &state);
+            if (!WriteInputRecordFrame(record, &frame, &state))
+            {
+                dmLogError("Failed to write the input recording, recording stopped");
+                CloseInputRecord(record);
+            }
+        }
+    }
+
+    static void GetExtensionParams(HEngine engine, dmExtension::Params* ext_params)
+    {
+        ext_params->m_ConfigFile = engine->m_Config;
+        ext_params->m_ResourceFactory = engine->m_Factory;
+        if (engine->m_SharedScriptContext) {
+            ext_params->m_L = dmScript::GetLuaState(engine->m_SharedScriptContext);
+        } else {
+            ext_params->m_L = dmScript::GetLuaState(engine->m_GOScriptContext);
+        }
+    }
+
+    // The render phase of a frame: builds the render list from the components, and lets the render script draw it.
+    // Note that it can't yet run on a thread of its own, overlapping the next frame's update. The component render
+    // functions read the simulation state directly, and the render script shares the Lua state with the game scripts
+    static void RenderFrame(HEngine engine, float dt)
+    {
+        // Call pre render functions for extensions, if available.
+        // We do it here before we render rest of the frame
+        // if any extension wants to render on under of the game.
+        dmExtension::Params ext_params;
+        GetExtensionParams(engine, &ext_params);
+        dmExtension::PreRender(&ext_params);
+
+        // Make the render list that will be used later.
+        dmRender::RenderListBegin(engine->m_RenderContext);
+        dmGameObject::Render(engine->m_MainCollection);
+
+        // Make sure we dispatch messages to the render script
+        // since it could have some "draw_text" messages waiting.
+        if (engine->m_RenderScriptPrototype)
+        {
+            dmRender::DispatchRenderScriptInstance(engine->m_RenderScriptPrototype->m_Instance);
+        }
+
+        dmRender::RenderListEnd(engine->m_RenderContext);
+
+        dmGraphics::BeginFrame(engine->m_GraphicsContext);
+
+        if (engine->m_RenderScriptPrototype)
+        {
+            dmRender::UpdateRenderScriptInstance(engine->m_RenderScriptPrototype->m_Instance, dt);
+        }
+        else
+        {
+            dmGraphics::SetViewport(engine->m_GraphicsContext, 0, 0, dmGraphics::GetWindowWidth(engine->m_GraphicsContext), dmGraphics::GetWindowHeight(engine->m_GraphicsContext));
+            dmGraphics::Clear(engine->m_GraphicsContext, dmGraphics::BUFFER_TYPE_COLOR0_BIT | dmGraphics::BUFFER_TYPE_DEPTH_BIT | dmGraphics::BUFFER_TYPE_STENCIL_BIT,
+                                (float)((engine->m_ClearColor>> 0)&0xFF),
+                                (float)((engine->m_ClearColor>> 8)&0xFF),
+                                (float)((engine->m_ClearColor>>16)&0xFF),
+                                (float)((engine->m_ClearColor>>24)&0xFF),
+                                1.0f, 0);
+            dmRender::DrawRenderList(engine->m_RenderContext, 0x0, 0x0, 0x0);
+        }
+    }
+
+    // The last frame of a Step() is paced, and presented when it's due
+    static void PaceFrame(HEngine engine)
+    {
+        FramePacer* pacer = &engine->m_FramePacer;
+        uint32_t divisor = GetFramePacerDivisor(pacer);
+        uint64_t remainder = UpdateFramePacer(pacer, engine->m_StepStartTime, dmTime::GetTime());
+
+        if (engine->m_UseSwVSync)
+        {
+            DM_PROFILE("SoftwareVsync");
+            while (remainder > 500) // dont bother with less than 0.5ms
+            {
+                uint64_t t1 = dmTime::GetTime();
+                dmTime::Sleep(100); // sleep in chunks of 0.1ms
+                uint64_t t2 = dmTime::GetTime();
+                uint64_t slept = t2 - t1;
+                if (slept >= remainder)
+                    break;
+                remainder -= slept;
+            }
+        }
+        else if (engine->m_SwapInterval > 0 && divisor != GetFramePacerDivisor(pacer))
+        {
+            // Let the vsync do the pacing at the new rate
+            dmGraphics::SetSwapInterval(engine->m_GraphicsContext, engine->m_SwapInterval * GetFramePacerDivisor(pacer));
+        }
+    }
+
+    // Polls the OS events and input devices. Returns false if the app was iconified by the events,
+    // and the frame should be skipped
+    static bool SampleInput(HEngine engine, float dt)
+    {
+        {
+            DM_PROFILE("Hid");
+            dmHID::Update(engine->m_HidContext);
+            UpdateInputRecord(engine, dt);
+            engine->m_InputSampleTime = dmTime::GetTime();
+        }
+        if (!engine->m_RunWhileIconified) {
+            if (dmGraphics::GetWindowStateParam(engine->m_GraphicsContext, dmPlatform::WINDOW_STATE_ICONIFIED))
+            {
+                // NOTE: This is a bit ugly but os event are polled in dmHID::Update and an iOS application
+                // might have entered background at this point and OpenGL calls are not permitted and will
+                // crash the application
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static void StepFrame(HEngine engine, float dt, bool last_step)
     {
         uint64_t frame_start = dmTime::GetTime();
 
+        dmMemory::FrameAllocatorNewFrame();
+
         dmProfiler::SetUpdateFrequency((uint32_t)(1.0f / dt));
 
         if (dmGraphics::GetWindowStateParam(engine->m_GraphicsContext, dmPlatform::WINDOW_STATE_ICONIFIED))
@@ -1606,6 +2037,15 @@ bail:
             }
         }
 
+        if (engine->m_InputRecord.m_Mode == INPUT_RECORD_MODE_REPLAY)
+        {
+            if (!BeginReplayFrame(engine, &dt) && !engine->m_Alive)
+                return;
+        }
+
+        FrameStats* frame_stats = &engine->m_FrameStats;
+        FrameStatsBeginFrame(frame_stats, frame_start);
+
         dmProfile::HProfile profile = dmProfile::BeginFrame();
         {
             DM_PROFILE("Frame");
@@ -1617,23 +2057,26 @@ bail:
                     DM_PROFILE("Resource");
                     dmResource::UpdateFactory(engine->m_Factory);
                 }
+                FrameStatsEndPhase(frame_stats, FRAME_PHASE_RESOURCE, dmTime::GetTime());
 
+                // In low latency mode, the input is sampled after the other systems are updated, right before it's dispatched
+                if (!engine->m_LowLatencyInput)
                 {
-                    DM_PROFILE("Hid");
-                    dmHID::Update(engine->m_HidContext);
-                }
-                if (!engine->m_RunWhileIconified) {
-                    if (dmGraphics::GetWindowStateParam(engine->m_GraphicsContext, dmPlatform::WINDOW_STATE_ICONIFIED))
+                    bool active = SampleInput(engine, dt);
+                    FrameStatsEndPhase(frame_stats, FRAME_PHASE_INPUT, dmTime::GetTime());
+                    if (!active)
                     {
-                        // NOTE: This is a bit ugly but os event are polled in dmHID::Update and an iOS application
-                        // might have entered background at this point and OpenGL calls are not permitted and will
-                        // crash the application
                         dmProfile::EndFrame(profile);
                         return;
                     }
                 }
 
                 dmJobThread::Update(engine->m_JobThreadContext);
+                if (engine->m_WorkerJobThreadContext)
+                {
+                    dmJobThread::Update(engine->m_WorkerJobThreadContext);
+                }
+                FrameStatsEndPhase(frame_stats, FRAME_PHASE_RESOURCE, dmTime::GetTime());
 
                 {
                     DM_PROFILE("Script");
@@ -1670,7 +2113,21 @@ bail:
                     }
                 }
 
+                FrameStatsEndPhase(frame_stats, FRAME_PHASE_SCRIPT, dmTime::GetTime());
+
                 dmSound::Update();
+                FrameStatsEndPhase(frame_stats, FRAME_PHASE_SOUND, dmTime::GetTime());
+
+                if (engine->m_LowLatencyInput)
+                {
+                    bool active = SampleInput(engine, dt);
+                    FrameStatsEndPhase(frame_stats, FRAME_PHASE_INPUT, dmTime::GetTime());
+                    if (!active)
+                    {
+                        dmProfile::EndFrame(profile);
+                        return;
+                    }
+                }
 
                 bool esc_pressed = false;
                 if (engine->m_QuitOnEsc)
@@ -1706,7 +2163,7 @@ bail:
                 {
                     dmGameObject::DispatchInput(engine->m_MainCollection, &input_buffer[0], input_buffer.Size());
                 }
-
+                FrameStatsEndPhase(frame_stats, FRAME_PHASE_INPUT, dmTime::GetTime());
 
                 dmGameObject::UpdateContext update_context;
                 update_context.m_TimeScale = 1.0f;
@@ -1714,54 +2171,14 @@ bail:
                 update_context.m_FixedUpdateFrequency = engine->m_FixedUpdateFrequency;
                 update_context.m_AccumFrameTime = engine->m_AccumFrameTime;
                 dmGameObject::Update(engine->m_MainCollection, &update_context);
+                FrameStatsEndPhase(frame_stats, FRAME_PHASE_UPDATE, dmTime::GetTime());
 
                 // Don't render while iconified
                 if (!dmGraphics::GetWindowStateParam(engine->m_GraphicsContext, dmPlatform::WINDOW_STATE_ICONIFIED))
                 {
-                    // Call pre render functions for extensions, if available.
-                    // We do it here before we render rest of the frame
-                    // if any extension wants to render on under of the game.
-                    dmExtension::Params ext_params;
-                    ext_params.m_ConfigFile = engine->m_Config;
-                    ext_params.m_ResourceFactory = engine->m_Factory;
-                    if (engine->m_SharedScriptContext) {
-                        ext_params.m_L = dmScript::GetLuaState(engine->m_SharedScriptContext);
-                    } else {
-                        ext_params.m_L = dmScript::GetLuaState(engine->m_GOScriptContext);
-                    }
-                    dmExtension::PreRender(&ext_params);
-
-                    // Make the render list that will be used later.
-                    dmRender::RenderListBegin(engine->m_RenderContext);
-                    dmGameObject::Render(engine->m_MainCollection);
-
-                    // Make sure we dispatch messages to the render script
-                    // since it could have some "draw_text" messages waiting.
-                    if (engine->m_RenderScriptPrototype)
-                    {
-                        dmRender::DispatchRenderScriptInstance(engine->m_RenderScriptPrototype->m_Instance);
-                    }
-
-                    dmRender::RenderListEnd(engine->m_RenderContext);
-
-                    dmGraphics::BeginFrame(engine->m_GraphicsContext);
-
-                    if (engine->m_RenderScriptPrototype)
-                    {
-                        dmRender::UpdateRenderScriptInstance(engine->m_RenderScriptPrototype->m_Instance, dt);
-                    }
-                    else
-                    {
-                        dmGraphics::SetViewport(engine->m_GraphicsContext, 0, 0, dmGraphics::GetWindowWidth(engine->m_GraphicsContext), dmGraphics::GetWindowHeight(engine->m_GraphicsContext));
-                        dmGraphics::Clear(engine->m_GraphicsContext, dmGraphics::BUFFER_TYPE_COLOR0_BIT | dmGraphics::BUFFER_TYPE_DEPTH_BIT | dmGraphics::BUFFER_TYPE_STENCIL_BIT,
-                                            (float)((engine->m_ClearColor>> 0)&0xFF),
-                                            (float)((engine->m_ClearColor>> 8)&0xFF),
-                                            (float)((engine->m_ClearColor>>16)&0xFF),
-                                            (float)((engine->m_ClearColor>>24)&0xFF),
-                                            1.0f, 0);
-                        dmRender::DrawRenderList(engine->m_RenderContext, 0x0, 0x0, 0x0);
-                    }
+                    RenderFrame(engine, dt);
                 }
+                FrameStatsEndPhase(frame_stats, FRAME_PHASE_RENDER, dmTime::GetTime());
 
                 dmGameObject::PostUpdate(engine->m_MainCollection);
                 dmGameObject::PostUpdate(engine->m_Register);
@@ -1770,10 +2187,21 @@ bail:
 
 
                 dmMessage::Dispatch(engine->m_SystemSocket, Dispatch, engine);
+                FrameStatsEndPhase(frame_stats, FRAME_PHASE_UPDATE, dmTime::GetTime());
             } // Sim
 
+            uint32_t lua_mem = GetLuaMemCount(engine);
+            dmMemory::SetUsage(dmMemory::CATEGORY_LUA, lua_mem * 1024);
+
             DM_PROPERTY_SET_U32(rmtp_LuaRefs, dmScript::GetLuaRefCount());
-            DM_PROPERTY_SET_U32(rmtp_LuaMem, GetLuaMemCount(engine));
+            DM_PROPERTY_SET_U32(rmtp_LuaMem, lua_mem);
+
+            DM_PROPERTY_SET_U32(rmtp_MemResource, dmMemory::GetUsage(dmMemory::CATEGORY_RESOURCE) / 1024);
+            DM_PROPERTY_SET_U32(rmtp_MemLua, dmMemory::GetUsage(dmMemory::CATEGORY_LUA) / 1024);
+            DM_PROPERTY_SET_U32(rmtp_MemGraphics, dmMemory::GetUsage(dmMemory::CATEGORY_GRAPHICS) / 1024);
+            DM_PROPERTY_SET_U32(rmtp_MemSound, dmMemory::GetUsage(dmMemory::CATEGORY_SOUND) / 1024);
+            DM_PROPERTY_SET_U32(rmtp_MemPhysics, dmMemory::GetUsage(dmMemory::CATEGORY_PHYSICS) / 1024);
+            DM_PROPERTY_SET_U32(rmtp_MemOther, dmMemory::GetUsage(dmMemory::CATEGORY_OTHER) / 1024);
 
             if (dLib::IsDebugMode())
             {
@@ -1798,38 +2226,21 @@ bail:
             if (!dmGraphics::GetWindowStateParam(engine->m_GraphicsContext, dmPlatform::WINDOW_STATE_ICONIFIED))
             {
                 dmExtension::Params ext_params;
-                ext_params.m_ConfigFile = engine->m_Config;
-                ext_params.m_ResourceFactory = engine->m_Factory;
-                if (engine->m_SharedScriptContext) {
-                    ext_params.m_L = dmScript::GetLuaState(engine->m_SharedScriptContext);
-                } else {
-                    ext_params.m_L = dmScript::GetLuaState(engine->m_GOScriptContext);
-                }
+                GetExtensionParams(engine, &ext_params);
                 dmExtension::PostRender(&ext_params);
             }
+            FrameStatsEndPhase(frame_stats, FRAME_PHASE_RENDER, dmTime::GetTime());
 
-            if (engine->m_UseSwVSync && engine->m_UpdateFrequency > 0)
-            {
-                DM_PROFILE("SoftwareVsync");
-                uint64_t current = dmTime::GetTime();
-
-                float target_time = dt; // already pre calculated by CalcTimeStep
-                uint64_t elapsed = current - frame_start;
-                uint64_t remainder = uint64_t(target_time*1000000) - elapsed;
+            StepScriptGC(engine, dt, frame_start);
+            FrameStatsEndPhase(frame_stats, FRAME_PHASE_GC, dmTime::GetTime());
 
-                while (remainder > 500) // dont bother with less than 0.5ms
-                {
-                    uint64_t t1 = dmTime::GetTime();
-                    dmTime::Sleep(100); // sleep in chunks of 0.1ms
-                    uint64_t t2 = dmTime::GetTime();
-                    uint64_t slept = t2 - t1;
-                    if (slept >= remainder)
-                        break;
-                    remainder -= slept;
-                }
+            if (last_step && engine->m_UpdateFrequency > 0)
+            {
+                PaceFrame(engine);
             }
 
             dmGraphics::Flip(engine->m_GraphicsContext);
+            FrameStatsEndPhase(frame_stats, FRAME_PHASE_FLIP, dmTime::GetTime());
 
             RecordData* record_data = &engine->m_RecordData;
             if (record_data->m_Recorder)
@@ -1840,12 +2251,15 @@ bail:
                     uint32_t height = dmGraphics::GetHeight(engine->m_GraphicsContext);
                     uint32_t buffer_size = width * height * 4;
 
-                    dmGraphics::ReadPixels(engine->m_GraphicsContext, record_data->m_Buffer, buffer_size);
-
-                    dmRecord::Result r = dmRecord::RecordFrame(record_data->m_Recorder, record_data->m_Buffer, buffer_size, dmRecord::BUFFER_FORMAT_BGRA);
-                    if (r != dmRecord::RESULT_OK)
+                    // The pixels are of a frame a few frames back, so the read doesn't stall the gpu.
+                    // The frames are encoded on the recorder thread
+                    if (dmGraphics::ReadPixelsAsync(engine->m_GraphicsContext, record_data->m_Buffer, buffer_size))
                     {
-                        dmLogError("Error while recoding frame (%d)", r);
+                        dmRecord::Result r = dmRecord::RecordFrame(record_data->m_Recorder, record_data->m_Buffer, buffer_size, dmRecord::BUFFER_FORMAT_BGRA);
+                        if (r != dmRecord::RESULT_OK)
+                        {
+                            dmLogError("Error while recoding frame (%d)", r);
+                        }
                     }
                 }
                 record_data->m_FrameCount++;
@@ -1853,6 +2267,8 @@ bail:
         }
         dmProfile::EndFrame(profile);
 
+        FrameStatsEndFrame(frame_stats, dmTime::GetTime());
+
         ++engine->m_Stats.m_FrameCount;
         engine->m_Stats.m_TotalTime += dt;
     }
@@ -1884,7 +2300,8 @@ bail:
         // We don't allow having a higher framerate than the actual variable frame rate
         // since the update+render is currently coupled together and also Flip() would be called more than once.
         // E.g. if the fixed_dt == 1/120 and the frame_dt == 1/60
-        if (fixed_dt < frame_dt)
+        // With a decoupled render, the steps are simulated together (see Step())
+        if (fixed_dt < frame_dt && !engine->m_DecoupledRender)
         {
             fixed_dt = frame_dt;
         }
@@ -1908,14 +2325,23 @@ bail:
         float step_dt;      // The dt for each step (the game frame)
         uint32_t num_steps; // Number of times to loop over the StepFrame function
 
+        engine->m_StepStartTime = dmTime::GetTime();
         CalcTimeStep(engine, step_dt, num_steps);
 
+        if (engine->m_DecoupledRender && num_steps > 1)
+        {
+            // A single frame covers all the steps. The collections run the fixed updates (e.g. physics)
+            // once per fixed step, and the render and Flip() are only done once
+            step_dt *= num_steps;
+            num_steps = 1;
+        }
+
         for (uint32_t i = 0; i < num_steps; ++i)
         {
             DM_PROFILE("Step");
             // We currently cannot separate the update from the render,
             // since some of the update is done in the render updates (e.g. sprite transforms)
-            StepFrame(engine, step_dt);
+            StepFrame(engine, step_dt, i + 1 == num_steps);
 
             if (!engine->m_Alive)
                 break;
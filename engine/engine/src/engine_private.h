@@ -40,6 +40,9 @@
 
 #include "engine.h"
 #include "engine_service.h"
+#include "frame_pacing.h"
+#include "frame_stats.h"
+#include "input_record.h"
 #include "engine.h"
 #include <engine/engine_ddf.h>
 #include <dmsdk/gamesys/resources/res_font.h>
@@ -122,6 +125,8 @@ namespace dmEngine
         float                                       m_MouseSensitivity;
 
         dmJobThread::HContext                       m_JobThreadContext;
+        /// Worker threads for splitting up engine work (e.g. frustum culling). Zero if disabled
+        dmJobThread::HContext                       m_WorkerJobThreadContext;
         dmGraphics::HContext                        m_GraphicsContext;
         dmRender::HRenderContext                    m_RenderContext;
         dmGameSystem::PhysicsContext                m_PhysicsContext;
@@ -153,16 +158,26 @@ namespace dmEngine
         dmGameSystem::RenderScriptPrototype*        m_RenderScriptPrototype;
 
         Stats                                       m_Stats;
+        FrameStats                                  m_FrameStats;               // Always on frame timings, used to report frame time spikes
+        FramePacer                                  m_FramePacer;               // Paces the frames when display.update_frequency is set
+        InputRecord                                 m_InputRecord;              // Records or replays the input of each frame
 
         bool                                        m_WasIconified;
         bool                                        m_QuitOnEsc;
         bool                                        m_ConnectionAppMode;        //!< If the app was started on a device, listening for connections
         bool                                        m_RunWhileIconified;
         bool                                        m_UseSwVSync;
+        bool                                        m_AdaptiveFramePacing;      // Lower the frame rate while the frames can't keep up with display.update_frequency
+        bool                                        m_DecoupledRender;          // With a fixed update frequency, the steps of a frame are simulated together and rendered once
+        bool                                        m_LowLatencyInput;          // Sample the input right before it's dispatched, instead of at the start of the frame
+        uint64_t                                    m_InputSampleTime;          // When the input of the current frame was sampled
         uint64_t                                    m_PreviousFrameTime;        // Used to calculate dt
+        uint64_t                                    m_StepStartTime;            // The start of the current Step(), which may run several frames
         float                                       m_AccumFrameTime;           // Used to trigger frame updates when using m_UpdateFrequency != 0
         uint32_t                                    m_UpdateFrequency;
         uint32_t                                    m_FixedUpdateFrequency;
+        uint32_t                                    m_SwapInterval;
+        uint32_t                                    m_ScriptGCStepBudget;       // Time (in microseconds) spent each frame stepping the Lua garbage collector. 0 = disabled
         uint32_t                                    m_Width;
         uint32_t                                    m_Height;
         uint32_t                                    m_ClearColor;
@@ -13,11 +13,13 @@
 // specific language governing permissions and limitations under the License.
 
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 #include <dlib/webserver.h>
 #include <dlib/message.h>
 #include <dlib/dstrings.h>
 #include <dlib/math.h>
+#include <dlib/memory.h>
 #include <dlib/log.h>
 #include <dlib/profile.h>
 #include <dlib/ssdp.h>
@@ -28,6 +30,7 @@
 #include <resource/resource.h>
 #include <gameobject/gameobject.h>
 #include <gamesys/components/comp_gui.h> 
+#include <profiler/profiler.h>
 #include "engine_service.h"
 #include "engine_version.h"
 
@@ -877,6 +880,184 @@ namespace dmEngineService
         OutputJsonSceneGraph(&root, request, 0);
     }
 
+    //
+    // Memory usage per subsystem
+    //
+
+    static void HttpMemoryRequestCallback(void* context, dmWebServer::Request* request)
+    {
+        dmWebServer::SetStatusCode(request, 200);
+        dmWebServer::SendAttribute(request, "Content-Type", "application/json");
+        dmWebServer::SendAttribute(request, "Access-Control-Allow-Origin", "*");
+        dmWebServer::SendAttribute(request, "Cache-Control", "no-store");
+
+        SendText(request, "{\n");
+        for (uint32_t i = 0; i < dmMemory::MAX_CATEGORY_COUNT; ++i)
+        {
+            dmMemory::Category category = (dmMemory::Category)i;
+            char buf[256];
+            dmSnPrintf(buf, sizeof(buf), "  \"%s\": { \"usage\": %u, \"peak\": %u, \"budget\": %u }%s\n",
+                        dmMemory::GetCategoryName(category),
+                        dmMemory::GetUsage(category),
+                        dmMemory::GetPeakUsage(category),
+                        dmMemory::GetBudget(category),
+                        (i + 1) < dmMemory::MAX_CATEGORY_COUNT ? "," : "");
+            SendText(request, buf);
+        }
+        SendText(request, "}\n");
+    }
+
+    //
+    // Component type costs per collection
+    //
+
+    struct ComponentStatsContext
+    {
+        dmWebServer::Request* m_Request;
+        bool                  m_First;
+    };
+
+    static void SendComponentTypeStats(void* ctx, const char* collection_name, const dmGameObject::ComponentTypeStats* stats)
+    {
+        ComponentStatsContext* context = (ComponentStatsContext*)ctx;
+        char buf[512];
+        dmSnPrintf(buf, sizeof(buf), "%s  { \"collection\": \"%s\", \"type\": \"%s\", "
+                    "\"update\": %u, \"fixed_update\": %u, \"post_update\": %u, \"render\": %u, "
+                    "\"update_count\": %u, \"fixed_update_count\": %u, \"post_update_count\": %u, \"render_count\": %u }",
+                    context->m_First ? "" : ",\n", collection_name, stats->m_TypeName,
+                    stats->m_UpdateTime, stats->m_FixedUpdateTime, stats->m_PostUpdateTime, stats->m_RenderTime,
+                    stats->m_UpdateCount, stats->m_FixedUpdateCount, stats->m_PostUpdateCount, stats->m_RenderCount);
+        SendText(context->m_Request, buf);
+        context->m_First = false;
+    }
+
+    // The times are in microseconds, and are from the last frame
+    static void HttpComponentStatsRequestCallback(void* context, dmWebServer::Request* request)
+    {
+        dmGameObject::HRegister regist = (dmGameObject::HRegister)context;
+
+        dmWebServer::SetStatusCode(request, 200);
+        dmWebServer::SendAttribute(request, "Content-Type", "application/json");
+        dmWebServer::SendAttribute(request, "Access-Control-Allow-Origin", "*");
+        dmWebServer::SendAttribute(request, "Cache-Control", "no-store");
+
+        ComponentStatsContext ctx;
+        ctx.m_Request = request;
+        ctx.m_First = true;
+        SendText(request, "[\n");
+        dmGameObject::IterateComponentTypeStats(regist, SendComponentTypeStats, &ctx);
+        SendText(request, "\n]\n");
+    }
+
+    //
+    // Resource load timeline
+    //
+
+    struct LoadTimelineContext
+    {
+        dmWebServer::Request* m_Request;
+        bool                  m_First;
+    };
+
+    static void SendLoadTimelineEntry(void* ctx, const dmResource::LoadTimelineEntry* entry)
+    {
+        LoadTimelineContext* context = (LoadTimelineContext*)ctx;
+        const dmResource::LoadTiming& timing = entry->m_Timing;
+        const char* provider = timing.m_Provider ? dmResource::GetLoadProviderName(timing.m_Provider) : 0;
+
+        char buf[1024];
+        dmSnPrintf(buf, sizeof(buf), "%s  { \"path\": \"%s\", \"async\": %s, \"result\": \"%s\", \"start\": %llu, \"provider\": \"%s\", \"size\": %u",
+                    context->m_First ? "" : ",\n", entry->m_Path, entry->m_Async ? "true" : "false", dmResource::ResultToString(entry->m_Result),
+                    (unsigned long long)timing.m_Start, provider ? provider : "", timing.m_Size);
+        SendText(context->m_Request, buf);
+
+        for (uint32_t i = 0; i < dmResource::MAX_LOAD_PHASE_COUNT; ++i)
+        {
+            dmSnPrintf(buf, sizeof(buf), ", \"%s\": %u", dmResource::GetLoadPhaseName((dmResource::LoadPhase)i), timing.m_Times[i]);
+            SendText(context->m_Request, buf);
+        }
+        SendText(context->m_Request, " }");
+        context->m_First = false;
+    }
+
+    // The times are in microseconds
+    static void HttpResourceTimelineRequestCallback(void* context, dmWebServer::Request* request)
+    {
+        dmResource::HFactory factory = (dmResource::HFactory)context;
+
+        dmWebServer::SetStatusCode(request, 200);
+        dmWebServer::SendAttribute(request, "Content-Type", "application/json");
+        dmWebServer::SendAttribute(request, "Access-Control-Allow-Origin", "*");
+        dmWebServer::SendAttribute(request, "Cache-Control", "no-store");
+
+        LoadTimelineContext ctx;
+        ctx.m_Request = request;
+        ctx.m_First = true;
+        SendText(request, "[\n");
+        dmResource::IterateLoadTimeline(factory, SendLoadTimelineEntry, &ctx);
+        SendText(request, "\n]\n");
+    }
+
+    //
+    // Frame capture
+    //
+
+    static void SendCaptureData(void* ctx, const char* data, uint32_t size)
+    {
+        dmWebServer::Send((dmWebServer::Request*)ctx, data, size);
+    }
+
+    // /profile_capture                                 Get the captured frames in the Chrome trace event format
+    // /profile_capture/start?frames=<n>&spike_ms=<ms>  Start a new capture (both arguments are optional)
+    // /profile_capture/stop                            Stop the current capture
+    static void HttpProfileCaptureRequestCallback(void* context, dmWebServer::Request* request)
+    {
+        const char* command = request->m_Resource + strlen("/profile_capture");
+        if (strncmp(command, "/start", 6) == 0)
+        {
+            uint32_t frame_count = 60;
+            float spike_threshold_ms = 0.0f;
+            const char* frames = strstr(command, "frames=");
+            if (frames)
+                frame_count = (uint32_t)strtoul(frames + strlen("frames="), 0, 10);
+            const char* spike = strstr(command, "spike_ms=");
+            if (spike)
+                spike_threshold_ms = (float)strtod(spike + strlen("spike_ms="), 0);
+
+            dmProfiler::StartCapture(frame_count, spike_threshold_ms);
+            dmWebServer::SetStatusCode(request, 200);
+            dmWebServer::SendAttribute(request, "Access-Control-Allow-Origin", "*");
+            SendText(request, "OK\n");
+            return;
+        }
+        else if (strncmp(command, "/stop", 5) == 0)
+        {
+            dmProfiler::StopCapture();
+            dmWebServer::SetStatusCode(request, 200);
+            dmWebServer::SendAttribute(request, "Access-Control-Allow-Origin", "*");
+            SendText(request, "OK\n");
+            return;
+        }
+
+        if (dmProfiler::IsCapturing())
+        {
+            dmWebServer::SetStatusCode(request, 409);
+            dmWebServer::SendAttribute(request, "Access-Control-Allow-Origin", "*");
+            SendText(request, "The capture is still recording\n");
+            return;
+        }
+
+        dmWebServer::SetStatusCode(request, 200);
+        dmWebServer::SendAttribute(request, "Content-Type", "application/json");
+        dmWebServer::SendAttribute(request, "Access-Control-Allow-Origin", "*");
+        dmWebServer::SendAttribute(request, "Cache-Control", "no-store");
+        dmWebServer::SendAttribute(request, "Content-Disposition", "attachment; filename=\"capture.json\"");
+        if (!dmProfiler::WriteCapture(SendCaptureData, request))
+        {
+            SendText(request, "{\"traceEvents\": []}\n");
+        }
+    }
+
 #undef CHECK_RESULT_BOOL
 
     //
@@ -911,6 +1092,26 @@ namespace dmEngineService
         scenegraph_params.m_Userdata = regist;
         dmWebServer::AddHandler(engine_service->m_WebServer, "/scene_graph", &scenegraph_params);
 
+        dmWebServer::HandlerParams memory_params;
+        memory_params.m_Handler = HttpMemoryRequestCallback;
+        memory_params.m_Userdata = 0;
+        dmWebServer::AddHandler(engine_service->m_WebServer, "/memory_data", &memory_params);
+
+        dmWebServer::HandlerParams component_stats_params;
+        component_stats_params.m_Handler = HttpComponentStatsRequestCallback;
+        component_stats_params.m_Userdata = regist;
+        dmWebServer::AddHandler(engine_service->m_WebServer, "/component_stats", &component_stats_params);
+
+        dmWebServer::HandlerParams resource_timeline_params;
+        resource_timeline_params.m_Handler = HttpResourceTimelineRequestCallback;
+        resource_timeline_params.m_Userdata = factory;
+        dmWebServer::AddHandler(engine_service->m_WebServer, "/resource_timeline", &resource_timeline_params);
+
+        dmWebServer::HandlerParams capture_params;
+        capture_params.m_Handler = HttpProfileCaptureRequestCallback;
+        capture_params.m_Userdata = 0;
+        dmWebServer::AddHandler(engine_service->m_WebServer, "/profile_capture", &capture_params);
+
         // The entry point to the engine service profiler
         dmWebServer::HandlerParams profile_params;
         profile_params.m_Handler = ProfileHandler;
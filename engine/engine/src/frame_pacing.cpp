@@ -0,0 +1,111 @@
+// Copyright 2020-2024 The Defold Foundation
+// Copyright 2014-2020 King
+// Copyright 2009-2014 Ragnar Svensson, Christian Murray
+// Licensed under the Defold License version 1.0 (the "License"); you may not use
+// this file except in compliance with the License.
+//
+// You may obtain a copy of the License, together with FAQs at
+// https://www.defold.com/license
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "frame_pacing.h"
+
+#include <string.h>
+
+#include <dlib/log.h>
+
+namespace dmEngine
+{
+    static const uint32_t FRAME_PACER_MAX_DIVISOR   = 4;    // E.g. 60 Hz can go down to 15 Hz
+    static const uint32_t FRAME_PACER_MISS_LIMIT    = 20;   // A missed frame adds 2, a frame on time removes 1
+    static const uint32_t FRAME_PACER_FAST_FRAMES   = 120;  // Frames that would fit the higher rate, before it's used
+
+    void InitFramePacer(FramePacer* pacer, uint32_t frequency, bool adaptive)
+    {
+        memset(pacer, 0, sizeof(*pacer));
+        pacer->m_BasePeriod = frequency > 0 ? 1000000 / frequency : 0;
+        pacer->m_Divisor = 1;
+        pacer->m_MaxDivisor = adaptive ? FRAME_PACER_MAX_DIVISOR : 1;
+        pacer->m_Adaptive = adaptive;
+    }
+
+    static void SetDivisor(FramePacer* pacer, uint32_t divisor)
+    {
+        dmLogInfo("Frame rate changed to %u Hz", 1000000 / (pacer->m_BasePeriod * divisor));
+        pacer->m_Divisor = divisor;
+        pacer->m_MissCount = 0;
+        pacer->m_FastCount = 0;
+    }
+
+    uint32_t UpdateFramePacer(FramePacer* pacer, uint64_t frame_start, uint64_t time)
+    {
+        if (pacer->m_BasePeriod == 0)
+        {
+            return 0;
+        }
+
+        uint32_t period = pacer->m_BasePeriod * pacer->m_Divisor;
+
+        // The first frame, or after a long stall (e.g. the app was in the background)
+        if (pacer->m_Deadline == 0 || pacer->m_Deadline + period < frame_start)
+        {
+            pacer->m_Deadline = frame_start + period;
+        }
+
+        uint32_t wait = 0;
+        bool missed = time > pacer->m_Deadline;
+        if (!missed)
+        {
+            wait = (uint32_t)(pacer->m_Deadline - time);
+            pacer->m_Deadline += period;
+        }
+        else
+        {
+            // Present it right away, and keep the next frames a full period apart
+            pacer->m_Deadline = time + period;
+        }
+
+        if (!pacer->m_Adaptive)
+        {
+            return wait;
+        }
+
+        if (missed)
+        {
+            pacer->m_MissCount += 2;
+        }
+        else if (pacer->m_MissCount > 0)
+        {
+            pacer->m_MissCount--;
+        }
+
+        uint32_t work = (uint32_t)(time - frame_start);
+        if (pacer->m_Divisor > 1 && work < (pacer->m_BasePeriod * (pacer->m_Divisor - 1) * 3) / 4)
+        {
+            pacer->m_FastCount++;
+        }
+        else
+        {
+            pacer->m_FastCount = 0;
+        }
+
+        if (pacer->m_MissCount >= FRAME_PACER_MISS_LIMIT && pacer->m_Divisor < pacer->m_MaxDivisor)
+        {
+            SetDivisor(pacer, pacer->m_Divisor + 1);
+        }
+        else if (pacer->m_FastCount >= FRAME_PACER_FAST_FRAMES)
+        {
+            SetDivisor(pacer, pacer->m_Divisor - 1);
+        }
+        return wait;
+    }
+
+    uint32_t GetFramePacerDivisor(const FramePacer* pacer)
+    {
+        return pacer->m_Divisor;
+    }
+}
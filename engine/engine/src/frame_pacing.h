@@ -0,0 +1,46 @@
+// Copyright 2020-2024 The Defold Foundation
+// Copyright 2014-2020 King
+// Copyright 2009-2014 Ragnar Svensson, Christian Murray
+// Licensed under the Defold License version 1.0 (the "License"); you may not use
+// this file except in compliance with the License.
+//
+// You may obtain a copy of the License, together with FAQs at
+// https://www.defold.com/license
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#ifndef DM_ENGINE_FRAME_PACING_H
+#define DM_ENGINE_FRAME_PACING_H
+
+#include <stdint.h>
+
+namespace dmEngine
+{
+    // Presents the frames at a steady rate, using absolute deadlines so that the wait of one frame
+    // doesn't add to the error of the next. When adaptive, the frame rate is lowered to an even
+    // fraction of the target rate (e.g. 60 -> 30 Hz) while the frames keep missing their deadlines
+    // (e.g. when the device is throttled), and raised again once there is room for it.
+    struct FramePacer
+    {
+        uint64_t m_Deadline;        // When the current frame should be presented (microseconds)
+        uint32_t m_BasePeriod;      // The period of the target frame rate (microseconds)
+        uint32_t m_Divisor;         // The frames are presented every m_Divisor base periods
+        uint32_t m_MaxDivisor;
+        uint32_t m_MissCount;       // Frames missing their deadlines, since the last rate change
+        uint32_t m_FastCount;       // Consecutive frames that would fit a higher rate
+        bool     m_Adaptive;
+    };
+
+    void     InitFramePacer(FramePacer* pacer, uint32_t frequency, bool adaptive);
+
+    // Call at the end of the frame, before it's presented. Returns the time to wait (microseconds) before presenting it
+    uint32_t UpdateFramePacer(FramePacer* pacer, uint64_t frame_start, uint64_t time);
+
+    // The number of base periods between two frames (i.e. the swap interval, relative to the target rate)
+    uint32_t GetFramePacerDivisor(const FramePacer* pacer);
+}
+
+#endif // DM_ENGINE_FRAME_PACING_H
@@ -0,0 +1,131 @@
+// Copyright 2020-2024 The Defold Foundation
+// Copyright 2014-2020 King
+// Copyright 2009-2014 Ragnar Svensson, Christian Murray
+// Licensed under the Defold License version 1.0 (the "License"); you may not use
+// this file except in compliance with the License.
+//
+// You may obtain a copy of the License, together with FAQs at
+// https://www.defold.com/license
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "frame_stats.h"
+
+#include <string.h>
+#include <algorithm> // std::sort
+
+#include <dlib/dstrings.h>
+#include <dlib/log.h>
+
+namespace dmEngine
+{
+    static void LogFrameSpike(void* ctx, const FrameSpikeReport* report)
+    {
+        char phases[512];
+        phases[0] = 0;
+        for (uint32_t i = 0; i < MAX_FRAME_PHASE_COUNT; ++i)
+        {
+            char phase[64];
+            dmSnPrintf(phase, sizeof(phase), "%s%s %.2f", i == 0 ? "" : ", ", GetFramePhaseName((FramePhase)i), report->m_PhaseTimes[i] / 1000.0f);
+            dmStrlCat(phases, phase, sizeof(phases));
+        }
+
+        dmLogWarning("Frame %llu took %.2f ms (median %.2f, p95 %.2f, p99 %.2f): %s",
+                        (unsigned long long)report->m_FrameIndex, report->m_FrameTime / 1000.0f,
+                        report->m_Median / 1000.0f, report->m_P95 / 1000.0f, report->m_P99 / 1000.0f, phases);
+    }
+
+    void InitFrameStats(FrameStats* stats, uint32_t spike_threshold, uint32_t report_interval)
+    {
+        memset(stats, 0, sizeof(*stats));
+        stats->m_SpikeThreshold = spike_threshold;
+        stats->m_ReportInterval = report_interval;
+        stats->m_FramesSinceReport = report_interval;
+        stats->m_Callback = LogFrameSpike;
+    }
+
+    void SetFrameSpikeCallback(FrameStats* stats, FrameSpikeCallback callback, void* ctx)
+    {
+        stats->m_Callback = callback ? callback : LogFrameSpike;
+        stats->m_CallbackCtx = callback ? ctx : 0;
+    }
+
+    void FrameStatsBeginFrame(FrameStats* stats, uint64_t time)
+    {
+        memset(stats->m_PhaseTimes, 0, sizeof(stats->m_PhaseTimes));
+        stats->m_FrameStart = time;
+        stats->m_PhaseStart = time;
+    }
+
+    void FrameStatsEndPhase(FrameStats* stats, FramePhase phase, uint64_t time)
+    {
+        stats->m_PhaseTimes[phase] += (uint32_t)(time - stats->m_PhaseStart);
+        stats->m_PhaseStart = time;
+    }
+
+    void FrameStatsEndFrame(FrameStats* stats, uint64_t time)
+    {
+        uint32_t frame_time = (uint32_t)(time - stats->m_FrameStart);
+        uint64_t frame_index = stats->m_FrameIndex++;
+
+        stats->m_History[stats->m_HistoryIndex] = frame_time;
+        stats->m_HistoryIndex = (stats->m_HistoryIndex + 1) % FRAME_STATS_HISTORY_SIZE;
+        if (stats->m_HistoryCount < FRAME_STATS_HISTORY_SIZE)
+            stats->m_HistoryCount++;
+        if (stats->m_FramesSinceReport < stats->m_ReportInterval)
+            stats->m_FramesSinceReport++;
+
+        if (stats->m_SpikeThreshold == 0 || frame_time < stats->m_SpikeThreshold)
+            return;
+
+        // Avoid flooding the log when the game is slow for a longer period, e.g. while loading
+        if (stats->m_FramesSinceReport < stats->m_ReportInterval)
+            return;
+        stats->m_FramesSinceReport = 0;
+
+        FrameSpikeReport report;
+        report.m_FrameIndex = frame_index;
+        report.m_FrameTime = frame_time;
+        memcpy(report.m_PhaseTimes, stats->m_PhaseTimes, sizeof(report.m_PhaseTimes));
+        GetFrameTimePercentiles(stats, &report.m_Median, &report.m_P95, &report.m_P99);
+
+        stats->m_Callback(stats->m_CallbackCtx, &report);
+    }
+
+    void GetFrameTimePercentiles(const FrameStats* stats, uint32_t* median, uint32_t* p95, uint32_t* p99)
+    {
+        uint32_t count = stats->m_HistoryCount;
+        if (count == 0)
+        {
+            *median = *p95 = *p99 = 0;
+            return;
+        }
+
+        uint32_t sorted[FRAME_STATS_HISTORY_SIZE];
+        memcpy(sorted, stats->m_History, count * sizeof(uint32_t));
+        std::sort(sorted, sorted + count);
+
+        *median = sorted[(count - 1) * 50 / 100];
+        *p95 = sorted[(count - 1) * 95 / 100];
+        *p99 = sorted[(count - 1) * 99 / 100];
+    }
+
+    const char* GetFramePhaseName(FramePhase phase)
+    {
+        switch(phase)
+        {
+        case FRAME_PHASE_RESOURCE:  return "Resource";
+        case FRAME_PHASE_INPUT:     return "Input";
+        case FRAME_PHASE_SCRIPT:    return "Script";
+        case FRAME_PHASE_SOUND:     return "Sound";
+        case FRAME_PHASE_UPDATE:    return "Update";
+        case FRAME_PHASE_RENDER:    return "Render";
+        case FRAME_PHASE_GC:        return "GC";
+        case FRAME_PHASE_FLIP:      return "Flip";
+        default:                    return "<unknown>";
+        }
+    }
+}
@@ -0,0 +1,80 @@
+// Copyright 2020-2024 The Defold Foundation
+// Copyright 2014-2020 King
+// Copyright 2009-2014 Ragnar Svensson, Christian Murray
+// Licensed under the Defold License version 1.0 (the "License"); you may not use
+// this file except in compliance with the License.
+//
+// You may obtain a copy of the License, together with FAQs at
+// https://www.defold.com/license
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#ifndef DM_ENGINE_FRAME_STATS_H
+#define DM_ENGINE_FRAME_STATS_H
+
+#include <stdint.h>
+
+namespace dmEngine
+{
+    // The top level parts of a frame, timed in all builds (including release)
+    enum FramePhase
+    {
+        FRAME_PHASE_RESOURCE,
+        FRAME_PHASE_INPUT,
+        FRAME_PHASE_SCRIPT,
+        FRAME_PHASE_SOUND,
+        FRAME_PHASE_UPDATE,     // Game object and component updates (including physics)
+        FRAME_PHASE_RENDER,
+        FRAME_PHASE_GC,
+        FRAME_PHASE_FLIP,       // Including the vsync wait
+        MAX_FRAME_PHASE_COUNT
+    };
+
+    static const uint32_t FRAME_STATS_HISTORY_SIZE = 256;
+
+    struct FrameSpikeReport
+    {
+        uint64_t m_FrameIndex;
+        uint32_t m_FrameTime;                           // Microseconds
+        uint32_t m_PhaseTimes[MAX_FRAME_PHASE_COUNT];   // Microseconds
+        uint32_t m_Median;                              // The frame time percentiles of the recent frames, in microseconds
+        uint32_t m_P95;
+        uint32_t m_P99;
+    };
+
+    typedef void (*FrameSpikeCallback)(void* ctx, const FrameSpikeReport* report);
+
+    struct FrameStats
+    {
+        uint32_t            m_History[FRAME_STATS_HISTORY_SIZE];    // Frame times in microseconds
+        uint32_t            m_PhaseTimes[MAX_FRAME_PHASE_COUNT];
+        uint64_t            m_FrameStart;
+        uint64_t            m_PhaseStart;
+        uint64_t            m_FrameIndex;
+        uint32_t            m_HistoryIndex;
+        uint32_t            m_HistoryCount;
+        uint32_t            m_SpikeThreshold;       // Microseconds, 0 means disabled
+        uint32_t            m_ReportInterval;       // Min number of frames between two reports
+        uint32_t            m_FramesSinceReport;
+        FrameSpikeCallback  m_Callback;
+        void*               m_CallbackCtx;
+    };
+
+    // The default callback logs the report as a warning
+    void        InitFrameStats(FrameStats* stats, uint32_t spike_threshold, uint32_t report_interval);
+    void        SetFrameSpikeCallback(FrameStats* stats, FrameSpikeCallback callback, void* ctx);
+
+    void        FrameStatsBeginFrame(FrameStats* stats, uint64_t time);
+    // Adds the time since the previous phase (or the frame start) to the phase
+    void        FrameStatsEndPhase(FrameStats* stats, FramePhase phase, uint64_t time);
+    // Calls the spike callback if the frame took longer than the threshold
+    void        FrameStatsEndFrame(FrameStats* stats, uint64_t time);
+
+    void        GetFrameTimePercentiles(const FrameStats* stats, uint32_t* median, uint32_t* p95, uint32_t* p99);
+    const char* GetFramePhaseName(FramePhase phase);
+}
+
+#endif // DM_ENGINE_FRAME_STATS_H
@@ -0,0 +1,144 @@
+// Copyright 2020-2024 The Defold Foundation
+// Copyright 2014-2020 King
+// Copyright 2009-2014 Ragnar Svensson, Christian Murray
+// Licensed under the Defold License version 1.0 (the "License"); you may not use
+// this file except in compliance with the License.
+//
+// You may obtain a copy of the License, together with FAQs at
+// https://www.defold.com/license
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "input_record.h"
+
+#include <string.h>
+
+#include <dlib/log.h>
+#include <dlib/time.h>
+
+namespace dmEngine
+{
+    static const uint32_t INPUT_RECORD_MAGIC   = 0x52494d44; // "DMIR"
+    static const uint32_t INPUT_RECORD_VERSION = 1;
+
+    // The packets are written as is, so a recording can only be replayed by an engine with the same hid layout
+    struct InputRecordHeader
+    {
+        uint32_t m_Magic;
+        uint32_t m_Version;
+        uint32_t m_StateSize;
+    };
+
+    struct InputRecordFrameHeader
+    {
+        InputRecordFrame m_Frame;
+        uint32_t         m_HasState;
+    };
+
+    void InitInputRecord(InputRecord* record)
+    {
+        memset(record, 0, sizeof(*record));
+    }
+
+    bool OpenInputRecord(InputRecord* record, const char* path, InputRecordMode mode)
+    {
+        InitInputRecord(record);
+
+        bool write = mode == INPUT_RECORD_MODE_RECORD;
+        record->m_File = fopen(path, write ? "wb" : "rb");
+        if (!record->m_File)
+        {
+            dmLogError("Failed to open input recording '%s'", path);
+            return false;
+        }
+
+        InputRecordHeader header;
+        if (write)
+        {
+            header.m_Magic     = INPUT_RECORD_MAGIC;
+            header.m_Version   = INPUT_RECORD_VERSION;
+            header.m_StateSize = sizeof(dmHID::InputState);
+            if (fwrite(&header, sizeof(header), 1, record->m_File) != 1)
+            {
+                dmLogError("Failed to write input recording '%s'", path);
+                CloseInputRecord(record);
+                return false;
+            }
+        }
+        else
+        {
+            if (fread(&header, sizeof(header), 1, record->m_File) != 1 ||
+                header.m_Magic != INPUT_RECORD_MAGIC ||
+                header.m_Version != INPUT_RECORD_VERSION ||
+                header.m_StateSize != sizeof(dmHID::InputState))
+            {
+                dmLogError("'%s' is not an input recording made by this engine version", path);
+                CloseInputRecord(record);
+                return false;
+            }
+        }
+
+        record->m_Mode = mode;
+        record->m_StartTime = dmTime::GetTime();
+        return true;
+    }
+
+    void CloseInputRecord(InputRecord* record)
+    {
+        if (record->m_File)
+        {
+            fclose(record->m_File);
+        }
+        record->m_File = 0;
+        record->m_Mode = INPUT_RECORD_MODE_OFF;
+    }
+
+    bool WriteInputRecordFrame(InputRecord* record, const InputRecordFrame* frame, const dmHID::InputState* state)
+    {
+        InputRecordFrameHeader header;
+        memset(&header, 0, sizeof(header));
+        header.m_Frame    = *frame;
+        header.m_HasState = record->m_FrameCount == 0 || memcmp(&record->m_State, state, sizeof(*state)) != 0;
+
+        if (fwrite(&header, sizeof(header), 1, record->m_File) != 1 ||
+            (header.m_HasState && fwrite(state, sizeof(*state), 1, record->m_File) != 1))
+        {
+            return false;
+        }
+
+        if (header.m_HasState)
+        {
+            record->m_State = *state;
+        }
+        record->m_FrameCount++;
+        return true;
+    }
+
+    bool ReadInputRecordFrame(InputRecord* record, InputRecordFrame* frame)
+    {
+        InputRecordFrameHeader header;
+        if (fread(&header, sizeof(header), 1, record->m_File) != 1)
+        {
+            return false;
+        }
+
+        if (header.m_HasState)
+        {
+            if (fread(&record->m_State, sizeof(record->m_State), 1, record->m_File) != 1)
+            {
+                return false;
+            }
+        }
+        else if (record->m_FrameCount == 0)
+        {
+            return false; // The first frame always has a state
+        }
+
+        *frame = header.m_Frame;
+        record->m_FrameCount++;
+        return true;
+    }
+}
@@ -0,0 +1,63 @@
+// Copyright 2020-2024 The Defold Foundation
+// Copyright 2014-2020 King
+// Copyright 2009-2014 Ragnar Svensson, Christian Murray
+// Licensed under the Defold License version 1.0 (the "License"); you may not use
+// this file except in compliance with the License.
+//
+// You may obtain a copy of the License, together with FAQs at
+// https://www.defold.com/license
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#ifndef DM_ENGINE_INPUT_RECORD_H
+#define DM_ENGINE_INPUT_RECORD_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <hid/hid.h>
+
+namespace dmEngine
+{
+    // Records the input, time step and random seeds of each frame to a file,
+    // so that a session can be replayed with identical input and timing.
+    enum InputRecordMode
+    {
+        INPUT_RECORD_MODE_OFF,
+        INPUT_RECORD_MODE_RECORD,
+        INPUT_RECORD_MODE_REPLAY,
+    };
+
+    static const uint32_t INPUT_RECORD_MAX_SEED_COUNT = 3; // One per script context
+
+    struct InputRecordFrame
+    {
+        float    m_Dt;
+        float    m_AccumFrameTime;
+        uint32_t m_RandomSeeds[INPUT_RECORD_MAX_SEED_COUNT];
+    };
+
+    struct InputRecord
+    {
+        FILE*               m_File;
+        InputRecordMode     m_Mode;
+        dmHID::InputState   m_State;        // The input state of the last frame read or written. Only changes are written to the file
+        uint32_t            m_FrameCount;
+        uint64_t            m_StartTime;
+        bool                m_QuitWhenDone; // Quit the engine when the replay has finished
+    };
+
+    void InitInputRecord(InputRecord* record);
+    bool OpenInputRecord(InputRecord* record, const char* path, InputRecordMode mode);
+    void CloseInputRecord(InputRecord* record);
+
+    // Writes the frame, and the input state if it changed since the previous frame
+    bool WriteInputRecordFrame(InputRecord* record, const InputRecordFrame* frame, const dmHID::InputState* state);
+    // Reads the next frame, and its input state into record->m_State. Returns false at the end of the recording, or if the file is broken
+    bool ReadInputRecordFrame(InputRecord* record, InputRecordFrame* frame);
+}
+
+#endif // DM_ENGINE_INPUT_RECORD_H
@@ -22,13 +22,11 @@ namespace PhysicsDebugRender
 {
     void DrawLines(dmVMath::Point3* points, uint32_t point_count, dmVMath::Vector4 color, void* user_data)
     {
-        for (uint32_t i = 0; i < point_count/2; ++i)
-            dmRender::Line3D((dmRender::HRenderContext)user_data, points[2*i], points[2*i+1], color, color);
+        dmRender::Lines3D((dmRender::HRenderContext)user_data, points, point_count, color);
     }
 
     void DrawTriangles(dmVMath::Point3* points, uint32_t point_count, dmVMath::Vector4 color, void* user_data)
     {
-        for (uint32_t i = 0; i < point_count/3; ++i)
-            dmRender::Triangle3d((dmRender::HRenderContext)user_data, &points[3*i], color);
+        dmRender::Triangles3D((dmRender::HRenderContext)user_data, points, point_count, color);
     }
 }
@@ -20,9 +20,13 @@
 #include <dlib/thread.h>
 #include <dlib/dstrings.h>
 #include <dlib/profile.h>
+#include <dlib/sys.h>
 #include "test_engine.h"
 #include "../../../graphics/src/graphics_private.h"
 #include "../engine.h"
+#include "../frame_pacing.h"
+#include "../frame_stats.h"
+#include "../input_record.h"
 
 #define JC_TEST_IMPLEMENTATION
 #include <jc_test/jc_test.h>
@@ -468,6 +472,181 @@ TEST_F(EngineTest, FixedUpdateFrequency3D)
 }
 */
 
+static void FrameSpikeCallback(void* ctx, const dmEngine::FrameSpikeReport* report)
+{
+    memcpy(ctx, report, sizeof(*report));
+}
+
+TEST(FrameStats, Spike)
+{
+    dmEngine::FrameStats stats;
+    dmEngine::InitFrameStats(&stats, 30000, 10);
+
+    dmEngine::FrameSpikeReport report;
+    memset(&report, 0, sizeof(report));
+    dmEngine::SetFrameSpikeCallback(&stats, FrameSpikeCallback, &report);
+
+    uint64_t time = 1000;
+    for (uint32_t i = 0; i < 100; ++i)
+    {
+        // The 50th frame spends an extra 40ms in the update
+        uint64_t update_time = i == 50 ? 50000 : 10000;
+        dmEngine::FrameStatsBeginFrame(&stats, time);
+        dmEngine::FrameStatsEndPhase(&stats, dmEngine::FRAME_PHASE_SCRIPT, time + 1000);
+        dmEngine::FrameStatsEndPhase(&stats, dmEngine::FRAME_PHASE_UPDATE, time + 1000 + update_time);
+        dmEngine::FrameStatsEndPhase(&stats, dmEngine::FRAME_PHASE_FLIP, time + 6000 + update_time);
+        dmEngine::FrameStatsEndFrame(&stats, time + 6000 + update_time);
+        time += 6000 + update_time;
+    }
+
+    ASSERT_EQ(50u, report.m_FrameIndex);
+    ASSERT_EQ(56000u, report.m_FrameTime);
+    ASSERT_EQ(1000u, report.m_PhaseTimes[dmEngine::FRAME_PHASE_SCRIPT]);
+    ASSERT_EQ(50000u, report.m_PhaseTimes[dmEngine::FRAME_PHASE_UPDATE]);
+    ASSERT_EQ(5000u, report.m_PhaseTimes[dmEngine::FRAME_PHASE_FLIP]);
+    ASSERT_EQ(0u, report.m_PhaseTimes[dmEngine::FRAME_PHASE_RENDER]);
+    ASSERT_EQ(16000u, report.m_Median);
+
+    uint32_t median, p95, p99;
+    dmEngine::GetFrameTimePercentiles(&stats, &median, &p95, &p99);
+    ASSERT_EQ(16000u, median);
+    ASSERT_EQ(16000u, p95);
+    ASSERT_EQ(16000u, p99);
+}
+
+static void CountFrameSpikeCallback(void* ctx, const dmEngine::FrameSpikeReport* report)
+{
+    (*(uint32_t*)ctx)++;
+}
+
+TEST(FrameStats, ReportInterval)
+{
+    dmEngine::FrameStats stats;
+    dmEngine::InitFrameStats(&stats, 30000, 10);
+
+    uint32_t count = 0;
+    dmEngine::SetFrameSpikeCallback(&stats, CountFrameSpikeCallback, &count);
+
+    // All frames are slow, but only every 10th frame is reported
+    uint64_t time = 0;
+    for (uint32_t i = 0; i < 25; ++i)
+    {
+        dmEngine::FrameStatsBeginFrame(&stats, time);
+        dmEngine::FrameStatsEndFrame(&stats, time + 40000);
+        time += 40000;
+    }
+    ASSERT_EQ(3u, count);
+}
+
+// Runs a frame of 'work' microseconds, and waits as long as the pacer says
+static uint32_t RunPacedFrame(dmEngine::FramePacer* pacer, uint64_t* time, uint32_t work)
+{
+    uint64_t frame_start = *time;
+    uint32_t wait = dmEngine::UpdateFramePacer(pacer, frame_start, frame_start + work);
+    *time = frame_start + work + wait;
+    return wait;
+}
+
+TEST(FramePacing, Steady)
+{
+    dmEngine::FramePacer pacer;
+    dmEngine::InitFramePacer(&pacer, 100, false);
+
+    uint64_t time = 1000;
+    for (uint32_t i = 0; i < 10; ++i)
+    {
+        ASSERT_EQ(6000u, RunPacedFrame(&pacer, &time, 4000));
+    }
+    ASSERT_EQ(101000u, time);
+
+    // A late frame is presented right away, and the next one a full period later
+    ASSERT_EQ(0u, RunPacedFrame(&pacer, &time, 15000));
+    ASSERT_EQ(6000u, RunPacedFrame(&pacer, &time, 4000));
+
+    // Without adaptive pacing, the rate never changes
+    for (uint32_t i = 0; i < 100; ++i)
+    {
+        RunPacedFrame(&pacer, &time, 15000);
+    }
+    ASSERT_EQ(1u, dmEngine::GetFramePacerDivisor(&pacer));
+
+    // No update frequency, no pacing
+    dmEngine::InitFramePacer(&pacer, 0, true);
+    ASSERT_EQ(0u, RunPacedFrame(&pacer, &time, 1000));
+}
+
+TEST(FramePacing, Adaptive)
+{
+    dmEngine::FramePacer pacer;
+    dmEngine::InitFramePacer(&pacer, 100, true);
+
+    // The frames keep missing the 100 Hz deadlines, so it goes down to 50 Hz
+    uint64_t time = 1000;
+    for (uint32_t i = 0; i < 9; ++i)
+    {
+        ASSERT_EQ(0u, RunPacedFrame(&pacer, &time, 15000));
+    }
+    ASSERT_EQ(1u, dmEngine::GetFramePacerDivisor(&pacer));
+    RunPacedFrame(&pacer, &time, 15000);
+    ASSERT_EQ(2u, dmEngine::GetFramePacerDivisor(&pacer));
+
+    // Which they make
+    RunPacedFrame(&pacer, &time, 15000);
+    for (uint32_t i = 0; i < 50; ++i)
+    {
+        ASSERT_EQ(5000u, RunPacedFrame(&pacer, &time, 15000));
+    }
+    ASSERT_EQ(2u, dmEngine::GetFramePacerDivisor(&pacer));
+
+    // Once the frames would fit the higher rate for a while, it's used again
+    for (uint32_t i = 0; i < 119; ++i)
+    {
+        RunPacedFrame(&pacer, &time, 2000);
+    }
+    ASSERT_EQ(2u, dmEngine::GetFramePacerDivisor(&pacer));
+    RunPacedFrame(&pacer, &time, 2000);
+    ASSERT_EQ(1u, dmEngine::GetFramePacerDivisor(&pacer));
+}
+
+TEST(InputRecord, WriteRead)
+{
+    char path[512];
+    dmTestUtil::MakeHostPath(path, sizeof(path), "src/test/build/input_record.bin");
+
+    dmEngine::InputRecord record;
+    ASSERT_TRUE(dmEngine::OpenInputRecord(&record, path, dmEngine::INPUT_RECORD_MODE_RECORD));
+
+    dmHID::InputState state;
+    memset(&state, 0, sizeof(state));
+    for (uint32_t i = 0; i < 10; ++i)
+    {
+        dmEngine::InputRecordFrame frame;
+        memset(&frame, 0, sizeof(frame));
+        frame.m_Dt = 1.0f / (60 + i);
+        frame.m_RandomSeeds[0] = i * 17;
+        // The mouse moves every other frame
+        state.m_Mouse.m_PositionX = i / 2;
+        ASSERT_TRUE(dmEngine::WriteInputRecordFrame(&record, &frame, &state));
+    }
+    dmEngine::CloseInputRecord(&record);
+
+    ASSERT_TRUE(dmEngine::OpenInputRecord(&record, path, dmEngine::INPUT_RECORD_MODE_REPLAY));
+    for (uint32_t i = 0; i < 10; ++i)
+    {
+        dmEngine::InputRecordFrame frame;
+        ASSERT_TRUE(dmEngine::ReadInputRecordFrame(&record, &frame));
+        ASSERT_EQ(1.0f / (60 + i), frame.m_Dt);
+        ASSERT_EQ(i * 17, frame.m_RandomSeeds[0]);
+        ASSERT_EQ((int32_t)(i / 2), record.m_State.m_Mouse.m_PositionX);
+    }
+    dmEngine::InputRecordFrame frame;
+    ASSERT_FALSE(dmEngine::ReadInputRecordFrame(&record, &frame));
+    ASSERT_EQ(10u, record.m_FrameCount);
+    dmEngine::CloseInputRecord(&record);
+
+    dmSys::Unlink(path);
+}
+
 int main(int argc, char **argv)
 {
     dmExportedSymbols();
@@ -393,6 +393,33 @@ namespace dmGameObject
      */
     typedef UpdateResult (*ComponentOnMessage)(const ComponentOnMessageParams& params);
 
+    /*#
+     * Parameters to ComponentsOnMessageBatch callback.
+     * @struct
+     * @name ComponentsOnMessageBatchParams
+     * @member m_World [type: void*] World
+     * @member m_Context [type: void*] User context
+     * @member m_Messages [type: const dmGameObject::ComponentOnMessageParams*] The messages, in the order they were posted
+     * @member m_Count [type: uint32_t] Number of messages
+     */
+    struct ComponentsOnMessageBatchParams
+    {
+        void* m_World;
+        void* m_Context;
+        const ComponentOnMessageParams* m_Messages;
+        uint32_t m_Count;
+    };
+
+    /*#
+     * Component batched on-message function. Called with consecutive messages sent to components of this type.
+     * Messages broadcast to all components of a game object are still passed to the ComponentOnMessage function.
+     * @typedef
+     * @name ComponentsOnMessageBatch
+     * @param params [type: const dmGameObject::ComponentsOnMessageBatchParams&] Update parameters
+     * @return result [type: UpdateResult] UPDATE_RESULT_OK on success
+     */
+    typedef UpdateResult (*ComponentsOnMessageBatch)(const ComponentsOnMessageBatchParams& params);
+
     /*#
      * Parameters to ComponentOnInput callback.
      * @struct
@@ -656,6 +683,15 @@ namespace dmGameObject
      */
     void ComponentTypeSetOnMessageFn(HComponentType type, ComponentOnMessage fn);
 
+    /*# set the component batched on-message callback
+     * Set the component batched on-message callback. If set, it's used instead of the on-message callback
+     * for the messages sent to a component of this type.
+     * @name ComponentTypeSetOnMessageBatchFn
+     * @param type [type: HComponentType] the type
+     * @param fn [type: ComponentsOnMessageBatch] callback
+     */
+    void ComponentTypeSetOnMessageBatchFn(HComponentType type, ComponentsOnMessageBatch fn);
+
     /*# set the component on-input callback
      * Set the component on-input callback. Called once per frame, before the Update function.
      * @name ComponentTypeSetOnInputFn
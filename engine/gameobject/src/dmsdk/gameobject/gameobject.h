@@ -115,6 +115,7 @@ namespace dmGameObject
     typedef void* HComponentWorld;
 
     typedef void* HCollectionDesc;
+    typedef struct CollectionSpawnTemplate* HCollectionSpawnTemplate;
 
     /*#
      * Gameobject prototype handle
@@ -458,6 +459,8 @@ namespace dmGameObject
         uint32_t m_GamepadIndex;
         uint32_t m_UserID;
         dmHID::GamepadPacket m_GamepadPacket;
+        /// When the input was sampled (microseconds, same clock as dmTime::GetTime()), or 0 if unknown
+        uint64_t m_Time;
 
         uint8_t  m_IsGamepad : 1;
         uint8_t  m_GamepadUnknown : 1;
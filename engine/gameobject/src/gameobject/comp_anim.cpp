@@ -15,6 +15,8 @@
 
 #include "comp_anim.h"
 
+#include <string.h>
+
 #include <dlib/index_pool.h>
 #include <dlib/profile.h>
 
@@ -74,9 +76,22 @@ namespace dmGameObject
         dmIndexPool<uint16_t>               m_AnimMapIndexPool;
         dmHashTable<uintptr_t, uint16_t>    m_InstanceToIndex;
         dmHashTable<uintptr_t, uint16_t>    m_ListenerInstanceToIndex;
+        // Scratch buffers for evaluating the easing curves, per animation
+        dmArray<float>                      m_EasedValues;
+        dmArray<uint8_t>                    m_EvalFlags;
+        // The same, grouped by easing curve type
+        dmArray<uint16_t>                   m_CurveIndices;
+        dmArray<float>                      m_CurveTimes;
+        dmArray<float>                      m_CurveValues;
         uint32_t                            m_InUpdate : 1;
     };
 
+    enum EvalFlag
+    {
+        EVAL_FLAG_EVALUATE  = 1,
+        EVAL_FLAG_COMPLETED = 2,
+    };
+
     CreateResult CompAnimNewWorld(const ComponentNewWorldParams& params)
     {
         if (params.m_World != 0x0)
@@ -159,6 +174,78 @@ namespace dmGameObject
         return CREATE_RESULT_OK;
     }
 
+    template <typename T>
+    static void EnsureSize(dmArray<T>& array, uint32_t size)
+    {
+        if (array.Capacity() < size)
+            array.SetCapacity(size);
+        array.SetSize(size);
+    }
+
+    // Evaluates the easing curves of the animations flagged with EVAL_FLAG_EVALUATE, given their curve times in
+    // m_EasedValues. The animations are grouped by built in curve type, so that each curve is evaluated in a batch.
+    static void EvaluateAnimationCurves(AnimWorld* world, uint32_t size)
+    {
+        DM_PROFILE("EvaluateAnimationCurves");
+
+        const Animation* animations = world->m_Animations.Begin();
+        float* eased_values = world->m_EasedValues.Begin();
+        const uint8_t* eval_flags = world->m_EvalFlags.Begin();
+        uint16_t* curve_indices = world->m_CurveIndices.Begin();
+        float* curve_times = world->m_CurveTimes.Begin();
+        float* curve_values = world->m_CurveValues.Begin();
+
+        uint32_t curve_offsets[dmEasing::TYPE_COUNT];
+        memset(curve_offsets, 0, sizeof(curve_offsets));
+
+        for (uint32_t i = 0; i < size; ++i)
+        {
+            if (!(eval_flags[i] & EVAL_FLAG_EVALUATE))
+                continue;
+            const dmEasing::Curve& easing = animations[i].m_Easing;
+            if (easing.type == dmEasing::TYPE_FLOAT_VECTOR)
+                eased_values[i] = dmEasing::GetValue(easing, eased_values[i]);
+            else
+                curve_offsets[easing.type]++;
+        }
+
+        uint32_t offset = 0;
+        for (uint32_t type = 0; type < dmEasing::TYPE_FLOAT_VECTOR; ++type)
+        {
+            uint32_t count = curve_offsets[type];
+            curve_offsets[type] = offset;
+            offset += count;
+        }
+
+        for (uint32_t i = 0; i < size; ++i)
+        {
+            dmEasing::Type type = animations[i].m_Easing.type;
+            if ((eval_flags[i] & EVAL_FLAG_EVALUATE) && type != dmEasing::TYPE_FLOAT_VECTOR)
+            {
+                uint32_t index = curve_offsets[type]++;
+                curve_indices[index] = (uint16_t) i;
+                curve_times[index] = eased_values[i];
+            }
+        }
+
+        // curve_offsets now holds the end of each curve type range
+        uint32_t start = 0;
+        for (uint32_t type = 0; type < dmEasing::TYPE_FLOAT_VECTOR; ++type)
+        {
+            uint32_t end = curve_offsets[type];
+            if (end > start)
+            {
+                dmEasing::GetValues((dmEasing::Type) type, curve_times + start, curve_values + start, end - start);
+            }
+            start = end;
+        }
+
+        for (uint32_t i = 0; i < start; ++i)
+        {
+            eased_values[curve_indices[i]] = curve_values[i];
+        }
+    }
+
     UpdateResult CompAnimUpdate(const ComponentsUpdateParams& params, ComponentsUpdateResult& update_result)
     {
         DM_PROFILE("Update");
@@ -173,7 +260,8 @@ namespace dmGameObject
          * have an incorrect value when read by the newly started animation to
          * retrieve the from-value.
          *
-         * The second pass advances and evaluates the animations.
+         * The second pass advances the animations and evaluates their easing curves, in batches
+         * per curve type, and then writes the values.
          *
          * The third pass prunes stopped animations and call callbacks.
          *
@@ -235,10 +323,19 @@ namespace dmGameObject
                 }
             }
         }
+        EnsureSize(world->m_EasedValues, size);
+        EnsureSize(world->m_EvalFlags, size);
+        EnsureSize(world->m_CurveIndices, size);
+        EnsureSize(world->m_CurveTimes, size);
+        EnsureSize(world->m_CurveValues, size);
+        float* eased_values = world->m_EasedValues.Begin();
+        uint8_t* eval_flags = world->m_EvalFlags.Begin();
+
         i = 0;
         for (i = 0; i < size; ++i)
         {
             Animation& anim = world->m_Animations[i];
+            eval_flags[i] = 0;
             // Ignore canceled or delayed animations
             if (!anim.m_Playing)
                 continue;
@@ -294,7 +391,7 @@ namespace dmGameObject
                 break;
             }
 
-            // Evaluate animation
+            // Store the curve time
             if (!anim.m_Composite)
             {
                 float t = 1.0f;
@@ -308,8 +405,27 @@ namespace dmGameObject
                         t = 2.0f - t;
                     }
                 }
-                t = dmEasing::GetValue(anim.m_Easing, t);
-                float v = anim.m_From + (anim.m_To - anim.m_From) * t;
+                eased_values[i] = t;
+                eval_flags[i] |= EVAL_FLAG_EVALUATE;
+            }
+            if (completed)
+            {
+                eval_flags[i] |= EVAL_FLAG_COMPLETED;
+            }
+        }
+
+        EvaluateAnimationCurves(world, size);
+
+        for (i = 0; i < size; ++i)
+        {
+            uint8_t flags = eval_flags[i];
+            if (flags == 0)
+                continue;
+
+            Animation& anim = world->m_Animations[i];
+            if (flags & EVAL_FLAG_EVALUATE)
+            {
+                float v = anim.m_From + (anim.m_To - anim.m_From) * eased_values[i];
                 if (anim.m_Value != 0x0)
                 {
                     *anim.m_Value = v;
@@ -321,7 +437,7 @@ namespace dmGameObject
                     SetProperty(anim.m_Instance, anim.m_ComponentId, anim.m_PropertyId, property_opt, PropertyVar(v));
                 }
             }
-            if (completed)
+            if (flags & EVAL_FLAG_COMPLETED)
             {
                 StopAnimation(&anim, true);
             }
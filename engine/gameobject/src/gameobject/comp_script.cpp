@@ -13,9 +13,13 @@
 // specific language governing permissions and limitations under the License.
 
 
+#include <algorithm>
+
 #include "comp_script.h"
 
+#include <dlib/align.h>
 #include <dlib/dstrings.h>
+#include <dlib/memory.h>
 #include <dlib/profile.h>
 
 #include <script/script.h>
@@ -164,6 +168,18 @@ namespace dmGameObject
                 break;
             }
         }
+        if (script_instance->m_Update)
+        {
+            for (uint32_t i = 0; i < script_world->m_UpdateInstances.Size(); ++i)
+            {
+                if (script_instance == script_world->m_UpdateInstances[i])
+                {
+                    script_world->m_UpdateInstances.EraseSwap(i);
+                    script_world->m_UpdateInstancesDirty = 1;
+                    break;
+                }
+            }
+        }
         DeleteScriptInstance(script_instance);
         return CREATE_RESULT_OK;
     }
@@ -215,33 +231,90 @@ namespace dmGameObject
         if (script_instance->m_Initialized)
         {
             HScript script = script_instance->m_Script;
-            script_instance->m_Update = script->m_FunctionReferences[SCRIPT_FUNCTION_UPDATE] != LUA_NOREF || script->m_FunctionReferences[SCRIPT_FUNCTION_FIXED_UPDATE] != LUA_NOREF;
+            bool update = script->m_FunctionReferences[SCRIPT_FUNCTION_UPDATE] != LUA_NOREF || script->m_FunctionReferences[SCRIPT_FUNCTION_FIXED_UPDATE] != LUA_NOREF;
+            if (update && !script_instance->m_Update)
+            {
+                CompScriptWorld* script_world = (CompScriptWorld*)params.m_World;
+                script_world->m_UpdateInstances.Push(script_instance);
+                script_world->m_UpdateInstancesDirty = 1;
+                script_instance->m_Update = 1;
+            }
             return CREATE_RESULT_OK;
         }
         return CREATE_RESULT_UNKNOWN_ERROR;
     }
 
 
+    static bool ScriptInstanceScriptPred(const ScriptInstance* a, const ScriptInstance* b)
+    {
+        return a->m_Script < b->m_Script;
+    }
+
     static UpdateResult CompScriptUpdateInternal(const ComponentsUpdateParams& params, ScriptFunction function, ComponentsUpdateResult& update_result)
     {
         lua_State* L = GetLuaState(params.m_Context);
         int top = lua_gettop(L);
         (void)top;
         UpdateResult result = UPDATE_RESULT_OK;
-        RunScriptParams run_params;
-        run_params.m_UpdateContext = params.m_UpdateContext;
         CompScriptWorld* script_world = (CompScriptWorld*)params.m_World;
-        uint32_t size = script_world->m_Instances.Size();
-        for (uint32_t i = 0; i < size; ++i)
+        dmArray<ScriptInstance*>& instances = script_world->m_UpdateInstances;
+        if (script_world->m_UpdateInstancesDirty)
+        {
+            // Keeps the order of the instances of each script
+            std::stable_sort(instances.Begin(), instances.End(), ScriptInstanceScriptPred);
+            script_world->m_UpdateInstancesDirty = 0;
+        }
+
+        // The function and error handler are pushed once for all the instances of a script.
+        // Instances created during the update are appended after the end, and updated next frame
+        const float dt = params.m_UpdateContext->m_DT;
+        uint32_t size = instances.Size();
+        uint32_t i = 0;
+        while (i < size)
         {
-            HScriptInstance script_instance = script_world->m_Instances[i];
-            if (script_instance->m_Update) {
-                ScriptResult ret = RunScript(L, script_instance->m_Script, function, script_instance, run_params);
-                if (ret == SCRIPT_RESULT_FAILED)
+            HScript script = instances[i]->m_Script;
+            uint32_t end = i + 1;
+            while (end < size && instances[end]->m_Script == script)
+            {
+                ++end;
+            }
+
+            int function_ref = script->m_FunctionReferences[function];
+            if (function_ref == LUA_NOREF)
+            {
+                i = end;
+                continue;
+            }
+
+            DM_PROFILE("RunScript");
+            char buffer[128];
+            const char* profiler_string = dmScript::GetProfilerString(L, 0, script->m_LuaModule->m_Source.m_Filename, SCRIPT_FUNCTION_NAMES[function], 0, buffer, sizeof(buffer));
+            DM_PROFILE_DYN(profiler_string, 0);
+
+            dmScript::PushErrorHandler(L);
+            int err_index = lua_gettop(L);
+            lua_rawgeti(L, LUA_REGISTRYINDEX, function_ref);
+            int function_index = lua_gettop(L);
+
+            for (; i < end; ++i)
+            {
+                HScriptInstance script_instance = instances[i];
+                lua_rawgeti(L, LUA_REGISTRYINDEX, script_instance->m_InstanceReference);
+                lua_pushvalue(L, -1);
+                dmScript::SetInstance(L);
+
+                lua_pushvalue(L, function_index);
+                lua_insert(L, -2);
+                lua_pushnumber(L, dt);
+                if (dmScript::PCallWithErrorHandler(L, 2, 0, err_index) != 0)
                 {
                     result = UPDATE_RESULT_UNKNOWN_ERROR;
                 }
             }
+
+            lua_pop(L, 2);
+            lua_pushnil(L);
+            dmScript::SetInstance(L);
         }
 
         // TODO: Find out if the scripts actually sent any transform events
@@ -381,7 +454,10 @@ namespace dmGameObject
         bool deref_function_ref = true;
 
         dmMessage::Message* message = 0;
-        void*               payload_message = 0;
+        bool                payload_decoded = false;
+        void*               message_memory = 0;
+        // Most payloads are small enough to be decoded on the stack, right after the message header
+        DM_ALIGNED(16) uint8_t stack_message[sizeof(dmMessage::Message) + 1024];
 
         if (params.m_Message->m_Descriptor != 0)
         {
@@ -399,15 +475,25 @@ namespace dmGameObject
 
                 const uint8_t* packed_payload = ((uint8_t*)params.m_Message->m_Data) + sizeof(dmGameObjectDDF::ScriptMessage);
 
-                dmDDF::Result ddf_result = dmDDF::LoadMessage(packed_payload, script_message->m_PayloadSize, descriptor, &payload_message, 0, &payload_message_size);
+                // The bytes fields point into the packed payload, which outlives the decoded message
+                message = (dmMessage::Message*) stack_message;
+                dmDDF::Result ddf_result = dmDDF::LoadMessageToBuffer(packed_payload, script_message->m_PayloadSize, descriptor, &message->m_Data[0],
+                                                                      sizeof(stack_message) - sizeof(dmMessage::Message), dmDDF::OPTION_IN_PLACE_BYTES, &payload_message_size);
+                if (ddf_result == dmDDF::RESULT_BUFFER_TOO_SMALL)
+                {
+                    dmMemory::AlignedMalloc(&message_memory, 16, sizeof(dmMessage::Message) + payload_message_size);
+                    message = (dmMessage::Message*) message_memory;
+                    ddf_result = dmDDF::LoadMessageToBuffer(packed_payload, script_message->m_PayloadSize, descriptor, &message->m_Data[0],
+                                                            payload_message_size, dmDDF::OPTION_IN_PLACE_BYTES, &payload_message_size);
+                }
                 if (ddf_result != dmDDF::RESULT_OK)
                 {
                     dmLogWarning("Failed to load message for type '%s'", descriptor->m_Name);
+                    if (message_memory)
+                        dmMemory::AlignedFree(message_memory);
                     return UPDATE_RESULT_OK;
                 }
-
-                uint32_t new_message_size = sizeof(dmMessage::Message) + payload_message_size;
-                message = (dmMessage::Message*)malloc(new_message_size);
+                payload_decoded = true;
 
                 message->m_Sender       = params.m_Message->m_Sender;
                 message->m_Receiver     = params.m_Message->m_Receiver;
@@ -417,8 +503,7 @@ namespace dmGameObject
                 message->m_UserData1    = 0; // should we copy the current m_UserData1?
                 message->m_UserData2    = 0; // deprecated (the Lua function reference)
                 message->m_Next         = 0;
-
-                memcpy(&message->m_Data[0], payload_message, payload_message_size);
+                message->m_DestroyCallback = 0;
 
                 if (script_message->m_Function)
                 {
@@ -441,7 +526,7 @@ namespace dmGameObject
         }
 
         // Is it using the old code path?
-        if (!payload_message)
+        if (!payload_decoded)
         {
             message = params.m_Message;
 
@@ -461,10 +546,9 @@ namespace dmGameObject
             result = HandleMessage(params.m_Context, script_instance, message, function_ref, is_callback, deref_function_ref);
         }
 
-        if (payload_message)
+        if (message_memory)
         {
-            dmDDF::FreeMessage(payload_message);
-            free((void*)message);
+            dmMemory::AlignedFree(message_memory);
         }
 
         return result;
@@ -478,7 +562,7 @@ namespace dmGameObject
         ScriptInstance* script_instance = (ScriptInstance*)*params.m_UserData;
 
         int function_ref = script_instance->m_Script->m_FunctionReferences[SCRIPT_FUNCTION_ONINPUT];
-        if (function_ref != LUA_NOREF)
+        if (function_ref != LUA_NOREF && ScriptInstanceWantsInput(script_instance, params.m_InputAction->m_ActionId))
         {
             lua_State* L = GetLuaState(params.m_Context);
             int top = lua_gettop(L);
@@ -564,6 +648,13 @@ namespace dmGameObject
                 lua_settable(L, -3);
             }
 
+            if (params.m_InputAction->m_Time != 0)
+            {
+                lua_pushliteral(L, "time");
+                lua_pushnumber(L, params.m_InputAction->m_Time / 1000000.0);
+                lua_settable(L, action_table);
+            }
+
             if (params.m_InputAction->m_ActionId != 0)
             {
                 lua_pushliteral(L, "value");
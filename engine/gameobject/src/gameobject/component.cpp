@@ -116,6 +116,7 @@ void ComponentTypeSetUpdateFn(HComponentType type, ComponentsUpdate fn)
 void ComponentTypeSetFixedUpdateFn(HComponentType type, ComponentsFixedUpdate fn)           { type->m_FixedUpdateFunction = fn; }
 void ComponentTypeSetPostUpdateFn(HComponentType type, ComponentsPostUpdate fn)             { type->m_PostUpdateFunction = fn; }
 void ComponentTypeSetOnMessageFn(HComponentType type, ComponentOnMessage fn)                { type->m_OnMessageFunction = fn; }
+void ComponentTypeSetOnMessageBatchFn(HComponentType type, ComponentsOnMessageBatch fn)     { type->m_OnMessageBatchFunction = fn; }
 void ComponentTypeSetOnInputFn(HComponentType type, ComponentOnInput fn)                    { type->m_OnInputFunction = fn; }
 void ComponentTypeSetOnReloadFn(HComponentType type, ComponentOnReload fn)                  { type->m_OnReloadFunction = fn; }
 void ComponentTypeSetSetPropertiesFn(HComponentType type, ComponentSetProperties fn)        { type->m_SetPropertiesFunction = fn; }
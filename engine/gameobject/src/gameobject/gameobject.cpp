@@ -26,6 +26,7 @@
 #include <dlib/math.h>
 #include <dlib/vmath.h>
 #include <dlib/mutex.h>
+#include <dlib/time.h>
 #include <ddf/ddf.h>
 #include "gameobject.h"
 #include "gameobject_script.h"
@@ -46,6 +47,10 @@ DM_PROPERTY_GROUP(rmtp_GameObject, "Gameobjects");
 
 DM_PROPERTY_U32(rmtp_GOInstances, 0, FrameReset, "# alive go instances / frame", &rmtp_GameObject);
 DM_PROPERTY_U32(rmtp_GODeleted, 0, FrameReset, "# deleted instances / frame", &rmtp_GameObject);
+DM_PROPERTY_U32(rmtp_GOUpdateTime, 0, FrameReset, "Time (us) in component update functions / frame", &rmtp_GameObject);
+DM_PROPERTY_U32(rmtp_GOFixedUpdateTime, 0, FrameReset, "Time (us) in component fixed update functions / frame", &rmtp_GameObject);
+DM_PROPERTY_U32(rmtp_GOPostUpdateTime, 0, FrameReset, "Time (us) in component post update functions / frame", &rmtp_GameObject);
+DM_PROPERTY_U32(rmtp_GORenderTime, 0, FrameReset, "Time (us) in component render functions / frame", &rmtp_GameObject);
 
 namespace dmGameObject
 {
@@ -184,6 +189,8 @@ namespace dmGameObject
         m_DefaultCollectionCapacity = DEFAULT_MAX_COLLECTION_CAPACITY;
         m_DefaultInputStackCapacity = DEFAULT_MAX_INPUT_STACK_CAPACITY;
         m_Mutex = dmMutex::New();
+        m_JobThread = 0;
+        m_CollectionCreateDeadline = 0;
     }
 
     Register::~Register()
@@ -216,8 +223,16 @@ namespace dmGameObject
         m_InstanceIndices.SetCapacity(max_instances);
         m_WorldTransforms.SetCapacity(max_instances);
         m_WorldTransforms.SetSize(max_instances);
+        m_PrevTransforms.SetCapacity(max_instances);
+        m_PrevTransforms.SetSize(max_instances);
+        m_TransformFlags.SetCapacity(max_instances);
+        m_TransformFlags.SetSize(max_instances);
+        m_TransformVersions.SetCapacity(max_instances);
+        m_TransformVersions.SetSize(max_instances);
+        m_TransformVersion = 1;
         m_IDToInstance.SetCapacity(dmMath::Max(1U, max_instances/3), max_instances);
         m_InputFocusStack.SetCapacity(max_input_stack_entries);
+        memset(m_InstanceAllocator.m_FreeLists, 0, sizeof(m_InstanceAllocator.m_FreeLists));
         m_NameHash = 0;
         m_ComponentSocket = 0;
         m_FrameSocket = 0;
@@ -234,6 +249,10 @@ namespace dmGameObject
         m_Initialized = 0;
         m_FixedAccumTime = 0.0f;
         m_FirstUpdate = 1;
+        m_PendingCreate = 0;
+        m_DeferTransforms = 0;
+        m_LevelIndicesCleared = 0;
+        m_PendingCreateIndex = 0;
 
         m_InstancesToDeleteHead = INVALID_INSTANCE_INDEX;
         m_InstancesToDeleteTail = INVALID_INSTANCE_INDEX;
@@ -243,7 +262,20 @@ namespace dmGameObject
 
         memset(&m_Instances[0], 0, sizeof(Instance*) * max_instances);
         memset(&m_WorldTransforms[0], 0xcc, sizeof(dmTransform::Transform) * max_instances);
+        memset(&m_TransformFlags[0], TRANSFORM_FLAG_FORCE, sizeof(uint8_t) * max_instances);
+        memset(&m_TransformVersions[0], 0, sizeof(uint32_t) * max_instances);
         memset(&m_LevelIndices[0], 0, sizeof(m_LevelIndices));
+
+        uint32_t component_type_count = regist->m_ComponentTypeCount;
+        m_ComponentTypeCosts.SetCapacity(component_type_count);
+        m_ComponentTypeCosts.SetSize(component_type_count);
+        m_LastComponentTypeCosts.SetCapacity(component_type_count);
+        m_LastComponentTypeCosts.SetSize(component_type_count);
+        if (component_type_count > 0)
+        {
+            memset(m_ComponentTypeCosts.Begin(), 0, sizeof(ComponentTypeCost) * component_type_count);
+            memset(m_LastComponentTypeCosts.Begin(), 0, sizeof(ComponentTypeCost) * component_type_count);
+        }
     }
 
     Result SetCollectionDefaultCapacity(HRegister regist, uint32_t capacity)
@@ -267,6 +299,18 @@ namespace dmGameObject
         regist->m_DefaultInputStackCapacity = capacity;
     }
 
+    void SetJobThread(HRegister regist, dmJobThread::HContext job_thread)
+    {
+        assert(regist != 0x0);
+        regist->m_JobThread = job_thread;
+    }
+
+    void SetCollectionCreateDeadline(HRegister regist, uint64_t deadline)
+    {
+        assert(regist != 0x0);
+        regist->m_CollectionCreateDeadline = deadline;
+    }
+
     static uint32_t GetInputStackDefaultCapacity(HRegister regist)
     {
         assert(regist != 0x0);
@@ -401,6 +445,12 @@ namespace dmGameObject
                 regist->m_ComponentTypes[i].m_DeleteWorldFunction(params);
         }
         dmMutex::Delete(collection->m_Mutex);
+
+        dmArray<void*>& slabs = collection->m_InstanceAllocator.m_Slabs;
+        for (uint32_t i = 0; i < slabs.Size(); ++i)
+        {
+            operator delete (slabs[i]);
+        }
         delete collection;
     }
 
@@ -528,6 +578,7 @@ namespace dmGameObject
                 DoDeleteInstance(collection, instance);
             }
         }
+        CompactLevelIndices(collection);
     }
 
     void DeleteCollection(Collection* collection)
@@ -682,6 +733,12 @@ namespace dmGameObject
     }
 
 
+    // For world transforms written, or pending, outside of UpdateTransforms. They count as changed until the next UpdateTransforms
+    static inline void MarkWorldTransformWritten(Collection* collection, uint16_t index)
+    {
+        collection->m_TransformVersions[index] = collection->m_TransformVersion + 1;
+    }
+
     static void EraseSwapLevelIndex(Collection* collection, HInstance instance)
     {
         /*
@@ -694,9 +751,50 @@ namespace dmGameObject
 
         uint16_t level_index = instance->m_LevelIndex;
         uint16_t swap_in_index = level.EraseSwap(level_index);
-        HInstance swap_in_instance = collection->m_Instances[swap_in_index];
-        assert(swap_in_instance->m_Index == swap_in_index);
-        swap_in_instance->m_LevelIndex = level_index;
+        // The swapped in entry may belong to a deleted instance (see ClearLevelIndex)
+        if (swap_in_index != INVALID_INSTANCE_INDEX)
+        {
+            HInstance swap_in_instance = collection->m_Instances[swap_in_index];
+            assert(swap_in_instance->m_Index == swap_in_index);
+            swap_in_instance->m_LevelIndex = level_index;
+        }
+    }
+
+    /*
+     * Used when deleting instances. The entry of the instance is cleared instead of erased, and the
+     * levels are compacted with CompactLevelIndices() once all instances of the batch have been deleted.
+     */
+    static void ClearLevelIndex(Collection* collection, HInstance instance)
+    {
+        dmArray<uint16_t>& level = collection->m_LevelIndices[instance->m_Depth];
+        assert(instance->m_LevelIndex < level.Size());
+        level[instance->m_LevelIndex] = INVALID_INSTANCE_INDEX;
+        collection->m_LevelIndicesCleared = 1;
+    }
+
+    static void CompactLevelIndices(Collection* collection)
+    {
+        DM_PROFILE("CompactLevelIndices");
+        for (uint32_t level_i = 0; level_i < MAX_HIERARCHICAL_DEPTH; ++level_i)
+        {
+            dmArray<uint16_t>& level = collection->m_LevelIndices[level_i];
+            uint32_t size = level.Size();
+            uint32_t write = 0;
+            for (uint32_t read = 0; read < size; ++read)
+            {
+                uint16_t index = level[read];
+                if (index == INVALID_INSTANCE_INDEX)
+                    continue;
+                if (write != read)
+                {
+                    level[write] = index;
+                    collection->m_Instances[index]->m_LevelIndex = write;
+                }
+                ++write;
+            }
+            level.SetSize(write);
+        }
+        collection->m_LevelIndicesCleared = 0;
     }
 
     /*
@@ -719,6 +817,8 @@ namespace dmGameObject
          * Insert instance in m_LevelIndices at level set in instance->m_Depth
          */
         dmArray<uint16_t>& level = collection->m_LevelIndices[instance->m_Depth];
+        if (level.Full() && collection->m_LevelIndicesCleared)
+            CompactLevelIndices(collection);
         if (level.Full())
             ExpandLevel(level, collection->m_MaxInstances);
         assert(!level.Full());
@@ -727,9 +827,67 @@ namespace dmGameObject
         level.SetSize(level_index + 1);
         level[level_index] = instance->m_Index;
         instance->m_LevelIndex = level_index;
+
+        // New or moved in the hierarchy, the world transform must be recalculated
+        collection->m_TransformFlags[instance->m_Index] = TRANSFORM_FLAG_FORCE;
+        MarkWorldTransformWritten(collection, instance->m_Index);
+    }
+
+    static uint32_t GetInstanceMemorySize(uint32_t component_instance_userdata_count)
+    {
+        uint32_t component_userdata_size = sizeof(((Instance*)0)->m_ComponentInstanceUserData[0]);
+        uint32_t size = sizeof(Instance) + component_instance_userdata_count * component_userdata_size;
+        // Keep the same alignment as operator new for each slot in a slab
+        return (size + 15) & ~15U;
+    }
+
+    static void* AllocInstanceMemory(Collection* collection, uint32_t component_instance_userdata_count)
+    {
+        InstanceAllocator& allocator = collection->m_InstanceAllocator;
+        uint32_t size = GetInstanceMemorySize(component_instance_userdata_count);
+        if (component_instance_userdata_count >= InstanceAllocator::SIZE_CLASS_COUNT)
+        {
+            return ::operator new (size);
+        }
+
+        void** free_list = &allocator.m_FreeLists[component_instance_userdata_count];
+        if (*free_list == 0)
+        {
+            uint8_t* slab = (uint8_t*) ::operator new (size * InstanceAllocator::SLAB_INSTANCE_COUNT);
+            if (allocator.m_Slabs.Full())
+            {
+                allocator.m_Slabs.OffsetCapacity(16);
+            }
+            allocator.m_Slabs.Push(slab);
+
+            // Link the slots in address order
+            for (uint32_t i = InstanceAllocator::SLAB_INSTANCE_COUNT; i > 0; --i)
+            {
+                void* slot = slab + (i - 1) * size;
+                *(void**) slot = *free_list;
+                *free_list = slot;
+            }
+        }
+
+        void* memory = *free_list;
+        *free_list = *(void**) memory;
+        return memory;
     }
 
-    static HInstance AllocInstance(Prototype* proto, const char* prototype_name) {
+    static void FreeInstanceMemory(Collection* collection, void* memory, uint32_t component_instance_userdata_count)
+    {
+        if (component_instance_userdata_count >= InstanceAllocator::SIZE_CLASS_COUNT)
+        {
+            operator delete (memory);
+            return;
+        }
+
+        void** free_list = &collection->m_InstanceAllocator.m_FreeLists[component_instance_userdata_count];
+        *(void**) memory = *free_list;
+        *free_list = memory;
+    }
+
+    static HInstance AllocInstance(Collection* collection, Prototype* proto, const char* prototype_name) {
         // Count number of component userdata fields required
         uint32_t component_instance_userdata_count = 0;
         for (uint32_t i = 0; i < proto->m_ComponentCount; ++i)
@@ -745,15 +903,15 @@ namespace dmGameObject
                 component_instance_userdata_count++;
         }
 
-        uint32_t component_userdata_size = sizeof(((Instance*)0)->m_ComponentInstanceUserData[0]);
         // NOTE: Allocate actual Instance with *all* component instance user-data accounted
-        void* instance_memory = ::operator new (sizeof(Instance) + component_instance_userdata_count * component_userdata_size);
+        void* instance_memory = AllocInstanceMemory(collection, component_instance_userdata_count);
         Instance* instance = new(instance_memory) Instance(proto);
         instance->m_ComponentInstanceUserDataCount = component_instance_userdata_count;
         return instance;
     }
 
-    static void DeallocInstance(HInstance instance) {
+    static void DeallocInstance(Collection* collection, HInstance instance) {
+        uint32_t component_instance_userdata_count = instance->m_ComponentInstanceUserDataCount;
         instance->~Instance();
         void* instance_memory = (void*) instance;
 
@@ -761,7 +919,7 @@ namespace dmGameObject
         // TODO: #ifdef on something...?
         // Clear all memory excluding ComponentInstanceUserData
         memset(instance_memory, 0xcc, sizeof(Instance));
-        operator delete (instance_memory);
+        FreeInstanceMemory(collection, instance_memory, component_instance_userdata_count);
     }
 
     HInstance NewInstance(Collection* collection, Prototype* proto, const char* prototype_name) {
@@ -770,7 +928,7 @@ namespace dmGameObject
             dmLogError("The game object instance could not be created since the buffer is full (%d). Increase the capacity with collection.max_instances", collection->m_InstanceIndices.Capacity());
             return 0;
         }
-        HInstance instance = AllocInstance(proto, prototype_name);
+        HInstance instance = AllocInstance(collection, proto, prototype_name);
         instance->m_Collection = collection;
         instance->m_ScaleAlongZ = collection->m_ScaleAlongZ;
         uint16_t instance_index = collection->m_InstanceIndices.Pop();
@@ -799,7 +957,7 @@ namespace dmGameObject
         }
 
         uint16_t instance_index = instance->m_Index;
-        operator delete ((void*)instance);
+        FreeInstanceMemory(collection, (void*)instance, instance->m_ComponentInstanceUserDataCount);
         collection->m_Instances[instance_index] = 0x0;
         collection->m_InstanceIndices.Push(instance_index);
         assert(collection->m_IDToInstance.Size() <= collection->m_InstanceIndices.Size());
@@ -1178,6 +1336,7 @@ namespace dmGameObject
         SetRotation(instance, rotation);
         SetScale(instance, scale);
         collection->m_WorldTransforms[instance->m_Index] = dmTransform::ToMatrix4(instance->m_Transform);
+        MarkWorldTransformWritten(collection, instance->m_Index);
 
         dmHashInit64(&instance->m_CollectionPathHashState, true);
         dmHashUpdateBuffer64(&instance->m_CollectionPathHashState, ID_SEPARATOR, strlen(ID_SEPARATOR));
@@ -1316,6 +1475,115 @@ namespace dmGameObject
     }
 
 
+    // Update the transform for all parent-less objects
+    static void UpdateSpawnedTransforms(Collection* collection, const dmArray<HInstance>& new_instances, dmTransform::Transform const &transform)
+    {
+        for (uint32_t i=0;i!=new_instances.Size();i++)
+        {
+            if (!GetParent(new_instances[i]))
+            {
+                new_instances[i]->m_Transform = dmTransform::Mul(transform, new_instances[i]->m_Transform);
+            }
+
+            // world transforms need to be up to date in time for the script init calls
+            collection->m_WorldTransforms[new_instances[i]->m_Index] = dmTransform::ToMatrix4(new_instances[i]->m_Transform);
+            MarkWorldTransformWritten(collection, new_instances[i]->m_Index);
+        }
+    }
+
+    // Initializes the created instances of a spawn, or deletes them all if the spawn failed
+    static bool FinishCollectionSpawn(Collection* collection, const dmArray<HInstance>& created, InstanceIdMap *id_mapping, bool success)
+    {
+        if (success)
+        {
+            for (uint32_t i=0;i!=created.Size();i++)
+            {
+                if (!InitInstance(collection, created[i]))
+                {
+                    success = false;
+                    break;
+                }
+            }
+        }
+
+        if (!success)
+        {
+            // Fail cleanup
+            for (uint32_t i=0;i!=created.Size();i++)
+                dmGameObject::Delete(collection, created[i], false);
+            id_mapping->Clear();
+            return false;
+        }
+
+        for (uint32_t i=0;i!=created.Size();i++)
+        {
+            AddToUpdate(collection, created[i]);
+        }
+
+        return true;
+    }
+
+    // Sets the properties of a spawned component, from the collection (ddf_properties) and from the spawn
+    // call (instance_properties). Takes ownership of ddf_properties
+    static bool SetSpawnedComponentProperties(HInstance instance, Prototype::Component& component, uint32_t component_instance_data_index,
+                                              HPropertyContainer ddf_properties, HPropertyContainer* instance_properties,
+                                              const char* instance_id, const char* collection_name)
+    {
+        ComponentType* type = component.m_Type;
+
+        HPropertyContainer lua_properties = 0x0;
+        if (instance_properties != 0x0)
+        {
+            if (strcmp(type->m_Name, "scriptc") == 0)
+            {
+                // TODO: Investigate if it's enough to have one property set, (to save time/memory)
+                // and only register the Free function once (letting the first instance "own" it)
+                lua_properties = PropertyContainerCopy(*instance_properties);
+            }
+        }
+
+        HPropertyContainer properties = 0x0;
+        if (ddf_properties != 0x0 && lua_properties !=0x0)
+        {
+            properties = PropertyContainerMerge(ddf_properties, lua_properties);
+            PropertyContainerDestroy(lua_properties);
+            PropertyContainerDestroy(ddf_properties);
+            if (properties == 0x0)
+            {
+                DM_HASH_REVERSE_MEM(hash_ctx, 256);
+                dmLogError("Could not merge properties parameters for the component '%s' in game object '%s' in collection '%s'", dmHashReverseSafe64Alloc(&hash_ctx, component.m_Id), instance_id, collection_name);
+                return false;
+            }
+        }
+        else
+        {
+            properties = ddf_properties ? ddf_properties : lua_properties;
+        }
+
+        ComponentSetPropertiesParams params;
+        params.m_Instance = instance;
+
+        if (properties != 0x0)
+        {
+            params.m_PropertySet.m_GetPropertyCallback = PropertyContainerGetPropertyCallback;
+            params.m_PropertySet.m_FreeUserDataCallback = PropertyContainerDestroyCallback;
+            params.m_PropertySet.m_UserData = (uintptr_t)properties;
+        }
+
+        uintptr_t* component_instance_data = &instance->m_ComponentInstanceUserData[component_instance_data_index];
+        params.m_UserData = component_instance_data;
+
+        PropertyResult result = type->m_SetPropertiesFunction(params);
+        if (result != PROPERTY_RESULT_OK)
+        {
+            DM_HASH_REVERSE_MEM(hash_ctx, 256);
+            dmLogError("Could not load properties for component '%s' when spawning '%s' in collection '%s'.", dmHashReverseSafe64Alloc(&hash_ctx, component.m_Id), instance_id, collection_name);
+            PropertyContainerDestroy(properties);
+            return false;
+        }
+        return true;
+    }
+
     // Returns if successful or not
     static bool CollectionSpawnFromDescInternal(Collection* collection, dmGameObjectDDF::CollectionDesc* collection_desc, InstancePropertyBuffers *property_buffers, InstanceIdMap *id_mapping, dmTransform::Transform const &transform)
     {
@@ -1450,17 +1718,7 @@ namespace dmGameObject
             return false;
         }
 
-        // Update the transform for all parent-less objects
-        for (uint32_t i=0;i!=new_instances.Size();i++)
-        {
-            if (!GetParent(new_instances[i]))
-            {
-                new_instances[i]->m_Transform = dmTransform::Mul(transform, new_instances[i]->m_Transform);
-            }
-
-            // world transforms need to be up to date in time for the script init calls
-            collection->m_WorldTransforms[new_instances[i]->m_Index] = dmTransform::ToMatrix4(new_instances[i]->m_Transform);
-        }
+        UpdateSpawnedTransforms(collection, new_instances, transform);
 
         // Create components and set properties
         //
@@ -1519,63 +1777,15 @@ namespace dmGameObject
                             }
                         }
 
-                        HPropertyContainer lua_properties = 0x0;
-                        HPropertyContainer* instance_properties = property_buffers->Get(dmHashString64(instance_desc.m_Id));
-                        if (instance_properties != 0x0)
-                        {
-                            if (strcmp(type->m_Name, "scriptc") == 0)
-                            {
-                                // TODO: Investigate if it's enough to have one property set, (to save time/memory)
-                                // and only register the Free function once (letting the first instance "own" it)
-                                lua_properties = PropertyContainerCopy(*instance_properties);
-                            }
-                        }
-
                         if (!success)
                         {
-                            PropertyContainerDestroy(lua_properties);
                             PropertyContainerDestroy(ddf_properties);
                             break;
                         }
 
-                        HPropertyContainer properties = 0x0;
-                        if (ddf_properties != 0x0 && lua_properties !=0x0)
-                        {
-                            properties = PropertyContainerMerge(ddf_properties, lua_properties);
-                            PropertyContainerDestroy(lua_properties);
-                            PropertyContainerDestroy(ddf_properties);
-                            if (properties == 0x0)
-                            {
-                                DM_HASH_REVERSE_MEM(hash_ctx, 256);
-                                dmLogError("Could not merge properties parameters for the component '%s' in game object '%s' in collection '%s'", dmHashReverseSafe64Alloc(&hash_ctx, component.m_Id), instance_desc.m_Id, collection_desc->m_Name);
-                                success = false;
-                                break;
-                            }
-                        }
-                        else
-                        {
-                            properties = ddf_properties ? ddf_properties : lua_properties;
-                        }
-
-                        ComponentSetPropertiesParams params;
-                        params.m_Instance = instance;
-
-                        if (properties != 0x0)
-                        {
-                            params.m_PropertySet.m_GetPropertyCallback = PropertyContainerGetPropertyCallback;
-                            params.m_PropertySet.m_FreeUserDataCallback = PropertyContainerDestroyCallback;
-                            params.m_PropertySet.m_UserData = (uintptr_t)properties;
-                        }
-
-                        uintptr_t* component_instance_data = &instance->m_ComponentInstanceUserData[component_instance_data_index];
-                        params.m_UserData = component_instance_data;
-
-                        PropertyResult result = type->m_SetPropertiesFunction(params);
-                        if (result != PROPERTY_RESULT_OK)
+                        HPropertyContainer* instance_properties = property_buffers->Get(dmHashString64(instance_desc.m_Id));
+                        if (!SetSpawnedComponentProperties(instance, component, component_instance_data_index, ddf_properties, instance_properties, instance_desc.m_Id, collection_desc->m_Name))
                         {
-                            DM_HASH_REVERSE_MEM(hash_ctx, 256);
-                            dmLogError("Could not load properties for component '%s' when spawning '%s' in collection '%s'.", dmHashReverseSafe64Alloc(&hash_ctx, component.m_Id), instance_desc.m_Id, collection_desc->m_Name);
-                            PropertyContainerDestroy(properties);
                             success = false;
                             break;
                         }
@@ -1594,33 +1804,334 @@ namespace dmGameObject
             }
         }
 
+        return FinishCollectionSpawn(collection, created, id_mapping, success);
+    }
+
+    // A collection description flattened for spawning: the ids are hashed, the hierarchy is resolved
+    // to instance indices and the component properties are decoded, once instead of for each spawn.
+    struct CollectionSpawnTemplate
+    {
+        struct InstanceTemplate
+        {
+            dmTransform::Transform  m_Transform;
+            const char*             m_Id;               // Points into the collection description
+            const char*             m_Prototype;
+            dmhash_t                m_IdHash;           // The id without the collection prefix, i.e. the key of the id mapping
+            dmhash_t                m_PrototypeHash;
+            uint32_t                m_IdLength;
+            uint32_t                m_PathLength;       // The length of the id path, including the last separator
+            uint32_t                m_PropertiesStart;  // Range in m_Properties
+            uint32_t                m_PropertiesCount;
+        };
+
+        struct ComponentProperties
+        {
+            dmhash_t            m_ComponentId;
+            HPropertyContainer  m_Properties;
+        };
+
+        // Parent and child instance indices, in the order of the collection description
+        struct Link
+        {
+            uint32_t m_Parent;
+            uint32_t m_Child;
+        };
+
+        dmGameObjectDDF::CollectionDesc*    m_CollectionDesc;
+        dmArray<InstanceTemplate>           m_Instances;
+        dmArray<ComponentProperties>        m_Properties;
+        dmArray<Link>                       m_Links;
+        uint8_t                             m_Valid:1; // If not, the spawn goes through the collection description
+    };
+
+    static bool BuildCollectionSpawnTemplate(CollectionSpawnTemplate* spawn_template)
+    {
+        dmGameObjectDDF::CollectionDesc* collection_desc = spawn_template->m_CollectionDesc;
+        uint32_t instance_count = collection_desc->m_Instances.m_Count;
+
+        dmHashTable64<uint32_t> id_to_index;
+        id_to_index.SetCapacity(dmMath::Max(1U, instance_count / 2), dmMath::Max(1U, instance_count));
+        spawn_template->m_Instances.SetCapacity(instance_count);
+
+        uint32_t property_count = 0;
+        for (uint32_t i = 0; i < instance_count; ++i)
+        {
+            property_count += collection_desc->m_Instances[i].m_ComponentProperties.m_Count;
+        }
+        spawn_template->m_Properties.SetCapacity(property_count);
+
+        for (uint32_t i = 0; i < instance_count; ++i)
+        {
+            const dmGameObjectDDF::InstanceDesc& instance_desc = collection_desc->m_Instances[i];
+            const char* path_end = strrchr(instance_desc.m_Id, *ID_SEPARATOR);
+            if (path_end == 0x0 || instance_desc.m_Prototype == 0x0)
+                return false;
+
+            CollectionSpawnTemplate::InstanceTemplate it;
+            it.m_Id             = instance_desc.m_Id;
+            it.m_IdLength       = strlen(instance_desc.m_Id);
+            it.m_IdHash         = dmHashBuffer64(instance_desc.m_Id, it.m_IdLength);
+            it.m_PathLength     = path_end - instance_desc.m_Id + 1;
+            it.m_Prototype      = instance_desc.m_Prototype;
+            it.m_PrototypeHash  = dmHashString64(instance_desc.m_Prototype);
+
+            // support legacy pipeline which outputs 0 for Scale3 and scale in Scale
+            Vector3 scale = instance_desc.m_Scale3;
+            if (scale.getX() == 0 && scale.getY() == 0 && scale.getZ() == 0)
+                    scale = Vector3(instance_desc.m_Scale, instance_desc.m_Scale, instance_desc.m_Scale);
+            it.m_Transform = dmTransform::Transform(Vector3(instance_desc.m_Position), instance_desc.m_Rotation, scale);
+
+            it.m_PropertiesStart = spawn_template->m_Properties.Size();
+            it.m_PropertiesCount = instance_desc.m_ComponentProperties.m_Count;
+            for (uint32_t prop_i = 0; prop_i < it.m_PropertiesCount; ++prop_i)
+            {
+                const dmGameObjectDDF::ComponentPropertyDesc& comp_prop = instance_desc.m_ComponentProperties[prop_i];
+                CollectionSpawnTemplate::ComponentProperties properties;
+                properties.m_ComponentId = dmHashString64(comp_prop.m_Id);
+                properties.m_Properties = PropertyContainerCreateFromDDF(&comp_prop.m_PropertyDecls);
+                if (properties.m_Properties == 0x0)
+                    return false;
+                spawn_template->m_Properties.Push(properties);
+            }
+
+            if (id_to_index.Get(it.m_IdHash))
+                return false;
+            id_to_index.Put(it.m_IdHash, i);
+            spawn_template->m_Instances.Push(it);
+        }
+
+        for (uint32_t i = 0; i < instance_count; ++i)
+        {
+            const dmGameObjectDDF::InstanceDesc& instance_desc = collection_desc->m_Instances[i];
+            const CollectionSpawnTemplate::InstanceTemplate& it = spawn_template->m_Instances[i];
+            for (uint32_t j = 0; j < instance_desc.m_Children.m_Count; ++j)
+            {
+                // Same as dmGameObject::GetAbsoluteIdentifier(), without the collection prefix
+                const char* child = instance_desc.m_Children[j];
+                HashState64 child_hs;
+                dmHashInit64(&child_hs, false);
+                if (*child != *ID_SEPARATOR)
+                    dmHashUpdateBuffer64(&child_hs, it.m_Id, it.m_PathLength);
+                dmHashUpdateBuffer64(&child_hs, child, strlen(child));
+                uint32_t* child_index = id_to_index.Get(dmHashFinal64(&child_hs));
+                if (!child_index)
+                    return false;
+
+                if (spawn_template->m_Links.Full())
+                    spawn_template->m_Links.OffsetCapacity(dmMath::Max(16U, instance_count));
+                CollectionSpawnTemplate::Link link = { i, *child_index };
+                spawn_template->m_Links.Push(link);
+            }
+        }
+        return true;
+    }
+
+    static void ClearCollectionSpawnTemplate(CollectionSpawnTemplate* spawn_template)
+    {
+        for (uint32_t i = 0; i < spawn_template->m_Properties.Size(); ++i)
+        {
+            PropertyContainerDestroy(spawn_template->m_Properties[i].m_Properties);
+        }
+        spawn_template->m_Properties.SetSize(0);
+        spawn_template->m_Instances.SetSize(0);
+        spawn_template->m_Links.SetSize(0);
+    }
+
+    HCollectionSpawnTemplate NewCollectionSpawnTemplate(HCollectionDesc collection_desc)
+    {
+        DM_PROFILE(__FUNCTION__);
+        CollectionSpawnTemplate* spawn_template = new CollectionSpawnTemplate;
+        spawn_template->m_CollectionDesc = (dmGameObjectDDF::CollectionDesc*)collection_desc;
+        spawn_template->m_Valid = BuildCollectionSpawnTemplate(spawn_template);
+        if (!spawn_template->m_Valid)
+        {
+            ClearCollectionSpawnTemplate(spawn_template);
+        }
+        return spawn_template;
+    }
+
+    void DeleteCollectionSpawnTemplate(HCollectionSpawnTemplate spawn_template)
+    {
+        ClearCollectionSpawnTemplate(spawn_template);
+        delete spawn_template;
+    }
+
+    static HPropertyContainer CopyTemplateProperties(const CollectionSpawnTemplate* spawn_template, const CollectionSpawnTemplate::InstanceTemplate& it, dmhash_t component_id)
+    {
+        for (uint32_t i = 0; i < it.m_PropertiesCount; ++i)
+        {
+            const CollectionSpawnTemplate::ComponentProperties& properties = spawn_template->m_Properties[it.m_PropertiesStart + i];
+            if (properties.m_ComponentId == component_id)
+                return PropertyContainerCopy(properties.m_Properties);
+        }
+        return 0x0;
+    }
+
+    // Same as CollectionSpawnFromDescInternal(), using the precomputed data of the template
+    static bool CollectionSpawnFromTemplateInternal(Collection* collection, const CollectionSpawnTemplate* spawn_template, InstancePropertyBuffers *property_buffers, InstanceIdMap *id_mapping, dmTransform::Transform const &transform)
+    {
+        const dmGameObjectDDF::CollectionDesc* collection_desc = spawn_template->m_CollectionDesc;
+        const uint32_t instance_count = spawn_template->m_Instances.Size();
+
+        // Path prefix for collection objects
+        char root_path[32];
+        HashState64 prefixHashState;
+        dmHashInit64(&prefixHashState, true);
+        GenerateUniqueCollectionInstanceId(collection, root_path, sizeof(root_path));
+        dmHashUpdateBuffer64(&prefixHashState, root_path, strlen(root_path));
+
+        // table for output ids
+        id_mapping->SetCapacity(32, instance_count);
+
+        // Indexed as the template instances
+        dmArray<HInstance> new_instances;
+        new_instances.SetCapacity(instance_count);
+
+        bool success = true;
+
+        dmResource::HFactory factory = collection->m_Factory;
+        for (uint32_t i = 0; i < instance_count; ++i)
+        {
+            const CollectionSpawnTemplate::InstanceTemplate& it = spawn_template->m_Instances[i];
+
+            // The prototypes are usually loaded already, which saves the path normalization
+            Prototype* proto = 0x0;
+            if (dmResource::Get(factory, it.m_PrototypeHash, (void**)&proto) != dmResource::RESULT_OK &&
+                dmResource::Get(factory, it.m_Prototype, (void**)&proto) != dmResource::RESULT_OK)
+            {
+                dmLogError("Unable to load prototype %s for %s", it.m_Prototype, it.m_Id);
+                success = false;
+                break;
+            }
+
+            dmGameObject::HInstance instance = dmGameObject::NewInstance(collection, proto, it.m_Prototype);
+            if (instance == 0) {
+                dmResource::Release(factory, proto);
+                success = false;
+                break;
+            }
+
+            instance->m_ScaleAlongZ = collection_desc->m_ScaleAlongZ;
+            instance->m_Generated = 1;
+            instance->m_Transform = it.m_Transform;
+            dmHashClone64(&instance->m_CollectionPathHashState, &prefixHashState, true);
+            dmHashUpdateBuffer64(&instance->m_CollectionPathHashState, it.m_Id, it.m_PathLength);
+
+            // Construct the full new path id and store in the id mapping table (mapping from prefixless
+            // to with the root_path added)
+            HashState64 new_id_hs;
+            dmHashClone64(&new_id_hs, &prefixHashState, true);
+            dmHashUpdateBuffer64(&new_id_hs, it.m_Id, it.m_IdLength);
+            dmhash_t new_id = dmHashFinal64(&new_id_hs);
+            id_mapping->Put(it.m_IdHash, new_id);
+            new_instances.Push(instance);
+
+            if (dmGameObject::SetIdentifier(collection, instance, new_id) != dmGameObject::RESULT_OK)
+            {
+                dmLogError("Unable to set identifier for %s%s. Name clash?", root_path, it.m_Id);
+                success = false;
+            }
+        }
+        dmHashRelease64(&prefixHashState);
+
         if (success)
         {
-            for (uint32_t i=0;i!=created.Size();i++)
+            // Setup hierarchy
+            for (uint32_t i = 0; i < spawn_template->m_Links.Size(); ++i)
             {
-                if (!InitInstance(collection, created[i]))
+                const CollectionSpawnTemplate::Link& link = spawn_template->m_Links[i];
+                dmGameObject::Result r = dmGameObject::SetParent(new_instances[link.m_Child], new_instances[link.m_Parent]);
+                if (r != dmGameObject::RESULT_OK)
                 {
+                    dmLogError("Unable to set %s as parent to %s (%d)", spawn_template->m_Instances[link.m_Parent].m_Id, spawn_template->m_Instances[link.m_Child].m_Id, r);
                     success = false;
-                    break;
                 }
             }
         }
 
+        // Exit point 1: Before components are created.
         if (!success)
         {
-            // Fail cleanup
-            for (uint32_t i=0;i!=created.Size();i++)
-                dmGameObject::Delete(collection, created[i], false);
+            for (uint32_t i=0;i!=new_instances.Size();i++)
+            {
+                ReleaseIdentifier(collection, new_instances[i]);
+                UndoNewInstance(collection, new_instances[i]);
+            }
             id_mapping->Clear();
             return false;
         }
 
-        for (uint32_t i=0;i!=created.Size();i++)
+        UpdateSpawnedTransforms(collection, new_instances, transform);
+
+        // Create components and set properties, see CollectionSpawnFromDescInternal()
+        dmArray<HInstance> created;
+        created.SetCapacity(instance_count);
+
+        for (uint32_t i = 0; i < instance_count; ++i)
         {
-            AddToUpdate(collection, created[i]);
+            const CollectionSpawnTemplate::InstanceTemplate& it = spawn_template->m_Instances[i];
+            dmGameObject::HInstance instance = new_instances[i];
+            bool result = dmGameObject::CreateComponents(collection, instance);
+            if (result) {
+                created.Push(instance);
+                HPropertyContainer* instance_properties = property_buffers->Get(it.m_IdHash);
+
+                uint32_t component_instance_data_index = 0;
+                Prototype::Component* components = instance->m_Prototype->m_Components;
+                uint32_t comp_count = instance->m_Prototype->m_ComponentCount;
+                for (uint32_t comp_i = 0; comp_i < comp_count; ++comp_i)
+                {
+                    Prototype::Component& component = components[comp_i];
+                    ComponentType* type = component.m_Type;
+                    if (type->m_SetPropertiesFunction != 0x0)
+                    {
+                        if (!type->m_InstanceHasUserData)
+                        {
+                            DM_HASH_REVERSE_MEM(hash_ctx, 256);
+                            dmLogError("Unable to set properties for the component '%s' in game object '%s' in collection '%s' since it has no ability to store them.", dmHashReverseSafe64Alloc(&hash_ctx, component.m_Id), it.m_Id, collection_desc->m_Name);
+                            success = false;
+                            break;
+                        }
+
+                        HPropertyContainer ddf_properties = CopyTemplateProperties(spawn_template, it, component.m_Id);
+                        if (!SetSpawnedComponentProperties(instance, component, component_instance_data_index, ddf_properties, instance_properties, it.m_Id, collection_desc->m_Name))
+                        {
+                            success = false;
+                            break;
+                        }
+                    }
+                    if (component.m_Type->m_InstanceHasUserData)
+                        ++component_instance_data_index;
+                }
+            } else {
+                ReparentChildNodes(collection, instance);
+                Unlink(collection, instance);
+                MoveAllUp(collection, instance);
+
+                ReleaseIdentifier(collection, instance);
+                UndoNewInstance(collection, instance);
+                success = false;
+            }
         }
 
-        return true;
+        return FinishCollectionSpawn(collection, created, id_mapping, success);
+    }
+
+    bool SpawnFromCollection(HCollection hcollection, HCollectionSpawnTemplate spawn_template, InstancePropertyBuffers *property_buffers,
+                             const Point3& position, const Quat& rotation, const Vector3& scale,
+                             InstanceIdMap *instances)
+    {
+        if (!spawn_template->m_Valid)
+        {
+            return SpawnFromCollection(hcollection, spawn_template->m_CollectionDesc, property_buffers, position, rotation, scale, instances);
+        }
+
+        dmTransform::Transform transform;
+        transform.SetTranslation(Vector3(position));
+        transform.SetRotation(rotation);
+        transform.SetScale(scale);
+
+        return CollectionSpawnFromTemplateInternal(hcollection->m_Collection, spawn_template, property_buffers, instances, transform);
     }
 
     bool SpawnFromCollection(HCollection hcollection, HCollectionDesc collection_desc, InstancePropertyBuffers *property_buffers,
@@ -1753,6 +2264,7 @@ namespace dmGameObject
                     *trans = dmTransform::MulNoScaleZ(*parent_trans, dmTransform::ToMatrix4(instance->m_Transform));
                 }
             }
+            MarkWorldTransformWritten(collection, instance->m_Index);
             return InitComponents(collection, instance);
         }
 
@@ -1946,6 +2458,32 @@ namespace dmGameObject
         instance->m_ToBeAdded = 0;
     }
 
+    // Unlinks all the instances scheduled for deletion from the add-to-update list, in one pass
+    static void RemoveDeletedFromAddToUpdate(Collection* collection)
+    {
+        uint16_t* prev_index_ptr = &collection->m_InstancesToAddHead;
+        uint16_t tail = INVALID_INSTANCE_INDEX;
+        uint16_t index = *prev_index_ptr;
+        while (index != INVALID_INSTANCE_INDEX)
+        {
+            Instance* instance = collection->m_Instances[index];
+            uint16_t next = instance->m_NextToAdd;
+            if (instance->m_ToBeDeleted)
+            {
+                *prev_index_ptr = next;
+                instance->m_NextToAdd = INVALID_INSTANCE_INDEX;
+                instance->m_ToBeAdded = 0;
+            }
+            else
+            {
+                prev_index_ptr = &instance->m_NextToAdd;
+                tail = index;
+            }
+            index = next;
+        }
+        collection->m_InstancesToAddTail = tail;
+    }
+
     static void DoDeleteInstance(Collection* collection, HInstance instance)
     {
         DM_PROFILE("DoDeleteInstance");
@@ -1978,7 +2516,7 @@ namespace dmGameObject
 
         // Unlink "me" from parent
         Unlink(collection, instance);
-        EraseSwapLevelIndex(collection, instance);
+        ClearLevelIndex(collection, instance);
         MoveAllUp(collection, instance);
 
         if (prototype != &EMPTY_PROTOTYPE)
@@ -2007,7 +2545,7 @@ namespace dmGameObject
             collection->m_InputFocusStack.Pop();
         }
 
-        DeallocInstance(instance);
+        DeallocInstance(collection, instance);
 
         assert(collection->m_IDToInstance.Size() <= collection->m_InstanceIndices.Size());
     }
@@ -2227,9 +2765,35 @@ namespace dmGameObject
     struct DispatchMessagesContext
     {
         Collection* m_Collection;
+        // Consecutive messages to components of a type with a batched on-message function
+        ComponentType* m_BatchType;
+        void* m_BatchWorld;
+        ComponentOnMessageParams m_Batch[dmMessage::DISPATCH_BATCH_SIZE];
+        uint32_t m_BatchCount;
         bool m_Success;
     };
 
+    static void FlushMessageBatch(DispatchMessagesContext* context)
+    {
+        if (context->m_BatchCount == 0)
+            return;
+
+        DM_PROFILE("OnMessageBatchFunction");
+        ComponentType* component_type = context->m_BatchType;
+        ComponentsOnMessageBatchParams params;
+        params.m_World = context->m_BatchWorld;
+        params.m_Context = component_type->m_Context;
+        params.m_Messages = context->m_Batch;
+        params.m_Count = context->m_BatchCount;
+        UpdateResult res = component_type->m_OnMessageBatchFunction(params);
+        if (res != UPDATE_RESULT_OK)
+            context->m_Success = false;
+
+        context->m_BatchType = 0;
+        context->m_BatchWorld = 0;
+        context->m_BatchCount = 0;
+    }
+
     void DispatchMessagesFunction(dmMessage::Message* message, void* user_ptr)
     {
         DispatchMessagesContext* context = (DispatchMessagesContext*) user_ptr;
@@ -2257,16 +2821,19 @@ namespace dmGameObject
             dmDDF::Descriptor* descriptor = (dmDDF::Descriptor*)message->m_Descriptor;
             if (descriptor == dmGameObjectDDF::AcquireInputFocus::m_DDFDescriptor)
             {
+                FlushMessageBatch(context);
                 dmGameObject::AcquireInputFocus(collection, instance);
                 return;
             }
             else if (descriptor == dmGameObjectDDF::ReleaseInputFocus::m_DDFDescriptor)
             {
+                FlushMessageBatch(context);
                 dmGameObject::ReleaseInputFocus(collection, instance);
                 return;
             }
             else if (descriptor == dmGameObjectDDF::SetParent::m_DDFDescriptor)
             {
+                FlushMessageBatch(context);
                 dmGameObjectDDF::SetParent* sp = (dmGameObjectDDF::SetParent*)message->m_Data;
                 dmGameObject::HInstance parent = 0;
                 if (sp->m_ParentId != 0)
@@ -2294,6 +2861,7 @@ namespace dmGameObject
                     {
                         world = dmTransform::MulNoScaleZ(parent_t, dmTransform::ToMatrix4(instance->m_Transform));
                     }
+                    MarkWorldTransformWritten(collection, instance->m_Index);
                 }
                 else
                 {
@@ -2344,7 +2912,7 @@ namespace dmGameObject
             ComponentType* component_type = component->m_Type;
             assert(component_type);
 
-            if (component_type->m_OnMessageFunction)
+            if (component_type->m_OnMessageFunction || component_type->m_OnMessageBatchFunction)
             {
                 // TODO: Not optimal way to find index of component instance data
                 uint32_t next_component_instance_data = 0;
@@ -2363,14 +2931,29 @@ namespace dmGameObject
                 {
                     component_instance_data = &instance->m_ComponentInstanceUserData[next_component_instance_data];
                 }
+
+                ComponentOnMessageParams params;
+                params.m_Instance = instance;
+                params.m_World = collection->m_ComponentWorlds[component->m_TypeIndex];
+                params.m_Context = component_type->m_Context;
+                params.m_UserData = component_instance_data;
+                params.m_Message = message;
+
+                if (component_type->m_OnMessageBatchFunction)
                 {
+                    // The batch is flushed before any other message is handled, and at the end of the dispatched batch
+                    if (context->m_BatchType != component_type)
+                    {
+                        FlushMessageBatch(context);
+                        context->m_BatchType = component_type;
+                        context->m_BatchWorld = params.m_World;
+                    }
+                    context->m_Batch[context->m_BatchCount++] = params;
+                }
+                else
+                {
+                    FlushMessageBatch(context);
                     DM_PROFILE("OnMessageFunction");
-                    ComponentOnMessageParams params;
-                    params.m_Instance = instance;
-                    params.m_World = collection->m_ComponentWorlds[component->m_TypeIndex];
-                    params.m_Context = component_type->m_Context;
-                    params.m_UserData = component_instance_data;
-                    params.m_Message = message;
                     UpdateResult res = component_type->m_OnMessageFunction(params);
                     if (res != UPDATE_RESULT_OK)
                         context->m_Success = false;
@@ -2384,6 +2967,7 @@ namespace dmGameObject
         }
         else // broadcast
         {
+            FlushMessageBatch(context);
             uint32_t next_component_instance_data = 0;
             for (uint32_t i = 0; i < prototype->m_ComponentCount; ++i)
             {
@@ -2422,12 +3006,26 @@ namespace dmGameObject
         }
     }
 
+    static void DispatchMessagesBatchFunction(dmMessage::Message** messages, uint32_t count, void* user_ptr)
+    {
+        DispatchMessagesContext* context = (DispatchMessagesContext*) user_ptr;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            DispatchMessagesFunction(messages[i], user_ptr);
+        }
+        // The messages are only valid during this call
+        FlushMessageBatch(context);
+    }
+
     static bool DispatchMessages(Collection* collection, dmMessage::HSocket* sockets, uint32_t socket_count)
     {
         DM_PROFILE("DispatchMessages");
 
         DispatchMessagesContext ctx;
         ctx.m_Collection = collection;
+        ctx.m_BatchType = 0;
+        ctx.m_BatchWorld = 0;
+        ctx.m_BatchCount = 0;
         ctx.m_Success = true;
         bool iterate = true;
         uint32_t iteration_count = 0;
@@ -2445,7 +3043,7 @@ namespace dmGameObject
                 {
                     UpdateTransforms(collection);
                 }
-                uint32_t message_count = dmMessage::Dispatch(sockets[i], &DispatchMessagesFunction, (void*) &ctx);
+                uint32_t message_count = dmMessage::DispatchBatch(sockets[i], &DispatchMessagesBatchFunction, (void*) &ctx);
                 if (message_count)
                 {
                     collection->m_DirtyTransforms = true;
@@ -2485,65 +3083,146 @@ namespace dmGameObject
         }
     }
 
-    void UpdateTransforms(Collection* collection)
+    // Checks if the world transform of the instance needs to be recalculated, and flags it for its children
+    static inline bool CheckTransformChanged(Collection* collection, Instance* instance)
     {
-        DM_PROFILE("UpdateTransforms");
+        CheckEuler(instance);
+
+        uint8_t* flags = collection->m_TransformFlags.Begin();
+        uint16_t index = instance->m_Index;
+        uint16_t parent_index = instance->m_Parent;
+        bool parent_changed = parent_index != INVALID_INSTANCE_INDEX && (flags[parent_index] & TRANSFORM_FLAG_CHANGED);
 
-        // Calculate world transforms
-        // First root-level instances
-        dmArray<uint16_t>& root_level = collection->m_LevelIndices[0];
-        uint32_t root_count = root_level.Size();
-        for (uint32_t i = 0; i < root_count; ++i)
+        // The local transform is written to directly by e.g. property animations, so compare against
+        // the transform used last time rather than relying on every writer flagging the instance
+        dmTransform::Transform& prev = collection->m_PrevTransforms[index];
+        if (!parent_changed && !(flags[index] & TRANSFORM_FLAG_FORCE) && memcmp(&prev, &instance->m_Transform, sizeof(dmTransform::Transform)) == 0)
         {
-            uint16_t index = root_level[i];
-            Instance* instance = collection->m_Instances[index];
-            CheckEuler(instance);
-            collection->m_WorldTransforms[index] = dmTransform::ToMatrix4(instance->m_Transform);
-            uint16_t parent_index = instance->m_Parent;
-            assert(parent_index == INVALID_INSTANCE_INDEX);
+            flags[index] = 0;
+            return false;
         }
+        prev = instance->m_Transform;
+        flags[index] = TRANSFORM_FLAG_CHANGED;
+        collection->m_TransformVersions[index] = collection->m_TransformVersion;
+        return true;
+    }
 
+    static void UpdateLevelTransforms(Collection* collection, const uint16_t* indices, uint32_t count)
+    {
+        static const Matrix4 identity = Matrix4::identity();
+        const uint32_t batch_size = dmTransform::TRANSFORM_BATCH_SIZE;
+        bool scale_along_z = collection->m_ScaleAlongZ;
+        Matrix4* world_transforms = collection->m_WorldTransforms.Begin();
 
-        if (collection->m_ScaleAlongZ) {
-            for (uint32_t level_i = 1; level_i < MAX_HIERARCHICAL_DEPTH; ++level_i)
-            {
-                dmArray<uint16_t>& level = collection->m_LevelIndices[level_i];
-                uint32_t instance_count = level.Size();
-                for (uint32_t i = 0; i < instance_count; ++i)
-                {
-                    uint16_t index = level[i];
-                    Instance* instance = collection->m_Instances[index];
-                    CheckEuler(instance);
-                    Matrix4* trans = &collection->m_WorldTransforms[index];
+        // The changed instances are gathered into batches, which are calculated together
+        dmTransform::TransformBatch batch;
+        const Matrix4* parents[batch_size];
+        uint16_t batch_indices[batch_size];
+        Matrix4 out[batch_size];
+        uint32_t batch_count = 0;
 
-                    uint16_t parent_index = instance->m_Parent;
-                    assert(parent_index != INVALID_INSTANCE_INDEX);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            uint16_t index = indices[i];
+            Instance* instance = collection->m_Instances[index];
+            if (!CheckTransformChanged(collection, instance))
+                continue;
 
-                    Matrix4* parent_trans = &collection->m_WorldTransforms[parent_index];
-                    Matrix4 own = dmTransform::ToMatrix4(instance->m_Transform);
-                    *trans = *parent_trans * own;
-                }
+            uint16_t parent_index = instance->m_Parent;
+            dmTransform::SetBatchTransform(&batch, batch_count, instance->m_Transform);
+            parents[batch_count] = parent_index == INVALID_INSTANCE_INDEX ? &identity : &world_transforms[parent_index];
+            batch_indices[batch_count] = index;
+            if (++batch_count == batch_size)
+            {
+                dmTransform::MulToMatrix4Batch(batch, parents, scale_along_z, out);
+                for (uint32_t j = 0; j < batch_size; ++j)
+                    world_transforms[batch_indices[j]] = out[j];
+                batch_count = 0;
             }
-        } else {
-            for (uint32_t level_i = 1; level_i < MAX_HIERARCHICAL_DEPTH; ++level_i)
+        }
+
+        if (batch_count > 0)
+        {
+            // Pad the unused lanes with the last entry
+            for (uint32_t j = batch_count; j < batch_size; ++j)
             {
-                dmArray<uint16_t>& level = collection->m_LevelIndices[level_i];
-                uint32_t instance_count = level.Size();
-                for (uint32_t i = 0; i < instance_count; ++i)
-                {
-                    uint16_t index = level[i];
-                    Instance* instance = collection->m_Instances[index];
-                    CheckEuler(instance);
-                    Matrix4* trans = &collection->m_WorldTransforms[index];
+                dmTransform::SetBatchTransform(&batch, j, collection->m_Instances[batch_indices[batch_count - 1]]->m_Transform);
+                parents[j] = parents[batch_count - 1];
+            }
+            dmTransform::MulToMatrix4Batch(batch, parents, scale_along_z, out);
+            for (uint32_t j = 0; j < batch_count; ++j)
+                world_transforms[batch_indices[j]] = out[j];
+        }
+    }
 
-                    uint16_t parent_index = instance->m_Parent;
-                    assert(parent_index != INVALID_INSTANCE_INDEX);
+    static int TransformJobProcess(void* context, void* data)
+    {
+        DM_PROFILE("TransformJob");
+        Collection* collection = (Collection*) context;
+        TransformJob* job = (TransformJob*) data;
+        UpdateLevelTransforms(collection, job->m_Indices, job->m_Count);
+        return 0;
+    }
 
-                    Matrix4* parent_trans = &collection->m_WorldTransforms[parent_index];
-                    Matrix4 own = dmTransform::ToMatrix4(instance->m_Transform);
-                    *trans = dmTransform::MulNoScaleZ(*parent_trans, own);
-                }
-            }
+    // Splits the level into chunks, where the calling thread processes the first chunk and the workers the rest.
+    // Instances within a level only depend on the (already calculated) previous level and can be processed in any order.
+    static void UpdateLevelTransformsParallel(Collection* collection, dmJobThread::HContext job_thread, const uint16_t* indices, uint32_t count)
+    {
+        uint32_t worker_count = dmJobThread::GetWorkerCount(job_thread);
+        uint32_t chunk_count = dmMath::Min(worker_count + 1, count / TRANSFORM_JOB_MIN_INSTANCES);
+        if (chunk_count <= 1)
+        {
+            UpdateLevelTransforms(collection, indices, count);
+            return;
+        }
+
+        uint32_t chunk_size = (count + chunk_count - 1) / chunk_count;
+        uint32_t job_count = chunk_count - 1;
+
+        dmArray<TransformJob>& jobs = collection->m_TransformJobs;
+        if (jobs.Capacity() < job_count)
+            jobs.SetCapacity(job_count);
+        jobs.SetSize(job_count);
+
+        dmJobThread::JobGroup group;
+        dmJobThread::InitGroup(&group, 0);
+        for (uint32_t i = 0; i < job_count; ++i)
+        {
+            uint32_t start = (i + 1) * chunk_size;
+            TransformJob& job = jobs[i];
+            job.m_Indices = indices + start;
+            job.m_Count = dmMath::Min(chunk_size, count - start);
+            dmJobThread::PushGroupJob(job_thread, &group, TransformJobProcess, (void*) collection, (void*) &job);
+        }
+
+        UpdateLevelTransforms(collection, indices, chunk_size);
+
+        {
+            DM_PROFILE("WaitTransformJobs");
+            dmJobThread::WaitGroup(job_thread, &group);
+        }
+    }
+
+    void UpdateTransforms(Collection* collection)
+    {
+        DM_PROFILE("UpdateTransforms");
+
+        dmJobThread::HContext job_thread = collection->m_Register->m_JobThread;
+        ++collection->m_TransformVersion;
+
+        // Calculate world transforms, level by level, since each level depends on the previous one
+        // Instances are only recalculated if their local transform or their parent's world transform changed
+        for (uint32_t level_i = 0; level_i < MAX_HIERARCHICAL_DEPTH; ++level_i)
+        {
+            dmArray<uint16_t>& level = collection->m_LevelIndices[level_i];
+            uint32_t instance_count = level.Size();
+            if (instance_count == 0)
+                continue;
+
+            if (job_thread)
+                UpdateLevelTransformsParallel(collection, job_thread, level.Begin(), instance_count);
+            else
+                UpdateLevelTransforms(collection, level.Begin(), instance_count);
         }
 
         collection->m_DirtyTransforms = false;
@@ -2554,6 +3233,86 @@ namespace dmGameObject
         UpdateTransforms(hcollection->m_Collection);
     }
 
+    static int CollectionTransformsJobProcess(void* context, void* data)
+    {
+        UpdateTransforms((Collection*) data);
+        return 0;
+    }
+
+    void UpdateTransforms(HCollection* hcollections, uint32_t count)
+    {
+        DM_PROFILE("UpdateCollectionTransforms");
+
+        // The collections don't share any instances, so they are updated concurrently, one job each.
+        // The calling thread updates the first one. A job may split the levels of its collection further.
+        Collection* first = 0;
+        dmJobThread::HContext job_thread = 0;
+        dmJobThread::JobGroup group;
+        dmJobThread::InitGroup(&group, 0);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            Collection* collection = hcollections[i]->m_Collection;
+            if (!collection->m_DirtyTransforms)
+                continue;
+
+            if (!first)
+            {
+                first = collection;
+                job_thread = collection->m_Register->m_JobThread;
+                continue;
+            }
+            dmJobThread::PushGroupJob(job_thread, &group, CollectionTransformsJobProcess, 0, (void*) collection);
+        }
+
+        if (first)
+        {
+            UpdateTransforms(first);
+            DM_PROFILE("WaitCollectionTransformJobs");
+            dmJobThread::WaitGroup(job_thread, &group);
+        }
+    }
+
+    void SetDeferTransforms(HCollection hcollection, bool defer)
+    {
+        hcollection->m_Collection->m_DeferTransforms = defer;
+    }
+
+    // Nesting level of the component function calls, larger than one while updating a collection proxy
+    static uint32_t g_ComponentCallDepth = 0;
+
+    static inline uint64_t BeginComponentCall()
+    {
+        ++g_ComponentCallDepth;
+        return dmTime::GetTime();
+    }
+
+    static void EndComponentCall(Collection* collection, uint32_t type_index, ComponentFunction function, uint64_t start)
+    {
+        uint32_t time = (uint32_t)(dmTime::GetTime() - start);
+        --g_ComponentCallDepth;
+
+        // Component types registered after the collection was created aren't tracked
+        if (type_index < collection->m_ComponentTypeCosts.Size())
+        {
+            ComponentTypeCost& cost = collection->m_ComponentTypeCosts[type_index];
+            cost.m_Time[function] += time;
+            cost.m_Count[function]++;
+        }
+
+        // The times are inclusive, so only the outermost calls are added to the totals
+        if (g_ComponentCallDepth != 0)
+            return;
+
+        switch (function)
+        {
+        case COMPONENT_FUNCTION_UPDATE:         DM_PROPERTY_ADD_U32(rmtp_GOUpdateTime, time); break;
+        case COMPONENT_FUNCTION_FIXED_UPDATE:   DM_PROPERTY_ADD_U32(rmtp_GOFixedUpdateTime, time); break;
+        case COMPONENT_FUNCTION_POST_UPDATE:    DM_PROPERTY_ADD_U32(rmtp_GOPostUpdateTime, time); break;
+        case COMPONENT_FUNCTION_RENDER:         DM_PROPERTY_ADD_U32(rmtp_GORenderTime, time); break;
+        default: break;
+        }
+    }
+
     static bool Update(Collection* collection, const UpdateContext* update_context)
     {
         DM_PROFILE("Update");
@@ -2604,7 +3363,9 @@ namespace dmGameObject
 
                 ComponentsUpdateResult update_result;
                 update_result.m_TransformsUpdated = false;
+                uint64_t call_start = BeginComponentCall();
                 UpdateResult res = component_type->m_UpdateFunction(params, update_result);
+                EndComponentCall(collection, update_index, COMPONENT_FUNCTION_UPDATE, call_start);
                 if (res != UPDATE_RESULT_OK)
                     ret = false;
 
@@ -2664,7 +3425,9 @@ namespace dmGameObject
 
                             ComponentsUpdateResult update_result;
                             update_result.m_TransformsUpdated = false;
+                            uint64_t call_start = BeginComponentCall();
                             UpdateResult res = component_type->m_FixedUpdateFunction(params, update_result);
+                            EndComponentCall(collection, update_index, COMPONENT_FUNCTION_FIXED_UPDATE, call_start);
                             if (res != UPDATE_RESULT_OK)
                                 ret = false;
 
@@ -2684,7 +3447,7 @@ namespace dmGameObject
         }
 
         collection->m_InUpdate = 0;
-        if (collection->m_DirtyTransforms) {
+        if (collection->m_DirtyTransforms && !collection->m_DeferTransforms) {
             UpdateTransforms(collection);
         }
 
@@ -2716,7 +3479,9 @@ namespace dmGameObject
                 params.m_Collection = hcollection;
                 params.m_World = collection->m_ComponentWorlds[update_index];
                 params.m_Context = component_type->m_Context;
+                uint64_t call_start = BeginComponentCall();
                 UpdateResult res = component_type->m_RenderFunction(params);
+                EndComponentCall(collection, update_index, COMPONENT_FUNCTION_RENDER, call_start);
                 if (res != UPDATE_RESULT_OK)
                     ret = false;
             }
@@ -2760,7 +3525,9 @@ namespace dmGameObject
                 params.m_Collection = collection->m_HCollection;
                 params.m_World = collection->m_ComponentWorlds[update_index];
                 params.m_Context = component_type->m_Context;
+                uint64_t call_start = BeginComponentCall();
                 UpdateResult res = component_type->m_PostUpdateFunction(params);
+                EndComponentCall(collection, update_index, COMPONENT_FUNCTION_POST_UPDATE, call_start);
                 if (res != UPDATE_RESULT_OK && result)
                     result = false;
             }
@@ -2797,6 +3564,11 @@ namespace dmGameObject
                     result = false;
                 }
 
+                // The instances are unlinked from the add-to-update list and the level indices in one pass each
+                if (collection->m_InstancesToAddHead != INVALID_INSTANCE_INDEX) {
+                    RemoveDeletedFromAddToUpdate(collection);
+                }
+
                 // Reset to iterate for actual deletion
                 index = head;
                 while (index != INVALID_INSTANCE_INDEX) {
@@ -2808,6 +3580,8 @@ namespace dmGameObject
                     DoDeleteInstance(collection, instance);
                     ++instances_deleted;
                 }
+
+                CompactLevelIndices(collection);
             }
             if (pass_count == max_pass_count) {
                 dmLogWarning("Creation/deletion cycles encountered, postponing to next frame to avoid infinite hang.");
@@ -2821,6 +3595,14 @@ namespace dmGameObject
 
         DM_PROPERTY_ADD_U32(rmtp_GODeleted, instances_deleted);
 
+        // The post update is the last step of the frame
+        {
+            DM_MUTEX_SCOPED_LOCK(reg->m_Mutex);
+            collection->m_LastComponentTypeCosts.Swap(collection->m_ComponentTypeCosts);
+        }
+        if (!collection->m_ComponentTypeCosts.Empty())
+            memset(collection->m_ComponentTypeCosts.Begin(), 0, sizeof(ComponentTypeCost) * collection->m_ComponentTypeCosts.Size());
+
         return result;
     }
 
@@ -2829,6 +3611,40 @@ namespace dmGameObject
         return PostUpdate(hcollection->m_Collection);
     }
 
+    void IterateComponentTypeStats(HRegister regist, ComponentTypeStatsCallback callback, void* ctx)
+    {
+        DM_MUTEX_SCOPED_LOCK(regist->m_Mutex);
+        for (uint32_t i = 0; i < regist->m_Collections.Size(); ++i)
+        {
+            Collection* collection = regist->m_Collections[i];
+            const char* collection_name = dmMessage::GetSocketName(collection->m_ComponentSocket);
+
+            for (uint32_t j = 0; j < regist->m_ComponentTypeCount; ++j)
+            {
+                uint16_t update_index = regist->m_ComponentTypesOrder[j];
+                if (update_index >= collection->m_LastComponentTypeCosts.Size())
+                    continue;
+                ComponentType* component_type = &regist->m_ComponentTypes[update_index];
+                if (!component_type->m_UpdateFunction && !component_type->m_FixedUpdateFunction &&
+                    !component_type->m_PostUpdateFunction && !component_type->m_RenderFunction)
+                    continue;
+
+                const ComponentTypeCost& cost = collection->m_LastComponentTypeCosts[update_index];
+                ComponentTypeStats stats;
+                stats.m_TypeName         = component_type->m_Name;
+                stats.m_UpdateTime       = cost.m_Time[COMPONENT_FUNCTION_UPDATE];
+                stats.m_FixedUpdateTime  = cost.m_Time[COMPONENT_FUNCTION_FIXED_UPDATE];
+                stats.m_PostUpdateTime   = cost.m_Time[COMPONENT_FUNCTION_POST_UPDATE];
+                stats.m_RenderTime       = cost.m_Time[COMPONENT_FUNCTION_RENDER];
+                stats.m_UpdateCount      = cost.m_Count[COMPONENT_FUNCTION_UPDATE];
+                stats.m_FixedUpdateCount = cost.m_Count[COMPONENT_FUNCTION_FIXED_UPDATE];
+                stats.m_PostUpdateCount  = cost.m_Count[COMPONENT_FUNCTION_POST_UPDATE];
+                stats.m_RenderCount      = cost.m_Count[COMPONENT_FUNCTION_RENDER];
+                callback(ctx, collection_name, &stats);
+            }
+        }
+    }
+
     bool PostUpdate(HRegister reg)
     {
         DM_PROFILE("PostUpdateRegister");
@@ -3098,6 +3914,23 @@ namespace dmGameObject
         return instance->m_Collection->m_WorldTransforms[instance->m_Index];
     }
 
+    uint32_t GetTransformIndex(HInstance instance)
+    {
+        return instance->m_Index;
+    }
+
+    const Matrix4* GetWorldTransforms(HCollection hcollection)
+    {
+        return hcollection->m_Collection->m_WorldTransforms.Begin();
+    }
+
+    const uint32_t* GetTransformVersions(HCollection hcollection, uint32_t* current_version)
+    {
+        Collection* collection = hcollection->m_Collection;
+        *current_version = collection->m_TransformVersion;
+        return collection->m_TransformVersions.Begin();
+    }
+
     Result SetParent(HInstance child, HInstance parent)
     {
         if (parent == 0 && child->m_Parent == INVALID_INSTANCE_INDEX)
@@ -3674,7 +4507,7 @@ namespace dmGameObject
         // We don't support recreating instances that are 'transitioning'
         assert(instance->m_ToBeAdded == 0);
         assert(instance->m_ToBeDeleted == 0);
-        HInstance new_instance = AllocInstance(new_proto, new_proto_name);
+        HInstance new_instance = AllocInstance(collection, new_proto, new_proto_name);
         if (!new_instance) {
             return;
         }
@@ -3701,7 +4534,7 @@ namespace dmGameObject
         bool res = CreateComponents(hcollection, new_instance);
         if (!res) {
             dmHashRelease64(&new_instance->m_CollectionPathHashState);
-            DeallocInstance(new_instance);
+            DeallocInstance(collection, new_instance);
             return;
         }
         if (instance->m_Initialized) {
@@ -3727,7 +4560,7 @@ namespace dmGameObject
                 break;
             }
         }
-        DeallocInstance(instance);
+        DeallocInstance(collection, instance);
         DoAddToUpdate(collection, new_instance);
     }
 
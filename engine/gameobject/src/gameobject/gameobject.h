@@ -21,6 +21,7 @@
 
 #include <dlib/easing.h>
 #include <dlib/hashtable.h>
+#include <dlib/job_thread.h>
 #include <dlib/message.h>
 #include <dlib/transform.h>
 
@@ -97,6 +98,23 @@ namespace dmGameObject
      */
     void SetInputStackDefaultCapacity(HRegister regist, uint32_t capacity);
 
+    /**
+     * Set the job thread used when calculating world transforms for the collections in this register.
+     * Large hierarchical levels are split into group jobs, which the calling thread helps out with. The register doesn't take ownership.
+     * @param regist Register
+     * @param job_thread Job thread context, or 0 to calculate everything on the calling thread
+     */
+    void SetJobThread(HRegister regist, dmJobThread::HContext job_thread);
+
+    /**
+     * Set a deadline for creating the components of the collections loaded by a resource preloader.
+     * While set, the collection resources defer the component creation to their post create function, which creates the
+     * components of as many instances as the deadline allows, and stays pending until all are created.
+     * @param regist Register
+     * @param deadline Time from dmTime::GetTime(), or 0 to create all components when the collection is created
+     */
+    void SetCollectionCreateDeadline(HRegister regist, uint64_t deadline);
+
     /**
      * Creates a new gameobject collection
      * @param name Collection name, which must be unique and follow the same naming as for sockets
@@ -149,6 +167,39 @@ namespace dmGameObject
                              const Point3& position, const Quat& rotation, const Vector3& scale,
                              InstanceIdMap *instances);
 
+    /**
+     * Creates a spawn template of a collection description. The template holds the hashed identifiers, the
+     * resolved hierarchy and the decoded component properties, to make repeated spawns of the same collection cheaper.
+     * The collection description must outlive the template.
+     *
+     * @param collection_desc Description data of collections
+     * @return The spawn template
+     */
+    HCollectionSpawnTemplate NewCollectionSpawnTemplate(HCollectionDesc collection_desc);
+
+    /**
+     * Deletes a spawn template
+     * @param spawn_template The spawn template
+     */
+    void DeleteCollectionSpawnTemplate(HCollectionSpawnTemplate spawn_template);
+
+    /**
+     * Spawns a collection into an existing one, from a spawn template. Same as SpawnFromCollection() with
+     * a collection description.
+     *
+     * @param collection Gameobject collection to spawn into
+     * @param spawn_template Spawn template, see NewCollectionSpawnTemplate()
+     * @param property_buffers Serialized property buffers hashtable (key: game object identifier, value: property buffer)
+     * @param position Position for the root object
+     * @param rotation Rotation for the root object
+     * @param scale Scale of the root object
+     * @param instances Hash table to be filled with instance identifier mapping.
+     * return true on success
+     */
+    bool SpawnFromCollection(HCollection collection, HCollectionSpawnTemplate spawn_template, InstancePropertyBuffers *property_buffers,
+                             const Point3& position, const Quat& rotation, const Vector3& scale,
+                             InstanceIdMap *instances);
+
     /**
      * Delete all gameobject instances in the collection
      * @param collection Gameobject collection
@@ -275,6 +326,39 @@ namespace dmGameObject
     // Used by comp_collision_object.cpp to do cold lookups of urls
     HCollection GetCollectionByHash(HRegister regist, dmhash_t socket_name);
 
+    /**
+     * The cost of a component type in a collection during the last frame
+     * The times are in microseconds, and are measured in all builds (including release)
+     */
+    struct ComponentTypeStats
+    {
+        const char* m_TypeName;
+        uint32_t    m_UpdateTime;
+        uint32_t    m_FixedUpdateTime;      // Total time of all fixed steps
+        uint32_t    m_PostUpdateTime;
+        uint32_t    m_RenderTime;
+        uint32_t    m_UpdateCount;          // Number of calls to the update functions
+        uint32_t    m_FixedUpdateCount;
+        uint32_t    m_PostUpdateCount;
+        uint32_t    m_RenderCount;
+    };
+
+    /**
+     * Callback for IterateComponentTypeStats
+     * @param ctx User context
+     * @param collection_name The collection (socket) name
+     * @param stats The stats of a component type with at least one update, post update or render function
+     */
+    typedef void (*ComponentTypeStatsCallback)(void* ctx, const char* collection_name, const ComponentTypeStats* stats);
+
+    /**
+     * Iterate the component type stats of the last frame, for all collections in the register
+     * @param regist Register
+     * @param callback Called once per collection and component type
+     * @param ctx User context passed to the callback
+     */
+    void IterateComponentTypeStats(HRegister regist, ComponentTypeStatsCallback callback, void* ctx);
+
     /**
      * Retrieve the frame message socket for the specified collection.
      * @param collection Collection handle
@@ -289,6 +373,32 @@ namespace dmGameObject
      */
     bool ScaleAlongZ(HCollection collection);
 
+    /**
+     * Get the index of the world transform of an instance in the array returned by GetWorldTransforms().
+     * The index is fixed for the lifetime of the instance.
+     * @param instance Instance
+     * @return the transform index
+     */
+    uint32_t GetTransformIndex(HInstance instance);
+
+    /**
+     * Get the world transforms of all the instances in a collection, indexed by GetTransformIndex().
+     * Useful for component worlds that read the transforms of many instances at once.
+     * @param collection Collection
+     * @return the world transforms
+     */
+    const dmVMath::Matrix4* GetWorldTransforms(HCollection collection);
+
+    /**
+     * Get the versions of the world transforms, indexed by GetTransformIndex(). A component world can
+     * store the current version after reading the transforms, and skip the instances whose version
+     * isn't greater than it the next time.
+     * @param collection Collection
+     * @param current_version [out] the current version
+     * @return the versions of the world transforms
+     */
+    const uint32_t* GetTransformVersions(HCollection collection, uint32_t* current_version);
+
     /**
      * Get instance hierarchical depth
      * @param instance Gameobject instance
@@ -378,6 +488,17 @@ namespace dmGameObject
      */
     void UpdateTransforms(HCollection hcollection);
 
+    /*
+     * Updates the transforms of several collections (the ones with changed transforms) concurrently on the job thread
+     */
+    void UpdateTransforms(HCollection* hcollections, uint32_t count);
+
+    /*
+     * Leaves the transform update at the end of Update() to the caller, e.g. to update several collections
+     * together with UpdateTransforms(HCollection*, uint32_t). The transforms must be updated before the collection is rendered.
+     */
+    void SetDeferTransforms(HCollection hcollection, bool defer);
+
     /**
      * Adds a reference to a dynamically created resource into the collection.
      * If the resource is not released before the collection is being destroyed,
@@ -18,6 +18,7 @@
 #include <dlib/hash.h>
 #include <dlib/hashtable.h>
 #include <dlib/index_pool.h>
+#include <dlib/job_thread.h>
 #include <dlib/math.h>
 #include <dlib/mutex.h>
 #include <dlib/transform.h>
@@ -201,15 +202,62 @@ namespace dmGameObject
         // Default capacity of collections
         uint32_t                    m_DefaultCollectionCapacity;
         uint32_t                    m_DefaultInputStackCapacity;
+        // Job thread used for splitting transform levels (not owned). Zero if disabled
+        dmJobThread::HContext       m_JobThread;
+        // While non zero, the components of collections created by a preloader are created in slices until this time (see SetCollectionCreateDeadline)
+        uint64_t                    m_CollectionCreateDeadline;
 
         Register();
         ~Register();
     };
 
+    // Set on instances that must have their world transform recalculated, regardless of their local transform (e.g. new or reparented)
+    const uint8_t TRANSFORM_FLAG_FORCE   = 1;
+    // Set during UpdateTransforms on instances whose world transform was recalculated, so that children know to recalculate as well
+    const uint8_t TRANSFORM_FLAG_CHANGED = 2;
+
+    // Minimum number of instances per job when splitting a hierarchical level over the transform worker threads
+    const uint32_t TRANSFORM_JOB_MIN_INSTANCES = 256;
+
+    struct TransformJob
+    {
+        const uint16_t*     m_Indices;
+        uint32_t            m_Count;
+    };
+
     // Max hierarchical depth
     // depth is interpreted as up to <depth> levels of child nodes including root-nodes
     // Must be greater than zero
     const uint32_t MAX_HIERARCHICAL_DEPTH = 128;
+    // Slab allocator for instances and their trailing component user data.
+    // There is one size class per user data count. Free slots are linked through their first word,
+    // and the slabs are kept until the collection is deleted.
+    struct InstanceAllocator
+    {
+        static const uint32_t SIZE_CLASS_COUNT = 16;
+        static const uint32_t SLAB_INSTANCE_COUNT = 32;
+
+        void*                    m_FreeLists[SIZE_CLASS_COUNT];
+        dmArray<void*>           m_Slabs;
+    };
+
+    enum ComponentFunction
+    {
+        COMPONENT_FUNCTION_UPDATE,
+        COMPONENT_FUNCTION_FIXED_UPDATE,
+        COMPONENT_FUNCTION_POST_UPDATE,
+        COMPONENT_FUNCTION_RENDER,
+        MAX_COMPONENT_FUNCTION_COUNT
+    };
+
+    // Accumulated cost of a component type during one frame (update, render and post update)
+    // The time is inclusive, e.g. a collection proxy includes the cost of its collection
+    struct ComponentTypeCost
+    {
+        uint32_t m_Time[MAX_COMPONENT_FUNCTION_COUNT];  // Microseconds
+        uint32_t m_Count[MAX_COMPONENT_FUNCTION_COUNT];
+    };
+
     struct Collection
     {
         Collection(dmResource::HFactory factory, HRegister regist, uint32_t max_instances, uint32_t max_input_stack_entries);
@@ -237,6 +285,9 @@ namespace dmGameObject
         // Index pool for mapping Instance::m_Index to m_Instances
         dmIndexPool16            m_InstanceIndices;
 
+        // Memory for the instances
+        InstanceAllocator        m_InstanceAllocator;
+
         // Resources referenced through property overrides inside the collection
         dmArray<void*>           m_PropertyResources;
 
@@ -250,6 +301,18 @@ namespace dmGameObject
         // Array of world transforms. Calculated using m_LevelIndices above
         dmArray<Matrix4>         m_WorldTransforms;
 
+        // Local transforms used when the world transforms were last calculated. Used to only recalculate changed subtrees
+        dmArray<dmTransform::Transform> m_PrevTransforms;
+        // TRANSFORM_FLAG_* per instance index
+        dmArray<uint8_t>         m_TransformFlags;
+        // The value of m_TransformVersion when the world transform was last written, per instance index
+        dmArray<uint32_t>        m_TransformVersions;
+        // Incremented by each UpdateTransforms (see GetTransformVersions)
+        uint32_t                 m_TransformVersion;
+
+        // Jobs for the current level in UpdateTransforms, and the number of those still running
+        dmArray<TransformJob>    m_TransformJobs;
+
         // Identifier to Instance mapping
         dmHashTable64<Instance*> m_IDToInstance;
 
@@ -259,6 +322,10 @@ namespace dmGameObject
         // Array of dynamically created resources (i.e runtime-only resources)
         dmArray<dmhash_t>        m_DynamicResources;
 
+        // Cost per component type (indexed as m_ComponentWorlds) of the current frame, and of the last completed frame
+        dmArray<ComponentTypeCost> m_ComponentTypeCosts;
+        dmArray<ComponentTypeCost> m_LastComponentTypeCosts;
+
         // Name-hash of the collection.
         dmhash_t                 m_NameHash;
 
@@ -286,6 +353,9 @@ namespace dmGameObject
 
         float                    m_FixedAccumTime;  // Accumulated time between fixed updates. Scaled time.
 
+        // Index of the next instance (in the collection desc) to create the components for, when the creation is deferred to the post create function
+        uint32_t                 m_PendingCreateIndex;
+
         // Set to 1 if in update-loop
         uint32_t                 m_InUpdate : 1;
         // Used for deferred deletion
@@ -295,6 +365,12 @@ namespace dmGameObject
         uint32_t                 m_DirtyTransforms : 1;
         uint32_t                 m_Initialized : 1;
         uint32_t                 m_FirstUpdate : 1;
+        // Set while the components of the instances are still being created (see m_PendingCreateIndex)
+        uint32_t                 m_PendingCreate : 1;
+        // Set if the last transform update of Update() is left to the caller (see SetDeferTransforms)
+        uint32_t                 m_DeferTransforms : 1;
+        // Set if there are cleared entries in m_LevelIndices (see ClearLevelIndex)
+        uint32_t                 m_LevelIndicesCleared : 1;
     };
 
     struct CollectionHandle
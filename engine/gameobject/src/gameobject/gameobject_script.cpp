@@ -15,12 +15,14 @@
 #include <assert.h>
 #include <string.h>
 #include <inttypes.h>
+#include <stdlib.h>
 
 #include <ddf/ddf.h>
 
 #include <dlib/log.h>
 #include <dlib/hash.h>
 #include <dlib/hashtable.h>
+#include <dlib/math.h>
 #include <dlib/message.h>
 #include <dlib/dstrings.h>
 #include <dlib/profile.h>
@@ -149,9 +151,11 @@ namespace dmGameObject
 
 #define SCRIPTINSTANCE "GOScriptInstance"
 #define SCRIPT "GOScript"
+#define PROPERTYHANDLE "GOPropertyHandle"
 
     static uint32_t SCRIPT_TYPE_HASH = 0;
     static uint32_t SCRIPTINSTANCE_TYPE_HASH = 0;
+    static uint32_t PROPERTYHANDLE_TYPE_HASH = 0;
 
     using namespace dmPropertiesDDF;
 
@@ -183,9 +187,12 @@ namespace dmGameObject
 
     CompScriptWorld::CompScriptWorld(uint32_t max_instance_count)
     : m_Instances()
+    , m_UpdateInstances()
     , m_ScriptWorld(0x0)
+    , m_UpdateInstancesDirty(0)
     {
         m_Instances.SetCapacity(max_instance_count);
+        m_UpdateInstances.SetCapacity(max_instance_count);
     }
 
     static Script* GetScript(lua_State *L)
@@ -400,13 +407,15 @@ namespace dmGameObject
      * only accepts instances in "this" collection. Otherwise a lua-error will be raised.
      * @param L lua state
      * @param instance_arg lua-arg
+     * @param trailing_args if true, the instance argument may also be followed by further (optional) arguments
      * @return instance handler
      */
-    static Instance* ResolveInstance(lua_State* L, int instance_arg)
+    static Instance* ResolveInstance(lua_State* L, int instance_arg, bool trailing_args = false)
     {
         ScriptInstance* i = ScriptInstance_Check(L);
         Instance* instance = i->m_Instance;
-        if (lua_gettop(L) == instance_arg && !lua_isnil(L, instance_arg)) {
+        int top = lua_gettop(L);
+        if ((top == instance_arg || (trailing_args && top > instance_arg)) && !lua_isnil(L, instance_arg)) {
             dmMessage::URL receiver;
             dmScript::ResolveURL(L, instance_arg, &receiver, 0x0);
             if (receiver.m_Socket != dmGameObject::GetMessageSocket(i->m_Instance->m_Collection->m_HCollection))
@@ -545,7 +554,147 @@ namespace dmGameObject
         return RESULT_OK;
     }
 
+    // A resolved go.get/go.set target, created with go.property_handle()
+    struct PropertyHandle
+    {
+        dmMessage::URL  m_Target;
+        dmhash_t        m_PropertyId;
+        // Cached lookup of m_Target.m_Path, validated against the collection on each use
+        Instance*       m_Instance;
+        uint32_t        m_InstanceIndex;
+    };
+
+    static PropertyHandle* ToPropertyHandle(lua_State* L, int index)
+    {
+        return (PropertyHandle*)dmScript::ToUserType(L, index, PROPERTYHANDLE_TYPE_HASH);
+    }
+
+    static Instance* ResolvePropertyHandle(lua_State* L, Collection* collection, PropertyHandle* handle)
+    {
+        if (handle->m_Target.m_Socket != collection->m_ComponentSocket)
+        {
+            luaL_error(L, "go property handles can only access instances within the same collection.");
+            return 0; // Actually never reached
+        }
+
+        // The cached instance is only used if it is still alive at the same index with the same id,
+        // otherwise the instance is looked up again (e.g. if it was deleted and respawned)
+        Instance* instance = handle->m_Instance;
+        if (handle->m_InstanceIndex >= collection->m_Instances.Size() ||
+            collection->m_Instances[handle->m_InstanceIndex] != instance ||
+            instance->m_Identifier != handle->m_Target.m_Path)
+        {
+            instance = GetInstanceFromIdentifier(collection, handle->m_Target.m_Path);
+            if (instance == 0)
+            {
+                DM_HASH_REVERSE_MEM(hash_ctx, 256);
+                luaL_error(L, "Could not find any instance with id '%s'.", dmHashReverseSafe64Alloc(&hash_ctx, handle->m_Target.m_Path));
+                return 0; // Actually never reached
+            }
+            handle->m_Instance = instance;
+            handle->m_InstanceIndex = instance->m_Index;
+        }
+        return instance;
+    }
+
+    static int PropertyHandle_tostring(lua_State* L)
+    {
+        PropertyHandle* handle = ToPropertyHandle(L, 1);
+        char buffer[256];
+        DM_HASH_REVERSE_MEM(hash_ctx, 256);
+        lua_pushfstring(L, "%s: %s[%s]", PROPERTYHANDLE, dmScript::UrlToString(&handle->m_Target, buffer, sizeof(buffer)), dmHashReverseSafe64Alloc(&hash_ctx, handle->m_PropertyId));
+        return 1;
+    }
+
+    static const luaL_reg PropertyHandle_meta[] =
+    {
+        {"__tostring", PropertyHandle_tostring},
+        {0, 0}
+    };
+
+    /*# creates a handle to a property of a game object or component
+     *
+     * Resolves the url and property once, and returns a handle that can be passed to
+     * [ref:go.get] and [ref:go.set] instead of the url and property id.
+     * This avoids looking up the target instance for each call, which is useful when
+     * the same property is read or written very often.
+     *
+     * If the target game object is deleted, the handle is resolved again by id on the next use,
+     * and the call fails if no game object with that id exists.
+     *
+     * @name go.property_handle
+     * @param url [type:string|hash|url] url of the game object or component having the property
+     * @param property [type:string|hash] id of the property
+     * @return handle [type:userdata] the property handle
+     * @examples
+     *
+     * ```lua
+     * function init(self)
+     *     self.tint = go.property_handle("#sprite", "tint")
+     * end
+     *
+     * function update(self, dt)
+     *     local tint = go.get(self.tint)
+     *     tint.w = tint.w * 0.99
+     *     go.set(self.tint, tint)
+     * end
+     * ```
+     */
+    static int Script_PropertyHandle(lua_State* L)
+    {
+        DM_LUA_STACK_CHECK(L, 1);
+
+        ScriptInstance* i = ScriptInstance_Check(L);
+        Instance* instance = i->m_Instance;
+        dmMessage::URL sender;
+        dmScript::GetURL(L, &sender);
+        dmMessage::URL target;
+        dmScript::ResolveURL(L, 1, &target, &sender);
+        DM_HASH_REVERSE_MEM(hash_ctx, 256);
+        if (target.m_Socket != dmGameObject::GetMessageSocket(instance->m_Collection->m_HCollection))
+        {
+            return luaL_error(L, "go.property_handle can only access instances within the same collection.");
+        }
+        dmhash_t property_id = 0;
+        if (lua_isstring(L, 2))
+        {
+            property_id = dmHashString64(lua_tostring(L, 2));
+        }
+        else
+        {
+            property_id = dmScript::CheckHash(L, 2);
+        }
+        dmGameObject::HInstance target_instance = dmGameObject::GetInstanceFromIdentifier(dmGameObject::GetCollection(instance), target.m_Path);
+        if (target_instance == 0)
+        {
+            return luaL_error(L, "Could not find any instance with id '%s'.", dmHashReverseSafe64Alloc(&hash_ctx, target.m_Path));
+        }
+
+        dmGameObject::PropertyOptions property_options = {};
+        dmGameObject::PropertyDesc property_desc;
+        dmGameObject::PropertyResult result = dmGameObject::GetProperty(target_instance, target.m_Fragment, property_id, property_options, property_desc);
+        if (result == dmGameObject::PROPERTY_RESULT_NOT_FOUND)
+        {
+            return luaL_error(L, "'%s' does not have any property called '%s'", dmHashReverseSafe64Alloc(&hash_ctx, target.m_Path), dmHashReverseSafe64Alloc(&hash_ctx, property_id));
+        }
+        else if (result == dmGameObject::PROPERTY_RESULT_COMP_NOT_FOUND)
+        {
+            return luaL_error(L, "could not find component '%s' when resolving '%s'", dmHashReverseSafe64Alloc(&hash_ctx, target.m_Fragment), dmHashReverseSafe64Alloc(&hash_ctx, target.m_Path));
+        }
+
+        PropertyHandle* handle = (PropertyHandle*)lua_newuserdata(L, sizeof(PropertyHandle));
+        handle->m_Target = target;
+        handle->m_PropertyId = property_id;
+        handle->m_Instance = target_instance;
+        handle->m_InstanceIndex = target_instance->m_Index;
+        luaL_getmetatable(L, PROPERTYHANDLE);
+        lua_setmetatable(L, -2);
+        return 1;
+    }
+
     /*# gets a named property of the specified game object or component
+     *
+     * The url and property may also be replaced by a single handle created with [ref:go.property_handle].
      *
      * @name go.get
      * @param url [type:string|hash|url] url of the game object or component having the property
@@ -608,28 +757,42 @@ namespace dmGameObject
     {
         ScriptInstance* i = ScriptInstance_Check(L);
         Instance* instance = i->m_Instance;
-        dmMessage::URL sender;
-        dmScript::GetURL(L, &sender);
         dmMessage::URL target;
-        dmScript::ResolveURL(L, 1, &target, &sender);
-        DM_HASH_REVERSE_MEM(hash_ctx, 256);
-        if (target.m_Socket != dmGameObject::GetMessageSocket(i->m_Instance->m_Collection->m_HCollection))
-        {
-            return luaL_error(L, "go.get can only access instances within the same collection.");
-        }
         dmhash_t property_id = 0;
-        if (lua_isstring(L, 2))
+        dmGameObject::HInstance target_instance = 0;
+        int options_index = 3;
+
+        PropertyHandle* handle = ToPropertyHandle(L, 1);
+        if (handle)
         {
-            property_id = dmHashString64(lua_tostring(L, 2));
+            target_instance = ResolvePropertyHandle(L, instance->m_Collection, handle);
+            target = handle->m_Target;
+            property_id = handle->m_PropertyId;
+            options_index = 2;
         }
         else
         {
-            property_id = dmScript::CheckHash(L, 2);
-        }
-        dmGameObject::HInstance target_instance = dmGameObject::GetInstanceFromIdentifier(dmGameObject::GetCollection(instance), target.m_Path);
-        if (target_instance == 0)
-        {
-            return luaL_error(L, "Could not find any instance with id '%s'.", dmHashReverseSafe64Alloc(&hash_ctx, target.m_Path));
+            dmMessage::URL sender;
+            dmScript::GetURL(L, &sender);
+            dmScript::ResolveURL(L, 1, &target, &sender);
+            DM_HASH_REVERSE_MEM(hash_ctx, 256);
+            if (target.m_Socket != dmGameObject::GetMessageSocket(i->m_Instance->m_Collection->m_HCollection))
+            {
+                return luaL_error(L, "go.get can only access instances within the same collection.");
+            }
+            if (lua_isstring(L, 2))
+            {
+                property_id = dmHashString64(lua_tostring(L, 2));
+            }
+            else
+            {
+                property_id = dmScript::CheckHash(L, 2);
+            }
+            target_instance = dmGameObject::GetInstanceFromIdentifier(dmGameObject::GetCollection(instance), target.m_Path);
+            if (target_instance == 0)
+            {
+                return luaL_error(L, "Could not find any instance with id '%s'.", dmHashReverseSafe64Alloc(&hash_ctx, target.m_Path));
+            }
         }
 
         dmGameObject::PropertyOptions property_options;
@@ -638,9 +801,9 @@ namespace dmGameObject
         bool index_requested = false;
 
         // Options table
-        if (lua_gettop(L) > 2)
+        if (lua_gettop(L) >= options_index)
         {
-            dmGameObject::LuaToPropertyOptions(L, 3, &property_options, property_id, &index_requested);
+            dmGameObject::LuaToPropertyOptions(L, options_index, &property_options, property_id, &index_requested);
         }
         dmGameObject::PropertyDesc property_desc;
         dmGameObject::PropertyResult result = dmGameObject::GetProperty(target_instance, target.m_Fragment, property_id, property_options, property_desc);
@@ -742,6 +905,8 @@ namespace dmGameObject
     }
 
     /*# sets a named property of the specified game object or component, or a material constant
+     *
+     * The url and property may also be replaced by a single handle created with [ref:go.property_handle].
      *
      * @name go.set
      * @param url [type:string|hash|url] url of the game object or component having the property
@@ -804,44 +969,58 @@ namespace dmGameObject
         DM_HASH_REVERSE_MEM(hash_ctx, 256);
         ScriptInstance* i = ScriptInstance_Check(L);
         Instance* instance = i->m_Instance;
-        dmMessage::URL sender;
-        dmScript::GetURL(L, &sender);
         dmMessage::URL target;
-        dmScript::ResolveURL(L, 1, &target, &sender);
-        if (target.m_Socket != dmGameObject::GetMessageSocket(i->m_Instance->m_Collection->m_HCollection))
-        {
-            luaL_error(L, "go.set can only access instances within the same collection.");
-        }
         dmhash_t property_id = 0;
+        dmGameObject::HInstance target_instance = 0;
+        int value_index = 3;
 
-        if (lua_isstring(L, 2))
+        PropertyHandle* handle = ToPropertyHandle(L, 1);
+        if (handle)
         {
-            property_id = dmHashString64(lua_tostring(L, 2));
+            target_instance = ResolvePropertyHandle(L, instance->m_Collection, handle);
+            target = handle->m_Target;
+            property_id = handle->m_PropertyId;
+            value_index = 2;
         }
         else
         {
-            property_id = dmScript::CheckHash(L, 2);
-        }
+            dmMessage::URL sender;
+            dmScript::GetURL(L, &sender);
+            dmScript::ResolveURL(L, 1, &target, &sender);
+            if (target.m_Socket != dmGameObject::GetMessageSocket(i->m_Instance->m_Collection->m_HCollection))
+            {
+                luaL_error(L, "go.set can only access instances within the same collection.");
+            }
 
-        dmGameObject::HInstance target_instance = dmGameObject::GetInstanceFromIdentifier(dmGameObject::GetCollection(instance), target.m_Path);
-        if (target_instance == 0)
-        {
-            return luaL_error(L, "could not find any instance with id '%s'.", dmHashReverseSafe64Alloc(&hash_ctx, target.m_Path));
+            if (lua_isstring(L, 2))
+            {
+                property_id = dmHashString64(lua_tostring(L, 2));
+            }
+            else
+            {
+                property_id = dmScript::CheckHash(L, 2);
+            }
+
+            target_instance = dmGameObject::GetInstanceFromIdentifier(dmGameObject::GetCollection(instance), target.m_Path);
+            if (target_instance == 0)
+            {
+                return luaL_error(L, "could not find any instance with id '%s'.", dmHashReverseSafe64Alloc(&hash_ctx, target.m_Path));
+            }
         }
 
         dmGameObject::PropertyOptions property_options = {};
-        if (lua_gettop(L) > 3)
+        if (lua_gettop(L) > value_index)
         {
-            int options_result = LuaToPropertyOptions(L, 4, &property_options, property_id, 0);
+            int options_result = LuaToPropertyOptions(L, value_index + 1, &property_options, property_id, 0);
             if (options_result != 0)
             {
                 return options_result;
             }
         }
 
-        if (lua_istable(L, 3))
+        if (lua_istable(L, value_index))
         {
-            lua_pushvalue(L, 3);
+            lua_pushvalue(L, value_index);
             lua_pushnil(L);
             while (lua_next(L, -2) != 0)
             {
@@ -878,7 +1057,7 @@ namespace dmGameObject
         else
         {
             dmGameObject::PropertyVar property_var;
-            dmGameObject::PropertyResult result = dmGameObject::LuaToVar(L, 3, property_var);
+            dmGameObject::PropertyResult result = dmGameObject::LuaToVar(L, value_index, property_var);
 
             if (result == PROPERTY_RESULT_OK)
             {
@@ -897,6 +1076,7 @@ namespace dmGameObject
      * @name go.get_position
      * @replaces request_transform transform_response
      * @param [id] [type:string|hash|url] optional id of the game object instance to get the position for, by default the instance of the calling script
+     * @param [out] [type:vector3] optional vector to store the position in, instead of allocating a new vector
      * @return position [type:vector3] instance position
      * @examples
      *
@@ -911,11 +1091,36 @@ namespace dmGameObject
      * ```lua
      * local pos = go.get_position("my_gameobject")
      * ```
+     *
+     * Read the position every frame into the same vector, without creating garbage:
+     *
+     * ```lua
+     * function init(self)
+     *     self.pos = vmath.vector3()
+     * end
+     *
+     * function update(self, dt)
+     *     go.get_position(nil, self.pos)
+     * end
+     * ```
      */
+    // Stores the value in the optional vector3 at out_index and pushes it, or pushes a new vector3
+    static void PushVector3Out(lua_State* L, int out_index, const dmVMath::Vector3& value)
+    {
+        if (lua_isnoneornil(L, out_index))
+        {
+            dmScript::PushVector3(L, value);
+            return;
+        }
+        dmVMath::Vector3* out = dmScript::CheckVector3(L, out_index);
+        *out = value;
+        lua_pushvalue(L, out_index);
+    }
+
     int Script_GetPosition(lua_State* L)
     {
-        Instance* instance = ResolveInstance(L, 1);
-        dmScript::PushVector3(L, dmVMath::Vector3(dmGameObject::GetPosition(instance)));
+        Instance* instance = ResolveInstance(L, 1, true);
+        PushVector3Out(L, 2, dmVMath::Vector3(dmGameObject::GetPosition(instance)));
         return 1;
     }
 
@@ -1279,6 +1484,7 @@ namespace dmGameObject
      *
      * @name go.get_world_position
      * @param [id] [type:string|hash|url] optional id of the game object instance to get the world position for, by default the instance of the calling script
+     * @param [out] [type:vector3] optional vector to store the world position in, instead of allocating a new vector
      * @return position [type:vector3] instance world position
      * @examples
      *
@@ -1296,8 +1502,8 @@ namespace dmGameObject
      */
     int Script_GetWorldPosition(lua_State* L)
     {
-        Instance* instance = ResolveInstance(L, 1);
-        dmScript::PushVector3(L, dmVMath::Vector3(dmGameObject::GetWorldPosition(instance)));
+        Instance* instance = ResolveInstance(L, 1, true);
+        PushVector3Out(L, 2, dmVMath::Vector3(dmGameObject::GetWorldPosition(instance)));
         return 1;
     }
 
@@ -2156,10 +2362,139 @@ namespace dmGameObject
         return 1;
     }
 
+    /*# only receive input for specific actions
+     * Restricts the calls to `on_input` of the current script to the given action ids.
+     * Actions not in the list are not passed to the script, and are not consumed by it,
+     * which saves the call into Lua when the script has nothing to do for them.
+     * The filter does not change the input focus, use `acquire_input_focus` for that.
+     *
+     * @name go.set_input_filter
+     * @param action_ids [type:table|nil] a list of action ids (hashes or strings) to receive, or `nil` to receive all actions again
+     * @param [movement] [type:boolean] if pointer movement without an action (`action_id` is `nil`) should be received. Defaults to `false`.
+     *
+     * @examples
+     *
+     * ```lua
+     * function init(self)
+     *     msg.post(".", "acquire_input_focus")
+     *     go.set_input_filter({ hash("jump"), "fire" })
+     * end
+     * ```
+     */
+    static int Script_SetInputFilter(lua_State* L)
+    {
+        DM_LUA_STACK_CHECK(L, 0);
+        ScriptInstance* i = ScriptInstance_Check(L);
+
+        free(i->m_InputFilter);
+        i->m_InputFilter = 0;
+        i->m_InputFilterCount = 0;
+        i->m_InputFilterSet = 0;
+        i->m_InputMovement = 0;
+
+        if (lua_isnoneornil(L, 1))
+        {
+            return 0;
+        }
+
+        luaL_checktype(L, 1, LUA_TTABLE);
+        uint32_t count = lua_objlen(L, 1);
+        if (count > 0xffff)
+        {
+            return DM_LUA_ERROR("Too many action ids in the input filter (%u), max is %u", count, 0xffff);
+        }
+
+        dmhash_t* action_ids = (dmhash_t*) malloc(dmMath::Max(1u, count) * sizeof(dmhash_t));
+        for (uint32_t n = 0; n < count; ++n)
+        {
+            lua_rawgeti(L, 1, n + 1);
+            if (!dmScript::IsHash(L, -1) && !lua_isstring(L, -1))
+            {
+                lua_pop(L, 1);
+                free(action_ids);
+                return DM_LUA_ERROR("The input filter can only contain hashes or strings");
+            }
+            action_ids[n] = dmScript::CheckHashOrString(L, -1);
+            lua_pop(L, 1);
+        }
+
+        i->m_InputFilter = action_ids;
+        i->m_InputFilterCount = (uint16_t) count;
+        i->m_InputFilterSet = 1;
+        i->m_InputMovement = lua_toboolean(L, 2);
+        return 0;
+    }
+
+    static void PushComponentTypeStats(void* ctx, const char* collection_name, const ComponentTypeStats* stats)
+    {
+        lua_State* L = (lua_State*)ctx;
+        lua_newtable(L);
+        lua_pushstring(L, collection_name);
+        lua_setfield(L, -2, "collection");
+        lua_pushstring(L, stats->m_TypeName);
+        lua_setfield(L, -2, "type");
+        lua_pushnumber(L, stats->m_UpdateTime / 1000.0);
+        lua_setfield(L, -2, "update");
+        lua_pushnumber(L, stats->m_FixedUpdateTime / 1000.0);
+        lua_setfield(L, -2, "fixed_update");
+        lua_pushnumber(L, stats->m_PostUpdateTime / 1000.0);
+        lua_setfield(L, -2, "post_update");
+        lua_pushnumber(L, stats->m_RenderTime / 1000.0);
+        lua_setfield(L, -2, "render");
+        lua_pushinteger(L, stats->m_UpdateCount);
+        lua_setfield(L, -2, "update_count");
+        lua_pushinteger(L, stats->m_FixedUpdateCount);
+        lua_setfield(L, -2, "fixed_update_count");
+        lua_pushinteger(L, stats->m_PostUpdateCount);
+        lua_setfield(L, -2, "post_update_count");
+        lua_pushinteger(L, stats->m_RenderCount);
+        lua_setfield(L, -2, "render_count");
+        lua_rawseti(L, -2, lua_objlen(L, -2) + 1);
+    }
+
+    /*# get the cost of each component type during the last frame
+     * Returns the time spent in the update, fixed update, post update and render functions
+     * of each component type, for each loaded collection. The times of a collection proxy
+     * include the collection it has loaded.
+     *
+     * @name go.get_component_stats
+     * @return stats [type:table] a list of tables with the following fields:
+     *
+     * `collection`
+     * : [type:string] the name of the collection
+     *
+     * `type`
+     * : [type:string] the component type, e.g. "sprite"
+     *
+     * `update`, `fixed_update`, `post_update`, `render`
+     * : [type:number] the time spent in the functions, in milliseconds
+     *
+     * `update_count`, `fixed_update_count`, `post_update_count`, `render_count`
+     * : [type:number] the number of calls to the functions
+     *
+     * @examples
+     *
+     * ```lua
+     * for _, stats in ipairs(go.get_component_stats()) do
+     *     if stats.update > 1 then
+     *         print(stats.collection, stats.type, stats.update)
+     *     end
+     * end
+     * ```
+     */
+    static int Script_GetComponentStats(lua_State* L)
+    {
+        DM_LUA_STACK_CHECK(L, 1);
+        lua_newtable(L);
+        IterateComponentTypeStats(g_Register, PushComponentTypeStats, L);
+        return 1;
+    }
+
     static const luaL_reg GO_methods[] =
     {
         {"get",                     Script_Get},
         {"set",                     Script_Set},
+        {"property_handle",         Script_PropertyHandle},
         {"get_position",            Script_GetPosition},
         {"get_rotation",            Script_GetRotation},
         {"get_scale",               Script_GetScale},
@@ -2184,6 +2519,8 @@ namespace dmGameObject
         {"exists",                  Script_Exists},
         {"world_to_local_position", Script_WorldToLocalPosition},
         {"world_to_local_transform",Script_WorldToLocalTransfrom},
+        {"get_component_stats",     Script_GetComponentStats},
+        {"set_input_filter",        Script_SetInputFilter},
         {0, 0}
     };
 
@@ -2200,6 +2537,8 @@ namespace dmGameObject
 
         SCRIPTINSTANCE_TYPE_HASH = dmScript::RegisterUserType(L, SCRIPTINSTANCE, ScriptInstance_methods, ScriptInstance_meta);
 
+        PROPERTYHANDLE_TYPE_HASH = dmScript::RegisterUserTypeLocal(L, PROPERTYHANDLE, PropertyHandle_meta);
+
         luaL_register(L, "go", GO_methods);
 
 #define SETPLAYBACK(name) \
@@ -2559,12 +2898,35 @@ bail:
         dmScript::Unref(L, LUA_REGISTRYINDEX, script_instance->m_ScriptDataReference);
 
         DeleteProperties(script_instance->m_Properties);
+        free(script_instance->m_InputFilter);
         script_instance->~ScriptInstance();
         ResetScriptInstance(script_instance);
 
         assert(top == lua_gettop(L));
     }
 
+    bool ScriptInstanceWantsInput(HScriptInstance script_instance, dmhash_t action_id)
+    {
+        if (!script_instance->m_InputFilterSet)
+        {
+            return true;
+        }
+        // 0 is reserved for pure mouse movement
+        if (action_id == 0)
+        {
+            return script_instance->m_InputMovement;
+        }
+        const dmhash_t* action_ids = script_instance->m_InputFilter;
+        for (uint32_t i = 0; i < script_instance->m_InputFilterCount; ++i)
+        {
+            if (action_ids[i] == action_id)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
 #define CHECK_PROP_RESULT(key, type, expected_type, result)\
     if (result == PROPERTY_RESULT_OK) {\
         if (type != expected_type) {\
@@ -2820,6 +3182,7 @@ bail:
      * `screen_dx` | The change in screen space x value of a pointer device, if present.
      * `screen_dy` | The change in screen space y value of a pointer device, if present.
      * `gamepad`   | The index of the gamepad device that provided the input.
+     * `time`      | When the input was sampled, in seconds (same clock as `socket.gettime()`).
      * `touch`     | List of touch input, one element per finger, if present. See table below about touch input
      *
      * Touch input table:
@@ -79,9 +79,14 @@ namespace dmGameObject
         int         m_ContextTableReference;
         uint16_t    m_ComponentIndex;
         HProperties m_Properties;
-        uint8_t    m_Update       : 1;
-        uint8_t    m_Initialized  : 1;
-        uint8_t    m_Padding      : 6;
+        // The action ids set with go.set_input_filter(), only valid if m_InputFilterSet is set
+        dmhash_t*   m_InputFilter;
+        uint16_t    m_InputFilterCount;
+        uint8_t    m_Update         : 1;
+        uint8_t    m_Initialized    : 1;
+        uint8_t    m_InputFilterSet : 1;
+        uint8_t    m_InputMovement  : 1;
+        uint8_t    m_Padding        : 4;
     };
 
     struct CompScriptWorld
@@ -89,7 +94,10 @@ namespace dmGameObject
         CompScriptWorld(uint32_t max_instance_count);
 
         dmArray<ScriptInstance*> m_Instances;
+        // The instances with an update or fixed_update function, grouped by script
+        dmArray<ScriptInstance*> m_UpdateInstances;
         dmScript::HScriptWorld m_ScriptWorld;
+        uint8_t                m_UpdateInstancesDirty : 1; // If m_UpdateInstances needs to be grouped again
     };
 
     void    InitializeScript(HRegister regist, dmScript::HContext context);
@@ -101,6 +109,9 @@ namespace dmGameObject
     HScriptInstance NewScriptInstance(CompScriptWorld* script_world, HScript script, HInstance instance, uint16_t component_index);
     void            DeleteScriptInstance(HScriptInstance script_instance);
 
+    // Returns false if the script instance has an input filter, and the action isn't in it
+    bool            ScriptInstanceWantsInput(HScriptInstance script_instance, dmhash_t action_id);
+
     PropertyResult PropertiesToLuaTable(HInstance instance, HScript script, const HProperties properties, lua_State* L, int index);
 }
 
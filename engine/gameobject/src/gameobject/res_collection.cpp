@@ -15,6 +15,7 @@
 #include <dmsdk/resource/resource.h>
 #include <dlib/dstrings.h>
 #include <dlib/log.h>
+#include <dlib/time.h>
 
 #include "gameobject.h"
 #include "gameobject_private.h"
@@ -26,7 +27,105 @@
 
 namespace dmGameObject
 {
-    static dmResource::Result AcquireResources(const char* name, dmResource::HFactory factory, dmGameObject::HRegister regist, dmGameObjectDDF::CollectionDesc* collection_desc, const char* filename, HCollection* out_hcollection)
+    static HInstance GetDescInstance(Collection* collection, const dmGameObjectDDF::InstanceDesc& instance_desc)
+    {
+        return dmGameObject::GetInstanceFromIdentifier(collection, dmHashString64(instance_desc.m_Id));
+    }
+
+    // Creates the components of the instance and sets the properties of the collection desc on them
+    static dmResource::Result CreateInstanceComponents(Collection* collection, const dmGameObjectDDF::InstanceDesc& instance_desc, const char* filename)
+    {
+        dmGameObject::HInstance instance = GetDescInstance(collection, instance_desc);
+
+        bool result = dmGameObject::CreateComponents(collection, instance);
+        if (!result)
+        {
+            dmGameObject::ReleaseIdentifier(collection, instance);
+            dmGameObject::UndoNewInstance(collection, instance);
+            return dmResource::RESULT_FORMAT_ERROR;
+        }
+
+        // Set properties
+        uint32_t component_instance_data_index = 0;
+        Prototype::Component* components = instance->m_Prototype->m_Components;
+        uint32_t comp_count = instance->m_Prototype->m_ComponentCount;
+        for (uint32_t comp_i = 0; comp_i < comp_count; ++comp_i)
+        {
+            Prototype::Component& component = components[comp_i];
+            ComponentType* type = component.m_Type;
+            if (type->m_SetPropertiesFunction != 0x0)
+            {
+                if (!type->m_InstanceHasUserData)
+                {
+                    DM_HASH_REVERSE_MEM(hash_ctx, 256);
+                    dmLogError("Unable to set properties for the component '%s' in game object '%s' since it has no ability to store them.", dmHashReverseSafe64Alloc(&hash_ctx, component.m_Id), instance_desc.m_Id);
+                    return dmResource::RESULT_FORMAT_ERROR;
+                }
+                ComponentSetPropertiesParams set_params;
+                set_params.m_Instance = instance;
+                uint32_t comp_prop_count = instance_desc.m_ComponentProperties.m_Count;
+                for (uint32_t prop_i = 0; prop_i < comp_prop_count; ++prop_i)
+                {
+                    const dmGameObjectDDF::ComponentPropertyDesc& comp_prop = instance_desc.m_ComponentProperties[prop_i];
+                    if (dmHashString64(comp_prop.m_Id) == component.m_Id)
+                    {
+                        set_params.m_PropertySet.m_UserData = (uintptr_t)PropertyContainerCreateFromDDF(&comp_prop.m_PropertyDecls);
+                        if (set_params.m_PropertySet.m_UserData == 0x0)
+                        {
+                            dmLogError("Could not read properties of game object '%s' in collection %s.", instance_desc.m_Id, filename);
+                            return dmResource::RESULT_FORMAT_ERROR;
+                        }
+                        else
+                        {
+                            set_params.m_PropertySet.m_GetPropertyCallback = PropertyContainerGetPropertyCallback;
+                            set_params.m_PropertySet.m_FreeUserDataCallback = PropertyContainerDestroyCallback;
+                        }
+                        break;
+                    }
+                }
+                uintptr_t* component_instance_data = &instance->m_ComponentInstanceUserData[component_instance_data_index];
+                set_params.m_UserData = component_instance_data;
+                type->m_SetPropertiesFunction(set_params);
+            }
+            if (component.m_Type->m_InstanceHasUserData)
+                ++component_instance_data_index;
+        }
+        return dmResource::RESULT_OK;
+    }
+
+    // Creates the components of the instances [start, end), until the deadline (if non zero) has passed.
+    // At least one instance is created per call, so that the creation always progresses.
+    // On failure, the instances without components are removed, so that the collection can be deleted safely.
+    static dmResource::Result CreateCollectionComponents(Collection* collection, dmGameObjectDDF::CollectionDesc* collection_desc, const char* filename, uint32_t end, uint64_t deadline)
+    {
+        uint32_t start = collection->m_PendingCreateIndex;
+        uint32_t i = start;
+        while (i < end)
+        {
+            if (i != start && deadline != 0 && dmTime::GetTime() >= deadline)
+            {
+                break;
+            }
+
+            const dmGameObjectDDF::InstanceDesc& instance_desc = collection_desc->m_Instances[i++];
+            dmResource::Result res = CreateInstanceComponents(collection, instance_desc, filename);
+            if (res != dmResource::RESULT_OK)
+            {
+                for (; i < end; ++i)
+                {
+                    dmGameObject::HInstance instance = GetDescInstance(collection, collection_desc->m_Instances[i]);
+                    dmGameObject::ReleaseIdentifier(collection, instance);
+                    dmGameObject::UndoNewInstance(collection, instance);
+                }
+                collection->m_PendingCreateIndex = end;
+                return res;
+            }
+        }
+        collection->m_PendingCreateIndex = i;
+        return dmResource::RESULT_OK;
+    }
+
+    static dmResource::Result AcquireResources(const char* name, dmResource::HFactory factory, dmGameObject::HRegister regist, dmGameObjectDDF::CollectionDesc* collection_desc, const char* filename, bool create_components, HCollection* out_hcollection)
     {
         // NOTE: Be careful about control flow. See below with dmMutex::Unlock, return, etc
         dmResource::Result res = dmResource::RESULT_OK;
@@ -132,68 +231,20 @@ namespace dmGameObject
 
         dmGameObject::UpdateTransforms(collection);
 
-        // Create components and set properties
-        for (uint32_t i = 0; i < created_instances; ++i)
+        // Create components and set properties. When deferred, it's done by the post create function instead
+        if (create_components || res != dmResource::RESULT_OK)
         {
-            const dmGameObjectDDF::InstanceDesc& instance_desc = collection_desc->m_Instances[i];
-
-            dmGameObject::HInstance instance = dmGameObject::GetInstanceFromIdentifier(collection, dmHashString64(instance_desc.m_Id));
-
-            bool result = dmGameObject::CreateComponents(collection, instance);
-            if (result) {
-                // Set properties
-                uint32_t component_instance_data_index = 0;
-                Prototype::Component* components = instance->m_Prototype->m_Components;
-                uint32_t comp_count = instance->m_Prototype->m_ComponentCount;
-                for (uint32_t comp_i = 0; comp_i < comp_count; ++comp_i)
-                {
-                    Prototype::Component& component = components[comp_i];
-                    ComponentType* type = component.m_Type;
-                    if (type->m_SetPropertiesFunction != 0x0)
-                    {
-                        if (!type->m_InstanceHasUserData)
-                        {
-                            DM_HASH_REVERSE_MEM(hash_ctx, 256);
-                            dmLogError("Unable to set properties for the component '%s' in game object '%s' since it has no ability to store them.", dmHashReverseSafe64Alloc(&hash_ctx, component.m_Id), instance_desc.m_Id);
-                            res = dmResource::RESULT_FORMAT_ERROR;
-                            goto bail;
-                        }
-                        ComponentSetPropertiesParams set_params;
-                        set_params.m_Instance = instance;
-                        uint32_t comp_prop_count = instance_desc.m_ComponentProperties.m_Count;
-                        for (uint32_t prop_i = 0; prop_i < comp_prop_count; ++prop_i)
-                        {
-                            const dmGameObjectDDF::ComponentPropertyDesc& comp_prop = instance_desc.m_ComponentProperties[prop_i];
-                            if (dmHashString64(comp_prop.m_Id) == component.m_Id)
-                            {
-                                set_params.m_PropertySet.m_UserData = (uintptr_t)PropertyContainerCreateFromDDF(&comp_prop.m_PropertyDecls);
-                                if (set_params.m_PropertySet.m_UserData == 0x0)
-                                {
-                                    dmLogError("Could not read properties of game object '%s' in collection %s.", instance_desc.m_Id, filename);
-                                    res = dmResource::RESULT_FORMAT_ERROR;
-                                    goto bail;
-                                }
-                                else
-                                {
-                                    set_params.m_PropertySet.m_GetPropertyCallback = PropertyContainerGetPropertyCallback;
-                                    set_params.m_PropertySet.m_FreeUserDataCallback = PropertyContainerDestroyCallback;
-                                }
-                                break;
-                            }
-                        }
-                        uintptr_t* component_instance_data = &instance->m_ComponentInstanceUserData[component_instance_data_index];
-                        set_params.m_UserData = component_instance_data;
-                        type->m_SetPropertiesFunction(set_params);
-                    }
-                    if (component.m_Type->m_InstanceHasUserData)
-                        ++component_instance_data_index;
-                }
-            } else {
-                dmGameObject::ReleaseIdentifier(collection, instance);
-                dmGameObject::UndoNewInstance(collection, instance);
-                res = dmResource::RESULT_FORMAT_ERROR;
+            dmResource::Result create_res = CreateCollectionComponents(collection, collection_desc, filename, created_instances, 0);
+            if (res == dmResource::RESULT_OK)
+            {
+                res = create_res;
             }
         }
+        else
+        {
+            collection->m_PendingCreateIndex = 0;
+            collection->m_PendingCreate = 1;
+        }
 
         if (collection_desc->m_CollectionInstances.m_Count != 0)
             dmLogError("Sub collections must be merged before loading.");
@@ -257,9 +308,15 @@ bail:
         Register* regist = (Register*) params->m_Context;
         dmGameObjectDDF::CollectionDesc* collection_desc = (dmGameObjectDDF::CollectionDesc*) params->m_PreloadData;
 
+        // With a deadline set, the components are created by the post create function, possibly over several frames
+        bool create_components = regist->m_CollectionCreateDeadline == 0;
+
         HCollection hcollection = 0;
-        dmResource::Result res = AcquireResources(collection_desc->m_Name, params->m_Factory, regist, collection_desc, params->m_Filename, &hcollection);
-        dmDDF::FreeMessage(collection_desc);
+        dmResource::Result res = AcquireResources(collection_desc->m_Name, params->m_Factory, regist, collection_desc, params->m_Filename, create_components, &hcollection);
+        if (res != dmResource::RESULT_OK || create_components)
+        {
+            dmDDF::FreeMessage(collection_desc);
+        }
 
         if (res != dmResource::RESULT_OK)
         {
@@ -271,6 +328,31 @@ bail:
         return res;
     }
 
+    static dmResource::Result ResCollectionPostCreate(const dmResource::ResourcePostCreateParams* params)
+    {
+        HCollection hcollection = (HCollection) ResourceDescriptorGetResource(params->m_Resource);
+        Collection* collection = hcollection->m_Collection;
+        if (!collection->m_PendingCreate)
+        {
+            return dmResource::RESULT_OK; // The preload data has already been freed
+        }
+
+        Register* regist = (Register*) params->m_Context;
+        dmGameObjectDDF::CollectionDesc* collection_desc = (dmGameObjectDDF::CollectionDesc*) params->m_PreloadData;
+        uint32_t instance_count = collection_desc->m_Instances.m_Count;
+
+        dmResource::Result res = CreateCollectionComponents(collection, collection_desc, params->m_Filename, instance_count, regist->m_CollectionCreateDeadline);
+        if (res == dmResource::RESULT_OK && collection->m_PendingCreateIndex < instance_count)
+        {
+            return dmResource::RESULT_PENDING;
+        }
+
+        collection->m_PendingCreate = 0;
+        dmDDF::FreeMessage(collection_desc);
+        ResourceDescriptorSetResourceSize(params->m_Resource, CalcSize(collection));
+        return res;
+    }
+
     static dmResource::Result ResCollectionDestroy(const dmResource::ResourceDestroyParams* params)
     {
         HCollection hcollection = (HCollection) ResourceDescriptorGetResource(params->m_Resource);
@@ -300,7 +382,7 @@ bail:
         dmGameObject::DetachCollection(prev_collection);
 
         HCollection delete_hcollection = 0;
-        dmResource::Result res = AcquireResources(collection_desc->m_Name, params->m_Factory, regist, collection_desc, params->m_Filename, &delete_hcollection);
+        dmResource::Result res = AcquireResources(collection_desc->m_Name, params->m_Factory, regist, collection_desc, params->m_Filename, true, &delete_hcollection);
         if (dmResource::RESULT_OK == res)
         {
             // We cannot simply swap the HCollection, since that's the resource that has been handed out
@@ -364,7 +446,7 @@ bail:
                                                     context,
                                                     ResCollectionPreload,
                                                     ResCollectionCreate,
-                                                    0,
+                                                    ResCollectionPostCreate,
                                                     ResCollectionDestroy,
                                                     ResCollectionRecreate);
     }
@@ -508,6 +508,40 @@ TEST_F(AnimTest, LoadTest)
     }
 }
 
+// The easing curves are evaluated in batches per curve type, so the values must still end up at the right instances
+TEST_F(AnimTest, MixedEasing)
+{
+    const uint32_t count = 64;
+    m_UpdateContext.m_DT = 0.25f;
+    dmhash_t id = hash("position.x");
+    dmGameObject::PropertyVar var(10.0f);
+
+    dmGameObject::HInstance gos[count];
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        gos[i] = dmGameObject::New(m_Collection, "/dummy.goc");
+        dmEasing::Type type = (dmEasing::Type) (i % dmEasing::TYPE_FLOAT_VECTOR);
+        dmGameObject::PropertyResult result = Animate(m_Collection, gos[i], 0, id, dmGameObject::PLAYBACK_ONCE_FORWARD, var, dmEasing::Curve(type), 1.0f, 0.0f, AnimationStopped, this, 0x0);
+        ASSERT_EQ(dmGameObject::PROPERTY_RESULT_OK, result);
+    }
+
+    for (uint32_t frame = 1; frame <= 4; ++frame)
+    {
+        ASSERT_TRUE(dmGameObject::Update(m_Collection, &m_UpdateContext));
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            dmEasing::Type type = (dmEasing::Type) (i % dmEasing::TYPE_FLOAT_VECTOR);
+            ASSERT_NEAR(10.0f * dmEasing::GetValue(type, frame * 0.25f), X(gos[i]), 0.0001f);
+        }
+    }
+    ASSERT_EQ(count, this->m_FinishCount);
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        dmGameObject::Delete(m_Collection, gos[i], false);
+    }
+}
+
 TEST_F(AnimTest, LinkedList)
 {
     m_UpdateContext.m_DT = 0.25f;
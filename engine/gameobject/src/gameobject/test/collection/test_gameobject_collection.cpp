@@ -227,6 +227,38 @@ TEST_F(CollectionTest, Collection)
     }
 }
 
+TEST_F(CollectionTest, CollectionCreateDeadline)
+{
+    // With the deadline already passed, the components of one instance are created per post create call
+    dmResource::HPreloader pr = dmResource::NewPreloader(m_Factory, "/test.collectionc");
+    dmResource::Result r;
+    for (uint32_t i = 0; i < 1000; ++i)
+    {
+        dmGameObject::SetCollectionCreateDeadline(m_Register, 1);
+        r = dmResource::UpdatePreloader(pr, 0, 0, 0);
+        dmGameObject::SetCollectionCreateDeadline(m_Register, 0);
+        if (r != dmResource::RESULT_PENDING)
+            break;
+        dmTime::Sleep(1000);
+    }
+    ASSERT_EQ(dmResource::RESULT_OK, r);
+
+    dmGameObject::HCollection coll;
+    r = dmResource::Get(m_Factory, "/test.collectionc", (void**) &coll);
+    dmResource::DeletePreloader(pr);
+    ASSERT_EQ(dmResource::RESULT_OK, r);
+    ASSERT_EQ(0u, coll->m_Collection->m_PendingCreate);
+
+    ASSERT_NE((void*) 0, dmGameObject::GetInstanceFromIdentifier(coll, dmHashString64("/go1")));
+    ASSERT_NE((void*) 0, dmGameObject::GetInstanceFromIdentifier(coll, dmHashString64("/go2")));
+
+    ASSERT_TRUE(dmGameObject::Init(coll));
+    ASSERT_TRUE(dmGameObject::Update(coll, &m_UpdateContext));
+
+    dmResource::Release(m_Factory, (void*) coll);
+    dmGameObject::PostUpdate(m_Register);
+}
+
 TEST_F(CollectionTest, CollectionSpawning)
 {
     // NOTE: Coll is local and not m_Collection in CollectionTest
@@ -266,6 +298,78 @@ TEST_F(CollectionTest, CollectionSpawning)
     dmGameObject::PostUpdate(m_Register);
 }
 
+struct SpawnTemplateCompareContext
+{
+    dmGameObject::HCollection       m_Collection;
+    dmGameObject::InstanceIdMap*    m_Other;
+    uint32_t                        m_Mismatches;
+};
+
+static void CompareSpawnedInstance(SpawnTemplateCompareContext* ctx, const dmhash_t* id, dmhash_t* new_id)
+{
+    dmhash_t* other_id = ctx->m_Other->Get(*id);
+    if (!other_id)
+    {
+        ctx->m_Mismatches++;
+        return;
+    }
+    dmGameObject::HInstance a = dmGameObject::GetInstanceFromIdentifier(ctx->m_Collection, *new_id);
+    dmGameObject::HInstance b = dmGameObject::GetInstanceFromIdentifier(ctx->m_Collection, *other_id);
+    if (!a || !b || a == b ||
+        (dmGameObject::GetParent(a) == 0) != (dmGameObject::GetParent(b) == 0) ||
+        dmVMath::Length(dmGameObject::GetWorldPosition(a) - dmGameObject::GetWorldPosition(b)) > 0.001f)
+    {
+        ctx->m_Mismatches++;
+    }
+}
+
+TEST_F(CollectionTest, CollectionSpawningTemplate)
+{
+    dmGameObject::HCollection coll;
+    dmResource::Result r = dmResource::Get(m_Factory, "/empty.collectionc", (void**) &coll);
+    ASSERT_EQ(dmResource::RESULT_OK, r);
+    dmGameObject::Init(coll);
+
+    void *msg;
+    uint32_t msg_size;
+    r = dmResource::GetRaw(m_Factory, "/root1.collectionc", &msg, &msg_size);
+    ASSERT_EQ(dmResource::RESULT_OK, r);
+    dmGameObjectDDF::CollectionDesc* desc;
+    ASSERT_EQ(dmDDF::RESULT_OK, dmDDF::LoadMessage<dmGameObjectDDF::CollectionDesc>(msg, msg_size, &desc));
+
+    dmGameObject::HCollectionSpawnTemplate spawn_template = dmGameObject::NewCollectionSpawnTemplate(desc);
+    ASSERT_NE((void*) 0, spawn_template);
+
+    dmVMath::Point3 pos(10,20,30);
+    dmVMath::Quat rot(0,0,0,1);
+    dmVMath::Vector3 scale(2,2,2);
+
+    dmGameObject::InstancePropertyBuffers props;
+    dmGameObject::InstanceIdMap from_desc;
+    ASSERT_TRUE(dmGameObject::SpawnFromCollection(coll, (dmGameObject::HCollectionDesc) desc, &props, pos, rot, scale, &from_desc));
+
+    for (int i = 0; i < 10; ++i)
+    {
+        dmGameObject::InstanceIdMap from_template;
+        ASSERT_TRUE(dmGameObject::SpawnFromCollection(coll, spawn_template, &props, pos, rot, scale, &from_template));
+        ASSERT_EQ(from_desc.Size(), from_template.Size());
+
+        // The same instances and hierarchy as the spawn from the description
+        SpawnTemplateCompareContext ctx = { coll, &from_desc, 0 };
+        from_template.Iterate(CompareSpawnedInstance, &ctx);
+        ASSERT_EQ(0u, ctx.m_Mismatches);
+
+        ASSERT_TRUE(dmGameObject::Update(coll, &m_UpdateContext));
+    }
+
+    dmGameObject::DeleteCollectionSpawnTemplate(spawn_template);
+    dmDDF::FreeMessage(desc);
+    free(msg);
+
+    dmResource::Release(m_Factory, (void*) coll);
+    dmGameObject::PostUpdate(m_Register);
+}
+
 TEST_F(CollectionTest, CollectionSpawningToFail)
 {
     const uint32_t max = 100;
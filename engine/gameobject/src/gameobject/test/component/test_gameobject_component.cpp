@@ -15,6 +15,7 @@
 #include <jc_test/jc_test.h>
 
 #include <map>
+#include <string.h>
 
 #include <dlib/dstrings.h>
 #include <dlib/hash.h>
@@ -346,6 +347,59 @@ TEST_F(ComponentTest, TestUpdate)
     ASSERT_EQ((uint32_t) 1, m_ComponentDestroyCountMap[TestGameObjectDDF::AResource::m_DDFHash]);
 }
 
+struct ComponentStatsContext
+{
+    const char* m_CollectionName;
+    const char* m_TypeName;
+    uint32_t    m_CallbackCount;
+    dmGameObject::ComponentTypeStats m_Stats;
+};
+
+static void ComponentStatsCallback(void* ctx, const char* collection_name, const dmGameObject::ComponentTypeStats* stats)
+{
+    ComponentStatsContext* context = (ComponentStatsContext*)ctx;
+    if (strcmp(context->m_CollectionName, collection_name) == 0 && strcmp(context->m_TypeName, stats->m_TypeName) == 0)
+    {
+        context->m_CallbackCount++;
+        context->m_Stats = *stats;
+    }
+}
+
+TEST_F(ComponentTest, TestComponentTypeStats)
+{
+    // The collection from the fixture is created before the test component types are registered
+    dmGameObject::HCollection collection = dmGameObject::NewCollection("stats", m_Factory, m_Register, 1024, 0x0);
+    dmGameObject::HInstance go = dmGameObject::New(collection, "/go1.goc");
+    ASSERT_NE((void*) 0, (void*) go);
+    dmGameObject::Init(collection);
+
+    ComponentStatsContext ctx = {"stats", "a", 0};
+    dmGameObject::IterateComponentTypeStats(m_Register, ComponentStatsCallback, &ctx);
+    ASSERT_EQ(1u, ctx.m_CallbackCount);
+    ASSERT_EQ(0u, ctx.m_Stats.m_UpdateCount);
+
+    for (uint32_t i = 0; i < 2; ++i)
+    {
+        ASSERT_TRUE(dmGameObject::Update(collection, &m_UpdateContext));
+        ASSERT_TRUE(dmGameObject::PostUpdate(collection));
+    }
+
+    // Only the last frame is reported
+    ctx.m_CallbackCount = 0;
+    dmGameObject::IterateComponentTypeStats(m_Register, ComponentStatsCallback, &ctx);
+    ASSERT_EQ(1u, ctx.m_CallbackCount);
+    ASSERT_EQ(1u, ctx.m_Stats.m_UpdateCount);
+    ASSERT_EQ(0u, ctx.m_Stats.m_FixedUpdateCount);
+    ASSERT_EQ(0u, ctx.m_Stats.m_RenderCount);
+
+    ctx.m_CollectionName = "collection";
+    ctx.m_CallbackCount = 0;
+    dmGameObject::IterateComponentTypeStats(m_Register, ComponentStatsCallback, &ctx);
+    ASSERT_EQ(0u, ctx.m_CallbackCount);
+
+    dmGameObject::DeleteCollection(collection);
+}
+
 TEST_F(ComponentTest, TestPostDeleteUpdate)
 {
     dmGameObject::HInstance go = dmGameObject::New(m_Collection, "/go1.goc");
@@ -681,6 +681,236 @@ TEST_F(HierarchyTest, TestHierarchyInheritScale)
     dmGameObject::Delete(m_Collection, parent, false);
 }
 
+// Only changed subtrees are recalculated, make sure changes deep down or high up in the hierarchy still propagate
+TEST_F(HierarchyTest, TestHierarchyDirtySubtree)
+{
+    dmGameObject::HInstance root = dmGameObject::New(m_Collection, 0x0);
+    dmGameObject::HInstance parent = dmGameObject::New(m_Collection, 0x0);
+    dmGameObject::HInstance child = dmGameObject::New(m_Collection, 0x0);
+    dmGameObject::HInstance sibling = dmGameObject::New(m_Collection, 0x0);
+
+    dmGameObject::SetParent(parent, root);
+    dmGameObject::SetParent(child, parent);
+    dmGameObject::SetParent(sibling, root);
+
+    dmGameObject::SetPosition(root, Point3(1.0f, 0.0f, 0.0f));
+    dmGameObject::SetPosition(parent, Point3(0.0f, 2.0f, 0.0f));
+    dmGameObject::SetPosition(child, Point3(0.0f, 0.0f, 3.0f));
+    dmGameObject::UpdateTransforms(m_Collection);
+
+    ASSERT_NEAR(0.0f, length(dmGameObject::GetWorldPosition(child) - Point3(1.0f, 2.0f, 3.0f)), EPSILON);
+    ASSERT_NEAR(0.0f, length(dmGameObject::GetWorldPosition(sibling) - Point3(1.0f, 0.0f, 0.0f)), EPSILON);
+
+    // Nothing changed
+    dmGameObject::UpdateTransforms(m_Collection);
+    ASSERT_NEAR(0.0f, length(dmGameObject::GetWorldPosition(child) - Point3(1.0f, 2.0f, 3.0f)), EPSILON);
+
+    // Leaf changed
+    dmGameObject::SetPosition(child, Point3(0.0f, 0.0f, 4.0f));
+    dmGameObject::UpdateTransforms(m_Collection);
+    ASSERT_NEAR(0.0f, length(dmGameObject::GetWorldPosition(child) - Point3(1.0f, 2.0f, 4.0f)), EPSILON);
+    ASSERT_NEAR(0.0f, length(dmGameObject::GetWorldPosition(parent) - Point3(1.0f, 2.0f, 0.0f)), EPSILON);
+
+    // Root changed, propagates to all descendants
+    dmGameObject::SetPosition(root, Point3(5.0f, 0.0f, 0.0f));
+    dmGameObject::UpdateTransforms(m_Collection);
+    ASSERT_NEAR(0.0f, length(dmGameObject::GetWorldPosition(child) - Point3(5.0f, 2.0f, 4.0f)), EPSILON);
+    ASSERT_NEAR(0.0f, length(dmGameObject::GetWorldPosition(sibling) - Point3(5.0f, 0.0f, 0.0f)), EPSILON);
+
+    // Reparenting without changing the local transform
+    dmGameObject::SetParent(child, sibling);
+    dmGameObject::SetPosition(child, Point3(0.0f, 0.0f, 4.0f));
+    dmGameObject::UpdateTransforms(m_Collection);
+    ASSERT_NEAR(0.0f, length(dmGameObject::GetWorldPosition(child) - Point3(5.0f, 0.0f, 4.0f)), EPSILON);
+
+    dmGameObject::Delete(m_Collection, child, false);
+    dmGameObject::Delete(m_Collection, sibling, false);
+    dmGameObject::Delete(m_Collection, parent, false);
+    dmGameObject::Delete(m_Collection, root, false);
+}
+
+TEST_F(HierarchyTest, TestHierarchyTransformThreads)
+{
+    dmJobThread::JobThreadCreationParams job_thread_create_param;
+    job_thread_create_param.m_ThreadNames[0] = "TestTransformJobThread";
+    job_thread_create_param.m_ThreadCount    = 3;
+    dmJobThread::HContext job_thread = dmJobThread::Create(job_thread_create_param);
+    dmGameObject::SetJobThread(m_Register, job_thread);
+
+    const uint32_t child_count = 900;
+    dmGameObject::HInstance root = dmGameObject::New(m_Collection, 0x0);
+    dmGameObject::HInstance children[child_count];
+    for (uint32_t i = 0; i < child_count; ++i)
+    {
+        children[i] = dmGameObject::New(m_Collection, 0x0);
+        dmGameObject::SetPosition(children[i], Point3((float)i, 0.0f, 0.0f));
+        dmGameObject::SetParent(children[i], root);
+    }
+
+    for (uint32_t frame = 0; frame < 3; ++frame)
+    {
+        dmGameObject::SetPosition(root, Point3(0.0f, (float)frame, 0.0f));
+        dmGameObject::UpdateTransforms(m_Collection);
+
+        for (uint32_t i = 0; i < child_count; ++i)
+        {
+            ASSERT_NEAR(0.0f, length(dmGameObject::GetWorldPosition(children[i]) - Point3((float)i, (float)frame, 0.0f)), EPSILON);
+        }
+    }
+
+    for (uint32_t i = 0; i < child_count; ++i)
+    {
+        dmGameObject::Delete(m_Collection, children[i], false);
+    }
+    dmGameObject::Delete(m_Collection, root, false);
+
+    dmGameObject::SetJobThread(m_Register, 0);
+    dmJobThread::Destroy(job_thread);
+}
+
+TEST_F(HierarchyTest, TestHierarchyTransformCollections)
+{
+    dmJobThread::JobThreadCreationParams job_thread_create_param;
+    job_thread_create_param.m_ThreadNames[0] = "TestTransformJobThread";
+    job_thread_create_param.m_ThreadCount    = 3;
+    dmJobThread::HContext job_thread = dmJobThread::Create(job_thread_create_param);
+    dmGameObject::SetJobThread(m_Register, job_thread);
+
+    const uint32_t collection_count = 4;
+    dmGameObject::HCollection collections[collection_count];
+    dmGameObject::HInstance roots[collection_count];
+    dmGameObject::HInstance children[collection_count];
+    for (uint32_t i = 0; i < collection_count; ++i)
+    {
+        char name[32];
+        dmSnPrintf(name, sizeof(name), "isolated%u", i);
+        collections[i] = i == 0 ? m_Collection : dmGameObject::NewCollection(name, m_Factory, m_Register, 1024, 0x0);
+        dmGameObject::SetDeferTransforms(collections[i], true);
+
+        roots[i] = dmGameObject::New(collections[i], 0x0);
+        children[i] = dmGameObject::New(collections[i], 0x0);
+        dmGameObject::SetParent(children[i], roots[i]);
+        dmGameObject::SetPosition(roots[i], Point3((float)i, 0.0f, 0.0f));
+        dmGameObject::SetPosition(children[i], Point3(0.0f, 1.0f, 0.0f));
+
+        ASSERT_TRUE(dmGameObject::Update(collections[i], &m_UpdateContext));
+    }
+
+    dmGameObject::UpdateTransforms(collections, collection_count);
+
+    for (uint32_t i = 0; i < collection_count; ++i)
+    {
+        ASSERT_NEAR(0.0f, length(dmGameObject::GetWorldPosition(children[i]) - Point3((float)i, 1.0f, 0.0f)), EPSILON);
+    }
+
+    for (uint32_t i = 0; i < collection_count; ++i)
+    {
+        dmGameObject::Delete(collections[i], children[i], false);
+        dmGameObject::Delete(collections[i], roots[i], false);
+        if (i > 0)
+            dmGameObject::DeleteCollection(collections[i]);
+    }
+
+    dmGameObject::SetJobThread(m_Register, 0);
+    dmJobThread::Destroy(job_thread);
+}
+
+TEST_F(HierarchyTest, TestHierarchyDeleteMany)
+{
+    const uint32_t count = 64;
+    dmGameObject::HInstance roots[count];
+    dmGameObject::HInstance children[count];
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        roots[i] = dmGameObject::New(m_Collection, 0x0);
+        children[i] = dmGameObject::New(m_Collection, 0x0);
+        dmGameObject::SetParent(children[i], roots[i]);
+        dmGameObject::SetPosition(roots[i], Point3((float)i, 0.0f, 0.0f));
+        dmGameObject::SetPosition(children[i], Point3(0.0f, 1.0f, 0.0f));
+    }
+
+    // Delete every other root in the same frame, which moves their children up one level
+    for (uint32_t i = 0; i < count; i += 2)
+    {
+        dmGameObject::Delete(m_Collection, roots[i], false);
+    }
+    ASSERT_TRUE(dmGameObject::PostUpdate(m_Collection));
+
+    dmGameObject::Collection* collection = m_Collection->m_Collection;
+    ASSERT_EQ(count, collection->m_LevelIndices[0].Size());
+    ASSERT_EQ(count / 2, collection->m_LevelIndices[1].Size());
+    for (uint32_t level_i = 0; level_i < 2; ++level_i)
+    {
+        dmArray<uint16_t>& level = collection->m_LevelIndices[level_i];
+        for (uint32_t i = 0; i < level.Size(); ++i)
+        {
+            dmGameObject::HInstance instance = collection->m_Instances[level[i]];
+            ASSERT_EQ(level_i, instance->m_Depth);
+            ASSERT_EQ(i, instance->m_LevelIndex);
+        }
+    }
+
+    for (uint32_t i = 1; i < count; i += 2)
+    {
+        dmGameObject::SetPosition(roots[i], Point3((float)i, 2.0f, 0.0f));
+    }
+    ASSERT_TRUE(dmGameObject::Update(m_Collection, &m_UpdateContext));
+
+    for (uint32_t i = 1; i < count; i += 2)
+    {
+        ASSERT_EQ(roots[i], dmGameObject::GetParent(children[i]));
+        ASSERT_NEAR(0.0f, length(dmGameObject::GetWorldPosition(children[i]) - Point3((float)i, 3.0f, 0.0f)), EPSILON);
+    }
+}
+
+TEST_F(HierarchyTest, TestHierarchyTransformVersions)
+{
+    dmGameObject::HInstance parent = dmGameObject::New(m_Collection, 0x0);
+    dmGameObject::HInstance child = dmGameObject::New(m_Collection, 0x0);
+    dmGameObject::HInstance other = dmGameObject::New(m_Collection, 0x0);
+    dmGameObject::SetParent(child, parent);
+    dmGameObject::UpdateTransforms(m_Collection);
+
+    uint32_t parent_index = dmGameObject::GetTransformIndex(parent);
+    uint32_t child_index = dmGameObject::GetTransformIndex(child);
+    uint32_t other_index = dmGameObject::GetTransformIndex(other);
+    const Matrix4* world_transforms = dmGameObject::GetWorldTransforms(m_Collection);
+    ASSERT_EQ(&dmGameObject::GetWorldMatrix(child), &world_transforms[child_index]);
+
+    uint32_t last_version;
+    dmGameObject::GetTransformVersions(m_Collection, &last_version);
+
+    // Nothing changed
+    dmGameObject::UpdateTransforms(m_Collection);
+    uint32_t version;
+    const uint32_t* versions = dmGameObject::GetTransformVersions(m_Collection, &version);
+    ASSERT_LT(last_version, version);
+    ASSERT_GE(last_version, versions[parent_index]);
+    ASSERT_GE(last_version, versions[child_index]);
+    ASSERT_GE(last_version, versions[other_index]);
+    last_version = version;
+
+    // The child changes along with its parent
+    dmGameObject::SetPosition(parent, Point3(1.0f, 2.0f, 3.0f));
+    dmGameObject::UpdateTransforms(m_Collection);
+    versions = dmGameObject::GetTransformVersions(m_Collection, &version);
+    ASSERT_LT(last_version, versions[parent_index]);
+    ASSERT_LT(last_version, versions[child_index]);
+    ASSERT_GE(last_version, versions[other_index]);
+    ASSERT_NEAR(0.0f, length(world_transforms[child_index].getTranslation() - Vector3(1.0f, 2.0f, 3.0f)), EPSILON);
+    last_version = version;
+
+    // New instances count as changed, before their transforms are updated
+    dmGameObject::HInstance created = dmGameObject::New(m_Collection, 0x0);
+    versions = dmGameObject::GetTransformVersions(m_Collection, &version);
+    ASSERT_LT(last_version, versions[dmGameObject::GetTransformIndex(created)]);
+
+    dmGameObject::Delete(m_Collection, created, false);
+    dmGameObject::Delete(m_Collection, other, false);
+    dmGameObject::Delete(m_Collection, child, false);
+    dmGameObject::Delete(m_Collection, parent, false);
+}
+
 // Test depth-first order
 TEST_F(HierarchyTest, TestHierarchyBonesOrder)
 {
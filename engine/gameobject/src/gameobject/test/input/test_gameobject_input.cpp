@@ -306,3 +306,47 @@ TEST_F(InputTest, TestDeleteFocusInstance)
 
     ASSERT_EQ(dmGameObject::UPDATE_RESULT_OK, r);
 }
+
+TEST_F(InputTest, TestComponentInputFilter)
+{
+    dmGameObject::HInstance go = dmGameObject::New(m_Collection, "/component_input_filter.goc");
+    ASSERT_NE((void*) 0, (void*) go);
+    ASSERT_TRUE(dmGameObject::Init(m_Collection));
+
+    dmGameObject::AcquireInputFocus(m_Collection, go);
+
+    // Not in the filter, the script isn't called (it would fail) and the action isn't consumed
+    dmGameObject::InputAction action;
+    action.m_ActionId = dmHashString64("other_action");
+    action.m_Pressed = 1;
+
+    dmGameObject::UpdateResult r = dmGameObject::DispatchInput(m_Collection, &action, 1);
+    ASSERT_EQ(dmGameObject::UPDATE_RESULT_OK, r);
+    ASSERT_FALSE(action.m_Consumed);
+
+    // Pure mouse movement isn't in the filter
+    action = dmGameObject::InputAction();
+    action.m_PositionSet = true;
+    action.m_X = 1.0f;
+    action.m_Y = 2.0f;
+
+    r = dmGameObject::DispatchInput(m_Collection, &action, 1);
+    ASSERT_EQ(dmGameObject::UPDATE_RESULT_OK, r);
+    ASSERT_FALSE(action.m_Consumed);
+
+    action = dmGameObject::InputAction();
+    action.m_ActionId = dmHashString64("test_action");
+    action.m_Pressed = 1;
+
+    r = dmGameObject::DispatchInput(m_Collection, &action, 1);
+    ASSERT_EQ(dmGameObject::UPDATE_RESULT_OK, r);
+    ASSERT_TRUE(action.m_Consumed);
+
+    action = dmGameObject::InputAction();
+    action.m_ActionId = dmHashString64("test_action2");
+    action.m_Pressed = 1;
+
+    r = dmGameObject::DispatchInput(m_Collection, &action, 1);
+    ASSERT_EQ(dmGameObject::UPDATE_RESULT_OK, r);
+    ASSERT_TRUE(action.m_Consumed);
+}
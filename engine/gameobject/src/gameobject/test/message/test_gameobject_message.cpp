@@ -66,6 +66,7 @@ protected:
         assert(dmMessage::NewSocket("@system", &m_Socket) == dmMessage::RESULT_OK);
 
         m_MessageTargetCounter = 0;
+        m_MessageTargetBatchCount = 0;
 
         dmResource::Result e = dmResource::RegisterType(m_Factory, "mt", this, 0, ResMessageTargetCreate, 0, ResMessageTargetDestroy, 0);
         ASSERT_EQ(dmResource::RESULT_OK, e);
@@ -110,6 +111,7 @@ protected:
     static dmGameObject::CreateResult CompMessageTargetCreate(const dmGameObject::ComponentCreateParams& params);
     static dmGameObject::CreateResult CompMessageTargetDestroy(const dmGameObject::ComponentDestroyParams& params);
     static dmGameObject::UpdateResult CompMessageTargetOnMessage(const dmGameObject::ComponentOnMessageParams& params);
+    static dmGameObject::UpdateResult CompMessageTargetOnMessageBatch(const dmGameObject::ComponentsOnMessageBatchParams& params);
 
 public:
     dmGameObject::UpdateContext m_UpdateContext;
@@ -122,6 +124,7 @@ public:
     std::map<uint32_t, uint32_t> m_MessageMap;
 
     uint32_t m_MessageTargetCounter;
+    uint32_t m_MessageTargetBatchCount;
     dmGameObject::ModuleContext m_ModuleContext;
     dmHashTable64<void*> m_Contexts;
 };
@@ -202,6 +205,19 @@ dmGameObject::UpdateResult MessageTest::CompMessageTargetOnMessage(const dmGameO
     return dmGameObject::UPDATE_RESULT_OK;
 }
 
+dmGameObject::UpdateResult MessageTest::CompMessageTargetOnMessageBatch(const dmGameObject::ComponentsOnMessageBatchParams& params)
+{
+    MessageTest* self = (MessageTest*) params.m_Context;
+    self->m_MessageTargetBatchCount++;
+    for (uint32_t i = 0; i < params.m_Count; ++i)
+    {
+        dmGameObject::UpdateResult result = CompMessageTargetOnMessage(params.m_Messages[i]);
+        if (result != dmGameObject::UPDATE_RESULT_OK)
+            return result;
+    }
+    return dmGameObject::UPDATE_RESULT_OK;
+}
+
 void DispatchCallback(dmMessage::Message *message, void* user_ptr)
 {
     MessageTest* test = (MessageTest*)user_ptr;
@@ -286,6 +302,51 @@ TEST_F(MessageTest, TestComponentMessage)
     dmGameObject::Delete(m_Collection, go, false);
 }
 
+TEST_F(MessageTest, TestComponentMessageBatch)
+{
+    HResourceType resource_type;
+    ASSERT_EQ(dmResource::RESULT_OK, dmResource::GetTypeFromExtension(m_Factory, "mt", &resource_type));
+    dmGameObject::ComponentType* mt_type = dmGameObject::FindComponentType(m_Register, resource_type, 0);
+    ASSERT_NE((void*) 0, (void*) mt_type);
+    mt_type->m_OnMessageBatchFunction = CompMessageTargetOnMessageBatch;
+
+    dmGameObject::HInstance go = dmGameObject::New(m_Collection, "/component_message.goc");
+    ASSERT_NE((void*) 0, (void*) go);
+    ASSERT_EQ(dmGameObject::RESULT_OK, dmGameObject::SetIdentifier(m_Collection, go, "test_instance"));
+
+    dmMessage::URL sender;
+    sender.m_Socket = dmGameObject::GetMessageSocket(m_Collection);
+    sender.m_Path = dmGameObject::GetIdentifier(go);
+    sender.m_Fragment = dmHashString64("script");
+    dmMessage::URL receiver;
+    receiver.m_Socket = dmGameObject::GetMessageSocket(m_Collection);
+    receiver.m_Path = dmGameObject::GetIdentifier(go);
+    receiver.m_Fragment = dmHashString64("mt");
+
+    // The messages must be handled in order, or the counter would wrap
+    const uint32_t message_count = 2 * dmMessage::DISPATCH_BATCH_SIZE + 2;
+    for (uint32_t i = 0; i < message_count; ++i)
+    {
+        dmhash_t message_id = dmHashString64((i & 1) == 0 ? "inc" : "dec");
+        ASSERT_EQ(dmMessage::RESULT_OK, dmMessage::Post(&sender, &receiver, message_id, 0, 0, 0x0, 0, 0));
+    }
+    ASSERT_TRUE(dmGameObject::Update(m_Collection, &m_UpdateContext));
+    ASSERT_EQ(0U, m_MessageTargetCounter);
+    ASSERT_EQ(3U, m_MessageTargetBatchCount);
+
+    // A message to another component in between splits the batch
+    m_MessageTargetBatchCount = 0;
+    ASSERT_EQ(dmMessage::RESULT_OK, dmMessage::Post(&sender, &receiver, dmHashString64("inc"), 0, 0, 0x0, 0, 0));
+    ASSERT_EQ(dmMessage::RESULT_OK, dmMessage::Post(&receiver, &sender, dmHashString64("test_message"), 0, 0, 0x0, 0, 0));
+    ASSERT_EQ(dmMessage::RESULT_OK, dmMessage::Post(&sender, &receiver, dmHashString64("dec"), 0, 0, 0x0, 0, 0));
+    ASSERT_TRUE(dmGameObject::Update(m_Collection, &m_UpdateContext));
+    ASSERT_EQ(0U, m_MessageTargetCounter);
+    ASSERT_EQ(2U, m_MessageTargetBatchCount);
+
+    mt_type->m_OnMessageBatchFunction = 0;
+    dmGameObject::Delete(m_Collection, go, false);
+}
+
 TEST_F(MessageTest, TestComponentMessageFail)
 {
     dmGameObject::HInstance go = dmGameObject::New(m_Collection, "/component_message.goc");
@@ -31,6 +31,11 @@ namespace dmGameSystem
         uint32_t                 m_ElementCount;    // The number of vertices
         uint32_t                 m_Stride;          // The vertex size (bytes)
         uint32_t                 m_Version;
+        // The elements changed since the content version m_DirtyVersion (set by resource.set_buffer).
+        // A count of zero means the whole buffer should be considered changed.
+        uint32_t                 m_DirtyVersion;
+        uint32_t                 m_DirtyStart;
+        uint32_t                 m_DirtyCount;
     };
 }
 
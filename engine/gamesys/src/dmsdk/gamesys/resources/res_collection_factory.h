@@ -29,6 +29,7 @@ namespace dmGameSystem
 
         dmhash_t                        m_PrototypePathHash;
         dmGameObject::HCollectionDesc   m_CollectionDesc;
+        dmGameObject::HCollectionSpawnTemplate m_SpawnTemplate;
         dmArray<void*>                  m_CollectionResources;
         uint8_t                         m_LoadDynamically : 1;
         uint8_t                         m_DynamicPrototype : 1;
@@ -22,7 +22,9 @@
 #include <dlib/log.h>
 #include <dlib/hash.h>
 #include <dlib/index_pool.h>
+#include <dlib/math.h>
 #include <dlib/profile.h>
+#include <dlib/time.h>
 
 #include <gameobject/gameobject.h>
 #include <gameobject/gameobject_ddf.h>
@@ -54,6 +56,7 @@ namespace dmGameSystem
     using namespace dmVMath;
 
     const char* COLLECTION_PROXY_MAX_COUNT_KEY = "collection_proxy.max_count";
+    const char* COLLECTION_PROXY_LOAD_BUDGET_KEY = "collection_proxy.load_budget";
 
     static const dmhash_t COLLECTION_PROXY_LOAD_HASH = dmHashString64("load");
     static const dmhash_t COLLECTION_PROXY_ASYNC_LOAD_HASH = dmHashString64("async_load");
@@ -79,6 +82,7 @@ namespace dmGameSystem
         uint32_t                        m_Unloaded : 1;
         uint32_t                        m_AddedToUpdate : 1;
         uint32_t                        m_Loading : 1;
+        uint32_t                        m_Isolated : 1;
 
         dmResource::HPreloader          m_Preloader;
         dmMessage::URL                  m_LoadSender;
@@ -99,6 +103,8 @@ namespace dmGameSystem
         dmArray<CollectionProxyComponent>   m_Components;
         dmIndexPool32                       m_IndexPool;
         CollectionProxyContext*             m_Context;
+        // The isolated collections updated this frame, which transforms are updated together
+        dmArray<dmGameObject::HCollection>  m_IsolatedCollections;
     };
 
     static dmGameObject::UpdateResult DoLoad(dmResource::HFactory factory, CollectionProxyComponent* proxy)
@@ -110,6 +116,7 @@ namespace dmGameSystem
             dmLogError("The collection %s could not be loaded.", collection_path);
             return dmGameObject::UPDATE_RESULT_UNKNOWN_ERROR;
         }
+        dmGameObject::SetDeferTransforms(proxy->m_Collection, proxy->m_Isolated);
         return dmGameObject::UPDATE_RESULT_OK;
     }
 
@@ -161,6 +168,16 @@ namespace dmGameSystem
     }
 
 
+    void CollectionProxySetIsolated(const HCollectionProxyWorld world, HCollectionProxyComponent component, bool isolated)
+    {
+        CollectionProxyComponent* proxy = (CollectionProxyComponent*)component;
+        proxy->m_Isolated = isolated;
+        if (proxy->m_Collection)
+        {
+            dmGameObject::SetDeferTransforms(proxy->m_Collection, isolated);
+        }
+    }
+
     dmhash_t GetCollectionUrlHashFromComponent(const HCollectionProxyWorld world, dmhash_t instanceId, uint32_t index)
     {
         dmhash_t comp_url_hash = 0;
@@ -329,10 +346,17 @@ namespace dmGameSystem
             if (proxy->m_Preloader != 0)
             {
                 CollectionProxyContext* context = (CollectionProxyContext*)params.m_Context;
-                dmResource::PreloaderCompleteCallbackParams params;
-                params.m_Factory = context->m_Factory;
-                params.m_UserData = proxy;
-                dmResource::Result r = dmResource::UpdatePreloader(proxy->m_Preloader, PreloadCompleteCallback, &params, 10*1000);
+                dmGameObject::HRegister regist = dmGameObject::GetRegister(params.m_Collection);
+                uint32_t load_budget = (context->m_LoadBudget ? context->m_LoadBudget : 10) * 1000;
+
+                // The instances of the loaded collection are created over as many frames as the budget requires.
+                // The preloader stays pending until all are created, so "proxy_loaded" is posted after the last slice
+                dmGameObject::SetCollectionCreateDeadline(regist, dmTime::GetTime() + load_budget);
+                dmResource::PreloaderCompleteCallbackParams preload_params;
+                preload_params.m_Factory = context->m_Factory;
+                preload_params.m_UserData = proxy;
+                dmResource::Result r = dmResource::UpdatePreloader(proxy->m_Preloader, PreloadCompleteCallback, &preload_params, load_budget);
+                dmGameObject::SetCollectionCreateDeadline(regist, 0);
                 if (r != dmResource::RESULT_PENDING)
                 {
                     dmResource::DeletePreloader(proxy->m_Preloader);
@@ -340,7 +364,8 @@ namespace dmGameSystem
                     proxy->m_Preloader = 0;
                 }
             }
-            if (proxy->m_Collection != 0)
+            // The collection is set before the load has completed, while its instances are still being created
+            if (proxy->m_Collection != 0 && !proxy->m_Loading)
             {
                 DM_PROPERTY_ADD_U32(rmtp_CollectionProxyLoaded, 1);
                 if (proxy->m_DelayedEnable != proxy->m_Enabled)
@@ -380,6 +405,14 @@ namespace dmGameSystem
 
                     if (!dmGameObject::Update(proxy->m_Collection, &uc))
                         result = dmGameObject::UPDATE_RESULT_UNKNOWN_ERROR;
+
+                    if (proxy->m_Isolated)
+                    {
+                        dmArray<dmGameObject::HCollection>& isolated = proxy_world->m_IsolatedCollections;
+                        if (isolated.Full())
+                            isolated.OffsetCapacity(dmMath::Max(4u, isolated.Capacity()));
+                        isolated.Push(proxy->m_Collection);
+                    }
                 }
                 else
                 {
@@ -391,6 +424,14 @@ namespace dmGameSystem
                 UnloadComplete(proxy, dmGameObject::RESULT_OK);
             }
         }
+
+        // The last transform update of the isolated collections was deferred, so they can be updated concurrently
+        dmArray<dmGameObject::HCollection>& isolated = proxy_world->m_IsolatedCollections;
+        if (!isolated.Empty())
+        {
+            dmGameObject::UpdateTransforms(isolated.Begin(), isolated.Size());
+            isolated.SetSize(0);
+        }
         return result;
     }
 
@@ -581,7 +622,7 @@ namespace dmGameSystem
 
     static dmGameObject::Result CompCollectionProxyInitializeInternal(HCollectionProxyComponent proxy, dmMessage::Message* message)
     {
-        if (proxy->m_Collection != 0)
+        if (proxy->m_Collection != 0 && !proxy->m_Loading)
         {
             if (proxy->m_Initialized == 0)
             {
@@ -637,7 +678,7 @@ namespace dmGameSystem
 
     static dmGameObject::Result CompCollectionProxyEnableInternal(HCollectionProxyComponent proxy, dmMessage::Message* message)
     {
-        if (proxy->m_Collection != 0)
+        if (proxy->m_Collection != 0 && !proxy->m_Loading)
         {
             if (proxy->m_Enabled == 0 && proxy->m_DelayedEnable == 0)
             {
@@ -1118,6 +1159,28 @@ namespace dmGameSystem
      * ```
      */
 
+    /*# marks a collection proxy as isolated
+     *
+     * The transforms of the game objects in isolated collections are updated concurrently, on the job threads,
+     * after all the collection proxies of the collection have been updated.
+     * An isolated collection must not depend on the transforms of the other isolated collections during the update,
+     * which holds for separate worlds (split-screen, background simulations or preloaded levels).
+     * The components themselves are still updated one collection at a time, since they share the script state.
+     *
+     * @name collectionproxy.set_isolated
+     * @param url [type:string|hash|url] the collection proxy component
+     * @param isolated [type:boolean] true to isolate the collection
+     *
+     * @examples
+     *
+     * ```lua
+     * collectionproxy.set_isolated("#level1", true)
+     * collectionproxy.set_isolated("#level2", true)
+     * msg.post("#level1", "async_load")
+     * msg.post("#level2", "async_load")
+     * ```
+     */
+
     /*# collection proxy is loading now
      * It's impossible to change the collection while the collection proxy is loading.
      * @name collectionproxy.RESULT_LOADING
@@ -44,6 +44,8 @@ namespace dmGameSystem
 
     SetCollectionForProxyPathResult CollectionProxySetCollectionPath(const HCollectionProxyWorld world, HCollectionProxyComponent component, const char* path);
 
+    void CollectionProxySetIsolated(const HCollectionProxyWorld world, HCollectionProxyComponent component, bool isolated);
+
     dmGameObject::CreateResult CompCollectionProxyNewWorld(const dmGameObject::ComponentNewWorldParams& params);
 
     dmGameObject::CreateResult CompCollectionProxyDeleteWorld(const dmGameObject::ComponentDeleteWorldParams& params);
@@ -125,6 +125,8 @@ namespace dmGameSystem
         uint8_t m_StartAsEnabled : 1;
         uint8_t m_FlippedX : 1; // set if it's been flipped
         uint8_t m_FlippedY : 1;
+        // Set when grid cell filters changed since the last step, see FlushGridShapeFilters
+        uint8_t m_GridFilterDirty : 1;
     };
 
     struct CollisionWorld
@@ -143,6 +145,7 @@ namespace dmGameSystem
         uint8_t     m_ComponentTypeIndex;
         uint8_t     m_3D : 1;
         uint8_t     m_FirstUpdate : 1;
+        uint8_t     m_GridFiltersDirty : 1; // If any component has m_GridFilterDirty set
         dmArray<CollisionComponent*> m_Components;
     };
 
@@ -349,12 +352,13 @@ namespace dmGameSystem
                         dmPhysics::SetGridShapeHull(component->m_Object2D, i, cell_y, cell_x, tile, flags);
                         uint32_t child = cell_x + tile_grid_resource->m_ColumnCount * cell_y;
                         uint16_t group = GetGroupBitIndex(world, texture_set_resource->m_HullCollisionGroups[tile], false);
-                        dmPhysics::SetCollisionObjectFilter(component->m_Object2D, i, child, group, component->m_Mask);
+                        dmPhysics::SetCollisionObjectFilterDeferred(component->m_Object2D, i, child, group, component->m_Mask);
                     }
                 }
 
                 dmPhysics::SetGridShapeEnable(component->m_Object2D, i, layer->m_IsVisible);
             }
+            dmPhysics::RefilterCollisionObject2D(component->m_Object2D);
         }
     }
 
@@ -467,6 +471,7 @@ namespace dmGameSystem
         component->m_JointEndPoints = 0x0;
         component->m_FlippedX = 0;
         component->m_FlippedY = 0;
+        component->m_GridFilterDirty = 0;
         component->m_ShapeBuffer = 0;
 
         CollisionWorld* world = (CollisionWorld*)params.m_World;
@@ -1008,6 +1013,24 @@ namespace dmGameSystem
         return dispatch_context.m_Success;
     }
 
+    // Changing a tile grid cell only updates the filter of that cell. The contacts of the grid are
+    // flagged for filtering once per step here, instead of once per changed cell.
+    static void FlushGridShapeFilters(CollisionWorld* world)
+    {
+        DM_PROFILE("FlushGridShapeFilters");
+        uint32_t num_components = world->m_Components.Size();
+        for (uint32_t i = 0; i < num_components; ++i)
+        {
+            CollisionComponent* component = world->m_Components[i];
+            if (component->m_GridFilterDirty)
+            {
+                dmPhysics::RefilterCollisionObject2D(component->m_Object2D);
+                component->m_GridFilterDirty = 0;
+            }
+        }
+        world->m_GridFiltersDirty = 0;
+    }
+
     static void Step(CollisionWorld* world, PhysicsContext* physics_context, dmGameObject::HCollection collection, const dmPhysics::StepWorldContext* step_ctx)
     {
         CollisionUserData* collision_user_data = (CollisionUserData*)step_ctx->m_CollisionUserData;
@@ -1029,6 +1052,11 @@ namespace dmGameSystem
         }
         else
         {
+            if (world->m_GridFiltersDirty)
+            {
+                FlushGridShapeFilters(world);
+            }
+
             DM_PROFILE("StepWorld2D");
             dmPhysics::StepWorld2D(world->m_World2D, *step_ctx);
         }
@@ -1291,7 +1319,9 @@ namespace dmGameSystem
                 group = GetGroupBitIndex((CollisionWorld*)params.m_World, tile_grid_resource->m_TextureSet->m_HullCollisionGroups[hull], false);
                 mask = component->m_Mask;
             }
-            dmPhysics::SetCollisionObjectFilter(component->m_Object2D, ddf->m_Shape, child, group, mask);
+            dmPhysics::SetCollisionObjectFilterDeferred(component->m_Object2D, ddf->m_Shape, child, group, mask);
+            component->m_GridFilterDirty = 1;
+            ((CollisionWorld*)params.m_World)->m_GridFiltersDirty = 1;
         }
         else if(params.m_Message->m_Id == dmPhysicsDDF::EnableGridShapeLayer::m_DDFDescriptor->m_NameHash)
         {
@@ -1484,6 +1514,32 @@ namespace dmGameSystem
         }
     }
 
+    void QueryAABB(void* _world, const dmVMath::Point3& min, const dmVMath::Point3& max, uint16_t mask, dmArray<void*>& results)
+    {
+        CollisionWorld* world = (CollisionWorld*)_world;
+        if (world->m_3D)
+        {
+            dmPhysics::QueryAABB3D(world->m_World3D, min, max, mask, results);
+        }
+        else
+        {
+            dmPhysics::QueryAABB2D(world->m_World2D, min, max, mask, results);
+        }
+    }
+
+    void QuerySphere(void* _world, const dmVMath::Point3& center, float radius, uint16_t mask, dmArray<void*>& results)
+    {
+        CollisionWorld* world = (CollisionWorld*)_world;
+        if (world->m_3D)
+        {
+            dmPhysics::QuerySphere3D(world->m_World3D, center, radius, mask, results);
+        }
+        else
+        {
+            dmPhysics::QueryCircle2D(world->m_World2D, center, radius, mask, results);
+        }
+    }
+
     // Find a JointEntry in the linked list of a collision component based on the joint id.
     static JointEntry* FindJointEntry(CollisionWorld* world, CollisionComponent* component, dmhash_t id)
     {
@@ -1776,6 +1832,16 @@ namespace dmGameSystem
         }
     }
 
+    void SetRegionFocus(void* _world, const dmVMath::Point3& position)
+    {
+        CollisionWorld* world = (CollisionWorld*)_world;
+        // Only the 2D worlds are partitioned
+        if (!world->m_3D)
+        {
+            dmPhysics::SetRegionFocus2D(world->m_World2D, position);
+        }
+    }
+
     bool GetShapeIndex(void* _component, dmhash_t shape_name_hash, uint32_t* index_out)
     {
         CollisionComponent* component = (CollisionComponent*) _component;
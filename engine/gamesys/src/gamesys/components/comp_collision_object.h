@@ -65,6 +65,8 @@ namespace dmGameSystem
 
     // For script_physics.cpp
     void RayCast(void* world, const dmPhysics::RayCastRequest& request, dmArray<dmPhysics::RayCastResponse>& results);
+    void QueryAABB(void* world, const dmVMath::Point3& min, const dmVMath::Point3& max, uint16_t mask, dmArray<void*>& results);
+    void QuerySphere(void* world, const dmVMath::Point3& center, float radius, uint16_t mask, dmArray<void*>& results);
     uint64_t GetLSBGroupHash(void* world, uint16_t mask);
     dmhash_t CompCollisionObjectGetIdentifier(void* component);
 
@@ -78,6 +80,7 @@ namespace dmGameSystem
 
     void SetGravity(void* world, const dmVMath::Vector3& gravity);
     dmVMath::Vector3 GetGravity(void* _world);
+    void SetRegionFocus(void* world, const dmVMath::Point3& position);
 
     bool IsCollision2D(void* _world);
     void SetCollisionFlipH(void* _component, bool flip);
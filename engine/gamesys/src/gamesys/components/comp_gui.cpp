@@ -147,6 +147,7 @@ namespace dmGameSystem
         dmRender::HRenderContext    m_RenderContext;
         dmRender::HMaterial         m_Material;
         GuiWorld*                   m_GuiWorld;
+        GuiComponent*               m_Component;
 
         // This order value is increased during rendering for each
         // render object generated, then used to make sure the final
@@ -344,7 +345,9 @@ namespace dmGameSystem
 
         // Grows automatically
         gui_world->m_ClientVertexBuffer.SetCapacity(512);
-        gui_world->m_VertexBuffer = dmGraphics::NewVertexBuffer(graphics_context, 0, 0, dmGraphics::BUFFER_USAGE_STREAM_DRAW);
+        gui_world->m_VertexBuffer = dmGraphics::NewVertexBuffer(graphics_context, 0, 0, dmGraphics::BUFFER_USAGE_DYNAMIC_DRAW);
+        gui_world->m_UploadedVertexCount = 0;
+        gui_world->m_RenderFrame = 0;
 
         uint8_t white_texture[] = { 0xff, 0xff, 0xff, 0xff,
                                     0xff, 0xff, 0xff, 0xff,
@@ -865,6 +868,9 @@ namespace dmGameSystem
                 }
             }
 
+            // Resolve the node descs up front, so that changing the layout doesn't have to
+            dmGui::ResolveLayouts(scene, SetNodeCallback);
+
             // we might have any resolution starting the scene, so let's set the best alternative layout directly
             dmArray<dmhash_t> scene_layouts;
             scene_layouts.SetCapacity(layouts_count+1);
@@ -986,6 +992,7 @@ namespace dmGameSystem
                 }
                 gui_component->m_ResourcePropertyPointers.SetSize(0);
                 dmGui::DeleteScene(gui_component->m_Scene);
+                DeleteBoxNodeVertexCache(gui_component);
                 delete gui_component;
                 gui_world->m_Components.EraseSwap(i);
                 break;
@@ -1062,7 +1069,7 @@ namespace dmGameSystem
     }
 
     static void ApplyStencilClipping(RenderGuiContext* gui_context, const dmGui::StencilScope* state, dmRender::StencilTestParams& stp) {
-        if (state != 0x0) {
+        if (state != 0x0 && state->m_UseStencil) {
             stp.m_Front.m_Func = dmGraphics::COMPARE_FUNC_EQUAL;
             stp.m_Front.m_OpSFail = dmGraphics::STENCIL_OP_KEEP;
             stp.m_Front.m_OpDPFail = dmGraphics::STENCIL_OP_REPLACE;
@@ -1097,11 +1104,19 @@ namespace dmGameSystem
     static void ApplyStencilClipping(RenderGuiContext* gui_context, const dmGui::StencilScope* state, dmRender::RenderObject& ro) {
         ro.m_SetStencilTest = 1;
         ApplyStencilClipping(gui_context, state, ro.m_StencilTestParams);
+        ro.m_SetScissor = state != 0x0 && state->m_UseScissor;
+        if (ro.m_SetScissor) {
+            ro.m_ScissorRect = Vector4(state->m_ScissorRect[0], state->m_ScissorRect[1], state->m_ScissorRect[2], state->m_ScissorRect[3]);
+        }
     }
 
     static void ApplyStencilClipping(RenderGuiContext* gui_context, const dmGui::StencilScope* state, dmRender::DrawTextParams& params) {
         params.m_StencilTestParamsSet = 1;
         ApplyStencilClipping(gui_context, state, params.m_StencilTestParams);
+        params.m_ScissorSet = state != 0x0 && state->m_UseScissor;
+        if (params.m_ScissorSet) {
+            params.m_ScissorRect = Vector4(state->m_ScissorRect[0], state->m_ScissorRect[1], state->m_ScissorRect[2], state->m_ScissorRect[3]);
+        }
     }
 
     static inline dmGraphics::HTexture GetNodeTexture(dmGui::HScene scene, dmGui::HNode node)
@@ -1481,6 +1496,315 @@ namespace dmGameSystem
         }
     }
 
+    // Vertex ranges closer than this are uploaded together
+    static const uint32_t GUI_DIRTY_VERTEX_RANGE_MERGE_GAP = 64;
+
+    static void MarkVertexRangeDirty(GuiWorld* gui_world, uint32_t start, uint32_t end)
+    {
+        if (start == end)
+            return;
+
+        dmArray<GuiVertexRange>& ranges = gui_world->m_DirtyVertexRanges;
+        if (!ranges.Empty() && start <= ranges.Back().m_End + GUI_DIRTY_VERTEX_RANGE_MERGE_GAP)
+        {
+            ranges.Back().m_End = dmMath::Max(ranges.Back().m_End, end);
+            return;
+        }
+
+        if (ranges.Full())
+        {
+            ranges.OffsetCapacity(dmMath::Max(16U, ranges.Capacity()));
+        }
+        GuiVertexRange range = {start, end};
+        ranges.Push(range);
+    }
+
+    // Vertices are only uploaded once per frame, after all scenes are rendered. If the vertex count is
+    // unchanged since the previous frame, only the ranges that were modified are uploaded.
+    static void UploadVertexBuffer(GuiWorld* gui_world)
+    {
+        DM_PROFILE("UploadVertexBuffer");
+
+        const dmArray<BoxVertex>& vertices = gui_world->m_ClientVertexBuffer;
+        const dmArray<GuiVertexRange>& ranges = gui_world->m_DirtyVertexRanges;
+        uint32_t vertex_count = vertices.Size();
+
+        if (vertex_count != gui_world->m_UploadedVertexCount)
+        {
+            dmGraphics::SetVertexBufferData(gui_world->m_VertexBuffer,
+                                            vertex_count * sizeof(BoxVertex),
+                                            vertices.Begin(),
+                                            dmGraphics::BUFFER_USAGE_DYNAMIC_DRAW);
+            gui_world->m_UploadedVertexCount = vertex_count;
+        }
+        else
+        {
+            for (uint32_t i = 0; i < ranges.Size(); ++i)
+            {
+                const GuiVertexRange& range = ranges[i];
+                dmGraphics::SetVertexBufferSubData(gui_world->m_VertexBuffer,
+                                                   range.m_Start * sizeof(BoxVertex),
+                                                   (range.m_End - range.m_Start) * sizeof(BoxVertex),
+                                                   vertices.Begin() + range.m_Start);
+            }
+        }
+
+        gui_world->m_DirtyVertexRanges.SetSize(0);
+
+        DM_PROPERTY_ADD_U32(rmtp_GuiVertexCount, vertex_count);
+    }
+
+    static BoxNodeVertexCache* GetBoxNodeVertexCache(GuiComponent* component)
+    {
+        dmArray<BoxNodeVertexCache>& caches = component->m_BoxVertexCache;
+        uint32_t index = component->m_BoxVertexCacheCursor++;
+        if (index >= caches.Size())
+        {
+            if (caches.Full())
+            {
+                caches.OffsetCapacity(dmMath::Max(16U, caches.Capacity()));
+            }
+            caches.SetSize(index + 1);
+            memset(&caches[index], 0, sizeof(BoxNodeVertexCache));
+        }
+        return &caches[index];
+    }
+
+    static void DeleteBoxNodeVertexCache(GuiComponent* component)
+    {
+        dmArray<BoxNodeVertexCache>& caches = component->m_BoxVertexCache;
+        for (uint32_t i = 0; i < caches.Size(); ++i)
+        {
+            free(caches[i].m_Vertices);
+        }
+        caches.SetCapacity(0);
+    }
+
+    static void GenerateBoxNodeVertices(const Matrix4& transform,
+                        const Vector4& pm_color,
+                        const float* tc,
+                        bool manually_set_texture,
+                        const Vector4& slice9,
+                        const Point3& size,
+                        dmGraphics::HTexture texture,
+                        float org_width,
+                        float org_height,
+                        dmGameSystemDDF::TextureSet* texture_set_ddf,
+                        uint32_t animation_frame,
+                        bool flip_u,
+                        bool flip_v,
+                        dmArray<BoxVertex>& vertex_buffer)
+    {
+        bool use_slice_nine = sum(slice9) != 0;
+
+        // render simple quad ignoring 9-slicing
+        if ((!use_slice_nine && manually_set_texture) || !texture)
+        {
+            BoxVertex v00;
+            v00.SetColor(pm_color);
+            v00.SetPosition(transform * Point3(0, 0, 0));
+            v00.SetUV(0, 0);
+            v00.SetPageIndex(0);
+
+            BoxVertex v10;
+            v10.SetColor(pm_color);
+            v10.SetPosition(transform * Point3(1, 0, 0));
+            v10.SetUV(1, 0);
+            v10.SetPageIndex(0);
+
+            BoxVertex v01;
+            v01.SetColor(pm_color);
+            v01.SetPosition(transform * Point3(0, 1, 0));
+            v01.SetUV(0, 1);
+            v01.SetPageIndex(0);
+
+            BoxVertex v11;
+            v11.SetColor(pm_color);
+            v11.SetPosition(transform * Point3(1, 1, 0));
+            v11.SetUV(1, 1);
+            v11.SetPageIndex(0);
+
+            vertex_buffer.Push(v00);
+            vertex_buffer.Push(v10);
+            vertex_buffer.Push(v11);
+            vertex_buffer.Push(v00);
+            vertex_buffer.Push(v11);
+            vertex_buffer.Push(v01);
+
+            return;
+        }
+
+        uint32_t frame_index                         = 0;
+        uint32_t page_index                          = 0;
+
+        if (texture_set_ddf)
+        {
+            frame_index            = texture_set_ddf->m_FrameIndices[animation_frame];
+            uint32_t* page_indices = texture_set_ddf->m_PageIndices.m_Data;
+            page_index             = page_indices[frame_index];
+        }
+
+        bool use_geometries = texture_set_ddf && texture_set_ddf->m_Geometries.m_Count > 0;
+        // render using geometries without 9-slicing
+        if (!use_slice_nine && use_geometries)
+        {
+            const dmGameSystemDDF::SpriteGeometry* geometry = &texture_set_ddf->m_Geometries.m_Data[frame_index];
+
+            const Matrix4& w = transform;
+
+            // NOTE: The original rendering code is from the comp_sprite.cpp.
+            // Compare with that one if you do any changes to either.
+            uint32_t num_points = geometry->m_Vertices.m_Count / 2;
+
+            const float* points = geometry->m_Vertices.m_Data;
+            const float* uvs = geometry->m_Uvs.m_Data;
+
+            // Depending on the sprite is flipped or not, we loop the vertices forward or backward
+            // to respect face winding (and backface culling)
+            int reverse = (int)flip_u ^ (int)flip_v;
+
+            float scaleX = flip_u ? -1 : 1;
+            float scaleY = flip_v ? -1 : 1;
+
+            // Since we don't use an index buffer, we duplicate the vertices manually
+            uint32_t index_count = geometry->m_Indices.m_Count;
+            for (uint32_t index = 0; index < index_count; ++index)
+            {
+                uint32_t i = geometry->m_Indices.m_Data[index];
+                i = reverse ? (num_points - i - 1) : i;
+
+                const float* point = &points[i * 2];
+                const float* uv = &uvs[i * 2];
+                // COnvert from range [-0.5,+0.5] to [0.0, 1.0]
+                float x = point[0] * scaleX + 0.5f;
+                float y = point[1] * scaleY + 0.5f;
+
+                Vector4 p = w * Point3(x, y, 0.0f);
+                BoxVertex v(p, uv[0], uv[1], pm_color, page_index);
+                vertex_buffer.Push(v);
+            }
+
+            return;
+        }
+
+        // render 9-sliced node
+
+        //   0 1     2 3
+        // 0 *-*-----*-*
+        //   | |  y  | |
+        // 1 *-*-----*-*
+        //   | |     | |
+        //   |x|     |z|
+        //   | |     | |
+        // 2 *-*-----*-*
+        //   | |  w  | |
+        // 3 *-*-----*-*
+        float us[4], vs[4], xs[4], ys[4];
+
+        // v are '1-v'
+        xs[0] = ys[0] = 0;
+        xs[3] = ys[3] = 1;
+
+        // disable slice9 computation below a certain dimension
+        // (avoid div by zero)
+        const float s9_min_dim = 0.001f;
+
+        const float su = 1.0f / org_width;
+        const float sv = 1.0f / org_height;
+
+        const float sx = size.getX() > s9_min_dim ? 1.0f / size.getX() : 0;
+        const float sy = size.getY() > s9_min_dim ? 1.0f / size.getY() : 0;
+
+        static const uint32_t uvIndex[2][4] = {{0,1,2,3}, {3,2,1,0}};
+        bool uv_rotated = tc[0] != tc[2] && tc[3] != tc[5];
+        if(uv_rotated)
+        {
+            const uint32_t *uI = flip_v ? uvIndex[1] : uvIndex[0];
+            const uint32_t *vI = flip_u ? uvIndex[1] : uvIndex[0];
+            us[uI[0]] = tc[0];
+            us[uI[1]] = tc[0] + (su * slice9.getW());
+            us[uI[2]] = tc[2] - (su * slice9.getY());
+            us[uI[3]] = tc[2];
+            vs[vI[0]] = tc[1];
+            vs[vI[1]] = tc[1] - (sv * slice9.getX());
+            vs[vI[2]] = tc[5] + (sv * slice9.getZ());
+            vs[vI[3]] = tc[5];
+        }
+        else
+        {
+            const uint32_t *uI = flip_u ? uvIndex[1] : uvIndex[0];
+            const uint32_t *vI = flip_v ? uvIndex[1] : uvIndex[0];
+            us[uI[0]] = tc[0];
+            us[uI[1]] = tc[0] + (su * slice9.getX());
+            us[uI[2]] = tc[4] - (su * slice9.getZ());
+            us[uI[3]] = tc[4];
+            vs[vI[0]] = tc[1];
+            vs[vI[1]] = tc[1] + (sv * slice9.getW());
+            vs[vI[2]] = tc[3] - (sv * slice9.getY());
+            vs[vI[3]] = tc[3];
+        }
+
+        xs[1] = sx * slice9.getX();
+        xs[2] = 1 - sx * slice9.getZ();
+        ys[1] = sy * slice9.getW();
+        ys[2] = 1 - sy * slice9.getY();
+
+        Vector4 pts[4][4];
+        for (int y=0;y<4;y++)
+        {
+            for (int x=0;x<4;x++)
+            {
+                pts[y][x] = (transform * Point3(xs[x], ys[y], 0));
+            }
+        }
+
+        BoxVertex v00, v10, v01, v11;
+        v00.SetColor(pm_color);
+        v10.SetColor(pm_color);
+        v01.SetColor(pm_color);
+        v11.SetColor(pm_color);
+
+        v00.SetPageIndex(page_index);
+        v10.SetPageIndex(page_index);
+        v01.SetPageIndex(page_index);
+        v11.SetPageIndex(page_index);
+
+        for (int y=0;y<3;y++)
+        {
+            for (int x=0;x<3;x++)
+            {
+                const int x0 = x;
+                const int x1 = x+1;
+                const int y0 = y;
+                const int y1 = y+1;
+                v00.SetPosition(pts[y0][x0]);
+                v10.SetPosition(pts[y0][x1]);
+                v01.SetPosition(pts[y1][x0]);
+                v11.SetPosition(pts[y1][x1]);
+                if(uv_rotated)
+                {
+                    v00.SetUV(us[y0], vs[x0]);
+                    v10.SetUV(us[y0], vs[x1]);
+                    v01.SetUV(us[y1], vs[x0]);
+                    v11.SetUV(us[y1], vs[x1]);
+                }
+                else
+                {
+                    v00.SetUV(us[x0], vs[y0]);
+                    v10.SetUV(us[x1], vs[y0]);
+                    v01.SetUV(us[x0], vs[y1]);
+                    v11.SetUV(us[x1], vs[y1]);
+                }
+                vertex_buffer.Push(v00);
+                vertex_buffer.Push(v10);
+                vertex_buffer.Push(v11);
+                vertex_buffer.Push(v00);
+                vertex_buffer.Push(v11);
+                vertex_buffer.Push(v01);
+            }
+        }
+    }
+
     static void RenderBoxNodes(dmGui::HScene scene,
                         const dmGui::RenderEntry* entries,
                         const Matrix4* node_transforms,
@@ -1543,7 +1867,9 @@ namespace dmGameSystem
         float org_height = (float)dmGraphics::GetOriginalTextureHeight(ro.m_Textures[0]);
         assert(org_width > 0 && org_height > 0);
 
-        int rendered_vert_count = 0;
+        GuiComponent* component = gui_context->m_Component;
+        uint32_t render_frame = gui_world->m_RenderFrame;
+
         for (uint32_t i = 0; i < node_count; ++i)
         {
             const dmGui::HNode node = entries[i].m_Node;
@@ -1563,59 +1889,11 @@ namespace dmGameSystem
             }
 
             Vector4 slice9 = dmGui::GetNodeSlice9(scene, node);
-            bool use_slice_nine = sum(slice9) != 0;
-
-            // render simple quad ignoring 9-slicing
-            if ((!use_slice_nine && manually_set_texture) || !texture)
-            {
-                BoxVertex v00;
-                v00.SetColor(pm_color);
-                v00.SetPosition(node_transforms[i] * Point3(0, 0, 0));
-                v00.SetUV(0, 0);
-                v00.SetPageIndex(0);
-
-                BoxVertex v10;
-                v10.SetColor(pm_color);
-                v10.SetPosition(node_transforms[i] * Point3(1, 0, 0));
-                v10.SetUV(1, 0);
-                v10.SetPageIndex(0);
-
-                BoxVertex v01;
-                v01.SetColor(pm_color);
-                v01.SetPosition(node_transforms[i] * Point3(0, 1, 0));
-                v01.SetUV(0, 1);
-                v01.SetPageIndex(0);
-
-                BoxVertex v11;
-                v11.SetColor(pm_color);
-                v11.SetPosition(node_transforms[i] * Point3(1, 1, 0));
-                v11.SetUV(1, 1);
-                v11.SetPageIndex(0);
-
-                gui_world->m_ClientVertexBuffer.Push(v00);
-                gui_world->m_ClientVertexBuffer.Push(v10);
-                gui_world->m_ClientVertexBuffer.Push(v11);
-                gui_world->m_ClientVertexBuffer.Push(v00);
-                gui_world->m_ClientVertexBuffer.Push(v11);
-                gui_world->m_ClientVertexBuffer.Push(v01);
-
-                rendered_vert_count += 6;
-                continue;
-            }
-
-            uint32_t frame_index                         = 0;
-            uint32_t page_index                          = 0;
+            Point3 size = dmGui::GetNodeSize(scene, node);
 
             dmGameSystemDDF::TextureSet* texture_set_ddf = GetNodeTextureSetDDF(scene, node);
-            if (texture_set_ddf)
-            {
-                frame_index            = dmGui::GetNodeAnimationFrame(scene, node);
-                frame_index            = texture_set_ddf->m_FrameIndices[frame_index];
-                uint32_t* page_indices = texture_set_ddf->m_PageIndices.m_Data;
-                page_index             = page_indices[frame_index];
-            }
+            uint32_t animation_frame = texture_set_ddf ? dmGui::GetNodeAnimationFrame(scene, node) : 0;
 
-            bool use_geometries = texture_set_ddf && texture_set_ddf->m_Geometries.m_Count > 0;
             bool flip_u = false;
             bool flip_v = false;
             if (!manually_set_texture)
@@ -1623,171 +1901,68 @@ namespace dmGameSystem
                 GetNodeFlipbookAnimUVFlip(scene, node, flip_u, flip_v);
             }
 
-            // render using geometries without 9-slicing
-            if (!use_slice_nine && use_geometries)
-            {
-                const dmGameSystemDDF::SpriteGeometry* geometry = &texture_set_ddf->m_Geometries.m_Data[frame_index];
-
-                const Matrix4& w = node_transforms[i];
-
-                // NOTE: The original rendering code is from the comp_sprite.cpp.
-                // Compare with that one if you do any changes to either.
-                uint32_t num_points = geometry->m_Vertices.m_Count / 2;
-
-                const float* points = geometry->m_Vertices.m_Data;
-                const float* uvs = geometry->m_Uvs.m_Data;
-
-                // Depending on the sprite is flipped or not, we loop the vertices forward or backward
-                // to respect face winding (and backface culling)
-                int reverse = (int)flip_u ^ (int)flip_v;
-
-                float scaleX = flip_u ? -1 : 1;
-                float scaleY = flip_v ? -1 : 1;
-
-                // Since we don't use an index buffer, we duplicate the vertices manually
-                uint32_t index_count = geometry->m_Indices.m_Count;
-                for (uint32_t index = 0; index < index_count; ++index)
+            BoxNodeVertexKey key;
+            memset(&key, 0, sizeof(key));
+            memcpy(key.m_Transform, &node_transforms[i], sizeof(key.m_Transform));
+            key.m_Color[0] = pm_color.getX();
+            key.m_Color[1] = pm_color.getY();
+            key.m_Color[2] = pm_color.getZ();
+            key.m_Color[3] = pm_color.getW();
+            key.m_Slice9[0] = slice9.getX();
+            key.m_Slice9[1] = slice9.getY();
+            key.m_Slice9[2] = slice9.getZ();
+            key.m_Slice9[3] = slice9.getW();
+            memcpy(key.m_TexCoords, tc, sizeof(key.m_TexCoords));
+            key.m_Size[0] = size.getX();
+            key.m_Size[1] = size.getY();
+            key.m_TextureSize[0] = org_width;
+            key.m_TextureSize[1] = org_height;
+            key.m_Texture = texture;
+            key.m_TextureSet = texture_set_ddf;
+            key.m_AnimationFrame = animation_frame;
+            key.m_Flags = (manually_set_texture ? 1 : 0) | (flip_u ? 2 : 0) | (flip_v ? 4 : 0);
+
+            uint32_t vertex_start = gui_world->m_ClientVertexBuffer.Size();
+            BoxNodeVertexCache* cache = GetBoxNodeVertexCache(component);
+
+            if (cache->m_Vertices && cache->m_Node == node && memcmp(&cache->m_Key, &key, sizeof(key)) == 0)
+            {
+                uint32_t vertex_count = cache->m_VertexCount;
+                gui_world->m_ClientVertexBuffer.SetSize(vertex_start + vertex_count);
+                memcpy(gui_world->m_ClientVertexBuffer.Begin() + vertex_start, cache->m_Vertices, vertex_count * sizeof(BoxVertex));
+
+                // The vertices are already uploaded if the node was at the same place in the previous frame
+                if (cache->m_LastRenderFrame + 1 != render_frame || cache->m_LastVertexStart != vertex_start)
                 {
-                    uint32_t i = geometry->m_Indices.m_Data[index];
-                    i = reverse ? (num_points - i - 1) : i;
-
-                    const float* point = &points[i * 2];
-                    const float* uv = &uvs[i * 2];
-                    // COnvert from range [-0.5,+0.5] to [0.0, 1.0]
-                    float x = point[0] * scaleX + 0.5f;
-                    float y = point[1] * scaleY + 0.5f;
-
-                    Vector4 p = w * Point3(x, y, 0.0f);
-                    BoxVertex v(p, uv[0], uv[1], pm_color, page_index);
-                    gui_world->m_ClientVertexBuffer.Push(v);
+                    MarkVertexRangeDirty(gui_world, vertex_start, vertex_start + vertex_count);
                 }
-
-                rendered_vert_count += index_count;
-                continue;
-            }
-
-            // render 9-sliced node
-
-            //   0 1     2 3
-            // 0 *-*-----*-*
-            //   | |  y  | |
-            // 1 *-*-----*-*
-            //   | |     | |
-            //   |x|     |z|
-            //   | |     | |
-            // 2 *-*-----*-*
-            //   | |  w  | |
-            // 3 *-*-----*-*
-            float us[4], vs[4], xs[4], ys[4];
-
-            // v are '1-v'
-            xs[0] = ys[0] = 0;
-            xs[3] = ys[3] = 1;
-
-            // disable slice9 computation below a certain dimension
-            // (avoid div by zero)
-            const float s9_min_dim = 0.001f;
-
-            const float su = 1.0f / org_width;
-            const float sv = 1.0f / org_height;
-
-            Point3 size = dmGui::GetNodeSize(scene, node);
-            const float sx = size.getX() > s9_min_dim ? 1.0f / size.getX() : 0;
-            const float sy = size.getY() > s9_min_dim ? 1.0f / size.getY() : 0;
-
-            static const uint32_t uvIndex[2][4] = {{0,1,2,3}, {3,2,1,0}};
-            bool uv_rotated = tc[0] != tc[2] && tc[3] != tc[5];
-            if(uv_rotated)
-            {
-                const uint32_t *uI = flip_v ? uvIndex[1] : uvIndex[0];
-                const uint32_t *vI = flip_u ? uvIndex[1] : uvIndex[0];
-                us[uI[0]] = tc[0];
-                us[uI[1]] = tc[0] + (su * slice9.getW());
-                us[uI[2]] = tc[2] - (su * slice9.getY());
-                us[uI[3]] = tc[2];
-                vs[vI[0]] = tc[1];
-                vs[vI[1]] = tc[1] - (sv * slice9.getX());
-                vs[vI[2]] = tc[5] + (sv * slice9.getZ());
-                vs[vI[3]] = tc[5];
             }
             else
             {
-                const uint32_t *uI = flip_u ? uvIndex[1] : uvIndex[0];
-                const uint32_t *vI = flip_v ? uvIndex[1] : uvIndex[0];
-                us[uI[0]] = tc[0];
-                us[uI[1]] = tc[0] + (su * slice9.getX());
-                us[uI[2]] = tc[4] - (su * slice9.getZ());
-                us[uI[3]] = tc[4];
-                vs[vI[0]] = tc[1];
-                vs[vI[1]] = tc[1] + (sv * slice9.getW());
-                vs[vI[2]] = tc[3] - (sv * slice9.getY());
-                vs[vI[3]] = tc[3];
-            }
-
-            xs[1] = sx * slice9.getX();
-            xs[2] = 1 - sx * slice9.getZ();
-            ys[1] = sy * slice9.getW();
-            ys[2] = 1 - sy * slice9.getY();
+                GenerateBoxNodeVertices(node_transforms[i], pm_color, tc, manually_set_texture, slice9, size,
+                                        texture, org_width, org_height, texture_set_ddf, animation_frame, flip_u, flip_v,
+                                        gui_world->m_ClientVertexBuffer);
 
-            const Matrix4* transform = &node_transforms[i];
-            Vector4 pts[4][4];
-            for (int y=0;y<4;y++)
-            {
-                for (int x=0;x<4;x++)
+                uint32_t vertex_count = gui_world->m_ClientVertexBuffer.Size() - vertex_start;
+                // Always allocate, so that nodes without vertices also get a valid entry
+                if (!cache->m_Vertices || cache->m_VertexCapacity < vertex_count)
                 {
-                    pts[y][x] = (*transform * Point3(xs[x], ys[y], 0));
+                    cache->m_VertexCapacity = dmMath::Max(1U, vertex_count);
+                    cache->m_Vertices = (BoxVertex*) realloc(cache->m_Vertices, cache->m_VertexCapacity * sizeof(BoxVertex));
                 }
-            }
-
-            BoxVertex v00, v10, v01, v11;
-            v00.SetColor(pm_color);
-            v10.SetColor(pm_color);
-            v01.SetColor(pm_color);
-            v11.SetColor(pm_color);
-
-            v00.SetPageIndex(page_index);
-            v10.SetPageIndex(page_index);
-            v01.SetPageIndex(page_index);
-            v11.SetPageIndex(page_index);
+                memcpy(cache->m_Vertices, gui_world->m_ClientVertexBuffer.Begin() + vertex_start, vertex_count * sizeof(BoxVertex));
+                cache->m_VertexCount = vertex_count;
+                cache->m_Node = node;
+                cache->m_Key = key;
 
-            for (int y=0;y<3;y++)
-            {
-                for (int x=0;x<3;x++)
-                {
-                    const int x0 = x;
-                    const int x1 = x+1;
-                    const int y0 = y;
-                    const int y1 = y+1;
-                    v00.SetPosition(pts[y0][x0]);
-                    v10.SetPosition(pts[y0][x1]);
-                    v01.SetPosition(pts[y1][x0]);
-                    v11.SetPosition(pts[y1][x1]);
-                    if(uv_rotated)
-                    {
-                        v00.SetUV(us[y0], vs[x0]);
-                        v10.SetUV(us[y0], vs[x1]);
-                        v01.SetUV(us[y1], vs[x0]);
-                        v11.SetUV(us[y1], vs[x1]);
-                    }
-                    else
-                    {
-                        v00.SetUV(us[x0], vs[y0]);
-                        v10.SetUV(us[x1], vs[y0]);
-                        v01.SetUV(us[x0], vs[y1]);
-                        v11.SetUV(us[x1], vs[y1]);
-                    }
-                    gui_world->m_ClientVertexBuffer.Push(v00);
-                    gui_world->m_ClientVertexBuffer.Push(v10);
-                    gui_world->m_ClientVertexBuffer.Push(v11);
-                    gui_world->m_ClientVertexBuffer.Push(v00);
-                    gui_world->m_ClientVertexBuffer.Push(v11);
-                    gui_world->m_ClientVertexBuffer.Push(v01);
-                }
+                MarkVertexRangeDirty(gui_world, vertex_start, vertex_start + vertex_count);
             }
-            rendered_vert_count += verts_per_node;
+
+            cache->m_LastVertexStart = vertex_start;
+            cache->m_LastRenderFrame = render_frame;
         }
 
-        ro.m_VertexCount = rendered_vert_count;
+        ro.m_VertexCount = gui_world->m_ClientVertexBuffer.Size() - ro.m_VertexStart;
     }
 
     // Computes max vertices required in the vertex buffer to draw a pie node with a
@@ -2059,6 +2234,45 @@ namespace dmGameSystem
         return dmGui::GetNodeRenderConstantsHash(scene, node);
     }
 
+    static void RenderBatch(dmGui::HScene scene,
+                    dmGui::NodeType node_type,
+                    uint32_t custom_type,
+                    const dmGui::RenderEntry* entries,
+                    const Matrix4* node_transforms,
+                    const float* node_opacities,
+                    const dmGui::StencilScope** stencil_scopes,
+                    HComponentRenderConstants render_constants,
+                    uint32_t n,
+                    RenderGuiContext* gui_context)
+    {
+        GuiWorld* gui_world = gui_context->m_GuiWorld;
+        uint32_t vertex_start = gui_world->m_ClientVertexBuffer.Size();
+
+        switch (node_type)
+        {
+            case dmGui::NODE_TYPE_TEXT:
+                RenderTextNodes(scene, entries, node_transforms, node_opacities, stencil_scopes, render_constants, n, gui_context);
+                break;
+            case dmGui::NODE_TYPE_BOX:
+                // Box nodes track their own modified vertex ranges
+                RenderBoxNodes(scene, entries, node_transforms, node_opacities, stencil_scopes, render_constants, n, gui_context);
+                return;
+            case dmGui::NODE_TYPE_PIE:
+                RenderPieNodes(scene, entries, node_transforms, node_opacities, stencil_scopes, render_constants, n, gui_context);
+                break;
+            case dmGui::NODE_TYPE_PARTICLEFX:
+                RenderParticlefxNodes(scene, entries, node_transforms, node_opacities, stencil_scopes, render_constants, n, gui_context);
+                break;
+            case dmGui::NODE_TYPE_CUSTOM:
+                RenderCustomNodes(scene, custom_type, GetCompGuiCustomType(gui_world->m_CompGuiContext, custom_type), entries, node_transforms, node_opacities, stencil_scopes, render_constants, n, gui_context);
+                break;
+            default:
+                break;
+        }
+
+        MarkVertexRangeDirty(gui_world, vertex_start, gui_world->m_ClientVertexBuffer.Size());
+    }
+
     // Called from gui.cpp
     static void RenderNodes(dmGui::HScene scene,
                     const dmGui::RenderEntry* entries,
@@ -2155,26 +2369,7 @@ namespace dmGameSystem
             {
                 uint32_t n = i - start;
 
-                switch (prev_node_type)
-                {
-                    case dmGui::NODE_TYPE_TEXT:
-                        RenderTextNodes(scene, entries + start, node_transforms + start, node_opacities + start, stencil_scopes + start, prev_render_constants, n, gui_context);
-                        break;
-                    case dmGui::NODE_TYPE_BOX:
-                        RenderBoxNodes(scene, entries + start, node_transforms + start, node_opacities + start, stencil_scopes + start, prev_render_constants, n, gui_context);
-                        break;
-                    case dmGui::NODE_TYPE_PIE:
-                        RenderPieNodes(scene, entries + start, node_transforms + start, node_opacities + start, stencil_scopes + start, prev_render_constants, n, gui_context);
-                        break;
-                    case dmGui::NODE_TYPE_PARTICLEFX:
-                        RenderParticlefxNodes(scene, entries + start, node_transforms + start, node_opacities + start, stencil_scopes + start, prev_render_constants, n, gui_context);
-                        break;
-                    case dmGui::NODE_TYPE_CUSTOM:
-                        RenderCustomNodes(scene, prev_custom_type, GetCompGuiCustomType(gui_world->m_CompGuiContext, prev_custom_type), entries + start, node_transforms + start, node_opacities + start, stencil_scopes + start, prev_render_constants, n, gui_context);
-                        break;
-                    default:
-                        break;
-                }
+                RenderBatch(scene, prev_node_type, prev_custom_type, entries + start, node_transforms + start, node_opacities + start, stencil_scopes + start, prev_render_constants, n, gui_context);
 
                 start = i;
             }
@@ -2195,34 +2390,8 @@ namespace dmGameSystem
 
         uint32_t n = i - start;
         if (n > 0) {
-            switch (prev_node_type)
-            {
-                case dmGui::NODE_TYPE_TEXT:
-                    RenderTextNodes(scene, entries + start, node_transforms + start, node_opacities + start, stencil_scopes + start, prev_render_constants, n, gui_context);
-                    break;
-                case dmGui::NODE_TYPE_BOX:
-                    RenderBoxNodes(scene, entries + start, node_transforms + start, node_opacities + start, stencil_scopes + start, prev_render_constants, n, gui_context);
-                    break;
-                case dmGui::NODE_TYPE_PIE:
-                    RenderPieNodes(scene, entries + start, node_transforms + start, node_opacities + start, stencil_scopes + start, prev_render_constants, n, gui_context);
-                    break;
-                case dmGui::NODE_TYPE_PARTICLEFX:
-                    RenderParticlefxNodes(scene, entries + start, node_transforms + start, node_opacities + start, stencil_scopes + start, prev_render_constants, n, gui_context);
-                    break;
-                case dmGui::NODE_TYPE_CUSTOM:
-                    RenderCustomNodes(scene, prev_custom_type, GetCompGuiCustomType(gui_world->m_CompGuiContext, prev_custom_type), entries + start, node_transforms + start, node_opacities + start, stencil_scopes + start, prev_render_constants, n, gui_context);
-                    break;
-                default:
-                    break;
-            }
+            RenderBatch(scene, prev_node_type, prev_custom_type, entries + start, node_transforms + start, node_opacities + start, stencil_scopes + start, prev_render_constants, n, gui_context);
         }
-
-        dmGraphics::SetVertexBufferData(gui_world->m_VertexBuffer,
-                                        gui_world->m_ClientVertexBuffer.Size() * sizeof(BoxVertex),
-                                        gui_world->m_ClientVertexBuffer.Begin(),
-                                        dmGraphics::BUFFER_USAGE_STREAM_DRAW);
-
-        DM_PROPERTY_ADD_U32(rmtp_GuiVertexCount, gui_world->m_ClientVertexBuffer.Size());
     }
 
     static dmGraphics::TextureFormat ToGraphicsFormat(dmImage::Type type)
@@ -2479,8 +2648,11 @@ namespace dmGameSystem
         RenderGuiContext render_gui_context;
         render_gui_context.m_RenderContext = gui_context->m_RenderContext;
         render_gui_context.m_GuiWorld = gui_world;
+        render_gui_context.m_Component = 0;
         render_gui_context.m_NextSortOrder = 0;
 
+        gui_world->m_RenderFrame++;
+
         uint32_t total_node_count = 0;
         for (uint32_t i = 0; i < gui_world->m_Components.Size(); ++i)
         {
@@ -2515,6 +2687,8 @@ namespace dmGameSystem
 
             // Render scene and see how many render objects it added, then we add those individually.
             render_gui_context.m_Material = GetMaterial(c, c->m_Resource);
+            render_gui_context.m_Component = c;
+            c->m_BoxVertexCacheCursor = 0;
             dmGui::RenderScene(c->m_Scene, rp, &render_gui_context);
             const uint32_t count = gui_world->m_GuiRenderObjects.Size() - lastEnd;
 
@@ -2540,6 +2714,8 @@ namespace dmGameSystem
             dmRender::RenderListSubmit(gui_context->m_RenderContext, render_list, write_ptr);
         }
 
+        UploadVertexBuffer(gui_world);
+
         return dmGameObject::UPDATE_RESULT_OK;
     }
 
@@ -2596,6 +2772,7 @@ namespace dmGameSystem
             gui_input_action.m_AccZ = params.m_InputAction->m_AccZ;
             gui_input_action.m_AccelerationSet = params.m_InputAction->m_AccelerationSet;
             gui_input_action.m_UserID = params.m_InputAction->m_UserID;
+            gui_input_action.m_Time = params.m_InputAction->m_Time;
 
             gui_input_action.m_TouchCount = params.m_InputAction->m_TouchCount;
             int tc = params.m_InputAction->m_TouchCount;
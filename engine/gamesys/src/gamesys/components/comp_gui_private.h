@@ -31,6 +31,33 @@ namespace dmGameSystem
     struct GuiSceneResource;
     struct MaterialResource;
 
+    // Identifies the inputs used to generate the vertices of a box node. If the key
+    // of a node is unchanged since the previous frame, the cached vertices are reused.
+    struct BoxNodeVertexKey
+    {
+        float                   m_Transform[16];
+        float                   m_Color[4];
+        float                   m_Slice9[4];
+        float                   m_TexCoords[6];
+        float                   m_Size[2];
+        float                   m_TextureSize[2];
+        dmGraphics::HTexture    m_Texture;
+        const void*             m_TextureSet;
+        uint32_t                m_AnimationFrame;
+        uint32_t                m_Flags;
+    };
+
+    struct BoxNodeVertexCache
+    {
+        BoxNodeVertexKey        m_Key;
+        struct BoxVertex*       m_Vertices;
+        dmGui::HNode            m_Node;
+        uint32_t                m_VertexCount;
+        uint32_t                m_VertexCapacity;
+        uint32_t                m_LastVertexStart;
+        uint32_t                m_LastRenderFrame;
+    };
+
     struct GuiComponent
     {
         struct GuiWorld*        m_World;
@@ -44,6 +71,9 @@ namespace dmGameSystem
         uint8_t                 m_Initialized   : 1;
         uint8_t                 m_Padding       : 5;
         dmArray<void*>          m_ResourcePropertyPointers;
+        // Box node vertices, indexed in the order the box nodes are rendered
+        dmArray<BoxNodeVertexCache> m_BoxVertexCache;
+        uint32_t                m_BoxVertexCacheCursor;
     };
 
     struct BoxVertex
@@ -89,6 +119,12 @@ namespace dmGameSystem
         float m_PageIndex;
     };
 
+    struct GuiVertexRange
+    {
+        uint32_t m_Start;
+        uint32_t m_End;
+    };
+
     struct GuiRenderObject
     {
         dmRender::RenderObject m_RenderObject;
@@ -139,6 +175,10 @@ namespace dmGameSystem
         uint32_t                                 m_BoxVertexStreamDeclarationCount;
         uint32_t                                 m_BoxVertexStructSize;
         dmArray<BoxVertex>                       m_ClientVertexBuffer;
+        // Ranges of m_ClientVertexBuffer that differ from what was uploaded the previous frame
+        dmArray<GuiVertexRange>                  m_DirtyVertexRanges;
+        uint32_t                                 m_UploadedVertexCount;
+        uint32_t                                 m_RenderFrame;
         dmGraphics::HTexture                     m_WhiteTexture;
         dmParticle::HParticleContext             m_ParticleContext;
         dmGraphics::VertexAttributeInfos         m_ParticleAttributeInfos;
@@ -30,6 +30,7 @@
 #include <dlib/math.h>
 #include <dlib/transform.h>
 #include <dmsdk/dlib/vmath.h>
+#include <dmsdk/dlib/intersection.h>
 #include <graphics/graphics.h>
 #include <render/render.h>
 #include <render/font_renderer.h>
@@ -64,10 +65,13 @@ namespace dmGameSystem
         Vector4                     m_Outline;
         Vector4                     m_Shadow;
         Matrix4                     m_World;
+        Point3                      m_CullingCenter;
+        float                       m_CullingRadiusSq;
         uint32_t                    m_Pivot;
         // Hash of the components properties. Hash is used to be compatible with 64-bit arch as a 32-bit value is used for sorting
         // See GenerateKeys
         uint32_t                    m_MixedHash;
+        dmGraphics::HTexture        m_Texture; // The glyph cache texture in the hash
         dmGameObject::HInstance     m_ListenerInstance;
         dmhash_t                    m_ListenerComponent;
         LabelResource*              m_Resource;
@@ -91,7 +95,15 @@ namespace dmGameSystem
 
     struct LabelWorld
     {
-        dmObjectPool<LabelComponent>    m_Components;
+        dmObjectPool<LabelComponent>            m_Components;
+        dmArray<dmRender::RenderObject*>        m_RenderObjects;
+        dmArray<dmRender::HNamedConstantBuffer> m_ConstantBuffers;  // 1:1 index mapping with the render objects
+        dmRender::HBufferedRenderBuffer         m_VertexBuffer;
+        uint8_t*                                m_VertexBufferData;
+        uint32_t                                m_VertexBufferCapacity; // In vertices
+        uint32_t                                m_VertexCount;          // Vertices written in the current dispatch
+        uint32_t                                m_RenderObjectsInUse;
+        uint32_t                                m_DispatchCount;
     };
 
     DM_GAMESYS_PROP_VECTOR3(LABEL_PROP_SCALE, scale, false);
@@ -110,6 +122,12 @@ namespace dmGameSystem
         uint32_t comp_count = dmMath::Min(params.m_MaxComponentInstances, label_context->m_MaxLabelCount);
         world->m_Components.SetCapacity(comp_count);
         memset(world->m_Components.GetRawObjects().Begin(), 0, sizeof(LabelComponent) * comp_count);
+        world->m_VertexBuffer = dmRender::NewBufferedRenderBuffer(label_context->m_RenderContext, dmRender::RENDER_BUFFER_TYPE_VERTEX_BUFFER);
+        world->m_VertexBufferData = 0;
+        world->m_VertexBufferCapacity = 0;
+        world->m_VertexCount = 0;
+        world->m_RenderObjectsInUse = 0;
+        world->m_DispatchCount = 0;
 
         *params.m_World = world;
         return dmGameObject::CREATE_RESULT_OK;
@@ -130,6 +148,16 @@ namespace dmGameSystem
             }
         }
 
+        for (uint32_t i = 0; i < world->m_RenderObjects.Size(); ++i)
+        {
+            delete world->m_RenderObjects[i];
+            dmRender::DeleteNamedConstantBuffer(world->m_ConstantBuffers[i]);
+        }
+
+        LabelContext* label_context = (LabelContext*)params.m_Context;
+        dmRender::DeleteBufferedRenderBuffer(label_context->m_RenderContext, world->m_VertexBuffer);
+        dmMemory::AlignedFree(world->m_VertexBufferData);
+
         delete world;
         return dmGameObject::CREATE_RESULT_OK;
     }
@@ -153,17 +181,18 @@ namespace dmGameSystem
 
     void ReHash(LabelComponent* component)
     {
-        // Hash resource-ptr, material-handle, blend mode and render constants
+        // Hash glyph cache texture, material-handle, blend mode and render constants
         HashState32 state;
         bool reverse = false;
         LabelResource* resource = component->m_Resource;
         dmGameSystemDDF::LabelDesc* ddf = resource->m_DDF;
         dmRender::HMaterial material = GetMaterial(component, resource);
-        FontResource* font = GetFontResource(component, resource);
+        // The distance field fonts of a glyph bank share the cache texture, and batch together
+        component->m_Texture = dmRender::GetFontMapTexture(GetFontMap(component, resource));
 
         dmHashInit32(&state, reverse);
         dmHashUpdateBuffer32(&state, &material, sizeof(material));
-        dmHashUpdateBuffer32(&state, font, sizeof(font));
+        dmHashUpdateBuffer32(&state, &component->m_Texture, sizeof(component->m_Texture));
         dmHashUpdateBuffer32(&state, &ddf->m_BlendMode, sizeof(ddf->m_BlendMode));
         dmHashUpdateBuffer32(&state, &ddf->m_Color, sizeof(ddf->m_Color));
         dmHashUpdateBuffer32(&state, &ddf->m_Outline, sizeof(ddf->m_Outline));
@@ -361,8 +390,13 @@ namespace dmGameSystem
 
     dmGameObject::UpdateResult CompLabelUpdate(const dmGameObject::ComponentsUpdateParams& params, dmGameObject::ComponentsUpdateResult& update_result)
     {
-        (void)params;
         (void)update_result;
+        LabelContext* label_context = (LabelContext*)params.m_Context;
+        LabelWorld* world = (LabelWorld*)params.m_World;
+
+        dmRender::TrimBuffer(label_context->m_RenderContext, world->m_VertexBuffer);
+        dmRender::RewindBuffer(label_context->m_RenderContext, world->m_VertexBuffer);
+        world->m_DispatchCount = 0;
         return dmGameObject::UPDATE_RESULT_OK;
     }
 
@@ -454,6 +488,119 @@ namespace dmGameSystem
         }
     }
 
+    static void RenderBatch(LabelWorld* world, dmRender::HRenderContext render_context, dmRender::RenderListEntry* buf, uint32_t* begin, uint32_t* end)
+    {
+        DM_PROFILE("LabelRenderBatch");
+
+        if (dmRender::GetBufferIndex(render_context, world->m_VertexBuffer) < world->m_DispatchCount)
+        {
+            dmRender::AddRenderBuffer(render_context, world->m_VertexBuffer);
+        }
+
+        dmArray<LabelComponent>& components = world->m_Components.GetRawObjects();
+        LabelComponent* first = &components[buf[*begin].m_UserData];
+        LabelResource* resource = first->m_Resource;
+        dmRender::HFontMap font_map = GetFontMap(first, resource);
+
+        // The render objects are passed by pointer to the renderer, so they can't be kept in a growing array
+        if (world->m_RenderObjectsInUse == world->m_RenderObjects.Size())
+        {
+            world->m_RenderObjects.OffsetCapacity(1);
+            world->m_RenderObjects.Push(new dmRender::RenderObject);
+            world->m_ConstantBuffers.OffsetCapacity(1);
+            world->m_ConstantBuffers.Push(dmRender::NewNamedConstantBuffer());
+        }
+
+        dmRender::HNamedConstantBuffer constants = world->m_ConstantBuffers[world->m_RenderObjectsInUse];
+        dmRender::RenderObject& ro = *world->m_RenderObjects[world->m_RenderObjectsInUse++];
+
+        dmRender::ClearNamedConstantBuffer(constants);
+        if (first->m_RenderConstants)
+        {
+            uint32_t size = dmGameSystem::GetRenderConstantCount(first->m_RenderConstants);
+            for (uint32_t i = 0; i < size; ++i)
+            {
+                dmRender::HConstant constant = dmGameSystem::GetRenderConstant(first->m_RenderConstants, i);
+                dmRender::SetNamedConstants(constants, &constant, 1);
+            }
+        }
+        dmRender::BeginTextBatch(render_context, font_map, constants);
+
+        dmRender::DrawTextParams text_params;
+        CreateDrawTextParams(first, text_params);
+
+        ro.Init();
+        ro.m_VertexDeclaration = dmRender::GetTextVertexDeclaration(render_context);
+        ro.m_VertexBuffer = (dmGraphics::HVertexBuffer) dmRender::GetBuffer(render_context, world->m_VertexBuffer);
+        ro.m_PrimitiveType = dmGraphics::PRIMITIVE_TRIANGLES;
+        ro.m_Material = GetMaterial(first, resource);
+        ro.m_Textures[0] = dmRender::GetFontMapTexture(font_map);
+        ro.m_ConstantBuffer = constants;
+        ro.m_SourceBlendFactor = text_params.m_SourceBlendFactor;
+        ro.m_DestinationBlendFactor = text_params.m_DestinationBlendFactor;
+        ro.m_SetBlendFactors = 1;
+        ro.m_VertexStart = world->m_VertexCount;
+
+        uint32_t vertex_size = dmRender::GetTextVertexSize();
+        for (uint32_t* i = begin; i != end; ++i)
+        {
+            LabelComponent* component = &components[buf[*i].m_UserData];
+            CreateDrawTextParams(component, text_params);
+
+            // The labels may use different fonts, sharing the glyph cache
+            uint8_t* vertices = world->m_VertexBufferData + world->m_VertexCount * vertex_size;
+            world->m_VertexCount += dmRender::CreateTextVertexData(render_context, GetFontMap(component, component->m_Resource), text_params, vertices, world->m_VertexBufferCapacity - world->m_VertexCount);
+        }
+
+        ro.m_VertexCount = world->m_VertexCount - ro.m_VertexStart;
+
+        dmRender::EndTextBatch(render_context, font_map);
+        dmRender::AddToRender(render_context, &ro);
+    }
+
+    static void RenderListDispatch(dmRender::RenderListDispatchParams const &params)
+    {
+        LabelWorld* world = (LabelWorld*) params.m_UserData;
+
+        switch (params.m_Operation)
+        {
+            case dmRender::RENDER_LIST_OPERATION_BEGIN:
+                world->m_VertexCount = 0;
+                world->m_RenderObjectsInUse = 0;
+                break;
+            case dmRender::RENDER_LIST_OPERATION_END:
+                if (world->m_VertexCount)
+                {
+                    uint32_t vertex_data_size = world->m_VertexCount * dmRender::GetTextVertexSize();
+                    dmRender::SetBufferData(params.m_Context, world->m_VertexBuffer, vertex_data_size, world->m_VertexBufferData, dmGraphics::BUFFER_USAGE_DYNAMIC_DRAW);
+                    world->m_DispatchCount++;
+                }
+                break;
+            default:
+                assert(params.m_Operation == dmRender::RENDER_LIST_OPERATION_BATCH);
+                RenderBatch(world, params.m_Context, params.m_Buf, params.m_Begin, params.m_End);
+        }
+    }
+
+    static void RenderListFrustumCulling(dmRender::RenderListVisibilityParams const &params)
+    {
+        DM_PROFILE("Label");
+
+        LabelWorld* world = (LabelWorld*) params.m_UserData;
+        dmArray<LabelComponent>& components = world->m_Components.GetRawObjects();
+
+        const dmIntersection::Frustum frustum = *params.m_Frustum;
+        uint32_t num_entries = params.m_NumEntries;
+        for (uint32_t i = 0; i < num_entries; ++i)
+        {
+            dmRender::RenderListEntry* entry = &params.m_Entries[i];
+            const LabelComponent* component = &components[entry->m_UserData];
+
+            bool intersect = dmIntersection::TestFrustumSphereSq(frustum, component->m_CullingCenter, component->m_CullingRadiusSq);
+            entry->m_Visibility = intersect ? dmRender::VISIBILITY_FULL : dmRender::VISIBILITY_NONE;
+        }
+    }
+
     dmGameObject::UpdateResult CompLabelRender(const dmGameObject::ComponentsRenderParams& params)
     {
         DM_PROFILE("Render");
@@ -471,36 +618,61 @@ namespace dmGameSystem
 
         UpdateTransforms(world, label_context->m_Subpixels);
 
+        // All labels are written into the same vertex buffer, batched by glyph cache, material, blend mode and constants
+        dmRender::RenderListEntry* render_list = dmRender::RenderListAlloc(render_context, component_count);
+        dmRender::HRenderListDispatch label_dispatch = dmRender::RenderListMakeDispatch(render_context, &RenderListDispatch, &RenderListFrustumCulling, world);
+        dmRender::RenderListEntry* write_ptr = render_list;
+
+        uint32_t vertex_count = 0;
         for (uint32_t i = 0; i < component_count; ++i)
         {
             LabelComponent* component = &components[i];
             if (!component->m_Enabled || !component->m_AddedToUpdate)
                 continue;
 
-            if (component->m_ReHash || (component->m_RenderConstants && dmGameSystem::AreRenderConstantsUpdated(component->m_RenderConstants)))
+            LabelResource* resource = component->m_Resource;
+            dmRender::HFontMap font_map = GetFontMap(component, resource);
+
+            // The font gets a cache texture of its own when it stops sharing it
+            if (component->m_ReHash || component->m_Texture != dmRender::GetFontMapTexture(font_map) ||
+                (component->m_RenderConstants && dmGameSystem::AreRenderConstantsUpdated(component->m_RenderConstants)))
             {
                 ReHash(component);
             }
 
             dmRender::DrawTextParams text_params;
             CreateDrawTextParams(component, text_params);
+            dmRender::GetTextBoundingSphere(font_map, text_params, &component->m_CullingCenter, &component->m_CullingRadiusSq);
+            vertex_count += dmRender::GetTextVertexCount(font_map, component->m_Text);
+
+            write_ptr->m_WorldPosition = Point3(component->m_World.getTranslation());
+            write_ptr->m_UserData = i; // Assuming the object pool stays intact
+            write_ptr->m_BatchKey = component->m_MixedHash;
+            write_ptr->m_TagListKey = dmRender::GetMaterialTagListKey(GetMaterial(component, resource));
+            write_ptr->m_Dispatch = label_dispatch;
+            write_ptr->m_MinorOrder = 0;
+            write_ptr->m_MajorOrder = dmRender::RENDER_ORDER_WORLD;
+            ++write_ptr;
+        }
 
-            if (component->m_RenderConstants)
+        if (vertex_count > world->m_VertexBufferCapacity)
+        {
+            dmMemory::AlignedFree(world->m_VertexBufferData);
+            world->m_VertexBufferData = 0;
+            world->m_VertexBufferCapacity = 0;
+
+            dmMemory::Result r = dmMemory::AlignedMalloc((void**)&world->m_VertexBufferData, 16, vertex_count * dmRender::GetTextVertexSize());
+            if (r == dmMemory::RESULT_OK)
             {
-                uint32_t size = dmGameSystem::GetRenderConstantCount(component->m_RenderConstants);
-                size = dmMath::Min<uint32_t>(size, dmRender::MAX_FONT_RENDER_CONSTANTS);
-                for (uint32_t i = 0; i < size; ++i)
-                {
-                    text_params.m_RenderConstants[i] = dmGameSystem::GetRenderConstant(component->m_RenderConstants, i);
-                }
-                text_params.m_NumRenderConstants = size;
+                world->m_VertexBufferCapacity = vertex_count;
+            }
+            else
+            {
+                dmLogError("Could not allocate label vertex buffer of %u vertices (%d).", vertex_count, r);
             }
-
-            LabelResource* resource = component->m_Resource;
-            dmRender::DrawText(render_context, GetFontMap(component, resource), GetMaterial(component, resource), component->m_MixedHash, text_params);
         }
 
-        dmRender::FlushTexts(render_context, dmRender::RENDER_ORDER_WORLD, 0, false);
+        dmRender::RenderListSubmit(render_context, render_list, write_ptr);
         return dmGameObject::UPDATE_RESULT_OK;
     }
 
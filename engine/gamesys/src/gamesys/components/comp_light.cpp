@@ -107,6 +107,7 @@ namespace dmGameSystem
     dmGameObject::UpdateResult CompLightUpdate(const dmGameObject::ComponentsUpdateParams& params, dmGameObject::ComponentsUpdateResult& update_result)
     {
         LightWorld* light_world = (LightWorld*) params.m_World;
+        dmRender::HRenderContext render_context = (dmRender::HRenderContext) params.m_Context;
         const uint32_t data_size = sizeof(dmGameSystemDDF::SetLight) + 9;
         char DM_ALIGNED(16) buf[data_size];
         dmGameSystemDDF::SetLight* set_light = (dmGameSystemDDF::SetLight*)buf;
@@ -149,6 +150,18 @@ namespace dmGameSystem
                 dmLogError("Could not send 'set_light' message to '%s'.", dmRender::RENDER_SOCKET_NAME);
                 return dmGameObject::UPDATE_RESULT_UNKNOWN_ERROR;
             }
+
+            // Lights with a range are also sorted into the light grid of the renderer, for the materials using it
+            if (light_desc->m_Range > 0.0f)
+            {
+                dmRender::LightGridLight grid_light;
+                grid_light.m_Position  = dmGameObject::GetWorldPosition(light->m_Instance);
+                grid_light.m_Direction = dmVMath::Rotate(dmGameObject::GetWorldRotation(light->m_Instance), Vector3(0.0f, 0.0f, -1.0f));
+                grid_light.m_Color     = Vector4(light_desc->m_Color.getXYZ() * light_desc->m_Intensity, light_desc->m_Color.getW());
+                grid_light.m_Range     = light_desc->m_Range;
+                grid_light.m_ConeAngle = light_desc->m_ConeAngle;
+                dmRender::AddLight(render_context, grid_light);
+            }
         }
         return dmGameObject::UPDATE_RESULT_OK;
     }
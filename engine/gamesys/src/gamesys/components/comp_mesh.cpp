@@ -85,6 +85,18 @@ namespace dmGameSystem
         dmGraphics::HVertexBuffer m_VertexBuffer;
         uint32_t m_RefCount;
         uint32_t m_Version;
+        // What was last uploaded, to know if a partial upload is possible
+        dmBuffer::HBuffer m_Buffer;
+        uint32_t m_ContentVersion;
+        uint32_t m_Size;
+    };
+
+    // The vertices of a world space batch, kept while the batch is unchanged
+    struct WorldVertexBuffer
+    {
+        dmGraphics::HVertexBuffer m_VertexBuffer;
+        uint64_t m_Hash;    // The meshes, their buffer versions and transforms
+        uint32_t m_Frame;   // The last frame it was rendered
     };
 
     struct MeshWorld
@@ -94,11 +106,11 @@ namespace dmGameSystem
         dmArray<dmRender::RenderObject>    m_RenderObjects;
         dmHashTable64<VertexBufferInfo>    m_ResourceToVertexBuffer;
         dmArray<dmGraphics::HVertexBuffer> m_VertexBufferPool;
-        dmArray<dmGraphics::HVertexBuffer> m_VertexBufferWorld; // for meshes batched in world space
+        dmArray<WorldVertexBuffer>         m_VertexBufferWorld; // for meshes batched in world space
         dmGraphics::HContext               m_GraphicsContext;
         void*                              m_WorldVertexData;
         size_t                             m_WorldVertexDataSize;
-
+        uint32_t                           m_Frame;
     };
 
     struct MeshContext
@@ -146,6 +158,9 @@ namespace dmGameSystem
         info.m_RefCount = 1;
         info.m_VertexBuffer = vertex_buffer;
         info.m_Version = version;
+        info.m_Buffer = 0;
+        info.m_ContentVersion = 0;
+        info.m_Size = 0;
         if (world->m_ResourceToVertexBuffer.Full()) {
             uint32_t capacity = world->m_ResourceToVertexBuffer.Capacity() + 8;
             world->m_ResourceToVertexBuffer.SetCapacity(capacity/3, capacity);
@@ -195,6 +210,39 @@ namespace dmGameSystem
         dmGraphics::SetVertexBufferData(vertex_buffer, vert_size * elem_count, bytes, buffer_usage);
     }
 
+    static void UploadVertexBuffer(VertexBufferInfo* info, dmGameSystem::BufferResource* br, dmGraphics::BufferUsage buffer_usage)
+    {
+        uint32_t content_version = 0;
+        dmBuffer::GetContentVersion(br->m_Buffer, &content_version);
+        uint32_t size = br->m_Stride * br->m_ElementCount;
+
+        // If only a range was changed since our last upload (see resource.set_buffer), we only upload that range
+        bool partial = br->m_DirtyCount > 0 &&
+                       info->m_Buffer == br->m_Buffer &&
+                       info->m_Size == size &&
+                       info->m_ContentVersion == br->m_DirtyVersion &&
+                       content_version == br->m_Version;
+
+        if (partial)
+        {
+            uint8_t* bytes = 0x0;
+            uint32_t bytes_size = 0;
+            dmBuffer::Result r = dmBuffer::GetBytes(br->m_Buffer, (void**)&bytes, &bytes_size);
+            assert(r == dmBuffer::RESULT_OK);
+
+            uint32_t offset = br->m_DirtyStart * br->m_Stride;
+            dmGraphics::SetVertexBufferSubData(info->m_VertexBuffer, offset, br->m_DirtyCount * br->m_Stride, bytes + offset);
+        }
+        else
+        {
+            CopyBufferToVertexBuffer(br->m_Buffer, info->m_VertexBuffer, br->m_Stride, br->m_ElementCount, buffer_usage);
+        }
+
+        info->m_Buffer = br->m_Buffer;
+        info->m_ContentVersion = content_version;
+        info->m_Size = size;
+    }
+
     static void CreateVertexBuffer(MeshWorld* world, dmGameSystem::BufferResource* br, uint32_t version)
     {
         dmGraphics::HVertexBuffer vertex_buffer = GetVertexBuffer(world, br->m_NameHash);
@@ -203,7 +251,7 @@ namespace dmGameSystem
             vertex_buffer = AllocVertexBuffer(world, world->m_GraphicsContext);
             AddVertexBufferInfo(world, br->m_NameHash, vertex_buffer, version); // ref count == 1
 
-            CopyBufferToVertexBuffer(br->m_Buffer, vertex_buffer, br->m_Stride, br->m_ElementCount, dmGraphics::BUFFER_USAGE_STREAM_DRAW);
+            UploadVertexBuffer(world->m_ResourceToVertexBuffer.Get(br->m_NameHash), br, dmGraphics::BUFFER_USAGE_STREAM_DRAW);
         }
         else
         {
@@ -234,6 +282,7 @@ namespace dmGameSystem
 
         world->m_WorldVertexData = 0x0;
         world->m_WorldVertexDataSize = 0;
+        world->m_Frame = 0;
 
         *params.m_World = world;
 
@@ -246,9 +295,10 @@ namespace dmGameSystem
     {
         MeshWorld* world = (MeshWorld*)params.m_World;
 
-        if (world->m_VertexBufferPool.Capacity() < world->m_VertexBufferPool.Size()+world->m_VertexBufferWorld.Size())
-            world->m_VertexBufferPool.OffsetCapacity(world->m_VertexBufferWorld.Size());
-        world->m_VertexBufferPool.PushArray(world->m_VertexBufferWorld.Begin(), world->m_VertexBufferWorld.Size());
+        for(uint32_t i = 0; i < world->m_VertexBufferWorld.Size(); ++i)
+        {
+            DeallocVertexBuffer(world, world->m_VertexBufferWorld[i].m_VertexBuffer);
+        }
         world->m_VertexBufferWorld.SetSize(0);
 
         for(uint32_t i = 0; i < world->m_VertexBufferPool.Size(); ++i)
@@ -501,7 +551,7 @@ namespace dmGameSystem
                 {
                     info->m_Version = component.m_BufferVersion;
 
-                    CopyBufferToVertexBuffer(br->m_Buffer, info->m_VertexBuffer, br->m_Stride, br->m_ElementCount, dmGraphics::BUFFER_USAGE_DYNAMIC_DRAW);
+                    UploadVertexBuffer(info, br, dmGraphics::BUFFER_USAGE_DYNAMIC_DRAW);
                 }
             }
 
@@ -657,13 +707,6 @@ namespace dmGameSystem
     {
         DM_PROFILE("RenderBatchWorld");
 
-        dmGraphics::HVertexBuffer vert_buffer = AllocVertexBuffer(world, world->m_GraphicsContext);
-        assert(vert_buffer);
-
-        if (world->m_VertexBufferWorld.Full())
-            world->m_VertexBufferWorld.OffsetCapacity(2);
-        world->m_VertexBufferWorld.Push(vert_buffer);
-
         dmRender::RenderObject& ro = *world->m_RenderObjects.End();
         world->m_RenderObjects.SetSize(world->m_RenderObjects.Size()+1);
 
@@ -678,16 +721,56 @@ namespace dmGameSystem
         dmGraphics::HVertexDeclaration vert_decl = mr->m_VertexDeclaration;
         uint32_t vert_size = br->m_Stride;
 
-        // Find out how many elements/vertices all instances in this batch has
-        // TODO: We might want to calculate this only when a mesh/buffer changes.
+        // Find out how many elements/vertices all instances in this batch has,
+        // and if the batch has changed since it was last transformed
         uint32_t element_count = 0;
+        HashState64 state;
+        dmHashInit64(&state, false);
         for (uint32_t *i=begin;i!=end;i++)
         {
             const MeshComponent* c = (MeshComponent*) buf[*i].m_UserData;
             const BufferResource* br = GetVerticesBuffer(c, c->m_Resource);
 
             element_count += br->m_ElementCount;
+
+            uint32_t version = CalcBufferVersion(c, (BufferResource*) br);
+            dmHashUpdateBuffer64(&state, &c, sizeof(c));
+            dmHashUpdateBuffer64(&state, &c->m_Resource, sizeof(c->m_Resource));
+            dmHashUpdateBuffer64(&state, &version, sizeof(version));
+            dmHashUpdateBuffer64(&state, &c->m_World, sizeof(c->m_World));
         }
+        uint64_t hash = dmHashFinal64(&state);
+
+        // since they are batched, they have the same settings as the first mesh
+        const TextureResource** mesh_resource_textures = (const TextureResource**) mr->m_Textures;
+        const TextureResource** component_textures     = (const TextureResource**) first->m_Textures;
+
+        DM_PROPERTY_ADD_U32(rmtp_MeshVertexCount, element_count);
+        DM_PROPERTY_ADD_U32(rmtp_MeshVertexSize, vert_size * element_count);
+
+        // Static meshes (and meshes updated less than every frame) keep their transformed vertices
+        for (uint32_t i = 0; i < world->m_VertexBufferWorld.Size(); ++i)
+        {
+            WorldVertexBuffer& world_buffer = world->m_VertexBufferWorld[i];
+            if (world_buffer.m_Hash == hash)
+            {
+                world_buffer.m_Frame = world->m_Frame;
+                FillRenderObject(ro, mr->m_PrimitiveType, material, mesh_resource_textures, component_textures, vert_decl, world_buffer.m_VertexBuffer, 0, element_count, Matrix4::identity(), first->m_RenderConstants);
+                dmRender::AddToRender(render_context, &ro);
+                return;
+            }
+        }
+
+        dmGraphics::HVertexBuffer vert_buffer = AllocVertexBuffer(world, world->m_GraphicsContext);
+        assert(vert_buffer);
+
+        WorldVertexBuffer world_buffer;
+        world_buffer.m_VertexBuffer = vert_buffer;
+        world_buffer.m_Hash = hash;
+        world_buffer.m_Frame = world->m_Frame;
+        if (world->m_VertexBufferWorld.Full())
+            world->m_VertexBufferWorld.OffsetCapacity(2);
+        world->m_VertexBufferWorld.Push(world_buffer);
 
         // Allocate a larger scratch buffer if vert count * vert size is larger than current buffer.
         if (world->m_WorldVertexDataSize < vert_size * element_count)
@@ -735,14 +818,6 @@ namespace dmGameSystem
             dst_data_ptr = (void*)((uint8_t*)dst_data_ptr + size);
         }
 
-        DM_PROPERTY_ADD_U32(rmtp_MeshVertexCount, element_count);
-        DM_PROPERTY_ADD_U32(rmtp_MeshVertexSize, vert_size * element_count);
-
-        // since they are batched, they have the same settings as the first mesh
-        const MeshComponent* component                 = (MeshComponent*) buf[*begin].m_UserData;
-        const TextureResource** mesh_resource_textures = (const TextureResource**) mr->m_Textures;
-        const TextureResource** component_textures     = (const TextureResource**) component->m_Textures;
-
         FillRenderObject(ro, mr->m_PrimitiveType, material, mesh_resource_textures, component_textures, vert_decl, vert_buffer, 0, element_count, Matrix4::identity(), first->m_RenderConstants);
         dmGraphics::SetVertexBufferData(vert_buffer, vert_size * element_count, world->m_WorldVertexData, dmGraphics::BUFFER_USAGE_DYNAMIC_DRAW);
         dmRender::AddToRender(render_context, &ro);
@@ -851,11 +926,6 @@ namespace dmGameSystem
             case dmRender::RENDER_LIST_OPERATION_BEGIN:
             {
                 world->m_RenderObjects.SetSize(0);
-
-                if (world->m_VertexBufferPool.Capacity() < world->m_VertexBufferPool.Size()+world->m_VertexBufferWorld.Size())
-                    world->m_VertexBufferPool.OffsetCapacity(world->m_VertexBufferWorld.Size());
-                world->m_VertexBufferPool.PushArray(world->m_VertexBufferWorld.Begin(), world->m_VertexBufferWorld.Size());
-                world->m_VertexBufferWorld.SetSize(0);
                 break;
             }
             case dmRender::RENDER_LIST_OPERATION_BATCH:
@@ -873,6 +943,27 @@ namespace dmGameSystem
         }
     }
 
+    // Returns the world space vertex buffers of the batches that weren't rendered last frame to the pool
+    static void ReleaseWorldVertexBuffers(MeshWorld* world)
+    {
+        world->m_Frame++;
+
+        uint32_t i = 0;
+        while (i < world->m_VertexBufferWorld.Size())
+        {
+            WorldVertexBuffer& world_buffer = world->m_VertexBufferWorld[i];
+            if (world_buffer.m_Frame + 1 < world->m_Frame)
+            {
+                DeallocVertexBuffer(world, world_buffer.m_VertexBuffer);
+                world->m_VertexBufferWorld.EraseSwap(i);
+            }
+            else
+            {
+                ++i;
+            }
+        }
+    }
+
     dmGameObject::UpdateResult CompMeshRender(const dmGameObject::ComponentsRenderParams& params)
     {
         DM_PROFILE("Render");
@@ -882,6 +973,7 @@ namespace dmGameSystem
         MeshWorld* world = (MeshWorld*)params.m_World;
 
         UpdateTransforms(world);
+        ReleaseWorldVertexBuffers(world);
 
         const dmArray<MeshComponent*>& components = world->m_Components.GetRawObjects();
         const uint32_t count = components.Size();
@@ -87,9 +87,12 @@ namespace dmGameSystem
         uint32_t                    m_InstanceRenderHash;
         uint32_t                    m_BoneIndex;
         uint32_t                    m_MaterialIndex;
+        uint32_t                    m_CullFrame;                  // The world frame the item was last frustum culled
         uint32_t                    m_Enabled                     : 1;
         uint32_t                    m_AttributeRenderDataIndex    : 16;
         uint32_t                    m_PerInstanceCustomAttributes : 1;
+        uint32_t                    m_Culled                      : 1; // Outside all the frustums of m_CullFrame
+        uint32_t                    m_Lod                         : 8; // The lod level of the mesh. LOD_NONE if it's always drawn
     };
 
     struct ModelComponent
@@ -109,7 +112,9 @@ namespace dmGameSystem
         dmArray<dmGameObject::HInstance> m_NodeInstances;
         dmArray<MeshRenderItem>          m_RenderItems;
         dmArray<MeshAttributeRenderData> m_MeshAttributeRenderDatas;
+        dmArray<float>                   m_LodScreenSizes; // The min screen size of each lod level. Empty if the model has no lods
         uint16_t                         m_ComponentIndex;
+        uint8_t                          m_Lod;            // The currently drawn lod level
         uint8_t                          m_Enabled : 1;
         uint8_t                          m_DoRender : 1;
         uint8_t                          m_AddedToUpdate : 1;
@@ -136,6 +141,7 @@ namespace dmGameSystem
         // For profiling data:
         uint32_t                         m_StatisticsVertexCount;
         uint32_t                         m_StatisticsVertexDataSize;
+        uint32_t                         m_FrameCount;
         uint8_t                          m_CurrentFrameTick;
     };
 
@@ -144,6 +150,10 @@ namespace dmGameSystem
     static const uint8_t VX_DECL_INSTANCE_BUFFER    = 1;
     static const uint8_t VX_DECL_CUSTOM_BUFFER      = 2;
 
+    static const uint32_t LOD_NONE                  = 0xFF;
+    static const uint32_t LOD_MAX_COUNT             = LOD_NONE;
+    static const float    LOD_HYSTERESIS            = 0.1f;   // How far (relative) the screen size must pass a lod threshold before the lod changes
+
     static const dmhash_t PROP_SKIN          = dmHashString64("skin");
     static const dmhash_t PROP_ANIMATION     = dmHashString64("animation");
     static const dmhash_t PROP_CURSOR        = dmHashString64("cursor");
@@ -167,6 +177,7 @@ namespace dmGameSystem
             dmLogFatal("Unable to create model rig context: %d", rr);
             return dmGameObject::CREATE_RESULT_UNKNOWN_ERROR;
         }
+        dmRig::SetJobThread(world->m_RigContext, context->m_JobThread);
 
         world->m_Components.SetCapacity(comp_count);
         world->m_RenderObjects.SetCapacity(comp_count);
@@ -193,6 +204,7 @@ namespace dmGameSystem
         world->m_InstanceBufferLocalSpace  = dmRender::NewBufferedRenderBuffer(context->m_RenderContext, dmRender::RENDER_BUFFER_TYPE_VERTEX_BUFFER);
 
         world->m_CurrentFrameTick = 0;
+        world->m_FrameCount = 0;
         world->m_VertexBuffers = new dmRender::HBufferedRenderBuffer[VERTEX_BUFFER_MAX_BATCHES];
         world->m_VertexBufferData = new dmArray<uint8_t>[VERTEX_BUFFER_MAX_BATCHES];
         world->m_VertexBufferDispatchCounts = new uint32_t[VERTEX_BUFFER_MAX_BATCHES];
@@ -760,6 +772,8 @@ namespace dmGameSystem
     {
         component->m_RenderItems.SetCapacity(resource->m_Meshes.Size());
         component->m_RenderItems.SetSize(0);
+        component->m_LodScreenSizes.SetSize(0);
+        component->m_Lod = 0;
 
         uint32_t num_custom_attributes = 0;
 
@@ -781,6 +795,9 @@ namespace dmGameSystem
             item.m_BoneIndex = dmRig::INVALID_BONE_INDEX;
             item.m_AttributeRenderDataIndex = ATTRIBUTE_RENDER_DATA_INDEX_UNUSED;
             item.m_InstanceRenderHash = 0;
+            item.m_CullFrame = 0;
+            item.m_Culled = 0;
+            item.m_Lod = LOD_NONE;
 
             // This model is a child under a bone, but isn't actually skinned
             if (item.m_Model->m_BoneId && bone_id_to_indices)
@@ -1578,12 +1595,48 @@ namespace dmGameSystem
         return dmGameObject::CREATE_RESULT_OK;
     }
 
+    static inline bool IsLodVisible(const ModelComponent* component, const MeshRenderItem& item)
+    {
+        return item.m_Lod == LOD_NONE || item.m_Lod == component->m_Lod;
+    }
+
+    // Rig instances whose render items were all outside the frustums of the previous frame only advance their animation cursors.
+    // Items that weren't frustum culled at all (e.g. no frustum was given to the render script, or they weren't rendered) count as visible.
+    static void CullRigInstances(ModelWorld* world)
+    {
+        DM_PROFILE("CullRigInstances");
+
+        const dmArray<ModelComponent*>& components = world->m_Components.GetRawObjects();
+        const uint32_t count = components.Size();
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            ModelComponent& component = *components[i];
+            if (!component.m_RigInstance)
+                continue;
+
+            bool visible = false;
+            uint32_t item_count = component.m_RenderItems.Size();
+            for (uint32_t j = 0; j < item_count && !visible; ++j)
+            {
+                const MeshRenderItem& item = component.m_RenderItems[j];
+                visible = item.m_Enabled && IsLodVisible(&component, item) && (item.m_CullFrame != world->m_FrameCount || !item.m_Culled);
+            }
+            dmRig::SetCulled(component.m_RigInstance, !visible);
+        }
+    }
+
     dmGameObject::UpdateResult CompModelUpdate(const dmGameObject::ComponentsUpdateParams& params, dmGameObject::ComponentsUpdateResult& update_result)
     {
         ModelWorld* world = (ModelWorld*)params.m_World;
         ModelContext* context = (ModelContext*)params.m_Context;
 
+        if (context->m_CullOffscreenAnimation)
+        {
+            CullRigInstances(world);
+        }
+
         dmRig::Result rig_res = dmRig::Update(world->m_RigContext, params.m_UpdateContext->m_DT);
+        world->m_FrameCount++;
 
         const dmArray<ModelComponent*>& components = world->m_Components.GetRawObjects();
         const uint32_t count = components.Size();
@@ -1626,10 +1679,25 @@ namespace dmGameSystem
         return dmGameObject::UPDATE_RESULT_OK;
     }
 
+    // Meshes with more triangles are too expensive to rasterize as occluders
+    static const uint32_t MAX_OCCLUDER_TRIANGLE_COUNT = 1024;
+
+    // Uses the (static) mesh to hide the models behind it
+    static void AddOccluder(dmRender::HRenderContext render_context, const MeshRenderItem& render_item)
+    {
+        const dmRigDDF::Mesh* mesh = render_item.m_Mesh;
+        bool index_32bit = mesh->m_IndicesFormat == dmRigDDF::INDEXBUFFER_FORMAT_32;
+        uint32_t index_count = mesh->m_Indices.m_Count / (index_32bit ? 4 : 2);
+        if (mesh->m_Positions.m_Count == 0 || index_count == 0 || index_count / 3 > MAX_OCCLUDER_TRIANGLE_COUNT)
+            return;
+        dmRender::AddOccluder(render_context, render_item.m_World, mesh->m_Positions.m_Data, mesh->m_Indices.m_Data, index_count, index_32bit);
+    }
+
     static void RenderListFrustumCulling(dmRender::RenderListVisibilityParams const &params)
     {
         DM_PROFILE("Model");
 
+        ModelWorld* world = (ModelWorld*)params.m_UserData;
         const dmIntersection::Frustum frustum = *params.m_Frustum;
         uint32_t num_entries = params.m_NumEntries;
         for (uint32_t i = 0; i < num_entries; ++i)
@@ -1638,7 +1706,19 @@ namespace dmGameSystem
             MeshRenderItem* render_item = (MeshRenderItem*)entry->m_UserData;
 
             bool intersect = dmIntersection::TestFrustumOBB(frustum, render_item->m_World, render_item->m_AabbMin, render_item->m_AabbMax);
-            entry->m_Visibility = intersect ? dmRender::VISIBILITY_FULL : dmRender::VISIBILITY_NONE;
+            bool occluded = intersect && params.m_OcclusionBuffer && dmRender::IsOccluded(params.m_OcclusionBuffer, render_item->m_World, render_item->m_AabbMin, render_item->m_AabbMax);
+            entry->m_Visibility = intersect && !occluded ? dmRender::VISIBILITY_FULL : dmRender::VISIBILITY_NONE;
+
+            // The item is visible if it's inside the frustum of any of the render passes of the frame
+            if (render_item->m_CullFrame != world->m_FrameCount)
+            {
+                render_item->m_CullFrame = world->m_FrameCount;
+                render_item->m_Culled = !intersect;
+            }
+            else if (intersect)
+            {
+                render_item->m_Culled = 0;
+            }
         }
     }
 
@@ -1701,6 +1781,50 @@ namespace dmGameSystem
         }
     }
 
+    // The diameter of the item's bounding sphere on screen, relative to the screen height
+    static float GetProjectedScreenSize(const Matrix4& view_proj, const MeshRenderItem& item)
+    {
+        const Matrix4& world = item.m_World;
+        float scale = dmMath::Max(Length(world.getCol0().getXYZ()), dmMath::Max(Length(world.getCol1().getXYZ()), Length(world.getCol2().getXYZ())));
+        float radius = Length(item.m_AabbMax - item.m_AabbMin) * 0.5f * scale;
+        Vector4 center = world * Point3((item.m_AabbMin + item.m_AabbMax) * 0.5f);
+
+        float w = (view_proj * center).getW();
+        if (w <= FLT_EPSILON)
+            return FLT_MAX; // At, or behind, the camera
+
+        // For both perspective and orthographic projections, the length of the y row is the vertical projection scale
+        Vector3 row_y(view_proj.getCol0().getY(), view_proj.getCol1().getY(), view_proj.getCol2().getY());
+        return radius * Length(row_y) / w;
+    }
+
+    // Selects the lod from the largest screen size of the lod meshes. To avoid flickering between two lods,
+    // a lod is kept until the screen size has moved LOD_HYSTERESIS past its threshold.
+    static void UpdateLod(ModelComponent* component, const Matrix4& view_proj)
+    {
+        float screen_size = 0.0f;
+        uint32_t item_count = component->m_RenderItems.Size();
+        for (uint32_t i = 0; i < item_count; ++i)
+        {
+            const MeshRenderItem& item = component->m_RenderItems[i];
+            if (item.m_Enabled && item.m_Lod != LOD_NONE)
+                screen_size = dmMath::Max(screen_size, GetProjectedScreenSize(view_proj, item));
+        }
+
+        uint32_t lod_count = component->m_LodScreenSizes.Size();
+        uint32_t lod = lod_count - 1;
+        for (uint32_t i = 0; i < lod_count; ++i)
+        {
+            float threshold = component->m_LodScreenSizes[i] * (i < component->m_Lod ? 1.0f + LOD_HYSTERESIS : 1.0f - LOD_HYSTERESIS);
+            if (screen_size >= threshold)
+            {
+                lod = i;
+                break;
+            }
+        }
+        component->m_Lod = (uint8_t)lod;
+    }
+
     dmGameObject::UpdateResult CompModelRender(const dmGameObject::ComponentsRenderParams& params)
     {
         ModelContext* context = (ModelContext*)params.m_Context;
@@ -1712,6 +1836,9 @@ namespace dmGameSystem
 
         const dmArray<ModelComponent*>& components = world->m_Components.GetRawObjects();
 
+        // The lods are selected with the camera of the previous frame, since the render script hasn't run yet
+        const Matrix4& view_proj = dmRender::GetViewProjectionMatrix(render_context);
+
         uint32_t num_components = components.Size();
         uint32_t mesh_count = 0;
         for (uint32_t i = 0; i < num_components; ++i)
@@ -1719,6 +1846,8 @@ namespace dmGameSystem
             ModelComponent& component = *components[i];
             if (!component.m_DoRender)
                 continue;
+            if (!component.m_LodScreenSizes.Empty())
+                UpdateLod(&component, view_proj);
             mesh_count += component.m_RenderItems.Size();
         }
 
@@ -1740,7 +1869,7 @@ namespace dmGameSystem
             for (uint32_t j = 0; j < item_count; ++j)
             {
                 MeshRenderItem& render_item = component.m_RenderItems[j];
-                if (!render_item.m_Enabled)
+                if (!render_item.m_Enabled || !IsLodVisible(&component, render_item))
                     continue;
 
                 uint32_t vertex_count = render_item.m_Buffers->m_VertexCount;
@@ -1762,6 +1891,11 @@ namespace dmGameSystem
                 write_ptr->m_Dispatch   = dispatch;
                 write_ptr->m_MinorOrder = minor_order;
 
+                if (context->m_OcclusionCulling && !component.m_Resource->m_RigScene->m_SkeletonRes)
+                {
+                    AddOccluder(render_context, render_item);
+                }
+
                 // For instancing we need to group instanced without looking at the Z value.
                 if (dmRender::GetVertexDeclaration(mesh_material, dmGraphics::VERTEX_STEP_FUNCTION_INSTANCE))
                 {
@@ -2121,6 +2255,37 @@ namespace dmGameSystem
         return found;
     }
 
+    bool CompModelSetMeshLod(ModelComponent* component, dmhash_t mesh_id, uint32_t lod, float screen_size)
+    {
+        if (lod >= LOD_MAX_COUNT)
+            return false;
+
+        bool found = false;
+        for (uint32_t i = 0; i < component->m_RenderItems.Size(); ++i)
+        {
+            MeshRenderItem& item = component->m_RenderItems[i];
+            if (item.m_Model->m_Id == mesh_id)
+            {
+                item.m_Lod = lod;
+                found = true;
+            }
+        }
+        if (!found)
+            return false;
+
+        dmArray<float>& screen_sizes = component->m_LodScreenSizes;
+        if (screen_sizes.Size() <= lod)
+        {
+            uint32_t old_size = screen_sizes.Size();
+            screen_sizes.SetCapacity(lod + 1);
+            screen_sizes.SetSize(lod + 1);
+            for (uint32_t i = old_size; i < lod; ++i)
+                screen_sizes[i] = FLT_MAX; // Levels without meshes are never selected
+        }
+        screen_sizes[lod] = screen_size;
+        return true;
+    }
+
     static bool CompModelIterPropertiesGetNext(dmGameObject::SceneNodePropertyIterator* pit)
     {
         ModelWorld* world = (ModelWorld*)pit->m_Node->m_ComponentWorld;
@@ -106,6 +106,11 @@ namespace dmGameSystem
         return false;
     }
 
+    bool CompModelSetMeshLod(ModelComponent* component, dmhash_t mesh_id, uint32_t lod, float screen_size)
+    {
+        return false;
+    }
+
     void CompModelIterProperties(dmGameObject::SceneNodePropertyIterator* pit, dmGameObject::SceneNode* node)
     { }
 }
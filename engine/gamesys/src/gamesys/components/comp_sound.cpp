@@ -53,7 +53,9 @@ namespace dmGameSystem
         uint8_t                 m_PauseRequested        : 1;
         uint8_t                 m_Paused                : 1;
         uint8_t                 m_ShouldDispatchEvents  : 1;
-        uint8_t                                         : 4;
+        // Set if the position of the game object is sent to the sound system, see CompSoundUpdate
+        uint8_t                 m_Spatial               : 1;
+        uint8_t                                         : 3;
     };
 
     struct SoundComponent
@@ -62,6 +64,9 @@ namespace dmGameSystem
         float   m_Pan;
         float   m_Gain;
         float   m_Speed;
+        // The sound is spatial if the max distance is > 0
+        float   m_MinDistance;
+        float   m_MaxDistance;
     };
 
     struct SoundWorld
@@ -69,12 +74,17 @@ namespace dmGameSystem
         dmArray<PlayEntry>              m_Entries;
         dmObjectPool<SoundComponent>    m_Components;
         dmIndexPool32                   m_EntryIndices;
+        // Scratch arrays, to send the positions of all the spatial sounds at once
+        dmArray<dmSound::HSoundInstance> m_SpatialInstances;
+        dmArray<dmVMath::Point3>         m_SpatialPositions;
     };
 
     static const dmhash_t SOUND_PROP_GAIN   = dmHashString64("gain");
     static const dmhash_t SOUND_PROP_PAN    = dmHashString64("pan");
     static const dmhash_t SOUND_PROP_SPEED  = dmHashString64("speed");
     static const dmhash_t SOUND_PROP_SOUND  = dmHashString64("sound");
+    static const dmhash_t SOUND_PROP_MIN_DISTANCE = dmHashString64("min_distance");
+    static const dmhash_t SOUND_PROP_MAX_DISTANCE = dmHashString64("max_distance");
 
     dmGameObject::CreateResult CompSoundNewWorld(const dmGameObject::ComponentNewWorldParams& params)
     {
@@ -87,6 +97,8 @@ namespace dmGameSystem
         world->m_Entries.SetSize(max_instances);
         world->m_EntryIndices.SetCapacity(max_instances);
         memset(world->m_Entries.Begin(), 0, max_instances * sizeof(PlayEntry));
+        world->m_SpatialInstances.SetCapacity(max_instances);
+        world->m_SpatialPositions.SetCapacity(max_instances);
 
         world->m_Components.SetCapacity(comp_count);
 
@@ -128,6 +140,8 @@ namespace dmGameSystem
         component->m_Gain   = component->m_Resource->m_Gain;
         component->m_Pan    = component->m_Resource->m_Pan;
         component->m_Speed  = component->m_Resource->m_Speed;
+        component->m_MinDistance = 0.0f;
+        component->m_MaxDistance = 0.0f;
 
         *params.m_UserData = (uintptr_t)index;
         return dmGameObject::CREATE_RESULT_OK;
@@ -145,6 +159,17 @@ namespace dmGameSystem
         uint32_t index = *params.m_UserData;
         world->m_Components.Free(index, false);
 
+        // The sounds keep playing at their last position after the game object is deleted
+        uint32_t size = world->m_Entries.Size();
+        for (uint32_t i = 0; i < size; ++i)
+        {
+            PlayEntry& entry = world->m_Entries[i];
+            if (entry.m_Instance == params.m_Instance)
+            {
+                entry.m_Spatial = 0;
+            }
+        }
+
         return dmGameObject::CREATE_RESULT_OK;
     }
 
@@ -255,8 +280,22 @@ namespace dmGameSystem
                     // If a stop was requested before we started playing, we can remove it immediately and dispatch the callback
                     update_result = HandleEntryFinishedPlaying(world, entry, i);
                 }
+
+                if (entry.m_SoundInstance != 0 && entry.m_Spatial)
+                {
+                    world->m_SpatialInstances.Push(entry.m_SoundInstance);
+                    world->m_SpatialPositions.Push(dmGameObject::GetWorldPosition(entry.m_Instance));
+                }
             }
         }
+
+        // The sound system computes the gains and pans of all the spatial sounds in one pass
+        if (!world->m_SpatialInstances.Empty())
+        {
+            dmSound::SetPositions(world->m_SpatialInstances.Begin(), world->m_SpatialPositions.Begin(), world->m_SpatialInstances.Size());
+            world->m_SpatialInstances.SetSize(0);
+            world->m_SpatialPositions.SetSize(0);
+        }
         dmSound::Update();
         return update_result;
     }
@@ -395,6 +434,33 @@ namespace dmGameSystem
         return dmGameObject::PROPERTY_RESULT_OK;
     }
 
+    // Also updates the spatial sounds that are playing. Sounds that were played as non spatial stay that way
+    static dmGameObject::PropertyResult SoundSetDistance(SoundWorld* world, dmGameObject::HInstance instance, SoundComponent* component, dmhash_t property_id, float value)
+    {
+        if (property_id == SOUND_PROP_MIN_DISTANCE)
+            component->m_MinDistance = dmMath::Max(0.0f, value);
+        else
+            component->m_MaxDistance = dmMath::Max(0.0f, value);
+
+        bool spatial = component->m_MaxDistance > 0.0f;
+        Sound* sound = component->m_Resource;
+        uint32_t size = world->m_Entries.Size();
+        for (uint32_t i = 0; i < size; ++i)
+        {
+            PlayEntry& entry = world->m_Entries[i];
+            if (entry.m_SoundInstance != 0 && entry.m_Sound == sound && entry.m_Instance == instance && entry.m_Spatial)
+            {
+                entry.m_Spatial = spatial;
+                dmSound::Result r = dmSound::SetSpatial(entry.m_SoundInstance, spatial, component->m_MinDistance, component->m_MaxDistance);
+                if (r != dmSound::RESULT_OK)
+                {
+                    return dmGameObject::PROPERTY_RESULT_UNSUPPORTED_VALUE;
+                }
+            }
+        }
+        return dmGameObject::PROPERTY_RESULT_OK;
+    }
+
     static dmGameObject::PropertyResult SoundGetParameter(SoundWorld* world, dmGameObject::HInstance instance, SoundComponent* component, dmSound::Parameter type, dmGameObject::PropertyDesc& out_value)
     {
         float value;
@@ -454,6 +520,14 @@ namespace dmGameSystem
                     dmSound::SetParameter(entry.m_SoundInstance, dmSound::PARAMETER_SPEED, dmVMath::Vector4(speed, 0, 0, 0));
                     dmSound::SetLooping(entry.m_SoundInstance, sound->m_Looping, (sound->m_Looping && !sound->m_Loopcount) ? -1 : sound->m_Loopcount ); // loopcounter semantics differ a bit from loopcount. If -1, it means loopforever, otherwise it contains the # of loops remaining.
 
+                    entry.m_Spatial = component->m_MaxDistance > 0.0f;
+                    if (entry.m_Spatial)
+                    {
+                        dmSound::SetSpatial(entry.m_SoundInstance, true, component->m_MinDistance, component->m_MaxDistance);
+                        dmVMath::Point3 position = dmGameObject::GetWorldPosition(params.m_Instance);
+                        dmSound::SetPositions(&entry.m_SoundInstance, &position, 1);
+                    }
+
                     entry.m_Listener = params.m_Message->m_Sender;
                     uintptr_t callback = params.m_Message->m_UserData2;
                     if (callback == UINTPTR_MAX)
@@ -555,6 +629,12 @@ namespace dmGameSystem
 
         if (params.m_PropertyId == SOUND_PROP_SOUND) {
             return GetResourceProperty(dmGameObject::GetFactory(params.m_Instance), component->m_Resource->m_SoundDataRes, out_value);
+        } else if (params.m_PropertyId == SOUND_PROP_MIN_DISTANCE) {
+            out_value.m_Variant = dmGameObject::PropertyVar(component->m_MinDistance);
+            return dmGameObject::PROPERTY_RESULT_OK;
+        } else if (params.m_PropertyId == SOUND_PROP_MAX_DISTANCE) {
+            out_value.m_Variant = dmGameObject::PropertyVar(component->m_MaxDistance);
+            return dmGameObject::PROPERTY_RESULT_OK;
         } else {
             dmSound::Parameter parameter = GetSoundParameterType(params.m_PropertyId);
             if (parameter == dmSound::PARAMETER_MAX) {
@@ -573,6 +653,10 @@ namespace dmGameSystem
         if (params.m_Value.m_Type != dmGameObject::PROPERTY_TYPE_NUMBER)
             return dmGameObject::PROPERTY_RESULT_TYPE_MISMATCH;
 
+        if (params.m_PropertyId == SOUND_PROP_MIN_DISTANCE || params.m_PropertyId == SOUND_PROP_MAX_DISTANCE) {
+            return SoundSetDistance(world, params.m_Instance, component, params.m_PropertyId, params.m_Value.m_Number);
+        }
+
         dmSound::Parameter parameter = GetSoundParameterType(params.m_PropertyId);
         if (parameter == dmSound::PARAMETER_MAX) {
             return dmGameObject::PROPERTY_RESULT_NOT_FOUND;
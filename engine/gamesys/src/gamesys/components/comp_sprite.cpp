@@ -18,6 +18,10 @@
 #include <float.h>
 #include <algorithm>
 
+#if defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#endif
+
 #include <dlib/array.h>
 #include <dlib/hash.h>
 #include <dlib/log.h>
@@ -68,6 +72,9 @@ namespace dmGameSystem
     struct SpriteComponent
     {
         Matrix4                     m_World;
+        // The size m_World was last computed from, used to skip sprites at rest
+        Vector3                     m_CachedSize;
+        float                       m_BoundingRadiusSq;
         Vector3                     m_Position;
         Quat                        m_Rotation;
         Vector3                     m_Scale;
@@ -86,6 +93,8 @@ namespace dmGameSystem
 
         uint32_t                    m_AnimationID; // index into array
         uint32_t                    m_DynamicVertexAttributeIndex;
+        uint32_t                    m_ActiveIndex; // Index into SpriteWorld::m_ActiveComponents, or INVALID_ACTIVE_INDEX
+        uint32_t                    m_TransformIndex; // Index of the game object world transform (see dmGameObject::GetWorldTransforms)
 
         /// Currently playing animation
         dmhash_t                    m_CurrentAnimation;
@@ -106,7 +115,8 @@ namespace dmGameSystem
         uint16_t                    m_AddedToUpdate : 1;
         uint16_t                    m_ReHash : 1;
         uint16_t                    m_UseSlice9 : 1;
-        uint16_t                    : 6;
+        uint16_t                    m_TransformValid : 1;
+        uint16_t                    : 5;
     };
 
     const uint32_t MAX_TEXTURE_COUNT = dmRender::RenderObject::MAX_TEXTURE_COUNT;
@@ -114,6 +124,8 @@ namespace dmGameSystem
     struct SpriteWorld
     {
         dmObjectPool<SpriteComponent>       m_Components;
+        // The (pool indices of the) sprites that are playing or need their frame updated. Only these are animated
+        dmArray<uint32_t>                   m_ActiveComponents;
         DynamicAttributePool                m_DynamicVertexAttributePool;
         dmArray<dmRender::RenderObject*>    m_RenderObjects;
         dmArray<float>                      m_BoundingVolumes;
@@ -121,9 +133,13 @@ namespace dmGameSystem
         dmArray<float>                      m_ScratchUVs[MAX_TEXTURE_COUNT];
         dmArray<Vector4>                    m_ScratchPositionWorld;
         dmArray<Vector4>                    m_ScratchPositionLocal;
+        dmArray<float>                      m_ScratchTextureIndices;
         uint32_t                            m_RenderObjectsInUse;
+        // The game object transform version when the sprite transforms were last updated
+        uint32_t                            m_TransformVersion;
         dmRender::HBufferedRenderBuffer     m_VertexBuffer;
         uint8_t*                            m_VertexBufferData;
+        uint8_t*                            m_VertexBufferBase;     // Either the mapped vertex buffer or m_VertexBufferData, 0 until the first batch of a dispatch
         uint8_t*                            m_VertexBufferWritePtr;
         dmRender::HBufferedRenderBuffer     m_IndexBuffer;
         uint32_t                            m_VerticesWritten;
@@ -135,6 +151,7 @@ namespace dmGameSystem
         uint8_t*                            m_IndexBufferWritePtr;
         uint8_t                             m_Is16BitIndex : 1;
         uint8_t                             m_ReallocBuffers : 1;
+        uint8_t                             m_VertexBufferMapped : 1;
     };
 
     struct TexturesData
@@ -209,10 +226,12 @@ namespace dmGameSystem
         SpriteWorld* sprite_world = new SpriteWorld();
         uint32_t comp_count = dmMath::Min(params.m_MaxComponentInstances, sprite_context->m_MaxSpriteCount);
         sprite_world->m_Components.SetCapacity(comp_count);
+        sprite_world->m_ActiveComponents.SetCapacity(comp_count);
         sprite_world->m_BoundingVolumes.SetCapacity(comp_count);
         sprite_world->m_BoundingVolumes.SetSize(comp_count);
         memset(sprite_world->m_Components.GetRawObjects().Begin(), 0, sizeof(SpriteComponent) * comp_count);
         sprite_world->m_RenderObjectsInUse = 0;
+        sprite_world->m_TransformVersion = 0;
         sprite_world->m_VertexBuffer     = 0;
         sprite_world->m_VertexBufferData = 0;
         sprite_world->m_IndexBuffer      = 0;
@@ -282,14 +301,15 @@ namespace dmGameSystem
         delete component->m_Overrides;
     }
 
-    static inline void HashResourceOverrides(HashState32* state, SpriteResourceOverrides* overrides)
+    static inline void HashResourceOverrides(HashState32* state, SpriteResourceOverrides* overrides, bool hash_textures)
     {
         if (!overrides)
             return;
 
         if (overrides->m_Material)
             dmHashUpdateBuffer32(state, overrides->m_Material, sizeof(MaterialResource*));
-        dmHashUpdateBuffer32(state, overrides->m_Textures.Begin(), sizeof(SpriteTexture) * overrides->m_Textures.Size());
+        if (hash_textures)
+            dmHashUpdateBuffer32(state, overrides->m_Textures.Begin(), sizeof(SpriteTexture) * overrides->m_Textures.Size());
     }
 
     // Keep the size/ordering up-to-date for the textures in the overrides list
@@ -476,6 +496,16 @@ namespace dmGameSystem
         return texture ? texture->m_Texture : 0;
     }
 
+    // Sprites with a single texture, whose material has a "texture_index" vertex attribute and more than one sampler,
+    // are batched regardless of their texture. Each batch binds up to one texture per sampler, and the shader picks
+    // the sampler from the texture index of the vertex.
+    static inline bool UsesTextureTable(const SpriteComponent* component)
+    {
+        MaterialResource* material = GetMaterialResource(component);
+        return GetNumTextures(component) == 1 && material->m_NumTextures > 1 &&
+            dmRender::GetMaterialAttributeIndex(material->m_Material, dmRender::VERTEX_STREAM_TEXTURE_INDEX) != dmRender::INVALID_MATERIAL_ATTRIBUTE_INDEX;
+    }
+
     static void UpdateCurrentAnimationFrame(SpriteComponent* component) {
         TextureSetResource* texture_set = GetFirstTextureSet(component);
         dmGameSystemDDF::TextureSet* texture_set_ddf = texture_set->m_TextureSet;
@@ -511,6 +541,33 @@ namespace dmGameSystem
         }
     }
 
+    static const uint32_t INVALID_ACTIVE_INDEX = 0xffffffff;
+
+    // Adds the sprite to the animated ones, if it's playing or needs its frame updated.
+    // Must be called after any change that may start the animation (the sprites are removed again in Animate() when idle)
+    static void ActivateSprite(SpriteWorld* sprite_world, uint32_t index)
+    {
+        SpriteComponent* component = &sprite_world->m_Components.Get(index);
+        if (component->m_ActiveIndex != INVALID_ACTIVE_INDEX || !(component->m_Playing || component->m_DoTick))
+            return;
+
+        dmArray<uint32_t>& active = sprite_world->m_ActiveComponents;
+        component->m_ActiveIndex = active.Size();
+        active.Push(index);
+    }
+
+    static void DeactivateSprite(SpriteWorld* sprite_world, SpriteComponent* component)
+    {
+        dmArray<uint32_t>& active = sprite_world->m_ActiveComponents;
+        uint32_t active_index = component->m_ActiveIndex;
+        component->m_ActiveIndex = INVALID_ACTIVE_INDEX;
+        active.EraseSwap(active_index);
+        if (active_index < active.Size())
+        {
+            sprite_world->m_Components.Get(active[active_index]).m_ActiveIndex = active_index;
+        }
+    }
+
     static bool PlayAnimation(SpriteComponent* component, dmhash_t animation, float offset, float playback_rate)
     {
         TextureSetResource* texture_set = GetFirstTextureSet(component);
@@ -572,10 +629,15 @@ namespace dmGameSystem
             dmGameSystem::HashRenderConstants(constants, &state);
         }
 
-        dmHashUpdateBuffer32(&state, resource->m_Textures, sizeof(SpriteTexture) * resource->m_NumTextures);
+        // The textures are bound per batch when the material uses a texture table
+        bool hash_textures = !UsesTextureTable(component);
+        if (hash_textures)
+        {
+            dmHashUpdateBuffer32(&state, resource->m_Textures, sizeof(SpriteTexture) * resource->m_NumTextures);
+        }
         dmHashUpdateBuffer32(&state, resource->m_Material, sizeof(MaterialResource*));
 
-        HashResourceOverrides(&state, component->m_Overrides);
+        HashResourceOverrides(&state, component->m_Overrides, hash_textures);
 
         component->m_MixedHash = dmHashFinal32(&state);
         component->m_ReHash = 0;
@@ -595,6 +657,7 @@ namespace dmGameSystem
         memset(component, 0, sizeof(SpriteComponent));
 
         component->m_Instance = params.m_Instance;
+        component->m_TransformIndex = dmGameObject::GetTransformIndex(params.m_Instance);
         component->m_Position = Vector3(params.m_Position);
         component->m_Rotation = params.m_Rotation;
         component->m_Scale = params.m_Scale;
@@ -613,6 +676,7 @@ namespace dmGameSystem
                 component->m_Resource->m_DDF->m_SizeMode == dmGameSystemDDF::SpriteDesc::SIZE_MODE_MANUAL;
 
         component->m_DynamicVertexAttributeIndex = INVALID_DYNAMIC_ATTRIBUTE_INDEX;
+        component->m_ActiveIndex = INVALID_ACTIVE_INDEX;
         component->m_Size = Vector3(0.0f, 0.0f, 0.0f);
         component->m_AnimationID = 0;
 
@@ -626,6 +690,7 @@ namespace dmGameSystem
         {
             PlayAnimation(component, resource->m_DefaultAnimation,
                     component->m_Resource->m_DDF->m_Offset, component->m_Resource->m_DDF->m_PlaybackRate);
+            ActivateSprite(sprite_world, index);
         }
 
         *params.m_UserData = (uintptr_t)index;
@@ -655,6 +720,11 @@ namespace dmGameSystem
 
         FreeMaterialAttribute(sprite_world->m_DynamicVertexAttributePool, component->m_DynamicVertexAttributeIndex);
 
+        if (component->m_ActiveIndex != INVALID_ACTIVE_INDEX)
+        {
+            DeactivateSprite(sprite_world, component);
+        }
+
         sprite_world->m_Components.Free(index, true);
         return dmGameObject::CREATE_RESULT_OK;
     }
@@ -1153,7 +1223,237 @@ namespace dmGameSystem
         }
     }
 
-    static void CreateVertexData(SpriteWorld* sprite_world, dmGraphics::VertexAttributeInfos* material_attribute_info, bool has_local_position_attribute, uint8_t** vb_where, uint8_t** ib_where, dmRender::RenderListEntry* buf, uint32_t* begin, uint32_t* end)
+    // Fast path for plain quads (the legacy sprite vertex format), where the only per vertex data is the world position,
+    // the texture coordinates and the page index. Any other attribute has the same value for all vertices, so each vertex
+    // starts as a copy of a template vertex, written once per batch with dmGraphics::WriteAttributes.
+    static const uint32_t SPRITE_QUAD_BATCH_SIZE    = 4;
+    static const uint32_t SPRITE_QUAD_MAX_STRIDE    = 256;
+
+    struct SpriteQuadLayout
+    {
+        uint8_t  m_Template[SPRITE_QUAD_MAX_STRIDE];
+        uint32_t m_Stride;
+        uint32_t m_PositionOffset;
+        uint32_t m_PositionSize; // bytes
+        int32_t  m_TexCoordOffset;
+        int32_t  m_PageIndexOffset;
+        int32_t  m_TextureIndexOffset; // -1 unless the batch uses a texture table
+    };
+
+    // Structure of arrays for SPRITE_QUAD_BATCH_SIZE sprites, so that the corners are computed for all sprites at once
+    struct SpriteQuadBatch
+    {
+        float    m_World[16][SPRITE_QUAD_BATCH_SIZE];
+        float    m_UVs[8][SPRITE_QUAD_BATCH_SIZE];
+        float    m_PageIndex[SPRITE_QUAD_BATCH_SIZE];
+        float    m_TextureIndex[SPRITE_QUAD_BATCH_SIZE];
+        uint8_t* m_Vertices[SPRITE_QUAD_BATCH_SIZE];
+        uint32_t m_Count;
+    };
+
+    static bool InitSpriteQuadLayout(const dmGraphics::VertexAttributeInfos* infos, SpriteQuadLayout* layout)
+    {
+        if (infos->m_VertexStride > SPRITE_QUAD_MAX_STRIDE)
+        {
+            return false;
+        }
+
+        bool has_world_position = false;
+        bool has_texcoord       = false;
+        bool has_page_index     = false;
+
+        layout->m_Stride          = infos->m_VertexStride;
+        layout->m_TexCoordOffset  = -1;
+        layout->m_PageIndexOffset = -1;
+        layout->m_TextureIndexOffset = -1;
+
+        // Mirrors how dmGraphics::WriteAttributes picks the data for each attribute. Only the first channel of each semantic type gets engine data.
+        uint32_t offset = 0;
+        for (uint32_t i = 0; i < infos->m_NumInfos; ++i)
+        {
+            const dmGraphics::VertexAttributeInfo& info = infos->m_Infos[i];
+            if (info.m_StepFunction != dmGraphics::VERTEX_STEP_FUNCTION_VERTEX)
+            {
+                return false;
+            }
+
+            const uint32_t element_count = dmGraphics::VectorTypeToElementCount(info.m_VectorType);
+            const bool is_float          = info.m_DataType == dmGraphics::VertexAttribute::TYPE_FLOAT;
+
+            switch(info.m_SemanticType)
+            {
+                case dmGraphics::VertexAttribute::SEMANTIC_TYPE_POSITION:
+                    if (info.m_CoordinateSpace != dmGraphics::COORDINATE_SPACE_WORLD)
+                    {
+                        return false; // Local positions depend on the sprite size
+                    }
+                    if (!has_world_position)
+                    {
+                        if (!is_float || element_count < 2 || element_count > 4)
+                            return false;
+                        layout->m_PositionOffset = offset;
+                        layout->m_PositionSize   = element_count * sizeof(float);
+                        has_world_position = true;
+                    }
+                    break;
+                case dmGraphics::VertexAttribute::SEMANTIC_TYPE_TEXCOORD:
+                    if (!has_texcoord)
+                    {
+                        if (!is_float || info.m_VectorType != dmGraphics::VertexAttribute::VECTOR_TYPE_VEC2)
+                            return false;
+                        layout->m_TexCoordOffset = offset;
+                        has_texcoord = true;
+                    }
+                    break;
+                case dmGraphics::VertexAttribute::SEMANTIC_TYPE_PAGE_INDEX:
+                    if (!has_page_index)
+                    {
+                        if (!is_float || info.m_VectorType != dmGraphics::VertexAttribute::VECTOR_TYPE_SCALAR)
+                            return false;
+                        layout->m_PageIndexOffset = offset;
+                        has_page_index = true;
+                    }
+                    break;
+                case dmGraphics::VertexAttribute::SEMANTIC_TYPE_WORLD_MATRIX:
+                    return false; // Differs per sprite
+                default:
+                    break;
+            }
+
+            offset += element_count * dmGraphics::DataTypeToByteWidth(info.m_DataType);
+        }
+
+        if (!has_world_position || offset != infos->m_VertexStride)
+        {
+            return false;
+        }
+
+        // The varying attributes are overwritten for each vertex, so it doesn't matter what we pass for them here
+        float zero[4*4] = {};
+        const float* zero_channels[] = { zero };
+        dmGraphics::WriteAttributeParams params;
+        FillWriteVertexAttributeParams(&params, infos, 0, zero_channels, 0, zero_channels, 1, zero_channels, 1);
+        dmGraphics::WriteAttributes(layout->m_Template, 0, params);
+        return true;
+    }
+
+    static void FlushSpriteQuadBatch(const SpriteQuadLayout& layout, SpriteQuadBatch* batch)
+    {
+        // Same corner order as the generic quad path
+        static const float corners[4][2] = { {-0.5f, -0.5f}, {-0.5f, 0.5f}, {0.5f, 0.5f}, {0.5f, -0.5f} };
+
+        const uint32_t count = batch->m_Count;
+        for (uint32_t c = 0; c < 4; ++c)
+        {
+            const float cx = corners[c][0];
+            const float cy = corners[c][1];
+
+            // world * (cx, cy, 0, 1), for all the sprites in the batch
+            float p[4][SPRITE_QUAD_BATCH_SIZE];
+#if defined(__wasm_simd128__)
+            const v128_t vcx = wasm_f32x4_splat(cx);
+            const v128_t vcy = wasm_f32x4_splat(cy);
+            for (uint32_t r = 0; r < 4; ++r)
+            {
+                v128_t x = wasm_f32x4_mul(wasm_v128_load(batch->m_World[r]), vcx);
+                v128_t y = wasm_f32x4_mul(wasm_v128_load(batch->m_World[4 + r]), vcy);
+                wasm_v128_store(p[r], wasm_f32x4_add(wasm_f32x4_add(x, y), wasm_v128_load(batch->m_World[12 + r])));
+            }
+#else
+            for (uint32_t r = 0; r < 4; ++r)
+            {
+                for (uint32_t j = 0; j < SPRITE_QUAD_BATCH_SIZE; ++j)
+                {
+                    p[r][j] = batch->m_World[r][j] * cx + batch->m_World[4 + r][j] * cy + batch->m_World[12 + r][j];
+                }
+            }
+#endif
+
+            for (uint32_t j = 0; j < count; ++j)
+            {
+                uint8_t* v = batch->m_Vertices[j] + c * layout.m_Stride;
+                memcpy(v, layout.m_Template, layout.m_Stride);
+
+                float position[4] = { p[0][j], p[1][j], p[2][j], p[3][j] };
+                memcpy(v + layout.m_PositionOffset, position, layout.m_PositionSize);
+                if (layout.m_TexCoordOffset >= 0)
+                {
+                    float uv[2] = { batch->m_UVs[c*2+0][j], batch->m_UVs[c*2+1][j] };
+                    memcpy(v + layout.m_TexCoordOffset, uv, sizeof(uv));
+                }
+                if (layout.m_PageIndexOffset >= 0)
+                {
+                    memcpy(v + layout.m_PageIndexOffset, &batch->m_PageIndex[j], sizeof(float));
+                }
+                if (layout.m_TextureIndexOffset >= 0)
+                {
+                    memcpy(v + layout.m_TextureIndexOffset, &batch->m_TextureIndex[j], sizeof(float));
+                }
+            }
+        }
+        batch->m_Count = 0;
+    }
+
+    static void AddToSpriteQuadBatch(const SpriteQuadLayout& layout, SpriteQuadBatch* batch, uint8_t* vertices, const Matrix4& world, const float* uvs, float page_index, float texture_index)
+    {
+        const uint32_t j = batch->m_Count;
+        const float* m = (const float*) &world;
+        for (uint32_t i = 0; i < 16; ++i)
+        {
+            batch->m_World[i][j] = m[i];
+        }
+        for (uint32_t i = 0; i < 8; ++i)
+        {
+            batch->m_UVs[i][j] = uvs[i];
+        }
+        batch->m_PageIndex[j] = page_index;
+        batch->m_TextureIndex[j] = texture_index;
+        batch->m_Vertices[j]  = vertices;
+
+        if (++batch->m_Count == SPRITE_QUAD_BATCH_SIZE)
+        {
+            FlushSpriteQuadBatch(layout, batch);
+        }
+    }
+
+    // The textures bound by a batch of sprites that uses a texture table (see UsesTextureTable)
+    struct SpriteTextureTable
+    {
+        dmGraphics::HTexture    m_Textures[MAX_TEXTURE_COUNT];
+        uint32_t                m_Count;
+        int32_t                 m_TextureIndexOffset;   // Byte offset of the texture index in the vertex
+        const float*            m_TextureIndices;       // One per sprite in the batch
+    };
+
+    // Returns the byte offset of the "texture_index" attribute in the vertex, or -1 if there is no such float attribute
+    static int32_t GetTextureIndexOffset(const dmGraphics::VertexAttributeInfos* infos)
+    {
+        uint32_t offset = 0;
+        for (uint32_t i = 0; i < infos->m_NumInfos; ++i)
+        {
+            const dmGraphics::VertexAttributeInfo& info = infos->m_Infos[i];
+            if (info.m_NameHash == dmRender::VERTEX_STREAM_TEXTURE_INDEX)
+            {
+                bool is_scalar_float = info.m_DataType == dmGraphics::VertexAttribute::TYPE_FLOAT && info.m_VectorType == dmGraphics::VertexAttribute::VECTOR_TYPE_SCALAR;
+                return is_scalar_float && info.m_StepFunction == dmGraphics::VERTEX_STEP_FUNCTION_VERTEX ? (int32_t) offset : -1;
+            }
+            if (info.m_StepFunction == dmGraphics::VERTEX_STEP_FUNCTION_VERTEX)
+            {
+                offset += dmGraphics::VectorTypeToElementCount(info.m_VectorType) * dmGraphics::DataTypeToByteWidth(info.m_DataType);
+            }
+        }
+        return -1;
+    }
+
+    static void WriteTextureIndex(uint8_t* vertices, uint8_t* vertices_end, uint32_t vertex_stride, int32_t offset, float texture_index)
+    {
+        for (; vertices < vertices_end; vertices += vertex_stride)
+        {
+            memcpy(vertices + offset, &texture_index, sizeof(float));
+        }
+    }
+
+    static void CreateVertexData(SpriteWorld* sprite_world, dmGraphics::VertexAttributeInfos* material_attribute_info, bool has_local_position_attribute, const SpriteTextureTable* texture_table, uint8_t** vb_where, uint8_t** ib_where, dmRender::RenderListEntry* buf, uint32_t* begin, uint32_t* end)
     {
         DM_PROFILE("CreateVertexData");
 
@@ -1185,6 +1485,21 @@ namespace dmGameSystem
         dmGraphics::VertexAttributeInfos sprite_attribute_info = {};
         dmGraphics::WriteAttributeParams write_params = {};
 
+        // Only used for sprites with a single texture, that use the material attributes as is
+        SpriteQuadLayout quad_layout;
+        SpriteQuadBatch quad_batch;
+        quad_batch.m_Count = 0;
+        bool use_quad_batch = textures.m_NumTextures == 1 && !has_local_position_attribute && InitSpriteQuadLayout(material_attribute_info, &quad_layout);
+        if (use_quad_batch)
+        {
+            // Unused lanes are still computed
+            memset(&quad_batch, 0, sizeof(quad_batch));
+            if (texture_table)
+            {
+                quad_layout.m_TextureIndexOffset = texture_table->m_TextureIndexOffset;
+            }
+        }
+
         for (uint32_t* i = begin; i != end; ++i)
         {
             uint32_t component_index         = (uint32_t)buf[*i].m_UserData;
@@ -1194,12 +1509,20 @@ namespace dmGameSystem
             float sp_width  = component->m_Size.getX();
             float sp_height = component->m_Size.getY();
 
+            if (texture_table)
+            {
+                // The sprites in the batch don't share their texture
+                textures.m_Resources[0]   = GetTextureSetByIndex(component, 0);
+                textures.m_TextureSets[0] = textures.m_Resources[0]->m_TextureSet;
+            }
+
             // Get the correct animation frames, and other meta data
             ResolveAnimationData(&textures, component->m_CurrentAnimation, component->m_CurrentAnimationFrame);
 
             // Fill in the custom sprite attributes (if specified), otherwise fallback to use the material attributes
             dmGraphics::VertexAttributeInfos* sprite_attribute_info_ptr = material_attribute_info;
-            if (component->m_Resource->m_DDF->m_Attributes.m_Count > 0 || component->m_DynamicVertexAttributeIndex != INVALID_DYNAMIC_ATTRIBUTE_INDEX)
+            bool has_custom_attributes = component->m_Resource->m_DDF->m_Attributes.m_Count > 0 || component->m_DynamicVertexAttributeIndex != INVALID_DYNAMIC_ATTRIBUTE_INDEX;
+            if (has_custom_attributes)
             {
                 FillAttributeInfos(&sprite_world->m_DynamicVertexAttributePool,
                     component->m_DynamicVertexAttributeIndex,
@@ -1212,7 +1535,7 @@ namespace dmGameSystem
             }
 
             // We need to pad the buffer if the vertex stride doesn't start at an even byte offset from the start
-            const uint32_t vb_buffer_offset = vertices - sprite_world->m_VertexBufferData;
+            const uint32_t vb_buffer_offset = vertices - sprite_world->m_VertexBufferBase;
             vertex_offset = vb_buffer_offset / vertex_stride;
 
             if (vb_buffer_offset % vertex_stride != 0)
@@ -1221,6 +1544,9 @@ namespace dmGameSystem
                 vertex_offset += 1;
             }
 
+            uint8_t* sprite_vertices = vertices;
+            bool batched = false;
+
             // if num_texture == 0, then we don't have a texture set to get any vertex/uv coordinates from
             if (textures.m_NumTextures != 0 && !CanUseQuads(&textures))
             {
@@ -1331,44 +1657,55 @@ namespace dmGameSystem
                     //    for any subsequent geometry would yield a wuad anyways.
                     ResolveUVDataFromQuads(&textures, sprite_world->m_ScratchUVs, scratch_uv_ptrs, scratch_pi_ptrs, component->m_FlipHorizontal, component->m_FlipVertical);
 
-                    Vector4 positions_world[] = {
-                        world_matrix * Point3(-0.5f, -0.5f, 0.0f),
-                        world_matrix * Point3(-0.5f,  0.5f, 0.0f),
-                        world_matrix * Point3( 0.5f,  0.5f, 0.0f),
-                        world_matrix * Point3( 0.5f, -0.5f, 0.0f)};
-
-                    Vector4 positions_local[4];
-                    if (has_local_position_attribute)
+                    if (use_quad_batch && !has_custom_attributes && scratch_uv_ptrs[0])
                     {
-                        positions_local[0] = Vector4(-0.5f * sp_width, -0.5f * sp_height, 0.0f, 1.0f);
-                        positions_local[1] = Vector4(-0.5f * sp_width,  0.5f * sp_height, 0.0f, 1.0f);
-                        positions_local[2] = Vector4( 0.5f * sp_width,  0.5f * sp_height, 0.0f, 1.0f);
-                        positions_local[3] = Vector4( 0.5f * sp_width, -0.5f * sp_height, 0.0f, 1.0f);
+                        // The space is reserved now, and the vertices are written once the batch is full
+                        float texture_index = texture_table ? texture_table->m_TextureIndices[i - begin] : 0.0f;
+                        AddToSpriteQuadBatch(quad_layout, &quad_batch, vertices, world_matrix, scratch_uv_ptrs[0], *scratch_pi_ptrs[0], texture_index);
+                        vertices += SPRITE_VERTEX_COUNT_LEGACY * vertex_stride;
+                        batched = true;
+                    }
+                    else
+                    {
+                        Vector4 positions_world[] = {
+                            world_matrix * Point3(-0.5f, -0.5f, 0.0f),
+                            world_matrix * Point3(-0.5f,  0.5f, 0.0f),
+                            world_matrix * Point3( 0.5f,  0.5f, 0.0f),
+                            world_matrix * Point3( 0.5f, -0.5f, 0.0f)};
+
+                        Vector4 positions_local[4];
+                        if (has_local_position_attribute)
+                        {
+                            positions_local[0] = Vector4(-0.5f * sp_width, -0.5f * sp_height, 0.0f, 1.0f);
+                            positions_local[1] = Vector4(-0.5f * sp_width,  0.5f * sp_height, 0.0f, 1.0f);
+                            positions_local[2] = Vector4( 0.5f * sp_width,  0.5f * sp_height, 0.0f, 1.0f);
+                            positions_local[3] = Vector4( 0.5f * sp_width, -0.5f * sp_height, 0.0f, 1.0f);
+                        }
+
+                        const float* world_matrix_channel[]    = { (float*) &world_matrix };
+                        const float* local_position_channels[] = { (float*) &positions_local };
+                        const float* world_position_channels[] = { (float*) &positions_world };
+
+                        FillWriteVertexAttributeParams(&write_params,
+                            sprite_attribute_info_ptr,
+                            world_matrix_channel,
+                            world_position_channels,
+                            local_position_channels,
+                            (const float**) scratch_uv_ptrs,
+                            textures.m_NumTextures,
+                            (const float**) scratch_pi_ptrs,
+                            textures.m_NumTextures);
+
+                        vertices = dmGraphics::WriteAttributes(vertices, 0, write_params);
+                        vertices = dmGraphics::WriteAttributes(vertices, 1, write_params);
+                        vertices = dmGraphics::WriteAttributes(vertices, 2, write_params);
+                        vertices = dmGraphics::WriteAttributes(vertices, 3, write_params);
+
+                    #if 0
+                        for (int f = 0; f < 4; ++f)
+                            printf("  %u: %.2f, %.2f\t%.2f, %.2f\n", f, vertices[f].x, vertices[f].y, vertices[f].u, vertices[f].v );
+                    #endif
                     }
-
-                    const float* world_matrix_channel[]    = { (float*) &world_matrix };
-                    const float* local_position_channels[] = { (float*) &positions_local };
-                    const float* world_position_channels[] = { (float*) &positions_world };
-
-                    FillWriteVertexAttributeParams(&write_params,
-                        sprite_attribute_info_ptr,
-                        world_matrix_channel,
-                        world_position_channels,
-                        local_position_channels,
-                        (const float**) scratch_uv_ptrs,
-                        textures.m_NumTextures,
-                        (const float**) scratch_pi_ptrs,
-                        textures.m_NumTextures);
-
-                    vertices = dmGraphics::WriteAttributes(vertices, 0, write_params);
-                    vertices = dmGraphics::WriteAttributes(vertices, 1, write_params);
-                    vertices = dmGraphics::WriteAttributes(vertices, 2, write_params);
-                    vertices = dmGraphics::WriteAttributes(vertices, 3, write_params);
-
-                #if 0
-                    for (int f = 0; f < 4; ++f)
-                        printf("  %u: %.2f, %.2f\t%.2f, %.2f\n", f, vertices[f].x, vertices[f].y, vertices[f].u, vertices[f].v );
-                #endif
 
                     if (sprite_world->m_Is16BitIndex)
                     {
@@ -1394,6 +1731,16 @@ namespace dmGameSystem
                     indices       += SPRITE_INDEX_COUNT_LEGACY * index_type_size;
                 }
             }
+
+            if (texture_table && texture_table->m_TextureIndexOffset >= 0 && !batched)
+            {
+                WriteTextureIndex(sprite_vertices, vertices, vertex_stride, texture_table->m_TextureIndexOffset, texture_table->m_TextureIndices[i - begin]);
+            }
+        }
+
+        if (quad_batch.m_Count > 0)
+        {
+            FlushSpriteQuadBatch(quad_layout, &quad_batch);
         }
 
         sprite_world->m_VerticesWritten = vertex_offset;
@@ -1402,10 +1749,24 @@ namespace dmGameSystem
         *ib_where = indices;
     }
 
-    static void RenderBatch(SpriteWorld* sprite_world, dmRender::HRenderContext render_context, dmRender::RenderListEntry *buf, uint32_t* begin, uint32_t* end)
+    static void BeginVertexBufferWrite(SpriteWorld* sprite_world, dmRender::HRenderContext render_context)
     {
-        DM_PROFILE("SpriteRenderBatch");
+        if (dmRender::GetBufferIndex(render_context, sprite_world->m_VertexBuffer) < sprite_world->m_DispatchCount)
+        {
+            dmRender::AddRenderBuffer(render_context, sprite_world->m_VertexBuffer);
+        }
+
+        // Write the vertices straight into the graphics buffer if possible,
+        // otherwise they are uploaded from m_VertexBufferData when the dispatch ends.
+        uint8_t* mapped = (uint8_t*) dmRender::MapBufferData(render_context, sprite_world->m_VertexBuffer, sprite_world->m_VertexMemorySize, dmGraphics::BUFFER_USAGE_DYNAMIC_DRAW);
+
+        sprite_world->m_VertexBufferMapped   = mapped != 0;
+        sprite_world->m_VertexBufferBase     = mapped ? mapped : sprite_world->m_VertexBufferData;
+        sprite_world->m_VertexBufferWritePtr = sprite_world->m_VertexBufferBase;
+    }
 
+    static void RenderSpriteRange(SpriteWorld* sprite_world, dmRender::HRenderContext render_context, dmRender::RenderListEntry *buf, uint32_t* begin, uint32_t* end, const SpriteTextureTable* texture_table)
+    {
         uint32_t component_index = (uint32_t)buf[*begin].m_UserData;
         const SpriteComponent* first = (const SpriteComponent*) &sprite_world->m_Components.GetRawObjects()[component_index];
         assert(first->m_Enabled);
@@ -1437,15 +1798,11 @@ namespace dmGameSystem
         uint8_t* ib_iter  = ib_begin;
 
         dmGraphics::VertexAttributeInfoMetadata material_attribute_info_meta = dmGraphics::GetVertexAttributeInfosMetaData(material_attribute_info);
-        CreateVertexData(sprite_world, &material_attribute_info, material_attribute_info_meta.m_HasAttributeLocalPosition, &vb_iter, &ib_iter, buf, begin, end);
+        CreateVertexData(sprite_world, &material_attribute_info, material_attribute_info_meta.m_HasAttributeLocalPosition, texture_table, &vb_iter, &ib_iter, buf, begin, end);
 
         sprite_world->m_VertexBufferWritePtr = vb_iter;
         sprite_world->m_IndexBufferWritePtr = ib_iter;
 
-        if (dmRender::GetBufferIndex(render_context, sprite_world->m_VertexBuffer) < sprite_world->m_DispatchCount)
-        {
-            dmRender::AddRenderBuffer(render_context, sprite_world->m_VertexBuffer);
-        }
         if (dmRender::GetBufferIndex(render_context, sprite_world->m_IndexBuffer) < sprite_world->m_DispatchCount)
         {
             dmRender::AddRenderBuffer(render_context, sprite_world->m_IndexBuffer);
@@ -1456,9 +1813,19 @@ namespace dmGameSystem
         ro.m_VertexBuffer = (dmGraphics::HVertexBuffer) dmRender::GetBuffer(render_context, sprite_world->m_VertexBuffer);
         ro.m_IndexBuffer = (dmGraphics::HIndexBuffer) dmRender::GetBuffer(render_context, sprite_world->m_IndexBuffer);
         ro.m_Material = GetComponentMaterial(first);
-        for(uint32_t i = 0; i < resource->m_NumTextures; ++i)
+        if (texture_table)
         {
-            ro.m_Textures[i] = GetMaterialTexture(first, i);
+            for(uint32_t i = 0; i < texture_table->m_Count; ++i)
+            {
+                ro.m_Textures[i] = texture_table->m_Textures[i];
+            }
+        }
+        else
+        {
+            for(uint32_t i = 0; i < resource->m_NumTextures; ++i)
+            {
+                ro.m_Textures[i] = GetMaterialTexture(first, i);
+            }
         }
 
         ro.m_PrimitiveType = dmGraphics::PRIMITIVE_TRIANGLES;
@@ -1515,6 +1882,79 @@ namespace dmGameSystem
         dmRender::AddToRender(render_context, &ro);
     }
 
+    static void RenderBatch(SpriteWorld* sprite_world, dmRender::HRenderContext render_context, dmRender::RenderListEntry *buf, uint32_t* begin, uint32_t* end)
+    {
+        DM_PROFILE("SpriteRenderBatch");
+
+        if (!sprite_world->m_VertexBufferBase)
+        {
+            BeginVertexBufferWrite(sprite_world, render_context);
+        }
+
+        const dmArray<SpriteComponent>& components = sprite_world->m_Components.GetRawObjects();
+        const SpriteComponent* first = &components[(uint32_t)buf[*begin].m_UserData];
+        if (!UsesTextureTable(first))
+        {
+            RenderSpriteRange(sprite_world, render_context, buf, begin, end, 0);
+            return;
+        }
+
+        // The batch key doesn't include the textures, so the range is split whenever the texture table is full.
+        // If the render material (e.g. set from the render script) has no texture index, there's room for one texture only.
+        dmRender::HMaterial material = GetRenderMaterial(render_context, first);
+        dmGraphics::VertexAttributeInfos material_attribute_info;
+        FillMaterialAttributeInfos(material, dmRender::GetVertexDeclaration(material), &material_attribute_info, dmGraphics::COORDINATE_SPACE_WORLD);
+
+        SpriteTextureTable texture_table;
+        texture_table.m_Count = 0;
+        texture_table.m_TextureIndexOffset = GetTextureIndexOffset(&material_attribute_info);
+        uint32_t max_texture_count = texture_table.m_TextureIndexOffset >= 0 ? GetMaterialResource(first)->m_NumTextures : 1;
+
+        EnsureSize(sprite_world->m_ScratchTextureIndices, end - begin);
+        float* texture_indices = sprite_world->m_ScratchTextureIndices.Begin();
+
+        uint32_t* range_begin = begin;
+        for (uint32_t* i = begin; i != end; ++i)
+        {
+            dmGraphics::HTexture texture = GetMaterialTexture(&components[(uint32_t)buf[*i].m_UserData], 0);
+            uint32_t slot = 0;
+            while (slot < texture_table.m_Count && texture_table.m_Textures[slot] != texture)
+            {
+                ++slot;
+            }
+
+            if (slot == texture_table.m_Count)
+            {
+                if (texture_table.m_Count == max_texture_count)
+                {
+                    texture_table.m_TextureIndices = texture_indices + (range_begin - begin);
+                    RenderSpriteRange(sprite_world, render_context, buf, range_begin, i, &texture_table);
+                    range_begin = i;
+                    texture_table.m_Count = 0;
+                    slot = 0;
+                }
+                texture_table.m_Textures[texture_table.m_Count++] = texture;
+            }
+            texture_indices[i - begin] = (float) slot;
+        }
+
+        texture_table.m_TextureIndices = texture_indices + (range_begin - begin);
+        RenderSpriteRange(sprite_world, render_context, buf, range_begin, end, &texture_table);
+    }
+
+    // Returns false if neither the game object transform nor the sprite size changed since the last update
+    static inline bool NeedsTransformUpdate(SpriteComponent* c, bool world_changed, const Vector3& size)
+    {
+        if (c->m_TransformValid && !world_changed &&
+            memcmp(&c->m_CachedSize, &size, sizeof(Vector3)) == 0)
+        {
+            return false;
+        }
+        c->m_CachedSize = size;
+        c->m_TransformValid = 1;
+        return true;
+    }
+
     static void UpdateTransforms(SpriteWorld* sprite_world, bool sub_pixels)
     {
         DM_PROFILE("UpdateTransforms");
@@ -1522,47 +1962,45 @@ namespace dmGameSystem
         dmArray<SpriteComponent>& components = sprite_world->m_Components.GetRawObjects();
         uint32_t n = components.Size();
 
-        bool scale_along_z = false;
-        if (n > 0) {
-            SpriteComponent* c = &components[0];
-            scale_along_z = dmGameObject::ScaleAlongZ(dmGameObject::GetCollection(c->m_Instance));
-        }
+        if (n == 0)
+            return;
+
+        // All the sprites of the world belong to the same collection, whose transforms are read directly
+        dmGameObject::HCollection collection = dmGameObject::GetCollection(components[0].m_Instance);
+        bool scale_along_z = dmGameObject::ScaleAlongZ(collection);
+        const Matrix4* world_transforms = dmGameObject::GetWorldTransforms(collection);
+        uint32_t current_version;
+        const uint32_t* versions = dmGameObject::GetTransformVersions(collection, &current_version);
+        uint32_t last_version = sprite_world->m_TransformVersion;
+        sprite_world->m_TransformVersion = current_version;
+
         // Note: We update all sprites, even though they might be disabled, or not added to update
+        // Sprites whose game object and size haven't changed keep their previous world transform (and bounding volume),
+        // which makes static level art close to free here.
 
-        if (scale_along_z) {
-            for (uint32_t i = 0; i < n; ++i)
-            {
-                SpriteComponent* c = &components[i];
-                Matrix4 local = dmTransform::ToMatrix4(dmTransform::Transform(c->m_Position, c->m_Rotation, 1.0f));
-                Matrix4 world = dmGameObject::GetWorldMatrix(c->m_Instance);
-                Vector3 size( c->m_Size.getX() * c->m_Scale.getX(), c->m_Size.getY() * c->m_Scale.getY(), 1);
-                c->m_World = dmVMath::AppendScale(world * local, size);
-                // we need to consider the full scale here
-                // I.e. we want the length of the diagonal C, where C = X + Y
-                float radius_sq = dmVMath::LengthSqr((c->m_World.getCol(0).getXYZ() + c->m_World.getCol(1).getXYZ()) * 0.5f);
-                sprite_world->m_BoundingVolumes[i] = radius_sq;
-            }
-        } else
+        for (uint32_t i = 0; i < n; ++i)
         {
-            for (uint32_t i = 0; i < n; ++i)
+            SpriteComponent* c = &components[i];
+            uint32_t transform_index = c->m_TransformIndex;
+            Vector3 size( c->m_Size.getX() * c->m_Scale.getX(), c->m_Size.getY() * c->m_Scale.getY(), 1);
+            if (!NeedsTransformUpdate(c, versions[transform_index] > last_version, size))
             {
-                SpriteComponent* c = &components[i];
-                Matrix4 local = dmTransform::ToMatrix4(dmTransform::Transform(c->m_Position, c->m_Rotation, 1.0f));
-                Matrix4 world = dmGameObject::GetWorldMatrix(c->m_Instance);
-                Matrix4 w = dmTransform::MulNoScaleZ(world, local);
-                Vector3 size( c->m_Size.getX() * c->m_Scale.getX(), c->m_Size.getY() * c->m_Scale.getY(), 1);
-                c->m_World = dmVMath::AppendScale(w, size);
-                // we need to consider the full scale here
-                // I.e. we want the length of the diagonal C, where C = X + Y
-                float radius_sq = dmVMath::LengthSqr((c->m_World.getCol(0).getXYZ() + c->m_World.getCol(1).getXYZ()) * 0.5f);
-                sprite_world->m_BoundingVolumes[i] = radius_sq;
+                // The object pool may have moved the component to a new slot
+                sprite_world->m_BoundingVolumes[i] = c->m_BoundingRadiusSq;
+                continue;
             }
-        }
 
-        // The "sub_pixels" is set by default
-        if (!sub_pixels) {
-            for (uint32_t i = 0; i < n; ++i) {
-                SpriteComponent* c = &components[i];
+            const Matrix4& world = world_transforms[transform_index];
+            Matrix4 local = dmTransform::ToMatrix4(dmTransform::Transform(c->m_Position, c->m_Rotation, 1.0f));
+            Matrix4 w = scale_along_z ? world * local : dmTransform::MulNoScaleZ(world, local);
+            c->m_World = dmVMath::AppendScale(w, size);
+            // we need to consider the full scale here
+            // I.e. we want the length of the diagonal C, where C = X + Y
+            c->m_BoundingRadiusSq = dmVMath::LengthSqr((c->m_World.getCol(0).getXYZ() + c->m_World.getCol(1).getXYZ()) * 0.5f);
+            sprite_world->m_BoundingVolumes[i] = c->m_BoundingRadiusSq;
+
+            // The "sub_pixels" is set by default
+            if (!sub_pixels) {
                 Vector4 position = c->m_World.getCol3();
                 position.setX((int) position.getX());
                 position.setY((int) position.getY());
@@ -1592,11 +2030,12 @@ namespace dmGameSystem
     {
         DM_PROFILE("PostMessages");
 
-        dmArray<SpriteComponent>& components = sprite_world->m_Components.GetRawObjects();
-        uint32_t n = components.Size();
+        // Only the active sprites can be playing
+        const dmArray<uint32_t>& active = sprite_world->m_ActiveComponents;
+        uint32_t n = active.Size();
         for (uint32_t i = 0; i < n; ++i)
         {
-            SpriteComponent* component = &components[i];
+            SpriteComponent* component = &sprite_world->m_Components.Get(active[i]);
             // NOTE: texture_set = c->m_Resource might be NULL so it's essential to "continue" here
             if (!component->m_Enabled || !component->m_Playing)
                 continue;
@@ -1652,11 +2091,19 @@ namespace dmGameSystem
     {
         DM_PROFILE("Animate");
 
-        dmArray<SpriteComponent>& components = sprite_world->m_Components.GetRawObjects();
-        uint32_t n = components.Size();
-        for (uint32_t i = 0; i < n; ++i)
+        dmArray<uint32_t>& active = sprite_world->m_ActiveComponents;
+        uint32_t i = 0;
+        while (i < active.Size())
         {
-            SpriteComponent* component = &components[i];
+            SpriteComponent* component = &sprite_world->m_Components.Get(active[i]);
+            // The sprite is idle until it's played again (see ActivateSprite)
+            if (!component->m_Playing && !component->m_DoTick)
+            {
+                DeactivateSprite(sprite_world, component);
+                continue;
+            }
+            ++i;
+
             // NOTE: texture_set = c->m_Resource might be NULL so it's essential to "continue" here
             if (!component->m_Enabled)
                 continue;
@@ -1819,6 +2266,30 @@ namespace dmGameSystem
         return dmGameObject::UPDATE_RESULT_OK;
     }
 
+    // Number of consecutive render list entries that are tested as one cluster before testing the sprites individually
+    static const uint32_t SPRITE_CULLING_CLUSTER_SIZE = 32;
+
+    enum ClusterVisibility
+    {
+        CLUSTER_OUTSIDE,
+        CLUSTER_INSIDE,
+        CLUSTER_INTERSECTS,
+    };
+
+    static ClusterVisibility ClassifyFrustumSphere(const dmIntersection::Frustum& frustum, const Point3& pos, float radius)
+    {
+        ClusterVisibility result = CLUSTER_INSIDE;
+        for (int i = 0; i < frustum.m_NumPlanes; ++i)
+        {
+            float d = dmIntersection::DistanceToPlane(frustum.m_Planes[i], pos);
+            if (d < -radius)
+                return CLUSTER_OUTSIDE;
+            if (d < radius)
+                result = CLUSTER_INTERSECTS;
+        }
+        return result;
+    }
+
     static void RenderListFrustumCulling(dmRender::RenderListVisibilityParams const &params)
     {
         DM_PROFILE("Sprite");
@@ -1828,14 +2299,49 @@ namespace dmGameSystem
 
         const dmIntersection::Frustum frustum = *params.m_Frustum;
         uint32_t num_entries = params.m_NumEntries;
-        for (uint32_t i = 0; i < num_entries; ++i)
+
+        // Sprites are submitted in component order, which usually follows the order the level was built in.
+        // Testing a bounding sphere around each cluster first lets us accept or reject whole groups of
+        // (e.g. off screen) sprites without testing every one of them against the frustum planes.
+        for (uint32_t cluster_start = 0; cluster_start < num_entries; cluster_start += SPRITE_CULLING_CLUSTER_SIZE)
         {
-            dmRender::RenderListEntry* entry = &params.m_Entries[i];
+            dmRender::RenderListEntry* entries = &params.m_Entries[cluster_start];
+            uint32_t cluster_count = dmMath::Min(SPRITE_CULLING_CLUSTER_SIZE, num_entries - cluster_start);
+
+            Point3 min_pos = entries[0].m_WorldPosition;
+            Point3 max_pos = min_pos;
+            float max_radius_sq = 0.0f;
+            for (uint32_t i = 0; i < cluster_count; ++i)
+            {
+                const Point3& pos = entries[i].m_WorldPosition;
+                min_pos = Point3(dmMath::Min(min_pos.getX(), pos.getX()), dmMath::Min(min_pos.getY(), pos.getY()), dmMath::Min(min_pos.getZ(), pos.getZ()));
+                max_pos = Point3(dmMath::Max(max_pos.getX(), pos.getX()), dmMath::Max(max_pos.getY(), pos.getY()), dmMath::Max(max_pos.getZ(), pos.getZ()));
+                max_radius_sq = dmMath::Max(max_radius_sq, radiuses[entries[i].m_UserData]);
+            }
+
+            Point3 center = min_pos + (max_pos - min_pos) * 0.5f;
+            float cluster_radius = dmVMath::Length(max_pos - center) + sqrtf(max_radius_sq);
+            ClusterVisibility cluster_visibility = ClassifyFrustumSphere(frustum, center, cluster_radius);
+
+            if (cluster_visibility != CLUSTER_INTERSECTS)
+            {
+                dmRender::Visibility visibility = cluster_visibility == CLUSTER_INSIDE ? dmRender::VISIBILITY_FULL : dmRender::VISIBILITY_NONE;
+                for (uint32_t i = 0; i < cluster_count; ++i)
+                {
+                    entries[i].m_Visibility = visibility;
+                }
+                continue;
+            }
+
+            for (uint32_t i = 0; i < cluster_count; ++i)
+            {
+                dmRender::RenderListEntry* entry = &entries[i];
 
-            float radius_sq = radiuses[entry->m_UserData];
+                float radius_sq = radiuses[entry->m_UserData];
 
-            bool intersect = dmIntersection::TestFrustumSphereSq(frustum, entry->m_WorldPosition, radius_sq);
-            entry->m_Visibility = intersect ? dmRender::VISIBILITY_FULL : dmRender::VISIBILITY_NONE;
+                bool intersect = dmIntersection::TestFrustumSphereSq(frustum, entry->m_WorldPosition, radius_sq);
+                entry->m_Visibility = intersect ? dmRender::VISIBILITY_FULL : dmRender::VISIBILITY_NONE;
+            }
         }
     }
 
@@ -1846,21 +2352,32 @@ namespace dmGameSystem
         switch (params.m_Operation)
         {
             case dmRender::RENDER_LIST_OPERATION_BEGIN:
-                world->m_VertexBufferWritePtr = world->m_VertexBufferData;
+                // The vertex buffer is mapped when the first batch is rendered
+                world->m_VertexBufferBase = 0;
+                world->m_VertexBufferWritePtr = 0;
                 world->m_IndexBufferWritePtr = world->m_IndexBufferData;
                 world->m_RenderObjectsInUse = 0;
                 break;
             case dmRender::RENDER_LIST_OPERATION_END:
                 {
-                    uint32_t vertex_data_size = world->m_VertexBufferWritePtr - world->m_VertexBufferData;
+                    uint32_t vertex_data_size = world->m_VertexBufferWritePtr - world->m_VertexBufferBase;
                     uint32_t index_data_size  = world->m_IndexBufferWritePtr - world->m_IndexBufferData;
 
+                    if (world->m_VertexBufferMapped)
+                    {
+                        dmRender::UnmapBufferData(params.m_Context, world->m_VertexBuffer);
+                        world->m_VertexBufferMapped = 0;
+                    }
+
                     // JG: The renderer executes the dispatch function for begin/end regardless if something is actually batched or not
                     //     This behaviour can cause side-effects on certain platforms and non-opengl graphics adapters.
                     //     We might want to change how that process is setup, but for now this is a safer change.
                     if (vertex_data_size && index_data_size)
                     {
-                        dmRender::SetBufferData(params.m_Context, world->m_VertexBuffer, vertex_data_size, world->m_VertexBufferData, dmGraphics::BUFFER_USAGE_DYNAMIC_DRAW);
+                        if (world->m_VertexBufferBase == world->m_VertexBufferData)
+                        {
+                            dmRender::SetBufferData(params.m_Context, world->m_VertexBuffer, vertex_data_size, world->m_VertexBufferData, dmGraphics::BUFFER_USAGE_DYNAMIC_DRAW);
+                        }
                         dmRender::SetBufferData(params.m_Context, world->m_IndexBuffer, index_data_size, world->m_IndexBufferData, dmGraphics::BUFFER_USAGE_DYNAMIC_DRAW);
 
                         DM_PROPERTY_ADD_U32(rmtp_SpriteVertexCount, world->m_VertexCount);
@@ -2039,6 +2556,7 @@ namespace dmGameSystem
                 dmGameSystemDDF::PlayAnimation* ddf = (dmGameSystemDDF::PlayAnimation*)params.m_Message->m_Data;
                 if (PlayAnimation(component, ddf->m_Id, ddf->m_Offset, ddf->m_PlaybackRate))
                 {
+                    ActivateSprite(sprite_world, *params.m_UserData);
                     // Remove the currently assigned callback by sending an unref message
                     if (component->m_FunctionRef)
                     {
@@ -2093,12 +2611,24 @@ namespace dmGameSystem
         return dmGameObject::UPDATE_RESULT_OK;
     }
 
+    dmGameObject::UpdateResult CompSpriteOnMessageBatch(const dmGameObject::ComponentsOnMessageBatchParams& params)
+    {
+        for (uint32_t i = 0; i < params.m_Count; ++i)
+        {
+            CompSpriteOnMessage(params.m_Messages[i]);
+        }
+        return dmGameObject::UPDATE_RESULT_OK;
+    }
+
     void CompSpriteOnReload(const dmGameObject::ComponentOnReloadParams& params)
     {
         SpriteWorld* sprite_world = (SpriteWorld*)params.m_World;
         SpriteComponent* component = &sprite_world->m_Components.Get(*params.m_UserData);
         if (component->m_Playing)
+        {
             PlayAnimation(component, component->m_CurrentAnimation, component->m_AnimTimer, component->m_PlaybackRate);
+            ActivateSprite(sprite_world, *params.m_UserData);
+        }
     }
 
     dmGameObject::PropertyResult CompSpriteGetProperty(const dmGameObject::ComponentGetPropertyParams& params, dmGameObject::PropertyDesc& out_value)
@@ -2217,6 +2747,7 @@ namespace dmGameSystem
                 return dmGameObject::PROPERTY_RESULT_TYPE_MISMATCH;
 
             SetCursor(component, params.m_Value.m_Number);
+            ActivateSprite(sprite_world, *params.m_UserData);
             return dmGameObject::PROPERTY_RESULT_OK;
         }
         else if (params.m_PropertyId == SPRITE_PROP_PLAYBACK_RATE)
@@ -2247,6 +2778,7 @@ namespace dmGameSystem
                 if (anim_id)
                 {
                     PlayAnimation(component, component->m_CurrentAnimation, GetCursor(component), component->m_PlaybackRate);
+                    ActivateSprite(sprite_world, *params.m_UserData);
                 }
                 else
                 {
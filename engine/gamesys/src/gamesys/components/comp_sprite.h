@@ -35,6 +35,8 @@ namespace dmGameSystem
 
     dmGameObject::UpdateResult CompSpriteOnMessage(const dmGameObject::ComponentOnMessageParams& params);
 
+    dmGameObject::UpdateResult CompSpriteOnMessageBatch(const dmGameObject::ComponentsOnMessageBatchParams& params);
+
     void*                      CompSpriteGetComponent(const dmGameObject::ComponentGetParams& params);
 
     void CompSpriteOnReload(const dmGameObject::ComponentOnReloadParams& params);
@@ -67,6 +67,15 @@ namespace dmGameSystem
         uint8_t :7;
     };
 
+    // Cached world space vertices of one layer in a region
+    struct TileGridRegionBuffer
+    {
+        dmGraphics::HVertexBuffer m_VertexBuffer;
+        uint32_t                  m_VertexCount;
+        uint8_t                   m_Dirty : 1;
+        uint8_t                   : 7;
+    };
+
     struct TileGridComponent
     {
         struct Flags
@@ -83,6 +92,7 @@ namespace dmGameSystem
         , m_Material(0)
         , m_TextureSet(0)
         , m_Resource(0)
+        , m_CachedTextureSet(0)
         {
         }
 
@@ -94,6 +104,9 @@ namespace dmGameSystem
         Flags*                      m_CellFlags;
         dmArray<TileGridRegion>     m_Regions;
         dmArray<TileGridLayer>      m_Layers;
+        dmArray<TileGridRegionBuffer> m_RegionBuffers; // Per layer and region, see GetRegionBuffer
+        dmVMath::Matrix4            m_CachedWorld;      // m_World of the previous update
+        void*                       m_CachedTextureSet; // Texture set data the region buffers were created with
         uint32_t                    m_MixedHash;
         HComponentRenderConstants   m_RenderConstants;
         MaterialResource*           m_Material;
@@ -104,7 +117,8 @@ namespace dmGameSystem
         uint16_t                    m_Occupied; // Number of occupied regions (regions with visible tiles)
         uint8_t                     m_Enabled : 1;
         uint8_t                     m_AddedToUpdate : 1;
-        uint8_t                     : 6;
+        uint8_t                     m_Moved : 1; // If m_World changed in the last update
+        uint8_t                     : 5;
     };
 
     struct TileGridVertex
@@ -127,6 +141,7 @@ namespace dmGameSystem
         TileGridVertex*                 m_VertexBufferData;
         TileGridVertex*                 m_VertexBufferDataEnd;
         TileGridVertex*                 m_VertexBufferWritePtr;
+        TileGridVertex*                 m_RegionVertexData; // Scratch space when updating a region buffer
 
         uint32_t                        m_MaxTilemapCount;
         uint32_t                        m_MaxTileCount;
@@ -151,6 +166,7 @@ namespace dmGameSystem
         uint32_t vcount = 6 * world->m_MaxTileCount;
         world->m_VertexBufferData = (TileGridVertex*) malloc(sizeof(TileGridVertex) * vcount);
         world->m_VertexBufferDataEnd = world->m_VertexBufferData + vcount;
+        world->m_RegionVertexData = (TileGridVertex*) malloc(sizeof(TileGridVertex) * 6 * TILEGRID_REGION_SIZE * TILEGRID_REGION_SIZE);
     }
 
     dmGameObject::CreateResult CompTileGridNewWorld(const dmGameObject::ComponentNewWorldParams& params)
@@ -178,6 +194,7 @@ namespace dmGameSystem
             dmGraphics::DeleteVertexDeclaration(world->m_VertexDeclaration);
             dmRender::DeleteBufferedRenderBuffer(world->m_RenderContext, world->m_VertexBuffer);
             free(world->m_VertexBufferData);
+            free(world->m_RegionVertexData);
         }
         delete world;
         return dmGameObject::CREATE_RESULT_OK;
@@ -237,6 +254,33 @@ namespace dmGameSystem
         layer->m_IsVisible = visible;
     }
 
+    static inline TileGridRegionBuffer* GetRegionBuffer(TileGridComponent* component, uint32_t layer, uint32_t region_index)
+    {
+        return &component->m_RegionBuffers[layer * component->m_Regions.Size() + region_index];
+    }
+
+    static void SetRegionBuffersDirty(TileGridComponent* component)
+    {
+        uint32_t count = component->m_RegionBuffers.Size();
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            component->m_RegionBuffers[i].m_Dirty = 1;
+        }
+    }
+
+    static void DeleteRegionBuffers(TileGridComponent* component)
+    {
+        uint32_t count = component->m_RegionBuffers.Size();
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            if (component->m_RegionBuffers[i].m_VertexBuffer)
+            {
+                dmGraphics::DeleteVertexBuffer(component->m_RegionBuffers[i].m_VertexBuffer);
+            }
+        }
+        component->m_RegionBuffers.SetSize(0);
+    }
+
     static void SetRegionDirty(TileGridComponent* component, int32_t cell_x, int32_t cell_y)
     {
         uint32_t region_x = cell_x / TILEGRID_REGION_SIZE;
@@ -280,7 +324,7 @@ namespace dmGameSystem
         component->m_MixedHash = dmHashFinal32(&state);
     }
 
-    static void CreateRegions(TileGridComponent* component, TileGridResource* resource)
+    static void CreateRegions(TileGridComponent* component, TileGridResource* resource, uint32_t n_layers)
     {
         // Round up to closest multiple
         component->m_RegionsX = ((resource->m_ColumnCount + TILEGRID_REGION_SIZE - 1) / TILEGRID_REGION_SIZE);
@@ -290,6 +334,13 @@ namespace dmGameSystem
         component->m_Regions.SetCapacity(region_count);
         component->m_Regions.SetSize(region_count);
         memset(&component->m_Regions[0], 0xFF, region_count * sizeof(TileGridRegion)); // mark them all dirty
+
+        DeleteRegionBuffers(component);
+        uint32_t buffer_count = region_count * n_layers;
+        component->m_RegionBuffers.SetCapacity(buffer_count);
+        component->m_RegionBuffers.SetSize(buffer_count);
+        memset(component->m_RegionBuffers.Begin(), 0, buffer_count * sizeof(TileGridRegionBuffer));
+        SetRegionBuffersDirty(component);
     }
 
     static uint32_t UpdateRegion(TileGridComponent* component, uint32_t region_x, uint32_t region_y)
@@ -301,6 +352,12 @@ namespace dmGameSystem
         }
         region->m_Dirty = 0;
 
+        uint32_t n_buffer_layers = component->m_RegionBuffers.Size() / component->m_Regions.Size();
+        for (uint32_t j = 0; j < n_buffer_layers; ++j)
+        {
+            GetRegionBuffer(component, j, index)->m_Dirty = 1;
+        }
+
         TileGridResource* resource = component->m_Resource;
         dmGameSystemDDF::TileGrid* tile_grid_ddf = resource->m_TileGrid;
 
@@ -406,7 +463,7 @@ namespace dmGameSystem
             }
         }
 
-        CreateRegions(component, resource);
+        CreateRegions(component, resource, n_layers);
         component->m_Occupied = UpdateRegions(component);
         return n_layers;
     }
@@ -431,6 +488,7 @@ namespace dmGameSystem
         component->m_Translation = Vector3(params.m_Position);
         component->m_Rotation = params.m_Rotation;
         component->m_Enabled = 1;
+        component->m_Moved = 1;
 
         uint32_t layer_count = CreateTileGrid(component);
         if (layer_count == 0)
@@ -467,6 +525,7 @@ namespace dmGameSystem
 
                 delete [] tile_grid->m_Cells;
                 delete [] tile_grid->m_CellFlags;
+                DeleteRegionBuffers(tile_grid);
 
                 if (tile_grid->m_RenderConstants)
                 {
@@ -524,6 +583,17 @@ namespace dmGameSystem
             {
                 component->m_World = dmTransform::MulNoScaleZ(go_world, local);
             }
+
+            // The cached region buffers are in world space. Tile grids that move are written to the shared
+            // vertex buffer each frame instead, until they come to rest.
+            void* texture_set = GetTextureSet(component)->m_TextureSet;
+            component->m_Moved = component->m_CachedTextureSet == 0 || memcmp(&component->m_World, &component->m_CachedWorld, sizeof(Matrix4)) != 0;
+            if (component->m_Moved || component->m_CachedTextureSet != texture_set)
+            {
+                component->m_CachedWorld = component->m_World;
+                component->m_CachedTextureSet = texture_set;
+                SetRegionBuffersDirty(component);
+            }
         }
         DM_PROPERTY_ADD_U32(rmtp_Tilemap, world->m_Components.Size());
 
@@ -548,9 +618,9 @@ namespace dmGameSystem
         region_y = (ptr >> 48) & 0xFFFF;
     }
 
-    TileGridVertex* CreateVertexData(TileGridWorld* world, TileGridVertex* where, TextureSetResource* texture_set, dmRender::RenderListEntry* buf, uint32_t* begin, uint32_t* end)
+    // Writes the vertices of one layer in a region. Returns 0x0 if there isn't room for all tiles before where_end.
+    static TileGridVertex* CreateRegionVertexData(const TileGridComponent* component, uint32_t layer, uint32_t region_x, uint32_t region_y, TextureSetResource* texture_set, TileGridVertex* where, TileGridVertex* where_end)
     {
-        DM_PROFILE("CreateVertexData");
         /*
          *   0----3
          *   | \  |
@@ -575,77 +645,116 @@ namespace dmGameSystem
         uint32_t tile_width = texture_set_ddf->m_TileWidth;
         uint32_t tile_height = texture_set_ddf->m_TileHeight;
 
-        for (uint32_t* i = begin; i != end; ++i)
-        {
-            uint32_t index, layer, region_x, region_y;
-            DecodeGridAndLayer(buf[*i].m_UserData, index, layer, region_x, region_y);
-
-            const TileGridComponent* component = world->m_Components[index];
-            const TileGridResource* resource = component->m_Resource;
-            dmGameSystemDDF::TileGrid* tile_grid_ddf = resource->m_TileGrid;
-            dmGameSystemDDF::TileLayer* layer_ddf = &tile_grid_ddf->m_Layers[layer];
+        const TileGridResource* resource = component->m_Resource;
+        dmGameSystemDDF::TileGrid* tile_grid_ddf = resource->m_TileGrid;
+        dmGameSystemDDF::TileLayer* layer_ddf = &tile_grid_ddf->m_Layers[layer];
 
-            const Matrix4& w = component->m_World;
-            const float z = layer_ddf->m_Z;
+        const Matrix4& w = component->m_World;
+        const float z = layer_ddf->m_Z;
 
-            uint32_t column_count = resource->m_ColumnCount;
-            uint32_t row_count = resource->m_RowCount;
+        uint32_t column_count = resource->m_ColumnCount;
+        uint32_t row_count = resource->m_RowCount;
 
-            int32_t min_x = resource->m_MinCellX + region_x * TILEGRID_REGION_SIZE;
-            int32_t min_y = resource->m_MinCellY + region_y * TILEGRID_REGION_SIZE;
-            int32_t max_x = dmMath::Min(min_x + (int32_t)TILEGRID_REGION_SIZE, resource->m_MinCellX + (int32_t)column_count);
-            int32_t max_y = dmMath::Min(min_y + (int32_t)TILEGRID_REGION_SIZE, resource->m_MinCellY + (int32_t)row_count);
+        int32_t min_x = resource->m_MinCellX + region_x * TILEGRID_REGION_SIZE;
+        int32_t min_y = resource->m_MinCellY + region_y * TILEGRID_REGION_SIZE;
+        int32_t max_x = dmMath::Min(min_x + (int32_t)TILEGRID_REGION_SIZE, resource->m_MinCellX + (int32_t)column_count);
+        int32_t max_y = dmMath::Min(min_y + (int32_t)TILEGRID_REGION_SIZE, resource->m_MinCellY + (int32_t)row_count);
 
-            for (int32_t y = min_y; y < max_y; ++y)
+        for (int32_t y = min_y; y < max_y; ++y)
+        {
+            for (int32_t x = min_x; x < max_x; ++x)
             {
-                for (int32_t x = min_x; x < max_x; ++x)
+                uint32_t cell = CalculateCellIndex(layer, x - resource->m_MinCellX, y - resource->m_MinCellY, column_count, row_count);
+                uint16_t tile = component->m_Cells[cell];
+                if (tile == 0xffff)
                 {
-                    uint32_t cell = CalculateCellIndex(layer, x - resource->m_MinCellX, y - resource->m_MinCellY, column_count, row_count);
-                    uint16_t tile = component->m_Cells[cell];
-                    if (tile == 0xffff)
-                    {
-                        continue;
-                    }
+                    continue;
+                }
 
-                    if( where >= world->m_VertexBufferDataEnd )
-                    {
-                        dmLogError("Out of tiles to render (%zu). You can change this with the game.project setting tilemap.max_tile_count", (size_t)((world->m_VertexBufferDataEnd - world->m_VertexBufferData) / 6));
-                        return world->m_VertexBufferDataEnd;
+                if( where >= where_end )
+                {
+                    return 0x0;
+                }
+
+                float p[4];
+                CalculateCellBounds(x, y, 1, 1, p);
+                const float* puv = &tex_coords[tile * 8];
+
+                TileGridComponent::Flags flags = component->m_CellFlags[cell];
+                const int* tex_lookup = &tex_coord_order[flags.m_TransformMask * 6];
+
+                #define SET_VERTEX(_I, _X, _Y, _Z, _U, _V) \
+                    { \
+                        const Vector4 v = w * Point3(_X * tile_width, _Y * tile_height, _Z); \
+                        where[_I].x = v.getX(); \
+                        where[_I].y = v.getY(); \
+                        where[_I].z = v.getZ(); \
+                        where[_I].u = _U; \
+                        where[_I].v = _V; \
                     }
 
-                    float p[4];
-                    CalculateCellBounds(x, y, 1, 1, p);
-                    const float* puv = &tex_coords[tile * 8];
-
-                    TileGridComponent::Flags flags = component->m_CellFlags[cell];
-                    const int* tex_lookup = &tex_coord_order[flags.m_TransformMask * 6];
-
-                    #define SET_VERTEX(_I, _X, _Y, _Z, _U, _V) \
-                        { \
-                            const Vector4 v = w * Point3(_X * tile_width, _Y * tile_height, _Z); \
-                            where[_I].x = v.getX(); \
-                            where[_I].y = v.getY(); \
-                            where[_I].z = v.getZ(); \
-                            where[_I].u = _U; \
-                            where[_I].v = _V; \
-                        }
+                SET_VERTEX(0, p[0], p[1], z, puv[tex_lookup[0] * 2], puv[tex_lookup[0] * 2 + 1]);
+                SET_VERTEX(1, p[0], p[3], z, puv[tex_lookup[1] * 2], puv[tex_lookup[1] * 2 + 1]);
+                SET_VERTEX(2, p[2], p[3], z, puv[tex_lookup[2] * 2], puv[tex_lookup[2] * 2 + 1]);
+                SET_VERTEX(3, p[2], p[3], z, puv[tex_lookup[3] * 2], puv[tex_lookup[3] * 2 + 1]);
+                SET_VERTEX(4, p[2], p[1], z, puv[tex_lookup[4] * 2], puv[tex_lookup[4] * 2 + 1]);
+                SET_VERTEX(5, p[0], p[1], z, puv[tex_lookup[5] * 2], puv[tex_lookup[5] * 2 + 1]);
 
-                    SET_VERTEX(0, p[0], p[1], z, puv[tex_lookup[0] * 2], puv[tex_lookup[0] * 2 + 1]);
-                    SET_VERTEX(1, p[0], p[3], z, puv[tex_lookup[1] * 2], puv[tex_lookup[1] * 2 + 1]);
-                    SET_VERTEX(2, p[2], p[3], z, puv[tex_lookup[2] * 2], puv[tex_lookup[2] * 2 + 1]);
-                    SET_VERTEX(3, p[2], p[3], z, puv[tex_lookup[3] * 2], puv[tex_lookup[3] * 2 + 1]);
-                    SET_VERTEX(4, p[2], p[1], z, puv[tex_lookup[4] * 2], puv[tex_lookup[4] * 2 + 1]);
-                    SET_VERTEX(5, p[0], p[1], z, puv[tex_lookup[5] * 2], puv[tex_lookup[5] * 2 + 1]);
+                where += 6;
 
-                    where += 6;
+                #undef SET_VERTEX
+            }
+        }
+        return where;
+    }
 
-                    #undef SET_VERTEX
-                }
+    TileGridVertex* CreateVertexData(TileGridWorld* world, TileGridVertex* where, TextureSetResource* texture_set, dmRender::RenderListEntry* buf, uint32_t* begin, uint32_t* end)
+    {
+        DM_PROFILE("CreateVertexData");
+
+        for (uint32_t* i = begin; i != end; ++i)
+        {
+            uint32_t index, layer, region_x, region_y;
+            DecodeGridAndLayer(buf[*i].m_UserData, index, layer, region_x, region_y);
+
+            const TileGridComponent* component = world->m_Components[index];
+            where = CreateRegionVertexData(component, layer, region_x, region_y, texture_set, where, world->m_VertexBufferDataEnd);
+            if (where == 0x0)
+            {
+                dmLogError("Out of tiles to render (%zu). You can change this with the game.project setting tilemap.max_tile_count", (size_t)((world->m_VertexBufferDataEnd - world->m_VertexBufferData) / 6));
+                return world->m_VertexBufferDataEnd;
             }
         }
         return where;
     }
 
+    // Rewrites the cached vertex buffer of one layer in a region
+    static void UpdateRegionBuffer(TileGridWorld* world, dmRender::HRenderContext render_context, TileGridComponent* component, TextureSetResource* texture_set, uint32_t layer, uint32_t region_x, uint32_t region_y, TileGridRegionBuffer* region_buffer)
+    {
+        DM_PROFILE("UpdateRegionBuffer");
+
+        TileGridVertex* begin = world->m_RegionVertexData;
+        TileGridVertex* end = CreateRegionVertexData(component, layer, region_x, region_y, texture_set, begin, begin + 6 * TILEGRID_REGION_SIZE * TILEGRID_REGION_SIZE);
+        assert(end != 0x0); // The scratch space fits a full region
+
+        region_buffer->m_VertexCount = end - begin;
+        region_buffer->m_Dirty = 0;
+        uint32_t size = region_buffer->m_VertexCount * sizeof(TileGridVertex);
+        if (size == 0)
+        {
+            return;
+        }
+
+        if (region_buffer->m_VertexBuffer == 0)
+        {
+            region_buffer->m_VertexBuffer = dmGraphics::NewVertexBuffer(dmRender::GetGraphicsContext(render_context), size, begin, dmGraphics::BUFFER_USAGE_STATIC_DRAW);
+        }
+        else
+        {
+            dmGraphics::SetVertexBufferData(region_buffer->m_VertexBuffer, size, begin, dmGraphics::BUFFER_USAGE_STATIC_DRAW);
+        }
+    }
+
     static void RenderListFrustumCulling(dmRender::RenderListVisibilityParams const &params)
     {
         DM_PROFILE("TileGridFrustrumCulling");
@@ -684,36 +793,19 @@ namespace dmGameSystem
         }
     }
 
-    static void RenderBatch(TileGridWorld* world, dmRender::HRenderContext render_context, dmRender::RenderListEntry *buf, uint32_t* begin, uint32_t* end)
+    static void AddRenderObject(TileGridWorld* world, dmRender::HRenderContext render_context, TileGridComponent* first, TextureSetResource* texture_set, dmGraphics::HVertexBuffer vertex_buffer, uint32_t vertex_start, uint32_t vertex_count)
     {
-        DM_PROFILE("TileGridRenderBatch");
-
-        uint32_t index, layer, region_x, region_y;
-        DecodeGridAndLayer(buf[*begin].m_UserData, index, layer, region_x, region_y);
-        TileGridComponent* first = world->m_Components[index];
-        assert(first->m_Enabled);
-
         TileGridResource* resource = first->m_Resource;
-        TextureSetResource* texture_set = GetTextureSet(first);
 
         dmRender::RenderObject& ro = *world->m_RenderObjects.End();
         world->m_RenderObjects.SetSize(world->m_RenderObjects.Size()+1);
 
-        // Fill in vertex buffer
-        TileGridVertex* vb_begin = world->m_VertexBufferWritePtr;
-        world->m_VertexBufferWritePtr = CreateVertexData(world, vb_begin, texture_set, buf, begin, end);
-
-        if (dmRender::GetBufferIndex(render_context, world->m_VertexBuffer) < world->m_DispatchCount)
-        {
-            dmRender::AddRenderBuffer(render_context, world->m_VertexBuffer);
-        }
-
         ro.Init();
         ro.m_VertexDeclaration = world->m_VertexDeclaration;
-        ro.m_VertexBuffer      = (dmGraphics::HVertexBuffer) dmRender::GetBuffer(render_context, world->m_VertexBuffer);
+        ro.m_VertexBuffer      = vertex_buffer;
         ro.m_PrimitiveType = dmGraphics::PRIMITIVE_TRIANGLES;
-        ro.m_VertexStart = vb_begin - world->m_VertexBufferData;
-        ro.m_VertexCount = (world->m_VertexBufferWritePtr - vb_begin);
+        ro.m_VertexStart = vertex_start;
+        ro.m_VertexCount = vertex_count;
         ro.m_Material = GetMaterial(first);
         ro.m_Textures[0] = texture_set->m_Texture->m_Texture;
 
@@ -756,6 +848,58 @@ namespace dmGameSystem
         dmRender::AddToRender(render_context, &ro);
     }
 
+    static void RenderBatch(TileGridWorld* world, dmRender::HRenderContext render_context, dmRender::RenderListEntry *buf, uint32_t* begin, uint32_t* end)
+    {
+        DM_PROFILE("TileGridRenderBatch");
+
+        uint32_t index, layer, region_x, region_y;
+        DecodeGridAndLayer(buf[*begin].m_UserData, index, layer, region_x, region_y);
+        TileGridComponent* first = world->m_Components[index];
+        assert(first->m_Enabled);
+
+        TextureSetResource* texture_set = GetTextureSet(first);
+
+        // Regions of tile grids at rest are drawn from their cached buffers, which are only
+        // rewritten when the region changes. The regions of moving tile grids are written
+        // to the shared vertex buffer and drawn together.
+        TileGridVertex* vb_begin = world->m_VertexBufferWritePtr;
+        bool use_shared_buffer = false;
+        for (uint32_t* i = begin; i != end; ++i)
+        {
+            DecodeGridAndLayer(buf[*i].m_UserData, index, layer, region_x, region_y);
+            TileGridComponent* component = world->m_Components[index];
+            if (component->m_Moved)
+            {
+                world->m_VertexBufferWritePtr = CreateVertexData(world, world->m_VertexBufferWritePtr, texture_set, buf, i, i + 1);
+                use_shared_buffer = true;
+                continue;
+            }
+
+            TileGridRegionBuffer* region_buffer = GetRegionBuffer(component, layer, region_y * component->m_RegionsX + region_x);
+            if (region_buffer->m_Dirty)
+            {
+                UpdateRegionBuffer(world, render_context, component, texture_set, layer, region_x, region_y, region_buffer);
+            }
+            if (region_buffer->m_VertexCount > 0)
+            {
+                AddRenderObject(world, render_context, first, texture_set, region_buffer->m_VertexBuffer, 0, region_buffer->m_VertexCount);
+            }
+        }
+
+        if (!use_shared_buffer)
+        {
+            return;
+        }
+
+        if (dmRender::GetBufferIndex(render_context, world->m_VertexBuffer) < world->m_DispatchCount)
+        {
+            dmRender::AddRenderBuffer(render_context, world->m_VertexBuffer);
+        }
+
+        AddRenderObject(world, render_context, first, texture_set, (dmGraphics::HVertexBuffer) dmRender::GetBuffer(render_context, world->m_VertexBuffer),
+                        vb_begin - world->m_VertexBufferData, world->m_VertexBufferWritePtr - vb_begin);
+    }
+
     static void RenderListDispatch(dmRender::RenderListDispatchParams const &params)
     {
         TileGridWorld* world = (TileGridWorld*) params.m_UserData;
@@ -17,6 +17,7 @@
 #include "gamesys_private.h"
 
 #include <dmsdk/dlib/log.h>
+#include <dlib/array.h>
 #include <dlib/static_assert.h>
 #include <dlib/profile.h>
 #include <gameobject/gameobject.h>
@@ -114,6 +115,8 @@ namespace dmGameSystem
         REGISTER_RESOURCE_TYPE("glyph_bankc", 0, ResGlyphBankPreload, ResGlyphBankCreate, 0, ResGlyphBankDestroy, ResGlyphBankRecreate);
         REGISTER_RESOURCE_TYPE("wavc", 0, 0, ResSoundDataCreate, 0, ResSoundDataDestroy, ResSoundDataRecreate);
         REGISTER_RESOURCE_TYPE("oggc", 0, 0, ResSoundDataCreate, 0, ResSoundDataDestroy, ResSoundDataRecreate);
+        REGISTER_RESOURCE_TYPE("aacc", 0, 0, ResSoundDataCreate, 0, ResSoundDataDestroy, ResSoundDataRecreate);
+        REGISTER_RESOURCE_TYPE("opusc", 0, 0, ResSoundDataCreate, 0, ResSoundDataDestroy, ResSoundDataRecreate);
         REGISTER_RESOURCE_TYPE("soundc", 0, ResSoundPreload, ResSoundCreate, 0, ResSoundDestroy, ResSoundRecreate);
         REGISTER_RESOURCE_TYPE("camerac", 0, 0, ResCameraCreate, 0, ResCameraDestroy, ResCameraRecreate);
         REGISTER_RESOURCE_TYPE("input_bindingc", input_context, 0, ResInputBindingCreate, 0, ResInputBindingDestroy, ResInputBindingRecreate);
@@ -135,6 +138,51 @@ namespace dmGameSystem
 
 #undef REGISTER_RESOURCE_TYPE
 
+        // These types only read their file data (without keeping it), so they can use it straight from a memory mapped archive
+        const char* zero_copy_types[] = { "texturec", "bufferc" };
+        for (uint32_t i = 0; i < DM_ARRAY_SIZE(zero_copy_types); ++i)
+        {
+            HResourceType type;
+            if (dmResource::GetTypeFromExtension(factory, zero_copy_types[i], &type) == dmResource::RESULT_OK)
+            {
+                ResourceTypeSetZeroCopy(type, true);
+            }
+        }
+
+        // These types create their resource from the buffer and preload data only, so they can be created on a loader thread
+        const char* thread_safe_create_types[] = { "glyph_bankc", "skeletonc", "gamepadsc" };
+        for (uint32_t i = 0; i < DM_ARRAY_SIZE(thread_safe_create_types); ++i)
+        {
+            HResourceType type;
+            if (dmResource::GetTypeFromExtension(factory, thread_safe_create_types[i], &type) == dmResource::RESULT_OK)
+            {
+                ResourceTypeSetThreadSafeCreate(type, true);
+            }
+        }
+
+        // These types are expensive to load, and commonly shared between levels and menus, so they are worth keeping
+        // alive (within the residency budget) after they are released
+        const char* keep_resident_types[] = { "texturec", "texturesetc", "fontc", "glyph_bankc", "wavc", "oggc", "aacc", "opusc" };
+        for (uint32_t i = 0; i < DM_ARRAY_SIZE(keep_resident_types); ++i)
+        {
+            HResourceType type;
+            if (dmResource::GetTypeFromExtension(factory, keep_resident_types[i], &type) == dmResource::RESULT_OK)
+            {
+                ResourceTypeSetKeepResident(type, true);
+            }
+        }
+
+        // Long compressed sounds (e.g. music) are streamed while they play, so only their first part is loaded
+        const char* streamed_types[] = { "oggc", "aacc", "opusc" };
+        for (uint32_t i = 0; i < DM_ARRAY_SIZE(streamed_types); ++i)
+        {
+            HResourceType type;
+            if (dmResource::GetTypeFromExtension(factory, streamed_types[i], &type) == dmResource::RESULT_OK)
+            {
+                ResourceTypeSetStreamed(type, 512 * 1024, 64 * 1024);
+            }
+        }
+
         return e;
     }
 
@@ -291,6 +339,8 @@ namespace dmGameSystem
                 CompSpriteOnReload, CompSpriteGetProperty, CompSpriteSetProperty,
                 0, CompSpriteIterProperties,
                 1);
+        // Bursts of e.g. play_animation messages are handled in batches
+        dmGameObject::FindComponentType(regist, type, 0)->m_OnMessageBatchFunction = CompSpriteOnMessageBatch;
 
         REGISTER_COMPONENT_TYPE(TILE_MAP_EXT, 1200, tilemap_context,
                 CompTileGridNewWorld, CompTileGridDeleteWorld,
@@ -48,6 +48,7 @@ namespace dmGameSystem
     extern const char* PHYSICS_MAX_FIXED_TIMESTEPS;
     /// Config key to use for tweaking maximum number of collection proxies
     extern const char* COLLECTION_PROXY_MAX_COUNT_KEY;
+    extern const char* COLLECTION_PROXY_LOAD_BUDGET_KEY;
     /// Config key to use for tweaking maximum number of factories
     extern const char* FACTORY_MAX_COUNT_KEY;
     /// Config key to use for tweaking maximum number of collection factories
@@ -99,6 +100,7 @@ namespace dmGameSystem
         }
         dmResource::HFactory m_Factory;
         dmRender::HRenderContext m_RenderContext;
+        dmJobThread::HContext m_JobThread;
         uint32_t m_MaxParticleFXCount;
         uint32_t m_MaxParticleCount;
         uint32_t m_MaxEmitterCount;
@@ -132,7 +134,12 @@ namespace dmGameSystem
         }
         dmRender::HRenderContext    m_RenderContext;
         dmResource::HFactory        m_Factory;
+        dmJobThread::HContext       m_JobThread;
         uint32_t                    m_MaxModelCount;
+        // Off screen models only advance their animation cursors
+        bool                        m_CullOffscreenAnimation;
+        // The models without a skeleton are used as occluders, to skip drawing the models behind them
+        bool                        m_OcclusionCulling;
     };
 
     struct SoundContext
@@ -168,6 +175,8 @@ namespace dmGameSystem
         }
         dmResource::HFactory m_Factory;
         uint32_t m_MaxCollectionProxyCount;
+        // Time (ms) per frame spent on an async load, including the creation of the collection instances
+        uint32_t m_LoadBudget;
     };
 
     struct FactoryContext
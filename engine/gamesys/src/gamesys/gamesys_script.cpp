@@ -34,8 +34,11 @@
 #include "scripts/script_collectionproxy.h"
 #include "scripts/script_buffer.h"
 #include "scripts/script_sys_gamesys.h"
+#include "scripts/script_go_gamesys.h"
 #include "scripts/script_camera.h"
 #include "scripts/script_http.h"
+#include "scripts/script_image.h"
+#include "scripts/script_udp.h"
 
 #include "components/comp_gui.h"
 
@@ -144,7 +147,10 @@ namespace dmGameSystem
         ScriptWindowRegister(context);
         ScriptCollectionProxyRegister(context);
         ScriptSysGameSysRegister(context);
+        ScriptGoGameSysRegister(context);
         ScriptHttpRegister(context);
+        ScriptImageRegister(context);
+        ScriptUdpRegister(context);
 
         assert(top == lua_gettop(L));
         return result;
@@ -159,11 +165,15 @@ namespace dmGameSystem
         ScriptWindowFinalize(context);
         ScriptSysGameSysFinalize(context);
         ScriptHttpFinalize(context);
+        ScriptImageFinalize(context);
+        ScriptUdpFinalize(context);
     }
 
     void UpdateScriptLibs(const ScriptLibContext& context)
     {
         ScriptSysGameSysUpdate(context);
+        ScriptImageUpdate(context);
+        ScriptUdpUpdate(context);
     }
 
     dmGameObject::HInstance CheckGoInstance(lua_State* L) {
@@ -17,6 +17,7 @@
 
 #include <dmsdk/dlib/log.h>
 #include <resource/resource.h>
+#include <gameobject/gameobject.h>
 #include <gameobject/gameobject_ddf.h>
 #include <gamesys/gamesys_ddf.h>
 
@@ -25,6 +26,7 @@ namespace dmGameSystem
     CollectionFactoryResource& CollectionFactoryResource::operator=(CollectionFactoryResource& other)
     {
         m_CollectionDesc = other.m_CollectionDesc;
+        m_SpawnTemplate = other.m_SpawnTemplate;
         m_CollectionResources.Swap(other.m_CollectionResources);
         m_LoadDynamically = other.m_LoadDynamically;
         return *this;
@@ -51,8 +53,19 @@ namespace dmGameSystem
         return dmResource::RESULT_OK;
     }
 
+    // Flattens the collection description once, for the spawns
+    static void CreateSpawnTemplate(CollectionFactoryResource* factory_res)
+    {
+        factory_res->m_SpawnTemplate = dmGameObject::NewCollectionSpawnTemplate(factory_res->m_CollectionDesc);
+    }
+
     static void ReleaseCollectionDesc(dmResource::HFactory factory, CollectionFactoryResource* factory_res)
     {
+        if (factory_res->m_SpawnTemplate != 0x0)
+        {
+            dmGameObject::DeleteCollectionSpawnTemplate(factory_res->m_SpawnTemplate);
+            factory_res->m_SpawnTemplate = 0;
+        }
         if (factory_res->m_CollectionDesc != 0x0)
         {
             dmDDF::FreeMessage(factory_res->m_CollectionDesc);
@@ -115,6 +128,10 @@ namespace dmGameSystem
         factory_res->m_PrototypePathHash = dmHashString64(ddf->m_Prototype);
         dmResource::Result r = AcquireCollectionDesc(factory, ddf->m_Prototype, (dmGameObjectDDF::CollectionDesc**)&factory_res->m_CollectionDesc);
         dmDDF::FreeMessage(ddf);
+        if (r == dmResource::RESULT_OK)
+        {
+            CreateSpawnTemplate(factory_res);
+        }
         *out_res = factory_res;
         return r;
     }
@@ -129,6 +146,10 @@ namespace dmGameSystem
         factory_res->m_DynamicPrototype = dynamic_prototype;
         factory_res->m_PrototypePathHash = dmHashString64(collectionc);
         dmResource::Result r = AcquireCollectionDesc(factory, collectionc, (dmGameObjectDDF::CollectionDesc**)&factory_res->m_CollectionDesc);
+        if (r == dmResource::RESULT_OK)
+        {
+            CreateSpawnTemplate(factory_res);
+        }
         *out_res = factory_res;
         return r;
     }
@@ -216,6 +216,17 @@ namespace dmGameSystem
         params.m_GetGlyphData = (dmRender::FGetGlyphData)GetGlyphData;
 
         dmGraphics::HContext graphics_context = dmRender::GetGraphicsContext(context);
+
+        // The distance field fonts of the same glyph bank share the glyph cache, so that their texts batch together
+        if (glyph_bank->m_ImageFormat != dmRenderDDF::TYPE_BITMAP)
+        {
+            if (glyph_bank_res->m_CacheFontMap == 0)
+            {
+                glyph_bank_res->m_CacheFontMap = dmRender::NewFontMap(graphics_context, params);
+            }
+            params.m_CacheFontMap = glyph_bank_res->m_CacheFontMap;
+        }
+
         if (font_map->m_FontMap == 0)
         {
             font_map->m_FontMap = dmRender::NewFontMap(graphics_context, params);
@@ -368,6 +379,9 @@ namespace dmGameSystem
         glyph->m_DataImageWidth = inglyph->m_Width;
         glyph->m_DataImageHeight = inglyph->m_Height;
         font->m_DynamicGlyphs.Put(codepoint, glyph);
+        dmRender::ClearFontMapLayoutCache(font->m_FontMap);
+        // The glyphs of the font no longer match the other fonts of the glyph bank
+        dmRender::UnshareFontMapCache(font->m_FontMap);
 
         dmResource::SetResourceSize(font->m_Resource, GetResourceSize(font));
         return dmResource::RESULT_OK;
@@ -380,6 +394,7 @@ namespace dmGameSystem
             return dmResource::RESULT_RESOURCE_NOT_FOUND;
 
         font->m_DynamicGlyphs.Erase(codepoint);
+        dmRender::ClearFontMapLayoutCache(font->m_FontMap);
 
         DynamicGlyph* glyph = *glyphp;
         free((void*)glyph->m_Data);
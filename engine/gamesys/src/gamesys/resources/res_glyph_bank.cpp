@@ -33,6 +33,7 @@ namespace dmGameSystem
     {
         GlyphBankResource* resource   = new GlyphBankResource();
         resource->m_DDF               = (dmRenderDDF::GlyphBank*) params->m_PreloadData;
+        resource->m_CacheFontMap      = 0;
         dmResource::SetResource(params->m_Resource, resource);
         return dmResource::RESULT_OK;
     }
@@ -40,6 +41,11 @@ namespace dmGameSystem
     dmResource::Result ResGlyphBankDestroy(const dmResource::ResourceDestroyParams* params)
     {
         GlyphBankResource* resource = (GlyphBankResource*) dmResource::GetResource(params->m_Resource);
+        // The cache is kept until the fonts sharing it are deleted
+        if (resource->m_CacheFontMap)
+        {
+            dmRender::DeleteFontMap(resource->m_CacheFontMap);
+        }
         if (resource->m_DDF != 0x0)
         {
             dmDDF::FreeMessage(resource->m_DDF);
@@ -65,6 +71,13 @@ namespace dmGameSystem
         }
 
         glyph_bank->m_DDF = ddf;
+
+        // The fonts get a new cache, as they are reloaded
+        if (glyph_bank->m_CacheFontMap)
+        {
+            dmRender::DeleteFontMap(glyph_bank->m_CacheFontMap);
+            glyph_bank->m_CacheFontMap = 0;
+        }
         return dmResource::RESULT_OK;
     }
 }
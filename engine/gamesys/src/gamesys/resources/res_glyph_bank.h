@@ -17,12 +17,15 @@
 
 #include <dmsdk/resource/resource.h>
 #include <render/font_ddf.h>
+#include <render/font_renderer.h>
 
 namespace dmGameSystem
 {
     struct GlyphBankResource
     {
         dmRenderDDF::GlyphBank* m_DDF;
+        // The glyph cache shared by the distance field fonts using this glyph bank. Created by the first font
+        dmRender::HFontMap      m_CacheFontMap;
     };
 
     dmResource::Result ResGlyphBankPreload(const dmResource::ResourcePreloadParams* params);
@@ -12,7 +12,10 @@
 // CONDITIONS OF ANY KIND, either express or implied. See the License for the
 // specific language governing permissions and limitations under the License.
 
+#include <stdlib.h>
 #include <string.h>
+#include <dlib/log.h>
+#include <resource/resource.h>
 #include <sound/sound.h>
 #include "res_sound_data.h"
 
@@ -28,7 +31,11 @@ namespace dmGameSystem
         // positions according to format specs (ogg, wav)
         if (buffer[0] == 'O' && buffer[1] == 'g' && buffer[2] == 'g')
         {
-            type = dmSound::SOUND_DATA_TYPE_OGG_VORBIS;
+            // Opus is also in an ogg container, with the codec identified by the first packet
+            if (bufferSize >= 36 && memcmp(buffer + 28, "OpusHead", 8) == 0)
+                type = dmSound::SOUND_DATA_TYPE_OPUS;
+            else
+                type = dmSound::SOUND_DATA_TYPE_OGG_VORBIS;
         }
         if (bufferSize < 11)
         {
@@ -41,6 +48,58 @@ namespace dmGameSystem
         return type;
     }
 
+    // The file of a streamed sound, read from the sound stream job thread
+    struct SoundDataStream
+    {
+        dmResource::HFactory m_Factory;
+        char*                m_Path;
+    };
+
+    static bool ReadSoundDataStream(void* context, uint32_t offset, void* buffer, uint32_t size, uint32_t* nread)
+    {
+        SoundDataStream* stream = (SoundDataStream*) context;
+        return dmResource::ReadResourcePartial(stream->m_Factory, stream->m_Path, offset, buffer, size, nread) == dmResource::RESULT_OK;
+    }
+
+    static void ReleaseSoundDataStream(void* context)
+    {
+        SoundDataStream* stream = (SoundDataStream*) context;
+        free(stream->m_Path);
+        delete stream;
+    }
+
+    // The buffer only holds the start of the file (see ResourceTypeSetStreamed). Either stream the rest while playing,
+    // or read it all if the sound can't be streamed
+    static dmSound::Result NewSoundDataFromHeader(const dmResource::ResourceCreateParams* params, uint32_t file_size, dmSound::SoundDataType type, dmSound::HSoundData* sound_data)
+    {
+        dmhash_t name_hash = dmResource::GetNameHash(params->m_Resource);
+
+        SoundDataStream* stream = new SoundDataStream;
+        stream->m_Factory = params->m_Factory;
+        stream->m_Path = strdup(params->m_Filename);
+        dmSound::Result r = dmSound::NewSoundDataStreaming(params->m_Buffer, params->m_BufferSize, file_size, ReadSoundDataStream, ReleaseSoundDataStream, stream, type, sound_data, name_hash);
+        if (r != dmSound::RESULT_UNSUPPORTED)
+        {
+            if (r != dmSound::RESULT_OK)
+                ReleaseSoundDataStream(stream);
+            return r;
+        }
+        ReleaseSoundDataStream(stream);
+
+        void* buffer = malloc(file_size);
+        uint32_t nread = 0;
+        dmResource::Result rr = dmResource::ReadResourcePartial(params->m_Factory, params->m_Filename, 0, buffer, file_size, &nread);
+        if (rr != dmResource::RESULT_OK || nread != file_size)
+        {
+            dmLogError("Failed to read sound '%s' (%d)", params->m_Filename, rr);
+            free(buffer);
+            return dmSound::RESULT_INVALID_STREAM_DATA;
+        }
+        r = dmSound::NewSoundData(buffer, file_size, type, sound_data, name_hash);
+        free(buffer);
+        return r;
+    }
+
     dmResource::Result ResSoundDataCreate(const dmResource::ResourceCreateParams* params)
     {
         dmSound::HSoundData sound_data;
@@ -52,8 +111,21 @@ namespace dmGameSystem
         {
             type = dmSound::SOUND_DATA_TYPE_OGG_VORBIS;
         }
+        else if (filename_len > 5 && strcmp(params->m_Filename + filename_len - 5, ".aacc") == 0)
+        {
+            type = dmSound::SOUND_DATA_TYPE_AAC;
+        }
+        else if (filename_len > 6 && strcmp(params->m_Filename + filename_len - 6, ".opusc") == 0)
+        {
+            type = dmSound::SOUND_DATA_TYPE_OPUS;
+        }
 
-        dmSound::Result r = dmSound::NewSoundData(params->m_Buffer, params->m_BufferSize, type, &sound_data, dmResource::GetNameHash(params->m_Resource));
+        uint32_t file_size = 0;
+        dmSound::Result r;
+        if (dmResource::GetResourceFileSize(params->m_Factory, params->m_Filename, &file_size) == dmResource::RESULT_OK && params->m_BufferSize < file_size)
+            r = NewSoundDataFromHeader(params, file_size, type, &sound_data);
+        else
+            r = dmSound::NewSoundData(params->m_Buffer, params->m_BufferSize, type, &sound_data, dmResource::GetNameHash(params->m_Resource));
         if (r != dmSound::RESULT_OK)
         {
             return dmResource::RESULT_OUT_OF_RESOURCES;
@@ -37,6 +37,12 @@ namespace dmGameSystem
         dmGraphics::TextureImage* m_DDFImage;
         uint8_t*                  m_DecompressedData[MAX_MIPMAP_COUNT];
         uint32_t                  m_DecompressedDataSize[MAX_MIPMAP_COUNT];
+        // The alternative that was transcoded in the preload step, or -1
+        int32_t                   m_TranscodedAlternative;
+        uint32_t                  m_TranscodedMipCount;
+        dmGraphics::TextureFormat m_TranscodedFormat;
+        // The alternatives that failed to transcode in the preload step
+        uint32_t                  m_TranscodeFailedMask;
     };
 
 #define CASE_TT(_X, _T) case dmGraphics::TextureImage::_X: return dmGraphics::TEXTURE_ ## _T
@@ -120,12 +126,81 @@ namespace dmGameSystem
         dmGraphics::SetTextureAsync(texture, params, 0, (void*) 0);
     }
 
+    // A compressed format that the device supports is uploaded as is, which is much cheaper
+    // than transcoding. If there is such an alternative, we use it instead of any transcoded ones.
+    static bool HasDirectUploadAlternative(dmGraphics::HContext context, dmGraphics::TextureImage* ddf_image)
+    {
+        for (uint32_t i = 0; i < ddf_image->m_Alternatives.m_Count; ++i)
+        {
+            dmGraphics::TextureImage::Image* image = &ddf_image->m_Alternatives[i];
+            dmGraphics::TextureFormat format       = TextureImageToTextureFormat(image->m_Format);
+            if (!dmGraphics::IsFormatTranscoded(image->m_CompressionType) &&
+                dmGraphics::IsTextureFormatCompressed(format) &&
+                dmGraphics::IsTextureFormatSupported(context, format))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    static bool TranscodeAlternative(const char* path, dmGraphics::HContext context, ImageDesc* image_desc, uint32_t alternative, dmGraphics::TextureFormat* output_format, uint32_t* num_mips)
+    {
+        dmGraphics::TextureImage::Image* image = &image_desc->m_DDFImage->m_Alternatives[alternative];
+        *num_mips      = MAX_MIPMAP_COUNT;
+        *output_format = dmGraphics::GetSupportedCompressionFormat(context, TextureImageToTextureFormat(image->m_Format), image->m_Width, image->m_Height);
+        if (!dmGraphics::Transcode(path, image, image_desc->m_DDFImage->m_Count, *output_format, image_desc->m_DecompressedData, image_desc->m_DecompressedDataSize, num_mips))
+        {
+            dmLogError("Failed to transcode %s", path);
+            // Don't leave any levels behind, or they would be uploaded instead of the next alternative
+            for (uint32_t i = 0; i < MAX_MIPMAP_COUNT; ++i)
+            {
+                delete[] image_desc->m_DecompressedData[i];
+                image_desc->m_DecompressedData[i] = 0;
+            }
+            return false;
+        }
+        return true;
+    }
+
+    // Transcodes the alternative that AcquireResources will pick, so that it's done on the loader thread
+    static void PreloadTranscode(const char* path, dmGraphics::HContext context, ImageDesc* image_desc)
+    {
+        DM_PROFILE(__FUNCTION__);
+        dmGraphics::TextureImage* ddf_image = image_desc->m_DDFImage;
+        if (HasDirectUploadAlternative(context, ddf_image))
+        {
+            return;
+        }
+
+        for (uint32_t i = 0; i < ddf_image->m_Alternatives.m_Count; ++i)
+        {
+            dmGraphics::TextureImage::Image* image = &ddf_image->m_Alternatives[i];
+            if (!dmGraphics::IsFormatTranscoded(image->m_CompressionType))
+            {
+                if (dmGraphics::IsTextureFormatSupported(context, TextureImageToTextureFormat(image->m_Format)))
+                {
+                    return;
+                }
+                continue;
+            }
+
+            if (TranscodeAlternative(path, context, image_desc, i, &image_desc->m_TranscodedFormat, &image_desc->m_TranscodedMipCount))
+            {
+                image_desc->m_TranscodedAlternative = (int32_t) i;
+                return;
+            }
+            image_desc->m_TranscodeFailedMask |= 1 << (i & 31);
+        }
+    }
+
     static dmResource::Result AcquireResources(const char* path, dmGraphics::HContext context, ImageDesc* image_desc,
         ResTextureUploadParams upload_params, dmGraphics::HTexture texture, dmGraphics::HTexture* texture_out)
     {
         DM_PROFILE_DYN(path, 0);
 
         dmResource::Result result = dmResource::RESULT_FORMAT_ERROR;
+        bool has_direct_upload = HasDirectUploadAlternative(context, image_desc->m_DDFImage);
         for (uint32_t i = 0; i < image_desc->m_DDFImage->m_Alternatives.m_Count; ++i)
         {
             dmGraphics::TextureImage::Image* image    = &image_desc->m_DDFImage->m_Alternatives[i];
@@ -136,12 +211,18 @@ namespace dmGameSystem
 
             if (dmGraphics::IsFormatTranscoded(image->m_CompressionType))
             {
-                num_mips = MAX_MIPMAP_COUNT;
-                output_format = dmGraphics::GetSupportedCompressionFormat(context, output_format, image->m_Width, image->m_Height);
-                bool result = dmGraphics::Transcode(path, image, image_desc->m_DDFImage->m_Count, output_format, image_desc->m_DecompressedData, image_desc->m_DecompressedDataSize, &num_mips);
-                if (!result)
+                if (has_direct_upload || (image_desc->m_TranscodeFailedMask & (1 << (i & 31))))
+                {
+                    continue;
+                }
+
+                if (image_desc->m_TranscodedAlternative == (int32_t) i)
+                {
+                    output_format = image_desc->m_TranscodedFormat;
+                    num_mips      = image_desc->m_TranscodedMipCount;
+                }
+                else if (!TranscodeAlternative(path, context, image_desc, i, &output_format, &num_mips))
                 {
-                    dmLogError("Failed to transcode %s", path);
                     continue;
                 }
             }
@@ -152,12 +233,21 @@ namespace dmGameSystem
 
             result = dmResource::RESULT_OK;
 
+            // When creating a new mipmapped texture, we can drop the largest mipmap levels
+            // to lower the texture memory usage (graphics.texture_mipmap_skip).
+            // Updates to existing textures always use the full image.
+            uint32_t mip_skip = 0;
+            if (!texture && !specific_mip_requested && num_mips > 1)
+            {
+                mip_skip = dmMath::Min((uint32_t) dmGraphics::GetTextureMipmapSkip(context), num_mips - 1);
+            }
+
             dmGraphics::TextureParams params;
             dmGraphics::GetDefaultTextureFilters(context, params.m_MinFilter, params.m_MagFilter);
 
             params.m_Format    = output_format;
-            params.m_Width     = image->m_Width;
-            params.m_Height    = image->m_Height;
+            params.m_Width     = dmMath::Max((uint16_t) 1, dmGraphics::GetMipmapSize(image->m_Width, mip_skip));
+            params.m_Height    = dmMath::Max((uint16_t) 1, dmGraphics::GetMipmapSize(image->m_Height, mip_skip));
             params.m_Depth     = image_desc->m_DDFImage->m_Count;
             params.m_X         = upload_params.m_X;
             params.m_Y         = upload_params.m_Y;
@@ -169,12 +259,12 @@ namespace dmGameSystem
                 dmGraphics::TextureCreationParams creation_params;
 
                 creation_params.m_Type           = TextureImageToTextureType(image_desc->m_DDFImage->m_Type);
-                creation_params.m_Width          = image->m_Width;
-                creation_params.m_Height         = image->m_Height;
+                creation_params.m_Width          = params.m_Width;
+                creation_params.m_Height         = params.m_Height;
                 creation_params.m_Depth          = image_desc->m_DDFImage->m_Count;
                 creation_params.m_OriginalWidth  = image->m_OriginalWidth;
                 creation_params.m_OriginalHeight = image->m_OriginalHeight;
-                creation_params.m_MipMapCount    = num_mips;
+                creation_params.m_MipMapCount    = num_mips - mip_skip;
 
                 if (image_desc->m_DDFImage->m_UsageFlags != 0)
                 {
@@ -207,7 +297,7 @@ namespace dmGameSystem
             }
 
             // Need to revert to simple bilinear filtering if no mipmaps were supplied
-            if (image->m_MipMapOffset.m_Count <= 1) {
+            if (image->m_MipMapOffset.m_Count <= 1 || (num_mips - mip_skip) <= 1) {
                 if (params.m_MinFilter == dmGraphics::TEXTURE_FILTER_LINEAR_MIPMAP_NEAREST) {
                     params.m_MinFilter = dmGraphics::TEXTURE_FILTER_LINEAR;
                 } else if (params.m_MinFilter == dmGraphics::TEXTURE_FILTER_NEAREST_MIPMAP_NEAREST) {
@@ -245,7 +335,7 @@ namespace dmGameSystem
             }
             else
             {
-                for (uint32_t i = 0; i < num_mips; ++i)
+                for (uint32_t i = mip_skip; i < num_mips; ++i)
                 {
                     if (image_desc->m_DecompressedData[i] == 0)
                     {
@@ -258,7 +348,7 @@ namespace dmGameSystem
                         params.m_DataSize = image_desc->m_DecompressedDataSize[i];
                     }
 
-                    params.m_MipMap   = i;
+                    params.m_MipMap   = i - mip_skip;
                     dmGraphics::SetTextureAsync(texture, params, 0, 0);
 
                     params.m_Width >>= 1;
@@ -314,6 +404,7 @@ namespace dmGameSystem
         ImageDesc* image_desc = new ImageDesc;
         memset(image_desc, 0x0, sizeof(ImageDesc));
         image_desc->m_DDFImage = texture_image;
+        image_desc->m_TranscodedAlternative = -1;
         return image_desc;
     }
 
@@ -341,6 +432,10 @@ namespace dmGameSystem
         }
 
         ImageDesc* image_desc = CreateImage((dmGraphics::HContext) params->m_Context, texture_image);
+
+        // Transcode here rather than in the create function, which runs on the main thread
+        PreloadTranscode(params->m_Filename, (dmGraphics::HContext) params->m_Context, image_desc);
+
         *params->m_PreloadData = image_desc;
         return dmResource::RESULT_OK;
     }
@@ -19,6 +19,7 @@
 #include <dlib/buffer.h>
 #include <dlib/dstrings.h>
 #include <dlib/log.h>
+#include <dlib/math.h>
 
 #include "script_buffer.h"
 #include "../resources/res_buffer.h"
@@ -684,6 +685,430 @@ namespace dmGameSystem
     }
 
 
+    ////////////////////////////////////////////////////////
+    // Bulk stream operations
+    //
+    // The loops below are kept simple, with the type known at compile time, so that the compiler
+    // can vectorize them (especially for tightly packed float streams).
+
+    // Integer streams are calculated in double precision, float streams in single precision
+    template<typename T> struct StreamCalcType { typedef double Type; };
+    template<> struct StreamCalcType<float> { typedef float Type; };
+
+    // Reads an optional element range at index and index+1. Defaults to the whole stream.
+    static void CheckStreamRange(lua_State* L, int index, const BufferStream* stream, uint32_t* offset, uint32_t* count)
+    {
+        int o = luaL_optinteger(L, index, 0);
+        int c = luaL_optinteger(L, index + 1, (int)stream->m_Count - o);
+        if (o < 0 || c < 0 || (uint32_t)(o + c) > stream->m_Count)
+        {
+            luaL_error(L, "Invalid stream range: Stream length: %d, Offset: %d, Count: %d", stream->m_Count, o, c);
+        }
+        *offset = (uint32_t)o;
+        *count = (uint32_t)c;
+    }
+
+    // Reads a number (used for all components), a vector3 or a vector4.
+    // For a vector3, the fourth component gets the default value.
+    static void CheckStreamVector(lua_State* L, int index, lua_Number default_w, lua_Number out[4])
+    {
+        if (lua_isnumber(L, index))
+        {
+            lua_Number v = lua_tonumber(L, index);
+            out[0] = out[1] = out[2] = out[3] = v;
+        }
+        else if (dmVMath::Vector3* v = dmScript::ToVector3(L, index))
+        {
+            out[0] = v->getX(); out[1] = v->getY(); out[2] = v->getZ(); out[3] = default_w;
+        }
+        else if (dmVMath::Vector4* v = dmScript::ToVector4(L, index))
+        {
+            out[0] = v->getX(); out[1] = v->getY(); out[2] = v->getZ(); out[3] = v->getW();
+        }
+        else
+        {
+            luaL_typerror(L, index, "number|vector3|vector4");
+        }
+    }
+
+    // Like CheckStreamVector, but with one value per stream component. Components after the fourth get the last value.
+    static void CheckStreamComponents(lua_State* L, int index, lua_Number default_w, lua_Number* out, uint32_t components)
+    {
+        lua_Number v[4];
+        CheckStreamVector(L, index, default_w, v);
+        for (uint32_t c = 0; c < components; ++c)
+        {
+            out[c] = v[dmMath::Min(c, 3u)];
+        }
+    }
+
+    template<typename T>
+    static void FillStreamT(T* data, uint32_t stride, uint32_t components, uint32_t count, const lua_Number* value)
+    {
+        for (uint32_t i = 0; i < count; ++i, data += stride)
+        {
+            for (uint32_t c = 0; c < components; ++c)
+            {
+                data[c] = (T)value[c];
+            }
+        }
+    }
+
+    template<typename T>
+    static void ScaleStreamT(T* data, uint32_t stride, uint32_t components, uint32_t count, const lua_Number* scale, const lua_Number* bias)
+    {
+        typedef typename StreamCalcType<T>::Type C;
+        for (uint32_t i = 0; i < count; ++i, data += stride)
+        {
+            for (uint32_t c = 0; c < components; ++c)
+            {
+                data[c] = (T)((C)data[c] * (C)scale[c] + (C)bias[c]);
+            }
+        }
+    }
+
+    template<typename T>
+    static void LerpStreamT(T* dst, const T* a, const T* b, uint32_t stride, uint32_t components, uint32_t count, float t)
+    {
+        typedef typename StreamCalcType<T>::Type C;
+        for (uint32_t i = 0; i < count; ++i, dst += stride, a += stride, b += stride)
+        {
+            for (uint32_t c = 0; c < components; ++c)
+            {
+                dst[c] = (T)((C)a[c] + ((C)b[c] - (C)a[c]) * (C)t);
+            }
+        }
+    }
+
+    template<typename TDst, typename TSrc>
+    static void ConvertStreamT(TDst* dst, uint32_t dststride, const TSrc* src, uint32_t srcstride, uint32_t components, uint32_t count)
+    {
+        for (uint32_t i = 0; i < count; ++i, dst += dststride, src += srcstride)
+        {
+            for (uint32_t c = 0; c < components; ++c)
+            {
+                dst[c] = (TDst)src[c];
+            }
+        }
+    }
+
+    template<typename TDst>
+    static bool ConvertStreamSrc(TDst* dst, uint32_t dststride, const BufferStream* src, uint32_t srcoffset, uint32_t components, uint32_t count)
+    {
+        #define DM_CONVERT_STREAM(_T_) ConvertStreamT<TDst, _T_>(dst, dststride, (const _T_*)src->m_Data + srcoffset * src->m_Stride, src->m_Stride, components, count)
+        switch(src->m_Type)
+        {
+        case dmBuffer::VALUE_TYPE_UINT8:      DM_CONVERT_STREAM(uint8_t); break;
+        case dmBuffer::VALUE_TYPE_UINT16:     DM_CONVERT_STREAM(uint16_t); break;
+        case dmBuffer::VALUE_TYPE_UINT32:     DM_CONVERT_STREAM(uint32_t); break;
+        case dmBuffer::VALUE_TYPE_UINT64:     DM_CONVERT_STREAM(uint64_t); break;
+        case dmBuffer::VALUE_TYPE_INT8:       DM_CONVERT_STREAM(int8_t); break;
+        case dmBuffer::VALUE_TYPE_INT16:      DM_CONVERT_STREAM(int16_t); break;
+        case dmBuffer::VALUE_TYPE_INT32:      DM_CONVERT_STREAM(int32_t); break;
+        case dmBuffer::VALUE_TYPE_INT64:      DM_CONVERT_STREAM(int64_t); break;
+        case dmBuffer::VALUE_TYPE_FLOAT32:    DM_CONVERT_STREAM(float); break;
+        default:
+            return false;
+        }
+        return true;
+        #undef DM_CONVERT_STREAM
+    }
+
+    #define DM_STREAM_TYPE_SWITCH(_TYPE_, _OP_, _FAIL_) \
+        switch(_TYPE_) \
+        { \
+        case dmBuffer::VALUE_TYPE_UINT8:      _OP_(uint8_t); break; \
+        case dmBuffer::VALUE_TYPE_UINT16:     _OP_(uint16_t); break; \
+        case dmBuffer::VALUE_TYPE_UINT32:     _OP_(uint32_t); break; \
+        case dmBuffer::VALUE_TYPE_UINT64:     _OP_(uint64_t); break; \
+        case dmBuffer::VALUE_TYPE_INT8:       _OP_(int8_t); break; \
+        case dmBuffer::VALUE_TYPE_INT16:      _OP_(int16_t); break; \
+        case dmBuffer::VALUE_TYPE_INT32:      _OP_(int32_t); break; \
+        case dmBuffer::VALUE_TYPE_INT64:      _OP_(int64_t); break; \
+        case dmBuffer::VALUE_TYPE_FLOAT32:    _OP_(float); break; \
+        default: _FAIL_; \
+        }
+
+    /*# fills a stream with a value
+     *
+     * Sets all components of a range of elements in a stream to a value.
+     *
+     * @name buffer.fill_stream
+     * @param stream [type:bufferstream] the stream to fill
+     * @param value [type:number|vector3|vector4] the value. A number is used for all components,
+     * and the components of a vector are used for the matching components of the stream.
+     * @param [offset] [type:number] the first element to fill (default 0)
+     * @param [count] [type:number] the number of elements to fill (default all elements from the offset)
+     *
+     * @examples
+     * How to make all vertices of a mesh white
+     *
+     * ```lua
+     * local colors = buffer.get_stream(buf, hash("color"))
+     * buffer.fill_stream(colors, vmath.vector4(1, 1, 1, 1))
+     * ```
+    */
+    static int FillStream(lua_State* L)
+    {
+        DM_LUA_STACK_CHECK(L, 0);
+        BufferStream* stream = CheckStream(L, 1);
+        lua_Number* value = (lua_Number*)alloca(stream->m_TypeCount * sizeof(lua_Number));
+        CheckStreamComponents(L, 2, 0.0f, value, stream->m_TypeCount);
+        uint32_t offset, count;
+        CheckStreamRange(L, 3, stream, &offset, &count);
+
+        #define DM_FILL_STREAM(_T_) FillStreamT<_T_>((_T_*)stream->m_Data + offset * stream->m_Stride, stream->m_Stride, stream->m_TypeCount, count, value)
+        DM_STREAM_TYPE_SWITCH(stream->m_Type, DM_FILL_STREAM, return DM_LUA_ERROR("Unknown stream value type: %d", stream->m_Type));
+        #undef DM_FILL_STREAM
+
+        dmBuffer::UpdateContentVersion(stream->m_Buffer);
+        return 0;
+    }
+
+    /*# scales and offsets the values of a stream
+     *
+     * Multiplies each component of a range of elements in a stream by a scale, and then adds a bias: `value * scale + bias`
+     *
+     * @name buffer.scale_stream
+     * @param stream [type:bufferstream] the stream to modify
+     * @param scale [type:number|vector3|vector4] the scale. A number is used for all components.
+     * @param [bias] [type:number|vector3|vector4] the value to add after scaling (default 0)
+     * @param [offset] [type:number] the first element to modify (default 0)
+     * @param [count] [type:number] the number of elements to modify (default all elements from the offset)
+     *
+     * @examples
+     * How to scale the positions of a mesh and move it up
+     *
+     * ```lua
+     * local positions = buffer.get_stream(buf, hash("position"))
+     * buffer.scale_stream(positions, 2, vmath.vector3(0, 10, 0))
+     * ```
+    */
+    static int ScaleStream(lua_State* L)
+    {
+        DM_LUA_STACK_CHECK(L, 0);
+        BufferStream* stream = CheckStream(L, 1);
+        uint32_t components = stream->m_TypeCount;
+        lua_Number* scale = (lua_Number*)alloca(components * sizeof(lua_Number));
+        lua_Number* bias = (lua_Number*)alloca(components * sizeof(lua_Number));
+        CheckStreamComponents(L, 2, 1.0f, scale, components);
+        if (!lua_isnoneornil(L, 3))
+        {
+            CheckStreamComponents(L, 3, 0.0f, bias, components);
+        }
+        else
+        {
+            memset(bias, 0, components * sizeof(lua_Number));
+        }
+        uint32_t offset, count;
+        CheckStreamRange(L, 4, stream, &offset, &count);
+
+        #define DM_SCALE_STREAM(_T_) ScaleStreamT<_T_>((_T_*)stream->m_Data + offset * stream->m_Stride, stream->m_Stride, components, count, scale, bias)
+        DM_STREAM_TYPE_SWITCH(stream->m_Type, DM_SCALE_STREAM, return DM_LUA_ERROR("Unknown stream value type: %d", stream->m_Type));
+        #undef DM_SCALE_STREAM
+
+        dmBuffer::UpdateContentVersion(stream->m_Buffer);
+        return 0;
+    }
+
+    /*# transforms the values of a stream by a matrix
+     *
+     * Transforms a range of elements in a float32 stream with 2, 3 or 4 components by a matrix.
+     * For streams with 2 components the z component is 0, and for streams with 2 or 3 components
+     * the w component is given by the `w` argument.
+     *
+     * @name buffer.transform_stream
+     * @param stream [type:bufferstream] the stream to transform
+     * @param matrix [type:matrix4] the transform
+     * @param [w] [type:number] the w component for streams with fewer than 4 components. Use 1 for positions and 0 for directions (default 1)
+     * @param [offset] [type:number] the first element to transform (default 0)
+     * @param [count] [type:number] the number of elements to transform (default all elements from the offset)
+     *
+     * @examples
+     * How to rotate the positions and normals of a mesh
+     *
+     * ```lua
+     * local m = vmath.matrix4_rotation_y(math.pi / 2)
+     * buffer.transform_stream(buffer.get_stream(buf, hash("position")), m)
+     * buffer.transform_stream(buffer.get_stream(buf, hash("normal")), m, 0)
+     * ```
+    */
+    static int TransformStream(lua_State* L)
+    {
+        DM_LUA_STACK_CHECK(L, 0);
+        BufferStream* stream = CheckStream(L, 1);
+        dmVMath::Matrix4* matrix = dmScript::CheckMatrix4(L, 2);
+        float w = (float)luaL_optnumber(L, 3, 1.0);
+        uint32_t offset, count;
+        CheckStreamRange(L, 4, stream, &offset, &count);
+
+        uint32_t components = stream->m_TypeCount;
+        if (stream->m_Type != dmBuffer::VALUE_TYPE_FLOAT32 || components < 2 || components > 4)
+        {
+            return DM_LUA_ERROR("Only float32 streams with 2, 3 or 4 components can be transformed, got %u 'buffer.%s'", components, dmBuffer::GetValueTypeString(stream->m_Type));
+        }
+
+        float m[4][4]; // column major
+        for (uint32_t c = 0; c < 4; ++c)
+        {
+            dmVMath::Vector4 col = matrix->getCol(c);
+            m[c][0] = col.getX(); m[c][1] = col.getY(); m[c][2] = col.getZ(); m[c][3] = col.getW();
+        }
+
+        float* data = (float*)stream->m_Data + offset * stream->m_Stride;
+        for (uint32_t i = 0; i < count; ++i, data += stream->m_Stride)
+        {
+            float x = data[0];
+            float y = data[1];
+            float z = components > 2 ? data[2] : 0.0f;
+            float vw = components > 3 ? data[3] : w;
+            float out[4];
+            for (uint32_t r = 0; r < 4; ++r)
+            {
+                out[r] = m[0][r] * x + m[1][r] * y + m[2][r] * z + m[3][r] * vw;
+            }
+            for (uint32_t c = 0; c < components; ++c)
+            {
+                data[c] = out[c];
+            }
+        }
+
+        dmBuffer::UpdateContentVersion(stream->m_Buffer);
+        return 0;
+    }
+
+    /*# interpolates between two streams
+     *
+     * Linearly interpolates between the elements of two streams, and stores the result in a third: `a + (b - a) * t`
+     *
+     * [icon:attention] The value type and component count must match between the streams.
+     * The destination stream can be the same as either of the source streams.
+     *
+     * @name buffer.lerp_stream
+     * @param dst [type:bufferstream] the destination stream
+     * @param a [type:bufferstream] the stream with the values at t = 0
+     * @param b [type:bufferstream] the stream with the values at t = 1
+     * @param t [type:number] the interpolation parameter
+     * @param [offset] [type:number] the first element to interpolate (default 0)
+     * @param [count] [type:number] the number of elements to interpolate (default all elements from the offset)
+     *
+     * @examples
+     * How to blend between two poses of a mesh
+     *
+     * ```lua
+     * local dst = buffer.get_stream(mesh_buf, hash("position"))
+     * buffer.lerp_stream(dst, buffer.get_stream(pose_a, hash("position")), buffer.get_stream(pose_b, hash("position")), self.blend)
+     * ```
+    */
+    static int LerpStream(lua_State* L)
+    {
+        DM_LUA_STACK_CHECK(L, 0);
+        BufferStream* dst = CheckStream(L, 1);
+        BufferStream* a = CheckStream(L, 2);
+        BufferStream* b = CheckStream(L, 3);
+        float t = (float)luaL_checknumber(L, 4);
+        uint32_t offset, count;
+        CheckStreamRange(L, 5, dst, &offset, &count);
+
+        BufferStream* srcs[] = {a, b};
+        for (uint32_t i = 0; i < 2; ++i)
+        {
+            if (srcs[i]->m_Type != dst->m_Type || srcs[i]->m_TypeCount != dst->m_TypeCount)
+            {
+                return DM_LUA_ERROR("The streams differ. Expected %u 'buffer.%s', got %u 'buffer.%s'",
+                                        dst->m_TypeCount, dmBuffer::GetValueTypeString(dst->m_Type), srcs[i]->m_TypeCount, dmBuffer::GetValueTypeString(srcs[i]->m_Type));
+            }
+            if (offset + count > srcs[i]->m_Count)
+            {
+                return DM_LUA_ERROR("Trying to read too many elements: Stream length: %d, Offset: %d, Count: %d", srcs[i]->m_Count, offset, count);
+            }
+        }
+
+        // The streams may be in buffers with different layouts, so we only iterate with a shared stride when they match
+        if (a->m_Stride != dst->m_Stride || b->m_Stride != dst->m_Stride)
+        {
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                for (uint32_t c = 0; c < dst->m_TypeCount; ++c)
+                {
+                    lua_Number va = a->m_Get(a->m_Data, (offset + i) * a->m_Stride + c);
+                    lua_Number vb = b->m_Get(b->m_Data, (offset + i) * b->m_Stride + c);
+                    dst->m_Set(dst->m_Data, (offset + i) * dst->m_Stride + c, va + (vb - va) * t);
+                }
+            }
+        }
+        else
+        {
+            uint32_t start = offset * dst->m_Stride;
+            #define DM_LERP_STREAM(_T_) LerpStreamT<_T_>((_T_*)dst->m_Data + start, (const _T_*)a->m_Data + start, (const _T_*)b->m_Data + start, dst->m_Stride, dst->m_TypeCount, count, t)
+            DM_STREAM_TYPE_SWITCH(dst->m_Type, DM_LERP_STREAM, return DM_LUA_ERROR("Unknown stream value type: %d", dst->m_Type));
+            #undef DM_LERP_STREAM
+        }
+
+        dmBuffer::UpdateContentVersion(dst->m_Buffer);
+        return 0;
+    }
+
+    /*# copies data from one stream to another, converting the value type
+     *
+     * Copies elements from one stream to another stream of a different value type.
+     * The values are converted like when they're set from Lua, e.g. floats are truncated when copied to an integer stream.
+     *
+     * [icon:attention] The component count must match between the streams.
+     *
+     * @name buffer.convert_stream
+     * @param dst [type:bufferstream] the destination stream
+     * @param dstoffset [type:number] the element to start copying data to
+     * @param src [type:bufferstream] the source stream
+     * @param srcoffset [type:number] the element to start copying data from
+     * @param count [type:number] the number of elements to copy
+     *
+     * @examples
+     * How to copy float colors to an 8 bit color stream
+     *
+     * ```lua
+     * local src = buffer.get_stream(float_colors, hash("color"))
+     * buffer.scale_stream(src, 255)
+     * buffer.convert_stream(buffer.get_stream(byte_colors, hash("color")), 0, src, 0, #float_colors)
+     * ```
+    */
+    static int ConvertStream(lua_State* L)
+    {
+        DM_LUA_STACK_CHECK(L, 0);
+        BufferStream* dst = CheckStream(L, 1);
+        int dstoffset = luaL_checkint(L, 2);
+        BufferStream* src = CheckStream(L, 3);
+        int srcoffset = luaL_checkint(L, 4);
+        int count = luaL_checkint(L, 5);
+
+        if (dst->m_TypeCount != src->m_TypeCount)
+        {
+            return DM_LUA_ERROR("The type count of the streams differ. Expected %u, got %u", dst->m_TypeCount, src->m_TypeCount);
+        }
+        if (dstoffset < 0 || count < 0 || (uint32_t)(dstoffset + count) > dst->m_Count)
+        {
+            return DM_LUA_ERROR("Trying to write too many elements: Stream length: %d, Offset: %d, Elements to copy: %d", dst->m_Count, dstoffset, count);
+        }
+        if (srcoffset < 0 || (uint32_t)(srcoffset + count) > src->m_Count)
+        {
+            return DM_LUA_ERROR("Trying to read too many elements: Stream length: %d, Offset: %d, Elements to copy: %d", src->m_Count, srcoffset, count);
+        }
+
+        bool ok = false;
+        #define DM_CONVERT_STREAM(_T_) ok = ConvertStreamSrc<_T_>((_T_*)dst->m_Data + dstoffset * dst->m_Stride, dst->m_Stride, src, srcoffset, dst->m_TypeCount, count)
+        DM_STREAM_TYPE_SWITCH(dst->m_Type, DM_CONVERT_STREAM, ok = false);
+        #undef DM_CONVERT_STREAM
+        if (!ok)
+        {
+            return DM_LUA_ERROR("Unknown stream value type: %d -> %d", src->m_Type, dst->m_Type);
+        }
+
+        dmBuffer::UpdateContentVersion(dst->m_Buffer);
+        return 0;
+    }
+
+    #undef DM_STREAM_TYPE_SWITCH
+
     /*# gets data from a stream
      *
      * Get a copy of all the bytes from a specified stream as a Lua string.
@@ -1148,6 +1573,11 @@ namespace dmGameSystem
         {"get_bytes", GetBytes},
         {"copy_stream", CopyStream},
         {"copy_buffer", CopyBuffer},
+        {"fill_stream", FillStream},
+        {"scale_stream", ScaleStream},
+        {"transform_stream", TransformStream},
+        {"lerp_stream", LerpStream},
+        {"convert_stream", ConvertStream},
         {"set_metadata",SetMetadata},
         {"get_metadata",GetMetadata},
         {0, 0}
@@ -361,16 +361,14 @@ namespace dmGameSystem
             scale = dmGameObject::GetWorldScale(sender_instance);
         }
 
+        // Keep the current instance on the stack while the spawned scripts run
         dmScript::GetInstance(L);
-        int ref = dmScript::Ref(L, LUA_REGISTRYINDEX);
 
         dmGameObject::InstanceIdMap instances;
-        bool success = dmGameObject::SpawnFromCollection(collection, CompCollectionFactoryGetResource(component)->m_CollectionDesc, &prop_bufs,
+        bool success = dmGameObject::SpawnFromCollection(collection, CompCollectionFactoryGetResource(component)->m_SpawnTemplate, &prop_bufs,
                                                          position, rotation, scale, &instances);
 
-        lua_rawgeti(L, LUA_REGISTRYINDEX, ref);
         dmScript::SetInstance(L);
-        dmScript::Unref(L, LUA_REGISTRYINDEX, ref);
 
         // Construct return table
         if (success)
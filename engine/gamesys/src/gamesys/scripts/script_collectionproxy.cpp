@@ -180,11 +180,25 @@ namespace dmGameSystem
         return 2;
     }
 
+    // See doc in comp_collection_proxy.cpp
+    static int CollectionProxy_SetIsolated(lua_State* L)
+    {
+        DM_LUA_STACK_CHECK(L, 0);
+        CollectionProxyWorld* world;
+        CollectionProxyComponent* component;
+        dmScript::GetComponentFromLua(L, 1, COLLECTION_PROXY_EXT, (void**)&world, (void**)&component, 0);
+        luaL_checktype(L, 2, LUA_TBOOLEAN);
+
+        CollectionProxySetIsolated(world, component, lua_toboolean(L, 2));
+        return 0;
+    }
+
     static const luaL_reg Module_methods[] =
     {
         {"missing_resources", CollectionProxy_MissingResources},
         {"get_resources", CollectionProxy_GetResources},
         {"set_collection", CollectionProxy_SetCollection},
+        {"set_isolated", CollectionProxy_SetIsolated},
         {0, 0}
     };
 
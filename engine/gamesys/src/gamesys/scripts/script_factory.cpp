@@ -42,6 +42,10 @@ extern "C"
 
 namespace dmGameSystem
 {
+    #define FACTORY_PROPERTIES "FactoryProperties"
+
+    static uint32_t FACTORY_PROPERTIES_TYPE_HASH = 0;
+
     /*# Factory API documentation
      *
      * Functions for controlling factory components which are used to
@@ -196,6 +200,76 @@ namespace dmGameSystem
     }
 
 
+    static dmGameObject::HPropertyContainer* FactoryProperties_Check(lua_State* L, int index)
+    {
+        return (dmGameObject::HPropertyContainer*)dmScript::CheckUserType(L, index, FACTORY_PROPERTIES_TYPE_HASH, "Expected a properties table or prepared properties (acquired from the factory.prepare_properties function)");
+    }
+
+    static int FactoryProperties_gc(lua_State* L)
+    {
+        dmGameObject::HPropertyContainer* p = (dmGameObject::HPropertyContainer*)lua_touserdata(L, 1);
+        dmGameObject::PropertyContainerDestroy(*p);
+        *p = 0;
+        return 0;
+    }
+
+    static int FactoryProperties_tostring(lua_State* L)
+    {
+        dmGameObject::HPropertyContainer properties = *(dmGameObject::HPropertyContainer*)lua_touserdata(L, 1);
+        lua_pushfstring(L, "FactoryProperties: %p", properties);
+        return 1;
+    }
+
+    static const luaL_reg FactoryProperties_methods[] =
+    {
+        {0,0}
+    };
+
+    static const luaL_reg FactoryProperties_meta[] =
+    {
+        {"__gc",        FactoryProperties_gc},
+        {"__tostring",  FactoryProperties_tostring},
+        {0,0}
+    };
+
+    /*# prepare properties for repeated factory.create calls
+     *
+     * Converts a properties table into a reusable, prepared form, which can be passed to [ref:factory.create]
+     * instead of the table.
+     * The table is read and the property names are hashed once, instead of once per created game object,
+     * which is useful when spawning many game objects with the same properties.
+     *
+     * @name factory.prepare_properties
+     * @param properties [type:table] the properties defined in a script attached to the new game object.
+     * @return properties [type:userdata] the prepared properties
+     * @examples
+     *
+     * How to spawn a wave of enemies with the same properties:
+     *
+     * ```lua
+     * function init(self)
+     *     self.enemy_properties = factory.prepare_properties({ health = 100, speed = 20 })
+     * end
+     *
+     * local function spawn_wave(self, count)
+     *     for i = 1, count do
+     *         factory.create("#enemy_factory", vmath.vector3(i * 32, 0, 0), nil, self.enemy_properties)
+     *     end
+     * end
+     * ```
+     */
+    static int FactoryComp_PrepareProperties(lua_State* L)
+    {
+        DM_LUA_STACK_CHECK(L, 1);
+
+        dmGameObject::HPropertyContainer properties = dmGameObject::PropertyContainerCreateFromLua(L, 1);
+        dmGameObject::HPropertyContainer* p = (dmGameObject::HPropertyContainer*)lua_newuserdata(L, sizeof(dmGameObject::HPropertyContainer));
+        *p = properties;
+        luaL_getmetatable(L, FACTORY_PROPERTIES);
+        lua_setmetatable(L, -2);
+        return 1;
+    }
+
     /*# make a factory create a new game object
      *
      * The URL identifies which factory should create the game object.
@@ -211,7 +285,7 @@ namespace dmGameSystem
      * @param url [type:string|hash|url] the factory that should create a game object.
      * @param [position] [type:vector3] the position of the new game object, the position of the game object calling `factory.create()` is used by default, or if the value is `nil`.
      * @param [rotation] [type:quaternion] the rotation of the new game object, the rotation of the game object calling `factory.create()` is used by default, or if the value is `nil`.
-     * @param [properties] [type:table] the properties defined in a script attached to the new game object.
+     * @param [properties] [type:table|userdata] the properties defined in a script attached to the new game object, either as a table or as prepared with [ref:factory.prepare_properties].
      * @param [scale] [type:number|vector3] the scale of the new game object (must be greater than 0), the scale of the game object containing the factory is used by default, or if the value is `nil`
      * @return id [type:hash] the global id of the spawned game object
      * @examples
@@ -305,10 +379,17 @@ namespace dmGameSystem
             rotation = dmGameObject::GetWorldRotation(sender_instance);
         }
 
+        // The prepared properties are owned by their userdata
         dmGameObject::HPropertyContainer properties = 0;
+        bool owns_properties = false;
         if (top >= 4 && lua_istable(L, 4))
         {
             properties = dmGameObject::PropertyContainerCreateFromLua(L, 4);
+            owns_properties = true;
+        }
+        else if (top >= 4 && !lua_isnil(L, 4))
+        {
+            properties = *FactoryProperties_Check(L, 4);
         }
 
         dmVMath::Vector3 scale;
@@ -352,16 +433,14 @@ namespace dmGameSystem
             else
             {
                 // Since the spawning will invoke any scripts on that new instance,
-                // we need a way to restore the state
+                // we need a way to restore the state. The scripts leave the stack balanced,
+                // so we keep the current instance on the stack rather than in the registry
                 dmScript::GetInstance(L);
-                int ref = dmScript::Ref(L, LUA_REGISTRYINDEX);
 
                 dmGameObject::HInstance instance = CompFactorySpawn(world, component, collection,
                                                                 index, id, position, rotation, scale, properties);
 
-                lua_rawgeti(L, LUA_REGISTRYINDEX, ref);
                 dmScript::SetInstance(L);
-                dmScript::Unref(L, LUA_REGISTRYINDEX, ref);
 
                 if (instance != 0)
                 {
@@ -374,7 +453,10 @@ namespace dmGameSystem
             }
         }
 
-        dmGameObject::PropertyContainerDestroy(properties);
+        if (owns_properties)
+        {
+            dmGameObject::PropertyContainerDestroy(properties);
+        }
 
         assert(top + 1 == lua_gettop(L));
         return 1;
@@ -485,6 +567,7 @@ namespace dmGameSystem
         {"unload",            FactoryComp_Unload},
         {"get_status",        FactoryComp_GetStatus},
         {"set_prototype",     FactoryComp_SetPrototype},
+        {"prepare_properties", FactoryComp_PrepareProperties},
         {0, 0}
     };
 
@@ -492,6 +575,8 @@ namespace dmGameSystem
     void ScriptFactoryRegister(const ScriptLibContext& context)
     {
         lua_State* L = context.m_LuaState;
+        FACTORY_PROPERTIES_TYPE_HASH = dmScript::RegisterUserType(L, FACTORY_PROPERTIES, FactoryProperties_methods, FactoryProperties_meta);
+
         luaL_register(L, "factory", FACTORY_COMP_FUNCTIONS);
 
         #define SETCONSTANT(value, name) \
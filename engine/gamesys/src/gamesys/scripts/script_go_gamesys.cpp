@@ -0,0 +1,281 @@
+// Copyright 2020-2024 The Defold Foundation
+// Copyright 2014-2020 King
+// Copyright 2009-2014 Ragnar Svensson, Christian Murray
+// Licensed under the Defold License version 1.0 (the "License"); you may not use
+// this file except in compliance with the License.
+//
+// You may obtain a copy of the License, together with FAQs at
+// https://www.defold.com/license
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include <dlib/buffer.h>
+#include <dlib/hash.h>
+#include <gameobject/gameobject.h>
+
+#include <dmsdk/gamesys/script.h>
+
+#include "../gamesys.h"
+
+#include "script_go_gamesys.h"
+
+extern "C"
+{
+    #include <lua/lua.h>
+    #include <lua/lauxlib.h>
+}
+
+namespace dmGameSystem
+{
+    /*# Game object API documentation
+     *
+     * Bulk transform functions, operating on many game object instances with a single call.
+     *
+     * @document
+     * @name Game object
+     * @namespace go
+     */
+
+    enum TransformComponent
+    {
+        TRANSFORM_COMPONENT_POSITION,
+        TRANSFORM_COMPONENT_ROTATION,
+        TRANSFORM_COMPONENT_SCALE,
+    };
+
+    static const char* TRANSFORM_FUNCTION_NAMES[2][3] =
+    {
+        {"go.get_positions", "go.get_rotations", "go.get_scales"},
+        {"go.set_positions", "go.set_rotations", "go.set_scales"},
+    };
+
+    static dmGameObject::HInstance ResolveBulkInstance(lua_State* L, dmGameObject::HCollection collection, int index)
+    {
+        // Hashed ids (e.g. from factory.create) are looked up directly, anything else goes through the regular url resolve
+        if (dmScript::IsHash(L, index))
+        {
+            dmhash_t id = dmScript::CheckHash(L, index);
+            dmGameObject::HInstance instance = dmGameObject::GetInstanceFromIdentifier(collection, id);
+            if (!instance)
+            {
+                luaL_error(L, "Instance %s not found", dmHashReverseSafe64(id));
+            }
+            return instance;
+        }
+        return dmScript::CheckGOInstance(L, index);
+    }
+
+    static int BulkTransform(lua_State* L, TransformComponent component, bool set)
+    {
+        DM_LUA_STACK_CHECK(L, 0);
+
+        const char* name = TRANSFORM_FUNCTION_NAMES[set ? 1 : 0][component];
+        luaL_checktype(L, 1, LUA_TTABLE);
+        dmBuffer::HBuffer buffer = dmScript::CheckBufferUnpack(L, 2);
+        dmhash_t stream_name = dmScript::CheckHashOrString(L, 3);
+
+        float* data = 0;
+        uint32_t count = 0;
+        uint32_t components = 0;
+        uint32_t stride = 0;
+        dmBuffer::Result r = dmBuffer::GetStream(buffer, stream_name, (void**)&data, &count, &components, &stride);
+        if (r != dmBuffer::RESULT_OK)
+        {
+            return DM_LUA_ERROR("%s: unable to get stream %s: %s (%d)", name, dmHashReverseSafe64(stream_name), dmBuffer::GetResultString(r), r);
+        }
+
+        dmBuffer::ValueType type;
+        dmBuffer::GetStreamType(buffer, stream_name, &type, &components);
+        uint32_t min_components = component == TRANSFORM_COMPONENT_ROTATION ? 4 : 3;
+        if (type != dmBuffer::VALUE_TYPE_FLOAT32 || components < min_components)
+        {
+            return DM_LUA_ERROR("%s: stream %s must be of type float32 with at least %d components", name, dmHashReverseSafe64(stream_name), min_components);
+        }
+
+        uint32_t instance_count = (uint32_t)lua_objlen(L, 1);
+        if (instance_count > count)
+        {
+            return DM_LUA_ERROR("%s: stream %s has %d elements, but %d ids were given", name, dmHashReverseSafe64(stream_name), count, instance_count);
+        }
+
+        dmGameObject::HCollection collection = dmGameObject::GetCollection(dmScript::CheckGOInstance(L));
+
+        for (uint32_t i = 0; i < instance_count; ++i, data += stride)
+        {
+            lua_rawgeti(L, 1, i + 1);
+            dmGameObject::HInstance instance = ResolveBulkInstance(L, collection, lua_gettop(L));
+            lua_pop(L, 1);
+
+            if (set)
+            {
+                switch (component)
+                {
+                case TRANSFORM_COMPONENT_POSITION:  dmGameObject::SetPosition(instance, dmVMath::Point3(data[0], data[1], data[2])); break;
+                case TRANSFORM_COMPONENT_ROTATION:  dmGameObject::SetRotation(instance, dmVMath::Quat(data[0], data[1], data[2], data[3])); break;
+                case TRANSFORM_COMPONENT_SCALE:     dmGameObject::SetScale(instance, dmVMath::Vector3(data[0], data[1], data[2])); break;
+                }
+            }
+            else
+            {
+                switch (component)
+                {
+                case TRANSFORM_COMPONENT_POSITION:
+                    {
+                        dmVMath::Point3 p = dmGameObject::GetPosition(instance);
+                        data[0] = p.getX(); data[1] = p.getY(); data[2] = p.getZ();
+                    }
+                    break;
+                case TRANSFORM_COMPONENT_ROTATION:
+                    {
+                        dmVMath::Quat q = dmGameObject::GetRotation(instance);
+                        data[0] = q.getX(); data[1] = q.getY(); data[2] = q.getZ(); data[3] = q.getW();
+                    }
+                    break;
+                case TRANSFORM_COMPONENT_SCALE:
+                    {
+                        dmVMath::Vector3 s = dmGameObject::GetScale(instance);
+                        data[0] = s.getX(); data[1] = s.getY(); data[2] = s.getZ();
+                    }
+                    break;
+                }
+            }
+        }
+
+        if (!set)
+        {
+            dmBuffer::UpdateContentVersion(buffer);
+        }
+        return 0;
+    }
+
+    /*# gets the positions of several game object instances
+     * Reads the positions of all instances in `ids` into a float32 buffer stream with at least 3 components,
+     * in the same order. The positions are relative the parent (if any).
+     *
+     * @name go.get_positions
+     * @param ids [type:table] list of instance ids (hash|string|url)
+     * @param buffer [type:buffer] the buffer to write to
+     * @param stream_name [type:hash|string] the name of the stream, with at least as many elements as there are ids
+     * @examples
+     *
+     * ```lua
+     * function init(self)
+     *     self.ids = {}
+     *     for i = 1, 1000 do
+     *         self.ids[i] = factory.create("#factory")
+     *     end
+     *     self.positions = buffer.create(#self.ids, { {name=hash("position"), type=buffer.VALUE_TYPE_FLOAT32, count=3} })
+     * end
+     *
+     * function update(self, dt)
+     *     go.get_positions(self.ids, self.positions, "position")
+     *     local stream = buffer.get_stream(self.positions, "position")
+     *     for i = 1, #self.ids do
+     *         stream[(i - 1) * 3 + 2] = stream[(i - 1) * 3 + 2] + 10 * dt
+     *     end
+     *     go.set_positions(self.ids, self.positions, "position")
+     * end
+     * ```
+     */
+    static int Script_GetPositions(lua_State* L)
+    {
+        return BulkTransform(L, TRANSFORM_COMPONENT_POSITION, false);
+    }
+
+    /*# sets the positions of several game object instances
+     * Sets the positions of all instances in `ids` from a float32 buffer stream with at least 3 components,
+     * in the same order. The positions are relative the parent (if any).
+     *
+     * @name go.set_positions
+     * @param ids [type:table] list of instance ids (hash|string|url)
+     * @param buffer [type:buffer] the buffer to read from
+     * @param stream_name [type:hash|string] the name of the stream, with at least as many elements as there are ids
+     */
+    static int Script_SetPositions(lua_State* L)
+    {
+        return BulkTransform(L, TRANSFORM_COMPONENT_POSITION, true);
+    }
+
+    /*# gets the rotations of several game object instances
+     * Reads the rotations of all instances in `ids` into a float32 buffer stream with at least 4 components (x, y, z, w),
+     * in the same order. The rotations are relative to the parent (if any).
+     *
+     * @name go.get_rotations
+     * @param ids [type:table] list of instance ids (hash|string|url)
+     * @param buffer [type:buffer] the buffer to write to
+     * @param stream_name [type:hash|string] the name of the stream, with at least as many elements as there are ids
+     */
+    static int Script_GetRotations(lua_State* L)
+    {
+        return BulkTransform(L, TRANSFORM_COMPONENT_ROTATION, false);
+    }
+
+    /*# sets the rotations of several game object instances
+     * Sets the rotations of all instances in `ids` from a float32 buffer stream with at least 4 components (x, y, z, w),
+     * in the same order. The rotations are relative to the parent (if any).
+     *
+     * @name go.set_rotations
+     * @param ids [type:table] list of instance ids (hash|string|url)
+     * @param buffer [type:buffer] the buffer to read from
+     * @param stream_name [type:hash|string] the name of the stream, with at least as many elements as there are ids
+     */
+    static int Script_SetRotations(lua_State* L)
+    {
+        return BulkTransform(L, TRANSFORM_COMPONENT_ROTATION, true);
+    }
+
+    /*# gets the scales of several game object instances
+     * Reads the (non uniform) scales of all instances in `ids` into a float32 buffer stream with at least 3 components,
+     * in the same order. The scales are relative to the parent (if any).
+     *
+     * @name go.get_scales
+     * @param ids [type:table] list of instance ids (hash|string|url)
+     * @param buffer [type:buffer] the buffer to write to
+     * @param stream_name [type:hash|string] the name of the stream, with at least as many elements as there are ids
+     */
+    static int Script_GetScales(lua_State* L)
+    {
+        return BulkTransform(L, TRANSFORM_COMPONENT_SCALE, false);
+    }
+
+    /*# sets the scales of several game object instances
+     * Sets the (non uniform) scales of all instances in `ids` from a float32 buffer stream with at least 3 components,
+     * in the same order. The scales are relative to the parent (if any).
+     *
+     * @name go.set_scales
+     * @param ids [type:table] list of instance ids (hash|string|url)
+     * @param buffer [type:buffer] the buffer to read from
+     * @param stream_name [type:hash|string] the name of the stream, with at least as many elements as there are ids
+     */
+    static int Script_SetScales(lua_State* L)
+    {
+        return BulkTransform(L, TRANSFORM_COMPONENT_SCALE, true);
+    }
+
+    static const luaL_reg GO_GAMESYS_FUNCTIONS[] =
+    {
+        {"get_positions",   Script_GetPositions},
+        {"set_positions",   Script_SetPositions},
+        {"get_rotations",   Script_GetRotations},
+        {"set_rotations",   Script_SetRotations},
+        {"get_scales",      Script_GetScales},
+        {"set_scales",      Script_SetScales},
+        {0, 0}
+    };
+
+    void ScriptGoGameSysRegister(const ScriptLibContext& context)
+    {
+        lua_State* L = context.m_LuaState;
+        int top = lua_gettop(L);
+        (void)top;
+
+        // Extends the go module registered by the gameobject library
+        luaL_register(L, "go", GO_GAMESYS_FUNCTIONS);
+        lua_pop(L, 1);
+
+        assert(top == lua_gettop(L));
+    }
+}
@@ -65,7 +65,10 @@ namespace dmGameSystem
         if (resp->m_Path)
         {
             if (resp->m_Status == 200) {
-                if (!WriteResponseToFile(resp->m_Path, response, resp->m_ResponseLength))
+                // A null response means the body was already streamed to the file by the http service
+                bool ok = response ? WriteResponseToFile(resp->m_Path, response, resp->m_ResponseLength)
+                                   : resp->m_ResponseLength == dmHttpService::STREAM_RESULT_OK;
+                if (!ok)
                 {
                     lua_pushstring(L, "Failed to write to temp file");
                     lua_setfield(L, -2, "error");
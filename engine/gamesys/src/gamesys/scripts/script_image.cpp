@@ -17,11 +17,15 @@
 #include <stdio.h>
 #include <stdint.h>
 
+#include <dlib/array.h>
 #include <dlib/log.h>
 #include <dlib/image.h>
+#include <dlib/job_thread.h>
 #include <extension/extension.h>
+#include <script/script.h>
 
 #include "script_buffer.h"
+#include "script_image.h"
 
 #include "../gamesys.h"
 
@@ -98,6 +102,62 @@ namespace dmGameSystem
         lua_rawset(L, -3);
     }
 
+    static void CheckLoadOptions(lua_State* L, int index, bool* premult, bool* flip_vertically)
+    {
+        // Parse as options table
+        if (lua_istable(L, index))
+        {
+            lua_pushvalue(L, index);
+
+            lua_getfield(L, -1, "premultiply_alpha");
+            if (!lua_isnil(L, -1))
+                *premult = dmScript::CheckBoolean(L, -1);
+            lua_pop(L, 1);
+
+            lua_getfield(L, -1, "flip_vertically");
+            if (!lua_isnil(L, -1))
+                *flip_vertically = dmScript::CheckBoolean(L, -1);
+            lua_pop(L, 1);
+
+            lua_pop(L, 1);
+        }
+        // backwards compatability
+        else
+        {
+            *premult = dmScript::CheckBoolean(L, index);
+        }
+    }
+
+    // Pushes the image table with the data in a buffer object
+    static void PushImageBuffer(lua_State* L, const dmImage::Image& image, uint8_t bytes_per_pixel)
+    {
+        lua_newtable(L);
+
+        PushImageParameters(L, image);
+
+        uint32_t imagesize = image.m_Width * image.m_Height;
+        uint32_t datasize = bytes_per_pixel * imagesize;
+
+        lua_pushliteral(L, "buffer");
+
+        dmBuffer::StreamDeclaration streams_decl[] = {
+            { dmHashString64("data"), dmBuffer::VALUE_TYPE_UINT8, bytes_per_pixel }
+        };
+
+        dmBuffer::HBuffer buffer = 0;
+        dmBuffer::Create(imagesize, streams_decl, 1, &buffer);
+
+        uint8_t* buffer_data     = 0;
+        uint32_t buffer_datasize = 0;
+        dmBuffer::GetBytes(buffer, (void**)&buffer_data, &buffer_datasize);
+        memcpy(buffer_data, image.m_Buffer, datasize);
+
+        dmScript::LuaHBuffer luabuf(buffer, dmScript::OWNER_LUA);
+        dmScript::PushBuffer(L, luabuf);
+
+        lua_rawset(L, -3);
+    }
+
     /*# load image from buffer
     * Load image (PNG or JPEG) from buffer.
     *
@@ -143,31 +203,9 @@ namespace dmGameSystem
 
         bool premult = false;
         bool flip_vertically = false;
-
         if (top >= 2)
         {
-            // Parse as options table
-            if (lua_istable(L, 2))
-            {
-                lua_pushvalue(L, 2);
-
-                lua_getfield(L, -1, "premultiply_alpha");
-                if (!lua_isnil(L, -1))
-                    premult = dmScript::CheckBoolean(L, -1);
-                lua_pop(L, 1);
-
-                lua_getfield(L, -1, "flip_vertically");
-                if (!lua_isnil(L, -1))
-                    flip_vertically = dmScript::CheckBoolean(L, -1);
-                lua_pop(L, 1);
-
-                lua_pop(L, 1);
-            }
-            // backwards compatability
-            else
-            {
-                premult = dmScript::CheckBoolean(L, 2);
-            }
+            CheckLoadOptions(L, 2, &premult, &flip_vertically);
         }
 
         dmImage::Image image;
@@ -254,31 +292,9 @@ namespace dmGameSystem
 
         bool premult = false;
         bool flip_vertically = false;
-
         if (top >= 2)
         {
-            // Parse as options table
-            if (lua_istable(L, 2))
-            {
-                lua_pushvalue(L, 2);
-
-                lua_getfield(L, -1, "premultiply_alpha");
-                if (!lua_isnil(L, -1))
-                    premult = dmScript::CheckBoolean(L, -1);
-                lua_pop(L, 1);
-
-                lua_getfield(L, -1, "flip_vertically");
-                if (!lua_isnil(L, -1))
-                    flip_vertically = dmScript::CheckBoolean(L, -1);
-                lua_pop(L, 1);
-
-                lua_pop(L, 1);
-            }
-            // backwards compatability
-            else
-            {
-                premult = dmScript::CheckBoolean(L, 2);
-            }
+            CheckLoadOptions(L, 2, &premult, &flip_vertically);
         }
 
         dmImage::Image image;
@@ -291,44 +307,247 @@ namespace dmGameSystem
                 luaL_error(L, "unknown image type %d", image.m_Type);
             }
 
-            lua_newtable(L);
+            PushImageBuffer(L, image, bytes_per_pixel);
 
-            PushImageParameters(L, image);
+            dmImage::Free(&image);
+        }
+        else
+        {
+            dmLogWarning("failed to load image (%d)", r);
+            lua_pushnil(L);
+        }
 
-            uint32_t imagesize = image.m_Width * image.m_Height;
-            uint32_t datasize = bytes_per_pixel * imagesize;
+        assert(top + 1 == lua_gettop(L));
+        return 1;
+    }
 
-            lua_pushliteral(L, "buffer");
+    struct ImageRequest
+    {
+        dmScript::LuaCallbackInfo* m_CallbackInfo;
+        uint8_t*                   m_Data;      // A copy of the encoded image
+        uint32_t                   m_DataSize;
+        uint32_t                   m_Id;
+        dmImage::Image             m_Image;
+        dmImage::Result            m_Result;
+        bool                       m_Premult;
+        bool                       m_FlipVertically;
+        bool                       m_Done;
+    };
 
-            dmBuffer::StreamDeclaration streams_decl[] = {
-                { dmHashString64("data"), dmBuffer::VALUE_TYPE_UINT8, bytes_per_pixel }
-            };
+    struct ImageModule
+    {
+        dmJobThread::HContext   m_JobThread;
+        dmArray<ImageRequest*>  m_Requests;
+        uint32_t                m_NextRequestId;
+    } g_ImageModule;
 
-            dmBuffer::HBuffer buffer = 0;
-            dmBuffer::Create(imagesize, streams_decl, 1, &buffer);
+    static void DeleteImageRequest(ImageRequest* request)
+    {
+        if (request->m_Result == dmImage::RESULT_OK)
+            dmImage::Free(&request->m_Image);
+        dmScript::DestroyCallback(request->m_CallbackInfo);
+        free(request->m_Data);
+        delete request;
+    }
 
-            uint8_t* buffer_data     = 0;
-            uint32_t buffer_datasize = 0;
-            dmBuffer::GetBytes(buffer, (void**)&buffer_data, &buffer_datasize);
-            memcpy(buffer_data, image.m_Buffer, datasize);
+    // Called from the job thread
+    static int DecodeImageJob(void* context, void* data)
+    {
+        ImageRequest* request = (ImageRequest*) context;
+        request->m_Result = dmImage::Load(request->m_Data, request->m_DataSize, request->m_Premult, request->m_FlipVertically, &request->m_Image);
+        free(request->m_Data);
+        request->m_Data = 0;
+        return 0;
+    }
 
-            dmScript::LuaHBuffer luabuf(buffer, dmScript::OWNER_LUA);
-            dmScript::PushBuffer(L, luabuf);
+    // Called from the main thread
+    static void DecodeImageJobComplete(void* context, void* data, int result)
+    {
+        ImageRequest* request = (ImageRequest*) context;
+        request->m_Done = true;
+    }
 
-            lua_rawset(L, -3);
+    static void HandleImageRequestCompleted(ImageRequest* request)
+    {
+        if (!dmScript::IsCallbackValid(request->m_CallbackInfo))
+            return;
 
-            dmImage::Free(&image);
+        lua_State* L = dmScript::GetCallbackLuaContext(request->m_CallbackInfo);
+        DM_LUA_STACK_CHECK(L, 0);
+
+        if (!dmScript::SetupCallback(request->m_CallbackInfo))
+        {
+            dmLogError("Failed to setup image.load_async callback (has the calling script been destroyed?)");
+            return;
+        }
+
+        lua_pushnumber(L, request->m_Id);
+
+        uint8_t bytes_per_pixel = request->m_Result == dmImage::RESULT_OK ? dmImage::BytesPerPixel(request->m_Image.m_Type) : 0;
+        if (bytes_per_pixel != 0)
+        {
+            PushImageBuffer(L, request->m_Image, bytes_per_pixel);
         }
         else
         {
-            dmLogWarning("failed to load image (%d)", r);
+            dmLogWarning("failed to load image (%d)", request->m_Result);
             lua_pushnil(L);
         }
 
+        dmScript::PCall(L, 3, 0);
+        dmScript::TeardownCallback(request->m_CallbackInfo);
+    }
+
+    /*# load image from a string into a buffer object asynchronously
+    * Load image (PNG or JPEG) from a string buffer, on a worker thread.
+    * The image is passed to the callback in the same format as [ref:image.load_buffer] returns it.
+    *
+    * @name image.load_async
+    * @param buffer [type:string] image data buffer
+    * @param [options] [type:table] An optional table containing parameters for loading the image. Supported entries:
+    *
+    * `premultiply_alpha`
+    * : [type:boolean] True if alpha should be premultiplied into the color components. Defaults to `false`.
+    *
+    * `flip_vertically`
+    * : [type:boolean] True if the image contents should be flipped vertically. Defaults to `false`.
+    *
+    * @param callback [type:function(self, request_id, image)] function that is called when the image has been loaded
+    *
+    * `self`
+    * : [type:object] The current object.
+    *
+    * `request_id`
+    * : [type:number] The id returned by image.load_async.
+    *
+    * `image`
+    * : [type:table|nil] The image object or `nil` if loading failed. See [ref:image.load_buffer].
+    *
+    * @return request_id [type:number] the id of the request
+    *
+    * @examples
+    *
+    * Load an image from an URL without stalling the frame, and create a texture from it:
+    *
+    * ```lua
+    * local imgurl = "http://www.site.com/image.png"
+    * http.request(imgurl, "GET", function(self, id, response)
+    *         image.load_async(response.response, { flip_vertically = true }, function(self, request_id, img)
+    *             if img then
+    *                 local tparams = {
+    *                     width  = img.width,
+    *                     height = img.height,
+    *                     type   = graphics.TEXTURE_TYPE_2D,
+    *                     format = graphics.TEXTURE_FORMAT_RGBA }
+    *                 resource.create_texture_async("/my_custom_texture.texturec", tparams, img.buffer)
+    *             end
+    *         end)
+    *     end)
+    * ```
+    */
+    static int Image_LoadAsync(lua_State* L)
+    {
+        int top = lua_gettop(L);
+        luaL_checktype(L, 1, LUA_TSTRING);
+        size_t buffer_len = 0;
+        const char* buffer = lua_tolstring(L, 1, &buffer_len);
+
+        bool premult = false;
+        bool flip_vertically = false;
+        int callback_index = 2;
+        if (!lua_isfunction(L, 2))
+        {
+            CheckLoadOptions(L, 2, &premult, &flip_vertically);
+            callback_index = 3;
+        }
+        luaL_checktype(L, callback_index, LUA_TFUNCTION);
+
+        dmScript::LuaCallbackInfo* callback_info = dmScript::CreateCallback(dmScript::GetMainThread(L), callback_index);
+        if (callback_info == 0x0)
+        {
+            return luaL_error(L, "image.load_async failed to create callback");
+        }
+
+        ImageRequest* request     = new ImageRequest();
+        request->m_CallbackInfo   = callback_info;
+        request->m_Data           = (uint8_t*) malloc(buffer_len);
+        request->m_DataSize       = (uint32_t) buffer_len;
+        request->m_Id             = g_ImageModule.m_NextRequestId++;
+        request->m_Result         = dmImage::RESULT_IMAGE_ERROR;
+        request->m_Premult        = premult;
+        request->m_FlipVertically = flip_vertically;
+        request->m_Done           = false;
+        memcpy(request->m_Data, buffer, buffer_len);
+
+        if (g_ImageModule.m_Requests.Full())
+        {
+            g_ImageModule.m_Requests.OffsetCapacity(4);
+        }
+        g_ImageModule.m_Requests.Push(request);
+
+        dmJobThread::PushJob(g_ImageModule.m_JobThread, DecodeImageJob, DecodeImageJobComplete, request, 0);
+
+        lua_pushnumber(L, request->m_Id);
+
         assert(top + 1 == lua_gettop(L));
         return 1;
     }
 
+    static const luaL_reg ScriptImageAsync_methods[] =
+    {
+        {"load_async", Image_LoadAsync},
+        {0, 0}
+    };
+
+    void ScriptImageRegister(const ScriptLibContext& context)
+    {
+        lua_State* L = context.m_LuaState;
+        int top = lua_gettop(L);
+        (void)top;
+
+        // The rest of the module is registered by the extension
+        luaL_register(L, LIB_NAME, ScriptImageAsync_methods);
+        lua_pop(L, 1);
+
+        assert(top == lua_gettop(L));
+
+        g_ImageModule.m_JobThread     = context.m_JobThread;
+        g_ImageModule.m_NextRequestId = 1;
+    }
+
+    void ScriptImageUpdate(const ScriptLibContext& context)
+    {
+        dmArray<ImageRequest*>& requests = g_ImageModule.m_Requests;
+        uint32_t i = 0;
+        while (i < requests.Size())
+        {
+            ImageRequest* request = requests[i];
+            if (!request->m_Done)
+            {
+                ++i;
+                continue;
+            }
+            requests.EraseSwap(i);
+            HandleImageRequestCompleted(request);
+            DeleteImageRequest(request);
+        }
+    }
+
+    void ScriptImageFinalize(const ScriptLibContext& context)
+    {
+        // Flush the pending jobs, as they refer to the requests
+        for (uint32_t i = 0; i < g_ImageModule.m_Requests.Size(); ++i)
+        {
+            while (!g_ImageModule.m_Requests[i]->m_Done)
+                dmJobThread::Update(g_ImageModule.m_JobThread);
+        }
+        for (uint32_t i = 0; i < g_ImageModule.m_Requests.Size(); ++i)
+        {
+            DeleteImageRequest(g_ImageModule.m_Requests[i]);
+        }
+        g_ImageModule.m_Requests.SetCapacity(0);
+    }
+
     static const luaL_reg ScriptImage_methods[] =
     {
         {"load",        Image_Load},
@@ -357,7 +576,7 @@ namespace dmGameSystem
         assert(top == lua_gettop(L));
     }
 
-    static dmExtension::Result ScriptImageInitialize(dmExtension::Params* params)
+    static dmExtension::Result ScriptImageExtensionInitialize(dmExtension::Params* params)
     {
         lua_State* L = params->m_L;
         ScriptImageRegister(L);
@@ -365,11 +584,11 @@ namespace dmGameSystem
     }
 
 
-    static dmExtension::Result ScriptImageFinalize(dmExtension::Params* params)
+    static dmExtension::Result ScriptImageExtensionFinalize(dmExtension::Params* params)
     {
         return dmExtension::RESULT_OK;
     }
 
 
-    DM_DECLARE_EXTENSION(ScriptImageExt, "ScriptImage", 0, 0, ScriptImageInitialize, 0, 0, ScriptImageFinalize)
+    DM_DECLARE_EXTENSION(ScriptImageExt, "ScriptImage", 0, 0, ScriptImageExtensionInitialize, 0, 0, ScriptImageExtensionFinalize)
 }
@@ -20,6 +20,8 @@
 namespace dmGameSystem
 {
     void ScriptImageRegister(const ScriptLibContext& context);
+    void ScriptImageUpdate(const ScriptLibContext& context);
+    void ScriptImageFinalize(const ScriptLibContext& context);
 }
 
 #endif // DM_GAMESYS_SCRIPT_IMAGE_H
@@ -610,6 +610,51 @@ namespace dmGameSystem
         return 1;
     }
 
+    /*# set the lod level of a mesh
+     * Makes the mesh part of the model's level of detail chain. Each frame, one lod level is drawn, picked from how large
+     * the lod meshes are on screen: the lowest level whose screen size is reached, or the last level if none is.
+     * Meshes that aren't part of the chain are always drawn.
+     *
+     * @name model.set_mesh_lod
+     * @param url [type:string|hash|url] the model
+     * @param mesh_id [type:string|hash|url] the id of the mesh
+     * @param lod [type:number] the lod level, where 0 is the most detailed level
+     * @param screen_size [type:number] the min screen size of the lod level, as the mesh bounds diameter relative to the screen height
+     * @examples
+     *
+     * ```lua
+     * function init(self)
+     *     model.set_mesh_lod("#model", "tree_lod0", 0, 0.25) -- drawn when the tree covers a quarter of the screen height or more
+     *     model.set_mesh_lod("#model", "tree_lod1", 1, 0.05)
+     *     model.set_mesh_lod("#model", "tree_lod2", 2, 0)
+     * end
+     * ```
+     */
+    static int LuaModelComp_SetMeshLod(lua_State* L)
+    {
+        int top = lua_gettop(L);
+
+        ModelComponent* component = 0;
+        dmhash_t mesh_id = 0;
+        LuaModelComp_GetSetMeshEnabled_Internal(L, &component, &mesh_id);
+        if (!component)
+        {
+            return luaL_error(L, "the component '%s' could not be found", lua_tostring(L, 1));
+        }
+
+        int lod = luaL_checkinteger(L, 3);
+        float screen_size = (float)luaL_checknumber(L, 4);
+        if (lod < 0 || screen_size < 0.0f)
+            return luaL_error(L, "The lod level and screen size must be positive");
+
+        bool result = CompModelSetMeshLod(component, mesh_id, (uint32_t)lod, screen_size);
+        if (!result)
+            return luaL_error(L, "Component %s had no mesh with id %s, or the lod level %d is too large", lua_tostring(L, 1), lua_tostring(L, 2), lod);
+
+        assert(top == lua_gettop(L));
+        return 0;
+    }
+
     static const luaL_reg MODEL_COMP_FUNCTIONS[] =
     {
             {"play",    LuaModelComp_Play}, // Deprecated
@@ -621,6 +666,7 @@ namespace dmGameSystem
 
             {"set_mesh_enabled",  LuaModelComp_SetMeshEnabled},
             {"get_mesh_enabled",  LuaModelComp_GetMeshEnabled},
+            {"set_mesh_lod",      LuaModelComp_SetMeshLod},
             {0, 0}
     };
 
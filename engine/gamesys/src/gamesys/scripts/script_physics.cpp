@@ -145,6 +145,8 @@ namespace dmGameSystem
     {
         dmMessage::HSocket m_Socket;
         uint32_t m_ComponentIndex;
+        // Scratch space for the spatial queries, reused between calls
+        dmArray<void*> m_QueryResults;
     };
 
     /*# [type:number] collision object mass
@@ -509,6 +511,188 @@ namespace dmGameSystem
         return 1;
     }
 
+    static void* CheckQueryWorld(lua_State* L, PhysicsScriptContext* context, const char* function_name)
+    {
+        dmMessage::URL sender;
+        if (!dmScript::GetURL(L, &sender)) {
+            luaL_error(L, "could not find a requesting instance for %s", function_name);
+            return 0x0;
+        }
+
+        dmGameObject::HInstance sender_instance = CheckGoInstance(L);
+        dmGameObject::HCollection collection = dmGameObject::GetCollection(sender_instance);
+        void* world = dmGameObject::GetWorld(collection, context->m_ComponentIndex);
+        if (world == 0x0)
+        {
+            luaL_error(L, "Physics world doesn't exist. Make sure you have at least one physics component in collection.");
+        }
+        return world;
+    }
+
+    static uint16_t CheckGroupMask(lua_State* L, void* world, int index)
+    {
+        uint16_t mask = 0;
+        luaL_checktype(L, index, LUA_TTABLE);
+        lua_pushnil(L);
+        while (lua_next(L, index) != 0)
+        {
+            mask |= CompCollisionGetGroupBitIndex(world, dmScript::CheckHash(L, -1));
+            lua_pop(L, 1);
+        }
+        return mask;
+    }
+
+    // Pushes the ids of the query results as a list. If a table is given at result_index, it is
+    // cleared and reused instead of creating a new one.
+    static void PushQueryResults(lua_State* L, const dmArray<void*>& results, int result_index)
+    {
+        if (lua_istable(L, result_index))
+        {
+            lua_pushvalue(L, result_index);
+        }
+        else
+        {
+            lua_createtable(L, results.Size(), 0);
+        }
+
+        uint32_t count = results.Size();
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            dmScript::PushHash(L, dmGameSystem::CompCollisionObjectGetIdentifier(results[i]));
+            lua_rawseti(L, -2, i+1);
+        }
+
+        // Remove any stale entries from a previous call
+        int n = count + 1;
+        lua_rawgeti(L, -1, n);
+        while (!lua_isnil(L, -1))
+        {
+            lua_pop(L, 1);
+            lua_pushnil(L);
+            lua_rawseti(L, -2, n);
+            ++n;
+            lua_rawgeti(L, -1, n);
+        }
+        lua_pop(L, 1);
+    }
+
+    /*# finds all collision objects overlapping a box
+     *
+     * Synchronously finds the collision objects whose bounds overlap an axis aligned box.
+     * All types of collision objects are tested against, including triggers.
+     * Which collision objects to find is filtered by their collision groups and can be configured
+     * through `groups`. Each collision object is returned once.
+     *
+     * @name physics.query_aabb
+     * @param min [type:vector3] the world position of the minimum corner of the box
+     * @param max [type:vector3] the world position of the maximum corner of the box
+     * @param groups [type:table] a lua table containing the hashed groups of the collision objects to find
+     * @param [result] [type:table] a lua table to reuse for the result. It is cleared before it is filled.
+     * @return ids [type:table] a list of the ids of the game objects of the found collision objects. The list is empty if nothing was found.
+     * @examples
+     *
+     * ```lua
+     * function init(self)
+     *     self.groups = {hash("enemy")}
+     *     self.targets = {}
+     * end
+     *
+     * function update(self, dt)
+     *     local pos = go.get_position()
+     *     local extents = vmath.vector3(100, 100, 0)
+     *     physics.query_aabb(pos - extents, pos + extents, self.groups, self.targets)
+     *     for _,id in ipairs(self.targets) do
+     *         msg.post(id, "alert")
+     *     end
+     * end
+     * ```
+     */
+    int Physics_QueryAABB(lua_State* L)
+    {
+        DM_LUA_STACK_CHECK(L, 1);
+
+        dmScript::GetGlobal(L, PHYSICS_CONTEXT_HASH);
+        PhysicsScriptContext* context = (PhysicsScriptContext*)lua_touserdata(L, -1);
+        lua_pop(L, 1);
+
+        void* world = CheckQueryWorld(L, context, "physics.query_aabb");
+
+        dmVMath::Point3 min( *dmScript::CheckVector3(L, 1) );
+        dmVMath::Point3 max( *dmScript::CheckVector3(L, 2) );
+        uint16_t mask = CheckGroupMask(L, world, 3);
+
+        dmGameSystem::QueryAABB(world, min, max, mask, context->m_QueryResults);
+        PushQueryResults(L, context->m_QueryResults, 4);
+        return 1;
+    }
+
+    /*# finds all collision objects overlapping a sphere
+     *
+     * Synchronously finds the collision objects overlapping a sphere.
+     * All types of collision objects are tested against, including triggers.
+     * Which collision objects to find is filtered by their collision groups and can be configured
+     * through `groups`. Each collision object is returned once.
+     * In 2D physics worlds, the z component of the center is ignored and the sphere is tested as a circle.
+     *
+     * @name physics.query_sphere
+     * @param center [type:vector3] the world position of the center of the sphere
+     * @param radius [type:number] the radius of the sphere
+     * @param groups [type:table] a lua table containing the hashed groups of the collision objects to find
+     * @param [result] [type:table] a lua table to reuse for the result. It is cleared before it is filled.
+     * @return ids [type:table] a list of the ids of the game objects of the found collision objects. The list is empty if nothing was found.
+     * @examples
+     *
+     * ```lua
+     * function explode(self, center)
+     *     local ids = physics.query_sphere(center, 5, {hash("enemy")})
+     *     for _,id in ipairs(ids) do
+     *         msg.post(id, "damage", {amount = 10})
+     *     end
+     * end
+     * ```
+     */
+
+    /*# finds all collision objects overlapping a circle
+     *
+     * Synchronously finds the collision objects overlapping a circle.
+     * All types of collision objects are tested against, including triggers.
+     * Which collision objects to find is filtered by their collision groups and can be configured
+     * through `groups`. Each collision object is returned once.
+     * This is the same function as [ref:physics.query_sphere], named for 2D physics worlds.
+     *
+     * @name physics.query_circle
+     * @param center [type:vector3] the world position of the center of the circle. The z component is ignored.
+     * @param radius [type:number] the radius of the circle
+     * @param groups [type:table] a lua table containing the hashed groups of the collision objects to find
+     * @param [result] [type:table] a lua table to reuse for the result. It is cleared before it is filled.
+     * @return ids [type:table] a list of the ids of the game objects of the found collision objects. The list is empty if nothing was found.
+     * @examples
+     *
+     * ```lua
+     * function update(self, dt)
+     *     self.nearby = physics.query_circle(go.get_position(), 200, {hash("pickup")}, self.nearby)
+     * end
+     * ```
+     */
+    int Physics_QuerySphere(lua_State* L)
+    {
+        DM_LUA_STACK_CHECK(L, 1);
+
+        dmScript::GetGlobal(L, PHYSICS_CONTEXT_HASH);
+        PhysicsScriptContext* context = (PhysicsScriptContext*)lua_touserdata(L, -1);
+        lua_pop(L, 1);
+
+        void* world = CheckQueryWorld(L, context, "physics.query_sphere");
+
+        dmVMath::Point3 center( *dmScript::CheckVector3(L, 1) );
+        float radius = luaL_checknumber(L, 2);
+        uint16_t mask = CheckGroupMask(L, world, 3);
+
+        dmGameSystem::QuerySphere(world, center, radius, mask, context->m_QueryResults);
+        PushQueryResults(L, context->m_QueryResults, 4);
+        return 1;
+    }
+
     // Matches JointResult in physics.h
     static const char* PhysicsResultString[] = {
         "result ok",
@@ -1075,6 +1259,51 @@ namespace dmGameSystem
         return 1;
     }
 
+    /*# set the focus of the partitioned physics world
+     *
+     * Set the focus of the 2D physics world of the collection that the function is called from,
+     * usually the position of the player.
+     *
+     * If `physics.region_size` is set in the game.project file, the world is partitioned into square regions
+     * of that size. Only the collision objects overlapping the regions within `physics.region_radius` regions
+     * of the focus region are simulated. The other collision objects are frozen in place: they are not stepped,
+     * do not collide and are not hit by ray casts, until they are within the radius again.
+     * All regions are simulated until the focus is set.
+     *
+     * Note: The function does nothing for 3D physics, or if the world isn't partitioned.
+     *
+     * @name physics.set_region_focus
+     * @param position [type:vector3] the focus position
+     * @examples
+     *
+     * ```lua
+     * function update(self, dt)
+     *     physics.set_region_focus(go.get_position())
+     * end
+     * ```
+     */
+    static int Physics_SetRegionFocus(lua_State* L)
+    {
+        DM_LUA_STACK_CHECK(L, 0);
+
+        dmScript::GetGlobal(L, PHYSICS_CONTEXT_HASH);
+        PhysicsScriptContext* context = (PhysicsScriptContext*)lua_touserdata(L, -1);
+        lua_pop(L, 1);
+
+        dmGameObject::HInstance sender_instance = CheckGoInstance(L);
+        dmGameObject::HCollection collection = dmGameObject::GetCollection(sender_instance);
+        void* world = dmGameObject::GetWorld(collection, context->m_ComponentIndex);
+        if (world == 0x0)
+        {
+            return DM_LUA_ERROR("Physics world doesn't exist. Make sure you have at least one physics component in collection.");
+        }
+        dmVMath::Point3 position( *dmScript::CheckVector3(L, 1) );
+
+        dmGameSystem::SetRegionFocus(world, position);
+
+        return 0;
+    }
+
     static int Physics_SetFlipInternal(lua_State* L, bool horizontal)
     {
         DM_LUA_STACK_CHECK(L, 0);
@@ -1747,6 +1976,9 @@ namespace dmGameSystem
         {"ray_cast",        Physics_RayCastAsync}, // Deprecated
         {"raycast_async",   Physics_RayCastAsync},
         {"raycast",         Physics_RayCast},
+        {"query_aabb",      Physics_QueryAABB},
+        {"query_sphere",    Physics_QuerySphere},
+        {"query_circle",    Physics_QuerySphere},
 
         {"create_joint",    Physics_CreateJoint},
         {"destroy_joint",   Physics_DestroyJoint},
@@ -1757,6 +1989,7 @@ namespace dmGameSystem
 
         {"set_gravity",     Physics_SetGravity},
         {"get_gravity",     Physics_GetGravity},
+        {"set_region_focus", Physics_SetRegionFocus},
 
         {"set_hflip",       Physics_SetFlipH},
         {"set_vflip",       Physics_SetFlipV},
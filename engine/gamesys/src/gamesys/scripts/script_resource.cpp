@@ -13,6 +13,7 @@
 // specific language governing permissions and limitations under the License.
 
 #include <float.h>  // FLT_MAX
+#include <stdlib.h> // malloc
 
 #include <dlib/buffer.h>
 #include <dlib/dstrings.h>
@@ -1349,6 +1350,214 @@ static int SetTexture(lua_State* L)
     return 0;
 }
 
+// Returns the number of 8 bit components of the formats we can update regions of, or 0
+static uint32_t GetTextureRegionComponents(dmGraphics::TextureFormat format)
+{
+    switch(format)
+    {
+        case dmGraphics::TEXTURE_FORMAT_LUMINANCE:       return 1;
+        case dmGraphics::TEXTURE_FORMAT_LUMINANCE_ALPHA: return 2;
+        case dmGraphics::TEXTURE_FORMAT_RGB:             return 3;
+        case dmGraphics::TEXTURE_FORMAT_RGBA:            return 4;
+        default:                                         return 0;
+    }
+}
+
+// Box filters the image into one of half the size. The width and height must be even.
+// The destination may be the same memory as the source.
+static void DownsampleTextureRegion(const uint8_t* src, uint8_t* dst, uint32_t width, uint32_t height, uint32_t components)
+{
+    uint32_t src_row = width * components;
+    for (uint32_t y = 0; y < height / 2; ++y)
+    {
+        const uint8_t* row0 = src + (y * 2) * src_row;
+        const uint8_t* row1 = row0 + src_row;
+        for (uint32_t x = 0; x < width / 2; ++x)
+        {
+            for (uint32_t c = 0; c < components; ++c)
+            {
+                uint32_t i = x * 2 * components + c;
+                *dst++ = (uint8_t) ((row0[i] + row0[i + components] + row1[i] + row1[i + components] + 2) / 4);
+            }
+        }
+    }
+}
+
+/*# set a region of a texture
+ * Updates a rectangular region of a texture with the pixels in a buffer. Unlike [ref:resource.set_texture],
+ * the region is uploaded directly to the graphics texture, without first creating a texture image for the resource.
+ * This is useful for e.g. runtime atlases, painting and minimaps, where a small part of a large texture changes often.
+ *
+ * The lower mipmap levels of the region can optionally be regenerated from the uploaded pixels.
+ * The region at a lower level is only regenerated if its position and size are divisible by two for every level
+ * above it, e.g. a 64x64 region at 128,192 regenerates mipmap levels 1 to 6, while a 48x48 region at 16,16
+ * regenerates levels 1 to 4.
+ *
+ * @note Only uncompressed 2D textures with 8 bits per component are supported.
+ *
+ * @name resource.set_texture_region
+ *
+ * @param path [type:hash|string] The path to the texture resource
+ * @param table [type:table] A table containing info about the region. Supported entries:
+ *
+ * `x`
+ * : [type:integer] The x offset of the region, in pixels
+ *
+ * `y`
+ * : [type:integer] The y offset of the region, in pixels
+ *
+ * `width`
+ * : [type:integer] The width of the region, in pixels
+ *
+ * `height`
+ * : [type:integer] The height of the region, in pixels
+ *
+ * `format`
+ * : [type:number] The format of the texture, and the pixels in the buffer. Supported values:
+ *
+ * - `graphics.TEXTURE_FORMAT_LUMINANCE`
+ * - `graphics.TEXTURE_FORMAT_RGB`
+ * - `graphics.TEXTURE_FORMAT_RGBA`
+ *
+ * `mipmap`
+ * : [type:integer] optional mipmap level to update (default 0)
+ *
+ * `generate_mipmaps`
+ * : [type:boolean] optional flag to also regenerate the region in the lower mipmap levels (default false)
+ *
+ * @param buffer [type:buffer] The buffer with the pixels of the region, in tightly packed rows
+ *
+ * @examples
+ * How to paint a 16x16 square of a 1024x1024 RGBA texture
+ *
+ * ```lua
+ * function init(self)
+ *     self.brush = buffer.create(16 * 16, { {name=hash("rgba"), type=buffer.VALUE_TYPE_UINT8, count=4} })
+ *     local stream = buffer.get_stream(self.brush, hash("rgba"))
+ *     for i=1,#stream do
+ *         stream[i] = 0xff
+ *     end
+ * end
+ *
+ * function on_input(self, action_id, action)
+ *     local path = go.get("#model", "texture0")
+ *     local region = { x = math.floor(action.x / 16) * 16, y = math.floor(action.y / 16) * 16, width = 16, height = 16,
+ *                      format = graphics.TEXTURE_FORMAT_RGBA, generate_mipmaps = true }
+ *     resource.set_texture_region(path, region, self.brush)
+ * end
+ * ```
+ */
+static int SetTextureRegion(lua_State* L)
+{
+    DM_LUA_STACK_CHECK(L, 0);
+
+    dmhash_t path_hash = dmScript::CheckHashOrString(L, 1);
+
+    luaL_checktype(L, 2, LUA_TTABLE);
+    uint32_t x                       = (uint32_t) CheckTableInteger(L, 2, "x");
+    uint32_t y                       = (uint32_t) CheckTableInteger(L, 2, "y");
+    uint32_t width                   = (uint32_t) CheckTableInteger(L, 2, "width");
+    uint32_t height                  = (uint32_t) CheckTableInteger(L, 2, "height");
+    dmGraphics::TextureFormat format = (dmGraphics::TextureFormat) CheckTableInteger(L, 2, "format");
+    uint32_t mipmap                  = (uint32_t) CheckTableInteger(L, 2, "mipmap", 0);
+
+    lua_getfield(L, 2, "generate_mipmaps");
+    bool generate_mipmaps = lua_toboolean(L, -1);
+    lua_pop(L, 1);
+
+    dmScript::LuaHBuffer* lua_buffer = dmScript::CheckBuffer(L, 3);
+    dmBuffer::HBuffer buffer_handle  = dmGameSystem::UnpackLuaBuffer(lua_buffer);
+
+    TextureResource* texture_res  = (TextureResource*) CheckResource(L, g_ResourceModule.m_Factory, path_hash, "texturec");
+    dmGraphics::HTexture texture  = texture_res->m_Texture;
+
+    uint32_t components = GetTextureRegionComponents(format);
+    if (components == 0)
+    {
+        return DM_LUA_ERROR("Unable to set texture region, unsupported texture format '%s'.", dmGraphics::GetTextureFormatLiteral(format));
+    }
+
+    dmGraphics::TextureType type = dmGraphics::GetTextureType(texture);
+    if (!(type == dmGraphics::TEXTURE_TYPE_2D || type == dmGraphics::TEXTURE_TYPE_IMAGE_2D))
+    {
+        return DM_LUA_ERROR("Unable to set texture region, unsupported texture type '%s'.", dmGraphics::GetTextureTypeLiteral(type));
+    }
+
+    if (texture_res->m_Uploading)
+    {
+        return DM_LUA_ERROR("Unable to set texture region, the texture '%s' is still being uploaded.", dmHashReverseSafe64(path_hash));
+    }
+
+    uint32_t mipmap_count = dmGraphics::GetTextureMipmapCount(texture);
+    if (mipmap >= mipmap_count)
+    {
+        return DM_LUA_ERROR("Texture mipmap level %u exceeds maximum mipmap level %u.", mipmap, mipmap_count - 1);
+    }
+
+    uint32_t tex_width  = dmGraphics::GetMipmapSize(dmGraphics::GetTextureWidth(texture), mipmap);
+    uint32_t tex_height = dmGraphics::GetMipmapSize(dmGraphics::GetTextureHeight(texture), mipmap);
+    if (width == 0 || height == 0 || x + width > tex_width || y + height > tex_height)
+    {
+        return DM_LUA_ERROR("Texture region %ux%u at offset %u,%u is outside of the texture (%ux%u) for mipmap level %u.",
+            width, height, x, y, tex_width, tex_height, mipmap);
+    }
+
+    uint8_t* data = 0;
+    uint32_t datasize = 0;
+    dmBuffer::GetBytes(buffer_handle, (void**)&data, &datasize);
+
+    uint32_t region_size = width * height * components;
+    if (datasize < region_size)
+    {
+        return DM_LUA_ERROR("The buffer is too small for the texture region (%u bytes, expected %u).", datasize, region_size);
+    }
+
+    dmGraphics::TextureParams params;
+    params.m_Format    = format;
+    params.m_X         = x;
+    params.m_Y         = y;
+    params.m_Width     = width;
+    params.m_Height    = height;
+    params.m_MipMap    = mipmap;
+    params.m_SubUpdate = 1;
+    params.m_Data      = data;
+    params.m_DataSize  = region_size;
+    dmGraphics::SetTexture(texture, params);
+
+    if (!generate_mipmaps)
+    {
+        return 0;
+    }
+
+    uint8_t* scratch = 0;
+    const uint8_t* src = data;
+    while (params.m_MipMap + 1 < mipmap_count && ((x | y | width | height) & 1) == 0)
+    {
+        if (!scratch)
+        {
+            scratch = (uint8_t*) malloc((width / 2) * (height / 2) * components);
+        }
+        DownsampleTextureRegion(src, scratch, width, height, components);
+        src     = scratch;
+        x      /= 2;
+        y      /= 2;
+        width  /= 2;
+        height /= 2;
+
+        params.m_X        = x;
+        params.m_Y        = y;
+        params.m_Width    = width;
+        params.m_Height   = height;
+        params.m_MipMap   = params.m_MipMap + 1;
+        params.m_Data     = scratch;
+        params.m_DataSize = width * height * components;
+        dmGraphics::SetTexture(texture, params);
+    }
+    free(scratch);
+
+    return 0;
+}
+
 /*# get texture info
  * Gets texture info from a texture resource path or a texture handle
  *
@@ -2877,6 +3086,14 @@ static int GetBuffer(lua_State* L)
  * * `transfer_ownership`
  * : [type:boolean] optional flag to determine wether or not the resource should take over ownership of the buffer object (default false)
  *
+ * * `offset`
+ * : [type:integer] optional index of the first element that has changed (default 0). Only used together with `count`.
+ *
+ * * `count`
+ * : [type:integer] optional number of elements that have changed. When set, only this range is copied from the incoming buffer,
+ *   and meshes using the resource only upload this range to the graphics buffer. If the resource is changed several times between
+ *   two frames, or the buffer size changes, the whole buffer is uploaded.
+ *
  * @examples
  * How to set the data from a buffer
  *
@@ -2912,6 +3129,21 @@ static int GetBuffer(lua_State* L)
  *     resource.set_buffer(res_path, buf)
  * end
  * ```
+ *
+ * How to update a few vertices of a mesh every frame, without copying the buffer
+ *
+ * ```lua
+ * function update(self, dt)
+ *     local buf = resource.get_buffer(self.res_path)
+ *     local positions = buffer.get_stream(buf, "position")
+ *
+ *     -- move the second vertex
+ *     positions[4] = math.sin(self.t)
+ *
+ *     -- the resource already owns the buffer, so this only marks vertex 1 as changed
+ *     resource.set_buffer(self.res_path, buf, { transfer_ownership = true, offset = 1, count = 1 })
+ * end
+ * ```
  */
 static int SetBuffer(lua_State* L)
 {
@@ -2919,18 +3151,40 @@ static int SetBuffer(lua_State* L)
     dmhash_t path_hash           = dmScript::CheckHashOrString(L, 1);
     dmScript::LuaHBuffer* luabuf = dmScript::CheckBuffer(L, 2);
     bool transfer_ownership      = false;
+    int dirty_start              = 0;
+    int dirty_count              = 0;
 
     if (lua_istable(L, 3))
     {
         lua_pushvalue(L, 3);
         transfer_ownership = CheckFieldValue<bool>(L, -1, "transfer_ownership", false);
+        dirty_start        = CheckFieldValue<int>(L, -1, "offset", 0);
+        dirty_count        = CheckFieldValue<int>(L, -1, "count", 0);
         lua_pop(L, 1); // args table
     }
 
+    if (dirty_start < 0 || dirty_count < 0)
+    {
+        return luaL_error(L, "The buffer range must not be negative (offset: %d, count: %d).", dirty_start, dirty_count);
+    }
+
     dmBuffer::HBuffer src_buffer                  = dmGameSystem::UnpackLuaBuffer(luabuf);
     void* resource                                = CheckResource(L, g_ResourceModule.m_Factory, path_hash, "bufferc");
     dmGameSystem::BufferResource* buffer_resource = (dmGameSystem::BufferResource*)resource;
     dmBuffer::HBuffer dst_buffer                  = buffer_resource->m_Buffer;
+    uint32_t prev_version                         = buffer_resource->m_Version;
+    bool dirty_range                              = false;
+
+    if (dirty_count > 0)
+    {
+        uint32_t src_count = 0;
+        dmBuffer::GetCount(src_buffer, &src_count);
+        if ((uint32_t) dirty_start + (uint32_t) dirty_count > src_count)
+        {
+            return luaL_error(L, "The buffer range %d-%d is outside of the buffer (count: %u).", dirty_start, dirty_start + dirty_count - 1, src_count);
+        }
+        dirty_range = true;
+    }
 
     if (transfer_ownership)
     {
@@ -2998,6 +3252,19 @@ static int SetBuffer(lua_State* L)
             buffer_resource->m_Buffer       = dst_buffer;
             buffer_resource->m_ElementCount = src_count;
         }
+        else if (dirty_range && src_buffer != dst_buffer && dmBuffer::GetStructSize(src_buffer) == dmBuffer::GetStructSize(dst_buffer))
+        {
+            // Only the changed elements need to be copied
+            uint8_t* src_bytes = 0;
+            uint8_t* dst_bytes = 0;
+            uint32_t src_size = 0;
+            uint32_t dst_size = 0;
+            dmBuffer::GetBytes(src_buffer, (void**)&src_bytes, &src_size);
+            dmBuffer::GetBytes(dst_buffer, (void**)&dst_bytes, &dst_size);
+
+            uint32_t stride = dmBuffer::GetStructSize(dst_buffer);
+            memcpy(dst_bytes + dirty_start * stride, src_bytes + dirty_start * stride, dirty_count * stride);
+        }
         else
         {
             br = dmBuffer::Copy(dst_buffer, src_buffer);
@@ -3009,10 +3276,16 @@ static int SetBuffer(lua_State* L)
     }
 
     // Update the content version
-    dmBuffer::UpdateContentVersion(dst_buffer);
+    dmBuffer::UpdateContentVersion(buffer_resource->m_Buffer);
     dmBuffer::GetContentVersion(buffer_resource->m_Buffer, &buffer_resource->m_Version);
     buffer_resource->m_NameHash = path_hash;
 
+    // The range is relative to the previous content of the resource. Meshes that uploaded any other
+    // version, or a different buffer object, will upload the whole buffer.
+    buffer_resource->m_DirtyVersion = prev_version;
+    buffer_resource->m_DirtyStart   = dirty_range ? dirty_start : 0;
+    buffer_resource->m_DirtyCount   = dirty_range ? dirty_count : 0;
+
     assert(top == lua_gettop(L));
     return 0;
 }
@@ -3115,6 +3388,7 @@ static const luaL_reg Module_methods[] =
     {"set_atlas",               SetAtlas},
     {"get_atlas",               GetAtlas},
     {"set_texture",             SetTexture},
+    {"set_texture_region",      SetTextureRegion},
     {"get_texture_info",        GetTextureInfo},
     {"get_render_target_info",  GetRenderTargetInfo},
     {"set_sound",               SetSound},
@@ -101,6 +101,35 @@ namespace dmGameSystem
      * ```
      */
 
+    /*# [type:number] sound max distance
+     *
+     * The distance at which the sounds of the sound-component are attenuated to silence.
+     * If greater than 0, the sounds are spatial: their gain and pan follow the position of
+     * the game object relative to the listener, see [ref:sound.set_listener]. Default is 0.
+     *
+     * @name max_distance
+     * @property
+     *
+     * @examples
+     *
+     * ```lua
+     * function init(self)
+     *   go.set("#sound", "min_distance", 50)
+     *   go.set("#sound", "max_distance", 800)
+     *   sound.play("#sound")
+     * end
+     * ```
+     */
+
+    /*# [type:number] sound min distance
+     *
+     * The distance within which the spatial sounds of the sound-component are at full gain.
+     * Between the min and the max distance, the gain falls off linearly. Default is 0.
+     *
+     * @name min_distance
+     * @property
+     */
+
     /*# [type:hash] sound data
      *
      * The sound data used when playing the sound. The type of the property is hash.
@@ -723,6 +752,41 @@ namespace dmGameSystem
         return 0;
     }
 
+    /*# set the sound listener
+     * Set the position and rotation of the listener of the spatial sounds, typically those of the camera or the player.
+     * The sounds to the right of the listener (along its local x axis) are panned to the right.
+     *
+     * @name sound.set_listener
+     * @param position [type:vector3] the world position of the listener
+     * @param [rotation] [type:quaternion] the world rotation of the listener. Default is no rotation
+     * @examples
+     *
+     * Follow the player with the listener:
+     *
+     * ```lua
+     * function update(self, dt)
+     *     sound.set_listener(go.get_world_position("player"), go.get_world_rotation("player"))
+     * end
+     * ```
+     */
+    static int Sound_SetListener(lua_State* L)
+    {
+        DM_LUA_STACK_CHECK(L, 0);
+
+        dmVMath::Vector3* position = dmScript::CheckVector3(L, 1);
+        dmVMath::Quat rotation = dmVMath::Quat::identity();
+        if (!lua_isnoneornil(L, 2))
+        {
+            rotation = *dmScript::CheckQuat(L, 2);
+        }
+
+        dmSound::Result r = dmSound::SetListener(dmVMath::Point3(*position), rotation);
+        if (r != dmSound::RESULT_OK) {
+            dmLogWarning("Failed to set the sound listener (%d)", r);
+        }
+        return 0;
+    }
+
     static const luaL_reg SOUND_FUNCTIONS[] =
     {
         {"is_music_playing", Sound_IsMusicPlaying},
@@ -738,6 +802,7 @@ namespace dmGameSystem
         {"pause", Sound_Pause},
         {"set_gain", Sound_SetGain},
         {"set_pan", Sound_SetPan},
+        {"set_listener", Sound_SetListener},
         {0, 0}
     };
 
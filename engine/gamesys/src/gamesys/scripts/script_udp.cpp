@@ -0,0 +1,739 @@
+// Copyright 2020-2024 The Defold Foundation
+// Copyright 2014-2020 King
+// Copyright 2009-2014 Ragnar Svensson, Christian Murray
+// Licensed under the Defold License version 1.0 (the "License"); you may not use
+// this file except in compliance with the License.
+//
+// You may obtain a copy of the License, together with FAQs at
+// https://www.defold.com/license
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <new>
+
+#include <dlib/array.h>
+#include <dlib/buffer.h>
+#include <dlib/hash.h>
+#include <dlib/hashtable.h>
+#include <dlib/log.h>
+#include <dlib/math.h>
+#include <dlib/network_constants.h>
+#include <dlib/profile.h>
+#include <dlib/socket.h>
+#include <script/script.h>
+#include <dmsdk/gamesys/script.h>
+
+#include "script_udp.h"
+
+#include "../gamesys.h"
+
+extern "C"
+{
+    #include <lua/lua.h>
+    #include <lua/lauxlib.h>
+}
+
+namespace dmGameSystem
+{
+    /*# UDP API documentation
+     *
+     * Functions for sending and receiving UDP datagrams without blocking, in batches.
+     * The received datagrams are returned in buffers, without any allocation per datagram,
+     * and the sent datagrams are queued and sent together at the end of the frame.
+     *
+     * @document
+     * @name UDP
+     * @namespace udp
+     */
+
+    #define LIB_NAME "udp"
+    #define SCRIPT_TYPE_NAME_UDP_ENDPOINT "udp_endpoint"
+
+    static const uint32_t DEFAULT_MAX_PACKETS     = 64;
+    static const uint32_t DEFAULT_MAX_PACKET_SIZE = 1200;
+    static const uint32_t DEFAULT_MAX_PEERS       = 64;
+    static const uint32_t MAX_PACKET_SIZE         = 65507;
+
+    static const dmhash_t UDP_STREAM_DATA = dmHashString64("data");
+    static const dmhash_t UDP_STREAM_SIZE = dmHashString64("size");
+    static const dmhash_t UDP_STREAM_PEER = dmHashString64("peer");
+
+    struct UdpPeer
+    {
+        dmSocket::Address m_Address;
+        uint16_t          m_Port;
+    };
+
+    struct UdpQueuedPacket
+    {
+        uint32_t m_Offset; // Into m_SendData
+        uint32_t m_Size;
+        uint32_t m_Peer;
+    };
+
+    // Lives in the memory of the Lua userdata
+    struct UdpEndpoint
+    {
+        dmSocket::Socket                m_Socket;
+        dmSocket::Domain                m_Domain;
+        uint32_t                        m_MaxPackets;
+        uint32_t                        m_MaxPacketSize;
+        uint32_t                        m_MaxPeers;
+
+        // The received packets, reused every receive. One element per packet, and max_packet_size bytes per packet
+        dmBuffer::HBuffer               m_Packets;
+        dmBuffer::HBuffer               m_Data;
+        dmArray<dmSocket::Datagram>     m_Datagrams;
+
+        // The peers are indexed from 1 in the scripts
+        dmArray<UdpPeer>                m_Peers;
+        dmHashTable64<uint32_t>         m_PeerLookup;
+
+        dmArray<UdpQueuedPacket>        m_SendQueue;
+        dmArray<uint8_t>                m_SendData;
+        uint32_t                        m_DroppedPackets;
+    };
+
+    struct UdpModule
+    {
+        dmArray<UdpEndpoint*> m_Endpoints;
+    } g_UdpModule;
+
+    static uint32_t SCRIPT_UDP_ENDPOINT_TYPE_HASH = 0;
+
+    static dmhash_t HashPeer(const dmSocket::Address& address, uint16_t port)
+    {
+        HashState64 state;
+        dmHashInit64(&state, false);
+        dmHashUpdateBuffer64(&state, &address.m_family, sizeof(address.m_family));
+        dmHashUpdateBuffer64(&state, address.m_address, sizeof(address.m_address));
+        dmHashUpdateBuffer64(&state, &port, sizeof(port));
+        return dmHashFinal64(&state);
+    }
+
+    // Returns the peer id, or 0 if there's no room for another peer
+    static uint32_t GetOrAddPeer(UdpEndpoint* endpoint, const dmSocket::Address& address, uint16_t port)
+    {
+        dmhash_t key = HashPeer(address, port);
+        uint32_t* id = endpoint->m_PeerLookup.Get(key);
+        if (id)
+        {
+            return *id;
+        }
+        if (endpoint->m_Peers.Size() >= endpoint->m_MaxPeers)
+        {
+            return 0;
+        }
+        if (endpoint->m_Peers.Full())
+        {
+            endpoint->m_Peers.OffsetCapacity(dmMath::Min(16u, endpoint->m_MaxPeers - endpoint->m_Peers.Size()));
+        }
+        UdpPeer peer;
+        peer.m_Address = address;
+        peer.m_Port = port;
+        endpoint->m_Peers.Push(peer);
+        uint32_t new_id = endpoint->m_Peers.Size();
+        endpoint->m_PeerLookup.Put(key, new_id);
+        return new_id;
+    }
+
+    static void CloseEndpoint(UdpEndpoint* endpoint)
+    {
+        if (endpoint->m_Socket == dmSocket::INVALID_SOCKET_HANDLE)
+        {
+            return;
+        }
+        dmSocket::Delete(endpoint->m_Socket);
+        endpoint->m_Socket = dmSocket::INVALID_SOCKET_HANDLE;
+        dmBuffer::Destroy(endpoint->m_Packets);
+        dmBuffer::Destroy(endpoint->m_Data);
+        endpoint->m_Packets = 0;
+        endpoint->m_Data = 0;
+
+        dmArray<UdpEndpoint*>& endpoints = g_UdpModule.m_Endpoints;
+        for (uint32_t i = 0; i < endpoints.Size(); ++i)
+        {
+            if (endpoints[i] == endpoint)
+            {
+                endpoints.EraseSwap(i);
+                break;
+            }
+        }
+    }
+
+    static void FlushEndpoint(UdpEndpoint* endpoint)
+    {
+        uint32_t count = endpoint->m_SendQueue.Size();
+        if (count == 0 || endpoint->m_Socket == dmSocket::INVALID_SOCKET_HANDLE)
+        {
+            return;
+        }
+        DM_PROFILE("UdpFlush");
+
+        // The same array is used for receiving, which never happens during a flush
+        dmArray<dmSocket::Datagram>& datagrams = endpoint->m_Datagrams;
+        uint32_t sent_total = 0;
+        while (sent_total < count)
+        {
+            uint32_t batch_count = dmMath::Min(count - sent_total, datagrams.Capacity());
+            datagrams.SetSize(batch_count);
+            for (uint32_t i = 0; i < batch_count; ++i)
+            {
+                const UdpQueuedPacket& packet = endpoint->m_SendQueue[sent_total + i];
+                const UdpPeer& peer = endpoint->m_Peers[packet.m_Peer - 1];
+                datagrams[i].m_Buffer  = endpoint->m_SendData.Begin() + packet.m_Offset;
+                datagrams[i].m_Size    = packet.m_Size;
+                datagrams[i].m_Address = peer.m_Address;
+                datagrams[i].m_Port    = peer.m_Port;
+            }
+
+            uint32_t sent_count = 0;
+            dmSocket::Result r = dmSocket::SendToBatch(endpoint->m_Socket, datagrams.Begin(), batch_count, &sent_count);
+            if (r != dmSocket::RESULT_OK)
+            {
+                // UDP is unreliable anyway, so the packets are dropped rather than kept for the next frame
+                if (r != dmSocket::RESULT_WOULDBLOCK)
+                {
+                    dmLogWarning("Failed to send %u udp packets: %s", count - sent_total, dmSocket::ResultToString(r));
+                }
+                endpoint->m_DroppedPackets += count - sent_total;
+                break;
+            }
+            sent_total += sent_count;
+        }
+
+        datagrams.SetSize(0);
+        endpoint->m_SendQueue.SetSize(0);
+        endpoint->m_SendData.SetSize(0);
+    }
+
+    static UdpEndpoint* CheckEndpoint(lua_State* L, int index)
+    {
+        UdpEndpoint* endpoint = (UdpEndpoint*) dmScript::CheckUserType(L, index, SCRIPT_UDP_ENDPOINT_TYPE_HASH, 0);
+        if (endpoint->m_Socket == dmSocket::INVALID_SOCKET_HANDLE)
+        {
+            luaL_error(L, "%s.%s is closed", LIB_NAME, SCRIPT_TYPE_NAME_UDP_ENDPOINT);
+        }
+        return endpoint;
+    }
+
+    static uint32_t GetOptionalUInt(lua_State* L, int table_index, const char* name, uint32_t default_value)
+    {
+        lua_getfield(L, table_index, name);
+        uint32_t value = lua_isnil(L, -1) ? default_value : (uint32_t) luaL_checkinteger(L, -1);
+        lua_pop(L, 1);
+        return value;
+    }
+
+    static bool ResolveAddress(const char* address_str, dmSocket::Domain domain, dmSocket::Address* address)
+    {
+        dmSocket::Result r = dmSocket::GetHostByName(address_str, address, domain == dmSocket::DOMAIN_IPV4, domain == dmSocket::DOMAIN_IPV6);
+        return r == dmSocket::RESULT_OK;
+    }
+
+    /*# opens a udp endpoint
+     * Opens a non-blocking udp socket, bound to the given address and port.
+     *
+     * @name udp.open
+     * @param [options] [type:table] optional table with the endpoint options
+     *
+     * `address`
+     * : [type:string] the address to bind to. The endpoint uses IPv6 if it's an IPv6 address. Default is "0.0.0.0".
+     *
+     * `port`
+     * : [type:number] the port to bind to. Default is 0, which picks any free port.
+     *
+     * `max_packets`
+     * : [type:number] the maximum number of packets returned by each `udp.receive`. Default is 64.
+     *
+     * `max_packet_size`
+     * : [type:number] the maximum packet size. Larger received packets are truncated. Default is 1200.
+     *
+     * `max_peers`
+     * : [type:number] the maximum number of peers. Packets from new peers are dropped when it's reached. Default is 64.
+     *
+     * `receive_buffer_size`
+     * : [type:number] the size of the socket receive buffer, which holds the packets between the calls to `udp.receive`. Default is set by the system.
+     *
+     * @return endpoint [type:udp_endpoint] the endpoint
+     * @examples
+     *
+     * ```lua
+     * function init(self)
+     *     self.endpoint = udp.open({ port = 5000, max_peers = 16 })
+     * end
+     * ```
+     */
+    static int Udp_Open(lua_State* L)
+    {
+        DM_LUA_STACK_CHECK(L, 1);
+
+        const char* address_str   = DM_UNIVERSAL_BIND_ADDRESS_IPV4;
+        uint32_t port             = 0;
+        uint32_t max_packets      = DEFAULT_MAX_PACKETS;
+        uint32_t max_packet_size  = DEFAULT_MAX_PACKET_SIZE;
+        uint32_t max_peers        = DEFAULT_MAX_PEERS;
+        uint32_t receive_buffer   = 0;
+
+        if (lua_gettop(L) >= 1 && !lua_isnil(L, 1))
+        {
+            luaL_checktype(L, 1, LUA_TTABLE);
+            lua_getfield(L, 1, "address");
+            if (!lua_isnil(L, -1))
+            {
+                address_str = luaL_checkstring(L, -1);
+            }
+            port            = GetOptionalUInt(L, 1, "port", port);
+            max_packets     = GetOptionalUInt(L, 1, "max_packets", max_packets);
+            max_packet_size = GetOptionalUInt(L, 1, "max_packet_size", max_packet_size);
+            max_peers       = GetOptionalUInt(L, 1, "max_peers", max_peers);
+            receive_buffer  = GetOptionalUInt(L, 1, "receive_buffer_size", receive_buffer);
+            lua_pop(L, 1);
+        }
+
+        if (port > 0xFFFF)
+        {
+            return DM_LUA_ERROR("%s.open: invalid port %u", LIB_NAME, port);
+        }
+        if (max_packets == 0 || max_packet_size == 0 || max_packet_size > MAX_PACKET_SIZE || max_peers == 0)
+        {
+            return DM_LUA_ERROR("%s.open: max_packets and max_peers must be positive, and max_packet_size between 1 and %u", LIB_NAME, MAX_PACKET_SIZE);
+        }
+
+        dmSocket::Address address;
+        if (dmSocket::GetHostByName(address_str, &address, true, true) != dmSocket::RESULT_OK)
+        {
+            return DM_LUA_ERROR("%s.open: failed to resolve the address '%s'", LIB_NAME, address_str);
+        }
+
+        dmSocket::Socket socket;
+        dmSocket::Result r = dmSocket::New(address.m_family, dmSocket::TYPE_DGRAM, dmSocket::PROTOCOL_UDP, &socket);
+        if (r == dmSocket::RESULT_OK)
+        {
+            r = dmSocket::Bind(socket, address, (int) port);
+            if (r == dmSocket::RESULT_OK)
+                r = dmSocket::SetBlocking(socket, false);
+            if (r == dmSocket::RESULT_OK && receive_buffer > 0)
+                r = dmSocket::SetReceiveBufferSize(socket, receive_buffer);
+            if (r != dmSocket::RESULT_OK)
+                dmSocket::Delete(socket);
+        }
+        if (r != dmSocket::RESULT_OK)
+        {
+            return DM_LUA_ERROR("%s.open: failed to open the socket on %s:%u: %s", LIB_NAME, address_str, port, dmSocket::ResultToString(r));
+        }
+
+        const dmBuffer::StreamDeclaration packets_decl[] = {
+            {UDP_STREAM_SIZE, dmBuffer::VALUE_TYPE_UINT32, 1},
+            {UDP_STREAM_PEER, dmBuffer::VALUE_TYPE_UINT32, 1},
+        };
+        const dmBuffer::StreamDeclaration data_decl[] = {
+            {UDP_STREAM_DATA, dmBuffer::VALUE_TYPE_UINT8, 1},
+        };
+        dmBuffer::HBuffer packets = 0;
+        dmBuffer::HBuffer data = 0;
+        dmBuffer::Result br = dmBuffer::Create(max_packets, packets_decl, DM_ARRAY_SIZE(packets_decl), &packets);
+        if (br == dmBuffer::RESULT_OK)
+        {
+            br = dmBuffer::Create(max_packets * max_packet_size, data_decl, DM_ARRAY_SIZE(data_decl), &data);
+            if (br != dmBuffer::RESULT_OK)
+                dmBuffer::Destroy(packets);
+        }
+        if (br != dmBuffer::RESULT_OK)
+        {
+            dmSocket::Delete(socket);
+            return DM_LUA_ERROR("%s.open: failed to create the packet buffers: %s", LIB_NAME, dmBuffer::GetResultString(br));
+        }
+
+        UdpEndpoint* endpoint = (UdpEndpoint*) lua_newuserdata(L, sizeof(UdpEndpoint));
+        new (endpoint) UdpEndpoint();
+        endpoint->m_Socket          = socket;
+        endpoint->m_Domain          = address.m_family;
+        endpoint->m_MaxPackets      = max_packets;
+        endpoint->m_MaxPacketSize   = max_packet_size;
+        endpoint->m_MaxPeers        = max_peers;
+        endpoint->m_Packets         = packets;
+        endpoint->m_Data            = data;
+        endpoint->m_DroppedPackets  = 0;
+        endpoint->m_Datagrams.SetCapacity(max_packets);
+        uint32_t table_size = dmMath::Max(1u, (2 * max_peers) / 3);
+        endpoint->m_PeerLookup.SetCapacity(table_size, max_peers);
+        luaL_getmetatable(L, SCRIPT_TYPE_NAME_UDP_ENDPOINT);
+        lua_setmetatable(L, -2);
+
+        if (g_UdpModule.m_Endpoints.Full())
+        {
+            g_UdpModule.m_Endpoints.OffsetCapacity(4);
+        }
+        g_UdpModule.m_Endpoints.Push(endpoint);
+        return 1;
+    }
+
+    /*# closes a udp endpoint
+     * Closes the socket. The packets that are still queued are dropped.
+     * The endpoint is also closed when it's garbage collected.
+     *
+     * @name udp.close
+     * @param endpoint [type:udp_endpoint] the endpoint
+     */
+    static int Udp_Close(lua_State* L)
+    {
+        DM_LUA_STACK_CHECK(L, 0);
+        UdpEndpoint* endpoint = (UdpEndpoint*) dmScript::CheckUserType(L, 1, SCRIPT_UDP_ENDPOINT_TYPE_HASH, 0);
+        CloseEndpoint(endpoint);
+        return 0;
+    }
+
+    /*# gets the port of a udp endpoint
+     * Useful when the endpoint was opened on any free port.
+     *
+     * @name udp.get_port
+     * @param endpoint [type:udp_endpoint] the endpoint
+     * @return port [type:number] the local port
+     */
+    static int Udp_GetPort(lua_State* L)
+    {
+        DM_LUA_STACK_CHECK(L, 1);
+        UdpEndpoint* endpoint = CheckEndpoint(L, 1);
+        dmSocket::Address address;
+        uint16_t port = 0;
+        dmSocket::Result r = dmSocket::GetName(endpoint->m_Socket, &address, &port);
+        if (r != dmSocket::RESULT_OK)
+        {
+            return DM_LUA_ERROR("%s.get_port: %s", LIB_NAME, dmSocket::ResultToString(r));
+        }
+        lua_pushinteger(L, port);
+        return 1;
+    }
+
+    /*# adds a peer to a udp endpoint
+     * Adds a peer to send packets to. The peers that send packets to the endpoint are added automatically.
+     *
+     * @name udp.add_peer
+     * @param endpoint [type:udp_endpoint] the endpoint
+     * @param address [type:string] the peer address, or host name
+     * @param port [type:number] the peer port
+     * @return peer [type:number] the peer id, the same as in the `peer` stream of the received packets
+     * @examples
+     *
+     * ```lua
+     * self.server = udp.add_peer(self.endpoint, "127.0.0.1", 5000)
+     * udp.send(self.endpoint, self.server, "hello")
+     * ```
+     */
+    static int Udp_AddPeer(lua_State* L)
+    {
+        DM_LUA_STACK_CHECK(L, 1);
+        UdpEndpoint* endpoint = CheckEndpoint(L, 1);
+        const char* address_str = luaL_checkstring(L, 2);
+        lua_Integer port = luaL_checkinteger(L, 3);
+        if (port <= 0 || port > 0xFFFF)
+        {
+            return DM_LUA_ERROR("%s.add_peer: invalid port %d", LIB_NAME, (int) port);
+        }
+
+        dmSocket::Address address;
+        if (!ResolveAddress(address_str, endpoint->m_Domain, &address))
+        {
+            return DM_LUA_ERROR("%s.add_peer: failed to resolve the address '%s'", LIB_NAME, address_str);
+        }
+
+        uint32_t peer = GetOrAddPeer(endpoint, address, (uint16_t) port);
+        if (peer == 0)
+        {
+            return DM_LUA_ERROR("%s.add_peer: the peer limit (%u) was reached", LIB_NAME, endpoint->m_MaxPeers);
+        }
+        lua_pushinteger(L, peer);
+        return 1;
+    }
+
+    /*# gets the address of a udp peer
+     *
+     * @name udp.get_peer
+     * @param endpoint [type:udp_endpoint] the endpoint
+     * @param peer [type:number] the peer id
+     * @return address [type:string] the peer address
+     * @return port [type:number] the peer port
+     */
+    static int Udp_GetPeer(lua_State* L)
+    {
+        DM_LUA_STACK_CHECK(L, 2);
+        UdpEndpoint* endpoint = CheckEndpoint(L, 1);
+        lua_Integer peer = luaL_checkinteger(L, 2);
+        if (peer < 1 || peer > (lua_Integer) endpoint->m_Peers.Size())
+        {
+            return DM_LUA_ERROR("%s.get_peer: invalid peer %d", LIB_NAME, (int) peer);
+        }
+        const UdpPeer& p = endpoint->m_Peers[peer - 1];
+        char* address = dmSocket::AddressToIPString(p.m_Address);
+        lua_pushstring(L, address);
+        free(address);
+        lua_pushinteger(L, p.m_Port);
+        return 2;
+    }
+
+    /*# queues a udp packet
+     * Queues a packet, which is sent with the other queued packets at the end of the frame, or by `udp.flush`.
+     *
+     * @name udp.send
+     * @param endpoint [type:udp_endpoint] the endpoint
+     * @param peer [type:number] the peer id
+     * @param data [type:string|buffer] the packet data. All bytes of a buffer are sent.
+     * @examples
+     *
+     * ```lua
+     * function update(self, dt)
+     *     for i = 1, #self.peers do
+     *         udp.send(self.endpoint, self.peers[i], self.snapshot)
+     *     end
+     * end
+     * ```
+     */
+    static int Udp_Send(lua_State* L)
+    {
+        DM_LUA_STACK_CHECK(L, 0);
+        UdpEndpoint* endpoint = CheckEndpoint(L, 1);
+        lua_Integer peer = luaL_checkinteger(L, 2);
+        if (peer < 1 || peer > (lua_Integer) endpoint->m_Peers.Size())
+        {
+            return DM_LUA_ERROR("%s.send: invalid peer %d", LIB_NAME, (int) peer);
+        }
+
+        const void* data = 0;
+        uint32_t size = 0;
+        if (dmScript::IsBuffer(L, 3))
+        {
+            dmBuffer::HBuffer buffer = dmScript::CheckBufferUnpack(L, 3);
+            void* bytes = 0;
+            dmBuffer::Result br = dmBuffer::GetBytes(buffer, &bytes, &size);
+            if (br != dmBuffer::RESULT_OK)
+            {
+                return DM_LUA_ERROR("%s.send: invalid buffer: %s", LIB_NAME, dmBuffer::GetResultString(br));
+            }
+            data = bytes;
+        }
+        else
+        {
+            size_t len = 0;
+            data = luaL_checklstring(L, 3, &len);
+            size = (uint32_t) len;
+        }
+        if (size > MAX_PACKET_SIZE)
+        {
+            return DM_LUA_ERROR("%s.send: the packet is too large (%u bytes)", LIB_NAME, size);
+        }
+
+        dmArray<UdpQueuedPacket>& queue = endpoint->m_SendQueue;
+        if (queue.Full())
+        {
+            queue.OffsetCapacity(dmMath::Max(16u, queue.Capacity()));
+        }
+        dmArray<uint8_t>& send_data = endpoint->m_SendData;
+        if (send_data.Remaining() < size)
+        {
+            send_data.OffsetCapacity(dmMath::Max(size, send_data.Capacity()));
+        }
+
+        UdpQueuedPacket packet;
+        packet.m_Offset = send_data.Size();
+        packet.m_Size = size;
+        packet.m_Peer = (uint32_t) peer;
+        queue.Push(packet);
+        send_data.PushArray((const uint8_t*) data, size);
+        return 0;
+    }
+
+    /*# sends the queued udp packets
+     * Sends the queued packets right away, instead of at the end of the frame.
+     *
+     * @name udp.flush
+     * @param endpoint [type:udp_endpoint] the endpoint
+     */
+    static int Udp_Flush(lua_State* L)
+    {
+        DM_LUA_STACK_CHECK(L, 0);
+        UdpEndpoint* endpoint = CheckEndpoint(L, 1);
+        FlushEndpoint(endpoint);
+        return 0;
+    }
+
+    /*# receives the pending udp packets
+     * Receives the packets that arrived since the last call, up to `max_packets`.
+     * The packets are returned in two buffers. The `packets` buffer has one element per packet, and the streams:
+     *
+     * `size`
+     * : [type:uint32] the packet size
+     *
+     * `peer`
+     * : [type:uint32] the id of the peer that sent the packet
+     *
+     * The `data` buffer has the `data` stream with the packet bytes. Each packet takes `max_packet_size` bytes,
+     * of which only the first `size` bytes are valid.
+     *
+     * The buffers are owned by the endpoint, and are overwritten by the next call.
+     * The packets from new peers are dropped when the `max_peers` limit is reached.
+     *
+     * @name udp.receive
+     * @param endpoint [type:udp_endpoint] the endpoint
+     * @return count [type:number] the number of packets
+     * @return packets [type:buffer] the packet sizes and peers
+     * @return data [type:buffer] the packet bytes
+     * @examples
+     *
+     * ```lua
+     * function update(self, dt)
+     *     local count, packets, data = udp.receive(self.endpoint)
+     *     local sizes = buffer.get_stream(packets, "size")
+     *     local peers = buffer.get_stream(packets, "peer")
+     *     local bytes = buffer.get_stream(data, "data")
+     *     for i = 1, count do
+     *         local first_byte = bytes[(i - 1) * MAX_PACKET_SIZE + 1]
+     *         handle_packet(self, peers[i], sizes[i], first_byte)
+     *     end
+     * end
+     * ```
+     */
+    static int Udp_Receive(lua_State* L)
+    {
+        DM_LUA_STACK_CHECK(L, 3);
+        UdpEndpoint* endpoint = CheckEndpoint(L, 1);
+        DM_PROFILE("UdpReceive");
+
+        uint8_t* data = 0;
+        uint32_t* sizes = 0;
+        uint32_t* peers = 0;
+        uint32_t data_size = 0, size_stride = 0, peer_stride = 0;
+        dmBuffer::GetBytes(endpoint->m_Data, (void**) &data, &data_size);
+        dmBuffer::GetStream(endpoint->m_Packets, UDP_STREAM_SIZE, (void**) &sizes, 0, 0, &size_stride);
+        dmBuffer::GetStream(endpoint->m_Packets, UDP_STREAM_PEER, (void**) &peers, 0, 0, &peer_stride);
+
+        const uint32_t packet_size = endpoint->m_MaxPacketSize;
+        assert(data_size >= endpoint->m_MaxPackets * packet_size);
+        (void)data_size;
+        dmArray<dmSocket::Datagram>& datagrams = endpoint->m_Datagrams;
+        datagrams.SetSize(endpoint->m_MaxPackets);
+        for (uint32_t i = 0; i < datagrams.Size(); ++i)
+        {
+            datagrams[i].m_Buffer = data + i * packet_size;
+            datagrams[i].m_Size = packet_size;
+        }
+
+        uint32_t received_count = 0;
+        dmSocket::Result r = dmSocket::ReceiveFromBatch(endpoint->m_Socket, datagrams.Begin(), datagrams.Size(), &received_count);
+        if (r != dmSocket::RESULT_OK && r != dmSocket::RESULT_WOULDBLOCK && r != dmSocket::RESULT_CONNRESET)
+        {
+            dmLogWarning("Failed to receive udp packets: %s", dmSocket::ResultToString(r));
+        }
+
+        // Packets from peers that don't fit are dropped, and the rest moved down to keep them contiguous
+        uint32_t count = 0;
+        for (uint32_t i = 0; i < received_count; ++i)
+        {
+            const dmSocket::Datagram& datagram = datagrams[i];
+            uint32_t peer = GetOrAddPeer(endpoint, datagram.m_Address, datagram.m_Port);
+            if (peer == 0)
+            {
+                endpoint->m_DroppedPackets++;
+                continue;
+            }
+            if (count != i)
+            {
+                memcpy(data + count * packet_size, datagram.m_Buffer, datagram.m_Size);
+            }
+            sizes[count * size_stride] = datagram.m_Size;
+            peers[count * peer_stride] = peer;
+            ++count;
+        }
+        datagrams.SetSize(0);
+
+        lua_pushinteger(L, count);
+        dmScript::LuaHBuffer packets_luabuf(endpoint->m_Packets, dmScript::OWNER_C);
+        dmScript::PushBuffer(L, packets_luabuf);
+        dmScript::LuaHBuffer data_luabuf(endpoint->m_Data, dmScript::OWNER_C);
+        dmScript::PushBuffer(L, data_luabuf);
+        return 3;
+    }
+
+    static int Endpoint_gc(lua_State* L)
+    {
+        UdpEndpoint* endpoint = (UdpEndpoint*) dmScript::CheckUserType(L, 1, SCRIPT_UDP_ENDPOINT_TYPE_HASH, 0);
+        CloseEndpoint(endpoint);
+        endpoint->~UdpEndpoint();
+        return 0;
+    }
+
+    static int Endpoint_tostring(lua_State* L)
+    {
+        UdpEndpoint* endpoint = (UdpEndpoint*) dmScript::CheckUserType(L, 1, SCRIPT_UDP_ENDPOINT_TYPE_HASH, 0);
+        if (endpoint->m_Socket == dmSocket::INVALID_SOCKET_HANDLE)
+        {
+            lua_pushfstring(L, "%s.%s(closed)", LIB_NAME, SCRIPT_TYPE_NAME_UDP_ENDPOINT);
+        }
+        else
+        {
+            lua_pushfstring(L, "%s.%s(peers = %d, dropped = %d)", LIB_NAME, SCRIPT_TYPE_NAME_UDP_ENDPOINT, endpoint->m_Peers.Size(), endpoint->m_DroppedPackets);
+        }
+        return 1;
+    }
+
+    static const luaL_reg Endpoint_methods[] =
+    {
+        {0,0}
+    };
+
+    static const luaL_reg Endpoint_meta[] =
+    {
+        {"__gc",        Endpoint_gc},
+        {"__tostring",  Endpoint_tostring},
+        {0,0}
+    };
+
+    static const luaL_reg ScriptUdp_methods[] =
+    {
+        {"open",        Udp_Open},
+        {"close",       Udp_Close},
+        {"get_port",    Udp_GetPort},
+        {"add_peer",    Udp_AddPeer},
+        {"get_peer",    Udp_GetPeer},
+        {"send",        Udp_Send},
+        {"flush",       Udp_Flush},
+        {"receive",     Udp_Receive},
+        {0, 0}
+    };
+
+    void ScriptUdpRegister(const ScriptLibContext& context)
+    {
+        lua_State* L = context.m_LuaState;
+        int top = lua_gettop(L);
+        (void)top;
+
+        SCRIPT_UDP_ENDPOINT_TYPE_HASH = dmScript::RegisterUserType(L, SCRIPT_TYPE_NAME_UDP_ENDPOINT, Endpoint_methods, Endpoint_meta);
+        luaL_register(L, LIB_NAME, ScriptUdp_methods);
+        lua_pop(L, 1);
+
+        assert(top == lua_gettop(L));
+    }
+
+    void ScriptUdpUpdate(const ScriptLibContext& context)
+    {
+        for (uint32_t i = 0; i < g_UdpModule.m_Endpoints.Size(); ++i)
+        {
+            FlushEndpoint(g_UdpModule.m_Endpoints[i]);
+        }
+    }
+
+    void ScriptUdpFinalize(const ScriptLibContext& context)
+    {
+        // The endpoints themselves are freed when they're garbage collected
+        while (!g_UdpModule.m_Endpoints.Empty())
+        {
+            CloseEndpoint(g_UdpModule.m_Endpoints.Back());
+        }
+    }
+}
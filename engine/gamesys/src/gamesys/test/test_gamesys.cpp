@@ -4480,6 +4480,114 @@ TEST_F(ScriptBufferTest, CopyStream)
 }
 
 
+TEST_F(ScriptBufferTest, StreamOperations)
+{
+    int top = lua_gettop(L);
+
+    uint16_t* stream_rgb = 0;
+    uint32_t count_rgb = 0;
+    uint32_t components_rgb = 0;
+    uint32_t stride_rgb = 0;
+    ASSERT_EQ(dmBuffer::RESULT_OK, dmBuffer::GetStream(m_Buffer, dmHashString64("rgb"), (void**)&stream_rgb, &count_rgb, &components_rgb, &stride_rgb));
+
+    float* stream_a = 0;
+    uint32_t count_a = 0;
+    uint32_t components_a = 0;
+    uint32_t stride_a = 0;
+    ASSERT_EQ(dmBuffer::RESULT_OK, dmBuffer::GetStream(m_Buffer, dmHashString64("a"), (void**)&stream_a, &count_a, &components_a, &stride_a));
+
+    dmScript::LuaHBuffer luabuf(m_Buffer, dmScript::OWNER_C);
+    dmScript::PushBuffer(L, luabuf);
+    lua_setglobal(L, "test_buffer");
+
+    // Fill, then scale and offset a range
+    {
+        memset_stream(stream_rgb, count_rgb, components_rgb, stride_rgb, (uint16_t)0);
+
+        ASSERT_TRUE(RunString(L, "local stream = buffer.get_stream(test_buffer, hash(\"rgb\")) \
+                                  buffer.fill_stream(stream, vmath.vector3(1, 2, 3)) \
+                                  buffer.scale_stream(stream, 2, vmath.vector3(1, 0, 1), 10, 5) \
+                                  "));
+        ASSERT_EQ(dmBuffer::RESULT_OK, dmBuffer::ValidateBuffer(m_Buffer));
+
+        uint16_t* rgb = stream_rgb;
+        for (uint32_t i = 0; i < count_rgb; ++i, rgb += stride_rgb)
+        {
+            bool scaled = i >= 10 && i < 15;
+            ASSERT_EQ(scaled ? 3 : 1, rgb[0]);
+            ASSERT_EQ(scaled ? 4 : 2, rgb[1]);
+            ASSERT_EQ(scaled ? 7 : 3, rgb[2]);
+        }
+    }
+
+    // Lerp between two streams
+    {
+        memset_stream(stream_a, count_a, components_a, stride_a, 0.0f);
+
+        ASSERT_TRUE(RunString(L, "local decl = { {name=hash(\"v\"), type=buffer.VALUE_TYPE_FLOAT32, count=1 } } \
+                                  local a = buffer.create(#test_buffer, decl) \
+                                  local b = buffer.create(#test_buffer, decl) \
+                                  buffer.fill_stream(buffer.get_stream(a, \"v\"), 2) \
+                                  buffer.fill_stream(buffer.get_stream(b, \"v\"), 10) \
+                                  buffer.lerp_stream(buffer.get_stream(test_buffer, \"a\"), buffer.get_stream(a, \"v\"), buffer.get_stream(b, \"v\"), 0.25) \
+                                  "));
+        ASSERT_EQ(dmBuffer::RESULT_OK, dmBuffer::ValidateBuffer(m_Buffer));
+
+        float* a = stream_a;
+        for (uint32_t i = 0; i < count_a; ++i, a += stride_a)
+        {
+            ASSERT_EQ(4.0f, a[0]);
+        }
+    }
+
+    // Convert float values to an integer stream
+    {
+        memset_stream(stream_rgb, count_rgb, components_rgb, stride_rgb, (uint16_t)0);
+
+        ASSERT_TRUE(RunString(L, "local src = buffer.create(4, { {name=hash(\"v\"), type=buffer.VALUE_TYPE_FLOAT32, count=3 } } ) \
+                                  local stream = buffer.get_stream(src, \"v\") \
+                                  for i=1,#stream do \
+                                      stream[i] = i + 0.5 \
+                                  end \
+                                  buffer.convert_stream(buffer.get_stream(test_buffer, \"rgb\"), 2, stream, 1, 3) \
+                                  "));
+        ASSERT_EQ(dmBuffer::RESULT_OK, dmBuffer::ValidateBuffer(m_Buffer));
+
+        uint16_t* rgb = stream_rgb;
+        for (uint32_t i = 0; i < 6; ++i, rgb += stride_rgb)
+        {
+            for (uint32_t c = 0; c < components_rgb; ++c)
+            {
+                ASSERT_EQ((i >= 2 && i < 5) ? (i - 1) * 3 + c + 1 : 0u, (uint32_t)rgb[c]);
+            }
+        }
+    }
+
+    // Transform positions and directions
+    ASSERT_TRUE(RunString(L, "local buf = buffer.create(3, { {name=hash(\"position\"), type=buffer.VALUE_TYPE_FLOAT32, count=3 } } ) \
+                              local stream = buffer.get_stream(buf, \"position\") \
+                              buffer.fill_stream(stream, vmath.vector3(1, 0, 0)) \
+                              buffer.transform_stream(stream, vmath.matrix4_translation(vmath.vector3(0, 5, 0)), 1, 0, 2) \
+                              buffer.transform_stream(stream, vmath.matrix4_translation(vmath.vector3(0, 5, 0)), 0, 2, 1) \
+                              assert(stream[1] == 1 and stream[2] == 5 and stream[3] == 0) \
+                              assert(stream[4] == 1 and stream[5] == 5 and stream[6] == 0) \
+                              assert(stream[7] == 1 and stream[8] == 0 and stream[9] == 0) \
+                              "));
+
+    dmLogWarning("Expected error outputs ->");
+
+    // Out of range
+    ASSERT_FALSE(RunString(L, "buffer.fill_stream(buffer.get_stream(test_buffer, \"a\"), 1, 10, #test_buffer)"));
+    lua_pop(L, 1);
+    // Only float streams can be transformed
+    ASSERT_FALSE(RunString(L, "buffer.transform_stream(buffer.get_stream(test_buffer, \"rgb\"), vmath.matrix4())"));
+    lua_pop(L, 1);
+
+    dmLogWarning("<- Expected error outputs end.");
+
+    ASSERT_EQ(top, lua_gettop(L));
+}
+
 TEST_P(ScriptBufferCopyTest, CopyBuffer)
 {
     const CopyBufferTestParams& p = GetParam();
@@ -4655,6 +4763,44 @@ TEST_F(ScriptBufferTest, RefCount)
 #endif
 }
 
+#if !defined(__EMSCRIPTEN__)
+TEST_F(ScriptUdpTest, SendReceive)
+{
+    int top = lua_gettop(L);
+
+    ASSERT_TRUE(RunString(L, "local server = udp.open({ address = \"127.0.0.1\", max_packets = 4, max_packet_size = 16 }) \
+                              local client = udp.open({ address = \"127.0.0.1\" }) \
+                              assert(udp.receive(server) == 0) \
+                              local peer = udp.add_peer(client, \"127.0.0.1\", udp.get_port(server)) \
+                              assert(peer == 1) \
+                              assert(udp.add_peer(client, \"127.0.0.1\", udp.get_port(server)) == peer) \
+                              udp.send(client, peer, \"hello\") \
+                              udp.send(client, peer, \"world!\") \
+                              udp.flush(client) \
+                              local count, packets, data = udp.receive(server) \
+                              assert(count == 2) \
+                              local bytes = buffer.get_stream(data, \"data\") \
+                              local sizes = buffer.get_stream(packets, \"size\") \
+                              local peers = buffer.get_stream(packets, \"peer\") \
+                              assert(sizes[1] == 5 and sizes[2] == 6) \
+                              assert(peers[1] == 1 and peers[2] == 1) \
+                              assert(bytes[1] == string.byte(\"h\") and bytes[16 + 6] == string.byte(\"!\")) \
+                              local address, port = udp.get_peer(server, peers[1]) \
+                              assert(address == \"127.0.0.1\" and port == udp.get_port(client)) \
+                              local reply = buffer.create(3, { {name=hash(\"v\"), type=buffer.VALUE_TYPE_UINT8, count=1 } }) \
+                              udp.send(server, peers[1], reply) \
+                              udp.flush(server) \
+                              count, packets = udp.receive(client) \
+                              assert(count == 1 and buffer.get_stream(packets, \"size\")[1] == 3) \
+                              udp.close(server) \
+                              assert(not pcall(udp.receive, server)) \
+                              udp.close(client) \
+                             "));
+
+    ASSERT_EQ(top, lua_gettop(L));
+}
+#endif
+
 TEST_F(RenderConstantsTest, CreateDestroy)
 {
     dmGameSystem::HComponentRenderConstants constants = dmGameSystem::CreateRenderConstants();
@@ -785,6 +785,11 @@ protected:
     uint32_t m_Count;
 };
 
+// The udp module returns the received packets in buffers
+class ScriptUdpTest : public ScriptBufferTest
+{
+};
+
 struct CopyBufferTestParams
 {
     uint32_t m_Count;
@@ -64,6 +64,9 @@ namespace dmGraphics
      * @member STAGE_FLAG_QUEUE_END
      * @member STAGE_FLAG_FRAGMENT_SHADER
      * @member STAGE_FLAG_EARLY_FRAGMENT_SHADER_TEST
+     * @member STAGE_FLAG_COMPUTE_SHADER
+     * @member STAGE_FLAG_VERTEX_SHADER
+     * @member STAGE_FLAG_DRAW_INDIRECT
      */
     enum BarrierStageFlags
     {
@@ -71,6 +74,9 @@ namespace dmGraphics
         STAGE_FLAG_QUEUE_END                  = 2,
         STAGE_FLAG_FRAGMENT_SHADER            = 4,
         STAGE_FLAG_EARLY_FRAGMENT_SHADER_TEST = 8,
+        STAGE_FLAG_COMPUTE_SHADER             = 16,
+        STAGE_FLAG_VERTEX_SHADER              = 32,
+        STAGE_FLAG_DRAW_INDIRECT              = 64,
     };
 
     /*#
@@ -79,12 +85,33 @@ namespace dmGraphics
      * @member ACCESS_FLAG_READ
      * @member ACCESS_FLAG_WRITE
      * @member ACCESS_FLAG_SHADER
+     * @member ACCESS_FLAG_INDIRECT_COMMAND
      */
     enum BarrierAccessFlags
     {
-        ACCESS_FLAG_READ   = 1,
-        ACCESS_FLAG_WRITE  = 2,
-        ACCESS_FLAG_SHADER = 4,
+        ACCESS_FLAG_READ             = 1,
+        ACCESS_FLAG_WRITE            = 2,
+        ACCESS_FLAG_SHADER           = 4,
+        ACCESS_FLAG_INDIRECT_COMMAND = 8,
+    };
+
+    /*#
+     * The layout of the draw arguments read by VulkanDrawElementsIndirect (same as VkDrawIndexedIndirectCommand)
+     * @struct
+     * @name DrawElementsIndirectCommand
+     * @member m_IndexCount [type: uint32_t] number of indices to draw
+     * @member m_InstanceCount [type: uint32_t] number of instances to draw
+     * @member m_FirstIndex [type: uint32_t] the first index (not byte offset) in the index buffer
+     * @member m_VertexOffset [type: int32_t] value added to the indices
+     * @member m_FirstInstance [type: uint32_t] the first instance
+     */
+    struct DrawElementsIndirectCommand
+    {
+        uint32_t m_IndexCount;
+        uint32_t m_InstanceCount;
+        uint32_t m_FirstIndex;
+        int32_t  m_VertexOffset;
+        uint32_t m_FirstInstance;
     };
 
     struct RenderPassDescriptor
@@ -199,6 +226,20 @@ namespace dmGraphics
      * @param index_buffer [type: dmGraphics::HIndexBuffer] the index buffer
      */
     void VulkanDrawBaseInstance(HContext context, PrimitiveType prim_type, uint32_t first, uint32_t count, uint32_t instance_count, uint32_t base_instance);
+    /*#
+     * Draw with index buffer, with the draw arguments read from a storage buffer.
+     * The arguments are typically written by a compute program (e.g. when culling instances on the GPU),
+     * in which case a barrier from STAGE_FLAG_COMPUTE_SHADER to STAGE_FLAG_DRAW_INDIRECT is needed before the draw.
+     * @name VulkanDrawElementsIndirect
+     * @param context [type: dmGraphics::HContext] the vulkan context
+     * @param prim_type [type: dmGraphics::PrimitiveType] primitive type
+     * @param type [type: dmGraphics::Type] the index buffer type
+     * @param index_buffer [type: dmGraphics::HIndexBuffer] the index buffer
+     * @param indirect_buffer [type: dmGraphics::HStorageBuffer] the buffer with the draw arguments, an array of DrawElementsIndirectCommand
+     * @param offset [type: uint32_t] the byte offset of the first draw arguments in the buffer
+     * @param draw_count [type: uint32_t] number of draws
+     */
+    void VulkanDrawElementsIndirect(HContext context, PrimitiveType prim_type, Type type, HIndexBuffer index_buffer, HStorageBuffer indirect_buffer, uint32_t offset, uint32_t draw_count);
     /*#
      * Create a render pass
      * @name VulkanCreateRenderPass
@@ -259,7 +300,7 @@ namespace dmGraphics
      */
     void VulkanGetUniformBinding(HContext context, HProgram program, uint32_t index, uint32_t* set, uint32_t* binding, uint32_t* member_index);
     /*#
-     * Create a new storage buffer
+     * Create a new storage buffer. Storage buffers can also be used for the arguments of indirect draws.
      * @name HStorageBuffer
      * @param context [type: dmGraphics::HContext] the vulkan context
      * @param buffer_size [type: uint32_t] the size of the storage buffer to allocate
@@ -23,10 +23,19 @@
 #include <assert.h>
 #include <dlib/profile.h>
 #include <dlib/math.h>
+#include <dlib/memory.h>
 
 DM_PROPERTY_GROUP(rmtp_Graphics, "Graphics");
 DM_PROPERTY_U32(rmtp_DrawCalls, 0, FrameReset, "# vertices", &rmtp_Graphics);
 DM_PROPERTY_U32(rmtp_DispatchCalls, 0, FrameReset, "# dispatches", &rmtp_Graphics);
+DM_PROPERTY_U32(rmtp_GpuTime, 0, FrameReset, "us spent on the gpu (a few frames old)", &rmtp_Graphics);
+DM_PROPERTY_U32(rmtp_Instances, 0, FrameReset, "# instances drawn", &rmtp_Graphics);
+DM_PROPERTY_U32(rmtp_Triangles, 0, FrameReset, "# triangles", &rmtp_Graphics);
+DM_PROPERTY_U32(rmtp_ProgramSwitches, 0, FrameReset, "# program switches", &rmtp_Graphics);
+DM_PROPERTY_U32(rmtp_TextureBinds, 0, FrameReset, "# texture binds", &rmtp_Graphics);
+DM_PROPERTY_U32(rmtp_BufferUploads, 0, FrameReset, "bytes uploaded to buffers and textures", &rmtp_Graphics);
+DM_PROPERTY_U32(rmtp_RenderPasses, 0, FrameReset, "# render pass begins", &rmtp_Graphics);
+DM_PROPERTY_U32(rmtp_DescriptorAllocations, 0, FrameReset, "# descriptor allocations", &rmtp_Graphics);
 
 #include <dlib/log.h>
 #include <dlib/dstrings.h>
@@ -36,6 +45,12 @@ namespace dmGraphics
     static GraphicsAdapter*             g_adapter_list = 0;
     static GraphicsAdapter*             g_adapter = 0;
     static GraphicsAdapterFunctionTable g_functions;
+    static uint8_t                      g_texture_mipmap_skip = 0;
+
+    // The stats are counted in the dispatch functions below, so that they're the same for all backends
+    static FrameStats                   g_frame_stats;
+    static FrameStats                   g_last_frame_stats;
+    static HProgram                     g_current_program = 0;
 
     void RegisterGraphicsAdapter(GraphicsAdapter* adapter,
         GraphicsAdapterIsSupportedCb              is_supported_cb,
@@ -278,6 +293,7 @@ namespace dmGraphics
 
     HContext NewContext(const ContextParams& params)
     {
+        g_texture_mipmap_skip = params.m_TextureMipmapSkip;
         return g_functions.m_NewContext(params);
     }
 
@@ -886,6 +902,9 @@ namespace dmGraphics
             case STATE_POLYGON_OFFSET_FILL:
                 pipeline_state.m_PolygonOffsetFillEnabled = value;
             break;
+            case STATE_SCISSOR_TEST:
+                // The scissor rect is set separately, and isn't part of the pipeline
+            break;
             default:
                 assert(0 && "EnableState: State not supported");
             break;
@@ -1190,33 +1209,121 @@ namespace dmGraphics
     {
         g_functions.m_GetDefaultTextureFilters(context, out_min_filter, out_mag_filter);
     }
+    uint8_t GetTextureMipmapSkip(HContext context)
+    {
+        return g_texture_mipmap_skip;
+    }
     void BeginFrame(HContext context)
     {
         g_functions.m_BeginFrame(context);
     }
+    static void AddBufferUploadStat(uint32_t size)
+    {
+        g_frame_stats.m_BufferUploadBytes += size;
+        DM_PROPERTY_ADD_U32(rmtp_BufferUploads, size);
+    }
+    static void AddDrawStat(PrimitiveType prim_type, uint32_t count, uint32_t instance_count)
+    {
+        instance_count = dmMath::Max((uint32_t) 1, instance_count);
+
+        uint32_t triangles = 0;
+        if (prim_type == PRIMITIVE_TRIANGLES)
+            triangles = count / 3;
+        else if (prim_type == PRIMITIVE_TRIANGLE_STRIP && count > 2)
+            triangles = count - 2;
+        triangles *= instance_count;
+
+        g_frame_stats.m_DrawCalls++;
+        g_frame_stats.m_Instances += instance_count;
+        g_frame_stats.m_Triangles += triangles;
+        DM_PROPERTY_ADD_U32(rmtp_Instances, instance_count);
+        DM_PROPERTY_ADD_U32(rmtp_Triangles, triangles);
+    }
+    void AddRenderPassBeginStat()
+    {
+        g_frame_stats.m_RenderPassBegins++;
+        DM_PROPERTY_ADD_U32(rmtp_RenderPasses, 1);
+    }
+    void AddDescriptorAllocationStat(uint32_t count)
+    {
+        g_frame_stats.m_DescriptorAllocations += count;
+        DM_PROPERTY_ADD_U32(rmtp_DescriptorAllocations, count);
+    }
+    void GetFrameStats(HContext context, FrameStats* stats)
+    {
+        *stats = g_last_frame_stats;
+    }
+    static void SumGpuTime(void* user_data, const char* name, uint32_t depth, uint64_t start, uint64_t time)
+    {
+        if (depth == 0)
+            *(uint64_t*)user_data += time;
+    }
     void Flip(HContext context)
     {
         g_functions.m_Flip(context);
+
+        g_last_frame_stats = g_frame_stats;
+        memset(&g_frame_stats, 0, sizeof(g_frame_stats));
+
+        if (g_functions.m_IterateGpuScopes && dmProfile::IsInitialized())
+        {
+            uint64_t gpu_time = 0;
+            g_functions.m_IterateGpuScopes(context, SumGpuTime, &gpu_time);
+            DM_PROPERTY_SET_U32(rmtp_GpuTime, (uint32_t)gpu_time);
+        }
+    }
+    void BeginGpuScope(HContext context, const char* name)
+    {
+        if (g_functions.m_BeginGpuScope && dmProfile::IsInitialized())
+            g_functions.m_BeginGpuScope(context, name);
+    }
+    void EndGpuScope(HContext context)
+    {
+        if (g_functions.m_EndGpuScope && dmProfile::IsInitialized())
+            g_functions.m_EndGpuScope(context);
+    }
+    void IterateGpuScopes(HContext context, GpuScopeCallback callback, void* user_data)
+    {
+        if (g_functions.m_IterateGpuScopes)
+            g_functions.m_IterateGpuScopes(context, callback, user_data);
     }
     void Clear(HContext context, uint32_t flags, uint8_t red, uint8_t green, uint8_t blue, uint8_t alpha, float depth, uint32_t stencil)
     {
         g_functions.m_Clear(context, flags, red, green, blue, alpha, depth, stencil);
     }
+    // The buffer sizes are reported to the memory accounting, using the size the backend keeps for each buffer
+    static void TrackBufferResize(uint32_t prev_size, uint32_t size)
+    {
+        if (size > prev_size)
+            dmMemory::TrackAlloc(dmMemory::CATEGORY_GRAPHICS, size - prev_size);
+        else if (size < prev_size)
+            dmMemory::TrackFree(dmMemory::CATEGORY_GRAPHICS, prev_size - size);
+    }
     HVertexBuffer NewVertexBuffer(HContext context, uint32_t size, const void* data, BufferUsage buffer_usage)
     {
-        return g_functions.m_NewVertexBuffer(context, size, data, buffer_usage);
+        HVertexBuffer buffer = g_functions.m_NewVertexBuffer(context, size, data, buffer_usage);
+        TrackBufferResize(0, g_functions.m_GetVertexBufferSize(buffer));
+        if (data)
+            AddBufferUploadStat(size);
+        return buffer;
     }
     void DeleteVertexBuffer(HVertexBuffer buffer)
     {
+        TrackBufferResize(g_functions.m_GetVertexBufferSize(buffer), 0);
         g_functions.m_DeleteVertexBuffer(buffer);
     }
     void SetVertexBufferData(HVertexBuffer buffer, uint32_t size, const void* data, BufferUsage buffer_usage)
     {
+        uint32_t prev_size = g_functions.m_GetVertexBufferSize(buffer);
         g_functions.m_SetVertexBufferData(buffer, size, data, buffer_usage);
+        TrackBufferResize(prev_size, g_functions.m_GetVertexBufferSize(buffer));
+        if (data)
+            AddBufferUploadStat(size);
     }
     void SetVertexBufferSubData(HVertexBuffer buffer, uint32_t offset, uint32_t size, const void* data)
     {
         g_functions.m_SetVertexBufferSubData(buffer, offset, size, data);
+        AddBufferUploadStat(size);
     }
     uint32_t GetVertexBufferSize(HVertexBuffer buffer)
     {
@@ -1228,24 +1335,50 @@ namespace dmGraphics
     }
     HIndexBuffer NewIndexBuffer(HContext context, uint32_t size, const void* data, BufferUsage buffer_usage)
     {
-        return g_functions.m_NewIndexBuffer(context, size, data, buffer_usage);
+        HIndexBuffer buffer = g_functions.m_NewIndexBuffer(context, size, data, buffer_usage);
+        TrackBufferResize(0, g_functions.m_GetIndexBufferSize(buffer));
+        if (data)
+            AddBufferUploadStat(size);
+        return buffer;
     }
     void DeleteIndexBuffer(HIndexBuffer buffer)
     {
+        TrackBufferResize(g_functions.m_GetIndexBufferSize(buffer), 0);
         g_functions.m_DeleteIndexBuffer(buffer);
     }
     void SetIndexBufferData(HIndexBuffer buffer, uint32_t size, const void* data, BufferUsage buffer_usage)
     {
+        uint32_t prev_size = g_functions.m_GetIndexBufferSize(buffer);
         g_functions.m_SetIndexBufferData(buffer, size, data, buffer_usage);
+        TrackBufferResize(prev_size, g_functions.m_GetIndexBufferSize(buffer));
+        if (data)
+            AddBufferUploadStat(size);
     }
     void SetIndexBufferSubData(HIndexBuffer buffer, uint32_t offset, uint32_t size, const void* data)
     {
         g_functions.m_SetIndexBufferSubData(buffer, offset, size, data);
+        AddBufferUploadStat(size);
     }
     uint32_t GetIndexBufferSize(HIndexBuffer buffer)
     {
         return g_functions.m_GetIndexBufferSize(buffer);
     }
+    void* MapVertexBuffer(HContext context, HVertexBuffer buffer, BufferAccess access)
+    {
+        return g_functions.m_MapVertexBuffer(context, buffer, access);
+    }
+    bool UnmapVertexBuffer(HContext context, HVertexBuffer buffer)
+    {
+        return g_functions.m_UnmapVertexBuffer(context, buffer);
+    }
+    void* MapIndexBuffer(HContext context, HIndexBuffer buffer, BufferAccess access)
+    {
+        return g_functions.m_MapIndexBuffer(context, buffer, access);
+    }
+    bool UnmapIndexBuffer(HContext context, HIndexBuffer buffer)
+    {
+        return g_functions.m_UnmapIndexBuffer(context, buffer);
+    }
     bool IsIndexBufferFormatSupported(HContext context, IndexBufferFormat format)
     {
         return g_functions.m_IsIndexBufferFormatSupported(context, format);
@@ -1281,14 +1414,17 @@ namespace dmGraphics
     void DrawElements(HContext context, PrimitiveType prim_type, uint32_t first, uint32_t count, Type type, HIndexBuffer index_buffer, uint32_t instance_count)
     {
         g_functions.m_DrawElements(context, prim_type, first, count, type, index_buffer, instance_count);
+        AddDrawStat(prim_type, count, instance_count);
     }
     void Draw(HContext context, PrimitiveType prim_type, uint32_t first, uint32_t count, uint32_t instance_count)
     {
         g_functions.m_Draw(context, prim_type, first, count, instance_count);
+        AddDrawStat(prim_type, count, instance_count);
     }
     void DispatchCompute(HContext context, uint32_t group_count_x, uint32_t group_count_y, uint32_t group_count_z)
     {
         g_functions.m_DispatchCompute(context, group_count_x, group_count_y, group_count_z);
+        g_frame_stats.m_DispatchCalls++;
     }
     HVertexProgram NewVertexProgram(HContext context, ShaderDesc* ddf, char* error_buffer, uint32_t error_buffer_size)
     {
@@ -1307,6 +1443,8 @@ namespace dmGraphics
     void DeleteProgram(HContext context, HProgram program)
     {
         g_functions.m_DeleteProgram(context, program);
+        if (program == g_current_program)
+            g_current_program = 0;
     }
     bool ReloadVertexProgram(HVertexProgram prog, ShaderDesc* ddf)
     {
@@ -1337,10 +1475,17 @@ namespace dmGraphics
     void EnableProgram(HContext context, HProgram program)
     {
         g_functions.m_EnableProgram(context, program);
+        if (program != g_current_program)
+        {
+            g_current_program = program;
+            g_frame_stats.m_ProgramSwitches++;
+            DM_PROPERTY_ADD_U32(rmtp_ProgramSwitches, 1);
+        }
     }
     void DisableProgram(HContext context)
     {
         g_functions.m_DisableProgram(context);
+        g_current_program = 0;
     }
     bool ReloadProgram(HContext context, HProgram program, HVertexProgram vert_program, HFragmentProgram frag_program)
     {
@@ -1490,10 +1635,12 @@ namespace dmGraphics
     void SetTexture(HTexture texture, const TextureParams& params)
     {
         g_functions.m_SetTexture(texture, params);
+        AddBufferUploadStat(params.m_Data ? params.m_DataSize : 0);
     }
     void SetTextureAsync(HTexture texture, const TextureParams& params, SetTextureAsyncCallback callback, void* user_data)
     {
         g_functions.m_SetTextureAsync(texture, params, callback, user_data);
+        AddBufferUploadStat(params.m_Data ? params.m_DataSize : 0);
     }
     void SetTextureParams(HTexture texture, TextureFilter minfilter, TextureFilter magfilter, TextureWrap uwrap, TextureWrap vwrap, float max_anisotropy)
     {
@@ -1534,6 +1681,8 @@ namespace dmGraphics
     void EnableTexture(HContext context, uint32_t unit, uint8_t id_index, HTexture texture)
     {
         g_functions.m_EnableTexture(context, unit, id_index, texture);
+        g_frame_stats.m_TextureBinds++;
+        DM_PROPERTY_ADD_U32(rmtp_TextureBinds, 1);
     }
     void DisableTexture(HContext context, uint32_t unit, HTexture texture)
     {
@@ -1551,6 +1700,13 @@ namespace dmGraphics
     {
         g_functions.m_ReadPixels(context, buffer, buffer_size);
     }
+    bool ReadPixelsAsync(HContext context, void* buffer, uint32_t buffer_size)
+    {
+        if (g_functions.m_ReadPixelsAsync)
+            return g_functions.m_ReadPixelsAsync(context, buffer, buffer_size);
+        g_functions.m_ReadPixels(context, buffer, buffer_size);
+        return true;
+    }
     void RunApplicationLoop(void* user_data, WindowStepMethod step_method, WindowIsRunning is_running)
     {
         g_functions.m_RunApplicationLoop(user_data, step_method, is_running);
@@ -174,6 +174,7 @@ namespace dmGraphics
         CONTEXT_FEATURE_STORAGE_BUFFER         = 3,
         CONTEXT_FEATURE_VSYNC                  = 4,
         CONTEXT_FEATURE_INSTANCING             = 5,
+        CONTEXT_FEATURE_BUFFER_MAPPING         = 6,
     };
 
     // Translation table to translate RenderTargetAttachment to BufferType
@@ -276,11 +277,16 @@ namespace dmGraphics
         uint32_t              m_Height;
         uint32_t              m_GraphicsMemorySize;             // The max allowed Gfx memory (default 0)
         uint32_t              m_SwapInterval;                   // Initial VSync setting (default 1)
+        uint8_t               m_TextureMipmapSkip;              // Number of top mipmap levels to drop when loading mipmapped textures (default 0)
+        const char*           m_PipelineCachePath;              // Vulkan only, file to persist compiled pipelines to (default 0)
+        const char*           m_PipelineManifestPath;           // Vulkan only, file listing the pipelines to compile ahead of time (default 0)
+        const char*           m_ProgramCachePath;               // OpenGL only, file to persist linked program binaries to (default 0)
         uint8_t               m_VerifyGraphicsCalls : 1;
         uint8_t               m_PrintDeviceInfo : 1;
         uint8_t               m_RenderDocSupport : 1;           // Vulkan only
         uint8_t               m_UseValidationLayers : 1;        // Vulkan only
-        uint8_t               : 4;
+        uint8_t               m_RecordPipelineManifest : 1;     // Vulkan only, write the created pipelines to m_PipelineManifestPath
+        uint8_t               : 3;
     };
 
     struct PipelineState
@@ -549,6 +555,14 @@ namespace dmGraphics
      */
     void GetDefaultTextureFilters(HContext context, TextureFilter& out_min_filter, TextureFilter& out_mag_filter);
 
+    /**
+     * Return the number of top mipmap levels that texture loaders should drop
+     * from mipmapped textures, to lower the resident texture memory.
+     * @param context Graphics context handle
+     * @return Number of mipmap levels to skip
+     */
+    uint8_t GetTextureMipmapSkip(HContext context);
+
     /**
      * Begin frame rendering.
      *
@@ -599,6 +613,13 @@ namespace dmGraphics
     uint32_t GetVertexBufferSize(HVertexBuffer vertex_buffer);
     uint32_t GetIndexBufferSize(HIndexBuffer buffer);
 
+    // Buffer mapping, only available when CONTEXT_FEATURE_BUFFER_MAPPING is supported.
+    // The mapped memory covers the current size of the buffer, and is valid until the buffer is unmapped.
+    void*    MapVertexBuffer(HContext context, HVertexBuffer buffer, BufferAccess access);
+    bool     UnmapVertexBuffer(HContext context, HVertexBuffer buffer);
+    void*    MapIndexBuffer(HContext context, HIndexBuffer buffer, BufferAccess access);
+    bool     UnmapIndexBuffer(HContext context, HIndexBuffer buffer);
+
     void     DrawElements(HContext context, PrimitiveType prim_type, uint32_t first, uint32_t count, Type type, HIndexBuffer index_buffer, uint32_t instance_count);
     void     Draw(HContext context, PrimitiveType prim_type, uint32_t first, uint32_t count, uint32_t instance_count);
     void     DispatchCompute(HContext context, uint32_t group_count_x, uint32_t group_count_y, uint32_t group_count_z);
@@ -869,6 +890,13 @@ namespace dmGraphics
      */
     uint32_t GetTextureStatusFlags(HTexture texture);
 
+    /** checks if the texture format is a block compressed format
+     * @name IsTextureFormatCompressed
+     * @param format dmGraphics::TextureFormat
+     * @return true if the format is compressed
+     */
+    bool IsTextureFormatCompressed(TextureFormat format);
+
     /** checks if the texture format is compressed
      * @name IsFormatTranscoded
      * @param format dmGraphics::TextureImage::CompressionType
@@ -896,14 +924,75 @@ namespace dmGraphics
      */
     void ReadPixels(HContext context, void* buffer, uint32_t buffer_size);
 
+    /**
+     * Read frame buffer pixels in BGRA format, without waiting for the gpu.
+     * The read is queued, and the pixels of a read queued a few frames earlier are returned instead, once available.
+     * The reads still in flight when the caller stops reading are dropped.
+     * Falls back to ReadPixels() if the adapter can't read asynchronously.
+     * @param buffer buffer to read to
+     * @param buffer_size buffer size
+     * @return true if the buffer was filled with the pixels of an earlier frame
+     */
+    bool ReadPixelsAsync(HContext context, void* buffer, uint32_t buffer_size);
+
+    /**
+     * Called for each timed gpu scope, in the order they were started
+     * @param user_data The user data passed to IterateGpuScopes
+     * @param name The name passed to BeginGpuScope
+     * @param depth The nesting depth of the scope
+     * @param start Start time in microseconds, relative to the first scope of the frame
+     * @param time Elapsed time in microseconds
+     */
+    typedef void (*GpuScopeCallback)(void* user_data, const char* name, uint32_t depth, uint64_t start, uint64_t time);
+
+    /**
+     * Starts timing the gpu commands issued until the matching EndGpuScope.
+     * Scopes can be nested, and are only recorded while the profiler is running, and if the backend supports timer queries.
+     * @param context the graphics context
+     * @param name the name of the scope. Must stay valid until the results are reported, e.g. a string literal.
+     */
+    void BeginGpuScope(HContext context, const char* name);
+
+    /**
+     * Ends the current gpu scope
+     * @param context the graphics context
+     */
+    void EndGpuScope(HContext context);
+
+    /**
+     * Iterates the gpu scopes of the most recent frame that has finished on the gpu.
+     * The results lag a few frames behind, since waiting for them would stall the cpu.
+     * @param context the graphics context
+     * @param callback the callback
+     * @param user_data user data passed to the callback
+     */
+    void IterateGpuScopes(HContext context, GpuScopeCallback callback, void* user_data);
+
+    /**
+     * Number of graphics calls and state changes made during a frame
+     */
+    struct FrameStats
+    {
+        uint32_t m_DrawCalls;
+        uint32_t m_DispatchCalls;
+        uint32_t m_Instances;             // Sum of the instance counts of the draw calls
+        uint32_t m_Triangles;
+        uint32_t m_ProgramSwitches;       // Number of times a different program was enabled
+        uint32_t m_TextureBinds;
+        uint32_t m_BufferUploadBytes;     // Bytes uploaded to vertex, index and texture buffers
+        uint32_t m_RenderPassBegins;      // Render passes, or framebuffer binds on backends without render passes
+        uint32_t m_DescriptorAllocations; // Descriptor sets or bind groups, if the backend uses them
+    };
+
+    /**
+     * Gets the statistics of the last completed frame, i.e. up to the last call to Flip
+     * @param context the graphics context
+     * @param stats the statistics are written here
+     */
+    void GetFrameStats(HContext context, FrameStats* stats);
+
     uint32_t    GetTypeSize(Type type);
     const char* GetGraphicsTypeLiteral(Type type);
-
-    // Test functions:
-    void* MapVertexBuffer(HContext context, HVertexBuffer buffer, BufferAccess access);
-    bool  UnmapVertexBuffer(HContext context, HVertexBuffer buffer);
-    void* MapIndexBuffer(HContext context, HIndexBuffer buffer, BufferAccess access);
-    bool  UnmapIndexBuffer(HContext context, HIndexBuffer buffer);
 }
 
 #endif // DM_GRAPHICS_H
@@ -176,7 +176,6 @@ namespace dmGraphics
     void                 SetForceFragmentReloadFail(bool should_fail);
     void                 SetForceVertexReloadFail(bool should_fail);
     void                 SetPipelineStateValue(PipelineState& pipeline_state, State state, uint8_t value);
-    bool                 IsTextureFormatCompressed(TextureFormat format);
     bool                 IsUniformTextureSampler(ShaderDesc::ShaderDataType uniform_type);
     bool                 IsUniformStorageBuffer(ShaderDesc::ShaderDataType uniform_type);
     void                 RepackRGBToRGBA(uint32_t num_pixels, uint8_t* rgb, uint8_t* rgba);
@@ -197,6 +196,10 @@ namespace dmGraphics
     void                  ReturnSetTextureAsyncIndex(SetTextureAsyncState& state, uint16_t index);
     void                  PushSetTextureAsyncDeleteTexture(SetTextureAsyncState& state, HTexture texture);
 
+    // The counters that only the backends know about. The rest are counted in graphics.cpp
+    void                  AddRenderPassBeginStat();
+    void                  AddDescriptorAllocationStat(uint32_t count);
+
     static inline void ClearTextureParamsData(TextureParams& params)
     {
         params.m_Data     = 0x0;
@@ -189,6 +189,7 @@ namespace dmGraphics
         context->m_ContextFeatures |= 1 << CONTEXT_FEATURE_TEXTURE_ARRAY;
         context->m_ContextFeatures |= 1 << CONTEXT_FEATURE_COMPUTE_SHADER;
         context->m_ContextFeatures |= 1 << CONTEXT_FEATURE_INSTANCING;
+        context->m_ContextFeatures |= 1 << CONTEXT_FEATURE_BUFFER_MAPPING;
 
         if (context->m_AsyncProcessingSupport)
         {
@@ -1312,6 +1313,7 @@ namespace dmGraphics
             RenderTarget* rt = GetAssetFromContainer<RenderTarget>(context->m_AssetHandleContainer, render_target);
             context->m_CurrentFrameBuffer = &rt->m_FrameBuffer;
         }
+        AddRenderPassBeginStat();
     }
 
     static HTexture NullGetRenderTargetTexture(HRenderTarget render_target, BufferType buffer_type)
@@ -1993,7 +1995,7 @@ namespace dmGraphics
         return false;
     }
 
-    bool UnmapIndexBuffer(HContext context, HIndexBuffer buffer)
+    static bool NullUnmapIndexBuffer(HContext context, HIndexBuffer buffer)
     {
         IndexBuffer* ib = (IndexBuffer*)buffer;
         memcpy(ib->m_Buffer, ib->m_Copy, ib->m_Size);
@@ -2002,7 +2004,7 @@ namespace dmGraphics
         return true;
     }
 
-    void* MapVertexBuffer(HContext context, HVertexBuffer buffer, BufferAccess access)
+    static void* NullMapVertexBuffer(HContext context, HVertexBuffer buffer, BufferAccess access)
     {
         VertexBuffer* vb = (VertexBuffer*)buffer;
         vb->m_Copy = new char[vb->m_Size];
@@ -2010,7 +2012,7 @@ namespace dmGraphics
         return vb->m_Copy;
     }
 
-    bool UnmapVertexBuffer(HContext context, HVertexBuffer buffer)
+    static bool NullUnmapVertexBuffer(HContext context, HVertexBuffer buffer)
     {
         VertexBuffer* vb = (VertexBuffer*)buffer;
         memcpy(vb->m_Buffer, vb->m_Copy, vb->m_Size);
@@ -2019,7 +2021,7 @@ namespace dmGraphics
         return true;
     }
 
-    void* MapIndexBuffer(HContext context, HIndexBuffer buffer, BufferAccess access)
+    static void* NullMapIndexBuffer(HContext context, HIndexBuffer buffer, BufferAccess access)
     {
         IndexBuffer* ib = (IndexBuffer*)buffer;
         ib->m_Copy = new char[ib->m_Size];
@@ -412,6 +412,10 @@ static void LogFrameBufferError(GLenum status)
 
     static void PostDeleteTextures(OpenGLContext*, bool);
     static bool OpenGLInitialize(HContext context, const ContextParams& params);
+    static void DeleteGpuScopes(OpenGLContext* context);
+    static void DeleteReadbackBuffers(OpenGLContext* context);
+    static void LoadProgramCache(OpenGLContext* context);
+    static void DeleteProgramBinaries(OpenGLContext* context);
 
     extern GLenum TEXTURE_UNIT_NAMES[32];
 
@@ -423,6 +427,30 @@ static void LogFrameBufferError(GLenum status)
     typedef void (* DM_PFNGLDRAWBUFFERSPROC) (GLsizei n, const GLenum *bufs);
     DM_PFNGLDRAWBUFFERSPROC PFN_glDrawBuffers = NULL;
 
+    typedef void (* DM_PFNGLGENQUERIESPROC) (GLsizei n, GLuint *ids);
+    DM_PFNGLGENQUERIESPROC PFN_glGenQueries = NULL;
+
+    typedef void (* DM_PFNGLDELETEQUERIESPROC) (GLsizei n, const GLuint *ids);
+    DM_PFNGLDELETEQUERIESPROC PFN_glDeleteQueries = NULL;
+
+    typedef void (* DM_PFNGLQUERYCOUNTERPROC) (GLuint id, GLenum target);
+    DM_PFNGLQUERYCOUNTERPROC PFN_glQueryCounter = NULL;
+
+    typedef void (* DM_PFNGLGETQUERYOBJECTIVPROC) (GLuint id, GLenum pname, GLint *params);
+    DM_PFNGLGETQUERYOBJECTIVPROC PFN_glGetQueryObjectiv = NULL;
+
+    typedef void (* DM_PFNGLGETQUERYOBJECTUI64VPROC) (GLuint id, GLenum pname, uint64_t *params);
+    DM_PFNGLGETQUERYOBJECTUI64VPROC PFN_glGetQueryObjectui64v = NULL;
+
+    typedef void (* DM_PFNGLGETPROGRAMBINARYPROC) (GLuint program, GLsizei bufSize, GLsizei *length, GLenum *binaryFormat, void *binary);
+    DM_PFNGLGETPROGRAMBINARYPROC PFN_glGetProgramBinary = NULL;
+
+    typedef void (* DM_PFNGLPROGRAMBINARYPROC) (GLuint program, GLenum binaryFormat, const void *binary, GLsizei length);
+    DM_PFNGLPROGRAMBINARYPROC PFN_glProgramBinary = NULL;
+
+    typedef void (* DM_PFNGLPROGRAMPARAMETERIPROC) (GLuint program, GLenum pname, GLint value);
+    DM_PFNGLPROGRAMPARAMETERIPROC PFN_glProgramParameteri = NULL;
+
     // Note: This is necessary for webgl and android to work since we don't load core functions with emsc,
     //       however we might want to do this the other way around perhaps? i.e special case for webgl
     //       and load functions like this for all other platforms.
@@ -488,6 +516,7 @@ static void LogFrameBufferError(GLenum status)
         m_Height                  = params.m_Height;
         m_Window                  = params.m_Window;
         m_JobThread               = params.m_JobThread;
+        m_ProgramCachePath        = params.m_ProgramCachePath ? strdup(params.m_ProgramCachePath) : 0;
 
         // We need to have some sort of valid default filtering
         if (m_DefaultTextureMinFilter == TEXTURE_FILTER_DEFAULT)
@@ -670,6 +699,8 @@ static void LogFrameBufferError(GLenum status)
             dmAtomicStore32(&context->m_DeleteContextRequested, 1);
             AcquireAuxContextOnThread(context, false);
             ResetSetTextureAsyncState(context->m_SetTextureAsyncState);
+            DeleteProgramBinaries(context);
+            free(context->m_ProgramCachePath);
             delete context;
             g_Context = 0x0;
         }
@@ -733,6 +764,18 @@ static void LogFrameBufferError(GLenum status)
         return ((OpenGLContext*) context)->m_Extensions[index];
     }
 
+    // glMapBuffer is only an extension on OpenGLES 2 and not available at all in WebGL
+    static bool IsBufferMappingSupported()
+    {
+    #if defined(GL_ES_VERSION_2_0) || defined(ANDROID) || defined(__EMSCRIPTEN__)
+        return false;
+    #elif defined(_WIN32)
+        return glMapBufferARB != NULL && glUnmapBufferARB != NULL;
+    #else
+        return true;
+    #endif
+    }
+
     static bool OpenGLIsContextFeatureSupported(HContext _context, ContextFeature feature)
     {
         OpenGLContext* context = (OpenGLContext*) _context;
@@ -743,6 +786,7 @@ static void LogFrameBufferError(GLenum status)
             case CONTEXT_FEATURE_COMPUTE_SHADER:         return context->m_ComputeSupport;
             case CONTEXT_FEATURE_STORAGE_BUFFER:         return context->m_StorageBufferSupport;
             case CONTEXT_FEATURE_INSTANCING:             return context->m_InstancingSupport;
+            case CONTEXT_FEATURE_BUFFER_MAPPING:         return IsBufferMappingSupported();
         }
         return false;
     }
@@ -1128,6 +1172,28 @@ static void LogFrameBufferError(GLenum status)
 
         DMGRAPHICS_GET_PROC_ADDRESS_EXT(PFN_glInvalidateFramebuffer,   "glDiscardFramebuffer", "discard_framebuffer", "glInvalidateFramebuffer", DM_PFNGLINVALIDATEFRAMEBUFFERPROC, context);
         DMGRAPHICS_GET_PROC_ADDRESS_EXT(PFN_glDrawBuffers,             "glDrawBuffers",        "draw_buffers",        "glDrawBuffers",           DM_PFNGLDRAWBUFFERSPROC, context);
+        DMGRAPHICS_GET_PROC_ADDRESS_EXT(PFN_glGenQueries,              "glGenQueries",           "disjoint_timer_query", "glGenQueries",           DM_PFNGLGENQUERIESPROC,          context);
+        DMGRAPHICS_GET_PROC_ADDRESS_EXT(PFN_glDeleteQueries,           "glDeleteQueries",        "disjoint_timer_query", "glDeleteQueries",        DM_PFNGLDELETEQUERIESPROC,       context);
+        DMGRAPHICS_GET_PROC_ADDRESS_EXT(PFN_glQueryCounter,            "glQueryCounter",         "disjoint_timer_query", "glQueryCounter",         DM_PFNGLQUERYCOUNTERPROC,        context);
+        DMGRAPHICS_GET_PROC_ADDRESS_EXT(PFN_glGetQueryObjectiv,        "glGetQueryObjectiv",     "disjoint_timer_query", "glGetQueryObjectiv",     DM_PFNGLGETQUERYOBJECTIVPROC,    context);
+        DMGRAPHICS_GET_PROC_ADDRESS_EXT(PFN_glGetQueryObjectui64v,     "glGetQueryObjectui64v",  "disjoint_timer_query", "glGetQueryObjectui64v",  DM_PFNGLGETQUERYOBJECTUI64VPROC, context);
+
+        context->m_GpuTimerSupport = PFN_glGenQueries != 0 && PFN_glDeleteQueries != 0 && PFN_glQueryCounter != 0 &&
+                                     PFN_glGetQueryObjectiv != 0 && PFN_glGetQueryObjectui64v != 0;
+        context->m_GpuTimerDisjointSupport = OpenGLIsExtensionSupported(context, "GL_EXT_disjoint_timer_query");
+
+        DMGRAPHICS_GET_PROC_ADDRESS_EXT(PFN_glGetProgramBinary,        "glGetProgramBinary",     "get_program_binary",   "glGetProgramBinary",     DM_PFNGLGETPROGRAMBINARYPROC,    context);
+        DMGRAPHICS_GET_PROC_ADDRESS_EXT(PFN_glProgramBinary,           "glProgramBinary",        "get_program_binary",   "glProgramBinary",        DM_PFNGLPROGRAMBINARYPROC,       context);
+        DMGRAPHICS_GET_PROC_ADDRESS_EXT(PFN_glProgramParameteri,       "glProgramParameteri",    "get_program_binary",   "glProgramParameteri",    DM_PFNGLPROGRAMPARAMETERIPROC,   context);
+
+        if (context->m_ProgramCachePath && PFN_glGetProgramBinary != 0 && PFN_glProgramBinary != 0)
+        {
+            // Some drivers expose the functions, but can't save any programs
+            GLint num_formats = 0;
+            glGetIntegerv(DMGRAPHICS_NUM_PROGRAM_BINARY_FORMATS, &num_formats);
+            CLEAR_GL_ERROR;
+            context->m_ProgramBinarySupport = num_formats > 0;
+        }
     #ifdef ANDROID
         DMGRAPHICS_GET_PROC_ADDRESS_EXT(PFN_glTexSubImage3D,           "glTexSubImage3D",           "texture_array",           "glTexSubImage3D",           DM_PFNGLTEXSUBIMAGE3DPROC,           context);
         DMGRAPHICS_GET_PROC_ADDRESS_EXT(PFN_glTexImage3D,              "glTexImage3D",              "texture_array",           "glTexImage3D",              DM_PFNGLTEXIMAGE3DPROC,              context);
@@ -1409,6 +1475,11 @@ static void LogFrameBufferError(GLenum status)
             OpenGLPrintDeviceInfo(context);
         }
 
+        if (context->m_ProgramBinarySupport)
+        {
+            LoadProgramCache(context);
+        }
+
         context->m_AsyncProcessingSupport = dmThread::PlatformHasThreadSupport() && dmPlatform::GetWindowStateParam(context->m_Window, dmPlatform::WINDOW_STATE_AUX_CONTEXT);
         if (context->m_AsyncProcessingSupport)
         {
@@ -1455,6 +1526,11 @@ static void LogFrameBufferError(GLenum status)
         if (dmPlatform::GetWindowStateParam(context->m_Window, dmPlatform::WINDOW_STATE_OPENED))
         {
             PostDeleteTextures(context, true);
+            if (context->m_GpuTimerSupport)
+            {
+                DeleteGpuScopes(context);
+            }
+            DeleteReadbackBuffers(context);
 
             context->m_Width = 0;
             context->m_Height = 0;
@@ -1558,11 +1634,196 @@ static void LogFrameBufferError(GLenum status)
         CHECK_GL_ERROR
     }
 
+    static void InvalidateStateCache(OpenGLContext* context)
+    {
+        OpenGLStateCache& cache = context->m_StateCache;
+        for (uint32_t i = 0; i < MAX_CACHED_VERTEX_ATTRIBUTES; ++i)
+        {
+            OpenGLVertexAttributeState& attribute = cache.m_VertexAttributes[i];
+            attribute.m_PointerValid = 0;
+            attribute.m_Known        = 0;
+        }
+        cache.m_Program            = INVALID_GL_NAME;
+        cache.m_ArrayBuffer        = INVALID_GL_NAME;
+        cache.m_ElementArrayBuffer = INVALID_GL_NAME;
+        cache.m_ActiveTextureUnit  = 0;
+        cache.m_KnownStates        = 0;
+    }
+
     static void OpenGLBeginFrame(HContext context)
     {
 #if defined(ANDROID)
         dmPlatform::AndroidBeginFrame(((OpenGLContext*) context)->m_Window);
 #endif
+        InvalidateStateCache((OpenGLContext*) context);
+    }
+
+    static GLuint AllocGpuTimerQuery(OpenGLGpuTimer& timer)
+    {
+        if (timer.m_FreeQueries.Empty())
+        {
+            const uint32_t count = 32;
+            GLuint queries[count];
+            PFN_glGenQueries(count, queries);
+            CHECK_GL_ERROR;
+            if (timer.m_FreeQueries.Remaining() < count)
+                timer.m_FreeQueries.OffsetCapacity(count);
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                timer.m_FreeQueries.Push(queries[i]);
+            }
+        }
+        GLuint query = timer.m_FreeQueries.Back();
+        timer.m_FreeQueries.Pop();
+        return query;
+    }
+
+    static void OpenGLBeginGpuScope(HContext _context, const char* name)
+    {
+        OpenGLContext* context = (OpenGLContext*) _context;
+        if (!context->m_GpuTimerSupport)
+            return;
+
+        OpenGLGpuTimer& timer = context->m_GpuTimer;
+        dmArray<OpenGLGpuScope>& scopes = timer.m_Frames[timer.m_Frame % GPU_TIMER_FRAME_COUNT];
+
+        if (timer.m_Stack.Full())
+            timer.m_Stack.OffsetCapacity(16);
+
+        // Keep the stack balanced, even if we don't record the scope
+        if (scopes.Size() >= MAX_GPU_SCOPES_PER_FRAME)
+        {
+            timer.m_Stack.Push(INVALID_GPU_SCOPE);
+            return;
+        }
+
+        OpenGLGpuScope scope;
+        scope.m_Name       = name;
+        scope.m_Depth      = timer.m_Stack.Size();
+        scope.m_Queries[0] = AllocGpuTimerQuery(timer);
+        scope.m_Queries[1] = AllocGpuTimerQuery(timer);
+
+        PFN_glQueryCounter(scope.m_Queries[0], DMGRAPHICS_TIMESTAMP);
+        CHECK_GL_ERROR;
+
+        if (scopes.Full())
+            scopes.OffsetCapacity(32);
+        timer.m_Stack.Push(scopes.Size());
+        scopes.Push(scope);
+    }
+
+    static void OpenGLEndGpuScope(HContext _context)
+    {
+        OpenGLContext* context = (OpenGLContext*) _context;
+        OpenGLGpuTimer& timer = context->m_GpuTimer;
+        if (!context->m_GpuTimerSupport || timer.m_Stack.Empty())
+            return;
+
+        uint32_t index = timer.m_Stack.Back();
+        timer.m_Stack.Pop();
+        if (index == INVALID_GPU_SCOPE)
+            return;
+
+        dmArray<OpenGLGpuScope>& scopes = timer.m_Frames[timer.m_Frame % GPU_TIMER_FRAME_COUNT];
+        PFN_glQueryCounter(scopes[index].m_Queries[1], DMGRAPHICS_TIMESTAMP);
+        CHECK_GL_ERROR;
+    }
+
+    static void OpenGLIterateGpuScopes(HContext _context, GpuScopeCallback callback, void* user_data)
+    {
+        OpenGLContext* context = (OpenGLContext*) _context;
+        const dmArray<OpenGLGpuScopeResult>& results = context->m_GpuTimer.m_Results;
+        for (uint32_t i = 0; i < results.Size(); ++i)
+        {
+            const OpenGLGpuScopeResult& result = results[i];
+            callback(user_data, result.m_Name, result.m_Depth, result.m_Start, result.m_Time);
+        }
+    }
+
+    // Moves on to the next frame, and reads back the oldest frame if the gpu is done with it.
+    // If it isn't, that frame is skipped rather than stalling on the results.
+    static void ResolveGpuScopes(OpenGLContext* context)
+    {
+        OpenGLGpuTimer& timer = context->m_GpuTimer;
+        while (!timer.m_Stack.Empty())
+        {
+            OpenGLEndGpuScope(context);
+        }
+
+        timer.m_Frame++;
+        dmArray<OpenGLGpuScope>& scopes = timer.m_Frames[timer.m_Frame % GPU_TIMER_FRAME_COUNT];
+        if (scopes.Empty())
+            return;
+
+        // The queries finish in order, so it's enough to check the last one
+        GLint available = 0;
+        PFN_glGetQueryObjectiv(scopes.Back().m_Queries[1], DMGRAPHICS_QUERY_RESULT_AVAILABLE, &available);
+        CHECK_GL_ERROR;
+
+        // E.g. the gpu clock changed, which invalidates all pending timestamps
+        GLint disjoint = 0;
+        if (context->m_GpuTimerDisjointSupport)
+        {
+            glGetIntegerv(DMGRAPHICS_GPU_DISJOINT, &disjoint);
+            CHECK_GL_ERROR;
+        }
+
+        if (available && !disjoint)
+        {
+            timer.m_Results.SetSize(0);
+            if (timer.m_Results.Capacity() < scopes.Size())
+                timer.m_Results.SetCapacity(scopes.Size());
+
+            uint64_t frame_start = 0;
+            for (uint32_t i = 0; i < scopes.Size(); ++i)
+            {
+                uint64_t start = 0;
+                uint64_t end = 0;
+                PFN_glGetQueryObjectui64v(scopes[i].m_Queries[0], DMGRAPHICS_QUERY_RESULT, &start);
+                PFN_glGetQueryObjectui64v(scopes[i].m_Queries[1], DMGRAPHICS_QUERY_RESULT, &end);
+                CHECK_GL_ERROR;
+                if (i == 0)
+                    frame_start = start;
+
+                // Timestamps are in nanoseconds
+                OpenGLGpuScopeResult result;
+                result.m_Name  = scopes[i].m_Name;
+                result.m_Depth = scopes[i].m_Depth;
+                result.m_Start = start > frame_start ? (start - frame_start) / 1000 : 0;
+                result.m_Time  = end > start ? (end - start) / 1000 : 0;
+                timer.m_Results.Push(result);
+            }
+        }
+
+        if (timer.m_FreeQueries.Remaining() < scopes.Size() * 2)
+            timer.m_FreeQueries.OffsetCapacity(scopes.Size() * 2 - timer.m_FreeQueries.Remaining());
+        for (uint32_t i = 0; i < scopes.Size(); ++i)
+        {
+            timer.m_FreeQueries.Push(scopes[i].m_Queries[0]);
+            timer.m_FreeQueries.Push(scopes[i].m_Queries[1]);
+        }
+        scopes.SetSize(0);
+    }
+
+    static void DeleteGpuScopes(OpenGLContext* context)
+    {
+        OpenGLGpuTimer& timer = context->m_GpuTimer;
+        for (uint32_t f = 0; f < GPU_TIMER_FRAME_COUNT; ++f)
+        {
+            dmArray<OpenGLGpuScope>& scopes = timer.m_Frames[f];
+            for (uint32_t i = 0; i < scopes.Size(); ++i)
+            {
+                PFN_glDeleteQueries(2, scopes[i].m_Queries);
+            }
+            scopes.SetSize(0);
+        }
+        if (!timer.m_FreeQueries.Empty())
+        {
+            PFN_glDeleteQueries(timer.m_FreeQueries.Size(), timer.m_FreeQueries.Begin());
+        }
+        timer.m_FreeQueries.SetSize(0);
+        timer.m_Stack.SetSize(0);
+        timer.m_Results.SetSize(0);
     }
 
     static void OpenGLFlip(HContext _context)
@@ -1570,10 +1831,55 @@ static void LogFrameBufferError(GLenum status)
         DM_PROFILE(__FUNCTION__);
         OpenGLContext* context = (OpenGLContext*) _context;
         PostDeleteTextures(context, false);
+        if (context->m_GpuTimerSupport)
+        {
+            ResolveGpuScopes(context);
+        }
         dmPlatform::SwapBuffers(context->m_Window);
         CHECK_GL_ERROR;
     }
 
+    static inline void BindArrayBuffer(OpenGLContext* context, GLuint buffer)
+    {
+        if (context->m_StateCache.m_ArrayBuffer != buffer)
+        {
+            glBindBufferARB(GL_ARRAY_BUFFER_ARB, buffer);
+            CHECK_GL_ERROR;
+            context->m_StateCache.m_ArrayBuffer = buffer;
+        }
+    }
+
+    static inline void BindElementArrayBuffer(OpenGLContext* context, GLuint buffer)
+    {
+        if (context->m_StateCache.m_ElementArrayBuffer != buffer)
+        {
+            glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB, buffer);
+            CHECK_GL_ERROR;
+            context->m_StateCache.m_ElementArrayBuffer = buffer;
+        }
+    }
+
+    // Deleting a buffer resets all bindings to it in the current context
+    static void InvalidateBufferBindings(OpenGLContext* context, GLuint buffer)
+    {
+        OpenGLStateCache& cache = context->m_StateCache;
+        if (cache.m_ArrayBuffer == buffer)
+        {
+            cache.m_ArrayBuffer = INVALID_GL_NAME;
+        }
+        if (cache.m_ElementArrayBuffer == buffer)
+        {
+            cache.m_ElementArrayBuffer = INVALID_GL_NAME;
+        }
+        for (uint32_t i = 0; i < MAX_CACHED_VERTEX_ATTRIBUTES; ++i)
+        {
+            if (cache.m_VertexAttributes[i].m_Buffer == buffer)
+            {
+                cache.m_VertexAttributes[i].m_PointerValid = 0;
+            }
+        }
+    }
+
     static GLenum GetOpenGLBufferUsage(BufferUsage buffer_usage)
     {
         const GLenum buffer_usage_lut[] = {
@@ -1610,6 +1916,7 @@ static void LogFrameBufferError(GLenum status)
         OpenGLBuffer* vertex_buffer = (OpenGLBuffer*) buffer;
         glDeleteBuffersARB(1, &vertex_buffer->m_Id);
         CHECK_GL_ERROR;
+        InvalidateBufferBindings(g_Context, vertex_buffer->m_Id);
         delete vertex_buffer;
     }
 
@@ -1623,12 +1930,9 @@ static void LogFrameBufferError(GLenum status)
         }
         OpenGLBuffer* vertex_buffer = (OpenGLBuffer*) buffer;
         vertex_buffer->m_MemorySize = size;
-        glBindBufferARB(GL_ARRAY_BUFFER_ARB, vertex_buffer->m_Id);
-        CHECK_GL_ERROR
+        BindArrayBuffer(g_Context, vertex_buffer->m_Id);
         glBufferDataARB(GL_ARRAY_BUFFER_ARB, size, data, GetOpenGLBufferUsage(buffer_usage));
         CHECK_GL_ERROR
-        glBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
-        CHECK_GL_ERROR;
     }
 
     static void OpenGLSetVertexBufferSubData(HVertexBuffer buffer, uint32_t offset, uint32_t size, const void* data)
@@ -1639,12 +1943,9 @@ static void LogFrameBufferError(GLenum status)
             return;
         }
         OpenGLBuffer* vertex_buffer = (OpenGLBuffer*) buffer;
-        glBindBufferARB(GL_ARRAY_BUFFER_ARB, vertex_buffer->m_Id);
-        CHECK_GL_ERROR;
+        BindArrayBuffer(g_Context, vertex_buffer->m_Id);
         glBufferSubDataARB(GL_ARRAY_BUFFER_ARB, offset, size, data);
         CHECK_GL_ERROR;
-        glBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
-        CHECK_GL_ERROR;
     }
 
     static uint32_t OpenGLGetVertexBufferSize(HVertexBuffer buffer)
@@ -1674,12 +1975,9 @@ static void LogFrameBufferError(GLenum status)
         OpenGLBuffer* index_buffer = (OpenGLBuffer*) buffer;
         index_buffer->m_MemorySize = size;
 
-        glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB, index_buffer->m_Id);
-        CHECK_GL_ERROR
+        BindElementArrayBuffer(g_Context, index_buffer->m_Id);
         glBufferDataARB(GL_ELEMENT_ARRAY_BUFFER_ARB, size, data, GetOpenGLBufferUsage(buffer_usage));
         CHECK_GL_ERROR
-        glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB, 0);
-        CHECK_GL_ERROR
     }
 
     static HIndexBuffer OpenGLNewIndexBuffer(HContext context, uint32_t size, const void* data, BufferUsage buffer_usage)
@@ -1702,6 +2000,7 @@ static void LogFrameBufferError(GLenum status)
         OpenGLBuffer* index_buffer = (OpenGLBuffer*) buffer;
         glDeleteBuffersARB(1, &index_buffer->m_Id);
         CHECK_GL_ERROR;
+        InvalidateBufferBindings(g_Context, index_buffer->m_Id);
         delete index_buffer;
     }
 
@@ -1713,12 +2012,9 @@ static void LogFrameBufferError(GLenum status)
         }
         DM_PROFILE(__FUNCTION__);
         OpenGLBuffer* index_buffer = (OpenGLBuffer*) buffer;
-        glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB, index_buffer->m_Id);
-        CHECK_GL_ERROR;
+        BindElementArrayBuffer(g_Context, index_buffer->m_Id);
         glBufferSubDataARB(GL_ELEMENT_ARRAY_BUFFER_ARB, offset, size, data);
         CHECK_GL_ERROR;
-        glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB, 0);
-        CHECK_GL_ERROR;
     }
 
     static uint32_t OpenGLGetIndexBufferSize(HIndexBuffer buffer)
@@ -1731,6 +2027,71 @@ static void LogFrameBufferError(GLenum status)
         return index_buffer->m_MemorySize;
     }
 
+    static void* OpenGLMapBuffer(GLenum target, OpenGLBuffer* buffer, BufferAccess access)
+    {
+    #if defined(GL_ES_VERSION_2_0) || defined(ANDROID) || defined(__EMSCRIPTEN__)
+        return 0;
+    #else
+        GLenum gl_access = DMGRAPHICS_READ_WRITE;
+        if (access == BUFFER_ACCESS_READ_ONLY)
+            gl_access = DMGRAPHICS_READ_ONLY;
+        else if (access == BUFFER_ACCESS_WRITE_ONLY)
+            gl_access = DMGRAPHICS_WRITE_ONLY;
+
+        if (!buffer || !IsBufferMappingSupported())
+        {
+            return 0;
+        }
+        if (target == GL_ARRAY_BUFFER_ARB)
+            BindArrayBuffer(g_Context, buffer->m_Id);
+        else
+            BindElementArrayBuffer(g_Context, buffer->m_Id);
+        void* ptr = glMapBufferARB(target, gl_access);
+        CHECK_GL_ERROR;
+        return ptr;
+    #endif
+    }
+
+    static bool OpenGLUnmapBuffer(GLenum target, OpenGLBuffer* buffer)
+    {
+    #if defined(GL_ES_VERSION_2_0) || defined(ANDROID) || defined(__EMSCRIPTEN__)
+        return false;
+    #else
+        if (!buffer || !IsBufferMappingSupported())
+        {
+            return false;
+        }
+        if (target == GL_ARRAY_BUFFER_ARB)
+            BindArrayBuffer(g_Context, buffer->m_Id);
+        else
+            BindElementArrayBuffer(g_Context, buffer->m_Id);
+        // The contents can become undefined (e.g after a display mode change), in which case the data has to be written again
+        bool result = glUnmapBufferARB(target) == GL_TRUE;
+        CHECK_GL_ERROR;
+        return result;
+    #endif
+    }
+
+    static void* OpenGLMapVertexBuffer(HContext context, HVertexBuffer buffer, BufferAccess access)
+    {
+        return OpenGLMapBuffer(GL_ARRAY_BUFFER_ARB, (OpenGLBuffer*) buffer, access);
+    }
+
+    static bool OpenGLUnmapVertexBuffer(HContext context, HVertexBuffer buffer)
+    {
+        return OpenGLUnmapBuffer(GL_ARRAY_BUFFER_ARB, (OpenGLBuffer*) buffer);
+    }
+
+    static void* OpenGLMapIndexBuffer(HContext context, HIndexBuffer buffer, BufferAccess access)
+    {
+        return OpenGLMapBuffer(GL_ELEMENT_ARRAY_BUFFER_ARB, (OpenGLBuffer*) buffer, access);
+    }
+
+    static bool OpenGLUnmapIndexBuffer(HContext context, HIndexBuffer buffer)
+    {
+        return OpenGLUnmapBuffer(GL_ELEMENT_ARRAY_BUFFER_ARB, (OpenGLBuffer*) buffer);
+    }
+
     static bool OpenGLIsIndexBufferFormatSupported(HContext context, IndexBufferFormat format)
     {
         return (((OpenGLContext*) context)->m_IndexBufferFormatSupport & (1 << format)) != 0;
@@ -1808,8 +2169,7 @@ static void LogFrameBufferError(GLenum status)
     static void OpenGLEnableVertexBuffer(HContext context, HVertexBuffer buffer, uint32_t binding_index)
     {
         OpenGLBuffer* vertex_buffer = (OpenGLBuffer*) buffer;
-        glBindBufferARB(GL_ARRAY_BUFFER, vertex_buffer->m_Id);
-        CHECK_GL_ERROR;
+        BindArrayBuffer((OpenGLContext*) context, vertex_buffer->m_Id);
     }
 
     static void OpenGLDisableVertexBuffer(HContext context, HVertexBuffer vertex_buffer)
@@ -1831,9 +2191,46 @@ static void LogFrameBufferError(GLenum status)
         dmLogInfo("Attribute: %d, %d, %d, %d, %d, %d", loc, component_count, opengl_type, normalize, stride, offset);
     #endif
 
-        // TODO: We should cache these bindings and skip applying them if they haven't changed
-        glEnableVertexAttribArray(loc);
-        CHECK_GL_ERROR;
+        if ((uint32_t) loc < MAX_CACHED_VERTEX_ATTRIBUTES)
+        {
+            OpenGLVertexAttributeState& attribute = context->m_StateCache.m_VertexAttributes[loc];
+            attribute.m_Required = 1;
+
+            if (!attribute.m_Known || !attribute.m_Enabled)
+            {
+                glEnableVertexAttribArray(loc);
+                CHECK_GL_ERROR;
+                attribute.m_Known   = 1;
+                attribute.m_Enabled = 1;
+            }
+
+            uint32_t divisor = context->m_InstancingSupport ? (uint32_t) step_function : 0;
+            if (attribute.m_PointerValid &&
+                attribute.m_Buffer         == context->m_StateCache.m_ArrayBuffer &&
+                attribute.m_Offset         == offset &&
+                attribute.m_Stride         == stride &&
+                attribute.m_Divisor        == divisor &&
+                attribute.m_Type           == opengl_type &&
+                attribute.m_ComponentCount == component_count &&
+                attribute.m_Normalize      == (uint8_t) normalize)
+            {
+                return;
+            }
+
+            attribute.m_Buffer         = context->m_StateCache.m_ArrayBuffer;
+            attribute.m_Offset         = offset;
+            attribute.m_Stride         = stride;
+            attribute.m_Divisor        = divisor;
+            attribute.m_Type           = opengl_type;
+            attribute.m_ComponentCount = component_count;
+            attribute.m_Normalize      = normalize;
+            attribute.m_PointerValid   = attribute.m_Buffer != INVALID_GL_NAME;
+        }
+        else
+        {
+            glEnableVertexAttribArray(loc);
+            CHECK_GL_ERROR;
+        }
 
         glVertexAttribPointer(
             loc,
@@ -1902,23 +2299,43 @@ static void LogFrameBufferError(GLenum status)
 
                 for (int j = 0; j < sub_vector_count; ++j)
                 {
-                    glDisableVertexAttribArray(base_location + j);
-                    CHECK_GL_ERROR;
+                    // Cached attributes are disabled lazily in DrawSetup, if the next draw call doesn't use them
+                    uint32_t location = base_location + j;
+                    if (location < MAX_CACHED_VERTEX_ATTRIBUTES)
+                    {
+                        ((OpenGLContext*) context)->m_StateCache.m_VertexAttributes[location].m_Required = 0;
+                    }
+                    else
+                    {
+                        glDisableVertexAttribArray(location);
+                        CHECK_GL_ERROR;
+                    }
                 }
             }
         }
+    }
 
-        glBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
-        CHECK_GL_ERROR;
-
-        glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB, 0);
-        CHECK_GL_ERROR;
+    static void DisableUnusedVertexAttributes(OpenGLContext* context)
+    {
+        for (uint32_t i = 0; i < MAX_CACHED_VERTEX_ATTRIBUTES; ++i)
+        {
+            OpenGLVertexAttributeState& attribute = context->m_StateCache.m_VertexAttributes[i];
+            if (!attribute.m_Required && (!attribute.m_Known || attribute.m_Enabled))
+            {
+                glDisableVertexAttribArray(i);
+                CHECK_GL_ERROR;
+                attribute.m_Known   = 1;
+                attribute.m_Enabled = 0;
+            }
+        }
     }
 
     static void DrawSetup(OpenGLContext* context)
     {
         OpenGLProgram* program = context->m_CurrentProgram;
 
+        DisableUnusedVertexAttributes(context);
+
         if (context->m_IsGles3Version)
         {
             for (int i = 0; i < program->m_UniformBuffers.Size(); ++i)
@@ -1954,8 +2371,7 @@ static void LogFrameBufferError(GLenum status)
 
         OpenGLBuffer* index_buffer = (OpenGLBuffer*) buffer;
 
-        glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER, index_buffer->m_Id);
-        CHECK_GL_ERROR;
+        BindElementArrayBuffer((OpenGLContext*) context, index_buffer->m_Id);
 
         OpenGLContext* context_ptr = (OpenGLContext*) context;
         if (context_ptr->m_InstancingSupport)
@@ -2083,6 +2499,7 @@ static void LogFrameBufferError(GLenum status)
         OpenGLShader* shader = new OpenGLShader();
         shader->m_Id         = shader_id;
         shader->m_Language   = ddf_shader->m_Language;
+        shader->m_SourceHash = dmHashBuffer64(ddf_shader->m_Source.m_Data, ddf_shader->m_Source.m_Count);
 
         CreateShaderMeta(&ddf->m_Reflection, &shader->m_ShaderMeta);
 
@@ -2317,6 +2734,77 @@ static void LogFrameBufferError(GLenum status)
                 CLEAR_GL_ERROR
             }
         }
+
+        // Reserve room for the last uploaded value of each uniform that isn't part of a uniform block
+        uint32_t uniform_values_size = 0;
+        for (int i = 0; i < num_uniforms; ++i)
+        {
+            OpenGLUniform& uniform = program->m_Uniforms[i];
+            uniform.m_ValueOffset  = uniform_values_size;
+            uniform.m_ValueSize    = 0;
+            uniform.m_ValueCached  = 0;
+
+            if (uniform.m_Location == INVALID_UNIFORM_LOCATION || UNIFORM_LOCATION_GET_FS(uniform.m_Location))
+            {
+                continue;
+            }
+
+            if (uniform.m_IsTextureType)
+            {
+                uniform.m_ValueSize = sizeof(int32_t);
+            }
+            else
+            {
+                uniform.m_ValueSize = uniform.m_Count * (uniform.m_Type == GL_FLOAT_MAT4 ? sizeof(Vector4) * 4 : sizeof(Vector4));
+            }
+            uniform_values_size += uniform.m_ValueSize;
+        }
+
+        program->m_UniformValues.SetCapacity(uniform_values_size);
+        program->m_UniformValues.SetSize(uniform_values_size);
+    }
+
+    static void InvalidateUniformValues(OpenGLProgram* program)
+    {
+        for (uint32_t i = 0; i < program->m_Uniforms.Size(); ++i)
+        {
+            program->m_Uniforms[i].m_ValueCached = 0;
+        }
+    }
+
+    // Returns true if the uniform already holds the data, otherwise the data is stored as its new value
+    static bool IsUniformValueUnchanged(OpenGLProgram* program, HUniformLocation location, const void* data, uint32_t size)
+    {
+        if (!program)
+        {
+            return false;
+        }
+
+        for (uint32_t i = 0; i < program->m_Uniforms.Size(); ++i)
+        {
+            OpenGLUniform& uniform = program->m_Uniforms[i];
+            if (uniform.m_Location != location)
+            {
+                continue;
+            }
+
+            if (size > uniform.m_ValueSize)
+            {
+                return false;
+            }
+
+            uint8_t* value = program->m_UniformValues.Begin() + uniform.m_ValueOffset;
+            if (uniform.m_ValueCached && memcmp(value, data, size) == 0)
+            {
+                return true;
+            }
+
+            memcpy(value, data, size);
+            // A partial upload only tells us the full value if it was already known
+            uniform.m_ValueCached = uniform.m_ValueCached || size == uniform.m_ValueSize;
+            return false;
+        }
+        return false;
     }
 
     static inline void IncreaseModificationVersion(OpenGLContext* context)
@@ -2325,6 +2813,214 @@ static void LogFrameBufferError(GLenum status)
         context->m_ModificationVersion = dmMath::Max(0U, context->m_ModificationVersion);
     }
 
+    // The program cache file holds the binaries of the programs linked by previous sessions.
+    // Each program that isn't found is appended when it's linked, so that nothing is lost if the app is killed.
+    static const uint32_t PROGRAM_CACHE_MAGIC   = 0x50474C44; // "DLGP"
+    static const uint32_t PROGRAM_CACHE_VERSION = 1;
+
+    struct ProgramCacheHeader
+    {
+        uint32_t m_Magic;
+        uint32_t m_Version;
+        uint64_t m_DriverHash;
+    };
+
+    struct ProgramCacheEntry
+    {
+        uint64_t m_Key;
+        uint32_t m_Format;
+        uint32_t m_Size;
+    };
+
+    // The binaries are only valid for the driver that created them
+    static uint64_t GetProgramCacheDriverHash()
+    {
+        HashState64 state;
+        dmHashInit64(&state, false);
+        const GLenum names[] = { GL_VENDOR, GL_RENDERER, GL_VERSION };
+        for (uint32_t i = 0; i < DM_ARRAY_SIZE(names); ++i)
+        {
+            const char* str = (const char*) glGetString(names[i]);
+            if (str)
+            {
+                dmHashUpdateBuffer64(&state, str, strlen(str));
+            }
+        }
+        return dmHashFinal64(&state);
+    }
+
+    static void PutProgramBinary(OpenGLContext* context, uint64_t key, uint32_t format, uint8_t* data, uint32_t size)
+    {
+        OpenGLProgramBinary* existing = context->m_ProgramBinaries.Get(key);
+        if (existing)
+        {
+            free(existing->m_Data);
+        }
+        else if (context->m_ProgramBinaries.Full())
+        {
+            uint32_t capacity = context->m_ProgramBinaries.Capacity() + 64;
+            context->m_ProgramBinaries.SetCapacity(capacity / 2 + 1, capacity);
+        }
+
+        OpenGLProgramBinary binary;
+        binary.m_Data   = data;
+        binary.m_Size   = size;
+        binary.m_Format = format;
+        context->m_ProgramBinaries.Put(key, binary);
+    }
+
+    static void LoadProgramCache(OpenGLContext* context)
+    {
+        DM_PROFILE(__FUNCTION__);
+
+        ProgramCacheHeader expected_header;
+        expected_header.m_Magic      = PROGRAM_CACHE_MAGIC;
+        expected_header.m_Version    = PROGRAM_CACHE_VERSION;
+        expected_header.m_DriverHash = GetProgramCacheDriverHash();
+
+        FILE* file = fopen(context->m_ProgramCachePath, "rb");
+        if (file)
+        {
+            fseek(file, 0, SEEK_END);
+            long file_size = ftell(file);
+            fseek(file, 0, SEEK_SET);
+
+            ProgramCacheHeader header;
+            if (fread(&header, 1, sizeof(header), file) == sizeof(header) && memcmp(&header, &expected_header, sizeof(header)) == 0)
+            {
+                // A partially written entry at the end is ignored, and overwritten by the next program that is appended
+                ProgramCacheEntry entry;
+                long valid_size = (long) sizeof(header);
+                while (fread(&entry, 1, sizeof(entry), file) == sizeof(entry))
+                {
+                    if ((long) entry.m_Size > file_size - valid_size - (long) sizeof(entry))
+                    {
+                        break;
+                    }
+
+                    uint8_t* data = (uint8_t*) malloc(entry.m_Size);
+                    if (!data || fread(data, 1, entry.m_Size, file) != entry.m_Size)
+                    {
+                        free(data);
+                        break;
+                    }
+                    PutProgramBinary(context, entry.m_Key, entry.m_Format, data, entry.m_Size);
+                    valid_size += (long) (sizeof(entry) + entry.m_Size);
+                }
+                fclose(file);
+
+                file = fopen(context->m_ProgramCachePath, "r+b");
+                if (file && fseek(file, valid_size, SEEK_SET) == 0)
+                {
+                    // Keep the file open, so that the programs we link are appended
+                    context->m_ProgramCacheFile = file;
+                    return;
+                }
+            }
+            else
+            {
+                dmLogInfo("Discarding OpenGL program cache, it was created by a different driver");
+            }
+
+            if (file)
+            {
+                fclose(file);
+            }
+            DeleteProgramBinaries(context);
+        }
+
+        file = fopen(context->m_ProgramCachePath, "wb");
+        if (!file || fwrite(&expected_header, 1, sizeof(expected_header), file) != sizeof(expected_header))
+        {
+            dmLogWarning("Could not write the OpenGL program cache to '%s'", context->m_ProgramCachePath);
+            if (file)
+            {
+                fclose(file);
+            }
+            context->m_ProgramBinarySupport = 0;
+            return;
+        }
+        context->m_ProgramCacheFile = file;
+    }
+
+    static void DeleteProgramBinaries(OpenGLContext* context)
+    {
+        dmHashTable64<OpenGLProgramBinary>::Iterator iter = context->m_ProgramBinaries.GetIterator();
+        while (iter.Next())
+        {
+            free(iter.GetValue().m_Data);
+        }
+        context->m_ProgramBinaries.Clear();
+
+        if (context->m_ProgramCacheFile)
+        {
+            fclose(context->m_ProgramCacheFile);
+            context->m_ProgramCacheFile = 0;
+        }
+    }
+
+    static uint64_t GetProgramBinaryKey(OpenGLShader** shaders, uint32_t num_shaders)
+    {
+        HashState64 state;
+        dmHashInit64(&state, false);
+        for (uint32_t i = 0; i < num_shaders; ++i)
+        {
+            dmHashUpdateBuffer64(&state, &shaders[i]->m_SourceHash, sizeof(shaders[i]->m_SourceHash));
+        }
+        return dmHashFinal64(&state);
+    }
+
+    // Returns true if the program was created from the cached binary
+    static bool LoadProgramBinary(GLuint program, const OpenGLProgramBinary* binary)
+    {
+        PFN_glProgramBinary(program, binary->m_Format, binary->m_Data, binary->m_Size);
+        CLEAR_GL_ERROR;
+
+        // The driver may still reject it, e.g. after an update that didn't change the version string
+        GLint status = 0;
+        glGetProgramiv(program, GL_LINK_STATUS, &status);
+        return status != 0;
+    }
+
+    static void SaveProgramBinary(OpenGLContext* context, GLuint program, uint64_t key)
+    {
+        GLint size = 0;
+        glGetProgramiv(program, DMGRAPHICS_PROGRAM_BINARY_LENGTH, &size);
+        CLEAR_GL_ERROR;
+        if (size <= 0)
+        {
+            return;
+        }
+
+        uint8_t* data = (uint8_t*) malloc(size);
+        GLenum format = 0;
+        GLsizei length = 0;
+        PFN_glGetProgramBinary(program, size, &length, &format, data);
+        CLEAR_GL_ERROR;
+        if (length <= 0)
+        {
+            free(data);
+            return;
+        }
+
+        ProgramCacheEntry entry;
+        entry.m_Key    = key;
+        entry.m_Format = format;
+        entry.m_Size   = (uint32_t) length;
+
+        FILE* file = context->m_ProgramCacheFile;
+        if (file && (fwrite(&entry, 1, sizeof(entry), file) != sizeof(entry) ||
+                     fwrite(data, 1, entry.m_Size, file) != entry.m_Size ||
+                     fflush(file) != 0))
+        {
+            dmLogWarning("Could not write the OpenGL program cache to '%s'", context->m_ProgramCachePath);
+            fclose(file);
+            context->m_ProgramCacheFile = 0;
+        }
+
+        PutProgramBinary(context, key, format, data, entry.m_Size);
+    }
+
     static bool LinkProgram(GLuint program)
     {
         glLinkProgram(program);
@@ -2387,6 +3083,26 @@ static void LogFrameBufferError(GLenum status)
     #endif
     }
 
+    static void AttachGraphicsShaders(GLuint program, OpenGLShader* vertex_shader, OpenGLShader* fragment_shader)
+    {
+        glAttachShader(program, vertex_shader->m_Id);
+        CHECK_GL_ERROR;
+        glAttachShader(program, fragment_shader->m_Id);
+        CHECK_GL_ERROR;
+
+        // For MRT bindings to work correctly on all platforms,
+        // we need to specify output locations manually
+#ifndef GL_ES_VERSION_2_0
+        const char* base_output_name = "_DMENGINE_GENERATED_gl_FragColor";
+        char buf[64] = {0};
+        for (int i = 0; i < MAX_BUFFER_COLOR_ATTACHMENTS; ++i)
+        {
+            snprintf(buf, sizeof(buf), "%s_%d", base_output_name, i);
+            glBindFragDataLocation(program, i, buf);
+        }
+#endif
+    }
+
     // TODO: Rename to graphicsprogram instead of newprogram
     static HProgram OpenGLNewProgram(HContext context, HVertexProgram vertex_program, HFragmentProgram fragment_program)
     {
@@ -2400,26 +3116,41 @@ static void LogFrameBufferError(GLenum status)
 
         OpenGLShader* vertex_shader   = (OpenGLShader*) vertex_program;
         OpenGLShader* fragment_shader = (OpenGLShader*) fragment_program;
+        OpenGLShader* shaders[]       = { vertex_shader, fragment_shader };
 
-        GLuint vertex_id   = vertex_shader->m_Id;
-        GLuint fragment_id = fragment_shader->m_Id;
-
-        glAttachShader(p, vertex_id);
-        CHECK_GL_ERROR;
-        glAttachShader(p, fragment_id);
-        CHECK_GL_ERROR;
+        program->m_Id       = p;
+        program->m_Language = vertex_shader->m_Language;
 
-        // For MRT bindings to work correctly on all platforms,
-        // we need to specify output locations manually
-#ifndef GL_ES_VERSION_2_0
-        const char* base_output_name = "_DMENGINE_GENERATED_gl_FragColor";
-        char buf[64] = {0};
-        for (int i = 0; i < MAX_BUFFER_COLOR_ATTACHMENTS; ++i)
+        OpenGLContext* gl_context = (OpenGLContext*) context;
+        uint64_t binary_key = 0;
+        if (gl_context->m_ProgramBinarySupport)
         {
-            snprintf(buf, sizeof(buf), "%s_%d", base_output_name, i);
-            glBindFragDataLocation(p, i, buf);
+            binary_key = GetProgramBinaryKey(shaders, DM_ARRAY_SIZE(shaders));
+            OpenGLProgramBinary* binary = gl_context->m_ProgramBinaries.Get(binary_key);
+            if (binary)
+            {
+                if (LoadProgramBinary(p, binary))
+                {
+                    BuildUniforms(gl_context, program, shaders, DM_ARRAY_SIZE(shaders));
+                    BuildAttributes(program);
+                    return (HProgram) program;
+                }
+
+                // Link from the shaders instead, in a new program since the rejected binary may have left state behind
+                glDeleteProgram(p);
+                p = glCreateProgram();
+                CHECK_GL_ERROR;
+                program->m_Id = p;
+            }
+
+            if (PFN_glProgramParameteri)
+            {
+                PFN_glProgramParameteri(p, DMGRAPHICS_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+                CLEAR_GL_ERROR;
+            }
         }
-#endif
+
+        AttachGraphicsShaders(p, vertex_shader, fragment_shader);
 
         if (!LinkProgram(p))
         {
@@ -2429,22 +3160,27 @@ static void LogFrameBufferError(GLenum status)
             return 0;
         }
 
-        program->m_Id       = p;
-        program->m_Language = vertex_shader->m_Language;
-
-        OpenGLShader* shaders[] = { vertex_shader, fragment_shader };
+        if (gl_context->m_ProgramBinarySupport)
+        {
+            SaveProgramBinary(gl_context, p, binary_key);
+        }
 
-        BuildUniforms((OpenGLContext*) context, program, shaders, DM_ARRAY_SIZE(shaders));
+        BuildUniforms(gl_context, program, shaders, DM_ARRAY_SIZE(shaders));
         BuildAttributes(program);
         return (HProgram) program;
     }
 
     static void OpenGLDeleteProgram(HContext context, HProgram program)
     {
-        (void) context;
         OpenGLProgram* program_ptr = (OpenGLProgram*) program;
         glDeleteProgram(program_ptr->m_Id);
 
+        // The name can be reused by a new program, so make sure it is bound again
+        if (((OpenGLContext*) context)->m_StateCache.m_Program == program_ptr->m_Id)
+        {
+            ((OpenGLContext*) context)->m_StateCache.m_Program = INVALID_GL_NAME;
+        }
+
         for (int i = 0; i < program_ptr->m_Uniforms.Size(); ++i)
         {
             free(program_ptr->m_Uniforms[i].m_Name);
@@ -2514,6 +3250,7 @@ static void LogFrameBufferError(GLenum status)
             CHECK_GL_ERROR;
             glCompileShader(id);
             CHECK_GL_ERROR;
+            ((OpenGLShader*) prog)->m_SourceHash = dmHashBuffer64(ddf_shader->m_Source.m_Data, ddf_shader->m_Source.m_Count);
         }
 
         return success;
@@ -2542,6 +3279,7 @@ static void LogFrameBufferError(GLenum status)
             CHECK_GL_ERROR;
             glCompileShader(id);
             CHECK_GL_ERROR;
+            ((OpenGLShader*) prog)->m_SourceHash = dmHashBuffer64(ddf_shader->m_Source.m_Data, ddf_shader->m_Source.m_Count);
         }
 
         return success;
@@ -2601,16 +3339,19 @@ static void LogFrameBufferError(GLenum status)
         OpenGLContext* context = (OpenGLContext*) _context;
         OpenGLProgram* program = (OpenGLProgram*) _program;
         context->m_CurrentProgram = program;
-        glUseProgram(program->m_Id);
-        CHECK_GL_ERROR;
+        if (context->m_StateCache.m_Program != program->m_Id)
+        {
+            glUseProgram(program->m_Id);
+            CHECK_GL_ERROR;
+            context->m_StateCache.m_Program = program->m_Id;
+        }
     }
 
     static void OpenGLDisableProgram(HContext _context)
     {
+        // The program is left bound, so that enabling it again for the next draw call is free
         OpenGLContext* context = (OpenGLContext*) _context;
         context->m_CurrentProgram = 0;
-        glUseProgram(0);
-        CHECK_GL_ERROR;
     }
 
     static bool TryLinkProgram(GLuint* ids, int num_ids)
@@ -2659,10 +3400,19 @@ static void LogFrameBufferError(GLenum status)
 
         OpenGLProgram* program_ptr = (OpenGLProgram*) program;
 
+        // A program created from a cached binary has no shaders attached
+        GLint num_attached = 0;
+        glGetProgramiv(program_ptr->m_Id, GL_ATTACHED_SHADERS, &num_attached);
+        if (num_attached == 0)
+        {
+            AttachGraphicsShaders(program_ptr->m_Id, (OpenGLShader*) vert_program, (OpenGLShader*) frag_program);
+        }
+
         glLinkProgram(program_ptr->m_Id);
         CHECK_GL_ERROR;
 
         BuildAttributes(program_ptr);
+        InvalidateUniformValues(program_ptr);
         return true;
     }
 
@@ -2676,7 +3426,8 @@ static void LogFrameBufferError(GLenum status)
         OpenGLProgram* program_ptr = (OpenGLProgram*) program;
         glLinkProgram(program_ptr->m_Id);
         CHECK_GL_ERROR;
-        
+
+        InvalidateUniformValues(program_ptr);
         return true;
     }
 
@@ -2703,6 +3454,7 @@ static void LogFrameBufferError(GLenum status)
             CHECK_GL_ERROR;
             glCompileShader(id);
             CHECK_GL_ERROR;
+            ((OpenGLShader*) prog)->m_SourceHash = dmHashBuffer64(ddf_shader->m_Source.m_Data, ddf_shader->m_Source.m_Count);
         }
 
         return success;
@@ -2806,7 +3558,7 @@ static void LogFrameBufferError(GLenum status)
             memcpy(data_ptr, data, sizeof(Vector4) * count);
             ubo.m_Dirty = true;
         }
-        else
+        else if (!IsUniformValueUnchanged(((OpenGLContext*) context)->m_CurrentProgram, base_location, data, sizeof(Vector4) * count))
         {
             glUniform4fv(base_location, count, (const GLfloat*) data);
             CHECK_GL_ERROR;
@@ -2827,7 +3579,7 @@ static void LogFrameBufferError(GLenum status)
             memcpy(data_ptr, data, sizeof(Vector4) * count * 4);
             ubo.m_Dirty = true;
         }
-        else
+        else if (!IsUniformValueUnchanged(((OpenGLContext*) context)->m_CurrentProgram, base_location, data, sizeof(Vector4) * count * 4))
         {
             glUniformMatrix4fv(base_location, count, 0, (const GLfloat*) data);
             CHECK_GL_ERROR;
@@ -2837,8 +3589,11 @@ static void LogFrameBufferError(GLenum status)
     static void OpenGLSetSampler(HContext context, HUniformLocation location, int32_t unit)
     {
         assert(context);
-        glUniform1i(location, unit);
-        CHECK_GL_ERROR;
+        if (!IsUniformValueUnchanged(((OpenGLContext*) context)->m_CurrentProgram, location, &unit, sizeof(unit)))
+        {
+            glUniform1i(location, unit);
+            CHECK_GL_ERROR;
+        }
     }
 
     static inline GLint GetDepthBufferFormat(OpenGLContext* context)
@@ -3257,6 +4012,7 @@ static void LogFrameBufferError(GLenum status)
         }
         glBindFramebuffer(GL_FRAMEBUFFER, rt == NULL ? dmPlatform::OpenGLGetDefaultFramebufferId() : rt->m_Id);
         CHECK_GL_ERROR;
+        AddRenderPassBeginStat();
 
     #if __EMSCRIPTEN__
         #define DRAW_BUFFERS_FN glDrawBuffers
@@ -3576,22 +4332,55 @@ static void LogFrameBufferError(GLenum status)
             gl_min_filter = GetNonMipMapVersionOfFilter(gl_min_filter);
         }
 
-        glTexParameteri(gl_type, GL_TEXTURE_MIN_FILTER, gl_min_filter);
-        CHECK_GL_ERROR;
+        GLenum gl_wrap_s = GetOpenGLTextureWrap(uwrap);
+        GLenum gl_wrap_t = GetOpenGLTextureWrap(vwrap);
 
-        glTexParameteri(gl_type, GL_TEXTURE_MAG_FILTER, gl_mag_filter);
-        CHECK_GL_ERROR;
+        // The parameters are stored per texture object. We only know which object is bound
+        // when the texture has a single id, so textures with several ids always apply them.
+        OpenGLTextureParamsCache& cache = tex->m_ParamsCache;
+        if (tex->m_NumTextureIds != 1 || cache.m_TextureId != tex->m_TextureIds[0])
+        {
+            memset(&cache, 0, sizeof(cache));
+            cache.m_TextureId = tex->m_NumTextureIds == 1 ? tex->m_TextureIds[0] : 0;
+        }
 
-        glTexParameteri(gl_type, GL_TEXTURE_WRAP_S, GetOpenGLTextureWrap(uwrap));
-        CHECK_GL_ERROR
+        if (cache.m_MinFilter != gl_min_filter)
+        {
+            glTexParameteri(gl_type, GL_TEXTURE_MIN_FILTER, gl_min_filter);
+            CHECK_GL_ERROR;
+            cache.m_MinFilter = gl_min_filter;
+        }
 
-        glTexParameteri(gl_type, GL_TEXTURE_WRAP_T, GetOpenGLTextureWrap(vwrap));
-        CHECK_GL_ERROR
+        if (cache.m_MagFilter != gl_mag_filter)
+        {
+            glTexParameteri(gl_type, GL_TEXTURE_MAG_FILTER, gl_mag_filter);
+            CHECK_GL_ERROR;
+            cache.m_MagFilter = gl_mag_filter;
+        }
 
-        if (g_Context->m_AnisotropySupport && max_anisotropy > 1.0f)
+        if (cache.m_WrapS != gl_wrap_s)
+        {
+            glTexParameteri(gl_type, GL_TEXTURE_WRAP_S, gl_wrap_s);
+            CHECK_GL_ERROR
+            cache.m_WrapS = gl_wrap_s;
+        }
+
+        if (cache.m_WrapT != gl_wrap_t)
         {
-            glTexParameterf(gl_type, GL_TEXTURE_MAX_ANISOTROPY_EXT, dmMath::Min(max_anisotropy, g_Context->m_MaxAnisotropy));
+            glTexParameteri(gl_type, GL_TEXTURE_WRAP_T, gl_wrap_t);
             CHECK_GL_ERROR
+            cache.m_WrapT = gl_wrap_t;
+        }
+
+        if (g_Context->m_AnisotropySupport && max_anisotropy > 1.0f)
+        {
+            float anisotropy = dmMath::Min(max_anisotropy, g_Context->m_MaxAnisotropy);
+            if (cache.m_MaxAnisotropy != anisotropy)
+            {
+                glTexParameterf(gl_type, GL_TEXTURE_MAX_ANISOTROPY_EXT, anisotropy);
+                CHECK_GL_ERROR
+                cache.m_MaxAnisotropy = anisotropy;
+            }
         }
     }
 
@@ -4189,6 +4978,16 @@ static void LogFrameBufferError(GLenum status)
         return false;
     }
 
+    static inline void SetActiveTextureUnit(OpenGLContext* context, uint32_t unit)
+    {
+        if (context->m_StateCache.m_ActiveTextureUnit != TEXTURE_UNIT_NAMES[unit])
+        {
+            glActiveTexture(TEXTURE_UNIT_NAMES[unit]);
+            CHECK_GL_ERROR;
+            context->m_StateCache.m_ActiveTextureUnit = TEXTURE_UNIT_NAMES[unit];
+        }
+    }
+
     static void OpenGLEnableTexture(HContext _context, uint32_t unit, uint8_t id_index, HTexture texture)
     {
         OpenGLContext* context = (OpenGLContext*) _context;
@@ -4201,8 +5000,7 @@ static void LogFrameBufferError(GLenum status)
         CHECK_GL_ERROR;
 #endif
 
-        glActiveTexture(TEXTURE_UNIT_NAMES[unit]);
-        CHECK_GL_ERROR;
+        SetActiveTextureUnit(context, unit);
 
         bool bind_as_texture = true;
         if (tex->m_Type == TEXTURE_TYPE_IMAGE_2D)
@@ -4228,8 +5026,7 @@ static void LogFrameBufferError(GLenum status)
         OpenGLContext* context = (OpenGLContext*) _context;
         OpenGLTexture* tex     = GetAssetFromContainer<OpenGLTexture>(context->m_AssetHandleContainer, texture);
 
-        glActiveTexture(TEXTURE_UNIT_NAMES[unit]);
-        CHECK_GL_ERROR;
+        SetActiveTextureUnit(context, unit);
 
         bool unbind_as_texture = true;
         if (tex->m_Type == TEXTURE_TYPE_IMAGE_2D)
@@ -4256,6 +5053,103 @@ static void LogFrameBufferError(GLenum status)
         CHECK_GL_ERROR;
     }
 
+    // Reads into a ring of pixel buffers, and maps the oldest one when it's about to be reused.
+    // By then the gpu is done with it, so neither the read nor the map stalls the frame
+    static bool OpenGLReadPixelsAsync(HContext _context, void* buffer, uint32_t buffer_size)
+    {
+    #if defined(GL_ES_VERSION_2_0) || defined(ANDROID) || defined(__EMSCRIPTEN__)
+        OpenGLReadPixels(_context, buffer, buffer_size);
+        return true;
+    #else
+        if (!IsBufferMappingSupported())
+        {
+            OpenGLReadPixels(_context, buffer, buffer_size);
+            return true;
+        }
+
+        OpenGLContext* context = (OpenGLContext*) _context;
+        OpenGLReadback& readback = context->m_Readback;
+        uint32_t w = dmGraphics::GetWidth(context);
+        uint32_t h = dmGraphics::GetHeight(context);
+        uint32_t size = w * h * 4;
+        assert (buffer_size >= size);
+
+        if (readback.m_Buffers[0] == 0)
+        {
+            glGenBuffersARB(READBACK_FRAME_COUNT, readback.m_Buffers);
+            CHECK_GL_ERROR;
+        }
+
+        uint32_t index = readback.m_Frame % READBACK_FRAME_COUNT;
+        readback.m_Frame++;
+
+        bool result = false;
+        glBindBufferARB(DMGRAPHICS_PIXEL_PACK_BUFFER, readback.m_Buffers[index]);
+        CHECK_GL_ERROR;
+
+        // A read of a different size (e.g. before a resize) is dropped
+        if (readback.m_Sizes[index] == size)
+        {
+            void* ptr = glMapBufferARB(DMGRAPHICS_PIXEL_PACK_BUFFER, DMGRAPHICS_READ_ONLY);
+            CHECK_GL_ERROR;
+            if (ptr)
+            {
+                memcpy(buffer, ptr, size);
+                result = true;
+            }
+            glUnmapBufferARB(DMGRAPHICS_PIXEL_PACK_BUFFER);
+            CHECK_GL_ERROR;
+        }
+        else
+        {
+            glBufferDataARB(DMGRAPHICS_PIXEL_PACK_BUFFER, size, 0, DMGRAPHICS_STREAM_READ);
+            CHECK_GL_ERROR;
+        }
+
+        glReadPixels(0, 0, w, h, GL_BGRA, GL_UNSIGNED_BYTE, 0);
+        CHECK_GL_ERROR;
+        readback.m_Sizes[index] = size;
+
+        glBindBufferARB(DMGRAPHICS_PIXEL_PACK_BUFFER, 0);
+        CHECK_GL_ERROR;
+        return result;
+    #endif
+    }
+
+    static void DeleteReadbackBuffers(OpenGLContext* context)
+    {
+        OpenGLReadback& readback = context->m_Readback;
+        if (readback.m_Buffers[0] != 0)
+        {
+            glDeleteBuffersARB(READBACK_FRAME_COUNT, readback.m_Buffers);
+            CHECK_GL_ERROR;
+        }
+        memset(&readback, 0, sizeof(readback));
+    }
+
+    static void SetOpenGLState(OpenGLContext* context, State state, bool enabled)
+    {
+        OpenGLStateCache& cache = context->m_StateCache;
+        const uint32_t state_bit = 1 << state;
+        if ((cache.m_KnownStates & state_bit) && ((cache.m_EnabledStates & state_bit) != 0) == enabled)
+        {
+            return;
+        }
+
+        if (enabled)
+        {
+            glEnable(GetOpenGLState(state));
+            cache.m_EnabledStates |= state_bit;
+        }
+        else
+        {
+            glDisable(GetOpenGLState(state));
+            cache.m_EnabledStates &= ~state_bit;
+        }
+        CHECK_GL_ERROR
+        cache.m_KnownStates |= state_bit;
+    }
+
     static void OpenGLEnableState(HContext context, State state)
     {
         assert(context);
@@ -4266,9 +5160,7 @@ static void LogFrameBufferError(GLenum status)
             return;
         }
     #endif
-        glEnable(GetOpenGLState(state));
-        CHECK_GL_ERROR
-
+        SetOpenGLState((OpenGLContext*) context, state, true);
         SetPipelineStateValue(((OpenGLContext*) context)->m_PipelineState, state, 1);
     }
 
@@ -4282,9 +5174,7 @@ static void LogFrameBufferError(GLenum status)
             return;
         }
     #endif
-        glDisable(GetOpenGLState(state));
-        CHECK_GL_ERROR
-
+        SetOpenGLState((OpenGLContext*) context, state, false);
         SetPipelineStateValue(((OpenGLContext*) context)->m_PipelineState, state, 0);
     }
 
@@ -4580,6 +5470,10 @@ static void LogFrameBufferError(GLenum status)
     {
         GraphicsAdapterFunctionTable fn_table = {};
         DM_REGISTER_GRAPHICS_FUNCTION_TABLE(fn_table, OpenGL);
+        DM_REGISTER_GRAPHICS_FUNCTION(fn_table, OpenGL, BeginGpuScope);
+        DM_REGISTER_GRAPHICS_FUNCTION(fn_table, OpenGL, EndGpuScope);
+        DM_REGISTER_GRAPHICS_FUNCTION(fn_table, OpenGL, IterateGpuScopes);
+        DM_REGISTER_GRAPHICS_FUNCTION(fn_table, OpenGL, ReadPixelsAsync);
         return fn_table;
     }
 }
@@ -119,6 +119,70 @@
     #define DMGRAPHICS_READ_ONLY                (0x88B8)
 #endif
 
+// GL_WRITE_ONLY
+#ifdef GL_WRITE_ONLY
+    #define DMGRAPHICS_WRITE_ONLY               (GL_WRITE_ONLY)
+#else
+    #define DMGRAPHICS_WRITE_ONLY               (0x88B9)
+#endif
+
+// Pixel buffer objects
+#ifdef GL_PIXEL_PACK_BUFFER
+    #define DMGRAPHICS_PIXEL_PACK_BUFFER        (GL_PIXEL_PACK_BUFFER)
+#else
+    #define DMGRAPHICS_PIXEL_PACK_BUFFER        (0x88EB)
+#endif
+
+#ifdef GL_STREAM_READ
+    #define DMGRAPHICS_STREAM_READ              (GL_STREAM_READ)
+#else
+    #define DMGRAPHICS_STREAM_READ              (0x88E1)
+#endif
+
+// Timer queries (GL_ARB_timer_query / GL_EXT_disjoint_timer_query)
+#ifdef GL_TIMESTAMP
+    #define DMGRAPHICS_TIMESTAMP               (GL_TIMESTAMP)
+#else
+    #define DMGRAPHICS_TIMESTAMP               (0x8E28)
+#endif
+
+#ifdef GL_QUERY_RESULT
+    #define DMGRAPHICS_QUERY_RESULT            (GL_QUERY_RESULT)
+#else
+    #define DMGRAPHICS_QUERY_RESULT            (0x8866)
+#endif
+
+#ifdef GL_QUERY_RESULT_AVAILABLE
+    #define DMGRAPHICS_QUERY_RESULT_AVAILABLE  (GL_QUERY_RESULT_AVAILABLE)
+#else
+    #define DMGRAPHICS_QUERY_RESULT_AVAILABLE  (0x8867)
+#endif
+
+#ifdef GL_GPU_DISJOINT_EXT
+    #define DMGRAPHICS_GPU_DISJOINT            (GL_GPU_DISJOINT_EXT)
+#else
+    #define DMGRAPHICS_GPU_DISJOINT            (0x8FBB)
+#endif
+
+// Program binaries (GLES3 / GL_ARB_get_program_binary / GL_OES_get_program_binary)
+#ifdef GL_PROGRAM_BINARY_LENGTH
+    #define DMGRAPHICS_PROGRAM_BINARY_LENGTH            (GL_PROGRAM_BINARY_LENGTH)
+#else
+    #define DMGRAPHICS_PROGRAM_BINARY_LENGTH            (0x8741)
+#endif
+
+#ifdef GL_NUM_PROGRAM_BINARY_FORMATS
+    #define DMGRAPHICS_NUM_PROGRAM_BINARY_FORMATS       (GL_NUM_PROGRAM_BINARY_FORMATS)
+#else
+    #define DMGRAPHICS_NUM_PROGRAM_BINARY_FORMATS       (0x87FE)
+#endif
+
+#ifdef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+    #define DMGRAPHICS_PROGRAM_BINARY_RETRIEVABLE_HINT  (GL_PROGRAM_BINARY_RETRIEVABLE_HINT)
+#else
+    #define DMGRAPHICS_PROGRAM_BINARY_RETRIEVABLE_HINT  (0x8257)
+#endif
+
 // GL_MAJOR_VERSION
 #ifdef GL_MAJOR_VERSION
     #define DMGRAPHICS_MAJOR_VERSION           (GL_MAJOR_VERSION)
@@ -15,7 +15,9 @@
 #ifndef __GRAPHICS_DEVICE_OPENGL__
 #define __GRAPHICS_DEVICE_OPENGL__
 
+#include <stdio.h>
 #include <dlib/atomic.h>
+#include <dlib/hashtable.h>
 #include <dlib/math.h>
 #include <dmsdk/dlib/atomic.h>
 #include <dmsdk/vectormath/cpp/vectormath_aos.h>
@@ -37,9 +39,21 @@ namespace dmGraphics
         DEVICE_BUFFER_TYPE_VERTEX  = 1,
     };
 
+    // The sampler parameters last applied to a texture object, used to skip redundant glTexParameter calls
+    struct OpenGLTextureParamsCache
+    {
+        GLuint  m_TextureId;
+        GLenum  m_MinFilter;
+        GLenum  m_MagFilter;
+        GLenum  m_WrapS;
+        GLenum  m_WrapT;
+        float   m_MaxAnisotropy;
+    };
+
     struct OpenGLTexture
     {
         TextureParams     m_Params;
+        OpenGLTextureParamsCache m_ParamsCache;
         TextureType       m_Type;
         GLuint*           m_TextureIds;
         uint32_t          m_ResourceSize; // For Mip level 0. We approximate each mip level is 1/4th. Or MipSize0 * 1.33
@@ -81,6 +95,15 @@ namespace dmGraphics
         GLuint               m_Id;
         ShaderMeta           m_ShaderMeta;
         ShaderDesc::Language m_Language;
+        uint64_t             m_SourceHash;
+    };
+
+    // A linked program, as returned by glGetProgramBinary
+    struct OpenGLProgramBinary
+    {
+        uint8_t* m_Data;
+        uint32_t m_Size;
+        uint32_t m_Format;
     };
 
     struct OpenGLBuffer
@@ -117,8 +140,11 @@ namespace dmGraphics
         HUniformLocation m_Location;
         GLint            m_Count;
         GLenum           m_Type;
+        uint32_t         m_ValueOffset; // Offset into OpenGLProgram::m_UniformValues
+        uint32_t         m_ValueSize;
         uint8_t          m_TextureUnit   : 7;
         uint8_t          m_IsTextureType : 1;
+        uint8_t          m_ValueCached   : 1;
     };
 
     struct OpenGLProgram
@@ -128,6 +154,77 @@ namespace dmGraphics
         dmArray<OpenGLVertexAttribute> m_Attributes;
         dmArray<OpenGLUniformBuffer>   m_UniformBuffers;
         dmArray<OpenGLUniform>         m_Uniforms;
+        dmArray<uint8_t>               m_UniformValues; // The last values uploaded for each uniform
+    };
+
+    const static uint32_t MAX_CACHED_VERTEX_ATTRIBUTES = 16;
+    const static GLuint   INVALID_GL_NAME              = 0xFFFFFFFF;
+
+    struct OpenGLVertexAttributeState
+    {
+        GLuint   m_Buffer;
+        uint32_t m_Offset;
+        uint32_t m_Stride;
+        uint32_t m_Divisor;
+        GLenum   m_Type;
+        uint8_t  m_ComponentCount;
+        uint8_t  m_Normalize      : 1;
+        uint8_t  m_PointerValid   : 1;
+        uint8_t  m_Known          : 1; // m_Enabled reflects the GL state
+        uint8_t  m_Enabled        : 1;
+        uint8_t  m_Required       : 1; // Used by a currently enabled vertex declaration
+    };
+
+    // Shadow copy of the GL state set by the context, used to skip redundant GL calls.
+    // Invalidated every frame, since native extensions might change the GL state directly.
+    struct OpenGLStateCache
+    {
+        OpenGLVertexAttributeState m_VertexAttributes[MAX_CACHED_VERTEX_ATTRIBUTES];
+        GLuint                     m_Program;
+        GLuint                     m_ArrayBuffer;
+        GLuint                     m_ElementArrayBuffer;
+        GLenum                     m_ActiveTextureUnit;
+        uint32_t                   m_EnabledStates;
+        uint32_t                   m_KnownStates;
+    };
+
+    // The number of frames the gpu timer queries are kept before being read back
+    const static uint32_t GPU_TIMER_FRAME_COUNT    = 3;
+    const static uint32_t MAX_GPU_SCOPES_PER_FRAME = 256;
+    const static uint32_t INVALID_GPU_SCOPE        = 0xFFFFFFFF;
+
+    struct OpenGLGpuScope
+    {
+        const char* m_Name;
+        GLuint      m_Queries[2]; // Start and end timestamps
+        uint32_t    m_Depth;
+    };
+
+    struct OpenGLGpuScopeResult
+    {
+        const char* m_Name;
+        uint64_t    m_Start; // us, relative to the first scope of the frame
+        uint64_t    m_Time;  // us
+        uint32_t    m_Depth;
+    };
+
+    struct OpenGLGpuTimer
+    {
+        dmArray<OpenGLGpuScope>       m_Frames[GPU_TIMER_FRAME_COUNT];
+        dmArray<OpenGLGpuScopeResult> m_Results;     // The most recent frame that has been read back
+        dmArray<GLuint>               m_FreeQueries;
+        dmArray<uint32_t>             m_Stack;       // Indices of the open scopes in the current frame
+        uint32_t                      m_Frame;
+    };
+
+    // The number of frames a frame buffer read is in flight, before its pixel buffer is mapped
+    const static uint32_t READBACK_FRAME_COUNT = 3;
+
+    struct OpenGLReadback
+    {
+        GLuint   m_Buffers[READBACK_FRAME_COUNT];
+        uint32_t m_Sizes[READBACK_FRAME_COUNT]; // The size of the pixels read to the buffer, 0 if none
+        uint32_t m_Frame;
     };
 
     struct OpenGLContext
@@ -145,9 +242,17 @@ namespace dmGraphics
 
         OpenGLProgram*          m_CurrentProgram;
 
+        // The program binaries of the cache file, and those linked since, keyed by the sources of the shaders
+        dmHashTable64<OpenGLProgramBinary> m_ProgramBinaries;
+        char*                   m_ProgramCachePath;
+        FILE*                   m_ProgramCacheFile;
+
         dmOpaqueHandleContainer<uintptr_t> m_AssetHandleContainer;
 
         PipelineState           m_PipelineState;
+        OpenGLStateCache        m_StateCache;
+        OpenGLGpuTimer          m_GpuTimer;
+        OpenGLReadback          m_Readback;
         uint32_t                m_Width;
         uint32_t                m_Height;
         uint32_t                m_MaxTextureSize;
@@ -177,6 +282,9 @@ namespace dmGraphics
         uint32_t                m_StorageBufferSupport             : 1;
         uint32_t                m_RenderDocSupport                 : 1;
         uint32_t                m_InstancingSupport                : 1;
+        uint32_t                m_GpuTimerSupport                  : 1;
+        uint32_t                m_GpuTimerDisjointSupport          : 1; // GL_EXT_disjoint_timer_query
+        uint32_t                m_ProgramBinarySupport             : 1; // GLES3 / GL_ARB_get_program_binary / GL_OES_get_program_binary
     };
 }
 #endif // __GRAPHICS_DEVICE_OPENGL__
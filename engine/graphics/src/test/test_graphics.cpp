@@ -397,6 +397,55 @@ TEST_F(dmGraphicsTest, Drawing)
     dmGraphics::DeleteVertexStreamDeclaration(stream_declaration);
 }
 
+TEST_F(dmGraphicsTest, FrameStats)
+{
+    float v[] = { 0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f, 8.0f, 9.0f, 10.0f, 11.0f, 12.0f, 13.0f, 14.0f };
+    uint32_t i[] = { 0, 1, 2, 2, 1, 0 };
+
+    // Start from a clean frame
+    dmGraphics::Flip(m_Context);
+
+    dmGraphics::HVertexStreamDeclaration stream_declaration = dmGraphics::NewVertexStreamDeclaration(m_Context);
+    dmGraphics::AddVertexStream(stream_declaration, "position", 3, dmGraphics::TYPE_FLOAT, false);
+    dmGraphics::HVertexDeclaration vd = dmGraphics::NewVertexDeclaration(m_Context, stream_declaration);
+    dmGraphics::HVertexBuffer vb = dmGraphics::NewVertexBuffer(m_Context, sizeof(v), v, dmGraphics::BUFFER_USAGE_STREAM_DRAW);
+    dmGraphics::HIndexBuffer ib = dmGraphics::NewIndexBuffer(m_Context, sizeof(i), i, dmGraphics::BUFFER_USAGE_STREAM_DRAW);
+    dmGraphics::SetVertexBufferSubData(vb, 0, 3 * sizeof(float), v);
+
+    dmGraphics::EnableVertexBuffer(m_Context, vb, 0);
+    dmGraphics::EnableVertexDeclaration(m_Context, vd, 0);
+    dmGraphics::DrawElements(m_Context, dmGraphics::PRIMITIVE_TRIANGLES, 0, 6, dmGraphics::TYPE_UNSIGNED_INT, ib, 4);
+    dmGraphics::Draw(m_Context, dmGraphics::PRIMITIVE_TRIANGLE_STRIP, 0, 5, 0);
+    dmGraphics::Draw(m_Context, dmGraphics::PRIMITIVE_LINES, 0, 4, 1);
+    dmGraphics::DisableVertexDeclaration(m_Context, vd);
+    dmGraphics::DisableVertexBuffer(m_Context, vb);
+
+    dmGraphics::SetRenderTarget(m_Context, 0, 0);
+
+    // The stats are of the last completed frame
+    dmGraphics::FrameStats stats;
+    dmGraphics::GetFrameStats(m_Context, &stats);
+    ASSERT_EQ(0u, stats.m_DrawCalls);
+
+    dmGraphics::Flip(m_Context);
+    dmGraphics::GetFrameStats(m_Context, &stats);
+    ASSERT_EQ(3u, stats.m_DrawCalls);
+    ASSERT_EQ(6u, stats.m_Instances);
+    ASSERT_EQ(2u * 4u + 3u, stats.m_Triangles);
+    ASSERT_EQ(sizeof(v) + sizeof(i) + 3 * sizeof(float), stats.m_BufferUploadBytes);
+    ASSERT_EQ(1u, stats.m_RenderPassBegins);
+
+    dmGraphics::Flip(m_Context);
+    dmGraphics::GetFrameStats(m_Context, &stats);
+    ASSERT_EQ(0u, stats.m_DrawCalls);
+    ASSERT_EQ(0u, stats.m_BufferUploadBytes);
+
+    dmGraphics::DeleteIndexBuffer(ib);
+    dmGraphics::DeleteVertexBuffer(vb);
+    dmGraphics::DeleteVertexDeclaration(vd);
+    dmGraphics::DeleteVertexStreamDeclaration(stream_declaration);
+}
+
 static inline dmGraphics::ShaderDesc MakeDDFShaderDesc(dmGraphics::ShaderDesc::Shader* shader,
     dmGraphics::ShaderDesc::ShaderType type,
     dmGraphics::ShaderDesc::ResourceBinding* inputs, uint32_t input_count,
@@ -287,6 +287,12 @@ namespace dmGraphics
         return true;
     }
 
+    static bool InitializeTranscoder()
+    {
+        basist::basisu_transcoder_init();
+        return true;
+    }
+
     bool Transcode(const char* path, dmGraphics::TextureImage::Image* image, uint8_t image_count, dmGraphics::TextureFormat format,
                     uint8_t** images, uint32_t* sizes, uint32_t* num_transcoded_mips)
     {
@@ -294,12 +300,9 @@ namespace dmGraphics
 
         assert(image_count > 0);
 
-        static int first = 1;
-        if (first)
-        {
-            first = 0;
-            basist::basisu_transcoder_init();
-        }
+        // Textures are transcoded on the loader threads, so the tables must only be initialized once
+        static bool initialized = InitializeTranscoder();
+        (void) initialized;
 
         basist::transcoder_texture_format transcoder_format;
         if (!TextureFormatToBasisFormat(format, transcoder_format))
@@ -350,7 +353,8 @@ namespace dmGraphics
             if (!level_result)
             {
                 dmLogError("Transcoding failed on level %d for %s\n", level_index, path);
-                delete[] data_write_ptr;
+                delete[] images[level_index];
+                images[level_index] = 0;
                 TranscoderDeleteStateArray(image_transcoders, image_count);
                 return false;
             }
@@ -17,6 +17,7 @@
 #include <dlib/profile.h>
 #include <dlib/dstrings.h>
 #include <dlib/log.h>
+#include <dlib/sys.h>
 
 #include <dmsdk/vectormath/cpp/vectormath_aos.h>
 
@@ -61,6 +62,7 @@ namespace dmGraphics
     static void           VulkanSetTextureParamsInternal(VulkanTexture* texture, TextureFilter minfilter, TextureFilter magfilter, TextureWrap uwrap, TextureWrap vwrap, float max_anisotropy);
     static void           CopyToTexture(VulkanContext* context, const TextureParams& params, bool useStageBuffer, uint32_t texDataSize, void* texDataPtr, VulkanTexture* textureOut);
     static VkFormat       GetVulkanFormatFromTextureFormat(TextureFormat format);
+    static void           DestroyReadbacks(VulkanContext* context);
 
     #define DM_VK_RESULT_TO_STR_CASE(x) case x: return #x
     static const char* VkResultToStr(VkResult res)
@@ -121,6 +123,12 @@ namespace dmGraphics
         m_Width                   = params.m_Width;
         m_Height                  = params.m_Height;
         m_SwapInterval            = params.m_SwapInterval;
+        m_PipelineCachePath       = params.m_PipelineCachePath ? strdup(params.m_PipelineCachePath) : 0;
+        m_PipelineManifestPath    = params.m_PipelineManifestPath ? strdup(params.m_PipelineManifestPath) : 0;
+        m_RecordPipelineManifest  = params.m_RecordPipelineManifest;
+        m_JobThread               = params.m_JobThread;
+
+        m_TextureStagingBuffer.m_Usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
 
         // We need to have some sort of valid default filtering
         if (m_DefaultTextureMinFilter == TEXTURE_FILTER_DEFAULT)
@@ -381,7 +389,7 @@ namespace dmGraphics
 
         VkRenderPassBeginInfo vk_render_pass_begin_info;
         vk_render_pass_begin_info.sType               = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-        vk_render_pass_begin_info.renderPass          = rt->m_Handle.m_RenderPass;
+        vk_render_pass_begin_info.renderPass          = rt->m_TransientBufferTypes ? rt->m_TransientRenderPass : rt->m_Handle.m_RenderPass;
         vk_render_pass_begin_info.framebuffer         = rt->m_Handle.m_Framebuffer;
         vk_render_pass_begin_info.pNext               = 0;
         vk_render_pass_begin_info.renderArea.offset.x = 0;
@@ -391,6 +399,7 @@ namespace dmGraphics
         vk_render_pass_begin_info.pClearValues        = vk_clear_values;
 
         vkCmdBeginRenderPass(context->m_MainCommandBuffers[context->m_SwapChain->m_ImageIndex], &vk_render_pass_begin_info, VK_SUBPASS_CONTENTS_INLINE);
+        AddRenderPassBeginStat();
 
         rt->m_IsBound          = 1;
         rt->m_SubPassIndex     = 0;
@@ -940,6 +949,387 @@ namespace dmGraphics
         }
     }
 
+    // Reads the pipeline cache saved by a previous session. The data is only used if it
+    // was created by the same device and driver, otherwise the driver might reject it.
+    static uint8_t* LoadDevicePipelineCacheData(VulkanContext* context, size_t* data_size)
+    {
+        *data_size = 0;
+        FILE* file = fopen(context->m_PipelineCachePath, "rb");
+        if (!file)
+        {
+            return 0;
+        }
+
+        fseek(file, 0, SEEK_END);
+        long file_size = ftell(file);
+        fseek(file, 0, SEEK_SET);
+
+        uint8_t* data = 0;
+        if (file_size > (long) sizeof(VkPipelineCacheHeaderVersionOne))
+        {
+            data = (uint8_t*) malloc(file_size);
+            if (fread(data, 1, file_size, file) != (size_t) file_size)
+            {
+                free(data);
+                data = 0;
+            }
+        }
+        fclose(file);
+
+        if (!data)
+        {
+            return 0;
+        }
+
+        VkPipelineCacheHeaderVersionOne header;
+        memcpy(&header, data, sizeof(header));
+
+        const VkPhysicalDeviceProperties& properties = context->m_PhysicalDevice.m_Properties;
+        if (header.headerVersion != VK_PIPELINE_CACHE_HEADER_VERSION_ONE ||
+            header.vendorID != properties.vendorID ||
+            header.deviceID != properties.deviceID ||
+            memcmp(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) != 0)
+        {
+            dmLogInfo("Discarding Vulkan pipeline cache, it was created by a different device or driver");
+            free(data);
+            return 0;
+        }
+
+        *data_size = (size_t) file_size;
+        return data;
+    }
+
+    static void CreateDevicePipelineCache(VulkanContext* context)
+    {
+        size_t data_size = 0;
+        uint8_t* data = context->m_PipelineCachePath ? LoadDevicePipelineCacheData(context, &data_size) : 0;
+
+        VkPipelineCacheCreateInfo vk_pipeline_cache_create_info;
+        memset(&vk_pipeline_cache_create_info, 0, sizeof(vk_pipeline_cache_create_info));
+        vk_pipeline_cache_create_info.sType           = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+        vk_pipeline_cache_create_info.initialDataSize = data_size;
+        vk_pipeline_cache_create_info.pInitialData    = data;
+
+        VkDevice vk_device = context->m_LogicalDevice.m_Device;
+        VkResult res = vkCreatePipelineCache(vk_device, &vk_pipeline_cache_create_info, 0, &context->m_DevicePipelineCache);
+        if (res != VK_SUCCESS && data)
+        {
+            // Fall back to an empty cache
+            vk_pipeline_cache_create_info.initialDataSize = 0;
+            vk_pipeline_cache_create_info.pInitialData    = 0;
+            res = vkCreatePipelineCache(vk_device, &vk_pipeline_cache_create_info, 0, &context->m_DevicePipelineCache);
+        }
+
+        if (res != VK_SUCCESS)
+        {
+            dmLogWarning("Could not create a Vulkan pipeline cache, reason: %s", VkResultToStr(res));
+            context->m_DevicePipelineCache = VK_NULL_HANDLE;
+        }
+
+        free(data);
+    }
+
+    static void SaveDevicePipelineCache(VulkanContext* context)
+    {
+        VkDevice vk_device = context->m_LogicalDevice.m_Device;
+
+        size_t data_size = 0;
+        if (vkGetPipelineCacheData(vk_device, context->m_DevicePipelineCache, &data_size, 0) != VK_SUCCESS || data_size == 0)
+        {
+            return;
+        }
+
+        uint8_t* data = (uint8_t*) malloc(data_size);
+        if (vkGetPipelineCacheData(vk_device, context->m_DevicePipelineCache, &data_size, data) == VK_SUCCESS)
+        {
+            // Write to a temporary file first, so that a partially written cache is never loaded
+            char tmp_path[1024];
+            dmSnPrintf(tmp_path, sizeof(tmp_path), "%s.tmp", context->m_PipelineCachePath);
+
+            FILE* file = fopen(tmp_path, "wb");
+            if (file)
+            {
+                bool written = fwrite(data, 1, data_size, file) == data_size;
+                fclose(file);
+
+                if (!written || dmSys::Rename(context->m_PipelineCachePath, tmp_path) != dmSys::RESULT_OK)
+                {
+                    dmLogWarning("Could not write the Vulkan pipeline cache to '%s'", context->m_PipelineCachePath);
+                    dmSys::Unlink(tmp_path);
+                }
+            }
+        }
+        free(data);
+    }
+
+    static void DestroyDevicePipelineCache(VulkanContext* context)
+    {
+        if (context->m_DevicePipelineCache == VK_NULL_HANDLE)
+        {
+            return;
+        }
+
+        if (context->m_PipelineCachePath)
+        {
+            SaveDevicePipelineCache(context);
+        }
+
+        vkDestroyPipelineCache(context->m_LogicalDevice.m_Device, context->m_DevicePipelineCache, 0);
+        context->m_DevicePipelineCache = VK_NULL_HANDLE;
+    }
+
+    static const uint32_t PIPELINE_MANIFEST_MAGIC   = 0x4d4c5044; // 'DPLM'
+    static const uint32_t PIPELINE_MANIFEST_VERSION = 1;
+
+    struct PipelineManifestHeader
+    {
+        uint32_t m_Magic;
+        uint32_t m_Version;
+        uint32_t m_EntrySize;
+        uint32_t m_EntryCount;
+    };
+
+    static uint64_t GetPipelineHash(uint64_t program_hash, const PipelineState& pipeline_state, uint16_t render_target_id,
+        VkSampleCountFlagBits vk_sample_count, VertexDeclaration** vertex_declarations, uint32_t vertex_declaration_count)
+    {
+        HashState64 pipeline_hash_state;
+        dmHashInit64(&pipeline_hash_state, false);
+        dmHashUpdateBuffer64(&pipeline_hash_state, &program_hash, sizeof(program_hash));
+        dmHashUpdateBuffer64(&pipeline_hash_state, &pipeline_state, sizeof(pipeline_state));
+        dmHashUpdateBuffer64(&pipeline_hash_state, &render_target_id, sizeof(render_target_id));
+        dmHashUpdateBuffer64(&pipeline_hash_state, &vk_sample_count, sizeof(vk_sample_count));
+
+        for (uint32_t i = 0; i < vertex_declaration_count; ++i)
+        {
+            dmHashUpdateBuffer64(&pipeline_hash_state, &vertex_declarations[i]->m_PipelineHash, sizeof(vertex_declarations[i]->m_PipelineHash));
+            dmHashUpdateBuffer64(&pipeline_hash_state, &vertex_declarations[i]->m_StepFunction, sizeof(vertex_declarations[i]->m_StepFunction));
+        }
+
+        return dmHashFinal64(&pipeline_hash_state);
+    }
+
+    static uint64_t GetPipelineHash(PipelineManifestEntry& entry)
+    {
+        VertexDeclaration* vertex_declarations[MAX_VERTEX_BUFFERS];
+        for (uint32_t i = 0; i < entry.m_VertexDeclarationCount; ++i)
+        {
+            vertex_declarations[i] = &entry.m_VertexDeclarations[i];
+        }
+        return GetPipelineHash(entry.m_ProgramHash, entry.m_PipelineState, DM_RENDERTARGET_BACKBUFFER_ID,
+            (VkSampleCountFlagBits) entry.m_SampleCount, vertex_declarations, entry.m_VertexDeclarationCount);
+    }
+
+    // Reads the pipelines that were created for the main render target in a previous session,
+    // so that they can be compiled in the background when their programs are created.
+    static void LoadPipelineManifest(VulkanContext* context)
+    {
+        context->m_PipelineManifest.SetSize(0);
+
+        FILE* file = fopen(context->m_PipelineManifestPath, "rb");
+        if (!file)
+        {
+            return;
+        }
+
+        PipelineManifestHeader header;
+        if (fread(&header, 1, sizeof(header), file) == sizeof(header) &&
+            header.m_Magic == PIPELINE_MANIFEST_MAGIC &&
+            header.m_Version == PIPELINE_MANIFEST_VERSION &&
+            header.m_EntrySize == sizeof(PipelineManifestEntry) &&
+            header.m_EntryCount > 0)
+        {
+            context->m_PipelineManifest.SetCapacity(header.m_EntryCount);
+            context->m_PipelineManifest.SetSize(header.m_EntryCount);
+            if (fread(context->m_PipelineManifest.Begin(), sizeof(PipelineManifestEntry), header.m_EntryCount, file) != header.m_EntryCount)
+            {
+                context->m_PipelineManifest.SetSize(0);
+            }
+        }
+
+        if (context->m_PipelineManifest.Empty())
+        {
+            dmLogInfo("Discarding Vulkan pipeline manifest '%s', it is empty or was created by a different engine version", context->m_PipelineManifestPath);
+        }
+
+        fclose(file);
+    }
+
+    static void SavePipelineManifest(VulkanContext* context)
+    {
+        // Merge the pipelines from the previous sessions with the ones created in this session
+        dmArray<PipelineManifestEntry> entries;
+        dmHashTable64<bool> added;
+        uint32_t max_count = context->m_PipelineManifest.Size() + context->m_RecordedPipelines.Size();
+        entries.SetCapacity(max_count);
+        added.SetCapacity(dmMath::Max(max_count / 2, 1U), max_count);
+
+        dmArray<PipelineManifestEntry>* sources[] = { &context->m_PipelineManifest, &context->m_RecordedPipelines };
+        for (uint32_t i = 0; i < DM_ARRAY_SIZE(sources); ++i)
+        {
+            for (uint32_t j = 0; j < sources[i]->Size(); ++j)
+            {
+                PipelineManifestEntry& entry = (*sources[i])[j];
+                uint64_t pipeline_hash = GetPipelineHash(entry);
+                if (!added.Get(pipeline_hash))
+                {
+                    added.Put(pipeline_hash, true);
+                    entries.Push(entry);
+                }
+            }
+        }
+
+        PipelineManifestHeader header;
+        header.m_Magic      = PIPELINE_MANIFEST_MAGIC;
+        header.m_Version    = PIPELINE_MANIFEST_VERSION;
+        header.m_EntrySize  = sizeof(PipelineManifestEntry);
+        header.m_EntryCount = entries.Size();
+
+        char tmp_path[1024];
+        dmSnPrintf(tmp_path, sizeof(tmp_path), "%s.tmp", context->m_PipelineManifestPath);
+
+        FILE* file = fopen(tmp_path, "wb");
+        if (file)
+        {
+            bool written = fwrite(&header, 1, sizeof(header), file) == sizeof(header) &&
+                              fwrite(entries.Begin(), sizeof(PipelineManifestEntry), entries.Size(), file) == entries.Size();
+            fclose(file);
+
+            if (!written || dmSys::Rename(context->m_PipelineManifestPath, tmp_path) != dmSys::RESULT_OK)
+            {
+                dmLogWarning("Could not write the Vulkan pipeline manifest to '%s'", context->m_PipelineManifestPath);
+                dmSys::Unlink(tmp_path);
+            }
+        }
+    }
+
+    static void RecordPipeline(VulkanContext* context, Program* program, const PipelineState& pipeline_state,
+        VkSampleCountFlagBits vk_sample_count, VertexDeclaration** vertex_declarations, uint32_t vertex_declaration_count)
+    {
+        PipelineManifestEntry entry;
+        memset(&entry, 0, sizeof(entry));
+        entry.m_ProgramHash            = program->m_Hash;
+        entry.m_PipelineState          = pipeline_state;
+        entry.m_VertexDeclarationCount = vertex_declaration_count;
+        entry.m_SampleCount            = (uint32_t) vk_sample_count;
+
+        for (uint32_t i = 0; i < vertex_declaration_count; ++i)
+        {
+            entry.m_VertexDeclarations[i]                       = *vertex_declarations[i];
+            entry.m_VertexDeclarations[i].m_BoundForProgram     = 0;
+            entry.m_VertexDeclarations[i].m_ModificationVersion = 0;
+        }
+
+        if (context->m_RecordedPipelines.Full())
+        {
+            context->m_RecordedPipelines.OffsetCapacity(32);
+        }
+        context->m_RecordedPipelines.Push(entry);
+    }
+
+    static int PrecompilePipelineJob(void* _context, void* data)
+    {
+        VulkanContext* context      = (VulkanContext*) _context;
+        PipelinePrecompileJob* job  = (PipelinePrecompileJob*) data;
+        PipelineManifestEntry& entry = job->m_Entry;
+
+        VertexDeclaration* vertex_declarations[MAX_VERTEX_BUFFERS];
+        for (uint32_t i = 0; i < entry.m_VertexDeclarationCount; ++i)
+        {
+            vertex_declarations[i] = &entry.m_VertexDeclarations[i];
+        }
+
+        job->m_Result = CreateGraphicsPipeline(context->m_LogicalDevice.m_Device, context->m_DevicePipelineCache, job->m_Scissor,
+            (VkSampleCountFlagBits) entry.m_SampleCount, entry.m_PipelineState, job->m_Program,
+            vertex_declarations, entry.m_VertexDeclarationCount, job->m_RenderTarget, &job->m_Pipeline);
+        return 0;
+    }
+
+    // Starts compiling the pipelines from the manifest that use this program on the job threads.
+    // The results are moved to the pipeline cache by FinishPrecompiledPipelines.
+    static void PrecompilePipelines(VulkanContext* context, Program* program)
+    {
+        if (context->m_PipelineManifest.Empty())
+        {
+            return;
+        }
+
+        uint32_t sample_count = (uint32_t) context->m_SwapChain->m_SampleCountFlag;
+        uint32_t job_count = 0;
+        for (uint32_t i = 0; i < context->m_PipelineManifest.Size(); ++i)
+        {
+            PipelineManifestEntry& entry = context->m_PipelineManifest[i];
+            if (entry.m_ProgramHash == program->m_Hash && entry.m_SampleCount == sample_count && !context->m_PipelineCache.Get(GetPipelineHash(entry)))
+            {
+                job_count++;
+            }
+        }
+
+        if (job_count == 0)
+        {
+            return;
+        }
+
+        RenderTarget* rt = GetAssetFromContainer<RenderTarget>(context->m_AssetHandleContainer, context->m_MainRenderTarget);
+
+        program->m_PrecompileJobs     = new PipelinePrecompileJob[job_count];
+        program->m_PrecompileJobCount = job_count;
+        memset(program->m_PrecompileJobs, 0, sizeof(PipelinePrecompileJob) * job_count);
+        dmJobThread::InitGroup(&program->m_PrecompileGroup, 0);
+
+        uint32_t job_index = 0;
+        for (uint32_t i = 0; i < context->m_PipelineManifest.Size(); ++i)
+        {
+            PipelineManifestEntry& entry = context->m_PipelineManifest[i];
+            if (entry.m_ProgramHash != program->m_Hash || entry.m_SampleCount != sample_count || context->m_PipelineCache.Get(GetPipelineHash(entry)))
+            {
+                continue;
+            }
+
+            PipelinePrecompileJob& job = program->m_PrecompileJobs[job_index++];
+            job.m_Entry                = entry;
+            job.m_Program              = program;
+            job.m_RenderTarget         = rt;
+            job.m_Scissor.extent       = rt->m_Extent;
+            job.m_Scissor.offset.x     = 0;
+            job.m_Scissor.offset.y     = 0;
+            dmJobThread::PushGroupJob(context->m_JobThread, &program->m_PrecompileGroup, PrecompilePipelineJob, context, &job);
+        }
+    }
+
+    static void FinishPrecompiledPipelines(VulkanContext* context, Program* program)
+    {
+        DM_PROFILE(__FUNCTION__);
+        dmJobThread::WaitGroup(context->m_JobThread, &program->m_PrecompileGroup);
+
+        PipelineCache& pipeline_cache = context->m_PipelineCache;
+        for (uint32_t i = 0; i < program->m_PrecompileJobCount; ++i)
+        {
+            PipelinePrecompileJob& job = program->m_PrecompileJobs[i];
+            if (job.m_Result != VK_SUCCESS)
+            {
+                dmLogWarning("Could not precompile a Vulkan pipeline, reason: %s", VkResultToStr(job.m_Result));
+                continue;
+            }
+
+            uint64_t pipeline_hash = GetPipelineHash(job.m_Entry);
+            if (pipeline_cache.Get(pipeline_hash))
+            {
+                vkDestroyPipeline(context->m_LogicalDevice.m_Device, job.m_Pipeline, 0);
+                continue;
+            }
+
+            if (pipeline_cache.Full())
+            {
+                pipeline_cache.SetCapacity(32, pipeline_cache.Capacity() + 4);
+            }
+            pipeline_cache.Put(pipeline_hash, job.m_Pipeline);
+        }
+
+        delete[] program->m_PrecompileJobs;
+        program->m_PrecompileJobs     = 0;
+        program->m_PrecompileJobCount = 0;
+    }
+
     bool InitializeVulkan(HContext _context)
     {
         VulkanContext* context = (VulkanContext*) _context;
@@ -1119,6 +1509,13 @@ namespace dmGraphics
         context->m_PipelineCache.SetCapacity(32,64);
         context->m_TextureSamplers.SetCapacity(4);
 
+        CreateDevicePipelineCache(context);
+
+        if (context->m_PipelineManifestPath)
+        {
+            LoadPipelineManifest(context);
+        }
+
         // Create framebuffers, default renderpass etc.
         res = CreateMainRenderingResources(context);
         if (res != VK_SUCCESS)
@@ -1238,6 +1635,8 @@ bail:
                 context->m_Instance = VK_NULL_HANDLE;
             }
 
+            free(context->m_PipelineCachePath);
+            free(context->m_PipelineManifestPath);
             delete context;
             g_VulkanContext = 0x0;
         }
@@ -1550,7 +1949,7 @@ bail:
         resource->m_Destroyed = 1;
     }
 
-    static Pipeline* GetOrCreateComputePipeline(VkDevice vk_device, PipelineCache& pipelineCache, Program* program)
+    static Pipeline* GetOrCreateComputePipeline(VkDevice vk_device, VkPipelineCache vk_pipeline_cache, PipelineCache& pipelineCache, Program* program)
     {
         HashState64 pipeline_hash_state;
         dmHashInit64(&pipeline_hash_state, false);
@@ -1563,7 +1962,7 @@ bail:
         {
             Pipeline new_pipeline = {};
 
-            VkResult res = CreateComputePipeline(vk_device, program, &new_pipeline);
+            VkResult res = CreateComputePipeline(vk_device, vk_pipeline_cache, program, &new_pipeline);
             CHECK_VK_ERROR(res);
 
             if (pipelineCache.Full())
@@ -1580,24 +1979,11 @@ bail:
         return cached_pipeline;
     }
 
-    static Pipeline* GetOrCreatePipeline(VkDevice vk_device, VkSampleCountFlagBits vk_sample_count,
+    static Pipeline* GetOrCreatePipeline(VkDevice vk_device, VkPipelineCache vk_pipeline_cache, VkSampleCountFlagBits vk_sample_count,
         const PipelineState pipelineState, PipelineCache& pipelineCache,
         Program* program, RenderTarget* rt, VertexDeclaration** vertexDeclaration, uint32_t vertexDeclarationCount)
     {
-        HashState64 pipeline_hash_state;
-        dmHashInit64(&pipeline_hash_state, false);
-        dmHashUpdateBuffer64(&pipeline_hash_state, &program->m_Hash, sizeof(program->m_Hash));
-        dmHashUpdateBuffer64(&pipeline_hash_state, &pipelineState, sizeof(pipelineState));
-        dmHashUpdateBuffer64(&pipeline_hash_state, &rt->m_Id, sizeof(rt->m_Id));
-        dmHashUpdateBuffer64(&pipeline_hash_state, &vk_sample_count, sizeof(vk_sample_count));
-
-        for (int i = 0; i < vertexDeclarationCount; ++i)
-        {
-            dmHashUpdateBuffer64(&pipeline_hash_state, &vertexDeclaration[i]->m_PipelineHash, sizeof(vertexDeclaration[i]->m_PipelineHash));
-            dmHashUpdateBuffer64(&pipeline_hash_state, &vertexDeclaration[i]->m_StepFunction, sizeof(vertexDeclaration[i]->m_StepFunction));
-        }
-
-        uint64_t pipeline_hash = dmHashFinal64(&pipeline_hash_state);
+        uint64_t pipeline_hash = GetPipelineHash(program->m_Hash, pipelineState, rt->m_Id, vk_sample_count, vertexDeclaration, vertexDeclarationCount);
 
         Pipeline* cached_pipeline = pipelineCache.Get(pipeline_hash);
 
@@ -1611,7 +1997,7 @@ bail:
             vk_scissor.offset.x = 0;
             vk_scissor.offset.y = 0;
 
-            VkResult res = CreateGraphicsPipeline(vk_device, vk_scissor, vk_sample_count, pipelineState, program, vertexDeclaration, vertexDeclarationCount, rt, &new_pipeline);
+            VkResult res = CreateGraphicsPipeline(vk_device, vk_pipeline_cache, vk_scissor, vk_sample_count, pipelineState, program, vertexDeclaration, vertexDeclarationCount, rt, &new_pipeline);
             CHECK_VK_ERROR(res);
 
             if (pipelineCache.Full())
@@ -1622,6 +2008,11 @@ bail:
             pipelineCache.Put(pipeline_hash, new_pipeline);
             cached_pipeline = pipelineCache.Get(pipeline_hash);
 
+            if (g_VulkanContext->m_RecordPipelineManifest && rt->m_Id == DM_RENDERTARGET_BACKBUFFER_ID)
+            {
+                RecordPipeline(g_VulkanContext, program, pipelineState, vk_sample_count, vertexDeclaration, vertexDeclarationCount);
+            }
+
             dmLogDebug("Created new VK Pipeline with hash %llu", (unsigned long long) pipeline_hash);
         }
 
@@ -2049,12 +2440,24 @@ bail:
         vk_write_desc_info.pBufferInfo    = &vk_buffer_info;
     }
 
-    static void UpdateDescriptorSets(VulkanContext* context, VkDevice vk_device, VkDescriptorSet* vk_descriptor_sets, Program* program, ScratchBuffer* scratch_buffer, uint32_t* dynamic_offsets, uint32_t dynamic_alignment)
+    static const uint32_t MAX_WRITE_DESCRIPTORS = MAX_SET_COUNT * MAX_BINDINGS_PER_SET_COUNT;
+
+    struct DescriptorWrites
+    {
+        VkWriteDescriptorSet   m_Writes[MAX_WRITE_DESCRIPTORS];
+        VkDescriptorImageInfo  m_ImageInfos[MAX_WRITE_DESCRIPTORS];
+        VkDescriptorBufferInfo m_BufferInfos[MAX_WRITE_DESCRIPTORS];
+        uint8_t                m_Sets[MAX_WRITE_DESCRIPTORS];
+        uint32_t               m_Count;
+    };
+
+    // Copies the uniform data to the scratch buffer and collects the descriptor writes for the program.
+    // The destination sets are filled in later, since the sets can be reused between draw calls.
+    static void PrepareDescriptorWrites(VulkanContext* context, Program* program, ScratchBuffer* scratch_buffer, uint32_t* dynamic_offsets, uint32_t dynamic_alignment, DescriptorWrites& writes)
     {
-        const uint32_t max_write_descriptors = MAX_SET_COUNT * MAX_BINDINGS_PER_SET_COUNT;
-        VkWriteDescriptorSet vk_write_descriptors[max_write_descriptors];
-        VkDescriptorImageInfo vk_write_image_descriptors[max_write_descriptors];
-        VkDescriptorBufferInfo vk_write_buffer_descriptors[max_write_descriptors];
+        VkWriteDescriptorSet* vk_write_descriptors          = writes.m_Writes;
+        VkDescriptorImageInfo* vk_write_image_descriptors   = writes.m_ImageInfos;
+        VkDescriptorBufferInfo* vk_write_buffer_descriptors = writes.m_BufferInfos;
 
         uint16_t uniform_to_write_index = 0;
         uint16_t image_to_write_index   = 0;
@@ -2069,10 +2472,11 @@ bail:
                 if (pgm_res.m_Res == 0x0)
                     continue;
 
+                writes.m_Sets[uniform_to_write_index]    = (uint8_t) set;
                 VkWriteDescriptorSet& vk_write_desc_info = vk_write_descriptors[uniform_to_write_index++];
                 vk_write_desc_info.sType                 = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
                 vk_write_desc_info.pNext                 = 0;
-                vk_write_desc_info.dstSet                = vk_descriptor_sets[set];
+                vk_write_desc_info.dstSet                = VK_NULL_HANDLE;
                 vk_write_desc_info.dstBinding            = binding;
                 vk_write_desc_info.dstArrayElement       = 0;
                 vk_write_desc_info.descriptorCount       = 1;
@@ -2130,7 +2534,38 @@ bail:
             }
         }
 
-        vkUpdateDescriptorSets(vk_device, uniform_to_write_index, vk_write_descriptors, 0, 0);
+        writes.m_Count = uniform_to_write_index;
+    }
+
+    static uint64_t GetDescriptorSetHash(Program* program, const DescriptorWrites& writes)
+    {
+        HashState64 hash_state;
+        dmHashInit64(&hash_state, false);
+        dmHashUpdateBuffer64(&hash_state, &program, sizeof(program));
+        dmHashUpdateBuffer64(&hash_state, &program->m_Hash, sizeof(program->m_Hash));
+
+        for (uint32_t i = 0; i < writes.m_Count; ++i)
+        {
+            const VkWriteDescriptorSet& vk_write = writes.m_Writes[i];
+            dmHashUpdateBuffer64(&hash_state, &writes.m_Sets[i], sizeof(writes.m_Sets[i]));
+            dmHashUpdateBuffer64(&hash_state, &vk_write.dstBinding, sizeof(vk_write.dstBinding));
+            dmHashUpdateBuffer64(&hash_state, &vk_write.descriptorType, sizeof(vk_write.descriptorType));
+
+            if (vk_write.pImageInfo)
+            {
+                dmHashUpdateBuffer64(&hash_state, &vk_write.pImageInfo->sampler, sizeof(vk_write.pImageInfo->sampler));
+                dmHashUpdateBuffer64(&hash_state, &vk_write.pImageInfo->imageView, sizeof(vk_write.pImageInfo->imageView));
+                dmHashUpdateBuffer64(&hash_state, &vk_write.pImageInfo->imageLayout, sizeof(vk_write.pImageInfo->imageLayout));
+            }
+            else if (vk_write.pBufferInfo)
+            {
+                dmHashUpdateBuffer64(&hash_state, &vk_write.pBufferInfo->buffer, sizeof(vk_write.pBufferInfo->buffer));
+                dmHashUpdateBuffer64(&hash_state, &vk_write.pBufferInfo->offset, sizeof(vk_write.pBufferInfo->offset));
+                dmHashUpdateBuffer64(&hash_state, &vk_write.pBufferInfo->range, sizeof(vk_write.pBufferInfo->range));
+            }
+        }
+
+        return dmHashFinal64(&hash_state);
     }
 
     static VkResult CommitUniforms(VulkanContext* context, VkCommandBuffer vk_command_buffer, VkDevice vk_device,
@@ -2145,14 +2580,41 @@ bail:
             return VK_SUCCESS;
         }
 
+        DescriptorWrites writes;
+        PrepareDescriptorWrites(context, program_ptr, scratch_buffer, dynamic_offsets, alignment, writes);
+
+        // Uniform buffers are bound with dynamic offsets, so the descriptor sets only depend on the
+        // bound resources. Draw calls with the same resources reuse the sets written earlier this frame.
+        DescriptorAllocator* allocator = scratch_buffer->m_DescriptorAllocator;
+        uint64_t descriptor_set_hash   = GetDescriptorSetHash(program_ptr, writes);
+        uint32_t* cached_set_index     = allocator->m_DescriptorSetCache.Get(descriptor_set_hash);
+
         VkDescriptorSet* vk_descriptor_set_list = 0x0;
-        VkResult res = scratch_buffer->m_DescriptorAllocator->Allocate(vk_device, program_ptr->m_Handle.m_DescriptorSetLayouts, program_ptr->m_Handle.m_DescriptorSetLayoutsCount, num_descriptors, &vk_descriptor_set_list);
-        if (res != VK_SUCCESS)
+        if (cached_set_index)
         {
-            return res;
+            vk_descriptor_set_list = &allocator->m_DescriptorSets[*cached_set_index];
         }
+        else
+        {
+            VkResult res = allocator->Allocate(vk_device, program_ptr->m_Handle.m_DescriptorSetLayouts, program_ptr->m_Handle.m_DescriptorSetLayoutsCount, num_descriptors, &vk_descriptor_set_list);
+            if (res != VK_SUCCESS)
+            {
+                return res;
+            }
+            AddDescriptorAllocationStat(program_ptr->m_Handle.m_DescriptorSetLayoutsCount);
+
+            for (uint32_t i = 0; i < writes.m_Count; ++i)
+            {
+                writes.m_Writes[i].dstSet = vk_descriptor_set_list[writes.m_Sets[i]];
+            }
+            vkUpdateDescriptorSets(vk_device, writes.m_Count, writes.m_Writes, 0, 0);
 
-        UpdateDescriptorSets(context, vk_device, vk_descriptor_set_list, program_ptr, scratch_buffer, dynamic_offsets, alignment);
+            if (allocator->m_DescriptorSetCache.Full())
+            {
+                allocator->m_DescriptorSetCache.SetCapacity(dmMath::Max(allocator->m_DescriptorSetCache.Capacity() / 4, 1U), allocator->m_DescriptorSetCache.Capacity() * 2);
+            }
+            allocator->m_DescriptorSetCache.Put(descriptor_set_hash, (uint32_t) (vk_descriptor_set_list - allocator->m_DescriptorSets));
+        }
 
         vkCmdBindDescriptorSets(vk_command_buffer,
             bind_point,
@@ -2224,7 +2686,7 @@ bail:
         VkResult res               = CommitUniforms(context, vk_command_buffer, vk_device, program_ptr, VK_PIPELINE_BIND_POINT_COMPUTE, scratchBuffer, context->m_DynamicOffsetBuffer, dynamic_alignment);
         CHECK_VK_ERROR(res);
 
-        Pipeline* pipeline = GetOrCreateComputePipeline(vk_device, context->m_PipelineCache, program_ptr);
+        Pipeline* pipeline = GetOrCreateComputePipeline(vk_device, context->m_DevicePipelineCache, context->m_PipelineCache, program_ptr);
         vkCmdBindPipeline(vk_command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, *pipeline);
     }
 
@@ -2308,7 +2770,12 @@ bail:
             vk_sample_count = context->m_SwapChain->m_SampleCountFlag;
         }
 
-        Pipeline* pipeline = GetOrCreatePipeline(vk_device, vk_sample_count,
+        if (program_ptr->m_PrecompileJobs)
+        {
+            FinishPrecompiledPipelines(context, program_ptr);
+        }
+
+        Pipeline* pipeline = GetOrCreatePipeline(vk_device, context->m_DevicePipelineCache, vk_sample_count,
             pipeline_state_draw, context->m_PipelineCache,
             program_ptr, current_rt, vx_declarations, num_vx_buffers);
 
@@ -2704,11 +3171,17 @@ bail:
     {
         Program* program = new Program;
         CreateGraphicsProgram((VulkanContext*) context, program, (ShaderModule*) vertex_program, (ShaderModule*) fragment_program);
+        PrecompilePipelines((VulkanContext*) context, program);
         return (HProgram) program;
     }
 
     static void DestroyProgram(HContext context, Program* program)
     {
+        if (program->m_PrecompileJobs)
+        {
+            FinishPrecompiledPipelines(g_VulkanContext, program);
+        }
+
         if (program->m_UniformData)
         {
             delete[] program->m_UniformData;
@@ -3213,14 +3686,63 @@ bail:
         return (VkAttachmentLoadOp) -1;
     }
 
+    // The attachments of render passes with different load and store ops are compatible,
+    // so all the render passes created here can be used with the framebuffer of the render target.
+    static VkResult CreateRenderTargetRenderPass(VulkanContext* context, RenderTarget* rt, uint32_t transient_buffer_types, VkRenderPass* render_pass_out)
+    {
+        RenderPassAttachment  rp_attachments[MAX_BUFFER_COLOR_ATTACHMENTS + 1];
+        RenderPassAttachment* rp_attachment_depth_stencil = 0;
+
+        for (int i = 0; i < rt->m_ColorAttachmentCount; ++i)
+        {
+            VulkanTexture* color_texture_ptr = GetAssetFromContainer<VulkanTexture>(context->m_AssetHandleContainer, rt->m_TextureColor[i]);
+            BufferType buffer_type           = rt->m_ColorAttachmentBufferTypes[i];
+            uint8_t color_buffer_index       = GetBufferTypeIndex(buffer_type);
+
+            RenderPassAttachment* rp_attachment_color = &rp_attachments[i];
+            rp_attachment_color->m_ImageLayout        = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+            rp_attachment_color->m_ImageLayoutInitial = VK_IMAGE_LAYOUT_UNDEFINED;
+            rp_attachment_color->m_Format             = color_texture_ptr->m_Format;
+            rp_attachment_color->m_LoadOp             = VulkanLoadOp(rt->m_ColorBufferLoadOps[color_buffer_index]);
+            rp_attachment_color->m_StoreOp            = VulkanStoreOp(rt->m_ColorBufferStoreOps[color_buffer_index]);
+
+            if (rp_attachment_color->m_LoadOp == VK_ATTACHMENT_LOAD_OP_LOAD)
+            {
+                rp_attachment_color->m_ImageLayoutInitial = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+            }
+
+            if (transient_buffer_types & buffer_type)
+            {
+                rp_attachment_color->m_StoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+            }
+        }
+
+        if (rt->m_TextureDepthStencil)
+        {
+            VulkanTexture* depth_stencil_texture_ptr = GetAssetFromContainer<VulkanTexture>(context->m_AssetHandleContainer, rt->m_TextureDepthStencil);
+
+            rp_attachment_depth_stencil                       = &rp_attachments[rt->m_ColorAttachmentCount];
+            rp_attachment_depth_stencil->m_ImageLayout        = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+            rp_attachment_depth_stencil->m_ImageLayoutInitial = VK_IMAGE_LAYOUT_UNDEFINED;
+            rp_attachment_depth_stencil->m_Format             = depth_stencil_texture_ptr->m_Format;
+            rp_attachment_depth_stencil->m_LoadOp             = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+            rp_attachment_depth_stencil->m_StoreOp            = VK_ATTACHMENT_STORE_OP_STORE;
+
+            // Depth and stencil share the attachment, so it can only be discarded if all of its buffer types are transient
+            if ((transient_buffer_types & rt->m_DepthStencilBufferTypes) == rt->m_DepthStencilBufferTypes)
+            {
+                rp_attachment_depth_stencil->m_StoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+            }
+        }
+
+        return CreateRenderPass(context->m_LogicalDevice.m_Device, VK_SAMPLE_COUNT_1_BIT, rp_attachments, rt->m_ColorAttachmentCount, rp_attachment_depth_stencil, 0, render_pass_out);
+    }
+
     static VkResult CreateRenderTarget(VulkanContext* context, HTexture* color_textures, BufferType* buffer_types, uint8_t num_color_textures,  HTexture depth_stencil_texture, uint32_t width, uint32_t height, RenderTarget* rtOut)
     {
         assert(rtOut->m_Handle.m_Framebuffer == VK_NULL_HANDLE && rtOut->m_Handle.m_RenderPass == VK_NULL_HANDLE);
         const uint8_t num_attachments = MAX_BUFFER_COLOR_ATTACHMENTS + 1;
 
-        RenderPassAttachment  rp_attachments[num_attachments];
-        RenderPassAttachment* rp_attachment_depth_stencil = 0;
-
         VkImageView fb_attachments[num_attachments];
         uint16_t    fb_attachment_count = 0;
         uint16_t    fb_width            = width;
@@ -3235,19 +3757,10 @@ bail:
             fb_width                   = rtOut->m_ColorTextureParams[color_buffer_index].m_Width;
             fb_height                  = rtOut->m_ColorTextureParams[color_buffer_index].m_Height;
 
-            RenderPassAttachment* rp_attachment_color = &rp_attachments[i];
-            rp_attachment_color->m_ImageLayout        = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-            rp_attachment_color->m_ImageLayoutInitial = VK_IMAGE_LAYOUT_UNDEFINED;
-            rp_attachment_color->m_Format             = color_texture_ptr->m_Format;
-            rp_attachment_color->m_LoadOp             = VulkanLoadOp(rtOut->m_ColorBufferLoadOps[color_buffer_index]);
-            rp_attachment_color->m_StoreOp            = VulkanStoreOp(rtOut->m_ColorBufferStoreOps[color_buffer_index]);
-
-            if (rp_attachment_color->m_LoadOp == VK_ATTACHMENT_LOAD_OP_LOAD)
-            {
-                rp_attachment_color->m_ImageLayoutInitial = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-            }
-
             fb_attachments[fb_attachment_count++] = color_texture_ptr->m_Handle.m_ImageView;
+
+            rtOut->m_TextureColor[i] = color_textures[i];
+            rtOut->m_ColorAttachmentBufferTypes[i] = buffer_types[i];
         }
 
         if (depth_stencil_texture)
@@ -3259,14 +3772,13 @@ bail:
                 fb_height = rtOut->m_DepthStencilTextureParams.m_Height;
             }
 
-            rp_attachment_depth_stencil                = &rp_attachments[fb_attachment_count];
-            rp_attachment_depth_stencil->m_ImageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-            rp_attachment_depth_stencil->m_Format      = depth_stencil_texture_ptr->m_Format;
-
             fb_attachments[fb_attachment_count++] = depth_stencil_texture_ptr->m_Handle.m_ImageView;
         }
 
-        VkResult res = CreateRenderPass(context->m_LogicalDevice.m_Device, VK_SAMPLE_COUNT_1_BIT, rp_attachments, num_color_textures, rp_attachment_depth_stencil, 0, &rtOut->m_Handle.m_RenderPass);
+        rtOut->m_ColorAttachmentCount = num_color_textures;
+        rtOut->m_TextureDepthStencil  = depth_stencil_texture;
+
+        VkResult res = CreateRenderTargetRenderPass(context, rtOut, 0, &rtOut->m_Handle.m_RenderPass);
         if (res != VK_SUCCESS)
         {
             return res;
@@ -3279,22 +3791,38 @@ bail:
             return res;
         }
 
-        for (int i = 0; i < num_color_textures; ++i)
+        rtOut->m_Extent.width  = fb_width;
+        rtOut->m_Extent.height = fb_height;
+
+        return VK_SUCCESS;
+    }
+
+    static void DestroyTransientRenderPass(VulkanContext* context, RenderTarget* render_target)
+    {
+        if (render_target->m_TransientRenderPass == VK_NULL_HANDLE)
         {
-            rtOut->m_TextureColor[i] = color_textures[i];
-            rtOut->m_ColorAttachmentBufferTypes[i] = buffer_types[i];
+            return;
         }
 
-        rtOut->m_ColorAttachmentCount = num_color_textures;
-        rtOut->m_TextureDepthStencil  = depth_stencil_texture;
-        rtOut->m_Extent.width         = fb_width;
-        rtOut->m_Extent.height        = fb_height;
+        ResourceToDestroy resource_to_destroy;
+        resource_to_destroy.m_ResourceType               = RESOURCE_TYPE_RENDER_TARGET;
+        resource_to_destroy.m_RenderTarget.m_RenderPass  = render_target->m_TransientRenderPass;
+        resource_to_destroy.m_RenderTarget.m_Framebuffer = VK_NULL_HANDLE;
 
-        return VK_SUCCESS;
+        ResourcesToDestroyList* resource_list = context->m_MainResourcesToDestroy[context->m_SwapChain->m_ImageIndex];
+        if (resource_list->Full())
+        {
+            resource_list->OffsetCapacity(8);
+        }
+        resource_list->Push(resource_to_destroy);
+
+        render_target->m_TransientRenderPass            = VK_NULL_HANDLE;
+        render_target->m_TransientRenderPassBufferTypes = 0;
     }
 
     static void DestroyRenderTarget(VulkanContext* context, RenderTarget* renderTarget)
     {
+        DestroyTransientRenderPass(context, renderTarget);
         DestroyResourceDeferred(context->m_MainResourcesToDestroy[g_VulkanContext->m_SwapChain->m_ImageIndex], renderTarget);
         renderTarget->m_Handle.m_Framebuffer = VK_NULL_HANDLE;
         renderTarget->m_Handle.m_RenderPass = VK_NULL_HANDLE;
@@ -3455,6 +3983,8 @@ bail:
             CHECK_VK_ERROR(res);
         }
 
+        rt->m_DepthStencilBufferTypes = buffer_type_flags & (BUFFER_TYPE_DEPTH_BIT | BUFFER_TYPE_STENCIL_BIT);
+
         if (color_index > 0 || has_depth || has_stencil)
         {
             VkResult res = CreateRenderTarget(g_VulkanContext, texture_color, buffer_types, color_index, texture_depth_stencil, fb_width, fb_height, rt);
@@ -3489,9 +4019,30 @@ bail:
 
     static void VulkanSetRenderTarget(HContext _context, HRenderTarget render_target, uint32_t transient_buffer_types)
     {
-        (void) transient_buffer_types;
         VulkanContext* context = (VulkanContext*) _context;
         context->m_ViewportChanged = 1;
+
+        if (render_target != 0x0)
+        {
+            RenderTarget* rt = GetAssetFromContainer<RenderTarget>(context->m_AssetHandleContainer, render_target);
+
+            // Transient buffers are discarded at the end of the render pass instead of being stored,
+            // which saves the bandwidth of writing them back to memory on tile based GPUs.
+            // Render targets with sub passes have their render pass set up by the user.
+            if (!rt->m_IsBound && rt->m_SubPassCount == 0 && rt->m_Handle.m_RenderPass != VK_NULL_HANDLE)
+            {
+                rt->m_TransientBufferTypes = transient_buffer_types;
+
+                if (transient_buffer_types && transient_buffer_types != rt->m_TransientRenderPassBufferTypes)
+                {
+                    DestroyTransientRenderPass(context, rt);
+                    VkResult res = CreateRenderTargetRenderPass(context, rt, transient_buffer_types, &rt->m_TransientRenderPass);
+                    CHECK_VK_ERROR(res);
+                    rt->m_TransientRenderPassBufferTypes = transient_buffer_types;
+                }
+            }
+        }
+
         BeginRenderPass(context, render_target != 0x0 ? render_target : context->m_MainRenderTarget);
     }
 
@@ -3739,11 +4290,16 @@ bail:
             vk_submit_info.commandBufferCount = 1;
             vk_submit_info.pCommandBuffers    = &vk_command_buffer;
 
-            DeviceBuffer stage_buffer(VK_BUFFER_USAGE_TRANSFER_SRC_BIT);
-
-            res = CreateDeviceBuffer(context->m_PhysicalDevice.m_Device, vk_device, texDataSize,
-                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &stage_buffer);
-            CHECK_VK_ERROR(res);
+            // The stage buffer is owned by the context and reused between uploads, it is only reallocated when
+            // an upload doesn't fit. This is safe since we wait for the copy to finish before returning.
+            DeviceBuffer& stage_buffer = context->m_TextureStagingBuffer;
+            if (texDataSize > stage_buffer.m_MemorySize)
+            {
+                DestroyDeviceBuffer(vk_device, &stage_buffer.m_Handle);
+                res = CreateDeviceBuffer(context->m_PhysicalDevice.m_Device, vk_device, texDataSize,
+                    VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &stage_buffer);
+                CHECK_VK_ERROR(res);
+            }
 
             res = WriteToDeviceBuffer(vk_device, texDataSize, 0, texDataPtr, &stage_buffer);
             CHECK_VK_ERROR(res);
@@ -3801,8 +4357,6 @@ bail:
                 layer_count);
             CHECK_VK_ERROR(res);
 
-            DestroyDeviceBuffer(vk_device, &stage_buffer.m_Handle);
-
             vkFreeCommandBuffers(vk_device, context->m_LogicalDevice.m_CommandPool, 1, &vk_command_buffer);
 
             delete[] vk_copy_regions;
@@ -3989,7 +4543,16 @@ bail:
 
         context->m_PipelineCache.Iterate(DestroyPipelineCacheCb, context);
 
+        if (context->m_PipelineManifestPath && context->m_RecordPipelineManifest && !context->m_RecordedPipelines.Empty())
+        {
+            SavePipelineManifest(context);
+        }
+
+        DestroyDevicePipelineCache(context);
+        DestroyReadbacks(context);
+
         DestroyDeviceBuffer(vk_device, &context->m_MainTextureDepthStencil.m_DeviceBuffer.m_Handle);
+        DestroyDeviceBuffer(vk_device, &context->m_TextureStagingBuffer.m_Handle);
         DestroyTexture(vk_device, &context->m_MainTextureDepthStencil.m_Handle);
         DestroyTexture(vk_device, &context->m_DefaultTexture2D->m_Handle);
         DestroyTexture(vk_device, &context->m_DefaultTexture2DArray->m_Handle);
@@ -4256,6 +4819,140 @@ bail:
         }
     }
 
+    // Copies the swap chain image to a ring of host visible stage buffers, and reads the oldest one when it's about to be reused.
+    // The copy is submitted with a fence instead of waiting for the queue to go idle, so the frame isn't stalled
+    static bool VulkanReadPixelsAsync(HContext _context, void* buffer, uint32_t buffer_size)
+    {
+        VulkanContext* context = (VulkanContext*) _context;
+        VkDevice vk_device     = context->m_LogicalDevice.m_Device;
+
+        uint32_t w    = context->m_WindowWidth;
+        uint32_t h    = context->m_WindowHeight;
+        uint32_t size = w * h * 4;
+        assert (buffer_size >= size);
+
+        Readback& readback = context->m_Readbacks[context->m_ReadbackFrame % READBACK_FRAME_COUNT];
+        context->m_ReadbackFrame++;
+
+        bool result = false;
+        if (readback.m_Size)
+        {
+            // Submitted a few frames ago, so this rarely waits
+            vkWaitForFences(vk_device, 1, &readback.m_Fence, VK_TRUE, UINT64_MAX);
+
+            // A read of a different size (e.g. before a resize) is dropped
+            if (readback.m_Size == size)
+            {
+                memcpy(buffer, readback.m_StageBuffer.m_MappedDataPtr, size);
+                result = true;
+            }
+            readback.m_Size = 0;
+        }
+
+        VkResult res;
+        if (readback.m_CmdBuffer == VK_NULL_HANDLE)
+        {
+            res = CreateCommandBuffers(vk_device, context->m_LogicalDevice.m_CommandPool, 1, &readback.m_CmdBuffer);
+            CHECK_VK_ERROR(res);
+
+            VkFenceCreateInfo vk_create_fence_info;
+            memset(&vk_create_fence_info, 0, sizeof(vk_create_fence_info));
+            vk_create_fence_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+            res = vkCreateFence(vk_device, &vk_create_fence_info, 0, &readback.m_Fence);
+            CHECK_VK_ERROR(res);
+        }
+
+        if (readback.m_StageBuffer.m_MemorySize < size)
+        {
+            if (readback.m_StageBuffer.m_Handle.m_Buffer != VK_NULL_HANDLE)
+            {
+                readback.m_StageBuffer.UnmapMemory(vk_device);
+                DestroyDeviceBuffer(vk_device, &readback.m_StageBuffer.m_Handle);
+            }
+            readback.m_StageBuffer = DeviceBuffer(VK_BUFFER_USAGE_TRANSFER_DST_BIT);
+            res = CreateDeviceBuffer(context->m_PhysicalDevice.m_Device, vk_device, size,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &readback.m_StageBuffer);
+            CHECK_VK_ERROR(res);
+            // Kept mapped for as long as the buffer lives
+            res = readback.m_StageBuffer.MapMemory(vk_device);
+            CHECK_VK_ERROR(res);
+        }
+
+        VkCommandBufferBeginInfo vk_command_buffer_begin_info;
+        memset(&vk_command_buffer_begin_info, 0, sizeof(vk_command_buffer_begin_info));
+        vk_command_buffer_begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        vk_command_buffer_begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        res = vkBeginCommandBuffer(readback.m_CmdBuffer, &vk_command_buffer_begin_info);
+        CHECK_VK_ERROR(res);
+
+        VkImageMemoryBarrier vk_barrier            = {};
+        vk_barrier.sType                           = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        vk_barrier.srcQueueFamilyIndex             = VK_QUEUE_FAMILY_IGNORED;
+        vk_barrier.dstQueueFamilyIndex             = VK_QUEUE_FAMILY_IGNORED;
+        vk_barrier.image                           = context->m_SwapChain->Image();
+        vk_barrier.subresourceRange.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+        vk_barrier.subresourceRange.levelCount     = 1;
+        vk_barrier.subresourceRange.layerCount     = 1;
+
+        // The image has been rendered and handed to the presentation engine (see VulkanFlip)
+        vk_barrier.oldLayout     = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+        vk_barrier.newLayout     = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        vk_barrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+        vk_barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+        vkCmdPipelineBarrier(readback.m_CmdBuffer, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, 0, 0, 0, 1, &vk_barrier);
+
+        VkBufferImageCopy vk_copy_region = {};
+        vk_copy_region.imageExtent.width           = w;
+        vk_copy_region.imageExtent.height          = h;
+        vk_copy_region.imageExtent.depth           = 1;
+        vk_copy_region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        vk_copy_region.imageSubresource.layerCount = 1;
+        vkCmdCopyImageToBuffer(readback.m_CmdBuffer, context->m_SwapChain->Image(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+            readback.m_StageBuffer.m_Handle.m_Buffer, 1, &vk_copy_region);
+
+        vk_barrier.oldLayout     = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        vk_barrier.newLayout     = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+        vk_barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+        vk_barrier.dstAccessMask = 0;
+        vkCmdPipelineBarrier(readback.m_CmdBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, 0, 0, 0, 1, &vk_barrier);
+
+        res = vkEndCommandBuffer(readback.m_CmdBuffer);
+        CHECK_VK_ERROR(res);
+
+        VkSubmitInfo vk_submit_info       = {};
+        vk_submit_info.sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        vk_submit_info.commandBufferCount = 1;
+        vk_submit_info.pCommandBuffers    = &readback.m_CmdBuffer;
+
+        vkResetFences(vk_device, 1, &readback.m_Fence);
+        res = vkQueueSubmit(context->m_LogicalDevice.m_GraphicsQueue, 1, &vk_submit_info, readback.m_Fence);
+        CHECK_VK_ERROR(res);
+
+        readback.m_Size = size;
+        return result;
+    }
+
+    static void DestroyReadbacks(VulkanContext* context)
+    {
+        VkDevice vk_device = context->m_LogicalDevice.m_Device;
+        for (uint32_t i = 0; i < READBACK_FRAME_COUNT; ++i)
+        {
+            Readback& readback = context->m_Readbacks[i];
+            if (readback.m_CmdBuffer == VK_NULL_HANDLE)
+                continue;
+
+            vkWaitForFences(vk_device, 1, &readback.m_Fence, VK_TRUE, UINT64_MAX);
+            vkDestroyFence(vk_device, readback.m_Fence, 0);
+            vkFreeCommandBuffers(vk_device, context->m_LogicalDevice.m_CommandPool, 1, &readback.m_CmdBuffer);
+            if (readback.m_StageBuffer.m_Handle.m_Buffer != VK_NULL_HANDLE)
+            {
+                readback.m_StageBuffer.UnmapMemory(vk_device);
+                DestroyDeviceBuffer(vk_device, &readback.m_StageBuffer.m_Handle);
+            }
+            memset(&readback, 0, sizeof(readback));
+        }
+    }
+
     static dmPlatform::HWindow VulkanGetWindow(HContext context)
     {
         return ((VulkanContext*) context)->m_Window;
@@ -4291,6 +4988,13 @@ bail:
 
     static bool VulkanIsContextFeatureSupported(HContext context, ContextFeature feature)
     {
+    #ifdef __MACH__
+        // Coherent memory writes are not properly synced on MoltenVK, see SetDeviceBuffer
+        if (feature == CONTEXT_FEATURE_BUFFER_MAPPING)
+        {
+            return false;
+        }
+    #endif
         return true;
     }
 
@@ -4361,7 +5065,7 @@ bail:
     HStorageBuffer VulkanNewStorageBuffer(HContext _context, uint32_t buffer_size)
     {
         VulkanContext* context       = (VulkanContext*) _context;
-        DeviceBuffer* storage_buffer = new DeviceBuffer(VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+        DeviceBuffer* storage_buffer = new DeviceBuffer(VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT);
 
         if (buffer_size > 0)
         {
@@ -4397,8 +5101,7 @@ bail:
         uint32_t binding     = UNIFORM_LOCATION_GET_VS_MEMBER(base_location);
         assert(!(set == UNIFORM_LOCATION_MAX && binding == UNIFORM_LOCATION_MAX));
 
-        // TODO!
-        assert(program_ptr->m_ComputeModule == 0x0);
+        // Compute programs use the same resource bindings, so they can write to storage buffers as well
         assert(program_ptr->m_ResourceBindings[set][binding].m_Res);
         program_ptr->m_ResourceBindings[set][binding].m_StorageBufferUnit = binding_index;
     }
@@ -4791,6 +5494,38 @@ bail:
         vkCmdDraw(vk_command_buffer, count, instance_count, first, base_instance);
     }
 
+    void VulkanDrawElementsIndirect(HContext _context, PrimitiveType prim_type, Type type, HIndexBuffer index_buffer, HStorageBuffer indirect_buffer, uint32_t offset, uint32_t draw_count)
+    {
+        DM_PROFILE(__FUNCTION__);
+        DM_PROPERTY_ADD_U32(rmtp_DrawCalls, 1);
+
+        VulkanContext* context = (VulkanContext*) _context;
+
+        assert(context->m_FrameBegun);
+        assert(indirect_buffer);
+        const uint8_t image_ix = context->m_SwapChain->m_ImageIndex;
+        VkCommandBuffer vk_command_buffer = context->m_MainCommandBuffers[image_ix];
+        context->m_PipelineState.m_PrimtiveType = prim_type;
+        DrawSetup(context, vk_command_buffer, &context->m_MainScratchBuffers[image_ix], (DeviceBuffer*) index_buffer, type);
+
+        DM_STATIC_ASSERT(sizeof(DrawElementsIndirectCommand) == sizeof(VkDrawIndexedIndirectCommand), Invalid_Struct_Size);
+        VkBuffer vk_indirect_buffer = ((DeviceBuffer*) indirect_buffer)->m_Handle.m_Buffer;
+        const uint32_t stride       = sizeof(VkDrawIndexedIndirectCommand);
+
+        // Without the multiDrawIndirect feature, the draw count must be 0 or 1
+        if (context->m_PhysicalDevice.m_Features.multiDrawIndirect || draw_count <= 1)
+        {
+            vkCmdDrawIndexedIndirect(vk_command_buffer, vk_indirect_buffer, offset, draw_count, stride);
+        }
+        else
+        {
+            for (uint32_t i = 0; i < draw_count; ++i)
+            {
+                vkCmdDrawIndexedIndirect(vk_command_buffer, vk_indirect_buffer, offset + i * stride, 1, stride);
+            }
+        }
+    }
+
     void VulkanSetVertexDeclarationStepFunction(HContext, HVertexDeclaration vertex_declaration, VertexStepFunction step_function)
     {
         vertex_declaration->m_StepFunction = step_function;
@@ -4911,6 +5646,9 @@ bail:
         if (bits & STAGE_FLAG_QUEUE_END)                  flags |= VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
         if (bits & STAGE_FLAG_FRAGMENT_SHADER)            flags |= VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
         if (bits & STAGE_FLAG_EARLY_FRAGMENT_SHADER_TEST) flags |= VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+        if (bits & STAGE_FLAG_COMPUTE_SHADER)             flags |= VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+        if (bits & STAGE_FLAG_VERTEX_SHADER)              flags |= VK_PIPELINE_STAGE_VERTEX_SHADER_BIT;
+        if (bits & STAGE_FLAG_DRAW_INDIRECT)              flags |= VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT;
         return flags;
     }
 
@@ -4922,6 +5660,10 @@ bail:
             if (bits & ACCESS_FLAG_READ)  flags |= VK_ACCESS_SHADER_READ_BIT;
             if (bits & ACCESS_FLAG_WRITE) flags |= VK_ACCESS_SHADER_WRITE_BIT;
         }
+        if (bits & ACCESS_FLAG_INDIRECT_COMMAND)
+        {
+            flags |= VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+        }
         return flags;
     }
 
@@ -5003,6 +5745,7 @@ bail:
     {
         GraphicsAdapterFunctionTable fn_table = {};
         DM_REGISTER_GRAPHICS_FUNCTION_TABLE(fn_table, Vulkan);
+        DM_REGISTER_GRAPHICS_FUNCTION(fn_table, Vulkan, ReadPixelsAsync);
         return fn_table;
     }
 }
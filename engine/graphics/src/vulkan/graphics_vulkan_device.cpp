@@ -37,8 +37,12 @@ namespace dmGraphics
     }
 
     RenderTarget::RenderTarget(const uint32_t rtId)
-        : m_SubPasses(0)
+        : m_TransientRenderPass(VK_NULL_HANDLE)
+        , m_SubPasses(0)
         , m_TextureDepthStencil(0)
+        , m_DepthStencilBufferTypes(0)
+        , m_TransientBufferTypes(0)
+        , m_TransientRenderPassBufferTypes(0)
         , m_Id(rtId)
         , m_IsBound(0)
         , m_SubPassCount(0)
@@ -240,6 +244,8 @@ namespace dmGraphics
 
     void DescriptorAllocator::Reset(VkDevice vk_device)
     {
+        m_DescriptorSetCache.Clear();
+
         if (m_DescriptorSetIndex > 0)
         {
             for (int i = 0; i < m_DescriptorPools.Size(); ++i)
@@ -774,6 +780,12 @@ bail:
         descriptorAllocator->m_DescriptorSetMax   = descriptor_count;
         descriptorAllocator->m_DescriptorsPerPool = descriptor_count;
         AllocateDescriptorSets(descriptorAllocator);
+
+        // The allocator lives in zeroed memory, so swap in a properly constructed table
+        dmHashTable64<uint32_t> descriptor_set_cache;
+        descriptor_set_cache.SetCapacity(dmMath::Max(descriptor_count / 4, 1U), descriptor_count);
+        descriptorAllocator->m_DescriptorSetCache.Swap(descriptor_set_cache);
+
         return AllocateDescriptorPool(descriptorAllocator, vk_device);
     }
 
@@ -1011,8 +1023,8 @@ bail:
 
             attachment_depth.format         = depthStencilAttachment->m_Format;
             attachment_depth.samples        = vk_sample_flags;
-            attachment_depth.loadOp         = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-            attachment_depth.storeOp        = VK_ATTACHMENT_STORE_OP_STORE;
+            attachment_depth.loadOp         = depthStencilAttachment->m_LoadOp;
+            attachment_depth.storeOp        = depthStencilAttachment->m_StoreOp;
             attachment_depth.stencilLoadOp  = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
             attachment_depth.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
             attachment_depth.initialLayout  = VK_IMAGE_LAYOUT_UNDEFINED;
@@ -1192,7 +1204,7 @@ bail:
         VK_COMPARE_OP_ALWAYS
     };
 
-    VkResult CreateComputePipeline(VkDevice vk_device, Program* program, Pipeline* pipelineOut)
+    VkResult CreateComputePipeline(VkDevice vk_device, VkPipelineCache vk_pipeline_cache, Program* program, Pipeline* pipelineOut)
     {
         assert(pipelineOut && *pipelineOut == VK_NULL_HANDLE);
 
@@ -1204,10 +1216,10 @@ bail:
         vk_pipeline_create_info.layout             = program->m_Handle.m_PipelineLayout;
         vk_pipeline_create_info.pNext              = 0;
         vk_pipeline_create_info.stage              = program->m_ComputeModule->m_PipelineStageInfo;
-        return vkCreateComputePipelines(vk_device, 0, 1, &vk_pipeline_create_info, 0, pipelineOut);
+        return vkCreateComputePipelines(vk_device, vk_pipeline_cache, 1, &vk_pipeline_create_info, 0, pipelineOut);
     }
 
-    VkResult CreateGraphicsPipeline(VkDevice vk_device, VkRect2D vk_scissor, VkSampleCountFlagBits vk_sample_count,
+    VkResult CreateGraphicsPipeline(VkDevice vk_device, VkPipelineCache vk_pipeline_cache, VkRect2D vk_scissor, VkSampleCountFlagBits vk_sample_count,
         PipelineState pipelineState, Program* program, VertexDeclaration** vertexDeclarations, uint32_t vertexDeclarationCount,
         RenderTarget* render_target, Pipeline* pipelineOut)
     {
@@ -1414,7 +1426,7 @@ bail:
         vk_pipeline_info.basePipelineHandle  = VK_NULL_HANDLE;
         vk_pipeline_info.basePipelineIndex   = -1;
 
-        return vkCreateGraphicsPipelines(vk_device, VK_NULL_HANDLE, 1, &vk_pipeline_info, 0, pipelineOut);
+        return vkCreateGraphicsPipelines(vk_device, vk_pipeline_cache, 1, &vk_pipeline_info, 0, pipelineOut);
     }
 
     void ResetScratchBuffer(VkDevice vk_device, ScratchBuffer* scratchBuffer)
@@ -1466,6 +1478,9 @@ bail:
         delete[] allocator->m_DescriptorSets;
         allocator->m_DescriptorSets = 0x0;
 
+        dmHashTable64<uint32_t> empty_cache;
+        allocator->m_DescriptorSetCache.Swap(empty_cache);
+
         for (int i = 0; i < allocator->m_DescriptorPools.Size(); ++i)
         {
             vkDestroyDescriptorPool(vk_device, allocator->m_DescriptorPools[i].m_DescriptorPool, 0);
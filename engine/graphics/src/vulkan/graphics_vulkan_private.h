@@ -131,6 +131,8 @@ namespace dmGraphics
     struct DescriptorAllocator
     {
         dmArray<DescriptorPool> m_DescriptorPools;
+        // Maps the contents of the descriptor sets written this frame to their index in m_DescriptorSets
+        dmHashTable64<uint32_t> m_DescriptorSetCache;
         VkDescriptorSet*        m_DescriptorSets;
         uint32_t                m_DescriptorSetIndex;
         uint32_t                m_DescriptorSetMax;
@@ -171,6 +173,8 @@ namespace dmGraphics
         };
 
         VulkanHandle   m_Handle;
+        // Same as m_Handle.m_RenderPass, but discards the buffers in m_TransientRenderPassBufferTypes
+        VkRenderPass   m_TransientRenderPass;
 
         AttachmentOp   m_ColorBufferLoadOps[MAX_BUFFER_COLOR_ATTACHMENTS];
         AttachmentOp   m_ColorBufferStoreOps[MAX_BUFFER_COLOR_ATTACHMENTS];
@@ -182,6 +186,9 @@ namespace dmGraphics
         SubPass*       m_SubPasses;
         HTexture       m_TextureColor[MAX_BUFFER_COLOR_ATTACHMENTS];
         HTexture       m_TextureDepthStencil;
+        uint32_t       m_DepthStencilBufferTypes;
+        uint32_t       m_TransientBufferTypes; // Set by the last SetRenderTarget
+        uint32_t       m_TransientRenderPassBufferTypes;
 
         VkExtent2D     m_Extent;
         VkRect2D       m_Scissor;
@@ -296,6 +303,11 @@ namespace dmGraphics
         uint16_t                        m_TotalResourcesCount;
         uint16_t                        m_TotalUniformCount;
 
+        // Pipelines from the pipeline manifest that are being compiled in the background
+        dmJobThread::JobGroup           m_PrecompileGroup;
+        struct PipelinePrecompileJob*   m_PrecompileJobs;
+        uint32_t                        m_PrecompileJobCount;
+
         uint8_t                         m_MaxSet;
         uint8_t                         m_MaxBinding;
         uint8_t                         m_Destroyed : 1;
@@ -303,6 +315,27 @@ namespace dmGraphics
         const VulkanResourceType GetType();
     };
 
+    // A pipeline that was created for the main render target, recorded so that it can
+    // be compiled ahead of time in later sessions
+    struct PipelineManifestEntry
+    {
+        uint64_t          m_ProgramHash;
+        PipelineState     m_PipelineState;
+        VertexDeclaration m_VertexDeclarations[MAX_VERTEX_BUFFERS];
+        uint32_t          m_VertexDeclarationCount;
+        uint32_t          m_SampleCount;
+    };
+
+    struct PipelinePrecompileJob
+    {
+        PipelineManifestEntry m_Entry;
+        Program*              m_Program;
+        RenderTarget*         m_RenderTarget;
+        VkRect2D              m_Scissor;
+        Pipeline              m_Pipeline;
+        VkResult              m_Result;
+    };
+
     struct ResourceToDestroy
     {
         union
@@ -358,6 +391,17 @@ namespace dmGraphics
         VkImageView ImageView() { return m_ImageViews[m_ImageIndex]; }
     };
 
+    // The number of frames a frame buffer read is in flight, before its stage buffer is read
+    const static uint32_t READBACK_FRAME_COUNT = 3;
+
+    struct Readback
+    {
+        DeviceBuffer    m_StageBuffer;
+        VkCommandBuffer m_CmdBuffer;
+        VkFence         m_Fence;
+        uint32_t        m_Size; // The size of the pixels read to the stage buffer, 0 if none
+    };
+
     struct VulkanContext
     {
         VulkanContext(const ContextParams& params, const VkInstance vk_instance);
@@ -367,6 +411,12 @@ namespace dmGraphics
         HTexture                           m_TextureUnits[DM_MAX_TEXTURE_UNITS];
         dmOpaqueHandleContainer<uintptr_t> m_AssetHandleContainer;
         PipelineCache                      m_PipelineCache;
+        VkPipelineCache                    m_DevicePipelineCache;
+        char*                              m_PipelineCachePath;
+        dmArray<PipelineManifestEntry>     m_PipelineManifest;
+        dmArray<PipelineManifestEntry>     m_RecordedPipelines;
+        char*                              m_PipelineManifestPath;
+        dmJobThread::HContext              m_JobThread;
         PipelineState                      m_PipelineState;
         SwapChain*                         m_SwapChain;
         SwapChainCapabilities              m_SwapChainCapabilities;
@@ -386,6 +436,7 @@ namespace dmGraphics
         dmArray<VkFramebuffer>          m_MainFrameBuffers;
         dmArray<VkCommandBuffer>        m_MainCommandBuffers;
         VkCommandBuffer                 m_MainCommandBufferUploadHelper;
+        DeviceBuffer                    m_TextureStagingBuffer;
         ResourcesToDestroyList*         m_MainResourcesToDestroy[3];
         dmArray<ScratchBuffer>          m_MainScratchBuffers;
         dmArray<DescriptorAllocator>    m_MainDescriptorAllocators;
@@ -414,6 +465,8 @@ namespace dmGraphics
         VulkanTexture*                  m_DefaultTexture2D32UI;
         VulkanTexture*                  m_DefaultStorageImage2D;
         VulkanTexture                   m_ResolveTexture;
+        Readback                        m_Readbacks[READBACK_FRAME_COUNT];
+        uint32_t                        m_ReadbackFrame;
 
         uint64_t                        m_TextureFormatSupport;
         uint32_t                        m_Width;
@@ -429,6 +482,7 @@ namespace dmGraphics
         uint32_t                        m_CullFaceChanged      : 1;
         uint32_t                        m_UseValidationLayers  : 1;
         uint32_t                        m_RenderDocSupport     : 1;
+        uint32_t                        m_RecordPipelineManifest : 1;
     };
 
     // Implemented in graphics_vulkan_context.cpp
@@ -459,8 +513,8 @@ namespace dmGraphics
     VkResult CreateRenderPass(VkDevice vk_device, VkSampleCountFlagBits vk_sample_flags, RenderPassAttachment* colorAttachments, uint8_t numColorAttachments, RenderPassAttachment* depthStencilAttachment, RenderPassAttachment* resolveAttachment, VkRenderPass* renderPassOut);
     VkResult CreateDeviceBuffer(VkPhysicalDevice vk_physical_device, VkDevice vk_device, VkDeviceSize vk_size, VkMemoryPropertyFlags vk_memory_flags, DeviceBuffer* bufferOut);
     VkResult CreateShaderModule(VkDevice vk_device, const void* source, uint32_t sourceSize, VkShaderStageFlagBits stage_flag, ShaderModule* shaderModuleOut);
-    VkResult CreateGraphicsPipeline(VkDevice vk_device, VkRect2D vk_scissor, VkSampleCountFlagBits vk_sample_count, const PipelineState pipelineState, Program* program, VertexDeclaration** vertexDeclarations, uint32_t vertexDeclarationCount, RenderTarget* render_target, Pipeline* pipelineOut);
-    VkResult CreateComputePipeline(VkDevice vk_device, Program* program, Pipeline* pipelineOut);
+    VkResult CreateGraphicsPipeline(VkDevice vk_device, VkPipelineCache vk_pipeline_cache, VkRect2D vk_scissor, VkSampleCountFlagBits vk_sample_count, const PipelineState pipelineState, Program* program, VertexDeclaration** vertexDeclarations, uint32_t vertexDeclarationCount, RenderTarget* render_target, Pipeline* pipelineOut);
+    VkResult CreateComputePipeline(VkDevice vk_device, VkPipelineCache vk_pipeline_cache, Program* program, Pipeline* pipelineOut);
 
     // Destroy functions
     void DestroyDeviceBuffer(VkDevice vk_device, DeviceBuffer::VulkanHandle* handle);
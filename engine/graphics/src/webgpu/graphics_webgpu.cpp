@@ -391,15 +391,20 @@ static void WebGPUSetTextureInternal(WebGPUTexture* texture, const TextureParams
             }
             const uint8_t repackBPP     = 4;
             const uint32_t repackPixels = params.m_Width * params.m_Height * depth;
-            uint8_t* repackData         = new uint8_t[repackPixels * repackBPP];
+            if (g_WebGPUContext->m_RepackBufferSize < repackPixels * repackBPP)
+            {
+                delete[] g_WebGPUContext->m_RepackBuffer;
+                g_WebGPUContext->m_RepackBufferSize = repackPixels * repackBPP;
+                g_WebGPUContext->m_RepackBuffer     = new uint8_t[g_WebGPUContext->m_RepackBufferSize];
+            }
+            // wgpuQueueWriteTexture copies the data immediately, so the buffer can be reused for the next upload
+            uint8_t* repackData = g_WebGPUContext->m_RepackBuffer;
             RepackRGBToRGBA(repackPixels, (uint8_t*)params.m_Data, repackData);
 
             dest.texture              = texture->m_Texture;
             layout.bytesPerRow        = extent.width * repackBPP;
             extent.depthOrArrayLayers = depth;
             wgpuQueueWriteTexture(g_WebGPUContext->m_Queue, &dest, repackData, repackPixels * repackBPP, &layout, &extent);
-
-            delete[] repackData;
         }
         else
         {
@@ -880,6 +885,8 @@ static bool InitializeWebGPUContext(WebGPUContext* context, const ContextParams&
     context->m_OriginalWidth   = params.m_Width;
     context->m_OriginalHeight  = params.m_Height;
     context->m_PrintDeviceInfo = params.m_PrintDeviceInfo;
+    context->m_RepackBuffer     = 0;
+    context->m_RepackBufferSize = 0;
     context->m_CurrentUniforms.m_Allocs.SetCapacity(32);
 
     context->m_CurrentPipelineState = GetDefaultPipelineState();
@@ -992,6 +999,7 @@ static bool InitializeWebGPUContext(WebGPUContext* context, const ContextParams&
 
 static void DestroyWebGPUContext(WebGPUContext* context)
 {
+    delete[] context->m_RepackBuffer;
     if (context->m_Surface)
         wgpuSurfaceRelease(context->m_Surface);
     if (context->m_Adapter)
@@ -1241,6 +1249,7 @@ static void WebGPUBeginRenderPass(WebGPUContext* context, const float* clearColo
             }
 
             context->m_CurrentRenderPass.m_Encoder = wgpuCommandEncoderBeginRenderPass(context->m_CommandEncoder, &desc);
+            AddRenderPassBeginStat();
         }
         context->m_CurrentRenderPass.m_Target->m_Scissor[0] = 0;
         context->m_CurrentRenderPass.m_Target->m_Scissor[1] = 0;
@@ -1301,6 +1310,16 @@ static void WebGPUFlip(HContext _context)
     context->m_CurrentRenderTarget = NULL;
     if (context->m_CommandEncoder)
     {
+        // Upload the uniforms staged during the frame, with one write per uniform buffer
+        if (context->m_CurrentUniforms.m_Allocs.Size() > 0)
+        {
+            for (size_t a = 0; a <= context->m_CurrentUniforms.m_Alloc; ++a)
+            {
+                WebGPUUniformBuffer::Alloc* alloc = context->m_CurrentUniforms.m_Allocs[a];
+                if (alloc->m_Used)
+                    wgpuQueueWriteBuffer(context->m_Queue, alloc->m_Buffer, 0, alloc->m_Data, alloc->m_Used);
+            }
+        }
         const WGPUCommandBuffer buffer = wgpuCommandEncoderFinish(context->m_CommandEncoder, NULL);
         wgpuQueueSubmit(context->m_Queue, 1, &buffer);
         wgpuCommandBufferRelease(buffer);
@@ -1488,6 +1507,28 @@ static uint32_t WebGPUGetIndexBufferSize(HIndexBuffer buffer)
     return buffer_ptr->m_Size;
 }
 
+// Buffers can't be mapped synchronously on the main thread in the browser,
+// so CONTEXT_FEATURE_BUFFER_MAPPING is not supported.
+static void* WebGPUMapVertexBuffer(HContext context, HVertexBuffer buffer, BufferAccess access)
+{
+    return 0;
+}
+
+static bool WebGPUUnmapVertexBuffer(HContext context, HVertexBuffer buffer)
+{
+    return false;
+}
+
+static void* WebGPUMapIndexBuffer(HContext context, HIndexBuffer buffer, BufferAccess access)
+{
+    return 0;
+}
+
+static bool WebGPUUnmapIndexBuffer(HContext context, HIndexBuffer buffer)
+{
+    return false;
+}
+
 static bool WebGPUIsIndexBufferFormatSupported(HContext context, IndexBufferFormat format)
 {
     TRACE_CALL;
@@ -1644,6 +1685,7 @@ static void WebGPUUpdateBindGroups(WebGPUContext* context)
 
         WGPUBindGroupDescriptor desc = {};
         WGPUBindGroupEntry entries[MAX_BINDINGS_PER_SET_COUNT];
+        context->m_CurrentProgram->m_DynamicOffsetCount[set] = 0;
         for (int binding = 0; binding < context->m_CurrentProgram->m_MaxBinding; ++binding)
         {
             ProgramResourceBinding& pgm_res = context->m_CurrentProgram->m_ResourceBindings[set][binding];
@@ -1720,6 +1762,7 @@ static void WebGPUUpdateBindGroups(WebGPUContext* context)
                                 desc.usage                = WGPUBufferUsage_Uniform | WGPUBufferUsage_CopyDst;
                                 desc.size                 = std::max(uint16_t(16 * 1024), pgm_res.m_Res->m_BindingInfo.m_BlockSize);
                                 alloc->m_Buffer           = wgpuDeviceCreateBuffer(context->m_Device, &desc);
+                                alloc->m_Data             = (uint8_t*)malloc(desc.size);
                                 alloc->m_Size             = desc.size;
                             }
                             if (context->m_CurrentUniforms.m_Allocs.Full())
@@ -1730,11 +1773,15 @@ static void WebGPUUpdateBindGroups(WebGPUContext* context)
                             context->m_CurrentUniforms.m_Allocs.Push(alloc);
                         }
                     }
-                    entries[desc.entryCount].buffer = context->m_CurrentUniforms.m_Allocs[context->m_CurrentUniforms.m_Alloc]->m_Buffer;
-                    entries[desc.entryCount].offset = context->m_CurrentUniforms.m_Allocs[context->m_CurrentUniforms.m_Alloc]->m_Used;
+                    // The data is staged, and the offset is passed as a dynamic offset, so that the
+                    // bind group only depends on the buffer and can be reused from the cache
+                    WebGPUUniformBuffer::Alloc* alloc = context->m_CurrentUniforms.m_Allocs[context->m_CurrentUniforms.m_Alloc];
+                    entries[desc.entryCount].buffer = alloc->m_Buffer;
+                    entries[desc.entryCount].offset = 0;
                     entries[desc.entryCount].size   = pgm_res.m_Res->m_BindingInfo.m_BlockSize;
-                    wgpuQueueWriteBuffer(context->m_Queue, entries[desc.entryCount].buffer, entries[desc.entryCount].offset, context->m_CurrentProgram->m_UniformData + pgm_res.m_DataOffset, entries[desc.entryCount].size);
-                    context->m_CurrentUniforms.m_Allocs[context->m_CurrentUniforms.m_Alloc]->m_Used += DM_ALIGN(pgm_res.m_Res->m_BindingInfo.m_BlockSize, ubo_alignment);
+                    memcpy(alloc->m_Data + alloc->m_Used, context->m_CurrentProgram->m_UniformData + pgm_res.m_DataOffset, pgm_res.m_Res->m_BindingInfo.m_BlockSize);
+                    context->m_CurrentProgram->m_DynamicOffsets[set][context->m_CurrentProgram->m_DynamicOffsetCount[set]++] = alloc->m_Used;
+                    alloc->m_Used += DM_ALIGN(pgm_res.m_Res->m_BindingInfo.m_BlockSize, ubo_alignment);
                     break;
                 }
                 case ShaderResourceBinding::BINDING_FAMILY_GENERIC:
@@ -1745,6 +1792,8 @@ static void WebGPUUpdateBindGroups(WebGPUContext* context)
             ++desc.entryCount;
         }
 
+        context->m_CurrentProgram->m_DynamicOffsetsChanged |= 1 << set;
+
         const uint64_t bindgroup_hash = dmHashFinal64(&bindgroup_hash_state);
         if (WGPUBindGroup* cached_bindgroup = context->m_BindGroupCache.Get(bindgroup_hash))
         {
@@ -1755,6 +1804,7 @@ static void WebGPUUpdateBindGroups(WebGPUContext* context)
             desc.entries            = entries;
             desc.layout             = context->m_CurrentProgram->m_BindGroupLayouts[set];
             WGPUBindGroup bindgroup = wgpuDeviceCreateBindGroup(context->m_Device, &desc);
+            AddDescriptorAllocationStat(1);
             if (context->m_BindGroupCache.Full())
                 context->m_BindGroupCache.SetCapacity(32, context->m_BindGroupCache.Capacity() + 4);
             context->m_BindGroupCache.Put(bindgroup_hash, bindgroup);
@@ -1781,8 +1831,9 @@ static void WebGPUSetupComputePipeline(WebGPUContext* context)
     for (int set = 0; set < context->m_CurrentProgram->m_MaxSet; ++set)
     {
         if (context->m_CurrentProgram->m_BindGroups[set])
-            wgpuComputePassEncoderSetBindGroup(context->m_CurrentComputePass.m_Encoder, set, context->m_CurrentProgram->m_BindGroups[set], 0, 0);
+            wgpuComputePassEncoderSetBindGroup(context->m_CurrentComputePass.m_Encoder, set, context->m_CurrentProgram->m_BindGroups[set], context->m_CurrentProgram->m_DynamicOffsetCount[set], context->m_CurrentProgram->m_DynamicOffsets[set]);
     }
+    context->m_CurrentProgram->m_DynamicOffsetsChanged = 0;
 }
 
 static void WebGPUSetupRenderPipeline(WebGPUContext* context, WebGPUBuffer* indexBuffer, Type indexBufferType)
@@ -1820,12 +1871,14 @@ static void WebGPUSetupRenderPipeline(WebGPUContext* context, WebGPUBuffer* inde
     // Set the bind groups
     for (int set = 0; set < context->m_CurrentProgram->m_MaxSet; ++set)
     {
-        if (context->m_CurrentProgram->m_BindGroups[set] && context->m_CurrentProgram->m_BindGroups[set] != context->m_CurrentRenderPass.m_BindGroups[set])
+        // A cached bind group may be reused with new offsets
+        if (context->m_CurrentProgram->m_BindGroups[set] && (context->m_CurrentProgram->m_BindGroups[set] != context->m_CurrentRenderPass.m_BindGroups[set] || (context->m_CurrentProgram->m_DynamicOffsetsChanged & (1 << set))))
         {
-            wgpuRenderPassEncoderSetBindGroup(context->m_CurrentRenderPass.m_Encoder, set, context->m_CurrentProgram->m_BindGroups[set], 0, 0);
+            wgpuRenderPassEncoderSetBindGroup(context->m_CurrentRenderPass.m_Encoder, set, context->m_CurrentProgram->m_BindGroups[set], context->m_CurrentProgram->m_DynamicOffsetCount[set], context->m_CurrentProgram->m_DynamicOffsets[set]);
             context->m_CurrentRenderPass.m_BindGroups[set] = context->m_CurrentProgram->m_BindGroups[set];
         }
     }
+    context->m_CurrentProgram->m_DynamicOffsetsChanged = 0;
 }
 
 static void WebGPUDrawElements(HContext _context, PrimitiveType prim_type, uint32_t first, uint32_t count, Type type, HIndexBuffer index_buffer, uint32_t instance_count)
@@ -1986,6 +2039,7 @@ static void WebGPUUpdateBindGroupLayouts(WebGPUContext* context, WebGPUProgram*
                 case ShaderResourceBinding::BINDING_FAMILY_UNIFORM_BUFFER: {
                     const uint32_t ubo_alignment = context->m_DeviceLimits.limits.minUniformBufferOffsetAlignment;
                     binding.buffer.type          = WGPUBufferBindingType_Uniform;
+                    binding.buffer.hasDynamicOffset = true;
 
                     assert(res.m_Type.m_UseTypeIndex);
                     program_resource_binding.m_DataOffset         = info.m_UniformDataSize;
@@ -50,6 +50,7 @@ namespace dmGraphics
         struct Alloc
         {
             WGPUBuffer m_Buffer = NULL;
+            uint8_t*   m_Data = NULL; // Staged on the cpu, uploaded with one write before the frame is submitted
             size_t     m_Used = 0;
             size_t     m_Size = 0;
         };
@@ -82,6 +83,9 @@ namespace dmGraphics
         uint64_t               m_Hash;
         uint8_t*               m_UniformData;
         ProgramResourceBinding m_ResourceBindings[MAX_SET_COUNT][MAX_BINDINGS_PER_SET_COUNT];
+        uint32_t               m_DynamicOffsets[MAX_SET_COUNT][MAX_BINDINGS_PER_SET_COUNT]; // In binding order
+        uint8_t                m_DynamicOffsetCount[MAX_SET_COUNT];
+        uint8_t                m_DynamicOffsetsChanged; // One bit per set
 
         uint32_t               m_UniformDataSizeAligned;
         uint16_t               m_UniformBufferCount;
@@ -223,6 +227,9 @@ namespace dmGraphics
         WebGPUProgram*      m_CurrentProgram;
         WebGPURenderTarget* m_CurrentRenderTarget;
 
+        uint8_t*            m_RepackBuffer;      // Reused between RGB -> RGBA texture uploads
+        uint32_t            m_RepackBufferSize;
+
         uint32_t            m_OriginalWidth;
         uint32_t            m_OriginalHeight;
         uint32_t            m_Width;
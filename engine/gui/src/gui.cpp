@@ -203,6 +203,7 @@ namespace dmGui
         context->m_PhysicalWidth = params->m_PhysicalWidth;
         context->m_PhysicalHeight = params->m_PhysicalHeight;
         context->m_Dpi = params->m_Dpi;
+        context->m_ScissorClipping = params->m_ScissorClipping;
         context->m_HidContext = params->m_HidContext;
         context->m_Scenes.SetCapacity(INITIAL_SCENE_COUNT);
         context->m_ScratchBoneNodes.SetCapacity(32);
@@ -359,6 +360,12 @@ namespace dmGui
         scene->m_Nodes.SetCapacity(params->m_MaxNodes);
         scene->m_NodePool.SetCapacity(params->m_MaxNodes);
         scene->m_Animations.SetCapacity(params->m_MaxAnimations);
+        scene->m_AnimationEasedValues.SetCapacity(params->m_MaxAnimations);
+        scene->m_AnimationEased.SetCapacity(params->m_MaxAnimations);
+        scene->m_AnimationCurveIndices.SetCapacity(params->m_MaxAnimations);
+        scene->m_AnimationCurveTimes.SetCapacity(params->m_MaxAnimations);
+        scene->m_AnimationCurveValues.SetCapacity(params->m_MaxAnimations);
+        scene->m_AnimationsVersion = 0;
         scene->m_Textures.SetCapacity(params->m_MaxTextures*2, params->m_MaxTextures);
         scene->m_DynamicTextures.SetCapacity(params->m_MaxDynamicTextures*2, params->m_MaxDynamicTextures);
         scene->m_MaterialResources.SetCapacity(params->m_MaxMaterials*2, params->m_MaxMaterials);
@@ -374,6 +381,7 @@ namespace dmGui
         scene->m_RenderTail = INVALID_INDEX;
         scene->m_NextVersionNumber = 0;
         scene->m_RenderOrder = 0;
+        scene->m_RenderNodesDirty = 1;
         scene->m_Width = context->m_DefaultProjectWidth;
         scene->m_Height = context->m_DefaultProjectHeight;
         scene->m_FetchTextureSetAnimCallback = params->m_FetchTextureSetAnimCallback;
@@ -832,6 +840,7 @@ namespace dmGui
         uint64_t layer_hash = dmHashString64(layer_name);
         uint16_t index = scene->m_NextLayerIndex++;
         scene->m_Layers.Put(layer_hash, index);
+        scene->m_RenderNodesDirty = 1;
         uint32_t n = scene->m_Nodes.Size();
         InternalNode* nodes = scene->m_Nodes.Begin();
         for (uint32_t i = 0; i < n; ++i)
@@ -849,6 +858,9 @@ namespace dmGui
         scene->m_Layouts.SetCapacity(capacity);
         scene->m_LayoutsNodeDescs.SetCapacity(layouts_count*node_count);
         scene->m_LayoutsNodeDescs.SetSize(0);
+        scene->m_LayoutsNodeStateIndices.SetSize(0);
+        scene->m_LayoutNodeStates.SetSize(0);
+        scene->m_LayoutTexts.SetSize(0);
     }
 
     void ClearLayouts(HScene scene)
@@ -857,6 +869,9 @@ namespace dmGui
         scene->m_Layouts.SetSize(0);
         scene->m_Layouts.Push(DEFAULT_LAYOUT);
         scene->m_LayoutsNodeDescs.SetCapacity(0);
+        scene->m_LayoutsNodeStateIndices.SetCapacity(0);
+        scene->m_LayoutNodeStates.SetCapacity(0);
+        scene->m_LayoutTexts.SetCapacity(0);
     }
 
     Result AddLayout(HScene scene, const char* layout_id)
@@ -919,13 +934,163 @@ namespace dmGui
             n->m_Node.m_NodeDescTable = table = &scene->m_LayoutsNodeDescs[table_index];
         }
         assert(layout_index_end < scene->m_Layouts.Size());
+        uint32_t table_index = table - scene->m_LayoutsNodeDescs.Begin();
         for(uint16_t i = layout_index_start; i <= layout_index_end; ++i)
+        {
             table[i] = (void*) desc;
+            // The resolved state is outdated, until the layouts are resolved again
+            if (table_index + i < scene->m_LayoutsNodeStateIndices.Size())
+                scene->m_LayoutsNodeStateIndices[table_index + i] = INVALID_LAYOUT_STATE;
+        }
         return RESULT_OK;
     }
 
+    static uint32_t* GetLayoutStateIndices(const HScene scene, InternalNode* n)
+    {
+        uint32_t table_index = n->m_Node.m_NodeDescTable - scene->m_LayoutsNodeDescs.Begin();
+        if (table_index + scene->m_Layouts.Size() > scene->m_LayoutsNodeStateIndices.Size())
+            return 0;
+        return &scene->m_LayoutsNodeStateIndices[table_index];
+    }
+
+    // Nodes with types or animations that the node desc callback sets up in other ways are always set through it
+    static bool CanStoreLayoutState(InternalNode* n)
+    {
+        const Node& node = n->m_Node;
+        return (node.m_NodeType == NODE_TYPE_BOX || node.m_NodeType == NODE_TYPE_TEXT || node.m_NodeType == NODE_TYPE_PIE)
+            && node.m_CustomType == 0 && node.m_FlipbookAnimHash == 0 && !node.m_IsBone;
+    }
+
+    static uint32_t StoreLayoutState(const HScene scene, InternalNode* n)
+    {
+        const Node& node = n->m_Node;
+        dmArray<NodeLayoutState>& states = scene->m_LayoutNodeStates;
+        if (states.Full())
+            states.OffsetCapacity(64);
+        states.SetSize(states.Size() + 1);
+        NodeLayoutState& state = states.Back();
+        memcpy(state.m_Properties, node.m_Properties, sizeof(state.m_Properties));
+        // A texture that wasn't found is cleared, which is what setting the 0 hash does
+        state.m_TextureHash = node.m_Texture ? node.m_TextureHash : 0;
+        state.m_FontHash = node.m_NodeType == NODE_TYPE_TEXT ? node.m_FontHash : 0;
+        state.m_LayerHash = node.m_LayerHash;
+        state.m_MaterialNameHash = node.m_MaterialNameHash;
+        state.m_State = node.m_State;
+        state.m_PerimeterVertices = node.m_PerimeterVertices;
+        state.m_OuterBounds = node.m_OuterBounds;
+        state.m_TextOffset = INVALID_LAYOUT_STATE;
+        if (node.m_Text)
+        {
+            dmArray<char>& texts = scene->m_LayoutTexts;
+            uint32_t size = strlen(node.m_Text) + 1;
+            if (texts.Remaining() < size)
+                texts.OffsetCapacity(dmMath::Max(size, 1024U));
+            state.m_TextOffset = texts.Size();
+            texts.PushArray(node.m_Text, size);
+        }
+        return states.Size() - 1;
+    }
+
+    static void ApplyLayoutState(const HScene scene, InternalNode* n, const NodeLayoutState* state)
+    {
+        Node& node = n->m_Node;
+        HNode hnode = GetNodeHandle(n);
+        memcpy(node.m_Properties, state->m_Properties, sizeof(node.m_Properties));
+        node.m_State = state->m_State;
+        node.m_PerimeterVertices = state->m_PerimeterVertices;
+        node.m_OuterBounds = state->m_OuterBounds;
+
+        // The resources are looked up by hash, as they might have changed since the layouts were resolved
+        SetNodeTexture(scene, hnode, state->m_TextureHash);
+        SetNodeLayer(scene, hnode, state->m_LayerHash);
+        SetNodeMaterial(scene, hnode, state->m_MaterialNameHash);
+        if (state->m_FontHash)
+            SetNodeFont(scene, hnode, state->m_FontHash);
+
+        const char* text = state->m_TextOffset != INVALID_LAYOUT_STATE ? &scene->m_LayoutTexts[state->m_TextOffset] : 0x0;
+        bool text_changed = text && node.m_Text ? strcmp(text, node.m_Text) != 0 : text != node.m_Text;
+        if (text_changed)
+            SetNodeText(scene, hnode, text);
+
+        memcpy(node.m_ResetPointProperties, node.m_Properties, sizeof(node.m_Properties));
+        node.m_ResetPointState = node.m_State;
+        node.m_HasResetPoint = 1;
+    }
+
+    void ResolveLayouts(const HScene scene, SetNodeCallback set_node_callback)
+    {
+        DM_PROFILE(__FUNCTION__);
+
+        uint32_t layout_count = scene->m_Layouts.Size();
+        dmArray<uint32_t>& indices = scene->m_LayoutsNodeStateIndices;
+        indices.SetCapacity(scene->m_LayoutsNodeDescs.Size());
+        indices.SetSize(scene->m_LayoutsNodeDescs.Size());
+        scene->m_LayoutNodeStates.SetSize(0);
+        scene->m_LayoutTexts.SetSize(0);
+
+        uint16_t current = GetLayoutIndex(scene, scene->m_LayoutId);
+        uint32_t n = scene->m_Nodes.Size();
+        InternalNode* nodes = scene->m_Nodes.Begin();
+        for (uint32_t i = 0; i < n; ++i)
+        {
+            InternalNode *n = &nodes[i];
+            if(!n->m_Node.m_NodeDescTable || n->m_Index == INVALID_INDEX)
+                continue;
+
+            void** descs = n->m_Node.m_NodeDescTable;
+            uint32_t* state_indices = GetLayoutStateIndices(scene, n);
+            for (uint32_t l = 0; l < layout_count; ++l)
+                state_indices[l] = INVALID_LAYOUT_STATE;
+            if (!CanStoreLayoutState(n))
+                continue;
+
+            // The node is already set up for the current layout
+            HNode hnode = GetNodeHandle(n);
+            state_indices[current] = StoreLayoutState(scene, n);
+            bool resolved = true;
+            for (uint32_t l = 0; l < layout_count && resolved; ++l)
+            {
+                if (l == current)
+                    continue;
+                // Layouts that don't override the node share the desc, and the state
+                for (uint32_t prev = 0; prev < l; ++prev)
+                {
+                    if (descs[prev] == descs[l] && state_indices[prev] != INVALID_LAYOUT_STATE)
+                    {
+                        state_indices[l] = state_indices[prev];
+                        break;
+                    }
+                }
+                if (descs[current] == descs[l])
+                    state_indices[l] = state_indices[current];
+                if (state_indices[l] != INVALID_LAYOUT_STATE)
+                    continue;
+
+                set_node_callback(scene, hnode, descs[l]);
+                resolved = CanStoreLayoutState(n);
+                if (resolved)
+                    state_indices[l] = StoreLayoutState(scene, n);
+            }
+
+            if (resolved)
+            {
+                ApplyLayoutState(scene, n, &scene->m_LayoutNodeStates[state_indices[current]]);
+            }
+            else
+            {
+                for (uint32_t l = 0; l < layout_count; ++l)
+                    state_indices[l] = INVALID_LAYOUT_STATE;
+                set_node_callback(scene, hnode, descs[current]);
+            }
+            n->m_Node.m_DirtyLocal = 1;
+        }
+        scene->m_RenderNodesDirty = 1;
+    }
+
     Result SetLayout(const HScene scene, dmhash_t layout_id, SetNodeCallback set_node_callback)
     {
+        DM_PROFILE(__FUNCTION__);
+
         scene->m_LayoutId = layout_id;
         uint16_t index = GetLayoutIndex(scene, layout_id);
         uint32_t n = scene->m_Nodes.Size();
@@ -935,9 +1100,14 @@ namespace dmGui
             InternalNode *n = &nodes[i];
             if(!n->m_Node.m_NodeDescTable)
                 continue;
-            set_node_callback(scene, GetNodeHandle(n), n->m_Node.m_NodeDescTable[index]);
+            uint32_t* state_indices = GetLayoutStateIndices(scene, n);
+            if (state_indices && state_indices[index] != INVALID_LAYOUT_STATE)
+                ApplyLayoutState(scene, n, &scene->m_LayoutNodeStates[state_indices[index]]);
+            else
+                set_node_callback(scene, GetNodeHandle(n), n->m_Node.m_NodeDescTable[index]);
             n->m_Node.m_DirtyLocal = 1;
         }
+        scene->m_RenderNodesDirty = 1;
         return RESULT_OK;
     }
 
@@ -1134,6 +1304,11 @@ namespace dmGui
 
     static void UpdateScope(InternalNode* node, StencilScope& scope, StencilScope& child_scope, const StencilScope* parent_scope, uint16_t index, uint16_t non_inv_clipper_count, uint16_t inv_clipper_count, uint16_t bit_field_offset) {
         int bit_range = CalcBitRange(non_inv_clipper_count);
+        // the scissor rects are set each frame, see UpdateScissorRects
+        scope.m_UseStencil = 1;
+        scope.m_UseScissor = 0;
+        child_scope.m_UseStencil = 1;
+        child_scope.m_UseScissor = 0;
         // state used for drawing the clipper
         scope.m_WriteMask = 0xff;
         scope.m_TestMask = 0;
@@ -1184,6 +1359,31 @@ namespace dmGui
         }
     }
 
+    static bool IsAxisAligned(const Matrix4& transform) {
+        const float epsilon = 0.0001f;
+        Vector4 x = transform.getCol0();
+        Vector4 y = transform.getCol1();
+        float x_length = dmMath::Abs(x.getX());
+        float y_length = dmMath::Abs(y.getY());
+        return dmMath::Abs(x.getY()) <= epsilon * x_length && dmMath::Abs(x.getZ()) <= epsilon * x_length &&
+               dmMath::Abs(y.getX()) <= epsilon * y_length && dmMath::Abs(y.getZ()) <= epsilon * y_length;
+    }
+
+    // Non-inverted box clippers that aren't rotated clip to a rect, which can be done with a scissor rect instead of the stencil buffer.
+    // Textured boxes are only rects if they are 9-sliced, since the images of a texture set may be trimmed to polygons.
+    static bool ClipsWithScissor(HScene scene, InternalNode* n, Matrix4& transform) {
+        const Node& node = n->m_Node;
+        if (!scene->m_Context->m_ScissorClipping || node.m_NodeType != NODE_TYPE_BOX || node.m_ClippingInverted || node.m_IsBone)
+            return false;
+        if (node.m_TextureType == NODE_TEXTURE_TYPE_TEXTURE_SET && dmVMath::LengthSqr(node.m_Properties[PROPERTY_SLICE9]) == 0.0f)
+            return false;
+
+        float opacity;
+        CalculateNodeSize(n);
+        CalculateNodeTransformAndAlphaCached(scene, n, CalculateNodeTransformFlags(CALCULATE_NODE_INCLUDE_SIZE | CALCULATE_NODE_RESET_PIVOT), transform, opacity);
+        return IsAxisAligned(transform);
+    }
+
     static void CollectInvClippers(HScene scene, uint16_t start_index, dmArray<InternalClippingNode>& clippers, ScopeContext& scope_context, uint16_t parent_index) {
         uint32_t index = start_index;
         InternalClippingNode* parent = 0x0;
@@ -1205,8 +1405,21 @@ namespace dmGui
                         clipper.m_ParentIndex = parent_index;
                         clipper.m_NextNonInvIndex = INVALID_INDEX;
                         clipper.m_VisibleRenderKey = ~0ULL;
+                        clipper.m_Scissor = 0;
                         n->m_ClipperIndex = clipper_index;
-                        if (n->m_Node.m_ClippingInverted) {
+                        Matrix4 transform;
+                        if (ClipsWithScissor(scene, n, transform)) {
+                            // No stencil bits are used, the stencil state of the parent applies to the children as well
+                            clipper.m_Scissor = 1;
+                            if (parent != 0x0) {
+                                clipper.m_Scope = parent->m_ChildScope;
+                            } else {
+                                memset(&clipper.m_Scope, 0, sizeof(clipper.m_Scope));
+                                clipper.m_Scope.m_ColorMask = 0xf;
+                            }
+                            clipper.m_ChildScope = clipper.m_Scope;
+                            CollectInvClippers(scene, n->m_ChildHead, clippers, scope_context, clipper_index);
+                        } else if (n->m_Node.m_ClippingInverted) {
                             StencilScope* parent_scope = 0x0;
                             if (parent != 0x0) {
                                 parent_scope = &parent->m_ChildScope;
@@ -1259,14 +1472,13 @@ namespace dmGui
         }
     }
 
-    static uint16_t CollectRenderEntries(HScene scene, uint16_t start_index, uint16_t order, dmArray<InternalClippingNode>& clippers, dmArray<RenderEntry>& render_entries) {
+    static uint16_t CollectRenderEntries(HScene scene, uint16_t start_index, uint16_t order, dmArray<InternalClippingNode>& clippers, dmArray<RenderEntry>& render_entries, uint32_t& active_nodes) {
         #define PUSH_RENDER_ENTRY(e) \
             if (render_entries.Full()) \
                 render_entries.OffsetCapacity(16U); \
             render_entries.Push(e);
 
         uint16_t index = start_index;
-        uint32_t active_nodes = 0;
         while (index != INVALID_INDEX) {
             InternalNode* n = &scene->m_Nodes[index];
             if (n->m_Node.m_Enabled) {
@@ -1279,15 +1491,18 @@ namespace dmGui
                         uint64_t clipping_key = CalcRenderKey(layer, order++);
                         uint64_t render_key   = CalcRenderKey(layer, order++);
 
-                        order = CollectRenderEntries(scene, n->m_ChildHead, order, clippers, render_entries);
+                        order = CollectRenderEntries(scene, n->m_ChildHead, order, clippers, render_entries, active_nodes);
 
                         clipper.m_VisibleRenderKey = render_key;
 
                         RenderEntry entry;
                         entry.m_Node = node;
-                        entry.m_RenderKey = clipping_key;
 
-                        PUSH_RENDER_ENTRY(entry);
+                        // Scissor clippers aren't drawn into the stencil buffer
+                        if (!clipper.m_Scissor) {
+                            entry.m_RenderKey = clipping_key;
+                            PUSH_RENDER_ENTRY(entry);
+                        }
 
                         if (n->m_Node.m_ClippingVisible) {
                             entry.m_RenderKey = render_key;
@@ -1337,20 +1552,93 @@ namespace dmGui
                     PUSH_RENDER_ENTRY(entry);
                 }
 
-                order = CollectRenderEntries(scene, n->m_ChildHead, order, clippers, render_entries);
+                order = CollectRenderEntries(scene, n->m_ChildHead, order, clippers, render_entries, active_nodes);
             }
             index = n->m_NextIndex;
         }
         #undef PUSH_RENDER_ENTRY
 
-        DM_PROPERTY_ADD_U32(rmtp_GuiActiveNodes, active_nodes);
         return order;
     }
 
-    static void CollectNodes(HScene scene, dmArray<InternalClippingNode>& clippers, dmArray<RenderEntry>& render_entries)
+    static void CollectNodes(HScene scene)
     {
+        dmArray<InternalClippingNode>& clippers = scene->m_StencilClippingNodes;
+        dmArray<RenderEntry>& render_entries = scene->m_CollectedRenderNodes;
+        clippers.SetSize(0);
+        render_entries.SetSize(0);
+        // There are never more clippers than nodes
+        uint32_t node_count = scene->m_NodePool.Size();
+        if (node_count > clippers.Capacity())
+        {
+            clippers.SetCapacity(node_count);
+        }
+        if (node_count * 2 > render_entries.Capacity())
+        {
+            render_entries.SetCapacity(node_count * 2);
+        }
+
         CollectClippers(scene, scene->m_RenderHead, 0, 0, clippers, INVALID_INDEX);
-        CollectRenderEntries(scene, scene->m_RenderHead, 0, clippers, render_entries);
+        scene->m_CollectedActiveNodes = 0;
+        CollectRenderEntries(scene, scene->m_RenderHead, 0, clippers, render_entries, scene->m_CollectedActiveNodes);
+        std::sort(render_entries.Begin(), render_entries.End(), RenderEntrySortPred());
+    }
+
+    // Sets the scissor rects of the clippers from their current transforms, intersected with the rects of their parents.
+    // Returns false if a clipper has to switch between scissor and stencil clipping, and the clippers need to be collected again.
+    static bool UpdateScissorRects(HScene scene)
+    {
+        dmArray<InternalClippingNode>& clippers = scene->m_StencilClippingNodes;
+        uint32_t clipper_count = clippers.Size();
+        for (uint32_t i = 0; i < clipper_count; ++i)
+        {
+            // The parents are always collected before their children
+            InternalClippingNode& clipper = clippers[i];
+            const StencilScope* parent_scope = 0x0;
+            if (clipper.m_ParentIndex != INVALID_INDEX && clippers[clipper.m_ParentIndex].m_ChildScope.m_UseScissor)
+            {
+                parent_scope = &clippers[clipper.m_ParentIndex].m_ChildScope;
+            }
+
+            Matrix4 transform;
+            bool scissor = ClipsWithScissor(scene, &scene->m_Nodes[clipper.m_NodeIndex], transform);
+            if (scissor != (clipper.m_Scissor != 0))
+            {
+                return false;
+            }
+
+            float rect[4];
+            if (scissor)
+            {
+                Vector4 p0 = transform * Point3(0.0f, 0.0f, 0.0f);
+                Vector4 p1 = transform * Point3(1.0f, 1.0f, 0.0f);
+                rect[0] = dmMath::Min(p0.getX(), p1.getX());
+                rect[1] = dmMath::Min(p0.getY(), p1.getY());
+                rect[2] = dmMath::Max(p0.getX(), p1.getX());
+                rect[3] = dmMath::Max(p0.getY(), p1.getY());
+                if (parent_scope != 0x0)
+                {
+                    rect[0] = dmMath::Max(rect[0], parent_scope->m_ScissorRect[0]);
+                    rect[1] = dmMath::Max(rect[1], parent_scope->m_ScissorRect[1]);
+                    rect[2] = dmMath::Max(rect[0], dmMath::Min(rect[2], parent_scope->m_ScissorRect[2]));
+                    rect[3] = dmMath::Max(rect[1], dmMath::Min(rect[3], parent_scope->m_ScissorRect[3]));
+                }
+            }
+            else if (parent_scope != 0x0)
+            {
+                memcpy(rect, parent_scope->m_ScissorRect, sizeof(rect));
+            }
+
+            uint8_t use_scissor = scissor || parent_scope != 0x0;
+            clipper.m_Scope.m_UseScissor = use_scissor;
+            clipper.m_ChildScope.m_UseScissor = use_scissor;
+            if (use_scissor)
+            {
+                memcpy(clipper.m_Scope.m_ScissorRect, rect, sizeof(rect));
+                memcpy(clipper.m_ChildScope.m_ScissorRect, rect, sizeof(rect));
+            }
+        }
+        return true;
     }
 
     static inline bool IsVisible(InternalNode* n, float opacity)
@@ -1367,7 +1655,6 @@ namespace dmGui
         c->m_RenderNodes.SetSize(0);
         c->m_RenderTransforms.SetSize(0);
         c->m_RenderOpacities.SetSize(0);
-        c->m_StencilClippingNodes.SetSize(0);
         c->m_StencilScopes.SetSize(0);
         c->m_StencilScopeIndices.SetSize(0);
         uint32_t capacity = scene->m_NodePool.Size() * 2;
@@ -1378,7 +1665,6 @@ namespace dmGui
             c->m_RenderOpacities.SetCapacity(capacity);
             c->m_SceneTraversalCache.m_Data.SetCapacity(capacity);
             c->m_SceneTraversalCache.m_Data.SetSize(capacity);
-            c->m_StencilClippingNodes.SetCapacity(capacity);
             c->m_StencilScopes.SetCapacity(capacity);
             c->m_StencilScopeIndices.SetCapacity(capacity);
         }
@@ -1389,9 +1675,30 @@ namespace dmGui
             c->m_SceneTraversalCache.m_Version = 0;
         }
 
-        CollectNodes(scene, c->m_StencilClippingNodes, c->m_RenderNodes);
-        uint32_t node_count = c->m_RenderNodes.Size();
-        std::sort(c->m_RenderNodes.Begin(), c->m_RenderNodes.End(), RenderEntrySortPred());
+        // The render entries only change with the node structure, except for particlefx nodes
+        // whose entries depend on the emitters currently alive
+        if (scene->m_RenderNodesDirty || scene->m_AliveParticlefxs.Size() > 0)
+        {
+            CollectNodes(scene);
+            scene->m_RenderNodesDirty = 0;
+        }
+        if (c->m_ScissorClipping && !UpdateScissorRects(scene))
+        {
+            CollectNodes(scene);
+            UpdateScissorRects(scene);
+        }
+        DM_PROPERTY_ADD_U32(rmtp_GuiActiveNodes, scene->m_CollectedActiveNodes);
+
+        uint32_t node_count = scene->m_CollectedRenderNodes.Size();
+        if (node_count > c->m_RenderNodes.Capacity())
+        {
+            c->m_RenderNodes.SetCapacity(node_count);
+        }
+        c->m_RenderNodes.SetSize(node_count);
+        if (node_count > 0)
+        {
+            memcpy(c->m_RenderNodes.Begin(), scene->m_CollectedRenderNodes.Begin(), node_count * sizeof(RenderEntry));
+        }
         Matrix4 transform;
 
         if (c->m_RenderNodes.Capacity() > c->m_RenderTransforms.Capacity())
@@ -1401,7 +1708,6 @@ namespace dmGui
             c->m_RenderOpacities.SetCapacity(new_capacity);
             c->m_SceneTraversalCache.m_Data.SetCapacity(new_capacity);
             c->m_SceneTraversalCache.m_Data.SetSize(new_capacity);
-            c->m_StencilClippingNodes.SetCapacity(new_capacity);
             c->m_StencilScopes.SetCapacity(new_capacity);
             c->m_StencilScopeIndices.SetCapacity(new_capacity);
         }
@@ -1434,12 +1740,12 @@ namespace dmGui
             c->m_RenderTransforms.Push(transform);
             c->m_RenderOpacities.Push(opacity);
             if (n->m_ClipperIndex != INVALID_INDEX) {
-                InternalClippingNode* clipper = &c->m_StencilClippingNodes[n->m_ClipperIndex];
+                InternalClippingNode* clipper = &scene->m_StencilClippingNodes[n->m_ClipperIndex];
                 if (clipper->m_NodeIndex == index) {
                     if (clipper->m_VisibleRenderKey == entry.m_RenderKey) {
                         StencilScope* scope = 0x0;
                         if (clipper->m_ParentIndex != INVALID_INDEX) {
-                            scope = &c->m_StencilClippingNodes[clipper->m_ParentIndex].m_ChildScope;
+                            scope = &scene->m_StencilClippingNodes[clipper->m_ParentIndex].m_ChildScope;
                         }
                         c->m_StencilScopes.Push(scope);
                     } else {
@@ -1546,26 +1852,162 @@ namespace dmGui
         }
     }
 
+    static inline bool IsAnimationActive(HScene scene, const Animation* anim)
+    {
+        dmGui::Playback playback = anim->m_Playback;
+        bool looping = playback == PLAYBACK_LOOP_FORWARD || playback == PLAYBACK_LOOP_BACKWARD || playback == PLAYBACK_LOOP_PINGPONG;
+
+        if (anim->m_Elapsed > anim->m_Duration
+            || anim->m_Cancelled
+            || (!looping && anim->m_Elapsed == anim->m_Duration && anim->m_Duration != 0))
+        {
+            return false;
+        }
+        return IsNodeEnabledRecursive(scene, anim->m_Node & 0xffff);
+    }
+
+    // Returns the elapsed time of an animation after it was advanced dt seconds
+    static inline float GetAdvancedElapsed(const Animation* anim, float dt)
+    {
+        // Compensate Elapsed with Delay underflow
+        float elapsed = anim->m_FirstUpdate ? -anim->m_Delay : anim->m_Elapsed;
+
+        // NOTE: We add dt to elapsed before we calculate t.
+        // Example: 60 updates with dt=1/60.0 should result in a complete animation
+        elapsed += dt*anim->m_PlaybackRate;
+
+        // Clamp elapsed to duration if we are closer than half a time step
+        return dmMath::Select(elapsed + dt * anim->m_PlaybackRate * 0.5f - anim->m_Duration, anim->m_Duration, elapsed);
+    }
+
+    // Calculate normalized time if elapsed has not yet reached duration, otherwise it's set to 1 (animation complete)
+    static inline float GetNormalizedTime(const Animation* anim, float elapsed)
+    {
+        float t = 1.0f;
+        if (anim->m_Duration != 0)
+        {
+            t = dmMath::Select(anim->m_Duration - elapsed, elapsed / anim->m_Duration, 1.0f);
+        }
+        return t;
+    }
+
+    // Maps the normalized time to the time used to sample the easing curve
+    static inline float GetCurveTime(const Animation* anim, float t)
+    {
+        dmGui::Playback playback = anim->m_Playback;
+        float t2 = t;
+        if (playback == PLAYBACK_ONCE_BACKWARD || playback == PLAYBACK_LOOP_BACKWARD || anim->m_Backwards) {
+            t2 = 1.0f - t;
+        }
+        if (playback == PLAYBACK_ONCE_PINGPONG || playback == PLAYBACK_LOOP_PINGPONG) {
+            t2 *= 2.0f;
+            if (t2 > 1.0f) {
+                t2 = 2.0f - t2;
+            }
+        }
+        return t2;
+    }
+
+    // Evaluates the easing curves of all animations that will be advanced this frame. The
+    // animations are grouped by built in curve type, so that each curve is evaluated in a batch.
+    static void EvaluateAnimationCurves(HScene scene, float dt)
+    {
+        DM_PROFILE("EvaluateAnimationCurves");
+
+        dmArray<Animation>& animations = scene->m_Animations;
+        uint32_t n = animations.Size();
+
+        float* eased_values = scene->m_AnimationEasedValues.Begin();
+        uint8_t* eased = scene->m_AnimationEased.Begin();
+        uint32_t* curve_indices = scene->m_AnimationCurveIndices.Begin();
+        float* curve_times = scene->m_AnimationCurveTimes.Begin();
+        float* curve_values = scene->m_AnimationCurveValues.Begin();
+
+        uint32_t curve_offsets[dmEasing::TYPE_COUNT];
+        memset(curve_offsets, 0, sizeof(curve_offsets));
+
+        // Store the curve time per animation and count the animations per curve type
+        for (uint32_t i = 0; i < n; ++i)
+        {
+            const Animation* anim = &animations[i];
+            eased[i] = 0;
+            if (anim->m_Delay >= dt || !IsAnimationActive(scene, anim))
+            {
+                continue;
+            }
+
+            float t2 = GetCurveTime(anim, GetNormalizedTime(anim, GetAdvancedElapsed(anim, dt)));
+            eased[i] = 1;
+            if (anim->m_Easing.type == dmEasing::TYPE_FLOAT_VECTOR)
+            {
+                eased_values[i] = dmEasing::GetValue(anim->m_Easing, t2);
+            }
+            else
+            {
+                eased_values[i] = t2;
+                curve_offsets[anim->m_Easing.type]++;
+            }
+        }
+
+        uint32_t offset = 0;
+        for (uint32_t type = 0; type < dmEasing::TYPE_FLOAT_VECTOR; ++type)
+        {
+            uint32_t count = curve_offsets[type];
+            curve_offsets[type] = offset;
+            offset += count;
+        }
+
+        for (uint32_t i = 0; i < n; ++i)
+        {
+            dmEasing::Type type = animations[i].m_Easing.type;
+            if (eased[i] && type != dmEasing::TYPE_FLOAT_VECTOR)
+            {
+                uint32_t index = curve_offsets[type]++;
+                curve_indices[index] = i;
+                curve_times[index] = eased_values[i];
+            }
+        }
+
+        // curve_offsets now holds the end of each curve type range
+        uint32_t start = 0;
+        for (uint32_t type = 0; type < dmEasing::TYPE_FLOAT_VECTOR; ++type)
+        {
+            uint32_t end = curve_offsets[type];
+            if (end > start)
+            {
+                dmEasing::GetValues((dmEasing::Type) type, curve_times + start, curve_values + start, end - start);
+            }
+            start = end;
+        }
+
+        for (uint32_t i = 0; i < start; ++i)
+        {
+            eased_values[curve_indices[i]] = curve_values[i];
+        }
+    }
+
     void UpdateAnimations(HScene scene, float dt)
     {
         dmArray<Animation>* animations = &scene->m_Animations;
 
         uint32_t active_animations = 0;
 
+        uint32_t prepared_count = animations->Size();
+        scene->m_AnimationEasedValues.SetSize(prepared_count);
+        scene->m_AnimationEased.SetSize(prepared_count);
+        scene->m_AnimationCurveIndices.SetSize(prepared_count);
+        scene->m_AnimationCurveTimes.SetSize(prepared_count);
+        scene->m_AnimationCurveValues.SetSize(prepared_count);
+        EvaluateAnimationCurves(scene, dt);
+
+        // The evaluated curves are only valid as long as no completion callback has added or removed animations
+        uint32_t prepared_version = scene->m_AnimationsVersion;
+
         for (uint32_t i = 0; i < animations->Size(); ++i)
         {
             Animation* anim = &(*animations)[i];
 
-            dmGui::Playback playback = anim->m_Playback;
-            bool looping = playback == PLAYBACK_LOOP_FORWARD || playback == PLAYBACK_LOOP_BACKWARD || playback == PLAYBACK_LOOP_PINGPONG;
-
-            if (anim->m_Elapsed > anim->m_Duration
-                || anim->m_Cancelled
-                || (!looping && anim->m_Elapsed == anim->m_Duration && anim->m_Duration != 0))
-            {
-                continue;
-            }
-            if (!IsNodeEnabledRecursive(scene, anim->m_Node & 0xffff))
+            if (!IsAnimationActive(scene, anim))
             {
                 continue;
             }
@@ -1573,40 +2015,27 @@ namespace dmGui
 
             if (anim->m_Delay < dt)
             {
+                float elapsed = GetAdvancedElapsed(anim, dt);
                 if (anim->m_FirstUpdate)
                 {
                     anim->m_From = *anim->m_Value;
                     anim->m_FirstUpdate = 0;
-                    // Compensate Elapsed with Delay underflow
-                    anim->m_Elapsed = -anim->m_Delay;
                     anim->m_Delay = 0;
                 }
+                anim->m_Elapsed = elapsed;
 
-                // NOTE: We add dt to elapsed before we calculate t.
-                // Example: 60 updates with dt=1/60.0 should result in a complete animation
-                anim->m_Elapsed += dt*anim->m_PlaybackRate;
+                float t = GetNormalizedTime(anim, elapsed);
 
-                // Clamp elapsed to duration if we are closer than half a time step
-                anim->m_Elapsed = dmMath::Select(anim->m_Elapsed + dt * anim->m_PlaybackRate * 0.5f - anim->m_Duration, anim->m_Duration, anim->m_Elapsed);
-                // Calculate normalized time if elapsed has not yet reached duration, otherwise it's set to 1 (animation complete)
-                float t = 1.0f;
-                if (anim->m_Duration != 0)
+                float x;
+                if (prepared_version == scene->m_AnimationsVersion && i < prepared_count && scene->m_AnimationEased[i])
                 {
-                    t = dmMath::Select(anim->m_Duration - anim->m_Elapsed, anim->m_Elapsed / anim->m_Duration, 1.0f);
-                }
-                float t2 = t;
-                if (playback == PLAYBACK_ONCE_BACKWARD || playback == PLAYBACK_LOOP_BACKWARD || anim->m_Backwards) {
-                    t2 = 1.0f - t;
+                    x = scene->m_AnimationEasedValues[i];
                 }
-                if (playback == PLAYBACK_ONCE_PINGPONG || playback == PLAYBACK_LOOP_PINGPONG) {
-                    t2 *= 2.0f;
-                    if (t2 > 1.0f) {
-                        t2 = 2.0f - t2;
-                    }
+                else
+                {
+                    x = dmEasing::GetValue(anim->m_Easing, GetCurveTime(anim, t));
                 }
 
-                float x = dmEasing::GetValue(anim->m_Easing, t2);
-
                 *anim->m_Value = anim->m_From + (anim->m_To - anim->m_From) * x;
                 // Flag local transform as dirty for the node
                 scene->m_Nodes[anim->m_Node & 0xffff].m_Node.m_DirtyLocal = 1;
@@ -1614,9 +2043,9 @@ namespace dmGui
                 // Animation complete, see above
                 if (t >= 1.0f)
                 {
-                    if (looping) {
+                    if (anim->m_Playback == PLAYBACK_LOOP_FORWARD || anim->m_Playback == PLAYBACK_LOOP_BACKWARD || anim->m_Playback == PLAYBACK_LOOP_PINGPONG) {
                         anim->m_Elapsed = anim->m_Elapsed - anim->m_Duration;
-                        if (playback == PLAYBACK_LOOP_PINGPONG) {
+                        if (anim->m_Playback == PLAYBACK_LOOP_PINGPONG) {
                             anim->m_Backwards ^= 1;
                         }
                     } else {
@@ -1645,6 +2074,7 @@ namespace dmGui
                 }
 
                 RemoveAnimation(*animations, i);
+                scene->m_AnimationsVersion++;
                 i--;
                 n--;
                 continue;
@@ -1823,6 +2253,13 @@ namespace dmGui
                         lua_settable(L, -3);
                     }
 
+                    if (ia->m_Time != 0)
+                    {
+                        lua_pushstring(L, "time");
+                        lua_pushnumber(L, ia->m_Time / 1000000.0);
+                        lua_rawset(L, -3);
+                    }
+
                     if (ia->m_ActionId != 0)
                     {
                         lua_pushstring(L, "value");
@@ -2047,11 +2484,12 @@ namespace dmGui
         {
             InternalNode* node = &nodes[i];
 
-            if (node->m_Deleted)
+            if (node->m_Deleted || node->m_Recycled)
             {
                 HNode hnode = GetNodeHandle(node);
                 DeleteNode(scene, hnode, true);
                 node->m_Deleted = 0; // Make sure to clear deferred delete flag
+                node->m_Recycled = 0;
                 n = scene->m_Nodes.Size();
             }
         }
@@ -2064,6 +2502,7 @@ namespace dmGui
             dmParticle::DestroyInstance(scene->m_ParticlefxContext, c->m_Instance);
         }
         scene->m_AliveParticlefxs.SetSize(0);
+        scene->m_RenderNodesDirty = 1;
 
         DeleteDynamicTextures(scene);
         ClearLayouts(scene);
@@ -2082,7 +2521,7 @@ namespace dmGui
             for (uint32_t i = 0; i < node_count; ++i)
             {
                 InternalNode* node = &nodes[i];
-                if (!node->m_Deleted)
+                if (!node->m_Deleted && !node->m_Pooled)
                 {
                     UpdateTextureSetAnimData(scene, node);
                 }
@@ -2105,7 +2544,13 @@ namespace dmGui
                 node->m_Deleted = 0; // Make sure to clear deferred delete flag
                 node_count = scene->m_Nodes.Size();
             }
-            else if (node->m_Index != INVALID_INDEX)
+            else if (node->m_Recycled)
+            {
+                // Deferred recycling of nodes
+                RecycleNode(scene, GetNodeHandle(node));
+                node_count = scene->m_Nodes.Size();
+            }
+            else if (node->m_Index != INVALID_INDEX && !node->m_Pooled)
             {
                 ++total_nodes;
                 if (node->m_Node.m_CustomType != 0)
@@ -2153,6 +2598,7 @@ namespace dmGui
 
                 dmParticle::DestroyInstance(scene->m_ParticlefxContext, c->m_Instance);
                 scene->m_AliveParticlefxs.EraseSwap(i);
+                scene->m_RenderNodesDirty = 1;
                 --count;
             }
             else
@@ -2180,7 +2626,7 @@ namespace dmGui
             for (uint32_t i = 0; i < node_count; ++i)
             {
                 InternalNode* node = &nodes[i];
-                if (!node->m_Deleted && node->m_Index != INVALID_INDEX && node->m_ParentIndex == INVALID_INDEX)
+                if (!node->m_Deleted && !node->m_Pooled && node->m_Index != INVALID_INDEX && node->m_ParentIndex == INVALID_INDEX)
                 {
                     return GetNodeHandle(node);
                 }
@@ -2266,8 +2712,15 @@ namespace dmGui
         return scene->m_Script;
     }
 
+    static void ReleaseClonePools(HScene scene);
+
     static uint32_t AllocateNode(HScene scene)
     {
+        if (scene->m_NodePool.Remaining() == 0 && scene->m_PooledNodeCount > 0)
+        {
+            // Recycled clones are only kept while there is room for them
+            ReleaseClonePools(scene);
+        }
         if (scene->m_NodePool.Remaining() == 0)
         {
             return scene->m_NodePool.Capacity();
@@ -2370,6 +2823,11 @@ namespace dmGui
     {
         InternalNode* n = GetNode(scene, node);
         n->m_NameHash = id;
+        // The id might now resolve to another node
+        if (scene->m_NodeIdCache.Get(id))
+        {
+            scene->m_NodeIdCache.Erase(id);
+        }
     }
 
     void SetNodeId(HScene scene, HNode node, const char* id)
@@ -2389,15 +2847,47 @@ namespace dmGui
         return GetNodeById(scene, name_hash);
     }
 
+    static void CacheNodeId(HScene scene, dmhash_t id, HNode node)
+    {
+        dmHashTable64<HNode>& cache = scene->m_NodeIdCache;
+        if (cache.Full())
+        {
+            uint32_t capacity = cache.Capacity();
+            if (capacity >= scene->m_NodePool.Capacity())
+            {
+                // The ids of deleted nodes pile up, start over
+                cache.Clear();
+            }
+            else
+            {
+                uint32_t newcapacity = dmMath::Min(capacity + 32, (uint32_t) scene->m_NodePool.Capacity());
+                uint32_t tablesize = (newcapacity*2)/3 + 1;
+                cache.SetCapacity(tablesize, newcapacity);
+            }
+        }
+        cache.Put(id, node);
+    }
+
     HNode GetNodeById(HScene scene, dmhash_t id)
     {
+        // Scripts tend to look up the same nodes every frame, so first try the node found the last time
+        HNode* cached = scene->m_NodeIdCache.Get(id);
+        if (cached && IsNodeValid(scene, *cached))
+        {
+            InternalNode* node = &scene->m_Nodes[*cached & 0xffff];
+            if (node->m_NameHash == id && !node->m_Deleted)
+            {
+                return *cached;
+            }
+        }
+
         uint32_t n = scene->m_Nodes.Size();
         InternalNode* nodes = scene->m_Nodes.Begin();
         HNode foundNode = 0;
         for (uint32_t i = 0; i < n; ++i)
         {
             InternalNode* node = &nodes[i];
-            if (node->m_NameHash == id)
+            if (node->m_NameHash == id && !node->m_Pooled)
             {
                 foundNode = GetNodeHandle(node);
                 // https://github.com/defold/defold/issues/3481
@@ -2407,6 +2897,7 @@ namespace dmGui
                 // another one
                 if (!node->m_Deleted)
                 {
+                    CacheNodeId(scene, id, foundNode);
                     break;
                 }
             }
@@ -2416,7 +2907,7 @@ namespace dmGui
 
     uint32_t GetNodeCount(HScene scene)
     {
-        return scene->m_NodePool.Size();
+        return scene->m_NodePool.Size() - scene->m_PooledNodeCount;
     }
 
     uint32_t GetParticlefxCount(HScene scene)
@@ -2441,6 +2932,7 @@ namespace dmGui
 
     static void AddToNodeList(HScene scene, InternalNode* n, InternalNode* parent_n, InternalNode* prev_n)
     {
+        scene->m_RenderNodesDirty = 1;
         uint16_t* head = &scene->m_RenderHead, * tail = &scene->m_RenderTail;
         uint16_t parent_index = INVALID_INDEX;
         if (parent_n != 0x0)
@@ -2485,6 +2977,7 @@ namespace dmGui
 
     static void RemoveFromNodeList(HScene scene, InternalNode* n)
     {
+        scene->m_RenderNodesDirty = 1;
         // Remove from list
         if (n->m_PrevIndex != INVALID_INDEX)
             scene->m_Nodes[n->m_PrevIndex].m_NextIndex = n->m_NextIndex;
@@ -2514,6 +3007,151 @@ namespace dmGui
         n->m_Index = INVALID_INDEX;
     }
 
+    static void CancelNodeAnimations(HScene scene, HNode node)
+    {
+        dmArray<Animation> *animations = &scene->m_Animations;
+        uint32_t n_anims = animations->Size();
+        for (uint32_t i = 0; i < n_anims; ++i)
+        {
+            Animation* anim = &(*animations)[i];
+
+            if (anim->m_Node == node)
+            {
+                CompleteAnimation(scene, anim, false);
+                RemoveAnimation(*animations, i);
+                scene->m_AnimationsVersion++;
+                i--;
+                n_anims--;
+                continue;
+            }
+        }
+    }
+
+    static void FreePooledNode(HScene scene, InternalNode* n)
+    {
+        n->m_NextIndex = INVALID_INDEX;
+        n->m_Pooled = 0;
+        scene->m_PooledNodeCount--;
+        ResetInternalNode(scene, n);
+    }
+
+    static void ReleaseClonePool(HScene scene, HNode source)
+    {
+        uint16_t* head = scene->m_ClonePools.Get(source);
+        if (!head)
+            return;
+        uint16_t index = *head;
+        scene->m_ClonePools.Erase(source);
+        while (index != INVALID_INDEX)
+        {
+            InternalNode* n = &scene->m_Nodes[index];
+            index = n->m_NextIndex;
+            FreePooledNode(scene, n);
+        }
+    }
+
+    static void ReleaseClonePools(HScene scene)
+    {
+        uint32_t n = scene->m_Nodes.Size();
+        for (uint32_t i = 0; i < n; ++i)
+        {
+            InternalNode* node = &scene->m_Nodes[i];
+            if (node->m_Pooled)
+            {
+                FreePooledNode(scene, node);
+                n = scene->m_Nodes.Size();
+            }
+        }
+        scene->m_ClonePools.Clear();
+    }
+
+    // Takes a recycled clone of the source node from its pool, or returns INVALID_INDEX
+    static uint16_t PopPooledNode(HScene scene, HNode source)
+    {
+        uint16_t* head = scene->m_ClonePools.Get(source);
+        if (!head)
+            return INVALID_INDEX;
+        uint16_t index = *head;
+        InternalNode* n = &scene->m_Nodes[index];
+        if (n->m_NextIndex == INVALID_INDEX)
+            scene->m_ClonePools.Erase(source);
+        else
+            *head = n->m_NextIndex;
+        n->m_NextIndex = INVALID_INDEX;
+        n->m_Pooled = 0;
+        scene->m_PooledNodeCount--;
+        return index;
+    }
+
+    static bool IsRecyclable(HScene scene, InternalNode* n)
+    {
+        // Custom nodes and particlefx nodes own external state, so they are deleted instead
+        return n->m_CloneSource != 0 && IsNodeValid(scene, n->m_CloneSource)
+            && n->m_Node.m_CustomType == 0 && n->m_Node.m_NodeType != NODE_TYPE_PARTICLEFX && !n->m_Node.m_IsBone;
+    }
+
+    void RecycleNode(HScene scene, HNode node)
+    {
+        InternalNode* n = GetNode(scene, node);
+
+        // Recycle children first, each one into the pool of its own source node
+        uint16_t child_index = n->m_ChildHead;
+        while (child_index != INVALID_INDEX)
+        {
+            InternalNode* child = &scene->m_Nodes[child_index & 0xffff];
+            child_index = child->m_NextIndex;
+            RecycleNode(scene, GetNodeHandle(child));
+        }
+
+        if (!IsRecyclable(scene, n))
+        {
+            DeleteNode(scene, node, false);
+            n->m_Deleted = 0;
+            n->m_Recycled = 0;
+            return;
+        }
+
+        CancelNodeAnimations(scene, node);
+        ReleaseClonePool(scene, node);
+
+        if (n->m_Node.m_RenderConstants)
+        {
+            scene->m_DestroyRenderConstantsCallback(n->m_Node.m_RenderConstants);
+            n->m_Node.m_RenderConstants = 0;
+        }
+
+        RemoveFromNodeList(scene, n);
+
+        // A new version invalidates the handles to the recycled node
+        uint16_t version = scene->m_NextVersionNumber;
+        if (version == 0)
+        {
+            ++version;
+        }
+        scene->m_NextVersionNumber = (version + 1) % ((1 << 16) - 1);
+        n->m_Version = version;
+        n->m_NameHash = 0;
+        n->m_Deleted = 0;
+        n->m_Recycled = 0;
+        n->m_Pooled = 1;
+        n->m_ParentIndex = INVALID_INDEX;
+        n->m_PrevIndex = INVALID_INDEX;
+        n->m_ChildHead = INVALID_INDEX;
+        n->m_ChildTail = INVALID_INDEX;
+
+        dmHashTable32<uint16_t>& pools = scene->m_ClonePools;
+        uint16_t* head = pools.Get(n->m_CloneSource);
+        n->m_NextIndex = head ? *head : INVALID_INDEX;
+        if (!head && pools.Full())
+        {
+            uint32_t newcapacity = pools.Capacity() + 8;
+            uint32_t tablesize = (newcapacity*2)/3;
+            pools.SetCapacity(tablesize, newcapacity);
+        }
+        pools.Put(n->m_CloneSource, n->m_Index);
+        scene->m_PooledNodeCount++;
+    }
+
     void DeleteNode(HScene scene, HNode node, bool delete_headless_pfx)
     {
         InternalNode* n = GetNode(scene, node);
@@ -2544,6 +3182,7 @@ namespace dmGui
                         dmParticle::DestroyInstance(scene->m_ParticlefxContext, comp_n->m_Node.m_ParticleInstance);
                         n->m_Node.m_ParticleInstance = dmParticle::INVALID_INSTANCE;
                         scene->m_AliveParticlefxs.EraseSwap(i);
+                        scene->m_RenderNodesDirty = 1;
                         --count;
                     }
                     else
@@ -2569,21 +3208,10 @@ namespace dmGui
             DeleteNode(scene, GetNodeHandle(child), delete_headless_pfx);
         }
 
-        dmArray<Animation> *animations = &scene->m_Animations;
-        uint32_t n_anims = animations->Size();
-        for (uint32_t i = 0; i < n_anims; ++i)
-        {
-            Animation* anim = &(*animations)[i];
+        CancelNodeAnimations(scene, node);
 
-            if (anim->m_Node == node)
-            {
-                CompleteAnimation(scene, anim, false);
-                RemoveAnimation(*animations, i);
-                i--;
-                n_anims--;
-                continue;
-            }
-        }
+        // The recycled clones of the node can't be reused anymore
+        ReleaseClonePool(scene, node);
 
         if (!delete_headless_pfx && n->m_Node.m_HasHeadlessPfx)
         {
@@ -2608,8 +3236,13 @@ namespace dmGui
         scene->m_Nodes.SetSize(0);
         scene->m_RenderHead = INVALID_INDEX;
         scene->m_RenderTail = INVALID_INDEX;
+        scene->m_RenderNodesDirty = 1;
         scene->m_NodePool.Clear();
         scene->m_Animations.SetSize(0);
+        scene->m_AnimationsVersion++;
+        scene->m_NodeIdCache.Clear();
+        scene->m_ClonePools.Clear();
+        scene->m_PooledNodeCount = 0;
     }
 
     static Vector4 ApplyAdjustOnReferenceScale(const Vector4& reference_scale, uint32_t adjust_mode)
@@ -2761,6 +3394,7 @@ namespace dmGui
             }
         }
         scene->m_Animations.SetSize(0);
+        scene->m_AnimationsVersion++;
     }
 
     uint16_t GetRenderOrder(HScene scene)
@@ -3195,6 +3829,7 @@ namespace dmGui
             InternalNode* n = GetNode(scene, node);
             n->m_Node.m_LayerHash = layer_id;
             n->m_Node.m_LayerIndex = *layer_index;
+            scene->m_RenderNodesDirty = 1;
             return RESULT_OK;
         }
         else
@@ -3330,6 +3965,7 @@ namespace dmGui
 
         uint32_t count = scene->m_AliveParticlefxs.Size();
         scene->m_AliveParticlefxs.SetSize(count + 1);
+        scene->m_RenderNodesDirty = 1;
         ParticlefxComponent* component = &scene->m_AliveParticlefxs[count];
         component->m_Prototype = particlefx_prototype;
         component->m_Instance = inst;
@@ -3367,6 +4003,7 @@ namespace dmGui
     {
         InternalNode* n = GetNode(scene, node);
         n->m_Node.m_ClippingMode = mode;
+        scene->m_RenderNodesDirty = 1;
     }
 
     ClippingMode GetNodeClippingMode(HScene scene, HNode node)
@@ -3379,6 +4016,7 @@ namespace dmGui
     {
         InternalNode* n = GetNode(scene, node);
         n->m_Node.m_ClippingVisible = (uint32_t) visible;
+        scene->m_RenderNodesDirty = 1;
     }
 
     bool GetNodeClippingVisible(HScene scene, HNode node)
@@ -3391,6 +4029,7 @@ namespace dmGui
     {
         InternalNode* n = GetNode(scene, node);
         n->m_Node.m_ClippingInverted = (uint32_t) inverted;
+        scene->m_RenderNodesDirty = 1;
     }
 
     bool GetNodeClippingInverted(HScene scene, HNode node)
@@ -3615,6 +4254,7 @@ namespace dmGui
         animation.m_Backwards = 0;
 
         animation_index = InsertAnimation(scene->m_Animations, &animation);
+        scene->m_AnimationsVersion++;
         return &scene->m_Animations[animation_index];
     }
 
@@ -3976,6 +4616,7 @@ namespace dmGui
     {
         InternalNode* n = GetNode(scene, node);
         n->m_Node.m_Enabled = enabled;
+        scene->m_RenderNodesDirty = 1;
         if(enabled)
         {
             SetDirtyLocalRecursive(scene, node);
@@ -4195,11 +4836,21 @@ namespace dmGui
 
     Result CloneNode(HScene scene, HNode node, HNode* out_node)
     {
-        uint16_t index = AllocateNode(scene);
-        if (index == scene->m_NodePool.Capacity())
+        // Reuse a recycled clone of the same node if there is one
+        const char* pooled_text = 0x0;
+        uint16_t index = PopPooledNode(scene, node);
+        if (index != INVALID_INDEX)
         {
-            dmLogError("Could not create the node since the buffer is full (%d).", scene->m_NodePool.Capacity());
-            return RESULT_OUT_OF_RESOURCES;
+            pooled_text = scene->m_Nodes[index].m_Node.m_Text;
+        }
+        else
+        {
+            index = AllocateNode(scene);
+            if (index == scene->m_NodePool.Capacity())
+            {
+                dmLogError("Could not create the node since the buffer is full (%d).", scene->m_NodePool.Capacity());
+                return RESULT_OUT_OF_RESOURCES;
+            }
         }
         uint16_t version = scene->m_NextVersionNumber;
         if (version == 0)
@@ -4217,9 +4868,16 @@ namespace dmGui
 
         InternalNode* n = GetNode(scene, node);
         out_n->m_Node = n->m_Node;
-        if (n->m_Node.m_Text != 0x0)
-            out_n->m_Node.m_Text = strdup(n->m_Node.m_Text);
+        const char* text = n->m_Node.m_Text;
+        if (pooled_text != 0x0 && (text == 0x0 || strcmp(pooled_text, text) != 0))
+        {
+            free((void*)pooled_text);
+            pooled_text = 0x0;
+        }
+        if (text != 0x0)
+            out_n->m_Node.m_Text = pooled_text ? pooled_text : strdup(text);
         out_n->m_NameHash = dmHashString64(name);
+        out_n->m_CloneSource = node;
         out_n->m_Version = version;
         out_n->m_Index = index;
         out_n->m_SceneTraversalCacheVersion = INVALID_INDEX;
@@ -252,10 +252,12 @@ namespace dmGui
     typedef void (*GetTextMetricsCallback)(const void* font, const char* text, float width, bool line_break, float leading, float tracking, TextMetrics* out_metrics);
 
     /**
-     * Stencil clipping render state
+     * Clipping render state
      */
     struct StencilScope
     {
+        /// Scissor rect (min x, min y, max x, max y) in the space of the node transforms
+        float       m_ScissorRect[4];
         /// Stencil reference value
         uint8_t     m_RefVal;
         /// Stencil test mask
@@ -264,7 +266,11 @@ namespace dmGui
         uint8_t     m_WriteMask;
         /// Color mask (R,G,B,A)
         uint8_t     m_ColorMask : 4;
-        uint8_t     m_Padding : 4;
+        /// If the stencil test is used
+        uint8_t     m_UseStencil : 1;
+        /// If the scissor rect is used
+        uint8_t     m_UseScissor : 1;
+        uint8_t     m_Padding : 2;
     };
 
     struct NewContextParams;
@@ -283,6 +289,8 @@ namespace dmGui
         uint32_t                m_DefaultProjectWidth;
         uint32_t                m_DefaultProjectHeight;
         uint32_t                m_Dpi;
+        // Clip with scissor rects instead of the stencil buffer, for the box clippers that aren't rotated
+        uint32_t                m_ScissorClipping : 1;
 
         NewContextParams()
         {
@@ -402,6 +410,8 @@ namespace dmGui
         uint32_t m_GamepadIndex;
         uint32_t m_UserID;
         dmHID::GamepadPacket m_GamepadPacket;
+        /// When the input was sampled (microseconds, same clock as dmTime::GetTime()), or 0 if unknown
+        uint64_t m_Time;
 
         uint8_t  m_IsGamepad : 1;
         uint8_t  m_GamepadUnknown : 1;
@@ -762,6 +772,15 @@ namespace dmGui
      */
     Result SetLayout(const HScene scene, dmhash_t layout_id, SetNodeCallback set_node_callback);
 
+    /**
+     * Resolve the node descs of all layouts into node states, which SetLayout then copies
+     * instead of calling the callback. Call after the node descs are set.
+     * Custom, particlefx and animated nodes are still set through the callback.
+     * @param scene Scene of which to resolve the layouts
+     * @param set_node_callback Callback function that will set node from node descriptor
+     */
+    void ResolveLayouts(const HScene scene, SetNodeCallback set_node_callback);
+
     /** Renders a gui scene
      * Renders a gui scene by calling the callback functions
      *
@@ -855,6 +874,14 @@ namespace dmGui
 
     void DeleteNode(HScene scene, HNode node, bool delete_headless_pfx);
 
+    /**
+     * Detach a cloned node and its children and keep them for reuse by CloneNode of the same source node.
+     * Nodes that weren't cloned, custom nodes and particlefx nodes are deleted instead.
+     * @param scene
+     * @param node the node to recycle
+     */
+    void RecycleNode(HScene scene, HNode node);
+
     void ClearNodes(HScene scene);
 
     /**
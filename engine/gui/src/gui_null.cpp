@@ -268,6 +268,10 @@ namespace dmGui
         return RESULT_OK;
     }
 
+    void ResolveLayouts(const HScene scene, SetNodeCallback set_node_callback)
+    {
+    }
+
     HNode GetNodeHandle(InternalNode* node)
     {
         return 0;
@@ -374,6 +378,10 @@ namespace dmGui
     {
     }
 
+    void RecycleNode(HScene scene, HNode node)
+    {
+    }
+
     InternalNode* GetNode(HScene scene, HNode node)
     {
         return 0;
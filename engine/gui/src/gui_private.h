@@ -76,6 +76,8 @@ namespace dmGui
         uint16_t                m_ParentIndex;
         uint16_t                m_NextNonInvIndex;
         uint16_t                m_NodeIndex;
+        // Clips with a scissor rect, and leaves the stencil state of the parent unchanged
+        uint16_t                m_Scissor;
     };
 
     struct Context
@@ -90,11 +92,11 @@ namespace dmGui
         uint32_t                        m_DefaultProjectWidth;
         uint32_t                        m_DefaultProjectHeight;
         uint32_t                        m_Dpi;
+        uint32_t                        m_ScissorClipping : 1;
         dmArray<HScene>                 m_Scenes;
         dmArray<RenderEntry>            m_RenderNodes;
         dmArray<dmVMath::Matrix4>       m_RenderTransforms;
         dmArray<float>                	m_RenderOpacities;
-        dmArray<InternalClippingNode>   m_StencilClippingNodes;
         dmArray<StencilScope*>          m_StencilScopes;
         dmArray<uint16_t>               m_StencilScopeIndices;
         dmArray<HNode>                  m_ScratchBoneNodes;
@@ -173,6 +175,23 @@ namespace dmGui
         dmParticle::HInstance   m_ParticleInstance;
     };
 
+    // The node state resolved from the node desc of a layout, see ResolveLayouts
+    struct NodeLayoutState
+    {
+        dmVMath::Vector4    m_Properties[PROPERTY_COUNT];
+        dmhash_t            m_TextureHash;
+        dmhash_t            m_FontHash;
+        dmhash_t            m_LayerHash;
+        dmhash_t            m_MaterialNameHash;
+        uint32_t            m_State;
+        uint32_t            m_PerimeterVertices;
+        PieBounds           m_OuterBounds;
+        // Offset into Scene::m_LayoutTexts, or INVALID_LAYOUT_STATE if the node has no text
+        uint32_t            m_TextOffset;
+    };
+
+    static const uint32_t INVALID_LAYOUT_STATE = 0xffffffff;
+
     struct InternalNode
     {
         Node            m_Node;
@@ -187,8 +206,12 @@ namespace dmGui
         uint16_t        m_SceneTraversalCacheIndex;
         uint16_t        m_SceneTraversalCacheVersion;
         uint16_t        m_ClipperIndex;
+        // The node this node was cloned from, or 0. Recycled clones are pooled per source node
+        HNode           m_CloneSource;
         uint16_t        m_Deleted : 1; // Set to true for deferred deletion
-        uint16_t        m_Padding : 15;
+        uint16_t        m_Recycled : 1; // Set to true for deferred recycling
+        uint16_t        m_Pooled : 1; // Detached and kept for reuse by CloneNode. m_NextIndex links the pooled clones
+        uint16_t        m_Padding : 13;
     };
 
     struct NodeProxy
@@ -263,7 +286,20 @@ namespace dmGui
         Script*                               m_Script;
         dmIndexPool16                         m_NodePool;
         dmArray<InternalNode>                 m_Nodes;
+        // Last node found for an id, validated on lookup
+        dmHashTable64<HNode>                  m_NodeIdCache;
+        // Recycled clones, from the source node to the first pooled node index
+        dmHashTable32<uint16_t>               m_ClonePools;
+        uint32_t                              m_PooledNodeCount;
         dmArray<Animation>                    m_Animations;
+        // Scratch buffers for evaluating the animation easing curves in batches, see UpdateAnimations
+        dmArray<float>                        m_AnimationEasedValues;
+        dmArray<uint8_t>                      m_AnimationEased;
+        dmArray<uint32_t>                     m_AnimationCurveIndices;
+        dmArray<float>                        m_AnimationCurveTimes;
+        dmArray<float>                        m_AnimationCurveValues;
+        // Incremented whenever animations are added or removed
+        uint32_t                              m_AnimationsVersion;
         dmHashTable<uintptr_t, dmhash_t>      m_ResourceToPath;
         dmHashTable64<void*>                  m_Fonts;
         dmHashTable64<TextureInfo>            m_Textures;
@@ -275,6 +311,10 @@ namespace dmGui
         dmHashTable64<uint16_t>               m_Layers;
         dmArray<dmhash_t>                     m_Layouts;
         dmArray<void*>                        m_LayoutsNodeDescs;
+        // Index into m_LayoutNodeStates for each entry in m_LayoutsNodeDescs, or INVALID_LAYOUT_STATE
+        dmArray<uint32_t>                     m_LayoutsNodeStateIndices;
+        dmArray<NodeLayoutState>              m_LayoutNodeStates;
+        dmArray<char>                         m_LayoutTexts;
         dmhash_t                              m_LayoutId;
         AdjustReference                       m_AdjustReference;
         void*                                 m_DefaultFont;
@@ -285,6 +325,12 @@ namespace dmGui
         uint16_t                              m_RenderOrder; // For the render-key
         uint16_t                              m_NextLayerIndex;
         uint16_t                              m_ResChanged : 1;
+        // Set when the node structure changed and m_CollectedRenderNodes needs to be rebuilt
+        uint16_t                              m_RenderNodesDirty : 1;
+        // Sorted render entries and the clippers they use, cached between frames
+        dmArray<RenderEntry>                  m_CollectedRenderNodes;
+        dmArray<InternalClippingNode>         m_StencilClippingNodes;
+        uint32_t                              m_CollectedActiveNodes;
         uint32_t                              m_Width;
         uint32_t                              m_Height;
         dmScript::ScriptWorld*                m_ScriptWorld;
@@ -984,6 +984,45 @@ namespace dmGui
         return 0;
     }
 
+    /*# recycles a cloned node
+     *
+     * Removes the specified node and any child nodes it might have, like
+     * gui.delete_node, but keeps the nodes created with gui.clone or
+     * gui.clone_tree around. Subsequent clones of the same source node reuse
+     * them instead of allocating new nodes, which is cheaper for lists that
+     * keep cloning and deleting rows.
+     * Nodes that weren't cloned, custom nodes and particlefx nodes are deleted.
+     *
+     * @name gui.recycle_node
+     * @param node [type:node] node to recycle
+     * @examples
+     *
+     * Recycle the rows of a list that scrolled out of view:
+     *
+     * ```lua
+     * for i, row in ipairs(self.hidden_rows) do
+     *     gui.recycle_node(row)
+     * end
+     * -- reuses the recycled rows
+     * local row = gui.clone_tree(self.row_template)
+     * ```
+     */
+    static int LuaRecycleNode(lua_State* L)
+    {
+        DM_LUA_STACK_CHECK(L, 0);
+
+        HNode hnode;
+        InternalNode* n = LuaCheckNodeInternal(L, 1, &hnode);
+        if (n->m_Node.m_IsBone) {
+            return luaL_error(L, "Unable to recycle bone nodes");
+        }
+
+        // Set deferred recycle flag
+        n->m_Recycled = 1;
+
+        return 0;
+    }
+
     static void LuaCurveRelease(dmEasing::Curve* curve)
     {
         HScene scene = (HScene)curve->userdata1;
@@ -2548,10 +2587,11 @@ namespace dmGui
      */
     static int LuaSetClippingMode(lua_State* L)
     {
+        Scene* scene = GuiScriptInstance_Check(L);
         HNode hnode;
-        InternalNode* n = LuaCheckNodeInternal(L, 1, &hnode);
+        LuaCheckNodeInternal(L, 1, &hnode);
         int clipping_mode = (int) luaL_checknumber(L, 2);
-        n->m_Node.m_ClippingMode = (ClippingMode) clipping_mode;
+        SetNodeClippingMode(scene, hnode, (ClippingMode) clipping_mode);
         return 0;
     }
 
@@ -2579,10 +2619,11 @@ namespace dmGui
      */
     static int LuaSetClippingVisible(lua_State* L)
     {
+        Scene* scene = GuiScriptInstance_Check(L);
         HNode hnode;
-        InternalNode* n = LuaCheckNodeInternal(L, 1, &hnode);
+        LuaCheckNodeInternal(L, 1, &hnode);
         int visible = lua_toboolean(L, 2);
-        n->m_Node.m_ClippingVisible = visible;
+        SetNodeClippingVisible(scene, hnode, visible != 0);
         return 0;
     }
 
@@ -2610,10 +2651,11 @@ namespace dmGui
      */
     static int LuaSetClippingInverted(lua_State* L)
     {
+        Scene* scene = GuiScriptInstance_Check(L);
         HNode hnode;
-        InternalNode* n = LuaCheckNodeInternal(L, 1, &hnode);
+        LuaCheckNodeInternal(L, 1, &hnode);
         int inverted = lua_toboolean(L, 2);
-        n->m_Node.m_ClippingInverted = inverted;
+        SetNodeClippingInverted(scene, hnode, inverted != 0);
         return 0;
     }
 
@@ -4817,6 +4859,7 @@ namespace dmGui
         {"set",             LuaSet},
         {"get_index",       LuaGetIndex},
         {"delete_node",     LuaDeleteNode},
+        {"recycle_node",    LuaRecycleNode},
         {"animate",         LuaAnimate},
         {"cancel_animation",LuaCancelAnimation},
         {"new_box_node",    LuaNewBoxNode},
@@ -5542,6 +5585,7 @@ namespace dmGui
      * `screen_dx` | The change in screen space x value of a pointer device, if present.
      * `screen_dy` | The change in screen space y value of a pointer device, if present.
      * `gamepad`   | The index of the gamepad device that provided the input.
+     * `time`      | When the input was sampled, in seconds (same clock as `socket.gettime()`).
      * `touch`     | List of touch input, one element per finger, if present. See table below about touch input
      *
      * Touch input table:
@@ -424,6 +424,73 @@ TEST_F(dmGuiTest, Layouts)
     ASSERT_EQ(dmGui::RESULT_OK, r);
 }
 
+struct LayoutDesc
+{
+    Point3      m_Position;
+    const char* m_Text;
+};
+
+static uint32_t g_LayoutCallbackCount = 0;
+
+void SetNodeLayoutCallback(const dmGui::HScene scene, dmGui::HNode node, const void *node_desc)
+{
+    const LayoutDesc* desc = (const LayoutDesc*) node_desc;
+    dmGui::SetNodePosition(scene, node, desc->m_Position);
+    dmGui::SetNodeText(scene, node, desc->m_Text);
+    dmGui::SetNodeResetPoint(scene, node);
+    ++g_LayoutCallbackCount;
+}
+
+TEST_F(dmGuiTest, ResolvedLayouts)
+{
+    dmGui::AllocateLayouts(m_Scene, 2, 2);
+    ASSERT_EQ(dmGui::RESULT_OK, dmGui::AddLayout(m_Scene, "layout1"));
+    ASSERT_EQ(dmGui::RESULT_OK, dmGui::AddLayout(m_Scene, "layout2"));
+    dmhash_t l1_hash = dmHashString64("layout1");
+    dmhash_t l2_hash = dmHashString64("layout2");
+
+    LayoutDesc d0 = {Point3(0,0,0), "default"};
+    LayoutDesc d1 = {Point3(1,0,0), "layout1"};
+    dmGui::HNode text = dmGui::NewNode(m_Scene, Point3(0,0,0), Vector3(1,1,1), dmGui::NODE_TYPE_TEXT, 0);
+    dmGui::HNode box = dmGui::NewNode(m_Scene, Point3(0,0,0), Vector3(1,1,1), dmGui::NODE_TYPE_BOX, 0);
+    SetNodeLayoutCallback(m_Scene, text, &d0);
+    SetNodeLayoutCallback(m_Scene, box, &d0);
+    ASSERT_EQ(dmGui::RESULT_OK, dmGui::SetNodeLayoutDesc(m_Scene, text, &d0, 0, 2));
+    ASSERT_EQ(dmGui::RESULT_OK, dmGui::SetNodeLayoutDesc(m_Scene, text, &d1, 1, 1));
+    ASSERT_EQ(dmGui::RESULT_OK, dmGui::SetNodeLayoutDesc(m_Scene, box, &d0, 0, 2));
+
+    // Only the overridden desc needs to be applied
+    g_LayoutCallbackCount = 0;
+    dmGui::ResolveLayouts(m_Scene, SetNodeLayoutCallback);
+    ASSERT_EQ(1U, g_LayoutCallbackCount);
+    ASSERT_EQ(0, dmGui::GetNodePosition(m_Scene, text).getX());
+    ASSERT_STREQ("default", dmGui::GetNodeText(m_Scene, text));
+
+    // Switching layouts copies the resolved states
+    g_LayoutCallbackCount = 0;
+    dmGui::SetLayout(m_Scene, l1_hash, SetNodeLayoutCallback);
+    ASSERT_EQ(1, dmGui::GetNodePosition(m_Scene, text).getX());
+    ASSERT_STREQ("layout1", dmGui::GetNodeText(m_Scene, text));
+    ASSERT_EQ(0, dmGui::GetNodePosition(m_Scene, box).getX());
+
+    dmGui::SetNodePosition(m_Scene, box, Point3(5,0,0));
+    dmGui::SetLayout(m_Scene, l2_hash, SetNodeLayoutCallback);
+    ASSERT_EQ(0, dmGui::GetNodePosition(m_Scene, text).getX());
+    ASSERT_STREQ("default", dmGui::GetNodeText(m_Scene, text));
+    ASSERT_EQ(0, dmGui::GetNodePosition(m_Scene, box).getX());
+
+    dmGui::SetLayout(m_Scene, dmGui::DEFAULT_LAYOUT, SetNodeLayoutCallback);
+    ASSERT_EQ(0, dmGui::GetNodePosition(m_Scene, text).getX());
+    ASSERT_EQ(0U, g_LayoutCallbackCount);
+
+    // Changed descs are applied through the callback again
+    LayoutDesc d2 = {Point3(2,0,0), "layout2"};
+    ASSERT_EQ(dmGui::RESULT_OK, dmGui::SetNodeLayoutDesc(m_Scene, box, &d2, 2, 2));
+    dmGui::SetLayout(m_Scene, l2_hash, SetNodeLayoutCallback);
+    ASSERT_EQ(2, dmGui::GetNodePosition(m_Scene, box).getX());
+    ASSERT_EQ(1U, g_LayoutCallbackCount);
+}
+
 TEST_F(dmGuiTest, NodeTextureType)
 {
     int t1, t2;
@@ -1048,6 +1115,52 @@ TEST_F(dmGuiTest, CustomEasingAnimation)
     dmGui::DeleteNode(m_Scene, node, true);
 }
 
+TEST_F(dmGuiTest, AnimateMixedEasing)
+{
+    dmhash_t property = dmGui::GetPropertyHash(dmGui::PROPERTY_POSITION);
+
+    dmVMath::FloatVector vector(64);
+    for (int i = 0; i < 64; ++i) {
+        float t = i / 63.0f;
+        vector.values[i] = t * t;
+    }
+    dmEasing::Curve custom_curve(dmEasing::TYPE_FLOAT_VECTOR);
+    custom_curve.vector = &vector;
+
+    // Interleave the curve types so that the batched evaluation has to regroup them
+    const uint32_t node_count = 8;
+    dmEasing::Curve curves[node_count] = {
+        dmEasing::Curve(dmEasing::TYPE_OUTBOUNCE), dmEasing::Curve(dmEasing::TYPE_LINEAR),
+        custom_curve, dmEasing::Curve(dmEasing::TYPE_OUTBOUNCE),
+        dmEasing::Curve(dmEasing::TYPE_INQUAD), dmEasing::Curve(dmEasing::TYPE_LINEAR),
+        dmEasing::Curve(dmEasing::TYPE_INOUTELASTIC), dmEasing::Curve(dmEasing::TYPE_INQUAD),
+    };
+
+    dmGui::HNode nodes[node_count];
+    for (uint32_t i = 0; i < node_count; ++i)
+    {
+        nodes[i] = dmGui::NewNode(m_Scene, Point3(0,0,0), Vector3(10,10,0), dmGui::NODE_TYPE_BOX, 0);
+        dmGui::AnimateNodeHash(m_Scene, nodes[i], property, Vector4(1,0,0,0), curves[i], dmGui::PLAYBACK_ONCE_FORWARD, 1.0f, 0.0f, 0, 0, 0);
+    }
+
+    for (int frame = 1; frame <= 60; ++frame)
+    {
+        dmGui::UpdateScene(m_Scene, 1.0f / 60.0f);
+        float t = frame / 60.0f;
+        for (uint32_t i = 0; i < node_count; ++i)
+        {
+            // The accumulated elapsed time differs slightly from t
+            ASSERT_NEAR(dmEasing::GetValue(curves[i], t), dmGui::GetNodePosition(m_Scene, nodes[i]).getX(), 0.0001f);
+        }
+    }
+
+    for (uint32_t i = 0; i < node_count; ++i)
+    {
+        ASSERT_NEAR(1.0f, dmGui::GetNodePosition(m_Scene, nodes[i]).getX(), EPSILON);
+        dmGui::DeleteNode(m_Scene, nodes[i], true);
+    }
+}
+
 TEST_F(dmGuiTest, Playback)
 {
     const float duration = 4 / 60.0f;
@@ -3507,6 +3620,52 @@ static void RenderNodesOrder(dmGui::HScene scene, const dmGui::RenderEntry* node
     }
 }
 
+// Verify that the render entries collected by RenderScene are reused until the node structure changes
+TEST_F(dmGuiTest, RenderEntriesCache)
+{
+    Vector3 size(10, 10, 0);
+    Point3 pos(size * 0.5f);
+
+    std::map<dmGui::HNode, uint16_t> order;
+
+    dmGui::RenderSceneParams render_params;
+    render_params.m_RenderNodes = RenderNodesOrder;
+
+    dmGui::AddLayer(m_Scene, "l1");
+    dmGui::AddLayer(m_Scene, "l2");
+
+    dmGui::HNode n1 = dmGui::NewNode(m_Scene, pos, size, dmGui::NODE_TYPE_BOX, 0);
+    dmGui::HNode n2 = dmGui::NewNode(m_Scene, pos, size, dmGui::NODE_TYPE_BOX, 0);
+    ASSERT_TRUE(m_Scene->m_RenderNodesDirty);
+    dmGui::RenderScene(m_Scene, render_params, &order);
+    ASSERT_FALSE(m_Scene->m_RenderNodesDirty);
+    ASSERT_EQ(0u, order[n1]);
+    ASSERT_EQ(1u, order[n2]);
+
+    // Non structural changes keep the cached entries
+    dmGui::SetNodePosition(m_Scene, n1, Point3(1.0f, 2.0f, 0.0f));
+    ASSERT_FALSE(m_Scene->m_RenderNodesDirty);
+    dmGui::RenderScene(m_Scene, render_params, &order);
+    ASSERT_EQ(0u, order[n1]);
+    ASSERT_EQ(1u, order[n2]);
+
+    dmGui::SetNodeLayer(m_Scene, n1, dmHashString64("l2"));
+    dmGui::SetNodeLayer(m_Scene, n2, dmHashString64("l1"));
+    ASSERT_TRUE(m_Scene->m_RenderNodesDirty);
+    dmGui::RenderScene(m_Scene, render_params, &order);
+    ASSERT_EQ(1u, order[n1]);
+    ASSERT_EQ(0u, order[n2]);
+
+    dmGui::SetNodeEnabled(m_Scene, n2, false);
+    dmGui::RenderScene(m_Scene, render_params, &order);
+    ASSERT_EQ(1u, order.size());
+    ASSERT_EQ(0u, order[n1]);
+
+    dmGui::DeleteNode(m_Scene, n1);
+    dmGui::RenderScene(m_Scene, render_params, &order);
+    ASSERT_EQ(0u, order.size());
+}
+
 // Verify specific use cases of moving around nodes:
 // - single node (nop)
 //   - move to top
@@ -5401,6 +5560,117 @@ TEST_F(dmGuiTest, CloneNodeAndAnim)
     dmGui::RemoveTexture(m_Scene, dmHashString64("t1"));
 }
 
+TEST_F(dmGuiTest, GetNodeByIdCache)
+{
+    dmGui::HNode n1 = dmGui::NewNode(m_Scene, Point3(0,0,0), Vector3(10,10,0), dmGui::NODE_TYPE_BOX, 0);
+    dmGui::HNode n2 = dmGui::NewNode(m_Scene, Point3(0,0,0), Vector3(10,10,0), dmGui::NODE_TYPE_BOX, 0);
+    dmGui::SetNodeId(m_Scene, n1, "n1");
+    dmGui::SetNodeId(m_Scene, n2, "n2");
+
+    ASSERT_EQ(n1, dmGui::GetNodeById(m_Scene, "n1"));
+    ASSERT_EQ(n1, dmGui::GetNodeById(m_Scene, "n1"));
+    ASSERT_EQ(n2, dmGui::GetNodeById(m_Scene, "n2"));
+
+    // Renamed nodes
+    dmGui::SetNodeId(m_Scene, n1, "other");
+    dmGui::SetNodeId(m_Scene, n2, "n1");
+    ASSERT_EQ(n2, dmGui::GetNodeById(m_Scene, "n1"));
+    ASSERT_EQ(n1, dmGui::GetNodeById(m_Scene, "other"));
+
+    // Deleted nodes
+    dmGui::DeleteNode(m_Scene, n2, false);
+    ASSERT_EQ((dmGui::HNode) 0, dmGui::GetNodeById(m_Scene, "n1"));
+    dmGui::HNode n3 = dmGui::NewNode(m_Scene, Point3(0,0,0), Vector3(10,10,0), dmGui::NODE_TYPE_BOX, 0);
+    dmGui::SetNodeId(m_Scene, n3, "n1");
+    ASSERT_EQ(n3, dmGui::GetNodeById(m_Scene, "n1"));
+}
+
+TEST_F(dmGuiTest, RecycleNode)
+{
+    dmGui::HNode parent = dmGui::NewNode(m_Scene, Point3(0,0,0), Vector3(10,10,0), dmGui::NODE_TYPE_BOX, 0);
+    dmGui::HNode child = dmGui::NewNode(m_Scene, Point3(0,0,0), Vector3(10,10,0), dmGui::NODE_TYPE_TEXT, 0);
+    dmGui::SetNodeText(m_Scene, child, "row");
+    dmGui::SetNodeParent(m_Scene, child, parent, false);
+    ASSERT_EQ(2U, dmGui::GetNodeCount(m_Scene));
+
+    dmGui::HNode parent_clone, child_clone;
+    ASSERT_EQ(dmGui::RESULT_OK, dmGui::CloneNode(m_Scene, parent, &parent_clone));
+    ASSERT_EQ(dmGui::RESULT_OK, dmGui::CloneNode(m_Scene, child, &child_clone));
+    dmGui::SetNodeParent(m_Scene, child_clone, parent_clone, false);
+    dmGui::SetNodePosition(m_Scene, parent_clone, Point3(1,2,3));
+    ASSERT_EQ(4U, dmGui::GetNodeCount(m_Scene));
+
+    // The recycled clones are invalid but still kept
+    dmGui::RecycleNode(m_Scene, parent_clone);
+    ASSERT_FALSE(dmGui::IsNodeValid(m_Scene, parent_clone));
+    ASSERT_FALSE(dmGui::IsNodeValid(m_Scene, child_clone));
+    ASSERT_EQ(2U, dmGui::GetNodeCount(m_Scene));
+    ASSERT_EQ(4U, m_Scene->m_NodePool.Size());
+
+    // Cloning the sources again reuses the same slots, with the state of the sources
+    dmGui::HNode parent_clone2, child_clone2;
+    ASSERT_EQ(dmGui::RESULT_OK, dmGui::CloneNode(m_Scene, parent, &parent_clone2));
+    ASSERT_EQ(dmGui::RESULT_OK, dmGui::CloneNode(m_Scene, child, &child_clone2));
+    ASSERT_EQ(parent_clone & 0xffff, parent_clone2 & 0xffff);
+    ASSERT_EQ(child_clone & 0xffff, child_clone2 & 0xffff);
+    ASSERT_NE(parent_clone, parent_clone2);
+    ASSERT_EQ(4U, m_Scene->m_NodePool.Size());
+    ASSERT_EQ(4U, dmGui::GetNodeCount(m_Scene));
+    ASSERT_EQ(0.0f, dmGui::GetNodePosition(m_Scene, parent_clone2).getX());
+    ASSERT_EQ(0.0f, dmGui::GetNodePosition(m_Scene, parent_clone2).getY());
+    ASSERT_STREQ("row", dmGui::GetNodeText(m_Scene, child_clone2));
+    ASSERT_EQ(child_clone2, dmGui::GetNodeById(m_Scene, dmGui::GetNodeId(m_Scene, child_clone2)));
+
+    // Deleting the source releases its recycled clones
+    dmGui::RecycleNode(m_Scene, child_clone2);
+    ASSERT_EQ(4U, m_Scene->m_NodePool.Size());
+    dmGui::DeleteNode(m_Scene, child, false);
+    ASSERT_EQ(2U, m_Scene->m_NodePool.Size());
+    ASSERT_EQ(2U, dmGui::GetNodeCount(m_Scene));
+
+    // Nodes that weren't cloned are deleted
+    dmGui::RecycleNode(m_Scene, parent);
+    ASSERT_EQ(1U, dmGui::GetNodeCount(m_Scene));
+}
+
+TEST_F(dmGuiTest, ScriptRecycleNode)
+{
+    const char* s = "function init(self)\n"
+                    "    self.template = gui.new_box_node(vmath.vector3(0, 0, 0), vmath.vector3(10, 10, 0))\n"
+                    "    gui.set_id(self.template, \"template\")\n"
+                    "    local child = gui.new_text_node(vmath.vector3(0, 0, 0), \"row\")\n"
+                    "    gui.set_id(child, \"child\")\n"
+                    "    gui.set_parent(child, self.template)\n"
+                    "    self.rows = {}\n"
+                    "    for i = 1, 10 do\n"
+                    "        self.rows[i] = gui.clone_tree(self.template)\n"
+                    "    end\n"
+                    "end\n"
+                    "function update(self, dt)\n"
+                    "    for i = 1, 10 do\n"
+                    "        local row = self.rows[i]\n"
+                    "        if row then\n"
+                    "            gui.recycle_node(row[hash(\"template\")])\n"
+                    "        end\n"
+                    "        self.rows[i] = gui.clone_tree(self.template)\n"
+                    "        assert(gui.get_text(self.rows[i][hash(\"child\")]) == \"row\")\n"
+                    "    end\n"
+                    "end\n";
+
+    ASSERT_EQ(dmGui::RESULT_OK, dmGui::SetScript(m_Script, LuaSourceFromStr(s)));
+    ASSERT_EQ(dmGui::RESULT_OK, dmGui::InitScene(m_Scene));
+    ASSERT_EQ(22U, dmGui::GetNodeCount(m_Scene));
+
+    ASSERT_EQ(dmGui::RESULT_OK, dmGui::UpdateScene(m_Scene, 1.0f / 60.0f));
+    ASSERT_EQ(42U, m_Scene->m_NodePool.Size());
+    ASSERT_EQ(22U, dmGui::GetNodeCount(m_Scene));
+
+    // The rows recycled in the previous frame are reused
+    ASSERT_EQ(dmGui::RESULT_OK, dmGui::UpdateScene(m_Scene, 1.0f / 60.0f));
+    ASSERT_EQ(42U, m_Scene->m_NodePool.Size());
+    ASSERT_EQ(22U, dmGui::GetNodeCount(m_Scene));
+}
+
 // Check consistancy of get_screen_position/set_screen_position functions 
 TEST_F(dmGuiTest, SetGetScreenPosition)
 {
@@ -1146,6 +1146,67 @@ TEST_F(dmGuiClippingTest, TestOverflowClearEnd) {
     Render();
 }
 
+/**
+ * Verify that box clippers that aren't rotated clip with scissor rects, and don't use any stencil bits
+ *
+ * - a (scissor)
+ *   - b (scissor)
+ *     - c
+ *   - d (1 bit, rotated)
+ *     - e
+ */
+TEST_F(dmGuiClippingTest, TestScissor) {
+    m_Context->m_ScissorClipping = 1;
+    dmGui::SetPhysicalResolution(m_Context, 640, 960);
+    dmGui::SetDefaultResolution(m_Context, 640, 960);
+    dmGui::SetSceneResolution(m_Scene, 640, 960);
+
+    dmGui::HNode a = AddClipperBox("a");
+    dmGui::SetNodePosition(m_Scene, a, Point3(10, 20, 0));
+    dmGui::SetNodeProperty(m_Scene, a, dmGui::PROPERTY_SIZE, Vector4(40, 60, 0, 0));
+    dmGui::HNode b = AddClipperBox("b", a);
+    dmGui::SetNodeProperty(m_Scene, b, dmGui::PROPERTY_SIZE, Vector4(100, 10, 0, 0));
+    dmGui::HNode c = AddBox("c", b);
+    dmGui::HNode d = AddClipperBox("d", a);
+    dmGui::SetNodeProperty(m_Scene, d, dmGui::PROPERTY_SIZE, Vector4(10, 10, 0, 0));
+    dmGui::SetNodeProperty(m_Scene, d, dmGui::PROPERTY_EULER, Vector4(0, 0, 45, 0));
+    dmGui::HNode e = AddBox("e", d);
+
+    Render();
+
+    // The scissor clippers aren't drawn into the stencil buffer
+    ASSERT_TRUE(m_NodeToClippingOrder.find(a) == m_NodeToClippingOrder.end());
+    ASSERT_TRUE(m_NodeToClippingOrder.find(b) == m_NodeToClippingOrder.end());
+
+    dmGui::StencilScope scope;
+    GetStencilScope(c, scope);
+    ASSERT_FALSE(scope.m_UseStencil);
+    ASSERT_TRUE(scope.m_UseScissor);
+    // The rect of b, intersected with the rect of a
+    ASSERT_NEAR(-10.0f, scope.m_ScissorRect[0], 0.001f);
+    ASSERT_NEAR(15.0f, scope.m_ScissorRect[1], 0.001f);
+    ASSERT_NEAR(30.0f, scope.m_ScissorRect[2], 0.001f);
+    ASSERT_NEAR(25.0f, scope.m_ScissorRect[3], 0.001f);
+
+    // The rotated clipper uses the stencil buffer, within the rect of a
+    GetStencilScope(d, scope);
+    ASSERT_TRUE(scope.m_UseStencil);
+    ASSERT_TRUE(scope.m_UseScissor);
+    ASSERT_EQ(BITS(00000001), GetRefVal(scope));
+    GetStencilScope(e, scope);
+    ASSERT_TRUE(scope.m_UseStencil);
+    ASSERT_TRUE(scope.m_UseScissor);
+    ASSERT_NEAR(-10.0f, scope.m_ScissorRect[0], 0.001f);
+    ASSERT_NEAR(50.0f, scope.m_ScissorRect[3], 0.001f);
+
+    // Rotating a clipper switches it to the stencil buffer
+    dmGui::SetNodeProperty(m_Scene, a, dmGui::PROPERTY_EULER, Vector4(0, 0, 10, 0));
+    Render();
+    ASSERT_TRUE(m_NodeToClippingOrder.find(a) != m_NodeToClippingOrder.end());
+    GetStencilScope(c, scope);
+    ASSERT_TRUE(scope.m_UseStencil);
+}
+
 #undef BITS
 
 int main(int argc, char **argv)
@@ -278,6 +278,56 @@ namespace dmHID
         }
     }
 
+    void GetInputState(HContext context, InputState* state)
+    {
+        memset(state, 0, sizeof(InputState));
+        state->m_Keyboard               = context->m_Keyboards[0].m_Packet;
+        state->m_KeyboardConnected      = context->m_Keyboards[0].m_Connected;
+        state->m_Mouse                  = context->m_Mice[0].m_Packet;
+        state->m_MouseConnected         = context->m_Mice[0].m_Connected;
+        state->m_TouchDevice            = context->m_TouchDevices[0].m_Packet;
+        state->m_TouchDeviceConnected   = context->m_TouchDevices[0].m_Connected;
+        state->m_Acceleration           = context->m_AccelerationPacket;
+        state->m_AccelerometerConnected = context->m_AccelerometerConnected;
+        state->m_Text                   = context->m_TextPacket;
+        state->m_MarkedText             = context->m_MarkedTextPacket;
+
+        for (uint32_t i = 0; i < MAX_GAMEPAD_COUNT; ++i)
+        {
+            Gamepad* gamepad = &context->m_Gamepads[i];
+            state->m_Gamepads[i]           = gamepad->m_Packet;
+            state->m_GamepadAxisCount[i]   = gamepad->m_AxisCount;
+            state->m_GamepadButtonCount[i] = gamepad->m_ButtonCount;
+            state->m_GamepadHatCount[i]    = gamepad->m_HatCount;
+            if (gamepad->m_Connected)
+                state->m_GamepadsConnected |= 1 << i;
+        }
+    }
+
+    void SetInputState(HContext context, const InputState* state)
+    {
+        context->m_Keyboards[0].m_Packet        = state->m_Keyboard;
+        context->m_Keyboards[0].m_Connected     = state->m_KeyboardConnected;
+        context->m_Mice[0].m_Packet             = state->m_Mouse;
+        context->m_Mice[0].m_Connected          = state->m_MouseConnected;
+        context->m_TouchDevices[0].m_Packet     = state->m_TouchDevice;
+        context->m_TouchDevices[0].m_Connected  = state->m_TouchDeviceConnected;
+        context->m_AccelerationPacket           = state->m_Acceleration;
+        context->m_AccelerometerConnected       = state->m_AccelerometerConnected;
+        context->m_TextPacket                   = state->m_Text;
+        context->m_MarkedTextPacket             = state->m_MarkedText;
+
+        for (uint32_t i = 0; i < MAX_GAMEPAD_COUNT; ++i)
+        {
+            Gamepad* gamepad = &context->m_Gamepads[i];
+            gamepad->m_Packet      = state->m_Gamepads[i];
+            gamepad->m_AxisCount   = state->m_GamepadAxisCount[i];
+            gamepad->m_ButtonCount = state->m_GamepadButtonCount[i];
+            gamepad->m_HatCount    = state->m_GamepadHatCount[i];
+            gamepad->m_Connected   = (state->m_GamepadsConnected >> i) & 1;
+        }
+    }
+
     bool GetKey(KeyboardPacket* packet, Key key)
     {
        int key_index = (int) key - dmPlatform::PLATFORM_KEY_START;
@@ -376,6 +426,34 @@ namespace dmHID
         }
     }
 
+    bool PushButtonEvent(ButtonEventQueue* queue, const ButtonEvent& event)
+    {
+        // Only the producer writes m_Write
+        uint32_t write = (uint32_t) queue->m_Write;
+        uint32_t read  = (uint32_t) dmAtomicGet32(&queue->m_Read);
+        if (write - read >= BUTTON_EVENT_QUEUE_SIZE)
+        {
+            return false;
+        }
+        queue->m_Events[write & (BUTTON_EVENT_QUEUE_SIZE - 1)] = event;
+        dmAtomicStore32(&queue->m_Write, (int32_t) (write + 1));
+        return true;
+    }
+
+    bool PopButtonEvent(ButtonEventQueue* queue, ButtonEvent* event)
+    {
+        // Only the consumer writes m_Read
+        uint32_t read  = (uint32_t) queue->m_Read;
+        uint32_t write = (uint32_t) dmAtomicGet32(&queue->m_Write);
+        if (read == write)
+        {
+            return false;
+        }
+        *event = queue->m_Events[read & (BUTTON_EVENT_QUEUE_SIZE - 1)];
+        dmAtomicStore32(&queue->m_Read, (int32_t) (read + 1));
+        return true;
+    }
+
     // NOTE: A bit contrived function only used for unit-tests. See AddTouchPosition
     bool GetTouch(TouchDevicePacket* packet, uint32_t touch_index, int32_t* x, int32_t* y, uint32_t* id, bool* pressed, bool* released)
     {
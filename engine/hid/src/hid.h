@@ -354,6 +354,46 @@ namespace dmHID
      * Enables the accelerometer (if available)
      */
     void EnableAccelerometer(HContext context);
+
+    /**
+     * The state of the first keyboard, mouse and touch device, and of all gamepads.
+     * Used to record and replay the input of a session.
+     */
+    struct InputState
+    {
+        KeyboardPacket     m_Keyboard;
+        MousePacket        m_Mouse;
+        TouchDevicePacket  m_TouchDevice;
+        GamepadPacket      m_Gamepads[MAX_GAMEPAD_COUNT];
+        uint8_t            m_GamepadAxisCount[MAX_GAMEPAD_COUNT];
+        uint8_t            m_GamepadButtonCount[MAX_GAMEPAD_COUNT];
+        uint8_t            m_GamepadHatCount[MAX_GAMEPAD_COUNT];
+        AccelerationPacket m_Acceleration;
+        TextPacket         m_Text;
+        MarkedTextPacket   m_MarkedText;
+        uint32_t           m_GamepadsConnected;         // One bit per gamepad
+        uint32_t           m_KeyboardConnected : 1;
+        uint32_t           m_MouseConnected : 1;
+        uint32_t           m_TouchDeviceConnected : 1;
+        uint32_t           m_AccelerometerConnected : 1;
+        uint32_t           : 28;
+    };
+
+    /**
+     * Gets the current input state. The state is zero initialized, so it can be compared with memcmp.
+     * Should be called after Update, and before the packets are read.
+     * @param context context handle
+     * @param state the state is written here
+     */
+    void GetInputState(HContext context, InputState* state);
+
+    /**
+     * Replaces the current input state, e.g. with a state recorded by GetInputState.
+     * Should be called after Update, and before the packets are read.
+     * @param context context handle
+     * @param state the new state
+     */
+    void SetInputState(HContext context, const InputState* state);
 }
 
 #endif // DM_HID_H
@@ -18,6 +18,7 @@
 #include "hid.h"
 
 #include <dlib/array.h>
+#include <dlib/atomic.h>
 
 namespace dmHID
 {
@@ -54,6 +55,30 @@ namespace dmHID
         uint32_t            m_Connected : 1;
     };
 
+    enum ButtonEventType
+    {
+        BUTTON_EVENT_KEY   = 0,
+        BUTTON_EVENT_MOUSE = 1,
+    };
+
+    struct ButtonEvent
+    {
+        uint16_t m_Button;  // The platform key/button value
+        uint8_t  m_Type;    // ButtonEventType
+        uint8_t  m_Pressed;
+    };
+
+    // Must be a power of two
+    const static uint32_t BUTTON_EVENT_QUEUE_SIZE = 256;
+
+    // Lock free queue, with the platform callbacks as the single producer, and Update() as the single consumer
+    struct ButtonEventQueue
+    {
+        ButtonEvent    m_Events[BUTTON_EVENT_QUEUE_SIZE];
+        int32_atomic_t m_Write;
+        int32_atomic_t m_Read;
+    };
+
     struct Context
     {
         Context();
@@ -66,6 +91,7 @@ namespace dmHID
         TextPacket         m_TextPacket;
         MarkedTextPacket   m_MarkedTextPacket;
         AccelerationPacket m_AccelerationPacket;
+        ButtonEventQueue   m_ButtonEvents;
         FHIDGamepadFunc    m_GamepadConnectivityCallback;
         void*              m_GamepadConnectivityUserdata;
         void*              m_NativeContext;
@@ -87,6 +113,10 @@ namespace dmHID
     bool GetPlatformGamepadUserId(HContext context, HGamepad gamepad, uint32_t* user_id);
     int  GetKeyValue(Key key);
     int  GetMouseButtonValue(MouseButton button);
+
+    // Returns false if the queue is full (the event is dropped) or empty
+    bool PushButtonEvent(ButtonEventQueue* queue, const ButtonEvent& event);
+    bool PopButtonEvent(ButtonEventQueue* queue, ButtonEvent* event);
 }
 
 #endif
@@ -44,6 +44,38 @@ namespace dmHID
         SetMarkedText((HContext) ctx, text);
     }
 
+    static void QueueButtonEvent(HContext context, ButtonEventType type, int button, int pressed)
+    {
+        ButtonEvent event;
+        event.m_Button  = (uint16_t) button;
+        event.m_Type    = (uint8_t) type;
+        event.m_Pressed = (uint8_t) pressed;
+        if (!PushButtonEvent(&context->m_ButtonEvents, event))
+        {
+            dmLogOnceWarning("The input event queue is full, events are dropped");
+        }
+    }
+
+    static void GLFWKeyCallback(void* ctx, int key, int pressed)
+    {
+        QueueButtonEvent((HContext) ctx, BUTTON_EVENT_KEY, key, pressed);
+    }
+
+    static void GLFWMouseButtonCallback(void* ctx, int button, int pressed)
+    {
+        QueueButtonEvent((HContext) ctx, BUTTON_EVENT_MOUSE, button, pressed);
+    }
+
+    static bool WasPressed(const uint16_t* buttons, uint32_t count, int button)
+    {
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            if (buttons[i] == button)
+                return true;
+        }
+        return false;
+    }
+
     static void GLFWDeviceChangedCallback(void* ctx, int status)
     {
         HContext context = (HContext) ctx;
@@ -181,6 +213,8 @@ namespace dmHID
             dmPlatform::SetKeyboardCharCallback(context->m_Window, GLFWAddKeyboardChar, (void*) context);
             dmPlatform::SetKeyboardMarkedTextCallback(context->m_Window, GLFWSetMarkedText, (void*) context);
             dmPlatform::SetKeyboardDeviceChangedCallback(context->m_Window, GLFWDeviceChangedCallback, (void*) context);
+            dmPlatform::SetKeyCallback(context->m_Window, GLFWKeyCallback, (void*) context);
+            dmPlatform::SetMouseButtonCallback(context->m_Window, GLFWMouseButtonCallback, (void*) context);
 
             assert(context->m_NativeContextUserData == 0);
             context->m_NativeContextUserData = new NativeContextUserData();
@@ -212,6 +246,25 @@ namespace dmHID
     {
         dmPlatform::PollEvents(context->m_Window);
 
+        // The key and mouse button states are polled once per update, so a button that was both pressed
+        // and released since the last update would never be seen. Such presses are reported as held
+        // for this update (and released in the next). Mouse movement is still sampled once per update.
+        uint16_t pressed_keys[BUTTON_EVENT_QUEUE_SIZE];
+        uint16_t pressed_mouse_buttons[BUTTON_EVENT_QUEUE_SIZE];
+        uint32_t pressed_key_count = 0;
+        uint32_t pressed_mouse_button_count = 0;
+
+        ButtonEvent event;
+        while (PopButtonEvent(&context->m_ButtonEvents, &event))
+        {
+            if (!event.m_Pressed)
+                continue;
+            if (event.m_Type == BUTTON_EVENT_KEY)
+                pressed_keys[pressed_key_count++] = event.m_Button;
+            else
+                pressed_mouse_buttons[pressed_mouse_button_count++] = event.m_Button;
+        }
+
         // Update keyboard
         if (!context->m_IgnoreKeyboard)
         {
@@ -224,7 +277,7 @@ namespace dmHID
                 {
                     Key key        = (Key) i;
                     int key_value  = GetKeyValue(key);
-                    int state      = dmPlatform::GetKey(context->m_Window, key_value);
+                    int state      = dmPlatform::GetKey(context->m_Window, key_value) || WasPressed(pressed_keys, pressed_key_count, key_value);
                     uint32_t mask  = 1 << (i % 32);
 
                     if (state)
@@ -252,7 +305,7 @@ namespace dmHID
                     mask <<= i % 32;
 
                     int button_value = GetMouseButtonValue((MouseButton) i);
-                    int state        = dmPlatform::GetMouseButton(context->m_Window, button_value);
+                    int state        = dmPlatform::GetMouseButton(context->m_Window, button_value) || WasPressed(pressed_mouse_buttons, pressed_mouse_button_count, button_value);
 
                     if (state)
                         packet.m_Buttons[i / 32] |= mask;
@@ -13,9 +13,11 @@
 // specific language governing permissions and limitations under the License.
 
 #define JC_TEST_IMPLEMENTATION
+#include <string.h>
 #include <jc_test/jc_test.h>
 
 #include "../hid.h"
+#include "../hid_private.h"
 
 class HIDTest : public jc_test_base_class
 {
@@ -262,6 +264,83 @@ TEST_F(HIDTest, IgnoredDevices)
     dmHID::DeleteContext(context);
 }
 
+TEST_F(HIDTest, InputState)
+{
+    dmHID::Update(m_Context);
+
+    dmHID::SetKey(m_Keyboard, dmHID::KEY_SPACE, true);
+    dmHID::SetMouseButton(m_Mouse, dmHID::MOUSE_BUTTON_LEFT, true);
+    dmHID::SetMousePosition(m_Mouse, 10, 20);
+    dmHID::AddTouch(m_TouchDevice, 30, 40, 0, dmHID::PHASE_BEGAN);
+
+    dmHID::InputState state;
+    dmHID::GetInputState(m_Context, &state);
+
+    dmHID::InputState state2;
+    dmHID::GetInputState(m_Context, &state2);
+    ASSERT_EQ(0, memcmp(&state, &state2, sizeof(state)));
+
+    // Clear the input, and restore it from the state
+    dmHID::SetKey(m_Keyboard, dmHID::KEY_SPACE, false);
+    dmHID::SetMouseButton(m_Mouse, dmHID::MOUSE_BUTTON_LEFT, false);
+    dmHID::SetMousePosition(m_Mouse, 0, 0);
+    dmHID::ClearTouches(m_TouchDevice);
+
+    dmHID::SetInputState(m_Context, &state);
+
+    dmHID::KeyboardPacket keyboard_packet;
+    ASSERT_TRUE(dmHID::GetKeyboardPacket(m_Keyboard, &keyboard_packet));
+    ASSERT_TRUE(dmHID::GetKey(&keyboard_packet, dmHID::KEY_SPACE));
+
+    dmHID::MousePacket mouse_packet;
+    ASSERT_TRUE(dmHID::GetMousePacket(m_Mouse, &mouse_packet));
+    ASSERT_TRUE(dmHID::GetMouseButton(&mouse_packet, dmHID::MOUSE_BUTTON_LEFT));
+    ASSERT_EQ(10, mouse_packet.m_PositionX);
+    ASSERT_EQ(20, mouse_packet.m_PositionY);
+
+    dmHID::TouchDevicePacket touch_packet;
+    ASSERT_TRUE(dmHID::GetTouchDevicePacket(m_TouchDevice, &touch_packet));
+    ASSERT_EQ(1u, touch_packet.m_TouchCount);
+    int32_t x, y;
+    uint32_t id;
+    ASSERT_TRUE(dmHID::GetTouch(&touch_packet, 0, &x, &y, &id));
+    ASSERT_EQ(30, x);
+    ASSERT_EQ(40, y);
+}
+
+TEST(HIDButtonEventQueue, PushPop)
+{
+    dmHID::ButtonEventQueue* queue = new dmHID::ButtonEventQueue;
+    memset(queue, 0, sizeof(*queue));
+
+    dmHID::ButtonEvent event;
+    ASSERT_FALSE(dmHID::PopButtonEvent(queue, &event));
+
+    // Wrap around the ring a few times
+    for (uint32_t round = 0; round < 3; ++round)
+    {
+        for (uint32_t i = 0; i < dmHID::BUTTON_EVENT_QUEUE_SIZE; ++i)
+        {
+            event.m_Button = (uint16_t) i;
+            event.m_Type = dmHID::BUTTON_EVENT_KEY;
+            event.m_Pressed = i & 1;
+            ASSERT_TRUE(dmHID::PushButtonEvent(queue, event));
+        }
+        // Full
+        ASSERT_FALSE(dmHID::PushButtonEvent(queue, event));
+
+        for (uint32_t i = 0; i < dmHID::BUTTON_EVENT_QUEUE_SIZE; ++i)
+        {
+            ASSERT_TRUE(dmHID::PopButtonEvent(queue, &event));
+            ASSERT_EQ(i, event.m_Button);
+            ASSERT_EQ(i & 1, event.m_Pressed);
+        }
+        ASSERT_FALSE(dmHID::PopButtonEvent(queue, &event));
+    }
+
+    delete queue;
+}
+
 int main(int argc, char **argv)
 {
     jc_test_init(&argc, argv);
@@ -14,6 +14,7 @@
 
 #include "liveupdate.h"
 #include "liveupdate_private.h"
+#include "liveupdate_patch.h"
 #include "liveupdate_verify.h"
 #include "script_liveupdate.h"
 
@@ -449,7 +450,7 @@ namespace dmLiveUpdate
     };
 
     // Called on the worker thread
-    static int StoreResourceProcess(LiveUpdateCtx* jobctx, ResourceInfo* job)
+    static bool EnsureLiveupdateArchive(LiveUpdateCtx* jobctx, const char* expected_digest)
     {
         if (jobctx->m_LiveupdateArchiveManifest == 0 || jobctx->m_LiveupdateArchive == 0)
         {
@@ -461,10 +462,18 @@ namespace dmLiveUpdate
 
             if (jobctx->m_LiveupdateArchiveManifest == 0 || jobctx->m_LiveupdateArchive == 0)
             {
-                dmLogError("Still no liveupdate mount found. Skipping storing of resource: %s", job->m_ExpectedResourceDigest);
-                return 0;
+                dmLogError("Still no liveupdate mount found. Skipping storing of resource: %s", expected_digest);
+                return false;
             }
         }
+        return true;
+    }
+
+    // Called on the worker thread
+    static int StoreResourceProcess(LiveUpdateCtx* jobctx, ResourceInfo* job)
+    {
+        if (!EnsureLiveupdateArchive(jobctx, job->m_ExpectedResourceDigest))
+            return 0;
 
         dmhash_t digest_hash = dmHashBuffer64(job->m_ExpectedResourceDigest, job->m_ExpectedResourceDigestLength);
         dmhash_t url_hash = dmResource::GetUrlHashFromHexDigest(jobctx->m_LiveupdateArchiveManifest, digest_hash);
@@ -524,6 +533,125 @@ namespace dmLiveUpdate
 
     // ******************************************************************************************************************************************
 
+    struct PatchInfo
+    {
+        PatchInfo() {
+            memset(this, 0, sizeof(*this));
+        }
+        const uint8_t*                          m_Patch; // points to external, ref-counted data from the Lua call. Released after the callback
+        uint32_t                                m_PatchLength;
+        const char*                             m_ExpectedResourceDigest;
+        uint32_t                                m_ExpectedResourceDigestLength;
+
+        void                                    (*m_Callback)(bool, void*);
+        void*                                   m_CallbackData;
+    };
+
+    // Called on the worker thread
+    static int StoreResourcePatchProcess(LiveUpdateCtx* jobctx, PatchInfo* job)
+    {
+        DM_PROFILE("StoreResourcePatch");
+
+        if (!EnsureLiveupdateArchive(jobctx, job->m_ExpectedResourceDigest))
+            return 0;
+
+        PatchHeader header;
+        Result result = GetPatchHeader(job->m_Patch, job->m_PatchLength, &header);
+        if (RESULT_OK != result)
+        {
+            dmLogError("Invalid patch for resource %s: %s", job->m_ExpectedResourceDigest, ResultToString(result));
+            return 0;
+        }
+
+        dmhash_t digest_hash = dmHashBuffer64(job->m_ExpectedResourceDigest, job->m_ExpectedResourceDigestLength);
+        dmhash_t url_hash = dmResource::GetUrlHashFromHexDigest(jobctx->m_LiveupdateArchiveManifest, digest_hash);
+        dmLiveUpdateDDF::ResourceEntry* entry = url_hash ? dmResource::FindEntry(jobctx->m_LiveupdateArchiveManifest, url_hash) : 0;
+        if (!entry)
+        {
+            dmLogError("Resource %s isn't in the manifest", job->m_ExpectedResourceDigest);
+            return 0;
+        }
+
+        // The base is the version of the resource that is currently mounted
+        uint32_t base_size = 0;
+        dmResource::Result r = dmResourceMounts::GetResourceSize(jobctx->m_ResourceMounts, url_hash, entry->m_Url, &base_size);
+        if (dmResource::RESULT_OK != r || base_size != header.m_BaseSize)
+        {
+            dmLogError("No matching base resource '%s' for the patch of resource %s", entry->m_Url, job->m_ExpectedResourceDigest);
+            return 0;
+        }
+
+        uint8_t* base = (uint8_t*)malloc(base_size);
+        uint8_t* target = (uint8_t*)malloc(header.m_TargetSize);
+        int stored = 0;
+        if (base && target)
+        {
+            r = dmResourceMounts::ReadResource(jobctx->m_ResourceMounts, url_hash, entry->m_Url, base, base_size);
+            if (dmResource::RESULT_OK == r)
+                result = ApplyPatch(base, base_size, job->m_Patch, job->m_PatchLength, target, header.m_TargetSize);
+            else
+                result = ResourceResultToLiveupdateResult(r);
+
+            if (RESULT_OK == result)
+            {
+                // Verified against the hash in the manifest when written
+                dmResourceProvider::Result pr = dmResourceProvider::WriteFile(jobctx->m_LiveupdateArchive, url_hash, job->m_ExpectedResourceDigest,
+                                                                                target, header.m_TargetSize);
+                stored = dmResourceProvider::RESULT_OK == pr;
+            }
+            else
+            {
+                dmLogError("Failed to patch resource '%s' (%s): %s", entry->m_Url, job->m_ExpectedResourceDigest, ResultToString(result));
+            }
+        }
+        free(base);
+        free(target);
+        return stored;
+    }
+
+    // Called on the main thread (see dmJobThread::Update below)
+    static void StoreResourcePatchFinished(LiveUpdateCtx* jobctx, PatchInfo* job, int result)
+    {
+        if (job->m_Callback)
+            job->m_Callback(result == 1, job->m_CallbackData);
+        delete job;
+    }
+
+    Result StoreResourcePatchAsync(const char* expected_digest, uint32_t expected_digest_length, const uint8_t* patch, uint32_t patch_length, void (*callback)(bool, void*), void* callback_data)
+    {
+        if (!IsLiveupdateEnabled())
+            return RESULT_NOT_INITIALIZED;
+
+        if (patch == 0x0)
+        {
+            return RESULT_MEM_ERROR;
+        }
+
+        if (patch_length < PATCH_HEADER_SIZE)
+        {
+            dmLogError("Patch has invalid header: '%s'", expected_digest);
+            return RESULT_INVALID_HEADER;
+        }
+
+        if(IsLiveupdateThreadDisabled())
+        {
+            return RESULT_INVAL;
+        }
+
+        PatchInfo* info = new PatchInfo;
+        info->m_Patch = patch;
+        info->m_PatchLength = patch_length;
+        info->m_ExpectedResourceDigest = expected_digest;
+        info->m_ExpectedResourceDigestLength = expected_digest_length;
+        info->m_Callback = callback;
+        info->m_CallbackData = callback_data;
+
+        bool res = dmLiveUpdate::PushAsyncJob((dmJobThread::FProcess)StoreResourcePatchProcess, (dmJobThread::FCallback)StoreResourcePatchFinished, (void*)&g_LiveUpdate, info);
+        return res == true ? RESULT_OK : RESULT_INVALID_RESOURCE;
+    }
+
+    // ******************************************************************************************************************************************
+
     struct StoreManifestInfo
     {
         StoreManifestInfo() {
@@ -642,7 +770,7 @@ namespace dmLiveUpdate
         if (job->m_Verify)
         {
             const char* public_key_path = dmResource::GetPublicKeyPath(g_LiveUpdate.m_ResourceFactory);
-            dmResource::Result result = dmLiveUpdate::VerifyZipArchive(job->m_Path, public_key_path);
+            dmResource::Result result = dmLiveUpdate::VerifyZipArchive(job->m_Path, public_key_path, dmResource::GetJobThread(g_LiveUpdate.m_ResourceFactory));
             if (dmResource::RESULT_OK != result)
             {
                 dmLogError("Zip archive verification failed. Archive was not stored. %d %s", result, dmResource::ResultToString(result));
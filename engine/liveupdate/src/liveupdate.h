@@ -63,6 +63,10 @@ namespace dmLiveUpdate
     Result StoreResourceAsync(const char* expected_digest, uint32_t expected_digest_length,
                                     const dmResourceArchive::LiveUpdateResource* resource, void (*callback)(bool, void*), void* callback_data);
 
+    // Rebuilds the resource from the currently mounted version of it and a patch (see liveupdate_patch.h), and stores it like StoreResourceAsync
+    Result StoreResourcePatchAsync(const char* expected_digest, uint32_t expected_digest_length,
+                                    const uint8_t* patch, uint32_t patch_length, void (*callback)(bool, void*), void* callback_data);
+
     Result StoreManifestAsync(const uint8_t* manifest_data, uint32_t manifest_len, void (*callback)(int, void*), void* callback_data);
 
 
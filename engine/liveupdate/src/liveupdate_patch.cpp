@@ -0,0 +1,118 @@
+// Copyright 2020-2024 The Defold Foundation
+// Copyright 2014-2020 King
+// Copyright 2009-2014 Ragnar Svensson, Christian Murray
+// Licensed under the Defold License version 1.0 (the "License"); you may not use
+// this file except in compliance with the License.
+//
+// You may obtain a copy of the License, together with FAQs at
+// https://www.defold.com/license
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "liveupdate_patch.h"
+
+#include <string.h>
+#include <dlib/hash.h>
+#include <dlib/log.h>
+
+namespace dmLiveUpdate
+{
+    static inline uint32_t ReadU32(const uint8_t* p)
+    {
+        return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+    }
+
+    static inline uint64_t ReadU64(const uint8_t* p)
+    {
+        return (uint64_t)ReadU32(p) | ((uint64_t)ReadU32(p + 4) << 32);
+    }
+
+    Result GetPatchHeader(const uint8_t* patch, uint32_t patch_size, PatchHeader* out_header)
+    {
+        if (patch == 0 || patch_size < PATCH_HEADER_SIZE)
+            return RESULT_INVALID_HEADER;
+        if (ReadU32(patch) != PATCH_MAGIC)
+            return RESULT_INVALID_HEADER;
+        if (ReadU32(patch + 4) != PATCH_VERSION)
+            return RESULT_VERSION_MISMATCH;
+
+        out_header->m_BaseSize   = ReadU32(patch + 8);
+        out_header->m_TargetSize = ReadU32(patch + 12);
+        out_header->m_BaseHash   = ReadU64(patch + 16);
+        return RESULT_OK;
+    }
+
+    Result ApplyPatch(const uint8_t* base, uint32_t base_size, const uint8_t* patch, uint32_t patch_size, uint8_t* out, uint32_t out_size)
+    {
+        PatchHeader header;
+        Result result = GetPatchHeader(patch, patch_size, &header);
+        if (RESULT_OK != result)
+            return result;
+
+        if (header.m_TargetSize != out_size)
+            return RESULT_INVAL;
+
+        if (header.m_BaseSize != base_size || header.m_BaseHash != dmHashBuffer64(base, base_size))
+        {
+            dmLogError("The patch was made from a different version of the resource");
+            return RESULT_INVALID_RESOURCE;
+        }
+
+        const uint8_t* p   = patch + PATCH_HEADER_SIZE;
+        const uint8_t* end = patch + patch_size;
+        uint32_t written = 0;
+        while (p < end)
+        {
+            uint8_t op = *p++;
+            uint32_t offset = 0;
+            if (op == PATCH_OP_COPY || op == PATCH_OP_ADD)
+            {
+                if (end - p < 4)
+                    return RESULT_FORMAT_ERROR;
+                offset = ReadU32(p);
+                p += 4;
+            }
+            else if (op != PATCH_OP_INSERT)
+            {
+                return RESULT_FORMAT_ERROR;
+            }
+
+            if (end - p < 4)
+                return RESULT_FORMAT_ERROR;
+            uint32_t size = ReadU32(p);
+            p += 4;
+
+            if (size > out_size - written)
+                return RESULT_FORMAT_ERROR;
+            if (op != PATCH_OP_INSERT && (offset > base_size || size > base_size - offset))
+                return RESULT_FORMAT_ERROR;
+            if (op != PATCH_OP_COPY && (uint32_t)(end - p) < size)
+                return RESULT_FORMAT_ERROR;
+
+            uint8_t* dst = out + written;
+            switch (op)
+            {
+            case PATCH_OP_COPY:
+                memcpy(dst, base + offset, size);
+                break;
+            case PATCH_OP_ADD:
+                for (uint32_t i = 0; i < size; ++i)
+                {
+                    dst[i] = (uint8_t)(base[offset + i] + p[i]);
+                }
+                p += size;
+                break;
+            case PATCH_OP_INSERT:
+                memcpy(dst, p, size);
+                p += size;
+                break;
+            }
+            written += size;
+        }
+
+        return written == out_size ? RESULT_OK : RESULT_FORMAT_ERROR;
+    }
+}
@@ -0,0 +1,66 @@
+// Copyright 2020-2024 The Defold Foundation
+// Copyright 2014-2020 King
+// Copyright 2009-2014 Ragnar Svensson, Christian Murray
+// Licensed under the Defold License version 1.0 (the "License"); you may not use
+// this file except in compliance with the License.
+//
+// You may obtain a copy of the License, together with FAQs at
+// https://www.defold.com/license
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#ifndef DM_LIVEUPDATE_PATCH_H
+#define DM_LIVEUPDATE_PATCH_H
+
+#include "liveupdate.h"
+#include <stdint.h>
+
+namespace dmLiveUpdate
+{
+    // A patch rebuilds a liveupdate resource from the resource currently found in the mounts (the base),
+    // so that a changed resource doesn't have to be downloaded as a whole.
+    //
+    // All values are little endian.
+    //
+    // Header:
+    //   uint32_t magic ('D','L','P','T')
+    //   uint32_t version
+    //   uint32_t base size
+    //   uint32_t target size
+    //   uint64_t base hash (dmHashBuffer64)
+    //
+    // Followed by commands, until the end of the patch:
+    //   PATCH_OP_COPY:   uint8_t op, uint32_t base offset, uint32_t size            - copies bytes from the base
+    //   PATCH_OP_ADD:    uint8_t op, uint32_t base offset, uint32_t size, size bytes - adds the bytes to the base bytes (modulo 256)
+    //   PATCH_OP_INSERT: uint8_t op, uint32_t size, size bytes                       - new bytes
+    //
+    // The target is the data that would otherwise be given to StoreResourceAsync (i.e. including the liveupdate resource header)
+
+    const uint32_t PATCH_MAGIC       = 0x54504C44; // "DLPT"
+    const uint32_t PATCH_VERSION     = 1;
+    const uint32_t PATCH_HEADER_SIZE = 24;
+
+    enum PatchOp
+    {
+        PATCH_OP_COPY   = 0,
+        PATCH_OP_ADD    = 1,
+        PATCH_OP_INSERT = 2,
+    };
+
+    struct PatchHeader
+    {
+        uint32_t m_BaseSize;
+        uint32_t m_TargetSize;
+        uint64_t m_BaseHash;
+    };
+
+    Result GetPatchHeader(const uint8_t* patch, uint32_t patch_size, PatchHeader* out_header);
+
+    // Writes the target to out, which must be of the target size. Fails if the base isn't the one the patch was made from
+    Result ApplyPatch(const uint8_t* base, uint32_t base_size, const uint8_t* patch, uint32_t patch_size, uint8_t* out, uint32_t out_size);
+}
+
+#endif // DM_LIVEUPDATE_PATCH_H
@@ -17,6 +17,7 @@
 #include <resource/resource_manifest.h>
 #include <resource/resource_verify.h>
 
+#include <dlib/atomic.h>
 #include <dlib/log.h>
 #include <dlib/memory.h>
 #include <dlib/zip.h>
@@ -59,13 +60,60 @@ namespace dmLiveUpdate
         return data;
     }
 
-    static dmResource::Result VerifyZipEntries(dmResource::Manifest* manifest, dmZip::HZip zip)
+    // The zip handle can only read one entry at a time, so the entries are read on the calling thread,
+    // and hashed as group jobs. Once this much entry data is waiting to be hashed, we wait for the jobs to finish.
+    static const uint32_t VERIFY_MAX_PENDING_SIZE = 32 * 1024 * 1024;
+
+    struct VerifyZipEntriesContext
+    {
+        dmResource::Manifest*   m_Manifest;
+        int32_atomic_t          m_Failed;
+    };
+
+    // Allocated together with the entry name and data
+    struct VerifyEntryJob
     {
+        const char* m_Name;
+        uint8_t*    m_Data;
+        uint32_t    m_Size;
+    };
+
+    static int VerifyEntryJobFn(void* _context, void* _job)
+    {
+        VerifyZipEntriesContext* context = (VerifyZipEntriesContext*)_context;
+        VerifyEntryJob* job = (VerifyEntryJob*)_job;
+
+        if (!dmAtomicGet32(&context->m_Failed))
+        {
+            dmResourceArchive::LiveUpdateResource resource(job->m_Data, job->m_Size);
+
+            // NOTE: The entry "name" is the actual checksum of the contents of that file. It is not a url.
+            // NOTE: We probably need to handle custom files existing in the .zip file that _aren't_ part of the manifest
+            dmResource::Result result = dmResource::VerifyResource(context->m_Manifest, (const uint8_t*)job->m_Name, strlen(job->m_Name), resource.m_Data, resource.m_Count);
+            if (dmResource::RESULT_OK != result)
+            {
+                dmLogError("Failed to verify resource '%s' in archive", job->m_Name);
+                dmAtomicStore32(&context->m_Failed, 1);
+            }
+        }
+
+        free(job);
+        return 0;
+    }
+
+    static dmResource::Result VerifyZipEntries(dmResource::Manifest* manifest, dmZip::HZip zip, dmJobThread::HContext job_thread)
+    {
+        VerifyZipEntriesContext context;
+        context.m_Manifest = manifest;
+        context.m_Failed = 0;
+
+        dmJobThread::JobGroup group;
+        dmJobThread::InitGroup(&group, 0);
+
         dmResource::Result result = dmResource::RESULT_OK;
+        uint32_t pending_size = 0;
         uint32_t num_entries = dmZip::GetNumEntries(zip);
-        uint32_t entry_data_capacity = 0;
-        uint8_t* entry_data = 0;
-        for( uint32_t i = 0; i < num_entries && dmResource::RESULT_OK == result; ++i)
+        for( uint32_t i = 0; i < num_entries && !dmAtomicGet32(&context.m_Failed); ++i)
         {
             dmZip::Result zr = dmZip::OpenEntry(zip, i);
 
@@ -78,30 +126,38 @@ namespace dmLiveUpdate
                 if (dmZip::RESULT_OK != zr)
                 {
                     dmLogError("Could not get entry size '%s'", entry_name);
-                    dmZip::Close(zip);
-                    free((void*)entry_data);
-                    return dmResource::RESULT_INVALID_DATA;
+                    dmZip::CloseEntry(zip);
+                    result = dmResource::RESULT_INVALID_DATA;
+                    break;
                 }
 
-                if (entry_data_capacity < entry_size)
-                {
-                    entry_data = (uint8_t*)realloc(entry_data, entry_size);
-                    entry_data_capacity = entry_size;
-                }
-
-                zr = dmZip::GetEntryData(zip, entry_data, entry_size);
-
-                dmResourceArchive::LiveUpdateResource resource(entry_data, entry_size);
                 if (entry_size >= sizeof(dmResourceArchive::LiveUpdateResourceHeader))
                 {
-                    // NOTE: The entry "name" is the actual checksum of the contents of that file. It is not a url.
-                    // NOTE: We probably need to handle custom files existing in the .zip file that _aren't_ part of the manifest
-                    result = dmResource::VerifyResource(manifest, (const uint8_t*)entry_name, strlen(entry_name), resource.m_Data, resource.m_Count);
+                    if (pending_size > 0 && pending_size + entry_size > VERIFY_MAX_PENDING_SIZE)
+                    {
+                        dmJobThread::WaitGroup(job_thread, &group);
+                        pending_size = 0;
+                    }
+
+                    uint32_t name_size = strlen(entry_name) + 1;
+                    VerifyEntryJob* job = (VerifyEntryJob*)malloc(sizeof(VerifyEntryJob) + name_size + entry_size);
+                    job->m_Name = (const char*)(job + 1);
+                    job->m_Data = (uint8_t*)(job + 1) + name_size;
+                    job->m_Size = entry_size;
+                    memcpy((void*)job->m_Name, entry_name, name_size);
 
-                    if (dmResource::RESULT_OK != result)
+                    zr = dmZip::GetEntryData(zip, job->m_Data, entry_size);
+                    if (dmZip::RESULT_OK != zr)
                     {
-                        dmLogError("Failed to verify resource '%s' in archive", entry_name);
+                        dmLogError("Could not read entry '%s'", entry_name);
+                        dmZip::CloseEntry(zip);
+                        free(job);
+                        result = dmResource::RESULT_INVALID_DATA;
+                        break;
                     }
+
+                    pending_size += entry_size;
+                    dmJobThread::PushGroupJob(job_thread, &group, VerifyEntryJobFn, (void*)&context, (void*)job);
                 }
                 else {
                     dmLogError("Skipping resource %s from archive", entry_name);
@@ -110,11 +166,12 @@ namespace dmLiveUpdate
 
             dmZip::CloseEntry(zip);
         }
-        free((void*)entry_data);
-        return dmResource::RESULT_OK;
+
+        dmJobThread::WaitGroup(job_thread, &group);
+        return result;
     }
 
-    dmResource::Result VerifyZipArchive(const char* path, const char* public_key_path)
+    dmResource::Result VerifyZipArchive(const char* path, const char* public_key_path, dmJobThread::HContext job_thread)
     {
         dmLogInfo("Verifying archive '%s'", path);
 
@@ -161,7 +218,7 @@ namespace dmLiveUpdate
 
         // TODO: What to do here. It is now ok for a liveupdate manifest/archive to not contain all the resources
         //      * We can require the manifest to only contain entries for the files in the archive
-        result = VerifyZipEntries(manifest, zip);
+        result = VerifyZipEntries(manifest, zip, job_thread);
         if (dmResource::RESULT_OK != result)
         {
             dmLogError("Manifest references non existing resources");
@@ -17,10 +17,12 @@
 
 #include "liveupdate.h"
 #include <resource/resource.h>
+#include <dlib/job_thread.h>
 
 namespace dmLiveUpdate
 {
-    dmResource::Result VerifyZipArchive(const char* path, const char* public_key_path);
+    // The entries are hashed as group jobs on the job thread, if one is given
+    dmResource::Result VerifyZipArchive(const char* path, const char* public_key_path, dmJobThread::HContext job_thread);
 }
 
 #endif // DM_LIVEUPDATE_VERIFY_H
@@ -151,6 +151,38 @@ namespace dmLiveUpdate
         return 0;
     }
 
+    static int Resource_StoreResourcePatch(lua_State* L)
+    {
+        DM_LUA_STACK_CHECK(L, 0);
+
+        // The patch data (see liveupdate_patch.h)
+        size_t patch_len = 0;
+        const char* patch = luaL_checklstring(L, 1, &patch_len);
+        // The hash digest of the patched resource
+        size_t hex_digest_length = 0;
+        const char* hex_digest = luaL_checklstring(L, 2, &hex_digest_length);
+
+        lua_pushvalue(L, 1);
+        int patch_ref = dmScript::Ref(L, LUA_REGISTRYINDEX);
+        lua_pushvalue(L, 2);
+        int hex_digest_ref = dmScript::Ref(L, LUA_REGISTRYINDEX);
+
+        StoreResourceCallbackData* cb = new StoreResourceCallbackData;
+        cb->m_Callback = dmScript::CreateCallback(L, 3);
+        cb->m_HexDigest = hex_digest;
+        cb->m_HexDigestRef = hex_digest_ref;
+        cb->m_ResourceRef = patch_ref;
+
+        dmLiveUpdate::Result res = dmLiveUpdate::StoreResourcePatchAsync(hex_digest, hex_digest_length, (const uint8_t*)patch, patch_len, Callback_StoreResource, cb);
+        if (dmLiveUpdate::RESULT_OK != res)
+        {
+            dmLogError("Failed to store patch for resource %s: %s", hex_digest, dmLiveUpdate::ResultToString(res));
+            Callback_StoreResource(false, cb);
+        }
+
+        return 0;
+    }
+
     static void Callback_StoreManifest(int _result, void* _cbk)
     {
         dmLiveUpdate::Result result = (dmLiveUpdate::Result)_result;
@@ -386,6 +418,7 @@ namespace dmLiveUpdate
         {"get_current_manifest", dmLiveUpdate::Resource_GetCurrentManifest},        /// bogus data, and never used?
         {"is_using_liveupdate_data", dmLiveUpdate::Resource_IsUsingLiveUpdateData},
         {"store_resource", dmLiveUpdate::Resource_StoreResource}, // Stores a single resource
+        {"store_resource_patch", dmLiveUpdate::Resource_StoreResourcePatch}, // Stores a single resource, patched from the current version
         {"store_manifest", dmLiveUpdate::Resource_StoreManifest}, // Store a .dmanifest file
         {"store_archive", dmLiveUpdate::Resource_StoreArchive},   // Store a .zip archive
 
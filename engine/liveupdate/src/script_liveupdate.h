@@ -100,6 +100,58 @@ namespace dmLiveUpdate
  * ```
  */
 
+/*# patch, verify and store a resource
+ *
+ * Rebuilds a resource from the version of it that is currently mounted and a binary patch,
+ * and stores it like [ref:liveupdate.store_resource]. Only the patch needs to be downloaded
+ * when a new version of the game changes a few bytes of a large resource.
+ * The patching is done on a worker thread, and the patched resource is verified against
+ * the hash in the current manifest before it is stored.
+ *
+ * The patch fails if the mounted resource isn't the one the patch was made from,
+ * in which case the whole resource has to be stored instead.
+ *
+ * @name liveupdate.store_resource_patch
+ * @param patch [type:string] The patch data.
+ * @param hexdigest [type:string] The expected hash of the patched resource,
+ * retrieved through collectionproxy.missing_resources.
+ * @param callback [type:function(self, hexdigest, status)] The callback
+ * function that is executed once the engine has attempted to store
+ * the resource.
+ *
+ * `self`
+ * : [type:object] The current object.
+ *
+ * `hexdigest`
+ * : [type:string] The hexdigest of the resource.
+ *
+ * `status`
+ * : [type:boolean] Whether or not the resource was successfully patched and stored.
+ *
+ * @examples
+ *
+ * ```lua
+ * local function callback_store_resource(self, hexdigest, status)
+ *      if not status then
+ *           -- fall back to downloading the whole resource
+ *           http.request(self.baseurl .. hexdigest, "GET", function(self, id, response)
+ *                if response.status == 200 then
+ *                     liveupdate.store_resource(nil, response.response, hexdigest, function() end)
+ *                end
+ *           end)
+ *      end
+ * end
+ *
+ * local function patch_resource(self, hexdigest)
+ *      http.request(self.baseurl .. hexdigest .. ".patch", "GET", function(self, id, response)
+ *           if response.status == 200 then
+ *                liveupdate.store_resource_patch(response.response, hexdigest, callback_store_resource)
+ *           end
+ *      end)
+ * end
+ * ```
+ */
+
 /*# create, verify, and store a manifest to device
  *
  * Create a new manifest from a buffer. The created manifest is verified
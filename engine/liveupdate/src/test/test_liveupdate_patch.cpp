@@ -0,0 +1,159 @@
+// Copyright 2020-2024 The Defold Foundation
+// Copyright 2014-2020 King
+// Copyright 2009-2014 Ragnar Svensson, Christian Murray
+// Licensed under the Defold License version 1.0 (the "License"); you may not use
+// this file except in compliance with the License.
+//
+// You may obtain a copy of the License, together with FAQs at
+// https://www.defold.com/license
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#define JC_TEST_IMPLEMENTATION
+#include <jc_test/jc_test.h>
+
+#include <stdint.h>
+#include <string.h>
+#include <dlib/array.h>
+#include <dlib/hash.h>
+#include "../liveupdate_patch.h"
+
+static void PushU32(dmArray<uint8_t>& patch, uint32_t v)
+{
+    if (patch.Remaining() < 4)
+        patch.OffsetCapacity(256);
+    for (uint32_t i = 0; i < 4; ++i)
+        patch.Push((uint8_t)(v >> (i * 8)));
+}
+
+static void PushBytes(dmArray<uint8_t>& patch, const uint8_t* data, uint32_t size)
+{
+    if (patch.Remaining() < size)
+        patch.OffsetCapacity(size + 256);
+    for (uint32_t i = 0; i < size; ++i)
+        patch.Push(data[i]);
+}
+
+static void PushHeader(dmArray<uint8_t>& patch, const char* base, uint32_t target_size)
+{
+    uint32_t base_size = (uint32_t)strlen(base);
+    uint64_t base_hash = dmHashBuffer64(base, base_size);
+    PushU32(patch, dmLiveUpdate::PATCH_MAGIC);
+    PushU32(patch, dmLiveUpdate::PATCH_VERSION);
+    PushU32(patch, base_size);
+    PushU32(patch, target_size);
+    PushU32(patch, (uint32_t)base_hash);
+    PushU32(patch, (uint32_t)(base_hash >> 32));
+}
+
+static void PushOp(dmArray<uint8_t>& patch, dmLiveUpdate::PatchOp op)
+{
+    uint8_t o = (uint8_t)op;
+    PushBytes(patch, &o, 1);
+}
+
+TEST(LiveUpdatePatch, Apply)
+{
+    const char* base   = "Hello World, this is the base";
+    const char* target = "Hello World, that is the target!";
+    uint32_t target_size = (uint32_t)strlen(target);
+
+    dmArray<uint8_t> patch;
+    PushHeader(patch, base, target_size);
+
+    // "Hello World, th"
+    PushOp(patch, dmLiveUpdate::PATCH_OP_COPY);
+    PushU32(patch, 0);
+    PushU32(patch, 15);
+    // "is" -> "at"
+    const uint8_t diff[] = { (uint8_t)('a' - 'i'), (uint8_t)('t' - 's') };
+    PushOp(patch, dmLiveUpdate::PATCH_OP_ADD);
+    PushU32(patch, 15);
+    PushU32(patch, 2);
+    PushBytes(patch, diff, 2);
+    // " is the "
+    PushOp(patch, dmLiveUpdate::PATCH_OP_COPY);
+    PushU32(patch, 17);
+    PushU32(patch, 8);
+    // "target!"
+    PushOp(patch, dmLiveUpdate::PATCH_OP_INSERT);
+    PushU32(patch, 7);
+    PushBytes(patch, (const uint8_t*)"target!", 7);
+
+    dmLiveUpdate::PatchHeader header;
+    ASSERT_EQ(dmLiveUpdate::RESULT_OK, dmLiveUpdate::GetPatchHeader(patch.Begin(), patch.Size(), &header));
+    ASSERT_EQ((uint32_t)strlen(base), header.m_BaseSize);
+    ASSERT_EQ(target_size, header.m_TargetSize);
+
+    char out[64] = {0};
+    ASSERT_EQ(dmLiveUpdate::RESULT_OK, dmLiveUpdate::ApplyPatch((const uint8_t*)base, (uint32_t)strlen(base), patch.Begin(), patch.Size(), (uint8_t*)out, target_size));
+    ASSERT_STREQ(target, out);
+}
+
+TEST(LiveUpdatePatch, WrongBase)
+{
+    const char* base = "The base";
+    dmArray<uint8_t> patch;
+    PushHeader(patch, base, 4);
+    PushOp(patch, dmLiveUpdate::PATCH_OP_COPY);
+    PushU32(patch, 0);
+    PushU32(patch, 4);
+
+    const char* other = "The other base";
+    uint8_t out[4];
+    ASSERT_EQ(dmLiveUpdate::RESULT_INVALID_RESOURCE, dmLiveUpdate::ApplyPatch((const uint8_t*)other, (uint32_t)strlen(other), patch.Begin(), patch.Size(), out, sizeof(out)));
+
+    // Same size, different content
+    const char* same_size = "The bass";
+    ASSERT_EQ(dmLiveUpdate::RESULT_INVALID_RESOURCE, dmLiveUpdate::ApplyPatch((const uint8_t*)same_size, (uint32_t)strlen(same_size), patch.Begin(), patch.Size(), out, sizeof(out)));
+}
+
+TEST(LiveUpdatePatch, Malformed)
+{
+    const char* base = "The base";
+    uint32_t base_size = (uint32_t)strlen(base);
+    uint8_t out[8];
+
+    // Truncated header
+    dmArray<uint8_t> patch;
+    PushHeader(patch, base, 8);
+    ASSERT_EQ(dmLiveUpdate::RESULT_INVALID_HEADER, dmLiveUpdate::ApplyPatch((const uint8_t*)base, base_size, patch.Begin(), 8, out, sizeof(out)));
+
+    // Copy outside of the base
+    PushOp(patch, dmLiveUpdate::PATCH_OP_COPY);
+    PushU32(patch, 4);
+    PushU32(patch, 8);
+    ASSERT_EQ(dmLiveUpdate::RESULT_FORMAT_ERROR, dmLiveUpdate::ApplyPatch((const uint8_t*)base, base_size, patch.Begin(), patch.Size(), out, sizeof(out)));
+
+    // Insert with missing data
+    patch.SetSize(0);
+    PushHeader(patch, base, 8);
+    PushOp(patch, dmLiveUpdate::PATCH_OP_INSERT);
+    PushU32(patch, 8);
+    PushBytes(patch, (const uint8_t*)"1234", 4);
+    ASSERT_EQ(dmLiveUpdate::RESULT_FORMAT_ERROR, dmLiveUpdate::ApplyPatch((const uint8_t*)base, base_size, patch.Begin(), patch.Size(), out, sizeof(out)));
+
+    // Too little output
+    patch.SetSize(0);
+    PushHeader(patch, base, 8);
+    PushOp(patch, dmLiveUpdate::PATCH_OP_COPY);
+    PushU32(patch, 0);
+    PushU32(patch, 4);
+    ASSERT_EQ(dmLiveUpdate::RESULT_FORMAT_ERROR, dmLiveUpdate::ApplyPatch((const uint8_t*)base, base_size, patch.Begin(), patch.Size(), out, sizeof(out)));
+
+    // Unknown op
+    patch.SetSize(0);
+    PushHeader(patch, base, 8);
+    PushOp(patch, (dmLiveUpdate::PatchOp)7);
+    ASSERT_EQ(dmLiveUpdate::RESULT_FORMAT_ERROR, dmLiveUpdate::ApplyPatch((const uint8_t*)base, base_size, patch.Begin(), patch.Size(), out, sizeof(out)));
+}
+
+int main(int argc, char **argv)
+{
+    jc_test_init(&argc, argv);
+    int ret = jc_test_run_all();
+    return ret;
+}
@@ -15,7 +15,10 @@
 
 #include "modelimporter.h"
 #include <dmsdk/dlib/log.h>
+#include <dmsdk/dlib/math.h>
 #include <dmsdk/dlib/dstrings.h>
+#include <dmsdk/dlib/vmath.h>
+#include <math.h>
 #include <stdio.h>
 #include <stdlib.h> // getenv
 #include <string.h>
@@ -114,6 +117,300 @@ static void DestroyAnimation(Animation* animation)
     animation->m_NodeAnimations.SetCapacity(0);
 }
 
+// Is the key recreated (within the tolerance) when interpolating between key a and b?
+static bool IsInterpolated(const KeyFrame& a, const KeyFrame& b, const KeyFrame& key, uint32_t num_components, bool rotation, float tolerance)
+{
+    float duration = b.m_Time - a.m_Time;
+    if (duration <= 0.0f)
+        return false;
+    float t = (key.m_Time - a.m_Time) / duration;
+
+    float value[4];
+    if (rotation)
+    {
+        dmVMath::Quat q = dmVMath::Slerp(t, dmVMath::Quat(a.m_Value[0], a.m_Value[1], a.m_Value[2], a.m_Value[3]),
+                                            dmVMath::Quat(b.m_Value[0], b.m_Value[1], b.m_Value[2], b.m_Value[3]));
+        value[0] = q.getX();
+        value[1] = q.getY();
+        value[2] = q.getZ();
+        value[3] = q.getW();
+    }
+    else
+    {
+        for (uint32_t i = 0; i < num_components; ++i)
+            value[i] = a.m_Value[i] + (b.m_Value[i] - a.m_Value[i]) * t;
+    }
+
+    for (uint32_t i = 0; i < num_components; ++i)
+    {
+        if (fabsf(value[i] - key.m_Value[i]) > tolerance)
+            return false;
+    }
+    return true;
+}
+
+uint32_t ReduceKeyFrames(KeyFrame* key_frames, uint32_t key_count, uint32_t num_components, bool rotation, float tolerance)
+{
+    if (key_count <= 2)
+        return key_count;
+
+    // The keys are compacted in place. A key is only written over once the last kept key (the anchor) has moved past it
+    uint32_t out = 1;
+    uint32_t anchor = 0;
+    for (uint32_t i = 1; i < key_count - 1; ++i)
+    {
+        // Key i can be removed if all the keys since the anchor are recreated by interpolating from the anchor to the next key
+        bool removable = true;
+        for (uint32_t j = anchor + 1; j <= i && removable; ++j)
+        {
+            removable = IsInterpolated(key_frames[anchor], key_frames[i + 1], key_frames[j], num_components, rotation, tolerance);
+        }
+
+        if (!removable)
+        {
+            key_frames[out++] = key_frames[i];
+            anchor = i;
+        }
+    }
+    key_frames[out++] = key_frames[key_count - 1];
+    return out;
+}
+
+// Vertex cache optimization, see Tom Forsyth's "Linear-Speed Vertex Cache Optimisation"
+static const uint32_t VERTEX_CACHE_SIZE = 32;
+
+static float GetVertexScore(int32_t cache_position, uint32_t live_triangles)
+{
+    if (live_triangles == 0)
+        return -1.0f; // No triangles left to emit
+
+    float score = 0.0f;
+    if (cache_position >= 0)
+    {
+        if (cache_position < 3)
+            score = 0.75f; // The vertices of the last triangle
+        else
+            score = powf(1.0f - (cache_position - 3) / (float)(VERTEX_CACHE_SIZE - 3), 1.5f);
+    }
+    // Prioritize the vertices with few triangles left, to avoid leaving lone triangles behind
+    return score + 2.0f * powf((float)live_triangles, -0.5f);
+}
+
+template<typename T>
+static void InitArray(dmArray<T>& array, uint32_t size, T value)
+{
+    array.SetCapacity(size);
+    array.SetSize(size);
+    for (uint32_t i = 0; i < size; ++i)
+        array[i] = value;
+}
+
+void OptimizeVertexCache(uint32_t* indices, uint32_t index_count, uint32_t vertex_count)
+{
+    uint32_t triangle_count = index_count / 3;
+    if (triangle_count < 2)
+        return;
+
+    // The triangles using each vertex. The live ones are stored first: adjacency[offsets[v] .. offsets[v] + live[v]]
+    dmArray<uint32_t> live;
+    dmArray<uint32_t> offsets;
+    dmArray<uint32_t> adjacency;
+    InitArray(live, vertex_count, 0u);
+    InitArray(offsets, vertex_count, 0u);
+    InitArray(adjacency, triangle_count * 3, 0u);
+
+    for (uint32_t i = 0; i < triangle_count * 3; ++i)
+        live[indices[i]]++;
+
+    uint32_t offset = 0;
+    for (uint32_t v = 0; v < vertex_count; ++v)
+    {
+        offsets[v] = offset;
+        offset += live[v];
+        live[v] = 0;
+    }
+
+    for (uint32_t i = 0; i < triangle_count * 3; ++i)
+    {
+        uint32_t v = indices[i];
+        adjacency[offsets[v] + live[v]++] = i / 3;
+    }
+
+    dmArray<int32_t> cache_positions;
+    dmArray<float> vertex_scores;
+    InitArray(cache_positions, vertex_count, -1);
+    InitArray(vertex_scores, vertex_count, 0.0f);
+    for (uint32_t v = 0; v < vertex_count; ++v)
+        vertex_scores[v] = GetVertexScore(-1, live[v]);
+
+    dmArray<float> triangle_scores;
+    dmArray<uint8_t> emitted;
+    InitArray(triangle_scores, triangle_count, 0.0f);
+    InitArray(emitted, triangle_count, (uint8_t)0);
+
+    uint32_t best_triangle = 0;
+    for (uint32_t t = 0; t < triangle_count; ++t)
+    {
+        const uint32_t* tri = &indices[t * 3];
+        triangle_scores[t] = vertex_scores[tri[0]] + vertex_scores[tri[1]] + vertex_scores[tri[2]];
+        if (triangle_scores[t] > triangle_scores[best_triangle])
+            best_triangle = t;
+    }
+
+    dmArray<uint32_t> out;
+    InitArray(out, triangle_count * 3, 0u);
+
+    uint32_t cache[VERTEX_CACHE_SIZE + 3];
+    uint32_t cache_count = 0;
+    uint32_t cursor = 0; // Where to look for a new triangle, when the cache has none left
+
+    for (uint32_t n = 0; n < triangle_count; ++n)
+    {
+        if (best_triangle == INVALID_INDEX)
+        {
+            while (emitted[cursor])
+                ++cursor;
+            best_triangle = cursor;
+        }
+
+        uint32_t* tri = &indices[best_triangle * 3];
+        memcpy(&out[n * 3], tri, sizeof(uint32_t) * 3);
+        emitted[best_triangle] = 1;
+
+        // Remove the triangle from its vertices' live lists
+        for (uint32_t c = 0; c < 3; ++c)
+        {
+            uint32_t v = tri[c];
+            uint32_t* list = &adjacency[offsets[v]];
+            for (uint32_t i = 0; i < live[v]; ++i)
+            {
+                if (list[i] == best_triangle)
+                {
+                    list[i] = list[--live[v]];
+                    break;
+                }
+            }
+        }
+
+        // The triangle's vertices move to the front of the cache
+        uint32_t new_cache[VERTEX_CACHE_SIZE + 3];
+        uint32_t new_cache_count = 0;
+        for (uint32_t c = 0; c < 3; ++c)
+        {
+            bool found = false;
+            for (uint32_t i = 0; i < new_cache_count; ++i)
+                found |= new_cache[i] == tri[c];
+            if (!found)
+                new_cache[new_cache_count++] = tri[c];
+        }
+        for (uint32_t i = 0; i < cache_count; ++i)
+        {
+            uint32_t v = cache[i];
+            if (v != tri[0] && v != tri[1] && v != tri[2])
+                new_cache[new_cache_count++] = v;
+        }
+
+        // Rescore the cached vertices (including the ones that just fell out), and pick the best triangle using any of them
+        best_triangle = INVALID_INDEX;
+        float best_score = -1.0f;
+        for (uint32_t i = 0; i < new_cache_count; ++i)
+        {
+            uint32_t v = new_cache[i];
+            int32_t cache_position = i < VERTEX_CACHE_SIZE ? (int32_t)i : -1;
+            float score = GetVertexScore(cache_position, live[v]);
+            float diff = score - vertex_scores[v];
+            cache_positions[v] = cache_position;
+            vertex_scores[v] = score;
+
+            const uint32_t* list = &adjacency[offsets[v]];
+            for (uint32_t j = 0; j < live[v]; ++j)
+            {
+                uint32_t t = list[j];
+                triangle_scores[t] += diff;
+                if (cache_position >= 0 && triangle_scores[t] > best_score)
+                {
+                    best_score = triangle_scores[t];
+                    best_triangle = t;
+                }
+            }
+        }
+
+        cache_count = dmMath::Min(new_cache_count, VERTEX_CACHE_SIZE);
+        memcpy(cache, new_cache, sizeof(uint32_t) * cache_count);
+    }
+
+    memcpy(indices, out.Begin(), sizeof(uint32_t) * triangle_count * 3);
+}
+
+template<typename T>
+static void RemapVertexData(dmArray<T>& data, const uint32_t* remap, uint32_t vertex_count)
+{
+    if (data.Empty())
+        return;
+
+    uint32_t stride = data.Size() / vertex_count;
+    dmArray<T> copy;
+    copy.SetCapacity(data.Size());
+    copy.SetSize(data.Size());
+    memcpy(copy.Begin(), data.Begin(), sizeof(T) * data.Size());
+
+    for (uint32_t v = 0; v < vertex_count; ++v)
+        memcpy(&data[remap[v] * stride], &copy[v * stride], sizeof(T) * stride);
+}
+
+void OptimizeVertexFetch(Mesh* mesh)
+{
+    uint32_t vertex_count = mesh->m_VertexCount;
+    if (vertex_count == 0)
+        return;
+
+    dmArray<uint32_t> remap;
+    InitArray(remap, vertex_count, (uint32_t)INVALID_INDEX);
+
+    uint32_t next = 0;
+    for (uint32_t i = 0; i < mesh->m_Indices.Size(); ++i)
+    {
+        uint32_t v = mesh->m_Indices[i];
+        if (remap[v] == INVALID_INDEX)
+            remap[v] = next++;
+        mesh->m_Indices[i] = remap[v];
+    }
+
+    // Unused vertices are kept, at the end
+    for (uint32_t v = 0; v < vertex_count; ++v)
+    {
+        if (remap[v] == INVALID_INDEX)
+            remap[v] = next++;
+    }
+
+    RemapVertexData(mesh->m_Positions, remap.Begin(), vertex_count);
+    RemapVertexData(mesh->m_Normals, remap.Begin(), vertex_count);
+    RemapVertexData(mesh->m_Tangents, remap.Begin(), vertex_count);
+    RemapVertexData(mesh->m_Colors, remap.Begin(), vertex_count);
+    RemapVertexData(mesh->m_Weights, remap.Begin(), vertex_count);
+    RemapVertexData(mesh->m_Bones, remap.Begin(), vertex_count);
+    RemapVertexData(mesh->m_TexCoords0, remap.Begin(), vertex_count);
+    RemapVertexData(mesh->m_TexCoords1, remap.Begin(), vertex_count);
+}
+
+bool OptimizeMesh(Mesh* mesh)
+{
+    uint32_t index_count = mesh->m_Indices.Size();
+    uint32_t vertex_count = mesh->m_VertexCount;
+    if (index_count == 0 || (index_count % 3) != 0)
+        return false;
+
+    for (uint32_t i = 0; i < index_count; ++i)
+    {
+        if (mesh->m_Indices[i] >= vertex_count)
+            return false;
+    }
+
+    OptimizeVertexCache(mesh->m_Indices.Begin(), index_count, vertex_count);
+    OptimizeVertexFetch(mesh);
+    return true;
+}
+
 static void DestroyMaterial(Material* material)
 {
     free((void*)material->m_Name);
@@ -383,6 +383,22 @@ namespace dmModelImporter
     void DebugScene(Scene* scene);
     void DebugStructScene(Scene* scene);
 
+    // Removes the key frames that are recreated (within the tolerance) by interpolating between the remaining keys,
+    // linearly for translation and scale, and with slerp for rotations. The first and last keys are kept.
+    // Returns the new key count.
+    uint32_t ReduceKeyFrames(KeyFrame* key_frames, uint32_t key_count, uint32_t num_components, bool rotation, float tolerance);
+
+    // Reorders the triangles for better use of the post transform vertex cache. The triangles themselves are unchanged.
+    void OptimizeVertexCache(uint32_t* indices, uint32_t index_count, uint32_t vertex_count);
+
+    // Reorders the vertex data in the order the vertices are first used by the indices, and remaps the indices.
+    // Unused vertices are moved to the end.
+    void OptimizeVertexFetch(Mesh* mesh);
+
+    // Optimizes the vertex cache and vertex fetch order of an indexed triangle list.
+    // Returns false if the mesh isn't a valid triangle list, in which case it is left untouched.
+    bool OptimizeMesh(Mesh* mesh);
+
     // For tests. User needs to call free() on the returned memory
     void* ReadFile(const char* path, uint32_t* file_size);
     void* ReadFileToBuffer(const char* path, uint32_t buffer_size, void* buffer);
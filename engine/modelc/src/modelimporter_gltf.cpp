@@ -899,6 +899,11 @@ static void LoadPrimitives(Scene* scene, Model* model, cgltf_data* gltf_data, cg
             uint32_t size = mesh->m_VertexCount * mesh->m_TexCoords0NumComponents;
             InitSize(mesh->m_TexCoords0, size, size);
         }
+
+        if (prim->type == cgltf_primitive_type_triangles && prim->indices)
+        {
+            OptimizeMesh(mesh);
+        }
     }
 }
 
@@ -1357,6 +1362,12 @@ static void LoadChannel(NodeAnimation* node_animation, cgltf_animation_channel*
     {
         key_count = 1;
     }
+    else if (channel->sampler->interpolation == cgltf_interpolation_type_linear)
+    {
+        // Many exporters bake one key per frame, so drop the keys that the interpolation recreates anyway
+        bool rotation = channel->target_path == cgltf_animation_path_type_rotation;
+        key_count = ReduceKeyFrames(key_frames, key_count, num_components, rotation, 0.0001f);
+    }
 
     for (uint32_t i = 0; i < key_count; ++i)
     {
@@ -16,6 +16,8 @@
 #include "modelimporter.h"
 #include <dlib/dstrings.h>
 #include <dlib/time.h>
+#include <math.h>
+#include <stdlib.h>
 #include <string.h>
 
 
@@ -236,6 +238,153 @@ TEST(ModelSkinnedTopNodes, MultipleModels)
     dmModelImporter::DestroyScene(scene);
 }
 
+TEST(ModelAnimation, ReduceKeyFrames)
+{
+    // A linear ramp (one key per frame) followed by a hold and a step
+    const uint32_t key_count = 9;
+    dmModelImporter::KeyFrame keys[key_count];
+    memset(keys, 0, sizeof(keys));
+    float values[key_count] = { 0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 4.0f, 4.0f, 7.0f, 7.0f };
+    for (uint32_t i = 0; i < key_count; ++i)
+    {
+        keys[i].m_Time = i / 30.0f;
+        keys[i].m_Value[0] = values[i];
+        keys[i].m_Value[1] = -values[i];
+        keys[i].m_Value[2] = 1.0f;
+    }
+
+    uint32_t count = dmModelImporter::ReduceKeyFrames(keys, key_count, 3, false, 0.0001f);
+    ASSERT_EQ(5u, count);
+
+    float expected_times[]  = { 0.0f, 4.0f, 6.0f, 7.0f, 8.0f };
+    float expected_values[] = { 0.0f, 4.0f, 4.0f, 7.0f, 7.0f };
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        ASSERT_NEAR(expected_times[i] / 30.0f, keys[i].m_Time, 0.0001f);
+        ASSERT_NEAR(expected_values[i], keys[i].m_Value[0], 0.0001f);
+        ASSERT_NEAR(-expected_values[i], keys[i].m_Value[1], 0.0001f);
+    }
+
+    // A constant speed rotation around z only needs the end keys
+    const uint32_t rotation_key_count = 5;
+    dmModelImporter::KeyFrame rotation_keys[rotation_key_count];
+    memset(rotation_keys, 0, sizeof(rotation_keys));
+    for (uint32_t i = 0; i < rotation_key_count; ++i)
+    {
+        float half_angle = i * 0.25f * 0.5f;
+        rotation_keys[i].m_Time = (float)i;
+        rotation_keys[i].m_Value[2] = sinf(half_angle);
+        rotation_keys[i].m_Value[3] = cosf(half_angle);
+    }
+    ASSERT_EQ(2u, dmModelImporter::ReduceKeyFrames(rotation_keys, rotation_key_count, 4, true, 0.0001f));
+    ASSERT_NEAR(4.0f, rotation_keys[1].m_Time, 0.0001f);
+}
+
+// The number of vertex transforms with a 16 entry fifo cache
+static uint32_t CountCacheMisses(const uint32_t* indices, uint32_t index_count)
+{
+    uint32_t cache[16];
+    uint32_t cache_count = 0;
+    uint32_t misses = 0;
+    for (uint32_t i = 0; i < index_count; ++i)
+    {
+        bool found = false;
+        for (uint32_t j = 0; j < cache_count && !found; ++j)
+            found = cache[j] == indices[i];
+        if (found)
+            continue;
+
+        ++misses;
+        if (cache_count < 16)
+            ++cache_count;
+        memmove(cache + 1, cache, sizeof(uint32_t) * (cache_count - 1));
+        cache[0] = indices[i];
+    }
+    return misses;
+}
+
+static int CompareTriangles(const void* a, const void* b)
+{
+    return memcmp(a, b, sizeof(uint32_t) * 3);
+}
+
+TEST(ModelMesh, Optimize)
+{
+    // A grid of quads, with the triangles in a scrambled order
+    const uint32_t grid_size = 16;
+    const uint32_t vertex_count = (grid_size + 1) * (grid_size + 1);
+    const uint32_t triangle_count = grid_size * grid_size * 2;
+
+    dmModelImporter::Mesh mesh;
+    mesh.m_VertexCount = vertex_count;
+    mesh.m_Positions.SetCapacity(vertex_count * 3);
+    for (uint32_t v = 0; v < vertex_count; ++v)
+    {
+        // Store the original vertex index, to follow the vertex through the remapping
+        mesh.m_Positions.Push((float)v);
+        mesh.m_Positions.Push(0.0f);
+        mesh.m_Positions.Push(0.0f);
+    }
+
+    uint32_t triangles[triangle_count * 3];
+    uint32_t t = 0;
+    for (uint32_t y = 0; y < grid_size; ++y)
+    {
+        for (uint32_t x = 0; x < grid_size; ++x)
+        {
+            uint32_t a = y * (grid_size + 1) + x;
+            uint32_t b = a + 1;
+            uint32_t c = a + grid_size + 1;
+            uint32_t d = c + 1;
+            uint32_t quad[6] = { a, b, c, b, d, c };
+            memcpy(&triangles[t * 3], quad, sizeof(quad));
+            t += 2;
+        }
+    }
+
+    mesh.m_Indices.SetCapacity(triangle_count * 3);
+    for (uint32_t i = 0; i < triangle_count; ++i)
+    {
+        uint32_t src = (i * 97) % triangle_count; // 97 is coprime with the triangle count
+        mesh.m_Indices.Push(triangles[src * 3 + 0]);
+        mesh.m_Indices.Push(triangles[src * 3 + 1]);
+        mesh.m_Indices.Push(triangles[src * 3 + 2]);
+    }
+
+    uint32_t misses = CountCacheMisses(mesh.m_Indices.Begin(), mesh.m_Indices.Size());
+
+    ASSERT_TRUE(dmModelImporter::OptimizeMesh(&mesh));
+
+    ASSERT_EQ(triangle_count * 3, mesh.m_Indices.Size());
+    ASSERT_LT(CountCacheMisses(mesh.m_Indices.Begin(), mesh.m_Indices.Size()), misses / 2);
+
+    // The vertices are stored in the order they're first used
+    uint32_t next = 0;
+    for (uint32_t i = 0; i < mesh.m_Indices.Size(); ++i)
+    {
+        ASSERT_LE(mesh.m_Indices[i], next);
+        if (mesh.m_Indices[i] == next)
+            ++next;
+    }
+    ASSERT_EQ(vertex_count, next);
+
+    // The same triangles, with the same winding
+    uint32_t optimized[triangle_count * 3];
+    for (uint32_t i = 0; i < triangle_count * 3; ++i)
+        optimized[i] = (uint32_t)mesh.m_Positions[mesh.m_Indices[i] * 3];
+
+    qsort(triangles, triangle_count, sizeof(uint32_t) * 3, CompareTriangles);
+    qsort(optimized, triangle_count, sizeof(uint32_t) * 3, CompareTriangles);
+    ASSERT_EQ(0, memcmp(triangles, optimized, sizeof(triangles)));
+
+    // Not a triangle list
+    mesh.m_Indices.SetSize(4);
+    ASSERT_FALSE(dmModelImporter::OptimizeMesh(&mesh));
+
+    mesh.m_Positions.SetCapacity(0);
+    mesh.m_Indices.SetCapacity(0);
+}
+
 
 static int TestStandalone(const char* path)
 {
@@ -15,13 +15,13 @@
 #include <string.h>
 #include <stdint.h>
 #include <float.h>
-#include <algorithm>
 #include <dlib/hash.h>
 #include <dlib/log.h>
 #include <dlib/math.h>
 #include <dlib/math.h>
 #include <dlib/vmath.h>
 #include <dlib/profile.h>
+#include <dlib/radix_sort.h>
 #include <dlib/time.h>
 #include <dmsdk/dlib/vmath.h>
 
@@ -270,10 +270,29 @@ namespace dmParticle
             Emitter* emitter = &i->m_Emitters[emitter_i];
             emitter->m_Particles.SetCapacity(0);
             emitter->m_RenderConstants.SetCapacity(0);
+            emitter->m_SimulationData.SetCapacity(0);
         }
         delete i;
     }
 
+    static void ReportEmitterState(Instance* instance, Emitter* emitter, EmitterState state)
+    {
+        if(state == EMITTER_STATE_PRESPAWN)
+        {
+            instance->m_NumAwakeEmitters += 1;
+        }
+        else if(state == EMITTER_STATE_SLEEPING)
+        {
+            instance->m_NumAwakeEmitters -= 1;
+        }
+
+        instance->m_EmitterStateChangedData.m_StateChangedCallback(
+            instance->m_NumAwakeEmitters,
+            emitter->m_Id,
+            state,
+            instance->m_EmitterStateChangedData.m_UserData);
+    }
+
     void SetEmitterState(Instance* instance, Emitter* emitter, EmitterState state)
     {
         EmitterState old_emitter_state = emitter->m_State;
@@ -281,20 +300,26 @@ namespace dmParticle
 
         if(state != old_emitter_state && instance->m_EmitterStateChangedData.m_UserData != 0x0)
         {
-            if(state == EMITTER_STATE_PRESPAWN)
-            {
-                instance->m_NumAwakeEmitters += 1;
-            }
-            else if(state == EMITTER_STATE_SLEEPING)
+            if (emitter->m_DeferStateChanges)
             {
-                instance->m_NumAwakeEmitters -= 1;
+                // The awake count is shared between the emitters of the instance, and the callback
+                // might call into Lua, so both are left for FlushEmitterStates on the main thread
+                assert(emitter->m_PendingStateCount < MAX_PENDING_STATE_CHANGES);
+                emitter->m_PendingStates[emitter->m_PendingStateCount++] = (uint8_t)state;
+                return;
             }
 
-            instance->m_EmitterStateChangedData.m_StateChangedCallback(
-                instance->m_NumAwakeEmitters,
-                emitter->m_Id,
-                emitter->m_State,
-                instance->m_EmitterStateChangedData.m_UserData);
+            ReportEmitterState(instance, emitter, state);
+        }
+    }
+
+    static void FlushEmitterStates(Instance* instance, Emitter* emitter)
+    {
+        uint32_t count = emitter->m_PendingStateCount;
+        emitter->m_PendingStateCount = 0;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            ReportEmitterState(instance, emitter, (EmitterState)emitter->m_PendingStates[i]);
         }
     }
 
@@ -375,6 +400,7 @@ namespace dmParticle
                 for (uint32_t emitter_i = prototype_emitter_count; emitter_i < emitter_count; ++emitter_i)
                 {
                     emitters[emitter_i].m_Particles.SetCapacity(0);
+                    emitters[emitter_i].m_SimulationData.SetCapacity(0);
                 }
             }
             emitters.SetCapacity(prototype_emitter_count);
@@ -598,9 +624,8 @@ namespace dmParticle
     static void UpdateParticles(Instance* instance, Emitter* emitter, dmParticleDDF::Emitter* emitter_ddf, float dt);
     static void UpdateEmitterState(Instance* instance, Emitter* emitter, EmitterPrototype* emitter_prototype, dmParticleDDF::Emitter* emitter_ddf, float dt);
     static void EvaluateEmitterProperties(Emitter* emitter, Property* emitter_properties, float duration, float properties[EMITTER_KEY_COUNT]);
-    static void EvaluateParticleProperties(Emitter* emitter, Property* particle_properties, dmParticleDDF::Emitter* emitter_ddf, float dt);
     static GenerateVertexDataResult UpdateRenderData(HParticleContext context, Instance* instance, Emitter* emitter, dmParticleDDF::Emitter* ddf, const dmGraphics::VertexAttributeInfos& attribute_infos, const Vector4& color, uint32_t vertex_index, uint8_t* vertex_buffer, uint32_t vertex_buffer_size, uint32_t* bytes_written, float dt);
-    static void GenerateKeys(Emitter* emitter, float max_particle_life_time);
+    static bool GenerateKeys(Emitter* emitter, float max_particle_life_time);
     static void SortParticles(Emitter* emitter);
     static void Simulate(Instance* instance, Emitter* emitter, EmitterPrototype* prototype, dmParticleDDF::Emitter* ddf, float dt);
 
@@ -614,8 +639,9 @@ namespace dmParticle
 
         UpdateEmitterState(instance, emitter, emitter_prototype, emitter_ddf, dt);
 
-        GenerateKeys(emitter, emitter_prototype->m_MaxParticleLifeTime);
-        SortParticles(emitter);
+        // Particles spawned in order usually stay in order, and then there is nothing to sort
+        if (!GenerateKeys(emitter, emitter_prototype->m_MaxParticleLifeTime))
+            SortParticles(emitter);
 
         Simulate(instance, emitter, emitter_prototype, emitter_ddf, dt);
     }
@@ -686,10 +712,39 @@ namespace dmParticle
         return res;
     }
 
+    static void UpdateEmitterJob(EmitterUpdateJob* job, float dt)
+    {
+        Instance* instance = job->m_Instance;
+        Prototype* prototype = instance->m_Prototype;
+        uint32_t emitter_i = job->m_EmitterIndex;
+        Emitter* emitter = &instance->m_Emitters[emitter_i];
+        EmitterPrototype* emitter_prototype = &prototype->m_Emitters[emitter_i];
+        dmParticleDDF::Emitter* emitter_ddf = &prototype->m_DDF->m_Emitters[emitter_i];
+
+        emitter->m_DeferStateChanges = 1;
+        UpdateEmitterVelocity(instance, emitter, emitter_ddf, dt);
+        UpdateEmitter(prototype, instance, emitter_prototype, emitter, emitter_ddf, dt);
+        emitter->m_DeferStateChanges = 0;
+    }
+
+    static int UpdateEmitterJobProcess(void* context, void* data)
+    {
+        UpdateEmitterJob((EmitterUpdateJob*)data, *(float*)context);
+        return 0;
+    }
+
+    void SetJobThread(HParticleContext context, dmJobThread::HContext job_thread)
+    {
+        context->m_JobThread = job_thread;
+    }
+
     void Update(HParticleContext context, float dt, FetchAnimationCallback fetch_animation_callback)
     {
         DM_PROFILE(__FUNCTION__);
 
+        dmArray<EmitterUpdateJob>& jobs = context->m_EmitterJobs;
+        jobs.SetSize(0);
+
         uint32_t size = context->m_Instances.Size();
         uint32_t TotalAliveParticles = 0;
         for (uint32_t i = 0; i < size; i++)
@@ -712,25 +767,59 @@ namespace dmParticle
                 }
                 continue;
             }
-            uint32_t instance_handle = instance->m_VersionNumber << 16 | i;
             instance->m_PlayTime += dt;
-            Prototype* prototype = instance->m_Prototype;
             uint32_t emitter_count = instance->m_Emitters.Size();
+            if (jobs.Remaining() < emitter_count)
+                jobs.OffsetCapacity(dmMath::Max(emitter_count, 32U));
             for (uint32_t emitter_i = 0; emitter_i < emitter_count; ++emitter_i)
             {
-                Emitter* emitter = &instance->m_Emitters[emitter_i];
-                EmitterPrototype* emitter_prototype = &prototype->m_Emitters[emitter_i];
-                dmParticleDDF::Emitter* emitter_ddf = &prototype->m_DDF->m_Emitters[emitter_i];
+                EmitterUpdateJob job;
+                job.m_Instance = instance;
+                job.m_InstanceIndex = i;
+                job.m_EmitterIndex = emitter_i;
+                jobs.Push(job);
+            }
+        }
 
-                UpdateEmitterVelocity(instance, emitter, emitter_ddf, dt);
-                UpdateEmitter(prototype, instance, emitter_prototype, emitter, emitter_ddf, dt);
-                TotalAliveParticles += (uint32_t)emitter->m_Particles.Size();
-                FetchAnimation(emitter, emitter_prototype, fetch_animation_callback);
-                UpdateEmitterRenderData(instance_handle, emitter_i, instance, emitter, emitter_ddf);
+        // The emitters don't share any state while simulating, so they can be updated in parallel.
+        // Anything that calls back into the engine (state changes, animation lookups) is done below, in order.
+        uint32_t job_count = jobs.Size();
+        dmJobThread::JobGroup group;
+        dmJobThread::InitGroup(&group, 0);
+        for (uint32_t i = 0; i < job_count; ++i)
+        {
+            EmitterUpdateJob* job = &jobs[i];
+            Emitter* emitter = &job->m_Instance->m_Emitters[job->m_EmitterIndex];
+            if (context->m_JobThread && !IsSleeping(emitter) && dt > 0.0f)
+                dmJobThread::PushGroupJob(context->m_JobThread, &group, UpdateEmitterJobProcess, (void*)&dt, (void*)job);
+            else
+                UpdateEmitterJob(job, dt);
+        }
 
-                if (emitter->m_ReHash)
-                    ReHashEmitter(emitter);
-            }
+        if (context->m_JobThread)
+        {
+            DM_PROFILE("WaitEmitterJobs");
+            dmJobThread::WaitGroup(context->m_JobThread, &group);
+        }
+
+        for (uint32_t i = 0; i < job_count; ++i)
+        {
+            EmitterUpdateJob* job = &jobs[i];
+            Instance* instance = job->m_Instance;
+            uint32_t emitter_i = job->m_EmitterIndex;
+            uint32_t instance_handle = instance->m_VersionNumber << 16 | job->m_InstanceIndex;
+            Prototype* prototype = instance->m_Prototype;
+            Emitter* emitter = &instance->m_Emitters[emitter_i];
+            EmitterPrototype* emitter_prototype = &prototype->m_Emitters[emitter_i];
+            dmParticleDDF::Emitter* emitter_ddf = &prototype->m_DDF->m_Emitters[emitter_i];
+
+            FlushEmitterStates(instance, emitter);
+            TotalAliveParticles += (uint32_t)emitter->m_Particles.Size();
+            FetchAnimation(emitter, emitter_prototype, fetch_animation_callback);
+            UpdateEmitterRenderData(instance_handle, emitter_i, instance, emitter, emitter_ddf);
+
+            if (emitter->m_ReHash)
+                ReHashEmitter(emitter);
         }
 
         DM_PROPERTY_SET_U32(rmtp_ParticlesAlive, TotalAliveParticles);
@@ -1326,22 +1415,28 @@ namespace dmParticle
         return res;
     }
 
-    struct SortPred
+    // Scratch memory shared by the sort and the simulation streams, which are never used at the same time
+    static float* GetScratch(Emitter* emitter, uint32_t float_count)
     {
-        inline bool operator () (const Particle& p1, const Particle& p2)
+        dmArray<float>& data = emitter->m_SimulationData;
+        if (data.Capacity() < float_count)
         {
-            return p1.GetSortKey().m_Key < p2.GetSortKey().m_Key;
+            data.SetCapacity(float_count);
         }
+        data.SetSize(float_count);
+        return data.Begin();
+    }
 
-    };
-
-    void GenerateKeys(Emitter* emitter, float max_particle_life_time)
+    // Returns true if the particles already are in key order
+    bool GenerateKeys(Emitter* emitter, float max_particle_life_time)
     {
         dmArray<Particle>& particles = emitter->m_Particles;
         uint32_t n = particles.Size();
 
         float range = 1.0f / max_particle_life_time;
 
+        bool sorted = true;
+        uint32_t prev_key = 0;
         Particle* first = particles.Begin();
         for (uint32_t i = 0; i < n; ++i)
         {
@@ -1355,14 +1450,59 @@ namespace dmParticle
             key.m_LifeTime = lt;
             key.m_Index = index;
             p->SetSortKey(key);
+
+            sorted = sorted && key.m_Key >= prev_key;
+            prev_key = key.m_Key;
         }
+        return sorted;
     }
 
     void SortParticles(Emitter* emitter)
     {
         DM_PROFILE(__FUNCTION__);
 
-        std::sort(emitter->m_Particles.Begin(), emitter->m_Particles.End(), SortPred());
+        dmArray<Particle>& particles = emitter->m_Particles;
+        uint32_t count = particles.Size();
+        if (count < 2)
+            return;
+
+        // keys and tmp_keys (2 floats per entry each), order and tmp_order (1 float per entry each)
+        uint32_t stride = (count + 1) & ~1u;
+        float* scratch = GetScratch(emitter, stride * 6);
+        uint64_t* keys = (uint64_t*) scratch;
+        uint64_t* tmp_keys = keys + stride;
+        uint32_t* order = (uint32_t*) (tmp_keys + stride);
+        uint32_t* tmp_order = order + stride;
+
+        // The index part of the sort key only makes the comparison sort stable, which the radix sort already is
+        Particle* p = particles.Begin();
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            keys[i] = p[i].m_SortKey.m_LifeTime;
+            order[i] = i;
+        }
+        dmRadixSort::Sort(keys, order, tmp_keys, tmp_order, count, 16);
+
+        // Move the particles into place by following the cycles of the permutation, so no copy of the particles is needed
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            if (order[i] == i)
+                continue;
+            Particle tmp = p[i];
+            uint32_t j = i;
+            while (true)
+            {
+                uint32_t next = order[j];
+                order[j] = j;
+                if (next == i)
+                {
+                    p[j] = tmp;
+                    break;
+                }
+                p[j] = p[next];
+                j = next;
+            }
+        }
     }
 
 #define SAMPLE_PROP(segment, x, target)\
@@ -1381,111 +1521,136 @@ namespace dmParticle
         }
     }
 
-    void EvaluateParticleProperties(Emitter* emitter, Property* particle_properties, dmParticleDDF::Emitter* emitter_ddf, float dt)
+    static inline void EvaluateParticleProperties(Particle* particle, Property* particle_properties, uint32_t orientation, float dt)
     {
         float properties[PARTICLE_KEY_COUNT];
-        // TODO Optimize this
-        dmArray<Particle>& particles = emitter->m_Particles;
-        uint32_t count = particles.Size();
-        for (uint32_t i = 0; i < count; ++i)
-        {
-            Particle* particle = &particles[i];
-            float x = dmMath::Select(-particle->GetMaxLifeTime(), 0.0f, 1.0f - particle->GetTimeLeft() * particle->GetooMaxLifeTime());
-            uint32_t segment_index = dmMath::Min((uint32_t)(x * PROPERTY_SAMPLE_COUNT), PROPERTY_SAMPLE_COUNT - 1);
-
-            SAMPLE_PROP(particle_properties[PARTICLE_KEY_SCALE].m_Segments[segment_index], x, properties[PARTICLE_KEY_SCALE])
-            SAMPLE_PROP(particle_properties[PARTICLE_KEY_RED].m_Segments[segment_index], x, properties[PARTICLE_KEY_RED])
-            SAMPLE_PROP(particle_properties[PARTICLE_KEY_GREEN].m_Segments[segment_index], x, properties[PARTICLE_KEY_GREEN])
-            SAMPLE_PROP(particle_properties[PARTICLE_KEY_BLUE].m_Segments[segment_index], x, properties[PARTICLE_KEY_BLUE])
-            SAMPLE_PROP(particle_properties[PARTICLE_KEY_ALPHA].m_Segments[segment_index], x, properties[PARTICLE_KEY_ALPHA])
-            SAMPLE_PROP(particle_properties[PARTICLE_KEY_STRETCH_FACTOR_X].m_Segments[segment_index], x, properties[PARTICLE_KEY_STRETCH_FACTOR_X])
-            SAMPLE_PROP(particle_properties[PARTICLE_KEY_STRETCH_FACTOR_Y].m_Segments[segment_index], x, properties[PARTICLE_KEY_STRETCH_FACTOR_Y])
-            Vector4 c = particle->GetSourceColor();
-            particle->SetScale(Vector3(properties[PARTICLE_KEY_SCALE]));
-            particle->SetColor(Vector4(dmMath::Clamp(c.getX() * properties[PARTICLE_KEY_RED], 0.0f, 1.0f),
-                    dmMath::Clamp(c.getY() * properties[PARTICLE_KEY_GREEN], 0.0f, 1.0f),
-                    dmMath::Clamp(c.getZ() * properties[PARTICLE_KEY_BLUE], 0.0f, 1.0f),
-                    dmMath::Clamp(c.getW() * properties[PARTICLE_KEY_ALPHA], 0.0f, 1.0f)));
-            particle->m_StretchFactorX = particle->m_SourceStretchFactorX + (properties[PARTICLE_KEY_STRETCH_FACTOR_X]);
-            particle->m_StretchFactorY = particle->m_SourceStretchFactorY + (properties[PARTICLE_KEY_STRETCH_FACTOR_Y]);
-        }
-
-        if (emitter_ddf->m_ParticleOrientation == PARTICLE_ORIENTATION_MOVEMENT_DIRECTION) {
-            for (uint32_t i = 0; i < count; ++i)
-            {
-                Particle* particle = &particles[i];
-                float x = dmMath::Select(-particle->GetMaxLifeTime(), 0.0f, 1.0f - particle->GetTimeLeft() * particle->GetooMaxLifeTime());
-                uint32_t segment_index = dmMath::Min((uint32_t)(x * PROPERTY_SAMPLE_COUNT), PROPERTY_SAMPLE_COUNT - 1);
-                SAMPLE_PROP(particle_properties[PARTICLE_KEY_ROTATION].m_Segments[segment_index], x, properties[PARTICLE_KEY_ROTATION])
-                particle->SetRotation(particle->GetSourceRotation() * dmVMath::QuatFromAngle(2, DEG_RAD * properties[PARTICLE_KEY_ROTATION]));
-                if (lengthSqr(particle->m_Velocity) > EPSILON)
-                {
-                    Vector3 vel_norm = normalize(particle->m_Velocity);
-                    float y_dot = dot(Vector3::yAxis(), vel_norm);
-                    // Corner case, https://gamedev.stackexchange.com/questions/61672/align-a-rotation-to-a-direction
-                    Quat q_vel = (dmMath::Abs(y_dot + 1.0f) > EPSILON) ? Quat::rotation(Vector3::yAxis(), vel_norm) : Quat(0.0, 0.0, 1.0, 0.0);
-                    Quat q = particle->GetRotation() * q_vel;
-                    particle->SetRotation(q);
-                }
-            }
-
-        } else if (emitter_ddf->m_ParticleOrientation == PARTICLE_ORIENTATION_ANGULAR_VELOCITY) {
-            for (uint32_t i = 0; i < count; ++i)
-            {
-                Particle* particle = &particles[i];
-                float x = dmMath::Select(-particle->GetMaxLifeTime(), 0.0f, 1.0f - particle->GetTimeLeft() * particle->GetooMaxLifeTime());
-                uint32_t segment_index = dmMath::Min((uint32_t)(x * PROPERTY_SAMPLE_COUNT), PROPERTY_SAMPLE_COUNT - 1);
-                SAMPLE_PROP(particle_properties[PARTICLE_KEY_ANGULAR_VELOCITY].m_Segments[segment_index], x, properties[PARTICLE_KEY_ANGULAR_VELOCITY])
-                particle->SetRotation(particle->GetRotation() * Quat::rotationZ(DEG_RAD * (particle->m_SourceAngularVelocity * (properties[PARTICLE_KEY_ANGULAR_VELOCITY])) * dt));
-            }
+        float x = dmMath::Select(-particle->GetMaxLifeTime(), 0.0f, 1.0f - particle->GetTimeLeft() * particle->GetooMaxLifeTime());
+        uint32_t segment_index = dmMath::Min((uint32_t)(x * PROPERTY_SAMPLE_COUNT), PROPERTY_SAMPLE_COUNT - 1);
 
-        } else {
-            for (uint32_t i = 0; i < count; ++i)
+        SAMPLE_PROP(particle_properties[PARTICLE_KEY_SCALE].m_Segments[segment_index], x, properties[PARTICLE_KEY_SCALE])
+        SAMPLE_PROP(particle_properties[PARTICLE_KEY_RED].m_Segments[segment_index], x, properties[PARTICLE_KEY_RED])
+        SAMPLE_PROP(particle_properties[PARTICLE_KEY_GREEN].m_Segments[segment_index], x, properties[PARTICLE_KEY_GREEN])
+        SAMPLE_PROP(particle_properties[PARTICLE_KEY_BLUE].m_Segments[segment_index], x, properties[PARTICLE_KEY_BLUE])
+        SAMPLE_PROP(particle_properties[PARTICLE_KEY_ALPHA].m_Segments[segment_index], x, properties[PARTICLE_KEY_ALPHA])
+        SAMPLE_PROP(particle_properties[PARTICLE_KEY_STRETCH_FACTOR_X].m_Segments[segment_index], x, properties[PARTICLE_KEY_STRETCH_FACTOR_X])
+        SAMPLE_PROP(particle_properties[PARTICLE_KEY_STRETCH_FACTOR_Y].m_Segments[segment_index], x, properties[PARTICLE_KEY_STRETCH_FACTOR_Y])
+        Vector4 c = particle->GetSourceColor();
+        particle->SetScale(Vector3(properties[PARTICLE_KEY_SCALE]));
+        particle->SetColor(Vector4(dmMath::Clamp(c.getX() * properties[PARTICLE_KEY_RED], 0.0f, 1.0f),
+                dmMath::Clamp(c.getY() * properties[PARTICLE_KEY_GREEN], 0.0f, 1.0f),
+                dmMath::Clamp(c.getZ() * properties[PARTICLE_KEY_BLUE], 0.0f, 1.0f),
+                dmMath::Clamp(c.getW() * properties[PARTICLE_KEY_ALPHA], 0.0f, 1.0f)));
+        particle->m_StretchFactorX = particle->m_SourceStretchFactorX + (properties[PARTICLE_KEY_STRETCH_FACTOR_X]);
+        particle->m_StretchFactorY = particle->m_SourceStretchFactorY + (properties[PARTICLE_KEY_STRETCH_FACTOR_Y]);
+
+        if (orientation == PARTICLE_ORIENTATION_MOVEMENT_DIRECTION)
+        {
+            SAMPLE_PROP(particle_properties[PARTICLE_KEY_ROTATION].m_Segments[segment_index], x, properties[PARTICLE_KEY_ROTATION])
+            particle->SetRotation(particle->GetSourceRotation() * dmVMath::QuatFromAngle(2, DEG_RAD * properties[PARTICLE_KEY_ROTATION]));
+            if (lengthSqr(particle->m_Velocity) > EPSILON)
             {
-                Particle* particle = &particles[i];
-                float x = dmMath::Select(-particle->GetMaxLifeTime(), 0.0f, 1.0f - particle->GetTimeLeft() * particle->GetooMaxLifeTime());
-                uint32_t segment_index = dmMath::Min((uint32_t)(x * PROPERTY_SAMPLE_COUNT), PROPERTY_SAMPLE_COUNT - 1);
-                SAMPLE_PROP(particle_properties[PARTICLE_KEY_ROTATION].m_Segments[segment_index], x, properties[PARTICLE_KEY_ROTATION])
-                particle->SetRotation(particle->GetSourceRotation() * dmVMath::QuatFromAngle(2, DEG_RAD * properties[PARTICLE_KEY_ROTATION]));
+                Vector3 vel_norm = normalize(particle->m_Velocity);
+                float y_dot = dot(Vector3::yAxis(), vel_norm);
+                // Corner case, https://gamedev.stackexchange.com/questions/61672/align-a-rotation-to-a-direction
+                Quat q_vel = (dmMath::Abs(y_dot + 1.0f) > EPSILON) ? Quat::rotation(Vector3::yAxis(), vel_norm) : Quat(0.0, 0.0, 1.0, 0.0);
+                Quat q = particle->GetRotation() * q_vel;
+                particle->SetRotation(q);
             }
         }
-
+        else if (orientation == PARTICLE_ORIENTATION_ANGULAR_VELOCITY)
+        {
+            SAMPLE_PROP(particle_properties[PARTICLE_KEY_ANGULAR_VELOCITY].m_Segments[segment_index], x, properties[PARTICLE_KEY_ANGULAR_VELOCITY])
+            particle->SetRotation(particle->GetRotation() * Quat::rotationZ(DEG_RAD * (particle->m_SourceAngularVelocity * (properties[PARTICLE_KEY_ANGULAR_VELOCITY])) * dt));
+        }
+        else
+        {
+            SAMPLE_PROP(particle_properties[PARTICLE_KEY_ROTATION].m_Segments[segment_index], x, properties[PARTICLE_KEY_ROTATION])
+            particle->SetRotation(particle->GetSourceRotation() * dmVMath::QuatFromAngle(2, DEG_RAD * properties[PARTICLE_KEY_ROTATION]));
+        }
     }
 
-    void ApplyAcceleration(dmArray<Particle>& particles, Property* modifier_properties, const Quat& rotation, float scale, float emitter_t, float dt)
+    static inline float SampleModifierMagnitude(const Property& magnitude_property, float emitter_t)
     {
-        uint32_t particle_count = particles.Size();
-        Vector3 acc_step = rotate(rotation, ACCELERATION_LOCAL_DIR) * dt * scale;
-        const Property& magnitude_property = modifier_properties[MODIFIER_KEY_MAGNITUDE];
         uint32_t segment_index = dmMath::Min((uint32_t)(emitter_t * PROPERTY_SAMPLE_COUNT), PROPERTY_SAMPLE_COUNT - 1);
         float magnitude;
         SAMPLE_PROP(magnitude_property.m_Segments[segment_index], emitter_t, magnitude)
+        return magnitude;
+    }
+
+    static void GetParticleStreams(Emitter* emitter, ParticleStreams* streams)
+    {
+        // Each stream is sized for the particle capacity and kept 16 byte aligned
+        uint32_t stride = (emitter->m_Particles.Capacity() + 3) & ~3u;
+        float* base = GetScratch(emitter, stride * PARTICLE_STREAM_COUNT);
+        streams->m_Particles    = emitter->m_Particles.Begin();
+        streams->m_PositionX    = base + 0 * stride;
+        streams->m_PositionY    = base + 1 * stride;
+        streams->m_PositionZ    = base + 2 * stride;
+        streams->m_VelocityX    = base + 3 * stride;
+        streams->m_VelocityY    = base + 4 * stride;
+        streams->m_VelocityZ    = base + 5 * stride;
+        streams->m_SpreadFactor = base + 6 * stride;
+    }
+
+    // The modifiers work on structure of arrays copies of the particle positions and velocities (see Simulate),
+    // written as plain loops over the streams so that the compiler can vectorize them.
+
+    void ApplyAcceleration(ParticleStreams& streams, uint32_t particle_count, Property* modifier_properties, const Quat& rotation, float scale, float emitter_t, float dt)
+    {
+        Vector3 acc_step = rotate(rotation, ACCELERATION_LOCAL_DIR) * dt * scale;
+        const Property& magnitude_property = modifier_properties[MODIFIER_KEY_MAGNITUDE];
+        float magnitude = SampleModifierMagnitude(magnitude_property, emitter_t);
         float mag_spread = magnitude_property.m_Spread;
+        float ax = acc_step.getX();
+        float ay = acc_step.getY();
+        float az = acc_step.getZ();
+        float* vx = streams.m_VelocityX;
+        float* vy = streams.m_VelocityY;
+        float* vz = streams.m_VelocityZ;
+        const float* spread = streams.m_SpreadFactor;
         for (uint32_t i = 0; i < particle_count; ++i)
         {
-            Particle* particle = &particles[i];
-            particle->SetVelocity(particle->GetVelocity() + acc_step * (magnitude + mag_spread * particle->GetSpreadFactor()));
+            float m = magnitude + mag_spread * spread[i];
+            vx[i] += ax * m;
+            vy[i] += ay * m;
+            vz[i] += az * m;
         }
     }
 
-    void ApplyDrag(dmArray<Particle>& particles, Property* modifier_properties, dmParticleDDF::Modifier* modifier_ddf, const Quat& rotation, float emitter_t, float dt)
+    void ApplyDrag(ParticleStreams& streams, uint32_t particle_count, Property* modifier_properties, dmParticleDDF::Modifier* modifier_ddf, const Quat& rotation, float emitter_t, float dt)
     {
-        uint32_t particle_count = particles.Size();
         Vector3 direction = rotate(rotation, DRAG_LOCAL_DIR);
         const Property& magnitude_property = modifier_properties[MODIFIER_KEY_MAGNITUDE];
-        uint32_t segment_index = dmMath::Min((uint32_t)(emitter_t * PROPERTY_SAMPLE_COUNT), PROPERTY_SAMPLE_COUNT - 1);
-        float magnitude;
-        SAMPLE_PROP(magnitude_property.m_Segments[segment_index], emitter_t, magnitude)
+        float magnitude = SampleModifierMagnitude(magnitude_property, emitter_t);
         float mag_spread = magnitude_property.m_Spread;
-        for (uint32_t i = 0; i < particle_count; ++i)
+        float dx = direction.getX();
+        float dy = direction.getY();
+        float dz = direction.getZ();
+        float* vx = streams.m_VelocityX;
+        float* vy = streams.m_VelocityY;
+        float* vz = streams.m_VelocityZ;
+        const float* spread = streams.m_SpreadFactor;
+        if (modifier_ddf->m_UseDirection)
+        {
+            for (uint32_t i = 0; i < particle_count; ++i)
+            {
+                float p = vx[i] * dx + vy[i] * dy + vz[i] * dz;
+                // Applied drag > 1 means the particle would travel in the reverse direction
+                float applied_drag = dmMath::Min((magnitude + mag_spread * spread[i]) * dt, 1.0f);
+                vx[i] -= (p * dx) * applied_drag;
+                vy[i] -= (p * dy) * applied_drag;
+                vz[i] -= (p * dz) * applied_drag;
+            }
+        }
+        else
         {
-            Particle* particle = &particles[i];
-            Vector3 v = particle->GetVelocity();
-            if (modifier_ddf->m_UseDirection)
-                v = projection(Point3(particle->GetVelocity()), direction) * direction;
-            // Applied drag > 1 means the particle would travel in the reverse direction
-            float applied_drag = dmMath::Min((magnitude + mag_spread * particle->GetSpreadFactor()) * dt, 1.0f);
-            particle->SetVelocity(particle->GetVelocity() - v * applied_drag);
+            for (uint32_t i = 0; i < particle_count; ++i)
+            {
+                float applied_drag = dmMath::Min((magnitude + mag_spread * spread[i]) * dt, 1.0f);
+                vx[i] -= vx[i] * applied_drag;
+                vy[i] -= vy[i] * applied_drag;
+                vz[i] -= vz[i] * applied_drag;
+            }
         }
     }
 
@@ -1494,50 +1659,61 @@ namespace dmParticle
         return rotate(particle->GetRotation(), PARTICLE_LOCAL_BASE_DIR);
     }
 
-    static Vector3 NonZeroVector3(Vector3 v, float sq_length, Vector3 fallback)
+    void ApplyRadial(ParticleStreams& streams, uint32_t particle_count, Property* modifier_properties, const Point3& position, float scale, float emitter_t, float dt)
     {
-        Vector3 result;
-        float neg_sq_length = -sq_length;
-        result.setX(dmMath::Select(neg_sq_length, fallback.getX(), v.getX()));
-        result.setY(dmMath::Select(neg_sq_length, fallback.getY(), v.getY()));
-        result.setZ(dmMath::Select(neg_sq_length, fallback.getZ(), v.getZ()));
-        return result;
-    }
-
-    void ApplyRadial(dmArray<Particle>& particles, Property* modifier_properties, const Point3& position, float scale, float emitter_t, float dt)
-    {
-        uint32_t particle_count = particles.Size();
         const Property& magnitude_property = modifier_properties[MODIFIER_KEY_MAGNITUDE];
         const Property& max_distance_property = modifier_properties[MODIFIER_KEY_MAX_DISTANCE];
-        uint32_t segment_index = dmMath::Min((uint32_t)(emitter_t * PROPERTY_SAMPLE_COUNT), PROPERTY_SAMPLE_COUNT - 1);
-        float magnitude;
-        SAMPLE_PROP(magnitude_property.m_Segments[segment_index], emitter_t, magnitude)
+        float magnitude = SampleModifierMagnitude(magnitude_property, emitter_t);
         float mag_spread = magnitude_property.m_Spread;
         // We temporarily only sample the first frame until we have decided what to animate over
         float max_distance = max_distance_property.m_Segments[0].m_Y * scale;
         float max_sq_distance = max_distance * max_distance;
         float applied_factor = dt * scale;
+        float ox = position.getX();
+        float oy = position.getY();
+        float oz = position.getZ();
+        const float* px = streams.m_PositionX;
+        const float* py = streams.m_PositionY;
+        const float* pz = streams.m_PositionZ;
+        float* vx = streams.m_VelocityX;
+        float* vy = streams.m_VelocityY;
+        float* vz = streams.m_VelocityZ;
+        const float* spread = streams.m_SpreadFactor;
         for (uint32_t i = 0; i < particle_count; ++i)
         {
-            Particle* particle = &particles[i];
-            Vector3 delta = particle->GetPosition() - position;
-            float delta_sq_len = lengthSqr(delta);
-            float applied_magnitude = magnitude + mag_spread * particle->GetSpreadFactor();
+            float dx = px[i] - ox;
+            float dy = py[i] - oy;
+            float dz = pz[i] - oz;
+            float delta_sq_len = dx * dx + dy * dy + dz * dz;
+            float applied_magnitude = magnitude + mag_spread * spread[i];
             // 0 acc delta lies outside max dist
             float a = dmMath::Select(max_sq_distance - delta_sq_len, applied_magnitude, 0.0f);
-            Vector3 dir = normalize(NonZeroVector3(delta, delta_sq_len, GetParticleDir(particle)));
-            particle->SetVelocity(particle->GetVelocity() + dir * a * applied_factor);
+            if (delta_sq_len <= 0.0f)
+            {
+                // The particle is at the center, push it along its own direction instead
+                Vector3 dir = normalize(GetParticleDir(&streams.m_Particles[i]));
+                dx = dir.getX();
+                dy = dir.getY();
+                dz = dir.getZ();
+            }
+            else
+            {
+                float inv_len = 1.0f / sqrtf(delta_sq_len);
+                dx *= inv_len;
+                dy *= inv_len;
+                dz *= inv_len;
+            }
+            vx[i] += (dx * a) * applied_factor;
+            vy[i] += (dy * a) * applied_factor;
+            vz[i] += (dz * a) * applied_factor;
         }
     }
 
-    void ApplyVortex(dmArray<Particle>& particles, Property* modifier_properties, const Point3& position, const Quat& rotation, float scale, float emitter_t, float dt)
+    void ApplyVortex(ParticleStreams& streams, uint32_t particle_count, Property* modifier_properties, const Point3& position, const Quat& rotation, float scale, float emitter_t, float dt)
     {
-        uint32_t particle_count = particles.Size();
         const Property& magnitude_property = modifier_properties[MODIFIER_KEY_MAGNITUDE];
         const Property& max_distance_property = modifier_properties[MODIFIER_KEY_MAX_DISTANCE];
-        uint32_t segment_index = dmMath::Min((uint32_t)(emitter_t * PROPERTY_SAMPLE_COUNT), PROPERTY_SAMPLE_COUNT - 1);
-        float magnitude;
-        SAMPLE_PROP(magnitude_property.m_Segments[segment_index], emitter_t, magnitude)
+        float magnitude = SampleModifierMagnitude(magnitude_property, emitter_t);
         float mag_spread = magnitude_property.m_Spread;
         // We temporarily only sample the first frame until we have decided what to animate over
         float max_distance = max_distance_property.m_Segments[0].m_Y * scale;
@@ -1545,23 +1721,50 @@ namespace dmParticle
         Vector3 axis = rotate(rotation, VORTEX_LOCAL_AXIS);
         Vector3 start = rotate(rotation, VORTEX_LOCAL_START_DIR);
         float applied_factor = dt * scale;
+        float ox = position.getX();
+        float oy = position.getY();
+        float oz = position.getZ();
+        float ax = axis.getX();
+        float ay = axis.getY();
+        float az = axis.getZ();
+        float sx = start.getX();
+        float sy = start.getY();
+        float sz = start.getZ();
+        const float* px = streams.m_PositionX;
+        const float* py = streams.m_PositionY;
+        const float* pz = streams.m_PositionZ;
+        float* vx = streams.m_VelocityX;
+        float* vy = streams.m_VelocityY;
+        float* vz = streams.m_VelocityZ;
+        const float* spread = streams.m_SpreadFactor;
         for (uint32_t i = 0; i < particle_count; ++i)
         {
-            Particle* particle = &particles[i];
             // delta from vortex position
-            Vector3 delta = particle->GetPosition() - position;
+            float dx = px[i] - ox;
+            float dy = py[i] - oy;
+            float dz = pz[i] - oz;
             // normal from vortex axis (non-unit)
-            Vector3 normal = delta - projection(Point3(delta), axis) * axis;
+            float d = dx * ax + dy * ay + dz * az;
+            float nx = dx - d * ax;
+            float ny = dy - d * ay;
+            float nz = dz - d * az;
             // tangent is the direction of the vortex acceleration
-            Vector3 tangent = cross(axis, normal);
+            float tx = ay * nz - az * ny;
+            float ty = az * nx - ax * nz;
+            float tz = ax * ny - ay * nx;
             // In case the particle is directed along the axis, give it a guaranteed orthogonal start
-            tangent = NonZeroVector3(tangent, lengthSqr(tangent), start);
+            float neg_sq_length = -(tx * tx + ty * ty + tz * tz);
+            tx = dmMath::Select(neg_sq_length, sx, tx);
+            ty = dmMath::Select(neg_sq_length, sy, ty);
+            tz = dmMath::Select(neg_sq_length, sz, tz);
             // tangent is now guaranteed to be non-zero
-            tangent = normalize(tangent);
+            float inv_len = 1.0f / sqrtf(tx * tx + ty * ty + tz * tz);
             // use normal for max distance test
-            float normal_sq_len = lengthSqr(normal);
-            float acceleration = dmMath::Select(max_sq_distance - normal_sq_len, magnitude + mag_spread * particle->GetSpreadFactor(), 0.0f);
-            particle->SetVelocity(particle->GetVelocity() + tangent * acceleration * applied_factor);
+            float normal_sq_len = nx * nx + ny * ny + nz * nz;
+            float acceleration = dmMath::Select(max_sq_distance - normal_sq_len, magnitude + mag_spread * spread[i], 0.0f);
+            vx[i] += ((tx * inv_len) * acceleration) * applied_factor;
+            vy[i] += ((ty * inv_len) * acceleration) * applied_factor;
+            vz[i] += ((tz * inv_len) * acceleration) * applied_factor;
         }
     }
 
@@ -1591,7 +1794,28 @@ namespace dmParticle
         DM_PROFILE(__FUNCTION__);
 
         dmArray<Particle>& particles = emitter->m_Particles;
-        EvaluateParticleProperties(emitter, prototype->m_ParticleProperties, ddf, dt);
+        uint32_t particle_count = particles.Size();
+        if (particle_count == 0)
+            return;
+
+        // Evaluate the particle properties, and copy the state the modifiers work on into the streams
+        ParticleStreams streams;
+        GetParticleStreams(emitter, &streams);
+        uint32_t orientation = ddf->m_ParticleOrientation;
+        Property* particle_properties = prototype->m_ParticleProperties;
+        for (uint32_t i = 0; i < particle_count; ++i)
+        {
+            Particle* p = &particles[i];
+            EvaluateParticleProperties(p, particle_properties, orientation, dt);
+            streams.m_PositionX[i] = p->m_Position.getX();
+            streams.m_PositionY[i] = p->m_Position.getY();
+            streams.m_PositionZ[i] = p->m_Position.getZ();
+            streams.m_VelocityX[i] = p->m_Velocity.getX();
+            streams.m_VelocityY[i] = p->m_Velocity.getY();
+            streams.m_VelocityZ[i] = p->m_Velocity.getZ();
+            streams.m_SpreadFactor[i] = p->m_SpreadFactor;
+        }
+
         float emitter_t = dmMath::Select(-ddf->m_Duration, 0.0f, emitter->m_Timer / ddf->m_Duration);
         float scale = 1.0f;
         if (ddf->m_Space == EMISSION_SPACE_WORLD)
@@ -1607,43 +1831,45 @@ namespace dmParticle
             case dmParticleDDF::MODIFIER_TYPE_ACCELERATION:
                 {
                     Quat rotation = CalculateModifierRotation(instance, ddf, modifier_ddf);
-                    ApplyAcceleration(particles, modifier->m_Properties, rotation, scale, emitter_t, dt);
+                    ApplyAcceleration(streams, particle_count, modifier->m_Properties, rotation, scale, emitter_t, dt);
                 }
                 break;
             case dmParticleDDF::MODIFIER_TYPE_DRAG:
                 {
                     Quat rotation = CalculateModifierRotation(instance, ddf, modifier_ddf);
-                    ApplyDrag(particles, modifier->m_Properties, modifier_ddf, rotation, emitter_t, dt);
+                    ApplyDrag(streams, particle_count, modifier->m_Properties, modifier_ddf, rotation, emitter_t, dt);
                 }
                 break;
             case dmParticleDDF::MODIFIER_TYPE_RADIAL:
                 {
                     Point3 position = CalculateModifierPosition(instance, ddf, modifier_ddf);
-                    ApplyRadial(particles, modifier->m_Properties, position, scale, emitter_t, dt);
+                    ApplyRadial(streams, particle_count, modifier->m_Properties, position, scale, emitter_t, dt);
                 }
                 break;
             case dmParticleDDF::MODIFIER_TYPE_VORTEX:
                 {
                     Point3 position = CalculateModifierPosition(instance, ddf, modifier_ddf);
                     Quat rotation = CalculateModifierRotation(instance, ddf, modifier_ddf);
-                    ApplyVortex(particles, modifier->m_Properties, position, rotation, scale, emitter_t, dt);
+                    ApplyVortex(streams, particle_count, modifier->m_Properties, position, rotation, scale, emitter_t, dt);
                 }
                 break;
             }
         }
-        uint32_t particle_count = particles.Size();
+
         for (uint32_t i = 0; i < particle_count; ++i)
         {
             Particle* p = &particles[i];
+            Vector3 velocity(streams.m_VelocityX[i], streams.m_VelocityY[i], streams.m_VelocityZ[i]);
+            p->m_Velocity = velocity;
             // NOTE This velocity integration has a larger error than normal since we don't use the velocity at the
             // beginning of the frame, but it's ok since particle movement does not need to be very exact
-            p->SetPosition(p->GetPosition() + p->m_Velocity * dt);
+            p->SetPosition(p->GetPosition() + velocity * dt);
 
             p->m_Scale[0] += p->m_Scale[0] * p->m_StretchFactorX;
             if (!ddf->m_StretchWithVelocity)
                 p->m_Scale[1] += p->m_Scale[1] * p->m_StretchFactorY;
             else
-                p->m_Scale[1] += p->m_Scale[1] * p->m_StretchFactorY * length(p->m_Velocity) * STRETCH_SCALING;
+                p->m_Scale[1] += p->m_Scale[1] * p->m_StretchFactorY * length(velocity) * STRETCH_SCALING;
         }
     }
 
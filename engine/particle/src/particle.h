@@ -17,6 +17,7 @@
 
 #include <dmsdk/dlib/vmath.h>
 #include <dlib/hash.h>
+#include <dlib/job_thread.h>
 #include <ddf/ddf.h>
 #include <graphics/graphics.h>
 #include "particle/particle_ddf.h"
@@ -246,6 +247,14 @@ namespace dmParticle
      */
     DM_PARTICLE_PROTO(void, SetContextMaxParticleCount, HParticleContext context, uint32_t max_particle_count);
 
+    /**
+     * Set the job thread used to simulate the emitters in parallel during Update.
+     * State changed callbacks are still invoked from the thread calling Update.
+     * @param context Context to update.
+     * @param job_thread Job thread, or 0 to simulate all emitters on the calling thread.
+     */
+    void SetJobThread(HParticleContext context, dmJobThread::HContext job_thread);
+
     /**
      * Create an instance from the supplied path and fetch resources using the supplied factory.
      * @param context Context in which to create the instance, must be valid.
@@ -17,12 +17,16 @@
 #define DM_PARTICLE_PRIVATE_H
 
 #include <dlib/index_pool.h>
+#include <dlib/job_thread.h>
 #include <dlib/transform.h>
 
 #include "particle/particle_ddf.h"
 
 namespace dmParticle
 {
+    /// Max number of state changes an emitter can go through during one update (prespawn -> spawning -> postspawn -> sleeping)
+    static const uint32_t MAX_PENDING_STATE_CHANGES = 4;
+
     /// Number of samples per property (spline => linear segments)
     static const uint32_t PROPERTY_SAMPLE_COUNT     = 64;
 
@@ -102,6 +106,24 @@ namespace dmParticle
         float       m_SourceAngularVelocity;
     };
 
+    /// Number of float streams in Emitter::m_SimulationData
+    static const uint32_t PARTICLE_STREAM_COUNT = 7;
+
+    /**
+     * Structure of arrays copy of the particle state the modifiers work on while simulating.
+     */
+    struct ParticleStreams
+    {
+        Particle*   m_Particles;
+        float*      m_PositionX;
+        float*      m_PositionY;
+        float*      m_PositionZ;
+        float*      m_VelocityX;
+        float*      m_VelocityY;
+        float*      m_VelocityZ;
+        float*      m_SpreadFactor;
+    };
+
     /**
      * Representation of an emitter.
      */
@@ -116,6 +138,8 @@ namespace dmParticle
         /// Particle buffer.
         dmArray<Particle>       m_Particles;
         dmArray<RenderConstant> m_RenderConstants;
+        /// Scratch memory for the ParticleStreams used while simulating (PARTICLE_STREAM_COUNT streams), and for sorting
+        dmArray<float>          m_SimulationData;
         dmVMath::Vector3        m_Velocity;
         dmVMath::Point3         m_LastPosition;
         dmhash_t                m_Id;
@@ -139,6 +163,9 @@ namespace dmParticle
         float                   m_StartDelay;
         /// Particle spawn rate spread, randomized on emitter creation and used for the duration of the emitter.
         float                   m_SpawnRateSpread;
+        /// State changes recorded while updating on a worker thread, reported on the main thread afterwards.
+        uint8_t                 m_PendingStates[MAX_PENDING_STATE_CHANGES];
+        uint8_t                 m_PendingStateCount;
         /// If the user has been warned that all particles cannot be rendered.
         uint16_t                m_RenderWarning : 1;
         /// If the user has been warned that the emitters animation could not be fetched
@@ -148,6 +175,8 @@ namespace dmParticle
         uint16_t                m_Retiring : 1;
         /// If this emitter needs to be rehashed
         uint16_t                m_ReHash : 1;
+        /// If state changes should be recorded instead of reported immediately
+        uint16_t                m_DeferStateChanges : 1;
     };
 
     struct Instance
@@ -182,6 +211,16 @@ namespace dmParticle
         uint16_t                m_ScaleAlongZ : 1;
     };
 
+    /**
+     * Emitter to update in a job during dmParticle::Update
+     */
+    struct EmitterUpdateJob
+    {
+        Instance*               m_Instance;
+        uint32_t                m_InstanceIndex;
+        uint32_t                m_EmitterIndex;
+    };
+
     /**
      * Representation of a context to hold a set of emitters.
      */
@@ -192,6 +231,7 @@ namespace dmParticle
         , m_MaxParticleCount(max_particle_count)
         , m_NextVersionNumber(1)
         , m_InstanceSeeding(0)
+        , m_JobThread(0)
         {
             memset(&m_Stats, 0, sizeof(m_Stats));
             m_Instances.SetCapacity(max_instance_count);
@@ -224,6 +264,10 @@ namespace dmParticle
         uint16_t            m_InstanceSeeding;
         /// Stats
         Stats               m_Stats;
+        /// Per frame list of emitters to update
+        dmArray<EmitterUpdateJob> m_EmitterJobs;
+        /// Job thread used to update the emitters in parallel (optional)
+        dmJobThread::HContext m_JobThread;
     };
 
     struct LinearSegment
@@ -18,10 +18,12 @@
 #include <algorithm>
 
 #include <dlib/dstrings.h>
+#include <dlib/job_thread.h>
 #include <dlib/log.h>
 #include <dlib/math.h>
 #include <dlib/vmath.h>
 #include <dlib/testutil.h>
+#include <dlib/thread.h>
 
 #include <ddf/ddf.h>
 
@@ -348,6 +350,47 @@ TEST_F(ParticleTest, CallbackCalledMultipleEmitters)
     dmParticle::DestroyInstance(m_Context, instance);
 }
 
+static dmThread::Thread g_CallbackThread;
+
+void EmitterStateChangedThreadCallback(uint32_t num_awake_emitters, dmhash_t emitter_id, dmParticle::EmitterState emitter_state, void* user_data)
+{
+    EmitterStateChangedCallback(num_awake_emitters, emitter_id, emitter_state, user_data);
+    if (dmThread::GetCurrentThread() != g_CallbackThread)
+        g_CallbackThread = 0;
+}
+
+/**
+* Verify emitter state change callbacks are called on the updating thread when the emitters are simulated in jobs
+*/
+TEST_F(ParticleTest, CallbackCalledMultipleEmittersJobThread)
+{
+    dmJobThread::JobThreadCreationParams job_thread_create_param;
+    job_thread_create_param.m_ThreadNames[0] = "TestParticleJobThread";
+    job_thread_create_param.m_ThreadCount    = 3;
+    dmJobThread::HContext job_thread = dmJobThread::Create(job_thread_create_param);
+    dmParticle::SetJobThread(m_Context, job_thread);
+    g_CallbackThread = dmThread::GetCurrentThread();
+
+    float dt = 1.2f;
+    EmitterStateChangedCallbackTestData* data = new (malloc(sizeof(EmitterStateChangedCallbackTestData))) EmitterStateChangedCallbackTestData();
+    m_CallbackData.m_StateChangedCallback = EmitterStateChangedThreadCallback;
+    m_CallbackData.m_UserData = (void*)data;
+    ASSERT_TRUE(LoadPrototype("once_three_emitters.particlefxc", &m_Prototype));
+    dmParticle::HInstance instance = dmParticle::CreateInstance(m_Context, m_Prototype, &m_CallbackData);
+    dmParticle::StartInstance(m_Context, instance); // Prespawn
+    dmParticle::Update(m_Context, dt, 0x0); // Spawning & Postspawn
+    dmParticle::Update(m_Context, dt, 0x0); // Sleeping
+    ASSERT_TRUE(data->m_CallbackWasCalled);
+    ASSERT_EQ(12U, data->m_NumStateChanges);
+    ASSERT_EQ(dmThread::GetCurrentThread(), g_CallbackThread);
+    ASSERT_EQ(0U, m_Context->m_Instances[instance & 0xffff]->m_NumAwakeEmitters);
+    ASSERT_TRUE(dmParticle::IsSleeping(m_Context, instance));
+    dmParticle::DestroyInstance(m_Context, instance);
+
+    dmParticle::SetJobThread(m_Context, 0);
+    dmJobThread::Destroy(job_thread);
+}
+
 /**
  * Verify creation/destruction, check leaks
  */
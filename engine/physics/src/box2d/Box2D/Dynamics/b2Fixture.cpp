@@ -223,6 +223,11 @@ void b2Fixture::SetFilterData(const b2Filter& filter, int32 index)
     Refilter(GetType() != b2Shape::e_grid);
 }
 
+void b2Fixture::SetFilterDataNoRefilter(const b2Filter& filter, int32 index)
+{
+    m_filters[index * m_shape->m_filterPerChild] = filter;
+}
+
 void b2Fixture::Refilter(bool touchProxies)
 {
 	if (m_body == NULL)
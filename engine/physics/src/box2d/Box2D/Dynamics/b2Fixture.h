@@ -130,6 +130,10 @@ public:
     // Defold modifications. Added index
 	void SetFilterData(const b2Filter& filter, int32 index);
 
+	// Defold modifications. Set the filtering data of a child without calling Refilter.
+	// Used when changing many children at once, call Refilter once afterwards.
+	void SetFilterDataNoRefilter(const b2Filter& filter, int32 index);
+
 	/// Get the contact filtering data.
 	// Defold modifications. Added index
 	const b2Filter& GetFilterData(int32 index) const;
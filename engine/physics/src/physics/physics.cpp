@@ -24,139 +24,162 @@
 
 namespace dmPhysics
 {
+    static inline uint32_t PairHash(void* object_a, void* object_b)
+    {
+        // Order independent, so that (a, b) and (b, a) end up in the same slot
+        uint64_t a = (uint64_t)(uintptr_t)object_a;
+        uint64_t b = (uint64_t)(uintptr_t)object_b;
+        uint64_t h = (a < b ? a : b) * 0x9E3779B97F4A7C15ULL ^ (a < b ? b : a);
+        h ^= h >> 29;
+        h *= 0xBF58476D1CE4E5B9ULL;
+        h ^= h >> 32;
+        return (uint32_t) h;
+    }
+
+    static inline bool PairMatches(const OverlapPair& pair, void* object_a, void* object_b)
+    {
+        return (pair.m_ObjectA == object_a && pair.m_ObjectB == object_b) || (pair.m_ObjectA == object_b && pair.m_ObjectB == object_a);
+    }
+
     /**
-     * Adds the overlap of an object to a specific entry.
-     * Returns whether the overlap was added (might be out of space).
+     * Returns the slot of the pair, or the empty slot where it should be inserted.
      */
-    static bool AddOverlap(OverlapEntry* entry, void* object, bool* out_found, const uint32_t trigger_overlap_capacity)
+    static uint32_t FindPairSlot(const OverlapCache* cache, void* object_a, void* object_b)
     {
-        bool found = false;
-        for (uint32_t i = 0; i < entry->m_OverlapCount; ++i)
-        {
-            Overlap& overlap = entry->m_Overlaps[i];
-            if (overlap.m_Object == object)
-            {
-                ++overlap.m_Count;
-                found = true;
-                break;
-            }
-        }
-        if (out_found != 0x0)
-            *out_found = found;
-        if (!found)
+        uint32_t mask = cache->m_Pairs.Size() - 1;
+        uint32_t i = PairHash(object_a, object_b) & mask;
+        while (cache->m_Pairs[i].m_ObjectA != 0x0 && !PairMatches(cache->m_Pairs[i], object_a, object_b))
         {
-            if (entry->m_OverlapCount == trigger_overlap_capacity)
-            {
-                dmLogError("Trigger overlap capacity reached, overlap will not be stored for enter/exit callbacks.");
-                return false;
-            }
-            else
-            {
-                Overlap& overlap = entry->m_Overlaps[entry->m_OverlapCount++];
-                overlap.m_Object = object;
-                overlap.m_Count = 1;
-            }
+            i = (i + 1) & mask;
         }
-        return true;
+        return i;
     }
 
-    /**
-     * Remove the overlap of an object from an entry.
-     */
-    static void RemoveOverlap(OverlapEntry* entry, void* object)
+    static void ResizePairs(OverlapCache* cache, uint32_t size)
     {
-        uint32_t count = entry->m_OverlapCount;
-        for (uint32_t i = 0; i < count; ++i)
+        dmArray<OverlapPair> old_pairs;
+        old_pairs.Swap(cache->m_Pairs);
+        cache->m_Pairs.SetCapacity(size);
+        cache->m_Pairs.SetSize(size);
+        memset(cache->m_Pairs.Begin(), 0, size * sizeof(OverlapPair));
+        for (uint32_t i = 0; i < old_pairs.Size(); ++i)
         {
-            Overlap& overlap = entry->m_Overlaps[i];
-            if (overlap.m_Object == object)
+            const OverlapPair& pair = old_pairs[i];
+            if (pair.m_ObjectA != 0x0)
             {
-                overlap = entry->m_Overlaps[count-1];
-                --entry->m_OverlapCount;
-                return;
+                cache->m_Pairs[FindPairSlot(cache, pair.m_ObjectA, pair.m_ObjectB)] = pair;
             }
         }
     }
 
-    /**
-     * Add the entry of two overlapping objects to the cache.
-     * Automatically creates the overlap, but is not symmetric.
-     */
-    static void AddEntry(OverlapCache* cache, void* object_a, void* user_data_a, void* object_b, uint16_t group_a)
+    static uint32_t GetOverlapCount(OverlapCache* cache, void* object)
+    {
+        uint32_t* count = cache->m_ObjectOverlapCounts.Get((uintptr_t)object);
+        return count ? *count : 0;
+    }
+
+    static void IncreaseOverlapCount(OverlapCache* cache, void* object)
     {
-        // Check if the cache needs to be expanded
-        uint32_t size = cache->m_OverlapCache.Size();
-        uint32_t capacity = cache->m_OverlapCache.Capacity();
-        // Expand when 80% full
-        if (size > 3 * capacity / 4)
+        uint32_t* count = cache->m_ObjectOverlapCounts.Get((uintptr_t)object);
+        if (count)
+        {
+            ++*count;
+            return;
+        }
+        if (cache->m_ObjectOverlapCounts.Full())
         {
-            capacity += CACHE_EXPANSION;
-            cache->m_OverlapCache.SetCapacity(3 * capacity / 4, capacity);
+            uint32_t capacity = cache->m_ObjectOverlapCounts.Capacity() * 2;
+            cache->m_ObjectOverlapCounts.SetCapacity(3 * capacity / 4, capacity);
         }
-        OverlapEntry entry;
-        memset(&entry, 0, sizeof(entry));
-        entry.m_Overlaps = (Overlap*)malloc(cache->m_TriggerOverlapCapacity * sizeof(Overlap));
-        entry.m_UserData = user_data_a;
-        entry.m_Group = group_a;
-        // Add overlap to the entry
-        AddOverlap(&entry, object_b, 0x0, cache->m_TriggerOverlapCapacity);
-        // Add the entry
-        cache->m_OverlapCache.Put((uintptr_t)object_a, entry);
+        cache->m_ObjectOverlapCounts.Put((uintptr_t)object, 1);
     }
 
-    void OverlapCacheInit(OverlapCache* cache)
+    static void DecreaseOverlapCount(OverlapCache* cache, void* object)
     {
-        cache->m_OverlapCache.SetCapacity(3 * CACHE_INITIAL_CAPACITY / 4, CACHE_INITIAL_CAPACITY);
+        uint32_t* count = cache->m_ObjectOverlapCounts.Get((uintptr_t)object);
+        if (count && --*count == 0)
+        {
+            cache->m_ObjectOverlapCounts.Erase((uintptr_t)object);
+        }
     }
 
     /**
-     * Sets an overlap to have 0 count, used to iterate the hash table from reset.
+     * Removes the pair at a slot, and shifts the following pairs of the probe sequence back into the hole
+     * so that no tombstones are needed. Pairs after the slot may end up in the slot itself.
      */
-    static void ResetOverlap(void* context, const uintptr_t* key, OverlapEntry* value)
+    static void RemovePairAt(OverlapCache* cache, uint32_t index)
     {
-        uint32_t count = value->m_OverlapCount;
-        for (uint32_t i = 0; i < count; ++i)
+        OverlapPair* pairs = cache->m_Pairs.Begin();
+        DecreaseOverlapCount(cache, pairs[index].m_ObjectA);
+        DecreaseOverlapCount(cache, pairs[index].m_ObjectB);
+
+        uint32_t mask = cache->m_Pairs.Size() - 1;
+        uint32_t hole = index;
+        uint32_t i = (index + 1) & mask;
+        while (pairs[i].m_ObjectA != 0x0)
         {
-            value->m_Overlaps[i].m_Count = 0;
+            uint32_t home = PairHash(pairs[i].m_ObjectA, pairs[i].m_ObjectB) & mask;
+            // The pair can fill the hole if the hole is between its home slot and its current slot
+            if (((i - home) & mask) >= ((i - hole) & mask))
+            {
+                pairs[hole] = pairs[i];
+                hole = i;
+            }
+            i = (i + 1) & mask;
         }
+        memset(&pairs[hole], 0, sizeof(OverlapPair));
+        --cache->m_PairCount;
+    }
+
+    void OverlapCacheInit(OverlapCache* cache)
+    {
+        ResizePairs(cache, CACHE_INITIAL_CAPACITY);
+        cache->m_ObjectOverlapCounts.SetCapacity(3 * CACHE_INITIAL_CAPACITY / 4, CACHE_INITIAL_CAPACITY);
     }
 
     void OverlapCacheReset(OverlapCache* cache)
     {
-        cache->m_OverlapCache.Iterate(ResetOverlap, (void*)0x0);
+        ++cache->m_Generation;
     }
 
     void OverlapCacheAdd(OverlapCache* cache, const OverlapCacheAddData& data)
     {
-        bool found = false;
-        OverlapEntry* entry_a = cache->m_OverlapCache.Get((uintptr_t)data.m_ObjectA);
-        if (entry_a != 0x0)
+        uint32_t slot = FindPairSlot(cache, data.m_ObjectA, data.m_ObjectB);
+        OverlapPair* pair = &cache->m_Pairs[slot];
+        if (pair->m_ObjectA != 0x0)
         {
-            if (!AddOverlap(entry_a, data.m_ObjectB, &found, cache->m_TriggerOverlapCapacity))
-            {
-                // The overlap could not be added to entry_a, bail out
-                return;
-            }
+            pair->m_Generation = cache->m_Generation;
+            return;
         }
-        OverlapEntry* entry_b = cache->m_OverlapCache.Get((uintptr_t)data.m_ObjectB);
-        if (entry_b != 0x0)
+
+        if (GetOverlapCount(cache, data.m_ObjectA) >= cache->m_TriggerOverlapCapacity ||
+            GetOverlapCount(cache, data.m_ObjectB) >= cache->m_TriggerOverlapCapacity)
         {
-            if (!AddOverlap(entry_b, data.m_ObjectA, &found, cache->m_TriggerOverlapCapacity))
-            {
-                // No space in entry_b, clean up entry_a
-                if (entry_a != 0x0)
-                    RemoveOverlap(entry_a, data.m_ObjectB);
-                // Bail out
-                return;
-            }
+            dmLogError("Trigger overlap capacity reached, overlap will not be stored for enter/exit callbacks.");
+            return;
+        }
+
+        // Keep the table at most 75% full
+        if (4 * (cache->m_PairCount + 1) > 3 * cache->m_Pairs.Size())
+        {
+            ResizePairs(cache, cache->m_Pairs.Size() * 2);
+            slot = FindPairSlot(cache, data.m_ObjectA, data.m_ObjectB);
+            pair = &cache->m_Pairs[slot];
         }
-        // Add entries for previously unrecorded objects
-        if (entry_a == 0x0)
-            AddEntry(cache, data.m_ObjectA, data.m_UserDataA, data.m_ObjectB, data.m_GroupA);
-        if (entry_b == 0x0)
-            AddEntry(cache, data.m_ObjectB, data.m_UserDataB, data.m_ObjectA, data.m_GroupB);
+
+        pair->m_ObjectA = data.m_ObjectA;
+        pair->m_ObjectB = data.m_ObjectB;
+        pair->m_UserDataA = data.m_UserDataA;
+        pair->m_UserDataB = data.m_UserDataB;
+        pair->m_GroupA = data.m_GroupA;
+        pair->m_GroupB = data.m_GroupB;
+        pair->m_Generation = cache->m_Generation;
+        ++cache->m_PairCount;
+        IncreaseOverlapCount(cache, data.m_ObjectA);
+        IncreaseOverlapCount(cache, data.m_ObjectB);
+
         // Callback for newly added overlaps
-        if (!found && data.m_TriggerEnteredCallback != 0x0)
+        if (data.m_TriggerEnteredCallback != 0x0)
         {
             TriggerEnter enter;
             enter.m_UserDataA = data.m_UserDataA;
@@ -169,67 +192,44 @@ namespace dmPhysics
 
     void OverlapCacheRemove(OverlapCache* cache, void* object)
     {
-        OverlapEntry* entry = cache->m_OverlapCache.Get((uintptr_t)object);
-        if (entry != 0x0)
+        uint32_t remaining = GetOverlapCount(cache, object);
+        uint32_t i = 0;
+        while (remaining > 0 && i < cache->m_Pairs.Size())
         {
-            // Remove back-references to the object from others
-            for (uint32_t i = 0; i < entry->m_OverlapCount; ++i)
+            const OverlapPair& pair = cache->m_Pairs[i];
+            if (pair.m_ObjectA == object || pair.m_ObjectB == object)
             {
-                Overlap& overlap = entry->m_Overlaps[i];
-                OverlapEntry* entry2 = cache->m_OverlapCache.Get((uintptr_t)overlap.m_Object);
-                if (entry2 != 0x0)
-                {
-                    RemoveOverlap(entry2, object);
-                }
+                // Another pair may have been shifted into this slot, so check it again
+                RemovePairAt(cache, i);
+                --remaining;
+            }
+            else
+            {
+                ++i;
             }
-            // Remove the object from the cache
-            cache->m_OverlapCache.Erase((uintptr_t)object);
-            free(entry->m_Overlaps);
         }
     }
 
-    /**
-     * Context when iterating entries to prune them
-     */
-    struct PruneContext
-    {
-        TriggerExitedCallback m_Callback;
-        void* m_UserData;
-        OverlapCache* m_Cache;
-    };
-
-    /**
-     * Prunes an entry, used to iterate the cache when pruning.
-     */
-    static void PruneOverlap(PruneContext* context, const uintptr_t* key, OverlapEntry* value)
+    void OverlapCachePrune(OverlapCache* cache, const OverlapCachePruneData& data)
     {
-        TriggerExitedCallback callback = context->m_Callback;
-        void* user_data = context->m_UserData;
-        OverlapCache* cache = context->m_Cache;
-        void* object_a = (void*)*key;
         uint32_t i = 0;
-        // Iterate overlaps
-        while (i < value->m_OverlapCount)
+        while (i < cache->m_Pairs.Size())
         {
-            Overlap& overlap = value->m_Overlaps[i];
-            // Condition to prune: no registered contacts
-            if (overlap.m_Count == 0)
+            const OverlapPair& pair = cache->m_Pairs[i];
+            // Condition to prune: not seen during this step
+            if (pair.m_ObjectA != 0x0 && pair.m_Generation != cache->m_Generation)
             {
-                OverlapEntry* entry = cache->m_OverlapCache.Get((uintptr_t)overlap.m_Object);
-                // Trigger exit callback
-                if (callback != 0x0)
+                if (data.m_TriggerExitedCallback != 0x0)
                 {
-                    TriggerExit data;
-                    data.m_UserDataA = value->m_UserData;
-                    data.m_UserDataB = entry->m_UserData;
-                    data.m_GroupA = value->m_Group;
-                    data.m_GroupB = entry->m_Group;
-                    callback(data, user_data);
+                    TriggerExit exit;
+                    exit.m_UserDataA = pair.m_UserDataA;
+                    exit.m_UserDataB = pair.m_UserDataB;
+                    exit.m_GroupA = pair.m_GroupA;
+                    exit.m_GroupB = pair.m_GroupB;
+                    data.m_TriggerExitedCallback(exit, data.m_TriggerExitedUserData);
                 }
-                RemoveOverlap(entry, object_a);
-
-                overlap = value->m_Overlaps[value->m_OverlapCount-1];
-                --value->m_OverlapCount;
+                // Another pair may have been shifted into this slot, so check it again
+                RemovePairAt(cache, i);
             }
             else
             {
@@ -237,13 +237,4 @@ namespace dmPhysics
             }
         }
     }
-
-    void OverlapCachePrune(OverlapCache* cache, const OverlapCachePruneData& data)
-    {
-        PruneContext context;
-        context.m_Callback = data.m_TriggerExitedCallback;
-        context.m_UserData = data.m_TriggerExitedUserData;
-        context.m_Cache = cache;
-        cache->m_OverlapCache.Iterate(PruneOverlap, &context);
-    }
 }
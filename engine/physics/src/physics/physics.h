@@ -20,6 +20,7 @@
 #include <dmsdk/dlib/vmath.h>
 
 #include <dlib/hash.h>
+#include <dlib/job_thread.h>
 #include <dlib/message.h>
 #include <dlib/transform.h>
 
@@ -247,6 +248,12 @@ namespace dmPhysics
         uint32_t m_RayCastLimit3D;
         /// Maximum number of overlapping triggers
         uint32_t m_TriggerOverlapCapacity;
+        /// Job thread to split the ray casts of a step over (default 0, the ray casts are done serially)
+        dmJobThread::HContext m_JobThread;
+        /// Size of the square regions the 2D worlds are partitioned into (default 0, the worlds aren't partitioned)
+        float m_RegionSize2D;
+        /// Number of regions around the focus region that are simulated, in each direction
+        uint32_t m_RegionRadius2D;
         /// If true, the collision objects will retrieve the position of its game object
         uint8_t m_AllowDynamicTransforms:1;
         uint8_t :7;
@@ -548,6 +555,25 @@ namespace dmPhysics
                                   uint32_t shape, uint32_t child,
                                   uint16_t group, uint16_t mask);
 
+    /**
+     * Set group and mask for collision object without flagging its existing contacts for filtering.
+     * Used when changing many grid shape cells at once, call RefilterCollisionObject2D once afterwards.
+     * @param collision_object collsion object
+     * @param shape shape index.
+     * @param child sub-shape index
+     * @param group group to set
+     * @param mask mask to set
+     */
+    void SetCollisionObjectFilterDeferred(HCollisionObject2D collision_object,
+                                          uint32_t shape, uint32_t child,
+                                          uint16_t group, uint16_t mask);
+
+    /**
+     * Flag the contacts of a collision object for filtering in the next step.
+     * @param collision_object collsion object
+     */
+    void RefilterCollisionObject2D(HCollisionObject2D collision_object);
+
     /**
      * Delete a 3D shape
      *
@@ -1178,6 +1204,57 @@ namespace dmPhysics
      */
     void RayCast2D(HWorld2D world, const RayCastRequest& request, dmArray<RayCastResponse>& results);
 
+    /**
+     * Synchronously find all collision objects overlapping an axis aligned box in a 3D world
+     *
+     * @param world Physics world in which to perform the query
+     * @param min Minimum corner of the box
+     * @param max Maximum corner of the box
+     * @param mask Bit field to filter out collision objects of the corresponding groups
+     * @param results Array receiving the user data of each overlapping collision object, once per object. The array is cleared before the query.
+     * @note The overlap test is done against the bounding boxes of the collision objects
+     * @note The result array may grow during the call
+     */
+    void QueryAABB3D(HWorld3D world, const dmVMath::Point3& min, const dmVMath::Point3& max, uint16_t mask, dmArray<void*>& results);
+
+    /**
+     * Synchronously find all collision objects overlapping an axis aligned box in a 2D world
+     *
+     * @param world Physics world in which to perform the query
+     * @param min Minimum corner of the box (z component will be ignored)
+     * @param max Maximum corner of the box (z component will be ignored)
+     * @param mask Bit field to filter out collision objects of the corresponding groups
+     * @param results Array receiving the user data of each overlapping collision object, once per object. The array is cleared before the query.
+     * @note The overlap test is done against the bounding boxes of the collision objects
+     * @note The result array may grow during the call
+     */
+    void QueryAABB2D(HWorld2D world, const dmVMath::Point3& min, const dmVMath::Point3& max, uint16_t mask, dmArray<void*>& results);
+
+    /**
+     * Synchronously find all collision objects overlapping a sphere in a 3D world
+     *
+     * @param world Physics world in which to perform the query
+     * @param center Center of the sphere
+     * @param radius Radius of the sphere
+     * @param mask Bit field to filter out collision objects of the corresponding groups
+     * @param results Array receiving the user data of each overlapping collision object, once per object. The array is cleared before the query.
+     * @note The result array may grow during the call
+     */
+    void QuerySphere3D(HWorld3D world, const dmVMath::Point3& center, float radius, uint16_t mask, dmArray<void*>& results);
+
+    /**
+     * Synchronously find all collision objects overlapping a circle in a 2D world
+     *
+     * @param world Physics world in which to perform the query
+     * @param center Center of the circle (z component will be ignored)
+     * @param radius Radius of the circle
+     * @param mask Bit field to filter out collision objects of the corresponding groups
+     * @param results Array receiving the user data of each overlapping collision object, once per object. The array is cleared before the query.
+     * @note Tile grid cells are tested with their bounding boxes
+     * @note The result array may grow during the call
+     */
+    void QueryCircle2D(HWorld2D world, const dmVMath::Point3& center, float radius, uint16_t mask, dmArray<void*>& results);
+
     /**
      * Set the gravity for a 2D physics world.
      *
@@ -1201,6 +1278,25 @@ namespace dmPhysics
      */
     dmVMath::Vector3 GetGravity2D(HWorld2D world);
 
+    /**
+     * Set the focus of a partitioned 2D physics world, usually the position of the player. Collision objects
+     * outside of the regions within the region radius of the focus are frozen in place: they are removed
+     * from the broadphase and aren't stepped, until they are within the radius again.
+     * Does nothing if the context wasn't created with a region size. Before the first call, all regions are simulated.
+     *
+     * @param world Physics world
+     * @param position Focus position
+     */
+    void SetRegionFocus2D(HWorld2D world, const dmVMath::Point3& position);
+
+    /**
+     * Get the number of collision objects that are frozen since they are outside of the simulated regions.
+     *
+     * @param world Physics world
+     * @return the number of frozen collision objects
+     */
+    uint32_t GetFrozenCollisionObjectCount2D(HWorld2D world);
+
     /**
      * Get the gravity for 3D physics world.
      *
@@ -36,12 +36,15 @@ namespace dmPhysics
     , m_DebugCallbacks()
     , m_Gravity(0.0f, -10.0f)
     , m_Socket(0)
+    , m_JobThread(0)
     , m_Scale(1.0f)
     , m_InvScale(1.0f)
     , m_ContactImpulseLimit(0.0f)
     , m_TriggerEnterLimit(0.0f)
     , m_RayCastLimit(0)
     , m_TriggerOverlapCapacity(0)
+    , m_RegionSize(0.0f)
+    , m_RegionRadius(0)
     , m_AllowDynamicTransforms(0)
     {
 
@@ -56,10 +59,22 @@ namespace dmPhysics
     , m_ContactListener(this)
     , m_GetWorldTransformCallback(params.m_GetWorldTransformCallback)
     , m_SetWorldTransformCallback(params.m_SetWorldTransformCallback)
+    , m_FocusRegionX(0)
+    , m_FocusRegionY(0)
+    , m_RegionUpdateCountdown(0)
     , m_AllowDynamicTransforms(context->m_AllowDynamicTransforms)
+    , m_HasRegionFocus(0)
+    , m_RegionsDirty(0)
     {
         m_RayCastRequests.SetCapacity(context->m_RayCastLimit);
+        m_RayCastResponses.SetCapacity(context->m_RayCastLimit);
         OverlapCacheInit(&m_TriggerOverlaps);
+        if (context->m_RegionSize > 0.0f && params.m_MaxCollisionObjectsCount > 0)
+        {
+            uint32_t capacity = params.m_MaxCollisionObjectsCount;
+            m_FrozenBodies.SetCapacity(capacity);
+            m_FrozenBodyIndices.SetCapacity(dmMath::Max(1U, capacity / 2), capacity);
+        }
     }
 
     class ProcessRayCastResultCallback2D : public b2RayCastCallback
@@ -132,6 +147,35 @@ namespace dmPhysics
             return -1.f;
     }
 
+    // Processes the ray cast requests [start, end) into the matching responses.
+    // The world is only read here, which makes it safe to process several ranges in parallel after the step.
+    static void ProcessRayCasts2D(HWorld2D world, uint32_t start, uint32_t end)
+    {
+        float scale = world->m_Context->m_Scale;
+        ProcessRayCastResultCallback2D callback;
+        callback.m_Context = world->m_Context;
+        for (uint32_t i = start; i < end; ++i)
+        {
+            const RayCastRequest& request = world->m_RayCastRequests[i];
+            b2Vec2 from;
+            ToB2(request.m_From, from, scale);
+            b2Vec2 to;
+            ToB2(request.m_To, to, scale);
+            callback.m_IgnoredUserData = request.m_IgnoredUserData;
+            callback.m_CollisionMask = request.m_Mask;
+            callback.m_Response.m_Hit = 0;
+            world->m_World.RayCast(&callback, from, to);
+            world->m_RayCastResponses[i] = callback.m_Response;
+        }
+    }
+
+    static int RayCastJobProcess2D(void* context, void* data)
+    {
+        RayCastJob* job = (RayCastJob*) data;
+        ProcessRayCasts2D((HWorld2D) context, job->m_Start, job->m_End);
+        return 0;
+    }
+
     ContactListener::ContactListener(HWorld2D world)
     : m_World(world)
     {
@@ -218,9 +262,12 @@ namespace dmPhysics
         context->m_ContactImpulseLimit = params.m_ContactImpulseLimit * params.m_Scale;
         context->m_TriggerEnterLimit = params.m_TriggerEnterLimit * params.m_Scale;
         context->m_RayCastLimit = params.m_RayCastLimit2D;
+        context->m_JobThread = params.m_JobThread;
         context->m_TriggerOverlapCapacity = params.m_TriggerOverlapCapacity;
         context->m_VelocityThreshold = params.m_VelocityThreshold;
         context->m_AllowDynamicTransforms = params.m_AllowDynamicTransforms;
+        context->m_RegionSize = dmMath::Max(0.0f, params.m_RegionSize2D);
+        context->m_RegionRadius = params.m_RegionRadius2D;
         b2ContactSolver::setVelocityThreshold(params.m_VelocityThreshold * params.m_Scale); // overrides fixed b2_velocityThreshold in b2Settings.h. Includes compensation for the scale factor so that velocityThreshold corresponds to the velocity values used in the game.
         dmMessage::Result result = dmMessage::NewSocket(PHYSICS_SOCKET_NAME, &context->m_Socket);
         if (result != dmMessage::RESULT_OK)
@@ -417,10 +464,161 @@ namespace dmPhysics
         }
     }
 
+    // Regions
+    //
+    // A partitioned world only simulates the bodies that overlap the regions within the region radius of the focus.
+    // The other bodies are frozen: they are deactivated, which removes them from the broadphase and the contact
+    // manager, and keeps their velocities until they are activated again. The bodies disabled by the user are
+    // inactive too, but never frozen.
+    // The bodies are checked when the focus moves to another region, and every REGION_UPDATE_INTERVAL steps
+    // since they may also leave (or, for kinematic bodies, enter) the simulated regions on their own.
+
+    static const uint32_t REGION_UPDATE_INTERVAL = 30;
+
+    static inline int32_t GetRegion(float position, float region_size)
+    {
+        return (int32_t) floorf(position / region_size);
+    }
+
+    static b2AABB GetBodyAABB(b2Body* body)
+    {
+        b2AABB aabb;
+        aabb.lowerBound = body->GetPosition();
+        aabb.upperBound = aabb.lowerBound;
+        // The fixture proxies are only valid for active bodies
+        for (b2Fixture* fixture = body->GetFixtureList(); fixture; fixture = fixture->GetNext())
+        {
+            int32 child_count = fixture->GetShape()->GetChildCount();
+            for (int32 i = 0; i < child_count; ++i)
+            {
+                aabb.Combine(fixture->GetAABB(i));
+            }
+        }
+        return aabb;
+    }
+
+    static inline bool Overlaps(const b2AABB& aabb, const b2Vec2& offset, const b2AABB& region)
+    {
+        return aabb.lowerBound.x + offset.x <= region.upperBound.x && aabb.upperBound.x + offset.x >= region.lowerBound.x &&
+               aabb.lowerBound.y + offset.y <= region.upperBound.y && aabb.upperBound.y + offset.y >= region.lowerBound.y;
+    }
+
+    static inline bool IsFrozen(HWorld2D world, b2Body* body)
+    {
+        return !world->m_FrozenBodies.Empty() && world->m_FrozenBodyIndices.Get((uintptr_t) body) != 0x0;
+    }
+
+    static void FreezeBody(HWorld2D world, b2Body* body)
+    {
+        FrozenBody2D frozen;
+        frozen.m_Body = body;
+        frozen.m_AABB = GetBodyAABB(body);
+        frozen.m_Position = body->GetPosition();
+        body->SetActive(false);
+
+        if (world->m_FrozenBodies.Full())
+            world->m_FrozenBodies.OffsetCapacity(dmMath::Max(16U, world->m_FrozenBodies.Capacity() / 2));
+        if (world->m_FrozenBodyIndices.Full())
+        {
+            uint32_t capacity = world->m_FrozenBodyIndices.Capacity() + dmMath::Max(16U, world->m_FrozenBodyIndices.Capacity() / 2);
+            world->m_FrozenBodyIndices.SetCapacity(dmMath::Max(1U, capacity / 2), capacity);
+        }
+        world->m_FrozenBodyIndices.Put((uintptr_t) body, world->m_FrozenBodies.Size());
+        world->m_FrozenBodies.Push(frozen);
+    }
+
+    // Removes the body from the frozen bodies, without activating it
+    static void RemoveFrozenBody(HWorld2D world, uint32_t index)
+    {
+        dmArray<FrozenBody2D>& frozen_bodies = world->m_FrozenBodies;
+        world->m_FrozenBodyIndices.Erase((uintptr_t) frozen_bodies[index].m_Body);
+        frozen_bodies.EraseSwap(index);
+        if (index < frozen_bodies.Size())
+        {
+            world->m_FrozenBodyIndices.Put((uintptr_t) frozen_bodies[index].m_Body, index);
+        }
+    }
+
+    static bool RemoveFrozenBody(HWorld2D world, b2Body* body)
+    {
+        if (world->m_FrozenBodies.Empty())
+            return false;
+        uint32_t* index = world->m_FrozenBodyIndices.Get((uintptr_t) body);
+        if (!index)
+            return false;
+        RemoveFrozenBody(world, *index);
+        return true;
+    }
+
+    static void UpdateRegions2D(HWorld2D world)
+    {
+        DM_PROFILE("UpdateRegions");
+        HContext2D context = world->m_Context;
+        float region_size = context->m_RegionSize * context->m_Scale;
+        int32_t radius = (int32_t) context->m_RegionRadius;
+        b2AABB region;
+        region.lowerBound.Set((world->m_FocusRegionX - radius) * region_size, (world->m_FocusRegionY - radius) * region_size);
+        region.upperBound.Set((world->m_FocusRegionX + radius + 1) * region_size, (world->m_FocusRegionY + radius + 1) * region_size);
+
+        // Frozen kinematic bodies still follow their game objects, see StepWorld2D()
+        for (uint32_t i = world->m_FrozenBodies.Size(); i > 0; --i)
+        {
+            FrozenBody2D& frozen = world->m_FrozenBodies[i - 1];
+            b2Vec2 offset = frozen.m_Body->GetPosition() - frozen.m_Position;
+            if (Overlaps(frozen.m_AABB, offset, region))
+            {
+                b2Body* body = frozen.m_Body;
+                RemoveFrozenBody(world, i - 1);
+                body->SetActive(true);
+            }
+        }
+
+        for (b2Body* body = world->m_World.GetBodyList(); body; body = body->GetNext())
+        {
+            if (!body->IsActive())
+                continue;
+            if (!Overlaps(GetBodyAABB(body), b2Vec2(0.0f, 0.0f), region))
+            {
+                FreezeBody(world, body);
+            }
+        }
+    }
+
+    void SetRegionFocus2D(HWorld2D world, const Point3& position)
+    {
+        float region_size = world->m_Context->m_RegionSize;
+        if (region_size <= 0.0f)
+            return;
+        int32_t x = GetRegion(position.getX(), region_size);
+        int32_t y = GetRegion(position.getY(), region_size);
+        if (!world->m_HasRegionFocus || x != world->m_FocusRegionX || y != world->m_FocusRegionY)
+        {
+            world->m_FocusRegionX = x;
+            world->m_FocusRegionY = y;
+            world->m_HasRegionFocus = 1;
+            world->m_RegionsDirty = 1;
+        }
+    }
+
+    uint32_t GetFrozenCollisionObjectCount2D(HWorld2D world)
+    {
+        return world->m_FrozenBodies.Size();
+    }
+
     void StepWorld2D(HWorld2D world, const StepWorldContext& step_context)
     {
         float dt = step_context.m_DT;
         HContext2D context = world->m_Context;
+        if (world->m_HasRegionFocus)
+        {
+            if (world->m_RegionsDirty || world->m_RegionUpdateCountdown == 0)
+            {
+                UpdateRegions2D(world);
+                world->m_RegionsDirty = 0;
+                world->m_RegionUpdateCountdown = REGION_UPDATE_INTERVAL;
+            }
+            --world->m_RegionUpdateCountdown;
+        }
         float scale = context->m_Scale;
         // Epsilon defining what transforms are considered noise and not
         // Values are picked by inspection, current rot value is roughly equivalent to 1 degree
@@ -475,11 +673,13 @@ namespace dmPhysics
             world->m_World.Step(dt, 10, 10);
             float inv_scale = world->m_Context->m_InvScale;
             // Update transforms of dynamic bodies
+            // Sleeping bodies haven't moved, so writing them back would only dirty their game objects.
+            // This matches Bullet, which only synchronizes the motion states of active bodies.
             if (world->m_SetWorldTransformCallback)
             {
                 for (b2Body* body = world->m_World.GetBodyList(); body; body = body->GetNext())
                 {
-                    if (body->GetType() == b2_dynamicBody && body->IsActive())
+                    if (body->GetType() == b2_dynamicBody && body->IsActive() && body->IsAwake())
                     {
                         Point3 position;
                         FromB2(body->GetPosition(), position, inv_scale);
@@ -494,20 +694,34 @@ namespace dmPhysics
         if (size > 0)
         {
             DM_PROFILE("RayCasts");
-            ProcessRayCastResultCallback2D callback;
-            callback.m_Context = world->m_Context;
+            world->m_RayCastResponses.SetSize(size);
+            if (context->m_JobThread && size > RAY_CAST_JOB_BATCH_SIZE)
+            {
+                uint32_t job_count = (size + RAY_CAST_JOB_BATCH_SIZE - 1) / RAY_CAST_JOB_BATCH_SIZE;
+                if (world->m_RayCastJobs.Capacity() < job_count)
+                    world->m_RayCastJobs.SetCapacity(job_count);
+                world->m_RayCastJobs.SetSize(job_count);
+
+                dmJobThread::JobGroup group;
+                dmJobThread::InitGroup(&group, 0);
+                for (uint32_t i = 0; i < job_count; ++i)
+                {
+                    RayCastJob* job = &world->m_RayCastJobs[i];
+                    job->m_Start = i * RAY_CAST_JOB_BATCH_SIZE;
+                    job->m_End = dmMath::Min(job->m_Start + RAY_CAST_JOB_BATCH_SIZE, size);
+                    dmJobThread::PushGroupJob(context->m_JobThread, &group, RayCastJobProcess2D, (void*) world, (void*) job);
+                }
+                dmJobThread::WaitGroup(context->m_JobThread, &group);
+            }
+            else
+            {
+                ProcessRayCasts2D(world, 0, size);
+            }
+
+            // The responses are reported in request order, on the calling thread
             for (uint32_t i = 0; i < size; ++i)
             {
-                RayCastRequest& request = world->m_RayCastRequests[i];
-                b2Vec2 from;
-                ToB2(request.m_From, from, scale);
-                b2Vec2 to;
-                ToB2(request.m_To, to, scale);
-                callback.m_IgnoredUserData = request.m_IgnoredUserData;
-                callback.m_CollisionMask = request.m_Mask;
-                callback.m_Response.m_Hit = 0;
-                world->m_World.RayCast(&callback, from, to);
-                (*step_context.m_RayCastCallback)(callback.m_Response, request, step_context.m_RayCastUserData);
+                (*step_context.m_RayCastCallback)(world->m_RayCastResponses[i], world->m_RayCastRequests[i], step_context.m_RayCastUserData);
             }
             world->m_RayCastRequests.SetSize(0);
         }
@@ -731,6 +945,27 @@ namespace dmPhysics
         fixture->SetFilterData(filter, child);
     }
 
+    void SetCollisionObjectFilterDeferred(HCollisionObject2D collision_shape,
+                                          uint32_t shape, uint32_t child,
+                                          uint16_t group, uint16_t mask)
+    {
+        b2Fixture* fixture = GetFixture((b2Body*) collision_shape, shape);
+        b2Filter filter = fixture->GetFilterData(child);
+        filter.categoryBits = group;
+        filter.maskBits = mask;
+        fixture->SetFilterDataNoRefilter(filter, child);
+    }
+
+    void RefilterCollisionObject2D(HCollisionObject2D collision_object)
+    {
+        b2Body* body = (b2Body*) collision_object;
+        for (b2Fixture* fixture = body->GetFixtureList(); fixture; fixture = fixture->GetNext())
+        {
+            // Same as SetFilterData, grids don't touch their proxies
+            fixture->Refilter(fixture->GetType() != b2Shape::e_grid);
+        }
+    }
+
     void DeleteCollisionShape2D(HCollisionShape2D shape)
     {
         delete (b2Shape*)shape;
@@ -1004,6 +1239,7 @@ namespace dmPhysics
 
         OverlapCacheRemove(&world->m_TriggerOverlaps, collision_object);
         b2Body* body = (b2Body*)collision_object;
+        RemoveFrozenBody(world, body);
         b2Fixture* fixture = body->GetFixtureList();
         while (fixture)
         {
@@ -1184,6 +1420,15 @@ namespace dmPhysics
     void SetEnabled2D(HWorld2D world, HCollisionObject2D collision_object, bool enabled)
     {
         DM_PROFILE("SetEnabled2D");
+        // A frozen body is enabled, but outside of the simulated regions
+        if (IsFrozen(world, (b2Body*)collision_object))
+        {
+            if (enabled)
+                return;
+            RemoveFrozenBody(world, (b2Body*)collision_object);
+            ((b2Body*)collision_object)->SetAwake(false);
+            return;
+        }
         bool prev_enabled = IsEnabled2D(collision_object);
         // Avoid multiple adds/removes
         if (prev_enabled == enabled)
@@ -1420,6 +1665,102 @@ namespace dmPhysics
         }
     }
 
+    // Queries the broad phase directly (instead of b2World::QueryAABB) since the child index is needed
+    // to get the filter data and shape of tile grid cells.
+    struct SpatialQueryCallback2D
+    {
+        bool QueryCallback(int32 proxy_id)
+        {
+            const b2FixtureProxy* proxy = (const b2FixtureProxy*)m_BroadPhase->GetUserData(proxy_id);
+            const b2Fixture* fixture = proxy->fixture;
+            int32 index = proxy->childIndex;
+            if (!(fixture->GetFilterData(index).categoryBits & m_CollisionMask))
+                return true;
+            // The tree stores fattened boxes
+            if (!b2TestOverlap(proxy->aabb, m_AABB))
+                return true;
+            if (m_Circle)
+            {
+                const b2Shape* shape = fixture->GetShape();
+                if (shape->GetType() == b2Shape::e_grid)
+                {
+                    // Grid cells have no vertices outside of their contacts, test against the cell bounds instead
+                    b2Vec2 closest = b2Clamp(m_Circle->m_p, proxy->aabb.lowerBound, proxy->aabb.upperBound);
+                    if (b2DistanceSquared(closest, m_Circle->m_p) > m_Circle->m_radius * m_Circle->m_radius)
+                        return true;
+                }
+                else
+                {
+                    b2Transform identity;
+                    identity.SetIdentity();
+                    if (!b2TestOverlap(m_Circle, 0, shape, index, identity, fixture->GetBody()->GetTransform()))
+                        return true;
+                }
+            }
+
+            // Bodies with several fixtures, or grids with several cells, are reported once
+            void* user_data = fixture->GetBody()->GetUserData();
+            for (uint32_t i = m_Results->Size(); i > 0; --i)
+            {
+                if ((*m_Results)[i-1] == user_data)
+                    return true;
+            }
+            if (m_Results->Full())
+                m_Results->OffsetCapacity(32);
+            m_Results->Push(user_data);
+            return true;
+        }
+
+        const b2BroadPhase*     m_BroadPhase;
+        const b2CircleShape*    m_Circle;
+        dmArray<void*>*         m_Results;
+        b2AABB                  m_AABB;
+        uint16_t                m_CollisionMask;
+    };
+
+    static void SpatialQuery2D(HWorld2D world, const b2AABB& aabb, const b2CircleShape* circle, uint16_t mask, dmArray<void*>& results)
+    {
+        results.SetSize(0);
+
+        SpatialQueryCallback2D callback;
+        callback.m_BroadPhase = &world->m_World.GetContactManager().m_broadPhase;
+        callback.m_Circle = circle;
+        callback.m_Results = &results;
+        callback.m_AABB = aabb;
+        callback.m_CollisionMask = mask;
+        callback.m_BroadPhase->Query(&callback, aabb);
+    }
+
+    void QueryAABB2D(HWorld2D world, const Point3& min, const Point3& max, uint16_t mask, dmArray<void*>& results)
+    {
+        DM_PROFILE("QueryAABB2D");
+
+        float scale = world->m_Context->m_Scale;
+        b2Vec2 a;
+        ToB2(min, a, scale);
+        b2Vec2 b;
+        ToB2(max, b, scale);
+        b2AABB aabb;
+        aabb.lowerBound = b2Min(a, b);
+        aabb.upperBound = b2Max(a, b);
+        SpatialQuery2D(world, aabb, 0x0, mask, results);
+    }
+
+    void QueryCircle2D(HWorld2D world, const Point3& center, float radius, uint16_t mask, dmArray<void*>& results)
+    {
+        DM_PROFILE("QueryCircle2D");
+
+        float scale = world->m_Context->m_Scale;
+        b2CircleShape circle;
+        ToB2(center, circle.m_p, scale);
+        circle.m_radius = dmMath::Max(radius, 0.0f) * scale;
+        b2Vec2 r(circle.m_radius, circle.m_radius);
+        b2AABB aabb;
+        aabb.lowerBound = circle.m_p - r;
+        aabb.upperBound = circle.m_p + r;
+        SpatialQuery2D(world, aabb, &circle, mask, results);
+    }
+
     void SetGravity2D(HWorld2D world, const Vector3& gravity)
     {
         b2Vec2 gravity_b;
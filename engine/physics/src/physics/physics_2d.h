@@ -42,6 +42,15 @@ namespace dmPhysics
         const StepWorldContext* m_TempStepWorldContext;
     };
 
+    /// A body outside of the simulated regions, see SetRegionFocus2D()
+    struct FrozenBody2D
+    {
+        b2Body* m_Body;
+        /// Bounds and position of the body when it was frozen
+        b2AABB  m_AABB;
+        b2Vec2  m_Position;
+    };
+
     struct World2D
     {
         World2D(HContext2D context, const NewWorldParams& params);
@@ -50,12 +59,21 @@ namespace dmPhysics
         HContext2D                  m_Context;
         b2World                     m_World;
         dmArray<RayCastRequest>     m_RayCastRequests;
+        dmArray<RayCastResponse>    m_RayCastResponses;
+        dmArray<RayCastJob>         m_RayCastJobs;
         DebugDraw2D                 m_DebugDraw;
         ContactListener             m_ContactListener;
         GetWorldTransformCallback   m_GetWorldTransformCallback;
         SetWorldTransformCallback   m_SetWorldTransformCallback;
+        dmArray<FrozenBody2D>               m_FrozenBodies;
+        dmHashTable<uintptr_t, uint32_t>    m_FrozenBodyIndices;    // Body to index in m_FrozenBodies
+        int32_t                     m_FocusRegionX;
+        int32_t                     m_FocusRegionY;
+        uint32_t                    m_RegionUpdateCountdown;
         uint8_t                     m_AllowDynamicTransforms:1;
-        uint8_t                     :7;
+        uint8_t                     m_HasRegionFocus:1;
+        uint8_t                     m_RegionsDirty:1;
+        uint8_t                     :5;
     };
 
     struct Context2D
@@ -66,6 +84,7 @@ namespace dmPhysics
         DebugCallbacks              m_DebugCallbacks;
         b2Vec2                      m_Gravity;
         dmMessage::HSocket          m_Socket;
+        dmJobThread::HContext       m_JobThread;
         float                       m_Scale;
         float                       m_InvScale;
         float                       m_ContactImpulseLimit;
@@ -73,6 +92,8 @@ namespace dmPhysics
         float                       m_VelocityThreshold;
         int                         m_RayCastLimit;
         int                         m_TriggerOverlapCapacity;
+        float                       m_RegionSize;
+        uint32_t                    m_RegionRadius;
         uint8_t                     m_AllowDynamicTransforms:1;
         uint8_t                     :7;
     };
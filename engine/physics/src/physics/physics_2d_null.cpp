@@ -107,6 +107,16 @@ namespace dmPhysics
     {
     }
 
+    void SetCollisionObjectFilterDeferred(HCollisionObject2D collision_object,
+                                          uint32_t shape, uint32_t child,
+                                          uint16_t group, uint16_t mask)
+    {
+    }
+
+    void RefilterCollisionObject2D(HCollisionObject2D collision_object)
+    {
+    }
+
     void DeleteCollisionShape2D(HCollisionShape2D shape)
     {
     }
@@ -265,10 +275,29 @@ namespace dmPhysics
     {
     }
 
+    void QueryAABB2D(HWorld2D world, const dmVMath::Point3& min, const dmVMath::Point3& max, uint16_t mask, dmArray<void*>& results)
+    {
+        results.SetSize(0);
+    }
+
+    void QueryCircle2D(HWorld2D world, const dmVMath::Point3& center, float radius, uint16_t mask, dmArray<void*>& results)
+    {
+        results.SetSize(0);
+    }
+
     void SetGravity2D(HWorld2D world, const dmVMath::Vector3& gravity)
     {
     }
 
+    void SetRegionFocus2D(HWorld2D world, const dmVMath::Point3& position)
+    {
+    }
+
+    uint32_t GetFrozenCollisionObjectCount2D(HWorld2D world)
+    {
+        return 0;
+    }
+
     dmVMath::Vector3 GetGravity2D(HWorld2D world)
     {
         return dmVMath::Vector3(0.0f);
@@ -117,6 +117,7 @@ namespace dmPhysics
     , m_DebugCallbacks()
     , m_Gravity(0.0f, -10.0f, 0.0f)
     , m_Socket(0)
+    , m_JobThread(0)
     , m_Scale(1.0f)
     , m_InvScale(1.0f)
     , m_ContactImpulseLimit(0.0f)
@@ -155,6 +156,7 @@ namespace dmPhysics
         m_SetWorldTransform = params.m_SetWorldTransformCallback;
 
         m_RayCastRequests.SetCapacity(context->m_RayCastLimit);
+        m_RayCastResponses.SetCapacity(context->m_RayCastLimit);
         OverlapCacheInit(&m_TriggerOverlaps);
     }
 
@@ -212,6 +214,41 @@ namespace dmPhysics
         RayCastResponse m_Response;
     };
 
+    // Processes the ray cast requests [start, end) into the matching responses.
+    // The world is only read here, which makes it safe to process several ranges in parallel after the step.
+    static void ProcessRayCasts3D(HWorld3D world, uint32_t start, uint32_t end)
+    {
+        float scale = world->m_Context->m_Scale;
+        float inv_scale = world->m_Context->m_InvScale;
+        for (uint32_t i = start; i < end; ++i)
+        {
+            const RayCastRequest& request = world->m_RayCastRequests[i];
+            btVector3 from;
+            ToBt(request.m_From, from, scale);
+            btVector3 to;
+            ToBt(request.m_To, to, scale);
+            RayCastResultClosestCallback3D result_callback(from, to, request.m_Mask, request.m_IgnoredUserData);
+            world->m_DynamicsWorld->rayTest(from, to, result_callback);
+            RayCastResponse& response = world->m_RayCastResponses[i];
+            response.m_Hit = result_callback.hasHit() ? 1 : 0;
+            response.m_Fraction = result_callback.m_closestHitFraction;
+            FromBt(result_callback.m_hitPointWorld, response.m_Position, inv_scale);
+            FromBt(result_callback.m_hitNormalWorld, response.m_Normal, 1.0f); // don't scale normal
+            if (result_callback.m_collisionObject != 0x0)
+            {
+                response.m_CollisionObjectUserData = result_callback.m_collisionObject->getUserPointer();
+                response.m_CollisionObjectGroup = result_callback.m_collisionObject->getBroadphaseHandle()->m_collisionFilterGroup;
+            }
+        }
+    }
+
+    static int RayCastJobProcess3D(void* context, void* data)
+    {
+        RayCastJob* job = (RayCastJob*) data;
+        ProcessRayCasts3D((HWorld3D) context, job->m_Start, job->m_End);
+        return 0;
+    }
+
     // Grabbed from a more recent Bullet version for now
     /// BULLET (do not modify) ->
     struct AllHitsRayResultCallback : public btCollisionWorld::RayResultCallback
@@ -289,6 +326,7 @@ namespace dmPhysics
         context->m_ContactImpulseLimit = params.m_ContactImpulseLimit * params.m_Scale;
         context->m_TriggerEnterLimit = params.m_TriggerEnterLimit * params.m_Scale;
         context->m_RayCastLimit = params.m_RayCastLimit3D;
+        context->m_JobThread = params.m_JobThread;
         context->m_TriggerOverlapCapacity = params.m_TriggerOverlapCapacity;
         context->m_AllowDynamicTransforms = params.m_AllowDynamicTransforms;
         dmMessage::Result result = dmMessage::NewSocket(PHYSICS_SOCKET_NAME, &context->m_Socket);
@@ -440,33 +478,47 @@ namespace dmPhysics
         if (size > 0)
         {
             DM_PROFILE("RayCasts");
-            for (uint32_t i = 0; i < size; ++i)
+            if (step_context.m_RayCastCallback == 0x0)
+            {
+                dmLogWarning("Ray cast requested without any response callback, skipped.");
+            }
+            else
             {
-                const RayCastRequest& request = world->m_RayCastRequests[i];
-                if (step_context.m_RayCastCallback == 0x0)
+                // The responses are reset since a missed ray leaves the collision object fields untouched
+                world->m_RayCastResponses.SetSize(size);
+                for (uint32_t i = 0; i < size; ++i)
                 {
-                    dmLogWarning("Ray cast requested without any response callback, skipped.");
-                    continue;
+                    world->m_RayCastResponses[i] = RayCastResponse();
+                }
+
+                if (context->m_JobThread && size > RAY_CAST_JOB_BATCH_SIZE)
+                {
+                    uint32_t job_count = (size + RAY_CAST_JOB_BATCH_SIZE - 1) / RAY_CAST_JOB_BATCH_SIZE;
+                    if (world->m_RayCastJobs.Capacity() < job_count)
+                        world->m_RayCastJobs.SetCapacity(job_count);
+                    world->m_RayCastJobs.SetSize(job_count);
+
+                    dmJobThread::JobGroup group;
+                    dmJobThread::InitGroup(&group, 0);
+                    for (uint32_t i = 0; i < job_count; ++i)
+                    {
+                        RayCastJob* job = &world->m_RayCastJobs[i];
+                        job->m_Start = i * RAY_CAST_JOB_BATCH_SIZE;
+                        job->m_End = dmMath::Min(job->m_Start + RAY_CAST_JOB_BATCH_SIZE, size);
+                        dmJobThread::PushGroupJob(context->m_JobThread, &group, RayCastJobProcess3D, (void*) world, (void*) job);
+                    }
+                    dmJobThread::WaitGroup(context->m_JobThread, &group);
                 }
-                float scale = world->m_Context->m_Scale;
-                btVector3 from;
-                ToBt(request.m_From, from, scale);
-                btVector3 to;
-                ToBt(request.m_To, to, scale);
-                RayCastResultClosestCallback3D result_callback(from, to, request.m_Mask, request.m_IgnoredUserData);
-                world->m_DynamicsWorld->rayTest(from, to, result_callback);
-                RayCastResponse response;
-                response.m_Hit = result_callback.hasHit() ? 1 : 0;
-                response.m_Fraction = result_callback.m_closestHitFraction;
-                float inv_scale = world->m_Context->m_InvScale;
-                FromBt(result_callback.m_hitPointWorld, response.m_Position, inv_scale);
-                FromBt(result_callback.m_hitNormalWorld, response.m_Normal, 1.0f); // don't scale normal
-                if (result_callback.m_collisionObject != 0x0)
+                else
                 {
-                    response.m_CollisionObjectUserData = result_callback.m_collisionObject->getUserPointer();
-                    response.m_CollisionObjectGroup = result_callback.m_collisionObject->getBroadphaseHandle()->m_collisionFilterGroup;
+                    ProcessRayCasts3D(world, 0, size);
+                }
+
+                // The responses are reported in request order, on the calling thread
+                for (uint32_t i = 0; i < size; ++i)
+                {
+                    step_context.m_RayCastCallback(world->m_RayCastResponses[i], world->m_RayCastRequests[i], step_context.m_RayCastUserData);
                 }
-                step_context.m_RayCastCallback(response, request, step_context.m_RayCastUserData);
             }
             world->m_RayCastRequests.SetSize(0);
         }
@@ -1255,6 +1307,103 @@ namespace dmPhysics
         }
     }
 
+    struct ContactTestCallback3D : public btCollisionWorld::ContactResultCallback
+    {
+        ContactTestCallback3D() : m_Hit(false) {}
+
+        virtual btScalar addSingleResult(btManifoldPoint& cp, const btCollisionObject* colObj0, int partId0, int index0, const btCollisionObject* colObj1, int partId1, int index1)
+        {
+            // Contacts are also reported within the contact breaking threshold, only keep actual overlaps
+            if (cp.getDistance() <= 0.0f)
+                m_Hit = true;
+            return 0;
+        }
+
+        bool m_Hit;
+    };
+
+    struct SpatialQueryCallback3D : public btBroadphaseAabbCallback
+    {
+        virtual bool process(const btBroadphaseProxy* proxy)
+        {
+            btCollisionObject* co = (btCollisionObject*)proxy->m_clientObject;
+            if (!(co->getBroadphaseHandle()->m_collisionFilterGroup & m_CollisionMask))
+                return true;
+            // The broadphase boxes include the collision margins, test against the shape bounds
+            btVector3 aabb_min, aabb_max;
+            co->getCollisionShape()->getAabb(co->getWorldTransform(), aabb_min, aabb_max);
+            if (!TestAabbAgainstAabb2(m_AABBMin, m_AABBMax, aabb_min, aabb_max))
+                return true;
+            if (m_Sphere)
+            {
+                ContactTestCallback3D contact;
+                m_World->contactPairTest(m_Sphere, co, contact);
+                if (!contact.m_Hit)
+                    return true;
+            }
+            if (m_Results->Full())
+                m_Results->OffsetCapacity(32);
+            m_Results->Push(co->getUserPointer());
+            return true;
+        }
+
+        btCollisionWorld*   m_World;
+        btCollisionObject*  m_Sphere;
+        dmArray<void*>*     m_Results;
+        btVector3           m_AABBMin;
+        btVector3           m_AABBMax;
+        uint16_t            m_CollisionMask;
+    };
+
+    static void SpatialQuery3D(HWorld3D world, const btVector3& aabb_min, const btVector3& aabb_max, btCollisionObject* sphere, uint16_t mask, dmArray<void*>& results)
+    {
+        results.SetSize(0);
+
+        SpatialQueryCallback3D callback;
+        callback.m_World = world->m_DynamicsWorld;
+        callback.m_Sphere = sphere;
+        callback.m_Results = &results;
+        callback.m_AABBMin = aabb_min;
+        callback.m_AABBMax = aabb_max;
+        callback.m_CollisionMask = mask;
+        world->m_DynamicsWorld->getBroadphase()->aabbTest(aabb_min, aabb_max, callback);
+    }
+
+    void QueryAABB3D(HWorld3D world, const Point3& min, const Point3& max, uint16_t mask, dmArray<void*>& results)
+    {
+        DM_PROFILE("QueryAABB3D");
+
+        float scale = world->m_Context->m_Scale;
+        btVector3 a;
+        ToBt(min, a, scale);
+        btVector3 b;
+        ToBt(max, b, scale);
+        btVector3 aabb_min = a;
+        aabb_min.setMin(b);
+        btVector3 aabb_max = a;
+        aabb_max.setMax(b);
+        SpatialQuery3D(world, aabb_min, aabb_max, 0x0, mask, results);
+    }
+
+    void QuerySphere3D(HWorld3D world, const Point3& center, float radius, uint16_t mask, dmArray<void*>& results)
+    {
+        DM_PROFILE("QuerySphere3D");
+
+        float scale = world->m_Context->m_Scale;
+        btVector3 c;
+        ToBt(center, c, scale);
+        btScalar r = dmMath::Max(radius, 0.0f) * scale;
+
+        btSphereShape shape(r);
+        btCollisionObject sphere;
+        sphere.setCollisionShape(&shape);
+        sphere.getWorldTransform().setIdentity();
+        sphere.getWorldTransform().setOrigin(c);
+
+        btVector3 extents(r, r, r);
+        SpatialQuery3D(world, c - extents, c + extents, &sphere, mask, results);
+    }
+
     void SetGravity3D(HWorld3D world, const Vector3& gravity)
     {
         HContext3D context = world->m_Context;
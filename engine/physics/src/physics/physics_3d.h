@@ -32,6 +32,8 @@ namespace dmPhysics
 
         OverlapCache                            m_TriggerOverlaps;
         dmArray<RayCastRequest>                 m_RayCastRequests;
+        dmArray<RayCastResponse>                m_RayCastResponses;
+        dmArray<RayCastJob>                     m_RayCastJobs;
         DebugDraw3D                             m_DebugDraw;
         HContext3D                              m_Context;
         btDefaultCollisionConfiguration*        m_CollisionConfiguration;
@@ -53,6 +55,7 @@ namespace dmPhysics
         DebugCallbacks              m_DebugCallbacks;
         btVector3                   m_Gravity;
         dmMessage::HSocket          m_Socket;
+        dmJobThread::HContext       m_JobThread;
         float                       m_Scale;
         float                       m_InvScale;
         float                       m_ContactImpulseLimit;
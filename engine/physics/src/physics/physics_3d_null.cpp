@@ -217,6 +217,16 @@ namespace dmPhysics
     {
     }
 
+    void QueryAABB3D(HWorld3D world, const dmVMath::Point3& min, const dmVMath::Point3& max, uint16_t mask, dmArray<void*>& results)
+    {
+        results.SetSize(0);
+    }
+
+    void QuerySphere3D(HWorld3D world, const dmVMath::Point3& center, float radius, uint16_t mask, dmArray<void*>& results)
+    {
+        results.SetSize(0);
+    }
+
     void SetGravity3D(HWorld3D world, const dmVMath::Vector3& gravity)
     {
     }
@@ -31,6 +31,9 @@ namespace dmPhysics
     , m_RayCastLimit2D(0)
     , m_RayCastLimit3D(0)
     , m_TriggerOverlapCapacity(0)
+    , m_JobThread(0)
+    , m_RegionSize2D(0.0f)
+    , m_RegionRadius2D(1)
     , m_AllowDynamicTransforms(0)
     {
 
@@ -103,7 +106,10 @@ namespace dmPhysics
     }
 
     OverlapCache::OverlapCache(uint32_t trigger_overlap_capacity)
-    : m_OverlapCache()
+    : m_Pairs()
+    , m_ObjectOverlapCounts()
+    , m_PairCount(0)
+    , m_Generation(0)
     , m_TriggerOverlapCapacity(trigger_overlap_capacity)
     {
 
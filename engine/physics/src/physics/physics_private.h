@@ -15,49 +15,61 @@
 #ifndef PHYSICS_PRIVATE_H
 #define PHYSICS_PRIVATE_H
 
+#include <dlib/array.h>
 #include <dlib/hashtable.h>
 
 namespace dmPhysics
 {
     /**
-     * Used to track the overlapping of an object.
-     * Count defines how many overlap-contacts are known.
+     * Number of ray casts each job processes when the ray casts of a step are split over the job threads.
      */
-    struct Overlap
-    {
-        void* m_Object;
-        uint32_t m_Count;
-    };
+    const uint32_t RAY_CAST_JOB_BATCH_SIZE = 32;
 
     /**
-     * Initial capacity of the cache.
-     * The cache is a hash table with 75% as many buckets as capacity.
+     * A range of ray cast requests to process in one job. The world is passed as the job context.
      */
-    const uint32_t CACHE_INITIAL_CAPACITY = 128;
+    struct RayCastJob
+    {
+        uint32_t m_Start;
+        uint32_t m_End;
+    };
 
     /**
-     * Count of elements to expand the cache with when it's 75% full.
+     * A pair of overlapping objects, stored once regardless of the order the objects are reported in.
+     * The user data and groups are the ones from when the overlap was entered, and are reported on exit.
      */
-    const uint32_t CACHE_EXPANSION = 16;
+    struct OverlapPair
+    {
+        void*    m_ObjectA;
+        void*    m_ObjectB;
+        void*    m_UserDataA;
+        void*    m_UserDataB;
+        /// The step generation when the overlap was last seen
+        uint32_t m_Generation;
+        uint16_t m_GroupA;
+        uint16_t m_GroupB;
+    };
 
     /**
-     * Used to track all overlaps given an object.
+     * Initial number of slots in the pair table, must be a power of two.
+     * The table doubles in size when it's 75% full.
      */
-    struct OverlapEntry
-    {
-        void* m_UserData;
-        Overlap* m_Overlaps;
-        uint32_t m_OverlapCount;
-        uint16_t m_Group;
-    };
+    const uint32_t CACHE_INITIAL_CAPACITY = 128;
 
     /**
-     * Stores every set of overlaps for each object.
+     * Stores the overlapping pairs in a flat open addressing (linear probing) table.
+     * Each step bumps the generation, the pairs seen during the step are stamped with it,
+     * and the pairs left with an older generation are the ones that exited.
      */
     struct OverlapCache {
     	OverlapCache(uint32_t triggerOverlapCapacity);
 
-    	dmHashTable<uintptr_t, OverlapEntry> m_OverlapCache;
+        /// Pair slots, empty slots have a null m_ObjectA
+        dmArray<OverlapPair> m_Pairs;
+        /// Number of overlaps per object, to enforce the capacity and to skip objects without overlaps on removal
+        dmHashTable<uintptr_t, uint32_t> m_ObjectOverlapCounts;
+        uint32_t m_PairCount;
+        uint32_t m_Generation;
 
         /**
          * Max count of tracked overlaps per object.
@@ -67,13 +79,13 @@ namespace dmPhysics
     };
 
     /**
-     * Initialize the cache with CACHE_INITIAL_CAPACITY and 75% as many buckets.
+     * Initialize the cache with CACHE_INITIAL_CAPACITY pair slots.
      */
     void OverlapCacheInit(OverlapCache* cache);
 
     /**
-     * Reset the overlap cache which set the contact point counts (Overlap::m_Count) to 0,
-     * so that removed contacts will be properly removed from the cache.
+     * Start a new step of the overlap cache, so that overlaps that aren't added again
+     * before the next prune are removed from the cache.
      */
     void OverlapCacheReset(OverlapCache* cache);
 
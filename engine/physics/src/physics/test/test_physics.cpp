@@ -128,6 +128,8 @@ Test3D::Test3D()
 , m_GetMassFunc(dmPhysics::GetMass3D)
 , m_RequestRayCastFunc(dmPhysics::RequestRayCast3D)
 , m_RayCastFunc(dmPhysics::RayCast3D)
+, m_QueryAABBFunc(dmPhysics::QueryAABB3D)
+, m_QuerySphereFunc(dmPhysics::QuerySphere3D)
 , m_SetDebugCallbacksFunc(dmPhysics::SetDebugCallbacks3D)
 , m_ReplaceShapeFunc(dmPhysics::ReplaceShape3D)
 , m_SetGravityFunc(dmPhysics::SetGravity3D)
@@ -186,6 +188,8 @@ Test2D::Test2D()
 , m_GetMassFunc(dmPhysics::GetMass2D)
 , m_RequestRayCastFunc(dmPhysics::RequestRayCast2D)
 , m_RayCastFunc(dmPhysics::RayCast2D)
+, m_QueryAABBFunc(dmPhysics::QueryAABB2D)
+, m_QuerySphereFunc(dmPhysics::QueryCircle2D)
 , m_SetDebugCallbacksFunc(dmPhysics::SetDebugCallbacks2D)
 , m_ReplaceShapeFunc(dmPhysics::ReplaceShape2D)
 , m_SetGravityFunc(dmPhysics::SetGravity2D)
@@ -1062,6 +1066,74 @@ TYPED_TEST(PhysicsTest, RayCasting)
     (*TestFixture::m_Test.m_DeleteCollisionShapeFunc)(shape);
 }
 
+TYPED_TEST(PhysicsTest, JobThreadRayCasting)
+{
+    // The ray casts of a step are split over the job thread when there are more than a batch of them
+    dmJobThread::JobThreadCreationParams job_thread_params;
+    job_thread_params.m_ThreadNames[0] = "test_physics_worker";
+    job_thread_params.m_ThreadCount = 2;
+    dmJobThread::HContext job_thread = dmJobThread::Create(job_thread_params);
+
+    dmPhysics::NewContextParams context_params = dmPhysics::NewContextParams();
+    context_params.m_Scale = PHYSICS_SCALE;
+    context_params.m_RayCastLimit2D = 64;
+    context_params.m_RayCastLimit3D = 64;
+    context_params.m_JobThread = job_thread;
+    typename TypeParam::ContextType context = (*TestFixture::m_Test.m_NewContextFunc)(context_params);
+    dmPhysics::NewWorldParams world_params;
+    world_params.m_GetWorldTransformCallback = GetWorldTransform;
+    world_params.m_SetWorldTransformCallback = SetWorldTransform;
+    typename TypeParam::WorldType world = (*TestFixture::m_Test.m_NewWorldFunc)(context, world_params);
+
+    float box_half_ext = 0.5f;
+    VisualObject vo;
+    dmPhysics::CollisionObjectData data;
+    typename TypeParam::CollisionShapeType shape = (*TestFixture::m_Test.m_NewBoxShapeFunc)(context, Vector3(box_half_ext, box_half_ext, box_half_ext));
+    data.m_Mass = 0.0f;
+    data.m_Type = dmPhysics::COLLISION_OBJECT_TYPE_KINEMATIC;
+    data.m_UserData = &vo;
+    typename TypeParam::CollisionObjectType box_co = (*TestFixture::m_Test.m_NewCollisionObjectFunc)(world, data, &shape, 1u);
+
+    const uint32_t ray_count = 64;
+    RayCastResult result[ray_count];
+    memset(result, 0, sizeof(result));
+
+    // Every other ray reaches the box
+    for (uint32_t i = 0; i < ray_count; ++i)
+    {
+        dmPhysics::RayCastRequest request;
+        request.m_From = Point3(0.0f, 1.0f, 0.0f);
+        request.m_To = (i % 2) ? Point3(0.0f, 0.49f, 0.0f) : Point3(0.0f, 0.51f + TestFixture::m_Test.m_PolygonRadius, 0.0f);
+        request.m_UserId = i;
+        request.m_UserData = result;
+        (*TestFixture::m_Test.m_RequestRayCastFunc)(world, request);
+    }
+
+    TestFixture::m_StepWorldContext.m_RayCastCallback = RayCastCallback;
+    (*TestFixture::m_Test.m_StepWorldFunc)(world, TestFixture::m_StepWorldContext);
+
+    for (uint32_t i = 0; i < ray_count; ++i)
+    {
+        ASSERT_EQ((void*)result, result[i].m_UserData);
+        if (i % 2)
+        {
+            ASSERT_TRUE(result[i].m_Response.m_Hit);
+            ASSERT_NEAR(0.5f, result[i].m_Response.m_Position.getY(), 0.00001f);
+            ASSERT_EQ((void*)&vo, (void*)result[i].m_Response.m_CollisionObjectUserData);
+        }
+        else
+        {
+            ASSERT_FALSE(result[i].m_Response.m_Hit);
+        }
+    }
+
+    (*TestFixture::m_Test.m_DeleteCollisionObjectFunc)(world, box_co);
+    (*TestFixture::m_Test.m_DeleteCollisionShapeFunc)(shape);
+    (*TestFixture::m_Test.m_DeleteWorldFunc)(context, world);
+    (*TestFixture::m_Test.m_DeleteContextFunc)(context);
+    dmJobThread::Destroy(job_thread);
+}
+
 TYPED_TEST(PhysicsTest, InsideRayCasting)
 {
     float box_half_ext = 0.5f;
@@ -1246,6 +1318,61 @@ TYPED_TEST(PhysicsTest, SynchronousRayCasting)
     (*TestFixture::m_Test.m_DeleteCollisionShapeFunc)(shape);
 }
 
+TYPED_TEST(PhysicsTest, SpatialQueries)
+{
+    float box_half_ext = 0.5f;
+
+    VisualObject vo_a;
+    vo_a.m_Position.setX(1.0f);
+
+    VisualObject vo_b;
+    vo_b.m_Position.setX(2.5f);
+
+    typename TypeParam::CollisionShapeType shape = (*TestFixture::m_Test.m_NewBoxShapeFunc)(TestFixture::m_Context, Vector3(box_half_ext, box_half_ext, box_half_ext));
+
+    dmPhysics::CollisionObjectData data_a;
+    data_a.m_Group = 1;
+    data_a.m_Mass = 0.0f;
+    data_a.m_Type = dmPhysics::COLLISION_OBJECT_TYPE_KINEMATIC;
+    data_a.m_UserData = &vo_a;
+    typename TypeParam::CollisionObjectType box_co_a = (*TestFixture::m_Test.m_NewCollisionObjectFunc)(TestFixture::m_World, data_a, &shape, 1u);
+
+    dmPhysics::CollisionObjectData data_b;
+    data_b.m_Group = 2;
+    data_b.m_Mass = 0.0f;
+    data_b.m_Type = dmPhysics::COLLISION_OBJECT_TYPE_TRIGGER;
+    data_b.m_UserData = &vo_b;
+    typename TypeParam::CollisionObjectType box_co_b = (*TestFixture::m_Test.m_NewCollisionObjectFunc)(TestFixture::m_World, data_b, &shape, 1u);
+
+    dmArray<void*> results;
+
+    // A miss
+    (*TestFixture::m_Test.m_QueryAABBFunc)(TestFixture::m_World, Point3(-1.0f, -1.0f, -1.0f), Point3(0.0f, 1.0f, 1.0f), 0xffff, results);
+    ASSERT_EQ(0u, results.Size());
+
+    // Both objects, including the trigger
+    (*TestFixture::m_Test.m_QueryAABBFunc)(TestFixture::m_World, Point3(0.0f, -1.0f, -1.0f), Point3(3.0f, 1.0f, 1.0f), 0xffff, results);
+    ASSERT_EQ(2u, results.Size());
+    ASSERT_TRUE((results[0] == &vo_a && results[1] == &vo_b) || (results[0] == &vo_b && results[1] == &vo_a));
+
+    // Filtered by group, the array is cleared by the query
+    (*TestFixture::m_Test.m_QueryAABBFunc)(TestFixture::m_World, Point3(0.0f, -1.0f, -1.0f), Point3(3.0f, 1.0f, 1.0f), 1, results);
+    ASSERT_EQ(1u, results.Size());
+    ASSERT_EQ(&vo_a, results[0]);
+
+    // The sphere bounds overlap both boxes, but the sphere only reaches the second
+    (*TestFixture::m_Test.m_QuerySphereFunc)(TestFixture::m_World, Point3(2.1f, 1.1f, 0.0f), 0.7f, 0xffff, results);
+    ASSERT_EQ(1u, results.Size());
+    ASSERT_EQ(&vo_b, results[0]);
+
+    (*TestFixture::m_Test.m_QuerySphereFunc)(TestFixture::m_World, Point3(1.75f, 0.0f, 0.0f), 0.5f, 0xffff, results);
+    ASSERT_EQ(2u, results.Size());
+
+    (*TestFixture::m_Test.m_DeleteCollisionObjectFunc)(TestFixture::m_World, box_co_a);
+    (*TestFixture::m_Test.m_DeleteCollisionObjectFunc)(TestFixture::m_World, box_co_b);
+    (*TestFixture::m_Test.m_DeleteCollisionShapeFunc)(shape);
+}
+
 enum Groups
 {
     GROUP_A = 1 << 0,
@@ -1725,6 +1852,51 @@ TYPED_TEST(PhysicsTest, KinematicSleep)
     (*TestFixture::m_Test.m_DeleteCollisionShapeFunc)(box0_shape);
 }
 
+TYPED_TEST(PhysicsTest, DynamicSleepSkipsTransformSync)
+{
+    float box_half_ext = 0.5f;
+
+    VisualObject ground_vo;
+    ground_vo.m_Position = Point3(0.0f, -box_half_ext, 0.0f);
+    dmPhysics::CollisionObjectData ground_data;
+    ground_data.m_Type = dmPhysics::COLLISION_OBJECT_TYPE_STATIC;
+    ground_data.m_Mass = 0.0f;
+    typename TypeParam::CollisionShapeType ground_shape = (*TestFixture::m_Test.m_NewBoxShapeFunc)(TestFixture::m_Context, Vector3(10.0f, box_half_ext, box_half_ext));
+    ground_data.m_UserData = &ground_vo;
+    typename TypeParam::CollisionObjectType ground_co = (*TestFixture::m_Test.m_NewCollisionObjectFunc)(TestFixture::m_World, ground_data, &ground_shape, 1u);
+
+    VisualObject box_vo;
+    box_vo.m_Position = Point3(0.0f, box_half_ext, 0.0f);
+    dmPhysics::CollisionObjectData box_data;
+    box_data.m_Type = dmPhysics::COLLISION_OBJECT_TYPE_DYNAMIC;
+    box_data.m_Mass = 1.0f;
+    typename TypeParam::CollisionShapeType box_shape = (*TestFixture::m_Test.m_NewBoxShapeFunc)(TestFixture::m_Context, Vector3(box_half_ext, box_half_ext, box_half_ext));
+    box_data.m_UserData = &box_vo;
+    typename TypeParam::CollisionObjectType box_co = (*TestFixture::m_Test.m_NewCollisionObjectFunc)(TestFixture::m_World, box_data, &box_shape, 1u);
+
+    const float sleep_time = 3.0f; // 2 in bullet, 0.5 in box
+    int steps = (int)(sleep_time / TestFixture::m_StepWorldContext.m_DT);
+    for (int i = 0; i < steps; ++i)
+    {
+        (*TestFixture::m_Test.m_StepWorldFunc)(TestFixture::m_World, TestFixture::m_StepWorldContext);
+    }
+
+    ASSERT_TRUE((*TestFixture::m_Test.m_IsSleepingFunc)(box_co));
+
+    // The transform of a sleeping body is no longer written back to its object
+    Point3 moved_position = box_vo.m_Position + Vector3(1.0f, 0.0f, 0.0f);
+    box_vo.m_Position = moved_position;
+    (*TestFixture::m_Test.m_StepWorldFunc)(TestFixture::m_World, TestFixture::m_StepWorldContext);
+
+    ASSERT_TRUE((*TestFixture::m_Test.m_IsSleepingFunc)(box_co));
+    ASSERT_NEAR(moved_position.getX(), box_vo.m_Position.getX(), 0.00001f);
+
+    (*TestFixture::m_Test.m_DeleteCollisionObjectFunc)(TestFixture::m_World, box_co);
+    (*TestFixture::m_Test.m_DeleteCollisionShapeFunc)(box_shape);
+    (*TestFixture::m_Test.m_DeleteCollisionObjectFunc)(TestFixture::m_World, ground_co);
+    (*TestFixture::m_Test.m_DeleteCollisionShapeFunc)(ground_shape);
+}
+
 // Although we don't have a good way of testing the functionality here (we do it in an integration test instead),
 // we need to make sure the linking will work as expected
 TYPED_TEST(PhysicsTest, Wakeup)
@@ -369,6 +369,64 @@ TYPED_TEST(PhysicsTest, GridShapePolygon)
     }
 }
 
+TYPED_TEST(PhysicsTest, GridShapeDeferredFilter)
+{
+    int32_t cell_width = 16;
+    int32_t cell_height = 16;
+    float grid_radius = b2_polygonRadius;
+
+    VisualObject vo_a;
+    vo_a.m_Position = dmVMath::Point3(0, 0, 0);
+    dmPhysics::CollisionObjectData data;
+    data.m_Type = dmPhysics::COLLISION_OBJECT_TYPE_STATIC;
+    data.m_Mass = 0.0f;
+    data.m_UserData = &vo_a;
+    data.m_Group = 0xffff;
+    data.m_Mask = 0xffff;
+    data.m_Restitution = 0.0f;
+
+    const float hull_vertices[] = { -0.5f, -0.5f,
+                                     0.5f, -0.5f,
+                                     0.5f,  0.5f,
+                                    -0.5f,  0.5f };
+    const dmPhysics::HullDesc hulls[] = { {0, 4} };
+    dmPhysics::HHullSet2D hull_set = dmPhysics::NewHullSet2D(TestFixture::m_Context, hull_vertices, 4, hulls, 1);
+    dmPhysics::HCollisionShape2D grid_shape = dmPhysics::NewGridShape2D(TestFixture::m_Context, hull_set, dmVMath::Point3(0,0,0), cell_width, cell_height, 1, 1);
+    typename TypeParam::CollisionObjectType grid_co = (*TestFixture::m_Test.m_NewCollisionObjectFunc)(TestFixture::m_World, data, &grid_shape, 1u);
+    dmPhysics::SetGridShapeHull(grid_co, 0, 0, 0, 0, EMPTY_FLAGS);
+
+    VisualObject vo_b;
+    vo_b.m_Position = dmVMath::Point3(0.0f, 20.0f, 0.0f);
+    data.m_Type = dmPhysics::COLLISION_OBJECT_TYPE_DYNAMIC;
+    data.m_Mass = 1.0f;
+    data.m_UserData = &vo_b;
+    typename TypeParam::CollisionShapeType shape = (*TestFixture::m_Test.m_NewBoxShapeFunc)(TestFixture::m_Context, dmVMath::Vector3(0.5f, 0.5f, 0.0f));
+    typename TypeParam::CollisionObjectType dynamic_co = (*TestFixture::m_Test.m_NewCollisionObjectFunc)(TestFixture::m_World, data, &shape, 1u);
+
+    for (uint32_t i = 0; i < 200; ++i)
+    {
+        (*TestFixture::m_Test.m_StepWorldFunc)(TestFixture::m_World, TestFixture::m_StepWorldContext);
+    }
+    // Resting on the cell
+    ASSERT_NEAR(8.0f + grid_radius + 0.5f, vo_b.m_Position.getY(), 0.05f);
+
+    // Clear the group of the cell, the existing contact is dropped once the object is refiltered
+    dmPhysics::SetCollisionObjectFilterDeferred(grid_co, 0, 0, 0, 0xffff);
+    dmPhysics::RefilterCollisionObject2D(grid_co);
+
+    for (uint32_t i = 0; i < 200; ++i)
+    {
+        (*TestFixture::m_Test.m_StepWorldFunc)(TestFixture::m_World, TestFixture::m_StepWorldContext);
+    }
+    ASSERT_GT(0.0f, vo_b.m_Position.getY());
+
+    (*TestFixture::m_Test.m_DeleteCollisionObjectFunc)(TestFixture::m_World, grid_co);
+    (*TestFixture::m_Test.m_DeleteCollisionObjectFunc)(TestFixture::m_World, dynamic_co);
+    (*TestFixture::m_Test.m_DeleteCollisionShapeFunc)(shape);
+    (*TestFixture::m_Test.m_DeleteCollisionShapeFunc)(grid_shape);
+    dmPhysics::DeleteHullSet2D(hull_set);
+}
+
 TYPED_TEST(PhysicsTest, GridShapeSphere)
 {
     /*
@@ -1842,6 +1900,80 @@ TYPED_TEST(PhysicsTest, ScriptApiBox2D)
     (*TestFixture::m_Test.m_DeleteCollisionObjectFunc)(TestFixture::m_World, dynamic_co);
 }
 
+TEST(PhysicsRegions2D, FreezeOutsideFocus)
+{
+    dmPhysics::NewContextParams context_params = dmPhysics::NewContextParams();
+    context_params.m_Scale = PHYSICS_SCALE;
+    context_params.m_RegionSize2D = 100.0f;
+    context_params.m_RegionRadius2D = 1;
+    dmPhysics::HContext2D context = dmPhysics::NewContext2D(context_params);
+    dmPhysics::NewWorldParams world_params;
+    world_params.m_GetWorldTransformCallback = GetWorldTransform;
+    world_params.m_SetWorldTransformCallback = SetWorldTransform;
+    world_params.m_MaxCollisionObjectsCount = 16;
+    dmPhysics::HWorld2D world = dmPhysics::NewWorld2D(context, world_params);
+
+    dmPhysics::StepWorldContext step_context;
+    step_context.m_DT = 1.0f / 60.0f;
+
+    dmPhysics::HCollisionShape2D shape = dmPhysics::NewCircleShape2D(context, 1.0f);
+    dmPhysics::CollisionObjectData data;
+    data.m_Type = dmPhysics::COLLISION_OBJECT_TYPE_DYNAMIC;
+    data.m_Mass = 1.0f;
+
+    VisualObject vo_near;
+    vo_near.m_Position = dmVMath::Point3(0.0f, 0.0f, 0.0f);
+    data.m_UserData = &vo_near;
+    dmPhysics::HCollisionObject2D near_co = dmPhysics::NewCollisionObject2D(world, data, &shape, 1u);
+
+    VisualObject vo_far;
+    vo_far.m_Position = dmVMath::Point3(1000.0f, 0.0f, 0.0f);
+    data.m_UserData = &vo_far;
+    dmPhysics::HCollisionObject2D far_co = dmPhysics::NewCollisionObject2D(world, data, &shape, 1u);
+
+    // Without focus, all regions are simulated
+    dmPhysics::StepWorld2D(world, step_context);
+    ASSERT_EQ(0u, dmPhysics::GetFrozenCollisionObjectCount2D(world));
+    ASSERT_GT(0.0f, vo_far.m_Position.getY());
+
+    dmPhysics::SetRegionFocus2D(world, dmVMath::Point3(10.0f, 10.0f, 0.0f));
+    dmPhysics::StepWorld2D(world, step_context);
+    ASSERT_EQ(1u, dmPhysics::GetFrozenCollisionObjectCount2D(world));
+    ASSERT_TRUE(dmPhysics::IsEnabled2D(near_co));
+    ASSERT_FALSE(dmPhysics::IsEnabled2D(far_co));
+
+    float far_y = vo_far.m_Position.getY();
+    float near_y = vo_near.m_Position.getY();
+    for (uint32_t i = 0; i < 10; ++i)
+        dmPhysics::StepWorld2D(world, step_context);
+    ASSERT_EQ(far_y, vo_far.m_Position.getY());
+    ASSERT_GT(near_y, vo_near.m_Position.getY());
+
+    // The frozen object keeps its velocity
+    dmPhysics::SetRegionFocus2D(world, dmVMath::Point3(1000.0f, 0.0f, 0.0f));
+    dmPhysics::StepWorld2D(world, step_context);
+    ASSERT_EQ(1u, dmPhysics::GetFrozenCollisionObjectCount2D(world));
+    ASSERT_TRUE(dmPhysics::IsEnabled2D(far_co));
+    ASSERT_FALSE(dmPhysics::IsEnabled2D(near_co));
+    ASSERT_GT(far_y, vo_far.m_Position.getY());
+    ASSERT_GT(0.0f, dmPhysics::GetLinearVelocity2D(context, near_co).getY());
+
+    // Disabling a frozen object keeps it disabled when its region is simulated again
+    dmPhysics::SetEnabled2D(world, near_co, false);
+    ASSERT_EQ(0u, dmPhysics::GetFrozenCollisionObjectCount2D(world));
+    dmPhysics::SetRegionFocus2D(world, dmVMath::Point3(0.0f, 0.0f, 0.0f));
+    dmPhysics::StepWorld2D(world, step_context);
+    ASSERT_FALSE(dmPhysics::IsEnabled2D(near_co));
+    ASSERT_EQ(1u, dmPhysics::GetFrozenCollisionObjectCount2D(world));
+
+    dmPhysics::DeleteCollisionObject2D(world, far_co);
+    ASSERT_EQ(0u, dmPhysics::GetFrozenCollisionObjectCount2D(world));
+    dmPhysics::DeleteCollisionObject2D(world, near_co);
+    dmPhysics::DeleteCollisionShape2D(shape);
+    dmPhysics::DeleteWorld2D(context, world);
+    dmPhysics::DeleteContext2D(context);
+}
+
 int main(int argc, char **argv)
 {
     jc_test_init(&argc, argv);
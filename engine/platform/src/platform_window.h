@@ -30,6 +30,8 @@ namespace dmPlatform
     typedef void (*WindowAddKeyboardCharCallback)(void* user_data, int chr);
     typedef void (*WindowSetMarkedTextCallback)(void* user_data, char* text);
     typedef void (*WindowDeviceChangedCallback)(void* user_data, int status);
+    // Called for every press and release (not repeat) of a key or mouse button, with the platform key/button value
+    typedef void (*WindowButtonCallback)(void* user_data, int button, int pressed);
 
     enum PlatformResult
     {
@@ -189,6 +191,8 @@ namespace dmPlatform
     void           SetKeyboardMarkedTextCallback(HWindow window, WindowSetMarkedTextCallback cb, void* user_data);
     void           SetKeyboardDeviceChangedCallback(HWindow window, WindowDeviceChangedCallback cb, void* user_data);
     void           SetGamepadEventCallback(HWindow window, WindowGamepadEventCallback cb, void* user_data);
+    void           SetKeyCallback(HWindow window, WindowButtonCallback cb, void* user_data);
+    void           SetMouseButtonCallback(HWindow window, WindowButtonCallback cb, void* user_data);
 
     void           ShowWindow(HWindow window);
     void           IconifyWindow(HWindow window);
@@ -47,6 +47,10 @@ namespace dmPlatform
         void*                         m_DeviceChangedCallbackUserData;
         WindowGamepadEventCallback    m_GamepadEventCallback;
         void*                         m_GamepadEventCallbackUserData;
+        WindowButtonCallback          m_KeyCallback;
+        void*                         m_KeyCallbackUserData;
+        WindowButtonCallback          m_MouseButtonCallback;
+        void*                         m_MouseButtonCallbackUserData;
         dmArray<GLFWTouch>            m_TouchData;
         int32_t                       m_Width;
         int32_t                       m_Height;
@@ -125,6 +129,22 @@ namespace dmPlatform
         }
     }
 
+    static void OnKey(int key, int action)
+    {
+        if (g_Window->m_KeyCallback)
+        {
+            g_Window->m_KeyCallback(g_Window->m_KeyCallbackUserData, key, action == GLFW_PRESS);
+        }
+    }
+
+    static void OnMouseButton(int button, int action)
+    {
+        if (g_Window->m_MouseButtonCallback)
+        {
+            g_Window->m_MouseButtonCallback(g_Window->m_MouseButtonCallbackUserData, button, action == GLFW_PRESS);
+        }
+    }
+
     static void OnGamepad(int gamepad_id, int connected)
     {
         if (g_Window->m_GamepadEventCallback)
@@ -284,6 +304,8 @@ namespace dmPlatform
             glfwSetWindowFocusCallback(OnWindowFocus);
             glfwSetWindowIconifyCallback(OnWindowIconify);
             glfwSetGamepadCallback(OnGamepad);
+            glfwSetKeyCallback(OnKey);
+            glfwSetMouseButtonCallback(OnMouseButton);
             glfwSwapInterval(1);
             glfwGetWindowSize(&window->m_Width, &window->m_Height);
 
@@ -646,6 +668,18 @@ namespace dmPlatform
         window->m_GamepadEventCallbackUserData = user_data;
     }
 
+    void SetKeyCallback(HWindow window, WindowButtonCallback cb, void* user_data)
+    {
+        window->m_KeyCallback         = cb;
+        window->m_KeyCallbackUserData = user_data;
+    }
+
+    void SetMouseButtonCallback(HWindow window, WindowButtonCallback cb, void* user_data)
+    {
+        window->m_MouseButtonCallback         = cb;
+        window->m_MouseButtonCallbackUserData = user_data;
+    }
+
     const char** VulkanGetRequiredInstanceExtensions(uint32_t* count)
     {
         *count = 0;
@@ -101,6 +101,24 @@ namespace dmPlatform
         }
     }
 
+    static void OnKey(GLFWwindow* glfw_window, int key, int scancode, int action, int mods)
+    {
+        HWindow window = (HWindow) glfwGetWindowUserPointer(glfw_window);
+        if (window->m_KeyCallback && action != GLFW_REPEAT)
+        {
+            window->m_KeyCallback(window->m_KeyCallbackUserData, key, action == GLFW_PRESS);
+        }
+    }
+
+    static void OnMouseButton(GLFWwindow* glfw_window, int button, int action, int mods)
+    {
+        HWindow window = (HWindow) glfwGetWindowUserPointer(glfw_window);
+        if (window->m_MouseButtonCallback)
+        {
+            window->m_MouseButtonCallback(window->m_MouseButtonCallbackUserData, button, action == GLFW_PRESS);
+        }
+    }
+
     static void OnContentScaleCallback(GLFWwindow* glfw_window, float xscale, float yscale)
     {
         (void)xscale;
@@ -273,6 +291,8 @@ namespace dmPlatform
             glfwSetWindowFocusCallback(window->m_Window, OnWindowFocus);
             glfwSetWindowIconifyCallback(window->m_Window, OnWindowIconify);
             glfwSetScrollCallback(window->m_Window, OnMouseScroll);
+            glfwSetKeyCallback(window->m_Window, OnKey);
+            glfwSetMouseButtonCallback(window->m_Window, OnMouseButton);
             glfwSetCharCallback(window->m_Window, OnAddCharacterCallback);
             glfwSetMarkedTextCallback(window->m_Window, OnMarkedTextCallback);
             glfwSetWindowContentScaleCallback(window->m_Window, OnContentScaleCallback);
@@ -576,6 +596,18 @@ namespace dmPlatform
         g_GLFW3Context.m_GamepadEventCallbackUserData = user_data;
     }
 
+    void SetKeyCallback(HWindow window, WindowButtonCallback cb, void* user_data)
+    {
+        window->m_KeyCallback         = cb;
+        window->m_KeyCallbackUserData = user_data;
+    }
+
+    void SetMouseButtonCallback(HWindow window, WindowButtonCallback cb, void* user_data)
+    {
+        window->m_MouseButtonCallback         = cb;
+        window->m_MouseButtonCallbackUserData = user_data;
+    }
+
     const int PLATFORM_KEY_START           = 32;
     const int PLATFORM_JOYSTICK_LAST       = GLFW_JOYSTICK_LAST;
     const int PLATFORM_KEY_ESC             = GLFW_KEY_ESCAPE;
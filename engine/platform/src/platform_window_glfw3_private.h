@@ -40,6 +40,10 @@ namespace dmPlatform
         void*                         m_SetMarkedTextCallbackUserData;
         WindowDeviceChangedCallback   m_DeviceChangedCallback;
         void*                         m_DeviceChangedCallbackUserData;
+        WindowButtonCallback          m_KeyCallback;
+        void*                         m_KeyCallbackUserData;
+        WindowButtonCallback          m_MouseButtonCallback;
+        void*                         m_MouseButtonCallbackUserData;
         double                        m_MouseScrollX;
         double                        m_MouseScrollY;
         int32_t                       m_Width;
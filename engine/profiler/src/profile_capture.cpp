@@ -0,0 +1,430 @@
+// Copyright 2020-2024 The Defold Foundation
+// Copyright 2014-2020 King
+// Copyright 2009-2014 Ragnar Svensson, Christian Murray
+// Licensed under the Defold License version 1.0 (the "License"); you may not use
+// this file except in compliance with the License.
+//
+// You may obtain a copy of the License, together with FAQs at
+// https://www.defold.com/license
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "profile_capture.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <dlib/array.h>
+#include <dlib/dstrings.h>
+#include <dlib/hash.h>
+#include <dlib/hashtable.h>
+
+namespace dmProfileCapture
+{
+    struct CaptureSample
+    {
+        uint64_t m_Start;
+        uint64_t m_Time;
+        uint32_t m_NameHash;
+        uint16_t m_Thread;
+        uint16_t m_Depth;
+    };
+
+    struct CaptureCounter
+    {
+        double   m_Value;
+        uint32_t m_NameHash;
+    };
+
+    struct CaptureFrame
+    {
+        dmArray<CaptureSample>  m_Samples;
+        dmArray<CaptureCounter> m_Counters;
+        uint64_t                m_Start;
+        uint64_t                m_Time;
+    };
+
+    struct Capture
+    {
+        // The ring buffer has one extra frame, which is the frame currently being recorded
+        dmArray<CaptureFrame*>      m_Frames;
+        uint32_t                    m_FirstFrame;
+        uint32_t                    m_FrameCount;
+        uint32_t                    m_MaxFrameCount;
+
+        dmHashTable32<const char*>  m_Names;
+        dmArray<const char*>        m_ThreadNames;
+        dmHashTable32<uint32_t>     m_ThreadIndices;
+
+        uint64_t                    m_TicksPerSecond;
+        uint64_t                    m_SpikeThreshold;
+        uint64_t                    m_LastFrameStart;
+        int64_t                     m_GpuOffset;
+        uint32_t                    m_GpuThread;
+        CaptureState                m_State;
+        uint8_t                     m_HasGpuOffset : 1;
+    };
+
+    static void FreeName(void*, const uint32_t*, const char** name)
+    {
+        free((void*)*name);
+    }
+
+    HCapture New(uint64_t ticks_per_second)
+    {
+        Capture* capture = new Capture;
+        capture->m_FirstFrame = 0;
+        capture->m_FrameCount = 0;
+        capture->m_MaxFrameCount = 0;
+        capture->m_TicksPerSecond = ticks_per_second;
+        capture->m_SpikeThreshold = 0;
+        capture->m_LastFrameStart = 0;
+        capture->m_GpuOffset = 0;
+        capture->m_State = CAPTURE_STATE_IDLE;
+        capture->m_HasGpuOffset = 0;
+        capture->m_GpuThread = GetThreadIndex(capture, "GPU");
+        return capture;
+    }
+
+    static void DeleteFrames(HCapture capture)
+    {
+        for (uint32_t i = 0; i < capture->m_Frames.Size(); ++i)
+        {
+            delete capture->m_Frames[i];
+        }
+        capture->m_Frames.SetSize(0);
+    }
+
+    void Delete(HCapture capture)
+    {
+        DeleteFrames(capture);
+        capture->m_Names.Iterate(FreeName, (void*)0);
+        for (uint32_t i = 0; i < capture->m_ThreadNames.Size(); ++i)
+        {
+            free((void*)capture->m_ThreadNames[i]);
+        }
+        delete capture;
+    }
+
+    static inline CaptureFrame* GetCurrentFrame(HCapture capture)
+    {
+        return capture->m_Frames[(capture->m_FirstFrame + capture->m_FrameCount) % capture->m_Frames.Size()];
+    }
+
+    static void ClearFrame(CaptureFrame* frame)
+    {
+        frame->m_Samples.SetSize(0);
+        frame->m_Counters.SetSize(0);
+        frame->m_Start = 0;
+        frame->m_Time = 0;
+    }
+
+    void Start(HCapture capture, uint32_t frame_count, uint64_t spike_threshold)
+    {
+        if (frame_count == 0)
+            frame_count = 1;
+
+        // Keep the already allocated sample arrays around if the size doesn't change
+        if (capture->m_Frames.Size() != frame_count + 1)
+        {
+            DeleteFrames(capture);
+            capture->m_Frames.SetCapacity(frame_count + 1);
+            for (uint32_t i = 0; i < frame_count + 1; ++i)
+            {
+                capture->m_Frames.Push(new CaptureFrame);
+            }
+        }
+        for (uint32_t i = 0; i < capture->m_Frames.Size(); ++i)
+        {
+            ClearFrame(capture->m_Frames[i]);
+        }
+
+        capture->m_FirstFrame = 0;
+        capture->m_FrameCount = 0;
+        capture->m_MaxFrameCount = frame_count;
+        capture->m_SpikeThreshold = spike_threshold;
+        capture->m_HasGpuOffset = 0;
+        capture->m_State = CAPTURE_STATE_RECORDING;
+    }
+
+    void Stop(HCapture capture)
+    {
+        if (capture->m_State == CAPTURE_STATE_RECORDING)
+            capture->m_State = capture->m_FrameCount > 0 ? CAPTURE_STATE_DONE : CAPTURE_STATE_IDLE;
+    }
+
+    CaptureState GetState(HCapture capture)
+    {
+        return capture->m_State;
+    }
+
+    uint32_t GetFrameCount(HCapture capture)
+    {
+        return capture->m_FrameCount;
+    }
+
+    static uint32_t InternName(HCapture capture, const char* name)
+    {
+        if (name == 0 || name[0] == 0)
+            name = "<empty>";
+
+        uint32_t name_hash = dmHashString32(name);
+        if (capture->m_Names.Get(name_hash) == 0)
+        {
+            if (capture->m_Names.Full())
+            {
+                uint32_t capacity = capture->m_Names.Capacity() + 256;
+                capture->m_Names.SetCapacity(capacity / 2 + 1, capacity);
+            }
+            capture->m_Names.Put(name_hash, strdup(name));
+        }
+        return name_hash;
+    }
+
+    uint32_t GetThreadIndex(HCapture capture, const char* thread_name)
+    {
+        uint32_t name_hash = dmHashString32(thread_name);
+        uint32_t* index = capture->m_ThreadIndices.Get(name_hash);
+        if (index)
+            return *index;
+
+        if (capture->m_ThreadIndices.Full())
+        {
+            uint32_t capacity = capture->m_ThreadIndices.Capacity() + 16;
+            capture->m_ThreadIndices.SetCapacity(capacity / 2 + 1, capacity);
+        }
+        if (capture->m_ThreadNames.Full())
+            capture->m_ThreadNames.OffsetCapacity(16);
+
+        uint32_t new_index = capture->m_ThreadNames.Size();
+        capture->m_ThreadNames.Push(strdup(thread_name));
+        capture->m_ThreadIndices.Put(name_hash, new_index);
+        return new_index;
+    }
+
+    void AddSample(HCapture capture, uint32_t thread, const char* name, uint32_t depth, uint64_t start, uint64_t time)
+    {
+        if (capture->m_State != CAPTURE_STATE_RECORDING)
+            return;
+
+        CaptureFrame* frame = GetCurrentFrame(capture);
+
+        CaptureSample sample;
+        sample.m_Start = start;
+        sample.m_Time = time;
+        sample.m_NameHash = InternName(capture, name);
+        sample.m_Thread = (uint16_t)thread;
+        sample.m_Depth = (uint16_t)depth;
+
+        if (frame->m_Samples.Full())
+            frame->m_Samples.OffsetCapacity(256);
+        frame->m_Samples.Push(sample);
+    }
+
+    void AddCounter(HCapture capture, const char* name, double value)
+    {
+        if (capture->m_State != CAPTURE_STATE_RECORDING)
+            return;
+
+        CaptureFrame* frame = GetCurrentFrame(capture);
+
+        CaptureCounter counter;
+        counter.m_Value = value;
+        counter.m_NameHash = InternName(capture, name);
+
+        if (frame->m_Counters.Full())
+            frame->m_Counters.OffsetCapacity(64);
+        frame->m_Counters.Push(counter);
+    }
+
+    void AddGpuSample(HCapture capture, const char* name, uint32_t depth, uint64_t start, uint64_t time)
+    {
+        if (capture->m_State != CAPTURE_STATE_RECORDING)
+            return;
+
+        if (!capture->m_HasGpuOffset)
+        {
+            if (capture->m_LastFrameStart == 0)
+                return; // We need a cpu frame to align to
+            capture->m_GpuOffset = (int64_t)capture->m_LastFrameStart - (int64_t)start;
+            capture->m_HasGpuOffset = 1;
+        }
+        AddSample(capture, capture->m_GpuThread, name, depth, (uint64_t)((int64_t)start + capture->m_GpuOffset), time);
+    }
+
+    void EndFrame(HCapture capture, uint64_t start, uint64_t time)
+    {
+        if (capture->m_State != CAPTURE_STATE_RECORDING)
+            return;
+
+        CaptureFrame* frame = GetCurrentFrame(capture);
+        frame->m_Start = start;
+        frame->m_Time = time;
+
+        // Realign the gpu scopes each frame, as the clocks drift apart
+        capture->m_LastFrameStart = start;
+        capture->m_HasGpuOffset = 0;
+
+        if (capture->m_FrameCount < capture->m_MaxFrameCount)
+        {
+            capture->m_FrameCount++;
+        }
+        else
+        {
+            capture->m_FirstFrame = (capture->m_FirstFrame + 1) % capture->m_Frames.Size();
+        }
+        ClearFrame(GetCurrentFrame(capture));
+
+        if (capture->m_SpikeThreshold != 0)
+        {
+            if (time >= capture->m_SpikeThreshold)
+                capture->m_State = CAPTURE_STATE_DONE;
+        }
+        else if (capture->m_FrameCount == capture->m_MaxFrameCount)
+        {
+            capture->m_State = CAPTURE_STATE_DONE;
+        }
+    }
+
+    // *******************************************************************
+
+    struct TraceWriter
+    {
+        char            m_Buffer[4096];
+        uint32_t        m_Size;
+        FWriteCallback  m_Callback;
+        void*           m_Context;
+        bool            m_First;
+    };
+
+    static void Flush(TraceWriter* writer)
+    {
+        if (writer->m_Size > 0)
+            writer->m_Callback(writer->m_Context, writer->m_Buffer, writer->m_Size);
+        writer->m_Size = 0;
+    }
+
+    static void Write(TraceWriter* writer, const char* text, uint32_t length)
+    {
+        while (length > 0)
+        {
+            uint32_t remaining = sizeof(writer->m_Buffer) - writer->m_Size;
+            if (remaining == 0)
+            {
+                Flush(writer);
+                continue;
+            }
+            uint32_t n = length < remaining ? length : remaining;
+            memcpy(writer->m_Buffer + writer->m_Size, text, n);
+            writer->m_Size += n;
+            text += n;
+            length -= n;
+        }
+    }
+
+    static void Write(TraceWriter* writer, const char* text)
+    {
+        Write(writer, text, (uint32_t)strlen(text));
+    }
+
+    static void WriteString(TraceWriter* writer, const char* text)
+    {
+        Write(writer, "\"", 1);
+        for (const char* c = text; *c; ++c)
+        {
+            if (*c == '"' || *c == '\\')
+            {
+                char escaped[2] = {'\\', *c};
+                Write(writer, escaped, 2);
+            }
+            else if ((unsigned char)*c < 0x20)
+            {
+                Write(writer, " ", 1);
+            }
+            else
+            {
+                Write(writer, c, 1);
+            }
+        }
+        Write(writer, "\"", 1);
+    }
+
+    static void BeginEvent(TraceWriter* writer)
+    {
+        Write(writer, writer->m_First ? "\n" : ",\n");
+        writer->m_First = false;
+    }
+
+    static const char* GetName(HCapture capture, uint32_t name_hash)
+    {
+        const char** name = capture->m_Names.Get(name_hash);
+        return name ? *name : "<unknown>";
+    }
+
+    // The trace event timestamps are in microseconds
+    static double ToMicroSeconds(HCapture capture, uint64_t ticks)
+    {
+        return (double)ticks * 1000000.0 / (double)capture->m_TicksPerSecond;
+    }
+
+    bool WriteChromeTrace(HCapture capture, FWriteCallback callback, void* ctx)
+    {
+        if (capture->m_FrameCount == 0)
+            return false;
+
+        TraceWriter writer;
+        writer.m_Size = 0;
+        writer.m_Callback = callback;
+        writer.m_Context = ctx;
+        writer.m_First = true;
+
+        char buffer[256];
+
+        Write(&writer, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [");
+
+        for (uint32_t i = 0; i < capture->m_ThreadNames.Size(); ++i)
+        {
+            BeginEvent(&writer);
+            dmSnPrintf(buffer, sizeof(buffer), "{\"ph\": \"M\", \"pid\": 1, \"tid\": %u, \"name\": \"thread_name\", \"args\": {\"name\": ", i);
+            Write(&writer, buffer);
+            WriteString(&writer, capture->m_ThreadNames[i]);
+            Write(&writer, "}}");
+        }
+
+        for (uint32_t f = 0; f < capture->m_FrameCount; ++f)
+        {
+            const CaptureFrame& frame = *capture->m_Frames[(capture->m_FirstFrame + f) % capture->m_Frames.Size()];
+
+            for (uint32_t i = 0; i < frame.m_Samples.Size(); ++i)
+            {
+                const CaptureSample& sample = frame.m_Samples[i];
+                BeginEvent(&writer);
+                dmSnPrintf(buffer, sizeof(buffer), "{\"ph\": \"X\", \"pid\": 1, \"tid\": %u, \"ts\": %.3f, \"dur\": %.3f, \"name\": ",
+                            sample.m_Thread, ToMicroSeconds(capture, sample.m_Start), ToMicroSeconds(capture, sample.m_Time));
+                Write(&writer, buffer);
+                WriteString(&writer, GetName(capture, sample.m_NameHash));
+                Write(&writer, "}");
+            }
+
+            // The property values are sampled once per frame, at the end of the frame
+            double counter_ts = ToMicroSeconds(capture, frame.m_Start + frame.m_Time);
+            for (uint32_t i = 0; i < frame.m_Counters.Size(); ++i)
+            {
+                const CaptureCounter& counter = frame.m_Counters[i];
+                BeginEvent(&writer);
+                Write(&writer, "{\"ph\": \"C\", \"pid\": 1, \"name\": ");
+                WriteString(&writer, GetName(capture, counter.m_NameHash));
+                dmSnPrintf(buffer, sizeof(buffer), ", \"ts\": %.3f, \"args\": {\"value\": %g}}", counter_ts, counter.m_Value);
+                Write(&writer, buffer);
+            }
+        }
+
+        dmSnPrintf(buffer, sizeof(buffer), "\n], \"otherData\": {\"frame_count\": %u}}\n", capture->m_FrameCount);
+        Write(&writer, buffer);
+        Flush(&writer);
+        return true;
+    }
+}
@@ -0,0 +1,75 @@
+// Copyright 2020-2024 The Defold Foundation
+// Copyright 2014-2020 King
+// Copyright 2009-2014 Ragnar Svensson, Christian Murray
+// Licensed under the Defold License version 1.0 (the "License"); you may not use
+// this file except in compliance with the License.
+//
+// You may obtain a copy of the License, together with FAQs at
+// https://www.defold.com/license
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#ifndef DM_PROFILE_CAPTURE_H
+#define DM_PROFILE_CAPTURE_H
+
+#include <stdint.h>
+
+namespace dmProfileCapture
+{
+    /**
+     * A frame capture keeps a ring buffer of the last N profiled frames (samples from all threads,
+     * property values and gpu scopes), and can export them as a Chrome trace event json file, which
+     * can be opened in chrome://tracing or https://ui.perfetto.dev
+     *
+     * The capture is not thread safe, the caller is responsible for the locking.
+     */
+    typedef struct Capture* HCapture;
+
+    enum CaptureState
+    {
+        CAPTURE_STATE_IDLE,
+        CAPTURE_STATE_RECORDING,
+        CAPTURE_STATE_DONE,
+    };
+
+    HCapture     New(uint64_t ticks_per_second);
+    void         Delete(HCapture capture);
+
+    /**
+     * Start a new capture, discarding any previously recorded frames
+     * @param frame_count The max number of frames to keep
+     * @param spike_threshold If 0, the capture stops after frame_count frames. Otherwise, the capture
+     *                        keeps recording the last frame_count frames until the main thread frame time
+     *                        is at least spike_threshold ticks long.
+     */
+    void         Start(HCapture capture, uint32_t frame_count, uint64_t spike_threshold);
+    void         Stop(HCapture capture);
+    CaptureState GetState(HCapture capture);
+    uint32_t     GetFrameCount(HCapture capture);
+
+    // Get the index of a thread, registering it if needed
+    uint32_t     GetThreadIndex(HCapture capture, const char* thread_name);
+
+    // Times are in ticks
+    void         AddSample(HCapture capture, uint32_t thread, const char* name, uint32_t depth, uint64_t start, uint64_t time);
+    void         AddCounter(HCapture capture, const char* name, double value);
+
+    // The gpu timings use a different clock, so they're aligned to the start of the previous cpu frame
+    void         AddGpuSample(HCapture capture, const char* name, uint32_t depth, uint64_t start, uint64_t time);
+
+    // Completes the frame, using the main thread root sample as the frame time
+    void         EndFrame(HCapture capture, uint64_t start, uint64_t time);
+
+    typedef void (*FWriteCallback)(void* ctx, const char* data, uint32_t size);
+
+    /**
+     * Write the recorded frames in the Chrome trace event json format.
+     * @return false if there are no recorded frames
+     */
+    bool         WriteChromeTrace(HCapture capture, FWriteCallback callback, void* ctx);
+}
+
+#endif // DM_PROFILE_CAPTURE_H
@@ -17,6 +17,7 @@
 #include <dlib/dlib.h>
 #include <dlib/hash.h>
 #include <dlib/log.h>
+#include <dlib/math.h>
 #include <dlib/profile.h>
 #include <dlib/time.h>
 
@@ -24,8 +25,10 @@
 #include <script/script.h>
 
 #include "profiler_private.h"
+#include "profile_capture.h"
 #include "profile_render.h"
 
+#include <stdio.h>
 #include <algorithm> // std::sort
 
 #include <dmsdk/dlib/vmath.h>
@@ -56,6 +59,7 @@ static uint32_t gUpdateFrequency = 60;
 static dmProfileRender::ProfilerFrame*  g_ProfilerCurrentFrame = 0;
 static dmMutex::HMutex                  g_ProfilerMutex = 0;
 static dmHashTable64<int>               g_ProfilerThreadSortOrder;
+static dmProfileCapture::HCapture       g_ProfilerCapture = 0;
 
 
 void SetUpdateFrequency(uint32_t update_frequency)
@@ -92,14 +96,129 @@ struct ThreadSortPred
 };
 
 
+static void GpuScopeCallback(void* _ctx, const char* name, uint32_t depth, uint64_t start, uint64_t time)
+{
+    dmProfileRender::ProfilerThread* thread = (dmProfileRender::ProfilerThread*)_ctx;
+
+    // The gpu times are in microseconds
+    uint64_t ticks_per_second = dmProfile::GetTicksPerSecond();
+
+    dmProfileRender::ProfilerSample out;
+    out.m_StartTime = start * ticks_per_second / 1000000;
+    out.m_Time = time * ticks_per_second / 1000000;
+    out.m_SelfTime = out.m_Time;
+    out.m_Count = 1;
+    out.m_Color = 0;
+    out.m_Indent = (uint8_t)depth;
+    out.m_NameHash = dmHashString32(name);
+
+    // The self time excludes the time of the child scopes
+    for (uint32_t i = thread->m_Samples.Size(); i > 0; --i)
+    {
+        dmProfileRender::ProfilerSample& parent = thread->m_Samples[i-1];
+        if (parent.m_Indent < out.m_Indent)
+        {
+            parent.m_SelfTime -= dmMath::Min(parent.m_SelfTime, out.m_Time);
+            break;
+        }
+    }
+
+    if (depth == 0)
+        thread->m_SamplesTotalTime += out.m_Time;
+
+    if (thread->m_Samples.Full())
+        thread->m_Samples.OffsetCapacity(32);
+    thread->m_Samples.Push(out);
+}
+
+static void CountGpuScopesCallback(void* _ctx, const char* name, uint32_t depth, uint64_t start, uint64_t time)
+{
+    (*(uint32_t*)_ctx)++;
+}
+
+// Adds the gpu timings as a separate "GPU" thread
+static void UpdateGpuThread(dmProfileRender::ProfilerFrame* frame, dmGraphics::HContext graphics_context)
+{
+    // Not all graphics backends support gpu timings
+    uint32_t count = 0;
+    dmGraphics::IterateGpuScopes(graphics_context, CountGpuScopesCallback, &count);
+    if (count == 0)
+        return;
+
+    static const uint32_t gpu_name_hash = dmHashString32("GPU");
+    dmProfileRender::ProfilerThread* thread = dmProfileRender::FindOrCreateProfilerThread(frame, gpu_name_hash);
+    dmProfileRender::ClearProfilerThreadSamples(thread);
+    thread->m_Time = frame->m_Time;
+    thread->m_SamplesTotalTime = 0;
+    if (thread->m_Samples.Capacity() < count)
+        thread->m_Samples.SetCapacity(count);
+    dmGraphics::IterateGpuScopes(graphics_context, GpuScopeCallback, thread);
+}
+
+static void CaptureGpuScopeCallback(void* _ctx, const char* name, uint32_t depth, uint64_t start, uint64_t time)
+{
+    // The gpu times are in microseconds
+    uint64_t ticks_per_second = dmProfile::GetTicksPerSecond();
+    dmProfileCapture::AddGpuSample(g_ProfilerCapture, name, depth, start * ticks_per_second / 1000000, time * ticks_per_second / 1000000);
+}
+
+void StartCapture(uint32_t frame_count, float spike_threshold_ms)
+{
+    if (!g_ProfilerCapture)
+    {
+        dmLogWarning("The profiler isn't initialized, unable to capture frames");
+        return;
+    }
+    DM_MUTEX_SCOPED_LOCK(g_ProfilerMutex);
+    uint64_t spike_threshold = 0;
+    if (spike_threshold_ms > 0.0f)
+        spike_threshold = (uint64_t)(spike_threshold_ms * dmProfile::GetTicksPerSecond() / 1000.0);
+    dmProfileCapture::Start(g_ProfilerCapture, frame_count, spike_threshold);
+}
+
+void StopCapture()
+{
+    if (!g_ProfilerCapture)
+        return;
+    DM_MUTEX_SCOPED_LOCK(g_ProfilerMutex);
+    dmProfileCapture::Stop(g_ProfilerCapture);
+}
+
+bool IsCapturing()
+{
+    if (!g_ProfilerCapture)
+        return false;
+    DM_MUTEX_SCOPED_LOCK(g_ProfilerMutex);
+    return dmProfileCapture::GetState(g_ProfilerCapture) == dmProfileCapture::CAPTURE_STATE_RECORDING;
+}
+
+bool WriteCapture(FCaptureWriteCallback callback, void* ctx)
+{
+    if (!g_ProfilerCapture)
+        return false;
+    DM_MUTEX_SCOPED_LOCK(g_ProfilerMutex);
+    return dmProfileCapture::WriteChromeTrace(g_ProfilerCapture, callback, ctx);
+}
+
 void RenderProfiler(dmProfile::HProfile profile, dmGraphics::HContext graphics_context, dmRender::HRenderContext render_context, dmRender::HFontMap system_font_map)
 {
+    if (g_ProfilerCapture)
+    {
+        DM_MUTEX_SCOPED_LOCK(g_ProfilerMutex);
+        if (dmProfileCapture::GetState(g_ProfilerCapture) == dmProfileCapture::CAPTURE_STATE_RECORDING)
+        {
+            dmGraphics::IterateGpuScopes(graphics_context, CaptureGpuScopeCallback, 0);
+        }
+    }
+
     if(gRenderProfile && g_ProfilerCurrentFrame)
     {
         DM_MUTEX_SCOPED_LOCK(g_ProfilerMutex);
 
         DM_PROFILE("RenderProfiler");
 
+        UpdateGpuThread(g_ProfilerCurrentFrame, graphics_context);
+
         // Make sure the main thread is at the front so it's picked by default
         std::sort(g_ProfilerCurrentFrame->m_Threads.Begin(), g_ProfilerCurrentFrame->m_Threads.End(), ThreadSortPred(&g_ProfilerThreadSortOrder));
 
@@ -521,6 +640,192 @@ static int ProfilerScopeEnd(lua_State* L)
 }
 
 
+/*# start capturing profiled frames
+ *
+ * Starts capturing the profiled frames of all threads, including the property values and gpu timings.
+ * The capture can be saved with `profiler.save_capture()` when it's done, and opened in
+ * chrome://tracing or [Perfetto](https://ui.perfetto.dev).
+ *
+ * If a spike threshold is given, the capture instead keeps recording the last `frame_count` frames,
+ * until a frame takes at least `spike_threshold` milliseconds. The slow frame is the last frame of the capture.
+ *
+ * @note The capture is also available from the engine service at `http://<ip>:<port>/profile_capture`
+ *
+ * @name profiler.start_capture
+ * @param frame_count [type:number] the number of frames to capture
+ * @param [spike_threshold] [type:number] the frame time in milliseconds that stops the capture
+ *
+ * @examples
+ * ```lua
+ * -- Capture the frames leading up to the first frame longer than 50ms
+ * profiler.start_capture(120, 50)
+ * ...
+ * if not profiler.is_capturing() then
+ *     profiler.save_capture("spike.json")
+ * end
+ * ```
+ */
+static int ProfilerStartCapture(lua_State* L)
+{
+    DM_LUA_STACK_CHECK(L, 0);
+
+    int frame_count = luaL_checkinteger(L, 1);
+    if (frame_count <= 0)
+    {
+        return DM_LUA_ERROR("Expected a frame count larger than zero, got %d", frame_count);
+    }
+    float spike_threshold = (float)luaL_optnumber(L, 2, 0.0);
+
+    StartCapture((uint32_t)frame_count, spike_threshold);
+    return 0;
+}
+
+/*# stop capturing profiled frames
+ *
+ * Stops an ongoing capture, keeping the frames captured so far.
+ *
+ * @name profiler.stop_capture
+ */
+static int ProfilerStopCapture(lua_State* L)
+{
+    DM_LUA_STACK_CHECK(L, 0);
+    StopCapture();
+    return 0;
+}
+
+/*# check if the profiler is capturing frames
+ *
+ * @name profiler.is_capturing
+ * @return capturing [type:boolean] true if frames are being captured
+ */
+static int ProfilerIsCapturing(lua_State* L)
+{
+    DM_LUA_STACK_CHECK(L, 1);
+    lua_pushboolean(L, IsCapturing());
+    return 1;
+}
+
+static void WriteCaptureToFile(void* ctx, const char* data, uint32_t size)
+{
+    fwrite(data, 1, size, (FILE*)ctx);
+}
+
+/*# save the captured frames to a file
+ *
+ * Saves the captured frames in the Chrome trace event json format.
+ *
+ * @name profiler.save_capture
+ * @param path [type:string] the path of the file to write
+ * @return success [type:boolean] true if the capture was saved, false if there were no captured frames or the file couldn't be written
+ */
+static int ProfilerSaveCapture(lua_State* L)
+{
+    DM_LUA_STACK_CHECK(L, 1);
+
+    const char* path = luaL_checkstring(L, 1);
+
+    FILE* file = fopen(path, "wb");
+    if (!file)
+    {
+        dmLogError("Failed to open '%s' for writing", path);
+        lua_pushboolean(L, 0);
+        return 1;
+    }
+
+    bool result = WriteCapture(WriteCaptureToFile, file);
+    fclose(file);
+
+    lua_pushboolean(L, result);
+    return 1;
+}
+
+/*# start sampling the Lua code
+ *
+ * Starts a sampling profiler for the Lua code, which records the Lua call stack every
+ * `instruction_count` Lua VM instructions. Any previous samples are discarded.
+ * A lower count gives more accurate results, at a higher cost.
+ *
+ * @note While sampling, the LuaJIT compiler is disabled, and the debugger hook is replaced
+ *
+ * @name profiler.start_lua_sampling
+ * @param [instruction_count] [type:number] the number of instructions between two samples. Defaults to 1000.
+ *
+ * @examples
+ * ```lua
+ * profiler.start_lua_sampling()
+ * ...
+ * profiler.stop_lua_sampling()
+ * profiler.save_lua_samples("lua.folded")
+ * ```
+ */
+static int ProfilerStartLuaSampling(lua_State* L)
+{
+    DM_LUA_STACK_CHECK(L, 0);
+
+    int instruction_count = luaL_optinteger(L, 1, 1000);
+    if (instruction_count <= 0)
+    {
+        return DM_LUA_ERROR("Expected an instruction count larger than zero, got %d", instruction_count);
+    }
+
+    dmScript::StartLuaSampling(dmScript::GetMainThread(L), (uint32_t)instruction_count);
+    return 0;
+}
+
+/*# stop sampling the Lua code
+ *
+ * Stops the sampling, keeping the samples until the next start.
+ *
+ * @name profiler.stop_lua_sampling
+ */
+static int ProfilerStopLuaSampling(lua_State* L)
+{
+    DM_LUA_STACK_CHECK(L, 0);
+    dmScript::StopLuaSampling(dmScript::GetMainThread(L));
+    return 0;
+}
+
+static void WriteLuaSampleToFile(void* ctx, const char* stack, uint32_t count)
+{
+    fprintf((FILE*)ctx, "%s %u\n", stack, count);
+}
+
+/*# save the Lua samples to a file
+ *
+ * Saves the sampled Lua call stacks in the folded stacks format, with one line per unique call
+ * stack and the number of times it was sampled. The file can be turned into a flame graph using
+ * e.g. [flamegraph.pl](https://github.com/brendangregg/FlameGraph) or [speedscope](https://www.speedscope.app).
+ *
+ * @name profiler.save_lua_samples
+ * @param path [type:string] the path of the file to write
+ * @return success [type:boolean] true if the samples were saved, false if there were no samples or the file couldn't be written
+ */
+static int ProfilerSaveLuaSamples(lua_State* L)
+{
+    DM_LUA_STACK_CHECK(L, 1);
+
+    const char* path = luaL_checkstring(L, 1);
+    if (dmScript::GetLuaSampleCount() == 0)
+    {
+        lua_pushboolean(L, 0);
+        return 1;
+    }
+
+    FILE* file = fopen(path, "wb");
+    if (!file)
+    {
+        dmLogError("Failed to open '%s' for writing", path);
+        lua_pushboolean(L, 0);
+        return 1;
+    }
+
+    dmScript::IterateLuaSamples(WriteLuaSampleToFile, file);
+    fclose(file);
+
+    lua_pushboolean(L, 1);
+    return 1;
+}
+
 /*# continously show latest frame
 *
 * @name profiler.MODE_RUN
@@ -585,17 +890,43 @@ static void TraverseSampleTree(dmProfileRender::ProfilerThread* thread, int inde
     }
 }
 
+static void CaptureSampleTree(uint32_t thread, int depth, dmProfile::HSample sample)
+{
+    dmProfileCapture::AddSample(g_ProfilerCapture, thread, dmProfile::SampleGetName(sample), depth,
+                                dmProfile::SampleGetStart(sample), dmProfile::SampleGetTime(sample));
+
+    dmProfile::SampleIterator iter;
+    dmProfile::SampleIterateChildren(sample, &iter);
+    while (dmProfile::SampleIterateNext(&iter))
+    {
+        CaptureSampleTree(thread, depth + 1, iter.m_Sample);
+    }
+}
+
 static void SampleTreeCallback(void* _ctx, const char* thread_name, dmProfile::HSample root)
 {
     if (g_ProfilerCurrentFrame == 0) // Possibly in the process of shutting down
         return;
 
-    // TODO: Make a better selection scheme, letting the user step through the threads one by one
-    if (strcmp(thread_name, "Main") != 0)
-        return;
+    bool is_main_thread = strcmp(thread_name, "Main") == 0;
 
     DM_MUTEX_SCOPED_LOCK(g_ProfilerMutex);
 
+    // The capture records all threads, and uses the main thread to mark the end of each frame
+    if (g_ProfilerCapture && dmProfileCapture::GetState(g_ProfilerCapture) == dmProfileCapture::CAPTURE_STATE_RECORDING)
+    {
+        uint32_t thread_index = dmProfileCapture::GetThreadIndex(g_ProfilerCapture, thread_name);
+        CaptureSampleTree(thread_index, 0, root);
+        if (is_main_thread)
+        {
+            dmProfileCapture::EndFrame(g_ProfilerCapture, dmProfile::SampleGetStart(root), dmProfile::SampleGetTime(root));
+        }
+    }
+
+    // TODO: Make a better selection scheme, letting the user step through the threads one by one
+    if (!is_main_thread)
+        return;
+
     dmProfileRender::ProfilerFrame* frame = (dmProfileRender::ProfilerFrame*)_ctx;
     frame->m_Time = dmTime::GetTime();
 
@@ -617,6 +948,23 @@ static void SampleTreeCallback(void* _ctx, const char* thread_name, dmProfile::H
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 
+static void CaptureProperty(const char* name, dmProfile::PropertyType type, dmProfile::PropertyValue value)
+{
+    double v = 0;
+    switch(type)
+    {
+    case dmProfile::PROPERTY_TYPE_BOOL: v = value.m_Bool ? 1 : 0; break;
+    case dmProfile::PROPERTY_TYPE_S32:  v = value.m_S32; break;
+    case dmProfile::PROPERTY_TYPE_U32:  v = value.m_U32; break;
+    case dmProfile::PROPERTY_TYPE_F32:  v = value.m_F32; break;
+    case dmProfile::PROPERTY_TYPE_S64:  v = (double)value.m_S64; break;
+    case dmProfile::PROPERTY_TYPE_U64:  v = (double)value.m_U64; break;
+    case dmProfile::PROPERTY_TYPE_F64:  v = value.m_F64; break;
+    default: return; // Groups have no value
+    }
+    dmProfileCapture::AddCounter(g_ProfilerCapture, name, v);
+}
+
 static void ProcessProperty(dmProfileRender::ProfilerFrame* frame, int indent, dmProfile::HProperty property)
 {
     const char* name = dmProfile::PropertyGetName(property);
@@ -626,6 +974,11 @@ static void ProcessProperty(dmProfileRender::ProfilerFrame* frame, int indent, d
     dmProfile::PropertyValue value = dmProfile::PropertyGetValue(property);
 
     dmProfileRender::AddProperty(frame, name_hash, type, value, indent);
+
+    if (g_ProfilerCapture && dmProfileCapture::GetState(g_ProfilerCapture) == dmProfileCapture::CAPTURE_STATE_RECORDING)
+    {
+        CaptureProperty(name?name:"<empty_property_name>", type, value);
+    }
 }
 
 static void TraversePropertyTree(dmProfileRender::ProfilerFrame* frame, int indent, dmProfile::HProperty property)
@@ -667,6 +1020,10 @@ static dmExtension::Result InitializeProfiler(dmExtension::Params* params)
         dmProfiler::g_TrackCpuUsage = true;
     }
 
+    // The interval (in milliseconds) the memory and CPU usage is sampled at, on the platforms that sample on a thread
+    uint32_t sample_interval = (uint32_t)dmConfigFile::GetInt(params->m_ConfigFile, "profiler.sample_interval", (int)(SAMPLE_CPU_INTERVAL * 1000));
+    dmProfilerExt::InitializePlatformProfiler(sample_interval, dmProfiler::g_TrackCpuUsage);
+
     static const luaL_reg Module_methods[] =
     {
         {"get_memory_usage",            MemoryUsage},
@@ -683,6 +1040,14 @@ static dmExtension::Result InitializeProfiler(dmExtension::Params* params)
         {"scope_begin",                 ProfilerScopeBegin},
         {"scope_end",                   ProfilerScopeEnd},
 
+        {"start_capture",               ProfilerStartCapture},
+        {"stop_capture",                ProfilerStopCapture},
+        {"is_capturing",                ProfilerIsCapturing},
+        {"save_capture",                ProfilerSaveCapture},
+        {"start_lua_sampling",          ProfilerStartLuaSampling},
+        {"stop_lua_sampling",           ProfilerStopLuaSampling},
+        {"save_lua_samples",            ProfilerSaveLuaSamples},
+
         {0, 0}
     };
 
@@ -726,6 +1091,9 @@ static dmExtension::Result UpdateProfiler(dmExtension::Params* params)
 
 static dmExtension::Result FinalizeProfiler(dmExtension::Params* params)
 {
+    dmScript::StopLuaSampling(params->m_L);
+    dmProfilerExt::FinalizePlatformProfiler();
+
     if (gRenderProfile)
     {
         dmProfileRender::DeleteRenderProfile(gRenderProfile);
@@ -759,6 +1127,8 @@ static dmExtension::Result AppInitializeProfiler(dmExtension::AppParams* params)
         return dmExtension::RESULT_OK;
     }
 
+    g_ProfilerCapture = dmProfileCapture::New(dmProfile::GetTicksPerSecond());
+
     g_ProfilerThreadSortOrder.SetCapacity(7, 8);
     g_ProfilerThreadSortOrder.Put(dmHashString64("Main"), 0);
     g_ProfilerThreadSortOrder.Put(dmHashString64("sound"), 1);
@@ -784,6 +1154,11 @@ static dmExtension::Result AppFinalizeProfiler(dmExtension::AppParams* params)
         DeleteProfilerFrame(g_ProfilerCurrentFrame);
         g_ProfilerCurrentFrame = 0;
     }
+    if (g_ProfilerCapture)
+    {
+        dmProfileCapture::Delete(g_ProfilerCapture);
+        g_ProfilerCapture = 0;
+    }
     dmMutex::Delete(g_ProfilerMutex);
     g_ProfilerMutex = 0;
 
@@ -39,6 +39,32 @@ namespace dmProfiler
     void ToggleProfiler();
     void RenderProfiler(dmProfile::HProfile profile, dmGraphics::HContext graphics_context, dmRender::HRenderContext render_context, dmRender::HFontMap system_font_map);
 
+    /**
+     * Start capturing profiled frames (all threads, properties and gpu scopes).
+     * @param frame_count The number of frames to capture
+     * @param spike_threshold_ms If > 0, the capture keeps the last frame_count frames until
+     *                           a frame takes at least this long, and then stops
+     */
+    void StartCapture(uint32_t frame_count, float spike_threshold_ms);
+
+    /**
+     * Stop an ongoing capture, keeping the frames recorded so far
+     */
+    void StopCapture();
+
+    /**
+     * @return true if a capture is recording frames
+     */
+    bool IsCapturing();
+
+    typedef void (*FCaptureWriteCallback)(void* ctx, const char* data, uint32_t size);
+
+    /**
+     * Write the captured frames in the Chrome trace event json format
+     * @return false if there are no captured frames
+     */
+    bool WriteCapture(FCaptureWriteCallback callback, void* ctx);
+
 } // dmProfiler
 
 #endif // DM_PROFILER_H
@@ -25,15 +25,7 @@ extern struct android_app* __attribute__((weak)) g_AndroidApp;
 
 void dmProfilerExt::SampleCpuUsage()
 {
-    // see https://github.com/defold/defold/issues/3385
-    int api_level = android_get_device_api_level();
-    if (api_level >= 26)
-    {
-        dmProfilerExt::SampleProcCpuUsage(true);
-    } else
-    {
-        dmProfilerExt::SampleProcCpuUsage(false);
-    }
+    // nop, sampled on a thread
 }
 
 uint64_t dmProfilerExt::GetMemoryUsage()
@@ -52,3 +44,15 @@ void dmProfilerExt::UpdatePlatformProfiler()
     JNIEnv* env = 0;
     DM_PROPERTY_SET_BOOL(rmtp_AttachedToJVM, g_AndroidApp->activity->vm->GetEnv((void **)&env, JNI_VERSION_1_6) == JNI_OK);
 }
+
+void dmProfilerExt::InitializePlatformProfiler(uint32_t sample_interval_ms, bool track_cpu)
+{
+    // see https://github.com/defold/defold/issues/3385
+    int api_level = android_get_device_api_level();
+    dmProfilerExt::StartProcSampler(sample_interval_ms, track_cpu, api_level >= 26);
+}
+
+void dmProfilerExt::FinalizePlatformProfiler()
+{
+    dmProfilerExt::StopProcSampler();
+}
@@ -75,3 +75,13 @@ void dmProfilerExt::UpdatePlatformProfiler()
 {
     // nop
 }
+
+void dmProfilerExt::InitializePlatformProfiler(uint32_t sample_interval_ms, bool track_cpu)
+{
+    // nop
+}
+
+void dmProfilerExt::FinalizePlatformProfiler()
+{
+    // nop
+}
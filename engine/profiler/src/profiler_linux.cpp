@@ -17,7 +17,7 @@
 
 void dmProfilerExt::SampleCpuUsage()
 {
-    dmProfilerExt:SampleProcCpuUsage(false);
+    // nop, sampled on a thread
 }
 
 uint64_t dmProfilerExt::GetMemoryUsage()
@@ -34,3 +34,13 @@ void dmProfilerExt::UpdatePlatformProfiler()
 {
     // nop
 }
+
+void dmProfilerExt::InitializePlatformProfiler(uint32_t sample_interval_ms, bool track_cpu)
+{
+    dmProfilerExt::StartProcSampler(sample_interval_ms, track_cpu, false);
+}
+
+void dmProfilerExt::FinalizePlatformProfiler()
+{
+    dmProfilerExt::StopProcSampler();
+}
@@ -31,6 +31,26 @@ void RenderProfiler(dmProfile::HProfile , dmGraphics::HContext , dmRender::HRend
     // nop
 }
 
+void StartCapture(uint32_t , float )
+{
+    // nop
+}
+
+void StopCapture()
+{
+    // nop
+}
+
+bool IsCapturing()
+{
+    return false;
+}
+
+bool WriteCapture(FCaptureWriteCallback , void* )
+{
+    return false;
+}
+
 extern "C" void ProfilerExt()
 {
     // nop
@@ -39,6 +39,18 @@ namespace dmProfilerExt {
      * Call update in platforms implementations to collect platform specific data.
      */
     void UpdatePlatformProfiler();
+
+    /**
+     * Called when the profiler is initialized. Platforms that sample the usage on a thread start it here.
+     * @param sample_interval_ms The time between two samples, in milliseconds
+     * @param track_cpu If the CPU usage should be sampled
+     */
+    void InitializePlatformProfiler(uint32_t sample_interval_ms, bool track_cpu);
+
+    /**
+     * Called when the profiler is finalized.
+     */
+    void FinalizePlatformProfiler();
 }
 
 #endif // #ifndef DM_PROFILER_PRIVATE_H
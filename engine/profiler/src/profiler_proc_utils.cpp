@@ -12,17 +12,34 @@
 // CONDITIONS OF ANY KIND, either express or implied. See the License for the
 // specific language governing permissions and limitations under the License.
 
-#include <dlib/time.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <fcntl.h>
 #include <unistd.h>
+#include <sys/resource.h>
+
+#include <dlib/atomic.h>
+#include <dlib/log.h>
+#include <dlib/thread.h>
+#include <dlib/time.h>
 
 #include "profiler_private.h"
 #include "profiler_proc_utils.h"
 
+// The usage is sampled on a thread, since reading the proc files shows up in the frame time.
+// The results are published as 32 bit values, which are atomic to read from the main thread.
+static int32_atomic_t   _sample_memory_kb = 0;
+static int32_atomic_t   _sample_cpu_usage = 0;    // In 1/10000ths
+static int32_atomic_t   _sampler_running = 0;
+static dmThread::Thread _sampler_thread = 0;
+static uint32_t         _sampler_interval_ms = 250;
+static bool             _sampler_cpu = false;
+static bool             _sampler_virtual_metric = false;
+
 // Inspired by this post: http://stackoverflow.com/questions/1420426/how-to-calculate-the-cpu-usage-of-a-process-by-pid-in-linux-from-c
 static uint64_t _sample_cpu_last_t = 0;
 static long int _sample_cpu_last_tot = 0;
 static long int _sample_cpu_last_proc = 0;
-static double _sample_cpu_usage = 0.0;
 static bool _sample_cpu_enabled = true;
 static int _cpu_count = -1;
 
@@ -57,61 +74,17 @@ static long int ParseTotalCPUUsage()
     return jiffies;
 }
 
-static long int ParseProcStat()
+// The user and system time of the process, in the same ticks as /proc/stat (1/USER_HZ sec, which is 100 in linux/android)
+static long int GetProcessTicks()
 {
-    FILE* fp = NULL;
-    if ((fp = fopen("/proc/self/stat", "r")) == NULL) {
-        dmLogError("Could not open /proc/self/stat");
-        return 0;
-    }
-
-    long int utime = 0;
-    long int stime = 0;
-    if (fscanf(fp, "%*d %*s %*s %*d %*d %*d %*d %*d %*d %*d %*d %*d %*d %ld %ld", &utime, &stime) != 2) {
-        dmLogError("Could not parse process CPU information.");
-        fclose(fp);
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
         return 0;
     }
-    fclose(fp);
-
-    return utime + stime;
-}
-
-static int ParseCpuCount()
-{
-    FILE* fp = NULL;
-    if ((fp = fopen("/proc/cpuinfo", "r")) == NULL) {
-            dmLogError("Could not open /proc/cpuinfo");
-            return 0;
-    }
-
-    char buffer[4096];
-    int result = 1; // a valid value to start with
-    int cpuid = -1;
-    int max_cpuid = -1;
-
-    // go for "processor : *" lines and keep the processor id.
-    while ( result != EOF)
-    {
-            result = fscanf(fp, "processor : %d \n", &cpuid);
-            if (result == EOF)
-            {
-                    break;
-            }
-            if (result != 1) // discard the line
-            {
-                    result = fscanf(fp, "%4095[^\n]\n", buffer);
-            } else
-            {
-                if (cpuid > max_cpuid)
-                    max_cpuid = cpuid;
-            }
-    }
-    fclose(fp);
-    // processor ids start from 0
-    max_cpuid ++;
 
-    return max_cpuid; // in case no processor is detected, 0 is returned
+    uint64_t us = (uint64_t)usage.ru_utime.tv_sec * 1000000 + usage.ru_utime.tv_usec +
+                  (uint64_t)usage.ru_stime.tv_sec * 1000000 + usage.ru_stime.tv_usec;
+    return (long int)(us / 10000);
 }
 
 static long int VirtualTotalCpuUsageDelta(uint64_t interval_us)
@@ -119,7 +92,7 @@ static long int VirtualTotalCpuUsageDelta(uint64_t interval_us)
     // lazily initialize processor count
     if (_cpu_count == -1)
     {
-        _cpu_count = ParseCpuCount();
+        _cpu_count = (int)sysconf(_SC_NPROCESSORS_CONF);
     }
 
     // convert from microsecs to tick count (tick in userland lasts 1/USER_HZ sec). USER_HZ should be 100 in linux/android
@@ -129,7 +102,7 @@ static long int VirtualTotalCpuUsageDelta(uint64_t interval_us)
     return ticks * _cpu_count;
 }
 
-void dmProfilerExt::SampleProcCpuUsage(bool use_virtual_metric)
+static void SampleProcCpuUsage(bool use_virtual_metric)
 {
     if (!_sample_cpu_enabled) {
         return;
@@ -138,57 +111,118 @@ void dmProfilerExt::SampleProcCpuUsage(bool use_virtual_metric)
     uint64_t time = dmTime::GetTime();
     if (_sample_cpu_last_t == 0) {
         _sample_cpu_last_t = time;
+        _sample_cpu_last_proc = GetProcessTicks();
         return;
     }
 
     uint64_t time_interval_us = time - _sample_cpu_last_t; // in micro seconds
-    if (time_interval_us * 0.000001 > SAMPLE_CPU_INTERVAL) {
+    long int cur_proc = GetProcessTicks();
 
-        long int cur_proc = ParseProcStat();
+    double tot_delta;
+    if (use_virtual_metric)
+    {
+        tot_delta = VirtualTotalCpuUsageDelta(time_interval_us);
+    } else
+    {
+        long int cur_tot = ParseTotalCPUUsage();
+        tot_delta = (double)cur_tot - (double)_sample_cpu_last_tot;
+        _sample_cpu_last_tot = cur_tot;
+    }
 
-        double tot_delta;
-        if (use_virtual_metric)
-        {
-            tot_delta = VirtualTotalCpuUsageDelta(time_interval_us);
-        } else
+    if (tot_delta > 0) {
+        double usage = ((double)cur_proc - (double)_sample_cpu_last_proc) / tot_delta;
+        dmAtomicStore32(&_sample_cpu_usage, (int32_t)(usage * 10000.0));
+    }
+
+    _sample_cpu_last_proc = cur_proc;
+    _sample_cpu_last_t = time;
+}
+
+static uint64_t ParseProcMemoryUsage()
+{
+    // A single small read, instead of going through stdio
+    int fd = open("/proc/self/statm", O_RDONLY);
+    if (fd < 0) {
+        return 0;
+    }
+
+    char buffer[128];
+    ssize_t n = read(fd, buffer, sizeof(buffer) - 1);
+    close(fd);
+    if (n <= 0) {
+        return 0;
+    }
+    buffer[n] = 0;
+
+    // "size resident shared ...", in pages
+    char* end = 0;
+    strtol(buffer, &end, 10);
+    long rss = strtol(end, 0, 10);
+
+    static long page_size = sysconf(_SC_PAGESIZE);
+    return (uint64_t)rss * page_size;
+}
+
+static void SampleProcMemoryUsage()
+{
+    dmAtomicStore32(&_sample_memory_kb, (int32_t)(ParseProcMemoryUsage() / 1024));
+}
+
+static void SamplerThread(void* ctx)
+{
+    while (dmAtomicGet32(&_sampler_running))
+    {
+        SampleProcMemoryUsage();
+        if (_sampler_cpu)
         {
-            long int cur_tot = ParseTotalCPUUsage();
-            tot_delta = (double)cur_tot - (double)_sample_cpu_last_tot;
-            _sample_cpu_last_tot = cur_tot;
+            SampleProcCpuUsage(_sampler_virtual_metric);
         }
 
-        if (tot_delta > 0) {
-            _sample_cpu_usage = ((double)cur_proc - (double)_sample_cpu_last_proc) / tot_delta;
+        // Sleep in short steps, to not delay the shutdown
+        uint64_t next_sample = dmTime::GetTime() + _sampler_interval_ms * 1000;
+        while (dmAtomicGet32(&_sampler_running) && dmTime::GetTime() < next_sample)
+        {
+            dmTime::Sleep(10000);
         }
-
-        _sample_cpu_last_proc = cur_proc;
-        _sample_cpu_last_t = time;
     }
 }
 
-uint64_t dmProfilerExt::GetProcMemoryUsage()
+void dmProfilerExt::StartProcSampler(uint32_t interval_ms, bool sample_cpu, bool use_virtual_metric)
 {
-    long rss = 0;
-    long vmu = 0;
-    FILE* fp = NULL;
-    if ((fp = fopen( "/proc/self/statm", "r" )) == NULL) {
-        dmLogError("Could not open /proc/self/statm");
-        return 0;
-    }
+    if (_sampler_thread)
+        return;
+
+    _sampler_interval_ms = interval_ms;
+    _sampler_cpu = sample_cpu;
+    _sampler_virtual_metric = use_virtual_metric;
+
+    // Take the first sample right away, so that the values are valid from the first frame
+    SampleProcMemoryUsage();
+
+    dmAtomicStore32(&_sampler_running, 1);
+    _sampler_thread = dmThread::New(SamplerThread, 0x10000, 0, "proc_sampler");
+}
+
+void dmProfilerExt::StopProcSampler()
+{
+    if (!_sampler_thread)
+        return;
 
-    if (fscanf(fp, "%ld %ld", &vmu, &rss) != 2)
+    dmAtomicStore32(&_sampler_running, 0);
+    dmThread::Join(_sampler_thread);
+    _sampler_thread = 0;
+}
+
+uint64_t dmProfilerExt::GetProcMemoryUsage()
+{
+    if (!_sampler_thread)
     {
-        dmLogError("Could not parse memory information.");
-        fclose(fp);
-        return 0;
+        SampleProcMemoryUsage();
     }
-    fclose(fp);
-
-    long page_size = sysconf( _SC_PAGESIZE);
-    return rss * page_size;
+    return (uint64_t)dmAtomicGet32(&_sample_memory_kb) * 1024;
 }
 
 double dmProfilerExt::GetProcCpuUsage()
 {
-    return _sample_cpu_usage;
+    return dmAtomicGet32(&_sample_cpu_usage) / 10000.0;
 }
@@ -19,10 +19,18 @@
 
 namespace dmProfilerExt {
     /**
-     * Call to sample CPU usage from proc in intervals.
+     * Starts a thread that samples the memory usage, and optionally the CPU usage, of the process from proc in intervals.
+     * The getters return the latest sampled values.
+     * @param interval_ms The time between two samples, in milliseconds
+     * @param sample_cpu If the CPU usage should be sampled
      * @param use_virtual_metric If true it will guess the usage denominator from interval duration and cpu count. Otherwise, sum jiffies from /proc/stat.
      */
-    void SampleProcCpuUsage(bool use_virtual_metric);
+    void StartProcSampler(uint32_t interval_ms, bool sample_cpu, bool use_virtual_metric);
+
+    /**
+     * Stops the sampling thread.
+     */
+    void StopProcSampler();
 
     /**
      * Get current memory usage in bytes from proc (resident/working set) for the process, as reported by OS.
@@ -0,0 +1,135 @@
+// Copyright 2020-2024 The Defold Foundation
+// Copyright 2014-2020 King
+// Copyright 2009-2014 Ragnar Svensson, Christian Murray
+// Licensed under the Defold License version 1.0 (the "License"); you may not use
+// this file except in compliance with the License.
+//
+// You may obtain a copy of the License, together with FAQs at
+// https://www.defold.com/license
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#define JC_TEST_IMPLEMENTATION
+#include <jc_test/jc_test.h>
+
+#include <string>
+
+#include "../profile_capture.h"
+
+static void WriteToString(void* ctx, const char* data, uint32_t size)
+{
+    ((std::string*)ctx)->append(data, size);
+}
+
+static void AddFrame(dmProfileCapture::HCapture capture, uint32_t thread, uint64_t start, uint64_t time)
+{
+    dmProfileCapture::AddSample(capture, thread, "Frame", 0, start, time);
+    dmProfileCapture::AddSample(capture, thread, "Update", 1, start + 1, time / 2);
+    dmProfileCapture::AddCounter(capture, "DrawCalls", 7);
+    dmProfileCapture::EndFrame(capture, start, time);
+}
+
+TEST(ProfileCapture, FrameCount)
+{
+    dmProfileCapture::HCapture capture = dmProfileCapture::New(1000000);
+    uint32_t main_thread = dmProfileCapture::GetThreadIndex(capture, "Main");
+    ASSERT_EQ(main_thread, dmProfileCapture::GetThreadIndex(capture, "Main"));
+
+    ASSERT_EQ(dmProfileCapture::CAPTURE_STATE_IDLE, dmProfileCapture::GetState(capture));
+    dmProfileCapture::Start(capture, 3, 0);
+    ASSERT_EQ(dmProfileCapture::CAPTURE_STATE_RECORDING, dmProfileCapture::GetState(capture));
+
+    for (uint32_t i = 0; i < 5; ++i)
+    {
+        AddFrame(capture, main_thread, 1000 + i * 16000, 16000);
+    }
+
+    ASSERT_EQ(dmProfileCapture::CAPTURE_STATE_DONE, dmProfileCapture::GetState(capture));
+    ASSERT_EQ(3u, dmProfileCapture::GetFrameCount(capture));
+
+    std::string trace;
+    ASSERT_TRUE(dmProfileCapture::WriteChromeTrace(capture, WriteToString, &trace));
+    ASSERT_NE(std::string::npos, trace.find("\"traceEvents\""));
+    ASSERT_NE(std::string::npos, trace.find("\"name\": \"Main\""));
+    ASSERT_NE(std::string::npos, trace.find("\"name\": \"Update\""));
+    ASSERT_NE(std::string::npos, trace.find("\"name\": \"DrawCalls\""));
+    // Only the first three frames are kept
+    ASSERT_NE(std::string::npos, trace.find("\"ts\": 33001.000"));
+    ASSERT_EQ(std::string::npos, trace.find("\"ts\": 49001.000"));
+
+    dmProfileCapture::Delete(capture);
+}
+
+TEST(ProfileCapture, Spike)
+{
+    dmProfileCapture::HCapture capture = dmProfileCapture::New(1000000);
+    uint32_t main_thread = dmProfileCapture::GetThreadIndex(capture, "Main");
+
+    dmProfileCapture::Start(capture, 2, 30000);
+    for (uint32_t i = 0; i < 10; ++i)
+    {
+        AddFrame(capture, main_thread, i * 16000, 16000);
+    }
+    ASSERT_EQ(dmProfileCapture::CAPTURE_STATE_RECORDING, dmProfileCapture::GetState(capture));
+
+    AddFrame(capture, main_thread, 10 * 16000, 40000);
+    ASSERT_EQ(dmProfileCapture::CAPTURE_STATE_DONE, dmProfileCapture::GetState(capture));
+    ASSERT_EQ(2u, dmProfileCapture::GetFrameCount(capture));
+
+    // The frames after the spike aren't recorded
+    AddFrame(capture, main_thread, 11 * 16000, 16000);
+
+    std::string trace;
+    ASSERT_TRUE(dmProfileCapture::WriteChromeTrace(capture, WriteToString, &trace));
+    ASSERT_NE(std::string::npos, trace.find("\"ts\": 144000.000"));
+    ASSERT_NE(std::string::npos, trace.find("\"dur\": 40000.000"));
+    ASSERT_EQ(std::string::npos, trace.find("\"ts\": 128000.000"));
+    ASSERT_EQ(std::string::npos, trace.find("\"ts\": 176000.000"));
+
+    dmProfileCapture::Delete(capture);
+}
+
+TEST(ProfileCapture, Escape)
+{
+    dmProfileCapture::HCapture capture = dmProfileCapture::New(1000000);
+    uint32_t main_thread = dmProfileCapture::GetThreadIndex(capture, "Main");
+
+    std::string trace;
+    ASSERT_FALSE(dmProfileCapture::WriteChromeTrace(capture, WriteToString, &trace));
+
+    dmProfileCapture::Start(capture, 1, 0);
+    dmProfileCapture::AddSample(capture, main_thread, "a \"quoted\" \\name", 0, 0, 10);
+    dmProfileCapture::EndFrame(capture, 0, 10);
+
+    ASSERT_TRUE(dmProfileCapture::WriteChromeTrace(capture, WriteToString, &trace));
+    ASSERT_NE(std::string::npos, trace.find("\"a \\\"quoted\\\" \\\\name\""));
+
+    dmProfileCapture::Delete(capture);
+}
+
+TEST(ProfileCapture, Stop)
+{
+    dmProfileCapture::HCapture capture = dmProfileCapture::New(1000000);
+    uint32_t main_thread = dmProfileCapture::GetThreadIndex(capture, "Main");
+
+    dmProfileCapture::Start(capture, 100, 0);
+    dmProfileCapture::Stop(capture);
+    ASSERT_EQ(dmProfileCapture::CAPTURE_STATE_IDLE, dmProfileCapture::GetState(capture));
+
+    dmProfileCapture::Start(capture, 100, 0);
+    AddFrame(capture, main_thread, 0, 16000);
+    dmProfileCapture::Stop(capture);
+    ASSERT_EQ(dmProfileCapture::CAPTURE_STATE_DONE, dmProfileCapture::GetState(capture));
+    ASSERT_EQ(1u, dmProfileCapture::GetFrameCount(capture));
+
+    dmProfileCapture::Delete(capture);
+}
+
+int main(int argc, char **argv)
+{
+    jc_test_init(&argc, argv);
+    return jc_test_run_all();
+}
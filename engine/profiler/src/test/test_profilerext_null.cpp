@@ -23,6 +23,10 @@ TEST(ProfilerExt, ProfilerStubs)
     dmProfiler::SetUpdateFrequency(30);
     dmProfiler::ToggleProfiler();
     dmProfiler::RenderProfiler(0, 0, 0, 0);
+    dmProfiler::StartCapture(60, 0.0f);
+    ASSERT_FALSE(dmProfiler::IsCapturing());
+    dmProfiler::StopCapture();
+    ASSERT_FALSE(dmProfiler::WriteCapture(0, 0));
 }
 
 int main(int argc, char **argv)
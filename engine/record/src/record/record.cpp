@@ -23,10 +23,18 @@
 #include "record.h"
 #include <vpx/vpx_encoder.h>
 #include <vpx/vp8cx.h>
+#include <dlib/condition_variable.h>
 #include <dlib/log.h>
+#include <dlib/math.h>
+#include <dlib/mutex.h>
+#include <dlib/profile.h>
+#include <dlib/thread.h>
 
 namespace dmRecord
 {
+    // The number of frames that can be queued for the encoding thread, before RecordFrame() waits for it
+    static const uint32_t FRAME_QUEUE_SIZE = 4;
+
     struct Recorder
     {
         Recorder(const NewParams* params)
@@ -36,10 +44,22 @@ namespace dmRecord
             m_Height = params->m_Height;
             m_Fps = params->m_Fps;
             m_Filename = strdup(params->m_Filename);
+            m_Mutex = dmMutex::New();
+            m_Condition = dmConditionVariable::New();
+            for (uint32_t i = 0; i < FRAME_QUEUE_SIZE; ++i)
+            {
+                m_Frames[i] = (uint8_t*) malloc(m_Width * m_Height * 4);
+            }
         }
 
         ~Recorder()
         {
+            for (uint32_t i = 0; i < FRAME_QUEUE_SIZE; ++i)
+            {
+                free(m_Frames[i]);
+            }
+            dmConditionVariable::Delete(m_Condition);
+            dmMutex::Delete(m_Mutex);
             free(m_Filename);
             if (m_File)
             {
@@ -55,6 +75,17 @@ namespace dmRecord
         vpx_codec_ctx_t     m_Codec;
         vpx_image_t         m_VpxImage;
         uint32_t            m_FrameCount;
+
+        dmThread::Thread                        m_Thread;
+        dmMutex::HMutex                         m_Mutex;
+        // Signalled when a frame is queued, or when the encoding thread has finished one
+        dmConditionVariable::HConditionVariable m_Condition;
+        uint8_t*                                m_Frames[FRAME_QUEUE_SIZE];
+        uint32_t                                m_FrameStart;
+        uint32_t                                m_QueuedFrames;
+        // The first error of the encoding thread
+        Result                                  m_Result;
+        uint32_t                                m_Quit : 1;
     };
 
     static void MemPutLE16(char *mem, unsigned int val)
@@ -111,6 +142,8 @@ namespace dmRecord
         return fwrite(header, 1, sizeof(header), recorder->m_File) == sizeof(header);
     }
 
+    static void EncodeThread(void* arg);
+
     Result New(const NewParams* params, HRecorder* recorder)
     {
         *recorder = 0;
@@ -156,6 +189,7 @@ namespace dmRecord
         cfg.g_h = params->m_Height;
         cfg.g_timebase.num = 1;
         cfg.g_timebase.den = params->m_Fps;
+        cfg.g_threads = dmMath::Max(1u, params->m_EncoderThreads);
 
         vpx_codec_ctx_t codec;
         res = vpx_codec_enc_init(&codec, vpx_codec_vp8_cx(), &cfg, 0);
@@ -166,6 +200,13 @@ namespace dmRecord
             return RESULT_UNKNOWN_ERROR;
         }
 
+        // The threads of the VP8 encoder work on separate token partitions
+        if (cfg.g_threads > 1)
+        {
+            uint32_t partitions = cfg.g_threads >= 8 ? VP8_EIGHT_TOKENPARTITION : cfg.g_threads >= 4 ? VP8_FOUR_TOKENPARTITION : VP8_TWO_TOKENPARTITION;
+            vpx_codec_control(&codec, VP8E_SET_TOKEN_PARTITIONS, partitions);
+        }
+
         FILE* f = fopen(params->m_Filename, "wb");
         if (!f)
         {
@@ -180,6 +221,7 @@ namespace dmRecord
         r->m_Codec = codec;
         r->m_VpxImage = vpx_image;
         r->m_File = f;
+        r->m_Thread = dmThread::New(EncodeThread, 0x80000, r, "record");
         *recorder = r;
         return RESULT_OK;
     }
@@ -239,32 +281,16 @@ namespace dmRecord
         }
     }
 
-    Result Delete(HRecorder recorder)
+    static Result EncodeFrame(HRecorder recorder, const uint8_t* frame_buffer)
     {
-        Result result = RESULT_OK;
-
-        fseek(recorder->m_File, 0, SEEK_SET);
-        if (!WriteIvfFileHeader(recorder))
-        {
-            result = RESULT_IO_ERROR;
-        }
-
-        vpx_img_free(&recorder->m_VpxImage);
-        vpx_codec_destroy(&recorder->m_Codec);
+        DM_PROFILE(__FUNCTION__);
 
-        delete recorder;
-        return result;
-    }
-
-    Result RecordFrame(HRecorder recorder, const void* frame_buffer,
-            uint32_t frame_buffer_size, BufferFormat format)
-    {
         vpx_codec_iter_t iter = NULL;
         const vpx_codec_cx_pkt_t *pkt;
         vpx_codec_err_t res;
         int flags = 0;
 
-        RGBAToYV12FlipY((const uint8_t*) frame_buffer, recorder->m_Width, recorder->m_Height, recorder->m_VpxImage.planes[0], recorder->m_VpxImage.planes[1], recorder->m_VpxImage.planes[2]);
+        RGBAToYV12FlipY(frame_buffer, recorder->m_Width, recorder->m_Height, recorder->m_VpxImage.planes[0], recorder->m_VpxImage.planes[1], recorder->m_VpxImage.planes[2]);
         res = vpx_codec_encode(&recorder->m_Codec, &recorder->m_VpxImage, recorder->m_FrameCount, 1, flags, VPX_DL_REALTIME);
         if (res)
         {
@@ -296,4 +322,93 @@ namespace dmRecord
 
         return RESULT_OK;
     }
+
+    // Encodes the queued frames in order, until the recorder is deleted and the queue is empty
+    static void EncodeThread(void* arg)
+    {
+        Recorder* recorder = (Recorder*) arg;
+        while (true)
+        {
+            uint8_t* frame;
+            {
+                DM_MUTEX_SCOPED_LOCK(recorder->m_Mutex);
+                while (recorder->m_QueuedFrames == 0 && !recorder->m_Quit)
+                {
+                    dmConditionVariable::Wait(recorder->m_Condition, recorder->m_Mutex);
+                }
+                if (recorder->m_QueuedFrames == 0)
+                    break;
+                frame = recorder->m_Frames[recorder->m_FrameStart];
+            }
+
+            // After an error, the rest of the frames are dropped
+            Result r = recorder->m_Result == RESULT_OK ? EncodeFrame(recorder, frame) : RESULT_OK;
+
+            DM_MUTEX_SCOPED_LOCK(recorder->m_Mutex);
+            if (r != RESULT_OK && recorder->m_Result == RESULT_OK)
+                recorder->m_Result = r;
+            recorder->m_FrameStart = (recorder->m_FrameStart + 1) % FRAME_QUEUE_SIZE;
+            recorder->m_QueuedFrames--;
+            dmConditionVariable::Broadcast(recorder->m_Condition);
+        }
+    }
+
+    Result Delete(HRecorder recorder)
+    {
+        {
+            DM_MUTEX_SCOPED_LOCK(recorder->m_Mutex);
+            recorder->m_Quit = 1;
+            dmConditionVariable::Broadcast(recorder->m_Condition);
+        }
+        dmThread::Join(recorder->m_Thread);
+
+        Result result = recorder->m_Result;
+
+        fseek(recorder->m_File, 0, SEEK_SET);
+        if (!WriteIvfFileHeader(recorder) && result == RESULT_OK)
+        {
+            result = RESULT_IO_ERROR;
+        }
+
+        vpx_img_free(&recorder->m_VpxImage);
+        vpx_codec_destroy(&recorder->m_Codec);
+
+        delete recorder;
+        return result;
+    }
+
+    Result RecordFrame(HRecorder recorder, const void* frame_buffer,
+            uint32_t frame_buffer_size, BufferFormat format)
+    {
+        DM_PROFILE(__FUNCTION__);
+
+        uint32_t size = recorder->m_Width * recorder->m_Height * 4;
+        if (frame_buffer_size < size)
+        {
+            return RESULT_INVAL_ERROR;
+        }
+
+        uint8_t* frame;
+        {
+            DM_MUTEX_SCOPED_LOCK(recorder->m_Mutex);
+            while (recorder->m_QueuedFrames == FRAME_QUEUE_SIZE && recorder->m_Result == RESULT_OK)
+            {
+                DM_PROFILE("WaitForEncoder");
+                dmConditionVariable::Wait(recorder->m_Condition, recorder->m_Mutex);
+            }
+            if (recorder->m_Result != RESULT_OK)
+            {
+                return recorder->m_Result;
+            }
+            frame = recorder->m_Frames[(recorder->m_FrameStart + recorder->m_QueuedFrames) % FRAME_QUEUE_SIZE];
+        }
+
+        // The slot isn't touched by the encoding thread until it's queued
+        memcpy(frame, frame_buffer, size);
+
+        DM_MUTEX_SCOPED_LOCK(recorder->m_Mutex);
+        recorder->m_QueuedFrames++;
+        dmConditionVariable::Broadcast(recorder->m_Condition);
+        return RESULT_OK;
+    }
 }
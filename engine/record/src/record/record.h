@@ -60,10 +60,34 @@ namespace dmRecord
         VideoCodec      m_VideoCodec;
         const char*     m_Filename;
         uint32_t        m_Fps;
+        /// Number of threads the encoder splits each frame over. Default 2
+        uint32_t        m_EncoderThreads;
     };
 
+    /**
+     * Create a recorder. The frames are encoded and written on a separate thread
+     * @param params parameters
+     * @param recorder the recorder (out)
+     * @return RESULT_OK on success
+     */
     Result New(const NewParams* params, HRecorder* recorder);
+
+    /**
+     * Delete a recorder. Waits for the queued frames to be encoded, and finishes the file
+     * @param recorder recorder
+     * @return RESULT_OK on success, or the first error of the encoding thread
+     */
     Result Delete(HRecorder recorder);
+
+    /**
+     * Queue a frame for encoding. The frame buffer is copied, so it can be reused as soon as this returns.
+     * Only waits if the encoding thread is a full queue of frames behind.
+     * @param recorder recorder
+     * @param frame_buffer frame buffer
+     * @param frame_buffer_size frame buffer size
+     * @param format frame buffer format
+     * @return RESULT_OK on success, or the first error of the encoding thread
+     */
     Result RecordFrame(HRecorder recorder, const void* frame_buffer, uint32_t frame_buffer_size, BufferFormat format);
 }
 
@@ -25,5 +25,6 @@ namespace dmRecord
         m_ContainerFormat = CONTAINER_FORMAT_IVF;
         m_VideoCodec = VIDOE_CODEC_VP8;
         m_Fps = 30;
+        m_EncoderThreads = 2;
     }
 }
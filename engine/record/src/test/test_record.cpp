@@ -14,6 +14,7 @@
 
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 #include <string>
 #define JC_TEST_IMPLEMENTATION
 #include <jc_test/jc_test.h>
@@ -141,6 +142,28 @@ TEST(dmRecord, Simple)
     r = dmRecord::Delete(recorder);
     ASSERT_EQ(dmRecord::RESULT_OK, r);
 }
+
+TEST(dmRecord, FrameBufferTooSmall)
+{
+    dmRecord::NewParams params;
+    params.m_Width = 64;
+    params.m_Height = 64;
+    params.m_EncoderThreads = 4;
+    params.m_Filename = "tmp/small.ivf";
+    dmRecord::HRecorder recorder = 0;
+    dmRecord::Result r = dmRecord::New(&params, &recorder);
+    ASSERT_EQ(dmRecord::RESULT_OK, r);
+
+    uint32_t buffer_size = params.m_Width * params.m_Height * 4;
+    uint8_t* buffer = new uint8_t[buffer_size];
+    memset(buffer, 0, buffer_size);
+    ASSERT_EQ(dmRecord::RESULT_INVAL_ERROR, dmRecord::RecordFrame(recorder, buffer, buffer_size - 4, dmRecord::BUFFER_FORMAT_BGRA));
+    ASSERT_EQ(dmRecord::RESULT_OK, dmRecord::RecordFrame(recorder, buffer, buffer_size, dmRecord::BUFFER_FORMAT_BGRA));
+    delete[] buffer;
+
+    r = dmRecord::Delete(recorder);
+    ASSERT_EQ(dmRecord::RESULT_OK, r);
+}
 #endif
 
 int main(int argc, char **argv)
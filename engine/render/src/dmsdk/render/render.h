@@ -77,6 +77,13 @@ namespace dmRender
      */
     typedef struct NamedConstantBuffer* HNamedConstantBuffer;
 
+    /*#
+     * Occlusion buffer handle. Holds the depth of the occluders of the frame, as seen from the culling frustum.
+     * @typedef
+     * @name HOcclusionBuffer
+     */
+    typedef struct OcclusionBuffer* HOcclusionBuffer;
+
     /*#
      * @enum
      * @name Result
@@ -162,6 +169,7 @@ namespace dmRender
      * @member m_Constants [type: dmRender::HConstant[]] the shader constants
      * @member m_WorldTransform [type: dmVMath::Matrix4] the world transform (usually identity for batched objects)
      * @member m_TextureTransform [type: dmVMath::Matrix4] the texture transform
+     * @member m_ScissorRect [type: dmVMath::Vector4] the world space rect (min x, min y, max x, max y) the object is clipped to
      * @member m_VertexBuffer [type: dmGraphics::HVertexBuffer] the vertex buffer
      * @member m_VertexDeclaration [type: dmGraphics::HVertexDeclaration] the vertex declaration
      * @member m_IndexBuffer [type: dmGraphics::HIndexBuffer] the index buffer
@@ -176,6 +184,7 @@ namespace dmRender
      * @member m_VertexCount [type: uint32_t] the vertex count
      * @member m_SetBlendFactors [type: uint8_t:1] use the blend factors
      * @member m_SetStencilTest [type: uint8_t:1] use the stencil test
+     * @member m_SetScissor [type: uint8_t:1] use the scissor rect
      */
     struct RenderObject
     {
@@ -188,6 +197,7 @@ namespace dmRender
         HNamedConstantBuffer            m_ConstantBuffer;
         dmVMath::Matrix4                m_WorldTransform;
         dmVMath::Matrix4                m_TextureTransform;
+        dmVMath::Vector4                m_ScissorRect;
         union
         {
             dmGraphics::HVertexBuffer m_VertexBuffer;
@@ -215,6 +225,7 @@ namespace dmRender
         uint8_t                         m_SetBlendFactors : 1;
         uint8_t                         m_SetStencilTest : 1;
         uint8_t                         m_SetFaceWinding : 1;
+        uint8_t                         m_SetScissor : 1;
     };
 
     /*#
@@ -323,6 +334,7 @@ namespace dmRender
      * @member m_UserData [type: void*] the callback user data (registered with RenderListMakeDispatch())
      * @member m_Entries [type: dmRender::RenderListEntry] the render entry array
      * @member m_NumEntries [type: uint32_t] the number of render entries in the array
+     * @member m_OcclusionBuffer [type: dmRender::HOcclusionBuffer] the occluders of the frame, or 0 if there are none
      */
     struct RenderListVisibilityParams
     {
@@ -330,10 +342,13 @@ namespace dmRender
         void*                           m_UserData;
         RenderListEntry*                m_Entries;
         uint32_t                        m_NumEntries;
+        HOcclusionBuffer                m_OcclusionBuffer;
     };
 
     /*#
      * Render dispatch function callback.
+     * @note The render list may be split into chunks that are culled concurrently on worker threads,
+     *       so the callback must only write to the entries it is given.
      * @typedef
      * @name RenderListDispatchFn
      * @param params [type: dmRender::RenderListDispatchParams] the params
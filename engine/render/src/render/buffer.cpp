@@ -113,6 +113,61 @@ namespace dmRender
         }
     }
 
+    void* MapBufferData(HRenderContext render_context, HBufferedRenderBuffer buffer, uint32_t size, dmGraphics::BufferUsage buffer_usage)
+    {
+        if (!render_context->m_BufferMappingSupported || size == 0)
+        {
+            return 0;
+        }
+
+        dmGraphics::HContext graphics_context = render_context->m_GraphicsContext;
+        HRenderBuffer render_buffer           = buffer->m_Buffers[buffer->m_BufferIndex];
+
+        // With multi buffering, a render buffer is never written to while it is used by a draw call
+        // so the storage can be reused as-is. Otherwise we respecify the storage, which allows the driver
+        // to hand out new memory instead of waiting for the previous draw calls to finish.
+        switch(buffer->m_Type)
+        {
+            case RENDER_BUFFER_TYPE_VERTEX_BUFFER:
+            {
+                dmGraphics::HVertexBuffer vbuf = (dmGraphics::HVertexBuffer) render_buffer;
+                if (!render_context->m_MultiBufferingRequired || dmGraphics::GetVertexBufferSize(vbuf) != size)
+                {
+                    dmGraphics::SetVertexBufferData(vbuf, size, 0, buffer_usage);
+                }
+                return dmGraphics::MapVertexBuffer(graphics_context, vbuf, dmGraphics::BUFFER_ACCESS_WRITE_ONLY);
+            }
+            case RENDER_BUFFER_TYPE_INDEX_BUFFER:
+            {
+                dmGraphics::HIndexBuffer ibuf = (dmGraphics::HIndexBuffer) render_buffer;
+                if (!render_context->m_MultiBufferingRequired || dmGraphics::GetIndexBufferSize(ibuf) != size)
+                {
+                    dmGraphics::SetIndexBufferData(ibuf, size, 0, buffer_usage);
+                }
+                return dmGraphics::MapIndexBuffer(graphics_context, ibuf, dmGraphics::BUFFER_ACCESS_WRITE_ONLY);
+            }
+            default:break;
+        }
+        return 0;
+    }
+
+    void UnmapBufferData(HRenderContext render_context, HBufferedRenderBuffer buffer)
+    {
+        dmGraphics::HContext graphics_context = render_context->m_GraphicsContext;
+        HRenderBuffer render_buffer           = buffer->m_Buffers[buffer->m_BufferIndex];
+
+        switch(buffer->m_Type)
+        {
+            case RENDER_BUFFER_TYPE_VERTEX_BUFFER:
+                dmGraphics::UnmapVertexBuffer(graphics_context, (dmGraphics::HVertexBuffer) render_buffer);
+                break;
+            case RENDER_BUFFER_TYPE_INDEX_BUFFER:
+                dmGraphics::UnmapIndexBuffer(graphics_context, (dmGraphics::HIndexBuffer) render_buffer);
+                break;
+            default:break;
+        }
+    }
+
     void TrimBuffer(HRenderContext render_context, HBufferedRenderBuffer buffer)
     {
         if (!buffer)
@@ -15,10 +15,13 @@
 #include "debug_renderer.h"
 
 #include <stdint.h>
+#include <stdlib.h>
 
 #include <dlib/array.h>
 #include <dlib/hash.h>
 #include <dlib/log.h>
+#include <dlib/math.h>
+#include <dmsdk/dlib/intersection.h>
 #include <dmsdk/dlib/vmath.h>
 
 #include <graphics/graphics.h>
@@ -30,18 +33,12 @@ namespace dmRender
 {
     using namespace dmVMath;
 
-    struct DebugVertex
-    {
-        Vector4 m_Position;
-        Vector4 m_Color;
-    };
-
     void InitializeDebugRenderer(dmRender::HRenderContext render_context, uint32_t max_vertex_count, const void* vp_desc, uint32_t vp_desc_size, const void* fp_desc, uint32_t fp_desc_size)
     {
         DebugRenderer& debug_renderer = render_context->m_DebugRenderer;
-        debug_renderer.m_MaxVertexCount = max_vertex_count;
 
         debug_renderer.m_RenderContext = render_context;
+        // The buffers start out at the max vertex count, and grow if more is drawn
         const uint32_t buffer_size = max_vertex_count * sizeof(DebugVertex);
         const uint32_t total_buffer_size = MAX_DEBUG_RENDER_TYPE_COUNT * buffer_size;
         debug_renderer.m_VertexBuffer = dmGraphics::NewVertexBuffer(render_context->m_GraphicsContext, total_buffer_size, 0x0, dmGraphics::BUFFER_USAGE_STREAM_DRAW);
@@ -108,7 +105,8 @@ namespace dmRender
             ro.m_VertexCount = 0;
             DebugRenderTypeData& type_data = debug_renderer.m_TypeData[i];
             type_data.m_RenderObject = ro;
-            type_data.m_ClientBuffer = new char[buffer_size];
+            type_data.m_ClientBuffer = (DebugVertex*) malloc(buffer_size);
+            type_data.m_Capacity = max_vertex_count;
         }
 
         debug_renderer.m_3dPredicate.m_Tags[0] = dmHashString64(DEBUG_3D_NAME);
@@ -116,6 +114,9 @@ namespace dmRender
         debug_renderer.m_2dPredicate.m_Tags[0] = dmHashString64(DEBUG_2D_NAME);
         debug_renderer.m_2dPredicate.m_TagCount = 1;
         debug_renderer.m_RenderBatchVersion = 0;
+        debug_renderer.m_DrawViewCount = 0;
+        debug_renderer.m_CullFrustumCount = 0;
+        debug_renderer.m_DrawViewOverflow = 0;
     }
 
     void FinalizeDebugRenderer(HRenderContext context)
@@ -138,7 +139,7 @@ namespace dmRender
 
         for (uint32_t i = 0; i < MAX_DEBUG_RENDER_TYPE_COUNT; ++i)
         {
-            delete [] (char*)debug_renderer.m_TypeData[i].m_ClientBuffer;
+            free(debug_renderer.m_TypeData[i].m_ClientBuffer);
         }
         dmGraphics::DeleteVertexBuffer(debug_renderer.m_VertexBuffer);
         dmGraphics::DeleteVertexDeclaration(debug_renderer.m_VertexDeclaration);
@@ -148,73 +149,105 @@ namespace dmRender
     {
         if (!context->m_DebugRenderer.m_RenderContext)
             return;
+        DebugRenderer& debug_renderer = context->m_DebugRenderer;
         for (uint32_t i = 0; i < MAX_DEBUG_RENDER_TYPE_COUNT; ++i)
         {
-            context->m_DebugRenderer.m_TypeData[i].m_RenderObject.m_VertexCount = 0;
+            debug_renderer.m_TypeData[i].m_RenderObject.m_VertexCount = 0;
+        }
+        debug_renderer.m_RenderBatchVersion = 0;
+
+        // The views of this frame are used to cull the batches of the next frame
+        debug_renderer.m_CullFrustumCount = 0;
+        if (!debug_renderer.m_DrawViewOverflow)
+        {
+            for (uint32_t i = 0; i < debug_renderer.m_DrawViewCount; ++i)
+            {
+                dmIntersection::CreateFrustumFromMatrix(debug_renderer.m_DrawViewProj[i], true, (int) FRUSTUM_PLANES_SIDES, debug_renderer.m_CullFrustums[i]);
+            }
+            debug_renderer.m_CullFrustumCount = debug_renderer.m_DrawViewCount;
         }
-        context->m_DebugRenderer.m_RenderBatchVersion = 0;
+        debug_renderer.m_DrawViewCount = 0;
+        debug_renderer.m_DrawViewOverflow = 0;
     }
 
-    static void LogVertexWarning(HRenderContext context)
+    void AddDebugDrawView(HRenderContext context, const Matrix4& view_proj)
     {
-        static bool has_warned = false;
-        if (!has_warned)
+        DebugRenderer& debug_renderer = context->m_DebugRenderer;
+        for (uint32_t i = 0; i < debug_renderer.m_DrawViewCount; ++i)
         {
-            dmLogWarning("Out of debug vertex data (%u). Increase graphics.max_debug_vertices to avoid this warning.", context->m_DebugRenderer.m_MaxVertexCount);
-            has_warned = true;
+            if (memcmp(&debug_renderer.m_DrawViewProj[i], &view_proj, sizeof(Matrix4)) == 0)
+                return;
         }
+        if (debug_renderer.m_DrawViewCount < MAX_DEBUG_CULL_VIEW_COUNT)
+            debug_renderer.m_DrawViewProj[debug_renderer.m_DrawViewCount++] = view_proj;
+        else
+            debug_renderer.m_DrawViewOverflow = 1;
     }
 
-    void Square2d(HRenderContext context, float x0, float y0, float x1, float y1, Vector4 color)
+    // Returns room for the vertices at the end of the client buffer of the type, which is grown if needed
+    static DebugVertex* AllocVertices(DebugRenderer& debug_renderer, DebugRenderType type, uint32_t vertex_count)
     {
-        if (!context->m_DebugRenderer.m_RenderContext)
-            return;
-        DebugRenderTypeData& type_data = context->m_DebugRenderer.m_TypeData[DEBUG_RENDER_TYPE_FACE_2D];
+        DebugRenderTypeData& type_data = debug_renderer.m_TypeData[type];
         RenderObject& ro = type_data.m_RenderObject;
-        const uint32_t vertex_count = 6;
-        if (ro.m_VertexCount + vertex_count < context->m_DebugRenderer.m_MaxVertexCount)
+        uint32_t required = ro.m_VertexCount + vertex_count;
+        if (required > type_data.m_Capacity)
         {
-            DebugVertex v[vertex_count];
-            v[0].m_Position = Vector4(x0, y0, 0.0f, 0.0f);
-            v[1].m_Position = Vector4(x0, y1, 0.0f, 0.0f);
-            v[2].m_Position = Vector4(x1, y0, 0.0f, 0.0f);
-            v[5].m_Position = Vector4(x1, y1, 0.0f, 0.0f);
-            v[3].m_Position = v[2].m_Position;
-            v[4].m_Position = v[1].m_Position;
-            for (uint32_t i = 0; i < vertex_count; ++i)
-                v[i].m_Color = color;
-            char* buffer = (char*)type_data.m_ClientBuffer;
-            memcpy(&buffer[ro.m_VertexCount * sizeof(DebugVertex)], (const void*)v, vertex_count * sizeof(DebugVertex));
-            ro.m_VertexCount += vertex_count;
+            uint32_t capacity = dmMath::Max(required, type_data.m_Capacity * 2);
+            type_data.m_ClientBuffer = (DebugVertex*) realloc(type_data.m_ClientBuffer, capacity * sizeof(DebugVertex));
+            type_data.m_Capacity = capacity;
         }
-        else
+        DebugVertex* v = type_data.m_ClientBuffer + ro.m_VertexCount;
+        ro.m_VertexCount = required;
+        return v;
+    }
+
+    // Checks the bounds of the points against the views that drew the debug data the previous frame
+    static bool IsDebugBatchVisible(const DebugRenderer& debug_renderer, const Point3* points, uint32_t point_count)
+    {
+        if (debug_renderer.m_CullFrustumCount == 0 || point_count == 0)
+            return true;
+
+        Vector3 aabb_min(points[0]);
+        Vector3 aabb_max(points[0]);
+        for (uint32_t i = 1; i < point_count; ++i)
+        {
+            aabb_min = minPerElem(aabb_min, Vector3(points[i]));
+            aabb_max = maxPerElem(aabb_max, Vector3(points[i]));
+        }
+
+        const Matrix4 world = Matrix4::identity();
+        for (uint32_t i = 0; i < debug_renderer.m_CullFrustumCount; ++i)
         {
-            LogVertexWarning(context);
+            if (dmIntersection::TestFrustumOBB(debug_renderer.m_CullFrustums[i], world, aabb_min, aabb_max))
+                return true;
         }
+        return false;
+    }
+
+    void Square2d(HRenderContext context, float x0, float y0, float x1, float y1, Vector4 color)
+    {
+        if (!context->m_DebugRenderer.m_RenderContext)
+            return;
+        DebugVertex* v = AllocVertices(context->m_DebugRenderer, DEBUG_RENDER_TYPE_FACE_2D, 6);
+        v[0].m_Position = Vector4(x0, y0, 0.0f, 0.0f);
+        v[1].m_Position = Vector4(x0, y1, 0.0f, 0.0f);
+        v[2].m_Position = Vector4(x1, y0, 0.0f, 0.0f);
+        v[5].m_Position = Vector4(x1, y1, 0.0f, 0.0f);
+        v[3].m_Position = v[2].m_Position;
+        v[4].m_Position = v[1].m_Position;
+        for (uint32_t i = 0; i < 6; ++i)
+            v[i].m_Color = color;
     }
 
     void Triangle3d(HRenderContext context, Point3 vertices[3], Vector4 color)
     {
         if (!context->m_DebugRenderer.m_RenderContext)
             return;
-        DebugRenderTypeData& type_data = context->m_DebugRenderer.m_TypeData[DEBUG_RENDER_TYPE_FACE_3D];
-        RenderObject& ro = type_data.m_RenderObject;
-        const uint32_t vertex_count = 3;
-        if (ro.m_VertexCount + vertex_count < context->m_DebugRenderer.m_MaxVertexCount)
+        DebugVertex* v = AllocVertices(context->m_DebugRenderer, DEBUG_RENDER_TYPE_FACE_3D, 3);
+        for (uint32_t i = 0; i < 3; ++i)
         {
-            DebugVertex v[vertex_count];
-            for (uint32_t i = 0; i < vertex_count; ++i)
-            {
-                v[i].m_Position = Vector4(vertices[i]);
-                v[i].m_Color = color;
-            }
-            char* buffer = (char*)type_data.m_ClientBuffer;
-            memcpy(&buffer[ro.m_VertexCount * sizeof(DebugVertex)], (const void*)v, vertex_count * sizeof(DebugVertex));
-            ro.m_VertexCount += vertex_count;
-        }
-        else
-        {
-            LogVertexWarning(context);
+            v[i].m_Position = Vector4(vertices[i]);
+            v[i].m_Color = color;
         }
     }
 
@@ -222,50 +255,48 @@ namespace dmRender
     {
         if (!context->m_DebugRenderer.m_RenderContext)
             return;
-        DebugRenderTypeData& type_data = context->m_DebugRenderer.m_TypeData[DEBUG_RENDER_TYPE_LINE_2D];
-        RenderObject& ro = type_data.m_RenderObject;
-        const uint32_t vertex_count = 2;
-        if (ro.m_VertexCount + vertex_count < context->m_DebugRenderer.m_MaxVertexCount)
-        {
-            DebugVertex v[vertex_count];
-            v[0].m_Position = Vector4(x0, y0, 0.0f, 0.0f);
-            v[0].m_Color = color0;
-            v[1].m_Position = Vector4(x1, y1, 0.0f, 0.0f);
-            v[1].m_Color = color1;
-            char* buffer = (char*)type_data.m_ClientBuffer;
-            memcpy(&buffer[ro.m_VertexCount * sizeof(DebugVertex)], (const void*)v, vertex_count * sizeof(DebugVertex));
-            ro.m_VertexCount += vertex_count;
-        }
-        else
-        {
-            LogVertexWarning(context);
-        }
+        DebugVertex* v = AllocVertices(context->m_DebugRenderer, DEBUG_RENDER_TYPE_LINE_2D, 2);
+        v[0].m_Position = Vector4(x0, y0, 0.0f, 0.0f);
+        v[0].m_Color = color0;
+        v[1].m_Position = Vector4(x1, y1, 0.0f, 0.0f);
+        v[1].m_Color = color1;
     }
 
     void Line3D(HRenderContext context, Point3 start, Point3 end, Vector4 start_color, Vector4 end_color)
     {
         if (!context->m_DebugRenderer.m_RenderContext)
             return;
-        DebugRenderTypeData& type_data = context->m_DebugRenderer.m_TypeData[DEBUG_RENDER_TYPE_LINE_3D];
-        RenderObject& ro = type_data.m_RenderObject;
-        const uint32_t vertex_count = 2;
-        if (ro.m_VertexCount + vertex_count < context->m_DebugRenderer.m_MaxVertexCount)
-        {
-            DebugVertex v[vertex_count];
-            v[0].m_Position = Vector4(start);
-            v[0].m_Color = start_color;
-            v[1].m_Position = Vector4(end);
-            v[1].m_Color = end_color;
-            char* buffer = (char*)type_data.m_ClientBuffer;
-            memcpy(&buffer[ro.m_VertexCount * sizeof(DebugVertex)], (const void*)v, vertex_count * sizeof(DebugVertex));
-            ro.m_VertexCount += vertex_count;
-        }
-        else
+        DebugVertex* v = AllocVertices(context->m_DebugRenderer, DEBUG_RENDER_TYPE_LINE_3D, 2);
+        v[0].m_Position = Vector4(start);
+        v[0].m_Color = start_color;
+        v[1].m_Position = Vector4(end);
+        v[1].m_Color = end_color;
+    }
+
+    static void AddDebugBatch(HRenderContext context, DebugRenderType type, const Point3* points, uint32_t point_count, Vector4 color)
+    {
+        if (!context->m_DebugRenderer.m_RenderContext || point_count == 0)
+            return;
+        if (!IsDebugBatchVisible(context->m_DebugRenderer, points, point_count))
+            return;
+        DebugVertex* v = AllocVertices(context->m_DebugRenderer, type, point_count);
+        for (uint32_t i = 0; i < point_count; ++i)
         {
-            LogVertexWarning(context);
+            v[i].m_Position = Vector4(points[i]);
+            v[i].m_Color = color;
         }
     }
 
+    void Lines3D(HRenderContext context, const Point3* points, uint32_t point_count, Vector4 color)
+    {
+        AddDebugBatch(context, DEBUG_RENDER_TYPE_LINE_3D, points, point_count & ~1u, color);
+    }
+
+    void Triangles3D(HRenderContext context, const Point3* points, uint32_t point_count, Vector4 color)
+    {
+        AddDebugBatch(context, DEBUG_RENDER_TYPE_FACE_3D, points, point_count - point_count % 3, color);
+    }
+
     static void DebugRenderListDispatch(dmRender::RenderListDispatchParams const &params)
     {
         DebugRenderer *debug_renderer = (DebugRenderer *)params.m_UserData;
@@ -22,7 +22,7 @@ namespace dmRender
     /**
      * Initialize debug render system
      * @param render_context Render context
-     * @param max_vertex_count Max vertex count (per type)
+     * @param max_vertex_count Initial vertex count (per type), the buffers grow if more is drawn
      * @param vp_desc VertexProgram shader desc
      * @param vp_desc_size VertexProgram shader desc size
      * @param fp_desc FragmentProgram shader desc
@@ -38,6 +38,11 @@ namespace dmRender
     void ClearDebugRenderObjects(HRenderContext render_context);
 
     void FlushDebug(HRenderContext render_context, uint32_t render_order);
+
+    /**
+     * Register a view that draws the 3d debug data this frame. The views are used to cull the batches of the next frame
+     */
+    void AddDebugDrawView(HRenderContext render_context, const dmVMath::Matrix4& view_proj);
 }
 
 #endif // DM_RENDER_DEBUG_RENDERER_H
@@ -98,6 +98,7 @@ namespace dmRender
     , m_LayerMask(FACE)
     , m_IsMonospaced(false)
     , m_ImageFormat(dmRenderDDF::TYPE_BITMAP)
+    , m_CacheFontMap(0)
     {
 
     }
@@ -111,6 +112,36 @@ namespace dmRender
         int16_t              m_Y;
     };
 
+    static const uint32_t GLYPH_CACHE_MAX_GROWTH      = 4;  // The cache texture may grow up to this many times its initial height
+    static const uint32_t GLYPH_CACHE_MAX_CELL_COUNT  = 0x10000; // The cache indices are 16 bit
+
+    static const uint32_t TEXT_LAYOUT_CACHE_SIZE      = 256;
+    static const uint32_t TEXT_LAYOUT_CACHE_MAX_LINES = 8;  // Texts with more lines are laid out each time
+
+    // The line breaks of a text, for a given font, width and tracking
+    struct TextLayout
+    {
+        uint64_t             m_Key;
+        uint32_t             m_LastUsed;
+        float                m_Width;
+        uint32_t             m_LineCount;
+        TextLine             m_Lines[TEXT_LAYOUT_CACHE_MAX_LINES];
+    };
+
+    // A glyph waiting to be written to the cache texture
+    struct GlyphUpload
+    {
+        const uint8_t*       m_Data;
+        uint32_t             m_DataSize;
+        uint32_t             m_Compression;
+        uint32_t             m_Character;
+        uint16_t             m_Width;   // The glyph image size
+        uint16_t             m_Height;
+        int16_t              m_X;       // The cache cell
+        int16_t              m_Y;
+        int16_t              m_OffsetY; // The glyph offset within the cache cell
+    };
+
     struct FontMap
     {
         FontMap()
@@ -124,7 +155,11 @@ namespace dmRender
         , m_ShadowY(0.0f)
         , m_MaxAscent(0.0f)
         , m_MaxDescent(0.0f)
-        , m_CellTempData(0)
+        , m_CacheFontMap(this)
+        , m_GraphicsContext(0)
+        , m_RefCount(1)
+        , m_CacheData(0)
+        , m_TextLayoutTime(0)
         , m_Cache(0)
         , m_CacheIndices(0)
         , m_CacheCursor(0)
@@ -136,9 +171,12 @@ namespace dmRender
         , m_CacheColumns(0)
         , m_CacheRows(0)
         , m_CacheCellCount(0)
+        , m_CacheMaxHeight(0)
+        , m_CacheBatchFrame(~0u)
         , m_CacheCellPadding(0)
         , m_LayerMask(FACE)
         , m_IsMonospaced(false)
+        , m_CacheGrowRequested(0)
         , m_Padding(0)
         {
         }
@@ -151,10 +189,13 @@ namespace dmRender
             free(m_Cache);
             m_Cache = 0;
 
-            free(m_CellTempData);
-            m_CellTempData = 0;
+            free(m_CacheData);
+            m_CacheData = 0;
 
-            dmGraphics::DeleteTexture(m_Texture);
+            if (m_Texture)
+            {
+                dmGraphics::DeleteTexture(m_Texture);
+            }
         }
 
         void*                   m_UserData; // The font map resources (see res_font.cpp)
@@ -177,7 +218,20 @@ namespace dmRender
         float                   m_OutlineAlpha;
         float                   m_ShadowAlpha;
 
-        uint8_t*                m_CellTempData; // a temporary unpack buffer for the compressed glyphs
+        // The font map owning the glyph cache, which is itself unless the cache is shared.
+        // The cache fields below are only used in the owner, and the font maps sharing it hold a reference to it
+        FontMap*                m_CacheFontMap;
+        dmGraphics::HContext    m_GraphicsContext;
+        uint32_t                m_RefCount;
+
+        dmArray<uint8_t>        m_CellTempData; // temporary unpack buffers for the compressed glyphs, one per decoding thread
+        uint8_t*                m_CacheData;    // a copy of the cache texture, where the glyphs are written before they're uploaded
+        dmArray<GlyphUpload>    m_GlyphUploads; // the glyphs added to the cache since the last upload
+        int32_atomic_t          m_GlyphUploadNextItem;
+
+        dmArray<TextLayout>         m_TextLayouts;          // The most recently used text layouts
+        dmHashTable64<uint16_t>     m_TextLayoutIndices;    // Layout key to index into m_TextLayouts
+        uint32_t                    m_TextLayoutTime;
 
         dmHashTable32<CacheGlyph*>  m_GlyphCache;   // Quick check what glyphs are in the cache
         CacheGlyph*                 m_Cache;        // The data (i.e. the pool)
@@ -196,30 +250,27 @@ namespace dmRender
         uint32_t                m_CacheColumns;         // Number of cells in horizontal direction
         uint32_t                m_CacheRows;            // Number of cells in horizontal direction
         uint32_t                m_CacheCellCount;       // Number of cells in total
+        uint32_t                m_CacheMaxHeight;       // In texels. The cache texture grows up to this height when it's too small
+        uint32_t                m_CacheBatchFrame;      // The last frame the font map was rendered
         uint8_t                 m_CacheChannels;        // Number of channels
         uint8_t                 m_CacheCellPadding;
         uint8_t                 m_LayerMask;
         uint8_t                 m_IsMonospaced:1;
-        uint8_t                 m_Padding:7;
+        uint8_t                 m_CacheGrowRequested:1;
+        uint8_t                 m_Padding:6;
     };
 
     static float GetLineTextMetrics(HFontMap font_map, float tracking, const char* text, int n, bool measure_trailing_space);
 
-    static void InitFontmap(FontMapParams& params, dmGraphics::TextureParams& tex_params, uint8_t init_val)
+    static void InitFontmap(uint8_t channels, dmGraphics::TextureParams& tex_params, uint8_t init_val)
     {
-        uint8_t bpp = params.m_GlyphChannels;
+        uint8_t bpp = channels;
         uint32_t data_size = tex_params.m_Width * tex_params.m_Height * bpp;
         tex_params.m_Data = malloc(data_size);
         tex_params.m_DataSize = data_size;
         memset((void*)tex_params.m_Data, init_val, tex_params.m_DataSize);
     }
 
-    static void CleanupFontmap(dmGraphics::TextureParams& tex_params)
-    {
-        free((void*)tex_params.m_Data);
-        tex_params.m_DataSize = 0;
-    }
-
     // Font maps have no mips, so we need to make sure we use a supported min filter
     static dmGraphics::TextureFilter ConvertMinTextureFilter(dmGraphics::TextureFilter filter)
     {
@@ -235,46 +286,49 @@ namespace dmRender
         return filter;
     }
 
+    static void InitCacheCells(HFontMap font_map, uint32_t begin, uint32_t end)
+    {
+        for (uint32_t i = begin; i < end; ++i)
+        {
+            font_map->m_CacheIndices[i] = i;
+
+            CacheGlyph* glyph = &font_map->m_Cache[i];
+            glyph->m_Glyph = 0;
+            glyph->m_Frame = 0;
+
+            // We calculate these only once
+            uint32_t col = i % font_map->m_CacheColumns;
+            uint32_t row = i / font_map->m_CacheColumns;
+            glyph->m_X = col * font_map->m_CacheCellWidth;
+            glyph->m_Y = row * font_map->m_CacheCellHeight;
+        }
+    }
+
     static void SetupCache(HFontMap font_map, uint32_t texture_width, uint32_t texture_height,
                                              uint32_t cell_width, uint32_t cell_height, uint32_t max_ascent)
     {
         if (font_map->m_Cache)
         {
             free(font_map->m_Cache);
-            free(font_map->m_CellTempData);
             free(font_map->m_CacheIndices);
             font_map->m_GlyphCache.Clear();
         }
+        font_map->m_GlyphUploads.SetSize(0);
 
         font_map->m_CacheCellWidth = cell_width;
         font_map->m_CacheCellHeight = cell_height;
         font_map->m_CacheCellMaxAscent = max_ascent;
 
         font_map->m_CacheColumns = texture_width / cell_width;
-        font_map->m_CacheRows = texture_height / cell_height;
+        font_map->m_CacheRows = dmMath::Min(texture_height / cell_height, GLYPH_CACHE_MAX_CELL_COUNT / dmMath::Max(font_map->m_CacheColumns, 1u));
         font_map->m_CacheCellCount = font_map->m_CacheColumns * font_map->m_CacheRows;
 
-        font_map->m_CellTempData = (uint8_t*)malloc(font_map->m_CacheCellWidth*font_map->m_CacheCellHeight*4);
-
         font_map->m_CacheIndices = (uint16_t*)malloc(sizeof(uint16_t) * font_map->m_CacheCellCount);
         memset(font_map->m_CacheIndices, 0, sizeof(uint16_t) * font_map->m_CacheCellCount);
 
         font_map->m_Cache = (CacheGlyph*)malloc(sizeof(CacheGlyph) * font_map->m_CacheCellCount);
         memset(font_map->m_Cache, 0, sizeof(CacheGlyph*) * font_map->m_CacheCellCount);
-        for (uint32_t i = 0; i < font_map->m_CacheCellCount; ++i)
-        {
-            font_map->m_CacheIndices[i] = i;
-
-            CacheGlyph* glyph = &font_map->m_Cache[i];
-            glyph->m_Glyph = 0;
-            glyph->m_Frame = 0;
-
-            // We calculate these only once
-            uint32_t col = i % font_map->m_CacheColumns;
-            uint32_t row = i / font_map->m_CacheColumns;
-            glyph->m_X = col * font_map->m_CacheCellWidth;
-            glyph->m_Y = row * font_map->m_CacheCellHeight;
-        }
+        InitCacheCells(font_map, 0, font_map->m_CacheCellCount);
 
         uint32_t old_cap = font_map->m_GlyphCache.Capacity();
         int new_cap = font_map->m_CacheCellCount;
@@ -284,6 +338,87 @@ namespace dmRender
         }
     }
 
+    static bool IsCacheCompatible(HFontMap font_map, HFontMap cache_font_map)
+    {
+        return font_map->m_CacheCellWidth == cache_font_map->m_CacheCellWidth &&
+               font_map->m_CacheCellHeight == cache_font_map->m_CacheCellHeight &&
+               font_map->m_CacheCellMaxAscent == cache_font_map->m_CacheCellMaxAscent &&
+               font_map->m_CacheChannels == cache_font_map->m_CacheChannels &&
+               font_map->m_MinFilter == cache_font_map->m_MinFilter &&
+               font_map->m_MagFilter == cache_font_map->m_MagFilter;
+    }
+
+    static void DeleteCache(HFontMap font_map)
+    {
+        free(font_map->m_Cache);
+        font_map->m_Cache = 0;
+        free(font_map->m_CacheIndices);
+        font_map->m_CacheIndices = 0;
+        free(font_map->m_CacheData);
+        font_map->m_CacheData = 0;
+        font_map->m_GlyphCache.Clear();
+        font_map->m_GlyphUploads.SetSize(0);
+        font_map->m_CacheCursor = 0;
+
+        if (font_map->m_Texture)
+        {
+            dmGraphics::DeleteTexture(font_map->m_Texture);
+            font_map->m_Texture = 0;
+        }
+    }
+
+    // Creates the cache cells and the cache texture, from the cache parameters of the font map
+    static void CreateCache(HFontMap font_map)
+    {
+        SetupCache(font_map, font_map->m_CacheWidth, font_map->m_CacheHeight,
+                                font_map->m_CacheCellWidth, font_map->m_CacheCellHeight, font_map->m_CacheCellMaxAscent);
+
+        // create new texture to be used as a cache
+        dmGraphics::TextureCreationParams tex_create_params;
+        dmGraphics::TextureParams tex_params;
+        tex_create_params.m_Width = font_map->m_CacheWidth;
+        tex_create_params.m_Height = font_map->m_CacheHeight;
+        tex_create_params.m_OriginalWidth = font_map->m_CacheWidth;
+        tex_create_params.m_OriginalHeight = font_map->m_CacheHeight;
+        tex_params.m_Format = font_map->m_CacheFormat;
+
+        tex_params.m_Data = 0;
+        tex_params.m_DataSize = 0;
+        tex_params.m_Width = font_map->m_CacheWidth;
+        tex_params.m_Height = font_map->m_CacheHeight;
+        tex_params.m_MinFilter = dmGraphics::TEXTURE_FILTER_LINEAR;
+        tex_params.m_MagFilter = dmGraphics::TEXTURE_FILTER_LINEAR;
+
+        if (font_map->m_Texture)
+        {
+            dmGraphics::DeleteTexture(font_map->m_Texture);
+        }
+        font_map->m_Texture = dmGraphics::NewTexture(font_map->m_GraphicsContext, tex_create_params);
+
+        free(font_map->m_CacheData);
+        InitFontmap(font_map->m_CacheChannels, tex_params, 0);
+        dmGraphics::SetTexture(font_map->m_Texture, tex_params);
+        font_map->m_CacheData = (uint8_t*)tex_params.m_Data; // Kept, as the staging area for the glyph uploads
+    }
+
+    static void ReleaseFontMap(HFontMap font_map)
+    {
+        if (--font_map->m_RefCount == 0)
+        {
+            delete font_map;
+        }
+    }
+
+    // Stops using the glyph cache of another font map
+    static void ReleaseCacheFontMap(HFontMap font_map)
+    {
+        if (font_map->m_CacheFontMap != font_map)
+        {
+            ReleaseFontMap(font_map->m_CacheFontMap);
+            font_map->m_CacheFontMap = font_map;
+        }
+    }
+
     void SetFontMap(HFontMap font_map, dmGraphics::HContext graphics_context, FontMapParams& params)
     {
 
@@ -308,14 +443,19 @@ namespace dmRender
         font_map->m_IsMonospaced = params.m_IsMonospaced;
         font_map->m_Padding = params.m_Padding;
 
+        ClearFontMapLayoutCache(font_map);
+
+        font_map->m_GraphicsContext = graphics_context;
         font_map->m_CacheWidth = params.m_CacheWidth;
         font_map->m_CacheHeight = params.m_CacheHeight;
+        font_map->m_CacheMaxHeight = dmMath::Max(params.m_CacheHeight, dmMath::Min(params.m_CacheHeight * GLYPH_CACHE_MAX_GROWTH, dmGraphics::GetMaxTextureSize(graphics_context)));
+        font_map->m_CacheGrowRequested = 0;
+        font_map->m_CacheCellWidth = params.m_CacheCellWidth;
+        font_map->m_CacheCellHeight = params.m_CacheCellHeight;
+        font_map->m_CacheCellMaxAscent = params.m_CacheCellMaxAscent;
         font_map->m_CacheCellPadding = params.m_CacheCellPadding;
         font_map->m_CacheChannels = params.m_GlyphChannels;
 
-        SetupCache(font_map, font_map->m_CacheWidth, font_map->m_CacheHeight,
-                                params.m_CacheCellWidth, params.m_CacheCellHeight, params.m_CacheCellMaxAscent);
-
         switch (params.m_GlyphChannels)
         {
             case 1:
@@ -345,32 +485,26 @@ namespace dmRender
             font_map->m_MagFilter = dmGraphics::TEXTURE_FILTER_LINEAR;
         }
 
+        ReleaseCacheFontMap(font_map);
 
-        // create new texture to be used as a cache
-        dmGraphics::TextureCreationParams tex_create_params;
-        dmGraphics::TextureParams tex_params;
-        tex_create_params.m_Width = params.m_CacheWidth;
-        tex_create_params.m_Height = params.m_CacheHeight;
-        tex_create_params.m_OriginalWidth = params.m_CacheWidth;
-        tex_create_params.m_OriginalHeight = params.m_CacheHeight;
-        tex_params.m_Format = font_map->m_CacheFormat;
-
-        tex_params.m_Data = 0;
-        tex_params.m_DataSize = 0;
-        tex_params.m_Width = params.m_CacheWidth;
-        tex_params.m_Height = params.m_CacheHeight;
-        tex_params.m_MinFilter = dmGraphics::TEXTURE_FILTER_LINEAR;
-        tex_params.m_MagFilter = dmGraphics::TEXTURE_FILTER_LINEAR;
-
-        if (font_map->m_Texture)
+        FontMap* cache_font_map = params.m_CacheFontMap ? params.m_CacheFontMap->m_CacheFontMap : 0;
+        if (cache_font_map && !IsCacheCompatible(font_map, cache_font_map))
         {
-            dmGraphics::DeleteTexture(font_map->m_Texture);
+            dmLogWarning("The glyph cache of font %s can't be shared with font %s", dmHashReverseSafe64(font_map->m_NameHash), dmHashReverseSafe64(cache_font_map->m_NameHash));
+            cache_font_map = 0;
         }
-        font_map->m_Texture = dmGraphics::NewTexture(graphics_context, tex_create_params);
 
-        InitFontmap(params, tex_params, 0);
-        dmGraphics::SetTexture(font_map->m_Texture, tex_params);
-        CleanupFontmap(tex_params);
+        // A font map with font maps sharing its own cache keeps it
+        if (cache_font_map && cache_font_map != font_map && font_map->m_RefCount == 1)
+        {
+            DeleteCache(font_map);
+            cache_font_map->m_RefCount++;
+            font_map->m_CacheFontMap = cache_font_map;
+        }
+        else
+        {
+            CreateCache(font_map);
+        }
     }
 
     HFontMap NewFontMap(dmGraphics::HContext graphics_context, FontMapParams& params)
@@ -382,25 +516,46 @@ namespace dmRender
 
     void SetFontMapCacheSize(HFontMap font_map, uint32_t cell_width, uint32_t cell_height, uint32_t max_ascent)
     {
+        // The cells of a shared cache can't change under the other font maps
+        UnshareFontMapCache(font_map);
+
         // TODO: DO we need to clear the texture?
-        SetupCache(font_map, font_map->m_CacheWidth, font_map->m_CacheWidth,
+        SetupCache(font_map, font_map->m_CacheWidth, font_map->m_CacheHeight,
                             cell_width, cell_height, max_ascent);
     }
 
     void GetFontMapCacheSize(HFontMap font_map, uint32_t* cell_width, uint32_t* cell_height, uint32_t* max_ascent)
     {
-        *cell_width = font_map->m_CacheCellWidth;
-        *cell_height = font_map->m_CacheCellHeight;
-        *max_ascent = font_map->m_CacheCellMaxAscent;
+        FontMap* cache = font_map->m_CacheFontMap;
+        *cell_width = cache->m_CacheCellWidth;
+        *cell_height = cache->m_CacheCellHeight;
+        *max_ascent = cache->m_CacheCellMaxAscent;
+    }
+
+    void UnshareFontMapCache(HFontMap font_map)
+    {
+        if (font_map->m_CacheFontMap != font_map)
+        {
+            ReleaseCacheFontMap(font_map);
+            CreateCache(font_map);
+        }
+    }
+
+    bool IsFontMapCacheShared(HFontMap font_map)
+    {
+        return font_map->m_CacheFontMap != font_map;
     }
 
     void DeleteFontMap(HFontMap font_map)
     {
-        delete font_map;
+        // The cache of the font map is kept until the font maps sharing it are deleted
+        ReleaseCacheFontMap(font_map);
+        ReleaseFontMap(font_map);
     }
 
     void SetFontMapUserData(HFontMap font_map, void* user_data)
     {
+        ClearFontMapLayoutCache(font_map);
         font_map->m_UserData = user_data;
     }
 
@@ -411,7 +566,7 @@ namespace dmRender
 
     dmGraphics::HTexture GetFontMapTexture(HFontMap font_map)
     {
-        return font_map->m_Texture;
+        return font_map->m_CacheFontMap->m_Texture;
     }
 
     void SetFontMapMaterial(HFontMap font_map, HMaterial material)
@@ -512,7 +667,9 @@ namespace dmRender
     , m_LineBreak(false)
     , m_Align(TEXT_ALIGN_LEFT)
     , m_VAlign(TEXT_VALIGN_TOP)
+    , m_ScissorRect(0.0f)
     , m_StencilTestParamsSet(0)
+    , m_ScissorSet(0)
     {
         m_StencilTestParams.Init();
     }
@@ -528,6 +685,78 @@ namespace dmRender
         }
     };
 
+    // Lays out the text, or copies the layout from the cache if the same text has been laid out with the same parameters
+    static uint32_t LayoutCached(HFontMap font_map, const char* text, float width, float tracking, bool measure_trailing_space, TextLine* lines, uint32_t max_lines, float* layout_width)
+    {
+        HashState64 key_state;
+        dmHashInit64(&key_state, false);
+        dmHashUpdateBuffer64(&key_state, &width, sizeof(width));
+        dmHashUpdateBuffer64(&key_state, &tracking, sizeof(tracking));
+        dmHashUpdateBuffer64(&key_state, &measure_trailing_space, sizeof(measure_trailing_space));
+        dmHashUpdateBuffer64(&key_state, text, strlen(text));
+        uint64_t key = dmHashFinal64(&key_state);
+
+        uint32_t time = ++font_map->m_TextLayoutTime;
+
+        uint16_t* index = font_map->m_TextLayoutIndices.Get(key);
+        if (index)
+        {
+            TextLayout& layout = font_map->m_TextLayouts[*index];
+            layout.m_LastUsed = time;
+            uint32_t line_count = dmMath::Min(layout.m_LineCount, max_lines);
+            memcpy(lines, layout.m_Lines, sizeof(TextLine) * line_count);
+            *layout_width = layout.m_Width;
+            return line_count;
+        }
+
+        LayoutMetrics lm(font_map, tracking);
+        uint32_t line_count = Layout(text, width, lines, max_lines, layout_width, lm, measure_trailing_space);
+        if (line_count > TEXT_LAYOUT_CACHE_MAX_LINES)
+        {
+            return line_count;
+        }
+
+        dmArray<TextLayout>& layouts = font_map->m_TextLayouts;
+        if (layouts.Capacity() == 0)
+        {
+            layouts.SetCapacity(TEXT_LAYOUT_CACHE_SIZE);
+            font_map->m_TextLayoutIndices.SetCapacity((TEXT_LAYOUT_CACHE_SIZE * 2) / 3, TEXT_LAYOUT_CACHE_SIZE);
+        }
+
+        uint32_t layout_index;
+        if (!layouts.Full())
+        {
+            layout_index = layouts.Size();
+            layouts.SetSize(layout_index + 1);
+        }
+        else
+        {
+            // Replace the least recently used layout
+            layout_index = 0;
+            for (uint32_t i = 1; i < layouts.Size(); ++i)
+            {
+                if (layouts[i].m_LastUsed < layouts[layout_index].m_LastUsed)
+                    layout_index = i;
+            }
+            font_map->m_TextLayoutIndices.Erase(layouts[layout_index].m_Key);
+        }
+
+        TextLayout& layout = layouts[layout_index];
+        layout.m_Key = key;
+        layout.m_LastUsed = time;
+        layout.m_Width = *layout_width;
+        layout.m_LineCount = line_count;
+        memcpy(layout.m_Lines, lines, sizeof(TextLine) * line_count);
+        font_map->m_TextLayoutIndices.Put(key, (uint16_t)layout_index);
+        return line_count;
+    }
+
+    void ClearFontMapLayoutCache(HFontMap font_map)
+    {
+        font_map->m_TextLayouts.SetSize(0);
+        font_map->m_TextLayoutIndices.Clear();
+    }
+
     static dmhash_t g_TextureSizeRecipHash = dmHashString64("texture_size_recip");
 
     static dmVMath::Point3 CalcCenterPoint(HFontMap font_map, const TextEntry& te, const TextMetrics& metrics) {
@@ -551,6 +780,53 @@ namespace dmRender
         return center_point;
     }
 
+    static void InitTextEntry(HFontMap font_map, HMaterial material, uint64_t batch_key, const DrawTextParams& params, TextEntry* te)
+    {
+        te->m_Transform = params.m_WorldTransform;
+        te->m_StringOffset = 0;
+        te->m_FontMap = font_map;
+        te->m_Material = material;
+        te->m_BatchKey = batch_key;
+        te->m_Next = -1;
+        te->m_Tail = -1;
+
+        te->m_FaceColor = dmGraphics::PackRGBA(Vector4(params.m_FaceColor.getXYZ(), params.m_FaceColor.getW() * font_map->m_Alpha));
+        te->m_OutlineColor = dmGraphics::PackRGBA(Vector4(params.m_OutlineColor.getXYZ(), params.m_OutlineColor.getW() * font_map->m_OutlineAlpha));
+        te->m_ShadowColor = dmGraphics::PackRGBA(Vector4(params.m_ShadowColor.getXYZ(), params.m_ShadowColor.getW() * font_map->m_ShadowAlpha));
+        te->m_RenderOrder = params.m_RenderOrder;
+        te->m_Width = params.m_Width;
+        te->m_Height = params.m_Height;
+        te->m_Leading = params.m_Leading;
+        te->m_Tracking = params.m_Tracking;
+        te->m_LineBreak = params.m_LineBreak;
+        te->m_Align = params.m_Align;
+        te->m_VAlign = params.m_VAlign;
+        te->m_StencilTestParams = params.m_StencilTestParams;
+        te->m_StencilTestParamsSet = params.m_StencilTestParamsSet;
+        te->m_ScissorRect = params.m_ScissorRect;
+        te->m_ScissorSet = params.m_ScissorSet;
+        te->m_SourceBlendFactor = params.m_SourceBlendFactor;
+        te->m_DestinationBlendFactor = params.m_DestinationBlendFactor;
+
+        assert( params.m_NumRenderConstants <= dmRender::MAX_FONT_RENDER_CONSTANTS );
+        te->m_NumRenderConstants = params.m_NumRenderConstants;
+        memcpy( te->m_RenderConstants, params.m_RenderConstants, params.m_NumRenderConstants * sizeof(dmRender::HConstant));
+    }
+
+    static void CalcBoundingSphere(HFontMap font_map, const TextEntry& te, const char* text, dmVMath::Point3* center, float* radius_sq)
+    {
+        TextMetrics metrics;
+        GetTextMetrics(font_map, text, te.m_Width, te.m_LineBreak, te.m_Leading, te.m_Tracking, &metrics);
+
+        dmVMath::Point3 centerpoint_local = CalcCenterPoint(font_map, te, metrics);
+        dmVMath::Point3 cornerpoint_local(centerpoint_local.getX() + metrics.m_Width/2, centerpoint_local.getY() + metrics.m_Height/2, centerpoint_local.getZ());
+        dmVMath::Vector4 centerpoint_world = te.m_Transform * centerpoint_local; // transform to world coordinates
+        dmVMath::Vector4 cornerpoint_world = te.m_Transform * cornerpoint_local;
+
+        *radius_sq = dmVMath::LengthSqr(cornerpoint_world - centerpoint_world);
+        *center = dmVMath::Point3(centerpoint_world.getXYZ());
+    }
+
     void DrawText(HRenderContext render_context, HFontMap font_map, HMaterial material, uint64_t batch_key, const DrawTextParams& params)
     {
         DM_PROFILE("DrawText");
@@ -564,15 +840,21 @@ namespace dmRender
 
         // The gui doesn't currently generate a batch key for each gui node, but instead rely on this being generated by the DrawText
         // The label component however, generates a batchkey when the label changes (which is usually not every frame)
+        material = material ? material : GetFontMapMaterial(font_map);
+
         if( batch_key == 0 )
         {
+            // Texts in font maps sharing the same glyph cache are batched together
             HashState64 key_state;
             dmHashInit64(&key_state, false);
-            dmHashUpdateBuffer64(&key_state, &font_map, sizeof(font_map));
+            dmHashUpdateBuffer64(&key_state, &font_map->m_CacheFontMap, sizeof(font_map->m_CacheFontMap));
             dmHashUpdateBuffer64(&key_state, &params.m_RenderOrder, sizeof(params.m_RenderOrder));
             if (params.m_StencilTestParamsSet) {
                 dmHashUpdateBuffer64(&key_state, &params.m_StencilTestParams, sizeof(params.m_StencilTestParams));
             }
+            if (params.m_ScissorSet) {
+                dmHashUpdateBuffer64(&key_state, &params.m_ScissorRect, sizeof(params.m_ScissorRect));
+            }
             if (material) {
                 dmHashUpdateBuffer64(&key_state, &material, sizeof(material));
             }
@@ -589,48 +871,12 @@ namespace dmRender
         text_context->m_TextBuffer.PushArray(params.m_Text, text_len);
         text_context->m_TextBuffer.Push('\0');
 
-        material = material ? material : GetFontMapMaterial(font_map);
         TextEntry te;
-        te.m_Transform = params.m_WorldTransform;
+        InitTextEntry(font_map, material, batch_key, params, &te);
         te.m_StringOffset = offset;
-        te.m_FontMap = font_map;
-        te.m_Material = material;
-        te.m_BatchKey = batch_key;
-        te.m_Next = -1;
-        te.m_Tail = -1;
-
-        te.m_FaceColor = dmGraphics::PackRGBA(Vector4(params.m_FaceColor.getXYZ(), params.m_FaceColor.getW() * font_map->m_Alpha));
-        te.m_OutlineColor = dmGraphics::PackRGBA(Vector4(params.m_OutlineColor.getXYZ(), params.m_OutlineColor.getW() * font_map->m_OutlineAlpha));
-        te.m_ShadowColor = dmGraphics::PackRGBA(Vector4(params.m_ShadowColor.getXYZ(), params.m_ShadowColor.getW() * font_map->m_ShadowAlpha));
-        te.m_RenderOrder = params.m_RenderOrder;
-        te.m_Width = params.m_Width;
-        te.m_Height = params.m_Height;
-        te.m_Leading = params.m_Leading;
-        te.m_Tracking = params.m_Tracking;
-        te.m_LineBreak = params.m_LineBreak;
-        te.m_Align = params.m_Align;
-        te.m_VAlign = params.m_VAlign;
-        te.m_StencilTestParams = params.m_StencilTestParams;
-        te.m_StencilTestParamsSet = params.m_StencilTestParamsSet;
-        te.m_SourceBlendFactor = params.m_SourceBlendFactor;
-        te.m_DestinationBlendFactor = params.m_DestinationBlendFactor;
-
-        TextMetrics metrics;
-        GetTextMetrics(font_map, params.m_Text, params.m_Width, params.m_LineBreak, params.m_Leading, params.m_Tracking, &metrics);
 
         // find center and radius for frustum culling
-        dmVMath::Point3 centerpoint_local = CalcCenterPoint(font_map, te, metrics);
-        dmVMath::Point3 cornerpoint_local(centerpoint_local.getX() + metrics.m_Width/2, centerpoint_local.getY() + metrics.m_Height/2, centerpoint_local.getZ());
-        dmVMath::Vector4 centerpoint_world = te.m_Transform * centerpoint_local; // transform to world coordinates
-        dmVMath::Vector4 cornerpoint_world = te.m_Transform * cornerpoint_local;
-
-        te.m_FrustumCullingRadiusSq = dmVMath::LengthSqr(cornerpoint_world - centerpoint_world);
-        te.m_FrustumCullingCenter = dmVMath::Point3(centerpoint_world.getXYZ());
-
-
-        assert( params.m_NumRenderConstants <= dmRender::MAX_FONT_RENDER_CONSTANTS );
-        te.m_NumRenderConstants = params.m_NumRenderConstants;
-        memcpy( te.m_RenderConstants, params.m_RenderConstants, params.m_NumRenderConstants * sizeof(dmRender::HConstant));
+        CalcBoundingSphere(font_map, te, params.m_Text, &te.m_FrustumCullingCenter, &te.m_FrustumCullingRadiusSq);
 
         text_context->m_TextEntries.Push(te);
     }
@@ -690,7 +936,7 @@ namespace dmRender
         else
             index = font_map->m_CacheCellCount-1;   // Get the oldest slot
 
-        return &font_map->m_Cache[index];
+        return &font_map->m_Cache[font_map->m_CacheIndices[index]];
     }
 
     static CacheGlyph* GetFromCache(HFontMap font_map, uint32_t c)
@@ -715,16 +961,24 @@ namespace dmRender
     //     }
     // }
 
-    static void UpdateGlyphTexture(HFontMap font_map, dmRender::FontGlyph* g, int32_t x, int32_t y, int offset_y)
+    static const uint32_t GLYPH_UPLOAD_JOB_MIN_GLYPHS = 16; // The min number of glyphs per decoding thread
+
+    static uint32_t GetCellTempDataSize(HFontMap font_map)
     {
-        uint32_t glyph_data_compression; // E.g. FONT_GLYPH_COMPRESSION_NONE;
-        uint32_t glyph_data_size = 0;
-        uint32_t glyph_image_width = 0;
-        uint32_t glyph_image_height = 0;
-        uint8_t* glyph_data = (uint8_t*)font_map->m_GetGlyphData(g->m_Character, font_map->m_UserData, &glyph_data_size, &glyph_data_compression, &glyph_image_width, &glyph_image_height);
+        return font_map->m_CacheCellWidth * font_map->m_CacheCellHeight * 4;
+    }
+
+    // Decodes the glyph into its cell in the cache texture copy. Only writes to the cell, and to temp_data,
+    // so that several glyphs can be written concurrently
+    static void WriteGlyphToCache(HFontMap font_map, const GlyphUpload& upload, uint8_t* temp_data)
+    {
+        const uint8_t* data = upload.m_Data;
+        if (!data)
+        {
+            return;
+        }
 
-        void* data = 0;
-        if (FONT_GLYPH_COMPRESSION_DEFLATE == glyph_data_compression)
+        if (FONT_GLYPH_COMPRESSION_DEFLATE == upload.m_Compression)
         {
             // When if came to choosing between the different algorithms, here are some speed/compression tests
             // Decoding 100 glyphs
@@ -738,30 +992,134 @@ namespace dmRender
             // deflate+delta 0.7680 ms  compression: 62%
 
             FontGlyphInflaterContext deflate_context;
-            deflate_context.m_Output = font_map->m_CellTempData;
+            deflate_context.m_Output = temp_data;
             deflate_context.m_Cursor = 0;
-            dmZlib::Result zlib_result = dmZlib::InflateBuffer(glyph_data, glyph_data_size, &deflate_context, FontGlyphInflater);
+            dmZlib::Result zlib_result = dmZlib::InflateBuffer(data, upload.m_DataSize, &deflate_context, FontGlyphInflater);
             if (zlib_result != dmZlib::RESULT_OK)
             {
-                dmLogError("Failed to decompress glyph (%c) in font %s: %d", g->m_Character, dmHashReverseSafe64(font_map->m_NameHash), zlib_result);
+                dmLogError("Failed to decompress glyph (%c) in font %s: %d", upload.m_Character, dmHashReverseSafe64(font_map->m_NameHash), zlib_result);
                 return;
             }
 
             uint32_t uncompressed_size = deflate_context.m_Cursor;
-            delta_decode(font_map->m_CellTempData, uncompressed_size);
+            delta_decode(temp_data, uncompressed_size);
 
-            data = font_map->m_CellTempData;
+            data = temp_data;
         }
-        else if (FONT_GLYPH_COMPRESSION_NONE == glyph_data_compression)
+        else if (FONT_GLYPH_COMPRESSION_NONE != upload.m_Compression)
         {
-            data = glyph_data;
+            dmLogOnceError("Unknown glyph compression: %u for glyph (%c) in font %s", upload.m_Compression, upload.m_Character, dmHashReverseSafe64(font_map->m_NameHash));
+            return;
         }
-        else
+
+        uint32_t channels = font_map->m_CacheChannels;
+        uint32_t row_size = font_map->m_CacheWidth * channels;
+        uint32_t x = upload.m_X;
+        uint32_t y = upload.m_Y;
+
+        // Clear the previous glyph from the cell
+        uint32_t cell_width = dmMath::Min(font_map->m_CacheCellWidth, font_map->m_CacheWidth - x);
+        uint32_t cell_height = dmMath::Min(font_map->m_CacheCellHeight, font_map->m_CacheHeight - y);
+        for (uint32_t row = 0; row < cell_height; ++row)
+        {
+            memset(font_map->m_CacheData + (y + row) * row_size + x * channels, 0, cell_width * channels);
+        }
+
+        y += upload.m_OffsetY;
+        if (y >= font_map->m_CacheHeight)
+        {
+            return;
+        }
+
+        uint32_t width = dmMath::Min((uint32_t)upload.m_Width, font_map->m_CacheWidth - x);
+        uint32_t height = dmMath::Min((uint32_t)upload.m_Height, font_map->m_CacheHeight - y);
+        for (uint32_t row = 0; row < height; ++row)
+        {
+            memcpy(font_map->m_CacheData + (y + row) * row_size + x * channels, data + row * upload.m_Width * channels, width * channels);
+        }
+    }
+
+    static void WriteGlyphsToCache(HFontMap font_map, uint32_t thread_index)
+    {
+        uint8_t* temp_data = font_map->m_CellTempData.Begin() + thread_index * GetCellTempDataSize(font_map);
+        const GlyphUpload* uploads = font_map->m_GlyphUploads.Begin();
+        uint32_t upload_count = font_map->m_GlyphUploads.Size();
+        while (true)
+        {
+            uint32_t i = (uint32_t) dmAtomicIncrement32(&font_map->m_GlyphUploadNextItem);
+            if (i >= upload_count)
+                break;
+            WriteGlyphToCache(font_map, uploads[i], temp_data);
+        }
+    }
+
+    static int GlyphUploadJobProcess(void* context, void* data)
+    {
+        DM_PROFILE("GlyphUploadJob");
+        WriteGlyphsToCache((HFontMap) context, (uint32_t) (uintptr_t) data);
+        return 0;
+    }
+
+    // Decodes the glyphs added to the cache (on the job threads if there are many of them),
+    // and uploads the rows of the cache texture they're in, with a single texture update
+    static void FlushGlyphUploads(HRenderContext render_context, HFontMap font_map)
+    {
+        uint32_t upload_count = font_map->m_GlyphUploads.Size();
+        if (upload_count == 0)
+        {
+            return;
+        }
+
+        DM_PROFILE("FlushGlyphUploads");
+
+        uint32_t job_count = 0;
+        if (render_context->m_JobThread && upload_count >= GLYPH_UPLOAD_JOB_MIN_GLYPHS * 2)
+        {
+            job_count = dmMath::Min(dmJobThread::GetWorkerCount(render_context->m_JobThread), upload_count / GLYPH_UPLOAD_JOB_MIN_GLYPHS - 1);
+        }
+
+        uint32_t temp_data_size = GetCellTempDataSize(font_map) * (job_count + 1);
+        if (font_map->m_CellTempData.Capacity() < temp_data_size)
+        {
+            font_map->m_CellTempData.SetCapacity(temp_data_size);
+        }
+        font_map->m_CellTempData.SetSize(temp_data_size);
+
+        // The jobs and the calling thread pick glyphs until there are none left
+        dmAtomicStore32(&font_map->m_GlyphUploadNextItem, 0);
+        dmJobThread::JobGroup group;
+        dmJobThread::InitGroup(&group, 0);
+        for (uint32_t i = 0; i < job_count; ++i)
+        {
+            dmJobThread::PushGroupJob(render_context->m_JobThread, &group, GlyphUploadJobProcess, (void*) font_map, (void*) (uintptr_t) (i + 1));
+        }
+
+        WriteGlyphsToCache(font_map, 0);
+
+        if (job_count > 0)
+        {
+            DM_PROFILE("WaitGlyphUploadJobs");
+            dmJobThread::WaitGroup(render_context->m_JobThread, &group);
+        }
+
+        uint32_t min_y = font_map->m_CacheHeight;
+        uint32_t max_y = 0;
+        for (uint32_t i = 0; i < upload_count; ++i)
+        {
+            const GlyphUpload& upload = font_map->m_GlyphUploads[i];
+            min_y = dmMath::Min(min_y, (uint32_t) upload.m_Y);
+            max_y = dmMath::Max(max_y, dmMath::Min((uint32_t) upload.m_Y + font_map->m_CacheCellHeight, font_map->m_CacheHeight));
+        }
+        font_map->m_GlyphUploads.SetSize(0);
+
+        if (min_y >= max_y)
         {
-            dmLogOnceError("Unknown glyph compression: %u for glyph (%c) in font %s", glyph_data_compression, g->m_Character, dmHashReverseSafe64(font_map->m_NameHash));
             return;
         }
 
+        // Full rows, so that the data is contiguous
+        uint32_t row_size = font_map->m_CacheWidth * font_map->m_CacheChannels;
+
         dmGraphics::TextureParams tex_params;
         tex_params.m_SubUpdate = true;
         tex_params.m_MipMap = 0;
@@ -769,51 +1127,144 @@ namespace dmRender
         tex_params.m_MinFilter = font_map->m_MinFilter;
         tex_params.m_MagFilter = font_map->m_MagFilter;
 
-        tex_params.m_Width = glyph_image_width;
-        tex_params.m_Height = glyph_image_height;
+        tex_params.m_Width = font_map->m_CacheWidth;
+        tex_params.m_Height = max_y - min_y;
 
-        tex_params.m_X = x;
-        tex_params.m_Y = y + offset_y;
+        tex_params.m_X = 0;
+        tex_params.m_Y = min_y;
 
-        tex_params.m_Data = data;
+        tex_params.m_Data = font_map->m_CacheData + min_y * row_size;
+        tex_params.m_DataSize = tex_params.m_Height * row_size;
 
         // Upload glyph data to GPU
         dmGraphics::SetTexture(font_map->m_Texture, tex_params);
     }
 
+    // Doubles the height of the cache texture (up to the max height), and adds the new rows as free cells.
+    // The glyphs already in the cache keep their cells, so only the texture coordinates change
+    static void GrowCache(HFontMap font_map)
+    {
+        uint32_t old_height = font_map->m_CacheHeight;
+        uint32_t height = dmMath::Min(old_height * 2, font_map->m_CacheMaxHeight);
+        uint32_t rows = dmMath::Min(height / font_map->m_CacheCellHeight, GLYPH_CACHE_MAX_CELL_COUNT / dmMath::Max(font_map->m_CacheColumns, 1u));
+        uint32_t old_cell_count = font_map->m_CacheCellCount;
+        uint32_t cell_count = font_map->m_CacheColumns * rows;
+        if (cell_count <= old_cell_count)
+        {
+            font_map->m_CacheMaxHeight = old_height;
+            return;
+        }
+
+        DM_PROFILE("GrowGlyphCache");
+
+        // The uploads are flushed at the end of each batch, so the texture copy is up to date
+        assert(font_map->m_GlyphUploads.Empty());
+
+        uint32_t row_size = font_map->m_CacheWidth * font_map->m_CacheChannels;
+        font_map->m_CacheData = (uint8_t*)realloc(font_map->m_CacheData, row_size * height);
+        memset(font_map->m_CacheData + row_size * old_height, 0, row_size * (height - old_height));
+
+        font_map->m_Cache = (CacheGlyph*)realloc(font_map->m_Cache, sizeof(CacheGlyph) * cell_count);
+        font_map->m_CacheIndices = (uint16_t*)realloc(font_map->m_CacheIndices, sizeof(uint16_t) * cell_count);
+        font_map->m_CacheHeight = height;
+        font_map->m_CacheRows = rows;
+        font_map->m_CacheCellCount = cell_count;
+        InitCacheCells(font_map, old_cell_count, cell_count);
+
+        // The cells may have moved
+        font_map->m_GlyphCache.Clear();
+        if (font_map->m_GlyphCache.Capacity() < cell_count)
+        {
+            font_map->m_GlyphCache.SetCapacity((cell_count*3)/2, cell_count);
+        }
+        for (uint32_t i = 0; i < font_map->m_CacheCursor; ++i)
+        {
+            CacheGlyph* cache_glyph = &font_map->m_Cache[font_map->m_CacheIndices[i]];
+            if (cache_glyph->m_Glyph)
+            {
+                font_map->m_GlyphCache.Put(cache_glyph->m_Glyph->m_Character, cache_glyph);
+            }
+        }
+
+        dmGraphics::TextureParams tex_params;
+        tex_params.m_Format = font_map->m_CacheFormat;
+        tex_params.m_MinFilter = font_map->m_MinFilter;
+        tex_params.m_MagFilter = font_map->m_MagFilter;
+        tex_params.m_Width = font_map->m_CacheWidth;
+        tex_params.m_Height = height;
+        tex_params.m_Data = font_map->m_CacheData;
+        tex_params.m_DataSize = row_size * height;
+        dmGraphics::SetTexture(font_map->m_Texture, tex_params);
+
+        dmLogDebug("Font glyph cache for %s grew from %u to %u texels high", dmHashReverseSafe64(font_map->m_NameHash), old_height, height);
+    }
+
     static void AddGlyphToCache(HFontMap font_map, uint32_t frame, dmRender::FontGlyph* g, int32_t g_offset_y)
     {
+        // The glyph data is looked up in the font map, and written to the cache it uses
+        FontMap* cache = font_map->m_CacheFontMap;
+
         // Locate a cache cell candidate
-        CacheGlyph* cache_glyph = AcquireFreeGlyphFromCache(font_map, g->m_Character, frame);
+        CacheGlyph* cache_glyph = AcquireFreeGlyphFromCache(cache, g->m_Character, frame);
+
+        // Replacing a glyph that is still in use means the cache is too small, and the glyphs will
+        // keep replacing each other. We then grow the cache, before the font map is rendered the next frame
+        if (cache_glyph->m_Glyph && frame - cache_glyph->m_Frame <= 1)
+        {
+            cache->m_CacheGrowRequested = cache->m_CacheHeight < cache->m_CacheMaxHeight;
+        }
 
         if (cache_glyph->m_Glyph && cache_glyph->m_Frame == frame)
         {
             // It means we've filled the entire cache with upload requests
             // We might then just as well skip the next uploads until the next frame
-            dmLogWarning("Entire font glyph cache (%u x %u) is filled in a single frame %u ('%c' %u). Consider increasing the cache for %s", font_map->m_CacheWidth, font_map->m_CacheHeight, frame, g->m_Character < 255 ? g->m_Character : ' ', g->m_Character, dmHashReverseSafe64(font_map->m_NameHash));
+            if (!cache->m_CacheGrowRequested)
+            {
+                dmLogWarning("Entire font glyph cache (%u x %u) is filled in a single frame %u ('%c' %u). Consider increasing the cache for %s", cache->m_CacheWidth, cache->m_CacheHeight, frame, g->m_Character < 255 ? g->m_Character : ' ', g->m_Character, dmHashReverseSafe64(cache->m_NameHash));
+            }
             return;
         }
 
         if (cache_glyph->m_Glyph) // It already existed in the cache
         {
             // Clear the old data from the cache
-            font_map->m_GlyphCache.Erase(cache_glyph->m_Glyph->m_Character);
+            cache->m_GlyphCache.Erase(cache_glyph->m_Glyph->m_Character);
         }
         cache_glyph->m_Glyph = g;
 
-        font_map->m_GlyphCache.Put(g->m_Character, cache_glyph);
+        cache->m_GlyphCache.Put(g->m_Character, cache_glyph);
 
         // Sort the glyphs, so that if we need to add another one, the oldest is at the end, for fast access
         cache_glyph->m_Frame = frame;
-        SortCache(font_map);
-
-        //DebugCache(font_map);
-
-        UpdateGlyphTexture(font_map, g, cache_glyph->m_X, cache_glyph->m_Y, g_offset_y);
+        SortCache(cache);
+
+        //DebugCache(cache);
+
+        // The glyph is written to the texture when the batch is done
+        GlyphUpload upload;
+        upload.m_DataSize = 0;
+        upload.m_Compression = FONT_GLYPH_COMPRESSION_NONE;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        upload.m_Data = (const uint8_t*)font_map->m_GetGlyphData(g->m_Character, font_map->m_UserData, &upload.m_DataSize, &upload.m_Compression, &width, &height);
+        upload.m_Character = g->m_Character;
+        upload.m_Width = (uint16_t)width;
+        upload.m_Height = (uint16_t)height;
+        upload.m_X = cache_glyph->m_X;
+        upload.m_Y = cache_glyph->m_Y;
+        upload.m_OffsetY = g_offset_y;
+
+        if (cache->m_GlyphUploads.Full())
+        {
+            cache->m_GlyphUploads.OffsetCapacity(dmMath::Max(16U, cache->m_GlyphUploads.Capacity() / 2));
+        }
+        cache->m_GlyphUploads.Push(upload);
     }
 
     static int CreateFontVertexDataInternal(TextContext& text_context, HFontMap font_map, const char* text, const TextEntry& te, float recip_w, float recip_h, GlyphVertex* vertices, uint32_t num_vertices)
     {
+        FontMap* cache = font_map->m_CacheFontMap;
+
         float width = te.m_Width;
         if (!te.m_LineBreak) {
             width = FLT_MAX;
@@ -831,9 +1282,8 @@ namespace dmRender
         // layout is calculated (https://github.com/defold/defold/issues/5911)
         bool measure_trailing_space = !te.m_LineBreak;
 
-        LayoutMetrics lm(font_map, tracking);
         float layout_width;
-        int line_count = Layout(text, width, lines, max_lines, &layout_width, lm, measure_trailing_space);
+        int line_count = LayoutCached(font_map, text, width, tracking, measure_trailing_space, lines, max_lines, &layout_width);
         float x_offset = OffsetX(te.m_Align, te.m_Width);
         if (font_map->m_IsMonospaced)
         {
@@ -908,17 +1358,18 @@ namespace dmRender
 
                     if (g->m_Width > 0)
                     {
-                        int16_t px_cell_offset_y = font_map->m_CacheCellMaxAscent - (int16_t)g->m_Ascent;
+                        int16_t px_cell_offset_y = cache->m_CacheCellMaxAscent - (int16_t)g->m_Ascent;
 
                         // Prepare the cache here aswell since we only count glyphs we definitely will render.
-                        if (!IsInCache(font_map, c))
+                        if (!IsInCache(cache, c))
                         {
                             AddGlyphToCache(font_map, text_context.m_Frame, g, px_cell_offset_y);
                         }
 
-                        CacheGlyph* cache_glyph = GetFromCache(font_map, c);
+                        CacheGlyph* cache_glyph = GetFromCache(cache, c);
                         if (cache_glyph)
                         {
+                            cache_glyph->m_Frame = text_context.m_Frame;
                             valid_glyph_count++;
 
                             vertexindex += vertices_per_quad;
@@ -968,16 +1419,17 @@ namespace dmRender
                     int16_t left_bearing = (int16_t) glyph->m_LeftBearing;
 
                     // Calculate y-offset in cache-cell space by moving glyphs down to baseline
-                    int16_t px_cell_offset_y = font_map->m_CacheCellMaxAscent - ascent;
+                    int16_t px_cell_offset_y = cache->m_CacheCellMaxAscent - ascent;
 
-                    if (!IsInCache(font_map, c))
+                    if (!IsInCache(cache, c))
                     {
                         AddGlyphToCache(font_map, text_context.m_Frame, glyph, px_cell_offset_y);
                     }
 
-                    CacheGlyph* cache_glyph = GetFromCache(font_map, c);
+                    CacheGlyph* cache_glyph = GetFromCache(cache, c);
                     if (cache_glyph)
                     {
+                        cache_glyph->m_Frame = text_context.m_Frame; // Glyphs in use are replaced last
                         uint32_t face_index = vertexindex + vertices_per_quad * valid_glyph_count * (layer_count-1);
                         uint32_t tx = cache_glyph->m_X;
                         uint32_t ty = cache_glyph->m_Y;
@@ -995,17 +1447,17 @@ namespace dmRender
                         (Vector4&) v3_layer_face.m_Position = te.m_Transform * Vector4(x + left_bearing + width, y - descent, 0, 1);
                         (Vector4&) v6_layer_face.m_Position = te.m_Transform * Vector4(x + left_bearing + width, y + ascent, 0, 1);
 
-                        v1_layer_face.m_UV[0] = (tx + font_map->m_CacheCellPadding) * recip_w;
-                        v1_layer_face.m_UV[1] = (ty + font_map->m_CacheCellPadding + ascent + descent + px_cell_offset_y) * recip_h;
+                        v1_layer_face.m_UV[0] = (tx + cache->m_CacheCellPadding) * recip_w;
+                        v1_layer_face.m_UV[1] = (ty + cache->m_CacheCellPadding + ascent + descent + px_cell_offset_y) * recip_h;
 
-                        v2_layer_face.m_UV[0] = (tx + font_map->m_CacheCellPadding) * recip_w;
-                        v2_layer_face.m_UV[1] = (ty + font_map->m_CacheCellPadding + px_cell_offset_y) * recip_h;
+                        v2_layer_face.m_UV[0] = (tx + cache->m_CacheCellPadding) * recip_w;
+                        v2_layer_face.m_UV[1] = (ty + cache->m_CacheCellPadding + px_cell_offset_y) * recip_h;
 
-                        v3_layer_face.m_UV[0] = (tx + font_map->m_CacheCellPadding + width) * recip_w;
-                        v3_layer_face.m_UV[1] = (ty + font_map->m_CacheCellPadding + ascent + descent + px_cell_offset_y) * recip_h;
+                        v3_layer_face.m_UV[0] = (tx + cache->m_CacheCellPadding + width) * recip_w;
+                        v3_layer_face.m_UV[1] = (ty + cache->m_CacheCellPadding + ascent + descent + px_cell_offset_y) * recip_h;
 
-                        v6_layer_face.m_UV[0] = (tx + font_map->m_CacheCellPadding + width) * recip_w;
-                        v6_layer_face.m_UV[1] = (ty + font_map->m_CacheCellPadding + px_cell_offset_y) * recip_h;
+                        v6_layer_face.m_UV[0] = (tx + cache->m_CacheCellPadding + width) * recip_w;
+                        v6_layer_face.m_UV[1] = (ty + cache->m_CacheCellPadding + px_cell_offset_y) * recip_h;
 
                         #define SET_VERTEX_FONT_PROPERTIES(v) \
                             v.m_FaceColor[0]    = face_color[0]; \
@@ -1133,30 +1585,56 @@ namespace dmRender
         return vertexindex * layer_count;
     }
 
-    static void CreateFontRenderBatch(HRenderContext render_context, dmRender::RenderListEntry *buf, uint32_t* begin, uint32_t* end)
+    // Returns the texture_size_recip constant of the batch: (1/width, 1/height, cell width ratio, cell height ratio)
+    static void PrepareBatch(TextContext& text_context, HFontMap font_map, Vector4* texture_size_recip)
     {
-        DM_PROFILE("FontRenderBatch");
-        TextContext& text_context = render_context->m_TextContext;
+        FontMap* cache = font_map->m_CacheFontMap;
 
-        const TextEntry& first_te = *(TextEntry*) buf[*begin].m_UserData;
+        // The texture coordinates of the previous batches this frame depend on the texture size,
+        // so the cache is only grown before the font map is rendered the first time each frame
+        if (cache->m_CacheBatchFrame != text_context.m_Frame)
+        {
+            if (cache->m_CacheGrowRequested)
+            {
+                GrowCache(cache);
+                cache->m_CacheGrowRequested = 0;
+            }
+            cache->m_CacheBatchFrame = text_context.m_Frame;
+        }
 
-        HFontMap font_map = first_te.m_FontMap;
         float im_recip = 1.0f;
         float ih_recip = 1.0f;
         float cache_cell_width_ratio  = 0.0;
         float cache_cell_height_ratio = 0.0;
 
-        if (font_map->m_Texture) {
-            float cache_width  = (float) dmGraphics::GetTextureWidth(font_map->m_Texture);
-            float cache_height = (float) dmGraphics::GetTextureHeight(font_map->m_Texture);
+        if (cache->m_Texture) {
+            float cache_width  = (float) dmGraphics::GetTextureWidth(cache->m_Texture);
+            float cache_height = (float) dmGraphics::GetTextureHeight(cache->m_Texture);
 
             im_recip /= cache_width;
             ih_recip /= cache_height;
 
-            cache_cell_width_ratio  = ((float) font_map->m_CacheCellWidth) / cache_width;
-            cache_cell_height_ratio = ((float) font_map->m_CacheCellHeight) / cache_height;
+            cache_cell_width_ratio  = ((float) cache->m_CacheCellWidth) / cache_width;
+            cache_cell_height_ratio = ((float) cache->m_CacheCellHeight) / cache_height;
         }
 
+        *texture_size_recip = Vector4(im_recip, ih_recip, cache_cell_width_ratio, cache_cell_height_ratio);
+    }
+
+    static void CreateFontRenderBatch(HRenderContext render_context, dmRender::RenderListEntry *buf, uint32_t* begin, uint32_t* end)
+    {
+        DM_PROFILE("FontRenderBatch");
+        TextContext& text_context = render_context->m_TextContext;
+
+        const TextEntry& first_te = *(TextEntry*) buf[*begin].m_UserData;
+
+        HFontMap font_map = first_te.m_FontMap;
+
+        Vector4 texture_size_recip;
+        PrepareBatch(text_context, font_map, &texture_size_recip);
+        float im_recip = texture_size_recip.getX();
+        float ih_recip = texture_size_recip.getY();
+
         GlyphVertex* vertices = (GlyphVertex*)text_context.m_ClientBuffer;
 
         if (text_context.m_RenderObjectIndex >= text_context.m_RenderObjects.Size()) {
@@ -1172,12 +1650,12 @@ namespace dmRender
         ro->m_DestinationBlendFactor = first_te.m_DestinationBlendFactor;
         ro->m_SetBlendFactors = 1;
         ro->m_Material = first_te.m_Material;
-        ro->m_Textures[0] = font_map->m_Texture;
+        ro->m_Textures[0] = font_map->m_CacheFontMap->m_Texture;
         ro->m_VertexStart = text_context.m_VertexIndex;
         ro->m_StencilTestParams = first_te.m_StencilTestParams;
         ro->m_SetStencilTest = first_te.m_StencilTestParamsSet;
-
-        Vector4 texture_size_recip(im_recip, ih_recip, cache_cell_width_ratio, cache_cell_height_ratio);
+        ro->m_ScissorRect = first_te.m_ScissorRect;
+        ro->m_SetScissor = first_te.m_ScissorSet;
 
         dmRender::ClearNamedConstantBuffer(constants_buffer);
         dmRender::SetNamedConstants(constants_buffer, (HConstant*)first_te.m_RenderConstants, first_te.m_NumRenderConstants);
@@ -1185,17 +1663,20 @@ namespace dmRender
 
         ro->m_ConstantBuffer = constants_buffer;
 
+        // The texts in the batch may be in different font maps, that share the glyph cache
         for (uint32_t *i = begin;i != end; ++i)
         {
             const TextEntry& te = *(TextEntry*) buf[*i].m_UserData;
             const char* text = &text_context.m_TextBuffer[te.m_StringOffset];
 
-            int num_indices = CreateFontVertexDataInternal(text_context, font_map, text, te, im_recip, ih_recip, &vertices[text_context.m_VertexIndex], text_context.m_MaxVertexCount - text_context.m_VertexIndex);
+            int num_indices = CreateFontVertexDataInternal(text_context, te.m_FontMap, text, te, im_recip, ih_recip, &vertices[text_context.m_VertexIndex], text_context.m_MaxVertexCount - text_context.m_VertexIndex);
             text_context.m_VertexIndex += num_indices;
         }
 
         ro->m_VertexCount = text_context.m_VertexIndex - ro->m_VertexStart;
 
+        FlushGlyphUploads(render_context, font_map->m_CacheFontMap);
+
         dmRender::AddToRender(render_context, ro);
     }
 
@@ -1296,6 +1777,62 @@ namespace dmRender
         text_context.m_TextEntriesFlushed = text_context.m_TextEntries.Size();
     }
 
+    uint32_t GetTextVertexSize()
+    {
+        return sizeof(GlyphVertex);
+    }
+
+    dmGraphics::HVertexDeclaration GetTextVertexDeclaration(HRenderContext render_context)
+    {
+        return render_context->m_TextContext.m_VertexDecl;
+    }
+
+    uint32_t GetTextVertexCount(HFontMap font_map, const char* text)
+    {
+        uint32_t layer_count = 1;
+        layer_count += (font_map->m_LayerMask & OUTLINE) == OUTLINE;
+        layer_count += (font_map->m_LayerMask & SHADOW) == SHADOW;
+        return dmUtf8::StrLen(text) * 6 * layer_count;
+    }
+
+    void GetTextBoundingSphere(HFontMap font_map, const DrawTextParams& params, dmVMath::Point3* center, float* radius_sq)
+    {
+        TextEntry te;
+        InitTextEntry(font_map, 0, 0, params, &te);
+        CalcBoundingSphere(font_map, te, params.m_Text, center, radius_sq);
+    }
+
+    void BeginTextBatch(HRenderContext render_context, HFontMap font_map, HNamedConstantBuffer constants)
+    {
+        Vector4 texture_size_recip;
+        PrepareBatch(render_context->m_TextContext, font_map, &texture_size_recip);
+        dmRender::SetNamedConstant(constants, g_TextureSizeRecipHash, &texture_size_recip, 1);
+    }
+
+    uint32_t CreateTextVertexData(HRenderContext render_context, HFontMap font_map, const DrawTextParams& params, void* vertices, uint32_t max_vertices)
+    {
+        TextContext& text_context = render_context->m_TextContext;
+
+        TextEntry te;
+        InitTextEntry(font_map, 0, 0, params, &te);
+
+        // The cache was prepared in BeginTextBatch()
+        float im_recip = 1.0f;
+        float ih_recip = 1.0f;
+        dmGraphics::HTexture texture = font_map->m_CacheFontMap->m_Texture;
+        if (texture)
+        {
+            im_recip /= (float) dmGraphics::GetTextureWidth(texture);
+            ih_recip /= (float) dmGraphics::GetTextureHeight(texture);
+        }
+        return CreateFontVertexDataInternal(text_context, font_map, params.m_Text, te, im_recip, ih_recip, (GlyphVertex*) vertices, max_vertices);
+    }
+
+    void EndTextBatch(HRenderContext render_context, HFontMap font_map)
+    {
+        FlushGlyphUploads(render_context, font_map->m_CacheFontMap);
+    }
+
     static float GetLineTextMetrics(HFontMap font_map, float tracking, const char* text, int n, bool measure_trailing_space)
     {
         float width = 0;
@@ -1349,9 +1886,8 @@ namespace dmRender
         // layout is calculated (https://github.com/defold/defold/issues/5911)
         bool measure_trailing_space = !line_break;
 
-        LayoutMetrics lm(font_map, tracking * line_height);
         float layout_width;
-        uint32_t num_lines = Layout(text, width, lines, max_lines, &layout_width, lm, measure_trailing_space);
+        uint32_t num_lines = LayoutCached(font_map, text, width, tracking * line_height, measure_trailing_space, lines, max_lines, &layout_width);
         metrics->m_Width = layout_width;
         metrics->m_Height = num_lines * (line_height * leading) - line_height * (leading - 1.0f);
         metrics->m_LineCount = num_lines;
@@ -1360,6 +1896,11 @@ namespace dmRender
     uint32_t GetFontMapResourceSize(HFontMap font_map)
     {
         uint32_t size = sizeof(FontMap);
+        // A shared cache is counted by the font map that owns it
+        if (font_map->m_CacheFontMap != font_map)
+        {
+            return size;
+        }
         // The cache size
         size += font_map->m_CacheCellCount*( (sizeof(CacheGlyph) * sizeof(uint32_t)) );
         // The texture size
@@ -1370,12 +1911,12 @@ namespace dmRender
     // Test functions begin
     bool VerifyFontMapMinFilter(dmRender::HFontMap font_map, dmGraphics::TextureFilter filter)
     {
-        return font_map->m_MinFilter == filter;
+        return font_map->m_CacheFontMap->m_MinFilter == filter;
     }
 
     bool VerifyFontMapMagFilter(dmRender::HFontMap font_map, dmGraphics::TextureFilter filter)
     {
-        return font_map->m_MagFilter == filter;
+        return font_map->m_CacheFontMap->m_MagFilter == filter;
     }
 
     const uint8_t* GetGlyphData(dmRender::HFontMap font_map, uint32_t codepoint, uint32_t* out_size, uint32_t* out_compression, uint32_t* out_width, uint32_t* out_height)
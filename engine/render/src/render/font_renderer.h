@@ -89,6 +89,11 @@ namespace dmRender
         uint8_t m_Padding:7;
 
         dmRenderDDF::FontTextureFormat m_ImageFormat;
+
+        /// Font map to share the glyph cache (and cache texture) with, instead of creating one. 0 by default.
+        /// The font maps must have the same glyphs for each codepoint, e.g. by using the same glyph bank,
+        /// and the same cache cell size and glyph channels
+        HFontMap m_CacheFontMap;
     };
 
     /**
@@ -132,6 +137,26 @@ namespace dmRender
      */
     void SetFontMap(HFontMap font_map, dmGraphics::HContext graphics_context, FontMapParams& params);
 
+    /**
+     * Stop sharing the glyph cache of another font map (see FontMapParams::m_CacheFontMap), and create
+     * a cache of its own. Needed before the glyphs of the font map change.
+     * @param font_map Font map handle
+     */
+    void UnshareFontMapCache(HFontMap font_map);
+
+    /**
+     * Check if the font map shares the glyph cache of another font map
+     * @param font_map Font map handle
+     * @return true if the cache is shared
+     */
+    bool IsFontMapCacheShared(HFontMap font_map);
+
+    /**
+     * Clear the text layouts cached by the font map. Needed when the glyphs of the font change.
+     * @param font_map Font map handle
+     */
+    void ClearFontMapLayoutCache(HFontMap font_map);
+
     /**
      * Get texture from a font map
      * @param font_map Font map handle
@@ -200,8 +225,12 @@ namespace dmRender
         TextVAlign m_VAlign;
         /// Stencil parameters
         StencilTestParams m_StencilTestParams;
+        /// World space rect (min x, min y, max x, max y) to clip the text to
+        dmVMath::Vector4 m_ScissorRect;
         /// Stencil parameters set or not
         uint8_t m_StencilTestParamsSet : 1;
+        /// Scissor rect set or not
+        uint8_t m_ScissorSet : 1;
     };
 
     /**
@@ -226,6 +255,66 @@ namespace dmRender
      */
     void FlushTexts(HRenderContext render_context, uint32_t major_order, uint32_t render_order, bool final);
 
+    /**
+     * Get the size of the glyph vertices created by CreateTextVertexData()
+     * @return vertex size in bytes
+     */
+    uint32_t GetTextVertexSize();
+
+    /**
+     * Get the vertex declaration of the glyph vertices created by CreateTextVertexData()
+     * @param render_context Context to use when rendering
+     * @return vertex declaration
+     */
+    dmGraphics::HVertexDeclaration GetTextVertexDeclaration(HRenderContext render_context);
+
+    /**
+     * Get the max number of glyph vertices CreateTextVertexData() writes for a text
+     * @param font_map Font map handle
+     * @param text utf8 text
+     * @return number of vertices
+     */
+    uint32_t GetTextVertexCount(HFontMap font_map, const char* text);
+
+    /**
+     * Get the bounding sphere of a text in world space, e.g. for frustum culling
+     * @param font_map Font map handle
+     * @param params Parameters to use when rendering
+     * @param center Center of the sphere, out-value
+     * @param radius_sq Squared radius of the sphere, out-value
+     */
+    void GetTextBoundingSphere(HFontMap font_map, const DrawTextParams& params, dmVMath::Point3* center, float* radius_sq);
+
+    /**
+     * Begin a batch of texts with the same font map, which are rendered by the caller
+     * instead of with DrawText(). Must be called from a render list dispatch, and
+     * the batch must be ended with EndTextBatch() before the next font map is batched.
+     * @param render_context Context to use when rendering
+     * @param font_map Font map handle
+     * @param constants The constant buffer of the batch. The constants needed by the font material are set in it
+     */
+    void BeginTextBatch(HRenderContext render_context, HFontMap font_map, HNamedConstantBuffer constants);
+
+    /**
+     * Create the glyph vertices of a text in the current batch. The vertices are
+     * rendered as triangles, with the vertex declaration from GetTextVertexDeclaration().
+     * The render order, material and stencil params are ignored.
+     * @param render_context Context to use when rendering
+     * @param font_map Font map handle
+     * @param params Parameters to use when rendering
+     * @param vertices Buffer to write the vertices to. Must be 16 byte aligned
+     * @param max_vertices Max number of vertices to write
+     * @return number of vertices written
+     */
+    uint32_t CreateTextVertexData(HRenderContext render_context, HFontMap font_map, const DrawTextParams& params, void* vertices, uint32_t max_vertices);
+
+    /**
+     * End a batch of texts, and upload the new glyphs to the font map texture
+     * @param render_context Context to use when rendering
+     * @param font_map Font map handle
+     */
+    void EndTextBatch(HRenderContext render_context, HFontMap font_map);
+
     /**
      * Get text metrics for string
      * @param font_map Font map handle
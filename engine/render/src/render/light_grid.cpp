@@ -0,0 +1,422 @@
+// Copyright 2020-2024 The Defold Foundation
+// Copyright 2014-2020 King
+// Copyright 2009-2014 Ragnar Svensson, Christian Murray
+// Licensed under the Defold License version 1.0 (the "License"); you may not use
+// this file except in compliance with the License.
+//
+// You may obtain a copy of the License, together with FAQs at
+// https://www.defold.com/license
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include <math.h>
+#include <string.h>
+#include <dlib/log.h>
+#include <dlib/math.h>
+#include <dlib/profile.h>
+#include "render_private.h"
+
+namespace dmRender
+{
+    using namespace dmVMath;
+
+    // The light grid is stored in RGBA32F textures, to be read with texelFetch (or nearest filtering):
+    //
+    //   light_grid_clusters  LIGHT_GRID_SIZE_X * LIGHT_GRID_SIZE_Y texels wide, LIGHT_GRID_SIZE_Z texels high.
+    //                        Texel (y * LIGHT_GRID_SIZE_X + x, z) is (offset, count, 0, 0) of the cluster in the index list
+    //   light_grid_indices   INDEX_TEXTURE_WIDTH texels wide, with four light indices per texel
+    //   light_grid_lights    LIGHT_TEXEL_COUNT texels wide. The first row is a header, and then one row per light:
+    //                        header: (size x, size y, size z, light count), (near, far, exponential, 0), (0, 0, 0, 0)
+    //                        light:  (position, range), (color), (direction, cone angle)
+    //
+    // The x and y of the cluster of a fragment is its tile in the viewport (with y up), and z its depth slice:
+    //   exponential: z = floor(log(depth / near) / log(far / near) * size z)
+    //   linear:      z = floor((depth - near) / (far - near) * size z)
+    // where depth is the view space distance in front of the camera.
+
+    static const uint32_t INDEX_TEXTURE_WIDTH = 1024;
+    static const uint32_t LIGHT_TEXEL_COUNT   = 3;
+
+    static const dmhash_t LIGHT_GRID_CLUSTERS = dmHashString64("light_grid_clusters");
+    static const dmhash_t LIGHT_GRID_INDICES  = dmHashString64("light_grid_indices");
+    static const dmhash_t LIGHT_GRID_LIGHTS   = dmHashString64("light_grid_lights");
+
+    void InitializeLightGrid(HRenderContext render_context)
+    {
+        LightGrid& grid = render_context->m_LightGrid;
+        memset(grid.m_Clusters, 0, sizeof(grid.m_Clusters));
+        memset(grid.m_SliceDepth, 0, sizeof(grid.m_SliceDepth));
+        grid.m_View           = Matrix4::identity();
+        grid.m_Projection     = Matrix4::identity();
+        grid.m_ClusterTexture = 0;
+        grid.m_IndexTexture   = 0;
+        grid.m_LightTexture   = 0;
+        grid.m_NextSlice      = 0;
+        grid.m_Exponential    = 0;
+        grid.m_Dirty          = 1;
+        grid.m_Bound          = 0;
+    }
+
+    void FinalizeLightGrid(HRenderContext render_context)
+    {
+        LightGrid& grid = render_context->m_LightGrid;
+        if (grid.m_ClusterTexture)
+        {
+            dmGraphics::DeleteTexture(grid.m_ClusterTexture);
+            dmGraphics::DeleteTexture(grid.m_IndexTexture);
+            dmGraphics::DeleteTexture(grid.m_LightTexture);
+        }
+    }
+
+    void AddLight(HRenderContext render_context, const LightGridLight& light)
+    {
+        LightGrid& grid = render_context->m_LightGrid;
+        if (grid.m_Lights.Size() == LIGHT_GRID_MAX_LIGHTS)
+        {
+            dmLogOnceWarning("The light grid is full (%u lights), the rest of the lights are ignored", LIGHT_GRID_MAX_LIGHTS);
+            return;
+        }
+
+        if (grid.m_Lights.Full())
+        {
+            grid.m_Lights.OffsetCapacity(64);
+        }
+        grid.m_Lights.Push(light);
+        grid.m_Dirty = 1;
+    }
+
+    void ClearLights(HRenderContext render_context)
+    {
+        LightGrid& grid = render_context->m_LightGrid;
+        if (!grid.m_Lights.Empty())
+        {
+            grid.m_Lights.SetSize(0);
+            grid.m_Dirty = 1;
+        }
+    }
+
+    uint32_t GetLightCount(HRenderContext render_context)
+    {
+        return render_context->m_LightGrid.m_Lights.Size();
+    }
+
+    static inline Point3 Unproject(const Matrix4& inv_projection, float x, float y, float z)
+    {
+        Vector4 p = inv_projection * Vector4(x, y, z, 1.0f);
+        return Point3(p.getXYZ() / p.getW());
+    }
+
+    // The point of the ray from near to far, at a view space depth
+    static inline Point3 PointAtDepth(const Point3& p_near, const Point3& p_far, float depth)
+    {
+        float t = (depth + p_near.getZ()) / (p_near.getZ() - p_far.getZ());
+        return lerp(t, p_near, p_far);
+    }
+
+    // Calculates the view space bounds of the clusters, which only depend on the projection
+    static void SetupClusters(LightGrid& grid, const Matrix4& projection)
+    {
+        DM_PROFILE("SetupClusters");
+
+        Matrix4 inv_projection = inverse(projection);
+        float near_z = -Unproject(inv_projection, 0.0f, 0.0f, -1.0f).getZ();
+        float far_z  = -Unproject(inv_projection, 0.0f, 0.0f, 1.0f).getZ();
+
+        // Perspective projections get more slices close to the camera, where the clusters are smaller
+        grid.m_Exponential = projection.getElem(3, 3) == 0.0f && near_z > 0.0f && far_z > near_z;
+        for (uint32_t z = 0; z <= LIGHT_GRID_SIZE_Z; ++z)
+        {
+            float t = z / (float) LIGHT_GRID_SIZE_Z;
+            grid.m_SliceDepth[z] = grid.m_Exponential ? near_z * powf(far_z / near_z, t) : near_z + (far_z - near_z) * t;
+        }
+
+        for (uint32_t y = 0; y < LIGHT_GRID_SIZE_Y; ++y)
+        {
+            for (uint32_t x = 0; x < LIGHT_GRID_SIZE_X; ++x)
+            {
+                float x0 = -1.0f + 2.0f * x / LIGHT_GRID_SIZE_X;
+                float x1 = -1.0f + 2.0f * (x + 1) / LIGHT_GRID_SIZE_X;
+                float y0 = -1.0f + 2.0f * y / LIGHT_GRID_SIZE_Y;
+                float y1 = -1.0f + 2.0f * (y + 1) / LIGHT_GRID_SIZE_Y;
+
+                // The rays through the corners of the tile
+                Point3 corners_near[4] = { Unproject(inv_projection, x0, y0, -1.0f), Unproject(inv_projection, x1, y0, -1.0f),
+                                           Unproject(inv_projection, x0, y1, -1.0f), Unproject(inv_projection, x1, y1, -1.0f) };
+                Point3 corners_far[4]  = { Unproject(inv_projection, x0, y0, 1.0f), Unproject(inv_projection, x1, y0, 1.0f),
+                                           Unproject(inv_projection, x0, y1, 1.0f), Unproject(inv_projection, x1, y1, 1.0f) };
+
+                for (uint32_t z = 0; z < LIGHT_GRID_SIZE_Z; ++z)
+                {
+                    Point3 p = PointAtDepth(corners_near[0], corners_far[0], grid.m_SliceDepth[z]);
+                    Vector3 min(p);
+                    Vector3 max(p);
+                    for (uint32_t c = 0; c < 4; ++c)
+                    {
+                        for (uint32_t d = 0; d < 2; ++d)
+                        {
+                            p = PointAtDepth(corners_near[c], corners_far[c], grid.m_SliceDepth[z + d]);
+                            min = minPerElem(min, Vector3(p));
+                            max = maxPerElem(max, Vector3(p));
+                        }
+                    }
+
+                    LightGridCluster& cluster = grid.m_Clusters[(z * LIGHT_GRID_SIZE_Y + y) * LIGHT_GRID_SIZE_X + x];
+                    cluster.m_Min = min;
+                    cluster.m_Max = max;
+                }
+            }
+        }
+    }
+
+    static void CullSlice(LightGrid& grid, uint32_t z)
+    {
+        // The lights within the depth range of the slice
+        uint16_t candidates[LIGHT_GRID_MAX_LIGHTS];
+        uint32_t candidate_count = 0;
+        float slice_near = grid.m_SliceDepth[z];
+        float slice_far = grid.m_SliceDepth[z + 1];
+        const Vector4* lights = grid.m_ViewLights.Begin();
+        uint32_t light_count = grid.m_ViewLights.Size();
+        for (uint32_t i = 0; i < light_count; ++i)
+        {
+            float depth = -lights[i].getZ();
+            float range = lights[i].getW();
+            if (depth + range >= slice_near && depth - range <= slice_far)
+            {
+                candidates[candidate_count++] = (uint16_t) i;
+            }
+        }
+
+        dmArray<uint16_t>& indices = grid.m_SliceIndices[z];
+        indices.SetSize(0);
+
+        LightGridCluster* clusters = &grid.m_Clusters[z * LIGHT_GRID_SIZE_X * LIGHT_GRID_SIZE_Y];
+        for (uint32_t c = 0; c < LIGHT_GRID_SIZE_X * LIGHT_GRID_SIZE_Y; ++c)
+        {
+            LightGridCluster& cluster = clusters[c];
+            cluster.m_Offset = indices.Size();
+            for (uint32_t i = 0; i < candidate_count; ++i)
+            {
+                const Vector4& light = lights[candidates[i]];
+                Vector3 center = light.getXYZ();
+                Vector3 closest = minPerElem(maxPerElem(center, cluster.m_Min), cluster.m_Max);
+                float range = light.getW();
+                if (lengthSqr(center - closest) <= range * range)
+                {
+                    if (indices.Full())
+                    {
+                        indices.OffsetCapacity(dmMath::Max(64U, indices.Capacity() / 2));
+                    }
+                    indices.Push(candidates[i]);
+                }
+            }
+            cluster.m_Count = indices.Size() - cluster.m_Offset;
+        }
+    }
+
+    static void CullSlices(LightGrid& grid)
+    {
+        while (true)
+        {
+            uint32_t z = (uint32_t) dmAtomicIncrement32(&grid.m_NextSlice);
+            if (z >= LIGHT_GRID_SIZE_Z)
+                break;
+            CullSlice(grid, z);
+        }
+    }
+
+    static int LightGridJobProcess(void* context, void* data)
+    {
+        DM_PROFILE("LightGridJob");
+        CullSlices(*(LightGrid*) context);
+        return 0;
+    }
+
+    static void SetTextureData(dmGraphics::HContext graphics_context, dmGraphics::HTexture* texture, uint32_t width, uint32_t height, const float* data)
+    {
+        if (*texture == 0)
+        {
+            dmGraphics::TextureCreationParams tex_create_params;
+            tex_create_params.m_Width = width;
+            tex_create_params.m_Height = height;
+            tex_create_params.m_OriginalWidth = width;
+            tex_create_params.m_OriginalHeight = height;
+            *texture = dmGraphics::NewTexture(graphics_context, tex_create_params);
+        }
+
+        dmGraphics::TextureParams tex_params;
+        tex_params.m_Format = dmGraphics::TEXTURE_FORMAT_RGBA32F;
+        tex_params.m_Data = data;
+        tex_params.m_DataSize = width * height * 4 * sizeof(float);
+        tex_params.m_Width = width;
+        tex_params.m_Height = height;
+        tex_params.m_MinFilter = dmGraphics::TEXTURE_FILTER_NEAREST;
+        tex_params.m_MagFilter = dmGraphics::TEXTURE_FILTER_NEAREST;
+        dmGraphics::SetTexture(*texture, tex_params);
+    }
+
+    static float* GetTextureData(LightGrid& grid, uint32_t texel_count)
+    {
+        uint32_t size = texel_count * 4;
+        if (grid.m_TextureData.Capacity() < size)
+        {
+            grid.m_TextureData.SetCapacity(size);
+        }
+        grid.m_TextureData.SetSize(size);
+        memset(grid.m_TextureData.Begin(), 0, size * sizeof(float));
+        return grid.m_TextureData.Begin();
+    }
+
+    static void UploadLightGrid(HRenderContext render_context)
+    {
+        DM_PROFILE("UploadLightGrid");
+
+        LightGrid& grid = render_context->m_LightGrid;
+        dmGraphics::HContext graphics_context = render_context->m_GraphicsContext;
+
+        // The index lists of the slices are packed one after the other
+        uint32_t slice_offsets[LIGHT_GRID_SIZE_Z];
+        uint32_t index_count = 0;
+        for (uint32_t z = 0; z < LIGHT_GRID_SIZE_Z; ++z)
+        {
+            slice_offsets[z] = index_count;
+            index_count += grid.m_SliceIndices[z].Size();
+        }
+
+        float* data = GetTextureData(grid, LIGHT_GRID_CLUSTER_COUNT);
+        for (uint32_t i = 0; i < LIGHT_GRID_CLUSTER_COUNT; ++i)
+        {
+            const LightGridCluster& cluster = grid.m_Clusters[i];
+            data[i * 4 + 0] = (float) (slice_offsets[i / (LIGHT_GRID_SIZE_X * LIGHT_GRID_SIZE_Y)] + cluster.m_Offset);
+            data[i * 4 + 1] = (float) cluster.m_Count;
+        }
+        SetTextureData(graphics_context, &grid.m_ClusterTexture, LIGHT_GRID_SIZE_X * LIGHT_GRID_SIZE_Y, LIGHT_GRID_SIZE_Z, data);
+
+        uint32_t index_texel_count = dmMath::Max(1U, (index_count + 3) / 4);
+        uint32_t index_height = (index_texel_count + INDEX_TEXTURE_WIDTH - 1) / INDEX_TEXTURE_WIDTH;
+        data = GetTextureData(grid, INDEX_TEXTURE_WIDTH * index_height);
+        for (uint32_t z = 0; z < LIGHT_GRID_SIZE_Z; ++z)
+        {
+            const dmArray<uint16_t>& indices = grid.m_SliceIndices[z];
+            float* slice_data = data + slice_offsets[z];
+            for (uint32_t i = 0; i < indices.Size(); ++i)
+            {
+                slice_data[i] = (float) indices[i];
+            }
+        }
+        SetTextureData(graphics_context, &grid.m_IndexTexture, INDEX_TEXTURE_WIDTH, index_height, data);
+
+        uint32_t light_count = grid.m_Lights.Size();
+        data = GetTextureData(grid, LIGHT_TEXEL_COUNT * (light_count + 1));
+        data[0] = (float) LIGHT_GRID_SIZE_X;
+        data[1] = (float) LIGHT_GRID_SIZE_Y;
+        data[2] = (float) LIGHT_GRID_SIZE_Z;
+        data[3] = (float) light_count;
+        data[4] = grid.m_SliceDepth[0];
+        data[5] = grid.m_SliceDepth[LIGHT_GRID_SIZE_Z];
+        data[6] = grid.m_Exponential ? 1.0f : 0.0f;
+        for (uint32_t i = 0; i < light_count; ++i)
+        {
+            const LightGridLight& light = grid.m_Lights[i];
+            float* texels = data + (i + 1) * LIGHT_TEXEL_COUNT * 4;
+            texels[0]  = light.m_Position.getX();
+            texels[1]  = light.m_Position.getY();
+            texels[2]  = light.m_Position.getZ();
+            texels[3]  = light.m_Range;
+            texels[4]  = light.m_Color.getX();
+            texels[5]  = light.m_Color.getY();
+            texels[6]  = light.m_Color.getZ();
+            texels[7]  = light.m_Color.getW();
+            texels[8]  = light.m_Direction.getX();
+            texels[9]  = light.m_Direction.getY();
+            texels[10] = light.m_Direction.getZ();
+            texels[11] = light.m_ConeAngle;
+        }
+        SetTextureData(graphics_context, &grid.m_LightTexture, LIGHT_TEXEL_COUNT, light_count + 1, data);
+    }
+
+    static void BindLightGrid(HRenderContext render_context, bool bind)
+    {
+        LightGrid& grid = render_context->m_LightGrid;
+        if (grid.m_Bound == bind)
+            return;
+        SetTextureBindingByHash(render_context, LIGHT_GRID_CLUSTERS, bind ? grid.m_ClusterTexture : 0);
+        SetTextureBindingByHash(render_context, LIGHT_GRID_INDICES, bind ? grid.m_IndexTexture : 0);
+        SetTextureBindingByHash(render_context, LIGHT_GRID_LIGHTS, bind ? grid.m_LightTexture : 0);
+        grid.m_Bound = bind;
+    }
+
+    void UpdateLightGrid(HRenderContext render_context)
+    {
+        LightGrid& grid = render_context->m_LightGrid;
+        if (grid.m_Lights.Empty())
+        {
+            BindLightGrid(render_context, false);
+            return;
+        }
+
+        bool projection_changed = memcmp(&grid.m_Projection, &render_context->m_Projection, sizeof(Matrix4)) != 0;
+        bool view_changed = memcmp(&grid.m_View, &render_context->m_View, sizeof(Matrix4)) != 0;
+        if (!grid.m_Dirty && !projection_changed && !view_changed && grid.m_Bound)
+            return;
+
+        if (!dmGraphics::IsTextureFormatSupported(render_context->m_GraphicsContext, dmGraphics::TEXTURE_FORMAT_RGBA32F))
+        {
+            dmLogOnceWarning("The light grid needs float textures, which aren't supported");
+            return;
+        }
+
+        DM_PROFILE("UpdateLightGrid");
+
+        if (projection_changed || grid.m_ClusterTexture == 0)
+        {
+            SetupClusters(grid, render_context->m_Projection);
+        }
+        grid.m_View = render_context->m_View;
+        grid.m_Projection = render_context->m_Projection;
+        grid.m_Dirty = 0;
+
+        uint32_t light_count = grid.m_Lights.Size();
+        if (grid.m_ViewLights.Capacity() < light_count)
+        {
+            grid.m_ViewLights.SetCapacity(light_count);
+        }
+        grid.m_ViewLights.SetSize(light_count);
+        for (uint32_t i = 0; i < light_count; ++i)
+        {
+            const LightGridLight& light = grid.m_Lights[i];
+            Vector4 position = grid.m_View * light.m_Position;
+            position.setW(light.m_Range);
+            grid.m_ViewLights[i] = position;
+        }
+
+        uint32_t job_count = 0;
+        if (render_context->m_JobThread)
+        {
+            job_count = dmMath::Min(dmJobThread::GetWorkerCount(render_context->m_JobThread), LIGHT_GRID_SIZE_Z - 1);
+        }
+
+        // The jobs and the calling thread pick slices until there are none left
+        dmAtomicStore32(&grid.m_NextSlice, 0);
+        dmJobThread::JobGroup group;
+        dmJobThread::InitGroup(&group, 0);
+        for (uint32_t i = 0; i < job_count; ++i)
+        {
+            dmJobThread::PushGroupJob(render_context->m_JobThread, &group, LightGridJobProcess, (void*) &grid, 0);
+        }
+
+        CullSlices(grid);
+
+        if (job_count > 0)
+        {
+            DM_PROFILE("WaitLightGridJobs");
+            dmJobThread::WaitGroup(render_context->m_JobThread, &group);
+        }
+
+        UploadLightGrid(render_context);
+        BindLightGrid(render_context, true);
+    }
+}
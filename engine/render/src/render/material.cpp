@@ -323,6 +323,41 @@ namespace dmRender
         }
     }
 
+    static inline bool IsObjectConstantType(dmRenderDDF::MaterialDesc::ConstantType type)
+    {
+        switch(type)
+        {
+            case dmRenderDDF::MaterialDesc::CONSTANT_TYPE_WORLD:
+            case dmRenderDDF::MaterialDesc::CONSTANT_TYPE_TEXTURE:
+            case dmRenderDDF::MaterialDesc::CONSTANT_TYPE_NORMAL:
+            case dmRenderDDF::MaterialDesc::CONSTANT_TYPE_WORLDVIEW:
+            case dmRenderDDF::MaterialDesc::CONSTANT_TYPE_WORLDVIEWPROJ:
+                return true;
+            default:break;
+        }
+        return false;
+    }
+
+    // Only applies the constants that are derived from the render object (world and texture transforms).
+    // Used when the other material constants are known to already be set in the program.
+    void ApplyMaterialObjectConstants(dmRender::HRenderContext render_context, HMaterial material, const RenderObject* ro)
+    {
+        dmGraphics::HContext graphics_context    = dmRender::GetGraphicsContext(render_context);
+        const dmArray<RenderConstant>& constants = material->m_Constants;
+        dmGraphics::HProgram program             = material->m_Program;
+        dmGraphics::ShaderDesc::Language language = dmGraphics::GetProgramLanguage(program);
+
+        uint32_t n = constants.Size();
+        for (uint32_t i = 0; i < n; ++i)
+        {
+            const HConstant constant                     = constants[i].m_Constant;
+            dmRenderDDF::MaterialDesc::ConstantType type = GetConstantType(constant);
+            if (!IsObjectConstantType(type))
+                continue;
+            SetProgramConstant(render_context, graphics_context, ro->m_WorldTransform, ro->m_TextureTransform, language, type, program, GetConstantLocation(constant), constant);
+        }
+    }
+
     dmhash_t GetMaterialSamplerNameHash(HMaterial material, uint32_t unit)
     {
         if (unit < material->m_Samplers.Size())
@@ -0,0 +1,273 @@
+// Copyright 2020-2024 The Defold Foundation
+// Copyright 2014-2020 King
+// Copyright 2009-2014 Ragnar Svensson, Christian Murray
+// Licensed under the Defold License version 1.0 (the "License"); you may not use
+// this file except in compliance with the License.
+//
+// You may obtain a copy of the License, together with FAQs at
+// https://www.defold.com/license
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include <float.h>
+#include <math.h>
+#include <dlib/math.h>
+#include <dlib/profile.h>
+#include "render_private.h"
+
+namespace dmRender
+{
+    using namespace dmVMath;
+
+    // The occlusion buffer is a depth buffer of OCCLUSION_BUFFER_WIDTH x OCCLUSION_BUFFER_HEIGHT texels over the viewport,
+    // where the occluder triangles are rasterized with the depth at the texel centers. Each level above it holds the max
+    // (farthest) depth of 2x2 texels of the level below, so that a box can be tested against a few texels only:
+    // the box is hidden if its nearest depth is behind the farthest depth of all the texels it covers.
+    //
+    // The depth is the normalized device depth, mapped to [0, 1], which is linear in screen space.
+
+    // Vertices closer than this (in clip space w) aren't projected
+    static const float MIN_W = 1e-5f;
+
+    static inline uint32_t LevelWidth(uint32_t level)
+    {
+        return dmMath::Max(1u, OCCLUSION_BUFFER_WIDTH >> level);
+    }
+
+    static inline uint32_t LevelHeight(uint32_t level)
+    {
+        return dmMath::Max(1u, OCCLUSION_BUFFER_HEIGHT >> level);
+    }
+
+    void AddOccluder(HRenderContext render_context, const Matrix4& world, const float* positions, const void* indices, uint32_t index_count, bool index_32bit)
+    {
+        OcclusionBuffer& buffer = render_context->m_OcclusionBuffer;
+        uint32_t triangle_count = index_count / 3;
+        if (triangle_count == 0 || buffer.m_TriangleCount + triangle_count > OCCLUSION_MAX_TRIANGLES)
+            return;
+
+        if (buffer.m_Occluders.Full())
+            buffer.m_Occluders.OffsetCapacity(dmMath::Max(16U, buffer.m_Occluders.Capacity() / 2));
+
+        Occluder occluder;
+        occluder.m_World      = world;
+        occluder.m_Positions  = positions;
+        occluder.m_Indices    = indices;
+        occluder.m_IndexCount = triangle_count * 3;
+        occluder.m_Index32    = index_32bit;
+        buffer.m_Occluders.Push(occluder);
+        buffer.m_TriangleCount += triangle_count;
+    }
+
+    uint32_t GetOccluderCount(HRenderContext render_context)
+    {
+        return render_context->m_OcclusionBuffer.m_Occluders.Size();
+    }
+
+    // Returns the position in texels (x, y) and depth (z) of the vertex, or false if it's too close to (or behind) the camera
+    static inline bool ProjectVertex(const Matrix4& m, const float* p, float out[3])
+    {
+        Vector4 v = m * Point3(p[0], p[1], p[2]);
+        float w = v.getW();
+        if (w < MIN_W)
+            return false;
+        float inv_w = 1.0f / w;
+        out[0] = (v.getX() * inv_w * 0.5f + 0.5f) * OCCLUSION_BUFFER_WIDTH;
+        out[1] = (v.getY() * inv_w * 0.5f + 0.5f) * OCCLUSION_BUFFER_HEIGHT;
+        out[2] = v.getZ() * inv_w * 0.5f + 0.5f;
+        return true;
+    }
+
+    static inline float EdgeFunction(const float* a, const float* b, float x, float y)
+    {
+        return (b[0] - a[0]) * (y - a[1]) - (b[1] - a[1]) * (x - a[0]);
+    }
+
+    static void RasterizeTriangle(float* depth, const float* v0, const float* v1, const float* v2)
+    {
+        float area = EdgeFunction(v0, v1, v2[0], v2[1]);
+        if (area == 0.0f)
+            return;
+        // Both windings occlude
+        if (area < 0.0f)
+        {
+            const float* t = v1; v1 = v2; v2 = t;
+            area = -area;
+        }
+
+        float min_x = dmMath::Min(v0[0], dmMath::Min(v1[0], v2[0]));
+        float max_x = dmMath::Max(v0[0], dmMath::Max(v1[0], v2[0]));
+        float min_y = dmMath::Min(v0[1], dmMath::Min(v1[1], v2[1]));
+        float max_y = dmMath::Max(v0[1], dmMath::Max(v1[1], v2[1]));
+        if (max_x < 0.0f || max_y < 0.0f || min_x >= (float) OCCLUSION_BUFFER_WIDTH || min_y >= (float) OCCLUSION_BUFFER_HEIGHT)
+            return;
+
+        int x0 = dmMath::Max(0, (int) floorf(min_x));
+        int y0 = dmMath::Max(0, (int) floorf(min_y));
+        int x1 = dmMath::Min((int) OCCLUSION_BUFFER_WIDTH - 1, (int) floorf(max_x));
+        int y1 = dmMath::Min((int) OCCLUSION_BUFFER_HEIGHT - 1, (int) floorf(max_y));
+
+        float inv_area = 1.0f / area;
+        for (int y = y0; y <= y1; ++y)
+        {
+            float py = y + 0.5f;
+            float* row = depth + y * OCCLUSION_BUFFER_WIDTH;
+            for (int x = x0; x <= x1; ++x)
+            {
+                float px = x + 0.5f;
+                float w0 = EdgeFunction(v1, v2, px, py);
+                float w1 = EdgeFunction(v2, v0, px, py);
+                float w2 = EdgeFunction(v0, v1, px, py);
+                if (w0 < 0.0f || w1 < 0.0f || w2 < 0.0f)
+                    continue;
+
+                float z = (w0 * v0[2] + w1 * v1[2] + w2 * v2[2]) * inv_area;
+                if (z < row[x])
+                    row[x] = z;
+            }
+        }
+    }
+
+    static inline uint32_t GetIndex(const Occluder& occluder, uint32_t i)
+    {
+        return occluder.m_Index32 ? ((const uint32_t*) occluder.m_Indices)[i] : ((const uint16_t*) occluder.m_Indices)[i];
+    }
+
+    static void BuildLevels(OcclusionBuffer& buffer)
+    {
+        float* depth = buffer.m_Depth.Begin();
+        for (uint32_t level = 1; level < OCCLUSION_BUFFER_LEVELS; ++level)
+        {
+            const float* src = depth + buffer.m_LevelOffset[level - 1];
+            float* dst = depth + buffer.m_LevelOffset[level];
+            uint32_t src_width  = LevelWidth(level - 1);
+            uint32_t src_height = LevelHeight(level - 1);
+            uint32_t width      = LevelWidth(level);
+            uint32_t height     = LevelHeight(level);
+            for (uint32_t y = 0; y < height; ++y)
+            {
+                uint32_t sy0 = dmMath::Min(y * 2, src_height - 1);
+                uint32_t sy1 = dmMath::Min(y * 2 + 1, src_height - 1);
+                for (uint32_t x = 0; x < width; ++x)
+                {
+                    uint32_t sx0 = dmMath::Min(x * 2, src_width - 1);
+                    uint32_t sx1 = dmMath::Min(x * 2 + 1, src_width - 1);
+                    float a = dmMath::Max(src[sy0 * src_width + sx0], src[sy0 * src_width + sx1]);
+                    float b = dmMath::Max(src[sy1 * src_width + sx0], src[sy1 * src_width + sx1]);
+                    dst[y * width + x] = dmMath::Max(a, b);
+                }
+            }
+        }
+    }
+
+    void BuildOcclusionBuffer(HRenderContext render_context, const Matrix4& view_proj)
+    {
+        OcclusionBuffer& buffer = render_context->m_OcclusionBuffer;
+        buffer.m_Valid = 0;
+        if (buffer.m_Occluders.Empty())
+            return;
+
+        DM_PROFILE("BuildOcclusionBuffer");
+
+        if (buffer.m_Depth.Empty())
+        {
+            uint32_t size = 0;
+            for (uint32_t level = 0; level < OCCLUSION_BUFFER_LEVELS; ++level)
+            {
+                buffer.m_LevelOffset[level] = size;
+                size += LevelWidth(level) * LevelHeight(level);
+            }
+            buffer.m_Depth.SetCapacity(size);
+            buffer.m_Depth.SetSize(size);
+        }
+
+        float* depth = buffer.m_Depth.Begin();
+        for (uint32_t i = 0; i < OCCLUSION_BUFFER_WIDTH * OCCLUSION_BUFFER_HEIGHT; ++i)
+        {
+            depth[i] = 1.0f;
+        }
+
+        uint32_t occluder_count = buffer.m_Occluders.Size();
+        for (uint32_t o = 0; o < occluder_count; ++o)
+        {
+            const Occluder& occluder = buffer.m_Occluders[o];
+            const Matrix4 m = view_proj * occluder.m_World;
+            for (uint32_t i = 0; i < occluder.m_IndexCount; i += 3)
+            {
+                // Triangles crossing the near plane are skipped, which only makes the culling more conservative
+                float v[3][3];
+                if (!ProjectVertex(m, occluder.m_Positions + GetIndex(occluder, i + 0) * 3, v[0]) ||
+                    !ProjectVertex(m, occluder.m_Positions + GetIndex(occluder, i + 1) * 3, v[1]) ||
+                    !ProjectVertex(m, occluder.m_Positions + GetIndex(occluder, i + 2) * 3, v[2]))
+                {
+                    continue;
+                }
+                RasterizeTriangle(depth, v[0], v[1], v[2]);
+            }
+        }
+
+        BuildLevels(buffer);
+        buffer.m_ViewProj = view_proj;
+        buffer.m_Valid = 1;
+    }
+
+    bool IsOccluded(HOcclusionBuffer buffer, const Matrix4& world, const Vector3& aabb_min, const Vector3& aabb_max)
+    {
+        const Matrix4 m = buffer->m_ViewProj * world;
+
+        float min_x = FLT_MAX;
+        float min_y = FLT_MAX;
+        float max_x = -FLT_MAX;
+        float max_y = -FLT_MAX;
+        float min_z = FLT_MAX;
+        for (uint32_t i = 0; i < 8; ++i)
+        {
+            float corner[3] = {
+                (i & 1) ? aabb_max.getX() : aabb_min.getX(),
+                (i & 2) ? aabb_max.getY() : aabb_min.getY(),
+                (i & 4) ? aabb_max.getZ() : aabb_min.getZ() };
+            float v[3];
+            if (!ProjectVertex(m, corner, v))
+                return false;
+            min_x = dmMath::Min(min_x, v[0]);
+            min_y = dmMath::Min(min_y, v[1]);
+            max_x = dmMath::Max(max_x, v[0]);
+            max_y = dmMath::Max(max_y, v[1]);
+            min_z = dmMath::Min(min_z, v[2]);
+        }
+
+        // Outside of the viewport is left to the frustum culling
+        if (max_x < 0.0f || max_y < 0.0f || min_x >= (float) OCCLUSION_BUFFER_WIDTH || min_y >= (float) OCCLUSION_BUFFER_HEIGHT)
+            return false;
+
+        uint32_t x0 = (uint32_t) dmMath::Max(0, (int) floorf(min_x));
+        uint32_t y0 = (uint32_t) dmMath::Max(0, (int) floorf(min_y));
+        uint32_t x1 = (uint32_t) dmMath::Min((int) OCCLUSION_BUFFER_WIDTH - 1, (int) floorf(max_x));
+        uint32_t y1 = (uint32_t) dmMath::Min((int) OCCLUSION_BUFFER_HEIGHT - 1, (int) floorf(max_y));
+
+        // The level where the box covers at most 2x2 texels
+        uint32_t size = dmMath::Max(x1 - x0, y1 - y0) + 1;
+        uint32_t level = 0;
+        while (level < OCCLUSION_BUFFER_LEVELS - 1 && (1u << level) < size)
+        {
+            ++level;
+        }
+
+        const float* depth = buffer->m_Depth.Begin() + buffer->m_LevelOffset[level];
+        uint32_t width = LevelWidth(level);
+        uint32_t tx1 = dmMath::Min(x1 >> level, width - 1);
+        uint32_t ty1 = dmMath::Min(y1 >> level, LevelHeight(level) - 1);
+        for (uint32_t y = y0 >> level; y <= ty1; ++y)
+        {
+            for (uint32_t x = x0 >> level; x <= tx1; ++x)
+            {
+                if (min_z <= depth[y * width + x])
+                    return false;
+            }
+        }
+        return true;
+    }
+}
@@ -15,12 +15,14 @@
 #include <assert.h>
 #include <string.h>
 #include <float.h>
+#include <math.h>
 #include <algorithm>
 
 #include <dlib/hash.h>
 #include <dlib/hashtable.h>
 #include <dlib/profile.h>
 #include <dlib/math.h>
+#include <dlib/radix_sort.h>
 #include <dmsdk/dlib/vmath.h>
 #include <dmsdk/dlib/intersection.h>
 
@@ -86,6 +88,7 @@ namespace dmRender
     , m_MaxCharacters(0)
     , m_CommandBufferSize(1024)
     , m_MaxDebugVertexCount(0)
+    , m_JobThread(0)
     {
 
     }
@@ -114,8 +117,26 @@ namespace dmRender
         context->m_View = Matrix4::identity();
         context->m_Projection = Matrix4::identity();
         context->m_ViewProj = context->m_Projection * context->m_View;
+        memset(context->m_Viewport, 0, sizeof(context->m_Viewport));
 
         context->m_ScriptContext = params.m_ScriptContext;
+        context->m_JobThread = params.m_JobThread;
+        context->m_CullingNextItem = 0;
+        context->m_FrustumHash = 0xFFFFFFFF;
+        for (uint32_t i = 0; i < SORT_BUFFER_CACHE_SIZE; ++i)
+        {
+            context->m_SortBufferCache[i].m_Key = 0;
+            context->m_SortBufferCache[i].m_Generation = 0;
+            context->m_SortBufferCache[i].m_LastUsed = 0;
+        }
+        for (uint32_t i = 0; i < VISIBILITY_CACHE_SIZE; ++i)
+        {
+            context->m_VisibilityCache[i].m_FrustumHash = 0;
+            context->m_VisibilityCache[i].m_Generation = 0;
+            context->m_VisibilityCache[i].m_LastUsed = 0;
+        }
+        context->m_SortBufferCacheTick = 0;
+        context->m_RenderListGeneration = 1;
         InitializeRenderScriptContext(context->m_RenderScriptContext, graphics_context, params.m_ScriptContext, params.m_CommandBufferSize);
         InitializeRenderScriptCameraContext(context, params.m_ScriptContext);
         context->m_ScriptWorld = dmScript::NewScriptWorld(context->m_ScriptContext);
@@ -127,6 +148,9 @@ namespace dmRender
         }
 
         InitializeTextContext(context, params.m_MaxCharacters, params.m_MaxBatches);
+        InitializeLightGrid(context);
+        context->m_OcclusionBuffer.m_TriangleCount = 0;
+        context->m_OcclusionBuffer.m_Valid = 0;
 
         context->m_OutOfResources = 0;
 
@@ -141,6 +165,11 @@ namespace dmRender
             context->m_MultiBufferingRequired = 1;
         }
 
+        context->m_BufferMappingSupported  = dmGraphics::IsContextFeatureSupported(graphics_context, dmGraphics::CONTEXT_FEATURE_BUFFER_MAPPING);
+        context->m_AutoInstancing          = dmGraphics::IsContextFeatureSupported(graphics_context, dmGraphics::CONTEXT_FEATURE_INSTANCING);
+        context->m_InstanceBuffer          = context->m_AutoInstancing ? NewBufferedRenderBuffer(context, RENDER_BUFFER_TYPE_VERTEX_BUFFER) : 0;
+        context->m_InstanceBufferDrawCount = 0;
+
         context->m_RenderListDispatch.SetCapacity(255);
 
         dmMessage::Result r = dmMessage::NewSocket(RENDER_SOCKET_NAME, &context->m_Socket);
@@ -157,6 +186,8 @@ namespace dmRender
         dmScript::DeleteScriptWorld(render_context->m_ScriptWorld);
         FinalizeDebugRenderer(render_context);
         FinalizeTextContext(render_context);
+        FinalizeLightGrid(render_context);
+        DeleteBufferedRenderBuffer(render_context, render_context->m_InstanceBuffer);
         dmMessage::DeleteSocket(render_context->m_Socket);
         delete render_context;
 
@@ -168,13 +199,23 @@ namespace dmRender
         return render_context->m_ScriptContext;
     }
 
+    static void InvalidateSortBufferCache(HRenderContext render_context)
+    {
+        // Skip 0, which marks the unused cache entries
+        if (++render_context->m_RenderListGeneration == 0)
+            render_context->m_RenderListGeneration = 1;
+    }
+
     void RenderListBegin(HRenderContext render_context)
     {
         render_context->m_RenderList.SetSize(0);
         render_context->m_RenderListSortIndices.SetSize(0);
         render_context->m_RenderListDispatch.SetSize(0);
         render_context->m_RenderListRanges.SetSize(0);
+        render_context->m_OcclusionBuffer.m_Occluders.SetSize(0);
+        render_context->m_OcclusionBuffer.m_TriangleCount = 0;
         render_context->m_FrustumHash = 0xFFFFFFFF; // trigger a first recalculation each frame
+        InvalidateSortBufferCache(render_context);
     }
 
     HRenderListDispatch RenderListMakeDispatch(HRenderContext render_context, RenderListDispatchFn dispatch_fn, RenderListVisibilityFn visibility_fn, void* user_data)
@@ -220,6 +261,7 @@ namespace dmRender
 
         // If we push new items after the last frustum culling, we need to reevaluate it
         render_context->m_FrustumHash = 0xFFFFFFFF;
+        InvalidateSortBufferCache(render_context);
 
         return (render_list.Begin() + size);
     }
@@ -253,19 +295,9 @@ namespace dmRender
 
         // invalidate the ranges if this is a call to the debug rendering (happening in the middle of the frame)
         render_context->m_RenderListRanges.SetSize(0);
+        InvalidateSortBufferCache(render_context);
     }
 
-    struct RenderListSorter
-    {
-        bool operator()(uint32_t a, uint32_t b) const
-        {
-            const RenderListSortValue& u = values[a];
-            const RenderListSortValue& v = values[b];
-            return u.m_SortKey < v.m_SortKey;
-        }
-        RenderListSortValue* values;
-    };
-
     void RenderListEnd(HRenderContext render_context)
     {
         // Unflushed leftovers are assumed to be the debug rendering
@@ -342,6 +374,11 @@ namespace dmRender
     {
         context->m_RenderObjects.SetSize(0);
         ClearDebugRenderObjects(context);
+        ClearLights(context);
+
+        TrimBuffer(context, context->m_InstanceBuffer);
+        RewindBuffer(context, context->m_InstanceBuffer);
+        context->m_InstanceBufferDrawCount = 0;
 
         // Should probably be moved and/or refactored, see case 2261
         // (Cannot reset the text buffer until all render objects are dispatched)
@@ -506,10 +543,24 @@ namespace dmRender
         RenderListSortValue* sort_values = context->m_RenderListSortValues.Begin();
         RenderListEntry* entries = context->m_RenderList.Begin();
 
-        const Matrix4& transform = context->m_ViewProj;
+        // Only the z and w rows of the view projection are needed for the depth
+        const Vector4 row_z = context->m_ViewProj.getRow(2);
+        const Vector4 row_w = context->m_ViewProj.getRow(3);
 
-        float minZW = FLT_MAX;
-        float maxZW = -FLT_MAX;
+        // The world entries are gathered into separate x, y and z arrays, so that the depths
+        // can be computed in one tight loop that the compiler can vectorize
+        const uint32_t max_depth_count = context->m_RenderListSortIndices.Size();
+        if (context->m_RenderListDepthIndices.Capacity() < max_depth_count)
+        {
+            context->m_RenderListDepthIndices.SetCapacity(max_depth_count);
+            context->m_RenderListDepthScratch.SetCapacity(max_depth_count * 3);
+        }
+        context->m_RenderListDepthScratch.SetSize(max_depth_count * 3);
+        uint32_t* depth_indices = context->m_RenderListDepthIndices.Begin();
+        float* xs = context->m_RenderListDepthScratch.Begin();
+        float* ys = xs + max_depth_count;
+        float* zs = ys + max_depth_count;
+        uint32_t depth_count = 0;
 
         RenderListRange* ranges = context->m_RenderListRanges.Begin();
         uint32_t num_ranges = context->m_RenderListRanges.Size();
@@ -527,7 +578,7 @@ namespace dmRender
                 continue;
             }
 
-            // Write z values...
+            // Gather the world positions...
             int num_visibility_skipped = 0;
             for (uint32_t i = range.m_Start; i < range.m_Start+range.m_Count; ++i)
             {
@@ -544,11 +595,11 @@ namespace dmRender
                     continue; // Could perhaps break here, if we also sorted on the major order (cost more when I tested it /MAWE)
                 }
 
-                const Vector4 res = transform * entry->m_WorldPosition;
-                const float zw = res.getZ() / res.getW();
-                sort_values[idx].m_ZW = zw;
-                if (zw < minZW) minZW = zw;
-                if (zw > maxZW) maxZW = zw;
+                depth_indices[depth_count] = idx;
+                xs[depth_count] = entry->m_WorldPosition.getX();
+                ys[depth_count] = entry->m_WorldPosition.getY();
+                zs[depth_count] = entry->m_WorldPosition.getZ();
+                ++depth_count;
             }
 
             if (num_visibility_skipped == range.m_Count)
@@ -557,11 +608,32 @@ namespace dmRender
             }
         }
 
-        // ... and compute range
+        // Compute the z values (reusing the x array), and find their range...
+        const float rz0 = row_z.getX(), rz1 = row_z.getY(), rz2 = row_z.getZ(), rz3 = row_z.getW();
+        const float rw0 = row_w.getX(), rw1 = row_w.getY(), rw2 = row_w.getZ(), rw3 = row_w.getW();
+        float* zws = xs;
+        float minZW = FLT_MAX;
+        float maxZW = -FLT_MAX;
+        for (uint32_t i = 0; i < depth_count; ++i)
+        {
+            const float z = rz0 * xs[i] + rz1 * ys[i] + rz2 * zs[i] + rz3;
+            const float w = rw0 * xs[i] + rw1 * ys[i] + rw2 * zs[i] + rw3;
+            const float zw = z / w;
+            zws[i] = zw;
+            minZW = zw < minZW ? zw : minZW;
+            maxZW = zw > maxZW ? zw : maxZW;
+        }
+
+        // ... and quantize them into the sort order
         float rc = 0;
         if (maxZW > minZW)
             rc = 1.0f / (maxZW - minZW);
 
+        for (uint32_t i = 0; i < depth_count; ++i)
+        {
+            sort_values[depth_indices[i]].m_Order = (uint32_t) (0xfffff8 - 0xfffff0 * rc * (zws[i] - minZW));
+        }
+
         for( uint32_t i = 0; i < num_ranges; ++i)
         {
             const RenderListRange& range = ranges[i];
@@ -579,14 +651,9 @@ namespace dmRender
                 }
 
                 sort_values[idx].m_MajorOrder = entry->m_MajorOrder;
-                if (entry->m_MajorOrder == RENDER_ORDER_WORLD)
-                {
-                    const float z = sort_values[idx].m_ZW;
-                    sort_values[idx].m_Order = (uint32_t) (0xfffff8 - 0xfffff0 * rc * (z - minZW));
-                }
-                else
+                if (entry->m_MajorOrder != RENDER_ORDER_WORLD)
                 {
-                    // use the integer value provided.
+                    // use the integer value provided (the world entries got theirs from the depth above)
                     sort_values[idx].m_Order = entry->m_Order;
                 }
                 sort_values[idx].m_MinorOrder = entry->m_MinorOrder;
@@ -597,6 +664,68 @@ namespace dmRender
         }
     }
 
+    static dmhash_t GetSortBufferCacheKey(HRenderContext context, uint32_t tag_count, const dmhash_t* tags, dmhash_t frustum_hash)
+    {
+        HashState64 state;
+        dmHashInit64(&state, false);
+        dmHashUpdateBuffer64(&state, &tag_count, sizeof(tag_count));
+        dmHashUpdateBuffer64(&state, tags, tag_count * sizeof(dmhash_t));
+        dmHashUpdateBuffer64(&state, &context->m_ViewProj, sizeof(context->m_ViewProj));
+        dmHashUpdateBuffer64(&state, &frustum_hash, sizeof(frustum_hash));
+        return dmHashFinal64(&state);
+    }
+
+    // Copies a previously sorted buffer into the sort buffer. Returns false if there was none
+    static bool GetCachedSortBuffer(HRenderContext context, dmhash_t key)
+    {
+        for (uint32_t i = 0; i < SORT_BUFFER_CACHE_SIZE; ++i)
+        {
+            SortBufferCacheEntry& entry = context->m_SortBufferCache[i];
+            if (entry.m_Generation == context->m_RenderListGeneration && entry.m_Key == key)
+            {
+                entry.m_LastUsed = ++context->m_SortBufferCacheTick;
+                context->m_RenderListSortBuffer.SetCapacity(context->m_RenderListSortIndices.Capacity());
+                context->m_RenderListSortBuffer.SetSize(entry.m_Indices.Size());
+                if (!entry.m_Indices.Empty())
+                {
+                    memcpy(context->m_RenderListSortBuffer.Begin(), entry.m_Indices.Begin(), entry.m_Indices.Size() * sizeof(uint32_t));
+                }
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Stores the sorted buffer, replacing the least recently used (or a stale) entry
+    static void PutCachedSortBuffer(HRenderContext context, dmhash_t key)
+    {
+        SortBufferCacheEntry* victim = &context->m_SortBufferCache[0];
+        for (uint32_t i = 0; i < SORT_BUFFER_CACHE_SIZE; ++i)
+        {
+            SortBufferCacheEntry* entry = &context->m_SortBufferCache[i];
+            if (entry->m_Generation != context->m_RenderListGeneration)
+            {
+                victim = entry;
+                break;
+            }
+            if (entry->m_LastUsed < victim->m_LastUsed)
+            {
+                victim = entry;
+            }
+        }
+
+        const dmArray<uint32_t>& indices = context->m_RenderListSortBuffer;
+        victim->m_Indices.SetCapacity(indices.Capacity());
+        victim->m_Indices.SetSize(indices.Size());
+        if (!indices.Empty())
+        {
+            memcpy(victim->m_Indices.Begin(), indices.Begin(), indices.Size() * sizeof(uint32_t));
+        }
+        victim->m_Key = key;
+        victim->m_Generation = context->m_RenderListGeneration;
+        victim->m_LastUsed = ++context->m_SortBufferCacheTick;
+    }
+
     static void CollectRenderEntryRange(void* _ctx, uint32_t tag_list_key, size_t start, size_t count)
     {
         HRenderContext context = (HRenderContext)_ctx;
@@ -632,6 +761,26 @@ namespace dmRender
         FindRenderListRanges(first, high - first, size - (high - rangefirst), entries, comp, ctx, callback);
     }
 
+    // Returns a key buffer with room for 2*count keys (the second half is used as scratch by the sort)
+    static uint64_t* PrepareSortScratch(HRenderContext context, uint32_t count)
+    {
+        if (context->m_RenderListSortKeys.Capacity() < count * 2)
+        {
+            context->m_RenderListSortKeys.SetCapacity(count * 2);
+            context->m_RenderListSortScratch.SetCapacity(count);
+        }
+        context->m_RenderListSortKeys.SetSize(count * 2);
+        context->m_RenderListSortScratch.SetSize(count);
+        return context->m_RenderListSortKeys.Begin();
+    }
+
+    // Stable sort of the indices on the keys written to the buffer from PrepareSortScratch
+    static void SortIndices(HRenderContext context, uint32_t* indices, uint32_t count, uint32_t key_bits)
+    {
+        uint64_t* keys = context->m_RenderListSortKeys.Begin();
+        dmRadixSort::Sort(keys, indices, keys + count, context->m_RenderListSortScratch.Begin(), count, key_bits);
+    }
+
     static void SortRenderList(HRenderContext context)
     {
         DM_PROFILE("SortRenderList");
@@ -641,9 +790,15 @@ namespace dmRender
 
         // First sort on the tag masks
         {
-            RenderListEntrySorter sort;
-            sort.m_Base = context->m_RenderList.Begin();
-            std::stable_sort(context->m_RenderListSortIndices.Begin(), context->m_RenderListSortIndices.End(), sort);
+            RenderListEntry* entries = context->m_RenderList.Begin();
+            uint32_t* indices = context->m_RenderListSortIndices.Begin();
+            uint32_t count = context->m_RenderListSortIndices.Size();
+            uint64_t* keys = PrepareSortScratch(context, count);
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                keys[i] = entries[indices[i]].m_TagListKey;
+            }
+            SortIndices(context, indices, count, 32);
         }
         // Now find the ranges of tag masks
         {
@@ -669,6 +824,36 @@ namespace dmRender
         }
     }
 
+    static void CullItems(HRenderContext context, const dmIntersection::Frustum* frustum)
+    {
+        const CullingItem* items = context->m_CullingItems.Begin();
+        uint32_t item_count = context->m_CullingItems.Size();
+        while (true)
+        {
+            uint32_t i = (uint32_t) dmAtomicIncrement32(&context->m_CullingNextItem);
+            if (i >= item_count)
+                break;
+
+            const CullingItem& item = items[i];
+            const RenderListDispatch* d = &context->m_RenderListDispatch[item.m_Dispatch];
+            RenderListVisibilityParams params;
+            params.m_Frustum = frustum;
+            params.m_UserData = d->m_UserData;
+            params.m_Entries = context->m_RenderList.Begin() + item.m_Start;
+            params.m_NumEntries = item.m_Count;
+            params.m_OcclusionBuffer = context->m_OcclusionBuffer.m_Valid ? &context->m_OcclusionBuffer : 0;
+            d->m_VisibilityFn(params);
+        }
+    }
+
+    static int CullingJobProcess(void* _context, void* data)
+    {
+        DM_PROFILE("CullingJob");
+        HRenderContext context = (HRenderContext) _context;
+        CullItems(context, (const dmIntersection::Frustum*) data);
+        return 0;
+    }
+
     static void FrustumCulling(HRenderContext context, const dmIntersection::Frustum& frustum)
     {
         DM_PROFILE("FrustumCulling");
@@ -677,7 +862,12 @@ namespace dmRender
         if (num_entries == 0)
             return;
 
-        BatchIterator<RenderListEntry*> iter(num_entries, context->m_RenderList.Begin(), RenderListEntryEqFn);
+        // Split each dispatch batch into chunks, since the visibility of each entry is independent
+        dmArray<CullingItem>& items = context->m_CullingItems;
+        items.SetSize(0);
+
+        RenderListEntry* base = context->m_RenderList.Begin();
+        BatchIterator<RenderListEntry*> iter(num_entries, base, RenderListEntryEqFn);
         while(iter.Next())
         {
             RenderListEntry* batch_start = iter.Begin();
@@ -686,16 +876,110 @@ namespace dmRender
             if (!d->m_VisibilityFn)
             {
                 SetVisibility(iter.Length(), iter.Begin(), dmRender::VISIBILITY_FULL);
+                continue;
             }
-            else {
-                RenderListVisibilityParams params;
-                params.m_Frustum = &frustum;
-                params.m_UserData = d->m_UserData;
-                params.m_Entries = batch_start;
-                params.m_NumEntries = iter.Length();
-                d->m_VisibilityFn(params);
+
+            uint32_t start = batch_start - base;
+            uint32_t end = start + iter.Length();
+            for (; start < end; start += CULLING_ITEM_ENTRY_COUNT)
+            {
+                if (items.Full())
+                    items.OffsetCapacity(dmMath::Max(16U, items.Capacity() / 2));
+                CullingItem item;
+                item.m_Dispatch = batch_start->m_Dispatch;
+                item.m_Start = start;
+                item.m_Count = dmMath::Min(CULLING_ITEM_ENTRY_COUNT, end - start);
+                items.Push(item);
             }
         }
+
+        if (items.Empty())
+            return;
+
+        uint32_t job_count = 0;
+        if (context->m_JobThread && items.Size() > 1)
+        {
+            job_count = dmMath::Min(dmJobThread::GetWorkerCount(context->m_JobThread), items.Size() - 1);
+        }
+
+        // The jobs and the calling thread pick items until there are none left
+        dmAtomicStore32(&context->m_CullingNextItem, 0);
+        dmJobThread::JobGroup group;
+        dmJobThread::InitGroup(&group, 0);
+        for (uint32_t i = 0; i < job_count; ++i)
+        {
+            dmJobThread::PushGroupJob(context->m_JobThread, &group, CullingJobProcess, (void*) context, (void*) &frustum);
+        }
+
+        CullItems(context, &frustum);
+
+        if (job_count > 0)
+        {
+            DM_PROFILE("WaitCullingJobs");
+            dmJobThread::WaitGroup(context->m_JobThread, &group);
+        }
+    }
+
+    // Restores the visibility of the render list entries from a previous culling with the same frustum. Returns false if there was none
+    static bool GetCachedVisibility(HRenderContext context, dmhash_t frustum_hash)
+    {
+        for (uint32_t i = 0; i < VISIBILITY_CACHE_SIZE; ++i)
+        {
+            VisibilityCacheEntry& entry = context->m_VisibilityCache[i];
+            if (entry.m_Generation == context->m_RenderListGeneration && entry.m_FrustumHash == frustum_hash)
+            {
+                entry.m_LastUsed = ++context->m_SortBufferCacheTick;
+                const uint32_t* visible = entry.m_Visible.Begin();
+                RenderListEntry* entries = context->m_RenderList.Begin();
+                uint32_t num_entries = context->m_RenderList.Size();
+                for (uint32_t e = 0; e < num_entries; ++e)
+                {
+                    entries[e].m_Visibility = (visible[e >> 5] >> (e & 31)) & 1;
+                }
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Stores the visibility of the render list entries, replacing the least recently used (or a stale) entry
+    static void PutCachedVisibility(HRenderContext context, dmhash_t frustum_hash)
+    {
+        VisibilityCacheEntry* victim = &context->m_VisibilityCache[0];
+        for (uint32_t i = 0; i < VISIBILITY_CACHE_SIZE; ++i)
+        {
+            VisibilityCacheEntry* entry = &context->m_VisibilityCache[i];
+            if (entry->m_Generation != context->m_RenderListGeneration)
+            {
+                victim = entry;
+                break;
+            }
+            if (entry->m_LastUsed < victim->m_LastUsed)
+            {
+                victim = entry;
+            }
+        }
+
+        const RenderListEntry* entries = context->m_RenderList.Begin();
+        uint32_t num_entries = context->m_RenderList.Size();
+        uint32_t num_words = (num_entries + 31) / 32;
+        if (victim->m_Visible.Capacity() < num_words)
+        {
+            victim->m_Visible.SetCapacity(num_words);
+        }
+        victim->m_Visible.SetSize(num_words);
+        if (num_words > 0)
+        {
+            memset(victim->m_Visible.Begin(), 0, num_words * sizeof(uint32_t));
+        }
+        uint32_t* visible = victim->m_Visible.Begin();
+        for (uint32_t e = 0; e < num_entries; ++e)
+        {
+            visible[e >> 5] |= (uint32_t) entries[e].m_Visibility << (e & 31);
+        }
+        victim->m_FrustumHash = frustum_hash;
+        victim->m_Generation = context->m_RenderListGeneration;
+        victim->m_LastUsed = ++context->m_SortBufferCacheTick;
     }
 
     void SetTextureBindingByHash(dmRender::HRenderContext render_context, dmhash_t sampler_hash, dmGraphics::HTexture texture)
@@ -855,24 +1139,41 @@ namespace dmRender
             }
         }
 
+        UpdateLightGrid(context);
+
         // Cleared once per frame
         if (context->m_RenderListRanges.Empty())
         {
             SortRenderList(context);
         }
 
-        dmhash_t frustum_hash = frustum_matrix ? dmHashBuffer64((const void*) frustum_matrix, 16*sizeof(float)) : 0;
+        dmhash_t frustum_hash = 0;
+        if (frustum_matrix)
+        {
+            HashState64 state;
+            dmHashInit64(&state, false);
+            dmHashUpdateBuffer64(&state, frustum_matrix, 16*sizeof(float));
+            dmHashUpdateBuffer64(&state, &frustum_num_planes, sizeof(frustum_num_planes));
+            frustum_hash = dmHashFinal64(&state);
+        }
 
         if (context->m_FrustumHash != frustum_hash)
         {
             // We use this to avoid calling the culling functions more than once in a row
             context->m_FrustumHash = frustum_hash;
 
+            // When drawing from several cameras (e.g. a minimap and the main view), the culling
+            // of each camera is kept for the rest of the frame
             if (frustum_matrix)
             {
-                dmIntersection::Frustum frustum;
-                dmIntersection::CreateFrustumFromMatrix(*frustum_matrix, true, (int) frustum_num_planes, frustum);
-                FrustumCulling(context, frustum);
+                if (!GetCachedVisibility(context, frustum_hash))
+                {
+                    dmIntersection::Frustum frustum;
+                    dmIntersection::CreateFrustumFromMatrix(*frustum_matrix, true, (int) frustum_num_planes, frustum);
+                    BuildOcclusionBuffer(context, *frustum_matrix);
+                    FrustumCulling(context, frustum);
+                    PutCachedVisibility(context, frustum_hash);
+                }
             }
             else
             {
@@ -881,18 +1182,36 @@ namespace dmRender
             }
         }
 
-        MakeSortBuffer(context, predicate?predicate->m_TagCount:0, predicate?predicate->m_Tags:0);
-
-        if (context->m_RenderListSortBuffer.Empty())
-            return RESULT_OK;
+        // Render scripts often draw the same predicate several times (e.g. for different passes) with the
+        // same matrices, so the sorted buffer is cached, like the culling result above
+        uint32_t tag_count = predicate ? predicate->m_TagCount : 0;
+        dmhash_t* tags = predicate ? predicate->m_Tags : 0;
+        dmhash_t sort_key = GetSortBufferCacheKey(context, tag_count, tags, frustum_hash);
 
+        if (!GetCachedSortBuffer(context, sort_key))
         {
-            DM_PROFILE("DrawRenderList_SORT");
-            RenderListSorter sort;
-            sort.values = context->m_RenderListSortValues.Begin();
-            std::stable_sort(context->m_RenderListSortBuffer.Begin(), context->m_RenderListSortBuffer.End(), sort);
+            MakeSortBuffer(context, tag_count, tags);
+
+            if (!context->m_RenderListSortBuffer.Empty())
+            {
+                DM_PROFILE("DrawRenderList_SORT");
+                const RenderListSortValue* sort_values = context->m_RenderListSortValues.Begin();
+                uint32_t* indices = context->m_RenderListSortBuffer.Begin();
+                uint32_t count = context->m_RenderListSortBuffer.Size();
+                uint64_t* keys = PrepareSortScratch(context, count);
+                for (uint32_t i = 0; i < count; ++i)
+                {
+                    keys[i] = sort_values[indices[i]].m_SortKey;
+                }
+                SortIndices(context, indices, count, 64);
+            }
+
+            PutCachedSortBuffer(context, sort_key);
         }
 
+        if (context->m_RenderListSortBuffer.Empty())
+            return RESULT_OK;
+
         // Construct render objects
         context->m_RenderObjects.SetSize(0);
 
@@ -1034,6 +1353,278 @@ namespace dmRender
 
     // NOTE: Currently only used externally in 1 test (fontview.cpp)
     // TODO: Replace that occurrance with DrawRenderList
+    static bool MatchRenderObjectPredicate(HRenderContext render_context, const RenderObject* ro, HPredicate predicate)
+    {
+        if (!predicate)
+            return true;
+
+        MaterialTagList taglist;
+        uint32_t taglistkey = dmRender::GetMaterialTagListKey(ro->m_Material);
+        dmRender::GetMaterialTagList(render_context, taglistkey, &taglist);
+        return dmRender::MatchMaterialTags(taglist.m_Count, taglist.m_Tags, predicate->m_TagCount, predicate->m_Tags);
+    }
+
+    // A material can be instanced automatically when its per-instance attributes can be produced
+    // from the render object itself, and no constants depend on the transform of the render object.
+    static bool CanAutoInstanceMaterial(HMaterial material)
+    {
+        if (!material->m_InstancingSupported ||
+            material->m_VertexDeclarationPerInstance == 0 ||
+            material->m_VertexSpace != dmRenderDDF::MaterialDesc::VERTEX_SPACE_LOCAL)
+        {
+            return false;
+        }
+
+        const dmArray<RenderConstant>& constants = material->m_Constants;
+        for (uint32_t i = 0; i < constants.Size(); ++i)
+        {
+            switch(GetConstantType(constants[i].m_Constant))
+            {
+                case dmRenderDDF::MaterialDesc::CONSTANT_TYPE_WORLD:
+                case dmRenderDDF::MaterialDesc::CONSTANT_TYPE_TEXTURE:
+                case dmRenderDDF::MaterialDesc::CONSTANT_TYPE_NORMAL:
+                case dmRenderDDF::MaterialDesc::CONSTANT_TYPE_WORLDVIEW:
+                case dmRenderDDF::MaterialDesc::CONSTANT_TYPE_WORLDVIEWPROJ:
+                    return false;
+                default:break;
+            }
+        }
+        return true;
+    }
+
+    // Returns the vertex buffer binding to use for the instance data, or -1 if the
+    // render object already provides its own instance data (or has no free binding)
+    static int32_t GetInstanceBindingIndex(const RenderObject* ro, HMaterial material)
+    {
+        if (ro->m_InstanceCount > 1)
+            return -1;
+
+        dmGraphics::HVertexDeclaration instance_decl = material->m_VertexDeclarationPerInstance;
+        int32_t binding_index = -1;
+
+        for (int i = 0; i < RenderObject::MAX_VERTEX_BUFFER_COUNT; ++i)
+        {
+            dmGraphics::HVertexDeclaration decl = ro->m_VertexDeclarations[i];
+            if (!decl)
+            {
+                if (!ro->m_VertexBuffers[i] && binding_index < 0)
+                    binding_index = i;
+                continue;
+            }
+
+            if (decl->m_StepFunction == dmGraphics::VERTEX_STEP_FUNCTION_INSTANCE)
+                return -1;
+
+            for (int s = 0; s < instance_decl->m_StreamCount; ++s)
+            {
+                if (dmGraphics::GetVertexStreamOffset(decl, instance_decl->m_Streams[s].m_NameHash) != dmGraphics::INVALID_STREAM_OFFSET)
+                    return -1;
+            }
+        }
+        return binding_index;
+    }
+
+    static bool CanInstanceTogether(const RenderObject* a, const RenderObject* b)
+    {
+        if (a->m_Material       != b->m_Material ||
+            a->m_ConstantBuffer != b->m_ConstantBuffer ||
+            a->m_IndexBuffer    != b->m_IndexBuffer ||
+            a->m_IndexType      != b->m_IndexType ||
+            a->m_PrimitiveType  != b->m_PrimitiveType ||
+            a->m_VertexStart    != b->m_VertexStart ||
+            a->m_VertexCount    != b->m_VertexCount ||
+            b->m_InstanceCount  > 1)
+        {
+            return false;
+        }
+
+        if (memcmp(a->m_VertexBuffers, b->m_VertexBuffers, sizeof(a->m_VertexBuffers)) != 0 ||
+            memcmp(a->m_VertexDeclarations, b->m_VertexDeclarations, sizeof(a->m_VertexDeclarations)) != 0 ||
+            memcmp(a->m_VertexBufferOffsets, b->m_VertexBufferOffsets, sizeof(a->m_VertexBufferOffsets)) != 0 ||
+            memcmp(a->m_Textures, b->m_Textures, sizeof(a->m_Textures)) != 0)
+        {
+            return false;
+        }
+
+        if (a->m_SetBlendFactors != b->m_SetBlendFactors ||
+            a->m_SetStencilTest  != b->m_SetStencilTest ||
+            a->m_SetFaceWinding  != b->m_SetFaceWinding ||
+            a->m_SetScissor      != b->m_SetScissor)
+        {
+            return false;
+        }
+
+        if (a->m_SetBlendFactors && (a->m_SourceBlendFactor != b->m_SourceBlendFactor || a->m_DestinationBlendFactor != b->m_DestinationBlendFactor))
+            return false;
+        if (a->m_SetStencilTest && memcmp(&a->m_StencilTestParams, &b->m_StencilTestParams, sizeof(a->m_StencilTestParams)) != 0)
+            return false;
+        if (a->m_SetFaceWinding && a->m_FaceWinding != b->m_FaceWinding)
+            return false;
+        if (a->m_SetScissor && memcmp(&a->m_ScissorRect, &b->m_ScissorRect, sizeof(a->m_ScissorRect)) != 0)
+            return false;
+        return true;
+    }
+
+    // Projects the world space scissor rect of the render object to the pixels of the current viewport
+    static void ApplyScissor(HRenderContext render_context, dmGraphics::HContext graphics_context, const RenderObject* ro)
+    {
+        int32_t vx = render_context->m_Viewport[0];
+        int32_t vy = render_context->m_Viewport[1];
+        int32_t vw = render_context->m_Viewport[2];
+        int32_t vh = render_context->m_Viewport[3];
+        if (vw == 0)
+        {
+            vx = vy = 0;
+            vw = (int32_t) dmGraphics::GetWidth(graphics_context);
+            vh = (int32_t) dmGraphics::GetHeight(graphics_context);
+        }
+
+        const Matrix4& view_proj = render_context->m_ViewProj;
+        Vector4 p0 = view_proj * Point3(ro->m_ScissorRect.getX(), ro->m_ScissorRect.getY(), 0.0f);
+        Vector4 p1 = view_proj * Point3(ro->m_ScissorRect.getZ(), ro->m_ScissorRect.getW(), 0.0f);
+        float x0 = (p0.getX() / p0.getW() * 0.5f + 0.5f) * vw + vx;
+        float y0 = (p0.getY() / p0.getW() * 0.5f + 0.5f) * vh + vy;
+        float x1 = (p1.getX() / p1.getW() * 0.5f + 0.5f) * vw + vx;
+        float y1 = (p1.getY() / p1.getW() * 0.5f + 0.5f) * vh + vy;
+
+        // Rounded, to cover the same pixels (by their centers) as the rasterized rect would
+        int32_t min_x = (int32_t) floorf(dmMath::Min(x0, x1) + 0.5f);
+        int32_t min_y = (int32_t) floorf(dmMath::Min(y0, y1) + 0.5f);
+        int32_t max_x = (int32_t) floorf(dmMath::Max(x0, x1) + 0.5f);
+        int32_t max_y = (int32_t) floorf(dmMath::Max(y0, y1) + 0.5f);
+        dmGraphics::SetScissor(graphics_context, min_x, min_y, dmMath::Max(0, max_x - min_x), dmMath::Max(0, max_y - min_y));
+    }
+
+    static void ResetScissor(HRenderContext render_context, dmGraphics::HContext graphics_context)
+    {
+        dmGraphics::DisableState(graphics_context, dmGraphics::STATE_SCISSOR_TEST);
+        // Some graphics adapters always scissor, so the rect is restored too
+        if (render_context->m_Viewport[2] != 0)
+            dmGraphics::SetScissor(graphics_context, render_context->m_Viewport[0], render_context->m_Viewport[1], render_context->m_Viewport[2], render_context->m_Viewport[3]);
+        else
+            dmGraphics::SetScissor(graphics_context, 0, 0, dmGraphics::GetWidth(graphics_context), dmGraphics::GetHeight(graphics_context));
+    }
+
+    static void WriteInstanceData(HRenderContext render_context, HMaterial material, const RenderObject* ro, uint8_t* write_ptr)
+    {
+        dmGraphics::HVertexDeclaration instance_decl = material->m_VertexDeclarationPerInstance;
+        const dmArray<dmGraphics::VertexAttribute>& attributes = material->m_VertexAttributes;
+
+        for (uint32_t i = 0; i < attributes.Size(); ++i)
+        {
+            const dmGraphics::VertexAttribute& attribute = attributes[i];
+            if (attribute.m_StepFunction != dmGraphics::VERTEX_STEP_FUNCTION_INSTANCE)
+                continue;
+
+            uint32_t offset = dmGraphics::GetVertexStreamOffset(instance_decl, attribute.m_NameHash);
+            if (offset == dmGraphics::INVALID_STREAM_OFFSET)
+                continue;
+
+            bool is_float_mat4 = attribute.m_DataType == dmGraphics::VertexAttribute::TYPE_FLOAT && attribute.m_ElementCount == 16;
+
+            if (is_float_mat4 && attribute.m_SemanticType == dmGraphics::VertexAttribute::SEMANTIC_TYPE_WORLD_MATRIX)
+            {
+                memcpy(write_ptr + offset, &ro->m_WorldTransform, sizeof(Matrix4));
+            }
+            else if (is_float_mat4 && attribute.m_SemanticType == dmGraphics::VertexAttribute::SEMANTIC_TYPE_NORMAL_MATRIX)
+            {
+                Matrix4 normal_matrix = GetNormalMatrix(render_context, ro->m_WorldTransform);
+                memcpy(write_ptr + offset, &normal_matrix, sizeof(Matrix4));
+            }
+            else
+            {
+                // Other per-instance attributes use the material value for all instances
+                const uint8_t* value_ptr;
+                uint32_t value_byte_size;
+                GetMaterialProgramAttributeValues(material, i, &value_ptr, &value_byte_size);
+                memcpy(write_ptr + offset, value_ptr, value_byte_size);
+            }
+        }
+    }
+
+    // Finds runs of consecutive render objects that only differ in their world transform, and
+    // writes their per-instance data (world and normal matrices) into the render context instance buffer.
+    // Each run is then drawn with a single instanced draw call in Draw().
+    static void PrepareInstanceRuns(HRenderContext render_context, HPredicate predicate, HMaterial context_material)
+    {
+        dmArray<InstanceRun>& runs = render_context->m_InstanceRuns;
+        dmArray<uint8_t>& data     = render_context->m_InstanceBufferData;
+        runs.SetSize(0);
+        data.SetSize(0);
+
+        if (!render_context->m_AutoInstancing)
+            return;
+
+        DM_PROFILE("PrepareInstanceRuns");
+
+        RenderObject** render_objects = render_context->m_RenderObjects.Begin();
+        uint32_t count = render_context->m_RenderObjects.Size();
+
+        uint32_t i = 0;
+        while (i < count)
+        {
+            RenderObject* ro   = render_objects[i];
+            HMaterial material = context_material ? context_material : ro->m_Material;
+
+            int32_t binding_index = -1;
+            if (ro->m_VertexCount == 0 ||
+                !MatchRenderObjectPredicate(render_context, ro, predicate) ||
+                !CanAutoInstanceMaterial(material) ||
+                (binding_index = GetInstanceBindingIndex(ro, material)) < 0)
+            {
+                ++i;
+                continue;
+            }
+
+            uint32_t run_end = i + 1;
+            while (run_end < count && CanInstanceTogether(ro, render_objects[run_end]))
+            {
+                ++run_end;
+            }
+
+            InstanceRun run;
+            run.m_First        = i;
+            run.m_Count        = run_end - i;
+            run.m_Offset       = data.Size();
+            run.m_BindingIndex = binding_index;
+
+            uint32_t stride = dmGraphics::GetVertexDeclarationStride(material->m_VertexDeclarationPerInstance);
+            uint32_t run_size = stride * run.m_Count;
+            if (data.Remaining() < run_size)
+            {
+                data.OffsetCapacity(dmMath::Max<uint32_t>(run_size - data.Remaining(), 1024));
+            }
+
+            uint8_t* write_ptr = data.End();
+            memset(write_ptr, 0, run_size);
+            for (uint32_t j = i; j < run_end; ++j)
+            {
+                WriteInstanceData(render_context, material, render_objects[j], write_ptr);
+                write_ptr += stride;
+            }
+            data.SetSize(data.Size() + run_size);
+
+            if (runs.Full())
+            {
+                runs.OffsetCapacity(64);
+            }
+            runs.Push(run);
+
+            i = run_end;
+        }
+
+        if (data.Empty())
+            return;
+
+        // Each Draw() call in a frame needs its own buffer when the graphics backend requires multi buffering
+        if (GetBufferIndex(render_context, render_context->m_InstanceBuffer) < render_context->m_InstanceBufferDrawCount)
+        {
+            AddRenderBuffer(render_context, render_context->m_InstanceBuffer);
+        }
+        SetBufferData(render_context, render_context->m_InstanceBuffer, data.Size(), data.Begin(), dmGraphics::BUFFER_USAGE_DYNAMIC_DRAW);
+        render_context->m_InstanceBufferDrawCount++;
+    }
+
     Result Draw(HRenderContext render_context, HPredicate predicate, HNamedConstantBuffer constant_buffer)
     {
         if (render_context == 0x0)
@@ -1053,21 +1644,34 @@ namespace dmRender
 
         dmGraphics::PipelineState ps_orig = dmGraphics::GetPipelineState(context);
 
+        PrepareInstanceRuns(render_context, predicate, context_material);
+
+        const InstanceRun* instance_runs  = render_context->m_InstanceRuns.Begin();
+        uint32_t instance_run_count       = render_context->m_InstanceRuns.Size();
+        uint32_t instance_run_index       = 0;
+
+        // Constants are only cached within one Draw call, since materials and view/projection can change between calls
+        HMaterial constants_material = 0;
+        dmGraphics::HVertexBuffer instance_buffer = instance_run_count ? (dmGraphics::HVertexBuffer) GetBuffer(render_context, render_context->m_InstanceBuffer) : 0;
+        bool scissor_enabled = false;
+
         for (uint32_t i = 0; i < render_context->m_RenderObjects.Size(); ++i)
         {
             RenderObject* ro = render_context->m_RenderObjects[i];
             if (ro->m_VertexCount == 0)
                 continue;
 
-            MaterialTagList taglist;
-            uint32_t taglistkey = dmRender::GetMaterialTagListKey(ro->m_Material);
-            dmRender::GetMaterialTagList(render_context, taglistkey, &taglist);
-
-            if (predicate && !dmRender::MatchMaterialTags(taglist.m_Count, taglist.m_Tags, predicate->m_TagCount, predicate->m_Tags))
+            if (!MatchRenderObjectPredicate(render_context, ro, predicate))
             {
                 continue;
             }
 
+            const InstanceRun* instance_run = 0;
+            if (instance_run_index < instance_run_count && instance_runs[instance_run_index].m_First == i)
+            {
+                instance_run = &instance_runs[instance_run_index++];
+            }
+
             if (!context_material)
             {
                 if(material != ro->m_Material)
@@ -1082,16 +1686,38 @@ namespace dmRender
                 }
             }
 
-            ApplyMaterialConstants(render_context, material, ro);
+            // The material constants that don't depend on the render object are still set in the program
+            // if the previous render object used the same material, and didn't override any constants.
+            if (material == constants_material)
+                ApplyMaterialObjectConstants(render_context, material, ro);
+            else
+                ApplyMaterialConstants(render_context, material, ro);
+            constants_material = material;
 
             if (ro->m_ConstantBuffer) // from components/scripts
+            {
                 ApplyNamedConstantBuffer(render_context, material, ro->m_ConstantBuffer);
+                constants_material = 0;
+            }
 
             if (constant_buffer) // from render script
                 ApplyNamedConstantBuffer(render_context, material, constant_buffer);
 
             ApplyRenderState(render_context, render_context->m_GraphicsContext, dmGraphics::GetPipelineState(context), ro);
 
+            if (ro->m_SetScissor)
+            {
+                if (!scissor_enabled)
+                    dmGraphics::EnableState(context, dmGraphics::STATE_SCISSOR_TEST);
+                ApplyScissor(render_context, context, ro);
+                scissor_enabled = true;
+            }
+            else if (scissor_enabled)
+            {
+                ResetScissor(render_context, context);
+                scissor_enabled = false;
+            }
+
             uint8_t next_texture_unit = 0;
             for (uint32_t i = 0; i < RenderObject::MAX_TEXTURE_COUNT; ++i)
             {
@@ -1129,10 +1755,24 @@ namespace dmRender
                 }
             }
 
+            uint32_t instance_count = ro->m_InstanceCount;
+            if (instance_run)
+            {
+                dmGraphics::EnableVertexBuffer(context, instance_buffer, instance_run->m_BindingIndex);
+                dmGraphics::EnableVertexDeclaration(context, material->m_VertexDeclarationPerInstance, instance_run->m_BindingIndex, instance_run->m_Offset, material_program);
+                instance_count = instance_run->m_Count;
+            }
+
             if (ro->m_IndexBuffer)
-                dmGraphics::DrawElements(context, ro->m_PrimitiveType, ro->m_VertexStart, ro->m_VertexCount, ro->m_IndexType, ro->m_IndexBuffer, ro->m_InstanceCount);
+                dmGraphics::DrawElements(context, ro->m_PrimitiveType, ro->m_VertexStart, ro->m_VertexCount, ro->m_IndexType, ro->m_IndexBuffer, instance_count);
             else
-                dmGraphics::Draw(context, ro->m_PrimitiveType, ro->m_VertexStart, ro->m_VertexCount, ro->m_InstanceCount);
+                dmGraphics::Draw(context, ro->m_PrimitiveType, ro->m_VertexStart, ro->m_VertexCount, instance_count);
+
+            if (instance_run)
+            {
+                dmGraphics::DisableVertexBuffer(context, instance_buffer);
+                dmGraphics::DisableVertexDeclaration(context, material->m_VertexDeclarationPerInstance);
+            }
 
             for (int i = 0; i < RenderObject::MAX_VERTEX_BUFFER_COUNT; ++i)
             {
@@ -1162,8 +1802,17 @@ namespace dmRender
                     }
                 }
             }
+
+            // The remaining render objects in the run were drawn as instances
+            if (instance_run)
+            {
+                i += instance_run->m_Count - 1;
+            }
         }
 
+        if (scissor_enabled)
+            ResetScissor(render_context, context);
+
         ResetRenderStateIfChanged(context, ps_orig, dmGraphics::GetPipelineState(context));
 
         TrimTextureBindingTable(render_context);
@@ -1176,6 +1825,7 @@ namespace dmRender
         if (!context->m_DebugRenderer.m_RenderContext) {
             return RESULT_INVALID_CONTEXT;
         }
+        AddDebugDrawView(context, context->m_ViewProj);
         return DrawRenderList(context, &context->m_DebugRenderer.m_3dPredicate, 0, frustum_options);
     }
 
@@ -21,6 +21,7 @@
 #include <dmsdk/render/render.h>
 
 #include <dlib/hash.h>
+#include <dlib/job_thread.h>
 #include <script/script.h>
 #include <script/lua_source_ddf.h>
 #include <graphics/graphics.h>
@@ -39,6 +40,7 @@ namespace dmRender
     static const dmhash_t VERTEX_STREAM_TEXCOORD0     = dmHashString64("texcoord0");
     static const dmhash_t VERTEX_STREAM_TEXCOORD1     = dmHashString64("texcoord1");
     static const dmhash_t VERTEX_STREAM_PAGE_INDEX    = dmHashString64("page_index");
+    static const dmhash_t VERTEX_STREAM_TEXTURE_INDEX = dmHashString64("texture_index");
     static const dmhash_t VERTEX_STREAM_WORLD_MATRIX  = dmHashString64("mtx_world");
     static const dmhash_t VERTEX_STREAM_NORMAL_MATRIX = dmHashString64("mtx_normal");
 
@@ -142,6 +144,8 @@ namespace dmRender
         /// Max debug vertex count
         /// NOTE: This is per debug-type and not the total sum
         uint32_t                        m_MaxDebugVertexCount;
+        /// Optional worker threads, used for splitting up e.g. the frustum culling. Not owned by the render context
+        dmJobThread::HContext           m_JobThread;
     };
 
     struct RenderCameraData
@@ -156,6 +160,16 @@ namespace dmRender
         uint8_t          m_OrthographicProjection : 1;
     };
 
+    /// A light sorted into the clusters of the light grid (see AddLight)
+    struct LightGridLight
+    {
+        dmVMath::Point3  m_Position;
+        dmVMath::Vector3 m_Direction;   // Spot lights
+        dmVMath::Vector4 m_Color;       // The intensity is premultiplied
+        float            m_Range;
+        float            m_ConeAngle;   // 0 for point lights
+    };
+
     struct MaterialProgramAttributeInfo
     {
         dmhash_t                           m_AttributeNameHash;
@@ -236,6 +250,26 @@ namespace dmRender
      */
     void Line3D(HRenderContext context, dmVMath::Point3 start, dmVMath::Point3 end, dmVMath::Vector4 start_color, dmVMath::Vector4 end_color);
 
+    /**
+     * Render a batch of debug lines in world space, between each pair of points.
+     * The batch is skipped if its bounds are outside the views that drew the debug data the previous frame.
+     * @param context Render context handle
+     * @param points Points of the lines
+     * @param point_count Number of points, two per line
+     * @param color Color
+     */
+    void Lines3D(HRenderContext context, const dmVMath::Point3* points, uint32_t point_count, dmVMath::Vector4 color);
+
+    /**
+     * Render a batch of debug triangles in world space.
+     * The batch is skipped if its bounds are outside the views that drew the debug data the previous frame.
+     * @param context Render context handle
+     * @param points Vertices of the triangles, three per triangle, CW winding
+     * @param point_count Number of vertices
+     * @param color Color
+     */
+    void Triangles3D(HRenderContext context, const dmVMath::Point3* points, uint32_t point_count, dmVMath::Vector4 color);
+
     HRenderScript   NewRenderScript(HRenderContext render_context, dmLuaDDF::LuaSource *source);
 
     bool            ReloadRenderScript(HRenderContext render_context, HRenderScript render_script, dmLuaDDF::LuaSource *source);
@@ -261,6 +295,7 @@ namespace dmRender
     dmhash_t                        GetMaterialSamplerNameHash(HMaterial material, uint32_t unit);
     uint32_t                        GetMaterialSamplerUnit(HMaterial material, dmhash_t name_hash);
     void                            ApplyMaterialConstants(dmRender::HRenderContext render_context, HMaterial material, const RenderObject* ro);
+    void                            ApplyMaterialObjectConstants(dmRender::HRenderContext render_context, HMaterial material, const RenderObject* ro);
     void                            ApplyMaterialSampler(dmRender::HRenderContext render_context, HMaterial material, HSampler sampler, uint8_t value_index, dmGraphics::HTexture texture);
 
     dmGraphics::HProgram            GetMaterialProgram(HMaterial material);
@@ -349,6 +384,12 @@ namespace dmRender
      * as well as to avoid excessive buffer allocations between frames.
      * Rewinding the buffer means that we set the buffer index to the head of the buffer list,
      * to prepare for setting data to the beginning of the buffer list again.
+     *
+     * Note on mapping:
+     * MapBufferData resizes the current render buffer to 'size' bytes and returns a pointer that the
+     * data can be written to directly, instead of going through an intermediate copy and SetBufferData.
+     * If the graphics context doesn't support mapping buffers, 0 is returned and the caller should use SetBufferData instead.
+     * The buffer must be unmapped with UnmapBufferData before it is used for drawing.
      */
     HBufferedRenderBuffer           NewBufferedRenderBuffer(HRenderContext render_context, RenderBufferType type);
     void                            DeleteBufferedRenderBuffer(HRenderContext render_context, HBufferedRenderBuffer buffer);
@@ -356,6 +397,8 @@ namespace dmRender
     HRenderBuffer                   GetBuffer(HRenderContext render_context, HBufferedRenderBuffer buffer);
     int32_t                         GetBufferIndex(HRenderContext render_context, HBufferedRenderBuffer buffer);
     void                            SetBufferData(HRenderContext render_context, HBufferedRenderBuffer buffer, uint32_t size, void* data, dmGraphics::BufferUsage buffer_usage);
+    void*                           MapBufferData(HRenderContext render_context, HBufferedRenderBuffer buffer, uint32_t size, dmGraphics::BufferUsage buffer_usage);
+    void                            UnmapBufferData(HRenderContext render_context, HBufferedRenderBuffer buffer);
     void                            TrimBuffer(HRenderContext render_context, HBufferedRenderBuffer buffer);
     void                            RewindBuffer(HRenderContext render_context, HBufferedRenderBuffer buffer);
 
@@ -374,6 +417,25 @@ namespace dmRender
     void                            GetRenderCameraData(HRenderContext render_context, HRenderCamera camera, RenderCameraData* data);
     void                            UpdateRenderCamera(HRenderContext render_context, HRenderCamera camera, const dmVMath::Point3* position, const dmVMath::Quat* rotation);
 
+    /** Clustered lights
+     * The lights added during the frame are sorted into a grid of clusters over the view frustum when the render list is drawn,
+     * and the grid is bound to the samplers "light_grid_clusters", "light_grid_indices" and "light_grid_lights" (see light_grid.cpp).
+     * A material can then light each fragment with only the lights of its cluster. The lights are cleared with the render objects.
+     */
+    void                            AddLight(HRenderContext render_context, const LightGridLight& light);
+    void                            ClearLights(HRenderContext render_context);
+    uint32_t                        GetLightCount(HRenderContext render_context);
+
+    /** Occlusion culling
+     * The triangles of the occluders added during the frame are rasterized into a small depth buffer on the CPU, when the render list
+     * is culled with a frustum. The visibility callbacks can then test their bounds against it (see RenderListVisibilityParams::m_OcclusionBuffer).
+     * The occluders are cleared with the render list, and the mesh data must stay valid until then.
+     */
+    void                            AddOccluder(HRenderContext render_context, const dmVMath::Matrix4& world, const float* positions, const void* indices, uint32_t index_count, bool index_32bit);
+    uint32_t                        GetOccluderCount(HRenderContext render_context);
+    // Returns true if the box is hidden behind the occluders
+    bool                            IsOccluded(HOcclusionBuffer buffer, const dmVMath::Matrix4& world, const dmVMath::Vector3& aabb_min, const dmVMath::Vector3& aabb_max);
+
     static inline dmGraphics::TextureWrap WrapFromDDF(dmRenderDDF::MaterialDesc::WrapMode wrap_mode)
     {
         switch(wrap_mode)
@@ -59,6 +59,8 @@ namespace dmRender
     {
         dmGraphics::HContext context = dmRender::GetGraphicsContext(render_context);
 
+        dmGraphics::BeginGpuScope(context, "RenderScript");
+
         for (uint32_t i=0; i<command_count; i++)
         {
             Command* c = &commands[i];
@@ -106,13 +108,17 @@ namespace dmRender
                     union float_to_uint32_t {float f; uint32_t i;};
                     float_to_uint32_t ftoi;
                     ftoi.i = c->m_Operands[2];
+                    dmGraphics::BeginGpuScope(context, "Clear");
                     dmGraphics::Clear(context, c->m_Operands[0], r, g, b, a, ftoi.f, c->m_Operands[3]);
+                    dmGraphics::EndGpuScope(context);
                     render_context->m_StencilBufferCleared = (c->m_Operands[0] & dmGraphics::BUFFER_TYPE_STENCIL_BIT) != 0;
                     break;
                 }
                 case COMMAND_TYPE_SET_VIEWPORT:
                 {
                     dmGraphics::SetViewport(context, c->m_Operands[0], c->m_Operands[1], c->m_Operands[2], c->m_Operands[3]);
+                    for (uint32_t i = 0; i < 4; ++i)
+                        render_context->m_Viewport[i] = (int32_t) c->m_Operands[i];
                     break;
                 }
                 case COMMAND_TYPE_SET_VIEW:
@@ -177,16 +183,20 @@ namespace dmRender
                 case COMMAND_TYPE_DRAW:
                 {
                     FrustumOptions* frustum_options = (FrustumOptions*)c->m_Operands[2];
+                    dmGraphics::BeginGpuScope(context, "Draw");
                     dmRender::DrawRenderList(render_context, (dmRender::Predicate*)c->m_Operands[0],
                                                              (dmRender::HNamedConstantBuffer)c->m_Operands[1],
                                                              frustum_options);
+                    dmGraphics::EndGpuScope(context);
                     delete frustum_options;
                     break;
                 }
                 case COMMAND_TYPE_DRAW_DEBUG3D:
                 {
                     FrustumOptions* frustum_options = (FrustumOptions*)c->m_Operands[0];
+                    dmGraphics::BeginGpuScope(context, "DrawDebug3d");
                     dmRender::DrawDebug3d(render_context, frustum_options);
+                    dmGraphics::EndGpuScope(context);
                     delete frustum_options;
                     break;
                 }
@@ -212,9 +222,11 @@ namespace dmRender
                 }
                 case COMMAND_TYPE_DISPATCH_COMPUTE:
                 {
+                    dmGraphics::BeginGpuScope(context, "DispatchCompute");
                     dmRender::DispatchCompute(render_context,
                         c->m_Operands[0], c->m_Operands[1], c->m_Operands[2], // group x,y,z
                         (dmRender::HNamedConstantBuffer) c->m_Operands[3]);
+                    dmGraphics::EndGpuScope(context);
                     break;
                 }
                 case COMMAND_TYPE_SET_RENDER_CAMERA:
@@ -228,6 +240,8 @@ namespace dmRender
                 }
             }
         }
+
+        dmGraphics::EndGpuScope(context);
     }
 
 }
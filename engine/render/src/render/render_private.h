@@ -18,9 +18,11 @@
 #include <string.h> // For memset
 
 #include <dmsdk/dlib/vmath.h>
+#include <dmsdk/dlib/intersection.h>
 #include <dlib/opaque_handle_container.h>
 
 #include <dlib/array.h>
+#include <dlib/atomic.h>
 #include <dlib/message.h>
 #include <dlib/hashtable.h>
 
@@ -124,12 +126,23 @@ namespace dmRender
         MAX_DEBUG_RENDER_TYPE_COUNT
     };
 
+    struct DebugVertex
+    {
+        Vector4 m_Position;
+        Vector4 m_Color;
+    };
+
     struct DebugRenderTypeData
     {
         dmRender::RenderObject  m_RenderObject;
-        void*                   m_ClientBuffer;
+        // Grows as needed, the vertex count of the render object is the used size
+        DebugVertex*            m_ClientBuffer;
+        uint32_t                m_Capacity;
     };
 
+    // The number of views that can draw the 3d debug data in a frame, and still be used for culling
+    static const uint32_t MAX_DEBUG_CULL_VIEW_COUNT = 4;
+
     struct DebugRenderer
     {
         DebugRenderTypeData             m_TypeData[MAX_DEBUG_RENDER_TYPE_COUNT];
@@ -138,8 +151,15 @@ namespace dmRender
         dmRender::HRenderContext        m_RenderContext;
         dmGraphics::HVertexBuffer       m_VertexBuffer;
         dmGraphics::HVertexDeclaration  m_VertexDeclaration;
-        uint32_t                        m_MaxVertexCount;
         uint32_t                        m_RenderBatchVersion;
+        // The views that drew the 3d debug data this frame
+        Matrix4                         m_DrawViewProj[MAX_DEBUG_CULL_VIEW_COUNT];
+        // The frustums of the views of the previous frame, that the batches are culled against
+        dmIntersection::Frustum         m_CullFrustums[MAX_DEBUG_CULL_VIEW_COUNT];
+        uint8_t                         m_DrawViewCount;
+        uint8_t                         m_CullFrustumCount;
+        // Set when there were more views than we keep track of, in which case nothing is culled
+        uint8_t                         m_DrawViewOverflow : 1;
     };
 
     const int MAX_TEXT_RENDER_CONSTANTS = 16;
@@ -148,6 +168,7 @@ namespace dmRender
     {
         StencilTestParams   m_StencilTestParams;
         Matrix4             m_Transform;
+        Vector4             m_ScissorRect;
         HConstant           m_RenderConstants[MAX_TEXT_RENDER_CONSTANTS];
         HFontMap            m_FontMap;
         HMaterial           m_Material;
@@ -172,6 +193,7 @@ namespace dmRender
         uint32_t            m_Align : 2;
         uint32_t            m_VAlign : 2;
         uint32_t            m_StencilTestParamsSet : 1;
+        uint32_t            m_ScissorSet : 1;
     };
 
     struct TextContext
@@ -220,8 +242,6 @@ namespace dmRender
                 uint32_t m_MajorOrder:4;        // currently only 2 bits used (dmRender::RenderOrder)
                 uint32_t m_MinorOrder:4;
             };
-            // only temporarily used
-            float m_ZW;
             // final sort value
             uint64_t m_SortKey;
         };
@@ -235,6 +255,39 @@ namespace dmRender
         uint32_t m_Skip:1;      // During the current draw call
     };
 
+    // The sorted render list of a previous draw call, reused when the same predicate is drawn again
+    // with the same view projection and frustum, and the render list hasn't changed
+    struct SortBufferCacheEntry
+    {
+        dmArray<uint32_t> m_Indices;
+        dmhash_t          m_Key;          // Hash of the predicate tags, view projection and frustum
+        uint32_t          m_Generation;   // The m_RenderListGeneration it was made from. 0 = unused
+        uint32_t          m_LastUsed;
+    };
+
+    const uint32_t SORT_BUFFER_CACHE_SIZE = 4;
+
+    // The culling result of a frustum, e.g. of each camera drawn from during the frame
+    struct VisibilityCacheEntry
+    {
+        dmArray<uint32_t> m_Visible;      // One bit per render list entry
+        dmhash_t          m_FrustumHash;
+        uint32_t          m_Generation;   // The m_RenderListGeneration it was made from. 0 = unused
+        uint32_t          m_LastUsed;
+    };
+
+    const uint32_t VISIBILITY_CACHE_SIZE = 4;
+
+    // Number of render list entries in each piece of work when splitting up the frustum culling
+    const uint32_t CULLING_ITEM_ENTRY_COUNT = 512;
+
+    struct CullingItem
+    {
+        uint32_t m_Start;       // Index into the renderlist
+        uint32_t m_Count;
+        uint8_t  m_Dispatch;
+    };
+
     struct MaterialTagList
     {
         uint32_t m_Count;
@@ -266,6 +319,74 @@ namespace dmRender
         uint8_t          m_Dirty : 1;
     };
 
+    // A run of consecutive render objects that are drawn with a single instanced draw call
+    struct InstanceRun
+    {
+        uint32_t m_First;        // Index of the first render object in the run
+        uint32_t m_Count;        // Number of render objects (instances) in the run
+        uint32_t m_Offset;       // Byte offset into the instance buffer
+        uint32_t m_BindingIndex; // Vertex buffer binding used for the instance data
+    };
+
+    static const uint32_t LIGHT_GRID_SIZE_X  = 16;
+    static const uint32_t LIGHT_GRID_SIZE_Y  = 9;
+    static const uint32_t LIGHT_GRID_SIZE_Z  = 24;
+    static const uint32_t LIGHT_GRID_CLUSTER_COUNT = LIGHT_GRID_SIZE_X * LIGHT_GRID_SIZE_Y * LIGHT_GRID_SIZE_Z;
+    static const uint32_t LIGHT_GRID_MAX_LIGHTS = 1024;
+
+    struct LightGridCluster
+    {
+        dmVMath::Vector3 m_Min; // View space bounds
+        dmVMath::Vector3 m_Max;
+        uint32_t         m_Offset; // Into the index list of the slice
+        uint32_t         m_Count;
+    };
+
+    // The lights sorted into a grid of clusters over the view frustum (see light_grid.cpp)
+    struct LightGrid
+    {
+        dmArray<LightGridLight>     m_Lights;
+        dmArray<dmVMath::Vector4>   m_ViewLights;       // The view space positions (w = range) of the lights
+        LightGridCluster            m_Clusters[LIGHT_GRID_CLUSTER_COUNT];
+        dmArray<uint16_t>           m_SliceIndices[LIGHT_GRID_SIZE_Z];
+        dmArray<float>              m_TextureData;
+        dmVMath::Matrix4            m_View;             // The matrices of the last build
+        dmVMath::Matrix4            m_Projection;
+        float                       m_SliceDepth[LIGHT_GRID_SIZE_Z + 1]; // View space depth of the slice planes
+        dmGraphics::HTexture        m_ClusterTexture;
+        dmGraphics::HTexture        m_IndexTexture;
+        dmGraphics::HTexture        m_LightTexture;
+        int32_atomic_t              m_NextSlice;
+        uint32_t                    m_Exponential : 1;  // If the depth slices are exponential (perspective projection)
+        uint32_t                    m_Dirty : 1;        // If the lights were changed since the last build
+        uint32_t                    m_Bound : 1;        // If the textures are bound
+    };
+
+    static const uint32_t OCCLUSION_BUFFER_WIDTH  = 256;
+    static const uint32_t OCCLUSION_BUFFER_HEIGHT = 128;
+    static const uint32_t OCCLUSION_BUFFER_LEVELS = 9; // Down to 1x1
+    static const uint32_t OCCLUSION_MAX_TRIANGLES = 32768; // Per frame, the rest of the occluders are ignored
+
+    struct Occluder
+    {
+        dmVMath::Matrix4    m_World;
+        const float*        m_Positions; // Local space xyz
+        const void*         m_Indices;
+        uint32_t            m_IndexCount;
+        uint32_t            m_Index32 : 1;
+    };
+
+    // The occluders rasterized on the CPU into a small depth buffer, with a pyramid of the max depth of each 2x2 texels (see occlusion.cpp)
+    struct OcclusionBuffer
+    {
+        dmArray<Occluder>   m_Occluders;
+        dmArray<float>      m_Depth;            // All the levels, level 0 first. Normalized device depth in [0, 1]
+        uint32_t            m_LevelOffset[OCCLUSION_BUFFER_LEVELS];
+        dmVMath::Matrix4    m_ViewProj;         // The matrix of the last build
+        uint32_t            m_TriangleCount;
+        uint32_t            m_Valid : 1;        // If there were any occluders in the last build
+    };
+
     struct RenderContext
     {
         DebugRenderer               m_DebugRenderer;
@@ -281,11 +402,30 @@ namespace dmRender
         dmArray<uint32_t>           m_RenderListSortBuffer;
         dmArray<uint32_t>           m_RenderListSortIndices;
         dmArray<RenderListRange>    m_RenderListRanges;         // Maps tagmask to a range in the (sorted) render list
+        dmArray<uint64_t>           m_RenderListSortKeys;       // Scratch keys for the radix sorts (2x the number of sorted entries)
+        dmArray<uint32_t>           m_RenderListSortScratch;    // Scratch indices for the radix sorts
+        dmArray<float>              m_RenderListDepthScratch;   // Positions (x, y, z arrays) of the world entries, while computing their depth
+        dmArray<uint32_t>           m_RenderListDepthIndices;   // The render list index of each position in m_RenderListDepthScratch
+        dmArray<CullingItem>        m_CullingItems;             // The frustum culling work, split into chunks
+        dmJobThread::HContext       m_JobThread;
+        int32_atomic_t              m_CullingNextItem;
         dmArray<TextureBinding>     m_TextureBindTable;
         dmhash_t                    m_FrustumHash;
+        SortBufferCacheEntry        m_SortBufferCache[SORT_BUFFER_CACHE_SIZE];
+        VisibilityCacheEntry        m_VisibilityCache[VISIBILITY_CACHE_SIZE];
+        uint32_t                    m_SortBufferCacheTick;
+        uint32_t                    m_RenderListGeneration;     // Changed whenever the render list is changed
+
+        HBufferedRenderBuffer       m_InstanceBuffer;           // Per-instance data for the automatically instanced render objects
+        dmArray<uint8_t>            m_InstanceBufferData;
+        dmArray<InstanceRun>        m_InstanceRuns;
+        uint32_t                    m_InstanceBufferDrawCount;  // Number of instance buffer uploads this frame
 
         dmHashTable32<MaterialTagList>  m_MaterialTagLists;
 
+        LightGrid                   m_LightGrid;
+        OcclusionBuffer             m_OcclusionBuffer;
+
         dmOpaqueHandleContainer<RenderCamera> m_RenderCameras;
         HRenderCamera                         m_CurrentRenderCamera; // When != 0, the renderer will use the matrices from this camera.
 
@@ -293,6 +433,7 @@ namespace dmRender
         Matrix4                     m_View;
         Matrix4                     m_Projection;
         Matrix4                     m_ViewProj;
+        int32_t                     m_Viewport[4];              // The last viewport (x, y, width, height) set by the render script. Zero width if not set
         dmGraphics::HContext        m_GraphicsContext;
         HMaterial                   m_Material;
         HComputeProgram             m_ComputeProgram;
@@ -301,6 +442,8 @@ namespace dmRender
         uint32_t                    m_StencilBufferCleared          : 1;
         uint32_t                    m_MultiBufferingRequired        : 1;
         uint32_t                    m_CurrentRenderCameraUseFrustum : 1;
+        uint32_t                    m_AutoInstancing                : 1;
+        uint32_t                    m_BufferMappingSupported        : 1;
     };
 
     struct BufferedRenderBuffer
@@ -310,6 +453,14 @@ namespace dmRender
         uint16_t               m_BufferIndex;
     };
 
+    void InitializeLightGrid(HRenderContext render_context);
+    void FinalizeLightGrid(HRenderContext render_context);
+    // Sorts the lights into the clusters of the current view and projection, and binds the grid
+    void UpdateLightGrid(HRenderContext render_context);
+
+    // Rasterizes the occluders of the frame with the matrix, for the visibility callbacks of the next culling
+    void BuildOcclusionBuffer(HRenderContext render_context, const dmVMath::Matrix4& view_proj);
+
     void RenderTypeTextBegin(HRenderContext rendercontext, void* user_context);
     void RenderTypeTextDraw(HRenderContext rendercontext, void* user_context, RenderObject* ro_, uint32_t count);
 
@@ -56,6 +56,8 @@ namespace dmRender
 
     #define RENDER_SCRIPT_PREDICATE "RenderScriptPredicate"
 
+    #define RENDER_SCRIPT_COMMAND_LIST "RenderScriptCommandList"
+
     #define RENDER_SCRIPT_LIB_NAME "render"
     #define RENDER_SCRIPT_FORMAT_NAME "format"
     #define RENDER_SCRIPT_WIDTH_NAME "width"
@@ -71,8 +73,13 @@ namespace dmRender
     static uint32_t RENDER_SCRIPT_CONSTANTBUFFER_TYPE_HASH = 0;
     static uint32_t RENDER_SCRIPT_PREDICATE_TYPE_HASH = 0;
     static uint32_t RENDER_SCRIPT_CONSTANTBUFFER_ARRAY_TYPE_HASH = 0;
+    static uint32_t RENDER_SCRIPT_COMMAND_LIST_TYPE_HASH = 0;
+
+    static uint32_t RENDER_SCRIPT_FLAG_TEXTURE_BIT    = 1;
+    static uint32_t RENDER_SCRIPT_FLAG_MEMORYLESS_BIT = 2;
 
-    static uint32_t RENDER_SCRIPT_FLAG_TEXTURE_BIT = 1;
+    // Number of frames an unused transient render target is kept in the pool
+    static const uint32_t TRANSIENT_RENDER_TARGET_MAX_IDLE_FRAMES = 4;
 
     const char* RENDER_SCRIPT_FUNCTION_NAMES[MAX_RENDER_SCRIPT_FUNCTION_COUNT] =
     {
@@ -360,6 +367,94 @@ namespace dmRender
         {0, 0}
     };
 
+    // The commands recorded with render.record(). The list owns the heap operands of its commands.
+    struct CommandList
+    {
+        dmArray<Command> m_Commands;
+    };
+
+    // Deletes the operands that ParseCommands() would have deleted
+    static void DeleteCommandOperands(const Command& command)
+    {
+        switch (command.m_Type)
+        {
+            case COMMAND_TYPE_SET_VIEW:
+            case COMMAND_TYPE_SET_PROJECTION:
+                delete (dmVMath::Matrix4*) command.m_Operands[0];
+                break;
+            case COMMAND_TYPE_DRAW:
+                delete (FrustumOptions*) command.m_Operands[2];
+                break;
+            case COMMAND_TYPE_DRAW_DEBUG3D:
+                delete (FrustumOptions*) command.m_Operands[0];
+                break;
+            default:
+                break;
+        }
+    }
+
+    // Copies the heap operands, so that the command can be passed to the command queue (which deletes them)
+    static void CloneCommandOperands(Command& command)
+    {
+        switch (command.m_Type)
+        {
+            case COMMAND_TYPE_SET_VIEW:
+            case COMMAND_TYPE_SET_PROJECTION:
+                command.m_Operands[0] = (uint64_t) new dmVMath::Matrix4(*(dmVMath::Matrix4*) command.m_Operands[0]);
+                break;
+            case COMMAND_TYPE_DRAW:
+                if (command.m_Operands[2])
+                    command.m_Operands[2] = (uint64_t) new FrustumOptions(*(FrustumOptions*) command.m_Operands[2]);
+                break;
+            case COMMAND_TYPE_DRAW_DEBUG3D:
+                if (command.m_Operands[0])
+                    command.m_Operands[0] = (uint64_t) new FrustumOptions(*(FrustumOptions*) command.m_Operands[0]);
+                break;
+            default:
+                break;
+        }
+    }
+
+    static CommandList** RenderScriptCommandList_Check(lua_State *L, int index)
+    {
+        return (CommandList**)dmScript::CheckUserType(L, index, RENDER_SCRIPT_COMMAND_LIST_TYPE_HASH, "Expected a command list (acquired from the render.record function)");
+    }
+
+    static int RenderScriptCommandList_gc (lua_State *L)
+    {
+        CommandList** p = (CommandList**)lua_touserdata(L, 1);
+        CommandList* list = *p;
+        if (list)
+        {
+            for (uint32_t i = 0; i < list->m_Commands.Size(); ++i)
+            {
+                DeleteCommandOperands(list->m_Commands[i]);
+            }
+            delete list;
+        }
+        *p = 0;
+        return 0;
+    }
+
+    static int RenderScriptCommandList_tostring (lua_State *L)
+    {
+        CommandList* list = *(CommandList**)lua_touserdata(L, 1);
+        lua_pushfstring(L, "CommandList: %p (%d commands)", list, list ? list->m_Commands.Size() : 0);
+        return 1;
+    }
+
+    static const luaL_reg RenderScriptCommandList_methods[] =
+    {
+        {0,0}
+    };
+
+    static const luaL_reg RenderScriptCommandList_meta[] =
+    {
+        {"__gc",        RenderScriptCommandList_gc},
+        {"__tostring",  RenderScriptCommandList_tostring},
+        {0, 0}
+    };
+
     /*# create a new constant buffer.
      *
      * Constant buffers are used to set shader program variables and are optionally passed to the `render.draw()` function.
@@ -735,161 +830,42 @@ namespace dmRender
             return luaL_error(L, "Command buffer is full (%d).", i->m_CommandBuffer.Capacity());
     }
 
-    /*# creates a new render target
-     * Creates a new render target according to the supplied
-     * specification table.
-     *
-     * The table should contain keys specifying which buffers should be created
-     * with what parameters. Each buffer key should have a table value consisting
-     * of parameters. The following parameter keys are available:
-     *
-     * Key                     | Values
-     * ----------------------- | ----------------------------
-     * `format`                |  `graphics.TEXTURE_FORMAT_LUMINANCE`<br/>`graphics.TEXTURE_FORMAT_RGB`<br/>`graphics.TEXTURE_FORMAT_RGBA`<br/>`graphics.TEXTURE_FORMAT_DEPTH`<br/>`graphics.TEXTURE_FORMAT_STENCIL`<br/>`graphics.TEXTURE_FORMAT_RGBA32F`<br/>`graphics.TEXTURE_FORMAT_RGBA16F`<br/>
-     * `width`                 | number
-     * `height`                | number
-     * `min_filter` (optional) | `graphics.TEXTURE_FILTER_LINEAR`<br/>`graphics.TEXTURE_FILTER_NEAREST`
-     * `mag_filter` (optional) | `graphics.TEXTURE_FILTER_LINEAR`<br/>`graphics.TEXTURE_FILTER_NEAREST`
-     * `u_wrap`     (optional) | `graphics.TEXTURE_WRAP_CLAMP_TO_BORDER`<br/>`graphics.TEXTURE_WRAP_CLAMP_TO_EDGE`<br/>`graphics.TEXTURE_WRAP_MIRRORED_REPEAT`<br/>`graphics.TEXTURE_WRAP_REPEAT`<br/>
-     * `v_wrap`     (optional) | `graphics.TEXTURE_WRAP_CLAMP_TO_BORDER`<br/>`graphics.TEXTURE_WRAP_CLAMP_TO_EDGE`<br/>`graphics.TEXTURE_WRAP_MIRRORED_REPEAT`<br/>`graphics.TEXTURE_WRAP_REPEAT`
-     * `flags`      (optional) | `render.TEXTURE_BIT` (only applicable to depth and stencil buffers)
-     *
-     * The render target can be created to support multiple color attachments. Each attachment can have different format settings and texture filters,
-     * but attachments must be added in sequence, meaning you cannot create a render target at slot 0 and 3.
-     * Instead it has to be created with all four buffer types ranging from [0..3] (as denoted by graphics.BUFFER_TYPE_COLORX_BIT where 'X' is the attachment you want to create).
-     * It is not guaranteed that the device running the script can support creating render targets with multiple color attachments. To check if the device can support multiple attachments,
-     * you can check if the `render` table contains any of the `BUFFER_TYPE_COLOR1_BIT`, `BUFFER_TYPE_COLOR2_BIT` or `BUFFER_TYPE_COLOR3_BIT` constants:
-     *
-     * ```lua
-     * function init(self)
-     *     if graphics.BUFFER_TYPE_COLOR1_BIT == nil then
-     *         -- this devices does not support multiple color attachments
-     *     end
-     * end
-     * ```
-     *
-     * @name render.render_target
-     * @param name [type:string] render target name
-     * @param parameters [type:table] table of buffer parameters, see the description for available keys and values
-     * @return render_target [type:render_target] new render target
-     * @examples
-     *
-     * How to create a new render target and draw to it:
-     *
-     * ```lua
-     * function init(self)
-     *     -- render target buffer parameters
-     *     local color_params = { format = graphics.TEXTURE_FORMAT_RGBA,
-     *                            width = render.get_window_width(),
-     *                            height = render.get_window_height(),
-     *                            min_filter = graphics.TEXTURE_FILTER_LINEAR,
-     *                            mag_filter = graphics.TEXTURE_FILTER_LINEAR,
-     *                            u_wrap = graphics.TEXTURE_WRAP_CLAMP_TO_EDGE,
-     *                            v_wrap = graphics.TEXTURE_WRAP_CLAMP_TO_EDGE }
-     *     local depth_params = { format = graphics.TEXTURE_FORMAT_DEPTH,
-     *                            width = render.get_window_width(),
-     *                            height = render.get_window_height(),
-     *                            u_wrap = graphics.TEXTURE_WRAP_CLAMP_TO_EDGE,
-     *                            v_wrap = graphics.TEXTURE_WRAP_CLAMP_TO_EDGE }
-     *     self.my_render_target = render.render_target({[graphics.BUFFER_TYPE_COLOR0_BIT] = color_params, [graphics.BUFFER_TYPE_DEPTH_BIT] = depth_params })
-     * end
-     *
-     * function update(self, dt)
-     *     -- enable target so all drawing is done to it
-     *     render.set_render_target(self.my_render_target)
-     *
-     *     -- draw a predicate to the render target
-     *     render.draw(self.my_pred)
-     * end
-     * ```
-     *
-     * How to create a render target with multiple outputs:
-     *
-     * ```lua
-     * function init(self)
-     *     -- render target buffer parameters
-     *     local color_params_rgba = { format = graphics.TEXTURE_FORMAT_RGBA,
-     *                                 width = render.get_window_width(),
-     *                                 height = render.get_window_height(),
-     *                                 min_filter = graphics.TEXTURE_FILTER_LINEAR,
-     *                                 mag_filter = graphics.TEXTURE_FILTER_LINEAR,
-     *                                 u_wrap = graphics.TEXTURE_WRAP_CLAMP_TO_EDGE,
-     *                                 v_wrap = graphics.TEXTURE_WRAP_CLAMP_TO_EDGE }
-     *     local color_params_float = { format = graphics.TEXTURE_FORMAT_RG32F,
-     *                            width = render.get_window_width(),
-     *                            height = render.get_window_height(),
-     *                            min_filter = graphics.TEXTURE_FILTER_LINEAR,
-     *                            mag_filter = graphics.TEXTURE_FILTER_LINEAR,
-     *                            u_wrap = graphics.TEXTURE_WRAP_CLAMP_TO_EDGE,
-     *                            v_wrap = graphics.TEXTURE_WRAP_CLAMP_TO_EDGE }
-     *
-     *
-     *     -- Create a render target with three color attachments
-     *     -- Note: No depth buffer is attached here
-     *     self.my_render_target = render.render_target({
-     *            [graphics.BUFFER_TYPE_COLOR0_BIT] = color_params_rgba,
-     *            [graphics.BUFFER_TYPE_COLOR1_BIT] = color_params_rgba,
-     *            [graphics.BUFFER_TYPE_COLOR2_BIT] = color_params_float, })
-     * end
-     *
-     * function update(self, dt)
-     *     -- enable target so all drawing is done to it
-     *     render.enable_render_target(self.my_render_target)
-     *
-     *     -- draw a predicate to the render target
-     *     render.draw(self.my_pred)
-     * end
-     * ```
-     *
-     */
-    int RenderScript_RenderTarget(lua_State* L)
+    static int CheckRenderTargetParams(lua_State* L, RenderScriptInstance* i, int table_index, uint32_t* buffer_type_flags, dmGraphics::RenderTargetCreationParams* params)
     {
         int top = lua_gettop(L);
         (void)top;
 
-        RenderScriptInstance* i = RenderScriptInstance_Check(L);
-
-        // Legacy support
-        int table_index = 2;
-        if (lua_istable(L, 1))
-        {
-            table_index = 1;
-        }
-
         const char* required_keys[] = { "format", "width", "height" };
-        uint32_t buffer_type_flags = 0;
         uint32_t max_tex_size = dmGraphics::GetMaxTextureSize(i->m_RenderContext->m_GraphicsContext);
         luaL_checktype(L, table_index, LUA_TTABLE);
 
-        dmGraphics::RenderTargetCreationParams params = {};
-
         lua_pushnil(L);
         while (lua_next(L, table_index))
         {
             bool required_found[]                 = { false, false, false };
             dmGraphics::BufferType buffer_type    = CheckBufferType(L, -2);
-            buffer_type_flags                    |= (uint32_t) buffer_type;
+            *buffer_type_flags                   |= (uint32_t) buffer_type;
             dmGraphics::TextureParams* p          = 0;
             dmGraphics::TextureCreationParams* cp = 0;
 
             if (dmGraphics::IsColorBufferType(buffer_type))
             {
                 uint32_t color_index = dmGraphics::GetBufferTypeIndex(buffer_type);
-                p  = &params.m_ColorBufferParams[color_index];
-                cp = &params.m_ColorBufferCreationParams[color_index];
+                p  = &params->m_ColorBufferParams[color_index];
+                cp = &params->m_ColorBufferCreationParams[color_index];
 
-                params.m_ColorBufferLoadOps[color_index]  = dmGraphics::ATTACHMENT_OP_DONT_CARE;
-                params.m_ColorBufferStoreOps[color_index] = dmGraphics::ATTACHMENT_OP_STORE;
+                params->m_ColorBufferLoadOps[color_index]  = dmGraphics::ATTACHMENT_OP_DONT_CARE;
+                params->m_ColorBufferStoreOps[color_index] = dmGraphics::ATTACHMENT_OP_STORE;
             }
             else if (buffer_type == dmGraphics::BUFFER_TYPE_DEPTH_BIT)
             {
-                p  = &params.m_DepthBufferParams;
-                cp = &params.m_DepthBufferCreationParams;
+                p  = &params->m_DepthBufferParams;
+                cp = &params->m_DepthBufferCreationParams;
             }
             else if (buffer_type == dmGraphics::BUFFER_TYPE_STENCIL_BIT)
             {
-                p  = &params.m_StencilBufferParams;
-                cp = &params.m_StencilBufferCreationParams;
+                p  = &params->m_StencilBufferParams;
+                cp = &params->m_StencilBufferCreationParams;
             }
             else
             {
@@ -976,9 +952,22 @@ namespace dmRender
                 else if (strncmp(key, RENDER_SCRIPT_FLAGS_NAME, strlen(RENDER_SCRIPT_FLAGS_NAME)) == 0)
                 {
                     int flags = luaL_checkinteger(L, -1);
+                    if (flags & RENDER_SCRIPT_FLAG_MEMORYLESS_BIT)
+                    {
+                        if (buffer_type != dmGraphics::BUFFER_TYPE_DEPTH_BIT && buffer_type != dmGraphics::BUFFER_TYPE_STENCIL_BIT)
+                        {
+                            return luaL_error(L, "Only depth and stencil buffers can be memoryless.");
+                        }
+                        if (flags & RENDER_SCRIPT_FLAG_TEXTURE_BIT)
+                        {
+                            return luaL_error(L, "A memoryless buffer cannot be sampled as a texture.");
+                        }
+                        // Never stored, so it only needs (lazily allocated) tile memory where supported
+                        cp->m_UsageHintBits = dmGraphics::TEXTURE_USAGE_FLAG_MEMORYLESS;
+                    }
                     if (buffer_type == dmGraphics::BUFFER_TYPE_DEPTH_BIT)
                     {
-                        params.m_DepthTexture = flags & RENDER_SCRIPT_FLAG_TEXTURE_BIT;
+                        params->m_DepthTexture = flags & RENDER_SCRIPT_FLAG_TEXTURE_BIT;
                     }
                     else if (buffer_type == dmGraphics::BUFFER_TYPE_STENCIL_BIT && flags & RENDER_SCRIPT_FLAG_TEXTURE_BIT)
                     {
@@ -1013,6 +1002,137 @@ namespace dmRender
             }
         }
 
+        return 0;
+    }
+
+    /*# creates a new render target
+     * Creates a new render target according to the supplied
+     * specification table.
+     *
+     * The table should contain keys specifying which buffers should be created
+     * with what parameters. Each buffer key should have a table value consisting
+     * of parameters. The following parameter keys are available:
+     *
+     * Key                     | Values
+     * ----------------------- | ----------------------------
+     * `format`                |  `graphics.TEXTURE_FORMAT_LUMINANCE`<br/>`graphics.TEXTURE_FORMAT_RGB`<br/>`graphics.TEXTURE_FORMAT_RGBA`<br/>`graphics.TEXTURE_FORMAT_DEPTH`<br/>`graphics.TEXTURE_FORMAT_STENCIL`<br/>`graphics.TEXTURE_FORMAT_RGBA32F`<br/>`graphics.TEXTURE_FORMAT_RGBA16F`<br/>
+     * `width`                 | number
+     * `height`                | number
+     * `min_filter` (optional) | `graphics.TEXTURE_FILTER_LINEAR`<br/>`graphics.TEXTURE_FILTER_NEAREST`
+     * `mag_filter` (optional) | `graphics.TEXTURE_FILTER_LINEAR`<br/>`graphics.TEXTURE_FILTER_NEAREST`
+     * `u_wrap`     (optional) | `graphics.TEXTURE_WRAP_CLAMP_TO_BORDER`<br/>`graphics.TEXTURE_WRAP_CLAMP_TO_EDGE`<br/>`graphics.TEXTURE_WRAP_MIRRORED_REPEAT`<br/>`graphics.TEXTURE_WRAP_REPEAT`<br/>
+     * `v_wrap`     (optional) | `graphics.TEXTURE_WRAP_CLAMP_TO_BORDER`<br/>`graphics.TEXTURE_WRAP_CLAMP_TO_EDGE`<br/>`graphics.TEXTURE_WRAP_MIRRORED_REPEAT`<br/>`graphics.TEXTURE_WRAP_REPEAT`
+     * `flags`      (optional) | `render.TEXTURE_BIT`<br/>`render.MEMORYLESS_BIT` (only applicable to depth and stencil buffers)
+     *
+     * A depth or stencil buffer that is never sampled can be created with `render.MEMORYLESS_BIT`, which lets tile based GPUs keep
+     * it in tile memory only (lazily allocated). The flag is a hint, and is ignored where it isn't supported.
+     *
+     * The render target can be created to support multiple color attachments. Each attachment can have different format settings and texture filters,
+     * but attachments must be added in sequence, meaning you cannot create a render target at slot 0 and 3.
+     * Instead it has to be created with all four buffer types ranging from [0..3] (as denoted by graphics.BUFFER_TYPE_COLORX_BIT where 'X' is the attachment you want to create).
+     * It is not guaranteed that the device running the script can support creating render targets with multiple color attachments. To check if the device can support multiple attachments,
+     * you can check if the `render` table contains any of the `BUFFER_TYPE_COLOR1_BIT`, `BUFFER_TYPE_COLOR2_BIT` or `BUFFER_TYPE_COLOR3_BIT` constants:
+     *
+     * ```lua
+     * function init(self)
+     *     if graphics.BUFFER_TYPE_COLOR1_BIT == nil then
+     *         -- this devices does not support multiple color attachments
+     *     end
+     * end
+     * ```
+     *
+     * @name render.render_target
+     * @param name [type:string] render target name
+     * @param parameters [type:table] table of buffer parameters, see the description for available keys and values
+     * @return render_target [type:render_target] new render target
+     * @examples
+     *
+     * How to create a new render target and draw to it:
+     *
+     * ```lua
+     * function init(self)
+     *     -- render target buffer parameters
+     *     local color_params = { format = graphics.TEXTURE_FORMAT_RGBA,
+     *                            width = render.get_window_width(),
+     *                            height = render.get_window_height(),
+     *                            min_filter = graphics.TEXTURE_FILTER_LINEAR,
+     *                            mag_filter = graphics.TEXTURE_FILTER_LINEAR,
+     *                            u_wrap = graphics.TEXTURE_WRAP_CLAMP_TO_EDGE,
+     *                            v_wrap = graphics.TEXTURE_WRAP_CLAMP_TO_EDGE }
+     *     local depth_params = { format = graphics.TEXTURE_FORMAT_DEPTH,
+     *                            width = render.get_window_width(),
+     *                            height = render.get_window_height(),
+     *                            u_wrap = graphics.TEXTURE_WRAP_CLAMP_TO_EDGE,
+     *                            v_wrap = graphics.TEXTURE_WRAP_CLAMP_TO_EDGE }
+     *     self.my_render_target = render.render_target({[graphics.BUFFER_TYPE_COLOR0_BIT] = color_params, [graphics.BUFFER_TYPE_DEPTH_BIT] = depth_params })
+     * end
+     *
+     * function update(self, dt)
+     *     -- enable target so all drawing is done to it
+     *     render.set_render_target(self.my_render_target)
+     *
+     *     -- draw a predicate to the render target
+     *     render.draw(self.my_pred)
+     * end
+     * ```
+     *
+     * How to create a render target with multiple outputs:
+     *
+     * ```lua
+     * function init(self)
+     *     -- render target buffer parameters
+     *     local color_params_rgba = { format = graphics.TEXTURE_FORMAT_RGBA,
+     *                                 width = render.get_window_width(),
+     *                                 height = render.get_window_height(),
+     *                                 min_filter = graphics.TEXTURE_FILTER_LINEAR,
+     *                                 mag_filter = graphics.TEXTURE_FILTER_LINEAR,
+     *                                 u_wrap = graphics.TEXTURE_WRAP_CLAMP_TO_EDGE,
+     *                                 v_wrap = graphics.TEXTURE_WRAP_CLAMP_TO_EDGE }
+     *     local color_params_float = { format = graphics.TEXTURE_FORMAT_RG32F,
+     *                            width = render.get_window_width(),
+     *                            height = render.get_window_height(),
+     *                            min_filter = graphics.TEXTURE_FILTER_LINEAR,
+     *                            mag_filter = graphics.TEXTURE_FILTER_LINEAR,
+     *                            u_wrap = graphics.TEXTURE_WRAP_CLAMP_TO_EDGE,
+     *                            v_wrap = graphics.TEXTURE_WRAP_CLAMP_TO_EDGE }
+     *
+     *
+     *     -- Create a render target with three color attachments
+     *     -- Note: No depth buffer is attached here
+     *     self.my_render_target = render.render_target({
+     *            [graphics.BUFFER_TYPE_COLOR0_BIT] = color_params_rgba,
+     *            [graphics.BUFFER_TYPE_COLOR1_BIT] = color_params_rgba,
+     *            [graphics.BUFFER_TYPE_COLOR2_BIT] = color_params_float, })
+     * end
+     *
+     * function update(self, dt)
+     *     -- enable target so all drawing is done to it
+     *     render.enable_render_target(self.my_render_target)
+     *
+     *     -- draw a predicate to the render target
+     *     render.draw(self.my_pred)
+     * end
+     * ```
+     *
+     */
+    int RenderScript_RenderTarget(lua_State* L)
+    {
+        int top = lua_gettop(L);
+        (void)top;
+
+        RenderScriptInstance* i = RenderScriptInstance_Check(L);
+
+        // Legacy support
+        int table_index = 2;
+        if (lua_istable(L, 1))
+        {
+            table_index = 1;
+        }
+
+        uint32_t buffer_type_flags = 0;
+        dmGraphics::RenderTargetCreationParams params = {};
+        CheckRenderTargetParams(L, i, table_index, &buffer_type_flags, &params);
+
         dmGraphics::HRenderTarget render_target = dmGraphics::NewRenderTarget(i->m_RenderContext->m_GraphicsContext, buffer_type_flags, params);
         assert(dmGraphics::GetAssetType(render_target) == dmGraphics::ASSET_TYPE_RENDER_TARGET);
 
@@ -1081,6 +1201,52 @@ namespace dmRender
         return luaL_error(L, "Invalid render target.");;
     }
 
+    static uint64_t HashRenderTargetParams(uint32_t buffer_type_flags, const dmGraphics::RenderTargetCreationParams& params)
+    {
+        HashState64 state;
+        dmHashInit64(&state, false);
+        dmHashUpdateBuffer64(&state, &buffer_type_flags, sizeof(buffer_type_flags));
+
+        const dmGraphics::TextureParams* buffer_params[dmGraphics::MAX_BUFFER_COLOR_ATTACHMENTS + 2];
+        const dmGraphics::TextureCreationParams* buffer_creation_params[dmGraphics::MAX_BUFFER_COLOR_ATTACHMENTS + 2];
+        for (uint32_t i = 0; i < dmGraphics::MAX_BUFFER_COLOR_ATTACHMENTS; ++i)
+        {
+            buffer_params[i]          = &params.m_ColorBufferParams[i];
+            buffer_creation_params[i] = &params.m_ColorBufferCreationParams[i];
+        }
+        buffer_params[dmGraphics::MAX_BUFFER_COLOR_ATTACHMENTS]              = &params.m_DepthBufferParams;
+        buffer_creation_params[dmGraphics::MAX_BUFFER_COLOR_ATTACHMENTS]     = &params.m_DepthBufferCreationParams;
+        buffer_params[dmGraphics::MAX_BUFFER_COLOR_ATTACHMENTS + 1]          = &params.m_StencilBufferParams;
+        buffer_creation_params[dmGraphics::MAX_BUFFER_COLOR_ATTACHMENTS + 1] = &params.m_StencilBufferCreationParams;
+
+        // Hash the fields one by one, the structs have padding
+        for (uint32_t i = 0; i < DM_ARRAY_SIZE(buffer_params); ++i)
+        {
+            const dmGraphics::TextureParams* p          = buffer_params[i];
+            const dmGraphics::TextureCreationParams* cp = buffer_creation_params[i];
+            uint32_t key[] = { (uint32_t) p->m_Format, cp->m_Width, cp->m_Height, (uint32_t) p->m_MinFilter, (uint32_t) p->m_MagFilter,
+                               (uint32_t) p->m_UWrap, (uint32_t) p->m_VWrap, cp->m_UsageHintBits };
+            dmHashUpdateBuffer64(&state, key, sizeof(key));
+        }
+
+        uint32_t depth_texture = params.m_DepthTexture;
+        dmHashUpdateBuffer64(&state, &depth_texture, sizeof(depth_texture));
+        return dmHashFinal64(&state);
+    }
+
+    static TransientRenderTarget* FindTransientRenderTarget(RenderScriptInstance* i, dmGraphics::HRenderTarget render_target)
+    {
+        dmArray<TransientRenderTarget>& pool = i->m_TransientRenderTargets;
+        for (uint32_t j = 0; j < pool.Size(); ++j)
+        {
+            if (pool[j].m_RenderTarget == render_target)
+            {
+                return &pool[j];
+            }
+        }
+        return 0;
+    }
+
     /*# deletes a render target
      *
      * Deletes a render target created by a render script.
@@ -1105,10 +1271,154 @@ namespace dmRender
 
         RenderScriptInstance* i = RenderScriptInstance_Check(L);
         dmGraphics::HRenderTarget render_target = (dmGraphics::HRenderTarget) CheckAssetHandle(L, 1, i->m_RenderContext->m_GraphicsContext, dmGraphics::ASSET_TYPE_RENDER_TARGET);
+        if (FindTransientRenderTarget(i, render_target))
+        {
+            return luaL_error(L, "Transient render targets are owned by the pool, use %s.release_transient_render_target instead.", RENDER_SCRIPT_LIB_NAME);
+        }
         dmGraphics::DeleteRenderTarget(render_target);
         return 0;
     }
 
+    /*# acquires a transient render target from the pool
+     *
+     * Acquires a render target for use during the current frame only. The render targets are pooled by their
+     * specification, so a render target that was released earlier (in the same frame or a previous one) is reused
+     * instead of creating a new one. This lets e.g. the passes of a post processing chain share their intermediate targets.
+     *
+     * The contents of an acquired render target are undefined. The render target is released automatically when
+     * the `update` function returns, but releasing it as soon as it's no longer needed lets later passes reuse it within the frame.
+     * Render targets that haven't been used for a few frames are deleted.
+     *
+     * @name render.acquire_transient_render_target
+     * @param parameters [type:table] table of buffer parameters, see [ref:render.render_target]
+     * @return render_target [type:render_target] the render target
+     * @examples
+     *
+     * A blur pass, where the second target may be the first one reused:
+     *
+     * ```lua
+     * function update(self)
+     *     local params = { [graphics.BUFFER_TYPE_COLOR0_BIT] = { format = graphics.TEXTURE_FORMAT_RGBA, width = 256, height = 256 } }
+     *
+     *     local horizontal = render.acquire_transient_render_target(params)
+     *     render.set_render_target(horizontal)
+     *     -- draw the horizontal blur
+     *
+     *     local vertical = render.acquire_transient_render_target(params)
+     *     render.set_render_target(vertical)
+     *     render.enable_texture(0, horizontal, graphics.BUFFER_TYPE_COLOR0_BIT)
+     *     -- draw the vertical blur
+     *     render.release_transient_render_target(horizontal)
+     *     ...
+     * end
+     * ```
+     */
+    int RenderScript_AcquireTransientRenderTarget(lua_State* L)
+    {
+        int top = lua_gettop(L);
+        (void)top;
+
+        RenderScriptInstance* i = RenderScriptInstance_Check(L);
+
+        uint32_t buffer_type_flags = 0;
+        dmGraphics::RenderTargetCreationParams params = {};
+        CheckRenderTargetParams(L, i, 1, &buffer_type_flags, &params);
+
+        uint64_t key = HashRenderTargetParams(buffer_type_flags, params);
+
+        dmArray<TransientRenderTarget>& pool = i->m_TransientRenderTargets;
+        for (uint32_t j = 0; j < pool.Size(); ++j)
+        {
+            TransientRenderTarget& entry = pool[j];
+            if (!entry.m_InUse && entry.m_Key == key)
+            {
+                entry.m_InUse         = 1;
+                entry.m_LastUsedFrame = i->m_FrameIndex;
+                lua_pushnumber(L, entry.m_RenderTarget);
+                assert(top + 1 == lua_gettop(L));
+                return 1;
+            }
+        }
+
+        dmGraphics::HRenderTarget render_target = dmGraphics::NewRenderTarget(i->m_RenderContext->m_GraphicsContext, buffer_type_flags, params);
+        if (render_target == 0)
+        {
+            return luaL_error(L, "Unable to create render target.");
+        }
+
+        if (pool.Full())
+        {
+            pool.OffsetCapacity(8);
+        }
+
+        TransientRenderTarget entry;
+        entry.m_RenderTarget  = render_target;
+        entry.m_Key           = key;
+        entry.m_LastUsedFrame = i->m_FrameIndex;
+        entry.m_InUse         = 1;
+        pool.Push(entry);
+
+        lua_pushnumber(L, render_target);
+        assert(top + 1 == lua_gettop(L));
+        return 1;
+    }
+
+    /*# releases a transient render target back to the pool
+     *
+     * Returns a render target acquired with [ref:render.acquire_transient_render_target] to the pool,
+     * so that it can be reused by later passes. The render target must not be used after it's released.
+     *
+     * @name render.release_transient_render_target
+     * @param render_target [type:render_target] the render target to release
+     */
+    int RenderScript_ReleaseTransientRenderTarget(lua_State* L)
+    {
+        RenderScriptInstance* i = RenderScriptInstance_Check(L);
+        dmGraphics::HRenderTarget render_target = (dmGraphics::HRenderTarget) CheckAssetHandle(L, 1, i->m_RenderContext->m_GraphicsContext, dmGraphics::ASSET_TYPE_RENDER_TARGET);
+
+        TransientRenderTarget* entry = FindTransientRenderTarget(i, render_target);
+        if (entry == 0)
+        {
+            return luaL_error(L, "The render target wasn't acquired with %s.acquire_transient_render_target.", RENDER_SCRIPT_LIB_NAME);
+        }
+        if (!entry->m_InUse)
+        {
+            return luaL_error(L, "The transient render target has already been released.");
+        }
+        entry->m_InUse = 0;
+        return 0;
+    }
+
+    // Called when the frame's commands have been dispatched
+    static void UpdateTransientRenderTargets(RenderScriptInstance* i)
+    {
+        dmArray<TransientRenderTarget>& pool = i->m_TransientRenderTargets;
+        uint32_t j = 0;
+        while (j < pool.Size())
+        {
+            TransientRenderTarget& entry = pool[j];
+            entry.m_InUse = 0;
+            if (i->m_FrameIndex - entry.m_LastUsedFrame >= TRANSIENT_RENDER_TARGET_MAX_IDLE_FRAMES)
+            {
+                dmGraphics::DeleteRenderTarget(entry.m_RenderTarget);
+                pool.EraseSwap(j);
+                continue;
+            }
+            ++j;
+        }
+        i->m_FrameIndex++;
+    }
+
+    static void DeleteTransientRenderTargets(RenderScriptInstance* i)
+    {
+        dmArray<TransientRenderTarget>& pool = i->m_TransientRenderTargets;
+        for (uint32_t j = 0; j < pool.Size(); ++j)
+        {
+            dmGraphics::DeleteRenderTarget(pool[j].m_RenderTarget);
+        }
+        pool.SetSize(0);
+    }
+
     /*#
      * @name render.RENDER_TARGET_DEFAULT
      * @variable
@@ -2587,6 +2897,149 @@ namespace dmRender
         return 1;
     }
 
+    /*# records a list of render commands
+     * Calls the function and records the render commands it issues into a command list, instead of
+     * adding them to the frame. The list can then be replayed each frame with `render.execute()`,
+     * which is much cheaper than issuing the same commands from Lua again.
+     *
+     * Only the commands are recorded. Functions that take effect immediately (e.g. `render.render_target()`
+     * or `render.set_render_target_size()`) are run once, while recording.
+     *
+     * The predicates, constant buffers, render targets and materials used by the commands are referenced,
+     * not copied. Changing the values of a constant buffer will affect the next replay of the list, and
+     * they must be kept alive (e.g. stored in `self`) for as long as the list is used.
+     *
+     * @name render.record
+     * @param func [type:function] the function issuing the render commands
+     * @return list [type:command_list] the recorded command list
+     * @examples
+     *
+     * Record the drawing of the tiles and sprites once, and replay it every frame:
+     *
+     * ```lua
+     * function init(self)
+     *     self.tile_pred = render.predicate({"tile"})
+     *     self.draw_world = render.record(function()
+     *         render.set_depth_mask(false)
+     *         render.enable_state(graphics.STATE_BLEND)
+     *         render.draw(self.tile_pred)
+     *         render.disable_state(graphics.STATE_BLEND)
+     *     end)
+     * end
+     *
+     * function update(self)
+     *     render.execute(self.draw_world)
+     * end
+     * ```
+     */
+    static int RenderScript_Record(lua_State* L)
+    {
+        int top = lua_gettop(L);
+        (void) top;
+
+        RenderScriptInstance* i = RenderScriptInstance_Check(L);
+        luaL_checktype(L, 1, LUA_TFUNCTION);
+
+        dmArray<Command>& buffer = i->m_CommandBuffer;
+        uint32_t start = buffer.Size();
+
+        lua_pushvalue(L, 1);
+        if (lua_pcall(L, 0, 0, 0) != 0)
+        {
+            // Don't leave a partial recording in the frame
+            for (uint32_t c = start; c < buffer.Size(); ++c)
+            {
+                DeleteCommandOperands(buffer[c]);
+            }
+            buffer.SetSize(start);
+            return lua_error(L);
+        }
+
+        CommandList* list = new CommandList;
+        uint32_t count = buffer.Size() - start;
+        if (count > 0)
+        {
+            list->m_Commands.SetCapacity(count);
+            list->m_Commands.PushArray(&buffer[start], count);
+        }
+        buffer.SetSize(start);
+
+        CommandList** p_list = (CommandList**) lua_newuserdata(L, sizeof(CommandList*));
+        *p_list = list;
+        luaL_getmetatable(L, RENDER_SCRIPT_COMMAND_LIST);
+        lua_setmetatable(L, -2);
+
+        assert(top + 1 == lua_gettop(L));
+        return 1;
+    }
+
+    /*# replays a recorded list of render commands
+     * Adds the commands of a list recorded with `render.record()` to the frame.
+     *
+     * @name render.execute
+     * @param list [type:command_list] the command list to replay
+     * @param [options] [type:table] optional table with properties, replacing the matrices recorded in the list:
+     *
+     * `view`
+     * : [type:matrix4] The matrix to use for every `render.set_view()` in the list.
+     *
+     * `projection`
+     * : [type:matrix4] The matrix to use for every `render.set_projection()` in the list.
+     *
+     * @examples
+     *
+     * ```lua
+     * function update(self)
+     *     render.execute(self.draw_world, { view = self.view, projection = self.projection })
+     * end
+     * ```
+     */
+    static int RenderScript_Execute(lua_State* L)
+    {
+        DM_LUA_STACK_CHECK(L, 0);
+
+        RenderScriptInstance* i = RenderScriptInstance_Check(L);
+        CommandList* list = *RenderScriptCommandList_Check(L, 1);
+        if (!list)
+        {
+            return DM_LUA_ERROR("The command list has been deleted");
+        }
+
+        dmVMath::Matrix4* view = 0;
+        dmVMath::Matrix4* projection = 0;
+        if (lua_istable(L, 2))
+        {
+            lua_getfield(L, 2, "view");
+            view = lua_isnil(L, -1) ? 0 : dmScript::CheckMatrix4(L, -1);
+            lua_pop(L, 1);
+
+            lua_getfield(L, 2, "projection");
+            projection = lua_isnil(L, -1) ? 0 : dmScript::CheckMatrix4(L, -1);
+            lua_pop(L, 1);
+        }
+
+        dmArray<Command>& buffer = i->m_CommandBuffer;
+        uint32_t count = list->m_Commands.Size();
+        if (buffer.Remaining() < count)
+        {
+            return DM_LUA_ERROR("Command buffer is full (%d).", buffer.Capacity());
+        }
+
+        for (uint32_t c = 0; c < count; ++c)
+        {
+            Command command = list->m_Commands[c];
+            if (view && command.m_Type == COMMAND_TYPE_SET_VIEW)
+                command.m_Operands[0] = (uint64_t) view;
+            else if (projection && command.m_Type == COMMAND_TYPE_SET_PROJECTION)
+                command.m_Operands[0] = (uint64_t) projection;
+
+            // The command queue deletes the operands after use
+            CloneCommandOperands(command);
+            buffer.Push(command);
+        }
+        return 0;
+    }
+
     /*# enables a material
      * If another material was already enabled, it will be automatically disabled
      * and the specified material is used instead.
@@ -2876,6 +3329,8 @@ namespace dmRender
         {"disable_state",                   RenderScript_DisableState},
         {"render_target",                   RenderScript_RenderTarget},
         {"delete_render_target",            RenderScript_DeleteRenderTarget},
+        {"acquire_transient_render_target", RenderScript_AcquireTransientRenderTarget},
+        {"release_transient_render_target", RenderScript_ReleaseTransientRenderTarget},
         {"set_render_target",               RenderScript_SetRenderTarget},
         {"enable_render_target",            RenderScript_EnableRenderTarget},
         {"disable_render_target",           RenderScript_DisableRenderTarget},
@@ -2905,6 +3360,8 @@ namespace dmRender
         {"get_window_width",                RenderScript_GetWindowWidth},
         {"get_window_height",               RenderScript_GetWindowHeight},
         {"predicate",                       RenderScript_Predicate},
+        {"record",                          RenderScript_Record},
+        {"execute",                         RenderScript_Execute},
         {"constant_buffer",                 RenderScript_ConstantBuffer},
         {"enable_material",                 RenderScript_EnableMaterial},
         {"disable_material",                RenderScript_DisableMaterial},
@@ -2934,6 +3391,8 @@ namespace dmRender
 
         RENDER_SCRIPT_CONSTANTBUFFER_ARRAY_TYPE_HASH = dmScript::RegisterUserType(L, RENDER_SCRIPT_CONSTANTBUFFER_ARRAY, RenderScriptConstantBuffer_methods, RenderScriptConstantBufferArray_meta);
 
+        RENDER_SCRIPT_COMMAND_LIST_TYPE_HASH = dmScript::RegisterUserType(L, RENDER_SCRIPT_COMMAND_LIST, RenderScriptCommandList_methods, RenderScriptCommandList_meta);
+
         luaL_register(L, RENDER_SCRIPT_LIB_NAME, Render_methods);
 
         ////////////////////////////////////////////////////////////////////
@@ -3094,9 +3553,11 @@ namespace dmRender
 
 #undef REGISTER_FRUSTUM_PLANES_CONSTANT
 
-        // Flags (only flag here currently, so no need for an enum)
+        // Flags
         lua_pushnumber(L, RENDER_SCRIPT_FLAG_TEXTURE_BIT);
         lua_setfield(L, -2, "TEXTURE_BIT");
+        lua_pushnumber(L, RENDER_SCRIPT_FLAG_MEMORYLESS_BIT);
+        lua_setfield(L, -2, "MEMORYLESS_BIT");
 
         lua_pop(L, 1);
 
@@ -3290,6 +3751,7 @@ bail:
         for (uint32_t i = 0; i < render_script_instance->m_PredicateCount; ++i) {
             delete render_script_instance->m_Predicates[i];
         }
+        DeleteTransientRenderTargets(render_script_instance);
         render_script_instance->~RenderScriptInstance();
         ResetRenderScriptInstance(render_script_instance);
     }
@@ -3483,6 +3945,8 @@ bail:
 
         if (instance->m_CommandBuffer.Size() > 0)
             ParseCommands(instance->m_RenderContext, &instance->m_CommandBuffer.Front(), instance->m_CommandBuffer.Size());
+
+        UpdateTransientRenderTargets(instance);
         return result;
     }
 
@@ -54,18 +54,30 @@ namespace dmRender
     };
 
     static const uint32_t MAX_PREDICATE_COUNT = 64;
+
+    // A render target from render.acquire_transient_render_target()
+    struct TransientRenderTarget
+    {
+        dmGraphics::HRenderTarget m_RenderTarget;
+        uint64_t                  m_Key; // Hash of the creation parameters
+        uint32_t                  m_LastUsedFrame;
+        uint8_t                   m_InUse : 1;
+    };
+
     struct RenderScriptInstance
     {
-        dmArray<Command>              m_CommandBuffer;
-        dmHashTable64<RenderResource> m_RenderResources;
-        Predicate*                    m_Predicates[MAX_PREDICATE_COUNT];
-        RenderContext*                m_RenderContext;
-        HRenderScript                 m_RenderScript;
-        dmScript::ScriptWorld*        m_ScriptWorld;
-        uint32_t                      m_PredicateCount;
-        int                           m_InstanceReference;
-        int                           m_RenderScriptDataReference;
-        int                           m_ContextTableReference;
+        dmArray<Command>               m_CommandBuffer;
+        dmHashTable64<RenderResource>  m_RenderResources;
+        dmArray<TransientRenderTarget> m_TransientRenderTargets;
+        Predicate*                     m_Predicates[MAX_PREDICATE_COUNT];
+        RenderContext*                 m_RenderContext;
+        HRenderScript                  m_RenderScript;
+        dmScript::ScriptWorld*         m_ScriptWorld;
+        uint32_t                       m_PredicateCount;
+        uint32_t                       m_FrameIndex; // Counts the updates, for the transient render target pool
+        int                            m_InstanceReference;
+        int                            m_RenderScriptDataReference;
+        int                            m_ContextTableReference;
     };
 
     void InitializeRenderScriptContext(RenderScriptContext& context, dmGraphics::HContext graphics_context, dmScript::HContext script_context, uint32_t command_buffer_size);
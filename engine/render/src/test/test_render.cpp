@@ -20,6 +20,7 @@
 #include <testmain/testmain.h>
 #include <dlib/hash.h>
 #include <dlib/math.h>
+#include <dlib/memory.h>
 
 #include <script/script.h>
 #include <algorithm> // std::stable_sort
@@ -123,7 +124,8 @@ protected:
     virtual void TearDown()
     {
         dmRender::DeleteRenderContext(m_Context, 0);
-        dmRender::DeleteFontMap(m_SystemFontMap);
+        if (m_SystemFontMap)
+            dmRender::DeleteFontMap(m_SystemFontMap);
         dmGraphics::DeleteContext(m_GraphicsContext);
         dmScript::DeleteContext(m_ScriptContext);
 
@@ -1137,6 +1139,84 @@ TEST_F(dmRenderTest, TestRenderListCulling)
     }
 }
 
+static uint32_t g_VisibilityCalls = 0;
+
+static void TestCountVisibility(dmRender::RenderListVisibilityParams const &params)
+{
+    g_VisibilityCalls++;
+    TestDrawVisibility(params);
+}
+
+static void TestCountDispatch(dmRender::RenderListDispatchParams const & params)
+{
+    TestDrawDispatchCtx *ctx = (TestDrawDispatchCtx*) params.m_UserData;
+    if (params.m_Operation == dmRender::RENDER_LIST_OPERATION_BATCH)
+    {
+        ctx->m_EntriesRendered += params.m_End - params.m_Begin;
+    }
+}
+
+TEST_F(dmRenderTest, TestRenderListCullingCache)
+{
+    dmVMath::Matrix4 view = dmVMath::Matrix4::identity();
+    dmVMath::Matrix4 proj = dmVMath::Matrix4::orthographic(0.0f, WIDTH, 0.0f, HEIGHT, -1.0f, 1.0f);
+    dmRender::SetViewMatrix(m_Context, view);
+    dmRender::SetProjectionMatrix(m_Context, proj);
+
+    TestDrawDispatchCtx ctx;
+    memset(&ctx, 0x00, sizeof(TestDrawDispatchCtx));
+
+    const uint32_t n = 16;
+    dmRender::RenderListBegin(m_Context);
+    uint8_t dispatch = dmRender::RenderListMakeDispatch(m_Context, TestCountDispatch, TestCountVisibility, &ctx);
+    dmRender::RenderListEntry* out = dmRender::RenderListAlloc(m_Context, n);
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        dmRender::RenderListEntry& entry = out[i];
+        memset(&entry, 0, sizeof(entry));
+        entry.m_WorldPosition = Point3((i + 0.5f) * WIDTH / n, HEIGHT * 0.5f, i);
+        entry.m_MajorOrder = dmRender::RENDER_ORDER_WORLD;
+        entry.m_Order = i + 1;
+        entry.m_BatchKey = 1;
+        entry.m_Dispatch = dispatch;
+    }
+    dmRender::RenderListSubmit(m_Context, out, out + n);
+    dmRender::RenderListEnd(m_Context);
+
+    // A main view and a minimap, seeing the left half
+    dmRender::FrustumOptions frustums[2];
+    frustums[0].m_Matrix = proj * view;
+    frustums[0].m_NumPlanes = dmRender::FRUSTUM_PLANES_SIDES;
+    frustums[1].m_Matrix = dmVMath::Matrix4::orthographic(0.0f, WIDTH * 0.5f, 0.0f, HEIGHT, -1.0f, 1.0f) * view;
+    frustums[1].m_NumPlanes = dmRender::FRUSTUM_PLANES_SIDES;
+    uint32_t num_rendered[2] = { n, n / 2 };
+
+    g_VisibilityCalls = 0;
+    for (uint32_t pass = 0; pass < 3; ++pass)
+    {
+        for (uint32_t c = 0; c < 2; ++c)
+        {
+            ctx.m_EntriesRendered = 0;
+            dmRender::DrawRenderList(m_Context, 0, 0, &frustums[c]);
+            ASSERT_EQ((int) num_rendered[c], ctx.m_EntriesRendered);
+        }
+    }
+    // Each frustum is only culled once
+    ASSERT_EQ(2u, g_VisibilityCalls);
+
+    // New render list entries invalidate the culling
+    dmRender::RenderListBegin(m_Context);
+    dispatch = dmRender::RenderListMakeDispatch(m_Context, TestCountDispatch, TestCountVisibility, &ctx);
+    out = dmRender::RenderListAlloc(m_Context, 1);
+    memset(out, 0, sizeof(*out));
+    out->m_MajorOrder = dmRender::RENDER_ORDER_WORLD;
+    out->m_Dispatch = dispatch;
+    dmRender::RenderListSubmit(m_Context, out, out + 1);
+    dmRender::RenderListEnd(m_Context);
+    dmRender::DrawRenderList(m_Context, 0, 0, &frustums[0]);
+    ASSERT_EQ(3u, g_VisibilityCalls);
+}
+
 struct TestRenderListOrderDispatchCtx
 {
     int m_BeginCalls;
@@ -1257,6 +1337,88 @@ TEST_F(dmRenderTest, TestRenderListOrder)
     ASSERT_EQ(ctx.m_Z, orders[2]);
 }
 
+struct TestRenderListCacheDispatchCtx
+{
+    uint64_t  m_Drawn[8];
+    uint32_t  m_DrawnCount;
+};
+
+static void TestRenderListCacheDispatch(dmRender::RenderListDispatchParams const & params)
+{
+    TestRenderListCacheDispatchCtx *ctx = (TestRenderListCacheDispatchCtx*) params.m_UserData;
+    if (params.m_Operation == dmRender::RENDER_LIST_OPERATION_BATCH)
+    {
+        for (uint32_t* i = params.m_Begin; i != params.m_End; ++i)
+        {
+            ctx->m_Drawn[ctx->m_DrawnCount++] = params.m_Buf[*i].m_UserData;
+        }
+    }
+}
+
+TEST_F(dmRenderTest, TestRenderListSortCache)
+{
+    // Drawing the same predicate again reuses the sorted list, it must still follow the view and the list changes
+    TestRenderListCacheDispatchCtx ctx;
+    memset(&ctx, 0x00, sizeof(ctx));
+
+    dmVMath::Matrix4 proj = dmVMath::Matrix4::orthographic(0.0f, WIDTH, 0.0f, HEIGHT, 0.1f, 1.0f);
+    dmRender::SetViewMatrix(m_Context, dmVMath::Matrix4::identity());
+    dmRender::SetProjectionMatrix(m_Context, proj);
+
+    dmRender::RenderListBegin(m_Context);
+    uint8_t dispatch = dmRender::RenderListMakeDispatch(m_Context, TestRenderListCacheDispatch, 0, &ctx);
+
+    const uint32_t n = 3;
+    const float z[n] = { -0.5f, -0.2f, -0.8f };
+    dmRender::RenderListEntry* out = dmRender::RenderListAlloc(m_Context, n);
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        dmRender::RenderListEntry& entry = out[i];
+        memset(&entry, 0, sizeof(entry));
+        entry.m_WorldPosition = Point3(0, 0, z[i]);
+        entry.m_MajorOrder = dmRender::RENDER_ORDER_WORLD;
+        entry.m_Dispatch = dispatch;
+        entry.m_UserData = i;
+    }
+    dmRender::RenderListSubmit(m_Context, out, out + n);
+    dmRender::RenderListEnd(m_Context);
+
+    dmRender::DrawRenderList(m_Context, 0, 0, 0);
+    ASSERT_EQ(n, ctx.m_DrawnCount);
+    uint64_t first[n];
+    memcpy(first, ctx.m_Drawn, sizeof(first));
+
+    // Same view, from the cache
+    ctx.m_DrawnCount = 0;
+    dmRender::DrawRenderList(m_Context, 0, 0, 0);
+    ASSERT_EQ(n, ctx.m_DrawnCount);
+    ASSERT_ARRAY_EQ_LEN(first, ctx.m_Drawn, n);
+
+    // Flipped depth, reversed order
+    dmRender::SetViewMatrix(m_Context, dmVMath::Matrix4::scale(dmVMath::Vector3(1.0f, 1.0f, -1.0f)));
+    ctx.m_DrawnCount = 0;
+    dmRender::DrawRenderList(m_Context, 0, 0, 0);
+    ASSERT_EQ(n, ctx.m_DrawnCount);
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        ASSERT_EQ(first[n - 1 - i], ctx.m_Drawn[i]);
+    }
+
+    // Back to the first view, with an added entry
+    dmRender::SetViewMatrix(m_Context, dmVMath::Matrix4::identity());
+    out = dmRender::RenderListAlloc(m_Context, 1);
+    memset(out, 0, sizeof(*out));
+    out->m_WorldPosition = Point3(0, 0, -0.3f);
+    out->m_MajorOrder = dmRender::RENDER_ORDER_WORLD;
+    out->m_Dispatch = dispatch;
+    out->m_UserData = n;
+    dmRender::RenderListSubmit(m_Context, out, out + 1);
+
+    ctx.m_DrawnCount = 0;
+    dmRender::DrawRenderList(m_Context, 0, 0, 0);
+    ASSERT_EQ(n + 1, ctx.m_DrawnCount);
+}
+
 TEST_F(dmRenderTest, TestRenderListDebug)
 {
     // Test submitting debug drawing when there is no other drawing going on
@@ -1441,6 +1603,169 @@ TEST_F(dmRenderTest, GetTextMetrics)
     ASSERT_EQ(numlines, metrics.m_LineCount);
 }
 
+TEST_F(dmRenderTest, GetTextMetricsCached)
+{
+    dmRender::TextMetrics metrics;
+
+    const int charwidth = 2;
+
+    dmRender::GetTextMetrics(m_SystemFontMap, "Hello World", 0, false, 1.0f, 0.0f, &metrics);
+    ASSERT_EQ(charwidth*11, metrics.m_Width);
+
+    // The layout is reused until the layout cache is cleared
+    m_Glyphs['o'].m_Advance = charwidth + 1;
+    dmRender::GetTextMetrics(m_SystemFontMap, "Hello World", 0, false, 1.0f, 0.0f, &metrics);
+    ASSERT_EQ(charwidth*11, metrics.m_Width);
+
+    dmRender::ClearFontMapLayoutCache(m_SystemFontMap);
+    dmRender::GetTextMetrics(m_SystemFontMap, "Hello World", 0, false, 1.0f, 0.0f, &metrics);
+    ASSERT_EQ(charwidth*11 + 2, metrics.m_Width);
+
+    // Different parameters get different layouts
+    dmRender::GetTextMetrics(m_SystemFontMap, "Hello World", 8*charwidth, true, 1.0f, 0.0f, &metrics);
+    ASSERT_EQ(2u, metrics.m_LineCount);
+    dmRender::GetTextMetrics(m_SystemFontMap, "Hello World", 0, false, 1.0f, 0.0f, &metrics);
+    ASSERT_EQ(1u, metrics.m_LineCount);
+
+    m_Glyphs['o'].m_Advance = charwidth;
+}
+
+static void DrawTextFrame(dmRender::HRenderContext context, dmRender::HFontMap font_map, const char* text)
+{
+    dmRender::DrawTextParams params;
+    params.m_Text = text;
+    dmRender::DrawText(context, font_map, 0, 0, params);
+
+    dmRender::RenderListBegin(context);
+    dmRender::FlushTexts(context, 0, 0, true);
+    dmRender::RenderListEnd(context);
+    dmRender::DrawRenderList(context, 0, 0, 0);
+    dmRender::ClearRenderObjects(context);
+}
+
+TEST_F(dmRenderTest, GlyphCacheGrows)
+{
+    dmGraphics::ShaderDesc::Shader shader = MakeDDFShader(dmGraphics::ShaderDesc::LANGUAGE_GLSL_SM140, "foo", 3);
+    dmGraphics::ShaderDesc vs_desc        = MakeDDFShaderDesc(&shader, dmGraphics::ShaderDesc::SHADER_TYPE_VERTEX, 0, 0, 0, 0);
+    dmGraphics::ShaderDesc fs_desc        = MakeDDFShaderDesc(&shader, dmGraphics::ShaderDesc::SHADER_TYPE_FRAGMENT, 0, 0, 0, 0);
+
+    dmGraphics::HVertexProgram vp   = dmGraphics::NewVertexProgram(m_GraphicsContext, &vs_desc, 0, 0);
+    dmGraphics::HFragmentProgram fp = dmGraphics::NewFragmentProgram(m_GraphicsContext, &fs_desc, 0, 0);
+    dmRender::HMaterial material    = dmRender::NewMaterial(m_Context, vp, fp);
+
+    // Room for two glyphs, and it may grow to four times the height
+    dmRender::FontMapParams font_map_params;
+    font_map_params.m_CacheWidth = 16;
+    font_map_params.m_CacheHeight = 8;
+    font_map_params.m_CacheCellWidth = 8;
+    font_map_params.m_CacheCellHeight = 8;
+    font_map_params.m_MaxAscent = 2;
+    font_map_params.m_MaxDescent = 1;
+    font_map_params.m_GetGlyph = GetGlyph;
+    font_map_params.m_GetGlyphData = GetGlyphData;
+
+    dmRender::HFontMap font_map = dmRender::NewFontMap(m_GraphicsContext, font_map_params);
+    dmRender::SetFontMapUserData(font_map, m_Glyphs);
+    dmRender::SetFontMapMaterial(font_map, material);
+
+    dmGraphics::HTexture texture = dmRender::GetFontMapTexture(font_map);
+    ASSERT_EQ(8u, dmGraphics::GetTextureHeight(texture));
+
+    // The cache grows the frame after it overflows
+    DrawTextFrame(m_Context, font_map, "abcdef");
+    ASSERT_EQ(8u, dmGraphics::GetTextureHeight(texture));
+    DrawTextFrame(m_Context, font_map, "abcdef");
+    ASSERT_EQ(16u, dmGraphics::GetTextureHeight(texture));
+    DrawTextFrame(m_Context, font_map, "abcdef");
+    ASSERT_EQ(32u, dmGraphics::GetTextureHeight(texture));
+
+    // But not beyond its max size
+    for (uint32_t i = 0; i < 4; ++i)
+    {
+        DrawTextFrame(m_Context, font_map, "abcdefghijkl");
+    }
+    ASSERT_EQ(32u, dmGraphics::GetTextureHeight(texture));
+    ASSERT_EQ(texture, dmRender::GetFontMapTexture(font_map));
+
+    dmRender::DeleteFontMap(font_map);
+    dmRender::DeleteMaterial(m_Context, material);
+    dmGraphics::DeleteVertexProgram(vp);
+    dmGraphics::DeleteFragmentProgram(fp);
+}
+
+TEST_F(dmRenderTest, CreateTextVertexData)
+{
+    const char* text = "Hello";
+    uint32_t vertex_count = dmRender::GetTextVertexCount(m_SystemFontMap, text);
+    ASSERT_EQ(5u * 6u, vertex_count);
+
+    void* vertices = 0;
+    ASSERT_EQ(dmMemory::RESULT_OK, dmMemory::AlignedMalloc(&vertices, 16, vertex_count * dmRender::GetTextVertexSize()));
+
+    dmRender::DrawTextParams params;
+    params.m_Text = text;
+
+    dmRender::HNamedConstantBuffer constants = dmRender::NewNamedConstantBuffer();
+    dmRender::BeginTextBatch(m_Context, m_SystemFontMap, constants);
+    ASSERT_EQ(vertex_count, dmRender::CreateTextVertexData(m_Context, m_SystemFontMap, params, vertices, vertex_count));
+    // Only whole glyphs are written
+    ASSERT_EQ(12u, dmRender::CreateTextVertexData(m_Context, m_SystemFontMap, params, vertices, 17));
+    dmRender::EndTextBatch(m_Context, m_SystemFontMap);
+
+    dmVMath::Vector4* texture_size_recip = 0;
+    uint32_t num_values = 0;
+    ASSERT_TRUE(dmRender::GetNamedConstant(constants, dmHashString64("texture_size_recip"), &texture_size_recip, &num_values));
+    ASSERT_EQ(1u, num_values);
+    ASSERT_EQ(1.0f / 128.0f, texture_size_recip->getX());
+
+    dmRender::DeleteNamedConstantBuffer(constants);
+    dmMemory::AlignedFree(vertices);
+}
+
+TEST_F(dmRenderTest, SharedGlyphCache)
+{
+    dmRender::FontMapParams font_map_params;
+    font_map_params.m_CacheWidth = 128;
+    font_map_params.m_CacheHeight = 128;
+    font_map_params.m_CacheCellWidth = 8;
+    font_map_params.m_CacheCellHeight = 8;
+    font_map_params.m_MaxAscent = 2;
+    font_map_params.m_MaxDescent = 1;
+    font_map_params.m_GetGlyph = GetGlyph;
+    font_map_params.m_GetGlyphData = GetGlyphData;
+    font_map_params.m_CacheFontMap = m_SystemFontMap;
+
+    dmRender::HFontMap font_map = dmRender::NewFontMap(m_GraphicsContext, font_map_params);
+    dmRender::SetFontMapUserData(font_map, m_Glyphs);
+    ASSERT_TRUE(dmRender::IsFontMapCacheShared(font_map));
+    ASSERT_FALSE(dmRender::IsFontMapCacheShared(m_SystemFontMap));
+    ASSERT_EQ(dmRender::GetFontMapTexture(m_SystemFontMap), dmRender::GetFontMapTexture(font_map));
+
+    // A cache with a different cell size can't be shared
+    dmRender::FontMapParams other_params = font_map_params;
+    other_params.m_CacheCellWidth = 16;
+    dmRender::HFontMap other_font_map = dmRender::NewFontMap(m_GraphicsContext, other_params);
+    ASSERT_FALSE(dmRender::IsFontMapCacheShared(other_font_map));
+    ASSERT_NE(dmRender::GetFontMapTexture(m_SystemFontMap), dmRender::GetFontMapTexture(other_font_map));
+    dmRender::DeleteFontMap(other_font_map);
+
+    // The glyphs are added to the shared cache
+    DrawTextFrame(m_Context, font_map, "abc");
+
+    // The cache outlives the font map that owns it
+    dmRender::DeleteFontMap(m_SystemFontMap);
+    m_SystemFontMap = 0;
+    DrawTextFrame(m_Context, font_map, "abcd");
+
+    dmGraphics::HTexture texture = dmRender::GetFontMapTexture(font_map);
+    dmRender::UnshareFontMapCache(font_map);
+    ASSERT_FALSE(dmRender::IsFontMapCacheShared(font_map));
+    ASSERT_NE(texture, dmRender::GetFontMapTexture(font_map));
+    DrawTextFrame(m_Context, font_map, "abcd");
+
+    dmRender::DeleteFontMap(font_map);
+}
+
 TEST_F(dmRenderTest, GetTextMetricsMeasureTrailingSpace)
 {
     dmRender::TextMetrics metricsHello;
@@ -1897,6 +2222,104 @@ TEST(Render, BatchIterator)
     ASSERT_FALSE(iterator1.Next());
 }
 
+static bool LightGridClusterHasLight(const dmRender::LightGrid& grid, uint32_t x, uint32_t y, uint32_t z, uint16_t light)
+{
+    const dmRender::LightGridCluster& cluster = grid.m_Clusters[(z * dmRender::LIGHT_GRID_SIZE_Y + y) * dmRender::LIGHT_GRID_SIZE_X + x];
+    const dmArray<uint16_t>& indices = grid.m_SliceIndices[z];
+    for (uint32_t i = 0; i < cluster.m_Count; ++i)
+    {
+        if (indices[cluster.m_Offset + i] == light)
+            return true;
+    }
+    return false;
+}
+
+TEST_F(dmRenderTest, LightGrid)
+{
+    dmGraphics::NullContext* null_context = (dmGraphics::NullContext*) m_GraphicsContext;
+    null_context->m_TextureFormatSupport |= 1 << dmGraphics::TEXTURE_FORMAT_RGBA32F;
+
+    dmRender::LightGridLight light;
+    memset(&light, 0, sizeof(light));
+    light.m_Color = dmVMath::Vector4(1.0f);
+    light.m_Range = 0.5f;
+
+    // In front of the camera, at the center of the view
+    light.m_Position = dmVMath::Point3(0.0f, 0.0f, -5.0f);
+    dmRender::AddLight(m_Context, light);
+    // Behind the camera
+    light.m_Position = dmVMath::Point3(0.0f, 0.0f, 5.0f);
+    dmRender::AddLight(m_Context, light);
+    ASSERT_EQ(2u, dmRender::GetLightCount(m_Context));
+
+    dmRender::SetViewMatrix(m_Context, dmVMath::Matrix4::identity());
+    dmRender::SetProjectionMatrix(m_Context, dmVMath::Matrix4::perspective(M_PI / 2.0f, 16.0f / 9.0f, 1.0f, 100.0f));
+    dmRender::UpdateLightGrid(m_Context);
+
+    const dmRender::LightGrid& grid = m_Context->m_LightGrid;
+    ASSERT_TRUE(grid.m_Exponential);
+    ASSERT_NEAR(1.0f, grid.m_SliceDepth[0], 0.001f);
+    ASSERT_NEAR(100.0f, grid.m_SliceDepth[dmRender::LIGHT_GRID_SIZE_Z], 0.01f);
+    ASSERT_NE((dmGraphics::HTexture) 0, grid.m_ClusterTexture);
+
+    // Depth 5 is in slice floor(log(5) / log(100) * 24) = 8
+    ASSERT_TRUE(LightGridClusterHasLight(grid, dmRender::LIGHT_GRID_SIZE_X / 2, dmRender::LIGHT_GRID_SIZE_Y / 2, 8, 0));
+    ASSERT_FALSE(LightGridClusterHasLight(grid, 0, 0, 8, 0));
+    ASSERT_FALSE(LightGridClusterHasLight(grid, dmRender::LIGHT_GRID_SIZE_X / 2, dmRender::LIGHT_GRID_SIZE_Y / 2, dmRender::LIGHT_GRID_SIZE_Z - 1, 0));
+
+    for (uint32_t z = 0; z < dmRender::LIGHT_GRID_SIZE_Z; ++z)
+    {
+        for (uint32_t i = 0; i < grid.m_SliceIndices[z].Size(); ++i)
+        {
+            ASSERT_EQ(0u, grid.m_SliceIndices[z][i]);
+        }
+    }
+
+    // The lights are cleared with the render objects
+    dmRender::ClearRenderObjects(m_Context);
+    ASSERT_EQ(0u, dmRender::GetLightCount(m_Context));
+}
+
+TEST_F(dmRenderTest, OcclusionCulling)
+{
+    // A wall covering the view, 10 units in front of the camera
+    const float positions[] = {
+        -100.0f, -100.0f, -10.0f,
+         100.0f, -100.0f, -10.0f,
+         100.0f,  100.0f, -10.0f,
+        -100.0f,  100.0f, -10.0f,
+    };
+    const uint16_t indices[] = { 0, 1, 2, 0, 2, 3 };
+
+    dmRender::RenderListBegin(m_Context);
+    dmRender::AddOccluder(m_Context, dmVMath::Matrix4::identity(), positions, indices, 6, false);
+    ASSERT_EQ(1u, dmRender::GetOccluderCount(m_Context));
+
+    dmVMath::Matrix4 view_proj = dmVMath::Matrix4::perspective(M_PI / 2.0f, 16.0f / 9.0f, 1.0f, 100.0f);
+    dmRender::BuildOcclusionBuffer(m_Context, view_proj);
+    dmRender::HOcclusionBuffer buffer = &m_Context->m_OcclusionBuffer;
+    ASSERT_TRUE(buffer->m_Valid);
+
+    dmVMath::Vector3 aabb_min(-1.0f, -1.0f, -1.0f);
+    dmVMath::Vector3 aabb_max(1.0f, 1.0f, 1.0f);
+
+    // Behind the wall
+    ASSERT_TRUE(dmRender::IsOccluded(buffer, dmVMath::Matrix4::translation(dmVMath::Vector3(0.0f, 0.0f, -20.0f)), aabb_min, aabb_max));
+    ASSERT_TRUE(dmRender::IsOccluded(buffer, dmVMath::Matrix4::translation(dmVMath::Vector3(5.0f, 2.0f, -50.0f)), aabb_min, aabb_max));
+    // In front of the wall
+    ASSERT_FALSE(dmRender::IsOccluded(buffer, dmVMath::Matrix4::translation(dmVMath::Vector3(0.0f, 0.0f, -5.0f)), aabb_min, aabb_max));
+    // Intersecting the wall
+    ASSERT_FALSE(dmRender::IsOccluded(buffer, dmVMath::Matrix4::translation(dmVMath::Vector3(0.0f, 0.0f, -10.5f)), aabb_min, aabb_max));
+    // Behind the camera
+    ASSERT_FALSE(dmRender::IsOccluded(buffer, dmVMath::Matrix4::translation(dmVMath::Vector3(0.0f, 0.0f, 5.0f)), aabb_min, aabb_max));
+
+    // The occluders are cleared with the render list
+    dmRender::RenderListBegin(m_Context);
+    ASSERT_EQ(0u, dmRender::GetOccluderCount(m_Context));
+    dmRender::BuildOcclusionBuffer(m_Context, view_proj);
+    ASSERT_FALSE(buffer->m_Valid);
+}
+
 extern "C" void dmExportedSymbols();
 
 int main(int argc, char **argv)
@@ -127,6 +127,35 @@ TEST_F(dmRenderBufferTest, TestBufferedRenderBufferSetData)
     m_RenderContext->m_MultiBufferingRequired = m_MultiBufferingRequired;
 }
 
+TEST_F(dmRenderBufferTest, TestBufferedRenderBufferMapData)
+{
+    dmRender::HBufferedRenderBuffer buffer = dmRender::NewBufferedRenderBuffer(m_RenderContext, dmRender::RENDER_BUFFER_TYPE_VERTEX_BUFFER);
+    ASSERT_NE((void*) 0x0, buffer);
+
+    // Nothing to map
+    ASSERT_EQ((void*) 0x0, dmRender::MapBufferData(m_RenderContext, buffer, 0, dmGraphics::BUFFER_USAGE_DYNAMIC_DRAW));
+
+    uint8_t data[] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+    uint8_t* mapped = (uint8_t*) dmRender::MapBufferData(m_RenderContext, buffer, sizeof(data), dmGraphics::BUFFER_USAGE_DYNAMIC_DRAW);
+    ASSERT_NE((void*) 0x0, mapped);
+    memcpy(mapped, data, sizeof(data));
+    dmRender::UnmapBufferData(m_RenderContext, buffer);
+
+    dmGraphics::HVertexBuffer vbuf = (dmGraphics::HVertexBuffer) dmRender::GetBuffer(m_RenderContext, buffer);
+    ASSERT_EQ(sizeof(data), dmGraphics::GetVertexBufferSize(vbuf));
+
+    void* vbuf_ptr = dmGraphics::MapVertexBuffer(m_GraphicsContext, vbuf, dmGraphics::BUFFER_ACCESS_READ_ONLY);
+    ASSERT_EQ(0, memcmp(data, vbuf_ptr, sizeof(data)));
+    ASSERT_TRUE(dmGraphics::UnmapVertexBuffer(m_GraphicsContext, vbuf));
+
+    // Mapping is not available, so the caller has to fall back to SetBufferData
+    m_RenderContext->m_BufferMappingSupported = 0;
+    ASSERT_EQ((void*) 0x0, dmRender::MapBufferData(m_RenderContext, buffer, sizeof(data), dmGraphics::BUFFER_USAGE_DYNAMIC_DRAW));
+    m_RenderContext->m_BufferMappingSupported = 1;
+
+    dmRender::DeleteBufferedRenderBuffer(m_RenderContext, buffer);
+}
+
 TEST_F(dmRenderBufferTest, TestBufferedRenderBufferAddAndTrim)
 {
     dmRender::HBufferedRenderBuffer buffer = dmRender::NewBufferedRenderBuffer(m_RenderContext, dmRender::RENDER_BUFFER_TYPE_VERTEX_BUFFER);
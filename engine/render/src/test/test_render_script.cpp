@@ -559,6 +559,54 @@ TEST_F(dmRenderScriptTest, TestLuaRenderTarget)
     dmRender::DeleteRenderScript(m_Context, render_script);
 }
 
+TEST_F(dmRenderScriptTest, TestLuaTransientRenderTarget)
+{
+    const char* script =
+    "function update(self)\n"
+    "    local params = { [graphics.BUFFER_TYPE_COLOR0_BIT] = { format = graphics.TEXTURE_FORMAT_RGBA, width = 4, height = 4 } }\n"
+    "    local params_other = { [graphics.BUFFER_TYPE_COLOR0_BIT] = { format = graphics.TEXTURE_FORMAT_RGBA, width = 8, height = 4 } }\n"
+    "    local a = render.acquire_transient_render_target(params)\n"
+    "    local b = render.acquire_transient_render_target(params)\n"
+    "    assert(a ~= b)\n"
+    "    local other = render.acquire_transient_render_target(params_other)\n"
+    "    assert(other ~= a and other ~= b)\n"
+    "    render.release_transient_render_target(a)\n"
+    "    assert(render.acquire_transient_render_target(params) == a)\n"
+    "    assert(not pcall(render.delete_render_target, a))\n"
+    "    render.release_transient_render_target(b)\n"
+    "    assert(not pcall(render.release_transient_render_target, b))\n"
+    "    if self.first then\n"
+    "        -- released at the end of the previous frame\n"
+    "        assert(a == self.first)\n"
+    "    end\n"
+    "    self.first = a\n"
+    "    local rt = render.render_target({[graphics.BUFFER_TYPE_COLOR0_BIT] = params[graphics.BUFFER_TYPE_COLOR0_BIT]})\n"
+    "    assert(not pcall(render.release_transient_render_target, rt))\n"
+    "    render.delete_render_target(rt)\n"
+    "    local depth = { format = graphics.TEXTURE_FORMAT_DEPTH, width = 4, height = 4, flags = render.MEMORYLESS_BIT }\n"
+    "    render.delete_render_target(render.render_target({[graphics.BUFFER_TYPE_DEPTH_BIT] = depth}))\n"
+    "    depth.flags = render.MEMORYLESS_BIT + render.TEXTURE_BIT\n"
+    "    assert(not pcall(render.render_target, {[graphics.BUFFER_TYPE_DEPTH_BIT] = depth}))\n"
+    "    local color = { format = graphics.TEXTURE_FORMAT_RGBA, width = 4, height = 4, flags = render.MEMORYLESS_BIT }\n"
+    "    assert(not pcall(render.render_target, {[graphics.BUFFER_TYPE_COLOR0_BIT] = color}))\n"
+    "end\n";
+    dmRender::HRenderScript render_script = dmRender::NewRenderScript(m_Context, LuaSourceFromString(script));
+    dmRender::HRenderScriptInstance render_script_instance = dmRender::NewRenderScriptInstance(m_Context, render_script);
+
+    ASSERT_EQ(dmRender::RENDER_SCRIPT_RESULT_OK, dmRender::UpdateRenderScriptInstance(render_script_instance, 0.0f));
+    ASSERT_EQ(3u, render_script_instance->m_TransientRenderTargets.Size());
+    ASSERT_EQ(dmRender::RENDER_SCRIPT_RESULT_OK, dmRender::UpdateRenderScriptInstance(render_script_instance, 0.0f));
+    ASSERT_EQ(3u, render_script_instance->m_TransientRenderTargets.Size());
+
+    for (uint32_t i = 0; i < render_script_instance->m_TransientRenderTargets.Size(); ++i)
+    {
+        ASSERT_FALSE(render_script_instance->m_TransientRenderTargets[i].m_InUse);
+    }
+
+    dmRender::DeleteRenderScriptInstance(render_script_instance);
+    dmRender::DeleteRenderScript(m_Context, render_script);
+}
+
 TEST_F(dmRenderScriptTest, TestLuaRenderTargetDeprecated)
 {
     // DEPRECATED functions tested, remove this test when render.enable/disable_render_target script functions are removed!
@@ -805,6 +853,46 @@ TEST_F(dmRenderScriptTest, TestLuaTransform)
     dmRender::DeleteRenderScript(m_Context, render_script);
 }
 
+TEST_F(dmRenderScriptTest, TestLuaRecordExecute)
+{
+    const char* script =
+    "function init(self)\n"
+    "    self.list = render.record(function()\n"
+    "        render.set_viewport(1, 2, 3, 4)\n"
+    "        render.set_view(vmath.matrix4())\n"
+    "    end)\n"
+    "    render.execute(self.list)\n"
+    "    render.execute(self.list, {view = vmath.matrix4_translation(vmath.vector3(1, 2, 3))})\n"
+    "end\n";
+    dmRender::HRenderScript render_script = dmRender::NewRenderScript(m_Context, LuaSourceFromString(script));
+    dmRender::HRenderScriptInstance render_script_instance = dmRender::NewRenderScriptInstance(m_Context, render_script);
+
+    ASSERT_EQ(dmRender::RENDER_SCRIPT_RESULT_OK, dmRender::InitRenderScriptInstance(render_script_instance));
+
+    // Only the replayed commands are in the frame
+    dmArray<dmRender::Command>& commands = render_script_instance->m_CommandBuffer;
+    ASSERT_EQ(4u, commands.Size());
+
+    ASSERT_EQ(dmRender::COMMAND_TYPE_SET_VIEWPORT, commands[0].m_Type);
+    ASSERT_EQ(dmRender::COMMAND_TYPE_SET_VIEW, commands[1].m_Type);
+    ASSERT_EQ(dmRender::COMMAND_TYPE_SET_VIEWPORT, commands[2].m_Type);
+    ASSERT_EQ(dmRender::COMMAND_TYPE_SET_VIEW, commands[3].m_Type);
+    ASSERT_EQ(4u, commands[2].m_Operands[3]);
+
+    // Each replay owns its own copy of the matrix
+    Matrix4* view0 = (Matrix4*)commands[1].m_Operands[0];
+    Matrix4* view1 = (Matrix4*)commands[3].m_Operands[0];
+    ASSERT_NE(view0, view1);
+    ASSERT_EQ(0.0f, view0->getCol3().getX());
+    ASSERT_EQ(1.0f, view1->getCol3().getX());
+    ASSERT_EQ(3.0f, view1->getCol3().getZ());
+
+    dmRender::ParseCommands(m_Context, &commands[0], commands.Size());
+
+    dmRender::DeleteRenderScriptInstance(render_script_instance);
+    dmRender::DeleteRenderScript(m_Context, render_script);
+}
+
 TEST_F(dmRenderScriptTest, TestLuaDraw_StringPredicate)
 {
     const char* script =
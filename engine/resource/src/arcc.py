@@ -24,8 +24,30 @@ VERSION = 4
 HASH_MAX_LENGTH = 64 # 512 bits
 HASH_LENGTH = 18
 
+# See dmResourceArchive::EntryFlag
+ENTRY_FLAG_ENCRYPTED = 1 << 0
+ENTRY_FLAG_COMPRESSED = 1 << 1
+ENTRY_FLAG_CHUNKED = 1 << 3
+
+def compress_buffer(buf, size, chunk_size):
+    # Returns the compressed data and entry flags.
+    # Entries larger than chunk_size are compressed as independent chunks (see dmResourceArchive::ChunkHeader)
+    if chunk_size <= 0 or size <= chunk_size:
+        max_compressed_size = dlib.dmLZ4MaxCompressedSize(size)
+        return dlib.dmLZ4CompressBuffer(buf, size, max_compressed_size), 0
+
+    chunks = []
+    for offset in range(0, size, chunk_size):
+        chunk = buf[offset:offset + chunk_size]
+        max_compressed_size = dlib.dmLZ4MaxCompressedSize(len(chunk))
+        chunks.append(dlib.dmLZ4CompressBuffer(chunk, len(chunk), max_compressed_size))
+
+    header = struct.pack('!II', chunk_size, len(chunks))
+    header += ''.join([struct.pack('!I', len(c)) for c in chunks])
+    return header + ''.join(chunks), ENTRY_FLAG_COMPRESSED | ENTRY_FLAG_CHUNKED
+
 class Entry(object):
-    def __init__(self, root, filename, compress):
+    def __init__(self, root, filename, compress, chunk_size = 0):
         rel_name = os.path.relpath(filename, root)
         rel_name = rel_name.replace('\\', '/')
 
@@ -34,8 +56,7 @@ class Entry(object):
         self.filename = '/' + rel_name
         if compress == True:
             tmp_buf = f.read()
-            max_compressed_size = dlib.dmLZ4MaxCompressedSize(size)
-            self.resource = dlib.dmLZ4CompressBuffer(tmp_buf, size, max_compressed_size)
+            self.resource, self.flags = compress_buffer(tmp_buf, size, chunk_size)
             self.compressed_size = len(self.resource)
             # Store uncompressed if gain is less than 5%
             # We believe that the shorter load time will compensate in this case.
@@ -47,15 +68,15 @@ class Entry(object):
             if comp_ratio > 0.95:
                 self.resource = tmp_buf
                 self.compressed_size = 0xFFFFFFFFL
+                self.flags = 0
         else:
             self.resource = f.read()
             self.compressed_size = 0xFFFFFFFFL
+            self.flags = 0
 
         if os.path.splitext(filename)[-1] in ENCRYPTED_EXTS:
-            self.flags = 1
+            self.flags |= ENTRY_FLAG_ENCRYPTED
             self.resource = dlib.dmEncryptXTeaCTR(self.resource, KEY)
-        else:
-            self.flags = 0
         self.size = size
         f.close()
 
@@ -67,7 +88,7 @@ class Entry(object):
 
 
 class EntryData(object):
-    def __init__(self, root, filename, compress, hashpostfix):
+    def __init__(self, root, filename, compress, hashpostfix, chunk_size = 0):
         rel_name = os.path.relpath(filename, root)
         rel_name = rel_name.replace('\\', '/')
 
@@ -81,8 +102,7 @@ class EntryData(object):
         self.hash_size = len(the_hash_bytes)
         if compress == True:
             tmp_buf = f.read()
-            max_compressed_size = dlib.dmLZ4MaxCompressedSize(size)
-            self.resource = dlib.dmLZ4CompressBuffer(tmp_buf, size, max_compressed_size)
+            self.resource, self.flags = compress_buffer(tmp_buf, size, chunk_size)
             self.compressed_size = len(self.resource)
             # Store uncompressed if gain is less than 5%
             # We believe that the shorter load time will compensate in this case.
@@ -94,15 +114,15 @@ class EntryData(object):
             if comp_ratio > 0.95:
                 self.resource = tmp_buf
                 self.compressed_size = 0xFFFFFFFFL
+                self.flags = 0
         else:
             self.resource = f.read()
             self.compressed_size = 0xFFFFFFFFL
+            self.flags = 0
 
         if os.path.splitext(filename)[-1] in ENCRYPTED_EXTS:
-            self.flags = 1
+            self.flags |= ENTRY_FLAG_ENCRYPTED
             self.resource = dlib.dmEncryptXTeaCTR(self.resource, KEY)
-        else:
-            self.flags = 0
         self.size = size
         f.close()
 
@@ -156,7 +176,7 @@ def compile(input_files, options):
         out_data.seek(0)
         for i,f in enumerate(input_files):
             align_file(out_data, 4)
-            e = EntryData(options.root, f, options.compress, num_input_files - i)
+            e = EntryData(options.root, f, options.compress, num_input_files - i, options.chunk_size)
             e.resource_offset = out_data.tell()
             out_data.write(e.resource)
             entry_datas.append(e)
@@ -224,7 +244,7 @@ def compile(input_files, options):
         string_pool_offset = out_file.tell()
         strings_offset = []
         for i,f in enumerate(input_files):
-            e = Entry(options.root, f, options.compress)
+            e = Entry(options.root, f, options.compress, options.chunk_size)
             # Store offset to string
             strings_offset.append(out_file.tell() - string_pool_offset)
             # Write filename string
@@ -276,6 +296,7 @@ if __name__ == '__main__':
     parser.add_option('-i', dest='output_file_index', help='Index output file', metavar='OUTPUTINDEX')
     parser.add_option('-d', dest='output_file_data', help='Data output file', metavar='OUTPUTDATA')
     parser.add_option('-c', dest='compress', action='store_true', help='Use compression', metavar='COMPRESSION', default=False)
+    parser.add_option('-k', dest='chunk_size', type='int', help='Compress entries larger than CHUNKSIZE bytes as independent chunks (0 to disable)', metavar='CHUNKSIZE', default=0)
     parser.add_option('-p', dest='rel_path', help='Output relative target path')
     (options, args) = parser.parse_args()
     if not options.output_file and not options.output_file_index:
@@ -38,6 +38,12 @@ namespace dmLoadQueue
         FResourcePreload        m_CompleteFunction;
         ResourcePreloadHintInfo m_HintInfo;
         void*                   m_Context;
+        // Set if the resource may be created by the loader thread, in case the preload function doesn't hint any dependencies
+        HResourceType           m_CreateType;
+        uint8_t                 m_Priority; // Requests with higher priority are loaded first
+        // Set if only the header of large resources should be loaded (see ResourceTypeSetStreamed)
+        HResourceType           m_StreamType;
+        uint8_t                 m_ZeroCopy:1; // Try to get the data straight from a memory mapped archive
     };
 
     struct LoadResult
@@ -45,6 +51,13 @@ namespace dmLoadQueue
         dmResource::Result m_LoadResult;
         dmResource::Result m_PreloadResult;
         void* m_PreloadData;
+        dmResource::LoadTiming m_Timing;
+        // Set if the resource was created by the loader thread (see PreloadInfo::m_CreateType)
+        dmResource::Result m_CreateResult;
+        ResourceDescriptor m_Resource;
+        // The buffer points into a memory mapped archive, and stays valid after FreeLoad
+        uint8_t m_ZeroCopy:1;
+        uint8_t m_Created:1;
     };
 
     HQueue CreateQueue(dmResource::HFactory factory);
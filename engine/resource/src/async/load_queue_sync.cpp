@@ -14,10 +14,12 @@
 
 #include "resource.h"
 #include "resource_private.h"
+#include "resource_timeline.h"
 #include "load_queue.h"
 
 #include <dlib/dstrings.h>
 #include <dlib/log.h>
+#include <dlib/time.h>
 
 namespace dmLoadQueue
 {
@@ -29,6 +31,7 @@ namespace dmLoadQueue
         const char* m_Name;
         const char* m_CanonicalPath;
         PreloadInfo m_PreloadInfo;
+        dmResource::LoadTiming m_Timing;
     };
 
     struct Queue
@@ -63,6 +66,7 @@ namespace dmLoadQueue
         queue->m_ActiveRequest->m_Name          = name;
         queue->m_ActiveRequest->m_CanonicalPath = canonical_path;
         queue->m_ActiveRequest->m_PreloadInfo   = *info;
+        dmResource::InitLoadTiming(&queue->m_ActiveRequest->m_Timing);
         return queue->m_ActiveRequest;
     }
 
@@ -73,9 +77,36 @@ namespace dmLoadQueue
             return RESULT_INVALID_PARAM;
         }
 
-        load_result->m_LoadResult    = dmResource::LoadResource(queue->m_Factory, request->m_CanonicalPath, request->m_Name, buf, size);
+        load_result->m_LoadResult    = dmResource::RESULT_NOT_SUPPORTED;
         load_result->m_PreloadResult = dmResource::RESULT_PENDING;
         load_result->m_PreloadData   = 0;
+        load_result->m_ZeroCopy      = 0;
+        load_result->m_Created       = 0;
+        load_result->m_Timing        = request->m_Timing;
+
+        dmResource::AddLoadPhaseTime(&load_result->m_Timing, dmResource::LOAD_PHASE_QUEUE, load_result->m_Timing.m_Start);
+        dmResource::BeginReadTiming(&load_result->m_Timing);
+
+        if (request->m_PreloadInfo.m_ZeroCopy)
+        {
+            const void* data = 0;
+            load_result->m_LoadResult = dmResource::LoadResourceData(queue->m_Factory, request->m_CanonicalPath, &data, size);
+            if (load_result->m_LoadResult == dmResource::RESULT_OK)
+            {
+                *buf = (void*)data;
+                load_result->m_ZeroCopy = 1;
+            }
+        }
+
+        if (load_result->m_LoadResult == dmResource::RESULT_NOT_SUPPORTED)
+        {
+            if (request->m_PreloadInfo.m_StreamType)
+                load_result->m_LoadResult = dmResource::LoadResourceHeader(queue->m_Factory, request->m_PreloadInfo.m_StreamType, request->m_CanonicalPath, request->m_Name, buf, size);
+            else
+                load_result->m_LoadResult = dmResource::LoadResource(queue->m_Factory, request->m_CanonicalPath, request->m_Name, buf, size);
+        }
+
+        dmResource::EndReadTiming(&load_result->m_Timing, load_result->m_LoadResult == dmResource::RESULT_OK ? *size : 0);
 
         if (load_result->m_LoadResult == dmResource::RESULT_OK && request->m_PreloadInfo.m_CompleteFunction)
         {
@@ -86,7 +117,9 @@ namespace dmLoadQueue
             params.m_BufferSize          = *size;
             params.m_HintInfo            = &request->m_PreloadInfo.m_HintInfo;
             params.m_PreloadData         = &load_result->m_PreloadData;
+            uint64_t phase_start         = dmTime::GetTime();
             load_result->m_PreloadResult = (dmResource::Result)request->m_PreloadInfo.m_CompleteFunction(&params);
+            dmResource::AddLoadPhaseTime(&load_result->m_Timing, dmResource::LOAD_PHASE_PRELOAD, phase_start);
         }
         return RESULT_OK;
     }
@@ -14,36 +14,52 @@
 
 #include "resource.h"
 #include "resource_private.h"
+#include "resource_timeline.h"
 #include "load_queue.h"
 
 #include <dlib/dstrings.h>
+#include <dlib/hash.h>
 #include <dlib/log.h>
 #include <dlib/array.h>
 #include <dlib/thread.h>
 #include <dlib/mutex.h>
 #include <dlib/time.h>
 #include <dlib/condition_variable.h>
+#include <dlib/math.h>
 
 namespace dmLoadQueue
 {
-    // Implementation of dmLoadQueue with a thread that loads items in the order they are supplied,
+    // Implementation of dmLoadQueue with a pool of threads that load items in priority order.
+    // Items with the same priority are loaded in the order they are stored in the archive, sweeping
+    // forward from the last read so that the reads stay sequential. Items in the same position
+    // (e.g. loose files) are loaded in the order they are supplied.
 
     // Default to small buffers since a lot of what is loaded are just small objects anyway.
     // That way we can have more in flight, but throttle when max pending data grows too large anyway
     const uint64_t DEFAULT_CAPACITY = 5 * 1024;
 
-    // Once the loader has this amount not picked up, it will stop loading more.
-    // This sets the bandwidth of the loader.
-    const uint64_t MAX_PENDING_DATA = 4 * 1024 * 1024;
     const uint32_t QUEUE_SLOTS      = 16;
 
+    enum RequestState
+    {
+        REQUEST_STATE_FREE,
+        REQUEST_STATE_PENDING,
+        REQUEST_STATE_LOADING,
+        REQUEST_STATE_LOADED,
+    };
+
     struct Request
     {
         const char*                m_Name;
         const char*                m_CanonicalPath;
         dmResource::LoadBufferType m_Buffer;
+        const void*                m_Data; // Set instead of m_Buffer for zero copy loads
+        uint32_t                   m_DataSize;
+        uint32_t                   m_MountIndex; // Where the resource is stored, to sort the reads
+        uint32_t                   m_Offset;
         PreloadInfo                m_PreloadInfo;
         LoadResult                 m_Result;
+        RequestState               m_State;
     };
 
     struct Queue
@@ -52,37 +68,107 @@ namespace dmLoadQueue
         dmResource::HFactory                    m_Factory;
         dmMutex::HMutex                         m_Mutex;
         dmConditionVariable::HConditionVariable m_WakeupCond;
-        dmThread::Thread                        m_Thread;
+        dmArray<dmThread::Thread>               m_Threads;
         uint32_t                                m_Front;
         uint32_t                                m_Back;
-        uint32_t                                m_Loaded;
         uint64_t                                m_BytesWaiting;
+        // Once the loaders have this amount not picked up, they will stop loading more.
+        // This sets the bandwidth of the loader.
+        uint64_t                                m_MaxPendingData;
+        uint32_t                                m_LastMountIndex; // Position of the last read
+        uint32_t                                m_LastOffset;
         bool                                    m_Shutdown;
 
         // Circular queue with indexing as follow (exclusive end)
         //
-        //          m_Back           m_Loaded   m_Front
-        // [N/A]   [loaded] [loaded] [to-load]  [N/A]
+        //          m_Back                       m_Front
+        // [N/A]   [loaded] [loading] [to-load]  [N/A]
         //
+        // Since the requests are loaded by priority, the states within the range can come in any order
     };
 
+    static inline uint64_t GetReadPosition(uint32_t mount_index, uint32_t offset)
+    {
+        return ((uint64_t)mount_index << 32) | offset;
+    }
+
     static Request* GetNextRequest(Queue* queue)
     {
         // Since we can be loading many things at once, track the total Capacity() for buffers
         // that are waiting to be picked up by the preloader. In the case of the queue being filled
         // with only large requests (say only 4Mb textures), this throttles a bit so memory consumption
         // does not run away.
-        if (queue->m_BytesWaiting >= MAX_PENDING_DATA)
+        if (queue->m_BytesWaiting >= queue->m_MaxPendingData)
         {
             return 0x0;
         }
 
-        if (queue->m_Loaded == queue->m_Front)
+        uint64_t last = GetReadPosition(queue->m_LastMountIndex, queue->m_LastOffset);
+
+        Request* best = 0x0;
+        bool best_ahead = false;
+        for (uint32_t i = queue->m_Back; i != queue->m_Front; ++i)
         {
-            return 0x0;
+            Request* r = &queue->m_Request[i % QUEUE_SLOTS];
+            if (r->m_State != REQUEST_STATE_PENDING)
+                continue;
+
+            uint64_t pos = GetReadPosition(r->m_MountIndex, r->m_Offset);
+            bool ahead = pos >= last;
+            if (best == 0x0 || r->m_PreloadInfo.m_Priority > best->m_PreloadInfo.m_Priority)
+            {
+                best = r;
+                best_ahead = ahead;
+                continue;
+            }
+            if (r->m_PreloadInfo.m_Priority < best->m_PreloadInfo.m_Priority)
+                continue;
+
+            // Same priority: prefer the closest read ahead of the last one, and only wrap around when there are none left
+            uint64_t best_pos = GetReadPosition(best->m_MountIndex, best->m_Offset);
+            if ((ahead && !best_ahead) || (ahead == best_ahead && pos < best_pos))
+            {
+                best = r;
+                best_ahead = ahead;
+            }
+        }
+
+        if (best)
+        {
+            best->m_State = REQUEST_STATE_LOADING;
+            queue->m_LastMountIndex = best->m_MountIndex;
+            queue->m_LastOffset     = best->m_Offset;
         }
+        return best;
+    }
 
-        return &queue->m_Request[queue->m_Loaded % QUEUE_SLOTS];
+    // Runs the create function of a resource without dependencies, the rest is done by the preloader on the main thread
+    static void CreateResource(Queue* queue, Request* request, const void* data, uint32_t size, LoadResult* result)
+    {
+        HResourceType type = request->m_PreloadInfo.m_CreateType;
+
+        ResourceDescriptor* resource = &result->m_Resource;
+        memset(resource, 0, sizeof(*resource));
+        resource->m_NameHash           = dmHashString64(request->m_CanonicalPath);
+        resource->m_ReferenceCount     = 1;
+        resource->m_ResourceType       = type;
+        resource->m_ResourceSizeOnDisc = size;
+        resource->m_ContentHash        = dmResource::GetContentHash(queue->m_Factory, data, size);
+
+        ResourceCreateParams params;
+        params.m_Factory     = queue->m_Factory;
+        params.m_Type        = type;
+        params.m_Context     = type->m_Context;
+        params.m_Buffer      = data;
+        params.m_BufferSize  = size;
+        params.m_PreloadData = result->m_PreloadData;
+        params.m_Resource    = resource;
+        params.m_Filename    = request->m_Name;
+
+        uint64_t phase_start  = dmTime::GetTime();
+        result->m_CreateResult = (dmResource::Result)type->m_CreateFunction(&params);
+        result->m_Created      = 1;
+        dmResource::AddLoadPhaseTime(&result->m_Timing, dmResource::LOAD_PHASE_CREATE, phase_start);
     }
 
     static void LoadThread(void* arg)
@@ -98,8 +184,8 @@ namespace dmLoadQueue
                 {
                     // Just finished one (from previous iteration)
                     queue->m_BytesWaiting += current->m_Buffer.Capacity();
-                    queue->m_Loaded++;
                     current->m_Result = result;
+                    current->m_State  = REQUEST_STATE_LOADED;
                     current           = 0;
                 }
                 if (queue->m_Shutdown)
@@ -114,7 +200,7 @@ namespace dmLoadQueue
                     for (uint32_t i = 0; i < QUEUE_SLOTS; ++i)
                     {
                         Request* r = &queue->m_Request[i];
-                        if (r->m_Buffer.Size() == 0)
+                        if (r->m_Buffer.Size() == 0 && r->m_State != REQUEST_STATE_LOADING)
                         {
                             if (r->m_Buffer.Capacity() > DEFAULT_CAPACITY)
                             {
@@ -139,28 +225,64 @@ namespace dmLoadQueue
                     current->m_Buffer.SetCapacity(DEFAULT_CAPACITY);
                 }
 
-                result.m_LoadResult = dmResource::LoadResourceFromBuffer(queue->m_Factory, current->m_CanonicalPath, current->m_Name, &size, &current->m_Buffer);
+                const void* data = 0;
+                result.m_LoadResult    = dmResource::RESULT_NOT_SUPPORTED;
                 result.m_PreloadResult = dmResource::RESULT_PENDING;
                 result.m_PreloadData   = 0;
+                result.m_ZeroCopy      = 0;
+                result.m_Created       = 0;
+                result.m_Timing        = current->m_Result.m_Timing;
+
+                uint64_t phase_start = dmResource::AddLoadPhaseTime(&result.m_Timing, dmResource::LOAD_PHASE_QUEUE, result.m_Timing.m_Start);
+                dmResource::BeginReadTiming(&result.m_Timing);
+
+                if (current->m_PreloadInfo.m_ZeroCopy)
+                {
+                    result.m_LoadResult = dmResource::LoadResourceData(queue->m_Factory, current->m_CanonicalPath, &data, &size);
+                    result.m_ZeroCopy   = result.m_LoadResult == dmResource::RESULT_OK;
+                }
+
+                if (result.m_LoadResult == dmResource::RESULT_NOT_SUPPORTED)
+                {
+                    if (current->m_PreloadInfo.m_StreamType)
+                        result.m_LoadResult = dmResource::LoadResourceHeaderFromBuffer(queue->m_Factory, current->m_PreloadInfo.m_StreamType, current->m_CanonicalPath, current->m_Name, &size, &current->m_Buffer);
+                    else
+                        result.m_LoadResult = dmResource::LoadResourceFromBuffer(queue->m_Factory, current->m_CanonicalPath, current->m_Name, &size, &current->m_Buffer);
+                    if (result.m_LoadResult == dmResource::RESULT_OK)
+                    {
+                        assert(current->m_Buffer.Size() == size);
+                        data = current->m_Buffer.Begin();
+                    }
+                }
+
+                dmResource::EndReadTiming(&result.m_Timing, result.m_LoadResult == dmResource::RESULT_OK ? size : 0);
 
                 if (result.m_LoadResult == dmResource::RESULT_OK)
                 {
-                    assert(current->m_Buffer.Size() == size);
+                    current->m_Data     = data;
+                    current->m_DataSize = size;
                     if (current->m_PreloadInfo.m_CompleteFunction)
                     {
                         ResourcePreloadParams params;
                         params.m_Factory       = queue->m_Factory;
                         params.m_Context       = current->m_PreloadInfo.m_Context;
-                        params.m_Buffer        = current->m_Buffer.Begin();
-                        params.m_BufferSize    = current->m_Buffer.Size();
+                        params.m_Buffer        = data;
+                        params.m_BufferSize    = size;
                         params.m_HintInfo      = &current->m_PreloadInfo.m_HintInfo;
                         params.m_PreloadData   = &result.m_PreloadData;
+                        phase_start = dmTime::GetTime();
                         result.m_PreloadResult = (dmResource::Result)current->m_PreloadInfo.m_CompleteFunction(&params);
+                        dmResource::AddLoadPhaseTime(&result.m_Timing, dmResource::LOAD_PHASE_PRELOAD, phase_start);
                     }
                     else
                     {
                         result.m_PreloadResult = dmResource::RESULT_OK;
                     }
+
+                    if (result.m_PreloadResult == dmResource::RESULT_OK && current->m_PreloadInfo.m_CreateType && current->m_PreloadInfo.m_HintInfo.m_HintCount == 0)
+                    {
+                        CreateResource(queue, current, data, size, &result);
+                    }
                 }
             }
         }
@@ -172,12 +294,30 @@ namespace dmLoadQueue
         q->m_Factory      = factory;
         q->m_Front        = 0;
         q->m_Back         = 0;
-        q->m_Loaded       = 0;
         q->m_Shutdown     = false;
         q->m_BytesWaiting = 0;
+        q->m_LastMountIndex = 0;
+        q->m_LastOffset   = 0;
+        q->m_MaxPendingData = dmResource::GetLoaderMaxPendingData(factory);
         q->m_Mutex        = dmMutex::New();
         q->m_WakeupCond   = dmConditionVariable::New();
-        q->m_Thread       = dmThread::New(&LoadThread, 128 * 1024, q, "AsyncLoad");
+
+        for (uint32_t i = 0; i < QUEUE_SLOTS; ++i)
+        {
+            q->m_Request[i].m_State    = REQUEST_STATE_FREE;
+            q->m_Request[i].m_Data     = 0x0;
+            q->m_Request[i].m_DataSize = 0;
+        }
+
+        // More threads than slots would never have anything to do
+        uint32_t thread_count = dmMath::Min(dmResource::GetLoaderThreadCount(factory), QUEUE_SLOTS);
+        q->m_Threads.SetCapacity(thread_count);
+        for (uint32_t i = 0; i < thread_count; ++i)
+        {
+            char name[32];
+            dmSnPrintf(name, sizeof(name), i == 0 ? "AsyncLoad" : "AsyncLoad%u", i);
+            q->m_Threads.Push(dmThread::New(&LoadThread, 128 * 1024, q, name));
+        }
 
         return q;
     }
@@ -187,10 +327,13 @@ namespace dmLoadQueue
         {
             dmMutex::ScopedLock lk(queue->m_Mutex);
             queue->m_Shutdown = true;
-            // Wake up the worker so it can exit and allow us to join
-            dmConditionVariable::Signal(queue->m_WakeupCond);
+            // Wake up the workers so they can exit and allow us to join
+            dmConditionVariable::Broadcast(queue->m_WakeupCond);
+        }
+        for (uint32_t i = 0; i < queue->m_Threads.Size(); ++i)
+        {
+            dmThread::Join(queue->m_Threads[i]);
         }
-        dmThread::Join(queue->m_Thread);
         dmConditionVariable::Delete(queue->m_WakeupCond);
         dmMutex::Delete(queue->m_Mutex);
         delete queue;
@@ -203,24 +346,37 @@ namespace dmLoadQueue
         assert(canonical_path != 0);
         assert(canonical_path[0] != 0);
 
+        // Look up the location before taking the queue lock, as the loader threads may be waiting on it
+        uint32_t mount_index = 0;
+        uint32_t offset = 0;
+        if (dmResource::RESULT_OK != dmResource::GetResourceLocation(queue->m_Factory, canonical_path, &mount_index, &offset))
+        {
+            mount_index = 0;
+            offset = 0;
+        }
+
         dmMutex::ScopedLock lk(queue->m_Mutex);
 
         // Refuse more if full.
         if ((queue->m_Front - queue->m_Back) == QUEUE_SLOTS)
             return 0;
 
-        if (queue->m_Loaded == queue->m_Front)
-        {
-            // The worker is sleeping waiting for request, wake it up
-            dmConditionVariable::Signal(queue->m_WakeupCond);
-        }
+        // Wake up a worker sleeping waiting for request
+        dmConditionVariable::Signal(queue->m_WakeupCond);
 
         Request* req         = &queue->m_Request[(queue->m_Front++) % QUEUE_SLOTS];
+        assert(req->m_State == REQUEST_STATE_FREE);
         req->m_Name          = name;
         req->m_CanonicalPath = canonical_path;
+        req->m_State         = REQUEST_STATE_PENDING;
+        req->m_Data          = 0;
+        req->m_DataSize      = 0;
+        req->m_MountIndex    = mount_index;
+        req->m_Offset        = offset;
 
         req->m_PreloadInfo         = *info;
         req->m_Result.m_LoadResult = dmResource::RESULT_PENDING;
+        dmResource::InitLoadTiming(&req->m_Result.m_Timing);
 
         return req;
     }
@@ -228,11 +384,11 @@ namespace dmLoadQueue
     Result EndLoad(HQueue queue, HRequest request, void** buf, uint32_t* size, LoadResult* load_result)
     {
         dmMutex::ScopedLock lk(queue->m_Mutex);
-        if (request->m_Result.m_LoadResult == dmResource::RESULT_PENDING)
+        if (request->m_State != REQUEST_STATE_LOADED)
             return RESULT_PENDING;
 
-        *buf         = request->m_Buffer.Begin();
-        *size        = request->m_Buffer.Size();
+        *buf         = (void*)request->m_Data;
+        *size        = request->m_DataSize;
         *load_result = request->m_Result;
 
         return RESULT_OK;
@@ -242,26 +398,33 @@ namespace dmLoadQueue
     {
         dmMutex::ScopedLock lk(queue->m_Mutex);
 
-        uint32_t old_bytes_waiting = queue->m_BytesWaiting;
+        uint64_t old_bytes_waiting = queue->m_BytesWaiting;
 
         // Make sure we don't copy any data if we reallocate the buffer
         request->m_Buffer.SetSize(0);
 
         uint32_t buffer_capacity = request->m_Buffer.Capacity();
         queue->m_BytesWaiting -= buffer_capacity;
-        // If we either have blocked further processing by exceeding MAX_PENDING_DATA or
-        // the buffer has a non-default capacity, we want to wake up the worker
-        if (buffer_capacity != DEFAULT_CAPACITY || (old_bytes_waiting >= MAX_PENDING_DATA && queue->m_BytesWaiting < MAX_PENDING_DATA))
+        // If we either have blocked further processing by exceeding m_MaxPendingData or
+        // the buffer has a non-default capacity, we want to wake up the workers
+        if (old_bytes_waiting >= queue->m_MaxPendingData && queue->m_BytesWaiting < queue->m_MaxPendingData)
+        {
+            // Wake up the threads, we can now fit new requests
+            dmConditionVariable::Broadcast(queue->m_WakeupCond);
+        }
+        else if (buffer_capacity != DEFAULT_CAPACITY)
         {
-            // Wake up thread, we can now fit a new request
             dmConditionVariable::Signal(queue->m_WakeupCond);
         }
 
         // Clean up picked up requests
         request->m_Name          = 0x0;
         request->m_CanonicalPath = 0x0;
+        request->m_Data          = 0x0;
+        request->m_DataSize      = 0;
+        request->m_State         = REQUEST_STATE_FREE;
 
-        while (queue->m_Back != queue->m_Loaded && queue->m_Request[queue->m_Back % QUEUE_SLOTS].m_Name == 0x0)
+        while (queue->m_Back != queue->m_Front && queue->m_Request[queue->m_Back % QUEUE_SLOTS].m_State == REQUEST_STATE_FREE)
         {
             queue->m_Back++;
         }
@@ -320,6 +320,19 @@ void ResourceTypeSetCreateFn(HResourceType type, FResourceCreate fn);
 void ResourceTypeSetPostCreateFn(HResourceType type, FResourcePostCreate fn);
 void ResourceTypeSetDestroyFn(HResourceType type, FResourceDestroy fn);
 void ResourceTypeSetRecreateFn(HResourceType type, FResourceRecreate fn);
+// Opt in to get the preload/create/recreate buffer straight from a memory mapped archive, when it is stored
+// uncompressed and unencrypted. The type functions must then not write to the buffer, nor keep it after returning.
+void ResourceTypeSetZeroCopy(HResourceType type, bool zero_copy);
+// Opt in to have the create function run on a loader thread, when the resource is preloaded and has no dependencies.
+// The create function must then only use the buffer and preload data, and not touch any other engine state.
+void ResourceTypeSetThreadSafeCreate(HResourceType type, bool thread_safe);
+// Opt in to keep unreferenced resources alive within the residency budget of the factory, so that they can be
+// revived instead of loaded again. The resources must not hold any state that should be reset when they are released.
+void ResourceTypeSetKeepResident(HResourceType type, bool keep_resident);
+// Opt in to only load the first header_size bytes of resources of at least min_size bytes, when the mount can read parts
+// of files. The create function then gets a buffer that is smaller than the file, and has to read the rest itself.
+// Recreate always gets the whole file.
+void ResourceTypeSetStreamed(HResourceType type, uint32_t min_size, uint32_t header_size);
 
 // internal
 ResourceResult ResourceRegisterType(HResourceFactory factory,
@@ -33,6 +33,11 @@ namespace dmResource
         return RESULT_OK;
     }
 
+    void PrefetchMappedData(const void* data, uint32_t size)
+    {
+        // Not used
+    }
+
     Result MountManifest(const char* manifest_filename, void*& out_map, uint32_t& out_size)
     {
         // Not used
@@ -18,6 +18,7 @@
 #include "provider.h"
 #include "provider_private.h"
 #include "../resource_private.h" // for logging
+#include "../resource_timeline.h"
 
 #include <dlib/hash.h>
 #include <dlib/log.h>
@@ -132,9 +133,33 @@ Result GetFileSize(HArchive archive, dmhash_t path_hash, const char* path, uint3
 
 Result ReadFile(HArchive archive, dmhash_t path_hash, const char* path, uint8_t* buffer, uint32_t buffer_len)
 {
+    dmResource::SetReadProvider(archive->m_Loader->m_NameHash);
     return archive->m_Loader->m_ReadFile(archive->m_Internal, path_hash, path, buffer, buffer_len);
 }
 
+Result GetFileData(HArchive archive, dmhash_t path_hash, const char* path, const uint8_t** data)
+{
+    dmResource::SetReadProvider(archive->m_Loader->m_NameHash);
+    if (archive->m_Loader->m_GetFileData)
+        return archive->m_Loader->m_GetFileData(archive->m_Internal, path_hash, path, data);
+    return RESULT_NOT_SUPPORTED;
+}
+
+Result ReadFilePartial(HArchive archive, dmhash_t path_hash, const char* path, uint32_t offset, uint8_t* buffer, uint32_t buffer_len, uint32_t* nread)
+{
+    dmResource::SetReadProvider(archive->m_Loader->m_NameHash);
+    if (archive->m_Loader->m_ReadFilePartial)
+        return archive->m_Loader->m_ReadFilePartial(archive->m_Internal, path_hash, path, offset, buffer, buffer_len, nread);
+    return RESULT_NOT_SUPPORTED;
+}
+
+Result GetFileOffset(HArchive archive, dmhash_t path_hash, const char* path, uint32_t* offset)
+{
+    if (archive->m_Loader->m_GetFileOffset)
+        return archive->m_Loader->m_GetFileOffset(archive->m_Internal, path_hash, path, offset);
+    return RESULT_NOT_SUPPORTED;
+}
+
 Result GetManifest(HArchive archive, dmResource::HManifest* out_manifest)
 {
     if (archive->m_Loader->m_GetManifest)
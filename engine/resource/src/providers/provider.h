@@ -50,6 +50,9 @@ namespace dmResourceProvider
 
     typedef Result (*FGetFileSize)(HArchiveInternal archive, dmhash_t path_hash, const char* path, uint32_t* file_size);
     typedef Result (*FReadFile)(HArchiveInternal archive, dmhash_t path_hash, const char* path, uint8_t* buffer, uint32_t buffer_len);
+    typedef Result (*FGetFileData)(HArchiveInternal archive, dmhash_t path_hash, const char* path, const uint8_t** data); // Optional. Returns RESULT_NOT_SUPPORTED if the file has to be read
+    typedef Result (*FReadFilePartial)(HArchiveInternal archive, dmhash_t path_hash, const char* path, uint32_t offset, uint8_t* buffer, uint32_t buffer_len, uint32_t* nread); // Optional. Returns RESULT_NOT_SUPPORTED if the file has to be read as a whole
+    typedef Result (*FGetFileOffset)(HArchiveInternal archive, dmhash_t path_hash, const char* path, uint32_t* offset); // Optional. Returns RESULT_NOT_SUPPORTED if the files aren't stored in a single file
     typedef Result (*FWriteFile)(HArchiveInternal archive, dmhash_t path_hash, const char* path, const uint8_t* buffer, uint32_t buffer_len);
     typedef Result (*FGetManifest)(HArchiveInternal, dmResource::HManifest*); // In order for other providers to get the base manifest
     typedef Result (*FSetManifest)(HArchiveInternal, dmResource::HManifest);  // In order to set a downloaded manifest to a provider
@@ -71,6 +74,12 @@ namespace dmResourceProvider
 
     Result GetFileSize(HArchive archive, dmhash_t path_hash, const char* path, uint32_t* file_size);
     Result ReadFile(HArchive archive, dmhash_t path_hash, const char* path, uint8_t* buffer, uint32_t buffer_len);
+    // Get a pointer to the file data without copying it (e.g. from a memory mapped archive). The size is given by GetFileSize()
+    Result GetFileData(HArchive archive, dmhash_t path_hash, const char* path, const uint8_t** data);
+    // Read up to buffer_len bytes of the file, starting at offset. nread is less than buffer_len at the end of the file
+    Result ReadFilePartial(HArchive archive, dmhash_t path_hash, const char* path, uint32_t offset, uint8_t* buffer, uint32_t buffer_len, uint32_t* nread);
+    // Get the position of the file within the archive data, so that reads can be issued in the order they're stored on disc
+    Result GetFileOffset(HArchive archive, dmhash_t path_hash, const char* path, uint32_t* offset);
     Result WriteFile(HArchive archive, dmhash_t path_hash, const char* path, const uint8_t* buffer, uint32_t buffer_len);
 
 
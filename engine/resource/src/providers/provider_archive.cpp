@@ -234,6 +234,68 @@ namespace dmResourceProviderArchive
         return dmResourceProvider::RESULT_NOT_FOUND;
     }
 
+    static dmResourceProvider::Result GetFileData(dmResourceProvider::HArchiveInternal internal, dmhash_t path_hash, const char* path, const uint8_t** data)
+    {
+        GameArchiveFile* archive = (GameArchiveFile*)internal;
+        EntryInfo* entry = archive->m_EntryMap.Get(path_hash);
+        if (entry)
+        {
+            if (dmResourceArchive::GetEntryData(archive->m_ArchiveIndex, entry->m_ArchiveInfo, data))
+                return dmResourceProvider::RESULT_OK;
+            return dmResourceProvider::RESULT_NOT_SUPPORTED;
+        }
+
+        return dmResourceProvider::RESULT_NOT_FOUND;
+    }
+
+    static dmResourceProvider::Result ReadFilePartial(dmResourceProvider::HArchiveInternal internal, dmhash_t path_hash, const char* path, uint32_t offset, uint8_t* buffer, uint32_t buffer_len, uint32_t* nread)
+    {
+        GameArchiveFile* archive = (GameArchiveFile*)internal;
+        EntryInfo* entry = archive->m_EntryMap.Get(path_hash);
+        if (entry)
+        {
+            const uint32_t flags = dmEndian::ToNetwork(entry->m_ArchiveInfo->m_Flags);
+            if (flags & (dmResourceArchive::ENTRY_FLAG_ENCRYPTED | dmResourceArchive::ENTRY_FLAG_COMPRESSED))
+                return dmResourceProvider::RESULT_NOT_SUPPORTED;
+            if (dmResourceArchive::ReadEntryPartial(archive->m_ArchiveIndex, entry->m_ArchiveInfo, offset, buffer, buffer_len, nread) != dmResourceArchive::RESULT_OK)
+                return dmResourceProvider::RESULT_IO_ERROR;
+            return dmResourceProvider::RESULT_OK;
+        }
+
+        return dmResourceProvider::RESULT_NOT_FOUND;
+    }
+
+    static dmResourceProvider::Result GetFileOffset(dmResourceProvider::HArchiveInternal internal, dmhash_t path_hash, const char* path, uint32_t* offset)
+    {
+        GameArchiveFile* archive = (GameArchiveFile*)internal;
+        EntryInfo* entry = archive->m_EntryMap.Get(path_hash);
+        if (entry)
+        {
+            *offset = dmEndian::ToNetwork(entry->m_ArchiveInfo->m_ResourceDataOffset);
+            return dmResourceProvider::RESULT_OK;
+        }
+
+        return dmResourceProvider::RESULT_NOT_FOUND;
+    }
+
+    dmResourceProvider::Result GetFileDataRange(dmResourceProvider::HArchiveInternal internal, dmhash_t path_hash, uint32_t* offset, uint32_t* size)
+    {
+        GameArchiveFile* archive = (GameArchiveFile*)internal;
+        EntryInfo* entry = archive->m_EntryMap.Get(path_hash);
+        if (entry)
+        {
+            const uint32_t flags = dmEndian::ToNetwork(entry->m_ArchiveInfo->m_Flags);
+            *offset = dmEndian::ToNetwork(entry->m_ArchiveInfo->m_ResourceDataOffset);
+            if (flags & dmResourceArchive::ENTRY_FLAG_COMPRESSED)
+                *size = dmEndian::ToNetwork(entry->m_ArchiveInfo->m_ResourceCompressedSize);
+            else
+                *size = dmEndian::ToNetwork(entry->m_ArchiveInfo->m_ResourceSize);
+            return dmResourceProvider::RESULT_OK;
+        }
+
+        return dmResourceProvider::RESULT_NOT_FOUND;
+    }
+
     static dmResourceProvider::Result GetManifest(dmResourceProvider::HArchiveInternal internal, dmResource::HManifest* out_manifest)
     {
         GameArchiveFile* archive = (GameArchiveFile*)internal;
@@ -253,6 +315,9 @@ namespace dmResourceProviderArchive
         loader->m_GetManifest   = GetManifest;
         loader->m_GetFileSize   = GetFileSize;
         loader->m_ReadFile      = ReadFile;
+        loader->m_GetFileData   = GetFileData;
+        loader->m_ReadFilePartial = ReadFilePartial;
+        loader->m_GetFileOffset = GetFileOffset;
     }
 
     DM_DECLARE_ARCHIVE_LOADER(ResourceProviderArchive, "archive", SetupArchiveLoader);
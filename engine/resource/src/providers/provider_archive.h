@@ -30,6 +30,9 @@ namespace dmResourceProviderArchive
                 uint8_t* index_data, uint32_t index_data_len,
                 uint8_t* archive_data, uint32_t archive_data_len,
                 dmResourceProvider::HArchiveInternal* out_internal);
+
+    // Get the range of the (possibly compressed) file data within the archive data
+    dmResourceProvider::Result GetFileDataRange(dmResourceProvider::HArchiveInternal internal, dmhash_t path_hash, uint32_t* offset, uint32_t* size);
 }
 
 #endif // DM_RESOURCE_PROVIDER_ARCHIVE_H
@@ -197,6 +197,7 @@ namespace dmResourceProviderArchiveMutable
         dmResource::HManifest manifest = new dmResource::Manifest;
         dmDDF::CopyMessage(base_manifest->m_DDF, dmLiveUpdateDDF::ManifestFile::m_DDFDescriptor, (void**)&manifest->m_DDF);
         dmDDF::CopyMessage(base_manifest->m_DDFData, dmLiveUpdateDDF::ManifestData::m_DDFDescriptor, (void**)&manifest->m_DDFData);
+        dmResource::BuildEntryLookup(manifest);
 
         return manifest;
     }
@@ -423,8 +424,9 @@ namespace dmResourceProviderArchiveMutable
         if (archive->m_EntryMap.Empty())
             return dmResourceProvider::RESULT_NOT_FOUND;
 
+        // Entries from the manifest that haven't been stored yet are found in the other mounts
         EntryInfo* entry = archive->m_EntryMap.Get(path_hash);
-        if (!entry)
+        if (!entry || !entry->m_ArchiveInfo)
             return dmResourceProvider::RESULT_NOT_FOUND;
 
         if (buffer_len < dmEndian::ToNetwork(entry->m_ArchiveInfo->m_ResourceSize))
@@ -112,6 +112,37 @@ namespace dmResourceProviderFile
         return SysResultToProviderResult(r);
     }
 
+    static dmResourceProvider::Result ReadFilePartial(dmResourceProvider::HArchiveInternal _archive, dmhash_t path_hash, const char* path, uint32_t offset, uint8_t* buffer, uint32_t buffer_len, uint32_t* nread)
+    {
+        FileProviderContext* archive = (FileProviderContext*)_archive;
+        (void)path_hash;
+
+        char path_buffer[DMPATH_MAX_PATH];
+        const char* resolved_path = ResolveFilePath(&archive->m_BaseUri, path, path_buffer, sizeof(path_buffer));
+        if (!resolved_path) {
+            return dmResourceProvider::RESULT_NOT_FOUND;
+        }
+
+        // E.g. Android assets can only be read as a whole (see dmSys::LoadResource)
+        FILE* f = fopen(resolved_path, "rb");
+        if (!f) {
+            return dmResourceProvider::RESULT_NOT_SUPPORTED;
+        }
+
+        dmResourceProvider::Result result = dmResourceProvider::RESULT_OK;
+        *nread = 0;
+        if (fseek(f, offset, SEEK_SET) == 0) {
+            *nread = (uint32_t)fread(buffer, 1, buffer_len, f);
+            if (*nread != buffer_len && ferror(f)) {
+                result = dmResourceProvider::RESULT_IO_ERROR;
+            }
+        } else {
+            result = dmResourceProvider::RESULT_IO_ERROR;
+        }
+        fclose(f);
+        return result;
+    }
+
     static void SetupArchiveLoader(dmResourceProvider::ArchiveLoader* loader)
     {
         loader->m_CanMount      = MatchesUri;
@@ -119,6 +150,7 @@ namespace dmResourceProviderFile
         loader->m_Unmount       = Unmount;
         loader->m_GetFileSize   = GetFileSize;
         loader->m_ReadFile      = ReadFile;
+        loader->m_ReadFilePartial = ReadFilePartial;
     }
 
     DM_DECLARE_ARCHIVE_LOADER(ResourceProviderFile, "file", SetupArchiveLoader);
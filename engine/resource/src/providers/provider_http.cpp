@@ -14,12 +14,15 @@
 
 #include "provider.h"
 #include "provider_private.h"
+#include "provider_archive.h"
 #include "../resource_util.h"
 
 #include <dlib/dstrings.h>
 #include <dlib/array.h>
 #include <dlib/hash.h>
 #include <dlib/log.h>
+#include <dlib/math.h>
+#include <dlib/memory.h>
 #include <dlib/sys.h>
 
 #include <dlib/http_client.h>
@@ -31,6 +34,9 @@
 namespace dmResourceProviderHttp
 {
 
+// The archive data is fetched in chunks of this size, as the resources in them are read
+static const uint32_t ARCHIVE_CHUNK_SIZE = 1024 * 1024;
+
 struct HttpProviderContext
 {
     dmURI::Parts            m_BaseUri;
@@ -41,6 +47,27 @@ struct HttpProviderContext
     int32_t                 m_HttpContentLength;        // Total number bytes loaded in current GET-request
     uint32_t                m_HttpTotalBytesStreamed;
     int                     m_HttpStatus;
+
+    // GetFileSize() fetches the whole file, since it's almost always followed by a ReadFile() of the same file.
+    // That way each resource costs one round trip instead of two.
+    dmhash_t                m_FetchedPathHash;
+
+    // When mounted on a .dmanifest, the manifest and the archive index are fetched when mounting, and the
+    // archive data is fetched with range requests as it's read. The rest of the data isn't waited for.
+    char                            m_ArchiveDataPath[dmResource::RESOURCE_PATH_MAX];
+    dmResourceProvider::HArchive    m_Archive;
+    dmResourceProvider::HArchiveInternal m_ArchiveInternal;
+    uint8_t*                        m_ArchiveIndexData;
+    uint8_t*                        m_ArchiveData;
+    uint32_t                        m_ArchiveDataSize;
+    dmArray<uint8_t>                m_ArchiveChunkFetched;
+
+    uint32_t                m_RangeStart;
+    uint32_t                m_RangeEnd;                 // Inclusive
+    uint32_t                m_RangeTotalSize;           // From the Content-Range response header
+
+    uint8_t                 m_HasFetchedFile:1;
+    uint8_t                 m_UseRange:1;
 };
 
 static void HttpHeader(dmHttpClient::HResponse response, void* user_data, int status_code, const char* key, const char* value)
@@ -60,6 +87,24 @@ static void HttpHeader(dmHttpClient::HResponse response, void* user_data, int st
             archive->m_HttpBuffer.SetSize(0);
         }
     }
+    else if (dmStrCaseCmp(key, "Content-Range") == 0)
+    {
+        // E.g. "bytes 0-1048575/83886080"
+        const char* total = strrchr(value, '/');
+        if (total && total[1] != '*')
+            archive->m_RangeTotalSize = (uint32_t)strtoul(total + 1, 0, 10);
+    }
+}
+
+static dmHttpClient::Result HttpWriteHeaders(dmHttpClient::HResponse response, void* user_data)
+{
+    HttpProviderContext* archive = (HttpProviderContext*)user_data;
+    if (!archive->m_UseRange)
+        return dmHttpClient::RESULT_OK;
+
+    char range[64];
+    dmSnPrintf(range, sizeof(range), "bytes=%u-%u", archive->m_RangeStart, archive->m_RangeEnd);
+    return dmHttpClient::WriteHeader(response, "Range", range);
 }
 
 static void HttpContent(dmHttpClient::HResponse, void* user_data, int status_code, const void* content_data, uint32_t content_data_size, int32_t content_length, const char* method)
@@ -103,6 +148,12 @@ static char* CreateEncodedUri(const dmURI::Parts* uri, const char* path, char* b
 static void DeleteHttpArchiveInternal(dmResourceProvider::HArchiveInternal _archive)
 {
     HttpProviderContext* archive = (HttpProviderContext*)_archive;
+    if (archive->m_Archive)
+        dmResourceProvider::Unmount(archive->m_Archive); // Also deletes the internal archive
+    if (archive->m_ArchiveIndexData)
+        dmMemory::AlignedFree(archive->m_ArchiveIndexData);
+    free(archive->m_ArchiveData);
+
     if (archive->m_HttpClient)
         dmHttpClient::Delete(archive->m_HttpClient);
     if (archive->m_HttpCache)
@@ -113,6 +164,8 @@ static void DeleteHttpArchiveInternal(dmResourceProvider::HArchiveInternal _arch
     delete archive;
 }
 
+static dmResourceProvider::Result MountArchive(HttpProviderContext* archive);
+
 static dmResourceProvider::Result Mount(const dmURI::Parts* uri, dmResourceProvider::HArchive base_archive, dmResourceProvider::HArchiveInternal* out_archive)
 {
     if (!MatchesUri(uri))
@@ -125,6 +178,7 @@ static dmResourceProvider::Result Mount(const dmURI::Parts* uri, dmResourceProvi
     dmHttpClient::NewParams http_params;
     http_params.m_HttpHeader = &HttpHeader;
     http_params.m_HttpContent = &HttpContent;
+    http_params.m_HttpWriteHeaders = &HttpWriteHeaders;
     http_params.m_Userdata = archive;
     http_params.m_HttpCache = archive->m_HttpCache;
     archive->m_HttpClient = dmHttpClient::New(&http_params, uri->m_Hostname, uri->m_Port, strcmp(uri->m_Scheme, "https") == 0, 0);
@@ -136,6 +190,17 @@ static dmResourceProvider::Result Mount(const dmURI::Parts* uri, dmResourceProvi
         return dmResourceProvider::RESULT_ERROR_UNKNOWN;
     }
 
+    const char* ext = strrchr(uri->m_Path, '.');
+    if (ext && strcmp(ext, ".dmanifest") == 0)
+    {
+        dmResourceProvider::Result result = MountArchive(archive);
+        if (result != dmResourceProvider::RESULT_OK)
+        {
+            DeleteHttpArchiveInternal(archive);
+            return result;
+        }
+    }
+
     *out_archive = (dmResourceProvider::HArchiveInternal)archive;
     return dmResourceProvider::RESULT_OK;
 }
@@ -151,7 +216,9 @@ static void ResetHttpInfo(HttpProviderContext* archive)
     archive->m_HttpContentLength = -1;
     archive->m_HttpTotalBytesStreamed = 0;
     archive->m_HttpStatus = -1;
+    archive->m_RangeTotalSize = 0;
     archive->m_HttpBuffer.SetSize(0);
+    archive->m_HasFetchedFile = 0;
 }
 
 // Note. This is used in a synchronous manner.
@@ -173,7 +240,8 @@ static dmResourceProvider::Result GetRequestFromUri(HttpProviderContext* archive
     //     dmHttpCache::SetConsistencyPolicy(factory->m_HttpCache, dmHttpCache::CONSISTENCY_POLICY_TRUSTED);
 
     bool http_result_ok = http_result == dmHttpClient::RESULT_OK ||
-                         (http_result == dmHttpClient::RESULT_NOT_200_OK && archive->m_HttpStatus == 304);
+                         (http_result == dmHttpClient::RESULT_NOT_200_OK && archive->m_HttpStatus == 304) ||
+                         (http_result == dmHttpClient::RESULT_NOT_200_OK && archive->m_HttpStatus == 206 && archive->m_UseRange);
 
     if (!http_result_ok)
     {
@@ -222,18 +290,200 @@ static dmResourceProvider::Result GetRequestFromUri(HttpProviderContext* archive
     return dmResourceProvider::RESULT_OK;
 }
 
+// Fetches the inclusive range of the archive data into the http buffer
+static dmResourceProvider::Result RequestArchiveRange(HttpProviderContext* archive, uint32_t start, uint32_t end)
+{
+    archive->m_UseRange = 1;
+    archive->m_RangeStart = start;
+    archive->m_RangeEnd = end;
+    uint32_t buffer_len = 0xFFFFFFFF;
+    dmResourceProvider::Result result = GetRequestFromUri(archive, "GET", archive->m_ArchiveDataPath, &buffer_len, 0);
+    archive->m_UseRange = 0;
+    return result;
+}
+
+static void SetArchiveChunksFetched(HttpProviderContext* archive, uint32_t first_chunk, uint32_t last_chunk)
+{
+    for (uint32_t chunk = first_chunk; chunk <= last_chunk; ++chunk)
+        archive->m_ArchiveChunkFetched[chunk] = 1;
+}
+
+// Makes sure the chunks covering the range of the archive data are fetched. Consecutive missing chunks are fetched with one request.
+static dmResourceProvider::Result FetchArchiveData(HttpProviderContext* archive, uint32_t offset, uint32_t size)
+{
+    if (size == 0)
+        return dmResourceProvider::RESULT_OK;
+    if (offset + size > archive->m_ArchiveDataSize)
+        return dmResourceProvider::RESULT_IO_ERROR;
+
+    const uint32_t last_chunk = (offset + size - 1) / ARCHIVE_CHUNK_SIZE;
+    uint32_t chunk = offset / ARCHIVE_CHUNK_SIZE;
+    while (chunk <= last_chunk)
+    {
+        if (archive->m_ArchiveChunkFetched[chunk])
+        {
+            ++chunk;
+            continue;
+        }
+
+        uint32_t end_chunk = chunk;
+        while (end_chunk < last_chunk && !archive->m_ArchiveChunkFetched[end_chunk + 1])
+            ++end_chunk;
+
+        const uint32_t start = chunk * ARCHIVE_CHUNK_SIZE;
+        const uint32_t end = dmMath::Min((end_chunk + 1) * ARCHIVE_CHUNK_SIZE, archive->m_ArchiveDataSize) - 1;
+        dmResourceProvider::Result result = RequestArchiveRange(archive, start, end);
+        if (result != dmResourceProvider::RESULT_OK)
+            return result;
+
+        if (archive->m_HttpStatus == 206 && archive->m_HttpTotalBytesStreamed == end - start + 1)
+        {
+            memcpy(archive->m_ArchiveData + start, archive->m_HttpBuffer.Begin(), archive->m_HttpTotalBytesStreamed);
+            SetArchiveChunksFetched(archive, chunk, end_chunk);
+        }
+        else if (archive->m_HttpTotalBytesStreamed == archive->m_ArchiveDataSize)
+        {
+            // The server ignored the range, and sent all the data
+            memcpy(archive->m_ArchiveData, archive->m_HttpBuffer.Begin(), archive->m_ArchiveDataSize);
+            SetArchiveChunksFetched(archive, 0, archive->m_ArchiveChunkFetched.Size() - 1);
+        }
+        else
+        {
+            dmLogError("Unexpected response for the range %u-%u of '%s' (status %d, %u bytes)", start, end, archive->m_ArchiveDataPath, archive->m_HttpStatus, archive->m_HttpTotalBytesStreamed);
+            return dmResourceProvider::RESULT_IO_ERROR;
+        }
+        chunk = end_chunk + 1;
+    }
+    return dmResourceProvider::RESULT_OK;
+}
+
+static dmResourceProvider::Result MountArchive(HttpProviderContext* archive)
+{
+    // Split "/some/dir/game.dmanifest" into the base path and the archive name
+    char name[dmResource::RESOURCE_PATH_MAX];
+    char* slash = strrchr(archive->m_BaseUri.m_Path, '/');
+    dmStrlCpy(name, slash ? slash + 1 : archive->m_BaseUri.m_Path, sizeof(name));
+    *strrchr(name, '.') = 0;
+    if (slash)
+        *slash = 0;
+    else
+        archive->m_BaseUri.m_Path[0] = 0;
+
+    char path[dmResource::RESOURCE_PATH_MAX];
+    uint32_t buffer_len = 0xFFFFFFFF;
+    dmSnPrintf(path, sizeof(path), "%s.dmanifest", name);
+    dmResourceProvider::Result result = GetRequestFromUri(archive, "GET", path, &buffer_len, 0);
+    if (result != dmResourceProvider::RESULT_OK)
+    {
+        dmLogError("Failed to fetch the manifest '%s': %d", path, result);
+        return result;
+    }
+    dmArray<uint8_t> manifest_data;
+    manifest_data.SetCapacity(buffer_len);
+    manifest_data.PushArray((const uint8_t*)archive->m_HttpBuffer.Begin(), buffer_len);
+
+    buffer_len = 0xFFFFFFFF;
+    dmSnPrintf(path, sizeof(path), "%s.arci", name);
+    result = GetRequestFromUri(archive, "GET", path, &buffer_len, 0);
+    if (result != dmResourceProvider::RESULT_OK)
+    {
+        dmLogError("Failed to fetch the archive index '%s': %d", path, result);
+        return result;
+    }
+    uint32_t index_size = buffer_len;
+    dmMemory::AlignedMalloc((void**)&archive->m_ArchiveIndexData, 16, index_size);
+    memcpy(archive->m_ArchiveIndexData, archive->m_HttpBuffer.Begin(), index_size);
+
+    // The first chunk also tells us the size of the archive data
+    dmSnPrintf(archive->m_ArchiveDataPath, sizeof(archive->m_ArchiveDataPath), "%s.arcd", name);
+    result = RequestArchiveRange(archive, 0, ARCHIVE_CHUNK_SIZE - 1);
+    if (result != dmResourceProvider::RESULT_OK)
+    {
+        dmLogError("Failed to fetch the archive data '%s': %d", archive->m_ArchiveDataPath, result);
+        return result;
+    }
+    archive->m_ArchiveDataSize = archive->m_HttpStatus == 206 ? archive->m_RangeTotalSize : archive->m_HttpTotalBytesStreamed;
+    if (archive->m_HttpTotalBytesStreamed > archive->m_ArchiveDataSize)
+    {
+        dmLogError("Unexpected size of the archive data '%s' (%u bytes)", archive->m_ArchiveDataPath, archive->m_ArchiveDataSize);
+        return dmResourceProvider::RESULT_IO_ERROR;
+    }
+    archive->m_ArchiveData = (uint8_t*)malloc(dmMath::Max(1U, archive->m_ArchiveDataSize));
+    memcpy(archive->m_ArchiveData, archive->m_HttpBuffer.Begin(), archive->m_HttpTotalBytesStreamed);
+
+    uint32_t chunk_count = (archive->m_ArchiveDataSize + ARCHIVE_CHUNK_SIZE - 1) / ARCHIVE_CHUNK_SIZE;
+    archive->m_ArchiveChunkFetched.SetCapacity(dmMath::Max(1U, chunk_count));
+    archive->m_ArchiveChunkFetched.SetSize(chunk_count);
+    if (chunk_count)
+    {
+        memset(archive->m_ArchiveChunkFetched.Begin(), 0, chunk_count);
+        SetArchiveChunksFetched(archive, 0, (archive->m_HttpTotalBytesStreamed - 1) / ARCHIVE_CHUNK_SIZE);
+    }
+    ResetHttpInfo(archive);
+
+    result = dmResourceProviderArchive::CreateArchive(manifest_data.Begin(), manifest_data.Size(),
+                                                      archive->m_ArchiveIndexData, index_size,
+                                                      archive->m_ArchiveData, archive->m_ArchiveDataSize,
+                                                      &archive->m_ArchiveInternal);
+    if (result != dmResourceProvider::RESULT_OK)
+    {
+        dmLogError("Failed to create the archive from '%s': %d", name, result);
+        return result;
+    }
+
+    dmResourceProvider::HArchiveLoader loader = dmResourceProvider::FindLoaderByName(dmHashString64("archive"));
+    return dmResourceProvider::CreateMount(loader, archive->m_ArchiveInternal, &archive->m_Archive);
+}
+
 static dmResourceProvider::Result GetFileSize(dmResourceProvider::HArchiveInternal _archive, dmhash_t path_hash, const char* path, uint32_t* file_size)
 {
     HttpProviderContext* archive = (HttpProviderContext*)_archive;
-    (void)path_hash;
+    if (archive->m_Archive)
+        return dmResourceProvider::GetFileSize(archive->m_Archive, path_hash, path, file_size);
 
-    return GetRequestFromUri((HttpProviderContext*)archive, "HEAD", path, file_size, 0);
+    // The path hash isn't always set by the caller
+    dmhash_t fetched_path_hash = dmHashString64(path);
+    if (archive->m_HasFetchedFile && archive->m_FetchedPathHash == fetched_path_hash)
+    {
+        *file_size = archive->m_HttpTotalBytesStreamed;
+        return dmResourceProvider::RESULT_OK;
+    }
+
+    uint32_t buffer_len = 0xFFFFFFFF;
+    dmResourceProvider::Result result = GetRequestFromUri((HttpProviderContext*)archive, "GET", path, &buffer_len, 0);
+    if (result != dmResourceProvider::RESULT_OK)
+    {
+        return result;
+    }
+
+    archive->m_FetchedPathHash = fetched_path_hash;
+    archive->m_HasFetchedFile = 1;
+    *file_size = buffer_len;
+    return dmResourceProvider::RESULT_OK;
 }
 
 static dmResourceProvider::Result ReadFile(dmResourceProvider::HArchiveInternal _archive, dmhash_t path_hash, const char* path, uint8_t* buffer, uint32_t _buffer_len)
 {
     HttpProviderContext* archive = (HttpProviderContext*)_archive;
-    (void)path_hash;
+    if (archive->m_Archive)
+    {
+        uint32_t offset, size;
+        dmResourceProvider::Result result = dmResourceProviderArchive::GetFileDataRange(archive->m_ArchiveInternal, path_hash, &offset, &size);
+        if (result == dmResourceProvider::RESULT_OK)
+            result = FetchArchiveData(archive, offset, size);
+        if (result != dmResourceProvider::RESULT_OK)
+            return result;
+        return dmResourceProvider::ReadFile(archive->m_Archive, path_hash, path, buffer, _buffer_len);
+    }
+
+    if (archive->m_HasFetchedFile && archive->m_FetchedPathHash == dmHashString64(path))
+    {
+        archive->m_HasFetchedFile = 0;
+        if (archive->m_HttpTotalBytesStreamed > _buffer_len)
+            return dmResourceProvider::RESULT_IO_ERROR;
+        memcpy(buffer, archive->m_HttpBuffer.Begin(), archive->m_HttpTotalBytesStreamed);
+        return dmResourceProvider::RESULT_OK;
+    }
 
     uint32_t buffer_len = _buffer_len;
     dmResourceProvider::Result result = GetRequestFromUri((HttpProviderContext*)archive, "GET", path, &buffer_len, buffer);
@@ -244,6 +494,22 @@ static dmResourceProvider::Result ReadFile(dmResourceProvider::HArchiveInternal
     return dmResourceProvider::RESULT_OK;
 }
 
+static dmResourceProvider::Result GetFileOffset(dmResourceProvider::HArchiveInternal _archive, dmhash_t path_hash, const char* path, uint32_t* offset)
+{
+    HttpProviderContext* archive = (HttpProviderContext*)_archive;
+    if (!archive->m_Archive)
+        return dmResourceProvider::RESULT_NOT_SUPPORTED;
+    return dmResourceProvider::GetFileOffset(archive->m_Archive, path_hash, path, offset);
+}
+
+static dmResourceProvider::Result GetManifest(dmResourceProvider::HArchiveInternal _archive, dmResource::HManifest* out_manifest)
+{
+    HttpProviderContext* archive = (HttpProviderContext*)_archive;
+    if (!archive->m_Archive)
+        return dmResourceProvider::RESULT_NOT_FOUND;
+    return dmResourceProvider::GetManifest(archive->m_Archive, out_manifest);
+}
+
 static void SetupArchiveLoaderHttp(dmResourceProvider::ArchiveLoader* loader)
 {
     loader->m_CanMount      = MatchesUri;
@@ -251,6 +517,8 @@ static void SetupArchiveLoaderHttp(dmResourceProvider::ArchiveLoader* loader)
     loader->m_Unmount       = Unmount;
     loader->m_GetFileSize   = GetFileSize;
     loader->m_ReadFile      = ReadFile;
+    loader->m_GetFileOffset = GetFileOffset;
+    loader->m_GetManifest   = GetManifest;
 }
 
 DM_DECLARE_ARCHIVE_LOADER(ResourceProviderHttp, "http", SetupArchiveLoaderHttp);
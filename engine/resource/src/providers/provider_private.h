@@ -38,6 +38,9 @@ namespace dmResourceProvider
 
         FGetFileSize            m_GetFileSize;
         FReadFile               m_ReadFile;
+        FGetFileData            m_GetFileData;      // For archives that can return the data without copying
+        FReadFilePartial        m_ReadFilePartial;  // For archives that can read a range of a file (e.g. for streaming)
+        FGetFileOffset          m_GetFileOffset;    // For archives that store all files in one data file
         FWriteFile              m_WriteFile;        // For writeable archives
 
         void Verify();
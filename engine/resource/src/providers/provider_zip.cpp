@@ -19,6 +19,7 @@
 #include "../resource_manifest.h"
 #include "../resource_manifest_private.h"
 #include "../resource_private.h"
+#include "../resource_timeline.h"
 
 #include <dlib/dstrings.h>
 #include <dlib/endian.h>
@@ -28,6 +29,7 @@
 #include <dlib/lz4.h>
 #include <dlib/math.h>
 #include <dlib/memory.h>
+#include <dlib/profile.h>
 #include <dlib/sys.h>
 #include <dlib/zip.h>
 
@@ -41,6 +43,9 @@ struct EntryInfo
     dmLiveUpdateDDF::ResourceEntry* m_ManifestEntry; // If it's a resource provided by the manifest
     uint32_t                        m_Size;          // Used when there is no resource entry
     uint32_t                        m_EntryIndex;
+    uint32_t                        m_RawSize;       // The size of the entry in the zip file
+    uint32_t                        m_DataOffset;    // Offset into the mapped zip file, if m_Mapped is set
+    uint8_t                         m_Mapped:1;      // The entry is stored uncompressed, and can be read from the mapped zip file
 };
 
 struct ZipProviderContext
@@ -49,6 +54,8 @@ struct ZipProviderContext
     dmZip::HZip                 m_Zip;
     dmResource::HManifest       m_Manifest;
     dmHashTable64<EntryInfo>    m_EntryMap; // url hash -> entry in the manifest
+    void*                       m_Map;      // The memory mapped zip file, if supported by the platform
+    uint32_t                    m_MapSize;
 };
 
 
@@ -70,6 +77,8 @@ static void DeleteZipArchiveInternal(dmResourceProvider::HArchiveInternal _archi
         dmResource::DeleteManifest(archive->m_Manifest);
     if (archive->m_Zip)
         dmZip::Close(archive->m_Zip);
+    if (archive->m_Map)
+        dmResource::UnmapFile(archive->m_Map, archive->m_MapSize);
     delete archive;
 }
 
@@ -101,6 +110,17 @@ static void CreateEntryMap(ZipProviderContext* archive)
         info.m_ManifestEntry = 0;
         dmZip::GetEntrySize(zip, &info.m_Size);
         dmZip::GetEntryIndex(zip, &info.m_EntryIndex);
+        info.m_RawSize = info.m_Size;
+        info.m_DataOffset = 0;
+        info.m_Mapped = 0;
+
+        uint32_t data_offset;
+        if (archive->m_Map && dmZip::IsEntryStored(zip) && dmZip::RESULT_OK == dmZip::GetEntryDataOffset(zip, &data_offset) &&
+            data_offset <= archive->m_MapSize && info.m_Size <= archive->m_MapSize - data_offset)
+        {
+            info.m_DataOffset = data_offset;
+            info.m_Mapped = 1;
+        }
 
         dmZip::CloseEntry(zip);
 
@@ -138,6 +158,9 @@ static void CreateEntryMap(ZipProviderContext* archive)
         // If we have file in manifest, get file size from there
         manifest_info.m_Size = entry->m_Size;
         manifest_info.m_EntryIndex = info->m_EntryIndex;
+        manifest_info.m_RawSize = info->m_RawSize;
+        manifest_info.m_DataOffset = info->m_DataOffset;
+        manifest_info.m_Mapped = info->m_Mapped;
         entry_map->Put(entry->m_UrlHash, manifest_info);
         DM_RESOURCE_DBG_LOG(3, "Added entry: %s %llx (%u bytes)\n", archive_path_buffer, archive_path_hash, manifest_info.m_Size);
     }
@@ -215,6 +238,15 @@ static dmResourceProvider::Result Mount(const dmURI::Parts* uri, dmResourceProvi
         return dmResourceProvider::RESULT_NOT_FOUND;
     }
 
+    // Uncompressed entries are read straight from the mapped file. If the platform doesn't map files, all entries are read via dmZip
+    void* map = 0;
+    uint32_t map_size = 0;
+    if (dmResource::RESULT_OK == dmResource::MapFile(mount_path, map, map_size) && map != 0)
+    {
+        archive->m_Map = map;
+        archive->m_MapSize = map_size;
+    }
+
     dmResourceProvider::Result result = LoadManifest(archive->m_Zip, LIVEUPDATE_ARCHIVE_MANIFEST_FILENAME, &archive->m_Manifest);
     if (dmResourceProvider::RESULT_OK != result)
     {
@@ -248,6 +280,24 @@ static dmResourceProvider::Result GetFileSize(dmResourceProvider::HArchiveIntern
     return dmResourceProvider::RESULT_NOT_FOUND;
 }
 
+// When a resource with dependencies (e.g. a collection) is read, its dependencies will be loaded shortly after
+static void PrefetchDependencies(ZipProviderContext* archive, EntryInfo* entry)
+{
+    if (!entry->m_ManifestEntry)
+        return;
+
+    uint32_t count = entry->m_ManifestEntry->m_Dependants.m_Count;
+    const dmhash_t* dependencies = entry->m_ManifestEntry->m_Dependants.m_Data;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        EntryInfo* dependency = archive->m_EntryMap.Get(dependencies[i]);
+        if (dependency && dependency->m_Mapped)
+        {
+            dmResource::PrefetchMappedData((const uint8_t*)archive->m_Map + dependency->m_DataOffset, dependency->m_RawSize);
+        }
+    }
+}
+
 static dmResourceProvider::Result UnpackData(const char* path, dmLiveUpdateDDF::ResourceEntry* entry, uint8_t* raw_resource, uint32_t raw_resource_size, uint8_t* out_buffer)
 {
     dmResourceArchive::LiveUpdateResource resource(raw_resource, raw_resource_size);
@@ -270,6 +320,8 @@ static dmResourceProvider::Result UnpackData(const char* path, dmLiveUpdateDDF::
 
     if (compressed)
     {
+        DM_PROFILE("Decompress");
+        dmResource::ReadPhaseScope timing_scope(dmResource::LOAD_PHASE_DECOMPRESS);
         int decompressed_size;
         dmLZ4::Result r = dmLZ4::DecompressBuffer((const uint8_t*)resource.m_Data, compressed_size, out_buffer, resource_size, &decompressed_size);
         if (dmLZ4::RESULT_OK != r)
@@ -296,6 +348,29 @@ static dmResourceProvider::Result ReadFile(dmResourceProvider::HArchiveInternal
     if (buffer_len < entry->m_Size)
         return dmResourceProvider::RESULT_INVAL_ERROR;
 
+    if (entry->m_Mapped)
+    {
+        const uint8_t* raw_data = (const uint8_t*)archive->m_Map + entry->m_DataOffset;
+        PrefetchDependencies(archive, entry);
+
+        if (!entry->m_ManifestEntry)
+        {
+            memcpy(buffer, raw_data, entry->m_Size);
+            return dmResourceProvider::RESULT_OK;
+        }
+
+        // The data is decrypted in place, so it has to be copied out of the (read only) mapping first
+        if (entry->m_ManifestEntry->m_Flags & dmLiveUpdateDDF::ENCRYPTED)
+        {
+            uint8_t* copy = new uint8_t[entry->m_RawSize];
+            memcpy(copy, raw_data, entry->m_RawSize);
+            dmResourceProvider::Result result = UnpackData(path, entry->m_ManifestEntry, copy, entry->m_RawSize, buffer);
+            delete[] copy;
+            return result;
+        }
+        return UnpackData(path, entry->m_ManifestEntry, (uint8_t*)raw_data, entry->m_RawSize, buffer);
+    }
+
     dmZip::Result zr = dmZip::OpenEntry(archive->m_Zip, entry->m_EntryIndex);
     if (dmZip::RESULT_OK != zr)
         return dmResourceProvider::RESULT_IO_ERROR;
@@ -320,6 +395,32 @@ static dmResourceProvider::Result ReadFile(dmResourceProvider::HArchiveInternal
     return result;
 }
 
+static dmResourceProvider::Result GetFileData(dmResourceProvider::HArchiveInternal _archive, dmhash_t path_hash, const char* path, const uint8_t** data)
+{
+    ZipProviderContext* archive = (ZipProviderContext*)_archive;
+    EntryInfo* entry = archive->m_EntryMap.Get(path_hash);
+    if (!entry)
+        return dmResourceProvider::RESULT_NOT_FOUND;
+
+    if (!entry->m_Mapped)
+        return dmResourceProvider::RESULT_NOT_SUPPORTED;
+
+    const uint8_t* raw_data = (const uint8_t*)archive->m_Map + entry->m_DataOffset;
+    if (entry->m_ManifestEntry)
+    {
+        // Encrypted or compressed resources have to be unpacked into a buffer
+        if (entry->m_ManifestEntry->m_Flags & (dmLiveUpdateDDF::ENCRYPTED | dmLiveUpdateDDF::COMPRESSED))
+            return dmResourceProvider::RESULT_NOT_SUPPORTED;
+        if (entry->m_RawSize < sizeof(dmResourceArchive::LiveUpdateResourceHeader) + entry->m_Size)
+            return dmResourceProvider::RESULT_NOT_SUPPORTED;
+        raw_data += sizeof(dmResourceArchive::LiveUpdateResourceHeader);
+    }
+
+    PrefetchDependencies(archive, entry);
+    *data = raw_data;
+    return dmResourceProvider::RESULT_OK;
+}
+
 static dmResourceProvider::Result GetManifest(dmResourceProvider::HArchiveInternal _archive, dmResource::HManifest* out_manifest)
 {
     ZipProviderContext* archive = (ZipProviderContext*)_archive;
@@ -339,6 +440,7 @@ static void SetupArchiveLoaderHttpZip(dmResourceProvider::ArchiveLoader* loader)
     loader->m_GetManifest   = GetManifest;
     loader->m_GetFileSize   = GetFileSize;
     loader->m_ReadFile      = ReadFile;
+    loader->m_GetFileData   = GetFileData;
 }
 
 DM_DECLARE_ARCHIVE_LOADER(ResourceProviderZip, "zip", SetupArchiveLoaderHttpZip);
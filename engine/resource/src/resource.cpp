@@ -44,6 +44,8 @@
 #include "resource_manifest.h"
 #include "resource_mounts.h"
 #include "resource_private.h"
+#include "resource_snapshot.h"
+#include "resource_timeline.h"
 #include "resource_util.h"
 #include <resource/resource_ddf.h>
 #include <dmsdk/resource/resource.h>
@@ -74,6 +76,13 @@ struct ResourceReloadedCallbackPair
 
 const uint32_t MAX_RESOURCE_TYPES = 128;
 
+// An unreferenced resource kept alive within the residency budget
+struct ResidentResource
+{
+    dmhash_t m_NameHash;
+    uint32_t m_Size;
+};
+
 struct ResourceFactory
 {
     // TODO: Arg... budget. Two hash-maps. Really necessary?
@@ -110,6 +119,22 @@ struct ResourceFactory
     dmResourceProvider::HArchive                 m_BuiltinMount;
     dmResourceProvider::HArchive                 m_BaseArchiveMount;
 
+    // Async loader settings
+    uint32_t                                     m_LoaderThreadCount;
+    uint32_t                                     m_LoaderMaxPendingData;
+    dmJobThread::HContext                        m_JobThread;
+
+    // The most recent resource loads. Only valid if m_LoadTimelineSize > 0
+    dmResource::HLoadTimeline                    m_LoadTimeline;
+
+    // Bytes of unreferenced resources kept alive per resource type
+    uint32_t                                     m_ResidencyBudget;
+    // The unreferenced resources kept alive, least recently released first
+    dmArray<ResidentResource>                    m_ResidentResources;
+
+    // Serves, or records, the reads during startup. Only valid between OpenStartupSnapshot() and CloseStartupSnapshot()
+    dmResource::HStartupSnapshot                 m_StartupSnapshot;
+
     // Serial version that increases per resource insertion
     uint16_t                                     m_Version;
 };
@@ -128,6 +153,10 @@ const char* BUNDLE_PUBLIC_KEY_FILENAME          = "game.public.der";
 
 
 const char* MAX_RESOURCES_KEY = "resource.max_resources";
+const char* LOADER_THREADS_KEY = "resource.loader_threads";
+const char* LOADER_MAX_PENDING_DATA_KEY = "resource.loader_max_pending_data";
+const char* LOAD_TIMELINE_SIZE_KEY = "resource.load_timeline_size";
+const char* RESIDENCY_BUDGET_KEY = "resource.residency_budget";
 
 
 static inline uint16_t IncreaseVersion(HResourceFactory factory)
@@ -167,6 +196,12 @@ void SetDefaultNewFactoryParams(struct NewFactoryParams* params)
     params->m_ArchiveIndex.m_Size = 0;
     params->m_ArchiveData.m_Data = 0;
     params->m_ArchiveData.m_Size = 0;
+
+    params->m_LoaderThreadCount = DEFAULT_LOADER_THREAD_COUNT;
+    params->m_LoaderMaxPendingData = DEFAULT_LOADER_MAX_PENDING_DATA;
+    params->m_JobThread = 0;
+    params->m_LoadTimelineSize = 0;
+    params->m_ResidencyBudget = 0;
 }
 
 static Result AddBuiltinMount(HFactory factory, NewFactoryParams* params)
@@ -212,6 +247,14 @@ HFactory NewFactory(NewFactoryParams* params, const char* uri)
     ResourceFactory* factory = new ResourceFactory;
     memset(factory, 0, sizeof(*factory));
     factory->m_Socket = socket;
+    factory->m_LoaderThreadCount = dmMath::Max(1u, params->m_LoaderThreadCount);
+    factory->m_LoaderMaxPendingData = params->m_LoaderMaxPendingData;
+    factory->m_JobThread = params->m_JobThread;
+    factory->m_ResidencyBudget = params->m_ResidencyBudget;
+    if (factory->m_JobThread)
+    {
+        dmResourceArchive::SetJobThread(factory->m_JobThread);
+    }
 
     dmURI::Result uri_result = dmURI::Parse(uri, &factory->m_UriParts);
     if (uri_result != dmURI::RESULT_OK)
@@ -354,6 +397,11 @@ HFactory NewFactory(NewFactoryParams* params, const char* uri)
         AddBuiltinMount(factory, params);
     }
 
+    if (params->m_LoadTimelineSize > 0)
+    {
+        factory->m_LoadTimeline = NewLoadTimeline(params->m_LoadTimelineSize);
+    }
+
     factory->m_LoadMutex = dmMutex::New();
     return factory;
 }
@@ -365,6 +413,11 @@ static void ResourceIteratorCallback(void*, const dmhash_t* id, ResourceDescript
 
 void DeleteFactory(HFactory factory)
 {
+    if (factory->m_JobThread)
+    {
+        // The archives are stored globally, so make sure they don't use the job thread after it is gone
+        dmResourceArchive::SetJobThread(0);
+    }
     if (factory->m_Socket)
     {
         dmMessage::DeleteSocket(factory->m_Socket);
@@ -373,12 +426,25 @@ void DeleteFactory(HFactory factory)
     {
         dmMutex::Delete(factory->m_LoadMutex);
     }
+    if (factory->m_StartupSnapshot)
+    {
+        DeleteStartupSnapshot(factory->m_StartupSnapshot);
+    }
+    if (factory->m_LoadTimeline)
+    {
+        DeleteLoadTimeline(factory->m_LoadTimeline);
+    }
 
     ReleaseBuiltinsArchive(factory);
 
     if (factory->m_Mounts)
         dmResourceMounts::Destroy(factory->m_Mounts);
 
+    if (factory->m_Resources)
+    {
+        SetResidencyBudget(factory, 0);
+    }
+
     if (factory->m_Resources && !factory->m_Resources->Empty())
     {
         dmLogError("Leaked resources:");
@@ -601,13 +667,25 @@ const char* GetPublicKeyPath(HFactory factory)
     return factory->m_PublicKeyPath;
 }
 
+dmJobThread::HContext GetJobThread(HFactory factory)
+{
+    return factory->m_JobThread;
+}
+
 dmResourceProvider::HArchive GetBaseArchive(HFactory factory)
 {
     return factory->m_BaseArchiveMount;
 }
 
+// Large resources of types that stream their data only have their header loaded (see ResourceTypeSetStreamed)
+static bool IsStreamed(const ResourceType* type, uint32_t file_size)
+{
+    return type && type->m_StreamHeaderSize && file_size >= type->m_StreamMinSize && file_size > type->m_StreamHeaderSize;
+}
+
 // Assumes m_LoadMutex is already held
-static Result LoadResourceFromBufferLocked(HFactory factory, const char* path, const char* original_name, uint32_t* resource_size, LoadBufferType* buffer)
+// The stream type is optional
+static Result LoadResourceFromBufferLocked(HFactory factory, const ResourceType* stream_type, const char* path, const char* original_name, uint32_t* resource_size, LoadBufferType* buffer)
 {
     DM_PROFILE(__FUNCTION__);
 
@@ -617,10 +695,38 @@ static Result LoadResourceFromBufferLocked(HFactory factory, const char* path, c
     // Let's find the resource in the current mounts
 
     dmhash_t normalized_path_hash = dmHashString64(normalized_path);
+    if (factory->m_StartupSnapshot && ReadStartupSnapshot(factory->m_StartupSnapshot, normalized_path_hash, buffer, resource_size))
+    {
+        return RESULT_OK;
+    }
+
     uint32_t file_size;
     dmResource::Result r = dmResourceMounts::GetResourceSize(factory->m_Mounts, normalized_path_hash, normalized_path, &file_size);
     if (r == dmResource::RESULT_OK)
     {
+        if (IsStreamed(stream_type, file_size))
+        {
+            uint32_t header_size = stream_type->m_StreamHeaderSize;
+            if (buffer->Capacity() < header_size) {
+                buffer->SetCapacity(header_size);
+            }
+            buffer->SetSize(0);
+
+            uint32_t nread = 0;
+            r = dmResourceMounts::ReadResourcePartial(factory->m_Mounts, normalized_path_hash, normalized_path, 0, (uint8_t*)buffer->Begin(), header_size, &nread);
+            if (r == dmResource::RESULT_OK)
+            {
+                buffer->SetSize(nread);
+                *resource_size = nread;
+                return RESULT_OK;
+            }
+            else if (r != dmResource::RESULT_NOT_SUPPORTED)
+            {
+                return r;
+            }
+            // E.g. compressed archive entries have to be read as a whole
+        }
+
         if (buffer->Capacity() < file_size) {
             buffer->SetCapacity(file_size);
         }
@@ -631,6 +737,10 @@ static Result LoadResourceFromBufferLocked(HFactory factory, const char* path, c
         {
             buffer->SetSize(file_size);
             *resource_size = file_size;
+            if (factory->m_StartupSnapshot)
+            {
+                AddStartupSnapshotEntry(factory->m_StartupSnapshot, normalized_path_hash, buffer->Begin(), file_size);
+            }
             return RESULT_OK;
         }
         return r;
@@ -643,17 +753,149 @@ Result LoadResourceFromBuffer(HFactory factory, const char* path, const char* or
 {
     // Called from async queue so we wrap around a lock
     dmMutex::ScopedLock lk(factory->m_LoadMutex);
-    return LoadResourceFromBufferLocked(factory, path, original_name, resource_size, buffer);
+    return LoadResourceFromBufferLocked(factory, 0, path, original_name, resource_size, buffer);
+}
+
+// Takes the lock.
+Result LoadResourceHeaderFromBuffer(HFactory factory, HResourceType type, const char* path, const char* original_name, uint32_t* resource_size, LoadBufferType* buffer)
+{
+    dmMutex::ScopedLock lk(factory->m_LoadMutex);
+    return LoadResourceFromBufferLocked(factory, type, path, original_name, resource_size, buffer);
 }
 
 // Assumes m_LoadMutex is already held
-Result LoadResource(HFactory factory, const char* path, const char* original_name, void** buffer, uint32_t* resource_size)
+static Result GetResourceDataLocked(HFactory factory, const char* path, const void** data, uint32_t* resource_size)
+{
+    char normalized_path[RESOURCE_PATH_MAX];
+    GetCanonicalPath(path, normalized_path); // normalize the path
+
+    const uint8_t* mapped_data = 0;
+    Result r = dmResourceMounts::GetResourceData(factory->m_Mounts, dmHashString64(normalized_path), normalized_path, &mapped_data, resource_size);
+    *data = mapped_data;
+    return r;
+}
+
+// Takes the lock.
+Result LoadResourceData(HFactory factory, const char* path, const void** data, uint32_t* resource_size)
+{
+    // Called from async queue so we wrap around a lock
+    dmMutex::ScopedLock lk(factory->m_LoadMutex);
+    return GetResourceDataLocked(factory, path, data, resource_size);
+}
+
+// Doesn't take the load lock, the mounts are protected by their own mutex
+Result ReadResourcePartial(HFactory factory, const char* path, uint32_t offset, void* buffer, uint32_t buffer_size, uint32_t* nread)
+{
+    char normalized_path[RESOURCE_PATH_MAX];
+    GetCanonicalPath(path, normalized_path); // normalize the path
+
+    return dmResourceMounts::ReadResourcePartial(factory->m_Mounts, dmHashString64(normalized_path), normalized_path, offset, (uint8_t*)buffer, buffer_size, nread);
+}
+
+// Doesn't take the load lock, the mounts are protected by their own mutex
+Result GetResourceFileSize(HFactory factory, const char* path, uint32_t* file_size)
+{
+    char normalized_path[RESOURCE_PATH_MAX];
+    GetCanonicalPath(path, normalized_path); // normalize the path
+
+    return dmResourceMounts::GetResourceSize(factory->m_Mounts, dmHashString64(normalized_path), normalized_path, file_size);
+}
+
+// Doesn't take the load lock, the mounts are protected by their own mutex
+Result GetResourceLocation(HFactory factory, const char* path, uint32_t* mount_index, uint32_t* offset)
+{
+    char normalized_path[RESOURCE_PATH_MAX];
+    GetCanonicalPath(path, normalized_path); // normalize the path
+
+    return dmResourceMounts::GetResourceLocation(factory->m_Mounts, dmHashString64(normalized_path), normalized_path, mount_index, offset);
+}
+
+Result GetStartupSnapshotKey(HFactory factory, uint64_t* key)
+{
+    // Loose files (or files served over http) may change without any of the manifests changing
+    if (!factory->m_BaseArchiveMount)
+    {
+        return RESULT_NOT_SUPPORTED;
+    }
+
+    HashState64 state;
+    dmHashInit64(&state, false);
+    uint32_t num_mounts = dmResourceMounts::GetNumMounts(factory->m_Mounts);
+    for (uint32_t i = 0; i < num_mounts; ++i)
+    {
+        dmResourceMounts::SGetMountResult mount;
+        if (dmResourceMounts::GetMountByIndex(factory->m_Mounts, i, &mount) != RESULT_OK)
+        {
+            continue;
+        }
+
+        dmResource::HManifest manifest;
+        if (dmResourceProvider::GetManifest(mount.m_Archive, &manifest) != dmResourceProvider::RESULT_OK || !manifest)
+        {
+            return RESULT_NOT_SUPPORTED;
+        }
+        dmhash_t manifest_hash = dmResource::GetManifestDataHash(manifest);
+        dmHashUpdateBuffer64(&state, mount.m_Name, strlen(mount.m_Name));
+        dmHashUpdateBuffer64(&state, &mount.m_Priority, sizeof(mount.m_Priority));
+        dmHashUpdateBuffer64(&state, &manifest_hash, sizeof(manifest_hash));
+    }
+    *key = dmHashFinal64(&state);
+    return RESULT_OK;
+}
+
+bool OpenStartupSnapshot(HFactory factory, const char* path, uint64_t key, uint32_t max_size)
+{
+    dmMutex::ScopedLock lk(factory->m_LoadMutex);
+    if (factory->m_StartupSnapshot)
+    {
+        DeleteStartupSnapshot(factory->m_StartupSnapshot);
+    }
+    factory->m_StartupSnapshot = NewStartupSnapshot(path, key, max_size);
+    return !IsStartupSnapshotRecording(factory->m_StartupSnapshot);
+}
+
+Result CloseStartupSnapshot(HFactory factory)
+{
+    dmMutex::ScopedLock lk(factory->m_LoadMutex);
+    if (!factory->m_StartupSnapshot)
+    {
+        return RESULT_OK;
+    }
+    Result r = WriteStartupSnapshot(factory->m_StartupSnapshot);
+    DeleteStartupSnapshot(factory->m_StartupSnapshot);
+    factory->m_StartupSnapshot = 0;
+    return r;
+}
+
+uint32_t GetLoaderThreadCount(HFactory factory)
+{
+    return factory->m_LoaderThreadCount;
+}
+
+uint32_t GetLoaderMaxPendingData(HFactory factory)
+{
+    return factory->m_LoaderMaxPendingData;
+}
+
+HLoadTimeline GetLoadTimeline(HFactory factory)
+{
+    return factory->m_LoadTimeline;
+}
+
+void IterateLoadTimeline(HFactory factory, FLoadTimelineCallback callback, void* ctx)
+{
+    IterateLoadTimeline(factory->m_LoadTimeline, callback, ctx);
+}
+
+// Assumes m_LoadMutex is already held
+// The stream type is optional
+static Result LoadResourceLocked(HFactory factory, const ResourceType* stream_type, const char* path, const char* original_name, void** buffer, uint32_t* resource_size)
 {
     if (factory->m_Buffer.Capacity() != DEFAULT_BUFFER_SIZE) {
         factory->m_Buffer.SetCapacity(DEFAULT_BUFFER_SIZE);
     }
     factory->m_Buffer.SetSize(0);
-    Result r = LoadResourceFromBufferLocked(factory, path, original_name, resource_size, &factory->m_Buffer);
+    Result r = LoadResourceFromBufferLocked(factory, stream_type, path, original_name, resource_size, &factory->m_Buffer);
     if (r == RESULT_OK)
     {
         *buffer = factory->m_Buffer.Begin();
@@ -665,14 +907,43 @@ Result LoadResource(HFactory factory, const char* path, const char* original_nam
     return r;
 }
 
+// Assumes m_LoadMutex is already held
+Result LoadResource(HFactory factory, const char* path, const char* original_name, void** buffer, uint32_t* resource_size)
+{
+    return LoadResourceLocked(factory, 0, path, original_name, buffer, resource_size);
+}
+
+// Assumes m_LoadMutex is already held
+Result LoadResourceHeader(HFactory factory, HResourceType type, const char* path, const char* original_name, void** buffer, uint32_t* resource_size)
+{
+    return LoadResourceLocked(factory, type, path, original_name, buffer, resource_size);
+}
+
+// Uses the mapped data directly if the type supports it, otherwise loads into the factory buffer
+// Assumes m_LoadMutex is already held
+static Result LoadResourceForType(HFactory factory, ResourceType* resource_type, const char* path, const char* original_name, void** buffer, uint32_t* resource_size)
+{
+    if (resource_type->m_ZeroCopy)
+    {
+        const void* data;
+        if (GetResourceDataLocked(factory, path, &data, resource_size) == RESULT_OK)
+        {
+            *buffer = (void*) data;
+            return RESULT_OK;
+        }
+    }
+    return LoadResourceLocked(factory, resource_type, path, original_name, buffer, resource_size);
+}
+
 const char* GetExtFromPath(const char* path)
 {
     return strrchr(path, '.');
 }
 
 // Assumes m_LoadMutex is already held
+// The timing is optional
 static Result DoCreateResource(HFactory factory, ResourceType* resource_type, const char* name, const char* canonical_path,
-    dmhash_t canonical_path_hash, void* buffer, uint32_t buffer_size, void** resource_out)
+    dmhash_t canonical_path_hash, void* buffer, uint32_t buffer_size, LoadTiming* timing, void** resource_out)
 {
     // TODO: We should *NOT* allocate SResource dynamically...
     ResourceDescriptor tmp_resource;
@@ -683,9 +954,11 @@ static Result DoCreateResource(HFactory factory, ResourceType* resource_type, co
 
     void *preload_data = 0;
     Result create_error = RESULT_OK;
+    uint64_t phase_start = dmTime::GetTime();
 
     if (resource_type->m_PreloadFunction)
     {
+        DM_PROFILE("Preload");
         ResourcePreloadParams params;
         params.m_Factory     = factory;
         params.m_Type        = resource_type;
@@ -696,11 +969,15 @@ static Result DoCreateResource(HFactory factory, ResourceType* resource_type, co
         params.m_Filename    = name;
         params.m_HintInfo    = 0; // No hinting now
         create_error         = (Result)resource_type->m_PreloadFunction(&params);
+        if (timing)
+            phase_start = AddLoadPhaseTime(timing, LOAD_PHASE_PRELOAD, phase_start);
     }
 
     if (create_error == RESULT_OK)
     {
+        DM_PROFILE("Create");
         tmp_resource.m_ResourceSizeOnDisc = buffer_size;
+        tmp_resource.m_ContentHash        = GetContentHash(factory, buffer, buffer_size);
         tmp_resource.m_ResourceSize       = 0; // Not everything will report a size (but instead rely on the disc size, sinze it's close enough)
 
         ResourceCreateParams params;
@@ -713,16 +990,20 @@ static Result DoCreateResource(HFactory factory, ResourceType* resource_type, co
         params.m_Resource    = &tmp_resource;
         params.m_Filename    = name;
         create_error         = (Result)resource_type->m_CreateFunction(&params);
+        if (timing)
+            phase_start = AddLoadPhaseTime(timing, LOAD_PHASE_CREATE, phase_start);
     }
 
     if (create_error == RESULT_OK && resource_type->m_PostCreateFunction)
     {
+        DM_PROFILE("PostCreate");
         ResourcePostCreateParams params;
         params.m_Factory     = factory;
         params.m_Type        = resource_type;
         params.m_Context     = resource_type->m_Context;
         params.m_PreloadData = preload_data;
         params.m_Resource    = &tmp_resource;
+        params.m_Filename    = name;
         for(;;)
         {
             create_error = (Result)resource_type->m_PostCreateFunction(&params);
@@ -730,6 +1011,8 @@ static Result DoCreateResource(HFactory factory, ResourceType* resource_type, co
                 break;
             dmTime::Sleep(1000);
         }
+        if (timing)
+            AddLoadPhaseTime(timing, LOAD_PHASE_POST_CREATE, phase_start);
     }
 
     // Restore to default buffer size
@@ -764,6 +1047,133 @@ static Result DoCreateResource(HFactory factory, ResourceType* resource_type, co
     }
 }
 
+static void DestroyResource(HFactory factory, ResourceDescriptor* rd)
+{
+    ResourceType* resource_type = (ResourceType*) rd->m_ResourceType;
+
+    DM_PROFILE_DYN(resource_type->m_Extension, 0);
+
+    dmhash_t resource_hash = rd->m_NameHash;
+    void* resource = rd->m_Resource;
+
+    ResourceDestroyParams params;
+    params.m_Factory    = factory;
+    params.m_Type       = resource_type;
+    params.m_Context    = resource_type->m_Context;
+    params.m_Resource   = rd;
+    resource_type->m_DestroyFunction(&params);
+
+    dmMemory::TrackFree(dmMemory::CATEGORY_RESOURCE, rd->m_AccountedSize);
+    rd->m_AccountedSize = 0;
+
+    factory->m_ResourceToHash->Erase((uintptr_t) resource);
+    factory->m_Resources->Erase(resource_hash);
+    if (factory->m_ResourceHashToFilename)
+    {
+        const char** s = factory->m_ResourceHashToFilename->Get(resource_hash);
+        factory->m_ResourceHashToFilename->Erase(resource_hash);
+        assert(s);
+        free((void*) *s);
+    }
+}
+
+static void EvictResidentResource(HFactory factory, uint32_t index)
+{
+    dmArray<ResidentResource>& resident = factory->m_ResidentResources;
+    ResidentResource entry = resident[index];
+    memmove(&resident[index], &resident[index] + 1, (resident.Size() - index - 1) * sizeof(ResidentResource));
+    resident.Pop();
+
+    ResourceDescriptor* rd = factory->m_Resources->Get(entry.m_NameHash);
+    assert(rd && rd->m_Resident && rd->m_ReferenceCount == 0);
+    ResourceType* resource_type = (ResourceType*) rd->m_ResourceType;
+    resource_type->m_ResidentSize -= entry.m_Size;
+    rd->m_Resident = 0;
+    DestroyResource(factory, rd);
+}
+
+// Destroys all the resources kept within the residency budget
+static void EvictResidentResources(HFactory factory)
+{
+    // Destroying a resource may release its dependencies, which are then kept resident at the end of the list
+    while (!factory->m_ResidentResources.Empty())
+    {
+        EvictResidentResource(factory, 0);
+    }
+}
+
+static bool KeepResident(HFactory factory, ResourceDescriptor* rd)
+{
+    ResourceType* resource_type = (ResourceType*) rd->m_ResourceType;
+    uint32_t budget = factory->m_ResidencyBudget;
+    uint32_t size = rd->m_AccountedSize;
+    if (!resource_type->m_KeepResident || rd->m_Dynamic || budget == 0 || size > budget)
+        return false;
+
+    dmArray<ResidentResource>& resident = factory->m_ResidentResources;
+    if (resident.Full())
+    {
+        resident.OffsetCapacity(64);
+    }
+    ResidentResource entry;
+    entry.m_NameHash = rd->m_NameHash;
+    entry.m_Size = size;
+    resident.Push(entry);
+    resource_type->m_ResidentSize += size;
+    rd->m_Resident = 1;
+
+    // Destroy the least recently released resources of the type, until it fits within the budget
+    uint32_t i = 0;
+    while (resource_type->m_ResidentSize > budget && i < resident.Size())
+    {
+        ResourceDescriptor* other = factory->m_Resources->Get(resident[i].m_NameHash);
+        if (other->m_ResourceType == resource_type)
+            EvictResidentResource(factory, i);
+        else
+            ++i;
+    }
+    return true;
+}
+
+static void ReviveResidentResource(HFactory factory, ResourceDescriptor* rd)
+{
+    dmArray<ResidentResource>& resident = factory->m_ResidentResources;
+    for (uint32_t i = 0; i < resident.Size(); ++i)
+    {
+        if (resident[i].m_NameHash == rd->m_NameHash)
+        {
+            ResourceType* resource_type = (ResourceType*) rd->m_ResourceType;
+            resource_type->m_ResidentSize -= resident[i].m_Size;
+            memmove(&resident[i], &resident[i] + 1, (resident.Size() - i - 1) * sizeof(ResidentResource));
+            resident.Pop();
+            break;
+        }
+    }
+    rd->m_Resident = 0;
+}
+
+void SetResidencyBudget(HFactory factory, uint32_t budget)
+{
+    factory->m_ResidencyBudget = budget;
+    if (budget == 0)
+    {
+        EvictResidentResources(factory);
+        return;
+    }
+
+    // Evict the least recently released resources of the types now over the budget
+    uint32_t i = 0;
+    while (i < factory->m_ResidentResources.Size())
+    {
+        ResourceDescriptor* rd = factory->m_Resources->Get(factory->m_ResidentResources[i].m_NameHash);
+        ResourceType* resource_type = (ResourceType*) rd->m_ResourceType;
+        if (resource_type->m_ResidentSize > budget)
+            EvictResidentResource(factory, i);
+        else
+            ++i;
+    }
+}
+
 // Assumes m_LoadMutex is already held
 static Result PrepareResourceCreation(HFactory factory, const char* canonical_path, dmhash_t canonical_path_hash, void** resource_out, HResourceType* resource_type_out)
 {
@@ -774,11 +1184,16 @@ static Result PrepareResourceCreation(HFactory factory, const char* canonical_pa
     if (rd)
     {
         assert(factory->m_ResourceToHash->Get((uintptr_t) rd->m_Resource));
-        rd->m_ReferenceCount++;
+        IncRef(factory, rd);
         *resource_out = rd->m_Resource;
         return RESULT_OK;
     }
 
+    if (factory->m_Resources->Full())
+    {
+        EvictResidentResources(factory);
+    }
+
     if (factory->m_Resources->Full())
     {
         dmLogError("The max number of resources (%d) has been passed, tweak \"%s\" in the config file.", factory->m_Resources->Capacity(), MAX_RESOURCES_KEY);
@@ -832,16 +1247,21 @@ static Result CreateAndLoadResource(HFactory factory, const char* name, void** r
         return RESULT_OK;
     }
 
+    LoadTiming timing;
+    InitLoadTiming(&timing);
+
     void* buffer         = 0;
     uint32_t buffer_size = 0;
-    Result result = LoadResource(factory, canonical_path, name, &buffer, &buffer_size);
-    if (result != RESULT_OK)
+    BeginReadTiming(&timing);
+    Result result = LoadResourceForType(factory, resource_type, canonical_path, name, &buffer, &buffer_size);
+    EndReadTiming(&timing, buffer_size);
+    if (result == RESULT_OK)
     {
-        return result;
+        result = DoCreateResource(factory, resource_type, name, canonical_path, canonical_path_hash, buffer, buffer_size, &timing, resource);
     }
-    assert(buffer == factory->m_Buffer.Begin());
 
-    return DoCreateResource(factory, resource_type, name, canonical_path, canonical_path_hash, buffer, buffer_size, resource);
+    AddLoadTimelineEntry(factory->m_LoadTimeline, canonical_path, canonical_path_hash, result, false, &timing);
+    return result;
 }
 
 Result CreateResource(HFactory factory, const char* name, void* data, uint32_t data_size, void** resource)
@@ -870,7 +1290,12 @@ Result CreateResource(HFactory factory, const char* name, void* data, uint32_t d
         return RESULT_OK;
     }
 
-    return DoCreateResource(factory, resource_type, name, canonical_path, canonical_path_hash, data, data_size, resource);
+    Result result = DoCreateResource(factory, resource_type, name, canonical_path, canonical_path_hash, data, data_size, 0, resource);
+    if (result == RESULT_OK)
+    {
+        factory->m_Resources->Get(canonical_path_hash)->m_Dynamic = 1;
+    }
+    return result;
 }
 
 Result Get(HFactory factory, const char* name, void** resource)
@@ -940,6 +1365,11 @@ Result Get(HFactory factory, dmhash_t name, void** resource)
 
 Result InsertResource(HFactory factory, const char* path, uint64_t canonical_path_hash, ResourceDescriptor* descriptor)
 {
+    if (factory->m_Resources->Full())
+    {
+        EvictResidentResources(factory);
+    }
+
     if (factory->m_Resources->Full())
     {
         dmLogError("The max number of resources (%d) has been passed, tweak \"%s\" in the config file.", factory->m_Resources->Capacity(), MAX_RESOURCES_KEY);
@@ -949,7 +1379,9 @@ Result InsertResource(HFactory factory, const char* path, uint64_t canonical_pat
     assert(descriptor->m_Resource);
     assert(descriptor->m_ReferenceCount == 1);
 
+    descriptor->m_AccountedSize = 0;
     factory->m_Resources->Put(canonical_path_hash, *descriptor);
+    UpdateResourceMemory(factory->m_Resources->Get(canonical_path_hash));
     factory->m_ResourceToHash->Put((uintptr_t) descriptor->m_Resource, canonical_path_hash);
     if (factory->m_ResourceHashToFilename)
     {
@@ -963,6 +1395,17 @@ Result InsertResource(HFactory factory, const char* path, uint64_t canonical_pat
     return RESULT_OK;
 }
 
+void UpdateResourceMemory(ResourceDescriptor* rd)
+{
+    // Same rule as the resource iterator, since not all resource types report their size in memory
+    uint32_t size = rd->m_ResourceSize ? rd->m_ResourceSize : rd->m_ResourceSizeOnDisc;
+    if (size > rd->m_AccountedSize)
+        dmMemory::TrackAlloc(dmMemory::CATEGORY_RESOURCE, size - rd->m_AccountedSize);
+    else if (size < rd->m_AccountedSize)
+        dmMemory::TrackFree(dmMemory::CATEGORY_RESOURCE, rd->m_AccountedSize - size);
+    rd->m_AccountedSize = size;
+}
+
 Result GetRaw(HFactory factory, const char* name, void** resource, uint32_t* resource_size)
 {
     DM_PROFILE(__FUNCTION__);
@@ -996,7 +1439,14 @@ Result GetRaw(HFactory factory, const char* name, void** resource, uint32_t* res
     return result;
 }
 
-static Result DoReloadResource(HFactory factory, const char* name, HResourceDescriptor* out_descriptor)
+uint32_t GetContentHash(HFactory factory, const void* buffer, uint32_t buffer_size)
+{
+    if (!factory->m_ResourceHashToFilename || !buffer)
+        return 0;
+    return dmHashBuffer32(buffer, buffer_size);
+}
+
+static Result DoReloadResource(HFactory factory, const char* name, HResourceDescriptor* out_descriptor, bool* unchanged)
 {
     char canonical_path[RESOURCE_PATH_MAX];
     GetCanonicalPath(name, canonical_path);
@@ -1017,13 +1467,19 @@ static Result DoReloadResource(HFactory factory, const char* name, HResourceDesc
 
     void* buffer;
     uint32_t buffer_size;
-    Result result = LoadResource(factory, canonical_path, name, &buffer, &buffer_size);
+    Result result = LoadResourceForType(factory, resource_type, canonical_path, name, &buffer, &buffer_size);
     if (result != RESULT_OK)
     {
         return result;
     }
 
-    assert(buffer == factory->m_Buffer.Begin());
+    // Saving a file, or reloading a whole directory, often sends files that are identical to what is loaded
+    uint32_t content_hash = GetContentHash(factory, buffer, buffer_size);
+    if (content_hash != 0 && content_hash == rd->m_ContentHash && buffer_size == rd->m_ResourceSizeOnDisc)
+    {
+        *unchanged = true;
+        return RESULT_OK;
+    }
 
     ResourceRecreateParams params;
     params.m_Factory    = factory;
@@ -1040,6 +1496,8 @@ static Result DoReloadResource(HFactory factory, const char* name, HResourceDesc
     {
         rd->m_Version = IncreaseVersion(factory);
         params.m_Resource->m_ResourceSizeOnDisc = buffer_size;
+        params.m_Resource->m_ContentHash = content_hash;
+        UpdateResourceMemory(rd);
         if (factory->m_ResourceReloadedCallbacks)
         {
             for (uint32_t i = 0; i < factory->m_ResourceReloadedCallbacks->Size(); ++i)
@@ -1078,12 +1536,16 @@ Result ReloadResource(HFactory factory, const char* name, HResourceDescriptor* o
 {
     dmMutex::ScopedLock lk(factory->m_LoadMutex);
 
-    Result result = DoReloadResource(factory, name, out_descriptor);
+    bool unchanged = false;
+    Result result = DoReloadResource(factory, name, out_descriptor, &unchanged);
 
     switch (result)
     {
         case RESULT_OK:
-            dmLogInfo("%s was successfully reloaded.", name);
+            if (unchanged)
+                dmLogInfo("%s is unchanged and was not reloaded.", name);
+            else
+                dmLogInfo("%s was successfully reloaded.", name);
             break;
         case RESULT_OUT_OF_MEMORY:
             dmLogError("Not enough memory to reload %s.", name);
@@ -1139,6 +1601,7 @@ Result SetResource(HFactory factory, uint64_t hashed_name, void* data, uint32_t
     Result create_result = (Result)resource_type->m_RecreateFunction(&params);
     if (create_result == RESULT_OK)
     {
+        rd->m_ContentHash = 0; // No longer matches the file, so the next reload must not be skipped
         if (factory->m_ResourceReloadedCallbacks)
         {
             for (uint32_t i = 0; i < factory->m_ResourceReloadedCallbacks->Size(); ++i)
@@ -1193,6 +1656,7 @@ Result SetResource(HFactory factory, uint64_t hashed_name, void* message)
     Result create_result = (Result)resource_type->m_RecreateFunction(&params);
     if (create_result == RESULT_OK)
     {
+        rd->m_ContentHash = 0; // No longer matches the file, so the next reload must not be skipped
         if (factory->m_ResourceReloadedCallbacks)
         {
             for (uint32_t i = 0; i < factory->m_ResourceReloadedCallbacks->Size(); ++i)
@@ -1320,9 +1784,12 @@ Result GetDescriptorWithExt(HFactory factory, uint64_t hashed_name, const uint64
 
 void IncRef(HFactory factory, HResourceDescriptor rd)
 {
-    (void)factory;
     assert(rd);
-    assert(rd->m_ReferenceCount > 0);
+    if (rd->m_Resident)
+    {
+        ReviveResidentResource(factory, rd);
+    }
+    assert(rd->m_ReferenceCount > 0 || rd->m_Resident == 0);
     ++rd->m_ReferenceCount;
 }
 
@@ -1378,26 +1845,9 @@ void Release(HFactory factory, void* resource)
 
     if (rd->m_ReferenceCount == 0)
     {
-        ResourceType* resource_type = (ResourceType*) rd->m_ResourceType;
-
-        DM_PROFILE_DYN(resource_type->m_Extension, 0);
-
-        ResourceDestroyParams params;
-        params.m_Factory    = factory;
-        params.m_Type       = resource_type;
-        params.m_Context    = resource_type->m_Context;
-        params.m_Resource   = rd;
-        resource_type->m_DestroyFunction(&params);
-
-        factory->m_ResourceToHash->Erase((uintptr_t) resource);
-        factory->m_Resources->Erase(*resource_hash);
-        if (factory->m_ResourceHashToFilename)
-        {
-            const char** s = factory->m_ResourceHashToFilename->Get(*resource_hash);
-            factory->m_ResourceHashToFilename->Erase(*resource_hash);
-            assert(s);
-            free((void*) *s);
-        }
+        if (KeepResident(factory, rd))
+            return;
+        DestroyResource(factory, rd);
     }
 }
 
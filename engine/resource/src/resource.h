@@ -20,6 +20,7 @@
 #include <dlib/hash.h>
 #include <dlib/hashtable.h>
 #include <dlib/mutex.h>
+#include <dlib/job_thread.h>
 
 struct ResourceDescriptor;
 
@@ -54,6 +55,32 @@ namespace dmResource
      */
     extern const char* MAX_RESOURCES_KEY;
 
+    /**
+     * Configuration key used to set the number of async loader threads per load queue.
+     */
+    extern const char* LOADER_THREADS_KEY;
+
+    /**
+     * Configuration key used to set the max number of loaded bytes (per load queue) waiting to be picked up.
+     */
+    extern const char* LOADER_MAX_PENDING_DATA_KEY;
+
+    /**
+     * Configuration key used to set the number of resource loads kept in the load timeline.
+     */
+    extern const char* LOAD_TIMELINE_SIZE_KEY;
+
+    /**
+     * Configuration key used to set the residency budget, in bytes per resource type.
+     */
+    extern const char* RESIDENCY_BUDGET_KEY;
+
+    /// Default number of async loader threads
+    const uint32_t DEFAULT_LOADER_THREAD_COUNT = 1;
+
+    /// Default max number of loaded bytes waiting to be picked up
+    const uint32_t DEFAULT_LOADER_MAX_PENDING_DATA = 4 * 1024 * 1024;
+
     extern const char* BUNDLE_INDEX_FILENAME;
     extern const char* BUNDLE_DATA_FILENAME;
 
@@ -137,7 +164,22 @@ namespace dmResource
         EmbeddedResource m_ArchiveData;
         EmbeddedResource m_ArchiveManifest;
 
-        uint32_t m_Reserved[5];
+        /// Number of async loader threads. Default is DEFAULT_LOADER_THREAD_COUNT
+        uint32_t m_LoaderThreadCount;
+
+        /// Max number of bytes loaded by a load queue, waiting to be picked up. Default is DEFAULT_LOADER_MAX_PENDING_DATA
+        uint32_t m_LoaderMaxPendingData;
+
+        /// Job thread used to decompress chunked archive entries in parallel. Default is 0 (no threading)
+        dmJobThread::HContext m_JobThread;
+
+        /// Number of resource loads kept in the load timeline. Default is 0 (disabled)
+        uint32_t m_LoadTimelineSize;
+
+        /// Bytes of unreferenced resources kept alive per resource type, see SetResidencyBudget(). Default is 0 (disabled)
+        uint32_t m_ResidencyBudget;
+
+        uint32_t m_Reserved[2];
 
         NewFactoryParams()
         {
@@ -371,6 +413,49 @@ namespace dmResource
      **/
     const char* GetPublicKeyPath(HFactory factory);
 
+    /**
+     * Returns the job thread context the factory was created with, or 0
+     **/
+    dmJobThread::HContext GetJobThread(HFactory factory);
+
+    /**
+     * Sets the residency budget. Resources of the types that opt in with ResourceTypeSetKeepResident() are
+     * kept alive when their reference count reaches zero, until the unreferenced resources of the type
+     * exceed the budget. The least recently released ones are destroyed first. A Get() of a kept resource
+     * revives it without loading it again.
+     * Setting the budget to 0 destroys all the currently kept resources.
+     * @param factory Factory handle
+     * @param budget Bytes of unreferenced resources kept alive per resource type
+     */
+    void SetResidencyBudget(HFactory factory, uint32_t budget);
+
+    /**
+     * Gets a key for a startup snapshot, that changes whenever any of the mounted archives change
+     * @param factory Factory handle
+     * @param key [out] The key
+     * @return RESULT_NOT_SUPPORTED if the resources aren't loaded from archives only
+     */
+    Result GetStartupSnapshotKey(HFactory factory, uint64_t* key);
+
+    /**
+     * Opens a startup snapshot. If the file at the path was written with the same key, it is read in one go,
+     * and the reads of the resources in it are served from memory, without decrypting or decompressing them.
+     * Otherwise, the reads are recorded (up to max_size bytes), and written to the file by CloseStartupSnapshot().
+     * @param factory Factory handle
+     * @param path Path of the snapshot file
+     * @param key See GetStartupSnapshotKey()
+     * @param max_size Max number of bytes of resource data recorded
+     * @return true if the snapshot was loaded, false if the reads are recorded
+     */
+    bool OpenStartupSnapshot(HFactory factory, const char* path, uint64_t key, uint32_t max_size);
+
+    /**
+     * Closes the startup snapshot, and writes it if the reads were recorded. Does nothing if it isn't open.
+     * @param factory Factory handle
+     * @return RESULT_IO_ERROR if the snapshot couldn't be written
+     */
+    Result CloseStartupSnapshot(HFactory factory);
+
     /**
      * Returns the base archive mount. It is always of type "archive", or it will return 0.
      **/
@@ -412,6 +497,72 @@ namespace dmResource
     Result LoadResource(HFactory factory, const char* path, const char* original_name, void** buffer, uint32_t* resource_size);
     // load with own buffer
     Result LoadResourceFromBuffer(HFactory factory, const char* path, const char* original_name, uint32_t* resource_size, LoadBufferType* buffer);
+    // as above, but only the header of large resources of types that stream their data (see ResourceTypeSetStreamed)
+    Result LoadResourceHeader(HFactory factory, HResourceType type, const char* path, const char* original_name, void** buffer, uint32_t* resource_size);
+    Result LoadResourceHeaderFromBuffer(HFactory factory, HResourceType type, const char* path, const char* original_name, uint32_t* resource_size, LoadBufferType* buffer);
+
+    // get a pointer straight into a memory mapped archive. RESULT_NOT_SUPPORTED if the resource has to be loaded
+    Result LoadResourceData(HFactory factory, const char* path, const void** data, uint32_t* resource_size);
+
+    // read a part of the resource file, e.g. for types that stream their data. Thread safe
+    Result ReadResourcePartial(HFactory factory, const char* path, uint32_t offset, void* buffer, uint32_t buffer_size, uint32_t* nread);
+
+    // get the size of the resource file. Thread safe
+    Result GetResourceFileSize(HFactory factory, const char* path, uint32_t* file_size);
+
+    // get where the resource is stored (mount index and offset within it), so that loads can be issued in disc order
+    Result GetResourceLocation(HFactory factory, const char* path, uint32_t* mount_index, uint32_t* offset);
+
+    // async loader settings, as given in the NewFactoryParams
+    uint32_t GetLoaderThreadCount(HFactory factory);
+    uint32_t GetLoaderMaxPendingData(HFactory factory);
+
+    enum LoadPhase
+    {
+        LOAD_PHASE_QUEUE,           // Waiting in the async load queue
+        LOAD_PHASE_READ,            // Reading the data, excluding the decryption and decompression
+        LOAD_PHASE_DECRYPT,
+        LOAD_PHASE_DECOMPRESS,
+        LOAD_PHASE_PRELOAD,
+        LOAD_PHASE_CREATE,
+        LOAD_PHASE_POST_CREATE,
+        MAX_LOAD_PHASE_COUNT
+    };
+
+    struct LoadTiming
+    {
+        uint64_t m_Start;                       // dmTime::GetTime() when the load was requested
+        uint32_t m_Times[MAX_LOAD_PHASE_COUNT]; // Microseconds
+        uint32_t m_Size;                        // Bytes read
+        dmhash_t m_Provider;                    // The archive loader that provided the data, e.g. "file" or "archive"
+    };
+
+    static const uint32_t MAX_LOAD_TIMELINE_PATH = 128;
+
+    struct LoadTimelineEntry
+    {
+        LoadTiming m_Timing;
+        dmhash_t   m_PathHash;
+        char       m_Path[MAX_LOAD_TIMELINE_PATH];
+        Result     m_Result;
+        uint8_t    m_Async:1;                   // Loaded by a preloader (e.g. a collection proxy)
+    };
+
+    typedef void (*FLoadTimelineCallback)(void* ctx, const LoadTimelineEntry* entry);
+
+    /**
+     * Iterate the most recent resource loads, oldest first.
+     * The number of loads kept is set by NewFactoryParams::m_LoadTimelineSize
+     * @param factory Factory handle
+     * @param callback Called for each load
+     * @param ctx User context passed to the callback
+     */
+    void IterateLoadTimeline(HFactory factory, FLoadTimelineCallback callback, void* ctx);
+
+    const char* GetLoadPhaseName(LoadPhase phase);
+
+    // Returns the name of the known archive loaders, or 0
+    const char* GetLoadProviderName(dmhash_t provider);
 }
 
 #endif // DM_RESOURCE_H
@@ -20,15 +20,19 @@
 #include "resource.h"
 #include "resource_archive.h"
 #include "resource_private.h"
+#include "resource_timeline.h"
 #include "resource_util.h"
 #include "resource_archive_private.h"
+#include <dlib/atomic.h>
 #include <dlib/crypt.h>
 #include <dlib/dstrings.h>
 #include <dlib/endian.h>
 #include <dlib/log.h>
 #include <dlib/lz4.h>
+#include <dlib/math.h>
 #include <dlib/memory.h>
 #include <dlib/path.h>
+#include <dlib/profile.h>
 #include <dlib/sys.h>
 
 #define DEBUG_LOG 1
@@ -43,6 +47,8 @@ namespace dmResourceArchive
 {
     const static uint64_t FILE_LOADED_INDICATOR = 1337;
 
+    static dmJobThread::HContext g_JobThread = 0;
+
     ArchiveIndex::ArchiveIndex()
     {
         memset(this, 0, sizeof(ArchiveIndex));
@@ -141,6 +147,7 @@ namespace dmResourceArchive
         }
 
         aic->m_ArchiveFileIndex->m_FileResourceData = f_data; // game.arcd file handle
+        BuildEntryLookup(aic);
         *archive = aic;
 
         fclose(f_index);
@@ -170,9 +177,19 @@ namespace dmResourceArchive
         (*archive)->m_ArchiveIndex = a;
         (*archive)->m_ArchiveIndexSize = index_buffer_size;
 
+        BuildEntryLookup(*archive);
         return RESULT_OK;
     }
 
+    static void DeleteEntryLookup(HArchiveIndexContainer archive)
+    {
+        free(archive->m_EntryLookup);
+        archive->m_EntryLookup = 0;
+        archive->m_EntryLookupHashes = 0;
+        archive->m_EntryLookupCount = 0;
+        archive->m_EntryLookupMask = 0;
+    }
+
     static void DeleteArchiveFileIndex(ArchiveFileIndex* afi)
     {
         if (afi != 0)
@@ -190,9 +207,22 @@ namespace dmResourceArchive
         delete afi;
     }
 
+    static void DeleteDictionaries(HArchiveIndexContainer archive)
+    {
+        for (uint32_t i = 0; i < archive->m_DictionaryCount; ++i)
+        {
+            delete[] archive->m_Dictionaries[i].m_Data;
+        }
+        free(archive->m_Dictionaries);
+        archive->m_Dictionaries = 0;
+        archive->m_DictionaryCount = 0;
+    }
+
     void Delete(HArchiveIndexContainer &archive)
     {
         DeleteArchiveFileIndex(archive->m_ArchiveFileIndex);
+        DeleteEntryLookup(archive);
+        DeleteDictionaries(archive);
 
         if (!archive->m_IsMemMapped)
         {
@@ -211,24 +241,91 @@ namespace dmResourceArchive
         }
     }
 
-    dmResourceArchive::Result FindEntry(dmResourceArchive::HArchiveIndexContainer archive, const uint8_t* hash, uint32_t hash_len, dmResourceArchive::EntryData** entry)
+    static void GetHashesAndEntries(HArchiveIndexContainer archive, uint8_t** hashes, EntryData** entries)
     {
-        uint32_t entry_count = dmEndian::ToNetwork(archive->m_ArchiveIndex->m_EntryDataCount);
-        uint32_t entry_offset = dmEndian::ToNetwork(archive->m_ArchiveIndex->m_EntryDataOffset);
-        uint32_t hash_offset = dmEndian::ToNetwork(archive->m_ArchiveIndex->m_HashOffset);
-        uint8_t* hashes = 0;
-        dmResourceArchive::EntryData* entries = 0;
-
         // If archive is loaded from file use the member arrays for hashes and entries, otherwise read with mem offsets.
         if (!archive->m_IsMemMapped)
         {
-            hashes = archive->m_ArchiveFileIndex->m_Hashes;
-            entries = archive->m_ArchiveFileIndex->m_Entries;
+            *hashes = archive->m_ArchiveFileIndex->m_Hashes;
+            *entries = archive->m_ArchiveFileIndex->m_Entries;
         }
         else
         {
-            hashes = (uint8_t*)((uintptr_t)archive->m_ArchiveIndex + hash_offset);
-            entries = (dmResourceArchive::EntryData*)((uintptr_t)archive->m_ArchiveIndex + entry_offset);
+            *hashes = (uint8_t*)((uintptr_t)archive->m_ArchiveIndex + dmEndian::ToNetwork(archive->m_ArchiveIndex->m_HashOffset));
+            *entries = (EntryData*)((uintptr_t)archive->m_ArchiveIndex + dmEndian::ToNetwork(archive->m_ArchiveIndex->m_EntryDataOffset));
+        }
+    }
+
+    // The digests are uniformly distributed, so the first bytes work as the hash key
+    static inline uint32_t GetLookupKey(const uint8_t* hash)
+    {
+        uint32_t key;
+        memcpy(&key, hash, sizeof(key));
+        return key;
+    }
+
+    void BuildEntryLookup(HArchiveIndexContainer archive)
+    {
+        DM_PROFILE("BuildEntryLookup");
+        DeleteEntryLookup(archive);
+
+        uint32_t entry_count = dmEndian::ToNetwork(archive->m_ArchiveIndex->m_EntryDataCount);
+        uint32_t hash_len = dmEndian::ToNetwork(archive->m_ArchiveIndex->m_HashLength);
+        if (entry_count == 0 || hash_len < sizeof(uint32_t))
+            return;
+
+        uint8_t* hashes = 0;
+        EntryData* entries = 0;
+        GetHashesAndEntries(archive, &hashes, &entries);
+
+        // Keep the load factor at or below 50% to keep the probe sequences short
+        uint32_t size = 16;
+        while (size < entry_count * 2)
+            size <<= 1;
+        uint32_t mask = size - 1;
+
+        uint32_t* lookup = (uint32_t*)malloc(size * sizeof(uint32_t));
+        memset(lookup, 0, size * sizeof(uint32_t));
+        for (uint32_t i = 0; i < entry_count; ++i)
+        {
+            uint32_t slot = GetLookupKey(hashes + dmResourceArchive::MAX_HASH * i) & mask;
+            while (lookup[slot] != 0)
+                slot = (slot + 1) & mask;
+            lookup[slot] = i + 1;
+        }
+
+        archive->m_EntryLookup = lookup;
+        archive->m_EntryLookupHashes = hashes;
+        archive->m_EntryLookupCount = entry_count;
+        archive->m_EntryLookupMask = mask;
+    }
+
+    dmResourceArchive::Result FindEntry(dmResourceArchive::HArchiveIndexContainer archive, const uint8_t* hash, uint32_t hash_len, dmResourceArchive::EntryData** entry)
+    {
+        uint32_t entry_count = dmEndian::ToNetwork(archive->m_ArchiveIndex->m_EntryDataCount);
+        uint8_t* hashes = 0;
+        dmResourceArchive::EntryData* entries = 0;
+        GetHashesAndEntries(archive, &hashes, &entries);
+
+        if (archive->m_EntryLookup && archive->m_EntryLookupHashes == hashes && archive->m_EntryLookupCount == entry_count && hash_len >= sizeof(uint32_t))
+        {
+            const uint32_t* lookup = archive->m_EntryLookup;
+            uint32_t mask = archive->m_EntryLookupMask;
+            uint32_t slot = GetLookupKey(hash) & mask;
+            while (lookup[slot] != 0)
+            {
+                uint32_t index = lookup[slot] - 1;
+                if (memcmp(hash, hashes + dmResourceArchive::MAX_HASH * index, hash_len) == 0)
+                {
+                    if (entry != 0)
+                    {
+                        *entry = &entries[index];
+                    }
+                    return dmResourceArchive::RESULT_OK;
+                }
+                slot = (slot + 1) & mask;
+            }
+            return dmResourceArchive::RESULT_NOT_FOUND;
         }
 
         // Search for hash with binary search (entries are sorted on hash)
@@ -499,6 +596,164 @@ namespace dmResourceArchive
         return RESULT_OK;
     }
 
+    void SetJobThread(dmJobThread::HContext job_thread)
+    {
+        g_JobThread = job_thread;
+    }
+
+    struct DecompressChunkJob
+    {
+        const uint8_t*  m_Data;
+        uint8_t*        m_Buffer;
+        uint32_t        m_DataSize;
+        uint32_t        m_BufferSize;
+    };
+
+    static int DecompressChunkJobFn(void* context, void* data)
+    {
+        int32_atomic_t* errors = (int32_atomic_t*)context;
+        DecompressChunkJob* job = (DecompressChunkJob*)data;
+
+        int decompressed_size;
+        dmLZ4::Result r = dmLZ4::DecompressBuffer(job->m_Data, job->m_DataSize, job->m_Buffer, job->m_BufferSize, &decompressed_size);
+        if (dmLZ4::RESULT_OK != r || (uint32_t)decompressed_size != job->m_BufferSize)
+        {
+            dmAtomicIncrement32(errors);
+        }
+        return 0;
+    }
+
+    Result DecompressChunks(const uint8_t* data, uint32_t data_size, uint8_t* buffer, uint32_t buffer_size)
+    {
+        if (data_size < sizeof(ChunkHeader))
+        {
+            return RESULT_INVALID_DATA;
+        }
+
+        // The data isn't necessarily aligned, nor in host byte order
+        ChunkHeader header;
+        memcpy(&header, data, sizeof(header));
+        const uint32_t chunk_size  = dmEndian::ToNetwork(header.m_ChunkSize);
+        const uint32_t chunk_count = dmEndian::ToNetwork(header.m_ChunkCount);
+
+        if (chunk_size == 0 || chunk_count != (buffer_size + chunk_size - 1) / chunk_size ||
+            (data_size - sizeof(ChunkHeader)) / sizeof(uint32_t) < chunk_count)
+        {
+            return RESULT_INVALID_DATA;
+        }
+
+        const uint8_t* sizes = data + sizeof(ChunkHeader);
+        const uint8_t* chunk_data = sizes + chunk_count * sizeof(uint32_t);
+        uint32_t data_left = data_size - (uint32_t)(chunk_data - data);
+
+        DecompressChunkJob* jobs = new DecompressChunkJob[chunk_count];
+        for (uint32_t i = 0; i < chunk_count; ++i)
+        {
+            uint32_t compressed_size;
+            memcpy(&compressed_size, sizes + i * sizeof(uint32_t), sizeof(uint32_t));
+            compressed_size = dmEndian::ToNetwork(compressed_size);
+            if (compressed_size > data_left)
+            {
+                delete[] jobs;
+                return RESULT_INVALID_DATA;
+            }
+
+            DecompressChunkJob& job = jobs[i];
+            job.m_Data       = chunk_data;
+            job.m_DataSize   = compressed_size;
+            job.m_Buffer     = buffer + i * chunk_size;
+            job.m_BufferSize = i == chunk_count - 1 ? buffer_size - i * chunk_size : chunk_size;
+
+            chunk_data += compressed_size;
+            data_left -= compressed_size;
+        }
+
+        int32_atomic_t errors = 0;
+        dmJobThread::JobGroup group;
+        dmJobThread::InitGroup(&group, 0);
+        for (uint32_t i = 0; i < chunk_count; ++i)
+        {
+            dmJobThread::PushGroupJob(g_JobThread, &group, DecompressChunkJobFn, (void*)&errors, &jobs[i]);
+        }
+        dmJobThread::WaitGroup(g_JobThread, &group);
+        delete[] jobs;
+
+        return dmAtomicGet32(&errors) == 0 ? RESULT_OK : RESULT_OUTBUFFER_TOO_SMALL;
+    }
+
+    static Result GetDictionary(HArchiveIndexContainer archive, uint32_t offset, uint32_t size, const uint8_t** out_data)
+    {
+        const ArchiveFileIndex* afi = archive->m_ArchiveFileIndex;
+        if (afi->m_IsMemMapped)
+        {
+            if (offset > afi->m_ResourceSize || size > afi->m_ResourceSize - offset)
+                return RESULT_INVALID_DATA;
+            *out_data = afi->m_ResourceData + offset;
+            return RESULT_OK;
+        }
+
+        for (uint32_t i = 0; i < archive->m_DictionaryCount; ++i)
+        {
+            const ArchiveDictionary& dictionary = archive->m_Dictionaries[i];
+            if (dictionary.m_Offset == offset && dictionary.m_Size == size)
+            {
+                *out_data = dictionary.m_Data;
+                return RESULT_OK;
+            }
+        }
+
+        uint8_t* data = new uint8_t[size];
+        FILE* resource_file = afi->m_FileResourceData;
+        if (fseek(resource_file, offset, SEEK_SET) != 0 || fread(data, 1, size, resource_file) != size)
+        {
+            delete[] data;
+            return RESULT_IO_ERROR;
+        }
+
+        archive->m_Dictionaries = (ArchiveDictionary*)realloc(archive->m_Dictionaries, (archive->m_DictionaryCount + 1) * sizeof(ArchiveDictionary));
+        ArchiveDictionary& dictionary = archive->m_Dictionaries[archive->m_DictionaryCount++];
+        dictionary.m_Offset = offset;
+        dictionary.m_Size   = size;
+        dictionary.m_Data   = data;
+
+        *out_data = data;
+        return RESULT_OK;
+    }
+
+    Result DecompressWithDictionary(HArchiveIndexContainer archive, const uint8_t* data, uint32_t data_size, uint8_t* buffer, uint32_t buffer_size)
+    {
+        if (data_size < sizeof(DictionaryHeader))
+        {
+            return RESULT_INVALID_DATA;
+        }
+
+        // The data isn't necessarily aligned, nor in host byte order
+        DictionaryHeader header;
+        memcpy(&header, data, sizeof(header));
+        const uint32_t dictionary_offset = dmEndian::ToNetwork(header.m_DictionaryOffset);
+        const uint32_t dictionary_size   = dmEndian::ToNetwork(header.m_DictionarySize);
+        if (dictionary_size == 0 || dictionary_size > MAX_DICTIONARY_SIZE)
+        {
+            return RESULT_INVALID_DATA;
+        }
+
+        const uint8_t* dictionary = 0;
+        Result r = GetDictionary(archive, dictionary_offset, dictionary_size, &dictionary);
+        if (RESULT_OK != r)
+        {
+            return r;
+        }
+
+        int decompressed_size;
+        dmLZ4::Result lz4_r = dmLZ4::DecompressBufferWithDictionary(data + sizeof(DictionaryHeader), data_size - sizeof(DictionaryHeader),
+                                                                    dictionary, dictionary_size, buffer, buffer_size, &decompressed_size);
+        if (dmLZ4::RESULT_OK != lz4_r || (uint32_t)decompressed_size != buffer_size)
+        {
+            return RESULT_OUTBUFFER_TOO_SMALL;
+        }
+        return RESULT_OK;
+    }
+
     Result ReadEntry(HArchiveIndexContainer archive, const EntryData* entry, void* buffer)
     {
         // We always assume it's in Host format, since it may arrive from memory mapped data
@@ -599,8 +854,26 @@ namespace dmResourceArchive
             }
         }
 
-        if (compressed)
+        if (compressed && (flags & dmResourceArchive::ENTRY_FLAG_DICTIONARY))
+        {
+            DM_PROFILE("Decompress");
+            dmResource::ReadPhaseScope timing_scope(dmResource::LOAD_PHASE_DECOMPRESS);
+            Result r = DecompressWithDictionary(archive, source_data, source_data_size, (uint8_t*)buffer, size);
+            delete[] temp_data;
+            return r;
+        }
+        else if (compressed && (flags & dmResourceArchive::ENTRY_FLAG_CHUNKED))
         {
+            DM_PROFILE("Decompress");
+            dmResource::ReadPhaseScope timing_scope(dmResource::LOAD_PHASE_DECOMPRESS);
+            Result r = DecompressChunks(source_data, source_data_size, (uint8_t*)buffer, size);
+            delete[] temp_data;
+            return r;
+        }
+        else if (compressed)
+        {
+            DM_PROFILE("Decompress");
+            dmResource::ReadPhaseScope timing_scope(dmResource::LOAD_PHASE_DECOMPRESS);
             int decompressed_size;
             dmLZ4::Result r = dmLZ4::DecompressBuffer(source_data, source_data_size, buffer, size, &decompressed_size);
             if (dmLZ4::RESULT_OK != r)
@@ -614,6 +887,58 @@ namespace dmResourceArchive
         return dmResourceArchive::RESULT_OK;
     }
 
+    bool GetEntryData(HArchiveIndexContainer archive, const EntryData* entry, const uint8_t** data)
+    {
+        const uint32_t flags            = dmEndian::ToNetwork(entry->m_Flags);
+        const uint32_t resource_offset  = dmEndian::ToNetwork(entry->m_ResourceDataOffset);
+
+        const ArchiveFileIndex* afi = archive->m_ArchiveFileIndex;
+        if (!afi->m_IsMemMapped || (flags & (ENTRY_FLAG_ENCRYPTED | ENTRY_FLAG_COMPRESSED)))
+        {
+            return false;
+        }
+
+        *data = (const uint8_t*) (((uintptr_t)afi->m_ResourceData + resource_offset));
+        return true;
+    }
+
+    Result ReadEntryPartial(HArchiveIndexContainer archive, const EntryData* entry, uint32_t offset, void* buffer, uint32_t buffer_len, uint32_t* nread)
+    {
+        const uint32_t flags            = dmEndian::ToNetwork(entry->m_Flags);
+        const uint32_t size             = dmEndian::ToNetwork(entry->m_ResourceSize);
+        const uint32_t resource_offset  = dmEndian::ToNetwork(entry->m_ResourceDataOffset);
+
+        *nread = 0;
+        if (flags & (ENTRY_FLAG_ENCRYPTED | ENTRY_FLAG_COMPRESSED))
+        {
+            return RESULT_INVALID_DATA;
+        }
+
+        if (offset >= size)
+        {
+            return RESULT_OK;
+        }
+        uint32_t len = dmMath::Min(buffer_len, size - offset);
+
+        const ArchiveFileIndex* afi = archive->m_ArchiveFileIndex;
+        if (afi->m_IsMemMapped)
+        {
+            memcpy(buffer, (const uint8_t*) (((uintptr_t)afi->m_ResourceData + resource_offset + offset)), len);
+        }
+        else
+        {
+            FILE* resource_file = afi->m_FileResourceData;
+            fseek(resource_file, resource_offset + offset, SEEK_SET);
+            if (fread(buffer, 1, len, resource_file) != len)
+            {
+                return RESULT_IO_ERROR;
+            }
+        }
+
+        *nread = len;
+        return RESULT_OK;
+    }
+
     Result WriteArchiveIndex(const char* path, ArchiveIndex* ai)
     {
         // Write to temporary index file, filename liveupdate.arci.tmp
@@ -685,6 +1010,7 @@ namespace dmResourceArchive
         archive_container->m_ArchiveIndex = new_index;
         // Since we store data sequentially when doing the deep-copy we want to access it in that fashion
         archive_container->m_IsMemMapped = mem_mapped;
+        BuildEntryLookup(archive_container);
     }
 
     uint32_t GetEntryCount(HArchiveIndexContainer archive)
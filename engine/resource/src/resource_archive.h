@@ -24,6 +24,7 @@
 #include <dlib/align.h>
 #include <dlib/array.h>
 #include <dlib/path.h> // DMPATH_MAX_PATH
+#include <dlib/job_thread.h>
 
 
 namespace dmResourceArchive
@@ -58,6 +59,39 @@ namespace dmResourceArchive
         ENTRY_FLAG_ENCRYPTED        = 1 << 0,
         ENTRY_FLAG_COMPRESSED       = 1 << 1,
         ENTRY_FLAG_LIVEUPDATE_DATA  = 1 << 2,
+        ENTRY_FLAG_CHUNKED          = 1 << 3, // Compressed as independent chunks, see ChunkHeader
+        ENTRY_FLAG_DICTIONARY       = 1 << 4, // Compressed against a dictionary, see DictionaryHeader
+    };
+
+    // LZ4 only references the last 64KB of a dictionary
+    const static uint32_t MAX_DICTIONARY_SIZE = 64 * 1024;
+
+    // Large compressed entries may be split into chunks that are compressed separately so that they can be
+    // decompressed in parallel. The (possibly encrypted) entry data then starts with this header, followed by
+    // m_ChunkCount compressed chunk sizes (uint32_t) and then the compressed chunks.
+    // Each chunk decompresses to m_ChunkSize bytes, except the last one. All values are in network byte order.
+    struct ChunkHeader
+    {
+        uint32_t m_ChunkSize;
+        uint32_t m_ChunkCount;
+    };
+
+    // Small entries (e.g. the DDF files) hardly compress on their own, so they may instead be compressed against a
+    // dictionary shared by the entries of the same type. The dictionary is stored as is (i.e. neither compressed nor
+    // encrypted) in the archive data file, and the (possibly encrypted) entry data starts with this header, followed
+    // by the compressed data. All values are in network byte order.
+    struct DictionaryHeader
+    {
+        uint32_t m_DictionaryOffset; // Offset of the dictionary in the archive data file
+        uint32_t m_DictionarySize;
+    };
+
+    // A dictionary read from an archive data file that isn't memory mapped
+    struct ArchiveDictionary
+    {
+        uint32_t m_Offset;
+        uint32_t m_Size;
+        uint8_t* m_Data;
     };
 
     // part of the .arci file format
@@ -121,6 +155,16 @@ namespace dmResourceArchive
         //ArchiveLoader       m_Loader;
         void*               m_UserData;         // private to the loader
 
+        // Open addressed hash table over the entries, keyed on the hash digest. Holds entry index + 1, 0 is an empty slot.
+        uint32_t*           m_EntryLookup;
+        const uint8_t*      m_EntryLookupHashes; // The hashes the table was built from, used to detect changes to the archive index
+        uint32_t            m_EntryLookupCount;
+        uint32_t            m_EntryLookupMask;
+
+        // Dictionaries are read once and kept, unless the archive data is memory mapped
+        ArchiveDictionary*  m_Dictionaries;
+        uint32_t            m_DictionaryCount;
+
         uint32_t m_ArchiveIndexSize;            // kept for unmapping
         uint8_t  m_IsMemMapped:1; // if the m_ArchiveIndex is memory mapped
         uint8_t  :7;
@@ -203,6 +247,13 @@ namespace dmResourceArchive
      */
     Result FindEntry(HArchiveIndexContainer archive, const uint8_t* hash, uint32_t hash_len, EntryData** entry);
 
+    /**
+     * Build the lookup table used by FindEntry. Done when the archive is loaded, or when a new archive index is set.
+     * If the table is missing or out of date, FindEntry falls back to a binary search
+     * @param archive archive index handle
+     */
+    void BuildEntryLookup(HArchiveIndexContainer archive);
+
     /**
      * Read resource from the given archive
      * @param archive archive index handle
@@ -212,6 +263,36 @@ namespace dmResourceArchive
      */
     Result ReadEntry(HArchiveIndexContainer archive, const EntryData* entry, void* buffer);
 
+    /**
+     * Get a pointer to the resource data within a memory mapped archive, without copying it.
+     * Only possible for entries that are neither compressed nor encrypted.
+     * @param archive archive index handle
+     * @param entry_data entry data
+     * @param data the resource data. Valid for as long as the archive is mounted
+     * @return true if the data could be returned. Otherwise the entry has to be read with ReadEntry()
+     */
+    bool GetEntryData(HArchiveIndexContainer archive, const EntryData* entry, const uint8_t** data);
+
+    /**
+     * Read a range of the resource data from the given archive.
+     * Only possible for entries that are neither compressed nor encrypted.
+     * @param archive archive index handle
+     * @param entry_data entry data
+     * @param offset offset within the resource
+     * @param buffer buffer to load to
+     * @param buffer_len number of bytes to read
+     * @param nread number of bytes read. Less than buffer_len at the end of the resource
+     * @return RESULT_OK on success, RESULT_INVALID_DATA if the entry is compressed or encrypted
+     */
+    Result ReadEntryPartial(HArchiveIndexContainer archive, const EntryData* entry, uint32_t offset, void* buffer, uint32_t buffer_len, uint32_t* nread);
+
+    /**
+     * Set the job thread used to decompress chunked entries in parallel.
+     * If no job thread is set, the chunks are decompressed on the calling thread.
+     * @param job_thread the job thread context, or 0
+     */
+    void SetJobThread(dmJobThread::HContext job_thread);
+
     /**
      * Delete archive index. Only required for archives created with LoadArchive function
      * @param archive archive index handle
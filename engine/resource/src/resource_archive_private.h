@@ -32,6 +32,12 @@ namespace dmResourceArchive
 
     Result GetInsertionIndex(ArchiveIndex* archive, const uint8_t* hash_digest, const uint8_t* hashes, int* index);
 
+    // Decompress an entry stored with ENTRY_FLAG_CHUNKED
+    Result DecompressChunks(const uint8_t* data, uint32_t data_size, uint8_t* buffer, uint32_t buffer_size);
+
+    // Decompress an entry stored with ENTRY_FLAG_DICTIONARY. The dictionary is read from the archive data
+    Result DecompressWithDictionary(HArchiveIndexContainer archive, const uint8_t* data, uint32_t data_size, uint8_t* buffer, uint32_t buffer_size);
+
     // Unit test helpers
     /**
      * Get total entries, i.e. files/resources in archive
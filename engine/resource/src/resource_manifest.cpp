@@ -12,6 +12,9 @@
 // CONDITIONS OF ANY KIND, either express or implied. See the License for the
 // specific language governing permissions and limitations under the License.
 
+#include <stdlib.h>
+#include <string.h>
+
 #include "resource.h"
 #include "resource_manifest.h"
 #include "resource_manifest_private.h"
@@ -50,6 +53,11 @@ uint32_t GetEntryHashLength(dmResource::HManifest manifest)
     return dmResource::HashLength(algorithm);
 }
 
+dmhash_t GetManifestDataHash(dmResource::HManifest manifest)
+{
+    return dmHashBuffer64(manifest->m_DDF->m_Data.m_Data, manifest->m_DDF->m_Data.m_Count);
+}
+
 void DeleteManifest(dmResource::HManifest manifest)
 {
     if (!manifest)
@@ -58,6 +66,7 @@ void DeleteManifest(dmResource::HManifest manifest)
         dmDDF::FreeMessage(manifest->m_DDF);
     if (manifest->m_DDFData)
         dmDDF::FreeMessage(manifest->m_DDFData);
+    free(manifest->m_EntryLookup);
     delete manifest;
 }
 
@@ -89,6 +98,7 @@ static dmResource::Result ManifestLoadMessage(const uint8_t* manifest_msg_buf, u
         return dmResource::RESULT_DDF_ERROR;
     }
 
+    BuildEntryLookup(out_manifest);
     return dmResource::RESULT_OK;
 }
 
@@ -190,10 +200,58 @@ dmResource::Result GetApplicationSupportPath(dmResource::HManifest manifest, cha
 }
 
 
+void BuildEntryLookup(dmResource::HManifest manifest)
+{
+    free(manifest->m_EntryLookup);
+    manifest->m_EntryLookup = 0;
+    manifest->m_EntryLookupCount = 0;
+    manifest->m_EntryLookupMask = 0;
+
+    uint32_t entry_count = manifest->m_DDFData->m_Resources.m_Count;
+    dmLiveUpdateDDF::ResourceEntry* entries = manifest->m_DDFData->m_Resources.m_Data;
+    if (entry_count == 0)
+        return;
+
+    // Keep the load factor at or below 50% to keep the probe sequences short
+    uint32_t size = 16;
+    while (size < entry_count * 2)
+        size <<= 1;
+    uint32_t mask = size - 1;
+
+    uint32_t* lookup = (uint32_t*)malloc(size * sizeof(uint32_t));
+    memset(lookup, 0, size * sizeof(uint32_t));
+    for (uint32_t i = 0; i < entry_count; ++i)
+    {
+        uint32_t slot = (uint32_t)entries[i].m_UrlHash & mask;
+        while (lookup[slot] != 0)
+            slot = (slot + 1) & mask;
+        lookup[slot] = i + 1;
+    }
+
+    manifest->m_EntryLookup = lookup;
+    manifest->m_EntryLookupCount = entry_count;
+    manifest->m_EntryLookupMask = mask;
+}
+
 dmLiveUpdateDDF::ResourceEntry* FindEntry(dmResource::HManifest manifest, dmhash_t url_hash)
 {
     dmLiveUpdateDDF::ResourceEntry* entries = manifest->m_DDFData->m_Resources.m_Data;
 
+    if (manifest->m_EntryLookup && manifest->m_EntryLookupCount == manifest->m_DDFData->m_Resources.m_Count)
+    {
+        const uint32_t* lookup = manifest->m_EntryLookup;
+        uint32_t mask = manifest->m_EntryLookupMask;
+        uint32_t slot = (uint32_t)url_hash & mask;
+        while (lookup[slot] != 0)
+        {
+            dmLiveUpdateDDF::ResourceEntry* entry = &entries[lookup[slot] - 1];
+            if (entry->m_UrlHash == url_hash)
+                return entry;
+            slot = (slot + 1) & mask;
+        }
+        return 0;
+    }
+
     int first = 0;
     int last = manifest->m_DDFData->m_Resources.m_Count - 1;
     while (first <= last)
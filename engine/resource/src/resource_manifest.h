@@ -50,6 +50,9 @@ namespace dmResource
 
     uint32_t            GetEntryHashLength(dmResource::HManifest manifest);
 
+    // Changes whenever any of the resources in the manifest change
+    dmhash_t            GetManifestDataHash(dmResource::HManifest manifest);
+
     void                DeleteManifest(dmResource::HManifest manifest);
     dmResource::Result  LoadManifest(const dmURI::Parts* uri, dmResource::HManifest* out);
     dmResource::Result  LoadManifest(const char* path, dmResource::HManifest* out);
@@ -79,6 +82,14 @@ namespace dmResource
      */
     dmLiveUpdateDDF::ResourceEntry* FindEntry(dmResource::HManifest manifest, dmhash_t url_hash);
 
+    /*#
+     * Build the url hash lookup table used by FindEntry. Done when the manifest is loaded,
+     * and needs to be done again if the resource entries are replaced.
+     * @name BuildEntryLookup
+     * @param manifest [type: dmResource::HManifest] The manifest
+     */
+    void BuildEntryLookup(dmResource::HManifest manifest);
+
     // Used when debugging (e.g. unit tests)
     void DebugPrintManifest(dmResource::HManifest manifest);
 }
@@ -44,6 +44,10 @@ struct Manifest
     dmLiveUpdateDDF::ManifestData*              m_DDFData;
     // For mutable archives, we fill this just-in-time with the mappings from hex digest to url_path
     dmHashTable64<dmhash_t>                     m_DigestToUrl;
+    // Open addressed hash table over m_Resources, keyed on the url hash. Holds entry index + 1, 0 is an empty slot.
+    uint32_t*                                   m_EntryLookup;
+    uint32_t                                    m_EntryLookupCount;
+    uint32_t                                    m_EntryLookupMask;
 };
 
 }
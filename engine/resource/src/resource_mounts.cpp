@@ -22,6 +22,7 @@
 
 #include <dlib/dstrings.h>
 #include <dlib/log.h>
+#include <dlib/math.h>
 #include <dlib/mutex.h>
 #include <dlib/sys.h>
 #include <algorithm> // std::sort
@@ -65,6 +66,7 @@ static dmResource::Result ProviderResultToResult(dmResourceProvider::Result resu
     case dmResourceProvider::RESULT_OK:         return dmResource::RESULT_OK;
     case dmResourceProvider::RESULT_IO_ERROR:   return dmResource::RESULT_IO_ERROR;
     case dmResourceProvider::RESULT_NOT_FOUND:  return dmResource::RESULT_RESOURCE_NOT_FOUND;
+    case dmResourceProvider::RESULT_NOT_SUPPORTED: return dmResource::RESULT_NOT_SUPPORTED;
     default:                                    return dmResource::RESULT_UNKNOWN_ERROR;
     }
 }
@@ -455,6 +457,88 @@ dmResource::Result ReadResource(HContext ctx, dmhash_t path_hash, const char* pa
     return dmResource::RESULT_RESOURCE_NOT_FOUND;
 }
 
+dmResource::Result ReadResourcePartial(HContext ctx, dmhash_t path_hash, const char* path, uint32_t offset, uint8_t* buffer, uint32_t buffer_size, uint32_t* nread)
+{
+    DM_MUTEX_SCOPED_LOCK(ctx->m_Mutex);
+
+    uint32_t size = ctx->m_Mounts.Size();
+    for (uint32_t i = 0; i < size; ++i)
+    {
+        ArchiveMount& mount = ctx->m_Mounts[i];
+        dmResourceProvider::Result result = dmResourceProvider::ReadFilePartial(mount.m_Archive, path_hash, path, offset, buffer, buffer_size, nread);
+        if (dmResourceProvider::RESULT_NOT_FOUND == result)
+            continue;
+        // The first mount that has the file decides, even if it has to be read as a whole
+        DM_RESOURCE_DBG_LOG(3, "ReadResourcePartial: %s (%u bytes at %u) - result %d\n", path, buffer_size, offset, result);
+        return ProviderResultToResult(result);
+    }
+
+    if (!ctx->m_CustomFiles.Empty())
+    {
+        CustomFile* file = ctx->m_CustomFiles.Get(path_hash);
+        if (file)
+        {
+            *nread = offset < file->m_Size ? dmMath::Min(buffer_size, file->m_Size - offset) : 0;
+            memcpy(buffer, (const uint8_t*)file->m_Resource + offset, *nread);
+            return dmResource::RESULT_OK;
+        }
+    }
+
+    return dmResource::RESULT_RESOURCE_NOT_FOUND;
+}
+
+dmResource::Result GetResourceData(HContext ctx, dmhash_t path_hash, const char* path, const uint8_t** data, uint32_t* data_size)
+{
+    DM_MUTEX_SCOPED_LOCK(ctx->m_Mutex);
+
+    uint32_t size = ctx->m_Mounts.Size();
+    for (uint32_t i = 0; i < size; ++i)
+    {
+        ArchiveMount& mount = ctx->m_Mounts[i];
+        dmResourceProvider::Result result = dmResourceProvider::GetFileSize(mount.m_Archive, path_hash, path, data_size);
+        if (dmResourceProvider::RESULT_NOT_FOUND == result)
+            continue;
+        if (dmResourceProvider::RESULT_OK == result)
+        {
+            // The first mount that has the file decides, even if it has to be read
+            result = dmResourceProvider::GetFileData(mount.m_Archive, path_hash, path, data);
+            DM_RESOURCE_DBG_LOG(3, "GetResourceData: %s (%u bytes) - result %d\n", path, *data_size, result);
+            DebugPrintMount(3, mount);
+        }
+        return ProviderResultToResult(result);
+    }
+
+    // Custom files are always copied
+    if (!ctx->m_CustomFiles.Empty() && ctx->m_CustomFiles.Get(path_hash))
+        return dmResource::RESULT_NOT_SUPPORTED;
+
+    return dmResource::RESULT_RESOURCE_NOT_FOUND;
+}
+
+dmResource::Result GetResourceLocation(HContext ctx, dmhash_t path_hash, const char* path, uint32_t* mount_index, uint32_t* offset)
+{
+    DM_MUTEX_SCOPED_LOCK(ctx->m_Mutex);
+
+    uint32_t resource_size;
+    uint32_t size = ctx->m_Mounts.Size();
+    for (uint32_t i = 0; i < size; ++i)
+    {
+        ArchiveMount& mount = ctx->m_Mounts[i];
+        dmResourceProvider::Result result = dmResourceProvider::GetFileSize(mount.m_Archive, path_hash, path, &resource_size);
+        if (dmResourceProvider::RESULT_NOT_FOUND == result)
+            continue;
+        if (dmResourceProvider::RESULT_OK == result)
+        {
+            *mount_index = i;
+            if (dmResourceProvider::RESULT_OK != dmResourceProvider::GetFileOffset(mount.m_Archive, path_hash, path, offset))
+                *offset = 0;
+        }
+        return ProviderResultToResult(result);
+    }
+
+    return dmResource::RESULT_RESOURCE_NOT_FOUND;
+}
+
 dmResource::Result ReadResource(HContext ctx, const char* path, dmhash_t path_hash, dmArray<char>* buffer)
 {
     DM_MUTEX_SCOPED_LOCK(ctx->m_Mutex);
@@ -51,6 +51,12 @@ namespace dmResourceMounts
     dmResource::Result GetResourceSize(HContext ctx, dmhash_t path_hash, const char* path, uint32_t* resource_size);
     dmResource::Result ReadResource(HContext ctx, dmhash_t path_hash, const char* path, uint8_t* buffer, uint32_t buffer_size);
     dmResource::Result ReadResource(HContext ctx, dmhash_t path_hash, const char* path, dmArray<char>* buffer);
+    // Reads up to buffer_size bytes of the resource, starting at offset. Returns RESULT_NOT_SUPPORTED if the resource has to be read as a whole
+    dmResource::Result ReadResourcePartial(HContext ctx, dmhash_t path_hash, const char* path, uint32_t offset, uint8_t* buffer, uint32_t buffer_size, uint32_t* nread);
+    // Gets a pointer to the resource data within the mount, without copying. Returns RESULT_NOT_SUPPORTED if the resource has to be read
+    dmResource::Result GetResourceData(HContext ctx, dmhash_t path_hash, const char* path, const uint8_t** data, uint32_t* data_size);
+    // Gets the mount that holds the resource, and the position of the resource within it (0 if the mount can't tell)
+    dmResource::Result GetResourceLocation(HContext ctx, dmhash_t path_hash, const char* path, uint32_t* mount_index, uint32_t* offset);
 
     struct SGetMountResult
     {
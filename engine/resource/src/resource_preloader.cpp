@@ -13,6 +13,7 @@
 // specific language governing permissions and limitations under the License.
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <assert.h>
 #include <string.h>
 #include <time.h>
@@ -22,6 +23,7 @@
 #include <dlib/hash.h>
 #include <dlib/hashtable.h>
 #include <dlib/log.h>
+#include <dlib/math.h>
 #include <dlib/uri.h>
 #include <dlib/time.h>
 #include <dlib/spinlock.h>
@@ -29,6 +31,7 @@
 #include "block_allocator.h"
 #include "resource.h"
 #include "resource_private.h"
+#include "resource_timeline.h"
 #include "resource_util.h"
 #include "async/load_queue.h"
 
@@ -69,32 +72,22 @@
 // to each request item. The path cache is also syncronized with the same spinlock as the new preloader hints array.
 // The path cache is not touched by the UpdatePreloader code, we keep the internalized pointers in the item.
 
-// If max number of preload items is reached or the path cache is full new items added to the preloader will
-// be thrown away and can potentially cause synced loading of those resources.
+// The request tree, the path cache and the in-progress table all grow on demand, so any number of
+// resources can be preloaded. Requests and path strings are allocated in blocks that are never moved,
+// so pointers to them stay valid while the preloader grows.
 
+typedef int32_t TRequestIndex;
 
-
-typedef int16_t TRequestIndex;
-
-// The preloader will function even down to a value of 1 here (the root object)
-// and sets the limit of how large a dependencies tree can be stored. Since nodes
-// are always present with all their children inserted (unless there was not room)
-// the required size is something the sum of all children on each level down along
-// the largest branch.
-
-typedef dmHashTable<dmhash_t, uint32_t> TPathHashTable;
+typedef dmHashTable<dmhash_t, const char*> TPathHashTable;
 typedef dmHashTable<dmhash_t, bool> TPathInProgressTable;
 
-
-static const uint32_t MAX_PRELOADER_REQUESTS         = 1024;
-static const uint32_t PATH_IN_PROGRESS_TABLE_SIZE    = MAX_PRELOADER_REQUESTS / 3;
-static const uint32_t PATH_IN_PROGRESS_CAPACITY      = MAX_PRELOADER_REQUESTS;
-static const uint32_t PATH_IN_PROGRESS_HASHDATA_SIZE = (PATH_IN_PROGRESS_TABLE_SIZE * sizeof(uint32_t)) + (PATH_IN_PROGRESS_CAPACITY * sizeof(TPathInProgressTable::Entry));
-static const uint32_t PATH_AVERAGE_LENGTH            = 40;
-static const uint32_t MAX_PRELOADER_PATHS            = 1536;
-static const uint32_t PATH_BUFFER_TABLE_SIZE         = 509;
-static const uint32_t PATH_BUFFER_TABLE_CAPACITY     = MAX_PRELOADER_PATHS;
-static const uint32_t PATH_BUFFER_HASHDATA_SIZE      = (PATH_BUFFER_TABLE_SIZE * sizeof(uint32_t)) + (PATH_BUFFER_TABLE_CAPACITY * sizeof(TPathHashTable::Entry));
+// Number of requests allocated at a time. The initial block is usually enough for a small collection
+static const uint32_t PRELOADER_REQUEST_BLOCK_SIZE    = 256;
+// Size of each block of internalized path strings. Must fit at least one path of RESOURCE_PATH_MAX
+static const uint32_t PATH_DATA_BLOCK_SIZE            = 16 * 1024;
+// Initial capacity of the path and in-progress tables. They grow with half their capacity when full
+static const uint32_t PATH_TABLE_INITIAL_CAPACITY     = 512;
+static const uint32_t PATH_IN_PROGRESS_INITIAL_CAPACITY = 128;
 
 struct PathDescriptor
 {
@@ -110,6 +103,8 @@ struct ResourcePostCreateParamsInternal
 {
     ResourcePostCreateParams m_Params;
     ResourceDescriptor m_ResourceDesc;
+    dmResource::LoadTiming m_Timing;
+    const char* m_Path;
     bool m_Destroy;
 };
 
@@ -126,7 +121,7 @@ struct PreloadRequest
     TRequestIndex m_Parent;
     TRequestIndex m_FirstChild;
     TRequestIndex m_NextSibling;
-    uint16_t m_PendingChildCount;
+    uint32_t m_PendingChildCount;
 
     // Set once resources have started loading, they have a load request
     dmLoadQueue::HRequest m_LoadRequest;
@@ -134,6 +129,8 @@ struct PreloadRequest
     // Set for items that are pending and waiting for children to complete
     void* m_Buffer;
     uint32_t m_BufferSize;
+    // The buffer points into a memory mapped archive and is not owned by the block allocator
+    uint8_t m_BufferIsMapped:1;
 
     // Set once preload function has run
     void* m_PreloadData;
@@ -141,39 +138,30 @@ struct PreloadRequest
     // Set once load has completed
     dmResource::Result m_LoadResult;
     void* m_Resource;
+
+    dmResource::LoadTiming m_Timing;
 };
 
 struct ResourcePreloader
 {
-    ResourcePreloader()
-        : m_InProgress(&m_PathInProgressData, PATH_IN_PROGRESS_TABLE_SIZE, PATH_IN_PROGRESS_CAPACITY)
-    {
-    }
     struct SyncedData
     {
-        SyncedData()
-            : m_PathLookup(m_LookupData, PATH_BUFFER_TABLE_SIZE, PATH_BUFFER_TABLE_CAPACITY)
-            , m_PathDataUsed(0)
-        {
-        }
         dmArray<PendingHint> m_NewHints;
         TPathHashTable m_PathLookup;
-        uint8_t m_LookupData[PATH_BUFFER_HASHDATA_SIZE];
-        char m_PathData[MAX_PRELOADER_PATHS * PATH_AVERAGE_LENGTH];
-        uint32_t m_PathDataUsed;
+        dmArray<char*> m_PathDataBlocks;
+        uint32_t m_PathDataUsed; // Used bytes of the last path data block
     } m_SyncedData;
 
     dmSpinlock::Spinlock m_SyncedDataSpinlock;
 
-    PreloadRequest m_Request[MAX_PRELOADER_REQUESTS];
+    // Blocks of PRELOADER_REQUEST_BLOCK_SIZE requests, see GetRequest()
+    dmArray<PreloadRequest*> m_RequestBlocks;
 
     // list of free nodes
-    TRequestIndex m_Freelist[MAX_PRELOADER_REQUESTS];
-    uint32_t m_FreelistSize;
+    dmArray<TRequestIndex> m_Freelist;
     dmLoadQueue::HQueue m_LoadQueue;
     dmResource::HFactory m_Factory;
     TPathInProgressTable m_InProgress;
-    uint8_t m_PathInProgressData[PATH_IN_PROGRESS_HASHDATA_SIZE];
 
     // used instead of dynamic allocs as far as it lasts.
     dmBlockAllocator::HContext m_BlockAllocator;
@@ -190,26 +178,68 @@ struct ResourcePreloader
     dmArray<void*> m_PersistedResources;
 };
 
+static inline PreloadRequest* GetRequest(ResourcePreloader* preloader, TRequestIndex index)
+{
+    return &preloader->m_RequestBlocks[index / PRELOADER_REQUEST_BLOCK_SIZE][index % PRELOADER_REQUEST_BLOCK_SIZE];
+}
+
+static uint32_t GetRequestCapacity(ResourcePreloader* preloader)
+{
+    return preloader->m_RequestBlocks.Size() * PRELOADER_REQUEST_BLOCK_SIZE;
+}
+
+// Adds a block of requests and puts them on the free list. The lowest index is popped first
+static void AddRequestBlock(ResourcePreloader* preloader)
+{
+    uint32_t first_index = GetRequestCapacity(preloader);
+    if (preloader->m_RequestBlocks.Full())
+    {
+        preloader->m_RequestBlocks.OffsetCapacity(dmMath::Max(4U, preloader->m_RequestBlocks.Capacity() / 2));
+    }
+    preloader->m_RequestBlocks.Push((PreloadRequest*)malloc(sizeof(PreloadRequest) * PRELOADER_REQUEST_BLOCK_SIZE));
+
+    uint32_t free_size = preloader->m_Freelist.Size();
+    preloader->m_Freelist.SetCapacity(GetRequestCapacity(preloader));
+    preloader->m_Freelist.SetSize(free_size + PRELOADER_REQUEST_BLOCK_SIZE);
+    for (uint32_t i = 0; i < PRELOADER_REQUEST_BLOCK_SIZE; ++i)
+    {
+        preloader->m_Freelist[free_size + i] = (TRequestIndex)(first_index + PRELOADER_REQUEST_BLOCK_SIZE - i - 1);
+    }
+}
+
+template <typename KEY, typename T>
+static void GrowTableIfFull(dmHashTable<KEY, T>& table)
+{
+    if (table.Full())
+    {
+        uint32_t capacity = table.Capacity() + table.Capacity() / 2;
+        table.SetCapacity(dmMath::Max(1U, capacity / 3), capacity);
+    }
+}
+
 namespace dmResource
 {
-    const char* InternalizePath(ResourcePreloader::SyncedData* preloader_synced_data, dmhash_t path_hash, const char* path, uint32_t path_len)
+    static const char* InternalizePath(ResourcePreloader::SyncedData* preloader_synced_data, dmhash_t path_hash, const char* path, uint32_t path_len)
     {
-        uint32_t* path_lookup = preloader_synced_data->m_PathLookup.Get(path_hash);
+        const char** path_lookup = preloader_synced_data->m_PathLookup.Get(path_hash);
         if (path_lookup != 0x0)
         {
-            return &preloader_synced_data->m_PathData[*path_lookup];
-        }
-        if (preloader_synced_data->m_PathLookup.Full())
-        {
-            return 0x0;
+            return *path_lookup;
         }
-        if (preloader_synced_data->m_PathDataUsed + path_len + 1 > sizeof(preloader_synced_data->m_PathData))
+        if (preloader_synced_data->m_PathDataBlocks.Empty() || preloader_synced_data->m_PathDataUsed + path_len + 1 > PATH_DATA_BLOCK_SIZE)
         {
-            return 0x0;
+            if (preloader_synced_data->m_PathDataBlocks.Full())
+            {
+                preloader_synced_data->m_PathDataBlocks.OffsetCapacity(8);
+            }
+            preloader_synced_data->m_PathDataBlocks.Push((char*)malloc(PATH_DATA_BLOCK_SIZE));
+            preloader_synced_data->m_PathDataUsed = 0;
         }
-        char* result = &preloader_synced_data->m_PathData[preloader_synced_data->m_PathDataUsed];
+        GrowTableIfFull(preloader_synced_data->m_PathLookup);
+
+        char* result = preloader_synced_data->m_PathDataBlocks.Back() + preloader_synced_data->m_PathDataUsed;
         dmStrlCpy(result, path, path_len + 1);
-        preloader_synced_data->m_PathLookup.Put(path_hash, preloader_synced_data->m_PathDataUsed);
+        preloader_synced_data->m_PathLookup.Put(path_hash, result);
         preloader_synced_data->m_PathDataUsed += path_len + 1;
         return result;
     }
@@ -263,20 +293,8 @@ namespace dmResource
         out_path_descriptor.m_CanonicalPathHash = dmHashBuffer64(canonical_path, canonical_path_len);
 
         DM_SPINLOCK_SCOPED_LOCK(preloader->m_SyncedDataSpinlock)
-        {
-            out_path_descriptor.m_InternalizedName = InternalizePath(&preloader->m_SyncedData, out_path_descriptor.m_NameHash, name, name_len);
-            if (out_path_descriptor.m_InternalizedName == 0x0)
-            {
-                dmSpinlock::Unlock(&preloader->m_SyncedDataSpinlock);
-                return RESULT_OUT_OF_MEMORY;
-            }
-            out_path_descriptor.m_InternalizedCanonicalPath = InternalizePath(&preloader->m_SyncedData, out_path_descriptor.m_CanonicalPathHash, canonical_path, canonical_path_len);
-            if (out_path_descriptor.m_InternalizedCanonicalPath == 0x0)
-            {
-                dmSpinlock::Unlock(&preloader->m_SyncedDataSpinlock);
-                return RESULT_OUT_OF_MEMORY;
-            }
-        }
+        out_path_descriptor.m_InternalizedName          = InternalizePath(&preloader->m_SyncedData, out_path_descriptor.m_NameHash, name, name_len);
+        out_path_descriptor.m_InternalizedCanonicalPath = InternalizePath(&preloader->m_SyncedData, out_path_descriptor.m_CanonicalPathHash, canonical_path, canonical_path_len);
 
         return RESULT_OK;
     }
@@ -292,6 +310,7 @@ namespace dmResource
     {
         dmhash_t path_hash = path_descriptor->m_CanonicalPathHash;
         assert(preloader->m_InProgress.Get(path_hash) == 0x0);
+        GrowTableIfFull(preloader->m_InProgress);
         preloader->m_InProgress.Put(path_hash, true);
     }
 
@@ -304,44 +323,44 @@ namespace dmResource
 
     static void PreloaderTreeInsert(ResourcePreloader* preloader, TRequestIndex index, TRequestIndex parent)
     {
-        PreloadRequest* reqs      = &preloader->m_Request[0];
-        reqs[index].m_NextSibling = reqs[parent].m_FirstChild;
-        reqs[index].m_Parent      = parent;
-        reqs[parent].m_FirstChild = index;
-        reqs[parent].m_PendingChildCount += 1;
+        PreloadRequest* req        = GetRequest(preloader, index);
+        PreloadRequest* parent_req = GetRequest(preloader, parent);
+        req->m_NextSibling         = parent_req->m_FirstChild;
+        req->m_Parent              = parent;
+        parent_req->m_FirstChild   = index;
+        parent_req->m_PendingChildCount += 1;
     }
 
     static void RemoveFromParentPendingCount(ResourcePreloader* preloader, PreloadRequest* req)
     {
         if (req->m_Parent != -1)
         {
-            assert(preloader->m_Request[req->m_Parent].m_PendingChildCount > 0);
-            preloader->m_Request[req->m_Parent].m_PendingChildCount -= 1;
+            assert(GetRequest(preloader, req->m_Parent)->m_PendingChildCount > 0);
+            GetRequest(preloader, req->m_Parent)->m_PendingChildCount -= 1;
         }
     }
 
     static Result PreloadPathDescriptor(HPreloader preloader, TRequestIndex parent, const PathDescriptor& path_descriptor)
     {
         // Quick deduplication, check if the child is already listed under the current parent
-        TRequestIndex child = preloader->m_Request[parent].m_FirstChild;
+        TRequestIndex child = GetRequest(preloader, parent)->m_FirstChild;
         while (child != -1)
         {
-            if (preloader->m_Request[child].m_PathDescriptor.m_NameHash == path_descriptor.m_NameHash)
+            if (GetRequest(preloader, child)->m_PathDescriptor.m_NameHash == path_descriptor.m_NameHash)
             {
                 return RESULT_ALREADY_REGISTERED;
             }
-            child = preloader->m_Request[child].m_NextSibling;
+            child = GetRequest(preloader, child)->m_NextSibling;
         }
 
-        if (!preloader->m_FreelistSize)
+        if (preloader->m_Freelist.Empty())
         {
-            // Preload queue is exhausted; this is not fatal, it just means the resource will be loaded
-            // inside the main thread which may cause stuttering
-            return RESULT_OUT_OF_MEMORY;
+            AddRequestBlock(preloader);
         }
 
-        TRequestIndex new_req = preloader->m_Freelist[--preloader->m_FreelistSize];
-        PreloadRequest* req   = &preloader->m_Request[new_req];
+        TRequestIndex new_req = preloader->m_Freelist.Back();
+        preloader->m_Freelist.Pop();
+        PreloadRequest* req   = GetRequest(preloader, new_req);
         memset(req, 0, sizeof(PreloadRequest));
         req->m_PathDescriptor    = path_descriptor;
         req->m_FirstChild        = -1;
@@ -355,15 +374,15 @@ namespace dmResource
         TRequestIndex go_up = parent;
         while (go_up != -1)
         {
-            if (preloader->m_Request[go_up].m_PathDescriptor.m_CanonicalPathHash == path_descriptor.m_CanonicalPathHash)
+            if (GetRequest(preloader, go_up)->m_PathDescriptor.m_CanonicalPathHash == path_descriptor.m_CanonicalPathHash)
             {
                 req->m_LoadResult = RESULT_RESOURCE_LOOP_ERROR;
                 assert(parent != -1);
-                assert(preloader->m_Request[parent].m_PendingChildCount > 0);
-                preloader->m_Request[parent].m_PendingChildCount -= 1;
+                assert(GetRequest(preloader, parent)->m_PendingChildCount > 0);
+                GetRequest(preloader, parent)->m_PendingChildCount -= 1;
                 break;
             }
-            go_up = preloader->m_Request[go_up].m_Parent;
+            go_up = GetRequest(preloader, go_up)->m_Parent;
         }
         return RESULT_OK;
     }
@@ -406,12 +425,12 @@ namespace dmResource
     // Only supports removing the first child, which is all the preloader uses anyway.
     static void PreloaderRemoveLeaf(ResourcePreloader* preloader, TRequestIndex index)
     {
-        assert(preloader->m_FreelistSize < MAX_PRELOADER_REQUESTS);
+        assert(preloader->m_Freelist.Size() < GetRequestCapacity(preloader));
 
-        PreloadRequest* me = &preloader->m_Request[index];
+        PreloadRequest* me = GetRequest(preloader, index);
         assert(me->m_FirstChild == -1);
         assert(me->m_PendingChildCount == 0);
-        PreloadRequest* parent = &preloader->m_Request[me->m_Parent];
+        PreloadRequest* parent = GetRequest(preloader, me->m_Parent);
         assert(parent->m_FirstChild == index);
 
         if (me->m_Resource)
@@ -433,7 +452,7 @@ namespace dmResource
             RemoveFromParentPendingCount(preloader, me);
         }
 
-        preloader->m_Freelist[preloader->m_FreelistSize++] = index;
+        preloader->m_Freelist.Push(index);
     }
 
     static void RemoveChildren(ResourcePreloader* preloader, PreloadRequest* req)
@@ -448,13 +467,14 @@ namespace dmResource
     HPreloader NewPreloader(HFactory factory, const dmArray<const char*>& names)
     {
         ResourcePreloader* preloader = new ResourcePreloader();
-        // root is always allocated so we don't add index zero in the free list
-        for (uint32_t i = 0; i < MAX_PRELOADER_REQUESTS - 1; i++)
-        {
-            preloader->m_Freelist[i] = MAX_PRELOADER_REQUESTS - i - 1;
-        }
+        preloader->m_SyncedData.m_PathLookup.SetCapacity(PATH_TABLE_INITIAL_CAPACITY / 3, PATH_TABLE_INITIAL_CAPACITY);
+        preloader->m_SyncedData.m_PathDataUsed = 0;
+        preloader->m_InProgress.SetCapacity(PATH_IN_PROGRESS_INITIAL_CAPACITY / 3, PATH_IN_PROGRESS_INITIAL_CAPACITY);
 
-        preloader->m_FreelistSize = MAX_PRELOADER_REQUESTS - 1;
+        AddRequestBlock(preloader);
+        // root is always allocated so we don't keep index zero in the free list
+        assert(preloader->m_Freelist.Back() == 0);
+        preloader->m_Freelist.Pop();
 
         preloader->m_Factory         = factory;
         preloader->m_LoadQueue       = dmLoadQueue::CreateQueue(factory);
@@ -464,7 +484,7 @@ namespace dmResource
         preloader->m_PersistedResources.SetCapacity(names.Size());
 
         // Insert root.
-        PreloadRequest* root = &preloader->m_Request[0];
+        PreloadRequest* root = GetRequest(preloader, 0);
         memset(root, 0x00, sizeof(PreloadRequest));
 
         root->m_LoadResult        = MakePathDescriptor(preloader, names[0], root->m_PathDescriptor);
@@ -474,7 +494,7 @@ namespace dmResource
         preloader->m_PersistResourceCount++;
 
         // Post create setup
-        preloader->m_PostCreateCallbacks.SetCapacity(MAX_PRELOADER_REQUESTS / 8);
+        preloader->m_PostCreateCallbacks.SetCapacity(PRELOADER_REQUEST_BLOCK_SIZE / 2);
         preloader->m_LoadQueueFull           = false;
         preloader->m_CreateComplete          = false;
         preloader->m_PostCreateCallbackIndex = 0;
@@ -513,7 +533,8 @@ namespace dmResource
     //   2) Having failed, (or created and destroyed), leaving => RESULT_SOME_ERROR + everything free:d
     //
     // If buffer is null it means to use the items internal buffer
-    static void CreateResource(HPreloader preloader, PreloadRequest* req, void* buffer, uint32_t buffer_size)
+    // If created is set, the create function has already been called by the loader thread
+    static void CreateResource(HPreloader preloader, PreloadRequest* req, void* buffer, uint32_t buffer_size, const dmLoadQueue::LoadResult* created)
     {
         assert(req->m_LoadResult == RESULT_PENDING);
         assert(req->m_PendingChildCount == 0);
@@ -524,6 +545,7 @@ namespace dmResource
         memset(&tmp_resource, 0, sizeof(tmp_resource));
 
         ResourceType* resource_type = req->m_PathDescriptor.m_ResourceType;
+        uint64_t create_start       = dmTime::GetTime();
 
         // We must call CreateFunction if Preload function has been called, so always do this even when an error has occured
         tmp_resource.m_NameHash       = req->m_PathDescriptor.m_CanonicalPathHash;
@@ -542,40 +564,60 @@ namespace dmResource
         {
             assert(req->m_Buffer);
             tmp_resource.m_ResourceSizeOnDisc = req->m_BufferSize;
+            tmp_resource.m_ContentHash        = GetContentHash(preloader->m_Factory, req->m_Buffer, req->m_BufferSize);
             params.m_Buffer                   = req->m_Buffer;
             params.m_BufferSize               = req->m_BufferSize;
             req->m_LoadResult                 = (Result)resource_type->m_CreateFunction(&params);
 
-            dmBlockAllocator::Free(preloader->m_BlockAllocator, req->m_Buffer, req->m_BufferSize);
+            if (!req->m_BufferIsMapped)
+            {
+                dmBlockAllocator::Free(preloader->m_BlockAllocator, req->m_Buffer, req->m_BufferSize);
+            }
 
-            req->m_Buffer = 0;
+            req->m_Buffer         = 0;
+            req->m_BufferIsMapped = 0;
+        }
+        else if (created)
+        {
+            memcpy(&tmp_resource, &created->m_Resource, sizeof(ResourceDescriptor));
+            tmp_resource.m_NameHash = req->m_PathDescriptor.m_CanonicalPathHash;
+            req->m_LoadResult       = created->m_CreateResult;
         }
         else
         {
             tmp_resource.m_ResourceSizeOnDisc = buffer_size;
+            tmp_resource.m_ContentHash        = GetContentHash(preloader->m_Factory, buffer, buffer_size);
             params.m_Buffer                   = buffer;
             params.m_BufferSize               = buffer_size;
             req->m_LoadResult                 = (Result)resource_type->m_CreateFunction(&params);
         }
 
-        if (req->m_LoadResult == RESULT_OK)
+        AddLoadPhaseTime(&req->m_Timing, LOAD_PHASE_CREATE, create_start);
+
+        if (req->m_LoadResult == RESULT_OK && resource_type->m_PostCreateFunction)
         {
-            if (resource_type->m_PostCreateFunction)
+            if (preloader->m_PostCreateCallbacks.Full())
             {
-                if (preloader->m_PostCreateCallbacks.Full())
-                {
-                    preloader->m_PostCreateCallbacks.OffsetCapacity(MAX_PRELOADER_REQUESTS / 8);
-                }
-                preloader->m_PostCreateCallbacks.SetSize(preloader->m_PostCreateCallbacks.Size() + 1);
-                ResourcePostCreateParamsInternal& ip = preloader->m_PostCreateCallbacks.Back();
-                ip.m_Destroy                         = false;
-                ip.m_Params.m_Factory                = preloader->m_Factory;
-                ip.m_Params.m_Type                   = resource_type;
-                ip.m_Params.m_Context                = resource_type->m_Context;
-                ip.m_Params.m_PreloadData            = req->m_PreloadData;
-                ip.m_Params.m_Resource               = 0;
-                memcpy(&ip.m_ResourceDesc, &tmp_resource, sizeof(ResourceDescriptor));
+                preloader->m_PostCreateCallbacks.OffsetCapacity(PRELOADER_REQUEST_BLOCK_SIZE / 2);
             }
+            preloader->m_PostCreateCallbacks.SetSize(preloader->m_PostCreateCallbacks.Size() + 1);
+            ResourcePostCreateParamsInternal& ip = preloader->m_PostCreateCallbacks.Back();
+            ip.m_Destroy                         = false;
+            ip.m_Params.m_Factory                = preloader->m_Factory;
+            ip.m_Params.m_Type                   = resource_type;
+            ip.m_Params.m_Context                = resource_type->m_Context;
+            ip.m_Params.m_PreloadData            = req->m_PreloadData;
+            ip.m_Params.m_Resource               = 0;
+            ip.m_Params.m_Filename               = req->m_PathDescriptor.m_InternalizedName;
+            memcpy(&ip.m_ResourceDesc, &tmp_resource, sizeof(ResourceDescriptor));
+            // The load is added to the timeline once the post create has finished
+            ip.m_Timing                          = req->m_Timing;
+            ip.m_Path                            = req->m_PathDescriptor.m_InternalizedCanonicalPath;
+        }
+        else
+        {
+            AddLoadTimelineEntry(GetLoadTimeline(preloader->m_Factory), req->m_PathDescriptor.m_InternalizedCanonicalPath,
+                                    req->m_PathDescriptor.m_CanonicalPathHash, req->m_LoadResult, true, &req->m_Timing);
         }
 
         assert(req->m_Buffer == 0);
@@ -604,7 +646,7 @@ namespace dmResource
         if (rd)
         {
             // Use already loaded resource
-            rd->m_ReferenceCount++;
+            IncRef(preloader->m_Factory, rd);
             req->m_Resource = rd->m_Resource;
             destroy         = true;
         }
@@ -680,12 +722,12 @@ namespace dmResource
         {
             return false;
         }
-        PreloadRequest* parent_req = &preloader->m_Request[parent];
+        PreloadRequest* parent_req = GetRequest(preloader, parent);
         if (parent_req->m_PendingChildCount > 0)
         {
             return false;
         }
-        CreateResource(preloader, parent_req, 0, 0);
+        CreateResource(preloader, parent_req, 0, 0, 0);
         UnmarkPathInProgress(preloader, &parent_req->m_PathDescriptor);
         PreloaderTryPruneParent(preloader, parent_req);
         return true;
@@ -711,9 +753,13 @@ namespace dmResource
             req->m_LoadResult = load_result.m_PreloadResult;
         }
 
+        req->m_Timing = load_result.m_Timing;
+
         // On error remove all children
         if (req->m_LoadResult != RESULT_PENDING)
         {
+            AddLoadTimelineEntry(GetLoadTimeline(preloader->m_Factory), req->m_PathDescriptor.m_InternalizedCanonicalPath,
+                                    req->m_PathDescriptor.m_CanonicalPathHash, req->m_LoadResult, true, &req->m_Timing);
             RemoveChildren(preloader, req);
             RemoveFromParentPendingCount(preloader, req);
         }
@@ -727,8 +773,8 @@ namespace dmResource
         {
             if (req->m_LoadResult == RESULT_PENDING)
             {
-                // Create the resource using the loading buffer directly.
-                CreateResource(preloader, req, buffer, buffer_size);
+                // Create the resource using the loading buffer directly, unless the loader thread already did
+                CreateResource(preloader, req, buffer, buffer_size, load_result.m_Created ? &load_result : 0);
                 created_resource = true;
             }
             UnmarkPathInProgress(preloader, &req->m_PathDescriptor);
@@ -739,9 +785,19 @@ namespace dmResource
         }
         else
         {
-            // Keep the loaded bytes until we have loaded all children
-            req->m_Buffer = dmBlockAllocator::Allocate(preloader->m_BlockAllocator, buffer_size);
-            memcpy(req->m_Buffer, buffer, buffer_size);
+            assert(!load_result.m_Created);
+            // Keep the loaded bytes until we have loaded all children.
+            // Mapped data stays valid for as long as the archive is mounted, so there is no need to copy it
+            if (load_result.m_ZeroCopy)
+            {
+                req->m_Buffer         = buffer;
+                req->m_BufferIsMapped = 1;
+            }
+            else
+            {
+                req->m_Buffer = dmBlockAllocator::Allocate(preloader->m_BlockAllocator, buffer_size);
+                memcpy(req->m_Buffer, buffer, buffer_size);
+            }
             req->m_BufferSize = buffer_size;
             dmLoadQueue::FreeLoad(preloader->m_LoadQueue, req->m_LoadRequest);
             req->m_LoadRequest = 0;
@@ -753,12 +809,24 @@ namespace dmResource
 
     // Find the first request that has is RESULT_PENDING and try to load it
     // Continue until all requests are checked or we have created a one resource
+    // Resources closer to the root are loaded first, since they are more likely to hint further
+    // resources, which keeps the loader threads busy
+    static uint8_t GetLoadPriority(HPreloader preloader, PreloadRequest* req)
+    {
+        uint32_t depth = 0;
+        for (TRequestIndex parent = req->m_Parent; parent != -1; parent = GetRequest(preloader, parent)->m_Parent)
+        {
+            ++depth;
+        }
+        return (uint8_t) (255 - dmMath::Min(depth, 255u));
+    }
+
     static bool PreloaderUpdateOneItem(HPreloader preloader, TRequestIndex index)
     {
         DM_PROFILE("PreloaderUpdateOneItem");
         while (index >= 0)
         {
-            PreloadRequest* req = &preloader->m_Request[index];
+            PreloadRequest* req = GetRequest(preloader, index);
             switch (req->m_LoadResult)
             {
                 case RESULT_PENDING:
@@ -836,7 +904,7 @@ namespace dmResource
         ResourceDescriptor* rd = FindByHash(preloader->m_Factory, req->m_PathDescriptor.m_CanonicalPathHash);
         if (rd)
         {
-            rd->m_ReferenceCount++;
+            IncRef(preloader->m_Factory, rd);
             req->m_Resource   = rd->m_Resource;
             req->m_LoadResult = RESULT_OK;
             RemoveChildren(preloader, req);
@@ -864,6 +932,17 @@ namespace dmResource
         info.m_HintInfo.m_Parent    = index;
         info.m_CompleteFunction     = req->m_PathDescriptor.m_ResourceType->m_PreloadFunction;
         info.m_Context              = req->m_PathDescriptor.m_ResourceType->m_Context;
+        info.m_Priority             = GetLoadPriority(preloader, req);
+        info.m_ZeroCopy             = req->m_PathDescriptor.m_ResourceType->m_ZeroCopy;
+        if (req->m_PathDescriptor.m_ResourceType->m_StreamHeaderSize)
+        {
+            info.m_StreamType = req->m_PathDescriptor.m_ResourceType;
+        }
+        // Only leaf resources can be created on the loader thread, as the children must be created first
+        if (req->m_PathDescriptor.m_ResourceType->m_ThreadSafeCreate && req->m_FirstChild == -1)
+        {
+            info.m_CreateType = req->m_PathDescriptor.m_ResourceType;
+        }
 
         // If we can't add the request to the load queue it is because the queue is full
         // We will try again once we completed loading of an item via dmLoadQueue::EndLoad
@@ -886,7 +965,9 @@ namespace dmResource
         ResourcePostCreateParams& params     = ip.m_Params;
         params.m_Resource                    = &ip.m_ResourceDesc;
         ResourceType* resource_type          = params.m_Resource->m_ResourceType;
+        uint64_t post_create_start           = dmTime::GetTime();
         Result ret                           = (Result)resource_type->m_PostCreateFunction(&params);
+        AddLoadPhaseTime(&ip.m_Timing, LOAD_PHASE_POST_CREATE, post_create_start);
 
         if (ret == RESULT_PENDING)
         {
@@ -894,6 +975,8 @@ namespace dmResource
         }
         ++preloader->m_PostCreateCallbackIndex;
 
+        AddLoadTimelineEntry(GetLoadTimeline(preloader->m_Factory), ip.m_Path, params.m_Resource->m_NameHash, ret, true, &ip.m_Timing);
+
         // Resource has been marked for delayed destroy after PostCreate function has been run.
         if (ip.m_Destroy)
         {
@@ -911,6 +994,7 @@ namespace dmResource
             {
                 if (params.m_Resource->m_ResourceSize != 0)
                     rd->m_ResourceSize = params.m_Resource->m_ResourceSize;
+                UpdateResourceMemory(rd);
             }
         }
 
@@ -933,7 +1017,7 @@ namespace dmResource
 
         do
         {
-            Result root_result        = preloader->m_Request[0].m_LoadResult;
+            Result root_result        = GetRequest(preloader, 0)->m_LoadResult;
             Result post_create_result = RESULT_OK;
             if (preloader->m_PostCreateCallbackIndex < preloader->m_PostCreateCallbacks.Size())
             {
@@ -946,7 +1030,7 @@ namespace dmResource
                         // Just waiting for the post-create functions to complete
                         // If main result is RESULT_OK pick up any errors from
                         // post create function
-                        preloader->m_Request[0].m_LoadResult = post_create_result;
+                        GetRequest(preloader, 0)->m_LoadResult = post_create_result;
                     }
                     continue;
                 }
@@ -972,7 +1056,7 @@ namespace dmResource
                     {
                         if (!complete_callback(complete_callback_params))
                         {
-                            preloader->m_Request[0].m_LoadResult = RESULT_NOT_LOADED;
+                            GetRequest(preloader, 0)->m_LoadResult = RESULT_NOT_LOADED;
                         }
                         empty_runs = 0;
                         // We need to continue to do all post create functions
@@ -1036,7 +1120,7 @@ namespace dmResource
         }
 
         // Release root and persisted resources
-        preloader->m_PersistedResources.Push(preloader->m_Request[0].m_Resource);
+        preloader->m_PersistedResources.Push(GetRequest(preloader, 0)->m_Resource);
         for (uint32_t i = 0; i < preloader->m_PersistedResources.Size(); ++i)
         {
             void* resource = preloader->m_PersistedResources[i];
@@ -1045,9 +1129,18 @@ namespace dmResource
             Release(preloader->m_Factory, resource);
         }
 
-        assert(preloader->m_FreelistSize == (MAX_PRELOADER_REQUESTS - 1));
+        assert(preloader->m_Freelist.Size() == GetRequestCapacity(preloader) - 1);
         dmLoadQueue::DeleteQueue(preloader->m_LoadQueue);
 
+        for (uint32_t i = 0; i < preloader->m_RequestBlocks.Size(); ++i)
+        {
+            free(preloader->m_RequestBlocks[i]);
+        }
+        for (uint32_t i = 0; i < preloader->m_SyncedData.m_PathDataBlocks.Size(); ++i)
+        {
+            free(preloader->m_SyncedData.m_PathDataBlocks[i]);
+        }
+
         dmBlockAllocator::DeleteContext(preloader->m_BlockAllocator);
 
         dmSpinlock::Destroy(&preloader->m_SyncedDataSpinlock);
@@ -1078,6 +1171,7 @@ namespace dmResource
         PendingHint& hint     = preloader->m_SyncedData.m_NewHints.Back();
         hint.m_PathDescriptor = path_descriptor;
         hint.m_Parent         = info->m_Parent;
+        info->m_HintCount++;
 
         return true;
     }
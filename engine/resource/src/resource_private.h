@@ -58,7 +58,11 @@ struct ResourceDescriptor
     HResourceType   m_ResourceType;
     uint32_t        m_ResourceSizeOnDisc;
     uint32_t        m_ReferenceCount;
+    uint32_t        m_AccountedSize;    // The size currently reported to dmMemory::CATEGORY_RESOURCE
+    uint32_t        m_ContentHash;      // Hash of the loaded file, if reloading is supported. 0 if unknown
     uint16_t        m_Version;
+    uint8_t         m_Resident:1;       // Unreferenced, but kept alive within the residency budget
+    uint8_t         m_Dynamic:1;        // Created from memory with CreateResource(), so it is never kept resident
 };
 
 struct ResourceType
@@ -76,6 +80,12 @@ struct ResourceType
     FResourceDestroy    m_DestroyFunction;
     FResourceRecreate   m_RecreateFunction;
     uint8_t             m_Index;
+    uint8_t             m_ZeroCopy:1; // The type functions only read the buffer, so it may point into a mapped archive
+    uint8_t             m_ThreadSafeCreate:1; // The create function may run on a loader thread
+    uint8_t             m_KeepResident:1; // Unreferenced resources are kept alive within the residency budget
+    uint32_t            m_StreamMinSize; // Resources of at least this size only have their header loaded
+    uint32_t            m_StreamHeaderSize; // 0 if the type doesn't stream its data
+    uint32_t            m_ResidentSize; // The size of the unreferenced resources currently kept alive
 };
 
 struct ResourceTypeContext
@@ -88,6 +98,7 @@ struct ResourcePreloadHintInfo
 {
     HResourcePreloader      m_Preloader;
     int32_t                 m_Parent;
+    uint32_t                m_HintCount; // Number of hints made by the preload function
 };
 
 namespace dmResource
@@ -99,9 +110,15 @@ namespace dmResource
     Result LoadResource(HFactory factory, const char* path, const char* original_name, void** buffer, uint32_t* resource_size);
 
     Result InsertResource(HFactory factory, const char* path, uint64_t canonical_path_hash, HResourceDescriptor descriptor);
+    // Hash of the file content, used to skip reloading resources that haven't changed. Returns 0 if the factory doesn't support reloading
+    uint32_t GetContentHash(HFactory factory, const void* buffer, uint32_t buffer_size);
+    // Reports any change of the resource size to the memory accounting
+    void UpdateResourceMemory(HResourceDescriptor descriptor);
     uint32_t GetCanonicalPathFromBase(const char* base_dir, const char* relative_dir, char* buf);
 
     HResourceType FindResourceType(HFactory factory, const char* extension);
+    // Returns 0 if the load timeline is disabled
+    struct LoadTimeline* GetLoadTimeline(HFactory factory);
     uint32_t GetRefCount(HFactory factory, void* resource);
     uint32_t GetRefCount(HFactory factory, dmhash_t identifier);
 
@@ -114,6 +131,8 @@ namespace dmResource
     // Files mapped with this function should be unmapped with UnmapFile(...)
     Result MapFile(const char* filename, void*& map, uint32_t& size);
     Result UnmapFile(void*& map, uint32_t size);
+    // Hints that the mapped data will be read soon, so the OS can start paging it in
+    void PrefetchMappedData(const void* data, uint32_t size);
 
     /**
      * In the case of an app-store upgrade, we dont want the runtime to load any existing local liveupdate.manifest.
@@ -0,0 +1,270 @@
+// Copyright 2020-2024 The Defold Foundation
+// Copyright 2014-2020 King
+// Copyright 2009-2014 Ragnar Svensson, Christian Murray
+// Licensed under the Defold License version 1.0 (the "License"); you may not use
+// this file except in compliance with the License.
+//
+// You may obtain a copy of the License, together with FAQs at
+// https://www.defold.com/license
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "resource_snapshot.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <dlib/array.h>
+#include <dlib/dstrings.h>
+#include <dlib/hashtable.h>
+#include <dlib/log.h>
+#include <dlib/math.h>
+#include <dlib/path.h>
+#include <dlib/profile.h>
+#include <dlib/sys.h>
+
+namespace dmResource
+{
+    static const uint32_t STARTUP_SNAPSHOT_MAGIC    = 0x50414e53; // "SNAP"
+    static const uint32_t STARTUP_SNAPSHOT_VERSION  = 1;
+
+    struct StartupSnapshotHeader
+    {
+        uint32_t m_Magic;
+        uint32_t m_Version;
+        uint64_t m_Key;
+        uint32_t m_EntryCount;
+        uint32_t m_DataSize;
+    };
+
+    struct StartupSnapshotEntry
+    {
+        dmhash_t m_PathHash;
+        uint32_t m_Offset;  // Into the data, which follows the entries
+        uint32_t m_Size;
+    };
+
+    struct StartupSnapshot
+    {
+        char                            m_Path[DMPATH_MAX_PATH];
+        uint64_t                        m_Key;
+        uint32_t                        m_MaxSize;
+
+        // Loaded: the whole file. Recording: 0
+        uint8_t*                        m_File;
+        const uint8_t*                  m_Data;
+        // The loaded, or recorded, entries
+        dmHashTable64<StartupSnapshotEntry> m_Entries;
+
+        // Recording, in the order they were read
+        dmArray<StartupSnapshotEntry>   m_RecordedEntries;
+        dmArray<uint8_t>                m_RecordedData;
+
+        uint8_t                         m_Recording:1;
+    };
+
+    static bool LoadStartupSnapshot(StartupSnapshot* snapshot)
+    {
+        DM_PROFILE(__FUNCTION__);
+
+        FILE* f = fopen(snapshot->m_Path, "rb");
+        if (!f)
+        {
+            return false;
+        }
+
+        fseek(f, 0, SEEK_END);
+        long file_size = ftell(f);
+        fseek(f, 0, SEEK_SET);
+
+        bool result = file_size >= (long)sizeof(StartupSnapshotHeader);
+        if (result)
+        {
+            snapshot->m_File = (uint8_t*) malloc(file_size);
+            result = fread(snapshot->m_File, file_size, 1, f) == 1;
+        }
+        fclose(f);
+
+        if (!result)
+        {
+            return false;
+        }
+
+        StartupSnapshotHeader* header = (StartupSnapshotHeader*) snapshot->m_File;
+        if (header->m_Magic != STARTUP_SNAPSHOT_MAGIC || header->m_Version != STARTUP_SNAPSHOT_VERSION || header->m_Key != snapshot->m_Key)
+        {
+            return false;
+        }
+
+        uint64_t entries_size = (uint64_t) header->m_EntryCount * sizeof(StartupSnapshotEntry);
+        if (sizeof(StartupSnapshotHeader) + entries_size + header->m_DataSize != (uint64_t) file_size)
+        {
+            dmLogWarning("Ignoring the broken startup snapshot '%s'", snapshot->m_Path);
+            return false;
+        }
+
+        const StartupSnapshotEntry* entries = (const StartupSnapshotEntry*) (snapshot->m_File + sizeof(StartupSnapshotHeader));
+        snapshot->m_Data = (const uint8_t*) (entries + header->m_EntryCount);
+
+        uint32_t count = header->m_EntryCount;
+        snapshot->m_Entries.SetCapacity(dmMath::Max(1u, (3 * count) / 4), dmMath::Max(1u, count));
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            if ((uint64_t) entries[i].m_Offset + entries[i].m_Size > header->m_DataSize)
+            {
+                dmLogWarning("Ignoring the broken startup snapshot '%s'", snapshot->m_Path);
+                snapshot->m_Entries.Clear();
+                return false;
+            }
+            snapshot->m_Entries.Put(entries[i].m_PathHash, entries[i]);
+        }
+        return true;
+    }
+
+    HStartupSnapshot NewStartupSnapshot(const char* path, uint64_t key, uint32_t max_size)
+    {
+        StartupSnapshot* snapshot = new StartupSnapshot;
+        dmStrlCpy(snapshot->m_Path, path, sizeof(snapshot->m_Path));
+        snapshot->m_Key = key;
+        snapshot->m_MaxSize = max_size;
+        snapshot->m_File = 0;
+        snapshot->m_Data = 0;
+        snapshot->m_Recording = 0;
+
+        if (!LoadStartupSnapshot(snapshot))
+        {
+            free(snapshot->m_File);
+            snapshot->m_File = 0;
+            snapshot->m_Data = 0;
+            snapshot->m_Recording = 1;
+        }
+        return snapshot;
+    }
+
+    void DeleteStartupSnapshot(HStartupSnapshot snapshot)
+    {
+        free(snapshot->m_File);
+        delete snapshot;
+    }
+
+    bool IsStartupSnapshotRecording(HStartupSnapshot snapshot)
+    {
+        return snapshot->m_Recording;
+    }
+
+    bool ReadStartupSnapshot(HStartupSnapshot snapshot, dmhash_t path_hash, LoadBufferType* buffer, uint32_t* resource_size)
+    {
+        if (snapshot->m_Recording)
+        {
+            return false;
+        }
+
+        StartupSnapshotEntry* entry = snapshot->m_Entries.Get(path_hash);
+        if (!entry)
+        {
+            return false;
+        }
+
+        if (buffer->Capacity() < entry->m_Size)
+        {
+            buffer->SetCapacity(entry->m_Size);
+        }
+        buffer->SetSize(entry->m_Size);
+        memcpy(buffer->Begin(), snapshot->m_Data + entry->m_Offset, entry->m_Size);
+        *resource_size = entry->m_Size;
+        return true;
+    }
+
+    void AddStartupSnapshotEntry(HStartupSnapshot snapshot, dmhash_t path_hash, const void* data, uint32_t size)
+    {
+        if (!snapshot->m_Recording)
+        {
+            return;
+        }
+
+        dmArray<uint8_t>& recorded_data = snapshot->m_RecordedData;
+        if (recorded_data.Size() + size > snapshot->m_MaxSize)
+        {
+            return;
+        }
+
+        // The same resource may be read several times (e.g. when it was released and loaded again)
+        dmHashTable64<StartupSnapshotEntry>& lookup = snapshot->m_Entries;
+        if (lookup.Get(path_hash))
+        {
+            return;
+        }
+        if (lookup.Full())
+        {
+            uint32_t capacity = dmMath::Max(64u, 2 * lookup.Capacity());
+            lookup.SetCapacity((3 * capacity) / 4, capacity);
+        }
+
+        StartupSnapshotEntry entry;
+        entry.m_PathHash = path_hash;
+        entry.m_Offset = recorded_data.Size();
+        entry.m_Size = size;
+        lookup.Put(path_hash, entry);
+
+        dmArray<StartupSnapshotEntry>& entries = snapshot->m_RecordedEntries;
+        if (entries.Full())
+        {
+            entries.OffsetCapacity(dmMath::Max(16u, entries.Capacity()));
+        }
+        entries.Push(entry);
+
+        if (recorded_data.Remaining() < size)
+        {
+            recorded_data.OffsetCapacity(dmMath::Max(size, recorded_data.Capacity()));
+        }
+        recorded_data.PushArray((const uint8_t*) data, size);
+    }
+
+    Result WriteStartupSnapshot(HStartupSnapshot snapshot)
+    {
+        DM_PROFILE(__FUNCTION__);
+
+        if (!snapshot->m_Recording)
+        {
+            return RESULT_OK;
+        }
+
+        char tmp_path[DMPATH_MAX_PATH];
+        dmSnPrintf(tmp_path, sizeof(tmp_path), "%s.tmp", snapshot->m_Path);
+
+        FILE* f = fopen(tmp_path, "wb");
+        if (!f)
+        {
+            dmLogWarning("Failed to write the startup snapshot '%s'", tmp_path);
+            return RESULT_IO_ERROR;
+        }
+
+        const dmArray<StartupSnapshotEntry>& entries = snapshot->m_RecordedEntries;
+        const dmArray<uint8_t>& data = snapshot->m_RecordedData;
+
+        StartupSnapshotHeader header;
+        memset(&header, 0, sizeof(header));
+        header.m_Magic = STARTUP_SNAPSHOT_MAGIC;
+        header.m_Version = STARTUP_SNAPSHOT_VERSION;
+        header.m_Key = snapshot->m_Key;
+        header.m_EntryCount = entries.Size();
+        header.m_DataSize = data.Size();
+
+        bool result = fwrite(&header, sizeof(header), 1, f) == 1 &&
+                      (entries.Empty() || fwrite(entries.Begin(), sizeof(StartupSnapshotEntry) * entries.Size(), 1, f) == 1) &&
+                      (data.Empty() || fwrite(data.Begin(), data.Size(), 1, f) == 1);
+        result = fclose(f) == 0 && result;
+
+        if (!result || dmSys::Rename(snapshot->m_Path, tmp_path) != dmSys::RESULT_OK)
+        {
+            dmLogWarning("Failed to write the startup snapshot '%s'", snapshot->m_Path);
+            dmSys::Unlink(tmp_path);
+            return RESULT_IO_ERROR;
+        }
+        return RESULT_OK;
+    }
+}
@@ -0,0 +1,46 @@
+// Copyright 2020-2024 The Defold Foundation
+// Copyright 2014-2020 King
+// Copyright 2009-2014 Ragnar Svensson, Christian Murray
+// Licensed under the Defold License version 1.0 (the "License"); you may not use
+// this file except in compliance with the License.
+//
+// You may obtain a copy of the License, together with FAQs at
+// https://www.defold.com/license
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#ifndef DM_RESOURCE_SNAPSHOT_H
+#define DM_RESOURCE_SNAPSHOT_H
+
+#include <stdint.h>
+#include <dlib/hash.h>
+#include "resource.h"
+
+namespace dmResource
+{
+    /**
+     * The (decrypted and decompressed) data of the resources read during startup, stored in a single file.
+     * If the file exists and was written with the same key, it's loaded with one read, and the reads of
+     * the resources in it are served from memory. Otherwise, the reads are recorded until it's written.
+     */
+    typedef struct StartupSnapshot* HStartupSnapshot;
+
+    HStartupSnapshot NewStartupSnapshot(const char* path, uint64_t key, uint32_t max_size);
+    void             DeleteStartupSnapshot(HStartupSnapshot snapshot);
+
+    bool             IsStartupSnapshotRecording(HStartupSnapshot snapshot);
+
+    // Returns false if the resource isn't in the (loaded) snapshot
+    bool             ReadStartupSnapshot(HStartupSnapshot snapshot, dmhash_t path_hash, LoadBufferType* buffer, uint32_t* resource_size);
+
+    // Records a read. Does nothing if the snapshot was loaded, or the data doesn't fit
+    void             AddStartupSnapshotEntry(HStartupSnapshot snapshot, dmhash_t path_hash, const void* data, uint32_t size);
+
+    // Writes the recorded reads to the file
+    Result           WriteStartupSnapshot(HStartupSnapshot snapshot);
+}
+
+#endif // DM_RESOURCE_SNAPSHOT_H
@@ -0,0 +1,207 @@
+// Copyright 2020-2024 The Defold Foundation
+// Copyright 2014-2020 King
+// Copyright 2009-2014 Ragnar Svensson, Christian Murray
+// Licensed under the Defold License version 1.0 (the "License"); you may not use
+// this file except in compliance with the License.
+//
+// You may obtain a copy of the License, together with FAQs at
+// https://www.defold.com/license
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "resource_timeline.h"
+
+#include <string.h>
+
+#include <dlib/array.h>
+#include <dlib/dstrings.h>
+#include <dlib/hash.h>
+#include <dlib/mutex.h>
+#include <dlib/profile.h>
+#include <dlib/thread.h>
+
+DM_PROPERTY_U32(rmtp_ResourceLoads, 0, FrameReset, "# resource loads / frame");
+DM_PROPERTY_U32(rmtp_ResourceBytesRead, 0, FrameReset, "# bytes read by resource loads / frame");
+
+namespace dmResource
+{
+    struct LoadTimeline
+    {
+        dmMutex::HMutex     m_Mutex;
+        LoadTimelineEntry*  m_Entries;
+        uint32_t            m_Capacity;
+        uint32_t            m_Next;
+        uint32_t            m_Count;
+    };
+
+    // The timed read of the current thread
+    struct ReadTiming
+    {
+        LoadTiming* m_Timing;
+        uint64_t    m_Start;
+        uint32_t    m_DecryptTime;
+        uint32_t    m_DecompressTime;
+    };
+
+    // Allocated together with the first timeline, before any loader threads are started
+    static dmThread::TlsKey g_ReadTimingKey;
+    static bool             g_ReadTimingKeyValid = false;
+
+    HLoadTimeline NewLoadTimeline(uint32_t capacity)
+    {
+        if (!g_ReadTimingKeyValid)
+        {
+            g_ReadTimingKey = dmThread::AllocTls();
+            g_ReadTimingKeyValid = true;
+        }
+
+        LoadTimeline* timeline = new LoadTimeline;
+        timeline->m_Mutex = dmMutex::New();
+        timeline->m_Entries = new LoadTimelineEntry[capacity];
+        timeline->m_Capacity = capacity;
+        timeline->m_Next = 0;
+        timeline->m_Count = 0;
+        return timeline;
+    }
+
+    void DeleteLoadTimeline(HLoadTimeline timeline)
+    {
+        dmMutex::Delete(timeline->m_Mutex);
+        delete[] timeline->m_Entries;
+        delete timeline;
+    }
+
+    void AddLoadTimelineEntry(HLoadTimeline timeline, const char* path, dmhash_t path_hash, Result result, bool async, const LoadTiming* timing)
+    {
+        DM_PROPERTY_ADD_U32(rmtp_ResourceLoads, 1);
+        DM_PROPERTY_ADD_U32(rmtp_ResourceBytesRead, timing->m_Size);
+
+        if (!timeline)
+            return;
+
+        DM_MUTEX_SCOPED_LOCK(timeline->m_Mutex);
+        LoadTimelineEntry& entry = timeline->m_Entries[timeline->m_Next];
+        entry.m_Timing = *timing;
+        entry.m_PathHash = path_hash;
+        dmStrlCpy(entry.m_Path, path, sizeof(entry.m_Path));
+        entry.m_Result = result;
+        entry.m_Async = async ? 1 : 0;
+
+        timeline->m_Next = (timeline->m_Next + 1) % timeline->m_Capacity;
+        if (timeline->m_Count < timeline->m_Capacity)
+            timeline->m_Count++;
+    }
+
+    void IterateLoadTimeline(HLoadTimeline timeline, FLoadTimelineCallback callback, void* ctx)
+    {
+        if (!timeline)
+            return;
+
+        DM_MUTEX_SCOPED_LOCK(timeline->m_Mutex);
+        uint32_t first = (timeline->m_Next + timeline->m_Capacity - timeline->m_Count) % timeline->m_Capacity;
+        for (uint32_t i = 0; i < timeline->m_Count; ++i)
+        {
+            callback(ctx, &timeline->m_Entries[(first + i) % timeline->m_Capacity]);
+        }
+    }
+
+    void InitLoadTiming(LoadTiming* timing)
+    {
+        memset(timing, 0, sizeof(*timing));
+        timing->m_Start = dmTime::GetTime();
+    }
+
+    uint64_t AddLoadPhaseTime(LoadTiming* timing, LoadPhase phase, uint64_t start)
+    {
+        uint64_t now = dmTime::GetTime();
+        timing->m_Times[phase] += (uint32_t)(now - start);
+        return now;
+    }
+
+    static ReadTiming* GetReadTiming()
+    {
+        if (!g_ReadTimingKeyValid)
+            return 0;
+        return (ReadTiming*)dmThread::GetTlsValue(g_ReadTimingKey);
+    }
+
+    void BeginReadTiming(LoadTiming* timing)
+    {
+        ReadTiming* read = GetReadTiming();
+        if (!read)
+        {
+            if (!g_ReadTimingKeyValid)
+                return;
+            // Kept for the lifetime of the thread
+            read = new ReadTiming;
+            dmThread::SetTlsValue(g_ReadTimingKey, read);
+        }
+        read->m_Timing = timing;
+        read->m_Start = dmTime::GetTime();
+        read->m_DecryptTime = 0;
+        read->m_DecompressTime = 0;
+    }
+
+    void EndReadTiming(LoadTiming* timing, uint32_t size)
+    {
+        ReadTiming* read = GetReadTiming();
+        if (!read || read->m_Timing != timing)
+            return;
+
+        uint32_t total = (uint32_t)(dmTime::GetTime() - read->m_Start);
+        uint32_t processing = read->m_DecryptTime + read->m_DecompressTime;
+        timing->m_Times[LOAD_PHASE_READ] += total > processing ? total - processing : 0;
+        timing->m_Times[LOAD_PHASE_DECRYPT] += read->m_DecryptTime;
+        timing->m_Times[LOAD_PHASE_DECOMPRESS] += read->m_DecompressTime;
+        timing->m_Size += size;
+        read->m_Timing = 0;
+    }
+
+    void AddReadPhaseTime(LoadPhase phase, uint32_t time)
+    {
+        ReadTiming* read = GetReadTiming();
+        if (!read || !read->m_Timing)
+            return;
+
+        if (phase == LOAD_PHASE_DECRYPT)
+            read->m_DecryptTime += time;
+        else if (phase == LOAD_PHASE_DECOMPRESS)
+            read->m_DecompressTime += time;
+    }
+
+    void SetReadProvider(dmhash_t provider)
+    {
+        ReadTiming* read = GetReadTiming();
+        if (read && read->m_Timing)
+            read->m_Timing->m_Provider = provider;
+    }
+
+    const char* GetLoadPhaseName(LoadPhase phase)
+    {
+        switch(phase)
+        {
+        case LOAD_PHASE_QUEUE:          return "queue";
+        case LOAD_PHASE_READ:           return "read";
+        case LOAD_PHASE_DECRYPT:        return "decrypt";
+        case LOAD_PHASE_DECOMPRESS:     return "decompress";
+        case LOAD_PHASE_PRELOAD:        return "preload";
+        case LOAD_PHASE_CREATE:         return "create";
+        case LOAD_PHASE_POST_CREATE:    return "post_create";
+        default:                        return "<unknown>";
+        }
+    }
+
+    const char* GetLoadProviderName(dmhash_t provider)
+    {
+        static const char* names[] = {"archive", "mutable", "file", "zip", "http"};
+        for (uint32_t i = 0; i < DM_ARRAY_SIZE(names); ++i)
+        {
+            if (dmHashString64(names[i]) == provider)
+                return names[i];
+        }
+        return 0;
+    }
+}
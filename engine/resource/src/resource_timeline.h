@@ -0,0 +1,60 @@
+// Copyright 2020-2024 The Defold Foundation
+// Copyright 2014-2020 King
+// Copyright 2009-2014 Ragnar Svensson, Christian Murray
+// Licensed under the Defold License version 1.0 (the "License"); you may not use
+// this file except in compliance with the License.
+//
+// You may obtain a copy of the License, together with FAQs at
+// https://www.defold.com/license
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#ifndef DM_RESOURCE_TIMELINE_H
+#define DM_RESOURCE_TIMELINE_H
+
+#include <stdint.h>
+#include <dlib/time.h>
+#include "resource.h"
+
+namespace dmResource
+{
+    // A ring buffer with the timings of the most recent resource loads
+    typedef struct LoadTimeline* HLoadTimeline;
+
+    HLoadTimeline NewLoadTimeline(uint32_t capacity);
+    void          DeleteLoadTimeline(HLoadTimeline timeline);
+    void          AddLoadTimelineEntry(HLoadTimeline timeline, const char* path, dmhash_t path_hash, Result result, bool async, const LoadTiming* timing);
+    void          IterateLoadTimeline(HLoadTimeline timeline, FLoadTimelineCallback callback, void* ctx);
+
+    // Clears the timing, and sets the start time to now
+    void          InitLoadTiming(LoadTiming* timing);
+
+    // Adds the time since start to the phase, and returns the current time
+    uint64_t      AddLoadPhaseTime(LoadTiming* timing, LoadPhase phase, uint64_t start);
+
+    /**
+     * Times a read on the current thread. The decryption, decompression and provider reported
+     * by the archives during the read are added to the timing.
+     */
+    void          BeginReadTiming(LoadTiming* timing);
+    void          EndReadTiming(LoadTiming* timing, uint32_t size);
+
+    // Called from the archives while reading. Does nothing if the read isn't timed.
+    void          AddReadPhaseTime(LoadPhase phase, uint32_t time);
+    void          SetReadProvider(dmhash_t provider);
+
+    // Adds the time of the scope to a phase of the current read
+    struct ReadPhaseScope
+    {
+        LoadPhase m_Phase;
+        uint64_t  m_Start;
+
+        ReadPhaseScope(LoadPhase phase) : m_Phase(phase), m_Start(dmTime::GetTime()) {}
+        ~ReadPhaseScope() { AddReadPhaseTime(m_Phase, (uint32_t)(dmTime::GetTime() - m_Start)); }
+    };
+}
+
+#endif // DM_RESOURCE_TIMELINE_H
@@ -81,6 +81,27 @@ void ResourceTypeSetRecreateFn(HResourceType type, FResourceRecreate fn)
     type->m_RecreateFunction = fn;
 }
 
+void ResourceTypeSetZeroCopy(HResourceType type, bool zero_copy)
+{
+    type->m_ZeroCopy = zero_copy ? 1 : 0;
+}
+
+void ResourceTypeSetThreadSafeCreate(HResourceType type, bool thread_safe)
+{
+    type->m_ThreadSafeCreate = thread_safe ? 1 : 0;
+}
+
+void ResourceTypeSetKeepResident(HResourceType type, bool keep_resident)
+{
+    type->m_KeepResident = keep_resident ? 1 : 0;
+}
+
+void ResourceTypeSetStreamed(HResourceType type, uint32_t min_size, uint32_t header_size)
+{
+    type->m_StreamMinSize = min_size;
+    type->m_StreamHeaderSize = header_size;
+}
+
 
 TypeCreatorDesc* g_ResourceTypeCreatorDescFirst = 0;
 
@@ -162,6 +183,9 @@ Result RegisterTypes(HFactory factory, dmHashTable64<void*>* contexts)
 
 Result DeregisterTypes(HFactory factory, dmHashTable64<void*>* contexts)
 {
+    // The kept resources must be destroyed while their type contexts are still alive
+    dmResource::SetResidencyBudget(factory, 0);
+
     const TypeCreatorDesc* desc = GetFirstTypeCreatorDesc();
     while (desc)
     {
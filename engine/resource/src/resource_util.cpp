@@ -14,10 +14,12 @@
 
 #include "resource_util.h"
 #include "resource_manifest_private.h"
+#include "resource_timeline.h"
 
 #include <dlib/crypt.h>
 #include <dlib/dstrings.h>
 #include <dlib/log.h>
+#include <dlib/profile.h>
 
 namespace dmResource
 {
@@ -46,6 +48,8 @@ static dmResource::Result DecryptWithXtea(void* buffer, uint32_t buffer_len)
 
 dmResource::Result DecryptBuffer(void* buffer, uint32_t buffer_len)
 {
+    DM_PROFILE("Decrypt");
+    ReadPhaseScope timing_scope(LOAD_PHASE_DECRYPT);
     return g_ResourceDecryption(buffer, buffer_len);
 }
 
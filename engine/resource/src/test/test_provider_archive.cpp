@@ -158,6 +158,28 @@ TEST_F(ArchiveProviderArchive, GetSize)
     ASSERT_EQ(dmResourceProvider::RESULT_NOT_FOUND, result);
 }
 
+TEST_F(ArchiveProviderArchive, GetFileOffset)
+{
+    dmResourceProvider::Result result;
+    uint32_t offset1 = 0xFFFFFFFF;
+    uint32_t offset4 = 0xFFFFFFFF;
+    uint32_t offset;
+    const char* path;
+
+    path = "/archive_data/file1.adc";
+    result = dmResourceProvider::GetFileOffset(m_Archive, dmHashString64(path), path, &offset1);
+    ASSERT_EQ(dmResourceProvider::RESULT_OK, result);
+
+    path = "/archive_data/file4.adc";
+    result = dmResourceProvider::GetFileOffset(m_Archive, dmHashString64(path), path, &offset4);
+    ASSERT_EQ(dmResourceProvider::RESULT_OK, result);
+    ASSERT_NE(offset1, offset4);
+
+    path = "src/test/files/not_exist";
+    result = dmResourceProvider::GetFileOffset(m_Archive, dmHashString64(path), path, &offset);
+    ASSERT_EQ(dmResourceProvider::RESULT_NOT_FOUND, result);
+}
+
 // * Test that the files exist
 // * Test that the content is the same as on disc
 TEST_F(ArchiveProviderArchive, ReadFile)
@@ -129,6 +129,27 @@ TEST_F(FileProviderArchive, ReadFile)
     ASSERT_ARRAY_EQ_LEN(SOMEDATA, long_buffer, sizeof(SOMEDATA));
 }
 
+TEST_F(FileProviderArchive, ReadFilePartial)
+{
+    dmResourceProvider::Result result;
+    uint8_t buffer[4];
+    uint32_t nread = 0;
+
+    result = dmResourceProvider::ReadFilePartial(m_Archive, 0, "/src/test/files/somedata", 2, buffer, sizeof(buffer), &nread);
+    ASSERT_EQ(dmResourceProvider::RESULT_OK, result);
+    ASSERT_EQ(4U, nread);
+    ASSERT_ARRAY_EQ_LEN(SOMEDATA + 2, buffer, nread);
+
+    // Reads past the end are truncated
+    result = dmResourceProvider::ReadFilePartial(m_Archive, 0, "/src/test/files/somedata", 6, buffer, sizeof(buffer), &nread);
+    ASSERT_EQ(dmResourceProvider::RESULT_OK, result);
+    ASSERT_EQ(2U, nread);
+    ASSERT_ARRAY_EQ_LEN(SOMEDATA + 6, buffer, nread);
+
+    result = dmResourceProvider::ReadFilePartial(m_Archive, 0, "/src/test/files/not_exist", 0, buffer, sizeof(buffer), &nread);
+    ASSERT_NE(dmResourceProvider::RESULT_OK, result);
+}
+
 extern "C" void dmExportedSymbols();
 
 int main(int argc, char **argv)
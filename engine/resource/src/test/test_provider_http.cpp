@@ -15,7 +15,9 @@
 #include <stdio.h>
 #include <stdint.h>
 
+#include <dlib/dstrings.h>
 #include <dlib/log.h>
+#include <dlib/memory.h>
 #include <dlib/testutil.h>
 #include <dlib/socket.h>
 #include <dlib/uri.h>
@@ -44,8 +46,9 @@ TEST(HttpProviderBasic, Registered)
     loader = dmResourceProvider::FindLoaderByName(dmHashString64("file"));
     ASSERT_EQ((ArchiveLoader*)0, loader);
 
+    // Used when mounting a .dmanifest
     loader = dmResourceProvider::FindLoaderByName(dmHashString64("archive"));
-    ASSERT_EQ((ArchiveLoader*)0, loader);
+    ASSERT_NE((ArchiveLoader*)0, loader);
 }
 
 TEST(HttpProviderBasic, CanMount)
@@ -135,6 +138,101 @@ TEST_F(HttpProviderArchive, ReadFile)
     ASSERT_ARRAY_EQ_LEN(SOMEDATA, long_buffer, sizeof(SOMEDATA));
 }
 
+// The file fetched by GetFileSize() is used by the following ReadFile()
+TEST_F(HttpProviderArchive, GetSizeAndReadFile)
+{
+    char path[1024];
+    dmTestUtil::MakeHostPath(path, sizeof(path), "build/src/test/somedata");
+    FILE* f = fopen(path, "wb");
+    ASSERT_NE((FILE*)0, f);
+    fwrite(SOMEDATA, sizeof(SOMEDATA), 1, f);
+    fclose(f);
+
+    dmResourceProvider::Result result;
+    uint32_t file_size;
+    uint8_t short_buffer[4] = {0};
+    uint8_t long_buffer[64] = {0};
+
+    result = dmResourceProvider::GetFileSize(m_Archive, 0, "/somedata", &file_size);
+    ASSERT_EQ(dmResourceProvider::RESULT_OK, result);
+    ASSERT_EQ((uint32_t)sizeof(SOMEDATA), file_size);
+
+    result = dmResourceProvider::ReadFile(m_Archive, 0, "/somedata", short_buffer, sizeof(short_buffer));
+    ASSERT_EQ(dmResourceProvider::RESULT_IO_ERROR, result);
+
+    result = dmResourceProvider::GetFileSize(m_Archive, 0, "/somedata", &file_size);
+    ASSERT_EQ(dmResourceProvider::RESULT_OK, result);
+
+    result = dmResourceProvider::GetFileSize(m_Archive, 0, "/test.cont", &file_size);
+    ASSERT_EQ(dmResourceProvider::RESULT_OK, result);
+    ASSERT_EQ(35U, file_size);
+
+    // A different file was fetched in between, so this is a new request
+    result = dmResourceProvider::ReadFile(m_Archive, 0, "/somedata", long_buffer, sizeof(long_buffer));
+    ASSERT_EQ(dmResourceProvider::RESULT_OK, result);
+    ASSERT_ARRAY_EQ_LEN(SOMEDATA, long_buffer, sizeof(SOMEDATA));
+}
+
+const char* ARCHIVE_FILE_PATHS[] = {
+    "/archive_data/file1.adc",
+    "/archive_data/file2.adc",
+    "/archive_data/file3.adc",
+    "/archive_data/file4.adc",
+    "/archive_data/file5.scriptc",
+};
+
+// The archive data is fetched with range requests, as the files are read
+TEST(HttpProviderArchiveData, ReadFile)
+{
+    dmResourceProvider::ArchiveLoader* loader = dmResourceProvider::FindLoaderByName(dmHashString64("http"));
+    ASSERT_NE((ArchiveLoader*)0, loader);
+
+    dmURI::Parts uri;
+    dmURI::Parse("http://localhost:6123/resources.dmanifest", &uri);
+
+    dmResourceProvider::HArchive archive;
+    dmResourceProvider::Result result = dmResourceProvider::CreateMount(loader, &uri, 0, &archive);
+    ASSERT_EQ(dmResourceProvider::RESULT_OK, result);
+
+    dmResource::HManifest manifest = 0;
+    result = dmResourceProvider::GetManifest(archive, &manifest);
+    ASSERT_EQ(dmResourceProvider::RESULT_OK, result);
+    ASSERT_NE((dmResource::HManifest)0, manifest);
+
+    for (uint32_t i = 0; i < DM_ARRAY_SIZE(ARCHIVE_FILE_PATHS); ++i)
+    {
+        const char* path = ARCHIVE_FILE_PATHS[i];
+        dmhash_t path_hash = dmHashString64(path);
+
+        char host_path[256];
+        dmSnPrintf(host_path, sizeof(host_path), "build/src/test%s", path);
+        uint32_t expected_file_size;
+        const uint8_t* expected_file = dmTestUtil::ReadHostFile(host_path, &expected_file_size);
+        ASSERT_NE((uint8_t*)0, expected_file);
+
+        uint32_t file_size;
+        result = dmResourceProvider::GetFileSize(archive, path_hash, path, &file_size);
+        ASSERT_EQ(dmResourceProvider::RESULT_OK, result);
+        ASSERT_EQ(expected_file_size, file_size);
+
+        uint8_t* buffer = new uint8_t[file_size];
+        result = dmResourceProvider::ReadFile(archive, path_hash, path, buffer, file_size);
+        ASSERT_EQ(dmResourceProvider::RESULT_OK, result);
+        ASSERT_ARRAY_EQ_LEN(expected_file, buffer, file_size);
+
+        delete[] buffer;
+        dmMemory::AlignedFree((void*)expected_file);
+    }
+
+    const char* path = "/not_exist";
+    uint32_t file_size;
+    result = dmResourceProvider::GetFileSize(archive, dmHashString64(path), path, &file_size);
+    ASSERT_EQ(dmResourceProvider::RESULT_NOT_FOUND, result);
+
+    result = dmResourceProvider::Unmount(archive);
+    ASSERT_EQ(dmResourceProvider::RESULT_OK, result);
+}
+
 #if defined(DM_TEST_HTTP_SUPPORTED)
 
 extern "C" void dmExportedSymbols();
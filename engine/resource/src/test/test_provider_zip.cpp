@@ -258,6 +258,38 @@ TEST_P(ArchiveProviderZip, ReadFile)
     }
 }
 
+// Uncompressed entries may be returned straight from the mapped zip file
+TEST_P(ArchiveProviderZip, GetFileData)
+{
+    for (uint32_t i = 0; i < DM_ARRAY_SIZE(FILE_PATHS); ++i)
+    {
+        const char* path = FILE_PATHS[i];
+        dmhash_t path_hash = dmHashString64(path);
+
+        uint32_t expected_file_size;
+        const uint8_t* expected_file = GetRawFile(path, &expected_file_size, false);
+        ASSERT_NE((uint8_t*)0, expected_file);
+
+        const uint8_t* data = 0;
+        dmResourceProvider::Result result = dmResourceProvider::GetFileData(m_Archive, path_hash, path, &data);
+        if (dmResourceProvider::RESULT_OK == result)
+        {
+            ASSERT_NE((const uint8_t*)0, data);
+            ASSERT_ARRAY_EQ_LEN(expected_file, data, expected_file_size);
+        }
+        else
+        {
+            ASSERT_EQ(dmResourceProvider::RESULT_NOT_SUPPORTED, result);
+        }
+
+        dmMemory::AlignedFree((void*)expected_file);
+    }
+
+    const char* path = "src/test/files/not_exist";
+    const uint8_t* data = 0;
+    ASSERT_EQ(dmResourceProvider::RESULT_NOT_FOUND, dmResourceProvider::GetFileData(m_Archive, dmHashString64(path), path, &data));
+}
+
 #define FSPREFIX ""
 #if defined(__EMSCRIPTEN__)
     #undef FSPREFIX
@@ -229,7 +229,11 @@ protected:
 
         dmResource::NewFactoryParams params;
         params.m_MaxResources = 16;
+        CreateFactory(&params);
+    }
 
+    void CreateFactory(dmResource::NewFactoryParams* params)
+    {
         const char* original_mount_path = GetParam();
 #if defined(DM_TEST_HTTP_SUPPORTED)
         char mountpath[512];
@@ -240,7 +244,7 @@ protected:
         }
 #endif
 
-        m_Factory = dmResource::NewFactory(&params, original_mount_path);
+        m_Factory = dmResource::NewFactory(params, original_mount_path);
 
         ASSERT_NE((void*) 0, m_Factory);
         m_ResourceName = "/test.cont";
@@ -723,6 +727,76 @@ TEST_P(GetResourceTest, PreloadGet)
     dmResource::Release(m_Factory, resource);
 }
 
+TEST_P(GetResourceTest, PreloadGetThreadSafeCreate)
+{
+    // The foo resources have no dependencies, so they may now be created on a loader thread
+    HResourceType type;
+    ASSERT_EQ(dmResource::RESULT_OK, dmResource::GetTypeFromExtension(m_Factory, "foo", &type));
+    ResourceTypeSetThreadSafeCreate(type, true);
+
+    TestResourceContainer* test_resource_cont = 0;
+    dmResource::Result e = PreloaderGet(m_Factory, m_ResourceName, (void**) &test_resource_cont);
+    ASSERT_EQ(dmResource::RESULT_OK, e);
+    ASSERT_NE((void*) 0, test_resource_cont);
+    ASSERT_EQ(2u, (uint32_t) test_resource_cont->m_Resources.size());
+    ASSERT_EQ((uint32_t) 123, test_resource_cont->m_Resources[0]->m_X);
+    ASSERT_EQ((uint32_t) 456, test_resource_cont->m_Resources[1]->m_X);
+    // The post create functions are still called on the main thread
+    ASSERT_EQ((uint32_t) test_resource_cont->m_Resources.size(), m_FooResourcePostCreateCallCount);
+
+    HResourceDescriptor descriptor;
+    ASSERT_EQ(dmResource::RESULT_OK, dmResource::GetDescriptor(m_Factory, "/test01.foo", &descriptor));
+    ASSERT_EQ(dmHashString64("/test01.foo"), descriptor->m_NameHash);
+
+    dmResource::Release(m_Factory, test_resource_cont);
+    ASSERT_EQ((uint32_t) 2, m_FooResourceDestroyCallCount);
+}
+
+TEST_P(GetResourceTest, KeepResident)
+{
+    HResourceType type;
+    ASSERT_EQ(dmResource::RESULT_OK, dmResource::GetTypeFromExtension(m_Factory, "foo", &type));
+    ResourceTypeSetKeepResident(type, true);
+    dmResource::SetResidencyBudget(m_Factory, 1024 * 1024);
+
+    TestResourceContainer* test_resource_cont = 0;
+    ASSERT_EQ(dmResource::RESULT_OK, dmResource::Get(m_Factory, m_ResourceName, (void**) &test_resource_cont));
+    ASSERT_EQ((uint32_t) 2, m_FooResourceCreateCallCount);
+    dmResource::Release(m_Factory, test_resource_cont);
+
+    // The container is destroyed, but the foo resources are kept alive without any references
+    ASSERT_EQ((uint32_t) 1, m_ResourceContainerDestroyCallCount);
+    ASSERT_EQ((uint32_t) 0, m_FooResourceDestroyCallCount);
+    HResourceDescriptor descriptor;
+    ASSERT_EQ(dmResource::RESULT_OK, dmResource::GetDescriptor(m_Factory, "/test01.foo", &descriptor));
+    ASSERT_EQ((uint32_t) 0, descriptor->m_ReferenceCount);
+
+    // Loading the container again revives them
+    ASSERT_EQ(dmResource::RESULT_OK, dmResource::Get(m_Factory, m_ResourceName, (void**) &test_resource_cont));
+    ASSERT_EQ((uint32_t) 2, m_ResourceContainerCreateCallCount);
+    ASSERT_EQ((uint32_t) 2, m_FooResourceCreateCallCount);
+    ASSERT_EQ((uint32_t) 1, dmResource::GetRefCount(m_Factory, test_resource_cont->m_Resources[0]));
+    ASSERT_EQ((uint32_t) 123, test_resource_cont->m_Resources[0]->m_X);
+
+    // The preloader revives them too
+    dmResource::Release(m_Factory, test_resource_cont);
+    ASSERT_EQ(dmResource::RESULT_OK, PreloaderGet(m_Factory, m_ResourceName, (void**) &test_resource_cont));
+    ASSERT_EQ((uint32_t) 2, m_FooResourceCreateCallCount);
+    dmResource::Release(m_Factory, test_resource_cont);
+    ASSERT_EQ((uint32_t) 0, m_FooResourceDestroyCallCount);
+
+    // Resources that no longer fit within the budget are destroyed
+    dmResource::SetResidencyBudget(m_Factory, 1);
+    ASSERT_EQ((uint32_t) 2, m_FooResourceDestroyCallCount);
+    ASSERT_EQ(dmResource::RESULT_NOT_LOADED, dmResource::GetDescriptor(m_Factory, "/test01.foo", &descriptor));
+
+    // Resources are not kept when the budget is 0
+    ASSERT_EQ(dmResource::RESULT_OK, dmResource::Get(m_Factory, m_ResourceName, (void**) &test_resource_cont));
+    dmResource::SetResidencyBudget(m_Factory, 0);
+    dmResource::Release(m_Factory, test_resource_cont);
+    ASSERT_EQ((uint32_t) 4, m_FooResourceDestroyCallCount);
+}
+
 TEST_P(GetResourceTest, PreloadGetList)
 {
     const char* resource_names_list[] = { m_ResourceName, "/test_ref.cont" };
@@ -850,9 +924,121 @@ TEST_P(GetResourceTest, PreloadGetParallell)
     }
 }
 
+TEST_P(GetResourceTest, PreloadGetLoaderThreads)
+{
+    // Several loader threads, and a byte budget small enough to throttle after every load
+    dmResource::DeleteFactory(m_Factory);
+    dmResource::NewFactoryParams params;
+    params.m_MaxResources = 16;
+    params.m_LoaderThreadCount = 4;
+    params.m_LoaderMaxPendingData = 1;
+    CreateFactory(&params);
+
+    for (uint32_t i = 0; i < 5; ++i)
+    {
+        TestResourceContainer* resource = 0;
+        dmResource::Result e = PreloaderGet(m_Factory, m_ResourceName, (void**) &resource);
+        ASSERT_EQ(dmResource::RESULT_OK, e);
+        ASSERT_NE((void*) 0, resource);
+        ASSERT_EQ((uint32_t) 1, m_ResourceContainerCreateCallCount);
+        dmResource::Release(m_Factory, resource);
+        m_ResourceContainerCreateCallCount = 0;
+    }
+}
+
+struct LoadTimelineTestContext
+{
+    uint32_t m_Count;
+    dmResource::LoadTimelineEntry m_Entry;
+};
+
+static void LoadTimelineTestCallback(void* ctx, const dmResource::LoadTimelineEntry* entry)
+{
+    LoadTimelineTestContext* context = (LoadTimelineTestContext*)ctx;
+    context->m_Count++;
+    if (strcmp(entry->m_Path, "/test.cont") == 0)
+        context->m_Entry = *entry;
+}
+
+TEST_P(GetResourceTest, LoadTimeline)
+{
+    dmResource::DeleteFactory(m_Factory);
+    dmResource::NewFactoryParams params;
+    params.m_MaxResources = 16;
+    params.m_LoadTimelineSize = 4;
+    CreateFactory(&params);
+
+    LoadTimelineTestContext ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    dmResource::IterateLoadTimeline(m_Factory, LoadTimelineTestCallback, &ctx);
+    ASSERT_EQ(0u, ctx.m_Count);
+
+    TestResourceContainer* resource = 0;
+    dmResource::Result e = dmResource::Get(m_Factory, m_ResourceName, (void**) &resource);
+    ASSERT_EQ(dmResource::RESULT_OK, e);
+    dmResource::Release(m_Factory, resource);
+
+    // The container and its children
+    dmResource::IterateLoadTimeline(m_Factory, LoadTimelineTestCallback, &ctx);
+    ASSERT_EQ(1u + m_FooResourceCreateCallCount, ctx.m_Count);
+    ASSERT_EQ(dmResource::RESULT_OK, ctx.m_Entry.m_Result);
+    ASSERT_EQ(0u, ctx.m_Entry.m_Async);
+    ASSERT_LT(0u, ctx.m_Entry.m_Timing.m_Size);
+    ASSERT_NE((const char*)0, dmResource::GetLoadProviderName(ctx.m_Entry.m_Timing.m_Provider));
+
+    e = PreloaderGet(m_Factory, m_ResourceName, (void**) &resource);
+    ASSERT_EQ(dmResource::RESULT_OK, e);
+    dmResource::Release(m_Factory, resource);
+
+    memset(&ctx, 0, sizeof(ctx));
+    dmResource::IterateLoadTimeline(m_Factory, LoadTimelineTestCallback, &ctx);
+    // Only the most recent loads are kept
+    ASSERT_EQ(4u, ctx.m_Count);
+    ASSERT_EQ(dmResource::RESULT_OK, ctx.m_Entry.m_Result);
+    ASSERT_EQ(1u, ctx.m_Entry.m_Async);
+    ASSERT_LT(0u, ctx.m_Entry.m_Timing.m_Size);
+}
+
+TEST_P(GetResourceTest, StartupSnapshot)
+{
+    // Loose files may change without the key changing
+    uint64_t key = 0;
+    ASSERT_EQ(dmResource::RESULT_NOT_SUPPORTED, dmResource::GetStartupSnapshotKey(m_Factory, &key));
+    key = 0x1234;
+
+    char path_buffer[512];
+    const char* path = dmTestUtil::MakeHostPathf(path_buffer, sizeof(path_buffer), "%s/%s", TMP_DIR, "startup.snapshot");
+    dmSys::Unlink(path);
+
+    // Nothing to load, the reads are recorded
+    ASSERT_FALSE(dmResource::OpenStartupSnapshot(m_Factory, path, key, 1024 * 1024));
+    TestResourceContainer* resource = 0;
+    ASSERT_EQ(dmResource::RESULT_OK, dmResource::Get(m_Factory, m_ResourceName, (void**) &resource));
+    size_t child_count = resource->m_Resources.size();
+    dmResource::Release(m_Factory, resource);
+    ASSERT_EQ(dmResource::RESULT_OK, dmResource::CloseStartupSnapshot(m_Factory));
+
+    // The reads are served from the snapshot
+    ASSERT_TRUE(dmResource::OpenStartupSnapshot(m_Factory, path, key, 1024 * 1024));
+    ASSERT_EQ(dmResource::RESULT_OK, dmResource::Get(m_Factory, m_ResourceName, (void**) &resource));
+    ASSERT_EQ(child_count, resource->m_Resources.size());
+    dmResource::Release(m_Factory, resource);
+
+    ASSERT_EQ(dmResource::RESULT_OK, PreloaderGet(m_Factory, m_ResourceName, (void**) &resource));
+    ASSERT_EQ(child_count, resource->m_Resources.size());
+    dmResource::Release(m_Factory, resource);
+    ASSERT_EQ(dmResource::RESULT_OK, dmResource::CloseStartupSnapshot(m_Factory));
+
+    // A different key means the archives changed
+    ASSERT_FALSE(dmResource::OpenStartupSnapshot(m_Factory, path, key + 1, 1024 * 1024));
+    ASSERT_EQ(dmResource::RESULT_OK, dmResource::CloseStartupSnapshot(m_Factory));
+
+    dmSys::Unlink(path);
+}
+
 TEST_P(GetResourceTest, PreloadGetManyRefs)
 {
-    // this has more references than the preloader can fit into its tree
+    // this has more references than the initial request block of the preloader, so the tree must grow
     dmResource::HPreloader pr = dmResource::NewPreloader(m_Factory, "/many_refs.cont");
 
     uint32_t timeout = 100*1000;
@@ -1065,6 +1251,14 @@ TEST(RecreateTest, RecreateTest)
     ASSERT_EQ(123, reload_data.m_Old);
     ASSERT_EQ(456, reload_data.m_New);
 
+    // The file hasn't changed, so the resource isn't recreated
+    reload_data = ReloadData();
+    rr = dmResource::ReloadResource(factory, resource_name, 0);
+    ASSERT_EQ(dmResource::RESULT_OK, rr);
+    ASSERT_EQ(456, *resource);
+    ASSERT_EQ(0, reload_data.m_Old);
+    ASSERT_EQ(0, reload_data.m_New);
+
     dmSys::Unlink(path);
     rr = dmResource::ReloadResource(factory, resource_name, 0);
     ASSERT_EQ(dmResource::RESULT_RESOURCE_NOT_FOUND, rr);
@@ -1389,6 +1583,12 @@ TEST(RecreateTest, ReloadCallbackTest)
     CallbackUserData user_data;
     dmResource::RegisterResourceReloadedCallback(factory, ReloadCallback, &user_data);
 
+    // Unchanged files aren't reloaded
+    f = fopen(path, "wb");
+    ASSERT_NE((FILE*) 0, f);
+    fprintf(f, "456");
+    fclose(f);
+
     dmResource::Result rr = dmResource::ReloadResource(factory, resource_name, 0);
     ASSERT_EQ(dmResource::RESULT_OK, rr);
 
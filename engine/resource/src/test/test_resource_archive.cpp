@@ -22,6 +22,9 @@
 #include "../providers/provider_archive_private.h"
 #include <dlib/dstrings.h>
 #include <dlib/endian.h>
+#include <dlib/job_thread.h>
+#include <dlib/lz4.h>
+#include <dlib/math.h>
 #include <dlib/sys.h>
 #include <dlib/testutil.h>
 #include <testmain/testmain.h>
@@ -647,6 +650,84 @@ TEST(dmResourceArchive, Wrap)
     dmResourceArchive::Delete(archive);
 }
 
+TEST(dmResourceArchive, FindEntry_Lookup)
+{
+    dmResourceArchive::HArchiveIndexContainer archive = 0;
+    dmResourceArchive::Result result = dmResourceArchive::WrapArchiveBuffer((void*) RESOURCES_ARCI, RESOURCES_ARCI_SIZE, true, RESOURCES_ARCD, RESOURCES_ARCD_SIZE, true, &archive);
+    ASSERT_EQ(dmResourceArchive::RESULT_OK, result);
+    ASSERT_NE((uint32_t*)0, archive->m_EntryLookup);
+
+    uint8_t invalid_hash[] = { 10U, 10U, 10U, 10U, 10U, 10U, 10U, 10U, 10U, 10U, 10U, 10U, 10U, 10U, 10U, 10U, 10U, 10U, 10U, 10U };
+
+    // The lookup table and the binary search (used when the table is out of date) should find the same entries
+    dmResourceArchive::EntryData* entries[sizeof(path_hash) / sizeof(path_hash[0])];
+    for (uint32_t i = 0; i < (sizeof(path_hash) / sizeof(path_hash[0])); ++i)
+    {
+        if (IsLiveUpdateResource(path_hash[i])) continue;
+        ASSERT_EQ(dmResourceArchive::RESULT_OK, dmResourceArchive::FindEntry(archive, content_hash[i], sizeof(content_hash[i]), &entries[i]));
+    }
+    ASSERT_EQ(dmResourceArchive::RESULT_NOT_FOUND, dmResourceArchive::FindEntry(archive, invalid_hash, sizeof(invalid_hash), 0));
+
+    archive->m_EntryLookupCount = 0;
+    for (uint32_t i = 0; i < (sizeof(path_hash) / sizeof(path_hash[0])); ++i)
+    {
+        if (IsLiveUpdateResource(path_hash[i])) continue;
+        dmResourceArchive::EntryData* entry = 0;
+        ASSERT_EQ(dmResourceArchive::RESULT_OK, dmResourceArchive::FindEntry(archive, content_hash[i], sizeof(content_hash[i]), &entry));
+        ASSERT_EQ(entries[i], entry);
+    }
+    ASSERT_EQ(dmResourceArchive::RESULT_NOT_FOUND, dmResourceArchive::FindEntry(archive, invalid_hash, sizeof(invalid_hash), 0));
+
+    dmResourceArchive::Delete(archive);
+
+    dmResource::HManifest manifest = 0;
+    ASSERT_EQ(dmResource::RESULT_OK, dmResource::LoadManifestFromBuffer(RESOURCES_DMANIFEST, RESOURCES_DMANIFEST_SIZE, &manifest));
+    ASSERT_NE((uint32_t*)0, manifest->m_EntryLookup);
+
+    dmLiveUpdateDDF::ManifestData* manifest_data = manifest->m_DDFData;
+    for (uint32_t i = 0; i < manifest_data->m_Resources.m_Count; ++i)
+    {
+        dmLiveUpdateDDF::ResourceEntry* entry = &manifest_data->m_Resources.m_Data[i];
+        ASSERT_EQ(entry, dmResource::FindEntry(manifest, entry->m_UrlHash));
+    }
+    ASSERT_EQ((dmLiveUpdateDDF::ResourceEntry*)0, dmResource::FindEntry(manifest, dmHashString64("/not_in_manifest")));
+
+    manifest->m_EntryLookupCount = 0;
+    for (uint32_t i = 0; i < manifest_data->m_Resources.m_Count; ++i)
+    {
+        dmLiveUpdateDDF::ResourceEntry* entry = &manifest_data->m_Resources.m_Data[i];
+        ASSERT_EQ(entry, dmResource::FindEntry(manifest, entry->m_UrlHash));
+    }
+    ASSERT_EQ((dmLiveUpdateDDF::ResourceEntry*)0, dmResource::FindEntry(manifest, dmHashString64("/not_in_manifest")));
+
+    dmResource::DeleteManifest(manifest);
+}
+
+TEST(dmResourceArchive, Wrap_GetEntryData)
+{
+    dmResourceArchive::HArchiveIndexContainer archive = 0;
+    dmResourceArchive::Result result = dmResourceArchive::WrapArchiveBuffer((void*) RESOURCES_ARCI, RESOURCES_ARCI_SIZE, true, RESOURCES_ARCD, RESOURCES_ARCD_SIZE, true, &archive);
+    ASSERT_EQ(dmResourceArchive::RESULT_OK, result);
+
+    dmResourceArchive::EntryData* entry;
+    for (uint32_t i = 0; i < (sizeof(path_hash) / sizeof(path_hash[0])); ++i)
+    {
+        if (IsLiveUpdateResource(path_hash[i])) continue;
+
+        result = dmResourceArchive::FindEntry(archive, content_hash[i], sizeof(content_hash[i]), &entry);
+        ASSERT_EQ(dmResourceArchive::RESULT_OK, result);
+
+        // The data is stored as is, so we get a pointer straight into the resource data
+        const uint8_t* data = 0;
+        ASSERT_TRUE(dmResourceArchive::GetEntryData(archive, entry, &data));
+        ASSERT_GE(data, (const uint8_t*)RESOURCES_ARCD);
+        ASSERT_LT(data, (const uint8_t*)RESOURCES_ARCD + RESOURCES_ARCD_SIZE);
+        ASSERT_EQ(0, memcmp(content[i], data, strlen(content[i])));
+    }
+
+    dmResourceArchive::Delete(archive);
+}
+
 TEST(dmResourceArchive, Wrap_Compressed)
 {
     dmResourceArchive::HArchiveIndexContainer archive = 0;
@@ -758,6 +839,168 @@ TEST(dmResourceArchive, LoadFromDisk_Compressed)
     dmResourceArchive::Delete(archive);
 }
 
+// Compresses the data the same way as arcc.py does for chunked entries
+static void CompressChunks(const uint8_t* data, uint32_t data_size, uint32_t chunk_size, dmArray<uint8_t>& out)
+{
+    uint32_t chunk_count = (data_size + chunk_size - 1) / chunk_size;
+    uint32_t header_size = sizeof(dmResourceArchive::ChunkHeader) + chunk_count * sizeof(uint32_t);
+
+    int max_compressed_size = 0;
+    dmLZ4::MaxCompressedSize(chunk_size, &max_compressed_size);
+    out.SetCapacity(header_size + chunk_count * max_compressed_size);
+    out.SetSize(header_size);
+
+    uint32_t* header = (uint32_t*)out.Begin();
+    header[0] = dmEndian::ToHost(chunk_size);
+    header[1] = dmEndian::ToHost(chunk_count);
+    for (uint32_t i = 0; i < chunk_count; ++i)
+    {
+        uint32_t size = dmMath::Min(chunk_size, data_size - i * chunk_size);
+        int compressed_size = 0;
+        ASSERT_EQ(dmLZ4::RESULT_OK, dmLZ4::CompressBuffer(data + i * chunk_size, size, out.End(), &compressed_size));
+        ((uint32_t*)out.Begin())[2 + i] = dmEndian::ToHost((uint32_t)compressed_size);
+        out.SetSize(out.Size() + compressed_size);
+    }
+}
+
+static void TestDecompressChunks(dmJobThread::HContext job_thread)
+{
+    dmResourceArchive::SetJobThread(job_thread);
+
+    const uint32_t data_size = 100 * 1024 + 17;
+    uint8_t* data = new uint8_t[data_size];
+    for (uint32_t i = 0; i < data_size; ++i)
+    {
+        data[i] = (uint8_t)((i / 7) ^ (i % 13));
+    }
+
+    dmArray<uint8_t> compressed;
+    CompressChunks(data, data_size, 16 * 1024, compressed);
+
+    uint8_t* buffer = new uint8_t[data_size];
+    ASSERT_EQ(dmResourceArchive::RESULT_OK, dmResourceArchive::DecompressChunks(compressed.Begin(), compressed.Size(), buffer, data_size));
+    ASSERT_EQ(0, memcmp(data, buffer, data_size));
+
+    // Wrong output size
+    ASSERT_NE(dmResourceArchive::RESULT_OK, dmResourceArchive::DecompressChunks(compressed.Begin(), compressed.Size(), buffer, data_size - 1));
+    // Truncated data
+    ASSERT_NE(dmResourceArchive::RESULT_OK, dmResourceArchive::DecompressChunks(compressed.Begin(), compressed.Size() - 1, buffer, data_size));
+    ASSERT_NE(dmResourceArchive::RESULT_OK, dmResourceArchive::DecompressChunks(compressed.Begin(), 12, buffer, data_size));
+
+    delete[] buffer;
+    delete[] data;
+
+    dmResourceArchive::SetJobThread(0);
+}
+
+TEST(dmResourceArchive, DecompressChunks)
+{
+    TestDecompressChunks(0);
+}
+
+TEST(dmResourceArchive, DecompressChunks_JobThread)
+{
+    dmJobThread::JobThreadCreationParams params;
+    params.m_ThreadNames[0] = "test_decompress";
+    params.m_ThreadCount    = 3;
+    dmJobThread::HContext job_thread = dmJobThread::Create(params);
+    TestDecompressChunks(job_thread);
+    dmJobThread::Destroy(job_thread);
+}
+
+// Archive data with a dictionary at the start, followed by the entry
+static void CreateDictionaryArchiveData(const char* dictionary, const char* data, dmArray<uint8_t>& out, uint32_t* entry_offset)
+{
+    uint32_t dictionary_size = (uint32_t)strlen(dictionary);
+    uint32_t data_size = (uint32_t)strlen(data);
+
+    int max_compressed_size = 0;
+    dmLZ4::MaxCompressedSize(data_size, &max_compressed_size);
+    out.SetCapacity(dictionary_size + sizeof(dmResourceArchive::DictionaryHeader) + max_compressed_size);
+    out.SetSize(dictionary_size);
+    memcpy(out.Begin(), dictionary, dictionary_size);
+
+    *entry_offset = out.Size();
+    dmResourceArchive::DictionaryHeader header;
+    header.m_DictionaryOffset = dmEndian::ToHost(0u);
+    header.m_DictionarySize   = dmEndian::ToHost(dictionary_size);
+    out.PushArray((const uint8_t*)&header, sizeof(header));
+
+    int compressed_size = 0;
+    ASSERT_EQ(dmLZ4::RESULT_OK, dmLZ4::CompressBufferWithDictionary(data, data_size, dictionary, dictionary_size, out.End(), &compressed_size));
+    out.SetSize(out.Size() + compressed_size);
+}
+
+static void TestDecompressWithDictionary(bool mem_mapped)
+{
+    const char* dictionary = "tile_set: \"/main/tiles.t.texturesetc\" default_animation: \"idle\" material: \"/builtins/materials/sprite.materialc\" blend_mode: BLEND_MODE_ALPHA";
+    const char* data       = "tile_set: \"/main/hero.t.texturesetc\" default_animation: \"run\" material: \"/builtins/materials/sprite.materialc\" blend_mode: BLEND_MODE_ADD";
+    uint32_t data_size = (uint32_t)strlen(data);
+
+    dmArray<uint8_t> archive_data;
+    uint32_t entry_offset;
+    CreateDictionaryArchiveData(dictionary, data, archive_data, &entry_offset);
+
+    dmResourceArchive::ArchiveFileIndex* afi = new dmResourceArchive::ArchiveFileIndex;
+    if (mem_mapped)
+    {
+        afi->m_IsMemMapped  = true;
+        afi->m_ResourceData = archive_data.Begin();
+        afi->m_ResourceSize = archive_data.Size();
+    }
+    else
+    {
+        afi->m_FileResourceData = tmpfile();
+        ASSERT_NE((FILE*)0, afi->m_FileResourceData);
+        ASSERT_EQ(archive_data.Size(), (uint32_t)fwrite(archive_data.Begin(), 1, archive_data.Size(), afi->m_FileResourceData));
+    }
+
+    dmResourceArchive::HArchiveIndexContainer archive = new dmResourceArchive::ArchiveIndexContainer;
+    archive->m_ArchiveFileIndex = afi;
+
+    dmResourceArchive::EntryData entry;
+    entry.m_ResourceDataOffset     = dmEndian::ToHost(entry_offset);
+    entry.m_ResourceSize           = dmEndian::ToHost(data_size);
+    entry.m_ResourceCompressedSize = dmEndian::ToHost(archive_data.Size() - entry_offset);
+    entry.m_Flags                  = dmEndian::ToHost((uint32_t)(dmResourceArchive::ENTRY_FLAG_COMPRESSED | dmResourceArchive::ENTRY_FLAG_DICTIONARY));
+
+    // Twice, to also read the dictionary from the cache
+    for (uint32_t i = 0; i < 2; ++i)
+    {
+        char buffer[256] = {0};
+        ASSERT_EQ(dmResourceArchive::RESULT_OK, dmResourceArchive::ReadEntry(archive, &entry, buffer));
+        ASSERT_STREQ(data, buffer);
+    }
+    ASSERT_EQ(mem_mapped ? 0u : 1u, archive->m_DictionaryCount);
+
+    // Wrong output size
+    char buffer[256];
+    const uint8_t* entry_data = archive_data.Begin() + entry_offset;
+    uint32_t entry_size = archive_data.Size() - entry_offset;
+    ASSERT_NE(dmResourceArchive::RESULT_OK, dmResourceArchive::DecompressWithDictionary(archive, entry_data, entry_size, (uint8_t*)buffer, data_size - 1));
+    // Truncated data
+    ASSERT_NE(dmResourceArchive::RESULT_OK, dmResourceArchive::DecompressWithDictionary(archive, entry_data, entry_size - 1, (uint8_t*)buffer, data_size));
+    ASSERT_NE(dmResourceArchive::RESULT_OK, dmResourceArchive::DecompressWithDictionary(archive, entry_data, 4, (uint8_t*)buffer, data_size));
+
+    // Dictionary outside of the archive data
+    dmArray<uint8_t> bad_data;
+    bad_data.SetCapacity(entry_size);
+    bad_data.PushArray(entry_data, entry_size);
+    ((dmResourceArchive::DictionaryHeader*)bad_data.Begin())->m_DictionaryOffset = dmEndian::ToHost(archive_data.Size());
+    ASSERT_NE(dmResourceArchive::RESULT_OK, dmResourceArchive::DecompressWithDictionary(archive, bad_data.Begin(), bad_data.Size(), (uint8_t*)buffer, data_size));
+
+    dmResourceArchive::Delete(archive);
+}
+
+TEST(dmResourceArchive, DecompressWithDictionary)
+{
+    TestDecompressWithDictionary(true);
+}
+
+TEST(dmResourceArchive, DecompressWithDictionary_File)
+{
+    TestDecompressWithDictionary(false);
+}
 
 static dmResource::Result TestDecryption(void* buffer, uint32_t buffer_len)
 {
@@ -31,14 +31,37 @@ namespace dmRig
 
     static const dmhash_t NULL_ANIMATION = dmHashString64("");
     static const float CURSOR_EPSILON = 0.0001f;
+    // Don't bother the job thread with fewer instances than this per job
+    static const uint32_t ANIMATE_JOB_MIN_INSTANCES = 8;
+    static const uint32_t ANIMATE_JOB_MAX_COUNT = 16;
 
-    static void DoAnimate(HRigContext context, RigInstance* instance, float dt);
+    // Events are collected while animating, and sent on the calling thread once all instances are animated
+    struct RigEvent
+    {
+        RigInstance*    m_Instance;
+        RigEventType    m_Type;
+        union
+        {
+            RigKeyframeEventData  m_Keyframe;
+            RigCompletedEventData m_Completed;
+        };
+    };
+
+    struct AnimateJob
+    {
+        RigInstance* const* m_Instances;
+        uint32_t            m_Count;
+        float               m_Dt;
+        dmArray<RigEvent>*  m_Events;
+    };
+
+    static void DoAnimate(HRigContext context, RigInstance* instance, float dt, dmArray<RigEvent>& events);
     static bool DoPostUpdate(RigInstance* instance);
 
     struct RigContext
     {
         dmObjectPool<HRigInstance>      m_Instances;
-        // Temporary scratch buffers used for store pose as transform and matrices
+        // Temporary scratch buffer for the skin matrices combined with the world (or normal) matrix
         // (avoids modifying the real pose transform data during rendering).
         dmArray<dmVMath::Matrix4>       m_ScratchPoseMatrixBuffer;
         // Temporary scratch buffers used when transforming the vertex buffer,
@@ -47,6 +70,12 @@ namespace dmRig
         dmArray<dmVMath::Vector3>       m_ScratchPositionBufferLocal;
         dmArray<dmVMath::Vector3>       m_ScratchNormalBuffer;
         dmArray<dmVMath::Vector4>       m_ScratchTangentBuffer;
+        // The events of each animate job, in instance order
+        dmArray<RigEvent>               m_Events[ANIMATE_JOB_MAX_COUNT];
+        AnimateJob                      m_AnimateJobs[ANIMATE_JOB_MAX_COUNT];
+        dmJobThread::HContext           m_JobThread;
+        // Increased for every Update(), to know when the skin matrices of the instances are out of date
+        uint32_t                        m_UpdateCount;
     };
 
 
@@ -59,6 +88,8 @@ namespace dmRig
 
         context->m_Instances.SetCapacity(params.m_MaxRigInstanceCount);
         context->m_ScratchPoseMatrixBuffer.SetCapacity(0);
+        context->m_JobThread = 0;
+        context->m_UpdateCount = 1;
         *out = context;
         return dmRig::RESULT_OK;
     }
@@ -68,6 +99,11 @@ namespace dmRig
         delete context;
     }
 
+    void SetJobThread(HRigContext context, dmJobThread::HContext job_thread)
+    {
+        context->m_JobThread = job_thread;
+    }
+
     static const dmRigDDF::RigAnimation* FindAnimation(const dmRigDDF::AnimationSet* anim_set, dmhash_t animation_id)
     {
         if(anim_set == 0x0)
@@ -218,7 +254,18 @@ namespace dmRig
         return duration;
     }
 
-    static void PostEventsInterval(HRigInstance instance, const dmRigDDF::RigAnimation* animation, float start_cursor, float end_cursor, float duration, bool backwards, float blend_weight)
+    static RigEvent* PushEvent(dmArray<RigEvent>& events, HRigInstance instance, RigEventType type)
+    {
+        if (events.Full())
+            events.OffsetCapacity(32);
+        events.SetSize(events.Size() + 1);
+        RigEvent* event = &events.Back();
+        event->m_Instance = instance;
+        event->m_Type = type;
+        return event;
+    }
+
+    static void PostEventsInterval(HRigInstance instance, const dmRigDDF::RigAnimation* animation, float start_cursor, float end_cursor, float duration, bool backwards, float blend_weight, dmArray<RigEvent>& events)
     {
         const uint32_t track_count = animation->m_EventTracks.m_Count;
         for (uint32_t ti = 0; ti < track_count; ++ti)
@@ -233,7 +280,7 @@ namespace dmRig
                     cursor = duration - cursor;
                 if (start_cursor <= cursor && cursor < end_cursor)
                 {
-                    RigKeyframeEventData event_data;
+                    RigKeyframeEventData& event_data = PushEvent(events, instance, RIG_EVENT_TYPE_KEYFRAME)->m_Keyframe;
                     event_data.m_EventId = track->m_EventId;
                     event_data.m_AnimationId = animation->m_Id;
                     event_data.m_BlendWeight = blend_weight;
@@ -241,14 +288,12 @@ namespace dmRig
                     event_data.m_Integer = key->m_Integer;
                     event_data.m_Float = key->m_Float;
                     event_data.m_String = key->m_String;
-
-                    instance->m_EventCallback(RIG_EVENT_TYPE_KEYFRAME, (void*)&event_data, instance->m_EventCBUserData1, instance->m_EventCBUserData2);
                 }
             }
         }
     }
 
-    static void PostEvents(HRigInstance instance, RigPlayer* player, const dmRigDDF::RigAnimation* animation, float dt, float prev_cursor, float duration, bool completed, float blend_weight)
+    static void PostEvents(HRigInstance instance, RigPlayer* player, const dmRigDDF::RigAnimation* animation, float dt, float prev_cursor, float duration, bool completed, float blend_weight, dmArray<RigEvent>& events)
     {
         float cursor = player->m_Cursor;
         // Since the intervals are defined as t0 <= t < t1, make sure we include the end of the animation, i.e. when t1 == duration
@@ -264,8 +309,8 @@ namespace dmRig
             {
                 prev_backwards = !player->m_Backwards;
             }
-            PostEventsInterval(instance, animation, prev_cursor, duration, duration, prev_backwards, blend_weight);
-            PostEventsInterval(instance, animation, 0.0f, cursor, duration, player->m_Backwards, blend_weight);
+            PostEventsInterval(instance, animation, prev_cursor, duration, duration, prev_backwards, blend_weight, events);
+            PostEventsInterval(instance, animation, 0.0f, cursor, duration, player->m_Backwards, blend_weight, events);
         }
         else
         {
@@ -276,22 +321,22 @@ namespace dmRig
                 // If the previous cursor was still in the forward direction, treat it as two distinct intervals: [start_cursor,half_duration) and [half_duration, end_cursor)
                 if (prev_cursor < half_duration)
                 {
-                    PostEventsInterval(instance, animation, prev_cursor, half_duration, duration, false, blend_weight);
-                    PostEventsInterval(instance, animation, half_duration, cursor, duration, true, blend_weight);
+                    PostEventsInterval(instance, animation, prev_cursor, half_duration, duration, false, blend_weight, events);
+                    PostEventsInterval(instance, animation, half_duration, cursor, duration, true, blend_weight, events);
                 }
                 else
                 {
-                    PostEventsInterval(instance, animation, prev_cursor, cursor, duration, true, blend_weight);
+                    PostEventsInterval(instance, animation, prev_cursor, cursor, duration, true, blend_weight, events);
                 }
             }
             else
             {
-                PostEventsInterval(instance, animation, prev_cursor, cursor, duration, player->m_Backwards, blend_weight);
+                PostEventsInterval(instance, animation, prev_cursor, cursor, duration, player->m_Backwards, blend_weight, events);
             }
         }
     }
 
-    static void UpdatePlayer(RigInstance* instance, RigPlayer* player, float dt, float blend_weight)
+    static void UpdatePlayer(RigInstance* instance, RigPlayer* player, float dt, float blend_weight, dmArray<RigEvent>& events)
     {
         const dmRigDDF::RigAnimation* animation = player->m_Animation;
         if (animation == 0x0 || !player->m_Playing)
@@ -344,7 +389,7 @@ namespace dmRig
 
         if (prev_cursor != player->m_Cursor && instance->m_EventCallback)
         {
-            PostEvents(instance, player, animation, dt, prev_cursor, duration, completed, blend_weight);
+            PostEvents(instance, player, animation, dt, prev_cursor, duration, completed, blend_weight, events);
         }
 
         if (completed)
@@ -353,11 +398,9 @@ namespace dmRig
             // Only report completeness for the primary player
             if (player == GetPlayer(instance) && instance->m_EventCallback)
             {
-                RigCompletedEventData event_data;
+                RigCompletedEventData& event_data = PushEvent(events, instance, RIG_EVENT_TYPE_COMPLETED)->m_Completed;
                 event_data.m_AnimationId = player->m_AnimationId;
                 event_data.m_Playback = player->m_Playback;
-
-                instance->m_EventCallback(RIG_EVENT_TYPE_COMPLETED, (void*)&event_data, instance->m_EventCBUserData1, instance->m_EventCBUserData2);
             }
         }
 
@@ -445,16 +488,72 @@ namespace dmRig
         }
     }
 
+    static int AnimateJobProcess(void* context, void* data)
+    {
+        DM_PROFILE("RigAnimateJob");
+        AnimateJob* job = (AnimateJob*) data;
+        for (uint32_t i = 0; i < job->m_Count; ++i)
+        {
+            DoAnimate((HRigContext) context, job->m_Instances[i], job->m_Dt, *job->m_Events);
+        }
+        return 0;
+    }
+
+    static void SendEvents(const dmArray<RigEvent>& events)
+    {
+        uint32_t count = events.Size();
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            const RigEvent& event = events[i];
+            RigInstance* instance = event.m_Instance;
+            void* event_data = event.m_Type == RIG_EVENT_TYPE_KEYFRAME ? (void*) &event.m_Keyframe : (void*) &event.m_Completed;
+            instance->m_EventCallback(event.m_Type, event_data, instance->m_EventCBUserData1, instance->m_EventCBUserData2);
+        }
+    }
+
+    // The instances are independent of each other, so they are split into chunks where the calling thread
+    // animates the first chunk and the job thread the rest. The events are sent afterwards, in instance order.
     static void Animate(HRigContext context, float dt)
     {
         DM_PROFILE("RigAnimate");
 
         const dmArray<RigInstance*>& instances = context->m_Instances.GetRawObjects();
         uint32_t n = instances.Size();
-        for (uint32_t i = 0; i < n; ++i)
+
+        uint32_t chunk_count = 1;
+        if (context->m_JobThread)
         {
-            RigInstance* instance = instances[i];
-            DoAnimate(context, instance, dt);
+            chunk_count = dmMath::Min(dmJobThread::GetWorkerCount(context->m_JobThread) + 1, n / ANIMATE_JOB_MIN_INSTANCES);
+            chunk_count = dmMath::Clamp(chunk_count, 1u, ANIMATE_JOB_MAX_COUNT);
+        }
+        uint32_t chunk_size = chunk_count > 1 ? (n + chunk_count - 1) / chunk_count : n;
+
+        dmJobThread::JobGroup group;
+        dmJobThread::InitGroup(&group, 0);
+        for (uint32_t i = 0; i < chunk_count; ++i)
+        {
+            uint32_t start = i * chunk_size;
+            AnimateJob& job = context->m_AnimateJobs[i];
+            job.m_Instances = instances.Begin() + start;
+            job.m_Count = start < n ? dmMath::Min(chunk_size, n - start) : 0;
+            job.m_Dt = dt;
+            job.m_Events = &context->m_Events[i];
+            job.m_Events->SetSize(0);
+            if (i > 0)
+                dmJobThread::PushGroupJob(context->m_JobThread, &group, AnimateJobProcess, (void*) context, (void*) &job);
+        }
+
+        AnimateJobProcess((void*) context, (void*) &context->m_AnimateJobs[0]);
+
+        if (chunk_count > 1)
+        {
+            DM_PROFILE("WaitAnimateJobs");
+            dmJobThread::WaitGroup(context->m_JobThread, &group);
+        }
+
+        for (uint32_t i = 0; i < chunk_count; ++i)
+        {
+            SendEvents(context->m_Events[i]);
         }
     }
 
@@ -492,7 +591,39 @@ namespace dmRig
         }
     }
 
-    static void DoAnimate(HRigContext context, RigInstance* instance, float dt)
+    // Returns the pose matrices premultiplied with the bind pose inverse, so they can be used
+    // directly to transform each vertex. They are only recalculated once per Update(),
+    // and are shared by all meshes (and render passes) of the instance.
+    static const dmArray<Matrix4>& GetSkinMatrices(HRigContext context, HRigInstance instance)
+    {
+        dmArray<Matrix4>& skin_matrices = instance->m_SkinMatrices;
+        uint32_t bone_count = GetBoneCount(instance);
+        if (instance->m_SkinMatricesUpdate == context->m_UpdateCount && skin_matrices.Size() == bone_count)
+        {
+            return skin_matrices;
+        }
+        instance->m_SkinMatricesUpdate = context->m_UpdateCount;
+
+        if (skin_matrices.Capacity() < bone_count)
+        {
+            skin_matrices.OffsetCapacity(bone_count - skin_matrices.Capacity());
+        }
+        skin_matrices.SetSize(bone_count);
+
+        if (bone_count)
+        {
+            PoseToMatrix(instance->m_Pose, skin_matrices);
+
+            const dmArray<RigBone>& bind_pose = *instance->m_BindPose;
+            for (uint32_t bi = 0; bi < bone_count; ++bi)
+            {
+                skin_matrices[bi] = skin_matrices[bi] * bind_pose[bi].m_ModelToLocal;
+            }
+        }
+        return skin_matrices;
+    }
+
+    static void DoAnimate(HRigContext context, RigInstance* instance, float dt, dmArray<RigEvent>& events)
     {
         // NOTE we previously checked for (!instance->m_Enabled || !instance->m_AddedToUpdate) here also
         RigPlayer* player = GetPlayer(instance);
@@ -500,6 +631,22 @@ namespace dmRig
         if (!player->m_Playing || !instance->m_Enabled || !player->m_Animation)
             return;
 
+        // A culled instance only advances its cursors, the pose is sampled from scratch once it's no longer culled
+        if (instance->m_Culled)
+        {
+            UpdateBlend(instance, dt);
+            float fade_rate = instance->m_Blending ? instance->m_BlendTimer / instance->m_BlendDuration : 1.0f;
+            for (uint32_t pi = 0; pi < 2; ++pi)
+            {
+                RigPlayer* p = &instance->m_Players[pi];
+                if (p == player)
+                    UpdatePlayer(instance, p, dt, fade_rate, events);
+                else if (instance->m_Blending)
+                    UpdatePlayer(instance, p, dt, 1.0f - fade_rate, events);
+            }
+            return;
+        }
+
         const dmRigDDF::Skeleton* skeleton = instance->m_Skeleton;
 
         dmArray<BonePose>& pose = instance->m_Pose;
@@ -531,7 +678,7 @@ namespace dmRig
                     blend_weight = 1.0f - fade_rate;
                 }
 
-                UpdatePlayer(instance, p, dt, blend_weight);
+                UpdatePlayer(instance, p, dt, blend_weight, events);
                 ApplyAnimation(instance, p, pose, ik_animation, alpha);
                 if (player == p)
                 {
@@ -545,7 +692,7 @@ namespace dmRig
         }
         else
         {
-            UpdatePlayer(instance, player, dt, 1.0f);
+            UpdatePlayer(instance, player, dt, 1.0f, events);
             ApplyAnimation(instance, player, pose, ik_animation, 1.0f);
         }
 
@@ -588,7 +735,7 @@ namespace dmRig
     {
             // If pose is empty, there are no bones to update
             dmArray<BonePose>& pose = instance->m_Pose;
-            if (pose.Empty())
+            if (pose.Empty() || instance->m_Culled)
                 return false;
 
             // Notify any listener that the pose has been recalculated
@@ -604,6 +751,9 @@ namespace dmRig
     {
         DM_PROFILE("RigUpdate");
 
+        if (++context->m_UpdateCount == 0)
+            context->m_UpdateCount = 1; // 0 means never calculated
+
         Animate(context, dt);
 
         return PostUpdate(context);
@@ -635,6 +785,8 @@ namespace dmRig
         instance->m_IKAnimation.SetCapacity(skeleton->m_Iks.m_Count);
         instance->m_IKAnimation.SetSize(skeleton->m_Iks.m_Count);
 
+        instance->m_SkinMatricesUpdate = 0;
+
         return dmRig::RESULT_OK;
     }
 
@@ -776,7 +928,16 @@ namespace dmRig
         return vertex_count;
     }
 
-    static void GenerateNormalData(const dmRigDDF::Mesh* mesh, const Matrix4& normal_matrix, const dmArray<Matrix4>& pose_matrices, float* normals_buffer, float* tangents_buffer)
+    template <typename T>
+    static void EnsureSize(T& array, uint32_t size)
+    {
+        if (array.Capacity() < size) {
+            array.OffsetCapacity(size - array.Capacity());
+        }
+        array.SetSize(size);
+    }
+
+    static void GenerateNormalData(const dmRigDDF::Mesh* mesh, const Matrix4& normal_matrix, const dmArray<Matrix4>& pose_matrices, dmArray<Matrix4>& scratch_matrices, float* normals_buffer, float* tangents_buffer)
     {
         const float* normals_in = mesh->m_Normals.m_Data;
         bool has_tangents = mesh->m_Tangents.m_Count > 0;
@@ -818,16 +979,25 @@ namespace dmRig
         }
 
         // Skinned data
+        // The normal matrix is folded into the skin matrices, so each vertex needs no further transform
+        const uint32_t bone_count = pose_matrices.Size();
+        EnsureSize(scratch_matrices, bone_count);
+        for (uint32_t bi = 0; bi < bone_count; ++bi)
+        {
+            scratch_matrices[bi] = normal_matrix * pose_matrices[bi];
+        }
+        const Matrix4* matrices = scratch_matrices.Begin();
+
         const uint32_t* indices = mesh->m_BoneIndices.m_Data;
         const float* weights = mesh->m_Weights.m_Data;
         for (uint32_t i = 0; i < vertex_count; ++i)
         {
             const Vector3 normal_in(normals_in[i*3+0], normals_in[i*3+1], normals_in[i*3+2]);
-            Vector4 normal_out(0.0f, 0.0f, 0.0f, 0.0f);
+            normal = Vector4(0.0f, 0.0f, 0.0f, 0.0f);
 
             const Vector3 tangent_in = has_tangents ? Vector3(tangents_in[i*4+0], tangents_in[i*4+1], tangents_in[i*4+2]) : Vector3(0,0,0);
             const float tangent_handedness = has_tangents ? tangents_in[i*4+3] : 0.0f;
-            Vector4 tangent_out(0.0f, 0.0f, 0.0f, 0.0f);
+            tangent = Vector4(0.0f, 0.0f, 0.0f, 0.0f);
 
             const uint32_t bi_offset = i * 4;
             const uint32_t* bone_indices = &indices[bi_offset];
@@ -835,26 +1005,25 @@ namespace dmRig
 
             if (bone_weights[0])
             {
-                normal_out += (pose_matrices[bone_indices[0]] * normal_in) * bone_weights[0];
-                tangent_out += (pose_matrices[bone_indices[0]] * tangent_in) * bone_weights[0];
+                normal += (matrices[bone_indices[0]] * normal_in) * bone_weights[0];
+                tangent += (matrices[bone_indices[0]] * tangent_in) * bone_weights[0];
                 if (bone_weights[1])
                 {
-                    normal_out += (pose_matrices[bone_indices[1]] * normal_in) * bone_weights[1];
-                    tangent_out += (pose_matrices[bone_indices[1]] * tangent_in) * bone_weights[1];
+                    normal += (matrices[bone_indices[1]] * normal_in) * bone_weights[1];
+                    tangent += (matrices[bone_indices[1]] * tangent_in) * bone_weights[1];
                     if (bone_weights[2])
                     {
-                        normal_out += (pose_matrices[bone_indices[2]] * normal_in) * bone_weights[2];
-                        tangent_out += (pose_matrices[bone_indices[2]] * tangent_in) * bone_weights[2];
+                        normal += (matrices[bone_indices[2]] * normal_in) * bone_weights[2];
+                        tangent += (matrices[bone_indices[2]] * tangent_in) * bone_weights[2];
                         if (bone_weights[3])
                         {
-                            normal_out += (pose_matrices[bone_indices[3]] * normal_in) * bone_weights[3];
-                            tangent_out += (pose_matrices[bone_indices[3]] * tangent_in) * bone_weights[3];
+                            normal += (matrices[bone_indices[3]] * normal_in) * bone_weights[3];
+                            tangent += (matrices[bone_indices[3]] * tangent_in) * bone_weights[3];
                         }
                     }
                 }
             }
 
-            normal = normal_matrix * normal_out.getXYZ();
             if (lengthSqr(normal) > 0.0f) {
                 normalize(normal);
             }
@@ -864,7 +1033,6 @@ namespace dmRig
 
             if (has_tangents)
             {
-                tangent = normal_matrix * tangent_out;
                 if (lengthSqr(tangent) > 0.0f) {
                     normalize(tangent);
                 }
@@ -876,7 +1044,7 @@ namespace dmRig
         }
     }
 
-    static void GeneratePositionData(const dmRigDDF::Mesh* mesh, const Matrix4& model_matrix, const dmArray<Matrix4>& pose_matrices, float* out_buffer_world, float* out_buffer_local)
+    static void GeneratePositionData(const dmRigDDF::Mesh* mesh, const Matrix4& model_matrix, const dmArray<Matrix4>& pose_matrices, dmArray<Matrix4>& scratch_matrices, float* out_buffer_world, float* out_buffer_local)
     {
         const float* positions = mesh->m_Positions.m_Data;
         const uint32_t vertex_count = mesh->m_Positions.m_Count / 3;
@@ -908,6 +1076,22 @@ namespace dmRig
             return;
         }
 
+        // When only world space positions are needed, the model matrix is folded into the skin matrices,
+        // so each vertex needs no further transform
+        const Matrix4* matrices = pose_matrices.Begin();
+        Vector4 model_translation(0.0f, 0.0f, 0.0f, 0.0f);
+        if (!out_buffer_local)
+        {
+            const uint32_t bone_count = pose_matrices.Size();
+            EnsureSize(scratch_matrices, bone_count);
+            for (uint32_t bi = 0; bi < bone_count; ++bi)
+            {
+                scratch_matrices[bi] = model_matrix * pose_matrices[bi];
+            }
+            matrices = scratch_matrices.Begin();
+            model_translation = Vector4(model_matrix.getTranslation(), 0.0f);
+        }
+
         const uint32_t* indices = mesh->m_BoneIndices.m_Data;
         const float* weights = mesh->m_Weights.m_Data;
         for (uint32_t i = 0; i < vertex_count; ++i)
@@ -919,27 +1103,42 @@ namespace dmRig
             in_v.setW(1.0f);
 
             Vector4 out_p(0.0f, 0.0f, 0.0f, 0.0f);
+            float weight_sum = 0.0f;
             const uint32_t bi_offset = i * 4;
             const uint32_t* bone_indices = &indices[bi_offset];
             const float* bone_weights = &weights[bi_offset];
 
             if(bone_weights[0])
             {
-                out_p += pose_matrices[bone_indices[0]] * in_v * bone_weights[0];
+                out_p += matrices[bone_indices[0]] * in_v * bone_weights[0];
+                weight_sum += bone_weights[0];
                 if(bone_weights[1])
                 {
-                    out_p += pose_matrices[bone_indices[1]] * in_v * bone_weights[1];
+                    out_p += matrices[bone_indices[1]] * in_v * bone_weights[1];
+                    weight_sum += bone_weights[1];
                     if(bone_weights[2])
                     {
-                        out_p += pose_matrices[bone_indices[2]] * in_v * bone_weights[2];
+                        out_p += matrices[bone_indices[2]] * in_v * bone_weights[2];
+                        weight_sum += bone_weights[2];
                         if(bone_weights[3])
                         {
-                            out_p += pose_matrices[bone_indices[3]] * in_v * bone_weights[3];
+                            out_p += matrices[bone_indices[3]] * in_v * bone_weights[3];
+                            weight_sum += bone_weights[3];
                         }
                     }
                 }
             }
 
+            if (!out_buffer_local)
+            {
+                // The folded matrices add the model translation once per weight, so make it add up to exactly one
+                out_p += model_translation * (1.0f - weight_sum);
+                *out_buffer_world++ = out_p.getX();
+                *out_buffer_world++ = out_p.getY();
+                *out_buffer_world++ = out_p.getZ();
+                continue;
+            }
+
             if (out_buffer_world)
             {
                 v = model_matrix * Point3(out_p.getX(), out_p.getY(), out_p.getZ());
@@ -947,12 +1146,9 @@ namespace dmRig
                 *out_buffer_world++ = v[1];
                 *out_buffer_world++ = v[2];
             }
-            if (out_buffer_local)
-            {
-                *out_buffer_local++ = out_p.getX();
-                *out_buffer_local++ = out_p.getY();
-                *out_buffer_local++ = out_p.getZ();
-            }
+            *out_buffer_local++ = out_p.getX();
+            *out_buffer_local++ = out_p.getY();
+            *out_buffer_local++ = out_p.getZ();
         }
         return;
     }
@@ -1118,15 +1314,6 @@ namespace dmRig
         return out_write_ptr;
     }
 
-    template <typename T>
-    static void EnsureSize(T& array, uint32_t size)
-    {
-        if (array.Capacity() < size) {
-            array.OffsetCapacity(size - array.Capacity());
-        }
-        array.SetSize(size);
-    }
-
     uint8_t* GenerateVertexDataFromAttributes(dmRig::HRigContext context, dmRig::HRigInstance instance, dmRigDDF::Mesh* mesh, const dmVMath::Matrix4& world_matrix, const dmVMath::Matrix4& normal_matrix, const dmGraphics::VertexAttributeInfos* attribute_infos, uint32_t vertex_stride, uint8_t* vertex_data_out)
     {
         const dmRigDDF::Model* model = instance->m_Model;
@@ -1136,18 +1323,18 @@ namespace dmRig
             return vertex_data_out;
         }
 
-        dmArray<Matrix4>& pose_matrices   = context->m_ScratchPoseMatrixBuffer;
-        dmArray<Vector3>& positions_world = context->m_ScratchPositionBufferWorld;
-        dmArray<Vector3>& positions_local = context->m_ScratchPositionBufferLocal;
-        dmArray<Vector3>& normals         = context->m_ScratchNormalBuffer;
-        dmArray<Vector4>& tangents        = context->m_ScratchTangentBuffer;
+        dmArray<Matrix4>& scratch_matrices = context->m_ScratchPoseMatrixBuffer;
+        dmArray<Vector3>& positions_world  = context->m_ScratchPositionBufferWorld;
+        dmArray<Vector3>& positions_local  = context->m_ScratchPositionBufferLocal;
+        dmArray<Vector3>& normals          = context->m_ScratchNormalBuffer;
+        dmArray<Vector4>& tangents         = context->m_ScratchTangentBuffer;
 
-        uint32_t bone_count   = GetBoneCount(instance);
         uint32_t vertex_count = mesh->m_Positions.m_Count / 3;
 
         dmGraphics::VertexAttributeInfoMetadata meta_datas = dmGraphics::GetVertexAttributeInfosMetaData(*attribute_infos);
 
-        pose_matrices.SetSize(0);
+        // Needed by both positions and normals
+        const dmArray<Matrix4>& pose_matrices = GetSkinMatrices(context, instance);
 
         float* positions_buffer_world = 0;
         float* positions_buffer_local = 0;
@@ -1156,28 +1343,6 @@ namespace dmRig
 
         if (meta_datas.m_HasAttributeWorldPosition || meta_datas.m_HasAttributeLocalPosition)
         {
-            if (bone_count)
-            {
-                // Make sure pose scratch buffers have enough space
-                if (pose_matrices.Capacity() < bone_count)
-                {
-                    uint32_t size_offset = bone_count - pose_matrices.Capacity();
-                    pose_matrices.OffsetCapacity(size_offset);
-                }
-                pose_matrices.SetSize(bone_count);
-
-                PoseToMatrix(instance->m_Pose, pose_matrices);
-
-                // Premultiply pose matrices with the bind pose inverse so they
-                // can be directly be used to transform each vertex.
-                const dmArray<RigBone>& bind_pose = *instance->m_BindPose;
-                for (uint32_t bi = 0; bi < pose_matrices.Size(); ++bi)
-                {
-                    Matrix4& pose_matrix = pose_matrices[bi];
-                    pose_matrix = pose_matrix * bind_pose[bi].m_ModelToLocal;
-                }
-            }
-
             if (meta_datas.m_HasAttributeWorldPosition)
             {
                 EnsureSize(positions_world, vertex_count);
@@ -1189,7 +1354,7 @@ namespace dmRig
                 positions_buffer_local = (float*) positions_local.Begin();
             }
 
-            dmRig::GeneratePositionData(mesh, world_matrix, pose_matrices, positions_buffer_world, positions_buffer_local);
+            dmRig::GeneratePositionData(mesh, world_matrix, pose_matrices, scratch_matrices, positions_buffer_world, positions_buffer_local);
         }
         if (meta_datas.m_HasAttributeNormal && mesh->m_Normals.m_Count)
         {
@@ -1200,7 +1365,7 @@ namespace dmRig
 
             Matrix4 normal_matrix = Vectormath::Aos::inverse(world_matrix);
             normal_matrix = Vectormath::Aos::transpose(normal_matrix);
-            dmRig::GenerateNormalData(mesh, normal_matrix, pose_matrices, normals_buffer, tangents_buffer);
+            dmRig::GenerateNormalData(mesh, normal_matrix, pose_matrices, scratch_matrices, normals_buffer, tangents_buffer);
         }
 
         return WriteVertexDataByAttributes(mesh, positions_buffer_world, positions_buffer_local, normals_buffer, tangents_buffer, attribute_infos, vertex_stride, world_matrix, normal_matrix, vertex_data_out);
@@ -1216,35 +1381,13 @@ namespace dmRig
             return vertex_data_out;
         }
 
-        dmArray<Matrix4>& pose_matrices   = context->m_ScratchPoseMatrixBuffer;
-        dmArray<Vector3>& positions_world = context->m_ScratchPositionBufferWorld;
-        dmArray<Vector3>& normals         = context->m_ScratchNormalBuffer;
-        dmArray<Vector4>& tangents        = context->m_ScratchTangentBuffer;
+        dmArray<Matrix4>& scratch_matrices = context->m_ScratchPoseMatrixBuffer;
+        dmArray<Vector3>& positions_world  = context->m_ScratchPositionBufferWorld;
+        dmArray<Vector3>& normals          = context->m_ScratchNormalBuffer;
+        dmArray<Vector4>& tangents         = context->m_ScratchTangentBuffer;
 
-        // If the rig has bones, update the pose to be local-to-model
-        uint32_t bone_count = GetBoneCount(instance);
-        if (bone_count)
-        {
-            // Make sure pose scratch buffers have enough space
-            if (pose_matrices.Capacity() < bone_count) {
-                uint32_t size_offset = bone_count - pose_matrices.Capacity();
-                pose_matrices.OffsetCapacity(size_offset);
-            }
-            pose_matrices.SetSize(bone_count);
-
-            PoseToMatrix(instance->m_Pose, pose_matrices);
-
-            // Premultiply pose matrices with the bind pose inverse so they
-            // can be directly be used to transform each vertex.
-            const dmArray<RigBone>& bind_pose = *instance->m_BindPose;
-            for (uint32_t bi = 0; bi < pose_matrices.Size(); ++bi)
-            {
-                Matrix4& pose_matrix = pose_matrices[bi];
-                pose_matrix = pose_matrix * bind_pose[bi].m_ModelToLocal;
-            }
-        } else {
-            pose_matrices.SetSize(0);
-        }
+        // If the rig has bones, get the pose as local-to-model
+        const dmArray<Matrix4>& pose_matrices = GetSkinMatrices(context, instance);
 
         Matrix4 normal_matrix = dmVMath::Inverse(world_matrix);
         normal_matrix = dmVMath::Transpose(normal_matrix);
@@ -1262,11 +1405,11 @@ namespace dmRig
         float* tangents_buffer = (float*)tangents.Begin();
 
         // Transform the mesh data into world space
-        dmRig::GeneratePositionData(mesh, world_matrix, pose_matrices, positions_world_buffer, 0);
+        dmRig::GeneratePositionData(mesh, world_matrix, pose_matrices, scratch_matrices, positions_world_buffer, 0);
 
         if (mesh->m_Normals.m_Count)
         {
-            dmRig::GenerateNormalData(mesh, normal_matrix, pose_matrices, normals_buffer, tangents_buffer);
+            dmRig::GenerateNormalData(mesh, normal_matrix, pose_matrices, scratch_matrices, normals_buffer, tangents_buffer);
         }
 
         return WriteVertexData(mesh, positions_world_buffer, normals_buffer, tangents_buffer, vertex_data_out);
@@ -1293,6 +1436,16 @@ namespace dmRig
         instance->m_Enabled = enabled;
     }
 
+    void SetCulled(HRigInstance instance, bool culled)
+    {
+        instance->m_Culled = culled;
+    }
+
+    bool GetCulled(HRigInstance instance)
+    {
+        return instance->m_Culled;
+    }
+
     bool GetEnabled(HRigInstance instance)
     {
         return instance->m_Enabled;
@@ -1375,6 +1528,7 @@ namespace dmRig
         // If we're going to use memset, then we should explicitly clear pose and instance arrays.
         instance->m_Pose.SetCapacity(0);
         instance->m_IKTargets.SetCapacity(0);
+        instance->m_SkinMatrices.SetCapacity(0);
         delete instance;
         context->m_Instances.Free(index, true);
     }
@@ -16,5 +16,25 @@
 #define DM_RIG_H
 
 #include <dmsdk/rig/rig.h>
+#include <dlib/job_thread.h>
+
+namespace dmRig
+{
+    /**
+     * Set the job thread used to animate the rig instances in parallel
+     * @param context Rig context
+     * @param job_thread Job thread context, or 0 to animate everything on the calling thread
+     */
+    void SetJobThread(HRigContext context, dmJobThread::HContext job_thread);
+
+    /**
+     * Set if the instance is culled (e.g. off screen). A culled instance only advances its animation
+     * cursors and sends its events, and its pose is sampled again once it is no longer culled.
+     * @param instance Rig instance
+     * @param culled true if the pose should not be updated
+     */
+    void SetCulled(HRigInstance instance, bool culled);
+    bool GetCulled(HRigInstance instance);
+}
 
 #endif // DM_RIG_H
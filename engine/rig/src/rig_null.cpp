@@ -24,6 +24,9 @@ namespace dmRig
     void DeleteContext(HRigContext context)
     { }
 
+    void SetJobThread(HRigContext context, dmJobThread::HContext job_thread)
+    { }
+
     Result PlayAnimation(HRigInstance instance, dmhash_t animation_id, dmRig::RigPlayback playback, float blend_duration, float offset, float playback_rate)
     {
         return dmRig::RESULT_OK;
@@ -109,6 +112,15 @@ namespace dmRig
         return true;
     }
 
+    void SetCulled(HRigInstance instance, bool culled)
+    {
+    }
+
+    bool GetCulled(HRigInstance instance)
+    {
+        return false;
+    }
+
     bool IsValid(HRigInstance instance)
     {
         return false;
@@ -77,6 +77,10 @@ namespace dmRig
         dmArray<IKAnimation>          m_IKAnimation;
         /// User IK constraint targets
         dmArray<IKTarget>             m_IKTargets;
+        /// Pose matrices premultiplied with the bind pose inverse, cached between Update() calls
+        dmArray<dmVMath::Matrix4>     m_SkinMatrices;
+        /// The context update count the skin matrices were calculated for (0 = never)
+        uint32_t                      m_SkinMatricesUpdate;
 
         const dmRigDDF::Model*        m_Model;      // Currently selected model
         uint32_t                      m_NumModels;
@@ -92,7 +96,9 @@ namespace dmRig
         uint8_t                       m_Blending : 1;
         uint8_t                       m_Enabled : 1;
         uint8_t                       m_DoRender : 1;
-        uint8_t                       : 4;
+        /// Only advance the animation cursors, the pose isn't sampled
+        uint8_t                       m_Culled : 1;
+        uint8_t                       : 3;
     };
 }
 
@@ -1360,6 +1360,30 @@ TEST_F(RigInstanceTest, PoseAnim)
     ASSERT_EQ(Quat::identity(), pose[1].m_World.GetRotation());
 }
 
+TEST_F(RigInstanceTest, PoseAnimCulled)
+{
+    ASSERT_EQ(dmRig::RESULT_OK, dmRig::Update(m_Context, 1.0f));
+    ASSERT_EQ(dmRig::RESULT_OK, dmRig::PlayAnimation(m_Instance, dmHashString64("valid"), dmRig::PLAYBACK_LOOP_FORWARD, 0.0f, 0.0f, 1.0f));
+
+    dmArray<dmRig::BonePose>& pose = *dmRig::GetPose(m_Instance);
+
+    // The cursor advances, but the pose stays at sample 0
+    dmRig::SetCulled(m_Instance, true);
+    ASSERT_TRUE(dmRig::GetCulled(m_Instance));
+    ASSERT_EQ(dmRig::RESULT_OK, dmRig::Update(m_Context, 1.0f));
+    ASSERT_NEAR(1.0f, dmRig::GetCursor(m_Instance, false), RIG_EPSILON_FLOAT);
+    ASSERT_EQ(Vector3(1.0f, 0.0f, 0.0f), pose[1].m_World.GetTranslation());
+    ASSERT_EQ(Quat::identity(), pose[1].m_World.GetRotation());
+
+    // sample 2, sampled directly once no longer culled
+    dmRig::SetCulled(m_Instance, false);
+    ASSERT_EQ(dmRig::RESULT_OK, dmRig::Update(m_Context, 1.0f));
+    ASSERT_EQ(Vector3(0.0f, 0.0f, 0.0f), pose[0].m_World.GetTranslation());
+    ASSERT_EQ(Quat::rotationZ((float)M_PI / 2.0f), pose[0].m_World.GetRotation());
+    ASSERT_EQ(Vector3(0.0f, 1.0f, 0.0f), pose[1].m_World.GetTranslation());
+    ASSERT_EQ(Quat::rotationZ((float)M_PI / 2.0f), pose[1].m_World.GetRotation());
+}
+
 TEST_F(RigInstanceTest, PoseAnimCancel)
 {
     ASSERT_EQ(dmRig::RESULT_OK, dmRig::Update(m_Context, 1.0f));
@@ -1465,6 +1489,33 @@ TEST_F(RigInstanceTest, GenerateNormalData)
     ASSERT_VERT_NORM(n_down, data[2]); // v2
 }
 
+// The skin matrices are cached between updates, and the world matrix is folded into them
+TEST_F(RigInstanceTest, GenerateWorldPositionData)
+{
+    ASSERT_EQ(dmRig::RESULT_OK, dmRig::PlayAnimation(m_Instance, dmHashString64("valid"), dmRig::PLAYBACK_LOOP_FORWARD, 0.0f, 0.0f, 1.0f));
+    ASSERT_EQ(dmRig::RESULT_OK, dmRig::Update(m_Context, 1.0f));
+    dmRig::RigModelVertex data[4];
+    dmRig::RigModelVertex moved_data[4];
+    dmRig::RigModelVertex* data_end = data + 4;
+    dmRig::RigModelVertex* moved_data_end = moved_data + 4;
+
+    Vector3 offset(1.0f, 2.0f, 3.0f);
+    Matrix4 world = Matrix4::translation(offset);
+
+    for (int sample = 0; sample < 2; ++sample)
+    {
+        ASSERT_EQ(data_end, dmRig::GenerateVertexData(m_Context, m_Instance, m_FirstMesh, Matrix4::identity(), data));
+        ASSERT_EQ(moved_data_end, dmRig::GenerateVertexData(m_Context, m_Instance, m_FirstMesh, world, moved_data));
+        for (int i = 0; i < 3; ++i)
+        {
+            ASSERT_VERT_POS(Vector3(data[i].pos[0], data[i].pos[1], data[i].pos[2]) + offset, moved_data[i]);
+            ASSERT_VERT_NORM(Vector3(data[i].normal[0], data[i].normal[1], data[i].normal[2]), moved_data[i]);
+        }
+
+        ASSERT_EQ(dmRig::RESULT_OK, dmRig::Update(m_Context, 1.0f));
+    }
+}
+
 TEST_F(RigInstanceTest, SetModel)
 {
     ASSERT_EQ(dmRig::RESULT_OK, dmRig::SetModel(m_Instance, dmHashString64("test")));
@@ -1880,6 +1931,84 @@ TEST_F(RigContextTest, DEF_3121)
     DeleteRigData(mesh_set, skeleton, animation_set);
 }
 
+static void CountCompletedEventCallback(dmRig::RigEventType event_type, void* event_data, void* user_data1, void* user_data2)
+{
+    if (event_type == dmRig::RIG_EVENT_TYPE_COMPLETED)
+    {
+        (*(uint32_t*)user_data1)++;
+    }
+}
+
+// Animates the instances on the job thread, and the events must still be sent on the calling thread
+TEST(RigJobThread, AnimateParallel)
+{
+    const uint32_t instance_count = 64;
+
+    dmJobThread::JobThreadCreationParams job_thread_params;
+    job_thread_params.m_ThreadNames[0] = "test_rig_worker";
+    job_thread_params.m_ThreadCount = 2;
+    dmJobThread::HContext job_thread = dmJobThread::Create(job_thread_params);
+
+    dmRig::HRigContext context = 0x0;
+    dmRig::NewContextParams params = {0};
+    params.m_MaxRigInstanceCount = instance_count;
+    ASSERT_EQ(dmRig::RESULT_OK, dmRig::NewContext(params, &context));
+    dmRig::SetJobThread(context, job_thread);
+
+    dmRigDDF::Skeleton*     skeleton      = new dmRigDDF::Skeleton();
+    dmRigDDF::MeshSet*      mesh_set      = new dmRigDDF::MeshSet();
+    dmRigDDF::AnimationSet* animation_set = new dmRigDDF::AnimationSet();
+    dmArray<dmRig::RigBone> bind_pose;
+    dmHashTable64<uint32_t> bone_indices;
+    SetUpSimpleRig(bind_pose, bone_indices, skeleton, mesh_set, animation_set);
+
+    uint32_t completed_count = 0;
+
+    dmRig::InstanceCreateParams create_params = {0};
+    create_params.m_BindPose         = &bind_pose;
+    create_params.m_BoneIndices      = &bone_indices;
+    create_params.m_Skeleton         = skeleton;
+    create_params.m_MeshSet          = mesh_set;
+    create_params.m_AnimationSet     = animation_set;
+    create_params.m_ModelId          = dmHashString64((const char*)"test");
+    create_params.m_DefaultAnimation = dmHashString64((const char*)"");
+    create_params.m_EventCallback    = CountCompletedEventCallback;
+    create_params.m_EventCBUserData1 = &completed_count;
+
+    dmRig::HRigInstance instances[instance_count];
+    for (uint32_t i = 0; i < instance_count; ++i)
+    {
+        ASSERT_EQ(dmRig::RESULT_OK, dmRig::InstanceCreate(context, create_params, &instances[i]));
+    }
+
+    ASSERT_EQ(dmRig::RESULT_OK, dmRig::Update(context, 1.0f));
+    for (uint32_t i = 0; i < instance_count; ++i)
+    {
+        ASSERT_EQ(dmRig::RESULT_OK, dmRig::PlayAnimation(instances[i], dmHashString64("valid"), dmRig::PLAYBACK_ONCE_FORWARD, 0.0f, 0.0f, 1.0f));
+    }
+
+    // sample 1
+    ASSERT_EQ(dmRig::RESULT_OK, dmRig::Update(context, 1.0f));
+    for (uint32_t i = 0; i < instance_count; ++i)
+    {
+        dmArray<dmRig::BonePose>& pose = *dmRig::GetPose(instances[i]);
+        ASSERT_EQ(Vector3(1.0f, 0.0f, 0.0f), pose[1].m_World.GetTranslation());
+        ASSERT_EQ(Quat::rotationZ((float)M_PI / 2.0f), pose[1].m_World.GetRotation());
+    }
+    ASSERT_EQ(0u, completed_count);
+
+    ASSERT_EQ(dmRig::RESULT_OK, dmRig::Update(context, 10.0f));
+    ASSERT_EQ(instance_count, completed_count);
+
+    for (uint32_t i = 0; i < instance_count; ++i)
+    {
+        ASSERT_EQ(dmRig::RESULT_OK, dmRig::InstanceDestroy(context, instances[i]));
+    }
+    DeleteRigData(mesh_set, skeleton, animation_set);
+    dmRig::DeleteContext(context);
+    dmJobThread::Destroy(job_thread);
+}
+
 #undef ASSERT_VERT_POS
 #undef ASSERT_VERT_NORM
 #undef ASSERT_VERT_UV
@@ -26,6 +26,7 @@
 #include <dlib/sys.h>
 #include <dlib/uri.h>
 #include <dlib/math.h>
+#include <dlib/path.h>
 #include <ddf/ddf.h>
 #include "http_ddf.h"
 #include "http_service.h"
@@ -54,6 +55,10 @@ namespace dmHttpService
         dmMessage::URL        m_CurrentRequesterURL;
         dmHttpDDF::HttpRequest*   m_Request;
         const char*           m_Filepath;
+        char                  m_TmpFilepath[DMPATH_MAX_PATH];
+        FILE*                 m_File;
+        uint32_t              m_BytesReceived;
+        bool                  m_FileError;
         int                   m_Status;
         uintptr_t             m_ResponseUserData1;
         uintptr_t             m_ResponseUserData2;
@@ -101,6 +106,70 @@ namespace dmHttpService
         h.Push('\n');
     }
 
+    static void CloseResponseFile(Worker* worker)
+    {
+        if (worker->m_File)
+        {
+            fclose(worker->m_File);
+            worker->m_File = 0;
+        }
+    }
+
+    // Write the response body straight to a temporary file next to the requested path,
+    // rather than keeping the whole body in memory
+    static void WriteResponseFile(Worker* worker, const void* content_data, uint32_t content_data_size)
+    {
+        if (worker->m_FileError)
+            return;
+
+        if (worker->m_File == 0)
+        {
+            worker->m_File = fopen(worker->m_TmpFilepath, "wb");
+            if (worker->m_File == 0)
+            {
+                dmLogError("Failed to open '%s' for writing", worker->m_TmpFilepath);
+                worker->m_FileError = true;
+                return;
+            }
+        }
+
+        if (content_data_size > 0 && fwrite(content_data, 1, content_data_size, worker->m_File) != content_data_size)
+        {
+            dmLogError("Failed to write '%u' bytes to '%s'", content_data_size, worker->m_TmpFilepath);
+            worker->m_FileError = true;
+        }
+    }
+
+    // Moves the file in place if the request was successful, otherwise removes it.
+    // The path is only written for successful requests, so the result is only relevant for those
+    static StreamResult FinishResponseFile(Worker* worker, bool success)
+    {
+        if (!success)
+        {
+            CloseResponseFile(worker);
+            dmSys::Unlink(worker->m_TmpFilepath);
+            return STREAM_RESULT_OK;
+        }
+
+        // Make sure we produce a file even if the response body was empty
+        WriteResponseFile(worker, 0, 0);
+        CloseResponseFile(worker);
+
+        if (worker->m_FileError)
+        {
+            dmSys::Unlink(worker->m_TmpFilepath);
+            return STREAM_RESULT_IO_ERROR;
+        }
+
+        if (dmSys::RESULT_OK != dmSys::Rename(worker->m_Filepath, worker->m_TmpFilepath))
+        {
+            dmLogError("Failed to rename '%s' to '%s'", worker->m_TmpFilepath, worker->m_Filepath);
+            dmSys::Unlink(worker->m_TmpFilepath);
+            return STREAM_RESULT_IO_ERROR;
+        }
+        return STREAM_RESULT_OK;
+    }
+
     void HttpContent(dmHttpClient::HResponse response, void* user_data, int status_code, const void* content_data, uint32_t content_data_size, int32_t content_length, const char* method)
     {
         Worker* worker = (Worker*) user_data;
@@ -110,22 +179,38 @@ namespace dmHttpService
 
         if (!method_is_head && !content_data && !content_data_size)
         {
+            // The request is restarted, discard what we've received so far
             r.SetSize(0);
+            worker->m_BytesReceived = 0;
+            worker->m_FileError = false;
+            CloseResponseFile(worker);
             return;
         }
 
         uint32_t bytes_received = 0;
         if (!method_is_head)
         {
-            uint32_t resize_to = (uint32_t) dmMath::Max((int32_t) content_data_size, content_length);
-
-            if (r.Capacity() < resize_to)
+            if (worker->m_Filepath)
             {
-                r.SetCapacity(resize_to);
+                // The file is only written for successful requests
+                if (status_code == 200)
+                {
+                    WriteResponseFile(worker, content_data, content_data_size);
+                }
             }
+            else
+            {
+                uint32_t resize_to = (uint32_t) dmMath::Max((int32_t) content_data_size, content_length);
+
+                if (r.Capacity() < resize_to)
+                {
+                    r.SetCapacity(resize_to);
+                }
 
-            r.PushArray((char*) content_data, content_data_size);
-            bytes_received = r.Size();
+                r.PushArray((char*) content_data, content_data_size);
+            }
+            worker->m_BytesReceived += content_data_size;
+            bytes_received = worker->m_BytesReceived;
         }
 
         if (worker->m_ReportProgress && (method_is_head || content_data_size > 0))
@@ -216,8 +301,15 @@ namespace dmHttpService
 
         resp.m_Headers = (uint64_t) malloc(headers_length);
         memcpy((void*) resp.m_Headers, headers, headers_length);
-        resp.m_Response = (uint64_t) malloc(response_length);
-        memcpy((void*) resp.m_Response, response, response_length);
+        if (response)
+        {
+            resp.m_Response = (uint64_t) malloc(response_length);
+            memcpy((void*) resp.m_Response, response, response_length);
+        }
+        else
+        {
+            resp.m_Response = 0;
+        }
         resp.m_Path = filepath;
 
         if (dmMessage::RESULT_OK != dmMessage::Post(0, requester, dmHttpDDF::HttpResponse::m_DDFHash, userdata1, userdata2, (uintptr_t) dmHttpDDF::HttpResponse::m_DDFDescriptor, &resp, sizeof(resp), MessageDestroyCallback) )
@@ -268,10 +360,22 @@ namespace dmHttpService
         }
 
         worker->m_Response.SetSize(0);
-        worker->m_Response.SetCapacity(DEFAULT_RESPONSE_BUFFER_SIZE);
         worker->m_Headers.SetSize(0);
         worker->m_Headers.SetCapacity(DEFAULT_HEADER_BUFFER_SIZE);
         worker->m_Filepath = request->m_Path;
+        worker->m_BytesReceived = 0;
+        worker->m_FileError = false;
+        if (worker->m_Filepath)
+        {
+            dmStrlCpy(worker->m_TmpFilepath, worker->m_Filepath, sizeof(worker->m_TmpFilepath));
+            dmStrlCat(worker->m_TmpFilepath, "._httptmp", sizeof(worker->m_TmpFilepath));
+            // The body goes to the file, so we release any large buffer from a previous request
+            worker->m_Response.SetCapacity(0);
+        }
+        else
+        {
+            worker->m_Response.SetCapacity(DEFAULT_RESPONSE_BUFFER_SIZE);
+        }
 
         if (request->m_ReportProgress)
         {
@@ -288,13 +392,22 @@ namespace dmHttpService
             dmHttpClient::SetOptionInt(worker->m_Client, dmHttpClient::OPTION_REQUEST_CHUNKED_TRANSFER, request->m_ChunkedTransfer);
 
             dmHttpClient::Result r = dmHttpClient::Request(worker->m_Client, request->m_Method, url.m_Path);
+            bool success = r == dmHttpClient::RESULT_OK || r == dmHttpClient::RESULT_NOT_200_OK;
+
+            const char* response = worker->m_Response.Begin();
+            uint32_t response_length = worker->m_Response.Size();
+            if (worker->m_Filepath)
+            {
+                response = 0;
+                response_length = FinishResponseFile(worker, success && worker->m_Status == 200);
+            }
 
-            if (r == dmHttpClient::RESULT_OK || r == dmHttpClient::RESULT_NOT_200_OK) {
-                SendResponse(requester, userdata1, userdata2, worker->m_Status, worker->m_Headers.Begin(), worker->m_Headers.Size(), worker->m_Response.Begin(), worker->m_Response.Size(), worker->m_Filepath);
+            if (success) {
+                SendResponse(requester, userdata1, userdata2, worker->m_Status, worker->m_Headers.Begin(), worker->m_Headers.Size(), response, response_length, worker->m_Filepath);
             } else {
                 // TODO: Error codes to lua?
                 dmLogError("HTTP request to '%s' failed (http result: %d  socket result: %d)", request->m_Url, r, GetLastSocketResult(worker->m_Client));
-                SendResponse(requester, userdata1, userdata2, 0, worker->m_Headers.Begin(), worker->m_Headers.Size(), worker->m_Response.Begin(), worker->m_Response.Size(), worker->m_Filepath);
+                SendResponse(requester, userdata1, userdata2, 0, worker->m_Headers.Begin(), worker->m_Headers.Size(), response, response_length, worker->m_Filepath);
             }
         } else {
             // TODO: Error codes to lua?
@@ -447,6 +560,8 @@ namespace dmHttpService
             worker->m_CacheFlusher = i == 0 && worker->m_Service->m_HttpCache != 0;
             worker->m_Run = true;
             worker->m_Canceled = 0;
+            worker->m_File = 0;
+            worker->m_FileError = false;
             service->m_Workers.Push(worker);
 
             dmThread::Thread t = dmThread::New(&Loop, THREAD_STACK_SIZE, worker, "http");
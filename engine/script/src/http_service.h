@@ -21,6 +21,16 @@ namespace dmHttpService
 {
     typedef struct HttpService* HHttpService;
 
+    /**
+     * When a request has a path, the workers write the response body directly to the file.
+     * The response message then has a null m_Response, and m_ResponseLength holds the StreamResult.
+     */
+    enum StreamResult
+    {
+        STREAM_RESULT_OK        = 0,
+        STREAM_RESULT_IO_ERROR  = 1,
+    };
+
     typedef void (*ReportProgressCallback)(dmHttpDDF::HttpRequestProgress* msg, dmMessage::URL* url, uintptr_t user_data);
 
     struct Params
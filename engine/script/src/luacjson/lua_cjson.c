@@ -1145,6 +1145,30 @@ static void json_set_token_error(json_token_t *token, json_parse_t *json,
     token->value.string = errtype;
 }
 
+// DEFOLD
+#define JSON_SWAR_ONES  0x0101010101010101ULL
+#define JSON_SWAR_HIGHS 0x8080808080808080ULL
+#define JSON_SWAR_HAS_ZERO(v) (((v) - JSON_SWAR_ONES) & ~(v) & JSON_SWAR_HIGHS)
+
+/* Returns a pointer to the first '"', '\\' or '\0' at or after p */
+static const char *json_scan_string(const char *p, const char *end)
+{
+    const uint64_t quotes = JSON_SWAR_ONES * (unsigned char)'"';
+    const uint64_t backslashes = JSON_SWAR_ONES * (unsigned char)'\\';
+
+    while (end - p >= 8) {
+        uint64_t v;
+        memcpy(&v, p, sizeof(v));
+        if (JSON_SWAR_HAS_ZERO(v) | JSON_SWAR_HAS_ZERO(v ^ quotes) | JSON_SWAR_HAS_ZERO(v ^ backslashes))
+            break;
+        p += 8;
+    }
+    while (*p != '"' && *p != '\\' && *p)
+        p++;
+    return p;
+}
+// END DEFOLD
+
 static void json_next_string_token(json_parse_t *json, json_token_t *token)
 {
     char *escape2char = json->cfg->escape2char;
@@ -1162,6 +1186,25 @@ static void json_next_string_token(json_parse_t *json, json_token_t *token)
      */
     strbuf_reset(json->tmp);
 
+    // DEFOLD
+    // Scan ahead for the closing quote, eight bytes at a time. Strings without escapes
+    // are returned as a pointer into the json data, skipping the copy to json->tmp
+    {
+        const char *start = json->ptr;
+        const char *p = json_scan_string(start, json->data_end);
+        if (*p == '"') {
+            json->ptr = p + 1;
+            token->type = T_STRING;
+            token->value.string = start;
+            token->string_len = (int)(p - start);
+            return;
+        }
+        /* Escape sequence or end of data, copy the plain prefix and continue below */
+        strbuf_append_mem_unsafe(json->tmp, start, (int)(p - start));
+        json->ptr = p;
+    }
+    // END DEFOLD
+
     while ((ch = *json->ptr) != '"') {
         if (!ch) {
             /* Premature end of the string */
@@ -19,6 +19,7 @@
 #include <dlib/math.h>
 #include <dlib/pprint.h>
 #include <dlib/profile.h>
+#include <dlib/time.h>
 
 #include "script_private.h"
 #include "script_hash.h"
@@ -84,6 +85,8 @@ namespace dmScript
         context->m_GraphicsContext = params.m_GraphicsContext;
         context->m_LuaState = lua_open();
         context->m_ContextTableRef = LUA_NOREF;
+        context->m_ChunkCacheRef = LUA_NOREF;
+        context->m_ChunkCacheSize = 0;
         return context;
     }
 
@@ -206,6 +209,10 @@ namespace dmScript
         lua_newtable(L);
         context->m_ContextTableRef = Ref(L, LUA_REGISTRYINDEX);
 
+        lua_newtable(L);
+        context->m_ChunkCacheRef = Ref(L, LUA_REGISTRYINDEX);
+        context->m_ChunkCacheSize = 0;
+
         InitializeTimer(context);
         InitializeExtensions(context);
 
@@ -256,6 +263,8 @@ namespace dmScript
         lua_pop(L, 1);
 
         Unref(L, LUA_REGISTRYINDEX, context->m_ContextTableRef);
+        Unref(L, LUA_REGISTRYINDEX, context->m_ChunkCacheRef);
+        context->m_ChunkCacheRef = LUA_NOREF;
     }
 
     lua_State* GetLuaState(HContext context)
@@ -1392,12 +1401,10 @@ namespace dmScript
         return 1;
     }
 
-    static int PCallInternal(lua_State* L, int nargs, int nresult, int in_error_handler) {
-        lua_pushcfunction(L, BacktraceErrorHandler);
-        int err_index = lua_gettop(L) - nargs - 1;
-        lua_insert(L, err_index);
-        int result = lua_pcall(L, nargs, nresult, err_index);
-        lua_remove(L, err_index);
+    static int PCallInternal(lua_State* L, int nargs, int nresult, int in_error_handler);
+
+    // Logs the error of a failed call (on top of the stack), and passes it on to the registered error handler
+    static void HandleCallError(lua_State* L, int result, int in_error_handler) {
         if (result == LUA_ERRMEM) {
             lua_pop(L, 1);  // Pop BacktraceErrorHandler since it will not be called on OOM
             dmLogError("Lua memory allocation error.");
@@ -1409,7 +1416,7 @@ namespace dmScript
             if (in_error_handler) {
                 dmLogError("In error handler: %s%s", lua_tostring(L, -2), lua_tostring(L, -1));
                 lua_pop(L, 3);
-                return result;
+                return;
             }
             // print before calling the error handler
             dmLogError("%s\n%s", lua_tostring(L, -2), lua_tostring(L, -1));
@@ -1431,6 +1438,15 @@ namespace dmScript
             }
             lua_pop(L, 4); // debug value, traceback, error, table
         }
+    }
+
+    static int PCallInternal(lua_State* L, int nargs, int nresult, int in_error_handler) {
+        lua_pushcfunction(L, BacktraceErrorHandler);
+        int err_index = lua_gettop(L) - nargs - 1;
+        lua_insert(L, err_index);
+        int result = lua_pcall(L, nargs, nresult, err_index);
+        lua_remove(L, err_index);
+        HandleCallError(L, result, in_error_handler);
         return result;
     }
 
@@ -1438,6 +1454,16 @@ namespace dmScript
         return PCallInternal(L, nargs, nresult, 0);
     }
 
+    void PushErrorHandler(lua_State* L) {
+        lua_pushcfunction(L, BacktraceErrorHandler);
+    }
+
+    int PCallWithErrorHandler(lua_State* L, int nargs, int nresult, int err_index) {
+        int result = lua_pcall(L, nargs, nresult, err_index);
+        HandleCallError(L, result, 0);
+        return result;
+    }
+
     int Ref(lua_State* L, int table)
     {
         ++g_LuaReferenceCount;
@@ -1473,6 +1499,48 @@ namespace dmScript
         return (uint32_t)lua_gc(L, LUA_GCCOUNT, 0);
     }
 
+    void SetLuaGCParams(lua_State* L, int pause, int step_mul)
+    {
+        if (pause > 0)
+            lua_gc(L, LUA_GCSETPAUSE, pause);
+        if (step_mul > 0)
+            lua_gc(L, LUA_GCSETSTEPMUL, step_mul);
+    }
+
+    uint32_t StepLuaGC(lua_State* L, uint64_t budget_us)
+    {
+        uint64_t start = dmTime::GetTime();
+        uint32_t steps = 0;
+        do
+        {
+            ++steps;
+            if (lua_gc(L, LUA_GCSTEP, 0))
+                break; // the cycle finished, leave the rest for the next frame
+        } while ((dmTime::GetTime() - start) < budget_us);
+        return steps;
+    }
+
+    uint32_t GetRandomSeed(lua_State* L)
+    {
+        DM_LUA_STACK_CHECK(L, 0);
+        lua_getglobal(L, RANDOM_SEED);
+        uint32_t* seed = (uint32_t*) lua_touserdata(L, -1);
+        lua_pop(L, 1);
+        return seed ? *seed : 0;
+    }
+
+    void SetRandomSeed(lua_State* L, uint32_t seed)
+    {
+        DM_LUA_STACK_CHECK(L, 0);
+        lua_getglobal(L, RANDOM_SEED);
+        uint32_t* current_seed = (uint32_t*) lua_touserdata(L, -1);
+        lua_pop(L, 1);
+        if (current_seed)
+        {
+            *current_seed = seed;
+        }
+    }
+
     LuaStackCheck::LuaStackCheck(lua_State* L, int diff, const char* filename, int linenumber) : m_L(L), m_Filename(filename), m_Linenumber(linenumber), m_Top(lua_gettop(L)), m_Diff(diff)
     {
         if (!(m_Diff >= -m_Top)) {
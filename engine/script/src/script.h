@@ -514,6 +514,43 @@ namespace dmScript
      */
     uint32_t WriteLuaTracebackEntry(lua_Debug* entry, char* buffer, uint32_t buffer_size);
 
+    /**
+     * Start sampling the Lua call stacks, using a count hook. Any previous samples are discarded.
+     * The hook replaces any current hook until the sampling is stopped.
+     * @note With Lua 5.1, only coroutines created after the start are sampled. With LuaJIT, setting
+     *       the hook makes the VM run in the interpreter while sampling.
+     * @param L lua state
+     * @param instruction_count number of Lua VM instructions between two samples
+     */
+    void StartLuaSampling(lua_State* L, uint32_t instruction_count);
+
+    /**
+     * Stop sampling, and restore the previous hook. The samples are kept until the next start.
+     * @param L lua state
+     */
+    void StopLuaSampling(lua_State* L);
+
+    bool IsLuaSampling();
+
+    /**
+     * Get the total number of samples taken since the start
+     */
+    uint32_t GetLuaSampleCount();
+
+    /**
+     * Callback for IterateLuaSamples
+     * @param ctx user context
+     * @param stack the call stack from the outermost to the innermost function, separated by ";"
+     * @param count number of samples with this call stack
+     */
+    typedef void (*FLuaSampleCallback)(void* ctx, const char* stack, uint32_t count);
+
+    /**
+     * Iterate the unique call stacks. Each call stack together with its count is a line in the
+     * "folded stacks" format read by flame graph tools (e.g. flamegraph.pl or speedscope)
+     */
+    void IterateLuaSamples(FLuaSampleCallback callback, void* ctx);
+
     /**
      * Retrieve config file handle from the context
      * @param context script context
@@ -641,6 +678,33 @@ namespace dmScript
     */
     uint32_t GetLuaGCCount(lua_State* L);
 
+    /** Sets the garbage collector pause and step multiplier (see LUA_GCSETPAUSE and LUA_GCSETSTEPMUL)
+    * @param L lua state
+    * @param pause the pause in percent. 0 keeps the current value
+    * @param step_mul the step multiplier in percent. 0 keeps the current value
+    */
+    void SetLuaGCParams(lua_State* L, int pause, int step_mul);
+
+    /** Performs incremental garbage collection steps until the time budget is spent or a cycle completes
+    * @param L lua state
+    * @param budget_us the time budget (in microseconds)
+    * @return the number of steps performed
+    */
+    uint32_t StepLuaGC(lua_State* L, uint64_t budget_us);
+
+    /** Gets the current state of the math.random() generator
+    * @param L lua state
+    * @return the random seed state, or 0 if the math library isn't loaded
+    */
+    uint32_t GetRandomSeed(lua_State* L);
+
+    /** Sets the state of the math.random() generator, e.g. to replay a recorded session.
+    * Unlike math.randomseed(), the first value isn't discarded, so a value from GetRandomSeed() is restored as is.
+    * @param L lua state
+    * @param seed the random seed state
+    */
+    void SetRandomSeed(lua_State* L, uint32_t seed);
+
 // DEPRECATED
 // I really don't like this callback setup (mistake on my part). It's clunky.
 // Perhaps better to have a lambda function? (now that all compilers support C++11) /MAWE
@@ -690,6 +754,22 @@ namespace dmScript
      */
     const char* GetProfilerString(lua_State* L, int optional_callback_index, const char* source_file_name, const char* function_name, const char* optional_message_name, char* buffer, uint32_t buffer_size);
 
+    /**
+     * Pushes the error handler used by PCall(), so that several functions can be called with PCallWithErrorHandler() without pushing it for each call.
+     * @param L lua state
+     */
+    void PushErrorHandler(lua_State* L);
+
+    /**
+     * Same as PCall(), with the error handler (see PushErrorHandler()) already on the stack.
+     * @param L lua state
+     * @param nargs number of arguments
+     * @param nresult number of results
+     * @param err_index absolute stack index of the error handler, below the function and its arguments
+     * @return error code from pcall
+     */
+    int PCallWithErrorHandler(lua_State* L, int nargs, int nresult, int err_index);
+
 } // dmScript
 
 #endif // DM_SCRIPT_H
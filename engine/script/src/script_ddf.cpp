@@ -455,7 +455,7 @@ namespace dmScript
             where = (const char*)(repeated->m_Array + pointers_offset);
             count = repeated->m_ArrayCount;
             array = true;
-            lua_newtable(L);
+            lua_createtable(L, count, 0);
         }
 
         for (uint32_t i=0;i!=count;i++)
@@ -552,7 +552,7 @@ namespace dmScript
                     }
                     else
                     {
-                        lua_newtable(L);
+                        lua_createtable(L, 0, d->m_FieldCount);
                         for (uint32_t j = 0; j < d->m_FieldCount; ++j)
                         {
                             const dmDDF::FieldDescriptor* f2 = &d->m_Fields[j];
@@ -595,7 +595,7 @@ namespace dmScript
             if (pointers_are_offsets)
                 pointers_offset = (uintptr_t) data;
 
-            lua_newtable(L);
+            lua_createtable(L, 0, d->m_FieldCount);
             for (uint32_t i = 0; i < d->m_FieldCount; ++i)
             {
                 const dmDDF::FieldDescriptor* f = &d->m_Fields[i];
@@ -603,6 +603,77 @@ namespace dmScript
      * @variable
      */
 
+    /*# get the graphics statistics of the last frame
+     * Returns the number of graphics calls and state changes made during the last completed frame.
+     *
+     * @name graphics.get_stats
+     * @return stats [type:table] a table with the following fields:
+     *
+     * `draw_calls`
+     * : [type:number] the number of draw calls
+     *
+     * `dispatch_calls`
+     * : [type:number] the number of compute dispatches
+     *
+     * `instances`
+     * : [type:number] the number of instances drawn
+     *
+     * `triangles`
+     * : [type:number] the number of triangles drawn
+     *
+     * `program_switches`
+     * : [type:number] the number of times a different shader program was enabled
+     *
+     * `texture_binds`
+     * : [type:number] the number of texture binds
+     *
+     * `buffer_upload_bytes`
+     * : [type:number] the number of bytes uploaded to vertex, index and texture buffers
+     *
+     * `render_pass_begins`
+     * : [type:number] the number of render passes, or framebuffer binds on OpenGL
+     *
+     * `descriptor_allocations`
+     * : [type:number] the number of descriptor sets (Vulkan) or bind groups (WebGPU) allocated
+     *
+     * @examples
+     *
+     * ```lua
+     * local stats = graphics.get_stats()
+     * print(stats.draw_calls, stats.triangles)
+     * ```
+     */
+    static int Graphics_GetStats(lua_State* L)
+    {
+        DM_LUA_STACK_CHECK(L, 1);
+
+        dmGraphics::HContext graphics_context = (dmGraphics::HContext) lua_touserdata(L, lua_upvalueindex(1));
+        dmGraphics::FrameStats stats;
+        memset(&stats, 0, sizeof(stats));
+        if (graphics_context)
+        {
+            dmGraphics::GetFrameStats(graphics_context, &stats);
+        }
+
+    #define SET_STAT(name, value) \
+        lua_pushinteger(L, (lua_Integer) value); \
+        lua_setfield(L, -2, name);
+
+        lua_createtable(L, 0, 9);
+        SET_STAT("draw_calls", stats.m_DrawCalls);
+        SET_STAT("dispatch_calls", stats.m_DispatchCalls);
+        SET_STAT("instances", stats.m_Instances);
+        SET_STAT("triangles", stats.m_Triangles);
+        SET_STAT("program_switches", stats.m_ProgramSwitches);
+        SET_STAT("texture_binds", stats.m_TextureBinds);
+        SET_STAT("buffer_upload_bytes", stats.m_BufferUploadBytes);
+        SET_STAT("render_pass_begins", stats.m_RenderPassBegins);
+        SET_STAT("descriptor_allocations", stats.m_DescriptorAllocations);
+
+    #undef SET_STAT
+        return 1;
+    }
+
     static const luaL_reg ScriptGraphics_methods[] =
     {
         {0, 0}
@@ -614,6 +685,11 @@ namespace dmScript
 
         luaL_register(L, SCRIPT_LIB_NAME, ScriptGraphics_methods);
 
+        // The context is kept as an upvalue, since the module has no other state
+        lua_pushlightuserdata(L, (void*) graphics_context);
+        lua_pushcclosure(L, Graphics_GetStats, 1);
+        lua_setfield(L, -2, "get_stats");
+
     #define SET_GRAPHICS_ENUM(name) \
         lua_pushnumber(L, (lua_Number) dmGraphics:: name); \
         lua_setfield(L, -2, #name);
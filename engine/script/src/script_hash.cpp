@@ -73,10 +73,29 @@ namespace dmScript
      * end
      * ```
      */
+    // The global hash() function keeps a table mapping strings to hash userdata as upvalue 1,
+    // and the number of entries in that table as upvalue 2. Lua strings are interned, so
+    // hashing the same string again is a single table lookup. The table is dropped when it
+    // grows too large, in case the hashed strings are generated at runtime.
+    static const uint32_t HASH_STRING_CACHE_MAX_SIZE = 4096;
+
     static int Hash_new(lua_State* L)
     {
         int top = lua_gettop(L);
 
+        const bool cached = lua_type(L, 1) == LUA_TSTRING && lua_istable(L, lua_upvalueindex(1));
+        if (cached)
+        {
+            lua_pushvalue(L, 1);
+            lua_rawget(L, lua_upvalueindex(1));
+            if (!lua_isnil(L, -1))
+            {
+                assert(top + 1 == lua_gettop(L));
+                return 1;
+            }
+            lua_pop(L, 1);
+        }
+
         dmhash_t hash;
         dmhash_t* phash = ToHash(L, 1);
         if (phash != 0)
@@ -90,6 +109,22 @@ namespace dmScript
         }
         PushHash(L, hash);
 
+        if (cached)
+        {
+            uint32_t count = (uint32_t)lua_tointeger(L, lua_upvalueindex(2));
+            if (count >= HASH_STRING_CACHE_MAX_SIZE)
+            {
+                lua_createtable(L, 0, 256);
+                lua_replace(L, lua_upvalueindex(1));
+                count = 0;
+            }
+            lua_pushvalue(L, 1);
+            lua_pushvalue(L, -2);
+            lua_rawset(L, lua_upvalueindex(1));
+            lua_pushinteger(L, count + 1);
+            lua_replace(L, lua_upvalueindex(2));
+        }
+
         assert(top + 1 == lua_gettop(L));
         return 1;
     }
@@ -332,7 +367,9 @@ namespace dmScript
         lua_pushcfunction(L, Hash_concat);
         lua_settable(L, -3);
 
-        lua_pushcfunction(L, Hash_new);
+        lua_createtable(L, 0, 256);
+        lua_pushinteger(L, 0);
+        lua_pushcclosure(L, Hash_new, 2);
         lua_setglobal(L, SCRIPT_TYPE_NAME_HASH);
 
         lua_pushcfunction(L, HashToHex);
@@ -55,12 +55,71 @@ namespace dmScript
         *size = source->m_Script.m_Count;
     }
 
+    // Max number of loaded chunks kept per context before the cache is flushed
+    static const uint32_t MAX_CHUNK_CACHE_SIZE = 1024;
+
+    // Loads the chunk, or reuses a previously loaded chunk with the same content and filename.
+    // Scripts and modules are loaded again each time their resources are recreated (e.g. when
+    // a collection proxy is reloaded), and calling an already loaded chunk skips the parsing.
+    // Hot reloaded content hashes differently, and gets a new entry.
+    static int LoadBufferCached(lua_State *L, const char *buf, uint32_t size, const char *filename)
+    {
+        HContext context = GetScriptContext(L);
+        if (!context || context->m_ChunkCacheRef == LUA_NOREF)
+        {
+            return luaL_loadbuffer(L, buf, size, filename);
+        }
+
+        HashState64 hash_state;
+        dmHashInit64(&hash_state, false);
+        dmHashUpdateBuffer64(&hash_state, buf, size);
+        dmHashUpdateBuffer64(&hash_state, filename, strlen(filename));
+        dmhash_t key = dmHashFinal64(&hash_state);
+
+        lua_rawgeti(L, LUA_REGISTRYINDEX, context->m_ChunkCacheRef);
+        // [-1] cache
+        lua_pushlstring(L, (const char*)&key, sizeof(key));
+        lua_rawget(L, -2);
+        // [-2] cache
+        // [-1] chunk or nil
+        if (lua_isfunction(L, -1))
+        {
+            lua_remove(L, -2);
+            return 0;
+        }
+        lua_pop(L, 2);
+
+        int ret = luaL_loadbuffer(L, buf, size, filename);
+        if (ret != 0)
+        {
+            return ret;
+        }
+
+        if (context->m_ChunkCacheSize >= MAX_CHUNK_CACHE_SIZE)
+        {
+            lua_newtable(L);
+            lua_rawseti(L, LUA_REGISTRYINDEX, context->m_ChunkCacheRef);
+            context->m_ChunkCacheSize = 0;
+        }
+
+        lua_rawgeti(L, LUA_REGISTRYINDEX, context->m_ChunkCacheRef);
+        // [-2] chunk
+        // [-1] cache
+        lua_pushlstring(L, (const char*)&key, sizeof(key));
+        lua_pushvalue(L, -3);
+        lua_rawset(L, -3);
+        lua_pop(L, 1);
+        // [-1] chunk
+        ++context->m_ChunkCacheSize;
+        return 0;
+    }
+
     int LuaLoad(lua_State *L, dmLuaDDF::LuaSource *source)
     {
         const char *buf;
         uint32_t size;
         GetLuaSource(source, &buf, &size);
-        return luaL_loadbuffer(L, buf, size, source->m_Filename);
+        return LoadBufferCached(L, buf, size, source->m_Filename);
     }
 
     static bool LuaLoadModule(lua_State *L, const char *buf, uint32_t size, const char *filename)
@@ -68,7 +127,7 @@ namespace dmScript
         int top = lua_gettop(L);
         (void) top;
 
-        int ret = luaL_loadbuffer(L, buf, size, filename);
+        int ret = LoadBufferCached(L, buf, size, filename);
         if (ret == 0)
         {
             assert(top + 1 == lua_gettop(L));
@@ -78,6 +78,8 @@ namespace dmScript
         dmArray<HScriptExtension>   m_ScriptExtensions;
         lua_State*                  m_LuaState;
         int                         m_ContextTableRef;
+        int                         m_ChunkCacheRef;    // Table of loaded chunks, keyed by content hash
+        uint32_t                    m_ChunkCacheSize;
     };
 
     HContext GetScriptContext(lua_State* L);
@@ -0,0 +1,215 @@
+// Copyright 2020-2024 The Defold Foundation
+// Copyright 2014-2020 King
+// Copyright 2009-2014 Ragnar Svensson, Christian Murray
+// Licensed under the Defold License version 1.0 (the "License"); you may not use
+// this file except in compliance with the License.
+//
+// You may obtain a copy of the License, together with FAQs at
+// https://www.defold.com/license
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <dlib/dstrings.h>
+#include <dlib/hash.h>
+#include <dlib/hashtable.h>
+
+#include "script.h"
+
+namespace dmScript
+{
+    // A sampling profiler for Lua code, using a count hook to walk the call stack
+    // every N instructions. The identical call stacks are aggregated into a single entry.
+
+    static const uint32_t MAX_SAMPLE_DEPTH = 32;
+    // Bounds the memory usage if the call stacks differ a lot, e.g. due to recursion
+    static const uint32_t MAX_UNIQUE_STACKS = 4096;
+
+    struct LuaSample
+    {
+        char*    m_Stack;
+        uint32_t m_Count;
+    };
+
+    struct LuaSampler
+    {
+        dmHashTable64<LuaSample> m_Samples;
+        uint32_t                 m_SampleCount;
+        uint32_t                 m_DroppedCount;
+        bool                     m_Sampling;
+
+        // The hook that was set before the sampling started
+        lua_Hook                 m_PrevHook;
+        int                      m_PrevHookMask;
+        int                      m_PrevHookCount;
+    };
+
+    static LuaSampler* g_LuaSampler = 0;
+
+    static void FreeSample(void* ctx, const dmhash_t* key, LuaSample* sample)
+    {
+        free(sample->m_Stack);
+    }
+
+    static void ClearSamples(LuaSampler* sampler)
+    {
+        sampler->m_Samples.Iterate(FreeSample, (void*)0);
+        sampler->m_Samples.Clear();
+        sampler->m_SampleCount = 0;
+        sampler->m_DroppedCount = 0;
+    }
+
+    static void WriteFrameName(lua_Debug* entry, char* buffer, uint32_t buffer_size)
+    {
+        if (*entry->what == 'C')
+        {
+            dmSnPrintf(buffer, buffer_size, "[C] %s", entry->name ? entry->name : "?");
+        }
+        else if (*entry->what == 't')
+        {
+            dmStrlCpy(buffer, "(tail call)", buffer_size);
+        }
+        else if (*entry->what == 'm')
+        {
+            dmSnPrintf(buffer, buffer_size, "main chunk (%s)", entry->short_src);
+        }
+        else
+        {
+            dmSnPrintf(buffer, buffer_size, "%s (%s:%d)", entry->name ? entry->name : "?", entry->short_src, entry->linedefined);
+        }
+    }
+
+    static void SampleHook(lua_State* L, lua_Debug* ar)
+    {
+        LuaSampler* sampler = g_LuaSampler;
+        if (ar->event != LUA_HOOKCOUNT || !sampler || !sampler->m_Sampling)
+            return;
+
+        lua_Debug entries[MAX_SAMPLE_DEPTH];
+        uint32_t depth = 0;
+        while (depth < MAX_SAMPLE_DEPTH && lua_getstack(L, depth, &entries[depth]))
+        {
+            lua_getinfo(L, "Sn", &entries[depth]);
+            ++depth;
+        }
+
+        if (depth == 0)
+            return;
+
+        // Outermost function first
+        char stack[2048];
+        stack[0] = 0;
+        for (uint32_t i = depth; i > 0; --i)
+        {
+            char frame[256];
+            WriteFrameName(&entries[i-1], frame, sizeof(frame));
+            if (i != depth)
+                dmStrlCat(stack, ";", sizeof(stack));
+            dmStrlCat(stack, frame, sizeof(stack));
+        }
+
+        sampler->m_SampleCount++;
+
+        dmhash_t key = dmHashString64(stack);
+        LuaSample* sample = sampler->m_Samples.Get(key);
+        if (sample)
+        {
+            sample->m_Count++;
+            return;
+        }
+
+        if (sampler->m_Samples.Size() >= MAX_UNIQUE_STACKS)
+        {
+            sampler->m_DroppedCount++;
+            return;
+        }
+
+        if (sampler->m_Samples.Full())
+        {
+            uint32_t capacity = sampler->m_Samples.Capacity() + 256;
+            sampler->m_Samples.SetCapacity(capacity/2+1, capacity);
+        }
+
+        LuaSample new_sample;
+        new_sample.m_Stack = strdup(stack);
+        new_sample.m_Count = 1;
+        sampler->m_Samples.Put(key, new_sample);
+    }
+
+    void StartLuaSampling(lua_State* L, uint32_t instruction_count)
+    {
+        if (!g_LuaSampler)
+        {
+            g_LuaSampler = new LuaSampler;
+            g_LuaSampler->m_Sampling = false;
+            g_LuaSampler->m_SampleCount = 0;
+            g_LuaSampler->m_DroppedCount = 0;
+        }
+
+        LuaSampler* sampler = g_LuaSampler;
+        if (sampler->m_Sampling)
+            StopLuaSampling(L);
+
+        ClearSamples(sampler);
+
+        sampler->m_PrevHook = lua_gethook(L);
+        sampler->m_PrevHookMask = lua_gethookmask(L);
+        sampler->m_PrevHookCount = lua_gethookcount(L);
+        sampler->m_Sampling = true;
+
+        lua_sethook(L, SampleHook, LUA_MASKCOUNT, instruction_count > 0 ? (int)instruction_count : 1);
+    }
+
+    void StopLuaSampling(lua_State* L)
+    {
+        LuaSampler* sampler = g_LuaSampler;
+        if (!sampler || !sampler->m_Sampling)
+            return;
+
+        sampler->m_Sampling = false;
+        lua_sethook(L, sampler->m_PrevHook, sampler->m_PrevHookMask, sampler->m_PrevHookCount);
+    }
+
+    bool IsLuaSampling()
+    {
+        return g_LuaSampler && g_LuaSampler->m_Sampling;
+    }
+
+    uint32_t GetLuaSampleCount()
+    {
+        return g_LuaSampler ? g_LuaSampler->m_SampleCount : 0;
+    }
+
+    struct IterateSamplesContext
+    {
+        FLuaSampleCallback m_Callback;
+        void*              m_Context;
+    };
+
+    static void IterateSample(IterateSamplesContext* ctx, const dmhash_t* key, LuaSample* sample)
+    {
+        ctx->m_Callback(ctx->m_Context, sample->m_Stack, sample->m_Count);
+    }
+
+    void IterateLuaSamples(FLuaSampleCallback callback, void* ctx)
+    {
+        LuaSampler* sampler = g_LuaSampler;
+        if (!sampler)
+            return;
+
+        IterateSamplesContext iterate_ctx;
+        iterate_ctx.m_Callback = callback;
+        iterate_ctx.m_Context = ctx;
+        sampler->m_Samples.Iterate(IterateSample, &iterate_ctx);
+
+        if (sampler->m_DroppedCount > 0)
+        {
+            callback(ctx, "[too many unique stacks]", sampler->m_DroppedCount);
+        }
+    }
+}
@@ -40,6 +40,7 @@
 #include <dlib/path.h>
 #include <dlib/align.h>
 #include <dlib/memory.h>
+#include <dlib/lz4.h>
 #include <resource/resource.h>
 #include "script.h"
 #include "script/sys_ddf.h"
@@ -60,6 +61,17 @@ const uint32_t MAX_BUFFER_SIZE = 512 * 1024;
 
 static int g_DebuggerLightweightHook = 0;
 
+// Compressed save files start with this header, followed by the LZ4 compressed table data.
+// The third byte ('Z') is not a valid key type in a version 0 table, and the magic differs
+// from the table header magic, so uncompressed files are still recognized.
+static const uint32_t SAVE_FILE_LZ4_MAGIC = 0x345A5344; // "DSZ4"
+
+struct SaveFileHeader
+{
+    uint32_t m_Magic;
+    uint32_t m_UncompressedSize;
+};
+
 union SaveLoadBuffer
 {
     uint32_t m_alignment; // This alignment is required for js-web
@@ -100,6 +112,39 @@ union SaveLoadBuffer
         }
     }
 
+    // Replaces the serialized table in buffer with a compressed save file
+    static char* Sys_CompressSaveData(char* buffer, uint32_t* size)
+    {
+        int max_compressed_size = 0;
+        if (dmLZ4::MaxCompressedSize((int)*size, &max_compressed_size) != dmLZ4::RESULT_OK)
+        {
+            return 0;
+        }
+
+        char* compressed = 0;
+        dmMemory::AlignedMalloc((void**)&compressed, 16, sizeof(SaveFileHeader) + max_compressed_size);
+        if (!compressed)
+        {
+            return 0;
+        }
+
+        int compressed_size = 0;
+        if (dmLZ4::CompressBuffer(buffer, *size, compressed + sizeof(SaveFileHeader), &compressed_size) != dmLZ4::RESULT_OK)
+        {
+            dmMemory::AlignedFree(compressed);
+            return 0;
+        }
+
+        SaveFileHeader header;
+        header.m_Magic = SAVE_FILE_LZ4_MAGIC;
+        header.m_UncompressedSize = *size;
+        memcpy(compressed, &header, sizeof(header));
+
+        Sys_FreeTableSerializationBuffer(buffer);
+        *size = sizeof(SaveFileHeader) + (uint32_t)compressed_size;
+        return compressed;
+    }
+
     /*# saves a lua table to a file stored on disk
      * The table can later be loaded by <code>sys.load</code>.
      * Use <code>sys.get_save_file</code> to obtain a valid location for the file.
@@ -110,9 +155,18 @@ union SaveLoadBuffer
      * keys are permitted to fall within a 32 bit range, supporting sparse arrays, however
      * the limit on the total number of rows remains in effect.
      *
+     * Saving with the `compress` option stores the data LZ4 compressed, which makes
+     * large save files smaller and faster to read on devices with slow storage.
+     * `sys.load` reads both compressed and uncompressed files.
+     *
      * @name sys.save
      * @param filename [type:string] file to write to
      * @param table [type:table] lua table to save
+     * @param [options] [type:table] optional table with the following fields:
+     *
+     * `compress`
+     * : [type:boolean] if the data should be stored LZ4 compressed. Default is `false`.
+     *
      * @return success [type:boolean] a boolean indicating if the table could be saved or not
      * @examples
      *
@@ -143,6 +197,25 @@ union SaveLoadBuffer
         }
         uint32_t n_used = CheckTable(L, buffer, table_size, 2);
 
+        bool compress = false;
+        if (lua_istable(L, 3))
+        {
+            lua_getfield(L, 3, "compress");
+            compress = lua_toboolean(L, -1);
+            lua_pop(L, 1);
+        }
+
+        if (compress)
+        {
+            char* compressed = Sys_CompressSaveData(buffer, &n_used);
+            if (!compressed)
+            {
+                Sys_FreeTableSerializationBuffer(buffer);
+                return luaL_error(L, "Could not compress the data for the file %s.", filename);
+            }
+            buffer = compressed;
+        }
+
 #if !defined(__EMSCRIPTEN__)
 
         char tmp_filename[DMPATH_MAX_PATH];
@@ -253,6 +326,40 @@ union SaveLoadBuffer
         uint32_t file_size = ftell(file);
         fseek(file, 0L, SEEK_SET);
 
+        SaveFileHeader header;
+        if (file_size > sizeof(header) && fread(&header, 1, sizeof(header), file) == sizeof(header) && header.m_Magic == SAVE_FILE_LZ4_MAGIC)
+        {
+            uint32_t compressed_size = file_size - sizeof(header);
+            char* compressed = (char*)malloc(compressed_size);
+            char* buffer = compressed ? Sys_SetupTableSerializationBuffer(header.m_UncompressedSize) : 0;
+            if (!buffer)
+            {
+                free(compressed);
+                fclose(file);
+                return luaL_error(L, "Could not allocate %d bytes for table deserialization.", header.m_UncompressedSize);
+            }
+
+            bool result = fread(compressed, 1, compressed_size, file) == compressed_size;
+            fclose(file);
+
+            int decompressed_size = 0;
+            if (result)
+            {
+                result = dmLZ4::DecompressBuffer(compressed, compressed_size, buffer, header.m_UncompressedSize, &decompressed_size) == dmLZ4::RESULT_OK;
+            }
+            free(compressed);
+            if (!result)
+            {
+                Sys_FreeTableSerializationBuffer(buffer);
+                return luaL_error(L, "Could not read from the file %s.", filename);
+            }
+
+            PushTable(L, buffer, (uint32_t)decompressed_size);
+            Sys_FreeTableSerializationBuffer(buffer);
+            return 1;
+        }
+        fseek(file, 0L, SEEK_SET);
+
         char* buffer = Sys_SetupTableSerializationBuffer(file_size);
         if (!buffer)
         {
@@ -888,7 +888,12 @@ namespace dmScript
             return luaL_error(L, "%s", str);
         }
 
-        lua_newtable(L);
+        // Preallocate the table to avoid rehashing while inserting the elements.
+        // Tables with a leading numeric key are most likely arrays
+        if (count > 0 && buffer < buffer_end && *buffer == LUA_TNUMBER)
+            lua_createtable(L, count, 0);
+        else
+            lua_createtable(L, 0, count);
 
         for (uint32_t i = 0; i < count; ++i)
         {
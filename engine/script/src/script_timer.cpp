@@ -16,6 +16,8 @@
 #include "script_timer_private.h"
 
 #include <string.h>
+#include <algorithm>
+#include <dlib/math.h>
 #include <dlib/object_pool.h>
 #include <dlib/profile.h>
 #include <dlib/set.h>
@@ -49,6 +51,11 @@ namespace dmScript
 
         Each script instance needs to call KillTimers for its owner to clean up potential timers
         that has not yet been cancelled or completed (one-shot).
+
+        Each timer stores the absolute world time when it should fire, and the world keeps a min-heap
+        of (due time, handle) entries so that an update only touches the timers that are due.
+        Cancelled or rescheduled timers leave stale entries in the heap, which are skipped when popped
+        (the handle or due time no longer matches) and purged when the heap grows too large.
     */
 
     static const char TIMER_WORLD_VALUE_KEY[] = "__dm_timer_world__";
@@ -63,8 +70,8 @@ namespace dmScript
         // Store complete timer handle with generation here to identify stale timer handles
         HTimer          m_Handle;
 
-        // How much time remaining until the timer fires
-        float           m_Remaining;
+        // The world time when the timer fires
+        double          m_Due;
 
         // The timer delay, we need to keep this for repeating timers
         float           m_Delay;
@@ -78,14 +85,25 @@ namespace dmScript
     #define INITIAL_TIMER_CAPACITY      8u
     #define TIMER_CAPACITY_GROWTH       16u
 
+    struct TimerQueueEntry
+    {
+        double  m_Due;
+        HTimer  m_Handle;
+    };
+
     struct TimerWorld
     {
-        dmObjectPool<Timer> m_Timers;
-        dmSet<uint16_t>     m_Instances; // the pool indices
-        dmArray<uint16_t>   m_ScratchBuffer; // When doing operations on the timer instances, we need a copy to avoid self modification of m_Instances
-        uint16_t            m_Version;   // Incremented to avoid collisions each time we push timer indexes back to the m_IndexPool
-        uint16_t            m_InUpdate : 1;
-        uint16_t            m_IsDirty : 1;
+        dmObjectPool<Timer>         m_Timers;
+        dmSet<uint16_t>             m_Instances; // the pool indices
+        dmArray<uint16_t>           m_ScratchBuffer; // When doing operations on the timer instances, we need a copy to avoid self modification of m_Instances
+        dmArray<TimerQueueEntry>    m_Queue;     // Min-heap on the due time
+        dmArray<TimerQueueEntry>    m_Pending;   // Timers added or rescheduled during an update, pushed to m_Queue after the update
+        dmArray<uint16_t>           m_Fired;     // Timers triggered during the current update
+        double                      m_Time;      // Accumulated world time
+        uint16_t                    m_Version;   // Incremented to avoid collisions each time we push timer indexes back to the m_IndexPool
+        uint16_t                    m_InUpdate : 1;
+        uint16_t                    m_IsDirty : 1;
+        uint16_t                    m_HasDeadTimers : 1; // Timers were cancelled or killed during an update
     };
 
     dmArray<TimerWorld*> g_Worlds;
@@ -100,6 +118,44 @@ namespace dmScript
         return (((uint32_t)generation) << 16) | (lookup_index);
     }
 
+    // Orders the heap so that the earliest timer is at the front. Timers due at the same time fire in pool index order.
+    struct TimerQueueGreater
+    {
+        bool operator()(const TimerQueueEntry& a, const TimerQueueEntry& b) const
+        {
+            if (a.m_Due != b.m_Due)
+                return a.m_Due > b.m_Due;
+            return GetIndexFromHandle(a.m_Handle) > GetIndexFromHandle(b.m_Handle);
+        }
+    };
+
+    static void PushEntry(dmArray<TimerQueueEntry>& entries, const Timer* timer)
+    {
+        if (entries.Full())
+        {
+            entries.OffsetCapacity(dmMath::Max(16u, entries.Capacity() / 2));
+        }
+        TimerQueueEntry entry = { timer->m_Due, timer->m_Handle };
+        entries.Push(entry);
+    }
+
+    static void ScheduleTimer(HTimerWorld timer_world, const Timer* timer)
+    {
+        // Timers scheduled during an update are not considered until the next update
+        if (timer_world->m_InUpdate)
+        {
+            PushEntry(timer_world->m_Pending, timer);
+            return;
+        }
+        PushEntry(timer_world->m_Queue, timer);
+        std::push_heap(timer_world->m_Queue.Begin(), timer_world->m_Queue.End(), TimerQueueGreater());
+    }
+
+    static float GetRemaining(HTimerWorld timer_world, const Timer* timer)
+    {
+        return (float)(timer->m_Due - timer_world->m_Time);
+    }
+
     static Timer* AllocateTimer(HTimerWorld timer_world, uintptr_t owner)
     {
         assert(timer_world != 0x0);
@@ -162,9 +218,11 @@ namespace dmScript
         timer_world->m_Timers.SetCapacity(INITIAL_TIMER_CAPACITY);
         timer_world->m_Instances.SetCapacity(INITIAL_TIMER_CAPACITY);
 
+        timer_world->m_Time = 0.0;
         timer_world->m_Version = 0;
         timer_world->m_InUpdate = 0;
         timer_world->m_IsDirty = 0;
+        timer_world->m_HasDeadTimers = 0;
         return timer_world;
     }
 
@@ -210,40 +268,61 @@ namespace dmScript
         return size;
     }
 
+    // Removes the stale entries from the queue, in case many timers were cancelled before firing
+    static void PurgeQueue(HTimerWorld timer_world)
+    {
+        dmArray<TimerQueueEntry>& queue = timer_world->m_Queue;
+        uint32_t size = queue.Size();
+        uint32_t count = 0;
+        for (uint32_t i = 0; i < size; ++i)
+        {
+            Timer* timer = GetTimerFromHandle(timer_world, queue[i].m_Handle);
+            if (timer && timer->m_IsAlive && timer->m_Due == queue[i].m_Due)
+            {
+                queue[count++] = queue[i];
+            }
+        }
+        queue.SetSize(count);
+        std::make_heap(queue.Begin(), queue.End(), TimerQueueGreater());
+    }
+
     void UpdateTimers(HTimerWorld timer_world, float dt)
     {
         assert(timer_world != 0x0);
         DM_PROFILE("Update");
 
         timer_world->m_InUpdate = 1;
+        timer_world->m_Time += dt;
+        const double now = timer_world->m_Time;
 
-        // We make a copy of the indices, as it's possible the m_Instances may be altered
-        // Any timers added during this update call, will be updated the next frame
-        uint32_t size = CopyIndices(timer_world->m_Instances, timer_world->m_ScratchBuffer);
+        DM_PROPERTY_ADD_U32(rmtp_TimerCount, timer_world->m_Instances.Size());
 
-        DM_PROPERTY_ADD_U32(rmtp_TimerCount, size);
+        // Any timers added or rescheduled during this update call are put in m_Pending, and will be updated the next frame
+        dmArray<TimerQueueEntry>& queue = timer_world->m_Queue;
+        dmArray<uint16_t>& fired = timer_world->m_Fired;
+        fired.SetSize(0);
 
-        for (uint32_t i = 0; i < size; ++i)
+        while (!queue.Empty() && queue[0].m_Due <= now)
         {
-            uint16_t index = timer_world->m_ScratchBuffer[i];
-            Timer* timer = GetTimerFromIndex(timer_world, index);
-            if (!timer)
-            {
-                continue;
-            }
+            std::pop_heap(queue.Begin(), queue.End(), TimerQueueGreater());
+            TimerQueueEntry entry = queue.Back();
+            queue.Pop();
 
-            if (timer->m_IsAlive == 0)
+            Timer* timer = GetTimerFromHandle(timer_world, entry.m_Handle);
+            if (!timer || timer->m_IsAlive == 0 || timer->m_Due != entry.m_Due)
             {
-                continue;
+                continue; // Stale entry
             }
 
-            timer->m_Remaining -= dt;
-            if (timer->m_Remaining > 0.0f)
+            uint16_t index = GetIndexFromHandle(entry.m_Handle);
+            if (fired.Full())
             {
-                continue;
+                fired.OffsetCapacity(dmMath::Max(16u, fired.Capacity() / 2));
             }
+            fired.Push(index);
 
-            float elapsed_time = timer->m_Delay - timer->m_Remaining;
+            float remaining = GetRemaining(timer_world, timer);
+            float elapsed_time = timer->m_Delay - remaining;
 
             TimerEventType eventType = timer->m_Repeat == 0 ? TIMER_EVENT_TRIGGER_WILL_DIE : TIMER_EVENT_TRIGGER_WILL_REPEAT;
             timer->m_Callback(timer_world, eventType, timer->m_Handle, elapsed_time, timer->m_Owner, timer->m_UserData);
@@ -268,31 +347,66 @@ namespace dmScript
 
             if (timer->m_Delay == 0.0f)
             {
-                timer->m_Remaining = 0.0f;
-                continue;
+                remaining = 0.0f;
             }
-
-            float wrapped_count = ((-timer->m_Remaining) / timer->m_Delay) + 1.f;
-            float offset_to_next_trigger  = floor(wrapped_count) * timer->m_Delay;
-            timer->m_Remaining += offset_to_next_trigger;
-            if (timer->m_Remaining < 0) // If the delay is very small, the floating point precision might produce issues
-                timer->m_Remaining = timer->m_Delay; // reset the timer
+            else
+            {
+                float wrapped_count = ((-remaining) / timer->m_Delay) + 1.f;
+                float offset_to_next_trigger  = floor(wrapped_count) * timer->m_Delay;
+                remaining += offset_to_next_trigger;
+                if (remaining < 0) // If the delay is very small, the floating point precision might produce issues
+                    remaining = timer->m_Delay; // reset the timer
+            }
+            timer->m_Due = now + remaining;
+            ScheduleTimer(timer_world, timer);
         }
 
         timer_world->m_InUpdate = 0;
 
         // We need to do the deletes in a separate pass, as the
         // callbacks may remove/add indices from the pool, thus messing up the current set of indices
-        for (uint32_t i = 0; i < size; ++i)
+        uint32_t fired_count = fired.Size();
+        for (uint32_t i = 0; i < fired_count; ++i)
         {
-            uint16_t index = timer_world->m_ScratchBuffer[i];
-            Timer* timer = GetTimerFromIndex(timer_world, index);
+            Timer* timer = GetTimerFromIndex(timer_world, fired[i]);
             if (timer && timer->m_IsAlive == 0)
             {
                 FreeTimer(timer_world, timer);
             }
         }
 
+        // Timers that were cancelled or killed from within the callbacks
+        if (timer_world->m_HasDeadTimers)
+        {
+            uint32_t size = CopyIndices(timer_world->m_Instances, timer_world->m_ScratchBuffer);
+            for (uint32_t i = 0; i < size; ++i)
+            {
+                Timer* timer = GetTimerFromIndex(timer_world, timer_world->m_ScratchBuffer[i]);
+                if (timer && timer->m_IsAlive == 0)
+                {
+                    FreeTimer(timer_world, timer);
+                }
+            }
+            timer_world->m_HasDeadTimers = 0;
+        }
+
+        uint32_t pending_count = timer_world->m_Pending.Size();
+        for (uint32_t i = 0; i < pending_count; ++i)
+        {
+            if (queue.Full())
+            {
+                queue.OffsetCapacity(dmMath::Max(16u, queue.Capacity() / 2));
+            }
+            queue.Push(timer_world->m_Pending[i]);
+            std::push_heap(queue.Begin(), queue.End(), TimerQueueGreater());
+        }
+        timer_world->m_Pending.SetSize(0);
+
+        if (queue.Size() > 2 * timer_world->m_Instances.Size() + 64)
+        {
+            PurgeQueue(timer_world);
+        }
+
         if (timer_world->m_IsDirty)
         {
             ++timer_world->m_Version;
@@ -318,12 +432,14 @@ namespace dmScript
         }
 
         timer->m_Delay = delay;
-        timer->m_Remaining = delay;
+        timer->m_Due = timer_world->m_Time + delay;
         timer->m_UserData = userdata;
         timer->m_Callback = timer_callback;
         timer->m_Repeat = repeat;
         timer->m_IsAlive = 1;
 
+        ScheduleTimer(timer_world, timer);
+
         return timer->m_Handle;
     }
 
@@ -347,6 +463,10 @@ namespace dmScript
             FreeTimer(timer_world, timer);
             ++timer_world->m_Version;
         }
+        else
+        {
+            timer_world->m_HasDeadTimers = 1;
+        }
 
         return true;
     }
@@ -382,6 +502,10 @@ namespace dmScript
             {
                 FreeTimer(timer_world, timer);
             }
+            else
+            {
+                timer_world->m_HasDeadTimers = 1;
+            }
         }
 
         return cancelled_count;
@@ -704,7 +828,7 @@ namespace dmScript
             return 1;
         }
 
-        LuaTimerCallbackArgs args = { timer->m_Handle, timer->m_Delay - timer->m_Remaining };
+        LuaTimerCallbackArgs args = { timer->m_Handle, timer->m_Delay - GetRemaining(timer_world, timer) };
         InvokeCallback(callback, LuaTimerCallbackArgsCB, &args);
 
         lua_pushboolean(L, 1);
@@ -757,7 +881,7 @@ namespace dmScript
         }
 
         lua_newtable(L);
-        lua_pushnumber(L,timer->m_Remaining);
+        lua_pushnumber(L,GetRemaining(timer_world, timer));
         lua_setfield(L, -2, "time_remaining");
         lua_pushnumber(L,timer->m_Delay);
         lua_setfield(L, -2, "delay");
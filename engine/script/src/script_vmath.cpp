@@ -2633,6 +2633,154 @@ namespace dmScript
         return 1;
     }
 
+    // Checks that the output argument and the vector arguments are all vector3 or all vector4
+    static ScriptUserType CheckInPlaceArguments(lua_State* L, const char* name, int out_index, void** out, int count, const int* indices, void** arguments)
+    {
+        ScriptUserType type = CheckUserData(L, out_index, out);
+        if (type != SCRIPT_TYPE_VECTOR3 && type != SCRIPT_TYPE_VECTOR4)
+        {
+            luaL_error(L, "%s.%s expects a %s.%s or %s.%s as the output argument.", SCRIPT_LIB_NAME, name, SCRIPT_LIB_NAME, SCRIPT_TYPE_NAME_VECTOR3, SCRIPT_LIB_NAME, SCRIPT_TYPE_NAME_VECTOR4);
+            return SCRIPT_TYPE_UNKNOWN;
+        }
+        for (int i = 0; i < count; ++i)
+        {
+            if (CheckUserData(L, indices[i], &arguments[i]) != type)
+            {
+                luaL_error(L, "%s.%s Arguments needs to be of same type!", SCRIPT_LIB_NAME, name);
+                return SCRIPT_TYPE_UNKNOWN;
+            }
+        }
+        return type;
+    }
+
+    /*# adds two vectors, storing the result in an existing vector
+     *
+     * Adds two vectors and stores the result in `out`, without allocating a new vector.
+     * `out` may be the same vector as one of the operands. All vectors must be of the same type.
+     *
+     * <code>vmath.add_to(out, v1, v2)</code> is equivalent to <code>out = v1 + v2</code>
+     *
+     * @name vmath.add_to
+     * @param out [type:vector3|vector4] the vector to store the result in
+     * @param v1 [type:vector3|vector4] first vector
+     * @param v2 [type:vector3|vector4] second vector
+     * @return out [type:vector3|vector4] the output vector
+     * @examples
+     *
+     * ```lua
+     * function update(self, dt)
+     *     vmath.add_to(self.pos, self.pos, self.velocity)
+     * end
+     * ```
+     */
+    static int AddTo(lua_State* L)
+    {
+        void* out = 0;
+        void* arguments[2] = {};
+        const int indices[2] = {2, 3};
+        ScriptUserType type = CheckInPlaceArguments(L, "add_to", 1, &out, 2, indices, arguments);
+        if (type == SCRIPT_TYPE_VECTOR3)
+            *(Vector3*)out = *(Vector3*)arguments[0] + *(Vector3*)arguments[1];
+        else
+            *(Vector4*)out = *(Vector4*)arguments[0] + *(Vector4*)arguments[1];
+        lua_pushvalue(L, 1);
+        return 1;
+    }
+
+    /*# subtracts two vectors, storing the result in an existing vector
+     *
+     * Subtracts `v2` from `v1` and stores the result in `out`, without allocating a new vector.
+     * `out` may be the same vector as one of the operands. All vectors must be of the same type.
+     *
+     * <code>vmath.sub_to(out, v1, v2)</code> is equivalent to <code>out = v1 - v2</code>
+     *
+     * @name vmath.sub_to
+     * @param out [type:vector3|vector4] the vector to store the result in
+     * @param v1 [type:vector3|vector4] first vector
+     * @param v2 [type:vector3|vector4] second vector
+     * @return out [type:vector3|vector4] the output vector
+     */
+    static int SubTo(lua_State* L)
+    {
+        void* out = 0;
+        void* arguments[2] = {};
+        const int indices[2] = {2, 3};
+        ScriptUserType type = CheckInPlaceArguments(L, "sub_to", 1, &out, 2, indices, arguments);
+        if (type == SCRIPT_TYPE_VECTOR3)
+            *(Vector3*)out = *(Vector3*)arguments[0] - *(Vector3*)arguments[1];
+        else
+            *(Vector4*)out = *(Vector4*)arguments[0] - *(Vector4*)arguments[1];
+        lua_pushvalue(L, 1);
+        return 1;
+    }
+
+    /*# multiplies a vector by a scalar, storing the result in an existing vector
+     *
+     * Multiplies `v` by the number `s` and stores the result in `out`, without allocating a new vector.
+     * `out` may be the same vector as `v`.
+     *
+     * <code>vmath.mul_scalar_to(out, v, s)</code> is equivalent to <code>out = v * s</code>
+     *
+     * @name vmath.mul_scalar_to
+     * @param out [type:vector3|vector4] the vector to store the result in
+     * @param v [type:vector3|vector4] the vector
+     * @param s [type:number] the scalar
+     * @return out [type:vector3|vector4] the output vector
+     * @examples
+     *
+     * ```lua
+     * function update(self, dt)
+     *     vmath.mul_scalar_to(self.step, self.velocity, dt)
+     *     vmath.add_to(self.pos, self.pos, self.step)
+     * end
+     * ```
+     */
+    static int MulScalarTo(lua_State* L)
+    {
+        void* out = 0;
+        void* arguments[1] = {};
+        const int indices[1] = {2};
+        ScriptUserType type = CheckInPlaceArguments(L, "mul_scalar_to", 1, &out, 1, indices, arguments);
+        float s = (float) luaL_checknumber(L, 3);
+        if (type == SCRIPT_TYPE_VECTOR3)
+            *(Vector3*)out = *(Vector3*)arguments[0] * s;
+        else
+            *(Vector4*)out = *(Vector4*)arguments[0] * s;
+        lua_pushvalue(L, 1);
+        return 1;
+    }
+
+    /*# lerps between two vectors, storing the result in an existing vector
+     *
+     * Linearly interpolates between `v1` and `v2` and stores the result in `out`, without allocating a new vector.
+     * `out` may be the same vector as one of the operands. All vectors must be of the same type.
+     *
+     * <code>vmath.lerp_to(out, t, v1, v2)</code> is equivalent to <code>out = vmath.lerp(t, v1, v2)</code>
+     *
+     * [icon:attention] The function does not clamp t between 0 and 1.
+     *
+     * @name vmath.lerp_to
+     * @param out [type:vector3|vector4] the vector to store the result in
+     * @param t [type:number] interpolation parameter, 0-1
+     * @param v1 [type:vector3|vector4] vector to lerp from
+     * @param v2 [type:vector3|vector4] vector to lerp to
+     * @return out [type:vector3|vector4] the output vector
+     */
+    static int LerpTo(lua_State* L)
+    {
+        void* out = 0;
+        void* arguments[2] = {};
+        const int indices[2] = {3, 4};
+        float t = (float) luaL_checknumber(L, 2);
+        ScriptUserType type = CheckInPlaceArguments(L, "lerp_to", 1, &out, 2, indices, arguments);
+        if (type == SCRIPT_TYPE_VECTOR3)
+            *(Vector3*)out = dmVMath::Lerp(t, *(Vector3*)arguments[0], *(Vector3*)arguments[1]);
+        else
+            *(Vector4*)out = dmVMath::Lerp(t, *(Vector4*)arguments[0], *(Vector4*)arguments[1]);
+        lua_pushvalue(L, 1);
+        return 1;
+    }
+
     static const luaL_reg methods[] =
     {
         {SCRIPT_TYPE_NAME_VECTOR, Vector_new},
@@ -2674,6 +2822,10 @@ namespace dmScript
         {"matrix4_compose", Matrix4_Compose},
         {"matrix4_scale", Matrix4_Scale},
         {"clamp", Vector_Clamp},
+        {"add_to", AddTo},
+        {"sub_to", SubTo},
+        {"mul_scalar_to", MulScalarTo},
+        {"lerp_to", LerpTo},
         {0, 0}
     };
 
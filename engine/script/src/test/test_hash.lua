@@ -36,6 +36,15 @@ function test_hash(hash_value, hash_value_hex)
 
     assert(key_count == 1)
 
+    -- repeated hashing of the same string returns the same hash, also when the string cache is flushed
+    local h = hash("cached_value")
+    assert(rawequal(h, hash("cached_value")))
+    for i=1,5000 do
+        hash("cached_value" .. i)
+    end
+    assert(h == hash("cached_value"))
+    assert(hash("cached_value" .. 1) == hash("cached_value1"))
+
     assert(hashmd5("") == "d41d8cd98f00b204e9800998ecf8427e")
     assert(hashmd5("foo") == "acbd18db4cc2f85cedef654fccc4a4d8")
     assert(hashmd5("defold") == "01757dd6173a9e1b01714bb584ef00e5")
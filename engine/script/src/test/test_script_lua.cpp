@@ -174,6 +174,23 @@ TEST_F(ScriptTestLua, TestRandom)
     ASSERT_EQ(top, lua_gettop(L));
 }
 
+TEST_F(ScriptTestLua, TestRandomSeedState)
+{
+    int top = lua_gettop(L);
+    ASSERT_TRUE(RunString(L, "math.randomseed(123)"));
+    uint32_t seed = dmScript::GetRandomSeed(L);
+    ASSERT_TRUE(RunString(L, "assert(math.random(0,100) == 58)"));
+    ASSERT_TRUE(RunString(L, "assert(math.random(0,100) == 71)"));
+
+    // Restoring the state repeats the sequence
+    dmScript::SetRandomSeed(L, seed);
+    ASSERT_EQ(seed, dmScript::GetRandomSeed(L));
+    ASSERT_TRUE(RunString(L, "assert(math.random(0,100) == 58)"));
+    ASSERT_TRUE(RunString(L, "assert(math.random(0,100) == 71)"));
+
+    ASSERT_EQ(top, lua_gettop(L));
+}
+
 static int LuaCallCallback(lua_State* L)
 {
     luaL_checktype(L, -1, LUA_TFUNCTION);
@@ -489,6 +506,38 @@ TEST_F(ScriptTestLua, TestErrorHandlerFunction)
     ASSERT_EQ(top, lua_gettop(L));
 }
 
+TEST_F(ScriptTestLua, TestPCallWithErrorHandler)
+{
+    int top = lua_gettop(L);
+
+    ASSERT_TRUE(RunString(L,
+        "_count = 0\n"
+        "function _add(n) _count = _count + n end\n"
+        "sys.set_error_handler(function(type, error, traceback) _error = error end)\n"));
+
+    // The handler stays on the stack for all the calls, also after an error
+    dmScript::PushErrorHandler(L);
+    int err_index = lua_gettop(L);
+
+    lua_getglobal(L, "_add");
+    lua_pushnumber(L, 1);
+    ASSERT_EQ(0, dmScript::PCallWithErrorHandler(L, 1, 0, err_index));
+
+    lua_pushcfunction(L, FailingFunc);
+    ASSERT_EQ(LUA_ERRRUN, dmScript::PCallWithErrorHandler(L, 0, 0, err_index));
+    ASSERT_EQ(err_index, lua_gettop(L));
+
+    lua_getglobal(L, "_add");
+    lua_pushnumber(L, 2);
+    ASSERT_EQ(0, dmScript::PCallWithErrorHandler(L, 1, 0, err_index));
+
+    lua_pop(L, 1);
+    ASSERT_EQ(top, lua_gettop(L));
+
+    ASSERT_TRUE(RunString(L, "assert(_count == 3)"));
+    ASSERT_TRUE(RunString(L, "assert(_error == \"this function does not work\")"));
+}
+
 
 struct CallbackArgs
 {
@@ -1066,6 +1115,53 @@ TEST_F(ScriptTestLua, LuaBooleanFunctions)
     lua_pop(L, 1);
 }
 
+struct LuaSamplesContext
+{
+    uint32_t m_StackCount;
+    uint32_t m_HotCount;
+};
+
+static void CountLuaSamples(void* _ctx, const char* stack, uint32_t count)
+{
+    LuaSamplesContext* ctx = (LuaSamplesContext*)_ctx;
+    ctx->m_StackCount++;
+    if (strstr(stack, "sampling_outer") && strstr(stack, "sampling_hot"))
+        ctx->m_HotCount += count;
+}
+
+TEST_F(ScriptTestLua, LuaSampling)
+{
+    int top = lua_gettop(L);
+
+    ASSERT_FALSE(dmScript::IsLuaSampling());
+    dmScript::StartLuaSampling(L, 100);
+    ASSERT_TRUE(dmScript::IsLuaSampling());
+
+    ASSERT_TRUE(RunString(L,
+        "local function sampling_hot() local x = 0 for i = 1, 100000 do x = x + i end return x end\n"
+        "function sampling_outer() return sampling_hot() + 1 end\n"
+        "sampling_outer()\n"));
+
+    dmScript::StopLuaSampling(L);
+    ASSERT_FALSE(dmScript::IsLuaSampling());
+    ASSERT_EQ((lua_Hook)0, lua_gethook(L));
+
+    uint32_t sample_count = dmScript::GetLuaSampleCount();
+    ASSERT_LT(0u, sample_count);
+
+    LuaSamplesContext ctx = {0, 0};
+    dmScript::IterateLuaSamples(CountLuaSamples, &ctx);
+    ASSERT_LT(0u, ctx.m_StackCount);
+    // Most of the time is spent in the loop
+    ASSERT_LT(sample_count / 2, ctx.m_HotCount);
+
+    // No samples are taken after the stop
+    ASSERT_TRUE(RunString(L, "sampling_outer()"));
+    ASSERT_EQ(sample_count, dmScript::GetLuaSampleCount());
+
+    ASSERT_EQ(top, lua_gettop(L));
+}
+
 #undef USE_PANIC_FN
 
 extern "C" void dmExportedSymbols();
@@ -706,6 +706,44 @@ TEST_F(ScriptTimerTest, TestKillTimers)
     dmScript::DeleteTimerWorld(timer_world);
 }
 
+TEST_F(ScriptTimerTest, TestTimerDueOrder)
+{
+    dmScript::HTimerWorld timer_world = dmScript::NewTimerWorld();
+
+    static uintptr_t owners[8];
+    static uint32_t owner_count = 0;
+
+    struct Callback {
+        static void cb(dmScript::HTimerWorld timer_world, dmScript::TimerEventType event_type, dmScript::HTimer timer_handle, float time_elapsed, uintptr_t owner, uintptr_t userdata)
+        {
+            if (event_type == dmScript::TIMER_EVENT_CANCELLED)
+                return;
+            owners[owner_count++] = owner;
+        }
+    };
+
+    dmScript::AddTimer(timer_world, 3.f, false, Callback::cb, 0x3, 0x0);
+    dmScript::AddTimer(timer_world, 1.f, false, Callback::cb, 0x1, 0x0);
+    dmScript::HTimer cancelled = dmScript::AddTimer(timer_world, 1.5f, false, Callback::cb, 0x4, 0x0);
+    dmScript::AddTimer(timer_world, 2.f, false, Callback::cb, 0x2, 0x0);
+
+    ASSERT_TRUE(dmScript::CancelTimer(timer_world, cancelled));
+
+    dmScript::UpdateTimers(timer_world, 0.5f);
+    ASSERT_EQ(0u, owner_count);
+
+    // All remaining timers are due, they should fire in the order of their due time
+    dmScript::UpdateTimers(timer_world, 5.f);
+    ASSERT_EQ(3u, owner_count);
+    ASSERT_EQ(0x1u, owners[0]);
+    ASSERT_EQ(0x2u, owners[1]);
+    ASSERT_EQ(0x3u, owners[2]);
+
+    ASSERT_EQ(0u, GetAliveTimers(timer_world));
+
+    dmScript::DeleteTimerWorld(timer_world);
+}
+
 static dmScript::HTimer cb_callback_handle = dmScript::INVALID_TIMER_HANDLE;
 static uint32_t cb_callback_counter = 0u;
 static float cb_elapsed_time = 0.0f;
@@ -104,6 +104,19 @@ function test_sys()
     assert(data['xp'] == data_prim['xp'])
     assert(data['name'] == data_prim['name'])
 
+    -- save and reload a compressed file
+    print("Saving compressed file")
+    ret, msg = pcall(function() sys.save(file, data, { compress = true }) end)
+    if not ret then
+        print(msg)
+        assert(false, "expected sys.save() with compression to work")
+    end
+    data_prim = sys.load(file)
+    assert(data['high_score'] == data_prim['high_score'])
+    assert(data['location'] == data_prim['location'])
+    assert(data['xp'] == data_prim['xp'])
+    assert(data['name'] == data_prim['name'])
+
     -- get_config_string
     print("Testing get_config_string")
     assert(sys.get_config_string("main.does_not_exists") == nil)
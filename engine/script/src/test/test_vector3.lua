@@ -124,6 +124,22 @@ assert(v.x == 5, "v.x is not 5")
 assert(v.y ==12, "v.y is not 12")
 assert(v.z ==21, "v.z is not 21")
 
+-- in place operations
+local out = vmath.vector3()
+local a = vmath.vector3(1, 2, 3)
+local b = vmath.vector3(4, 5, 6)
+assert(vmath.add_to(out, a, b) == out, "add_to should return out")
+assert(out.x == 5 and out.y == 7 and out.z == 9, "add_to")
+vmath.sub_to(out, b, a)
+assert(out.x == 3 and out.y == 3 and out.z == 3, "sub_to")
+vmath.mul_scalar_to(out, out, 2)
+assert(out.x == 6 and out.y == 6 and out.z == 6, "mul_scalar_to")
+vmath.lerp_to(out, 0.5, a, b)
+assert(out.x == 2.5 and out.y == 3.5 and out.z == 4.5, "lerp_to")
+vmath.add_to(a, a, a)
+assert(a.x == 2 and a.y == 4 and a.z == 6, "add_to aliased")
+assert(not pcall(vmath.add_to, out, a, vmath.vector4()), "add_to with mixed types")
+
 -- tostring and concat
 v = vmath.vector3(1, 2, 3)
 assert(("foo " .. tostring(v)) == "foo vmath.vector3(1, 2, 3)")
@@ -0,0 +1,256 @@
+// Copyright 2020-2024 The Defold Foundation
+// Copyright 2014-2020 King
+// Copyright 2009-2014 Ragnar Svensson, Christian Murray
+// Licensed under the Defold License version 1.0 (the "License"); you may not use
+// this file except in compliance with the License.
+//
+// You may obtain a copy of the License, together with FAQs at
+// https://www.defold.com/license
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+
+#include <stdint.h>
+#include <string.h>
+#include <AudioToolbox/AudioToolbox.h>
+
+#include <dlib/log.h>
+#include <dlib/math.h>
+#include <dlib/profile.h>
+
+#include "sound_codec.h"
+#include "sound_decoder.h"
+
+// Decodes AAC (m4a/adts) with the OS decoders, which are hardware accelerated on most Apple devices
+
+namespace dmSoundCodec
+{
+    namespace
+    {
+        struct DecodeStreamInfo
+        {
+            Info            m_Info;
+            AudioFileID     m_File;
+            ExtAudioFileRef m_ExtFile;
+            const uint8_t*  m_Buffer;
+            uint32_t        m_Size;
+            // Set if the data is read while decoding
+            HStreamBuffer   m_StreamBuffer;
+            uint32_t        m_BytesPerFrame;
+            SInt64          m_FrameCount;
+        };
+    }
+
+    static OSStatus AudioToolboxRead(void* context, SInt64 position, UInt32 request_count, void* buffer, UInt32* actual_count)
+    {
+        DecodeStreamInfo* info = (DecodeStreamInfo*) context;
+        *actual_count = 0;
+        if (position < 0)
+            return kAudioFileInvalidPacketOffsetError;
+        if (position >= info->m_Size)
+            return noErr;
+
+        uint32_t n = dmMath::Min((uint32_t) request_count, info->m_Size - (uint32_t) position);
+        if (info->m_StreamBuffer)
+        {
+            // The file parser may jump around (e.g. to an index at the end of the file), which then reads the data directly
+            if (StreamTell(info->m_StreamBuffer) != (uint32_t) position)
+                StreamSeek(info->m_StreamBuffer, (uint32_t) position);
+
+            uint32_t got = 0;
+            while (got < n)
+            {
+                uint32_t r = StreamRead(info->m_StreamBuffer, (uint8_t*) buffer + got, n - got);
+                if (r == 0)
+                    break;
+                got += r;
+            }
+            *actual_count = got;
+            return got == n ? noErr : (OSStatus) kAudioFileUnspecifiedError;
+        }
+
+        memcpy(buffer, info->m_Buffer + position, n);
+        *actual_count = n;
+        return noErr;
+    }
+
+    static SInt64 AudioToolboxGetSize(void* context)
+    {
+        return ((DecodeStreamInfo*) context)->m_Size;
+    }
+
+    static void CloseFile(DecodeStreamInfo* info)
+    {
+        if (info->m_ExtFile)
+            ExtAudioFileDispose(info->m_ExtFile);
+        if (info->m_File)
+            AudioFileClose(info->m_File);
+        info->m_ExtFile = 0;
+        info->m_File = 0;
+    }
+
+    static Result OpenStream(DecodeStreamInfo* info, HDecodeStream* stream)
+    {
+        // No type hint, so that both m4a and adts files are accepted
+        OSStatus err = AudioFileOpenWithCallbacks(info, AudioToolboxRead, 0, AudioToolboxGetSize, 0, 0, &info->m_File);
+        if (err == noErr)
+            err = ExtAudioFileWrapAudioFileID(info->m_File, false, &info->m_ExtFile);
+
+        AudioStreamBasicDescription file_format;
+        UInt32 size = sizeof(file_format);
+        if (err == noErr)
+            err = ExtAudioFileGetProperty(info->m_ExtFile, kExtAudioFileProperty_FileDataFormat, &size, &file_format);
+
+        if (err != noErr || file_format.mChannelsPerFrame < 1 || file_format.mChannelsPerFrame > 2)
+        {
+            if (err == noErr)
+                dmLogWarning("Only mono and stereo sounds are supported, got %u channels", (uint32_t) file_format.mChannelsPerFrame);
+            CloseFile(info);
+            delete info;
+            return RESULT_INVALID_FORMAT;
+        }
+
+        // Decode to interleaved 16 bit pcm, at the rate of the file. The mixer does the resampling
+        uint32_t channels = file_format.mChannelsPerFrame;
+        AudioStreamBasicDescription client_format;
+        memset(&client_format, 0, sizeof(client_format));
+        client_format.mSampleRate       = file_format.mSampleRate;
+        client_format.mFormatID         = kAudioFormatLinearPCM;
+        client_format.mFormatFlags      = kAudioFormatFlagsNativeEndian | kAudioFormatFlagIsSignedInteger | kAudioFormatFlagIsPacked;
+        client_format.mChannelsPerFrame = channels;
+        client_format.mBitsPerChannel   = 16;
+        client_format.mFramesPerPacket  = 1;
+        client_format.mBytesPerFrame    = 2 * channels;
+        client_format.mBytesPerPacket   = 2 * channels;
+        err = ExtAudioFileSetProperty(info->m_ExtFile, kExtAudioFileProperty_ClientDataFormat, sizeof(client_format), &client_format);
+
+        SInt64 frame_count = 0;
+        size = sizeof(frame_count);
+        if (err == noErr)
+            err = ExtAudioFileGetProperty(info->m_ExtFile, kExtAudioFileProperty_FileLengthFrames, &size, &frame_count);
+
+        if (err != noErr)
+        {
+            dmLogWarning("Failed to set up the AAC decoder (%d)", (int) err);
+            CloseFile(info);
+            delete info;
+            return RESULT_INVALID_FORMAT;
+        }
+
+        info->m_Info.m_Rate = (uint32_t) file_format.mSampleRate;
+        info->m_Info.m_Size = 0;
+        info->m_Info.m_Channels = (uint8_t) channels;
+        info->m_Info.m_BitsPerSample = 16;
+        info->m_BytesPerFrame = client_format.mBytesPerFrame;
+        info->m_FrameCount = frame_count;
+
+        *stream = info;
+        return RESULT_OK;
+    }
+
+    static Result AudioToolboxOpenStream(const void* buffer, uint32_t buffer_size, HDecodeStream* stream)
+    {
+        DecodeStreamInfo* info = new DecodeStreamInfo();
+        info->m_Buffer = (const uint8_t*) buffer;
+        info->m_Size = buffer_size;
+        info->m_StreamBuffer = 0;
+        return OpenStream(info, stream);
+    }
+
+    static Result AudioToolboxOpenStreamBuffer(HStreamBuffer stream_buffer, HDecodeStream* stream)
+    {
+        DecodeStreamInfo* info = new DecodeStreamInfo();
+        info->m_Buffer = 0;
+        info->m_Size = StreamSize(stream_buffer);
+        info->m_StreamBuffer = stream_buffer;
+        return OpenStream(info, stream);
+    }
+
+    static void AudioToolboxCloseStream(HDecodeStream stream)
+    {
+        DecodeStreamInfo* info = (DecodeStreamInfo*) stream;
+        CloseFile(info);
+        delete info;
+    }
+
+    static Result AudioToolboxDecode(HDecodeStream stream, char* buffer, uint32_t buffer_size, uint32_t* decoded)
+    {
+        DM_PROFILE(__FUNCTION__);
+
+        DecodeStreamInfo* info = (DecodeStreamInfo*) stream;
+        uint32_t frames = buffer_size / info->m_BytesPerFrame;
+        uint32_t got_frames = 0;
+
+        // The converter returns a packet at a time, so loop until the buffer is full
+        while (got_frames < frames)
+        {
+            AudioBufferList buffers;
+            buffers.mNumberBuffers = 1;
+            buffers.mBuffers[0].mNumberChannels = info->m_Info.m_Channels;
+            buffers.mBuffers[0].mDataByteSize = (frames - got_frames) * info->m_BytesPerFrame;
+            buffers.mBuffers[0].mData = buffer + got_frames * info->m_BytesPerFrame;
+
+            UInt32 n = frames - got_frames;
+            OSStatus err = ExtAudioFileRead(info->m_ExtFile, &n, &buffers);
+            if (err != noErr)
+            {
+                return RESULT_DECODE_ERROR;
+            }
+            if (n == 0)
+            {
+                // reached end of file
+                break;
+            }
+            got_frames += n;
+        }
+
+        *decoded = got_frames * info->m_BytesPerFrame;
+        return RESULT_OK;
+    }
+
+    static Result AudioToolboxResetStream(HDecodeStream stream)
+    {
+        DecodeStreamInfo* info = (DecodeStreamInfo*) stream;
+        return ExtAudioFileSeek(info->m_ExtFile, 0) == noErr ? RESULT_OK : RESULT_DECODE_ERROR;
+    }
+
+    static Result AudioToolboxSkipInStream(HDecodeStream stream, uint32_t bytes, uint32_t* skipped)
+    {
+        DecodeStreamInfo* info = (DecodeStreamInfo*) stream;
+        *skipped = 0;
+
+        SInt64 pos = 0;
+        if (ExtAudioFileTell(info->m_ExtFile, &pos) != noErr)
+            return RESULT_DECODE_ERROR;
+
+        // Seeking is cheaper than decoding and discarding
+        SInt64 frames = dmMath::Min((SInt64) (bytes / info->m_BytesPerFrame), dmMath::Max((SInt64) 0, info->m_FrameCount - pos));
+        if (frames > 0 && ExtAudioFileSeek(info->m_ExtFile, pos + frames) != noErr)
+            return RESULT_DECODE_ERROR;
+
+        *skipped = (uint32_t) frames * info->m_BytesPerFrame;
+        return RESULT_OK;
+    }
+
+    static void AudioToolboxGetInfo(HDecodeStream stream, struct Info* out)
+    {
+        *out = ((DecodeStreamInfo*) stream)->m_Info;
+    }
+
+    static int64_t AudioToolboxGetInternalPos(HDecodeStream stream)
+    {
+        DecodeStreamInfo* info = (DecodeStreamInfo*) stream;
+        SInt64 pos = 0;
+        ExtAudioFileTell(info->m_ExtFile, &pos);
+        return pos;
+    }
+
+    DM_DECLARE_SOUND_DECODER(AudioDecoderAudioToolbox, "AacDecoderAudioToolbox", FORMAT_AAC,
+                             8,
+                             AudioToolboxOpenStream, AudioToolboxOpenStreamBuffer, AudioToolboxCloseStream, AudioToolboxDecode,
+                             AudioToolboxResetStream, AudioToolboxSkipInStream, AudioToolboxGetInfo,
+                             AudioToolboxGetInternalPos);
+}
@@ -0,0 +1,279 @@
+// Copyright 2020-2024 The Defold Foundation
+// Copyright 2014-2020 King
+// Copyright 2009-2014 Ragnar Svensson, Christian Murray
+// Licensed under the Defold License version 1.0 (the "License"); you may not use
+// this file except in compliance with the License.
+//
+// You may obtain a copy of the License, together with FAQs at
+// https://www.defold.com/license
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+
+#include <stdint.h>
+#include <string.h>
+#include <dlib/log.h>
+#include <dlib/math.h>
+#include <dlib/profile.h>
+
+#include <opusfile.h>
+
+#include "sound_codec.h"
+#include "sound_decoder.h"
+
+namespace dmSoundCodec
+{
+    // Opus is always decoded at 48kHz. The mixer resamples it to the device rate
+    static const uint32_t OPUS_RATE = 48000;
+
+    namespace
+    {
+        struct DecodeStreamInfo
+        {
+            Info m_Info;
+            OggOpusFile* m_File;
+            size_t m_Size, m_Cursor;
+            const unsigned char* m_Buffer;
+            // Set if the data is read while decoding. The stream is then unseekable
+            HStreamBuffer m_StreamBuffer;
+            ogg_int64_t m_PcmLength;
+            // Files with more than two channels are downmixed to stereo
+            bool m_Downmix;
+        };
+    }
+
+    // The functions below mimic the usual fopen/fread etc functions, reading from a buffer
+    // in memory
+    static int OpusRead(void* datasource, unsigned char* ptr, int nbytes)
+    {
+        DecodeStreamInfo* info = (DecodeStreamInfo*) datasource;
+        if (info->m_StreamBuffer)
+        {
+            return (int) StreamRead(info->m_StreamBuffer, ptr, (uint32_t) nbytes);
+        }
+
+        size_t tot = (size_t) nbytes;
+        if (tot > (info->m_Size - info->m_Cursor)) {
+            tot = info->m_Size - info->m_Cursor;
+        }
+
+        memcpy(ptr, &info->m_Buffer[info->m_Cursor], tot);
+        info->m_Cursor += tot;
+        return (int) tot;
+    }
+
+    static int OpusSeek(void* datasource, opus_int64 offset, int whence)
+    {
+        DecodeStreamInfo* info = (DecodeStreamInfo*) datasource;
+
+        opus_int64 pos = 0;
+        if (whence == SEEK_SET)
+            pos = offset;
+        else if (whence == SEEK_CUR)
+            pos = (opus_int64) info->m_Cursor + offset;
+        else if (whence == SEEK_END)
+            pos = (opus_int64) info->m_Size + offset;
+
+        if (pos < 0)
+            return -1;
+        info->m_Cursor = (size_t) pos;
+        return 0;
+    }
+
+    static opus_int64 OpusTell(void* datasource)
+    {
+        DecodeStreamInfo* info = (DecodeStreamInfo*) datasource;
+        if (info->m_StreamBuffer)
+        {
+            return StreamTell(info->m_StreamBuffer);
+        }
+        return (opus_int64) info->m_Cursor;
+    }
+
+    static int OpenFile(DecodeStreamInfo* info)
+    {
+        OpusFileCallbacks cb;
+        cb.read = OpusRead;
+        // Without a seek function, the decoder doesn't read the end of the file to find the length
+        cb.seek = info->m_StreamBuffer ? 0 : OpusSeek;
+        cb.tell = OpusTell;
+        cb.close = 0;
+
+        int error = 0;
+        info->m_File = op_open_callbacks(info, &cb, 0, 0, &error);
+        return info->m_File ? 0 : error;
+    }
+
+    static Result OpenStream(DecodeStreamInfo* tmp, HDecodeStream* stream)
+    {
+        int res = OpenFile(tmp);
+        if (res)
+        {
+            delete tmp;
+            return RESULT_INVALID_FORMAT;
+        }
+
+        int channels = op_channel_count(tmp->m_File, -1);
+        tmp->m_Downmix = channels > 2;
+
+        tmp->m_Info.m_Rate = OPUS_RATE;
+        tmp->m_Info.m_Size = 0;
+        tmp->m_Info.m_Channels = tmp->m_Downmix ? 2 : channels;
+        tmp->m_Info.m_BitsPerSample = 16;
+
+        tmp->m_PcmLength = op_pcm_total(tmp->m_File, -1);
+
+        *stream = tmp;
+        return RESULT_OK;
+    }
+
+    static Result OpusOpenStream(const void* buffer, uint32_t buffer_size, HDecodeStream* stream)
+    {
+        DecodeStreamInfo* tmp = new DecodeStreamInfo();
+        tmp->m_Buffer = (const unsigned char*) buffer;
+        tmp->m_Size = buffer_size;
+        tmp->m_Cursor = 0;
+        tmp->m_StreamBuffer = 0;
+        return OpenStream(tmp, stream);
+    }
+
+    static Result OpusOpenStreamBuffer(HStreamBuffer stream_buffer, HDecodeStream* stream)
+    {
+        DecodeStreamInfo* tmp = new DecodeStreamInfo();
+        tmp->m_Buffer = 0;
+        tmp->m_Size = 0;
+        tmp->m_Cursor = 0;
+        tmp->m_StreamBuffer = stream_buffer;
+        return OpenStream(tmp, stream);
+    }
+
+    static Result OpusDecode(HDecodeStream stream, char* buffer, uint32_t buffer_size, uint32_t* decoded)
+    {
+        DM_PROFILE(__FUNCTION__);
+
+        DecodeStreamInfo* streamInfo = (DecodeStreamInfo*) stream;
+        if (!streamInfo->m_File)
+        {
+            // A reset failed to open the file again
+            return RESULT_DECODE_ERROR;
+        }
+
+        const uint32_t channels = streamInfo->m_Info.m_Channels;
+        const uint32_t stride = channels * sizeof(opus_int16);
+        uint32_t got_bytes = 0;
+
+        // op_read returns at most one opus packet (20ms by default) per call, so loop and fetch
+        while (true)
+        {
+            const uint32_t remaining = (buffer_size - got_bytes) / stride;
+            if (!remaining)
+            {
+                break;
+            }
+
+            opus_int16* out = (opus_int16*) &buffer[got_bytes];
+            int frames;
+            if (streamInfo->m_Downmix)
+                frames = op_read_stereo(streamInfo->m_File, out, (int) (remaining * channels));
+            else
+                frames = op_read(streamInfo->m_File, out, (int) (remaining * channels), 0);
+
+            if (frames == OP_HOLE)
+            {
+                // A gap in the data (e.g. a corrupt page). Keep decoding from the next packet
+                continue;
+            }
+
+            if (frames < 0)
+            {
+                return RESULT_DECODE_ERROR;
+            }
+
+            if (!frames)
+            {
+                // reached end of file
+                break;
+            }
+
+            got_bytes += frames * stride;
+        }
+
+        *decoded = got_bytes;
+        return RESULT_OK;
+    }
+
+    static Result OpusResetStream(HDecodeStream stream)
+    {
+        DecodeStreamInfo* streamInfo = (DecodeStreamInfo*) stream;
+        if (streamInfo->m_StreamBuffer)
+        {
+            // Unseekable, so open it again. The header is kept in memory, so this doesn't wait for any reads
+            op_free(streamInfo->m_File);
+            StreamSeek(streamInfo->m_StreamBuffer, 0);
+            // On failure, the file is 0, which op_free() accepts, so the stream can still be closed
+            return OpenFile(streamInfo) ? RESULT_DECODE_ERROR : RESULT_OK;
+        }
+        return op_raw_seek(streamInfo->m_File, 0) == 0 ? RESULT_OK : RESULT_DECODE_ERROR;
+    }
+
+    static Result OpusSkipInStream(HDecodeStream stream, uint32_t bytes, uint32_t* skipped)
+    {
+        DecodeStreamInfo* streamInfo = (DecodeStreamInfo*) stream;
+        const ogg_int64_t stride = streamInfo->m_Info.m_Channels * sizeof(opus_int16);
+        if (streamInfo->m_PcmLength > 0)
+        {
+            // clamp to end of stream
+            ogg_int64_t pos = op_pcm_tell(streamInfo->m_File);
+            ogg_int64_t newpos = dmMath::Min(pos + (ogg_int64_t) (bytes / stride), streamInfo->m_PcmLength);
+            if (newpos > pos && op_pcm_seek(streamInfo->m_File, newpos) != 0)
+            {
+                *skipped = 0;
+                return RESULT_DECODE_ERROR;
+            }
+            *skipped = (uint32_t) ((newpos - pos) * stride);
+            return RESULT_OK;
+        }
+
+        // Streamed data can't be seeked, so decode and discard
+        char buffer[4096];
+        uint32_t total = 0;
+        while (total < bytes)
+        {
+            uint32_t decoded = 0;
+            Result r = OpusDecode(stream, buffer, dmMath::Min((uint32_t) sizeof(buffer), bytes - total), &decoded);
+            if (r != RESULT_OK)
+                return r;
+            if (decoded == 0)
+                break;
+            total += decoded;
+        }
+        *skipped = total;
+        return RESULT_OK;
+    }
+
+    static void OpusCloseStream(HDecodeStream stream)
+    {
+        DecodeStreamInfo* streamInfo = (DecodeStreamInfo*) stream;
+        op_free(streamInfo->m_File);
+        delete streamInfo;
+    }
+
+    static void OpusGetInfo(HDecodeStream stream, struct Info* out)
+    {
+        *out = ((DecodeStreamInfo*) stream)->m_Info;
+    }
+
+    static int64_t OpusGetInternalPos(HDecodeStream stream)
+    {
+        DecodeStreamInfo* streamInfo = (DecodeStreamInfo*) stream;
+        return streamInfo->m_File ? (int64_t) op_pcm_tell(streamInfo->m_File) : 0;
+    }
+
+    DM_DECLARE_SOUND_DECODER(AudioDecoderOpus, "OpusDecoder", FORMAT_OPUS, 8,
+                             OpusOpenStream, OpusOpenStreamBuffer, OpusCloseStream, OpusDecode,
+                             OpusResetStream, OpusSkipInStream, OpusGetInfo,
+                             OpusGetInternalPos);
+}
@@ -123,7 +123,7 @@ namespace dmSoundCodec
 
     DM_DECLARE_SOUND_DECODER(AudioDecoderStbVorbis, "VorbisDecoderStb", FORMAT_VORBIS,
                              5, // baseline score (1-10)
-                             StbVorbisOpenStream, StbVorbisCloseStream, StbVorbisDecode,
+                             StbVorbisOpenStream, 0, StbVorbisCloseStream, StbVorbisDecode,
                              StbVorbisResetStream, StbVorbisSkipInStream, StbVorbisGetInfo,
                              StbVorbisGetInternalPos);
 }
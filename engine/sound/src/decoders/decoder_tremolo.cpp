@@ -33,6 +33,8 @@ namespace dmSoundCodec
             OggVorbis_File m_File;
             size_t m_Size, m_Cursor;
             const char *m_Buffer;
+            // Set if the data is read while decoding. The stream is then unseekable
+            HStreamBuffer m_StreamBuffer;
             ogg_int64_t m_SeekTo;
             ogg_int64_t m_PcmLength;
         };
@@ -43,6 +45,10 @@ namespace dmSoundCodec
     static size_t OggRead(void *ptr, size_t size, size_t nmemb, void *datasource)
     {
         DecodeStreamInfo *info = (DecodeStreamInfo*) datasource;
+        if (info->m_StreamBuffer)
+        {
+            return StreamRead(info->m_StreamBuffer, ptr, (uint32_t)(nmemb * size));
+        }
 
         size_t tot = nmemb * size;
         if (tot > (info->m_Size - info->m_Cursor)) {
@@ -77,23 +83,28 @@ namespace dmSoundCodec
     static long OggTell(void *datasource)
     {
         DecodeStreamInfo *info = (DecodeStreamInfo*) datasource;
+        if (info->m_StreamBuffer)
+        {
+            return StreamTell(info->m_StreamBuffer);
+        }
         return info->m_Cursor;
     }
 
-    static Result TremoloOpenStream(const void* buffer, uint32_t buffer_size, HDecodeStream* stream)
+    static int OpenFile(DecodeStreamInfo* info)
     {
-        DecodeStreamInfo *tmp = new DecodeStreamInfo();
-        tmp->m_Buffer = (const char*) buffer;
-        tmp->m_Size = buffer_size;
-        tmp->m_Cursor = 0;
-
         ov_callbacks cb;
         cb.read_func = OggRead;
         cb.close_func = OggClose;
-        cb.seek_func = OggSeek;
+        // Without a seek function, the decoder doesn't read the end of the file to find the length
+        cb.seek_func = info->m_StreamBuffer ? 0 : OggSeek;
         cb.tell_func = OggTell;
 
-        int res = ov_open_callbacks(tmp, &tmp->m_File, 0, 0, cb);
+        return ov_open_callbacks(info, &info->m_File, 0, 0, cb);
+    }
+
+    static Result OpenStream(DecodeStreamInfo* tmp, HDecodeStream* stream)
+    {
+        int res = OpenFile(tmp);
         if (res)
         {
             delete tmp;
@@ -114,6 +125,26 @@ namespace dmSoundCodec
         return RESULT_OK;
     }
 
+    static Result TremoloOpenStream(const void* buffer, uint32_t buffer_size, HDecodeStream* stream)
+    {
+        DecodeStreamInfo *tmp = new DecodeStreamInfo();
+        tmp->m_Buffer = (const char*) buffer;
+        tmp->m_Size = buffer_size;
+        tmp->m_Cursor = 0;
+        tmp->m_StreamBuffer = 0;
+        return OpenStream(tmp, stream);
+    }
+
+    static Result TremoloOpenStreamBuffer(HStreamBuffer stream_buffer, HDecodeStream* stream)
+    {
+        DecodeStreamInfo *tmp = new DecodeStreamInfo();
+        tmp->m_Buffer = 0;
+        tmp->m_Size = 0;
+        tmp->m_Cursor = 0;
+        tmp->m_StreamBuffer = stream_buffer;
+        return OpenStream(tmp, stream);
+    }
+
     static Result TremoloDecode(HDecodeStream stream, char* buffer, uint32_t buffer_size, uint32_t* decoded)
     {
         DM_PROFILE(__FUNCTION__);
@@ -163,8 +194,16 @@ namespace dmSoundCodec
     static Result TremoloResetStream(HDecodeStream stream)
     {
         DecodeStreamInfo *streamInfo = (DecodeStreamInfo*) stream;
-        ov_raw_seek(&streamInfo->m_File, 0);
         streamInfo->m_SeekTo = -1;
+        if (streamInfo->m_StreamBuffer)
+        {
+            // Unseekable, so open it again. The header is kept in memory, so this doesn't wait for any reads
+            ov_clear(&streamInfo->m_File);
+            StreamSeek(streamInfo->m_StreamBuffer, 0);
+            // On failure, the file is cleared, so the stream can still be closed
+            return OpenFile(streamInfo) ? RESULT_DECODE_ERROR : RESULT_OK;
+        }
+        ov_raw_seek(&streamInfo->m_File, 0);
         return RESULT_OK;
     }
 
@@ -188,6 +227,24 @@ namespace dmSoundCodec
             *skipped = (uint32_t)((newpos - pos) * stride);
             return RESULT_OK;
         }
+        else if (streamInfo->m_StreamBuffer)
+        {
+            // Streamed data can't be seeked, so decode and discard
+            char buffer[4096];
+            uint32_t total = 0;
+            while (total < bytes)
+            {
+                uint32_t decoded = 0;
+                Result r = TremoloDecode(stream, buffer, dmMath::Min((uint32_t)sizeof(buffer), bytes - total), &decoded);
+                if (r != RESULT_OK)
+                    return r;
+                if (decoded == 0)
+                    break;
+                total += decoded;
+            }
+            *skipped = total;
+            return RESULT_OK;
+        }
         else
         {
             // unseekable stream.
@@ -215,7 +272,7 @@ namespace dmSoundCodec
     }
 
     DM_DECLARE_SOUND_DECODER(AudioDecoderTremolo, "VorbisDecoderTremolo", FORMAT_VORBIS, 8,
-                             TremoloOpenStream, TremoloCloseStream, TremoloDecode,
+                             TremoloOpenStream, TremoloOpenStreamBuffer, TremoloCloseStream, TremoloDecode,
                              TremoloResetStream, TremoloSkipInStream, TremoloGetInfo,
                              TremoloGetInternalPos);
 }
@@ -248,7 +248,7 @@ namespace dmSoundCodec
 
     DM_DECLARE_SOUND_DECODER(AudioDecoderWav, "WavDecoder", FORMAT_WAV,
                              0,
-                             WavOpenStream, WavCloseStream, WavDecodeStream,
+                             WavOpenStream, 0, WavCloseStream, WavDecodeStream,
                              WavResetStream, WavSkipInStream, WavGetInfo,
                              WavGetInternalPos);
 }
@@ -0,0 +1,346 @@
+// Copyright 2020-2024 The Defold Foundation
+// Copyright 2014-2020 King
+// Copyright 2009-2014 Ragnar Svensson, Christian Murray
+// Licensed under the Defold License version 1.0 (the "License"); you may not use
+// this file except in compliance with the License.
+//
+// You may obtain a copy of the License, together with FAQs at
+// https://www.defold.com/license
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include <assert.h>
+#include <dlfcn.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <dlib/atomic.h>
+#include <dlib/log.h>
+#include <dlib/math.h>
+#include <dlib/profile.h>
+#include "sound.h"
+
+#include <aaudio/AAudio.h>
+
+/**
+ * AAudio audio device (Android 8.0+)
+ *
+ * - The stream is opened in low latency mode, at the native rate of the output, and pulls the
+ *   mixed frames from a ring buffer in its data callback. The sound thread fills the ring buffer
+ *   through the same queue interface as the other devices.
+ * - libaaudio is loaded at runtime, so that the engine still runs on older devices. If it can't be
+ *   loaded, or the stream can't be opened, the next "default" device (OpenSL ES) is used instead.
+ * - If the output is disconnected (e.g. headphones are unplugged), the stream is reopened from the sound thread.
+ */
+namespace dmDeviceAAudio
+{
+    // Number of mixed buffers in the ring buffer. Two are in flight while the sound thread sleeps, and one is being mixed
+    static const uint32_t RING_BUFFER_COUNT = 3;
+
+    struct AAudioApi
+    {
+        void* m_Library;
+        aaudio_result_t (*m_CreateStreamBuilder)(AAudioStreamBuilder** builder);
+        void            (*m_SetPerformanceMode)(AAudioStreamBuilder* builder, aaudio_performance_mode_t mode);
+        void            (*m_SetSharingMode)(AAudioStreamBuilder* builder, aaudio_sharing_mode_t mode);
+        void            (*m_SetFormat)(AAudioStreamBuilder* builder, aaudio_format_t format);
+        void            (*m_SetChannelCount)(AAudioStreamBuilder* builder, int32_t channel_count);
+        void            (*m_SetSampleRate)(AAudioStreamBuilder* builder, int32_t sample_rate);
+        void            (*m_SetDataCallback)(AAudioStreamBuilder* builder, AAudioStream_dataCallback callback, void* user_data);
+        void            (*m_SetErrorCallback)(AAudioStreamBuilder* builder, AAudioStream_errorCallback callback, void* user_data);
+        aaudio_result_t (*m_OpenStream)(AAudioStreamBuilder* builder, AAudioStream** stream);
+        aaudio_result_t (*m_DeleteStreamBuilder)(AAudioStreamBuilder* builder);
+        aaudio_result_t (*m_RequestStart)(AAudioStream* stream);
+        aaudio_result_t (*m_RequestStop)(AAudioStream* stream);
+        aaudio_result_t (*m_Close)(AAudioStream* stream);
+        int32_t         (*m_GetSampleRate)(AAudioStream* stream);
+        int32_t         (*m_GetFramesPerBurst)(AAudioStream* stream);
+        aaudio_result_t (*m_SetBufferSizeInFrames)(AAudioStream* stream, int32_t num_frames);
+        aaudio_sharing_mode_t (*m_GetSharingMode)(AAudioStream* stream);
+        const char*     (*m_ConvertResultToText)(aaudio_result_t result);
+    };
+
+    struct AAudioDevice
+    {
+        AAudioStream*               m_Stream;
+        dmSound::OpenDeviceParams   m_Params;
+        uint32_t                    m_MixRate;
+
+        // Interleaved stereo frames, written by the sound thread and read by the data callback
+        int16_t*                    m_Ring;
+        uint32_t                    m_RingFrames;
+        // Total number of frames read and written. Only the difference is used, so they may wrap
+        int32_atomic_t              m_ReadPos;
+        int32_atomic_t              m_WritePos;
+
+        int32_atomic_t              m_Disconnected;
+        bool                        m_IsPlaying;
+    };
+
+    static AAudioApi g_AAudio;
+
+    template <typename T>
+    static bool LoadFunction(T* fn, const char* name)
+    {
+        *fn = (T) dlsym(g_AAudio.m_Library, name);
+        return *fn != 0;
+    }
+
+    static bool LoadApi()
+    {
+        if (g_AAudio.m_Library)
+            return true;
+
+        void* library = dlopen("libaaudio.so", RTLD_NOW);
+        if (!library)
+            return false;
+
+        g_AAudio.m_Library = library;
+        bool ok = LoadFunction(&g_AAudio.m_CreateStreamBuilder, "AAudio_createStreamBuilder")
+               && LoadFunction(&g_AAudio.m_SetPerformanceMode, "AAudioStreamBuilder_setPerformanceMode")
+               && LoadFunction(&g_AAudio.m_SetSharingMode, "AAudioStreamBuilder_setSharingMode")
+               && LoadFunction(&g_AAudio.m_SetFormat, "AAudioStreamBuilder_setFormat")
+               && LoadFunction(&g_AAudio.m_SetChannelCount, "AAudioStreamBuilder_setChannelCount")
+               && LoadFunction(&g_AAudio.m_SetSampleRate, "AAudioStreamBuilder_setSampleRate")
+               && LoadFunction(&g_AAudio.m_SetDataCallback, "AAudioStreamBuilder_setDataCallback")
+               && LoadFunction(&g_AAudio.m_SetErrorCallback, "AAudioStreamBuilder_setErrorCallback")
+               && LoadFunction(&g_AAudio.m_OpenStream, "AAudioStreamBuilder_openStream")
+               && LoadFunction(&g_AAudio.m_DeleteStreamBuilder, "AAudioStreamBuilder_delete")
+               && LoadFunction(&g_AAudio.m_RequestStart, "AAudioStream_requestStart")
+               && LoadFunction(&g_AAudio.m_RequestStop, "AAudioStream_requestStop")
+               && LoadFunction(&g_AAudio.m_Close, "AAudioStream_close")
+               && LoadFunction(&g_AAudio.m_GetSampleRate, "AAudioStream_getSampleRate")
+               && LoadFunction(&g_AAudio.m_GetFramesPerBurst, "AAudioStream_getFramesPerBurst")
+               && LoadFunction(&g_AAudio.m_SetBufferSizeInFrames, "AAudioStream_setBufferSizeInFrames")
+               && LoadFunction(&g_AAudio.m_GetSharingMode, "AAudioStream_getSharingMode")
+               && LoadFunction(&g_AAudio.m_ConvertResultToText, "AAudio_convertResultToText");
+        if (!ok)
+        {
+            dlclose(library);
+            memset(&g_AAudio, 0, sizeof(g_AAudio));
+        }
+        return ok;
+    }
+
+    static aaudio_data_callback_result_t DataCallback(AAudioStream* stream, void* user_data, void* audio_data, int32_t num_frames)
+    {
+        AAudioDevice* aaudio = (AAudioDevice*) user_data;
+        int16_t* out = (int16_t*) audio_data;
+
+        uint32_t read_pos = (uint32_t) dmAtomicGet32(&aaudio->m_ReadPos);
+        uint32_t available = (uint32_t) dmAtomicGet32(&aaudio->m_WritePos) - read_pos;
+        uint32_t n = dmMath::Min(available, (uint32_t) num_frames);
+
+        uint32_t pos = read_pos % aaudio->m_RingFrames;
+        uint32_t first = dmMath::Min(n, aaudio->m_RingFrames - pos);
+        memcpy(out, aaudio->m_Ring + 2 * pos, first * sizeof(int16_t) * 2);
+        memcpy(out + 2 * first, aaudio->m_Ring, (n - first) * sizeof(int16_t) * 2);
+        // Silence on underrun
+        memset(out + 2 * n, 0, (num_frames - n) * sizeof(int16_t) * 2);
+
+        dmAtomicStore32(&aaudio->m_ReadPos, (int32_t) (read_pos + n));
+        return AAUDIO_CALLBACK_RESULT_CONTINUE;
+    }
+
+    static void ErrorCallback(AAudioStream* stream, void* user_data, aaudio_result_t error)
+    {
+        // The stream can't be closed from the callback, so it's reopened on the sound thread
+        AAudioDevice* aaudio = (AAudioDevice*) user_data;
+        if (error == AAUDIO_ERROR_DISCONNECTED)
+        {
+            dmAtomicStore32(&aaudio->m_Disconnected, 1);
+        }
+    }
+
+    // sample_rate 0 opens the stream at the native rate of the output
+    static aaudio_result_t OpenStream(AAudioDevice* aaudio, int32_t sample_rate)
+    {
+        AAudioStreamBuilder* builder = 0;
+        aaudio_result_t r = g_AAudio.m_CreateStreamBuilder(&builder);
+        if (r != AAUDIO_OK)
+            return r;
+
+        g_AAudio.m_SetPerformanceMode(builder, AAUDIO_PERFORMANCE_MODE_LOW_LATENCY);
+        g_AAudio.m_SetSharingMode(builder, aaudio->m_Params.m_Exclusive ? AAUDIO_SHARING_MODE_EXCLUSIVE : AAUDIO_SHARING_MODE_SHARED);
+        g_AAudio.m_SetFormat(builder, AAUDIO_FORMAT_PCM_I16);
+        g_AAudio.m_SetChannelCount(builder, 2);
+        if (sample_rate > 0)
+            g_AAudio.m_SetSampleRate(builder, sample_rate);
+        g_AAudio.m_SetDataCallback(builder, DataCallback, aaudio);
+        g_AAudio.m_SetErrorCallback(builder, ErrorCallback, aaudio);
+
+        AAudioStream* stream = 0;
+        r = g_AAudio.m_OpenStream(builder, &stream);
+        g_AAudio.m_DeleteStreamBuilder(builder);
+        if (r != AAUDIO_OK)
+            return r;
+
+        // The smallest multiple of the burst size that holds the requested size. Two bursts by default
+        int32_t burst = g_AAudio.m_GetFramesPerBurst(stream);
+        int32_t buffer_frames = 2 * burst;
+        if (aaudio->m_Params.m_DeviceBufferFrames > 0 && burst > 0)
+            buffer_frames = dmMath::Max(1, ((int32_t) aaudio->m_Params.m_DeviceBufferFrames + burst - 1) / burst) * burst;
+        g_AAudio.m_SetBufferSizeInFrames(stream, buffer_frames);
+
+        if (aaudio->m_Params.m_Exclusive && g_AAudio.m_GetSharingMode(stream) != AAUDIO_SHARING_MODE_EXCLUSIVE)
+        {
+            dmLogInfo("AAudio: Exclusive mode is not available, using shared mode");
+        }
+
+        aaudio->m_Stream = stream;
+        dmAtomicStore32(&aaudio->m_Disconnected, 0);
+        return AAUDIO_OK;
+    }
+
+    static void CloseStream(AAudioDevice* aaudio)
+    {
+        if (aaudio->m_Stream)
+        {
+            g_AAudio.m_RequestStop(aaudio->m_Stream);
+            g_AAudio.m_Close(aaudio->m_Stream);
+            aaudio->m_Stream = 0;
+        }
+    }
+
+    static void ReopenStream(AAudioDevice* aaudio)
+    {
+        DM_PROFILE(__FUNCTION__);
+        CloseStream(aaudio);
+
+        // Keep the rate, as the sound system mixes at the rate the device was opened with
+        aaudio_result_t r = OpenStream(aaudio, (int32_t) aaudio->m_MixRate);
+        if (r != AAUDIO_OK)
+        {
+            dmLogError("AAudio: Failed to reopen stream: %s", g_AAudio.m_ConvertResultToText(r));
+            return;
+        }
+
+        if (aaudio->m_IsPlaying)
+        {
+            g_AAudio.m_RequestStart(aaudio->m_Stream);
+        }
+    }
+
+    dmSound::Result DeviceAAudioOpen(const dmSound::OpenDeviceParams* params, dmSound::HDevice* device)
+    {
+        assert(params);
+        assert(device);
+        if (!params->m_LowLatency)
+        {
+            return dmSound::RESULT_UNSUPPORTED;
+        }
+        if (!LoadApi())
+        {
+            dmLogInfo("AAudio is not available, using OpenSL ES");
+            return dmSound::RESULT_DEVICE_NOT_FOUND;
+        }
+
+        AAudioDevice* aaudio = new AAudioDevice;
+        memset(aaudio, 0, sizeof(*aaudio));
+        aaudio->m_Params = *params;
+
+        aaudio_result_t r = OpenStream(aaudio, 0);
+        if (r != AAUDIO_OK)
+        {
+            dmLogWarning("AAudio: Failed to open stream: %s. Using OpenSL ES", g_AAudio.m_ConvertResultToText(r));
+            delete aaudio;
+            return dmSound::RESULT_INIT_ERROR;
+        }
+
+        aaudio->m_MixRate = (uint32_t) g_AAudio.m_GetSampleRate(aaudio->m_Stream);
+        aaudio->m_RingFrames = params->m_FrameCount * dmMath::Min(params->m_BufferCount, RING_BUFFER_COUNT);
+        aaudio->m_Ring = (int16_t*) malloc(aaudio->m_RingFrames * sizeof(int16_t) * 2);
+
+        *device = aaudio;
+        return dmSound::RESULT_OK;
+    }
+
+    void DeviceAAudioClose(dmSound::HDevice device)
+    {
+        assert(device);
+        AAudioDevice* aaudio = (AAudioDevice*) device;
+        CloseStream(aaudio);
+        free(aaudio->m_Ring);
+        delete aaudio;
+    }
+
+    dmSound::Result DeviceAAudioQueue(dmSound::HDevice device, const int16_t* samples, uint32_t sample_count)
+    {
+        assert(device);
+        AAudioDevice* aaudio = (AAudioDevice*) device;
+        if (!aaudio->m_IsPlaying)
+        {
+            return dmSound::RESULT_INIT_ERROR;
+        }
+
+        uint32_t write_pos = (uint32_t) dmAtomicGet32(&aaudio->m_WritePos);
+        uint32_t used = write_pos - (uint32_t) dmAtomicGet32(&aaudio->m_ReadPos);
+        assert(aaudio->m_RingFrames - used >= sample_count);
+
+        uint32_t pos = write_pos % aaudio->m_RingFrames;
+        uint32_t first = dmMath::Min(sample_count, aaudio->m_RingFrames - pos);
+        memcpy(aaudio->m_Ring + 2 * pos, samples, first * sizeof(int16_t) * 2);
+        memcpy(aaudio->m_Ring, samples + 2 * first, (sample_count - first) * sizeof(int16_t) * 2);
+
+        // Published after the frames are written
+        dmAtomicStore32(&aaudio->m_WritePos, (int32_t) (write_pos + sample_count));
+        return dmSound::RESULT_OK;
+    }
+
+    uint32_t DeviceAAudioFreeBufferSlots(dmSound::HDevice device)
+    {
+        assert(device);
+        AAudioDevice* aaudio = (AAudioDevice*) device;
+        if (dmAtomicGet32(&aaudio->m_Disconnected))
+        {
+            ReopenStream(aaudio);
+        }
+        if (!aaudio->m_Stream)
+        {
+            return 0;
+        }
+
+        uint32_t used = (uint32_t) dmAtomicGet32(&aaudio->m_WritePos) - (uint32_t) dmAtomicGet32(&aaudio->m_ReadPos);
+        return (aaudio->m_RingFrames - used) / aaudio->m_Params.m_FrameCount;
+    }
+
+    void DeviceAAudioDeviceInfo(dmSound::HDevice device, dmSound::DeviceInfo* info)
+    {
+        assert(device);
+        assert(info);
+        AAudioDevice* aaudio = (AAudioDevice*) device;
+        info->m_MixRate = aaudio->m_MixRate;
+    }
+
+    void DeviceAAudioStart(dmSound::HDevice device)
+    {
+        assert(device);
+        AAudioDevice* aaudio = (AAudioDevice*) device;
+        if (aaudio->m_Stream)
+        {
+            aaudio_result_t r = g_AAudio.m_RequestStart(aaudio->m_Stream);
+            if (r != AAUDIO_OK)
+            {
+                dmLogError("AAudio: Failed to start stream: %s", g_AAudio.m_ConvertResultToText(r));
+            }
+        }
+        aaudio->m_IsPlaying = true;
+    }
+
+    void DeviceAAudioStop(dmSound::HDevice device)
+    {
+        assert(device);
+        AAudioDevice* aaudio = (AAudioDevice*) device;
+        if (aaudio->m_Stream)
+        {
+            g_AAudio.m_RequestStop(aaudio->m_Stream);
+        }
+        aaudio->m_IsPlaying = false;
+    }
+
+    // Registered after the OpenSL ES device, so that it's tried first
+    DM_DECLARE_SOUND_DEVICE(AAudioSoundDevice, "default", DeviceAAudioOpen, DeviceAAudioClose, DeviceAAudioQueue, DeviceAAudioFreeBufferSlots, DeviceAAudioDeviceInfo, DeviceAAudioStart, DeviceAAudioStop);
+}
@@ -23,6 +23,10 @@
 
 #include "sound.h"
 
+#if defined(__EMSCRIPTEN_PTHREADS__)
+#include <emscripten/threading.h>
+#endif
+
 extern "C" {
     // Implementation in library_sound.js
     int dmDeviceJSOpen(int buffers);
@@ -34,6 +38,42 @@ extern "C" {
 
 namespace dmDeviceJS
 {
+#if defined(__EMSCRIPTEN_PTHREADS__)
+    // The audio context lives on the main thread, while the sound may be mixed on a worker thread
+    static void QueueOnMainThread(int device, const int16_t* samples, uint32_t sample_count)
+    {
+        if (emscripten_is_main_runtime_thread())
+            dmDeviceJSQueue(device, samples, sample_count);
+        else
+            emscripten_sync_run_in_main_runtime_thread(EM_FUNC_SIG_VIII, dmDeviceJSQueue, device, samples, sample_count);
+    }
+
+    static int FreeBufferSlotsOnMainThread(int device)
+    {
+        if (emscripten_is_main_runtime_thread())
+            return dmDeviceJSFreeBufferSlots(device);
+        return emscripten_sync_run_in_main_runtime_thread(EM_FUNC_SIG_II, dmDeviceJSFreeBufferSlots, device);
+    }
+
+    static int OpenOnMainThread(int buffers)
+    {
+        if (emscripten_is_main_runtime_thread())
+            return dmDeviceJSOpen(buffers);
+        return emscripten_sync_run_in_main_runtime_thread(EM_FUNC_SIG_II, dmDeviceJSOpen, buffers);
+    }
+
+    static int GetSampleRateOnMainThread(int device)
+    {
+        if (emscripten_is_main_runtime_thread())
+            return dmGetDeviceSampleRate(device);
+        return emscripten_sync_run_in_main_runtime_thread(EM_FUNC_SIG_II, dmGetDeviceSampleRate, device);
+    }
+#else
+    #define QueueOnMainThread           dmDeviceJSQueue
+    #define FreeBufferSlotsOnMainThread dmDeviceJSFreeBufferSlots
+    #define OpenOnMainThread            dmDeviceJSOpen
+    #define GetSampleRateOnMainThread   dmGetDeviceSampleRate
+#endif
     struct JSDevice
     {
         int devId;
@@ -45,7 +85,7 @@ namespace dmDeviceJS
         assert(params);
         assert(device);
         JSDevice *dev = new JSDevice();
-        int deviceId = dmDeviceJSOpen(params->m_BufferCount);
+        int deviceId = OpenOnMainThread(params->m_BufferCount);
         if (deviceId < 0)
         {
             return dmSound::RESULT_DEVICE_NOT_FOUND;
@@ -70,7 +110,7 @@ namespace dmDeviceJS
         {
             return dmSound::RESULT_INIT_ERROR;
         }
-        dmDeviceJSQueue(dev->devId, samples, sample_count);
+        QueueOnMainThread(dev->devId, samples, sample_count);
         return dmSound::RESULT_OK;
     }
 
@@ -78,7 +118,7 @@ namespace dmDeviceJS
     {
         assert(device);
         JSDevice *dev = (JSDevice*) device;
-        return dmDeviceJSFreeBufferSlots(dev->devId);
+        return FreeBufferSlotsOnMainThread(dev->devId);
     }
 
     void DeviceJSDeviceInfo(dmSound::HDevice device, dmSound::DeviceInfo* info)
@@ -86,7 +126,7 @@ namespace dmDeviceJS
         assert(device);
         assert(info);
         JSDevice *dev = (JSDevice*) device;
-        info->m_MixRate = dmGetDeviceSampleRate(dev->devId);
+        info->m_MixRate = GetSampleRateOnMainThread(dev->devId);
     }
 
     void DeviceJSStart(dmSound::HDevice device)
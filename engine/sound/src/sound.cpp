@@ -19,6 +19,7 @@
 #include <dlib/index_pool.h>
 #include <dlib/log.h>
 #include <dlib/math.h>
+#include <dlib/memory.h>
 #include <dlib/mutex.h>
 #include <dlib/profile.h>
 #include <dlib/thread.h>
@@ -32,6 +33,11 @@
 
 #include <math.h>
 #include <cfloat>
+#include <algorithm>
+
+#if defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#endif
 
 /**
  * Defold simple sound system
@@ -51,6 +57,10 @@ namespace dmSound
 
     const dmhash_t MASTER_GROUP_HASH = dmHashString64("master");
     const uint32_t GROUP_MEMORY_BUFFER_COUNT = 64;
+    // Size of the wav header written in front of the decoded pcm in the pcm cache
+    const uint32_t PCM_CACHE_WAV_HEADER_SIZE = 44;
+    // Size of the read ahead buffer of each instance of a streamed sound
+    const uint32_t SOUND_STREAM_BUFFER_SIZE = 128 * 1024;
 
     static void SoundThread(void* ctx);
 
@@ -154,20 +164,40 @@ namespace dmSound
         dmhash_t      m_NameHash;
         void*         m_Data;
         int           m_Size;
+        // Decoded sound, as a wav file, shared by the instances playing it. See sound.pcm_cache_size
+        void*         m_PcmData;
+        uint32_t      m_PcmSize;
+        uint32_t      m_PcmLastUsed;
+        // Number of instances decoding from m_PcmData
+        uint16_t      m_PcmUsers;
         // Index in m_SoundData
         uint16_t      m_Index;
         SoundDataType m_Type;
         uint16_t      m_RefCount;
+        // Set if the sound could not be cached, e.g. because it's too large
+        uint8_t       m_PcmUncacheable : 1;
+        // Set if the sound data was changed while instances used m_PcmData
+        uint8_t       m_PcmStale : 1;
+        // Set if m_Data only holds the header, and the rest is read while playing
+        uint8_t       m_Streamed : 1;
+        uint8_t       : 5;
+        dmSoundCodec::StreamSource m_StreamSource;
+        FSoundDataRelease          m_StreamRelease;
     };
 
     struct SoundInstance
     {
         dmSoundCodec::HDecoder m_Decoder;
+        // Set if the sound data is streamed
+        dmSoundCodec::HStreamBuffer m_StreamBuffer;
         void*       m_Frames;
         dmhash_t    m_Group;
 
         Value       m_Gain;     // default: 1.0f
         Value       m_Pan;      // 0 = -45deg left, 1 = 45 deg right
+        // The gain and pan set with SetParameter, which the spatial gain and pan are applied to
+        float       m_BaseGain;
+        float       m_BasePan;
         float       m_Speed;    // 1.0 = normal speed, 0.5 = half speed, 2.0 = double speed
         uint32_t    m_FrameCount;
         uint64_t    m_FrameFraction;
@@ -177,8 +207,15 @@ namespace dmSound
         uint8_t     m_Looping : 1;
         uint8_t     m_EndOfStream : 1;
         uint8_t     m_Playing : 1;
-        uint8_t     : 5;
+        uint8_t     m_UsesPcmCache : 1;
+        // Set if the instance is playing, but not among the voices that are mixed. It only advances its cursor
+        uint8_t     m_Virtual : 1;
+        // Set if the gain and pan are computed from the position of the instance, see UpdateSpatial
+        uint8_t     m_Spatial : 1;
+        uint8_t     : 2;
         int8_t      m_Loopcounter; // if set to 3, there will be 3 loops effectively playing the sound 4 times.
+        // Instances with higher priority are mixed before those with lower, when there are more than the max voices
+        uint8_t     m_Priority;
     };
 
     struct SoundGroup
@@ -189,6 +226,39 @@ namespace dmSound
         float    m_SumSquaredMemory[SOUND_MAX_MIX_CHANNELS * GROUP_MEMORY_BUFFER_COUNT];
         float    m_PeakMemorySq[SOUND_MAX_MIX_CHANNELS * GROUP_MEMORY_BUFFER_COUNT];
         int      m_NextMemorySlot;
+        // Max number of instances of the group that are mixed. 0 means no limit
+        uint32_t m_MaxVoices;
+        // Number of instances mixed in the current mix, see UpdateVoices
+        uint32_t m_VoiceCount;
+    };
+
+    /**
+     * Sound instance decoded and resampled into its own buffer, on a worker thread, during MixInstances
+     */
+    struct VoiceMix
+    {
+        const MixContext*   m_MixContext;
+        SoundInstance*      m_Instance;
+        float*              m_MixBuffer;
+        // Group to add the mix buffer to, or 0 if nothing was mixed
+        SoundGroup*         m_Group;
+    };
+
+    /**
+     * Positions and distance ranges of the instances, by instance index. Kept as separate arrays,
+     * so that the gains and pans of all the spatial instances are computed in one pass, see UpdateSpatial
+     */
+    struct SpatialEmitters
+    {
+        dmArray<float> m_X;
+        dmArray<float> m_Y;
+        dmArray<float> m_Z;
+        dmArray<float> m_MinDistance;
+        // 1 / (max_distance - min_distance)
+        dmArray<float> m_RangeRecip;
+        // Output of the pass
+        dmArray<float> m_Gain;
+        dmArray<float> m_Pan;
     };
 
     struct SoundSystem
@@ -216,9 +286,31 @@ namespace dmSound
         uint32_t                m_FrameCount;
         uint32_t                m_PlayCounter;
 
+        uint32_t                m_PcmCacheSize;
+        uint32_t                m_PcmCacheMaxSize;
+        uint32_t                m_PcmCacheMaxSoundSize;
+        uint32_t                m_PcmCacheTick;
+
         int16_t*                m_OutBuffers[SOUND_OUTBUFFER_COUNT];
         uint16_t                m_NextOutBuffer;
 
+        dmJobThread::HContext   m_JobThread;
+        dmJobThread::HContext   m_StreamJobThread;
+        dmArray<VoiceMix>       m_VoiceMixes;
+        dmArray<float>          m_VoiceMixBuffers;
+
+        // Max number of instances that are mixed. 0 means no limit
+        uint32_t                m_MaxVoices;
+        // The playing instances, in the order they get voices, see UpdateVoices
+        dmArray<SoundInstance*> m_VoiceOrder;
+
+        SpatialEmitters         m_Emitters;
+        // Number of instances with m_Spatial set
+        uint32_t                m_SpatialCount;
+        float                   m_ListenerPosition[3];
+        // Unit vector to the right of the listener
+        float                   m_ListenerRight[3];
+
         bool                    m_IsDeviceStarted;
         bool                    m_IsAudioInterrupted;
         bool                    m_HasWindowFocus;
@@ -255,6 +347,9 @@ namespace dmSound
         params->m_BufferSize = 12 * 4096;
         params->m_FrameCount = 768;
         params->m_MaxInstances = 256;
+        params->m_PcmCacheSize = 0;
+        params->m_PcmCacheMaxSoundSize = 256 * 1024;
+        params->m_MaxVoices = 64;
         params->m_UseThread = true;
     }
 
@@ -265,18 +360,24 @@ namespace dmSound
         return RESULT_OK;
     }
 
+    // Several devices may have the same name, e.g. a low latency device that isn't supported on all devices.
+    // They are tried in reverse order of registration, until one opens
     static Result OpenDevice(const char* name, const OpenDeviceParams* params, DeviceType** device_type, HDevice* device)
     {
+        Result r = RESULT_DEVICE_NOT_FOUND;
         DeviceType* d = g_FirstDevice;
         while (d) {
             if (strcmp(d->m_Name, name) == 0) {
-                *device_type = d;
-                return d->m_Open(params, device);
+                r = d->m_Open(params, device);
+                if (r == RESULT_OK) {
+                    *device_type = d;
+                    return r;
+                }
             }
             d = d->m_Next;
         }
 
-        return RESULT_DEVICE_NOT_FOUND;
+        return r;
     }
 
     static int GetOrCreateGroup(const char* group_name)
@@ -315,6 +416,12 @@ namespace dmSound
         // TODO: m_BufferCount configurable?
         device_params.m_BufferCount = SOUND_OUTBUFFER_COUNT;
         device_params.m_FrameCount = params->m_FrameCount;
+        if (config)
+        {
+            device_params.m_LowLatency = dmConfigFile::GetInt(config, "sound.low_latency", 1) != 0;
+            device_params.m_Exclusive = dmConfigFile::GetInt(config, "sound.device_exclusive", 0) != 0;
+            device_params.m_DeviceBufferFrames = (uint32_t) dmConfigFile::GetInt(config, "sound.device_buffer_frames", 0);
+        }
         DeviceType* device_type;
         DeviceInfo device_info;
         r = OpenDevice(params->m_OutputDevice, &device_params, &device_type, &device);
@@ -345,6 +452,9 @@ namespace dmSound
         uint32_t max_buffers = params->m_MaxBuffers;
         uint32_t max_sources = params->m_MaxSources;
         uint32_t max_instances = params->m_MaxInstances;
+        uint32_t pcm_cache_size = params->m_PcmCacheSize;
+        uint32_t pcm_cache_max_sound_size = params->m_PcmCacheMaxSoundSize;
+        uint32_t max_voices = params->m_MaxVoices;
 
         if (config)
         {
@@ -353,6 +463,10 @@ namespace dmSound
             max_buffers = (uint32_t) dmConfigFile::GetInt(config, "sound.max_sound_buffers", (int32_t) max_buffers);
             max_sources = (uint32_t) dmConfigFile::GetInt(config, "sound.max_sound_sources", (int32_t) max_sources);
             max_instances = (uint32_t) dmConfigFile::GetInt(config, "sound.max_sound_instances", (int32_t) max_instances);
+            // In kilobytes
+            pcm_cache_size = (uint32_t) dmConfigFile::GetInt(config, "sound.pcm_cache_size", (int32_t) (pcm_cache_size / 1024)) * 1024;
+            pcm_cache_max_sound_size = (uint32_t) dmConfigFile::GetInt(config, "sound.pcm_cache_max_sound_size", (int32_t) (pcm_cache_max_sound_size / 1024)) * 1024;
+            max_voices = (uint32_t) dmConfigFile::GetInt(config, "sound.max_voices", (int32_t) max_voices);
         }
 
         sound->m_Instances.SetCapacity(max_instances);
@@ -379,12 +493,36 @@ namespace dmSound
             sound->m_SoundData[i].m_Index = 0xffff;
         }
 
+        sound->m_PcmCacheSize = 0;
+        sound->m_PcmCacheMaxSize = pcm_cache_size;
+        sound->m_PcmCacheMaxSoundSize = dmMath::Min(pcm_cache_max_sound_size, pcm_cache_size);
+        sound->m_PcmCacheTick = 0;
+
         sound->m_MixRate = device_info.m_MixRate;
         sound->m_FrameCount = params->m_FrameCount;
         for (int i = 0; i < SOUND_OUTBUFFER_COUNT; ++i) {
             sound->m_OutBuffers[i] = (int16_t*) malloc(params->m_FrameCount * sizeof(int16_t) * SOUND_MAX_MIX_CHANNELS);
         }
         sound->m_NextOutBuffer = 0;
+        sound->m_JobThread = params->m_JobThread;
+        sound->m_StreamJobThread = params->m_StreamJobThread;
+        sound->m_MaxVoices = max_voices;
+        sound->m_VoiceOrder.SetCapacity(max_instances);
+
+        dmArray<float>* emitter_arrays[] = { &sound->m_Emitters.m_X, &sound->m_Emitters.m_Y, &sound->m_Emitters.m_Z,
+                                             &sound->m_Emitters.m_MinDistance, &sound->m_Emitters.m_RangeRecip,
+                                             &sound->m_Emitters.m_Gain, &sound->m_Emitters.m_Pan };
+        for (uint32_t i = 0; i < DM_ARRAY_SIZE(emitter_arrays); ++i)
+        {
+            emitter_arrays[i]->SetCapacity(max_instances);
+            emitter_arrays[i]->SetSize(max_instances);
+            memset(emitter_arrays[i]->Begin(), 0, max_instances * sizeof(float));
+        }
+        sound->m_SpatialCount = 0;
+        memset(sound->m_ListenerPosition, 0, sizeof(sound->m_ListenerPosition));
+        sound->m_ListenerRight[0] = 1.0f;
+        sound->m_ListenerRight[1] = 0.0f;
+        sound->m_ListenerRight[2] = 0.0f;
 
         sound->m_GroupMap.SetCapacity(MAX_GROUPS * 2 + 1, MAX_GROUPS);
         for (uint32_t i = 0; i < MAX_GROUPS; ++i) {
@@ -470,11 +608,46 @@ namespace dmSound
     }
 
 
+    static void FreeCachedPcm(SoundSystem* sound, SoundData* sound_data)
+    {
+        assert(sound_data->m_PcmUsers == 0);
+        free(sound_data->m_PcmData);
+        sound->m_PcmCacheSize -= sound_data->m_PcmSize;
+        dmMemory::TrackFree(dmMemory::CATEGORY_SOUND, sound_data->m_PcmSize);
+        sound_data->m_PcmData = 0;
+        sound_data->m_PcmSize = 0;
+        sound_data->m_PcmStale = 0;
+    }
+
+    static void ReleaseCachedPcm(SoundSystem* sound, SoundData* sound_data)
+    {
+        assert(sound_data->m_PcmUsers > 0);
+        sound_data->m_PcmUsers--;
+        if (sound_data->m_PcmUsers == 0 && sound_data->m_PcmStale)
+        {
+            FreeCachedPcm(sound, sound_data);
+        }
+    }
+
     static Result SetSoundDataNoLock(HSoundData sound_data, const void* sound_buffer, uint32_t sound_buffer_size)
     {
+        if (sound_data->m_PcmData)
+        {
+            // Playing instances keep decoding the old pcm until they're deleted
+            if (sound_data->m_PcmUsers == 0)
+                FreeCachedPcm(g_SoundSystem, sound_data);
+            else
+                sound_data->m_PcmStale = 1;
+        }
+        sound_data->m_PcmUncacheable = 0;
+        // The whole sound is set, so it's no longer streamed. The stream context is released with the sound data
+        sound_data->m_Streamed = 0;
+
         free(sound_data->m_Data);
+        dmMemory::TrackFree(dmMemory::CATEGORY_SOUND, sound_data->m_Size);
         sound_data->m_Data = malloc(sound_buffer_size);
         sound_data->m_Size = sound_buffer_size;
+        dmMemory::TrackAlloc(dmMemory::CATEGORY_SOUND, sound_buffer_size);
         memcpy(sound_data->m_Data, sound_buffer, sound_buffer_size);
         return RESULT_OK;
     }
@@ -503,6 +676,15 @@ namespace dmSound
         sd->m_Data = 0;
         sd->m_Size = 0;
         sd->m_RefCount = 1;
+        sd->m_PcmData = 0;
+        sd->m_PcmSize = 0;
+        sd->m_PcmLastUsed = 0;
+        sd->m_PcmUsers = 0;
+        sd->m_PcmUncacheable = 0;
+        sd->m_PcmStale = 0;
+        sd->m_Streamed = 0;
+        memset(&sd->m_StreamSource, 0, sizeof(sd->m_StreamSource));
+        sd->m_StreamRelease = 0;
 
         Result result = SetSoundDataNoLock(sd, sound_buffer, sound_buffer_size);
         if (result == RESULT_OK)
@@ -513,6 +695,37 @@ namespace dmSound
         return result;
     }
 
+    Result NewSoundDataStreaming(const void* header, uint32_t header_size, uint32_t sound_size, FSoundDataRead read, FSoundDataRelease release, void* context, SoundDataType type, HSoundData* sound_data, dmhash_t name)
+    {
+        bool supported = (type == SOUND_DATA_TYPE_OGG_VORBIS && dmSoundCodec::HasStreamDecoder(dmSoundCodec::FORMAT_VORBIS)) ||
+                         (type == SOUND_DATA_TYPE_AAC && dmSoundCodec::HasStreamDecoder(dmSoundCodec::FORMAT_AAC)) ||
+                         (type == SOUND_DATA_TYPE_OPUS && dmSoundCodec::HasStreamDecoder(dmSoundCodec::FORMAT_OPUS));
+        if (!supported)
+        {
+            *sound_data = 0;
+            return RESULT_UNSUPPORTED;
+        }
+
+        HSoundData sd;
+        Result result = NewSoundData(header, header_size, type, &sd, name);
+        if (result != RESULT_OK)
+        {
+            *sound_data = 0;
+            return result;
+        }
+
+        // No instances can use the sound data yet
+        sd->m_Streamed = 1;
+        sd->m_StreamSource.m_Read = read;
+        sd->m_StreamSource.m_Context = context;
+        sd->m_StreamSource.m_Header = sd->m_Data;
+        sd->m_StreamSource.m_HeaderSize = header_size;
+        sd->m_StreamSource.m_Size = sound_size;
+        sd->m_StreamRelease = release;
+        *sound_data = sd;
+        return RESULT_OK;
+    }
+
     Result SetSoundData(HSoundData sound_data, const void* sound_buffer, uint32_t sound_buffer_size)
     {
         DM_MUTEX_OPTIONAL_SCOPED_LOCK(g_SoundSystem->m_Mutex);
@@ -521,7 +734,7 @@ namespace dmSound
 
     uint32_t GetSoundResourceSize(HSoundData sound_data)
     {
-        return sound_data->m_Size + sizeof(SoundData);
+        return sound_data->m_Size + sound_data->m_PcmSize + sizeof(SoundData);
     }
 
     Result DeleteSoundData(HSoundData sound_data)
@@ -536,14 +749,174 @@ namespace dmSound
 
         if (sound_data->m_Data != 0x0)
             free((void*) sound_data->m_Data);
+        dmMemory::TrackFree(dmMemory::CATEGORY_SOUND, sound_data->m_Size);
+        sound_data->m_Size = 0;
 
         SoundSystem* sound = g_SoundSystem;
+        if (sound_data->m_PcmData != 0x0)
+            FreeCachedPcm(sound, sound_data);
+
+        if (sound_data->m_StreamRelease)
+            sound_data->m_StreamRelease(sound_data->m_StreamSource.m_Context);
+        sound_data->m_StreamRelease = 0;
+        sound_data->m_Streamed = 0;
+
         sound->m_SoundDataPool.Push(sound_data->m_Index);
         sound_data->m_Index = 0xffff;
 
         return RESULT_OK;
     }
 
+    static inline void WriteLE16(uint8_t* p, uint16_t value)
+    {
+        p[0] = (uint8_t) (value & 0xff);
+        p[1] = (uint8_t) (value >> 8);
+    }
+
+    static inline void WriteLE32(uint8_t* p, uint32_t value)
+    {
+        WriteLE16(p, (uint16_t) (value & 0xffff));
+        WriteLE16(p + 2, (uint16_t) (value >> 16));
+    }
+
+    static void WriteWavHeader(uint8_t* p, const dmSoundCodec::Info* info, uint32_t data_size)
+    {
+        uint32_t block_align = info->m_Channels * (info->m_BitsPerSample / 8);
+        memcpy(p + 0, "RIFF", 4);
+        WriteLE32(p + 4, PCM_CACHE_WAV_HEADER_SIZE - 8 + data_size);
+        memcpy(p + 8, "WAVE", 4);
+        memcpy(p + 12, "fmt ", 4);
+        WriteLE32(p + 16, 16);
+        WriteLE16(p + 20, 1); // PCM
+        WriteLE16(p + 22, info->m_Channels);
+        WriteLE32(p + 24, info->m_Rate);
+        WriteLE32(p + 28, info->m_Rate * block_align);
+        WriteLE16(p + 32, (uint16_t) block_align);
+        WriteLE16(p + 34, info->m_BitsPerSample);
+        memcpy(p + 36, "data", 4);
+        WriteLE32(p + 40, data_size);
+    }
+
+    // Decodes the whole stream into a wav file in memory. Returns 0 if the stream doesn't decode to at most max_size bytes
+    static uint8_t* DecodePcm(SoundSystem* sound, dmSoundCodec::HDecoder decoder, uint32_t max_size, uint32_t* out_size)
+    {
+        DM_PROFILE(__FUNCTION__);
+
+        dmSoundCodec::Info info;
+        dmSoundCodec::GetInfo(sound->m_CodecContext, decoder, &info);
+        if ((info.m_Channels != 1 && info.m_Channels != 2) || info.m_BitsPerSample != 16) {
+            return 0;
+        }
+
+        // Multiple of the largest frame size (stereo, 16 bits)
+        max_size &= ~3u;
+        uint32_t capacity = dmMath::Min(16u * 1024u, max_size);
+        uint8_t* buffer = (uint8_t*) malloc(PCM_CACHE_WAV_HEADER_SIZE + capacity);
+        uint32_t size = 0;
+        while (true)
+        {
+            if (size == capacity)
+            {
+                if (capacity == max_size)
+                {
+                    // Check if there is more to decode than fits
+                    char overflow[4];
+                    uint32_t decoded = 0;
+                    dmSoundCodec::Result r = dmSoundCodec::Decode(sound->m_CodecContext, decoder, overflow, sizeof(overflow), &decoded);
+                    if (r != dmSoundCodec::RESULT_OK || decoded > 0) {
+                        free(buffer);
+                        return 0;
+                    }
+                    break;
+                }
+                capacity = dmMath::Min(capacity * 2, max_size);
+                buffer = (uint8_t*) realloc(buffer, PCM_CACHE_WAV_HEADER_SIZE + capacity);
+            }
+
+            uint32_t decoded = 0;
+            dmSoundCodec::Result r = dmSoundCodec::Decode(sound->m_CodecContext, decoder, (char*) buffer + PCM_CACHE_WAV_HEADER_SIZE + size, capacity - size, &decoded);
+            if (r != dmSoundCodec::RESULT_OK) {
+                free(buffer);
+                return 0;
+            }
+            if (decoded == 0)
+                break;
+            size += decoded;
+        }
+
+        WriteWavHeader(buffer, &info, size);
+        *out_size = PCM_CACHE_WAV_HEADER_SIZE + size;
+        return buffer;
+    }
+
+    // Evicts the least recently used pcm, not used by any instance, until size bytes fit in the cache
+    static bool ReservePcmCache(SoundSystem* sound, uint32_t size)
+    {
+        if (size > sound->m_PcmCacheMaxSize)
+            return false;
+
+        while (sound->m_PcmCacheSize + size > sound->m_PcmCacheMaxSize)
+        {
+            SoundData* lru = 0;
+            uint32_t count = sound->m_SoundData.Size();
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                SoundData* sd = &sound->m_SoundData[i];
+                if (sd->m_Index == 0xffff || sd->m_PcmData == 0 || sd->m_PcmUsers > 0)
+                    continue;
+                if (!lru || sd->m_PcmLastUsed < lru->m_PcmLastUsed)
+                    lru = sd;
+            }
+
+            if (!lru)
+                return false;
+            FreeCachedPcm(sound, lru);
+        }
+        return true;
+    }
+
+    // Returns true if the decoded sound is available in sound_data->m_PcmData, decoding it if needed
+    static bool GetCachedPcm(SoundSystem* sound, SoundData* sound_data, dmSoundCodec::Format format)
+    {
+        dmSoundCodec::HDecoder decoder;
+        {
+            DM_MUTEX_OPTIONAL_SCOPED_LOCK(sound->m_Mutex);
+            if (sound_data->m_PcmData)
+                return !sound_data->m_PcmStale;
+            if (sound_data->m_PcmUncacheable)
+                return false;
+
+            dmSoundCodec::Result r = dmSoundCodec::NewDecoder(sound->m_CodecContext, format, sound_data->m_Data, sound_data->m_Size, &decoder);
+            if (r != dmSoundCodec::RESULT_OK)
+                return false;
+        }
+
+        // Decode without holding the lock, so that the sound thread isn't blocked
+        uint32_t pcm_size = 0;
+        uint8_t* pcm = DecodePcm(sound, decoder, sound->m_PcmCacheMaxSoundSize - PCM_CACHE_WAV_HEADER_SIZE, &pcm_size);
+
+        DM_MUTEX_OPTIONAL_SCOPED_LOCK(sound->m_Mutex);
+        dmSoundCodec::DeleteDecoder(sound->m_CodecContext, decoder);
+
+        if (!pcm)
+        {
+            sound_data->m_PcmUncacheable = 1;
+            return false;
+        }
+
+        if (sound_data->m_PcmData || !ReservePcmCache(sound, pcm_size))
+        {
+            free(pcm);
+            return sound_data->m_PcmData != 0 && !sound_data->m_PcmStale;
+        }
+
+        sound_data->m_PcmData = pcm;
+        sound_data->m_PcmSize = pcm_size;
+        sound->m_PcmCacheSize += pcm_size;
+        dmMemory::TrackAlloc(dmMemory::CATEGORY_SOUND, pcm_size);
+        return true;
+    }
+
     Result NewSoundInstance(HSoundData sound_data, HSoundInstance* sound_instance)
     {
         SoundSystem* ss = g_SoundSystem;
@@ -555,27 +928,61 @@ namespace dmSound
             codec_format = dmSoundCodec::FORMAT_WAV;
         } else if (sound_data->m_Type == SOUND_DATA_TYPE_OGG_VORBIS) {
             codec_format = dmSoundCodec::FORMAT_VORBIS;
+        } else if (sound_data->m_Type == SOUND_DATA_TYPE_AAC) {
+            codec_format = dmSoundCodec::FORMAT_AAC;
+        } else if (sound_data->m_Type == SOUND_DATA_TYPE_OPUS) {
+            codec_format = dmSoundCodec::FORMAT_OPUS;
         } else {
             assert(0);
         }
 
+        // Streamed sounds are read while they're decoded, into a buffer per instance
+        dmSoundCodec::HStreamBuffer stream_buffer = 0;
+        if (sound_data->m_Streamed)
+        {
+            stream_buffer = dmSoundCodec::NewStreamBuffer(&sound_data->m_StreamSource, SOUND_STREAM_BUFFER_SIZE, ss->m_StreamJobThread);
+        }
+
+        // Short ogg and opus sounds are decoded once and then played from the pcm cache
+        bool compressed = codec_format == dmSoundCodec::FORMAT_VORBIS || codec_format == dmSoundCodec::FORMAT_OPUS;
+        bool uses_pcm_cache = !stream_buffer && compressed && ss->m_PcmCacheMaxSoundSize > PCM_CACHE_WAV_HEADER_SIZE && GetCachedPcm(ss, sound_data, codec_format);
+
         uint16_t index;
         {
             DM_MUTEX_OPTIONAL_SCOPED_LOCK(ss->m_Mutex);
 
             if (ss->m_InstancesPool.Remaining() == 0)
             {
+                if (stream_buffer)
+                    dmSoundCodec::DeleteStreamBuffer(stream_buffer);
                 *sound_instance = 0;
                 dmLogError("Out of sound data instance slots (%u). Increase the project setting 'sound.max_sound_instances'", ss->m_InstancesPool.Capacity());
                 return RESULT_OUT_OF_INSTANCES;
             }
 
-            dmSoundCodec::Result r = dmSoundCodec::NewDecoder(ss->m_CodecContext, codec_format, sound_data->m_Data, sound_data->m_Size, &decoder);
+            // The cached pcm may have been evicted or replaced since GetCachedPcm()
+            uses_pcm_cache = uses_pcm_cache && sound_data->m_PcmData && !sound_data->m_PcmStale;
+
+            dmSoundCodec::Result r;
+            if (stream_buffer)
+                r = dmSoundCodec::NewDecoder(ss->m_CodecContext, codec_format, stream_buffer, &decoder);
+            else if (uses_pcm_cache)
+                r = dmSoundCodec::NewDecoder(ss->m_CodecContext, dmSoundCodec::FORMAT_WAV, sound_data->m_PcmData, sound_data->m_PcmSize, &decoder);
+            else
+                r = dmSoundCodec::NewDecoder(ss->m_CodecContext, codec_format, sound_data->m_Data, sound_data->m_Size, &decoder);
             if (r != dmSoundCodec::RESULT_OK) {
+                if (stream_buffer)
+                    dmSoundCodec::DeleteStreamBuffer(stream_buffer);
                 dmLogError("Failed to decode sound (%d)", r);
                 return RESULT_INVALID_STREAM_DATA;
             }
 
+            if (uses_pcm_cache)
+            {
+                sound_data->m_PcmUsers++;
+                sound_data->m_PcmLastUsed = ++ss->m_PcmCacheTick;
+            }
+
             index = ss->m_InstancesPool.Pop();
         }
 
@@ -588,10 +995,17 @@ namespace dmSound
         si->m_Index = index;
         si->m_Gain.Reset(1.0f);
         si->m_Pan.Reset(0.5f);
+        si->m_BaseGain = 1.0f;
+        si->m_BasePan = 0.5f;
+        si->m_Spatial = 0;
         si->m_Looping = 0;
         si->m_EndOfStream = 0;
         si->m_Playing = 0;
+        si->m_UsesPcmCache = uses_pcm_cache ? 1 : 0;
+        si->m_Virtual = 0;
+        si->m_Priority = 0;
         si->m_Decoder = decoder;
+        si->m_StreamBuffer = stream_buffer;
         si->m_Group = MASTER_GROUP_HASH;
 
         *sound_instance = si;
@@ -615,10 +1029,26 @@ namespace dmSound
         uint16_t index = sound_instance->m_Index;
         sound->m_InstancesPool.Push(index);
         sound_instance->m_Index = 0xffff;
-        DeleteSoundData(&sound->m_SoundData[sound_instance->m_SoundDataIndex]);
-        sound_instance->m_SoundDataIndex = 0xffff;
         dmSoundCodec::DeleteDecoder(sound->m_CodecContext, sound_instance->m_Decoder);
         sound_instance->m_Decoder = 0;
+        if (sound_instance->m_Spatial)
+        {
+            sound_instance->m_Spatial = 0;
+            sound->m_SpatialCount--;
+        }
+        if (sound_instance->m_StreamBuffer)
+        {
+            dmSoundCodec::DeleteStreamBuffer(sound_instance->m_StreamBuffer);
+            sound_instance->m_StreamBuffer = 0;
+        }
+        SoundData* sound_data = &sound->m_SoundData[sound_instance->m_SoundDataIndex];
+        if (sound_instance->m_UsesPcmCache)
+        {
+            ReleaseCachedPcm(sound, sound_data);
+            sound_instance->m_UsesPcmCache = 0;
+        }
+        DeleteSoundData(sound_data);
+        sound_instance->m_SoundDataIndex = 0xffff;
         sound_instance->m_FrameCount = 0;
         sound_instance->m_Speed = 1.0f;
 
@@ -702,6 +1132,32 @@ namespace dmSound
         return RESULT_OK;
     }
 
+    Result SetGroupMaxVoices(dmhash_t group_hash, uint32_t max_voices)
+    {
+        DM_MUTEX_OPTIONAL_SCOPED_LOCK(g_SoundSystem->m_Mutex);
+        SoundSystem* sound = g_SoundSystem;
+        int* index = sound->m_GroupMap.Get(group_hash);
+        if (!index) {
+            return RESULT_NO_SUCH_GROUP;
+        }
+
+        sound->m_Groups[*index].m_MaxVoices = max_voices;
+        return RESULT_OK;
+    }
+
+    Result GetGroupMaxVoices(dmhash_t group_hash, uint32_t* max_voices)
+    {
+        DM_MUTEX_OPTIONAL_SCOPED_LOCK(g_SoundSystem->m_Mutex);
+        SoundSystem* sound = g_SoundSystem;
+        int* index = sound->m_GroupMap.Get(group_hash);
+        if (!index) {
+            return RESULT_NO_SUCH_GROUP;
+        }
+
+        *max_voices = sound->m_Groups[*index].m_MaxVoices;
+        return RESULT_OK;
+    }
+
     Result GetGroupHashes(uint32_t* count, dmhash_t* buffer)
     {
         DM_MUTEX_OPTIONAL_SCOPED_LOCK(g_SoundSystem->m_Mutex);
@@ -831,19 +1287,31 @@ namespace dmSound
         return RESULT_OK;
     }
 
+    Result SetPriority(HSoundInstance sound_instance, uint8_t priority)
+    {
+        DM_MUTEX_OPTIONAL_SCOPED_LOCK(g_SoundSystem->m_Mutex);
+        sound_instance->m_Priority = priority;
+        return RESULT_OK;
+    }
+
     Result SetParameter(HSoundInstance sound_instance, Parameter parameter, const Vector4& value)
     {
         bool reset = !sound_instance->m_Playing;
         switch(parameter)
         {
+            // The spatial instances get their gain and pan in UpdateSpatial
             case PARAMETER_GAIN:
-                sound_instance->m_Gain.Set(dmMath::Max(0.0f, value.getX()), reset);
+                sound_instance->m_BaseGain = dmMath::Max(0.0f, value.getX());
+                if (!sound_instance->m_Spatial)
+                    sound_instance->m_Gain.Set(sound_instance->m_BaseGain, reset);
                 break;
             case PARAMETER_PAN:
                 {
                     float pan = dmMath::Max(-1.0f, dmMath::Min(1.0f, value.getX()));
                     pan = (pan + 1.0f) * 0.5f; // map [-1,1] to [0,1] for easier calculations later
-                    sound_instance->m_Pan.Set(pan, reset);
+                    sound_instance->m_BasePan = pan;
+                    if (!sound_instance->m_Spatial)
+                        sound_instance->m_Pan.Set(pan, reset);
                 }
                 break;
             case PARAMETER_SPEED:
@@ -856,6 +1324,124 @@ namespace dmSound
         return RESULT_OK;
     }
 
+    Result SetSpatial(HSoundInstance sound_instance, bool spatial, float min_distance, float max_distance)
+    {
+        SoundSystem* sound = g_SoundSystem;
+        DM_MUTEX_OPTIONAL_SCOPED_LOCK(sound->m_Mutex);
+
+        if (spatial)
+        {
+            uint16_t index = sound_instance->m_Index;
+            min_distance = dmMath::Max(0.0f, min_distance);
+            max_distance = dmMath::Max(min_distance + 0.0001f, max_distance);
+            sound->m_Emitters.m_MinDistance[index] = min_distance;
+            sound->m_Emitters.m_RangeRecip[index] = 1.0f / (max_distance - min_distance);
+        }
+
+        if (spatial == (bool) sound_instance->m_Spatial)
+            return RESULT_OK;
+
+        bool reset = !sound_instance->m_Playing;
+        sound_instance->m_Spatial = spatial ? 1 : 0;
+        if (spatial)
+        {
+            sound->m_SpatialCount++;
+            // Fade in from silence, as the attenuation isn't known until the next update
+            if (reset)
+                sound_instance->m_Gain.Reset(0.0f);
+        }
+        else
+        {
+            sound->m_SpatialCount--;
+            sound_instance->m_Gain.Set(sound_instance->m_BaseGain, reset);
+            sound_instance->m_Pan.Set(sound_instance->m_BasePan, reset);
+        }
+        return RESULT_OK;
+    }
+
+    Result SetPositions(const HSoundInstance* sound_instances, const Point3* positions, uint32_t count)
+    {
+        SoundSystem* sound = g_SoundSystem;
+        DM_MUTEX_OPTIONAL_SCOPED_LOCK(sound->m_Mutex);
+
+        SpatialEmitters* emitters = &sound->m_Emitters;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            uint16_t index = sound_instances[i]->m_Index;
+            emitters->m_X[index] = positions[i].getX();
+            emitters->m_Y[index] = positions[i].getY();
+            emitters->m_Z[index] = positions[i].getZ();
+        }
+        return RESULT_OK;
+    }
+
+    Result SetListener(const Point3& position, const Quat& rotation)
+    {
+        SoundSystem* sound = g_SoundSystem;
+        DM_MUTEX_OPTIONAL_SCOPED_LOCK(sound->m_Mutex);
+
+        Vector3 right = dmVMath::Rotate(rotation, Vector3(1.0f, 0.0f, 0.0f));
+        sound->m_ListenerPosition[0] = position.getX();
+        sound->m_ListenerPosition[1] = position.getY();
+        sound->m_ListenerPosition[2] = position.getZ();
+        sound->m_ListenerRight[0] = right.getX();
+        sound->m_ListenerRight[1] = right.getY();
+        sound->m_ListenerRight[2] = right.getZ();
+        return RESULT_OK;
+    }
+
+    /*
+     * Computes the gains and pans of all the spatial instances from their positions relative to the listener.
+     * The gain falls off linearly from 1 at the min distance to 0 at the max distance, and the pan follows the
+     * direction to the emitter. The first loop only reads and writes the emitter arrays, so the compiler can vectorize it.
+     */
+    static void UpdateSpatial(SoundSystem* sound)
+    {
+        if (sound->m_SpatialCount == 0)
+            return;
+
+        DM_PROFILE(__FUNCTION__);
+
+        SpatialEmitters* emitters = &sound->m_Emitters;
+        const uint32_t count = sound->m_Instances.Size();
+        const float lx = sound->m_ListenerPosition[0];
+        const float ly = sound->m_ListenerPosition[1];
+        const float lz = sound->m_ListenerPosition[2];
+        const float rx = sound->m_ListenerRight[0];
+        const float ry = sound->m_ListenerRight[1];
+        const float rz = sound->m_ListenerRight[2];
+
+        const float* x = emitters->m_X.Begin();
+        const float* y = emitters->m_Y.Begin();
+        const float* z = emitters->m_Z.Begin();
+        const float* min_distance = emitters->m_MinDistance.Begin();
+        const float* range_recip = emitters->m_RangeRecip.Begin();
+        float* gains = emitters->m_Gain.Begin();
+        float* pans = emitters->m_Pan.Begin();
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            float dx = x[i] - lx;
+            float dy = y[i] - ly;
+            float dz = z[i] - lz;
+            float distance = sqrtf(dx * dx + dy * dy + dz * dz);
+            float gain = 1.0f - (distance - min_distance[i]) * range_recip[i];
+            gains[i] = dmMath::Min(1.0f, dmMath::Max(0.0f, gain));
+            // [-1,1] from left to right, 0 when the emitter is at the listener
+            pans[i] = (dx * rx + dy * ry + dz * rz) / dmMath::Max(distance, 0.0001f);
+        }
+
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            SoundInstance* instance = &sound->m_Instances[i];
+            if (!instance->m_Spatial)
+                continue;
+            bool reset = !instance->m_Playing;
+            float pan = dmMath::Min(1.0f, dmMath::Max(0.0f, instance->m_BasePan + pans[i] * 0.5f));
+            instance->m_Gain.Set(instance->m_BaseGain * gains[i], reset);
+            instance->m_Pan.Set(pan, reset);
+        }
+    }
+
     static inline void GetPanScale(float pan, float* left_scale, float* right_scale)
     {
         // Constant power panning: https://www.cs.cmu.edu/~music/icm-online/readings/panlaws/index.html
@@ -864,6 +1450,40 @@ namespace dmSound
         *right_scale = sinf(theta);
     }
 
+    // Number of frames per block when computing the per frame gains and pan scales of a mix
+    static const uint32_t MIX_BLOCK_FRAMES = 64;
+
+    /*
+     * Per frame gains and constant power pan scales for the frames [start, start + count) of a mix.
+     * The mix loops then only multiply and add, which the compiler can vectorize. The pan is usually
+     * constant over a mix, in which case the trigonometry is done once instead of per frame.
+     */
+    static void GetMixScales(const Ramp& gain_ramp, const Ramp& pan_ramp, uint32_t start, uint32_t count, float* gains, float* left_scales, float* right_scales)
+    {
+        for (uint32_t i = 0; i < count; i++)
+        {
+            gains[i] = gain_ramp.GetValue(start + i);
+        }
+
+        if (pan_ramp.m_From == pan_ramp.m_To)
+        {
+            float left_scale, right_scale;
+            GetPanScale(pan_ramp.m_From, &left_scale, &right_scale);
+            for (uint32_t i = 0; i < count; i++)
+            {
+                left_scales[i] = left_scale;
+                right_scales[i] = right_scale;
+            }
+        }
+        else
+        {
+            for (uint32_t i = 0; i < count; i++)
+            {
+                GetPanScale(pan_ramp.GetValue(start + i), &left_scales[i], &right_scales[i]);
+            }
+        }
+    }
+
     /*
      *
      * Template parameters
@@ -892,29 +1512,34 @@ namespace dmSound
 
         Ramp gain_ramp = GetRamp(mix_context, &instance->m_Gain, mix_buffer_count);
         Ramp pan_ramp = GetRamp(mix_context, &instance->m_Pan, mix_buffer_count);
-        for (uint32_t i = 0; i < mix_buffer_count; i++)
+        float gains[MIX_BLOCK_FRAMES];
+        float left_scales[MIX_BLOCK_FRAMES];
+        float right_scales[MIX_BLOCK_FRAMES];
+        for (uint32_t block = 0; block < mix_buffer_count; block += MIX_BLOCK_FRAMES)
         {
-            float gain = gain_ramp.GetValue(i);
-            float pan = pan_ramp.GetValue(i);
-            float mix = frac * range_recip; // determines the bias between two consecutive samples in the sound instance. It ranges from 0-1. A mix of 0, makes only the first sample count while a mix of 0.5 will count equally both samples.
-            T s1 = frames[index];
-            T s2 = frames[index + 1];
-            s1 = (s1 - offset) * scale;
-            s2 = (s2 - offset) * scale;
+            uint32_t block_count = dmMath::Min(MIX_BLOCK_FRAMES, mix_buffer_count - block);
+            GetMixScales(gain_ramp, pan_ramp, block, block_count, gains, left_scales, right_scales);
+            float* out = mix_buffer + 2 * block;
 
-            float left_scale, right_scale;
-            GetPanScale(pan, &left_scale, &right_scale);
+            for (uint32_t i = 0; i < block_count; i++)
+            {
+                float mix = frac * range_recip; // determines the bias between two consecutive samples in the sound instance. It ranges from 0-1. A mix of 0, makes only the first sample count while a mix of 0.5 will count equally both samples.
+                T s1 = frames[index];
+                T s2 = frames[index + 1];
+                s1 = (s1 - offset) * scale;
+                s2 = (s2 - offset) * scale;
 
-            float s = (1.0f - mix) * s1 + mix * s2; // resulting destination sample value is a mix of two source samples since a kind of fractional indexing is used
-            mix_buffer[2 * i] += s * gain * left_scale;
-            mix_buffer[2 * i + 1] += s * gain * right_scale;
+                float s = (1.0f - mix) * s1 + mix * s2; // resulting destination sample value is a mix of two source samples since a kind of fractional indexing is used
+                out[2 * i] += s * gains[i] * left_scales[i];
+                out[2 * i + 1] += s * gains[i] * right_scales[i];
 
-            prev_index = index; // keep old index for assertion
-            frac += delta;
+                prev_index = index; // keep old index for assertion
+                frac += delta;
 
-            index += (uint32_t)(frac >> RESAMPLE_FRACTION_BITS);
+                index += (uint32_t)(frac >> RESAMPLE_FRACTION_BITS);
 
-            frac &= ((1U << RESAMPLE_FRACTION_BITS) - 1U); // Keep lower RESAMPLE_FRACTION_BITS bits. Clear higher.
+                frac &= ((1U << RESAMPLE_FRACTION_BITS) - 1U); // Keep lower RESAMPLE_FRACTION_BITS bits. Clear higher.
+            }
         }
         instance->m_FrameFraction = frac;
 
@@ -947,34 +1572,39 @@ namespace dmSound
 
         Ramp gain_ramp = GetRamp(mix_context, &instance->m_Gain, mix_buffer_count);
         Ramp pan_ramp = GetRamp(mix_context, &instance->m_Pan, mix_buffer_count);
-        for (uint32_t i = 0; i < mix_buffer_count; i++)
+        float gains[MIX_BLOCK_FRAMES];
+        float left_scales[MIX_BLOCK_FRAMES];
+        float right_scales[MIX_BLOCK_FRAMES];
+        for (uint32_t block = 0; block < mix_buffer_count; block += MIX_BLOCK_FRAMES)
         {
-            float gain = gain_ramp.GetValue(i);
-            float pan = pan_ramp.GetValue(i);
-            float mix = frac * range_recip;
-            T sl1 = frames[2 * index];
-            T sl2 = frames[2 * index + 2];
-            sl1 = (sl1 - offset) * scale;
-            sl2 = (sl2 - offset) * scale;
+            uint32_t block_count = dmMath::Min(MIX_BLOCK_FRAMES, mix_buffer_count - block);
+            GetMixScales(gain_ramp, pan_ramp, block, block_count, gains, left_scales, right_scales);
+            float* out = mix_buffer + 2 * block;
 
-            T sr1 = frames[2 * index + 1];
-            T sr2 = frames[2 * index + 3];
-            sr1 = (sr1 - offset) * scale;
-            sr2 = (sr2 - offset) * scale;
-
-            float left_scale, right_scale;
-            GetPanScale(pan, &left_scale, &right_scale);
-
-            float sl = (1.0f - mix) * sl1 + mix * sl2;
-            float sr = (1.0f - mix) * sr1 + mix * sr2;
-            mix_buffer[2 * i]       += sl * gain * left_scale;
-            mix_buffer[2 * i + 1]   += sr * gain * right_scale;
-
-            prev_index = index;
-            frac += delta;
-            index += (uint32_t)(frac >> RESAMPLE_FRACTION_BITS);
-
-            frac &= ((1U << RESAMPLE_FRACTION_BITS) - 1U);
+            for (uint32_t i = 0; i < block_count; i++)
+            {
+                float mix = frac * range_recip;
+                T sl1 = frames[2 * index];
+                T sl2 = frames[2 * index + 2];
+                sl1 = (sl1 - offset) * scale;
+                sl2 = (sl2 - offset) * scale;
+
+                T sr1 = frames[2 * index + 1];
+                T sr2 = frames[2 * index + 3];
+                sr1 = (sr1 - offset) * scale;
+                sr2 = (sr2 - offset) * scale;
+
+                float sl = (1.0f - mix) * sl1 + mix * sl2;
+                float sr = (1.0f - mix) * sr1 + mix * sr2;
+                out[2 * i]       += sl * gains[i] * left_scales[i];
+                out[2 * i + 1]   += sr * gains[i] * right_scales[i];
+
+                prev_index = index;
+                frac += delta;
+                index += (uint32_t)(frac >> RESAMPLE_FRACTION_BITS);
+
+                frac &= ((1U << RESAMPLE_FRACTION_BITS) - 1U);
+            }
         }
         instance->m_FrameFraction = frac;
 
@@ -994,17 +1624,23 @@ namespace dmSound
         Ramp gain_ramp = GetRamp(mix_context, &instance->m_Gain, mix_buffer_count);
         Ramp pan_ramp = GetRamp(mix_context, &instance->m_Pan, mix_buffer_count);
 
-        for (uint32_t i = 0; i < mix_buffer_count; i++)
+        float gains[MIX_BLOCK_FRAMES];
+        float left_scales[MIX_BLOCK_FRAMES];
+        float right_scales[MIX_BLOCK_FRAMES];
+        for (uint32_t block = 0; block < mix_buffer_count; block += MIX_BLOCK_FRAMES)
         {
-            float gain = gain_ramp.GetValue(i);
-            float pan = pan_ramp.GetValue(i);
-            float s = frames[i];
-            s = (s - offset) * scale * gain;
+            uint32_t block_count = dmMath::Min(MIX_BLOCK_FRAMES, mix_buffer_count - block);
+            GetMixScales(gain_ramp, pan_ramp, block, block_count, gains, left_scales, right_scales);
+            const T* in = frames + block;
+            float* out = mix_buffer + 2 * block;
 
-            float left_scale, right_scale;
-            GetPanScale(pan, &left_scale, &right_scale);
-            mix_buffer[2 * i]       += s * left_scale;
-            mix_buffer[2 * i + 1]   += s * right_scale;
+            for (uint32_t i = 0; i < block_count; i++)
+            {
+                float s = in[i];
+                s = (s - offset) * scale * gains[i];
+                out[2 * i]       += s * left_scales[i];
+                out[2 * i + 1]   += s * right_scales[i];
+            }
         }
         instance->m_FrameCount -= mix_buffer_count;
     }
@@ -1019,19 +1655,25 @@ namespace dmSound
         Ramp gain_ramp = GetRamp(mix_context, &instance->m_Gain, mix_buffer_count);
         Ramp pan_ramp = GetRamp(mix_context, &instance->m_Pan, mix_buffer_count);
 
-        for (uint32_t i = 0; i < mix_buffer_count; i++)
+        float gains[MIX_BLOCK_FRAMES];
+        float left_scales[MIX_BLOCK_FRAMES];
+        float right_scales[MIX_BLOCK_FRAMES];
+        for (uint32_t block = 0; block < mix_buffer_count; block += MIX_BLOCK_FRAMES)
         {
-            float gain = gain_ramp.GetValue(i);
-            float pan = pan_ramp.GetValue(i);
-            float s1 = frames[2 * i];
-            float s2 = frames[2 * i + 1];
-            s1 = (s1 - offset) * scale * gain;
-            s2 = (s2 - offset) * scale * gain;
+            uint32_t block_count = dmMath::Min(MIX_BLOCK_FRAMES, mix_buffer_count - block);
+            GetMixScales(gain_ramp, pan_ramp, block, block_count, gains, left_scales, right_scales);
+            const T* in = frames + 2 * block;
+            float* out = mix_buffer + 2 * block;
 
-            float left_scale, right_scale;
-            GetPanScale(pan, &left_scale, &right_scale);
-            mix_buffer[2 * i]       += s1 * left_scale;
-            mix_buffer[2 * i + 1]   += s2 * right_scale;
+            for (uint32_t i = 0; i < block_count; i++)
+            {
+                float s1 = in[2 * i];
+                float s2 = in[2 * i + 1];
+                s1 = (s1 - offset) * scale * gains[i];
+                s2 = (s2 - offset) * scale * gains[i];
+                out[2 * i]       += s1 * left_scales[i];
+                out[2 * i + 1]   += s2 * right_scales[i];
+            }
         }
         instance->m_FrameCount -= mix_buffer_count;
     }
@@ -1098,7 +1740,7 @@ namespace dmSound
         mixer(mix_context, instance, rate, mix_rate, mix_buffer, mix_buffer_count);
     }
 
-    static void Mix(const MixContext* mix_context, SoundInstance* instance, const dmSoundCodec::Info* info)
+    static void Mix(const MixContext* mix_context, SoundInstance* instance, const dmSoundCodec::Info* info, VoiceMix* voice)
     {
         DM_PROFILE(__FUNCTION__);
 
@@ -1111,7 +1753,16 @@ namespace dmSound
         int* index = sound->m_GroupMap.Get(instance->m_Group);
         if (index) {
             SoundGroup* group = &sound->m_Groups[*index];
-            MixResample(mix_context, instance, info, sound->m_MixRate, group->m_MixBuffer, mix_count);
+            if (voice)
+            {
+                // Added to the group buffer after all voices are mixed, see MixInstancesParallel
+                MixResample(mix_context, instance, info, sound->m_MixRate, voice->m_MixBuffer, mix_count);
+                voice->m_Group = group;
+            }
+            else
+            {
+                MixResample(mix_context, instance, info, sound->m_MixRate, group->m_MixBuffer, mix_count);
+            }
         } else {
             dmLogError("Sound group not found");
         }
@@ -1147,7 +1798,35 @@ namespace dmSound
         return false;
     }
 
-    static void MixInstance(const MixContext* mix_context, SoundInstance* instance) {
+    // Drops the frames that Mix() would have consumed, without resampling them
+    static void SkipMix(SoundInstance* instance, const dmSoundCodec::Info* info)
+    {
+        SoundSystem* sound = g_SoundSystem;
+        if (instance->m_Speed == 0.0f)
+            return;
+
+        uint64_t delta = (uint32_t) ((((uint64_t) info->m_Rate) << RESAMPLE_FRACTION_BITS) / sound->m_MixRate);
+        uint32_t mix_count = ((uint64_t) (instance->m_FrameCount) << RESAMPLE_FRACTION_BITS) / (delta * instance->m_Speed);
+        mix_count = dmMath::Min(mix_count, sound->m_FrameCount);
+
+        uint32_t index = mix_count;
+        if (info->m_Rate != sound->m_MixRate || instance->m_Speed != 1.0f)
+        {
+            // Same stepping as the resampling mixers
+            uint64_t step = (((uint64_t) info->m_Rate) << RESAMPLE_FRACTION_BITS) / sound->m_MixRate;
+            step *= instance->m_Speed;
+            uint64_t frac = instance->m_FrameFraction + step * mix_count;
+            index = (uint32_t) (frac >> RESAMPLE_FRACTION_BITS);
+            instance->m_FrameFraction = frac & ((1U << RESAMPLE_FRACTION_BITS) - 1U);
+        }
+        index = dmMath::Min(index, instance->m_FrameCount);
+
+        const uint32_t stride = info->m_Channels * (info->m_BitsPerSample / 8);
+        memmove(instance->m_Frames, (char*) instance->m_Frames + index * stride, (instance->m_FrameCount - index) * stride);
+        instance->m_FrameCount -= index;
+    }
+
+    static void MixInstance(const MixContext* mix_context, SoundInstance* instance, VoiceMix* voice) {
         SoundSystem* sound = g_SoundSystem;
         uint32_t decoded = 0;
 
@@ -1167,12 +1846,16 @@ namespace dmSound
             return;
         }
 
-        bool is_muted = dmSound::IsMuted(instance);
+        // Virtual instances are skipped like muted ones, so that they continue in sync when they get a voice again
+        bool is_muted = instance->m_Virtual || dmSound::IsMuted(instance);
 
         dmSoundCodec::Result r = dmSoundCodec::RESULT_OK;
         uint32_t mixed_instance_FrameCount = ceilf(sound->m_FrameCount * dmMath::Max(1.0f, instance->m_Speed));
 
-        if (instance->m_FrameCount < mixed_instance_FrameCount && instance->m_Playing) {
+        // Rather than blocking the mix on a read, a streamed instance waits until its data is buffered
+        bool is_buffered = !instance->m_StreamBuffer || dmSoundCodec::StreamIsReady(instance->m_StreamBuffer);
+
+        if (instance->m_FrameCount < mixed_instance_FrameCount && instance->m_Playing && is_buffered) {
 
             const uint32_t stride = info.m_Channels * (info.m_BitsPerSample / 8);
             uint32_t n = mixed_instance_FrameCount - instance->m_FrameCount; // if the result contains a fractional part and we don't ceil(), we'll end up with a smaller number. Later, when deciding the mix_count in Mix(), a smaller value (integer) will be produced. This will result in leaving a small gap in the mix buffer resulting in sound crackling when the chunk changes.
@@ -1239,7 +1922,12 @@ namespace dmSound
         }
 
         if (instance->m_FrameCount > 0)
-            Mix(mix_context, instance, &info);
+        {
+            if (instance->m_Virtual)
+                SkipMix(instance, &info);
+            else
+                Mix(mix_context, instance, &info, voice);
+        }
 
         if (instance->m_FrameCount <= 1 && instance->m_EndOfStream) {
             // NOTE: Due to round-off errors, e.g 32000 -> 44100,
@@ -1249,6 +1937,175 @@ namespace dmSound
         }
     }
 
+    static int VoiceMixJob(void* context, void* data)
+    {
+        (void)context;
+        VoiceMix* voice = (VoiceMix*) data;
+        MixInstance(voice->m_MixContext, voice->m_Instance, voice);
+        return 0;
+    }
+
+    // Each voice decodes and resamples into its own buffer on the job thread. The buffers are then
+    // added to the group buffers in instance order, so the output does not depend on the job scheduling.
+    static void MixInstancesParallel(const MixContext* mix_context)
+    {
+        SoundSystem* sound = g_SoundSystem;
+        uint32_t frame_count = sound->m_FrameCount;
+
+        dmArray<VoiceMix>& voices = sound->m_VoiceMixes;
+        voices.SetSize(0);
+        uint32_t instances = sound->m_Instances.Size();
+        for (uint32_t i = 0; i < instances; ++i) {
+            SoundInstance* instance = &sound->m_Instances[i];
+            if (instance->m_Virtual)
+            {
+                // Only skips frames, so there is no need for a job or a buffer
+                MixInstance(mix_context, instance, 0);
+            }
+            else if (instance->m_Playing || instance->m_FrameCount > 0)
+            {
+                if (voices.Full())
+                    voices.OffsetCapacity(16);
+                VoiceMix voice;
+                voice.m_MixContext = mix_context;
+                voice.m_Instance = instance;
+                voice.m_MixBuffer = 0;
+                voice.m_Group = 0;
+                voices.Push(voice);
+            }
+        }
+
+        uint32_t voice_count = voices.Size();
+        uint32_t voice_buffer_size = frame_count * SOUND_MAX_MIX_CHANNELS;
+        dmArray<float>& buffers = sound->m_VoiceMixBuffers;
+        if (buffers.Capacity() < voice_count * voice_buffer_size)
+            buffers.SetCapacity(voice_count * voice_buffer_size);
+        buffers.SetSize(voice_count * voice_buffer_size);
+        if (voice_count > 0)
+            memset(buffers.Begin(), 0, voice_count * voice_buffer_size * sizeof(float));
+
+        dmJobThread::JobGroup group;
+        dmJobThread::InitGroup(&group, 0);
+        for (uint32_t i = 0; i < voice_count; ++i)
+        {
+            VoiceMix* voice = &voices[i];
+            voice->m_MixBuffer = buffers.Begin() + i * voice_buffer_size;
+            dmJobThread::PushGroupJob(sound->m_JobThread, &group, VoiceMixJob, 0, (void*) voice);
+        }
+
+        {
+            // The sound thread works on the voices too while waiting, so it never waits for unrelated jobs to finish first
+            DM_PROFILE("WaitVoiceMixJobs");
+            dmJobThread::WaitGroup(sound->m_JobThread, &group);
+        }
+
+        for (uint32_t i = 0; i < voice_count; ++i)
+        {
+            VoiceMix* voice = &voices[i];
+            if (voice->m_Group)
+            {
+                float* out = voice->m_Group->m_MixBuffer;
+                const float* in = voice->m_MixBuffer;
+                for (uint32_t j = 0; j < voice_buffer_size; ++j)
+                {
+                    out[j] += in[j];
+                }
+            }
+        }
+
+        for (uint32_t i = 0; i < instances; ++i) {
+            SoundInstance* instance = &sound->m_Instances[i];
+            if (instance->m_EndOfStream && instance->m_FrameCount == 0) {
+                instance->m_Playing = 0;
+            }
+        }
+    }
+
+    // How loud the instance is, before panning
+    static float GetAudibility(SoundSystem* sound, SoundInstance* instance)
+    {
+        if (instance->m_Speed == 0.0f)
+            return 0.0f;
+        float gain = instance->m_Gain.m_Current;
+        int* group_index = sound->m_GroupMap.Get(instance->m_Group);
+        if (group_index)
+            gain *= sound->m_Groups[*group_index].m_Gain.m_Current;
+        return gain;
+    }
+
+    struct VoiceOrderPred
+    {
+        SoundSystem* m_Sound;
+        bool operator()(SoundInstance* a, SoundInstance* b) const
+        {
+            if (a->m_Priority != b->m_Priority)
+                return a->m_Priority > b->m_Priority;
+            float audibility_a = GetAudibility(m_Sound, a);
+            float audibility_b = GetAudibility(m_Sound, b);
+            if (audibility_a != audibility_b)
+                return audibility_a > audibility_b;
+            return a->m_Index < b->m_Index;
+        }
+    };
+
+    // Picks the playing instances that are mixed, by priority and then by gain, within the max voices of the
+    // system and of their groups. The rest are virtual: they keep playing, but are not decoded
+    static void UpdateVoices(SoundSystem* sound)
+    {
+        DM_PROFILE(__FUNCTION__);
+
+        bool group_limits = false;
+        for (uint32_t i = 0; i < MAX_GROUPS; i++) {
+            SoundGroup* g = &sound->m_Groups[i];
+            g->m_VoiceCount = 0;
+            group_limits |= g->m_MaxVoices > 0;
+        }
+
+        dmArray<SoundInstance*>& order = sound->m_VoiceOrder;
+        order.SetSize(0);
+        uint32_t instances = sound->m_Instances.Size();
+        for (uint32_t i = 0; i < instances; ++i) {
+            SoundInstance* instance = &sound->m_Instances[i];
+            if (instance->m_Playing || instance->m_FrameCount > 0)
+            {
+                order.Push(instance);
+            }
+            else
+            {
+                instance->m_Virtual = 0;
+            }
+        }
+
+        uint32_t max_voices = sound->m_MaxVoices > 0 ? sound->m_MaxVoices : order.Size();
+        if (!group_limits && order.Size() <= max_voices)
+        {
+            for (uint32_t i = 0; i < order.Size(); ++i)
+                order[i]->m_Virtual = 0;
+            return;
+        }
+
+        VoiceOrderPred pred;
+        pred.m_Sound = sound;
+        std::sort(order.Begin(), order.End(), pred);
+
+        uint32_t voice_count = 0;
+        for (uint32_t i = 0; i < order.Size(); ++i)
+        {
+            SoundInstance* instance = order[i];
+            int* group_index = sound->m_GroupMap.Get(instance->m_Group);
+            SoundGroup* group = group_index ? &sound->m_Groups[*group_index] : 0;
+
+            bool audible = voice_count < max_voices && (!group || group->m_MaxVoices == 0 || group->m_VoiceCount < group->m_MaxVoices);
+            instance->m_Virtual = audible ? 0 : 1;
+            if (audible)
+            {
+                voice_count++;
+                if (group)
+                    group->m_VoiceCount++;
+            }
+        }
+    }
+
     static void MixInstances(const MixContext* mix_context)
     {
         DM_PROFILE(__FUNCTION__);
@@ -1286,12 +2143,20 @@ namespace dmSound
             }
         }
 
+        UpdateVoices(sound);
+
+        if (sound->m_JobThread)
+        {
+            MixInstancesParallel(mix_context);
+            return;
+        }
+
         uint32_t instances = sound->m_Instances.Size();
         for (uint32_t i = 0; i < instances; ++i) {
             SoundInstance* instance = &sound->m_Instances[i];
             if (instance->m_Playing || instance->m_FrameCount > 0)
             {
-                MixInstance(mix_context, instance);
+                MixInstance(mix_context, instance, 0);
             }
 
             if (instance->m_EndOfStream && instance->m_FrameCount == 0) {
@@ -1300,6 +2165,37 @@ namespace dmSound
         }
     }
 
+    // Applies the master gain, and converts the mix to 16 bit samples, clamped to the 16 bit range
+    static void ConvertMasterOutput(const Ramp& ramp, const float* mix_buffer, int16_t* out, uint32_t n)
+    {
+        uint32_t i = 0;
+#if defined(__wasm_simd128__)
+        // Four frames at a time. The float to int conversion and the narrowing to 16 bit both saturate,
+        // and truncate like the scalar cast
+        for (; i + 4 <= n; i += 4)
+        {
+            float g0 = ramp.GetValue(i);
+            float g1 = ramp.GetValue(i + 1);
+            float g2 = ramp.GetValue(i + 2);
+            float g3 = ramp.GetValue(i + 3);
+            v128_t a = wasm_f32x4_mul(wasm_v128_load(mix_buffer + 2 * i), wasm_f32x4_make(g0, g0, g1, g1));
+            v128_t b = wasm_f32x4_mul(wasm_v128_load(mix_buffer + 2 * i + 4), wasm_f32x4_make(g2, g2, g3, g3));
+            wasm_v128_store(out + 2 * i, wasm_i16x8_narrow_i32x4(wasm_i32x4_trunc_sat_f32x4(a), wasm_i32x4_trunc_sat_f32x4(b)));
+        }
+#endif
+        for (; i < n; i++) {
+            float gain = ramp.GetValue(i);
+            float s1 = mix_buffer[2 * i] * gain;
+            float s2 = mix_buffer[2 * i + 1] * gain;
+            s1 = dmMath::Min(32767.0f, s1);
+            s1 = dmMath::Max(-32768.0f, s1);
+            s2 = dmMath::Min(32767.0f, s2);
+            s2 = dmMath::Max(-32768.0f, s2);
+            out[2 * i] = (int16_t) s1;
+            out[2 * i + 1] = (int16_t) s2;
+        }
+    }
+
     static void Master(const MixContext* mix_context)
     {
         DM_PROFILE(__FUNCTION__);
@@ -1332,29 +2228,31 @@ namespace dmSound
                 continue;
             }
             Ramp ramp = GetRamp(mix_context, &g->m_Gain, n);
-            for (uint32_t i = 0; i < n; i++) {
-                float gain = ramp.GetValue(i);
-                gain = dmMath::Clamp(gain, 0.0f, 1.0f);
-
-                float s1 = g->m_MixBuffer[2 * i];
-                float s2 = g->m_MixBuffer[2 * i + 1];
-                mix_buffer[2 * i] += s1 * gain;
-                mix_buffer[2 * i + 1] += s2 * gain;
+            const float* group_buffer = g->m_MixBuffer;
+            if (ramp.m_From == ramp.m_To)
+            {
+                // Constant gain, a plain multiply-add over the interleaved samples
+                float gain = dmMath::Clamp(ramp.m_From, 0.0f, 1.0f);
+                for (uint32_t i = 0; i < 2 * n; i++) {
+                    mix_buffer[i] += group_buffer[i] * gain;
+                }
+            }
+            else
+            {
+                for (uint32_t i = 0; i < n; i++) {
+                    float gain = ramp.GetValue(i);
+                    gain = dmMath::Clamp(gain, 0.0f, 1.0f);
+
+                    float s1 = group_buffer[2 * i];
+                    float s2 = group_buffer[2 * i + 1];
+                    mix_buffer[2 * i] += s1 * gain;
+                    mix_buffer[2 * i + 1] += s2 * gain;
+                }
             }
         }
 
         Ramp ramp = GetRamp(mix_context, &master->m_Gain, n);
-        for (uint32_t i = 0; i < n; i++) {
-            float gain = ramp.GetValue(i);
-            float s1 = mix_buffer[2 * i] * gain;
-            float s2 = mix_buffer[2 * i + 1] * gain;
-            s1 = dmMath::Min(32767.0f, s1);
-            s1 = dmMath::Max(-32768.0f, s1);
-            s2 = dmMath::Min(32767.0f, s2);
-            s2 = dmMath::Max(-32768.0f, s2);
-            out[2 * i] = (int16_t) s1;
-            out[2 * i + 1] = (int16_t) s2;
-        }
+        ConvertMasterOutput(ramp, mix_buffer, out, n);
     }
 
     static void StepGroupValues()
@@ -1458,6 +2356,7 @@ namespace dmSound
 
         uint32_t free_slots = sound->m_DeviceType->m_FreeBufferSlots(sound->m_Device);
         if (free_slots > 0) {
+            UpdateSpatial(sound);
             StepGroupValues();
             StepInstanceValues();
         }
@@ -1550,4 +2449,17 @@ namespace dmSound
     {
         return data->m_RefCount;
     }
+
+    // Unit tests
+    uint32_t GetPcmCacheSize()
+    {
+        return g_SoundSystem->m_PcmCacheSize;
+    }
+
+    // Unit tests
+    bool IsVirtual(HSoundInstance instance)
+    {
+        DM_MUTEX_OPTIONAL_SCOPED_LOCK(g_SoundSystem->m_Mutex);
+        return instance->m_Virtual;
+    }
 }
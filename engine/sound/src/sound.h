@@ -17,6 +17,7 @@
 
 #include <dlib/configfile.h>
 #include <dlib/hash.h>
+#include <dlib/job_thread.h>
 
 #include <dmsdk/dlib/vmath.h>
 
@@ -29,6 +30,8 @@ namespace dmSound
     {
         SOUND_DATA_TYPE_WAV        = 0,
         SOUND_DATA_TYPE_OGG_VORBIS = 1,
+        SOUND_DATA_TYPE_AAC        = 2,
+        SOUND_DATA_TYPE_OPUS       = 3,
     };
 
     enum Parameter
@@ -67,8 +70,18 @@ namespace dmSound
 
     const uint32_t MAX_GROUPS = 32;
 
-    // TODO:
-    // - Music streaming.
+    /**
+     * Reads the encoded data of a streamed sound. Called from the stream job thread, so it has to be thread safe
+     * @param context the user context
+     * @param offset offset in the sound data
+     * @param buffer buffer to read to
+     * @param size number of bytes to read
+     * @param nread number of bytes read (out). Less than size at the end of the data
+     * @return false on error
+     */
+    typedef bool (*FSoundDataRead)(void* context, uint32_t offset, void* buffer, uint32_t size, uint32_t* nread);
+    // Called when the streamed sound data is deleted
+    typedef void (*FSoundDataRelease)(void* context);
 
     struct InitializeParams;
     void SetDefaultInitializeParams(InitializeParams* params);
@@ -83,6 +96,17 @@ namespace dmSound
         uint32_t m_BufferSize;
         uint32_t m_FrameCount;
         uint32_t m_MaxInstances;
+        // Size in bytes of the cache of decoded ogg sounds. 0 disables the cache
+        uint32_t m_PcmCacheSize;
+        // Larger sounds (in decoded bytes) are never cached
+        uint32_t m_PcmCacheMaxSoundSize;
+        // Optional. If set, the sound instances are decoded and resampled in parallel on the job thread
+        dmJobThread::HContext m_JobThread;
+        // Optional. If set, streamed sound data is read on the job thread. Otherwise it's read when it's decoded
+        dmJobThread::HContext m_StreamJobThread;
+        // Max number of playing instances that are decoded and mixed. The others are virtual, and only advance
+        // their position until they are among the highest priority/loudest again. 0 means no limit
+        uint32_t m_MaxVoices;
         bool     m_UseThread;
 
         InitializeParams()
@@ -102,6 +126,10 @@ namespace dmSound
 
     // Thread safe
     Result NewSoundData(const void* sound_buffer, uint32_t sound_buffer_size, SoundDataType type, HSoundData* sound_data, dmhash_t name);
+    // Creates sound data that is read while it's played, instead of being kept in memory.
+    // The header is copied, and decoders are opened from it. The rest of the data is read using the callback.
+    // Returns RESULT_UNSUPPORTED if the type can't be streamed, in which case the release callback isn't called
+    Result NewSoundDataStreaming(const void* header, uint32_t header_size, uint32_t sound_size, FSoundDataRead read, FSoundDataRelease release, void* context, SoundDataType type, HSoundData* sound_data, dmhash_t name);
     Result SetSoundData(HSoundData sound_data, const void* sound_buffer, uint32_t sound_buffer_size);
     uint32_t GetSoundResourceSize(HSoundData sound_data);
     Result DeleteSoundData(HSoundData sound_data);
@@ -115,6 +143,9 @@ namespace dmSound
     Result AddGroup(const char* group);
     Result SetGroupGain(dmhash_t group_hash, float gain);
     Result GetGroupGain(dmhash_t group_hash, float* gain);
+    // Max number of instances of the group that are mixed, see InitializeParams::m_MaxVoices. 0 means no limit
+    Result SetGroupMaxVoices(dmhash_t group_hash, uint32_t max_voices);
+    Result GetGroupMaxVoices(dmhash_t group_hash, uint32_t* max_voices);
     Result GetGroupHashes(uint32_t* count, dmhash_t* buffer);
 
     Result GetGroupRMS(dmhash_t group_hash, float window, float* rms_left, float* rms_right);
@@ -127,8 +158,19 @@ namespace dmSound
     uint32_t GetAndIncreasePlayCounter();
 
     Result SetLooping(HSoundInstance sound_instance, bool looping, int8_t loopcount);
+    // Instances with higher priority are mixed first, when more instances than the max voices are playing. Default is 0
+    Result SetPriority(HSoundInstance sound_instance, uint8_t priority);
 
     Result SetParameter(HSoundInstance sound_instance, Parameter parameter, const dmVMath::Vector4& value);
+
+    // Spatial instances get their gain and pan from their position relative to the listener, computed for all of them
+    // at once on each update. The gain is 1 within min_distance, and falls off linearly to 0 at max_distance.
+    // The gain and pan set with SetParameter are applied on top
+    Result SetSpatial(HSoundInstance sound_instance, bool spatial, float min_distance, float max_distance);
+    // Sets the positions of a batch of instances, under one lock
+    Result SetPositions(const HSoundInstance* sound_instances, const dmVMath::Point3* positions, uint32_t count);
+    // The listener is at the origin, facing -z with +x to the right, by default
+    Result SetListener(const dmVMath::Point3& position, const dmVMath::Quat& rotation);
     Result GetParameter(HSoundInstance sound_instance, Parameter parameter, dmVMath::Vector4& value);
 
     // Platform dependent
@@ -150,11 +192,18 @@ namespace dmSound
      */
     struct OpenDeviceParams
     {
-        OpenDeviceParams() : m_BufferCount(0), m_FrameCount(0)
+        OpenDeviceParams() : m_BufferCount(0), m_FrameCount(0), m_DeviceBufferFrames(0), m_LowLatency(true), m_Exclusive(false)
         {
         }
         uint32_t m_BufferCount;
         uint32_t m_FrameCount;
+        // The options below are for the callback driven devices, that pull the queued frames from their own thread
+        // Size of the buffer of the device, in frames. 0 lets the device pick the lowest size that doesn't glitch
+        uint32_t m_DeviceBufferFrames;
+        // Use the low latency device, if there is one. Otherwise the next device with the same name is used
+        bool     m_LowLatency;
+        // Ask for exclusive access to the output, bypassing the system mixer. Not all devices support it
+        bool     m_Exclusive;
     };
 
     /**
@@ -90,6 +90,37 @@ namespace dmSoundCodec
         return RESULT_OK;
     }
 
+    Result NewDecoder(HCodecContext context, Format format, HStreamBuffer stream, HDecoder* decoder)
+    {
+        if (context->m_DecodersPool.Remaining() == 0) {
+            return RESULT_OUT_OF_RESOURCES;
+        }
+
+        const DecoderInfo* decoderImpl = FindBestStreamDecoder(format);
+        if (!decoderImpl) {
+            return RESULT_UNSUPPORTED;
+        }
+
+        uint16_t index = context->m_DecodersPool.Pop();
+        Decoder* d = &context->m_Decoders[index];
+        d->m_Index = index;
+        d->m_DecoderInfo = decoderImpl;
+
+        Result r = decoderImpl->m_OpenStreamBuffer(stream, &d->m_Stream);
+        if (r != RESULT_OK) {
+            context->m_DecodersPool.Push(index);
+            return r;
+        }
+
+        *decoder = d;
+        return RESULT_OK;
+    }
+
+    bool HasStreamDecoder(Format format)
+    {
+        return FindBestStreamDecoder(format) != 0;
+    }
+
     void GetInfo(HCodecContext context, HDecoder decoder, Info* info)
     {
         assert(decoder);
@@ -15,6 +15,8 @@
 #ifndef DM_SOUND_CODEC_H
 #define DM_SOUND_CODEC_H
 
+#include "sound_stream.h"
+
 /**
  * Sound decoding support
  */
@@ -45,6 +47,8 @@ namespace dmSoundCodec
     {
         FORMAT_WAV,   //!< FORMAT_WAV
         FORMAT_VORBIS,//!< FORMAT_VORBIS
+        FORMAT_AAC,   //!< FORMAT_AAC. Only decoded on platforms with a native decoder
+        FORMAT_OPUS,  //!< FORMAT_OPUS
     };
 
     /**
@@ -100,6 +104,23 @@ namespace dmSoundCodec
      */
     Result NewDecoder(HCodecContext context, Format format, const void* buffer, uint32_t buffer_size, HDecoder* decoder);
 
+    /**
+     * Create a new decoder, for data that is read while decoding
+     * @param context context
+     * @param format format
+     * @param stream stream buffer. Must outlive the decoder
+     * @param decoder decoder (out)
+     * @return RESULT_OK on success. RESULT_UNSUPPORTED if no decoder can decode streamed data of the format
+     */
+    Result NewDecoder(HCodecContext context, Format format, HStreamBuffer stream, HDecoder* decoder);
+
+    /**
+     * Check if there is a decoder for streamed data of the format
+     * @param format format
+     * @return true if streamed data of the format can be decoded
+     */
+    bool HasStreamDecoder(Format format);
+
     /**
      * Delete decoder
      * @param context context
@@ -46,7 +46,7 @@ namespace dmSoundCodec
         return 0;
     }
 
-    const DecoderInfo* FindBestDecoder(Format format)
+    static const DecoderInfo* FindBestDecoder(Format format, bool streamed)
     {
         // All decoders contain a score, now pick the decoder with highest score
         // with matching format.
@@ -56,7 +56,7 @@ namespace dmSoundCodec
 
         while (decoder)
         {
-            if (decoder->m_Format != format)
+            if (decoder->m_Format != format || (streamed && !decoder->m_OpenStreamBuffer))
             {
                 decoder = decoder->m_Next;
                 continue;
@@ -71,7 +71,18 @@ namespace dmSoundCodec
             decoder = decoder->m_Next;
         }
 
+        return best;
+    }
+
+    const DecoderInfo* FindBestDecoder(Format format)
+    {
+        const DecoderInfo* best = FindBestDecoder(format, false);
         assert(best != 0);
         return best;
     }
+
+    const DecoderInfo* FindBestStreamDecoder(Format format)
+    {
+        return FindBestDecoder(format, true);
+    }
 }
@@ -18,6 +18,7 @@
 #include "sound_codec.h"
 #include "sound_decoder.h"
 #include "sound.h"
+#include "sound_stream.h"
 
 namespace dmSoundCodec
 {
@@ -51,6 +52,11 @@ namespace dmSoundCodec
          */
         Result (*m_OpenStream)(const void* buffer, const uint32_t size, HDecodeStream* out);
 
+        /**
+         * Open a stream for decoding data that is read while decoding. Optional
+         */
+        Result (*m_OpenStreamBuffer)(HStreamBuffer stream, HDecodeStream* out);
+
         /**
          * Close and free decoding resources
          */
@@ -95,6 +101,11 @@ namespace dmSoundCodec
      */
     const DecoderInfo* FindBestDecoder(Format format);
 
+    /**
+     * Finds the best match among the decoders that can decode streamed data. Returns 0 if there is none
+     */
+    const DecoderInfo* FindBestStreamDecoder(Format format);
+
     /**
      * Get by name of implementation
      */
@@ -112,12 +123,13 @@ namespace dmSoundCodec
     /**
      * Declare a new stream decoder
      */
-    #define DM_DECLARE_SOUND_DECODER(symbol, name, format, score, open, close, decode, reset, skip, getinfo, get_internal_pos) \
+    #define DM_DECLARE_SOUND_DECODER(symbol, name, format, score, open, open_stream_buffer, close, decode, reset, skip, getinfo, get_internal_pos) \
             dmSoundCodec::DecoderInfo DM_SOUND_PASTE2(symbol, __LINE__) = { \
                     name, \
                     format, \
                     score, \
                     open, \
+                    open_stream_buffer, \
                     close, \
                     decode, \
                     reset, \
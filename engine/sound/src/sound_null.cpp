@@ -73,6 +73,13 @@ namespace dmSound
         return result;
     }
 
+    Result NewSoundDataStreaming(const void* header, uint32_t header_size, uint32_t sound_size, FSoundDataRead read, FSoundDataRelease release, void* context, SoundDataType type, HSoundData* sound_data, dmhash_t name)
+    {
+        // Nothing is played, so the sound is never read
+        *sound_data = 0;
+        return RESULT_UNSUPPORTED;
+    }
+
     Result SetSoundData(HSoundData sound_data, const void* sound_buffer, uint32_t sound_buffer_size)
     {
         if (sound_data->m_Buffer != 0x0)
@@ -154,6 +161,21 @@ namespace dmSound
         return RESULT_OK;
     }
 
+    Result SetGroupMaxVoices(dmhash_t group_hash, uint32_t max_voices)
+    {
+        // NOTE: Not supported.
+        // sound_null is deprecated and should be replaced by sound2 with null-device
+        return RESULT_OK;
+    }
+
+    Result GetGroupMaxVoices(dmhash_t group_hash, uint32_t* max_voices)
+    {
+        // NOTE: Not supported.
+        // sound_null is deprecated and should be replaced by sound2 with null-device
+        *max_voices = 0;
+        return RESULT_OK;
+    }
+
     Result GetGroupGain(dmhash_t group_hash, float* gain)
     {
         // NOTE: Not supported.
@@ -222,6 +244,11 @@ namespace dmSound
         return RESULT_OK;
     }
 
+    Result SetPriority(HSoundInstance sound_instance, uint8_t priority)
+    {
+        return RESULT_OK;
+    }
+
     Result SetParameter(HSoundInstance sound_instance, Parameter parameter, const Vector4& value)
     {
         sound_instance->m_Parameters[parameter] = value;
@@ -234,6 +261,21 @@ namespace dmSound
         return RESULT_OK;
     }
 
+    Result SetSpatial(HSoundInstance sound_instance, bool spatial, float min_distance, float max_distance)
+    {
+        return RESULT_OK;
+    }
+
+    Result SetPositions(const HSoundInstance* sound_instances, const Point3* positions, uint32_t count)
+    {
+        return RESULT_OK;
+    }
+
+    Result SetListener(const Point3& position, const Quat& rotation)
+    {
+        return RESULT_OK;
+    }
+
     bool IsMusicPlaying()
     {
         return false;
@@ -31,6 +31,8 @@ namespace dmSound
     // Unit tests
     int64_t GetInternalPos(HSoundInstance);
     int32_t GetRefCount(HSoundData);
+    uint32_t GetPcmCacheSize();
+    bool IsVirtual(HSoundInstance);
 }
 
 #endif // #ifndef DM_SOUND_PRIVATE_H
@@ -0,0 +1,295 @@
+// Copyright 2020-2024 The Defold Foundation
+// Copyright 2014-2020 King
+// Copyright 2009-2014 Ragnar Svensson, Christian Murray
+// Licensed under the Defold License version 1.0 (the "License"); you may not use
+// this file except in compliance with the License.
+//
+// You may obtain a copy of the License, together with FAQs at
+// https://www.defold.com/license
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include <stdlib.h>
+#include <string.h>
+#include <dlib/atomic.h>
+#include <dlib/log.h>
+#include <dlib/math.h>
+#include <dlib/memory.h>
+#include <dlib/mutex.h>
+#include <dlib/profile.h>
+#include <dlib/time.h>
+
+#include "sound_stream.h"
+
+namespace dmSoundCodec
+{
+    // The ring buffer is read ahead in chunks of this fraction of the capacity
+    static const uint32_t CHUNK_COUNT = 4;
+
+    struct StreamBuffer
+    {
+        StreamSource            m_Source;
+        // 0 if the data is read on the decoding thread
+        dmJobThread::HContext   m_JobContext;
+        dmMutex::HMutex         m_Mutex;
+        uint8_t*                m_Data;
+        uint32_t                m_Capacity;
+        uint32_t                m_ChunkSize;
+        uint32_t                m_Cursor;
+        // The ring buffer holds the data in [m_Begin, m_End). The data before the cursor is released
+        uint32_t                m_Begin;
+        uint32_t                m_End;
+        // Increased when the buffered data is dropped, so that the read in flight is discarded
+        uint32_t                m_Generation;
+        // The read in flight
+        uint32_t                m_ReadOffset;
+        uint32_t                m_ReadSize;
+        uint32_t                m_ReadGeneration;
+        int32_atomic_t          m_ReadPending;
+        uint8_t                 m_Error : 1;
+    };
+
+    // Reads into the ring buffer, at the position of the offset
+    static bool ReadToRing(const StreamSource* source, uint8_t* ring, uint32_t capacity, uint32_t offset, uint32_t size, uint32_t* nread)
+    {
+        uint32_t pos = offset % capacity;
+        uint32_t first = dmMath::Min(size, capacity - pos);
+        bool ok = source->m_Read(source->m_Context, offset, ring + pos, first, nread);
+        if (ok && *nread == first && first < size)
+        {
+            uint32_t n = 0;
+            ok = source->m_Read(source->m_Context, offset + first, ring, size - first, &n);
+            *nread += n;
+        }
+        return ok;
+    }
+
+    static void CopyFromRing(const StreamBuffer* stream, uint32_t offset, uint8_t* buffer, uint32_t size)
+    {
+        uint32_t pos = offset % stream->m_Capacity;
+        uint32_t first = dmMath::Min(size, stream->m_Capacity - pos);
+        memcpy(buffer, stream->m_Data + pos, first);
+        memcpy(buffer + first, stream->m_Data, size - first);
+    }
+
+    // Drops the buffered data, and continues reading ahead from the offset. Assumes the mutex is held
+    static void RestartAt(StreamBuffer* stream, uint32_t offset)
+    {
+        offset = dmMath::Max(offset, stream->m_Source.m_HeaderSize);
+        stream->m_Begin = offset;
+        stream->m_End = offset;
+        stream->m_Generation++;
+    }
+
+    static void ReadChunk(StreamBuffer* stream)
+    {
+        DM_PROFILE(__FUNCTION__);
+
+        uint32_t nread = 0;
+        bool ok = ReadToRing(&stream->m_Source, stream->m_Data, stream->m_Capacity, stream->m_ReadOffset, stream->m_ReadSize, &nread);
+        {
+            DM_MUTEX_SCOPED_LOCK(stream->m_Mutex);
+            if (stream->m_ReadGeneration == stream->m_Generation)
+            {
+                if (!ok || nread < stream->m_ReadSize)
+                {
+                    dmLogError("Failed to read %u bytes of streamed sound data at offset %u", stream->m_ReadSize, stream->m_ReadOffset);
+                    stream->m_Error = 1;
+                }
+                stream->m_End += nread;
+            }
+        }
+        // Last, as the stream may be deleted as soon as there is no read in flight
+        dmAtomicStore32(&stream->m_ReadPending, 0);
+    }
+
+    static int ReadChunkJob(void* context, void* data)
+    {
+        (void)data;
+        ReadChunk((StreamBuffer*) context);
+        return 0;
+    }
+
+    // Starts reading the next chunk, if there is room for it
+    static void ReadAhead(StreamBuffer* stream)
+    {
+        {
+            DM_MUTEX_SCOPED_LOCK(stream->m_Mutex);
+            if (dmAtomicGet32(&stream->m_ReadPending) || stream->m_Error || stream->m_End >= stream->m_Source.m_Size)
+                return;
+            if (stream->m_Capacity - (stream->m_End - stream->m_Begin) < stream->m_ChunkSize)
+                return;
+
+            stream->m_ReadOffset = stream->m_End;
+            stream->m_ReadSize = dmMath::Min(stream->m_ChunkSize, stream->m_Source.m_Size - stream->m_End);
+            stream->m_ReadGeneration = stream->m_Generation;
+            dmAtomicStore32(&stream->m_ReadPending, 1);
+        }
+
+        if (stream->m_JobContext)
+            dmJobThread::PushJob(stream->m_JobContext, ReadChunkJob, 0, stream, 0);
+        else
+            ReadChunk(stream);
+    }
+
+    HStreamBuffer NewStreamBuffer(const StreamSource* source, uint32_t capacity, dmJobThread::HContext job_context)
+    {
+        StreamBuffer* stream = new StreamBuffer;
+        memset(stream, 0, sizeof(*stream));
+        stream->m_Source = *source;
+        // Without worker threads, the job would only run on the main thread, where we can't wait for it
+        stream->m_JobContext = job_context && dmJobThread::GetWorkerCount(job_context) > 0 ? job_context : 0;
+        stream->m_Mutex = dmMutex::New();
+        stream->m_ChunkSize = dmMath::Max(1u, capacity / CHUNK_COUNT);
+        stream->m_Capacity = stream->m_ChunkSize * CHUNK_COUNT;
+        stream->m_Data = (uint8_t*) malloc(stream->m_Capacity);
+        dmMemory::TrackAlloc(dmMemory::CATEGORY_SOUND, stream->m_Capacity);
+        RestartAt(stream, 0);
+
+        // Start reading while the header is being decoded
+        ReadAhead(stream);
+        return stream;
+    }
+
+    void DeleteStreamBuffer(HStreamBuffer stream)
+    {
+        while (dmAtomicGet32(&stream->m_ReadPending))
+        {
+            dmTime::Sleep(100);
+        }
+        dmMutex::Delete(stream->m_Mutex);
+        free(stream->m_Data);
+        dmMemory::TrackFree(dmMemory::CATEGORY_SOUND, stream->m_Capacity);
+        delete stream;
+    }
+
+    // Copies from the header or the ring buffer, without waiting for any reads
+    static uint32_t ReadBuffered(StreamBuffer* stream, uint8_t* buffer, uint32_t size)
+    {
+        const StreamSource* source = &stream->m_Source;
+        uint32_t cursor = stream->m_Cursor;
+        if (cursor < source->m_HeaderSize)
+        {
+            uint32_t n = dmMath::Min(size, source->m_HeaderSize - cursor);
+            memcpy(buffer, (const uint8_t*) source->m_Header + cursor, n);
+            stream->m_Cursor += n;
+            return n;
+        }
+
+        DM_MUTEX_SCOPED_LOCK(stream->m_Mutex);
+        if (cursor < stream->m_Begin || cursor >= stream->m_End)
+            return 0;
+
+        uint32_t n = dmMath::Min(size, stream->m_End - cursor);
+        CopyFromRing(stream, cursor, buffer, n);
+        stream->m_Cursor += n;
+        stream->m_Begin = stream->m_Cursor;
+        return n;
+    }
+
+    uint32_t StreamRead(HStreamBuffer stream, void* _buffer, uint32_t size)
+    {
+        uint8_t* buffer = (uint8_t*) _buffer;
+        size = dmMath::Min(size, stream->m_Source.m_Size - dmMath::Min(stream->m_Cursor, stream->m_Source.m_Size));
+        if (size == 0 || stream->m_Error)
+            return 0;
+
+        uint32_t n = ReadBuffered(stream, buffer, size);
+        if (n == 0)
+        {
+            // The chunk at the cursor is already on its way
+            bool pending = false;
+            {
+                DM_MUTEX_SCOPED_LOCK(stream->m_Mutex);
+                pending = dmAtomicGet32(&stream->m_ReadPending) && stream->m_Cursor == stream->m_End && stream->m_ReadGeneration == stream->m_Generation;
+            }
+            if (pending)
+            {
+                DM_PROFILE("WaitForRead");
+                while (dmAtomicGet32(&stream->m_ReadPending))
+                {
+                    dmTime::Sleep(100);
+                }
+                n = ReadBuffered(stream, buffer, size);
+            }
+        }
+
+        if (n == 0 && !stream->m_Error)
+        {
+            // Nothing is buffered at the cursor (e.g. after a seek), so read it directly instead of waiting for a chunk
+            DM_PROFILE("ReadUnbuffered");
+            if (stream->m_Source.m_Read(stream->m_Source.m_Context, stream->m_Cursor, buffer, size, &n))
+            {
+                DM_MUTEX_SCOPED_LOCK(stream->m_Mutex);
+                stream->m_Cursor += n;
+                RestartAt(stream, stream->m_Cursor);
+            }
+            else
+            {
+                dmLogError("Failed to read %u bytes of streamed sound data at offset %u", size, stream->m_Cursor);
+                stream->m_Error = 1;
+                n = 0;
+            }
+        }
+
+        ReadAhead(stream);
+        return n;
+    }
+
+    void StreamSeek(HStreamBuffer stream, uint32_t offset)
+    {
+        {
+            DM_MUTEX_SCOPED_LOCK(stream->m_Mutex);
+            stream->m_Cursor = offset;
+            uint32_t pos = dmMath::Max(offset, stream->m_Source.m_HeaderSize);
+            if (pos < stream->m_Begin || pos > stream->m_End)
+            {
+                RestartAt(stream, pos);
+            }
+        }
+        ReadAhead(stream);
+    }
+
+    uint32_t StreamTell(HStreamBuffer stream)
+    {
+        return stream->m_Cursor;
+    }
+
+    uint32_t StreamSize(HStreamBuffer stream)
+    {
+        return stream->m_Source.m_Size;
+    }
+
+    bool StreamIsReady(HStreamBuffer stream)
+    {
+        // The data is read when it's decoded, so there is nothing to wait for
+        if (!stream->m_JobContext)
+            return true;
+
+        uint32_t available = 0;
+        uint32_t pos = stream->m_Cursor;
+        if (pos < stream->m_Source.m_HeaderSize)
+        {
+            available = stream->m_Source.m_HeaderSize - pos;
+            pos = stream->m_Source.m_HeaderSize;
+        }
+
+        {
+            DM_MUTEX_SCOPED_LOCK(stream->m_Mutex);
+            if (pos >= stream->m_Begin && pos < stream->m_End)
+            {
+                available += stream->m_End - pos;
+            }
+        }
+
+        // Enough for a few mix buffers, while the next chunk is read
+        if (stream->m_Error || stream->m_Cursor + available >= stream->m_Source.m_Size || available >= stream->m_ChunkSize / 2)
+            return true;
+
+        ReadAhead(stream);
+        return false;
+    }
+}
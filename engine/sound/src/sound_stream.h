@@ -0,0 +1,112 @@
+// Copyright 2020-2024 The Defold Foundation
+// Copyright 2014-2020 King
+// Copyright 2009-2014 Ragnar Svensson, Christian Murray
+// Licensed under the Defold License version 1.0 (the "License"); you may not use
+// this file except in compliance with the License.
+//
+// You may obtain a copy of the License, together with FAQs at
+// https://www.defold.com/license
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#ifndef DM_SOUND_STREAM_H
+#define DM_SOUND_STREAM_H
+
+#include <stdint.h>
+#include <dlib/job_thread.h>
+
+/**
+ * Encoded sound data that is read in chunks while it's decoded
+ */
+namespace dmSoundCodec
+{
+    /// Stream buffer handle
+    typedef struct StreamBuffer* HStreamBuffer;
+
+    /**
+     * Reads encoded data. Called from the stream job thread, so it has to be thread safe
+     * @param context the user context
+     * @param offset offset in the encoded data
+     * @param buffer buffer to read to
+     * @param size number of bytes to read
+     * @param nread number of bytes read (out). Less than size at the end of the data
+     * @return false on error
+     */
+    typedef bool (*FStreamRead)(void* context, uint32_t offset, void* buffer, uint32_t size, uint32_t* nread);
+
+    /**
+     * The encoded data of a streamed sound. The first part of the data (the header) is kept in memory,
+     * so that the decoders can be opened without waiting on any reads
+     */
+    struct StreamSource
+    {
+        /// Read function
+        FStreamRead m_Read;
+        /// User context
+        void*       m_Context;
+        /// The first m_HeaderSize bytes of the data
+        const void* m_Header;
+        uint32_t    m_HeaderSize;
+        /// Total size of the data
+        uint32_t    m_Size;
+    };
+
+    /**
+     * Create a stream buffer, reading from the start of the data.
+     * The data after the header is read ahead in chunks into a ring buffer.
+     * @param source the data source. Must outlive the stream buffer
+     * @param capacity size of the ring buffer
+     * @param job_context the context to read on. If 0 (or without worker threads), the data is read on the decoding thread
+     * @return the stream buffer
+     */
+    HStreamBuffer NewStreamBuffer(const StreamSource* source, uint32_t capacity, dmJobThread::HContext job_context);
+
+    /**
+     * Delete a stream buffer. Waits for any read in flight
+     * @param stream stream buffer
+     */
+    void DeleteStreamBuffer(HStreamBuffer stream);
+
+    /**
+     * Read data at the cursor, and advance it. Returns the buffered data, which may be less than size.
+     * Only reads the source directly if nothing is buffered at the cursor.
+     * @param stream stream buffer
+     * @param buffer buffer to read to
+     * @param size max number of bytes to read
+     * @return number of bytes read. 0 at the end of the data, or on error
+     */
+    uint32_t StreamRead(HStreamBuffer stream, void* buffer, uint32_t size);
+
+    /**
+     * Move the cursor. Buffered data is kept if the new position is within it
+     * @param stream stream buffer
+     * @param offset offset in the encoded data
+     */
+    void StreamSeek(HStreamBuffer stream, uint32_t offset);
+
+    /**
+     * Get the cursor
+     * @param stream stream buffer
+     * @return offset in the encoded data
+     */
+    uint32_t StreamTell(HStreamBuffer stream);
+
+    /**
+     * Get the total size of the encoded data
+     * @param stream stream buffer
+     * @return size in bytes
+     */
+    uint32_t StreamSize(HStreamBuffer stream);
+
+    /**
+     * Check if enough data is buffered at the cursor to decode without reading the source directly
+     * @param stream stream buffer
+     * @return true if the data is buffered, or the rest of the data is
+     */
+    bool StreamIsReady(HStreamBuffer stream);
+}
+
+#endif // DM_SOUND_STREAM_H
@@ -275,6 +275,25 @@ class dmSoundTestPlayTest : public dmSoundTest
 {
 };
 
+class dmSoundPcmCacheTest : public dmSoundTest
+{
+public:
+    virtual void SetUp()
+    {
+        dmSound::InitializeParams params;
+        params.m_MaxBuffers = MAX_BUFFERS;
+        params.m_MaxSources = MAX_SOURCES;
+        params.m_OutputDevice = m_DeviceName;
+        params.m_FrameCount = GetParam().m_BufferFrameCount;
+        params.m_UseThread = false;
+        params.m_PcmCacheSize = 512 * 1024;
+        params.m_PcmCacheMaxSoundSize = 256 * 1024;
+
+        dmSound::Result r = dmSound::Initialize(0, &params);
+        ASSERT_EQ(dmSound::RESULT_OK, r);
+    }
+};
+
 class dmSoundTestPlaySpeedTest : public dmSoundTest
 {
 };
@@ -1106,6 +1125,263 @@ TEST_P(dmSoundVerifyOggTest, SoundDataRefCount)
     ASSERT_EQ(dmSound::RESULT_OK, r);
 }
 
+// Verifies that instances over the max voices of their group are virtual, and stay in sync with the mixed ones
+TEST_P(dmSoundVerifyOggTest, VirtualVoices)
+{
+    TestParams params = GetParam();
+    dmSound::Result r;
+    dmSound::HSoundData sd = 0;
+    dmSound::NewSoundData(params.m_Sound, params.m_SoundSize, params.m_Type, &sd, 1234);
+
+    r = dmSound::AddGroup("voices");
+    ASSERT_EQ(dmSound::RESULT_OK, r);
+    r = dmSound::SetGroupMaxVoices(dmHashString64("voices"), 1);
+    ASSERT_EQ(dmSound::RESULT_OK, r);
+
+    dmSound::HSoundInstance loud = 0;
+    r = dmSound::NewSoundInstance(sd, &loud);
+    ASSERT_EQ(dmSound::RESULT_OK, r);
+    dmSound::HSoundInstance quiet = 0;
+    r = dmSound::NewSoundInstance(sd, &quiet);
+    ASSERT_EQ(dmSound::RESULT_OK, r);
+
+    dmSound::HSoundInstance instances[] = { loud, quiet };
+    for (uint32_t i = 0; i < DM_ARRAY_SIZE(instances); ++i)
+    {
+        r = dmSound::SetInstanceGroup(instances[i], "voices");
+        ASSERT_EQ(dmSound::RESULT_OK, r);
+        r = dmSound::SetParameter(instances[i], dmSound::PARAMETER_GAIN, dmVMath::Vector4(i == 0 ? 0.5f : 0.25f, 0, 0, 0));
+        ASSERT_EQ(dmSound::RESULT_OK, r);
+        r = dmSound::SetParameter(instances[i], dmSound::PARAMETER_SPEED, dmVMath::Vector4(params.m_Speed, 0, 0, 0));
+        ASSERT_EQ(dmSound::RESULT_OK, r);
+        r = dmSound::Play(instances[i]);
+        ASSERT_EQ(dmSound::RESULT_OK, r);
+    }
+
+    r = dmSound::Update();
+    ASSERT_EQ(dmSound::RESULT_OK, r);
+    ASSERT_FALSE(dmSound::IsVirtual(loud));
+    ASSERT_TRUE(dmSound::IsVirtual(quiet));
+
+    // Priority goes before gain
+    r = dmSound::SetPriority(quiet, 1);
+    ASSERT_EQ(dmSound::RESULT_OK, r);
+
+    uint32_t tick = 0;
+    do {
+        r = dmSound::Update();
+        ASSERT_EQ(dmSound::RESULT_OK, r);
+        if (tick++ == 0)
+        {
+            ASSERT_TRUE(dmSound::IsVirtual(loud));
+            ASSERT_FALSE(dmSound::IsVirtual(quiet));
+        }
+        ASSERT_EQ(dmSound::GetInternalPos(loud), dmSound::GetInternalPos(quiet));
+    } while (dmSound::IsPlaying(loud));
+    ASSERT_FALSE(dmSound::IsPlaying(quiet));
+
+    r = dmSound::DeleteSoundInstance(loud);
+    ASSERT_EQ(dmSound::RESULT_OK, r);
+    r = dmSound::DeleteSoundInstance(quiet);
+    ASSERT_EQ(dmSound::RESULT_OK, r);
+
+    r = dmSound::DeleteSoundData(sd);
+    ASSERT_EQ(dmSound::RESULT_OK, r);
+}
+
+// Verifies that the spatial instances are attenuated and panned by their positions relative to the listener
+TEST_P(dmSoundVerifyOggTest, Spatial)
+{
+    TestParams params = GetParam();
+    dmSound::Result r;
+    dmSound::HSoundData sd = 0;
+    dmSound::NewSoundData(params.m_Sound, params.m_SoundSize, params.m_Type, &sd, 1234);
+
+    r = dmSound::AddGroup("spatial");
+    ASSERT_EQ(dmSound::RESULT_OK, r);
+    r = dmSound::SetGroupMaxVoices(dmHashString64("spatial"), 1);
+    ASSERT_EQ(dmSound::RESULT_OK, r);
+
+    dmSound::HSoundInstance near = 0;
+    r = dmSound::NewSoundInstance(sd, &near);
+    ASSERT_EQ(dmSound::RESULT_OK, r);
+    dmSound::HSoundInstance far = 0;
+    r = dmSound::NewSoundInstance(sd, &far);
+    ASSERT_EQ(dmSound::RESULT_OK, r);
+
+    // To the right of the listener, and out of range to the left
+    dmSound::HSoundInstance instances[] = { near, far };
+    dmVMath::Point3 positions[] = { dmVMath::Point3(5, 0, 0), dmVMath::Point3(-100, 0, 0) };
+    for (uint32_t i = 0; i < DM_ARRAY_SIZE(instances); ++i)
+    {
+        r = dmSound::SetInstanceGroup(instances[i], "spatial");
+        ASSERT_EQ(dmSound::RESULT_OK, r);
+        r = dmSound::SetParameter(instances[i], dmSound::PARAMETER_SPEED, dmVMath::Vector4(params.m_Speed, 0, 0, 0));
+        ASSERT_EQ(dmSound::RESULT_OK, r);
+        r = dmSound::SetSpatial(instances[i], true, 1.0f, 10.0f);
+        ASSERT_EQ(dmSound::RESULT_OK, r);
+    }
+    r = dmSound::SetPositions(instances, positions, DM_ARRAY_SIZE(instances));
+    ASSERT_EQ(dmSound::RESULT_OK, r);
+    r = dmSound::SetListener(dmVMath::Point3(0, 0, 0), dmVMath::Quat::identity());
+    ASSERT_EQ(dmSound::RESULT_OK, r);
+
+    for (uint32_t i = 0; i < DM_ARRAY_SIZE(instances); ++i)
+    {
+        r = dmSound::Play(instances[i]);
+        ASSERT_EQ(dmSound::RESULT_OK, r);
+    }
+
+    r = dmSound::Update();
+    ASSERT_EQ(dmSound::RESULT_OK, r);
+    ASSERT_FALSE(dmSound::IsVirtual(near));
+    ASSERT_TRUE(dmSound::IsVirtual(far));
+
+    r = dmSound::Update();
+    ASSERT_EQ(dmSound::RESULT_OK, r);
+    float rms_left, rms_right;
+    dmSound::GetGroupRMS(dmHashString64("spatial"), params.m_BufferFrameCount / 44100.0f, &rms_left, &rms_right);
+    ASSERT_NEAR(0.0f, rms_left, 0.001f);
+    ASSERT_GE(rms_right, rms_left);
+
+    // Moving the listener next to the far instance swaps them
+    r = dmSound::SetListener(dmVMath::Point3(-100, 0, 0), dmVMath::Quat::identity());
+    ASSERT_EQ(dmSound::RESULT_OK, r);
+    r = dmSound::Update();
+    ASSERT_EQ(dmSound::RESULT_OK, r);
+    ASSERT_TRUE(dmSound::IsVirtual(near));
+    ASSERT_FALSE(dmSound::IsVirtual(far));
+
+    for (uint32_t i = 0; i < DM_ARRAY_SIZE(instances); ++i)
+    {
+        r = dmSound::Stop(instances[i]);
+        ASSERT_EQ(dmSound::RESULT_OK, r);
+        r = dmSound::DeleteSoundInstance(instances[i]);
+        ASSERT_EQ(dmSound::RESULT_OK, r);
+    }
+
+    r = dmSound::SetListener(dmVMath::Point3(0, 0, 0), dmVMath::Quat::identity());
+    ASSERT_EQ(dmSound::RESULT_OK, r);
+    r = dmSound::DeleteSoundData(sd);
+    ASSERT_EQ(dmSound::RESULT_OK, r);
+}
+
+struct StreamedSoundData
+{
+    const uint8_t* m_Data;
+    uint32_t       m_Size;
+    uint32_t       m_Reads;
+    bool           m_Released;
+};
+
+static bool ReadStreamedSoundData(void* context, uint32_t offset, void* buffer, uint32_t size, uint32_t* nread)
+{
+    StreamedSoundData* data = (StreamedSoundData*) context;
+    *nread = offset < data->m_Size ? dmMath::Min(size, data->m_Size - offset) : 0;
+    memcpy(buffer, data->m_Data + offset, *nread);
+    data->m_Reads++;
+    return true;
+}
+
+static void ReleaseStreamedSoundData(void* context)
+{
+    ((StreamedSoundData*) context)->m_Released = true;
+}
+
+// Verifies that a streamed sound plays in sync with the same sound in memory
+TEST_P(dmSoundVerifyOggTest, Streamed)
+{
+    TestParams params = GetParam();
+    dmSound::Result r;
+    dmSound::HSoundData sd = 0;
+    dmSound::NewSoundData(params.m_Sound, params.m_SoundSize, params.m_Type, &sd, 1234);
+
+    StreamedSoundData data = { (const uint8_t*) params.m_Sound, params.m_SoundSize, 0, false };
+    uint32_t header_size = dmMath::Min(4096u, params.m_SoundSize / 4);
+    dmSound::HSoundData streamed_sd = 0;
+    r = dmSound::NewSoundDataStreaming(params.m_Sound, header_size, params.m_SoundSize, ReadStreamedSoundData, ReleaseStreamedSoundData, &data, params.m_Type, &streamed_sd, 1235);
+    if (r == dmSound::RESULT_UNSUPPORTED)
+    {
+        dmSound::DeleteSoundData(sd);
+        return; // No decoder for streamed ogg on this platform
+    }
+    ASSERT_EQ(dmSound::RESULT_OK, r);
+
+    dmSound::HSoundInstance instance = 0;
+    r = dmSound::NewSoundInstance(sd, &instance);
+    ASSERT_EQ(dmSound::RESULT_OK, r);
+    dmSound::HSoundInstance streamed_instance = 0;
+    r = dmSound::NewSoundInstance(streamed_sd, &streamed_instance);
+    ASSERT_EQ(dmSound::RESULT_OK, r);
+
+    r = dmSound::Play(instance);
+    ASSERT_EQ(dmSound::RESULT_OK, r);
+    r = dmSound::Play(streamed_instance);
+    ASSERT_EQ(dmSound::RESULT_OK, r);
+    do {
+        r = dmSound::Update();
+        ASSERT_EQ(dmSound::RESULT_OK, r);
+        ASSERT_EQ(dmSound::GetInternalPos(instance), dmSound::GetInternalPos(streamed_instance));
+    } while (dmSound::IsPlaying(instance));
+    ASSERT_FALSE(dmSound::IsPlaying(streamed_instance));
+    ASSERT_LT(0u, data.m_Reads);
+
+    r = dmSound::DeleteSoundInstance(instance);
+    ASSERT_EQ(dmSound::RESULT_OK, r);
+    r = dmSound::DeleteSoundInstance(streamed_instance);
+    ASSERT_EQ(dmSound::RESULT_OK, r);
+
+    r = dmSound::DeleteSoundData(sd);
+    ASSERT_EQ(dmSound::RESULT_OK, r);
+    ASSERT_FALSE(data.m_Released);
+    r = dmSound::DeleteSoundData(streamed_sd);
+    ASSERT_EQ(dmSound::RESULT_OK, r);
+    ASSERT_TRUE(data.m_Released);
+}
+
+// Verifies that instances of the same sound share the decoded pcm, and that it is released with the sound data
+TEST_P(dmSoundPcmCacheTest, SharedPcm)
+{
+    TestParams params = GetParam();
+    dmSound::Result r;
+    dmSound::HSoundData sd = 0;
+    dmSound::NewSoundData(params.m_Sound, params.m_SoundSize, params.m_Type, &sd, 1234);
+
+    ASSERT_EQ(0u, dmSound::GetPcmCacheSize());
+
+    dmSound::HSoundInstance instance = 0;
+    r = dmSound::NewSoundInstance(sd, &instance);
+    ASSERT_EQ(dmSound::RESULT_OK, r);
+    ASSERT_NE((dmSound::HSoundInstance) 0, instance);
+
+    uint32_t cache_size = dmSound::GetPcmCacheSize();
+    ASSERT_LT(0u, cache_size);
+
+    dmSound::HSoundInstance instance2 = 0;
+    r = dmSound::NewSoundInstance(sd, &instance2);
+    ASSERT_EQ(dmSound::RESULT_OK, r);
+    ASSERT_EQ(cache_size, dmSound::GetPcmCacheSize());
+
+    r = dmSound::Play(instance);
+    ASSERT_EQ(dmSound::RESULT_OK, r);
+    r = dmSound::Play(instance2);
+    ASSERT_EQ(dmSound::RESULT_OK, r);
+    do {
+        r = dmSound::Update();
+        ASSERT_EQ(dmSound::RESULT_OK, r);
+    } while (dmSound::IsPlaying(instance) || dmSound::IsPlaying(instance2));
+
+    r = dmSound::DeleteSoundInstance(instance);
+    ASSERT_EQ(dmSound::RESULT_OK, r);
+    r = dmSound::DeleteSoundInstance(instance2);
+    ASSERT_EQ(dmSound::RESULT_OK, r);
+    ASSERT_EQ(cache_size, dmSound::GetPcmCacheSize());
+
+    r = dmSound::DeleteSoundData(sd);
+    ASSERT_EQ(dmSound::RESULT_OK, r);
+    ASSERT_EQ(0u, dmSound::GetPcmCacheSize());
+}
+
 const TestParams params_verify_ogg_test[] = {TestParams("loopback",
                                             MONO_RESAMPLE_FRAMECOUNT_16000_OGG,
                                             MONO_RESAMPLE_FRAMECOUNT_16000_OGG_SIZE,
@@ -1115,6 +1391,7 @@ const TestParams params_verify_ogg_test[] = {TestParams("loopback",
                                             35200,
                                             2048)};
 INSTANTIATE_TEST_CASE_P(dmSoundVerifyOggTest, dmSoundVerifyOggTest, jc_test_values_in(params_verify_ogg_test));
+INSTANTIATE_TEST_CASE_P(dmSoundPcmCacheTest, dmSoundPcmCacheTest, jc_test_values_in(params_verify_ogg_test));
 #endif
 
 #if !defined(GITHUB_CI) || (defined(GITHUB_CI) && !(defined(WIN32) || defined(__MACH__)))
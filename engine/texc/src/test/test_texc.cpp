@@ -230,6 +230,46 @@ TEST_F(TexcTest, MipMaps)
 }
 
 
+TEST_F(TexcTest, EncodeCache)
+{
+    const char* cache_dir = "build/test_texc_encode_cache";
+    ASSERT_TRUE(dmTexc::SetEncodeCacheDir(cache_dir));
+
+    uint32_t sizes[2];
+    uint8_t* datas[2];
+    for (uint32_t i = 0; i < 2; ++i)
+    {
+        dmTexc::HTexture texture = CreateDefaultRGBA32(dmTexc::CT_BASIS_UASTC);
+        ASSERT_TRUE(dmTexc::Encode(texture, dmTexc::PF_R8G8B8A8, dmTexc::CS_LRGB, dmTexc::CL_FAST, dmTexc::CT_BASIS_UASTC, false, 1));
+        sizes[i] = dmTexc::GetTotalDataSize(texture);
+        datas[i] = new uint8_t[sizes[i]];
+        dmTexc::GetData(texture, datas[i], sizes[i]);
+        dmTexc::Destroy(texture);
+    }
+
+    // The second texture gets the cached encoding of the first one
+    ASSERT_LT(0u, sizes[0]);
+    ASSERT_EQ(sizes[0], sizes[1]);
+    ASSERT_EQ(0, memcmp(datas[0], datas[1], sizes[0]));
+
+    dmTexc::Texture* texture = (dmTexc::Texture*)CreateDefaultRGBA32(dmTexc::CT_BASIS_UASTC);
+    uint64_t key = dmTexc::GetEncodeCacheKey(texture, texture->m_BasisImage.get_ptr(), 2 * 2 * 4, dmTexc::PF_R8G8B8A8, dmTexc::CT_BASIS_UASTC, dmTexc::CL_FAST);
+    dmArray<uint8_t> cached;
+    ASSERT_TRUE(dmTexc::ReadEncodeCache(key, cached));
+    ASSERT_EQ(sizes[0], cached.Size());
+
+    // Other settings have other keys
+    ASSERT_NE(key, dmTexc::GetEncodeCacheKey(texture, texture->m_BasisImage.get_ptr(), 2 * 2 * 4, dmTexc::PF_R8G8B8A8, dmTexc::CT_BASIS_UASTC, dmTexc::CL_BEST));
+    ASSERT_NE(key, dmTexc::GetEncodeCacheKey(texture, texture->m_BasisImage.get_ptr(), 2 * 2 * 4, dmTexc::PF_R8G8B8A8, dmTexc::CT_BASIS_ETC1S, dmTexc::CL_FAST));
+    dmTexc::Destroy(texture);
+
+    delete[] datas[0];
+    delete[] datas[1];
+
+    ASSERT_TRUE(dmTexc::SetEncodeCacheDir(0));
+    ASSERT_FALSE(dmTexc::ReadEncodeCache(key, cached));
+}
+
 #define ASSERT_RGBA(exp, act)\
     ASSERT_EQ((exp)[0], (act)[0]);\
     ASSERT_EQ((exp)[1], (act)[1]);\
@@ -143,15 +143,16 @@ namespace dmTexc
         return t->m_Encoder.m_FnFlip(t, flip_axis);
     }
 
+    // A max_threads of 0 or less uses all cores
     static uint32_t GetNumThreads(int max_threads)
     {
         uint32_t num_threads = max_threads;
-        if (max_threads > 1)
+        if (max_threads > 1 || max_threads <= 0)
         {
             num_threads = std::thread::hardware_concurrency();
             if (num_threads < 1)
                 num_threads = 1;
-            if (num_threads > max_threads)
+            if (max_threads > 0 && num_threads > (uint32_t)max_threads)
                 num_threads = max_threads;
         }
         return num_threads;
@@ -226,6 +227,7 @@ namespace dmTexc
     DM_TEXC_TRAMPOLINE1(bool, GenMipMaps, HTexture);
     DM_TEXC_TRAMPOLINE2(bool, Flip, HTexture, FlipAxis);
     DM_TEXC_TRAMPOLINE7(bool, Encode, HTexture, PixelFormat, ColorSpace, CompressionLevel, CompressionType, bool, int);
+    DM_TEXC_TRAMPOLINE1(bool, SetEncodeCacheDir, const char*);
     DM_TEXC_TRAMPOLINE2(HBuffer, CompressBuffer, void*, uint32_t);
     DM_TEXC_TRAMPOLINE1(uint32_t, GetTotalBufferDataSize, HBuffer);
     DM_TEXC_TRAMPOLINE3(uint32_t, GetBufferData, HBuffer, void*, uint32_t);
@@ -191,6 +191,13 @@ namespace dmTexc
      */
     DM_TEXC_PROTO(bool, Encode, HTexture texture, PixelFormat pixelFormat, ColorSpace color_space, CompressionLevel compressionLevel, CompressionType compression_type, bool mipmaps, int max_threads);
 
+    /**
+     * Set the directory where the encoded outputs are cached, keyed by the image, the encode settings and the encoder version.
+     * The directory may be shared by several processes. Pass 0 to disable the cache.
+     * If not set, the DM_TEXC_CACHE_DIR environment variable is used.
+     */
+    DM_TEXC_PROTO(bool, SetEncodeCacheDir, const char* path);
+
     // Now only used for font glyphs
     // Compresses an image buffer
     DM_TEXC_PROTO(HBuffer, CompressBuffer, void* data, uint32_t size);
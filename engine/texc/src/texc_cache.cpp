@@ -0,0 +1,188 @@
+// Copyright 2020-2024 The Defold Foundation
+// Copyright 2014-2020 King
+// Copyright 2009-2014 Ragnar Svensson, Christian Murray
+// Licensed under the Defold License version 1.0 (the "License"); you may not use
+// this file except in compliance with the License.
+//
+// You may obtain a copy of the License, together with FAQs at
+// https://www.defold.com/license
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <dlib/dstrings.h>
+#include <dlib/hash.h>
+#include <dlib/log.h>
+#include <dlib/mutex.h>
+#include <dlib/path.h>
+#include <dlib/sys.h>
+#include <dlib/time.h>
+
+#include "texc.h"
+#include "texc_private.h"
+
+#include <basis/encoder/basisu_comp.h>
+
+namespace dmTexc
+{
+    // Bump this whenever the encoder settings change, to invalidate the encoded outputs already in the caches
+    static const uint32_t ENCODE_CACHE_VERSION = 1;
+    static const uint32_t ENCODE_CACHE_MAGIC   = 0x43584554; // "TEXC"
+
+    static const char*    ENCODE_CACHE_DIR_ENV = "DM_TEXC_CACHE_DIR";
+
+    struct EncodeCacheHeader
+    {
+        uint32_t m_Magic;
+        uint32_t m_Version;
+        uint64_t m_Key;
+        uint32_t m_DataSize;
+    };
+
+    static dmMutex::HMutex g_EncodeCacheMutex = dmMutex::New();
+    static char            g_EncodeCacheDir[DMPATH_MAX_PATH] = {0};
+    static bool            g_EncodeCacheDirSet = false;
+
+    static bool SetEncodeCacheDirInternal(const char* path)
+    {
+        g_EncodeCacheDirSet = true;
+        g_EncodeCacheDir[0] = 0;
+        if (!path || !path[0])
+        {
+            return true;
+        }
+
+        dmSys::Result r = dmSys::Mkdir(path, 0755);
+        if (r != dmSys::RESULT_OK && r != dmSys::RESULT_EXIST)
+        {
+            dmLogWarning("Failed to create the texture encode cache directory '%s': %d", path, r);
+            return false;
+        }
+        dmStrlCpy(g_EncodeCacheDir, path, sizeof(g_EncodeCacheDir));
+        return true;
+    }
+
+    bool SetEncodeCacheDir(const char* path)
+    {
+        DM_MUTEX_SCOPED_LOCK(g_EncodeCacheMutex);
+        return SetEncodeCacheDirInternal(path);
+    }
+
+    // Returns false if there is no cache
+    static bool GetEncodeCachePath(uint64_t key, char* path, uint32_t path_size)
+    {
+        DM_MUTEX_SCOPED_LOCK(g_EncodeCacheMutex);
+        if (!g_EncodeCacheDirSet)
+        {
+            SetEncodeCacheDirInternal(getenv(ENCODE_CACHE_DIR_ENV));
+        }
+
+        if (!g_EncodeCacheDir[0])
+        {
+            return false;
+        }
+        dmSnPrintf(path, path_size, "%s/%016llx.texc", g_EncodeCacheDir, (unsigned long long)key);
+        return true;
+    }
+
+    uint64_t GetEncodeCacheKey(Texture* texture, const void* data, uint32_t data_size, PixelFormat pixel_format, CompressionType compression_type, CompressionLevel compression_level)
+    {
+        // Everything that affects the encoded output
+        uint32_t settings[] = {
+            ENCODE_CACHE_VERSION,
+            BASISU_LIB_VERSION,
+            texture->m_Width,
+            texture->m_Height,
+            (uint32_t)texture->m_ColorSpace,
+            (uint32_t)texture->m_BasisGenMipmaps,
+            (uint32_t)pixel_format,
+            (uint32_t)compression_type,
+            (uint32_t)compression_level,
+        };
+
+        HashState64 state;
+        dmHashInit64(&state, false);
+        dmHashUpdateBuffer64(&state, settings, sizeof(settings));
+        dmHashUpdateBuffer64(&state, data, data_size);
+        return dmHashFinal64(&state);
+    }
+
+    bool ReadEncodeCache(uint64_t key, dmArray<uint8_t>& out_data)
+    {
+        char path[DMPATH_MAX_PATH];
+        if (!GetEncodeCachePath(key, path, sizeof(path)))
+        {
+            return false;
+        }
+
+        FILE* f = fopen(path, "rb");
+        if (!f)
+        {
+            return false;
+        }
+
+        EncodeCacheHeader header;
+        bool result = fread(&header, sizeof(header), 1, f) == 1 &&
+                      header.m_Magic == ENCODE_CACHE_MAGIC &&
+                      header.m_Version == ENCODE_CACHE_VERSION &&
+                      header.m_Key == key;
+        if (result)
+        {
+            out_data.SetCapacity(header.m_DataSize);
+            out_data.SetSize(header.m_DataSize);
+            result = header.m_DataSize == 0 || fread(out_data.Begin(), header.m_DataSize, 1, f) == 1;
+        }
+        fclose(f);
+
+        if (!result)
+        {
+            dmLogWarning("Ignoring the broken texture encode cache entry '%s'", path);
+            out_data.SetSize(0);
+        }
+        return result;
+    }
+
+    void WriteEncodeCache(uint64_t key, const dmArray<uint8_t>& data)
+    {
+        char path[DMPATH_MAX_PATH];
+        if (!GetEncodeCachePath(key, path, sizeof(path)))
+        {
+            return;
+        }
+
+        // The cache may be shared by several processes, so the entry is written to a
+        // unique file first, and then moved into place
+        char tmp_path[DMPATH_MAX_PATH];
+        dmSnPrintf(tmp_path, sizeof(tmp_path), "%s.%llx.tmp", path, (unsigned long long)(dmTime::GetTime() ^ (uintptr_t)&data));
+
+        FILE* f = fopen(tmp_path, "wb");
+        if (!f)
+        {
+            dmLogWarning("Failed to write the texture encode cache entry '%s'", tmp_path);
+            return;
+        }
+
+        EncodeCacheHeader header;
+        memset(&header, 0, sizeof(header));
+        header.m_Magic = ENCODE_CACHE_MAGIC;
+        header.m_Version = ENCODE_CACHE_VERSION;
+        header.m_Key = key;
+        header.m_DataSize = data.Size();
+
+        bool result = fwrite(&header, sizeof(header), 1, f) == 1 &&
+                      (data.Empty() || fwrite(data.Begin(), data.Size(), 1, f) == 1);
+        result = fclose(f) == 0 && result;
+
+        if (!result || dmSys::Rename(path, tmp_path) != dmSys::RESULT_OK)
+        {
+            dmLogWarning("Failed to write the texture encode cache entry '%s'", path);
+            dmSys::Unlink(tmp_path);
+        }
+    }
+}
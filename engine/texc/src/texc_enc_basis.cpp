@@ -105,7 +105,14 @@ namespace dmTexc
 
     static bool EncodeBasis(Texture* texture, int num_threads, PixelFormat pixel_format, CompressionType compression_type, CompressionLevel compression_level)
     {
-        (void)pixel_format;
+        uint64_t cache_key = GetEncodeCacheKey(texture, texture->m_BasisImage.get_ptr(),
+                                               texture->m_BasisImage.get_pitch() * texture->m_BasisImage.get_height() * sizeof(basisu::color_rgba),
+                                               pixel_format, compression_type, compression_level);
+        if (ReadEncodeCache(cache_key, texture->m_BasisFile))
+        {
+            dmLogDebug("Using the cached encoding of %s", texture->m_Name);
+            return true;
+        }
 
         basisu::job_pool jpool(num_threads);
 
@@ -205,6 +212,7 @@ namespace dmTexc
         texture->m_BasisFile.SetSize(data.size());
         memcpy(texture->m_BasisFile.Begin(), &data[0], data.size());
 
+        WriteEncodeCache(cache_key, texture->m_BasisFile);
         return true;
     }
 
@@ -101,6 +101,12 @@ namespace dmTexc
     void        DitherRGBx565(uint8_t* data, uint32_t width, uint32_t height);
 
     void        DebugPrint(uint8_t* p, uint32_t width, uint32_t height, uint32_t num_channels);
+
+    // Encoded output cache (see SetEncodeCacheDir)
+    uint64_t    GetEncodeCacheKey(Texture* texture, const void* data, uint32_t data_size, PixelFormat pixel_format, CompressionType compression_type, CompressionLevel compression_level);
+    // Returns false if there is no cache, or no entry for the key
+    bool        ReadEncodeCache(uint64_t key, dmArray<uint8_t>& out_data);
+    void        WriteEncodeCache(uint64_t key, const dmArray<uint8_t>& data);
 }
 
 #endif // DM_TEXC_PRIVATE_H